@@ -46,7 +46,10 @@
 #include "clang/Tooling/Tooling.h"
 #include "llvm/Support/Process.h"
 #include "llvm/Support/Signals.h"
+#include "llvm/Support/ThreadPool.h"
+#include "llvm/Support/Threading.h"
 #include <algorithm>
+#include <mutex>
 #include <utility>
 
 using namespace clang::ast_matchers;
@@ -390,6 +393,7 @@ ClangTidyASTConsumerFactory::CreateASTConsumer(
     Profiling = llvm::make_unique<ClangTidyProfiling>(
         Context.getProfileStorageParams());
     FinderOptions.CheckProfiling.emplace(Profiling->Records);
+    FinderOptions.CheckProfiling->SeparateCallbacks = true;
   }
 
   std::unique_ptr<ast_matchers::MatchFinder> Finder(
@@ -484,12 +488,38 @@ getCheckOptions(const ClangTidyOptions &Options,
   return Factory.getCheckOptions();
 }
 
-std::vector<ClangTidyError>
-runClangTidy(clang::tidy::ClangTidyContext &Context,
-             const CompilationDatabase &Compilations,
-             ArrayRef<std::string> InputFiles,
-             llvm::IntrusiveRefCntPtr<llvm::vfs::OverlayFileSystem> BaseFS,
-             bool EnableCheckProfile, llvm::StringRef StoreCheckProfile) {
+namespace {
+/// Provides the options of the context that owns a run to the contexts of the
+/// threads processing its translation units. The configuration files read so
+/// far are cached by the owner's provider, so access to it is serialized.
+class SharedOptionsProvider : public ClangTidyOptionsProvider {
+public:
+  SharedOptionsProvider(const ClangTidyContext &Owner, std::mutex &Lock)
+      : Owner(Owner), Lock(Lock) {}
+
+  const ClangTidyGlobalOptions &getGlobalOptions() override {
+    return Owner.getGlobalOptions();
+  }
+
+  std::vector<OptionsSource> getRawOptions(llvm::StringRef FileName) override {
+    std::lock_guard<std::mutex> Guard(Lock);
+    std::vector<OptionsSource> Result;
+    Result.emplace_back(Owner.getOptionsForFile(FileName), "shared");
+    return Result;
+  }
+
+private:
+  const ClangTidyContext &Owner;
+  std::mutex &Lock;
+};
+} // namespace
+
+/// Runs the checks enabled in \p Context on \p InputFiles, in order, and
+/// reports the diagnostics to \p DiagConsumer.
+static void runChecksOnFiles(
+    ClangTidyContext &Context, ClangTidyDiagnosticConsumer &DiagConsumer,
+    const CompilationDatabase &Compilations, ArrayRef<std::string> InputFiles,
+    llvm::IntrusiveRefCntPtr<llvm::vfs::OverlayFileSystem> BaseFS) {
   ClangTool Tool(Compilations, InputFiles,
                  std::make_shared<PCHContainerOperations>(), BaseFS);
 
@@ -513,10 +543,7 @@ runClangTidy(clang::tidy::ClangTidyContext &Context,
 
   Tool.appendArgumentsAdjuster(PerFileExtraArgumentsInserter);
   Tool.appendArgumentsAdjuster(getStripPluginsAdjuster());
-  Context.setEnableProfiling(EnableCheckProfile);
-  Context.setProfileStoragePrefix(StoreCheckProfile);
 
-  ClangTidyDiagnosticConsumer DiagConsumer(Context);
   DiagnosticsEngine DE(new DiagnosticIDs(), new DiagnosticOptions(),
                        &DiagConsumer, /*ShouldOwnClient=*/false);
   Context.setDiagnosticsEngine(&DE);
@@ -559,6 +586,55 @@ runClangTidy(clang::tidy::ClangTidyContext &Context,
 
   ActionFactory Factory(Context, BaseFS);
   Tool.run(&Factory);
+  Context.setDiagnosticsEngine(nullptr);
+}
+
+std::vector<ClangTidyError>
+runClangTidy(clang::tidy::ClangTidyContext &Context,
+             const CompilationDatabase &Compilations,
+             ArrayRef<std::string> InputFiles,
+             llvm::IntrusiveRefCntPtr<llvm::vfs::OverlayFileSystem> BaseFS,
+             bool EnableCheckProfile, llvm::StringRef StoreCheckProfile,
+             unsigned ThreadCount) {
+  Context.setEnableProfiling(EnableCheckProfile);
+  Context.setProfileStoragePrefix(StoreCheckProfile);
+
+  ClangTidyDiagnosticConsumer DiagConsumer(Context);
+  if (ThreadCount == 0)
+    ThreadCount = llvm::hardware_concurrency();
+  if (ThreadCount == 1 || InputFiles.size() < 2) {
+    runChecksOnFiles(Context, DiagConsumer, Compilations, InputFiles, BaseFS);
+    return DiagConsumer.take();
+  }
+
+  std::mutex Lock;
+  {
+    llvm::ThreadPool Pool(std::min<size_t>(ThreadCount, InputFiles.size()));
+    for (const std::string &File : InputFiles) {
+      Pool.async([&, File] {
+        // Each translation unit gets a context of its own, as they track the
+        // file being processed, and a file system of its own, as ClangTool
+        // changes its working directory.
+        ClangTidyContext FileContext(
+            llvm::make_unique<SharedOptionsProvider>(Context, Lock),
+            Context.canEnableAnalyzerAlphaCheckers());
+        FileContext.setEnableProfiling(EnableCheckProfile);
+        FileContext.setProfileStoragePrefix(StoreCheckProfile);
+        ClangTidyDiagnosticConsumer FileDiagConsumer(
+            FileContext, /*ExternalDiagEngine=*/nullptr,
+            /*RemoveIncompatibleErrors=*/false);
+        llvm::IntrusiveRefCntPtr<llvm::vfs::OverlayFileSystem> FS(
+            new llvm::vfs::OverlayFileSystem(
+                llvm::vfs::createPhysicalFileSystem().release()));
+        runChecksOnFiles(FileContext, FileDiagConsumer, Compilations, File,
+                         FS);
+
+        std::lock_guard<std::mutex> Guard(Lock);
+        DiagConsumer.addErrors(FileDiagConsumer.take());
+        Context.mergeStats(FileContext.getStats());
+      });
+    }
+  }
   return DiagConsumer.take();
 }
 
@@ -24,6 +24,7 @@
 #include "clang/Tooling/Core/Diagnostic.h"
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/SmallString.h"
+#include <iterator>
 #include <tuple>
 #include <vector>
 using namespace clang;
@@ -754,8 +755,18 @@ struct EqualClangTidyError {
 };
 } // end anonymous namespace
 
+void ClangTidyDiagnosticConsumer::addErrors(
+    std::vector<ClangTidyError> NewErrors) {
+  AddedErrors.insert(AddedErrors.end(),
+                     std::make_move_iterator(NewErrors.begin()),
+                     std::make_move_iterator(NewErrors.end()));
+}
+
 std::vector<ClangTidyError> ClangTidyDiagnosticConsumer::take() {
   finalizeLastError();
+  Errors.insert(Errors.end(), std::make_move_iterator(AddedErrors.begin()),
+                std::make_move_iterator(AddedErrors.end()));
+  AddedErrors.clear();
 
   std::sort(Errors.begin(), Errors.end(), LessClangTidyError());
   Errors.erase(std::unique(Errors.begin(), Errors.end(), EqualClangTidyError()),
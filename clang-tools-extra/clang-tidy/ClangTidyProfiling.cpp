@@ -13,6 +13,7 @@
 #include "llvm/Support/Path.h"
 #include "llvm/Support/YAMLTraits.h"
 #include "llvm/Support/raw_ostream.h"
+#include <mutex>
 #include <system_error>
 #include <utility>
 
@@ -82,10 +83,14 @@ ClangTidyProfiling::ClangTidyProfiling(llvm::Optional<StorageParams> Storage)
 ClangTidyProfiling::~ClangTidyProfiling() {
   TG.emplace("clang-tidy", "clang-tidy checks profiling", Records);
 
-  if (!Storage.hasValue())
+  if (!Storage.hasValue()) {
+    // Translation units may be processed in parallel; keep their tables apart.
+    static std::mutex OutputLock;
+    std::lock_guard<std::mutex> Guard(OutputLock);
     printUserFriendlyTable(llvm::errs());
-  else
+  } else {
     storeProfileData();
+  }
 }
 
 } // namespace tidy
@@ -177,11 +177,21 @@ configuration of all checks.
 
 static cl::opt<bool> EnableCheckProfile("enable-check-profile", cl::desc(R"(
 Enable per-check timing profiles, and print a
-report to stderr.
+report to stderr. The time spent evaluating the
+matchers of a check and the time spent in the
+check's own code (the "<check>.callback" entry)
+are reported separately.
 )"),
                                         cl::init(false),
                                         cl::cat(ClangTidyCategory));
 
+static cl::opt<unsigned> Jobs("j", cl::desc(R"(
+Number of files to process in parallel. Set to 0
+to use all hardware threads. Ignored together
+with -vfsoverlay.
+)"),
+                             cl::init(1), cl::cat(ClangTidyCategory));
+
 static cl::opt<std::string> StoreCheckProfile("store-check-profile",
                                               cl::desc(R"(
 By default reports are printed in tabulated
@@ -428,7 +438,8 @@ static int clangTidyMain(int argc, const char **argv) {
                            AllowEnablingAnalyzerAlphaCheckers);
   std::vector<ClangTidyError> Errors =
       runClangTidy(Context, OptionsParser.getCompilations(), PathList, BaseFS,
-                   EnableCheckProfile, ProfilePrefix);
+                   EnableCheckProfile, ProfilePrefix,
+                   VfsOverlay.empty() ? Jobs : 1);
   bool FoundErrors = llvm::find_if(Errors, [](const ClangTidyError &E) {
                        return E.DiagLevel == ClangTidyError::Error;
                      }) != Errors.end();
@@ -25,6 +25,8 @@
 #include "llvm/Support/FormatVariadic.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/ScopedPrinter.h"
+#include <array>
+#include <chrono>
 
 namespace clang {
 namespace clangd {
@@ -188,7 +190,48 @@ public:
     };
   }
 
+  // Describes how long the replies to each method took so far.
+  llvm::json::Object latencies() const {
+    std::lock_guard<std::mutex> Lock(LatenciesMutex);
+    llvm::json::Object Result;
+    for (const auto &Entry : Latencies) {
+      const LatencyHistogram &H = Entry.second;
+      llvm::json::Array Buckets;
+      for (unsigned Count : H.Buckets)
+        Buckets.push_back(Count);
+      Result[Entry.first()] = llvm::json::Object{
+          {"count", H.Count},
+          {"totalMs", H.TotalMs},
+          {"buckets", std::move(Buckets)},
+      };
+    }
+    return Result;
+  }
+
 private:
+  // Latencies of the replies to a method. Buckets[I] counts the replies that
+  // took less than 2^I ms, the last bucket counts all slower ones.
+  struct LatencyHistogram {
+    unsigned Count = 0;
+    double TotalMs = 0;
+    std::array<unsigned, 16> Buckets = {};
+  };
+  mutable std::mutex LatenciesMutex;
+  llvm::StringMap<LatencyHistogram> Latencies;
+
+  void recordLatency(llvm::StringRef Method,
+                     std::chrono::steady_clock::duration Duration) {
+    double Ms = std::chrono::duration<double, std::milli>(Duration).count();
+    unsigned Bucket = 0;
+    std::lock_guard<std::mutex> Lock(LatenciesMutex);
+    LatencyHistogram &H = Latencies[Method];
+    while (Bucket + 1 < H.Buckets.size() && Ms >= (1u << Bucket))
+      ++Bucket;
+    ++H.Count;
+    H.TotalMs += Ms;
+    ++H.Buckets[Bucket];
+  }
+
   // Function object to reply to an LSP call.
   // Each instance must be called exactly once, otherwise:
   //  - the bug is logged, and (in debug mode) an assert will fire
@@ -236,6 +279,7 @@ private:
         return;
       }
       auto Duration = std::chrono::steady_clock::now() - Start;
+      Server->MsgHandler->recordLatency(Method, Duration);
       if (Reply) {
         log("--> reply:{0}({1}) {2:ms}", Method, ID, Duration);
         if (TraceArgs)
@@ -447,6 +491,24 @@ void ClangdLSPServer::onSync(const NoParams &Params,
                                   "Not idle after a minute"));
 }
 
+void ClangdLSPServer::onMemoryUsage(const NoParams &Params,
+                                    Callback<llvm::json::Value> Reply) {
+  ClangdServer::MemoryUsage Usage = Server->getMemoryUsage();
+  Reply(llvm::json::Object{
+      {"preambles", Usage.Preambles},
+      {"astCache", Usage.ASTCache},
+      {"dynamicIndex", Usage.DynamicIndex},
+      {"backgroundIndex", Usage.BackgroundIndex},
+      {"staticIndex", Usage.StaticIndex},
+      {"total", Usage.total()},
+  });
+}
+
+void ClangdLSPServer::onRequestLatencies(const NoParams &Params,
+                                         Callback<llvm::json::Value> Reply) {
+  Reply(MsgHandler->latencies());
+}
+
 void ClangdLSPServer::onDocumentDidOpen(
     const DidOpenTextDocumentParams &Params) {
   PathRef File = Params.textDocument.uri.file();
@@ -996,6 +1058,8 @@ ClangdLSPServer::ClangdLSPServer(
   MsgHandler->bind("initialize", &ClangdLSPServer::onInitialize);
   MsgHandler->bind("shutdown", &ClangdLSPServer::onShutdown);
   MsgHandler->bind("sync", &ClangdLSPServer::onSync);
+  MsgHandler->bind("$/memoryUsage", &ClangdLSPServer::onMemoryUsage);
+  MsgHandler->bind("$/requestLatencies", &ClangdLSPServer::onRequestLatencies);
   MsgHandler->bind("textDocument/rangeFormatting", &ClangdLSPServer::onDocumentRangeFormatting);
   MsgHandler->bind("textDocument/onTypeFormatting", &ClangdLSPServer::onDocumentOnTypeFormatting);
   MsgHandler->bind("textDocument/formatting", &ClangdLSPServer::onDocumentFormatting);
@@ -123,13 +123,20 @@ ClangdServer::ClangdServer(const GlobalCompilationDatabase &CDB,
       this->Index = Idx;
     }
   };
-  if (Opts.StaticIndex)
+  if (Opts.StaticIndex) {
+    StaticIdx = Opts.StaticIndex;
     AddIndex(Opts.StaticIndex);
+  }
   if (Opts.BackgroundIndex) {
+    auto IndexStorageFactory =
+        BackgroundIndexStorage::createDiskBackedStorageFactory();
+    if (!Opts.IndexStorePath.empty())
+      IndexStorageFactory =
+          BackgroundIndexStorage::createIndexStoreBackedStorageFactory(
+              Opts.IndexStorePath, std::move(IndexStorageFactory));
     BackgroundIdx = llvm::make_unique<BackgroundIndex>(
         Context::current().clone(), FSProvider, CDB,
-        BackgroundIndexStorage::createDiskBackedStorageFactory(),
-        Opts.BackgroundIndexRebuildPeriodMs);
+        std::move(IndexStorageFactory), Opts.BackgroundIndexRebuildPeriodMs);
     AddIndex(BackgroundIdx.get());
   }
   if (DynamicIdx)
@@ -154,6 +161,8 @@ void ClangdServer::addDocument(PathRef File, llvm::StringRef Contents,
   Inputs.Opts = std::move(Opts);
   Inputs.Index = Index;
   WorkScheduler.update(File, Inputs, WantDiags);
+  if (BackgroundIdx)
+    BackgroundIdx->boostRelated(File);
 }
 
 void ClangdServer::removeDocument(PathRef File) { WorkScheduler.remove(File); }
@@ -587,6 +596,20 @@ ClangdServer::getUsedBytesPerFile() const {
   return WorkScheduler.getUsedBytesPerFile();
 }
 
+ClangdServer::MemoryUsage ClangdServer::getMemoryUsage() const {
+  MemoryUsage Result;
+  TUScheduler::MemoryUsage Files = WorkScheduler.getMemoryUsage();
+  Result.Preambles = Files.Preambles;
+  Result.ASTCache = Files.ASTCache;
+  if (DynamicIdx)
+    Result.DynamicIndex = DynamicIdx->estimateMemoryUsage();
+  if (BackgroundIdx)
+    Result.BackgroundIndex = BackgroundIdx->estimateMemoryUsage();
+  if (StaticIdx)
+    Result.StaticIndex = StaticIdx->estimateMemoryUsage();
+  return Result;
+}
+
 LLVM_NODISCARD bool
 ClangdServer::blockUntilIdleForTest(llvm::Optional<double> TimeoutSeconds) {
   return WorkScheduler.blockUntilIdle(timeoutSeconds(TimeoutSeconds)) &&
@@ -102,6 +102,9 @@ public:
     /// periodically every BuildIndexPeriodMs milliseconds; otherwise, the
     /// symbol index will be updated for each indexed file.
     size_t BackgroundIndexRebuildPeriodMs = 0;
+    /// If set, the background index loads the shards it does not have from the
+    /// index store written by clang at this path (-index-store-path).
+    std::string IndexStorePath;
 
     /// If set, use this index to augment code completion results.
     SymbolIndex *StaticIndex = nullptr;
@@ -276,11 +279,26 @@ public:
   /// The order of results is unspecified.
   /// Overall memory usage of clangd may be significantly more than reported
   /// here, as this metric does not account (at least) for:
-  ///   - memory occupied by static and dynamic index,
-  ///   - memory required for in-flight requests,
-  /// FIXME: those metrics might be useful too, we should add them.
+  ///   - memory occupied by static and dynamic index (see getMemoryUsage()),
+  ///   - memory required for in-flight requests.
   std::vector<std::pair<Path, std::size_t>> getUsedBytesPerFile() const;
 
+  /// Estimated memory usage of the server, broken down by component.
+  /// Memory required for in-flight requests is not accounted for.
+  struct MemoryUsage {
+    std::size_t Preambles = 0;
+    std::size_t ASTCache = 0;
+    std::size_t DynamicIndex = 0;
+    std::size_t BackgroundIndex = 0;
+    std::size_t StaticIndex = 0;
+
+    std::size_t total() const {
+      return Preambles + ASTCache + DynamicIndex + BackgroundIndex +
+             StaticIndex;
+    }
+  };
+  MemoryUsage getMemoryUsage() const;
+
   // Blocks the main thread until the server is idle. Only for use in tests.
   // Returns false if the timeout expires.
   LLVM_NODISCARD bool
@@ -302,6 +320,8 @@ private:
   //   - the static index passed to the constructor
   //   - a merged view of a static and dynamic index (MergedIndex)
   const SymbolIndex *Index = nullptr;
+  // If present, the static index passed to the constructor. Read via *Index.
+  const SymbolIndex *StaticIdx = nullptr;
   // If present, an index of symbols in open files. Read via *Index.
   std::unique_ptr<FileIndex> DynamicIdx;
   // If present, the new "auto-index" maintained in background threads.
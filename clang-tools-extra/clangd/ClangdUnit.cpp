@@ -41,6 +41,9 @@
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/SmallString.h"
 #include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/ADT/StringSet.h"
+#include "llvm/Support/Path.h"
 #include "llvm/Support/raw_ostream.h"
 #include <algorithm>
 #include <memory>
@@ -294,10 +297,12 @@ ParsedAST::build(std::unique_ptr<CompilerInvocation> CI,
   // to leak memory in clangd.
   CI->getFrontendOpts().DisableFree = false;
   const PrecompiledPreamble *PreamblePCH =
-      Preamble ? &Preamble->Preamble : nullptr;
+      Preamble ? Preamble->Preamble.get() : nullptr;
 
   StoreDiags ASTDiags;
   std::string Content = Buffer->getBuffer();
+  if (Preamble)
+    patchPreamble(*Preamble, Content, *CI);
 
   auto Clang = prepareCompilerInstance(std::move(CI), PreamblePCH,
                                        std::move(Buffer), VFS, ASTDiags);
@@ -534,7 +539,7 @@ const CanonicalIncludes &ParsedAST::getCanonicalIncludes() const {
   return CanonIncludes;
 }
 
-PreambleData::PreambleData(PrecompiledPreamble Preamble,
+PreambleData::PreambleData(std::shared_ptr<const PrecompiledPreamble> Preamble,
                            std::vector<Diag> Diags, IncludeStructure Includes,
                            std::vector<std::string> MainFileMacros,
                            std::unique_ptr<PreambleFileStatusCache> StatCache,
@@ -573,9 +578,7 @@ buildPreamble(PathRef FileName, CompilerInvocation &CI,
       ComputePreambleBounds(*CI.getLangOpts(), ContentsBuffer.get(), 0);
 
   if (OldPreamble &&
-      compileCommandsAreEqual(Inputs.CompileCommand, OldCompileCommand) &&
-      OldPreamble->Preamble.CanReuse(CI, ContentsBuffer.get(), Bounds,
-                                     Inputs.FS.get())) {
+      isPreambleCompatible(*OldPreamble, OldCompileCommand, Inputs, CI)) {
     vlog("Reusing preamble for file {0}", llvm::Twine(FileName));
     return OldPreamble;
   }
@@ -622,7 +625,8 @@ buildPreamble(PathRef FileName, CompilerInvocation &CI,
          FileName);
     std::vector<Diag> Diags = PreambleDiagnostics.take();
     return std::make_shared<PreambleData>(
-        std::move(*BuiltPreamble), std::move(Diags),
+        std::make_shared<PrecompiledPreamble>(std::move(*BuiltPreamble)),
+        std::move(Diags),
         SerializedDeclsCollector.takeIncludes(),
         SerializedDeclsCollector.takeMainFileMacros(), std::move(StatCache),
         SerializedDeclsCollector.takeCanonicalIncludes());
@@ -632,6 +636,189 @@ buildPreamble(PathRef FileName, CompilerInvocation &CI,
   }
 }
 
+bool isPreambleCompatible(const PreambleData &Preamble,
+                          const tooling::CompileCommand &PreambleCommand,
+                          const ParseInputs &Inputs,
+                          const CompilerInvocation &CI) {
+  auto ContentsBuffer = llvm::MemoryBuffer::getMemBuffer(Inputs.Contents);
+  auto Bounds =
+      ComputePreambleBounds(*CI.getLangOpts(), ContentsBuffer.get(), 0);
+  return compileCommandsAreEqual(Inputs.CompileCommand, PreambleCommand) &&
+         Preamble.Preamble->CanReuse(CI, ContentsBuffer.get(), Bounds,
+                                     Inputs.FS.get());
+}
+
+void patchPreamble(const PreambleData &Preamble, llvm::StringRef Contents,
+                   CompilerInvocation &CI) {
+  auto ContentsBuffer = llvm::MemoryBuffer::getMemBuffer(Contents);
+  auto Bounds =
+      ComputePreambleBounds(*CI.getLangOpts(), ContentsBuffer.get(), 0);
+  llvm::StringSet<> Included;
+  for (const Inclusion &Inc : Preamble.Includes.MainFileIncludes)
+    Included.insert(Inc.Written);
+
+  // Find the new #include directives outside of any conditional. This only
+  // looks at whole lines; anything fancier waits for the new preamble.
+  std::string Patch;
+  unsigned Depth = 0;
+  llvm::SmallVector<llvm::StringRef, 32> Lines;
+  Contents.take_front(Bounds.Size).split(Lines, '\n');
+  for (llvm::StringRef Line : Lines) {
+    Line = Line.trim();
+    if (!Line.consume_front("#"))
+      continue;
+    Line = Line.ltrim();
+    if (Line.startswith("if")) {
+      ++Depth;
+    } else if (Line.startswith("endif")) {
+      if (Depth)
+        --Depth;
+    } else if (Depth == 0 && (Line.consume_front("include_next") ||
+                              Line.consume_front("include") ||
+                              Line.consume_front("import"))) {
+      llvm::StringRef Written = Line.trim();
+      if (!Written.startswith("<") && !Written.startswith("\""))
+        continue;
+      size_t End = Written.find_first_of(Written.startswith("<") ? ">" : "\"",
+                                         1);
+      if (End == llvm::StringRef::npos)
+        continue;
+      Written = Written.take_front(End + 1);
+      if (Included.insert(Written).second)
+        Patch += ("#include " + Written + "\n").str();
+    }
+  }
+  if (Patch.empty())
+    return;
+
+  // Put the patch next to the main file so that quoted includes are looked up
+  // the same way.
+  llvm::SmallString<256> PatchPath(llvm::sys::path::parent_path(
+      CI.getFrontendOpts().Inputs[0].getFile()));
+  llvm::sys::path::append(PatchPath, "__preamble_patch__.h");
+  vlog("Patching stale preamble of file {0} with:\n{1}",
+       CI.getFrontendOpts().Inputs[0].getFile(), Patch);
+  auto &PPOpts = CI.getPreprocessorOpts();
+  PPOpts.addRemappedFile(
+      PatchPath,
+      llvm::MemoryBuffer::getMemBufferCopy(Patch, PatchPath).release());
+  PPOpts.Includes.push_back(PatchPath.str());
+}
+
+/// Returns the key under which the preamble of \p Inputs is shared, or None
+/// if it should not be shared.
+static llvm::Optional<FileDigest> preambleKey(PathRef FileName,
+                                              const CompilerInvocation &CI,
+                                              const ParseInputs &Inputs,
+                                              PreambleBounds Bounds) {
+  // Empty preambles are cheap to build and not worth sharing.
+  if (Bounds.Size == 0)
+    return None;
+  // The command of each file names the file itself, and usually an output.
+  // Leave those out so that the files of one target can share a preamble.
+  StringRef MainFileName = CI.getFrontendOpts().Inputs.empty()
+                               ? StringRef()
+                               : CI.getFrontendOpts().Inputs[0].getFile();
+  std::string Key;
+  llvm::raw_string_ostream OS(Key);
+  OS << Inputs.CompileCommand.Directory << '\0';
+  const std::vector<std::string> &Args = Inputs.CompileCommand.CommandLine;
+  for (size_t I = 0; I < Args.size(); ++I) {
+    if (Args[I] == "-o") {
+      ++I;
+      continue;
+    }
+    if (Args[I] == FileName || Args[I] == MainFileName)
+      continue;
+    OS << Args[I] << '\0';
+  }
+  OS << Bounds.PreambleEndsAtStartOfLine << '\0'
+     << Inputs.Contents.substr(0, Bounds.Size);
+  return digest(OS.str());
+}
+
+std::shared_ptr<const PreambleData>
+PreambleStore::lookup(PathRef FileName, const CompilerInvocation &CI,
+                      const ParseInputs &Inputs,
+                      const PreambleData *OldPreamble) {
+  auto ContentsBuffer = llvm::MemoryBuffer::getMemBuffer(Inputs.Contents);
+  auto Bounds =
+      ComputePreambleBounds(*CI.getLangOpts(), ContentsBuffer.get(), 0);
+  auto Key = preambleKey(FileName, CI, Inputs, Bounds);
+  if (!Key || CI.getFrontendOpts().Inputs.empty())
+    return nullptr;
+
+  Entry E;
+  {
+    std::lock_guard<std::mutex> Lock(Mutex);
+    auto It = Entries.find(llvm::toHex(*Key));
+    if (It == Entries.end())
+      return nullptr;
+    E = It->second;
+  }
+  std::shared_ptr<const PreambleData> Shared = E.Preamble.lock();
+  if (!Shared ||
+      (OldPreamble && OldPreamble->Preamble == Shared->Preamble) ||
+      !Shared->Preamble->CanReuse(CI, ContentsBuffer.get(), Bounds,
+                                  Inputs.FS.get()))
+    return nullptr;
+  vlog("Reusing preamble of file {0} for file {1}", E.FileName, FileName);
+
+  // The PCH is the same, but the data collected while building it refers to
+  // the file it was built for.
+  StringRef MainFileName = CI.getFrontendOpts().Inputs[0].getFile();
+  auto RenameMainFile = [&](DiagBase &D) {
+    if (D.File == E.MainFileName)
+      D.File = MainFileName;
+    if (D.AbsFile && *D.AbsFile == E.FileName)
+      D.AbsFile = FileName.str();
+  };
+  std::vector<Diag> Diags = Shared->Diags;
+  for (Diag &D : Diags) {
+    RenameMainFile(D);
+    for (Note &N : D.Notes)
+      RenameMainFile(N);
+  }
+  IncludeStructure Includes = Shared->Includes;
+  Includes.renameFile(E.MainFileName, MainFileName);
+  auto StatCache =
+      Shared->StatCache
+          ? llvm::make_unique<PreambleFileStatusCache>(*Shared->StatCache)
+          : nullptr;
+  auto Result = std::make_shared<PreambleData>(
+      Shared->Preamble, std::move(Diags), std::move(Includes),
+      Shared->MainFileMacros, std::move(StatCache), Shared->CanonIncludes);
+  Result->CompileCommand = Inputs.CompileCommand;
+  return Result;
+}
+
+void PreambleStore::insert(PathRef FileName, const CompilerInvocation &CI,
+                           const ParseInputs &Inputs,
+                           std::shared_ptr<const PreambleData> Preamble) {
+  // Macros defined in the main file would point into the wrong file when
+  // the preamble is used for another one.
+  if (!Preamble || !Preamble->MainFileMacros.empty() ||
+      CI.getFrontendOpts().Inputs.empty())
+    return;
+  auto Key = preambleKey(FileName, CI, Inputs, Preamble->Preamble->getBounds());
+  if (!Key)
+    return;
+
+  Entry E;
+  E.FileName = FileName;
+  E.MainFileName = CI.getFrontendOpts().Inputs[0].getFile();
+  E.Preamble = Preamble;
+  std::lock_guard<std::mutex> Lock(Mutex);
+  // Drop the entries of preambles that are no longer used, while we are here.
+  for (auto It = Entries.begin(); It != Entries.end();) {
+    auto Next = std::next(It);
+    if (It->second.Preamble.expired())
+      Entries.erase(It);
+    It = Next;
+  }
+  Entries[llvm::toHex(*Key)] = std::move(E);
+}
+
 llvm::Optional<ParsedAST>
 buildAST(PathRef FileName, std::unique_ptr<CompilerInvocation> Invocation,
          const ParseInputs &Inputs,
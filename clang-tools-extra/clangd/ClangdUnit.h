@@ -25,7 +25,9 @@
 #include "clang/Tooling/CompilationDatabase.h"
 #include "clang/Tooling/Core/Replacement.h"
 #include "clang/Tooling/Syntax/Tokens.h"
+#include "llvm/ADT/StringMap.h"
 #include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 
@@ -47,14 +49,16 @@ namespace clangd {
 
 // Stores Preamble and associated data.
 struct PreambleData {
-  PreambleData(PrecompiledPreamble Preamble, std::vector<Diag> Diags,
+  PreambleData(std::shared_ptr<const PrecompiledPreamble> Preamble,
+               std::vector<Diag> Diags,
                IncludeStructure Includes,
                std::vector<std::string> MainFileMacros,
                std::unique_ptr<PreambleFileStatusCache> StatCache,
                CanonicalIncludes CanonIncludes);
 
   tooling::CompileCommand CompileCommand;
-  PrecompiledPreamble Preamble;
+  // Shared with the preambles of other files in the same PreambleStore.
+  std::shared_ptr<const PrecompiledPreamble> Preamble;
   std::vector<Diag> Diags;
   // Processes like code completions and go-to-definitions will need #include
   // information, and their compile action skips preamble range.
@@ -169,6 +173,51 @@ buildPreamble(PathRef FileName, CompilerInvocation &CI,
               const ParseInputs &Inputs, bool StoreInMemory,
               PreambleParsedCallback PreambleCallback);
 
+/// Returns true if \p Preamble, built with \p PreambleCommand, can be used as
+/// is for \p Inputs, i.e. buildPreamble() would return it unchanged.
+bool isPreambleCompatible(const PreambleData &Preamble,
+                          const tooling::CompileCommand &PreambleCommand,
+                          const ParseInputs &Inputs,
+                          const CompilerInvocation &CI);
+
+/// Makes \p CI implicitly include the #include directives at the top of
+/// \p Contents that \p Preamble was built without. This lets an AST be built
+/// on top of a stale preamble, e.g. while the new one is being built, without
+/// missing the headers that were just added.
+void patchPreamble(const PreambleData &Preamble, llvm::StringRef Contents,
+                   CompilerInvocation &CI);
+
+/// Shares the preambles of files whose preamble region and compile command
+/// are identical, e.g. sources of one module that start with the same block of
+/// #includes, so that only one PCH is built and kept for all of them.
+/// Only weak references are kept: a preamble is dropped from the store as soon
+/// as no file uses it anymore.
+class PreambleStore {
+public:
+  /// Returns a preamble built for another file that \p FileName can use with
+  /// \p Inputs, or null if there is none. \p OldPreamble is the preamble
+  /// currently used by \p FileName, if any; it is never returned.
+  std::shared_ptr<const PreambleData>
+  lookup(PathRef FileName, const CompilerInvocation &CI,
+         const ParseInputs &Inputs, const PreambleData *OldPreamble);
+
+  /// Makes \p Preamble, just built for \p FileName, available to other files.
+  void insert(PathRef FileName, const CompilerInvocation &CI,
+              const ParseInputs &Inputs,
+              std::shared_ptr<const PreambleData> Preamble);
+
+private:
+  struct Entry {
+    // The file the preamble was built for, and its name inside clang.
+    std::string FileName;
+    std::string MainFileName;
+    std::weak_ptr<const PreambleData> Preamble;
+  };
+
+  std::mutex Mutex;
+  llvm::StringMap<Entry> Entries; // Keyed by preamble contents and command.
+};
+
 /// Build an AST from provided user inputs. This function does not check if
 /// preamble can be reused, as this function expects that \p Preamble is the
 /// result of calling buildPreamble.
@@ -111,5 +111,59 @@ PreambleFileStatusCache::getConsumingFS(
   return llvm::IntrusiveRefCntPtr<CacheVFS>(new CacheVFS(std::move(FS), *this));
 }
 
+llvm::IntrusiveRefCntPtr<llvm::vfs::FileSystem>
+withOwnWorkingDirectory(llvm::IntrusiveRefCntPtr<llvm::vfs::FileSystem> FS) {
+  class OwnCWDFS : public llvm::vfs::FileSystem {
+  public:
+    OwnCWDFS(llvm::IntrusiveRefCntPtr<llvm::vfs::FileSystem> FS)
+        : FS(std::move(FS)) {
+      if (auto CWD = this->FS->getCurrentWorkingDirectory())
+        WorkingDirectory = std::move(*CWD);
+    }
+
+    llvm::ErrorOr<llvm::vfs::Status> status(const llvm::Twine &Path) override {
+      return FS->status(absolute(Path));
+    }
+    llvm::ErrorOr<std::unique_ptr<llvm::vfs::File>>
+    openFileForRead(const llvm::Twine &Path) override {
+      return FS->openFileForRead(absolute(Path));
+    }
+    llvm::vfs::directory_iterator dir_begin(const llvm::Twine &Dir,
+                                            std::error_code &EC) override {
+      return FS->dir_begin(absolute(Dir), EC);
+    }
+    std::error_code
+    getRealPath(const llvm::Twine &Path,
+                llvm::SmallVectorImpl<char> &Output) const override {
+      return FS->getRealPath(absolute(Path), Output);
+    }
+    std::error_code isLocal(const llvm::Twine &Path, bool &Result) override {
+      return FS->isLocal(absolute(Path), Result);
+    }
+
+    llvm::ErrorOr<std::string> getCurrentWorkingDirectory() const override {
+      return WorkingDirectory;
+    }
+    std::error_code
+    setCurrentWorkingDirectory(const llvm::Twine &Path) override {
+      WorkingDirectory = absolute(Path);
+      return {};
+    }
+
+  private:
+    std::string absolute(const llvm::Twine &Path) const {
+      llvm::SmallString<256> Result;
+      Path.toVector(Result);
+      if (!llvm::sys::path::is_absolute(Result))
+        llvm::sys::fs::make_absolute(WorkingDirectory, Result);
+      return Result.str();
+    }
+
+    llvm::IntrusiveRefCntPtr<llvm::vfs::FileSystem> FS;
+    std::string WorkingDirectory;
+  };
+  return llvm::IntrusiveRefCntPtr<OwnCWDFS>(new OwnCWDFS(std::move(FS)));
+}
+
 } // namespace clangd
 } // namespace clang
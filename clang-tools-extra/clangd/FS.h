@@ -65,6 +65,13 @@ private:
   llvm::StringMap<llvm::vfs::Status> StatCache;
 };
 
+/// Returns a VFS that reads through \p FS but keeps a working directory of
+/// its own, starting with the current one of \p FS. Only absolute paths are
+/// passed down, so it can be used on another thread than \p FS as long as
+/// reading \p FS concurrently is safe.
+IntrusiveRefCntPtr<llvm::vfs::FileSystem>
+withOwnWorkingDirectory(IntrusiveRefCntPtr<llvm::vfs::FileSystem> FS);
+
 } // namespace clangd
 } // namespace clang
 
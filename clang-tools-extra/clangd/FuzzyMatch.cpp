@@ -185,16 +185,18 @@ bool FuzzyMatcher::init(llvm::StringRef NewWord) {
   std::copy(NewWord.begin(), NewWord.begin() + WordN, Word);
   if (PatN == 0)
     return true;
-  for (int I = 0; I < WordN; ++I)
-    LowWord[I] = lower(Word[I]);
 
-  // Cheap subsequence check.
+  // Cheap subsequence check. Most words are rejected here, so it runs before
+  // any other per-word work. It also finds the earliest position at which
+  // each pattern character can be matched, which bounds buildGraph().
   for (int W = 0, P = 0; P != PatN; ++W) {
     if (W == WordN)
       return false;
-    if (LowWord[W] == LowPat[P])
-      ++P;
+    if (lower(Word[W]) == LowPat[P])
+      FirstMatch[P++] = W;
   }
+  for (int I = 0; I < WordN; ++I)
+    LowWord[I] = lower(Word[I]);
 
   // FIXME: some words are hard to tokenize algorithmically.
   // e.g. vsprintf is V S Print F, and should match [pri] but not [int].
@@ -220,7 +222,11 @@ void FuzzyMatcher::buildGraph() {
     Scores[0][W + 1][Match] = {AwfulScore, Miss};
   }
   for (int P = 0; P < PatN; ++P) {
-    for (int W = P; W < WordN; ++W) {
+    // Pat[..P] can't fit in Word[..W] before Pat[P] can first be matched.
+    for (int W = P; W < FirstMatch[P]; ++W)
+      for (Action A : {Miss, Match})
+        Scores[P + 1][W + 1][A] = {AwfulScore, Miss};
+    for (int W = FirstMatch[P]; W < WordN; ++W) {
       auto &Score = Scores[P + 1][W + 1], &PreMiss = Scores[P + 1][W];
 
       auto MatchMissScore = PreMiss[Match].Score;
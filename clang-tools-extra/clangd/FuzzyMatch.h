@@ -119,6 +119,7 @@ private:
   CharRole WordRole[MaxWord]; // Word segmentation info
   CharTypeSet WordTypeSet;    // Bitmask of 1<<CharType for all Word characters
   bool WordContainsPattern;   // Simple substring check
+  int FirstMatch[MaxPat];     // Earliest Word index each Pat char can match
 
   // Cumulative best-match score table.
   // Boundary conditions are filled in by the constructor.
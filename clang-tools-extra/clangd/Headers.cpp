@@ -125,6 +125,15 @@ void IncludeStructure::recordInclude(llvm::StringRef IncludingName,
   IncludeChildren[Parent].push_back(Child);
 }
 
+void IncludeStructure::renameFile(llvm::StringRef From, llvm::StringRef To) {
+  auto It = NameToIndex.find(From);
+  if (It == NameToIndex.end() || From == To)
+    return;
+  unsigned Index = It->getValue();
+  NameToIndex.erase(It);
+  NameToIndex[To] = Index;
+}
+
 unsigned IncludeStructure::fileIndex(llvm::StringRef Name) {
   auto R = NameToIndex.try_emplace(Name, RealPathNames.size());
   if (R.second)
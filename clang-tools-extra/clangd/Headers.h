@@ -122,6 +122,10 @@ public:
                      llvm::StringRef IncludedName,
                      llvm::StringRef IncludedRealName);
 
+  // Makes the includes recorded for the file named \p From belong to \p To,
+  // e.g. when a preamble is reused for a different main file.
+  void renameFile(llvm::StringRef From, llvm::StringRef To);
+
 private:
   // Identifying files in a way that persists from preamble build to subsequent
   // builds is surprisingly hard. FileID is unavailable in InclusionDirective(),
@@ -44,12 +44,14 @@
 #include "TUScheduler.h"
 #include "Cancellation.h"
 #include "Compiler.h"
+#include "FS.h"
 #include "GlobalCompilationDatabase.h"
 #include "Logger.h"
 #include "Trace.h"
 #include "index/CanonicalIncludes.h"
 #include "clang/Frontend/CompilerInvocation.h"
 #include "clang/Tooling/CompilationDatabase.h"
+#include "llvm/ADT/DenseSet.h"
 #include "llvm/ADT/Optional.h"
 #include "llvm/ADT/ScopeExit.h"
 #include "llvm/Support/Errc.h"
@@ -160,7 +162,7 @@ class ASTWorker {
   ASTWorker(PathRef FileName, const GlobalCompilationDatabase &CDB,
             TUScheduler::ASTCache &LRUCache, Semaphore &Barrier, bool RunSync,
             steady_clock::duration UpdateDebounce, bool StorePreamblesInMemory,
-            ParsingCallbacks &Callbacks);
+            PreambleStore &Preambles, ParsingCallbacks &Callbacks);
 
 public:
   /// Create a new ASTWorker and return a handle to it.
@@ -172,7 +174,8 @@ public:
   create(PathRef FileName, const GlobalCompilationDatabase &CDB,
          TUScheduler::ASTCache &IdleASTs, AsyncTaskRunner *Tasks,
          Semaphore &Barrier, steady_clock::duration UpdateDebounce,
-         bool StorePreamblesInMemory, ParsingCallbacks &Callbacks);
+         bool StorePreamblesInMemory, PreambleStore &Preambles,
+         ParsingCallbacks &Callbacks);
   ~ASTWorker();
 
   void update(ParseInputs Inputs, WantDiagnostics);
@@ -197,6 +200,7 @@ public:
   void waitForFirstPreamble() const;
 
   std::size_t getUsedBytes() const;
+  std::size_t getCachedASTBytes() const;
   bool isASTCached() const;
 
 private:
@@ -209,6 +213,19 @@ private:
   /// Adds a new task to the end of the request queue.
   void startTask(llvm::StringRef Name, llvm::unique_function<void()> Task,
                  llvm::Optional<WantDiagnostics> UpdateType);
+  /// Returns the task that rebuilds the preamble and the AST for \p Inputs.
+  llvm::unique_function<void()> updateTask(ParseInputs Inputs,
+                                           WantDiagnostics WantDiags);
+  /// Starts building the preamble for \p Inputs on a separate thread, unless
+  /// a build is already running. \p StalePreamble is used in the meantime.
+  void buildPreambleInBackground(
+      const ParseInputs &Inputs, const CompilerInvocation &CI,
+      std::shared_ptr<const PreambleData> StalePreamble);
+  /// Called on the worker thread when a background preamble build is done.
+  void onPreambleBuilt(std::shared_ptr<const PreambleData> Built,
+                       std::shared_ptr<const PreambleData> Stale,
+                       const ParseInputs &BuildInputs,
+                       const CompilerInvocation &BuildCI);
   /// Updates the TUStatus and emits it. Only called in the worker thread.
   void emitTUStatus(TUAction FAction,
                     const TUStatus::BuildDetails *Detail = nullptr);
@@ -225,6 +242,9 @@ private:
   /// interface.
   std::shared_ptr<const ParseInputs> getCurrentFileInputs() const;
 
+  using PreambleCallback =
+      llvm::unique_function<void(std::shared_ptr<const PreambleData>)>;
+
   struct Request {
     llvm::unique_function<void()> Action;
     std::string Name;
@@ -243,6 +263,8 @@ private:
   const GlobalCompilationDatabase &CDB;
   /// Whether to keep the built preambles in memory or on disk.
   const bool StorePreambleInMemory;
+  /// Preambles shared with the other files of the TUScheduler.
+  PreambleStore &Preambles;
   /// Callback invoked when preamble or main file AST is built.
   ParsingCallbacks &Callbacks;
   /// Only accessed by the worker thread.
@@ -274,6 +296,13 @@ private:
   // don't. When the old handle is destroyed, the old worker will stop reporting
   // diagnostics.
   bool ReportDiagnostics = true; /* GUARDED_BY(DiagsMu) */
+  /// Whether a preamble is being built in the background.
+  bool BuildingPreamble = false; /* GUARDED_BY(Mutex) */
+  /// Reads of the current preamble waiting for the background build.
+  std::vector<PreambleCallback> PendingPreambleReads; /* GUARDED_BY(Mutex) */
+  /// Runs the background preamble builds. Declared last so that a running
+  /// build finishes before the members it uses are destroyed.
+  AsyncTaskRunner PreambleBuilds;
 };
 
 /// A smart-pointer-like class that points to an active ASTWorker.
@@ -322,10 +351,11 @@ ASTWorkerHandle
 ASTWorker::create(PathRef FileName, const GlobalCompilationDatabase &CDB,
                   TUScheduler::ASTCache &IdleASTs, AsyncTaskRunner *Tasks,
                   Semaphore &Barrier, steady_clock::duration UpdateDebounce,
-                  bool StorePreamblesInMemory, ParsingCallbacks &Callbacks) {
-  std::shared_ptr<ASTWorker> Worker(
-      new ASTWorker(FileName, CDB, IdleASTs, Barrier, /*RunSync=*/!Tasks,
-                    UpdateDebounce, StorePreamblesInMemory, Callbacks));
+                  bool StorePreamblesInMemory, PreambleStore &Preambles,
+                  ParsingCallbacks &Callbacks) {
+  std::shared_ptr<ASTWorker> Worker(new ASTWorker(
+      FileName, CDB, IdleASTs, Barrier, /*RunSync=*/!Tasks, UpdateDebounce,
+      StorePreamblesInMemory, Preambles, Callbacks));
   if (Tasks)
     Tasks->runAsync("worker:" + llvm::sys::path::filename(FileName),
                     [Worker]() { Worker->run(); });
@@ -336,10 +366,11 @@ ASTWorker::create(PathRef FileName, const GlobalCompilationDatabase &CDB,
 ASTWorker::ASTWorker(PathRef FileName, const GlobalCompilationDatabase &CDB,
                      TUScheduler::ASTCache &LRUCache, Semaphore &Barrier,
                      bool RunSync, steady_clock::duration UpdateDebounce,
-                     bool StorePreamblesInMemory, ParsingCallbacks &Callbacks)
+                     bool StorePreamblesInMemory, PreambleStore &Preambles,
+                     ParsingCallbacks &Callbacks)
     : IdleASTs(LRUCache), RunSync(RunSync), UpdateDebounce(UpdateDebounce),
       FileName(FileName), CDB(CDB),
-      StorePreambleInMemory(StorePreamblesInMemory),
+      StorePreambleInMemory(StorePreamblesInMemory), Preambles(Preambles),
       Callbacks(Callbacks), Status{TUAction(TUAction::Idle, ""),
                                    TUStatus::BuildDetails()},
       Barrier(Barrier), Done(false) {
@@ -362,8 +393,13 @@ ASTWorker::~ASTWorker() {
 }
 
 void ASTWorker::update(ParseInputs Inputs, WantDiagnostics WantDiags) {
+  startTask("Update", updateTask(std::move(Inputs), WantDiags), WantDiags);
+}
+
+llvm::unique_function<void()>
+ASTWorker::updateTask(ParseInputs Inputs, WantDiagnostics WantDiags) {
   llvm::StringRef TaskName = "Update";
-  auto Task = [=]() mutable {
+  return [=]() mutable {
     // Get the actual command as `Inputs` does not have a command.
     // FIXME: some build systems like Bazel will take time to preparing
     // environment to build the file, it would be nice if we could emit a
@@ -410,13 +446,36 @@ void ASTWorker::update(ParseInputs Inputs, WantDiagnostics WantDiags) {
 
     std::shared_ptr<const PreambleData> OldPreamble =
         getPossiblyStalePreamble();
-    std::shared_ptr<const PreambleData> NewPreamble = buildPreamble(
-        FileName, *Invocation, OldPreamble, OldCommand, Inputs,
-        StorePreambleInMemory,
-        [this](ASTContext &Ctx, std::shared_ptr<clang::Preprocessor> PP,
-               const CanonicalIncludes &CanonIncludes) {
-          Callbacks.onPreambleAST(FileName, Ctx, std::move(PP), CanonIncludes);
-        });
+    std::shared_ptr<const PreambleData> NewPreamble;
+    if (OldPreamble &&
+        isPreambleCompatible(*OldPreamble, OldCommand, Inputs, *Invocation)) {
+      vlog("Reusing preamble for file {0}", FileName);
+      NewPreamble = OldPreamble;
+    } else {
+      // Another open file may have built a preamble that fits this one.
+      NewPreamble =
+          Preambles.lookup(FileName, *Invocation, Inputs, OldPreamble.get());
+    }
+    if (!NewPreamble && OldPreamble && !RunSync &&
+        Inputs.CompileCommand == OldCommand) {
+      // Only the preamble region changed, e.g. an #include was added. Building
+      // the new preamble can take long, so keep serving the file from the old
+      // one, patched with the new includes, while it builds in the background.
+      buildPreambleInBackground(Inputs, *Invocation, OldPreamble);
+      NewPreamble = OldPreamble;
+    }
+    if (!NewPreamble) {
+      NewPreamble = buildPreamble(
+          FileName, *Invocation, /*OldPreamble=*/nullptr, OldCommand, Inputs,
+          StorePreambleInMemory,
+          [this](ASTContext &Ctx, std::shared_ptr<clang::Preprocessor> PP,
+                 const CanonicalIncludes &CanonIncludes) {
+            Callbacks.onPreambleAST(FileName, Ctx, std::move(PP),
+                                    CanonIncludes);
+          });
+    }
+    if (NewPreamble != OldPreamble)
+      Preambles.insert(FileName, *Invocation, Inputs, NewPreamble);
 
     bool CanReuseAST = InputsAreTheSame && (OldPreamble == NewPreamble);
     {
@@ -498,7 +557,92 @@ void ASTWorker::update(ParseInputs Inputs, WantDiagnostics WantDiags) {
     // Stash the AST in the cache for further use.
     IdleASTs.put(this, std::move(*AST));
   };
-  startTask(TaskName, std::move(Task), WantDiags);
+}
+
+void ASTWorker::buildPreambleInBackground(
+    const ParseInputs &Inputs, const CompilerInvocation &CI,
+    std::shared_ptr<const PreambleData> StalePreamble) {
+  {
+    std::lock_guard<std::mutex> Lock(Mutex);
+    // The running build picks up the latest inputs once it is done.
+    if (BuildingPreamble)
+      return;
+    BuildingPreamble = true;
+  }
+  // Reads of the current inputs keep using their file system, so give the
+  // build a working directory of its own.
+  ParseInputs BuildInputs = Inputs;
+  BuildInputs.FS = withOwnWorkingDirectory(Inputs.FS);
+  auto BuildCI = std::make_shared<CompilerInvocation>(CI);
+  auto Task = [this, BuildInputs, BuildCI, StalePreamble]() {
+    std::shared_ptr<const PreambleData> Built;
+    {
+      std::lock_guard<Semaphore> BarrierLock(Barrier);
+      Built = buildPreamble(
+          FileName, *BuildCI, /*OldPreamble=*/nullptr,
+          BuildInputs.CompileCommand, BuildInputs, StorePreambleInMemory,
+          [this](ASTContext &Ctx, std::shared_ptr<clang::Preprocessor> PP,
+                 const CanonicalIncludes &CanonIncludes) {
+            Callbacks.onPreambleAST(FileName, Ctx, std::move(PP),
+                                    CanonIncludes);
+          });
+    }
+
+    std::vector<PreambleCallback> Reads;
+    {
+      std::lock_guard<std::mutex> Lock(Mutex);
+      BuildingPreamble = false;
+      if (Done) {
+        Reads = std::move(PendingPreambleReads);
+      } else {
+        Requests.push_back(
+            {Bind(
+                 [this, BuildInputs, BuildCI,
+                  StalePreamble](std::shared_ptr<const PreambleData> Built) {
+                   onPreambleBuilt(std::move(Built), StalePreamble,
+                                   BuildInputs, *BuildCI);
+                 },
+                 std::move(Built)),
+             "PreambleBuilt", steady_clock::now(),
+             Context::current().derive(kFileBeingProcessed, FileName),
+             /*UpdateType=*/None});
+      }
+    }
+    RequestsCV.notify_all();
+    for (PreambleCallback &Read : Reads)
+      Read(Built ? Built : StalePreamble);
+  };
+  PreambleBuilds.runAsync("preamble:" + llvm::sys::path::filename(FileName),
+                          std::move(Task));
+}
+
+void ASTWorker::onPreambleBuilt(std::shared_ptr<const PreambleData> Built,
+                                std::shared_ptr<const PreambleData> Stale,
+                                const ParseInputs &BuildInputs,
+                                const CompilerInvocation &BuildCI) {
+  std::vector<PreambleCallback> Reads;
+  bool Installed = false;
+  {
+    std::lock_guard<std::mutex> Lock(Mutex);
+    // A preamble built synchronously in the meantime is more recent.
+    if (Built && LastBuiltPreamble == Stale) {
+      LastBuiltPreamble = Built;
+      Installed = true;
+    }
+    Reads = std::move(PendingPreambleReads);
+  }
+  std::shared_ptr<const PreambleData> Current = getPossiblyStalePreamble();
+  for (PreambleCallback &Read : Reads)
+    Read(Current);
+  if (!Installed)
+    return;
+  Preambles.insert(FileName, BuildCI, BuildInputs, Built);
+
+  // Replace the AST built on the stale preamble. The inputs may have changed
+  // since the build started, in which case this starts another one.
+  IdleASTs.take(this);
+  DiagsWereReported = false;
+  updateTask(*getCurrentFileInputs(), WantDiagnostics::Auto)();
 }
 
 void ASTWorker::runWithAST(
@@ -549,8 +693,13 @@ void ASTWorker::getCurrentPreamble(
   auto LastUpdate =
       std::find_if(Requests.rbegin(), Requests.rend(),
                    [](const Request &R) { return R.UpdateType.hasValue(); });
-  // If there were no writes in the queue, the preamble is ready now.
+  // If there were no writes in the queue, the preamble is ready now, unless
+  // it is still being built in the background.
   if (LastUpdate == Requests.rend()) {
+    if (BuildingPreamble) {
+      PendingPreambleReads.push_back(std::move(Callback));
+      return;
+    }
     Lock.unlock();
     return Callback(getPossiblyStalePreamble());
   }
@@ -558,6 +707,13 @@ void ASTWorker::getCurrentPreamble(
   Requests.insert(LastUpdate.base(),
                   Request{Bind(
                               [this](decltype(Callback) Callback) {
+                                std::unique_lock<std::mutex> Lock(Mutex);
+                                if (BuildingPreamble) {
+                                  PendingPreambleReads.push_back(
+                                      std::move(Callback));
+                                  return;
+                                }
+                                Lock.unlock();
                                 Callback(getPossiblyStalePreamble());
                               },
                               std::move(Callback)),
@@ -586,10 +742,14 @@ std::size_t ASTWorker::getUsedBytes() const {
   // only, so this should be fine.
   std::size_t Result = IdleASTs.getUsedBytes(this);
   if (auto Preamble = getPossiblyStalePreamble())
-    Result += Preamble->Preamble.getSize();
+    Result += Preamble->Preamble->getSize();
   return Result;
 }
 
+std::size_t ASTWorker::getCachedASTBytes() const {
+  return IdleASTs.getUsedBytes(this);
+}
+
 bool ASTWorker::isASTCached() const { return IdleASTs.getUsedBytes(this) != 0; }
 
 void ASTWorker::stop() {
@@ -766,7 +926,8 @@ bool ASTWorker::shouldSkipHeadLocked() const {
 
 bool ASTWorker::blockUntilIdle(Deadline Timeout) const {
   std::unique_lock<std::mutex> Lock(Mutex);
-  return wait(Lock, RequestsCV, Timeout, [&] { return Requests.empty(); });
+  return wait(Lock, RequestsCV, Timeout,
+              [&] { return Requests.empty() && !BuildingPreamble; });
 }
 
 // Render a TUAction to a user-facing string representation.
@@ -868,7 +1029,7 @@ void TUScheduler::update(PathRef File, ParseInputs Inputs,
     ASTWorkerHandle Worker = ASTWorker::create(
         File, CDB, *IdleASTs,
         WorkerThreads ? WorkerThreads.getPointer() : nullptr, Barrier,
-        UpdateDebounce, StorePreamblesInMemory, *Callbacks);
+        UpdateDebounce, StorePreamblesInMemory, Preambles, *Callbacks);
     FD = std::unique_ptr<FileData>(
         new FileData{Inputs.Contents, std::move(Worker)});
   } else {
@@ -992,6 +1153,19 @@ TUScheduler::getUsedBytesPerFile() const {
   return Result;
 }
 
+TUScheduler::MemoryUsage TUScheduler::getMemoryUsage() const {
+  MemoryUsage Result;
+  llvm::DenseSet<const PrecompiledPreamble *> SeenPreambles;
+  for (auto &&PathAndFile : Files) {
+    const ASTWorker &Worker = *PathAndFile.second->Worker;
+    Result.ASTCache += Worker.getCachedASTBytes();
+    if (auto Preamble = Worker.getPossiblyStalePreamble())
+      if (SeenPreambles.insert(Preamble->Preamble.get()).second)
+        Result.Preambles += Preamble->Preamble->getSize();
+  }
+  return Result;
+}
+
 std::vector<Path> TUScheduler::getFilesWithCachedAST() const {
   std::vector<Path> Result;
   for (auto &&PathAndFile : Files) {
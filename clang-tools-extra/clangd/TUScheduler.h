@@ -137,6 +137,14 @@ public:
   /// The order of results is unspecified.
   std::vector<std::pair<Path, std::size_t>> getUsedBytesPerFile() const;
 
+  /// Estimated memory used by the preambles and the cached ASTs of all open
+  /// files. Preambles shared by several files are counted once.
+  struct MemoryUsage {
+    std::size_t Preambles = 0;
+    std::size_t ASTCache = 0;
+  };
+  MemoryUsage getMemoryUsage() const;
+
   /// Returns a list of files with ASTs currently stored in memory. This method
   /// is not very reliable and is only used for test. E.g., the results will not
   /// contain files that currently run something over their AST.
@@ -230,6 +238,7 @@ private:
   Semaphore Barrier;
   llvm::StringMap<std::unique_ptr<FileData>> Files;
   std::unique_ptr<ASTCache> IdleASTs;
+  PreambleStore Preambles;
   // None when running tasks synchronously and non-None when running tasks
   // asynchronously.
   llvm::Optional<AsyncTaskRunner> PreambleTasks;
@@ -0,0 +1,56 @@
+//===--- FuzzyMatchBenchmark.cpp - FuzzyMatcher benchmarks ------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "../FuzzyMatch.h"
+#include "benchmark/benchmark.h"
+#include "llvm/ADT/STLExtras.h"
+#include <random>
+#include <string>
+#include <vector>
+
+namespace clang {
+namespace clangd {
+namespace {
+
+// Identifiers built from common segments, roughly like the ones found in a
+// large index.
+std::vector<std::string> generateWords(size_t N) {
+  static const char *Segments[] = {"get",    "set",  "Buffer", "_",
+                                   "Symbol", "ptr",  "Index",  "unique",
+                                   "Map",    "size", "HTTP",   "Request",
+                                   "parse",  "from", "to",     "String"};
+  std::mt19937 Rand(42);
+  std::vector<std::string> Words;
+  for (size_t I = 0; I < N; ++I) {
+    std::string Word;
+    for (unsigned J = 0, E = 1 + Rand() % 5; J < E; ++J)
+      Word += Segments[Rand() % llvm::array_lengthof(Segments)];
+    Words.push_back(std::move(Word));
+  }
+  return Words;
+}
+
+// Scores a pattern against many words, as code completion does per keystroke.
+static void matchWords(benchmark::State &State, const char *Pattern) {
+  const auto Words = generateWords(10000);
+  FuzzyMatcher Matcher(Pattern);
+  for (auto _ : State)
+    for (const auto &Word : Words)
+      benchmark::DoNotOptimize(Matcher.match(Word));
+  State.SetItemsProcessed(State.iterations() * Words.size());
+}
+BENCHMARK_CAPTURE(matchWords, Short, "gs");
+BENCHMARK_CAPTURE(matchWords, Prefix, "getBuf");
+BENCHMARK_CAPTURE(matchWords, Scattered, "sybfrq");
+BENCHMARK_CAPTURE(matchWords, Rare, "xyz");
+
+} // namespace
+} // namespace clangd
+} // namespace clang
+
+BENCHMARK_MAIN();
@@ -173,8 +173,10 @@ void BackgroundIndex::run() {
         return;
       }
       ++NumActiveTasks;
-      std::tie(Task, Priority) = std::move(Queue.front());
-      Queue.pop_front();
+      std::pop_heap(Queue.begin(), Queue.end(), runsAfter);
+      Task = std::move(Queue.back().Run);
+      Priority = Queue.back().Priority;
+      Queue.pop_back();
     }
 
     if (Priority != llvm::ThreadPriority::Default && !PreventStarvation.load())
@@ -207,8 +209,27 @@ void BackgroundIndex::enqueue(const std::vector<std::string> &ChangedFiles) {
         log("Enqueueing {0} commands for indexing", ChangedFiles.size());
         SPAN_ATTACH(Tracer, "files", int64_t(ChangedFiles.size()));
 
-        auto NeedsReIndexing = loadShards(std::move(ChangedFiles));
-        // Run indexing for files that need to be updated.
+        // Load the shards closest to the boosted files first, so that their
+        // symbols become available early.
+        std::vector<std::pair<unsigned, std::string>> ByCost;
+        {
+          std::lock_guard<std::mutex> Lock(QueueMu);
+          for (const std::string &File : ChangedFiles)
+            ByCost.emplace_back(costLocked(File), File);
+        }
+        std::stable_sort(ByCost.begin(), ByCost.end(),
+                         [](const std::pair<unsigned, std::string> &L,
+                            const std::pair<unsigned, std::string> &R) {
+                           return L.first < R.first;
+                         });
+        std::vector<std::string> Files;
+        for (auto &Elem : ByCost)
+          Files.push_back(std::move(Elem.second));
+
+        auto NeedsReIndexing = loadShards(std::move(Files));
+        // Run indexing for files that need to be updated. The queue orders
+        // them by proximity to the boosted files; shuffling spreads the rest
+        // over the project.
         std::shuffle(NeedsReIndexing.begin(), NeedsReIndexing.end(),
                      std::mt19937(std::random_device{}()));
         for (auto &Elem : NeedsReIndexing)
@@ -219,6 +240,7 @@ void BackgroundIndex::enqueue(const std::vector<std::string> &ChangedFiles) {
 
 void BackgroundIndex::enqueue(tooling::CompileCommand Cmd,
                               BackgroundIndexStorage *Storage) {
+  std::string Path = getAbsolutePath(Cmd).str();
   enqueueTask(Bind(
                   [this, Storage](tooling::CompileCommand Cmd) {
                     // We can't use llvm::StringRef here since we are going to
@@ -229,28 +251,49 @@ void BackgroundIndex::enqueue(tooling::CompileCommand Cmd,
                            std::move(Error));
                   },
                   std::move(Cmd)),
-              llvm::ThreadPriority::Background);
+              llvm::ThreadPriority::Background, Path);
 }
 
-void BackgroundIndex::enqueueTask(Task T, llvm::ThreadPriority Priority) {
+bool BackgroundIndex::runsAfter(const QueuedTask &L, const QueuedTask &R) {
+  // Tasks with Normal priority are pretty rare (loading shards) and always run
+  // before any indexing.
+  bool LIsDefault = L.Priority == llvm::ThreadPriority::Default;
+  bool RIsDefault = R.Priority == llvm::ThreadPriority::Default;
+  if (LIsDefault != RIsDefault)
+    return RIsDefault;
+  return std::tie(L.Cost, L.Seq) > std::tie(R.Cost, R.Seq);
+}
+
+unsigned BackgroundIndex::costLocked(llvm::StringRef Path) {
+  if (Path.empty() || BoostedFiles.empty())
+    return FileDistance::Unreachable;
+  if (!Distance)
+    Distance.emplace(BoostedFiles);
+  return Distance->distance(Path);
+}
+
+void BackgroundIndex::enqueueTask(Task T, llvm::ThreadPriority Priority,
+                                  llvm::StringRef Path) {
   {
     std::lock_guard<std::mutex> Lock(QueueMu);
-    auto I = Queue.end();
-    // We first store the tasks with Normal priority in the front of the queue.
-    // Then we store low priority tasks. Normal priority tasks are pretty rare,
-    // they should not grow beyond single-digit numbers, so it is OK to do
-    // linear search and insert after that.
-    if (Priority == llvm::ThreadPriority::Default) {
-      I = llvm::find_if(
-          Queue, [](const std::pair<Task, llvm::ThreadPriority> &Elem) {
-            return Elem.second == llvm::ThreadPriority::Background;
-          });
-    }
-    Queue.insert(I, {std::move(T), Priority});
+    Queue.push_back(
+        {std::move(T), Priority, Path, costLocked(Path), NextSeq++});
+    std::push_heap(Queue.begin(), Queue.end(), runsAfter);
   }
   QueueCV.notify_all();
 }
 
+void BackgroundIndex::boostRelated(llvm::StringRef Path) {
+  std::lock_guard<std::mutex> Lock(QueueMu);
+  if (!BoostedFiles.try_emplace(Path).second)
+    return;
+  // Distances change for every queued file, so recompute them and re-heapify.
+  Distance.reset();
+  for (QueuedTask &T : Queue)
+    T.Cost = costLocked(T.Path);
+  std::make_heap(Queue.begin(), Queue.end(), runsAfter);
+}
+
 /// Given index results from a TU, only update symbols coming from files that
 /// are different or missing from than \p ShardVersionsSnapshot. Also stores new
 /// index information on IndexStorage.
@@ -644,6 +687,12 @@ BackgroundIndex::loadShards(std::vector<std::string> ChangedFiles) {
   // Keeps track of the loaded shards to make sure we don't perform redundant
   // disk IO. Keys are absolute paths.
   llvm::StringSet<> LoadedShards;
+  // Publish the shards loaded so far whenever this many TUs have been loaded,
+  // so that the index (and notably the files loaded first) can be queried
+  // before all shards are read. Doubling the period keeps the total cost of
+  // rebuilding linear in the number of TUs.
+  size_t NextPublish = 16;
+  size_t LoadedTUs = 0;
   for (const auto &File : ChangedFiles) {
     ProjectInfo PI;
     auto Cmd = CDB.getCompileCommand(File, &PI);
@@ -651,6 +700,14 @@ BackgroundIndex::loadShards(std::vector<std::string> ChangedFiles) {
       continue;
     BackgroundIndexStorage *IndexStorage = IndexStorageFactory(PI.SourceRoot);
     auto Dependencies = loadShard(*Cmd, IndexStorage, LoadedShards);
+    if (++LoadedTUs == NextPublish) {
+      NextPublish *= 2;
+      if (BuildIndexPeriodMs > 0)
+        SymbolsUpdatedSinceLastIndex = true;
+      else
+        reset(IndexedSymbols.buildIndex(IndexType::Light,
+                                        DuplicateHandling::Merge));
+    }
     for (const auto &Dependency : Dependencies) {
       if (!Dependency.NeedsReIndexing || FilesToIndex.count(Dependency.Path))
         continue;
@@ -11,6 +11,7 @@
 
 #include "Context.h"
 #include "FSProvider.h"
+#include "FileDistance.h"
 #include "GlobalCompilationDatabase.h"
 #include "SourceCode.h"
 #include "Threading.h"
@@ -23,7 +24,6 @@
 #include "llvm/Support/Threading.h"
 #include <atomic>
 #include <condition_variable>
-#include <deque>
 #include <mutex>
 #include <string>
 #include <thread>
@@ -57,11 +57,18 @@ public:
   // Creates an Index Storage that saves shards into disk. Index storage uses
   // CDBDirectory + ".clangd/index/" as the folder to save shards.
   static Factory createDiskBackedStorageFactory();
+
+  // Creates an Index Storage that loads the shards missing from the storages of
+  // \p Storages from the index store written by clang at \p IndexStorePath,
+  // and saves shards into the storages of \p Storages.
+  static Factory createIndexStoreBackedStorageFactory(std::string IndexStorePath,
+                                                      Factory Storages);
 };
 
 // Builds an in-memory index by by running the static indexer action over
 // all commands in a compilation database. Indexing happens in the background.
-// FIXME: it should also persist its state on disk for fast start.
+// Files close to the ones open in the editor are indexed first, and shards
+// loaded from disk become queryable before all of them have been read.
 // FIXME: it should watch for changes to files on disk.
 class BackgroundIndex : public SwapIndex {
 public:
@@ -81,6 +88,10 @@ public:
   // available sometime later.
   void enqueue(const std::vector<std::string> &ChangedFiles);
 
+  // Prioritizes loading and indexing of files close to \p Path (e.g. a file
+  // that was just opened) over the rest of the queue.
+  void boostRelated(llvm::StringRef Path);
+
   // Cause background threads to stop after ther current task, any remaining
   // tasks will be discarded.
   void stop();
@@ -144,15 +155,31 @@ private:
 
   // queue management
   using Task = std::function<void()>;
+  struct QueuedTask {
+    Task Run;
+    llvm::ThreadPriority Priority;
+    std::string Path; // The file the task works on, or empty.
+    unsigned Cost;    // Distance of Path from the boosted files.
+    uint64_t Seq;     // Breaks ties in FIFO order.
+  };
+  // Orders the Queue heap: Default priority tasks first, then the ones closest
+  // to the boosted files.
+  static bool runsAfter(const QueuedTask &L, const QueuedTask &R);
+  // Distance of \p Path from the boosted files. Requires QueueMu.
+  unsigned costLocked(llvm::StringRef Path);
   void run(); // Main loop executed by Thread. Runs tasks from Queue.
-  void enqueueTask(Task T, llvm::ThreadPriority Prioirty);
+  void enqueueTask(Task T, llvm::ThreadPriority Prioirty,
+                   llvm::StringRef Path = "");
   void enqueueLocked(tooling::CompileCommand Cmd,
                      BackgroundIndexStorage *IndexStorage);
   std::mutex QueueMu;
   unsigned NumActiveTasks = 0; // Only idle when queue is empty *and* no tasks.
   std::condition_variable QueueCV;
   bool ShouldStop = false;
-  std::deque<std::pair<Task, llvm::ThreadPriority>> Queue;
+  std::vector<QueuedTask> Queue; // A heap ordered by runsAfter().
+  uint64_t NextSeq = 0;
+  llvm::StringMap<SourceParams> BoostedFiles;
+  llvm::Optional<FileDistance> Distance; // Built lazily from BoostedFiles.
   AsyncTaskRunner ThreadPool;
   GlobalCompilationDatabase::CommandChanged::Subscription CommandsChanged;
 };
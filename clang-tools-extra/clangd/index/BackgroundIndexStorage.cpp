@@ -8,6 +8,7 @@
 
 #include "Logger.h"
 #include "index/Background.h"
+#include "index/IndexStore.h"
 #include "llvm/ADT/ScopeExit.h"
 #include "llvm/Support/Error.h"
 #include "llvm/Support/FileSystem.h"
@@ -86,7 +87,10 @@ public:
   loadShard(llvm::StringRef ShardIdentifier) const override {
     const std::string ShardPath =
         getShardPathFromFilePath(DiskShardRoot, ShardIdentifier);
-    auto Buffer = llvm::MemoryBuffer::getFile(ShardPath);
+    // The serialized index doesn't need a null terminator; not asking for one
+    // lets large shards be mapped rather than copied.
+    auto Buffer = llvm::MemoryBuffer::getFile(ShardPath, /*FileSize=*/-1,
+                                              /*RequiresNullTerminator=*/false);
     if (!Buffer)
       return nullptr;
     if (auto I = readIndexFile(Buffer->get()->getBuffer()))
@@ -122,6 +126,34 @@ public:
   }
 };
 
+// Falls back to the records written by clang to an index store for the shards
+// that are not in the wrapped storage.
+class IndexStoreBackedStorage : public BackgroundIndexStorage {
+  const index::IndexRecordStore &Store;
+  BackgroundIndexStorage &Storage;
+
+public:
+  IndexStoreBackedStorage(const index::IndexRecordStore &Store,
+                          BackgroundIndexStorage &Storage)
+      : Store(Store), Storage(Storage) {}
+
+  std::unique_ptr<IndexFileIn>
+  loadShard(llvm::StringRef ShardIdentifier) const override {
+    if (auto Shard = Storage.loadShard(ShardIdentifier))
+      return Shard;
+    auto Buffer = llvm::MemoryBuffer::getFile(ShardIdentifier);
+    if (!Buffer)
+      return nullptr;
+    return loadIndexStoreShard(Store, ShardIdentifier,
+                               Buffer->get()->getBuffer());
+  }
+
+  llvm::Error storeShard(llvm::StringRef ShardIdentifier,
+                         IndexFileOut Shard) const override {
+    return Storage.storeShard(ShardIdentifier, std::move(Shard));
+  }
+};
+
 // Creates and owns IndexStorages for multiple CDBs.
 class DiskBackedIndexStorageManager {
 public:
@@ -148,6 +180,31 @@ private:
   std::unique_ptr<std::mutex> IndexStorageMapMu;
 };
 
+// Wraps the IndexStorages of another factory, with the same index store.
+class IndexStoreBackedStorageManager {
+public:
+  IndexStoreBackedStorageManager(std::string IndexStorePath,
+                                 BackgroundIndexStorage::Factory Storages)
+      : Store(llvm::make_unique<index::IndexRecordStore>(IndexStorePath)),
+        Storages(std::move(Storages)),
+        IndexStorageMapMu(llvm::make_unique<std::mutex>()) {}
+
+  BackgroundIndexStorage *operator()(llvm::StringRef CDBDirectory) {
+    std::lock_guard<std::mutex> Lock(*IndexStorageMapMu);
+    auto &IndexStorage = IndexStorageMap[CDBDirectory];
+    if (!IndexStorage)
+      IndexStorage = llvm::make_unique<IndexStoreBackedStorage>(
+          *Store, *Storages(CDBDirectory));
+    return IndexStorage.get();
+  }
+
+private:
+  std::unique_ptr<index::IndexRecordStore> Store;
+  BackgroundIndexStorage::Factory Storages;
+  llvm::StringMap<std::unique_ptr<BackgroundIndexStorage>> IndexStorageMap;
+  std::unique_ptr<std::mutex> IndexStorageMapMu;
+};
+
 } // namespace
 
 BackgroundIndexStorage::Factory
@@ -155,5 +212,12 @@ BackgroundIndexStorage::createDiskBackedStorageFactory() {
   return DiskBackedIndexStorageManager();
 }
 
+BackgroundIndexStorage::Factory
+BackgroundIndexStorage::createIndexStoreBackedStorageFactory(
+    std::string IndexStorePath, Factory Storages) {
+  return IndexStoreBackedStorageManager(std::move(IndexStorePath),
+                                        std::move(Storages));
+}
+
 } // namespace clangd
 } // namespace clang
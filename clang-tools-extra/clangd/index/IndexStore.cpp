@@ -0,0 +1,124 @@
+//===--- IndexStore.cpp - Load index data written by the compiler ---------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "index/IndexStore.h"
+#include "Headers.h"
+#include "Logger.h"
+#include "SourceCode.h"
+#include "URI.h"
+#include "index/Ref.h"
+#include "index/Symbol.h"
+#include "index/SymbolID.h"
+#include "index/SymbolLocation.h"
+#include "index/SymbolOrigin.h"
+#include "clang/Index/IndexSymbol.h"
+#include "llvm/ADT/DenseMap.h"
+
+namespace clang {
+namespace clangd {
+
+static bool hasRole(const index::StoredOccurrence &Occ,
+                    index::SymbolRole Role) {
+  return Occ.Roles & static_cast<index::SymbolRoleSet>(Role);
+}
+
+std::unique_ptr<IndexFileIn>
+loadIndexStoreShard(const index::IndexRecordStore &Store,
+                    llvm::StringRef AbsolutePath, llvm::StringRef Content) {
+  std::string RecordName = index::IndexRecordStore::getRecordName(Content);
+  if (!Store.hasRecord(RecordName))
+    return nullptr;
+  auto Record = Store.readRecord(RecordName);
+  if (!Record) {
+    elog("Failed to read the index store record of {0}: {1}", AbsolutePath,
+         Record.takeError());
+    return nullptr;
+  }
+
+  // The strings are owned by the record and the URI until they are copied into
+  // the slabs.
+  std::string FileURI = URI::create(AbsolutePath).toString();
+  std::vector<SymbolID> IDs;
+  IDs.reserve(Record->Symbols.size());
+  llvm::DenseMap<SymbolID, Symbol> Symbols;
+  for (const index::StoredSymbol &Stored : Record->Symbols) {
+    SymbolID ID(Stored.USR);
+    IDs.push_back(ID);
+    Symbol &Sym = Symbols[ID];
+    Sym.ID = ID;
+    Sym.SymInfo = Stored.Info;
+    Sym.Name = Stored.Name;
+    Sym.Scope = Stored.Scope;
+    Sym.Origin = SymbolOrigin::Static;
+  }
+
+  RefSlab::Builder Refs;
+  for (const index::StoredOccurrence &Occ : Record->Occurrences) {
+    SymbolLocation Loc;
+    Loc.FileURI = FileURI.c_str();
+    Loc.Start.setLine(Occ.Line - 1);
+    Loc.Start.setColumn(Occ.Column - 1);
+    Loc.End.setLine(Occ.Line - 1);
+    Loc.End.setColumn(Occ.Column - 1 + Occ.Length);
+
+    const SymbolID &ID = IDs[Occ.Symbol];
+    Symbol &Sym = Symbols[ID];
+    if (hasRole(Occ, index::SymbolRole::Definition) && !Sym.Definition)
+      Sym.Definition = Loc;
+    if (hasRole(Occ, index::SymbolRole::Declaration) &&
+        !Sym.CanonicalDeclaration)
+      Sym.CanonicalDeclaration = Loc;
+
+    Ref R;
+    R.Location = Loc;
+    R.Kind = static_cast<RefKind>(Occ.Roles &
+                                  static_cast<uint8_t>(RefKind::All));
+    if (R.Kind != RefKind::Unknown)
+      Refs.insert(ID, R);
+  }
+
+  SymbolSlab::Builder Syms;
+  for (auto &Entry : Symbols) {
+    Symbol &Sym = Entry.second;
+    if (!Sym.CanonicalDeclaration)
+      Sym.CanonicalDeclaration = Sym.Definition;
+    // Symbols only referenced in this file belong to the shard of another one.
+    if (Sym.CanonicalDeclaration)
+      Syms.insert(Sym);
+  }
+
+  IncludeGraph Sources;
+  auto &NodeEntry = *Sources.try_emplace(FileURI).first;
+  IncludeGraphNode &Node = NodeEntry.getValue();
+  Node.URI = NodeEntry.getKey();
+  Node.Digest = digest(Content);
+  // The unit lists all the files of the translation unit: the background index
+  // loads their shards after this one.
+  if (auto Unit = Store.readUnit(AbsolutePath)) {
+    Node.Flags |= IncludeGraphNode::SourceFlag::IsTU;
+    for (const index::IndexUnit::FileRecord &File : Unit->Files) {
+      if (File.Path == AbsolutePath)
+        continue;
+      auto &Include =
+          *Sources.try_emplace(URI::create(File.Path).toString()).first;
+      Include.getValue().URI = Include.getKey();
+      Node.DirectIncludes.push_back(Include.getKey());
+    }
+  } else {
+    llvm::consumeError(Unit.takeError());
+  }
+
+  auto Shard = llvm::make_unique<IndexFileIn>();
+  Shard->Symbols = std::move(Syms).build();
+  Shard->Refs = std::move(Refs).build();
+  Shard->Sources = std::move(Sources);
+  return Shard;
+}
+
+} // namespace clangd
+} // namespace clang
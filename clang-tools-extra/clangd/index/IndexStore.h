@@ -0,0 +1,41 @@
+//===--- IndexStore.h - Load index data written by the compiler --*- C++-*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// clang can write the index data of the files it compiles to an index store
+// (-index-store-path). This converts the record of a file to an index shard, so
+// that the background index gets the index of a project from its build instead
+// of parsing every file again.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_TOOLS_EXTRA_CLANGD_INDEX_INDEXSTORE_H
+#define LLVM_CLANG_TOOLS_EXTRA_CLANGD_INDEX_INDEXSTORE_H
+
+#include "index/Serialization.h"
+#include "clang/Index/IndexRecordStore.h"
+#include "llvm/ADT/StringRef.h"
+#include <memory>
+
+namespace clang {
+namespace clangd {
+
+// Builds the shard of the file at \p AbsolutePath, with contents \p Content,
+// from its record in \p Store. Returns nullptr if there is no record for these
+// contents.
+//
+// The shard has the symbols declared or defined in the file and their
+// references in the file, but no completion information. If the file is the
+// main file of a unit, the other files of the unit are its includes.
+std::unique_ptr<IndexFileIn>
+loadIndexStoreShard(const index::IndexRecordStore &Store,
+                    llvm::StringRef AbsolutePath, llvm::StringRef Content);
+
+} // namespace clangd
+} // namespace clang
+
+#endif
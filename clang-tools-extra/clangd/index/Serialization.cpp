@@ -432,6 +432,127 @@ readCompileCommand(Reader CmdReader, llvm::ArrayRef<llvm::StringRef> Strings) {
   return Cmd;
 }
 
+// DEX POSTING LISTS
+// The section starts with the offset of the chunk array within it (uint32).
+// It is followed by the number of documents and, for each of them in DocID
+// order, the position of its symbol in the symbol section (varint).
+// Then come the number of posting lists and, for each of them:
+//   - token kind (uint8)
+//   - token data (string table index, varint)
+//   - first chunk and number of chunks (varint each)
+// The section ends with the chunk array, padded so that it is aligned within
+// the file and can be used in place once the file is mapped. Each chunk is the
+// head (uint32) followed by the payload bytes.
+
+constexpr static size_t DexChunkAlignment = sizeof(dex::Chunk);
+
+struct InternedPostingList {
+  dex::Token::Kind Kind;
+  llvm::StringRef Data;
+  llvm::ArrayRef<dex::Chunk> Chunks;
+};
+
+// FileOffset is the offset of the section data within the file.
+void writeDexPostings(llvm::ArrayRef<uint32_t> RankedSymbols,
+                      llvm::ArrayRef<InternedPostingList> PostingLists,
+                      const StringTableOut &Strings, size_t FileOffset,
+                      llvm::raw_ostream &OS) {
+  std::string Header;
+  {
+    llvm::raw_string_ostream HeaderOS(Header);
+    writeVar(RankedSymbols.size(), HeaderOS);
+    for (uint32_t I : RankedSymbols)
+      writeVar(I, HeaderOS);
+    writeVar(PostingLists.size(), HeaderOS);
+    uint32_t FirstChunk = 0;
+    for (const InternedPostingList &P : PostingLists) {
+      HeaderOS.write(static_cast<uint8_t>(P.Kind));
+      writeVar(Strings.index(P.Data), HeaderOS);
+      writeVar(FirstChunk, HeaderOS);
+      writeVar(P.Chunks.size(), HeaderOS);
+      FirstChunk += P.Chunks.size();
+    }
+  }
+  size_t ChunksOffset = sizeof(uint32_t) + Header.size();
+  ChunksOffset +=
+      llvm::OffsetToAlignment(FileOffset + ChunksOffset, DexChunkAlignment);
+  write32(ChunksOffset, OS);
+  OS << Header;
+  OS.write_zeros(ChunksOffset - sizeof(uint32_t) - Header.size());
+  for (const InternedPostingList &P : PostingLists)
+    for (const dex::Chunk &C : P.Chunks) {
+      write32(C.Head, OS);
+      OS.write(reinterpret_cast<const char *>(C.Payload.data()),
+               C.Payload.size());
+    }
+}
+
+llvm::Expected<DexPostingsIn>
+readDexPostings(llvm::StringRef Data, llvm::ArrayRef<llvm::StringRef> Strings,
+                size_t NumSymbols) {
+  Reader R(Data);
+  uint32_t ChunksOffset = R.consume32();
+  DexPostingsIn Result;
+  uint32_t NumDocs = R.consumeVar();
+  if (NumDocs != NumSymbols)
+    return makeError("dex postings don't match the symbols");
+  Result.RankedSymbols.resize(NumDocs);
+  for (uint32_t &I : Result.RankedSymbols) {
+    I = R.consumeVar();
+    if (I >= NumSymbols)
+      return makeError("malformed dex postings");
+  }
+  struct ListRef {
+    dex::Token::Kind Kind;
+    llvm::StringRef Data;
+    uint32_t FirstChunk, NumChunks;
+  };
+  std::vector<ListRef> Lists(R.consumeVar());
+  for (ListRef &L : Lists) {
+    uint8_t Kind = R.consume8();
+    if (Kind > static_cast<uint8_t>(dex::Token::Kind::Sentinel))
+      return makeError("malformed dex postings");
+    L.Kind = static_cast<dex::Token::Kind>(Kind);
+    L.Data = R.consumeString(Strings);
+    L.FirstChunk = R.consumeVar();
+    L.NumChunks = R.consumeVar();
+  }
+  if (R.err() || ChunksOffset > Data.size() ||
+      (Data.size() - ChunksOffset) % sizeof(dex::Chunk))
+    return makeError("malformed or truncated dex postings");
+
+  llvm::StringRef Raw = Data.drop_front(ChunksOffset);
+  size_t NumChunks = Raw.size() / sizeof(dex::Chunk);
+  llvm::ArrayRef<dex::Chunk> Chunks;
+  if (llvm::sys::IsLittleEndianHost &&
+      reinterpret_cast<uintptr_t>(Raw.data()) % alignof(dex::Chunk) == 0) {
+    Chunks = llvm::makeArrayRef(
+        reinterpret_cast<const dex::Chunk *>(Raw.data()), NumChunks);
+  } else {
+    Reader ChunkReader(Raw);
+    Result.Chunks.resize(NumChunks);
+    for (dex::Chunk &C : Result.Chunks) {
+      C.Head = ChunkReader.consume32();
+      llvm::StringRef Payload = ChunkReader.consume(C.Payload.size());
+      std::copy(Payload.begin(), Payload.end(), C.Payload.begin());
+    }
+    Chunks = Result.Chunks;
+  }
+  for (const ListRef &L : Lists) {
+    if (L.NumChunks == 0 || L.FirstChunk + L.NumChunks > Chunks.size())
+      return makeError("malformed dex postings");
+    // Checking every document would mean decoding the lists; checking the
+    // heads catches most corruption.
+    for (const dex::Chunk &C : Chunks.slice(L.FirstChunk, L.NumChunks))
+      if (C.Head >= NumDocs)
+        return makeError("malformed dex postings");
+    Result.PostingLists.try_emplace(
+        dex::Token(L.Kind, L.Data),
+        dex::PostingList::fromChunks(Chunks.slice(L.FirstChunk, L.NumChunks)));
+  }
+  return std::move(Result);
+}
+
 // FILE ENCODING
 // A file is a RIFF chunk with type 'CdIx'.
 // It contains the sections:
@@ -440,6 +561,7 @@ readCompileCommand(Reader CmdReader, llvm::ArrayRef<llvm::StringRef> Strings) {
 //   - stri: string table
 //   - symb: symbols
 //   - refs: references to symbols
+//   - dexp: optional Dex posting lists over the symbols
 
 // The current versioning scheme is simple - non-current versions are rejected.
 // If you make a breaking change, bump this version number to invalidate stored
@@ -496,6 +618,14 @@ llvm::Expected<IndexFileIn> readRIFF(llvm::StringRef Data) {
       return makeError("malformed or truncated symbol");
     Result.Symbols = std::move(Symbols).build();
   }
+  if (Chunks.count("dexp")) {
+    auto Postings =
+        readDexPostings(Chunks.lookup("dexp"), Strings->Strings,
+                        Result.Symbols ? Result.Symbols->size() : 0);
+    if (!Postings)
+      return Postings.takeError();
+    Result.DexPostings = std::move(*Postings);
+  }
   if (Chunks.count("refs")) {
     Reader RefsReader(Chunks.lookup("refs"));
     RefSlab::Builder Refs;
@@ -588,6 +718,25 @@ void writeRIFF(const IndexFileOut &Data, llvm::raw_ostream &OS) {
     }
   }
 
+  // Build the index over the symbols and keep its posting lists. Refs and
+  // relations don't affect them.
+  std::unique_ptr<dex::Dex> Dex;
+  std::vector<uint32_t> RankedSymbols;
+  std::vector<InternedPostingList> PostingLists;
+  if (Data.DexPostings) {
+    Dex = llvm::make_unique<dex::Dex>(
+        *Data.Symbols, std::vector<std::pair<SymbolID, llvm::ArrayRef<Ref>>>(),
+        std::vector<Relation>());
+    for (const Symbol *Sym : Dex->rankedSymbols())
+      RankedSymbols.push_back(Sym - &*Data.Symbols->begin());
+    for (const auto &TokenToPostingList : Dex->postingLists()) {
+      PostingLists.push_back({TokenToPostingList.first.TokenKind,
+                              TokenToPostingList.first.Data,
+                              TokenToPostingList.second.chunks()});
+      Strings.intern(PostingLists.back().Data);
+    }
+  }
+
   InternedCompileCommand InternedCmd;
   if (Data.Cmd) {
     InternedCmd.CommandLine.reserve(Data.Cmd->CommandLine.size());
@@ -653,6 +802,21 @@ void writeRIFF(const IndexFileOut &Data, llvm::raw_ostream &OS) {
     RIFF.Chunks.push_back({riff::fourCC("cmdl"), CmdlSection});
   }
 
+  std::string DexpSection;
+  if (Data.DexPostings) {
+    // The section is last so that its offset in the file is known: after the
+    // RIFF header and type, each chunk has an 8 byte header and even length.
+    size_t Offset = 12;
+    for (const riff::Chunk &C : RIFF.Chunks)
+      Offset += 8 + C.Data.size() + C.Data.size() % 2;
+    {
+      llvm::raw_string_ostream DexpOS(DexpSection);
+      writeDexPostings(RankedSymbols, PostingLists, Strings, Offset + 8,
+                       DexpOS);
+    }
+    RIFF.Chunks.push_back({riff::fourCC("dexp"), DexpSection});
+  }
+
   OS << RIFF;
 }
 
@@ -697,6 +861,7 @@ std::unique_ptr<SymbolIndex> loadIndex(llvm::StringRef SymbolFilename,
   SymbolSlab Symbols;
   RefSlab Refs;
   RelationSlab Relations;
+  llvm::Optional<DexPostingsIn> DexPostings;
   {
     trace::Span Tracer("ParseIndex");
     if (auto I = readIndexFile(Buffer->get()->getBuffer())) {
@@ -706,6 +871,8 @@ std::unique_ptr<SymbolIndex> loadIndex(llvm::StringRef SymbolFilename,
         Refs = std::move(*I->Refs);
       if (I->Relations)
         Relations = std::move(*I->Relations);
+      if (I->DexPostings)
+        DexPostings = std::move(*I->DexPostings);
     } else {
       llvm::errs() << "Bad Index: " << llvm::toString(I.takeError()) << "\n";
       return nullptr;
@@ -717,10 +884,28 @@ std::unique_ptr<SymbolIndex> loadIndex(llvm::StringRef SymbolFilename,
   size_t NumRelations = Relations.size();
 
   trace::Span Tracer("BuildIndex");
-  auto Index = UseDex ? dex::Dex::build(std::move(Symbols), std::move(Refs),
-                                        std::move(Relations))
-                      : MemIndex::build(std::move(Symbols), std::move(Refs),
-                                        std::move(Relations));
+  std::unique_ptr<SymbolIndex> Index;
+  if (UseDex && DexPostings) {
+    // The posting lists may point into the file contents, so keep them alive.
+    // Mapped pages are shared with other processes using the same file and
+    // are not counted towards our memory usage.
+    std::vector<const Symbol *> RankedSymbols;
+    for (uint32_t I : DexPostings->RankedSymbols)
+      RankedSymbols.push_back(&*(Symbols.begin() + I));
+    auto PostingLists = std::move(DexPostings->PostingLists);
+    size_t Size = Symbols.bytes() + Refs.bytes() +
+                  DexPostings->Chunks.capacity() * sizeof(dex::Chunk);
+    auto Data = std::make_tuple(std::move(Symbols), std::move(Refs),
+                                std::move(*Buffer), std::move(*DexPostings));
+    Index = llvm::make_unique<dex::Dex>(
+        std::move(RankedSymbols), std::get<1>(Data), Relations,
+        std::move(PostingLists), std::move(Data), Size);
+  } else {
+    Index = UseDex ? dex::Dex::build(std::move(Symbols), std::move(Refs),
+                                     std::move(Relations))
+                   : MemIndex::build(std::move(Symbols), std::move(Refs),
+                                     std::move(Relations));
+  }
   vlog("Loaded {0} from {1} with estimated memory usage {2} bytes\n"
        "  - number of symbols: {3}\n"
        "  - number of refs: {4}\n"
@@ -27,6 +27,8 @@
 #include "Headers.h"
 #include "Index.h"
 #include "index/Symbol.h"
+#include "index/dex/PostingList.h"
+#include "index/dex/Token.h"
 #include "clang/Tooling/CompilationDatabase.h"
 #include "llvm/Support/Error.h"
 
@@ -38,6 +40,17 @@ enum class IndexFileFormat {
   YAML, // Human-readable format, suitable for experiments and debugging.
 };
 
+// Dex posting lists stored in an index file.
+struct DexPostingsIn {
+  // Positions in IndexFileIn::Symbols of the symbols, in DocID order.
+  std::vector<uint32_t> RankedSymbols;
+  // These point into the data that was read whenever it is suitably aligned,
+  // so that a mapped index file can be shared instead of copied.
+  llvm::DenseMap<dex::Token, dex::PostingList> PostingLists;
+  // Holds the chunks when they could not be used in place.
+  std::vector<dex::Chunk> Chunks;
+};
+
 // Holds the contents of an index file that was read.
 struct IndexFileIn {
   llvm::Optional<SymbolSlab> Symbols;
@@ -47,6 +60,7 @@ struct IndexFileIn {
   llvm::Optional<IncludeGraph> Sources;
   // This contains only the Directory and CommandLine.
   llvm::Optional<tooling::CompileCommand> Cmd;
+  llvm::Optional<DexPostingsIn> DexPostings;
 };
 // Parse an index file. The input must be a RIFF or YAML file.
 llvm::Expected<IndexFileIn> readIndexFile(llvm::StringRef);
@@ -58,8 +72,10 @@ struct IndexFileOut {
   const RelationSlab *Relations = nullptr;
   // Keys are URIs of the source files.
   const IncludeGraph *Sources = nullptr;
-  // TODO: Support serializing Dex posting lists.
   IndexFileFormat Format = IndexFileFormat::RIFF;
+  // Also store the Dex posting lists of the symbols, so that loadIndex() can
+  // use them without rebuilding the index. Only supported by RIFF.
+  bool DexPostings = false;
   const tooling::CompileCommand *Cmd = nullptr;
 
   IndexFileOut() = default;
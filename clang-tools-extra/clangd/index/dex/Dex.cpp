@@ -65,26 +65,16 @@ std::vector<Token> generateSearchTokens(const Symbol &Sym) {
 } // namespace
 
 void Dex::buildIndex() {
-  this->Corpus = dex::Corpus(Symbols.size());
   std::vector<std::pair<float, const Symbol *>> ScoredSymbols(Symbols.size());
-
-  for (size_t I = 0; I < Symbols.size(); ++I) {
-    const Symbol *Sym = Symbols[I];
-    LookupTable[Sym->ID] = Sym;
-    ScoredSymbols[I] = {quality(*Sym), Sym};
-  }
+  for (size_t I = 0; I < Symbols.size(); ++I)
+    ScoredSymbols[I] = {quality(*Symbols[I]), Symbols[I]};
 
   // Symbols are sorted by symbol qualities so that items in the posting lists
   // are stored in the descending order of symbol quality.
   llvm::sort(ScoredSymbols, std::greater<std::pair<float, const Symbol *>>());
-
-  // SymbolQuality was empty up until now.
-  SymbolQuality.resize(Symbols.size());
-  // Populate internal storage using Symbol + Score pairs.
-  for (size_t I = 0; I < ScoredSymbols.size(); ++I) {
-    SymbolQuality[I] = ScoredSymbols[I].first;
+  for (size_t I = 0; I < ScoredSymbols.size(); ++I)
     Symbols[I] = ScoredSymbols[I].second;
-  }
+  indexRankedSymbols();
 
   // Populate TempInvertedIndex with lists for index symbols.
   llvm::DenseMap<Token, std::vector<DocID>> TempInvertedIndex;
@@ -100,6 +90,15 @@ void Dex::buildIndex() {
         {TokenToPostingList.first, PostingList(TokenToPostingList.second)});
 }
 
+void Dex::indexRankedSymbols() {
+  this->Corpus = dex::Corpus(Symbols.size());
+  SymbolQuality.resize(Symbols.size());
+  for (size_t I = 0; I < Symbols.size(); ++I) {
+    LookupTable[Symbols[I]->ID] = Symbols[I];
+    SymbolQuality[I] = quality(*Symbols[I]);
+  }
+}
+
 std::unique_ptr<Iterator> Dex::iterator(const Token &Tok) const {
   auto It = InvertedIndex.find(Tok);
   return It == InvertedIndex.end() ? Corpus.none()
@@ -33,11 +33,8 @@ namespace clangd {
 namespace dex {
 
 /// In-memory Dex trigram-based index implementation.
-// FIXME(kbobyrev): Introduce serialization and deserialization of the symbol
-// index so that it can be loaded from the disk. Since static index is not
-// changed frequently, it's safe to assume that it has to be built only once
-// (when the clangd process starts). Therefore, it can be easier to store built
-// index on disk and then load it if available.
+/// The posting lists can be stored in index files (see IndexFileOut), so that
+/// a static index doesn't need to be rebuilt when it is loaded.
 class Dex : public SymbolIndex {
 public:
   // All data must outlive this index.
@@ -46,11 +43,7 @@ public:
       : Corpus(0) {
     for (auto &&Sym : Symbols)
       this->Symbols.push_back(&Sym);
-    for (auto &&Ref : Refs)
-      this->Refs.try_emplace(Ref.first, Ref.second);
-    for (auto &&Rel : Relations)
-      this->Relations[std::make_pair(Rel.Subject, Rel.Predicate)].push_back(
-          Rel.Object);
+    addRefsAndRelations(Refs, Relations);
     buildIndex();
   }
   // Symbols and Refs are owned by BackingData, Index takes ownership.
@@ -65,6 +58,23 @@ public:
     this->BackingDataSize = BackingDataSize;
   }
 
+  // Uses the posting lists of a previously built index instead of building
+  // them, e.g. ones read from an index file. RankedSymbols must be ordered as
+  // rankedSymbols() was for that index. Index takes ownership of BackingData.
+  template <typename RefsRange, typename RelationsRange, typename Payload>
+  Dex(std::vector<const Symbol *> RankedSymbols, RefsRange &&Refs,
+      RelationsRange &&Relations,
+      llvm::DenseMap<Token, PostingList> PostingLists, Payload &&BackingData,
+      size_t BackingDataSize)
+      : Symbols(std::move(RankedSymbols)),
+        InvertedIndex(std::move(PostingLists)), Corpus(0) {
+    addRefsAndRelations(Refs, Relations);
+    indexRankedSymbols();
+    KeepAlive = std::shared_ptr<void>(
+        std::make_shared<Payload>(std::move(BackingData)), nullptr);
+    this->BackingDataSize = BackingDataSize;
+  }
+
   /// Builds an index from slabs. The index takes ownership of the slab.
   static std::unique_ptr<SymbolIndex> build(SymbolSlab, RefSlab, RelationSlab);
 
@@ -84,8 +94,25 @@ public:
 
   size_t estimateMemoryUsage() const override;
 
+  /// The symbols in DocID order, and the posting lists over them. Used to
+  /// serialize the index.
+  llvm::ArrayRef<const Symbol *> rankedSymbols() const { return Symbols; }
+  const llvm::DenseMap<Token, PostingList> &postingLists() const {
+    return InvertedIndex;
+  }
+
 private:
+  template <typename RefsRange, typename RelationsRange>
+  void addRefsAndRelations(RefsRange &&Refs, RelationsRange &&Relations) {
+    for (auto &&Ref : Refs)
+      this->Refs.try_emplace(Ref.first, Ref.second);
+    for (auto &&Rel : Relations)
+      this->Relations[std::make_pair(Rel.Subject, Rel.Predicate)].push_back(
+          Rel.Object);
+  }
   void buildIndex();
+  // Fills in everything but the posting lists, assuming Symbols is ranked.
+  void indexRankedSymbols();
   std::unique_ptr<Iterator> iterator(const Token &Tok) const;
   std::unique_ptr<Iterator>
   createFileProximityIterator(llvm::ArrayRef<std::string> ProximityPaths) const;
@@ -217,7 +217,7 @@ llvm::SmallVector<DocID, Chunk::PayloadSize + 1> Chunk::decompress() const {
 }
 
 PostingList::PostingList(llvm::ArrayRef<DocID> Documents)
-    : Chunks(encodeStream(Documents)) {}
+    : Storage(encodeStream(Documents)), Chunks(Storage) {}
 
 std::unique_ptr<Iterator> PostingList::iterator(const Token *Tok) const {
   return llvm::make_unique<ChunkIterator>(Tok, Chunks);
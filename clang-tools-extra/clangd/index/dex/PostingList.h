@@ -60,16 +60,32 @@ class PostingList {
 public:
   explicit PostingList(llvm::ArrayRef<DocID> Documents);
 
+  /// Wraps chunks that were already encoded, e.g. ones mapped from an index
+  /// file. The chunks are not copied and must outlive the posting list.
+  static PostingList fromChunks(llvm::ArrayRef<Chunk> Chunks) {
+    return PostingList(Chunks);
+  }
+
+  PostingList(PostingList &&) = default;
+  PostingList &operator=(PostingList &&) = default;
+
   /// Constructs DocumentIterator over given posting list. DocumentIterator will
   /// go through the chunks and decompress them on-the-fly when necessary.
   /// If given, Tok is only used for the string representation.
   std::unique_ptr<Iterator> iterator(const Token *Tok = nullptr) const;
 
-  /// Returns in-memory size of external storage.
-  size_t bytes() const { return Chunks.capacity() * sizeof(Chunk); }
+  /// Returns in-memory size of external storage. Chunks that are not owned by
+  /// the posting list are not counted.
+  size_t bytes() const { return Storage.capacity() * sizeof(Chunk); }
+
+  /// The encoded contents of the posting list, for serialization.
+  llvm::ArrayRef<Chunk> chunks() const { return Chunks; }
 
 private:
-  const std::vector<Chunk> Chunks;
+  explicit PostingList(llvm::ArrayRef<Chunk> Chunks) : Chunks(Chunks) {}
+
+  std::vector<Chunk> Storage; // Empty if the chunks are not owned.
+  llvm::ArrayRef<Chunk> Chunks;
 };
 
 } // namespace dex
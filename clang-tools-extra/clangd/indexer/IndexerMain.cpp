@@ -129,6 +129,7 @@ int main(int argc, const char **argv) {
   // Emit collected data.
   clang::clangd::IndexFileOut Out(Data);
   Out.Format = clang::clangd::Format;
+  Out.DexPostings = true;
   llvm::outs() << Out;
   return 0;
 }
@@ -199,6 +199,14 @@ static llvm::cl::opt<int> BackgroundIndexRebuildPeriod(
         "symbol index will be updated for each indexed file"),
     llvm::cl::init(5000), llvm::cl::Hidden);
 
+static llvm::cl::opt<std::string> IndexStorePath(
+    "index-store-path",
+    llvm::cl::desc(
+        "Load the background index of the files compiled with "
+        "`clang -index-store-path <dir>` from that index store. Only used "
+        "with -background-index"),
+    llvm::cl::init(""));
+
 enum CompileArgsFrom { LSPCompileArgs, FilesystemCompileArgs };
 static llvm::cl::opt<CompileArgsFrom> CompileArgsFrom(
     "compile_args_from", llvm::cl::desc("The source of compile commands"),
@@ -467,6 +475,7 @@ int main(int argc, char *argv[]) {
   Opts.BuildDynamicSymbolIndex = EnableIndex;
   Opts.BackgroundIndex = EnableBackgroundIndex;
   Opts.BackgroundIndexRebuildPeriodMs = BackgroundIndexRebuildPeriod;
+  Opts.IndexStorePath = IndexStorePath;
   std::unique_ptr<SymbolIndex> StaticIdx;
   std::future<void> AsyncIndexLoad; // Block exit while loading the index.
   if (EnableIndex && !IndexFile.empty()) {
@@ -605,5 +605,41 @@ TEST_F(BackgroundIndexTest, CmdLineHash) {
   }
 }
 
+TEST_F(BackgroundIndexTest, IndexesFilesNearBoostedOnesFirst) {
+  MockFSProvider FS;
+  FS.Files[testPath("root/a/A.cc")] = "void a();";
+  FS.Files[testPath("root/b/B.cc")] = "void b();";
+  llvm::StringMap<std::string> Storage;
+  size_t CacheHits = 0;
+  class OrderedStorage : public MemoryShardStorage {
+  public:
+    using MemoryShardStorage::MemoryShardStorage;
+    llvm::Error storeShard(llvm::StringRef ShardIdentifier,
+                           IndexFileOut Shard) const override {
+      Stored.push_back(ShardIdentifier);
+      return MemoryShardStorage::storeShard(ShardIdentifier, Shard);
+    }
+    mutable std::vector<std::string> Stored;
+  } MSS(Storage, CacheHits);
+  OverlayCDB CDB(/*Base=*/nullptr);
+  for (llvm::StringRef File : {"root/a/A.cc", "root/b/B.cc"}) {
+    tooling::CompileCommand Cmd;
+    Cmd.Filename = testPath(File);
+    Cmd.Directory = testPath("root");
+    Cmd.CommandLine = {"clang++", testPath(File)};
+    CDB.setCompileCommand(testPath(File), Cmd);
+  }
+  // A single worker, so that both TUs are queued before either is indexed.
+  BackgroundIndex Idx(Context::empty(), FS, CDB,
+                      [&](llvm::StringRef) { return &MSS; },
+                      /*BuildIndexPeriodMs=*/0, /*ThreadPoolSize=*/1);
+  Idx.boostRelated(testPath("root/b/B.h"));
+  Idx.enqueue({testPath("root/a/A.cc"), testPath("root/b/B.cc")});
+  ASSERT_TRUE(Idx.blockUntilIdleForTest());
+
+  EXPECT_THAT(MSS.Stored,
+              ElementsAre(testPath("root/b/B.cc"), testPath("root/a/A.cc")));
+}
+
 } // namespace clangd
 } // namespace clang
@@ -503,6 +503,10 @@ struct Something {
 
   EXPECT_THAT(Server.getUsedBytesPerFile(),
               UnorderedElementsAre(Pair(FooCpp, Gt(0u)), Pair(BarCpp, Gt(0u))));
+  ClangdServer::MemoryUsage Usage = Server.getMemoryUsage();
+  EXPECT_GT(Usage.Preambles, 0u);
+  EXPECT_GT(Usage.DynamicIndex, 0u);
+  EXPECT_EQ(Usage.StaticIndex, 0u);
 
   Server.removeDocument(FooCpp);
   ASSERT_TRUE(Server.blockUntilIdleForTest());
@@ -511,6 +515,9 @@ struct Something {
   Server.removeDocument(BarCpp);
   ASSERT_TRUE(Server.blockUntilIdleForTest());
   EXPECT_THAT(Server.getUsedBytesPerFile(), IsEmpty());
+  Usage = Server.getMemoryUsage();
+  EXPECT_EQ(Usage.Preambles, 0u);
+  EXPECT_EQ(Usage.ASTCache, 0u);
 }
 
 TEST_F(ClangdVFSTest, InvalidCompileCommand) {
@@ -9,6 +9,7 @@
 #include "Annotations.h"
 #include "ClangdUnit.h"
 #include "SourceCode.h"
+#include "TestFS.h"
 #include "TestTU.h"
 #include "clang/Basic/TokenKinds.h"
 #include "clang/Tooling/Syntax/Tokens.h"
@@ -134,6 +135,38 @@ TEST(ClangdUnitTest, TokensAfterPreamble) {
   EXPECT_EQ(Spelled.back().text(SM), "last_token");
 }
 
+TEST(ClangdUnitTest, StalePreambleIsPatched) {
+  std::string MainFile = testPath("main.cpp");
+  llvm::StringMap<std::string> Files;
+  Files[testPath("a.h")] = "int a;";
+  Files[testPath("b.h")] = "int b;";
+
+  ParseInputs Inputs;
+  Inputs.CompileCommand.Filename = MainFile;
+  Inputs.CompileCommand.CommandLine = {"clang", MainFile};
+  Inputs.CompileCommand.Directory = testRoot();
+  Inputs.FS = buildTestFS(Files);
+  Inputs.Opts = ParseOptions();
+  Inputs.Contents = "#include \"a.h\"\n";
+  auto CI = buildCompilerInvocation(Inputs);
+  ASSERT_TRUE(CI);
+  auto StalePreamble =
+      buildPreamble(MainFile, *CI, /*OldPreamble=*/nullptr,
+                    Inputs.CompileCommand, Inputs, /*StoreInMemory=*/true,
+                    /*PreambleCallback=*/nullptr);
+  ASSERT_TRUE(StalePreamble);
+
+  // The header added since the preamble was built is still seen.
+  Inputs.Contents = R"cpp(#include "a.h"
+#include "b.h"
+int c = a + b;
+)cpp";
+  auto AST = buildAST(MainFile, buildCompilerInvocation(Inputs), Inputs,
+                      StalePreamble);
+  ASSERT_TRUE(AST);
+  EXPECT_THAT(AST->getDiagnostics(), ::testing::IsEmpty());
+}
+
 } // namespace
 } // namespace clangd
 } // namespace clang
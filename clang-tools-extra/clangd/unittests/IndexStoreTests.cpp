@@ -0,0 +1,145 @@
+//===-- IndexStoreTests.cpp -------------------------------------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "Headers.h"
+#include "SourceCode.h"
+#include "TestFS.h"
+#include "URI.h"
+#include "index/IndexStore.h"
+#include "llvm/ADT/ScopeExit.h"
+#include "llvm/Support/FileSystem.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+using ::testing::AllOf;
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+using ::testing::Pair;
+using ::testing::UnorderedElementsAre;
+
+namespace clang {
+namespace clangd {
+namespace {
+
+MATCHER_P(Named, N, "") { return (arg.Scope + arg.Name).str() == N; }
+MATCHER(Declared, "") {
+  return !StringRef(arg.CanonicalDeclaration.FileURI).empty();
+}
+MATCHER(Defined, "") { return !StringRef(arg.Definition.FileURI).empty(); }
+MATCHER_P2(RefAt, Line, Column, "") {
+  return arg.Location.Start.line() == Line &&
+         arg.Location.Start.column() == Column;
+}
+
+class IndexStoreTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    ASSERT_FALSE(
+        llvm::sys::fs::createUniqueDirectory("clangd-index-store", StorePath));
+  }
+  void TearDown() override { llvm::sys::fs::remove_directories(StorePath); }
+
+  static index::StoredSymbol symbol(llvm::StringRef Scope,
+                                    llvm::StringRef Name) {
+    index::StoredSymbol Sym;
+    Sym.Info = {index::SymbolKind::Function, index::SymbolSubKind::None,
+                index::SymbolLanguage::CXX, 0};
+    Sym.USR = ("c:@F@" + Scope + Name).str();
+    Sym.Name = Name;
+    Sym.Scope = Scope;
+    return Sym;
+  }
+
+  static index::StoredOccurrence occurrence(unsigned Symbol,
+                                            index::SymbolRole Role,
+                                            unsigned Line, unsigned Column) {
+    return {Symbol, static_cast<index::SymbolRoleSet>(Role), Line, Column,
+            /*Length=*/1};
+  }
+
+  llvm::SmallString<128> StorePath;
+};
+
+TEST_F(IndexStoreTest, LoadsRecord) {
+  std::string Content = R"cpp(int f();
+int f() { return 0; }
+int g() { return f() + ns::h(); })cpp";
+  index::IndexRecord Record;
+  Record.Symbols = {symbol("", "f"), symbol("", "g"), symbol("ns::", "h")};
+  Record.Occurrences = {
+      occurrence(0, index::SymbolRole::Declaration, 1, 5),
+      occurrence(0, index::SymbolRole::Definition, 2, 5),
+      occurrence(1, index::SymbolRole::Definition, 3, 5),
+      occurrence(0, index::SymbolRole::Reference, 3, 18),
+      occurrence(2, index::SymbolRole::Reference, 3, 28),
+  };
+  index::IndexRecordStore Store(StorePath);
+  std::string RecordName = index::IndexRecordStore::getRecordName(Content);
+  ASSERT_FALSE(Store.writeRecord(RecordName, Record));
+
+  std::string MainPath = testPath("main.cpp");
+  std::string HeaderPath = testPath("header.h");
+  index::IndexUnit Unit;
+  Unit.MainFile = MainPath;
+  Unit.Files = {{MainPath, RecordName, false}, {HeaderPath, "0123", false}};
+  ASSERT_FALSE(Store.writeUnit(Unit));
+
+  auto Shard = loadIndexStoreShard(Store, MainPath, Content);
+  ASSERT_TRUE(Shard);
+  // h is only referenced in this file.
+  EXPECT_THAT(*Shard->Symbols,
+              UnorderedElementsAre(AllOf(Named("f"), Declared(), Defined()),
+                                   AllOf(Named("g"), Declared(), Defined())));
+  EXPECT_EQ(Shard->Symbols->find(SymbolID("c:@F@f"))
+                ->CanonicalDeclaration.Start.line(),
+            0u);
+  EXPECT_THAT(*Shard->Refs,
+              UnorderedElementsAre(
+                  Pair(SymbolID("c:@F@f"),
+                       UnorderedElementsAre(RefAt(0u, 4u), RefAt(1u, 4u),
+                                            RefAt(2u, 17u))),
+                  Pair(SymbolID("c:@F@g"), ElementsAre(RefAt(2u, 4u))),
+                  Pair(SymbolID("c:@F@ns::h"), ElementsAre(RefAt(2u, 27u)))));
+
+  std::string MainURI = URI::create(MainPath).toString();
+  std::string HeaderURI = URI::create(HeaderPath).toString();
+  EXPECT_THAT(Shard->Sources->keys(), UnorderedElementsAre(MainURI, HeaderURI));
+  const IncludeGraphNode &Node = Shard->Sources->lookup(MainURI);
+  EXPECT_EQ(Node.Digest, digest(Content));
+  EXPECT_TRUE(Node.Flags & IncludeGraphNode::SourceFlag::IsTU);
+  EXPECT_THAT(Node.DirectIncludes, ElementsAre(HeaderURI));
+}
+
+TEST_F(IndexStoreTest, HeaderWithoutUnit) {
+  std::string Content = "header contents";
+  index::IndexRecordStore Store(StorePath);
+  ASSERT_FALSE(Store.writeRecord(
+      index::IndexRecordStore::getRecordName(Content), index::IndexRecord()));
+
+  std::string HeaderPath = testPath("header.h");
+  auto Shard = loadIndexStoreShard(Store, HeaderPath, Content);
+  ASSERT_TRUE(Shard);
+  EXPECT_THAT(*Shard->Symbols, IsEmpty());
+  std::string HeaderURI = URI::create(HeaderPath).toString();
+  const IncludeGraphNode &Node = Shard->Sources->lookup(HeaderURI);
+  EXPECT_FALSE(Node.Flags & IncludeGraphNode::SourceFlag::IsTU);
+  EXPECT_THAT(Node.DirectIncludes, IsEmpty());
+}
+
+TEST_F(IndexStoreTest, NoRecordForContents) {
+  index::IndexRecordStore Store(StorePath);
+  ASSERT_FALSE(Store.writeRecord(
+      index::IndexRecordStore::getRecordName("old contents"),
+      index::IndexRecord()));
+  EXPECT_FALSE(
+      loadIndexStoreShard(Store, testPath("header.h"), "new contents"));
+}
+
+} // namespace
+} // namespace clangd
+} // namespace clang
@@ -9,6 +9,7 @@
 #include "Headers.h"
 #include "index/Index.h"
 #include "index/Serialization.h"
+#include "index/dex/Dex.h"
 #include "clang/Tooling/CompilationDatabase.h"
 #include "llvm/Support/SHA1.h"
 #include "llvm/Support/ScopedPrinter.h"
@@ -202,6 +203,47 @@ TEST(SerializationTest, BinaryConversions) {
               UnorderedElementsAreArray(YAMLFromRelations(*In->Relations)));
 }
 
+TEST(SerializationTest, DexPostings) {
+  auto In = readIndexFile(YAML);
+  ASSERT_TRUE(bool(In)) << In.takeError();
+
+  IndexFileOut Out(*In);
+  Out.Format = IndexFileFormat::RIFF;
+  Out.DexPostings = true;
+  std::string Serialized = llvm::to_string(Out);
+
+  auto In2 = readIndexFile(Serialized);
+  ASSERT_TRUE(bool(In2)) << In2.takeError();
+  ASSERT_TRUE(In2->Symbols);
+  ASSERT_TRUE(In2->DexPostings);
+
+  // An index using the stored posting lists finds the same symbols as one
+  // that builds them.
+  std::vector<const Symbol *> Ranked;
+  for (uint32_t I : In2->DexPostings->RankedSymbols)
+    Ranked.push_back(&*(In2->Symbols->begin() + I));
+  dex::Dex Loaded(std::move(Ranked),
+                  std::vector<std::pair<SymbolID, llvm::ArrayRef<Ref>>>(),
+                  std::vector<Relation>(),
+                  std::move(In2->DexPostings->PostingLists), /*Payload=*/0,
+                  /*BackingDataSize=*/0);
+  auto Built = dex::Dex::build(std::move(*In->Symbols), RefSlab(),
+                               RelationSlab());
+  for (llvm::StringRef Query : {"", "Foo", "Foo2"}) {
+    FuzzyFindRequest Req;
+    Req.Query = Query;
+    Req.AnyScope = true;
+    std::vector<std::string> Expected, Actual;
+    Built->fuzzyFind(Req, [&](const Symbol &S) {
+      Expected.push_back(S.ID.str());
+    });
+    Loaded.fuzzyFind(Req, [&](const Symbol &S) {
+      Actual.push_back(S.ID.str());
+    });
+    EXPECT_THAT(Actual, UnorderedElementsAreArray(Expected)) << Query;
+  }
+}
+
 TEST(SerializationTest, SrcsTest) {
   auto In = readIndexFile(YAML);
   EXPECT_TRUE(bool(In)) << In.takeError();
@@ -512,7 +512,7 @@ TEST_F(TUSchedulerTests, EmptyPreamble) {
       [&](Expected<InputsAndPreamble> Preamble) {
         // We expect to get a non-empty preamble.
         EXPECT_GT(
-            cantFail(std::move(Preamble)).Preamble->Preamble.getBounds().Size,
+            cantFail(std::move(Preamble)).Preamble->Preamble->getBounds().Size,
             0u);
       });
   // Wait for the preamble is being built.
@@ -527,11 +527,52 @@ TEST_F(TUSchedulerTests, EmptyPreamble) {
       [&](Expected<InputsAndPreamble> Preamble) {
         // We expect to get an empty preamble.
         EXPECT_EQ(
-            cantFail(std::move(Preamble)).Preamble->Preamble.getBounds().Size,
+            cantFail(std::move(Preamble)).Preamble->Preamble->getBounds().Size,
             0u);
       });
 }
 
+TEST_F(TUSchedulerTests, SharedPreamble) {
+  TUScheduler S(CDB,
+                /*AsyncThreadsCount=*/getDefaultAsyncThreadsCount(),
+                /*StorePreambleInMemory=*/true, /*ASTCallbacks=*/nullptr,
+                /*UpdateDebounce=*/std::chrono::steady_clock::duration::zero(),
+                ASTRetentionPolicy());
+
+  auto Foo = testPath("foo.cpp");
+  auto Bar = testPath("bar.cpp");
+  auto Header = testPath("foo.h");
+
+  Files[Header] = "void foo();";
+  Timestamps[Header] = time_t(0);
+  auto Contents = R"cpp(
+    #include "foo.h"
+    int main() { foo(); }
+  )cpp";
+  S.update(Foo, getInputs(Foo, Contents), WantDiagnostics::Auto);
+  ASSERT_TRUE(S.blockUntilIdle(timeoutSeconds(10)));
+  S.update(Bar, getInputs(Bar, Contents), WantDiagnostics::Auto);
+  ASSERT_TRUE(S.blockUntilIdle(timeoutSeconds(10)));
+
+  // Both files start with the same includes and are built with the same
+  // flags, so they should use the same PCH.
+  const PrecompiledPreamble *FooPCH = nullptr;
+  const PrecompiledPreamble *BarPCH = nullptr;
+  S.runWithPreamble("getFooPreamble", Foo, TUScheduler::Stale,
+                    [&](Expected<InputsAndPreamble> Preamble) {
+                      FooPCH = cantFail(std::move(Preamble))
+                                   .Preamble->Preamble.get();
+                    });
+  S.runWithPreamble("getBarPreamble", Bar, TUScheduler::Stale,
+                    [&](Expected<InputsAndPreamble> Preamble) {
+                      BarPCH = cantFail(std::move(Preamble))
+                                   .Preamble->Preamble.get();
+                    });
+  ASSERT_TRUE(S.blockUntilIdle(timeoutSeconds(10)));
+  EXPECT_NE(FooPCH, nullptr);
+  EXPECT_EQ(FooPCH, BarPCH);
+}
+
 TEST_F(TUSchedulerTests, RunWaitsForPreamble) {
   // Testing strategy: we update the file and schedule a few preamble reads at
   // the same time. All reads should get the same non-null preamble.
@@ -126,6 +126,11 @@ public:
 
       /// Per bucket timing information.
       llvm::StringMap<llvm::TimeRecord> &Records;
+
+      /// Record the time spent in the callbacks in a bucket of their own,
+      /// named after the id with a ".callback" suffix, instead of together
+      /// with the time spent evaluating their matchers.
+      bool SeparateCallbacks = false;
     };
 
     /// Enables per-check timers.
@@ -3159,10 +3159,16 @@ AST_MATCHER_P(CallExpr, callee, internal::Matcher<Stmt>,
 ///   class Y { public: void x(); };
 ///   void z() { Y y; y.x(); }
 /// \endcode
-AST_MATCHER_P_OVERLOAD(CallExpr, callee, internal::Matcher<Decl>, InnerMatcher,
-                       1) {
-  return callExpr(hasDeclaration(InnerMatcher)).matches(Node, Finder, Builder);
+///
+/// Unlike most matchers, this one is not opaque to the \c MatchFinder: when
+/// \p InnerMatcher only matches declarations with given names, the finder
+/// only runs it on calls that have one of those names.
+inline internal::Matcher<CallExpr>
+callee(const internal::Matcher<Decl> &InnerMatcher) {
+  return callExpr(hasDeclaration(InnerMatcher));
 }
+typedef internal::Matcher<CallExpr> (&callee_Type1)(
+    const internal::Matcher<Decl> &InnerMatcher);
 
 /// Matches if the expression's or declaration's type matches a type
 /// matcher.
@@ -282,6 +282,17 @@ public:
   virtual bool dynMatches(const ast_type_traits::DynTypedNode &DynNode,
                           ASTMatchFinder *Finder,
                           BoundNodesTreeBuilder *Builder) const = 0;
+
+  /// Returns true if this matcher can only match nodes whose name is one of
+  /// a known set, and adds those names to \p Names.
+  ///
+  /// The name of a \c NamedDecl is its identifier, and the name of a
+  /// \c CallExpr is the identifier of its callee declaration. This lets the
+  /// \c MatchFinder skip matchers that cannot match a node without running
+  /// them. \p Names is left unchanged if false is returned.
+  virtual bool getRequiredNames(std::vector<std::string> &Names) const {
+    return false;
+  }
 };
 
 /// Generic interface for matchers on an AST node of type T.
@@ -398,6 +409,14 @@ public:
                           ASTMatchFinder *Finder,
                           BoundNodesTreeBuilder *Builder) const;
 
+  /// Returns true if the matcher can only match nodes with one of a known set
+  /// of names, and adds them to \p Names.
+  ///
+  /// \sa DynMatcherInterface::getRequiredNames()
+  bool getRequiredNames(std::vector<std::string> &Names) const {
+    return Implementation->getRequiredNames(Names);
+  }
+
   /// Bind the specified \p ID to the matcher.
   /// \return A new matcher with the \p ID bound to it if this matcher supports
   ///   binding. Otherwise, returns an empty \c Optional<>.
@@ -707,6 +726,8 @@ class HasNameMatcher : public SingleNodeMatcherInterface<NamedDecl> {
 
   bool matchesNode(const NamedDecl &Node) const override;
 
+  bool getRequiredNames(std::vector<std::string> &Names) const override;
+
  private:
   /// Unqualified match routine.
   ///
@@ -760,6 +781,14 @@ public:
     return matchesSpecialized(Node, Finder, Builder);
   }
 
+  bool getRequiredNames(std::vector<std::string> &Names) const override {
+    // The name of a call expression is the name of its callee declaration,
+    // which is what the inner matcher is run on.
+    return std::is_base_of<CallExpr, T>::value &&
+           this->InnerMatcher.getRequiredNames(Names);
+  }
+
+
 private:
   /// Forwards to matching on the underlying type of the QualType.
   bool matchesSpecialized(const QualType &Node, ASTMatchFinder *Finder,
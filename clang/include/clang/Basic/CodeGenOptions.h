@@ -286,6 +286,16 @@ public:
   /// List of backend command-line options for -fembed-bitcode.
   std::vector<uint8_t> CmdArgs;
 
+  /// The directory of the cache of the backend outputs, if not empty.
+  std::string BackendCachePath;
+
+  /// The pruning policy of the backend cache.
+  std::string BackendCachePolicy;
+
+  /// The command-line options that are part of the key of the backend cache,
+  /// rendered as strings.
+  std::vector<std::string> BackendCacheArgs;
+
   /// A list of all -fno-builtin-* function names (e.g., memset).
   std::vector<std::string> NoBuiltinFuncs;
 
@@ -23,6 +23,7 @@
 #include <cstdint>
 #include <ctime>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <utility>
 
@@ -83,6 +84,49 @@ public:
                           llvm::vfs::FileSystem &FS) override;
 };
 
+/// A thread-safe record of 'stat' results that outlives a single compiler
+/// invocation, so that the FileManagers of many invocations in one process
+/// (e.g. the workers of a dependency scanner or a build server) only go to
+/// the file system once per path.
+///
+/// Unlike \c MemorizeStatCalls, failed lookups are cached too: header search
+/// probes every include directory and most of those probes fail. Only
+/// absolute paths are cached, since relative ones depend on the working
+/// directory of each invocation. The owner must call \c clear() whenever the
+/// file system may have changed.
+class SharedStatCache {
+public:
+  /// Look up \p Path, going to \p FS on a miss and caching the result.
+  std::error_code getStat(StringRef Path, llvm::vfs::Status &Status,
+                          llvm::vfs::FileSystem &FS);
+
+  /// Forget all cached results.
+  void clear();
+
+private:
+  struct Entry {
+    llvm::vfs::Status Status;
+    std::error_code EC;
+  };
+
+  std::mutex Lock;
+  llvm::StringMap<Entry, llvm::BumpPtrAllocator> Entries;
+};
+
+/// A FileManager stat cache that answers from a \c SharedStatCache.
+class SharedStatCacheClient : public FileSystemStatCache {
+public:
+  explicit SharedStatCacheClient(SharedStatCache &Shared) : Shared(Shared) {}
+
+  std::error_code getStat(StringRef Path, llvm::vfs::Status &Status,
+                          bool isFile,
+                          std::unique_ptr<llvm::vfs::File> *F,
+                          llvm::vfs::FileSystem &FS) override;
+
+private:
+  SharedStatCache &Shared;
+};
+
 } // namespace clang
 
 #endif // LLVM_CLANG_BASIC_FILESYSTEMSTATCACHE_H
@@ -172,6 +172,9 @@ private:
   const T *findDefInDeclContext(const DeclContext *DC,
                                 StringRef LookupName);
   template <typename T>
+  const T *findDefByNameLookup(const T *D, ASTContext &From,
+                               StringRef LookupName);
+  template <typename T>
   llvm::Expected<const T *> importDefinitionImpl(const T *D);
 
   llvm::StringMap<std::unique_ptr<clang::ASTUnit>> FileASTUnitMap;
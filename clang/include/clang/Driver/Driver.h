@@ -199,6 +199,12 @@ public:
   /// Whether the driver is generating diagnostics for debugging purposes.
   unsigned CCGenDiagnostics : 1;
 
+  /// Pointer to the cc1 entry point of the driver executable, used to run
+  /// -cc1 jobs in-process when -fintegrated-cc1 is given. Null if the
+  /// executable cannot do that.
+  typedef int (*CC1ToolFunc)(SmallVectorImpl<const char *> &ArgV);
+  CC1ToolFunc CC1Main = nullptr;
+
 private:
   /// Raw target triple.
   std::string TargetTriple;
@@ -52,12 +52,17 @@ class Command {
   /// argument, which will be the executable).
   llvm::opt::ArgStringList Arguments;
 
+protected:
   /// The list of program arguments which are inputs.
   llvm::opt::ArgStringList InputFilenames;
 
   /// Whether to print the input filenames when executing.
   bool PrintInputFilenames = false;
 
+  /// See Command::setEnvironment
+  std::vector<const char *> Environment;
+
+private:
   /// Response file name, if this command is set to use one, or nullptr
   /// otherwise
   const char *ResponseFile = nullptr;
@@ -70,9 +75,6 @@ class Command {
   /// file
   std::string ResponseFileFlag;
 
-  /// See Command::setEnvironment
-  std::vector<const char *> Environment;
-
   /// When a response file is needed, we try to put most arguments in an
   /// exclusive file, while others remains as regular command line arguments.
   /// This functions fills a vector with the regular command line arguments,
@@ -132,6 +134,19 @@ public:
   void setPrintInputFilenames(bool P) { PrintInputFilenames = P; }
 };
 
+/// Like Command, but runs the -cc1 job in the driver's own process instead of
+/// spawning a new one.
+class CC1Command : public Command {
+public:
+  CC1Command(const Action &Source_, const Tool &Creator_,
+             const char *Executable_,
+             const llvm::opt::ArgStringList &Arguments_,
+             ArrayRef<InputInfo> Inputs);
+
+  int Execute(ArrayRef<Optional<StringRef>> Redirects, std::string *ErrMsg,
+              bool *ExecutionFailed) const override;
+};
+
 /// Like Command, but with a fallback which is executed in case
 /// the primary command crashes.
 class FallbackCommand : public Command {
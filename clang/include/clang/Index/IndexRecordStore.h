@@ -0,0 +1,105 @@
+//===--- IndexRecordStore.h - On-disk index records -------------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// An index store is a directory where the compiler writes the index data of the
+// translation units it builds (see -index-store-path), so that other tools can
+// use it without parsing the code again:
+//
+//   <store>/records/<record name>
+//     The symbols and occurrences of one source or header file. The record
+//     name is derived from the contents of the file, so a header included by
+//     many translation units is written once, and a record is never stale.
+//
+//   <store>/units/<unit name>
+//     The files of one translation unit and the name of their records. The
+//     unit name is derived from the path of the main file.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_INDEX_INDEXRECORDSTORE_H
+#define LLVM_CLANG_INDEX_INDEXRECORDSTORE_H
+
+#include "clang/Basic/LLVM.h"
+#include "clang/Index/IndexSymbol.h"
+#include "llvm/Support/Error.h"
+#include <string>
+#include <vector>
+
+namespace clang {
+namespace index {
+
+/// A symbol occurring in a record.
+struct StoredSymbol {
+  SymbolInfo Info;
+  std::string USR;
+  std::string Name;
+  /// The enclosing scopes of the symbol, e.g. "ns::Class::".
+  std::string Scope;
+};
+
+/// An occurrence of a symbol in the file of a record.
+struct StoredOccurrence {
+  /// The index of the symbol in the record.
+  unsigned Symbol;
+  SymbolRoleSet Roles;
+  /// The 1-based line and column of the occurrence, and the length of its
+  /// token, in bytes.
+  unsigned Line;
+  unsigned Column;
+  unsigned Length;
+};
+
+/// The index data of one file.
+struct IndexRecord {
+  std::vector<StoredSymbol> Symbols;
+  /// Sorted by line and column.
+  std::vector<StoredOccurrence> Occurrences;
+};
+
+/// The files of a translation unit and the names of their records.
+struct IndexUnit {
+  struct FileRecord {
+    std::string Path;
+    std::string RecordName;
+    bool IsSystem;
+  };
+
+  std::string MainFile;
+  /// The main file comes first.
+  std::vector<FileRecord> Files;
+};
+
+/// Reads and writes the records and units of an index store. The files are
+/// written atomically, so a store can be shared by concurrent compilations.
+class IndexRecordStore {
+public:
+  explicit IndexRecordStore(StringRef StorePath) : StorePath(StorePath) {}
+
+  StringRef getStorePath() const { return StorePath; }
+
+  /// Returns the name of the record of a file with the contents
+  /// \p FileContent.
+  static std::string getRecordName(StringRef FileContent);
+
+  bool hasRecord(StringRef RecordName) const;
+  llvm::Error writeRecord(StringRef RecordName,
+                          const IndexRecord &Record) const;
+  llvm::Expected<IndexRecord> readRecord(StringRef RecordName) const;
+
+  llvm::Error writeUnit(const IndexUnit &Unit) const;
+  /// Reads the unit of the translation unit with the main file \p MainFile.
+  llvm::Expected<IndexUnit> readUnit(StringRef MainFile) const;
+
+private:
+  std::string StorePath;
+};
+
+} // namespace index
+} // namespace clang
+
+#endif // LLVM_CLANG_INDEX_INDEXRECORDSTORE_H
@@ -56,6 +56,13 @@ createIndexingAction(std::shared_ptr<IndexDataConsumer> DataConsumer,
                      IndexingOptions Opts,
                      std::unique_ptr<FrontendAction> WrappedAction);
 
+/// Creates a frontend action that writes the index data of the translation
+/// unit to the index store at \p StorePath (see IndexRecordStore.h), in
+/// addition to running \p WrappedAction.
+std::unique_ptr<FrontendAction>
+createIndexDataRecordingAction(StringRef StorePath, IndexingOptions Opts,
+                               std::unique_ptr<FrontendAction> WrappedAction);
+
 /// Recursively indexes all decls in the AST.
 void indexASTUnit(ASTUnit &Unit, IndexDataConsumer &DataConsumer,
                   IndexingOptions Opts);
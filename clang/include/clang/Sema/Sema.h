@@ -7577,6 +7577,14 @@ public:
   // FIXME: Does this belong in Sema? It's tough to implement it anywhere else.
   unsigned LastEmittedCodeSynthesisContextDepth = 0;
 
+  /// The number of class and function template instantiations performed so
+  /// far, reported to -ftime-trace.
+  unsigned NumTimeTracedInstantiations = 0;
+
+  /// Record the instantiation count and the AST memory in use as
+  /// -ftime-trace counters.
+  void traceInstantiationCounters();
+
   /// The template instantiation callbacks to trace or track
   /// instantiations (objects can be chained).
   ///
@@ -1010,6 +1010,14 @@ private:
   /// Total size of modules, in bits, currently loaded
   uint64_t TotalModulesSizeInBits = 0;
 
+  /// The number of successful calls to ReadAST(), i.e. of PCH, preamble and
+  /// module imports.
+  unsigned NumASTImports = 0;
+
+  /// The number of AST files loaded by those imports, and their total size.
+  unsigned NumASTFilesLoaded = 0;
+  uint64_t TotalASTFileBytesLoaded = 0;
+
   /// Number of Decl/types that are currently deserializing.
   unsigned NumCurrentElementsDeserializing = 0;
 
@@ -0,0 +1,84 @@
+//===- DependencyScanningFilesystem.h - clang-scan-deps fs ===---*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_TOOLING_DEPENDENCY_SCANNING_FILESYSTEM_H
+#define LLVM_CLANG_TOOLING_DEPENDENCY_SCANNING_FILESYSTEM_H
+
+#include "clang/Basic/LLVM.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Support/Allocator.h"
+#include "llvm/Support/ErrorOr.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/VirtualFileSystem.h"
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace clang {
+namespace tooling {
+namespace dependencies {
+
+/// The minimized contents of every file read through a
+/// \c DependencyScanningFilesystem, shared by all the workers of a scan.
+///
+/// Sources are minimized down to the preprocessor directives that can affect
+/// their dependencies, so that each file is lexed in full only once per scan.
+/// If a cache directory is given, minimized sources are also stored there,
+/// keyed by a hash of the original contents, so that a later scan only has to
+/// minimize the files that changed.
+class MinimizedSourceCache {
+public:
+  struct Entry {
+    /// The error reported when the file was read, if any.
+    std::error_code EC;
+    /// The status of the file, with its size adjusted to \c Contents.
+    llvm::vfs::Status Status;
+    /// The minimized contents. Null for directories.
+    std::unique_ptr<llvm::MemoryBuffer> Contents;
+  };
+
+  explicit MinimizedSourceCache(StringRef CacheDir = "") : CacheDir(CacheDir) {}
+
+  /// Return the entry for the absolute path \p Path, reading it from \p FS
+  /// on first use. The returned reference stays valid for the lifetime of the
+  /// cache.
+  const Entry &get(StringRef Path, llvm::vfs::FileSystem &FS);
+
+private:
+  std::unique_ptr<llvm::MemoryBuffer> minimize(StringRef Path,
+                                               const llvm::MemoryBuffer &Input);
+
+  std::string CacheDir;
+  std::mutex Lock;
+  llvm::StringMap<Entry, llvm::BumpPtrAllocator> Entries;
+};
+
+/// A file system that serves the minimized contents of source files from a
+/// \c MinimizedSourceCache instead of their original contents.
+class DependencyScanningFilesystem : public llvm::vfs::ProxyFileSystem {
+public:
+  DependencyScanningFilesystem(
+      MinimizedSourceCache &Cache,
+      IntrusiveRefCntPtr<llvm::vfs::FileSystem> FS)
+      : ProxyFileSystem(std::move(FS)), Cache(Cache) {}
+
+  llvm::ErrorOr<llvm::vfs::Status> status(const Twine &Path) override;
+  llvm::ErrorOr<std::unique_ptr<llvm::vfs::File>>
+  openFileForRead(const Twine &Path) override;
+
+private:
+  const MinimizedSourceCache::Entry &getEntry(const Twine &Path);
+
+  MinimizedSourceCache &Cache;
+};
+
+} // end namespace dependencies
+} // end namespace tooling
+} // end namespace clang
+
+#endif // LLVM_CLANG_TOOLING_DEPENDENCY_SCANNING_FILESYSTEM_H
@@ -18,9 +18,14 @@
 #include <string>
 
 namespace clang {
+
+class SharedStatCache;
+
 namespace tooling {
 namespace dependencies {
 
+class MinimizedSourceCache;
+
 /// An individual dependency scanning worker that is able to run on its own
 /// thread.
 ///
@@ -29,7 +34,13 @@ namespace dependencies {
 /// using the regular processing run.
 class DependencyScanningWorker {
 public:
-  DependencyScanningWorker();
+  /// \param StatCache If non-null, a stat cache shared with the other
+  /// workers, which must outlive this worker.
+  /// \param MinimizedSources If non-null, the worker preprocesses minimized
+  /// sources from this cache, which must outlive this worker, instead of the
+  /// original files.
+  DependencyScanningWorker(SharedStatCache *StatCache = nullptr,
+                           MinimizedSourceCache *MinimizedSources = nullptr);
 
   /// Print out the dependency information into a string using the dependency
   /// file format that is specified in the options (-MD is the default) and
@@ -49,6 +60,8 @@ private:
   /// dependencies. This filesystem persists accross multiple compiler
   /// invocations.
   llvm::IntrusiveRefCntPtr<llvm::vfs::FileSystem> WorkerFS;
+
+  SharedStatCache *StatCache;
 };
 
 } // end namespace dependencies
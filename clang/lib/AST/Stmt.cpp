@@ -87,22 +87,32 @@ void Stmt::PrintStats() {
   // Ensure the table is primed.
   getStmtInfoTableEntry(Stmt::NullStmtClass);
 
-  unsigned sum = 0;
+  // Use 64-bit totals: the largest translation units allocate well over 4GB
+  // of nodes.
+  uint64_t sum = 0;
+  SmallVector<const StmtClassNameTable *, 64> UsedClasses;
   llvm::errs() << "\n*** Stmt/Expr Stats:\n";
   for (int i = 0; i != Stmt::lastStmtConstant+1; i++) {
     if (StmtClassInfo[i].Name == nullptr) continue;
     sum += StmtClassInfo[i].Counter;
+    if (StmtClassInfo[i].Counter != 0)
+      UsedClasses.push_back(&StmtClassInfo[i]);
   }
   llvm::errs() << "  " << sum << " stmts/exprs total.\n";
+
+  // List the node kinds that take up the most memory first.
+  auto getBytes = [](const StmtClassNameTable *Info) {
+    return uint64_t(Info->Counter) * Info->Size;
+  };
+  llvm::sort(UsedClasses.begin(), UsedClasses.end(),
+             [&](const StmtClassNameTable *A, const StmtClassNameTable *B) {
+               return getBytes(A) > getBytes(B);
+             });
   sum = 0;
-  for (int i = 0; i != Stmt::lastStmtConstant+1; i++) {
-    if (StmtClassInfo[i].Name == nullptr) continue;
-    if (StmtClassInfo[i].Counter == 0) continue;
-    llvm::errs() << "    " << StmtClassInfo[i].Counter << " "
-                 << StmtClassInfo[i].Name << ", " << StmtClassInfo[i].Size
-                 << " each (" << StmtClassInfo[i].Counter*StmtClassInfo[i].Size
-                 << " bytes)\n";
-    sum += StmtClassInfo[i].Counter*StmtClassInfo[i].Size;
+  for (const StmtClassNameTable *Info : UsedClasses) {
+    llvm::errs() << "    " << Info->Counter << " " << Info->Name << ", "
+                 << Info->Size << " each (" << getBytes(Info) << " bytes)\n";
+    sum += getBytes(Info);
   }
 
   llvm::errs() << "Total bytes = " << sum << "\n";
@@ -22,7 +22,9 @@
 #include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/StringMap.h"
 #include "llvm/Support/Timer.h"
+#include <algorithm>
 #include <deque>
+#include <iterator>
 #include <memory>
 #include <set>
 
@@ -317,7 +319,7 @@ public:
     TimeBucketRegion Timer;
     for (MatchCallback *MC : Matchers->AllCallbacks) {
       if (EnableCheckProfiling)
-        Timer.setBucket(&TimeByBucket[MC->getID()]);
+        Timer.setBucket(getCallbackBucket(MC));
       MC->onStartOfTranslationUnit();
     }
   }
@@ -327,7 +329,7 @@ public:
     TimeBucketRegion Timer;
     for (MatchCallback *MC : Matchers->AllCallbacks) {
       if (EnableCheckProfiling)
-        Timer.setBucket(&TimeByBucket[MC->getID()]);
+        Timer.setBucket(getCallbackBucket(MC));
       MC->onEndOfTranslationUnit();
     }
   }
@@ -541,6 +543,8 @@ private:
         Timer.setBucket(&TimeByBucket[MP.second->getID()]);
       BoundNodesTreeBuilder Builder;
       if (MP.first.matches(Node, this, &Builder)) {
+        if (EnableCheckProfiling)
+          Timer.setBucket(getCallbackBucket(MP.second));
         MatchVisitor Visitor(ActiveASTContext, MP.second);
         Builder.visitMatches(&Visitor);
       }
@@ -553,32 +557,92 @@ private:
     const auto &Filter =
         it != MatcherFiltersMap.end() ? it->second : getFilterForKind(Kind);
 
-    if (Filter.empty())
+    if (Filter.All.empty())
       return;
 
+    StringRef Name;
+    if (Filter.AnyName.size() != Filter.All.size())
+      Name = getDispatchName(DynNode);
+    if (Name.empty()) {
+      matchWithIndices(DynNode, Filter.All);
+      return;
+    }
+
+    auto ByName = Filter.ByName.find(Name);
+    if (ByName == Filter.ByName.end()) {
+      matchWithIndices(DynNode, Filter.AnyName);
+      return;
+    }
+    // Run the matchers in the order they were added.
+    SmallVector<unsigned short, 32> Indices;
+    std::merge(Filter.AnyName.begin(), Filter.AnyName.end(),
+               ByName->second.begin(), ByName->second.end(),
+               std::back_inserter(Indices));
+    matchWithIndices(DynNode, Indices);
+  }
+
+  /// Runs the \c DeclOrStmt matchers at \p Indices on \p DynNode.
+  ///
+  /// They must all be able to match nodes of the kind of \p DynNode.
+  void matchWithIndices(const ast_type_traits::DynTypedNode &DynNode,
+                        ArrayRef<unsigned short> Indices) {
     const bool EnableCheckProfiling = Options.CheckProfiling.hasValue();
     TimeBucketRegion Timer;
     auto &Matchers = this->Matchers->DeclOrStmt;
-    for (unsigned short I : Filter) {
+    for (unsigned short I : Indices) {
       auto &MP = Matchers[I];
       if (EnableCheckProfiling)
         Timer.setBucket(&TimeByBucket[MP.second->getID()]);
       BoundNodesTreeBuilder Builder;
       if (MP.first.matchesNoKindCheck(DynNode, this, &Builder)) {
+        if (EnableCheckProfiling)
+          Timer.setBucket(getCallbackBucket(MP.second));
         MatchVisitor Visitor(ActiveASTContext, MP.second);
         Builder.visitMatches(&Visitor);
       }
     }
   }
 
-  const std::vector<unsigned short> &
-  getFilterForKind(ast_type_traits::ASTNodeKind Kind) {
+  /// Returns the name that matchers which only match nodes with given names
+  /// are looked up by, or an empty string if all matchers have to be run on
+  /// \p DynNode.
+  ///
+  /// \sa internal::DynMatcherInterface::getRequiredNames()
+  static StringRef
+  getDispatchName(const ast_type_traits::DynTypedNode &DynNode) {
+    const Decl *D;
+    if (const auto *Call = DynNode.get<CallExpr>())
+      D = Call->getCalleeDecl();
+    else
+      D = DynNode.get<Decl>();
+    // Nodes without an identifier, like constructors, can still match name
+    // based matchers.
+    if (const auto *ND = dyn_cast_or_null<NamedDecl>(D))
+      if (const IdentifierInfo *II = ND->getIdentifier())
+        return II->getName();
+    return StringRef();
+  }
+
+  struct MatcherFilter;
+
+  const MatcherFilter &getFilterForKind(ast_type_traits::ASTNodeKind Kind) {
     auto &Filter = MatcherFiltersMap[Kind];
     auto &Matchers = this->Matchers->DeclOrStmt;
     assert((Matchers.size() < USHRT_MAX) && "Too many matchers.");
+    std::vector<std::string> Names;
     for (unsigned I = 0, E = Matchers.size(); I != E; ++I) {
-      if (Matchers[I].first.canMatchNodesOfKind(Kind)) {
-        Filter.push_back(I);
+      if (!Matchers[I].first.canMatchNodesOfKind(Kind))
+        continue;
+      Filter.All.push_back(I);
+      Names.clear();
+      if (!Matchers[I].first.getRequiredNames(Names)) {
+        Filter.AnyName.push_back(I);
+        continue;
+      }
+      for (const std::string &Name : Names) {
+        auto &Indices = Filter.ByName[Name];
+        if (Indices.empty() || Indices.back() != I)
+          Indices.push_back(I);
       }
     }
     return Filter;
@@ -762,11 +826,29 @@ private:
     return false;
   }
 
+  /// Returns the bucket that the time spent in \p MC itself, rather than in
+  /// its matchers, is recorded in.
+  ///
+  /// This is the same bucket as for the matchers unless the profile was asked
+  /// to keep them apart.
+  llvm::TimeRecord *getCallbackBucket(MatchCallback *MC) {
+    if (!Options.CheckProfiling->SeparateCallbacks)
+      return &TimeByBucket[MC->getID()];
+    llvm::TimeRecord *&Bucket = CallbackBuckets[MC];
+    if (!Bucket)
+      Bucket = &TimeByBucket[(MC->getID() + ".callback").str()];
+    return Bucket;
+  }
+
   /// Bucket to record map.
   ///
   /// Used to get the appropriate bucket for each matcher.
   llvm::StringMap<llvm::TimeRecord> TimeByBucket;
 
+  /// Cache of the callback buckets in \c TimeByBucket, to avoid building
+  /// their names for every match.
+  llvm::DenseMap<MatchCallback *, llvm::TimeRecord *> CallbackBuckets;
+
   const MatchFinder::MatchersByType *Matchers;
 
   /// Filtered list of matcher indices for each matcher kind.
@@ -777,8 +859,15 @@ private:
   /// We precalculate a list of matchers that pass the toplevel restrict check.
   /// This also allows us to skip the restrict check at matching time. See
   /// use \c matchesNoKindCheck() above.
-  llvm::DenseMap<ast_type_traits::ASTNodeKind, std::vector<unsigned short>>
-      MatcherFiltersMap;
+  /// Matchers that only match nodes with given names, like
+  /// \c callExpr(callee(functionDecl(hasName("f")))), are also indexed by
+  /// those names, so that they are only run on nodes that have them.
+  struct MatcherFilter {
+    std::vector<unsigned short> All;
+    std::vector<unsigned short> AnyName;
+    llvm::StringMap<std::vector<unsigned short>> ByName;
+  };
+  llvm::DenseMap<ast_type_traits::ASTNodeKind, MatcherFilter> MatcherFiltersMap;
 
   const MatchFinder::MatchFinderOptions &Options;
   ASTContext *ActiveASTContext;
@@ -17,6 +17,7 @@
 #include "clang/AST/DeclTemplate.h"
 #include "clang/AST/PrettyPrinter.h"
 #include "clang/ASTMatchers/ASTMatchers.h"
+#include "clang/Basic/CharInfo.h"
 #include "clang/Basic/LLVM.h"
 #include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/IntrusiveRefCntPtr.h"
@@ -94,6 +95,23 @@ public:
     return Func(DynNode, Finder, Builder, InnerMatchers);
   }
 
+  bool getRequiredNames(std::vector<std::string> &Names) const override {
+    // It is enough for one of the matchers of an allOf() to restrict the
+    // names, while every alternative of an anyOf() or eachOf() has to.
+    if (Func == AllOfVariadicOperator)
+      return llvm::any_of(InnerMatchers, [&](const DynTypedMatcher &M) {
+        return M.getRequiredNames(Names);
+      });
+    if (Func != AnyOfVariadicOperator && Func != EachOfVariadicOperator)
+      return false;
+    std::vector<std::string> Alternatives;
+    for (const DynTypedMatcher &M : InnerMatchers)
+      if (!M.getRequiredNames(Alternatives))
+        return false;
+    Names.insert(Names.end(), Alternatives.begin(), Alternatives.end());
+    return true;
+  }
+
 private:
   std::vector<DynTypedMatcher> InnerMatchers;
 };
@@ -112,6 +130,10 @@ public:
     return Result;
   }
 
+  bool getRequiredNames(std::vector<std::string> &Names) const override {
+    return InnerMatcher->getRequiredNames(Names);
+  }
+
 private:
   const std::string ID;
   const IntrusiveRefCntPtr<DynMatcherInterface> InnerMatcher;
@@ -536,6 +558,23 @@ bool HasNameMatcher::matchesNodeFullSlow(const NamedDecl &Node) const {
   return false;
 }
 
+bool HasNameMatcher::getRequiredNames(std::vector<std::string> &Out) const {
+  // Only the last component of a pattern is compared with the name of the
+  // node itself. Other names, like those of operators, are printed rather
+  // than compared with the identifier.
+  std::vector<std::string> Required;
+  for (StringRef Name : Names) {
+    StringRef Last = Name.rsplit("::").second;
+    if (Last.empty())
+      Last = Name;
+    if (!isValidIdentifier(Last))
+      return false;
+    Required.push_back(Last);
+  }
+  Out.insert(Out.end(), Required.begin(), Required.end());
+  return true;
+}
+
 bool HasNameMatcher::matchesNode(const NamedDecl &Node) const {
   assert(matchesNodeFullFast(Node) == matchesNodeFullSlow(Node));
   if (UseUnqualifiedMatch) {
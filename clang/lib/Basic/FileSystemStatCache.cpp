@@ -118,3 +118,46 @@ MemorizeStatCalls::getStat(StringRef Path, llvm::vfs::Status &Status,
 
   return std::error_code();
 }
+
+std::error_code SharedStatCache::getStat(StringRef Path,
+                                         llvm::vfs::Status &Status,
+                                         llvm::vfs::FileSystem &FS) {
+  {
+    std::lock_guard<std::mutex> Guard(Lock);
+    auto It = Entries.find(Path);
+    if (It != Entries.end()) {
+      Status = It->second.Status;
+      return It->second.EC;
+    }
+  }
+
+  // Stat without holding the lock. Two threads may race to fill in the same
+  // path; they will see the same result, so either one may win.
+  Entry E;
+  llvm::ErrorOr<llvm::vfs::Status> StatusOrErr = FS.status(Path);
+  if (StatusOrErr)
+    E.Status = *StatusOrErr;
+  else
+    E.EC = StatusOrErr.getError();
+
+  std::lock_guard<std::mutex> Guard(Lock);
+  Entries.insert(std::make_pair(Path, E));
+  Status = E.Status;
+  return E.EC;
+}
+
+void SharedStatCache::clear() {
+  std::lock_guard<std::mutex> Guard(Lock);
+  Entries.clear();
+}
+
+std::error_code
+SharedStatCacheClient::getStat(StringRef Path, llvm::vfs::Status &Status,
+                               bool isFile,
+                               std::unique_ptr<llvm::vfs::File> *F,
+                               llvm::vfs::FileSystem &FS) {
+  if (!llvm::sys::path::is_absolute(Path))
+    return get(Path, Status, isFile, F, nullptr, FS);
+  // The file is opened later by the FileManager if it is actually needed.
+  return Shared.getStat(Path, Status, FS);
+}
@@ -11,6 +11,7 @@
 #include "clang/Basic/Diagnostic.h"
 #include "clang/Basic/LangOptions.h"
 #include "clang/Basic/TargetOptions.h"
+#include "clang/Basic/Version.h"
 #include "clang/Frontend/FrontendDiagnostic.h"
 #include "clang/Frontend/Utils.h"
 #include "clang/Lex/HeaderSearchOptions.h"
@@ -32,15 +33,18 @@
 #include "llvm/IR/Module.h"
 #include "llvm/IR/ModuleSummaryIndex.h"
 #include "llvm/IR/Verifier.h"
+#include "llvm/LTO/Caching.h"
 #include "llvm/LTO/LTOBackend.h"
 #include "llvm/MC/MCAsmInfo.h"
 #include "llvm/MC/SubtargetFeature.h"
 #include "llvm/Passes/PassBuilder.h"
 #include "llvm/Passes/PassPlugin.h"
 #include "llvm/Support/BuryPointer.h"
+#include "llvm/Support/CachePruning.h"
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/PrettyStackTrace.h"
+#include "llvm/Support/SHA1.h"
 #include "llvm/Support/TargetRegistry.h"
 #include "llvm/Support/TimeProfiler.h"
 #include "llvm/Support/Timer.h"
@@ -463,6 +467,7 @@ static void initTargetOptions(llvm::TargetOptions &Options,
   Options.UnsafeFPMath = CodeGenOpts.UnsafeFPMath;
   Options.StackAlignmentOverride = CodeGenOpts.StackAlignment;
   Options.FunctionSections = CodeGenOpts.FunctionSections;
+  Options.BBSections = CodeGenOpts.getBBSections();
   Options.DataSections = CodeGenOpts.DataSections;
   Options.UniqueSectionNames = CodeGenOpts.UniqueSectionNames;
   Options.EmulatedTLS = CodeGenOpts.EmulatedTLS;
@@ -1460,6 +1465,99 @@ static void runThinLTOBackend(ModuleSummaryIndex *CombinedIndex, Module *M,
   }
 }
 
+/// Returns true if the output of the backend for \p Action can be taken from
+/// the -fbackend-cache-path cache: the backend must write nothing but this
+/// output.
+static bool isBackendOutputCacheable(const CodeGenOptions &CGOpts,
+                                     BackendAction Action) {
+  return !CGOpts.BackendCachePath.empty() && Action != Backend_EmitNothing &&
+         Action != Backend_EmitMCNull && CGOpts.SplitDwarfOutput.empty() &&
+         CGOpts.ThinLinkBitcodeFile.empty() && CGOpts.OptRecordFile.empty() &&
+         !CGOpts.EmitGcovNotes && !CGOpts.TimePasses &&
+         !CGOpts.OptimizationRemarkPattern &&
+         !CGOpts.OptimizationRemarkMissedPattern &&
+         !CGOpts.OptimizationRemarkAnalysisPattern;
+}
+
+/// Computes the key of the output of the backend: a hash of the compiler, of
+/// the options, of the files that the backend reads, and of the IR. Returns an
+/// empty key if one of the files cannot be read.
+static std::string computeBackendCacheKey(const CodeGenOptions &CGOpts,
+                                          BackendAction Action,
+                                          const Module &M) {
+  SHA1 Hasher;
+  auto AddString = [&](StringRef S) {
+    Hasher.update(S);
+    // Separate the strings, so that "ab" "c" and "a" "bc" hash differently.
+    Hasher.update(StringRef("", 1));
+  };
+
+  AddString(getClangFullVersion());
+  AddString(utostr(Action));
+  for (const std::string &Arg : CGOpts.BackendCacheArgs)
+    AddString(Arg);
+
+  SmallVector<StringRef, 4> Files = {CGOpts.ProfileInstrumentUsePath,
+                                     CGOpts.SampleProfileFile,
+                                     CGOpts.ProfileRemappingFile};
+  Files.append(CGOpts.RewriteMapFiles.begin(), CGOpts.RewriteMapFiles.end());
+  for (StringRef File : Files) {
+    if (File.empty())
+      continue;
+    ErrorOr<std::unique_ptr<MemoryBuffer>> Buf = MemoryBuffer::getFile(File);
+    if (!Buf)
+      return std::string();
+    AddString((*Buf)->getBuffer());
+  }
+
+  SmallString<0> Bitcode;
+  raw_svector_ostream OS(Bitcode);
+  WriteBitcodeToFile(M, OS);
+  Hasher.update(Bitcode);
+  return toHex(Hasher.final());
+}
+
+/// Writes the output of the backend for \p M to \p OS, and takes it from the
+/// -fbackend-cache-path cache if it is there. \p Emit runs the backend.
+static void emitBackendOutputWithCache(
+    DiagnosticsEngine &Diags, const CodeGenOptions &CGOpts,
+    BackendAction Action, Module &M, std::unique_ptr<raw_pwrite_stream> OS,
+    function_ref<void(std::unique_ptr<raw_pwrite_stream>)> Emit) {
+  std::string Key = computeBackendCacheKey(CGOpts, Action, M);
+  if (Key.empty())
+    return Emit(std::move(OS));
+
+  std::unique_ptr<MemoryBuffer> CachedOutput;
+  Expected<lto::NativeObjectCache> Cache = lto::localCache(
+      CGOpts.BackendCachePath,
+      [&](unsigned Task, std::unique_ptr<MemoryBuffer> MB) {
+        CachedOutput = std::move(MB);
+      });
+  if (!Cache) {
+    Diags.Report(diag::warn_fe_backend_cache_unusable)
+        << CGOpts.BackendCachePath << toString(Cache.takeError());
+    return Emit(std::move(OS));
+  }
+
+  if (lto::AddStreamFn AddStream = (*Cache)(0, Key)) {
+    // The output is written to the cache only if the backend succeeds.
+    SmallString<0> Output;
+    Emit(llvm::make_unique<raw_svector_ostream>(Output));
+    if (!Diags.hasErrorOccurred()) {
+      // Destroying the stream moves the entry into the cache.
+      std::unique_ptr<lto::NativeObjectStream> Entry = AddStream(0);
+      *Entry->OS << Output;
+    }
+    *OS << Output;
+  } else {
+    *OS << CachedOutput->getBuffer();
+  }
+
+  // The policy was checked when the options were parsed.
+  pruneCache(CGOpts.BackendCachePath,
+             cantFail(parseCachePruningPolicy(CGOpts.BackendCachePolicy)));
+}
+
 void clang::EmitBackendOutput(DiagnosticsEngine &Diags,
                               const HeaderSearchOptions &HeaderOpts,
                               const CodeGenOptions &CGOpts,
@@ -1510,10 +1608,16 @@ void clang::EmitBackendOutput(DiagnosticsEngine &Diags,
 
   EmitAssemblyHelper AsmHelper(Diags, HeaderOpts, CGOpts, TOpts, LOpts, M);
 
-  if (CGOpts.ExperimentalNewPassManager)
-    AsmHelper.EmitAssemblyWithNewPassManager(Action, std::move(OS));
+  auto Emit = [&](std::unique_ptr<raw_pwrite_stream> Out) {
+    if (CGOpts.ExperimentalNewPassManager)
+      AsmHelper.EmitAssemblyWithNewPassManager(Action, std::move(Out));
+    else
+      AsmHelper.EmitAssembly(Action, std::move(Out));
+  };
+  if (isBackendOutputCacheable(CGOpts, Action))
+    emitBackendOutputWithCache(Diags, CGOpts, Action, *M, std::move(OS), Emit);
   else
-    AsmHelper.EmitAssembly(Action, std::move(OS));
+    Emit(std::move(OS));
 
   // Verify clang's TargetInfo DataLayout against the LLVM TargetMachine's
   // DataLayout.
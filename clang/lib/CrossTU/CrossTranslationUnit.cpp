@@ -37,6 +37,8 @@ STATISTIC(NumGetCTUCalled, "The # of getCTUDefinition function called");
 STATISTIC(
     NumNotInOtherTU,
     "The # of getCTUDefinition called but the function is not in any other TU");
+STATISTIC(NumDefsFoundByNameLookup,
+          "The # of definitions found by name lookup in the external AST");
 STATISTIC(NumGetCTUSuccess,
           "The # of getCTUDefinition successfully returned the "
           "requested function's body");
@@ -220,6 +222,56 @@ CrossTranslationUnitContext::findDefInDeclContext(const DeclContext *DC,
   return nullptr;
 }
 
+/// Look up the definition of \p D by its name in the namespaces of \p From
+/// with the same names as the ones enclosing \p D. Unlike walking the whole
+/// translation unit, this only deserializes the declarations with these names
+/// from the AST file.
+template <typename T>
+const T *
+CrossTranslationUnitContext::findDefByNameLookup(const T *D, ASTContext &From,
+                                                 StringRef LookupName) {
+  // Outside of C++, the AST file has no lookup table for the translation unit.
+  if (!From.getLangOpts().CPlusPlus)
+    return nullptr;
+
+  const IdentifierInfo *II = D->getIdentifier();
+  if (!II)
+    return nullptr;
+
+  // Only named namespaces can be looked up, give up on any other context.
+  SmallVector<const IdentifierInfo *, 4> NamespaceNames;
+  for (const DeclContext *DC = D->getDeclContext()->getRedeclContext();
+       !DC->isTranslationUnit(); DC = DC->getParent()->getRedeclContext()) {
+    const auto *NS = dyn_cast<NamespaceDecl>(DC);
+    if (!NS || !NS->getIdentifier())
+      return nullptr;
+    NamespaceNames.push_back(NS->getIdentifier());
+  }
+
+  const DeclContext *DC = From.getTranslationUnitDecl();
+  for (const IdentifierInfo *Name : llvm::reverse(NamespaceNames)) {
+    const NamespaceDecl *InnerNS = nullptr;
+    for (const NamedDecl *ND : DC->lookup(&From.Idents.get(Name->getName())))
+      if ((InnerNS = dyn_cast<NamespaceDecl>(ND)))
+        break;
+    if (!InnerNS)
+      return nullptr;
+    DC = InnerNS;
+  }
+
+  for (const NamedDecl *ND : DC->lookup(&From.Idents.get(II->getName()))) {
+    const auto *Candidate = dyn_cast<T>(ND);
+    const T *ResultDecl;
+    if (!Candidate || !hasBodyOrInit(Candidate, ResultDecl))
+      continue;
+    if (getLookupName(ResultDecl) != LookupName)
+      continue;
+    ++NumDefsFoundByNameLookup;
+    return ResultDecl;
+  }
+  return nullptr;
+}
+
 template <typename T>
 llvm::Expected<const T *> CrossTranslationUnitContext::getCrossTUDefinitionImpl(
     const T *D, StringRef CrossTUDir, StringRef IndexName,
@@ -288,6 +340,11 @@ llvm::Expected<const T *> CrossTranslationUnitContext::getCrossTUDefinitionImpl(
         index_error_code::lang_dialect_mismatch);
   }
 
+  // Walking the whole translation unit deserializes all of the AST file, so
+  // try to look the definition up by name first.
+  if (const T *ResultDecl =
+          findDefByNameLookup<T>(D, Unit->getASTContext(), LookupName))
+    return importDefinition(ResultDecl);
   TranslationUnitDecl *TU = Unit->getASTContext().getTranslationUnitDecl();
   if (const T *ResultDecl = findDefInDeclContext<T>(TU, LookupName))
     return importDefinition(ResultDecl);
@@ -1253,7 +1253,9 @@ public:
     tooling::Replacements Result;
     deriveLocalStyle(AnnotatedLines);
     AffectedRangeMgr.computeAffectedLines(AnnotatedLines);
-    for (unsigned i = 0, e = AnnotatedLines.size(); i != e; ++i) {
+    for (unsigned i = getFirstLineToAnalyze(AnnotatedLines),
+                  e = AnnotatedLines.size();
+         i != e; ++i) {
       Annotator.calculateFormattingInformation(*AnnotatedLines[i]);
     }
     Annotator.setCommentLineLevels(AnnotatedLines);
@@ -1285,6 +1287,36 @@ private:
     return Text.count('\r') * 2 > Text.count('\n');
   }
 
+  /// Returns the index of the first line whose formatting information can
+  /// influence the formatting of the affected lines.
+  ///
+  /// Nothing before the first affected line is reformatted, so earlier lines
+  /// only matter if they would be merged or aligned with later ones. Neither
+  /// reaches across a top-level line that follows an empty line and the end
+  /// of a top-level declaration, so computing the formatting information of
+  /// the lines before it can be skipped. This makes formatting a few lines of
+  /// a large file considerably cheaper.
+  static unsigned
+  getFirstLineToAnalyze(const SmallVectorImpl<AnnotatedLine *> &Lines) {
+    unsigned FirstAffected = 0;
+    while (FirstAffected != Lines.size() &&
+           !Lines[FirstAffected]->Affected &&
+           !Lines[FirstAffected]->LeadingEmptyLinesAffected &&
+           !Lines[FirstAffected]->ChildrenAffected)
+      ++FirstAffected;
+    for (unsigned i = FirstAffected; i > 1; --i) {
+      const AnnotatedLine &Line = *Lines[i - 1];
+      const AnnotatedLine &Previous = *Lines[i - 2];
+      if (Line.Level == 0 && !Line.InPPDirective &&
+          Line.First->NewlinesBefore > 1 &&
+          !Line.First->isOneOf(tok::comment, tok::l_brace, tok::r_brace) &&
+          Previous.Level == 0 && !Previous.InPPDirective &&
+          Previous.Last->isOneOf(tok::semi, tok::r_brace))
+        return i - 1;
+    }
+    return 0;
+  }
+
   bool
   hasCpp03IncompatibleFormat(const SmallVectorImpl<AnnotatedLine *> &Lines) {
     for (const AnnotatedLine *Line : Lines) {
@@ -64,6 +64,7 @@
 #include "llvm/Option/OptTable.h"
 #include "llvm/Option/Option.h"
 #include "llvm/ProfileData/InstrProfReader.h"
+#include "llvm/Support/CachePruning.h"
 #include "llvm/Support/CodeGen.h"
 #include "llvm/Support/Compiler.h"
 #include "llvm/Support/Error.h"
@@ -464,6 +465,21 @@ static void parseAnalyzerConfigs(AnalyzerOptions &AnOpts,
 
   // At this point, AnalyzerOptions is configured. Let's validate some options.
 
+  // Invalid shards can't be ignored in compatibility mode, so analyze the
+  // whole translation unit instead.
+  if (AnOpts.TopLevelShardCount == 0 ||
+      AnOpts.TopLevelShardIndex >= AnOpts.TopLevelShardCount) {
+    if (Diags && AnOpts.TopLevelShardCount == 0)
+      Diags->Report(diag::err_analyzer_config_invalid_input)
+          << "top-level-shard-count" << "a positive";
+    else if (Diags)
+      Diags->Report(diag::err_analyzer_config_invalid_input)
+          << "top-level-shard-index"
+          << "a smaller than 'top-level-shard-count'";
+    AnOpts.TopLevelShardCount = 1;
+    AnOpts.TopLevelShardIndex = 0;
+  }
+
   if (!Diags)
     return;
 
@@ -894,6 +910,20 @@ static bool ParseCodeGenArgs(CodeGenOptions &Opts, ArgList &Args, InputKind IK,
 
   Opts.FunctionSections = Args.hasFlag(OPT_ffunction_sections,
                                        OPT_fno_function_sections, false);
+  if (Arg *A = Args.getLastArg(OPT_fbasic_block_sections_EQ)) {
+    StringRef Name = A->getValue();
+    unsigned Type = llvm::StringSwitch<unsigned>(Name)
+        .Case("none", unsigned(llvm::BasicBlockSection::None))
+        .Case("all", unsigned(llvm::BasicBlockSection::All))
+        .Case("cold", unsigned(llvm::BasicBlockSection::Cold))
+        .Default(~0U);
+    if (Type == ~0U) {
+      Diags.Report(diag::err_drv_invalid_value) << A->getAsString(Args) << Name;
+      Success = false;
+    } else {
+      Opts.setBBSections(static_cast<llvm::BasicBlockSection>(Type));
+    }
+  }
   Opts.DataSections = Args.hasFlag(OPT_fdata_sections,
                                    OPT_fno_data_sections, false);
   Opts.StackSizeSection =
@@ -1012,6 +1042,39 @@ static bool ParseCodeGenArgs(CodeGenOptions &Opts, ArgList &Args, InputKind IK,
     }
   }
 
+  if (Arg *A = Args.getLastArg(OPT_fbackend_cache_path_EQ)) {
+    Opts.BackendCachePath = A->getValue();
+    Opts.BackendCachePolicy =
+        Args.getLastArgValue(OPT_fbackend_cache_policy_EQ);
+    Expected<llvm::CachePruningPolicy> Policy =
+        llvm::parseCachePruningPolicy(Opts.BackendCachePolicy);
+    if (!Policy) {
+      llvm::consumeError(Policy.takeError());
+      const Arg *PolicyArg = Args.getLastArg(OPT_fbackend_cache_policy_EQ);
+      Diags.Report(diag::err_drv_invalid_value)
+          << PolicyArg->getAsString(Args) << PolicyArg->getValue();
+      Success = false;
+    }
+
+    // The backend output depends on the IR, and on any of the options but the
+    // ones that only name the input and the output, or that only change the
+    // warnings. The options are part of the key of the cache, including the
+    // -mllvm options that are not recorded anywhere else.
+    for (const auto &A : Args) {
+      if (A->getOption().getID() == options::OPT_o ||
+          A->getOption().getID() == options::OPT_INPUT ||
+          A->getOption().getID() == options::OPT_fbackend_cache_path_EQ ||
+          A->getOption().getID() == options::OPT_fbackend_cache_policy_EQ ||
+          (A->getOption().getGroup().isValid() &&
+           A->getOption().getGroup().getID() == options::OPT_W_Group))
+        continue;
+      ArgStringList ASL;
+      A->render(Args, ASL);
+      Opts.BackendCacheArgs.insert(Opts.BackendCacheArgs.end(), ASL.begin(),
+                                   ASL.end());
+    }
+  }
+
   Opts.PreserveVec3Type = Args.hasArg(OPT_fpreserve_vec3_type);
   Opts.InstrumentFunctions = Args.hasArg(OPT_finstrument_functions);
   Opts.InstrumentFunctionsAfterInlining =
@@ -1066,6 +1129,7 @@ static bool ParseCodeGenArgs(CodeGenOptions &Opts, ArgList &Args, InputKind IK,
                      .Case("none", llvm::DebugCompressionType::None)
                      .Case("zlib", llvm::DebugCompressionType::Z)
                      .Case("zlib-gnu", llvm::DebugCompressionType::GNU)
+                     .Case("zstd", llvm::DebugCompressionType::Zstd)
                      .Default(llvm::DebugCompressionType::None);
       Opts.setCompressDebugSections(DCT);
     }
@@ -1775,6 +1839,7 @@ static InputKind ParseFrontendArgs(FrontendOptions &Opts, ArgList &Args,
   Opts.TimeTrace = Args.hasArg(OPT_ftime_trace);
   Opts.ShowVersion = Args.hasArg(OPT_version);
   Opts.ASTMergeFiles = Args.getAllArgValues(OPT_ast_merge);
+  Opts.IndexStorePath = Args.getLastArgValue(OPT_index_store_path);
   Opts.LLVMArgs = Args.getAllArgValues(OPT_mllvm);
   Opts.FixWhatYouCan = Args.hasArg(OPT_fix_what_you_can);
   Opts.FixOnlyWarnings = Args.hasArg(OPT_fix_only_warnings);
@@ -1913,7 +1978,7 @@ static InputKind ParseFrontendArgs(FrontendOptions &Opts, ArgList &Args,
       DashX = llvm::StringSwitch<InputKind>(XValue)
                   .Case("cpp-output", InputKind(InputKind::C).getPreprocessed())
                   .Case("assembler-with-cpp", InputKind::Asm)
-                  .Cases("ast", "pcm",
+                  .Cases("ast", "pcm", "precompiled-header",
                          InputKind(InputKind::Unknown, InputKind::Precompiled))
                   .Case("ir", InputKind::LLVM_IR)
                   .Default(InputKind::Unknown);
@@ -13,7 +13,8 @@ using namespace clang;
 
 InputKind FrontendOptions::getInputKindForExtension(StringRef Extension) {
   return llvm::StringSwitch<InputKind>(Extension)
-    .Cases("ast", "pcm", InputKind(InputKind::Unknown, InputKind::Precompiled))
+    .Cases("ast", "pcm", "pch",
+           InputKind(InputKind::Unknown, InputKind::Precompiled))
     .Case("c", InputKind::C)
     .Cases("S", "s", InputKind::Asm)
     .Case("i", InputKind(InputKind::C).getPreprocessed())
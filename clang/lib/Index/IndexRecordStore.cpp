@@ -0,0 +1,261 @@
+//===--- IndexRecordStore.cpp - On-disk index records ---------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// Records and units are small binary files: a magic number and a version,
+// followed by little-endian 32-bit counts and fields. Strings are a 32-bit
+// length followed by the bytes.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Index/IndexRecordStore.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/ScopeExit.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/Support/EndianStream.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/SHA1.h"
+#include "llvm/Support/raw_ostream.h"
+
+using namespace clang;
+using namespace clang::index;
+
+static constexpr llvm::StringLiteral RecordMagic = "IDXR";
+static constexpr llvm::StringLiteral UnitMagic = "IDXU";
+static constexpr uint32_t StoreVersion = 1;
+
+static std::string hashString(StringRef S) {
+  return llvm::toHex(
+      llvm::SHA1::hash({reinterpret_cast<const uint8_t *>(S.data()), S.size()}),
+      /*LowerCase=*/true);
+}
+
+static std::string getStoreFilePath(StringRef StorePath, StringRef Dir,
+                                    StringRef Name) {
+  SmallString<128> Path(StorePath);
+  llvm::sys::path::append(Path, Dir, Name);
+  return Path.str();
+}
+
+static llvm::Error makeStoreError(const Twine &Msg, StringRef Path) {
+  return llvm::make_error<llvm::StringError>(Msg + ": " + Path,
+                                             llvm::inconvertibleErrorCode());
+}
+
+/// Writes \p Contents to \p Path through a temporary file, so that readers
+/// never see a partial file.
+static llvm::Error writeStoreFile(StringRef Path, StringRef Contents) {
+  if (std::error_code EC =
+          llvm::sys::fs::create_directories(llvm::sys::path::parent_path(Path)))
+    return llvm::errorCodeToError(EC);
+
+  SmallString<128> TempPath;
+  int FD;
+  if (std::error_code EC =
+          llvm::sys::fs::createUniqueFile(Path + "-%%%%%%%%", FD, TempPath))
+    return llvm::errorCodeToError(EC);
+  auto RemoveOnFail =
+      llvm::make_scope_exit([&] { llvm::sys::fs::remove(TempPath); });
+
+  llvm::raw_fd_ostream OS(FD, /*shouldClose=*/true);
+  OS << Contents;
+  OS.close();
+  if (OS.has_error())
+    return llvm::errorCodeToError(OS.error());
+  if (std::error_code EC = llvm::sys::fs::rename(TempPath, Path))
+    return llvm::errorCodeToError(EC);
+  RemoveOnFail.release();
+  return llvm::Error::success();
+}
+
+namespace {
+class StoreWriter {
+  std::string Buf;
+  llvm::raw_string_ostream OS;
+  llvm::support::endian::Writer W;
+
+public:
+  StoreWriter(StringRef Magic) : OS(Buf), W(OS, llvm::support::little) {
+    OS << Magic;
+    write(StoreVersion);
+  }
+
+  void write(uint32_t V) { W.write<uint32_t>(V); }
+  void write(StringRef S) {
+    write(S.size());
+    OS << S;
+  }
+
+  StringRef contents() { return OS.str(); }
+};
+
+class StoreReader {
+  StringRef Data;
+  bool Failed = false;
+
+public:
+  StoreReader(StringRef Data) : Data(Data) {}
+
+  /// Checks the magic number and the version.
+  bool readHeader(StringRef Magic) {
+    if (!Data.startswith(Magic))
+      return false;
+    Data = Data.drop_front(Magic.size());
+    return read() == StoreVersion && !Failed;
+  }
+
+  uint32_t read() {
+    if (Data.size() < sizeof(uint32_t)) {
+      Failed = true;
+      return 0;
+    }
+    uint32_t V = llvm::support::endian::read32le(Data.data());
+    Data = Data.drop_front(sizeof(uint32_t));
+    return V;
+  }
+
+  StringRef readString() {
+    uint32_t Size = read();
+    if (Size > Data.size()) {
+      Failed = true;
+      return StringRef();
+    }
+    StringRef S = Data.take_front(Size);
+    Data = Data.drop_front(Size);
+    return S;
+  }
+
+  /// Reads a count of entries of at least \p MinEntrySize bytes each.
+  uint32_t readCount(size_t MinEntrySize) {
+    uint32_t Count = read();
+    if (Count > Data.size() / MinEntrySize) {
+      Failed = true;
+      return 0;
+    }
+    return Count;
+  }
+
+  /// Returns true if the data was truncated or has trailing bytes.
+  bool failed() const { return Failed || !Data.empty(); }
+};
+} // namespace
+
+std::string IndexRecordStore::getRecordName(StringRef FileContent) {
+  return hashString(FileContent);
+}
+
+bool IndexRecordStore::hasRecord(StringRef RecordName) const {
+  return llvm::sys::fs::exists(
+      getStoreFilePath(StorePath, "records", RecordName));
+}
+
+llvm::Error IndexRecordStore::writeRecord(StringRef RecordName,
+                                          const IndexRecord &Record) const {
+  StoreWriter W(RecordMagic);
+  W.write(Record.Symbols.size());
+  for (const StoredSymbol &Sym : Record.Symbols) {
+    W.write(static_cast<uint32_t>(Sym.Info.Kind));
+    W.write(static_cast<uint32_t>(Sym.Info.SubKind));
+    W.write(static_cast<uint32_t>(Sym.Info.Lang));
+    W.write(Sym.Info.Properties);
+    W.write(Sym.USR);
+    W.write(Sym.Name);
+    W.write(Sym.Scope);
+  }
+  W.write(Record.Occurrences.size());
+  for (const StoredOccurrence &Occ : Record.Occurrences) {
+    W.write(Occ.Symbol);
+    W.write(Occ.Roles);
+    W.write(Occ.Line);
+    W.write(Occ.Column);
+    W.write(Occ.Length);
+  }
+  return writeStoreFile(getStoreFilePath(StorePath, "records", RecordName),
+                        W.contents());
+}
+
+llvm::Expected<IndexRecord>
+IndexRecordStore::readRecord(StringRef RecordName) const {
+  std::string Path = getStoreFilePath(StorePath, "records", RecordName);
+  auto Buf = llvm::MemoryBuffer::getFile(Path);
+  if (!Buf)
+    return llvm::errorCodeToError(Buf.getError());
+
+  StoreReader R((*Buf)->getBuffer());
+  if (!R.readHeader(RecordMagic))
+    return makeStoreError("unknown index record format", Path);
+
+  IndexRecord Record;
+  Record.Symbols.resize(R.readCount(/*MinEntrySize=*/7 * sizeof(uint32_t)));
+  for (StoredSymbol &Sym : Record.Symbols) {
+    Sym.Info.Kind = static_cast<SymbolKind>(R.read());
+    Sym.Info.SubKind = static_cast<SymbolSubKind>(R.read());
+    Sym.Info.Lang = static_cast<SymbolLanguage>(R.read());
+    Sym.Info.Properties = R.read();
+    Sym.USR = R.readString();
+    Sym.Name = R.readString();
+    Sym.Scope = R.readString();
+  }
+  Record.Occurrences.resize(R.readCount(/*MinEntrySize=*/5 * sizeof(uint32_t)));
+  for (StoredOccurrence &Occ : Record.Occurrences) {
+    Occ.Symbol = R.read();
+    Occ.Roles = R.read();
+    Occ.Line = R.read();
+    Occ.Column = R.read();
+    Occ.Length = R.read();
+    if (Occ.Symbol >= Record.Symbols.size())
+      return makeStoreError("invalid symbol in index record", Path);
+  }
+  if (R.failed())
+    return makeStoreError("malformed index record", Path);
+  return std::move(Record);
+}
+
+llvm::Error IndexRecordStore::writeUnit(const IndexUnit &Unit) const {
+  StoreWriter W(UnitMagic);
+  W.write(Unit.MainFile);
+  W.write(Unit.Files.size());
+  for (const IndexUnit::FileRecord &File : Unit.Files) {
+    W.write(File.Path);
+    W.write(File.RecordName);
+    W.write(File.IsSystem);
+  }
+  return writeStoreFile(
+      getStoreFilePath(StorePath, "units", hashString(Unit.MainFile)),
+      W.contents());
+}
+
+llvm::Expected<IndexUnit>
+IndexRecordStore::readUnit(StringRef MainFile) const {
+  std::string Path =
+      getStoreFilePath(StorePath, "units", hashString(MainFile));
+  auto Buf = llvm::MemoryBuffer::getFile(Path);
+  if (!Buf)
+    return llvm::errorCodeToError(Buf.getError());
+
+  StoreReader R((*Buf)->getBuffer());
+  if (!R.readHeader(UnitMagic))
+    return makeStoreError("unknown index unit format", Path);
+
+  IndexUnit Unit;
+  Unit.MainFile = R.readString();
+  Unit.Files.resize(R.readCount(/*MinEntrySize=*/3 * sizeof(uint32_t)));
+  for (IndexUnit::FileRecord &File : Unit.Files) {
+    File.Path = R.readString();
+    File.RecordName = R.readString();
+    File.IsSystem = R.read();
+  }
+  if (R.failed())
+    return makeStoreError("malformed index unit", Path);
+  // Units are found by the hash of the path: make sure this is the right one.
+  if (Unit.MainFile != MainFile)
+    return makeStoreError("index unit for a different file", Path);
+  return std::move(Unit);
+}
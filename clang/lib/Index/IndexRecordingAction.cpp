@@ -0,0 +1,178 @@
+//===--- IndexRecordingAction.cpp - Write index data to a store -----------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "FileIndexRecord.h"
+#include "clang/AST/ASTContext.h"
+#include "clang/AST/Decl.h"
+#include "clang/Basic/DiagnosticFrontend.h"
+#include "clang/Basic/SourceManager.h"
+#include "clang/Frontend/FrontendAction.h"
+#include "clang/Index/IndexDataConsumer.h"
+#include "clang/Index/IndexRecordStore.h"
+#include "clang/Index/IndexingAction.h"
+#include "clang/Index/USRGeneration.h"
+#include "clang/Lex/Lexer.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallString.h"
+
+using namespace clang;
+using namespace clang::index;
+
+namespace {
+
+/// Collects the declaration occurrences of each file of the translation unit,
+/// and writes them to the store at the end: a record for each file whose
+/// contents have not been recorded before, and the unit of the main file.
+class IndexRecordingConsumer : public IndexDataConsumer {
+  IndexRecordStore Store;
+  ASTContext *Ctx = nullptr;
+  llvm::DenseMap<FileID, std::unique_ptr<FileIndexRecord>> Records;
+
+public:
+  IndexRecordingConsumer(StringRef StorePath) : Store(StorePath) {}
+
+  void initialize(ASTContext &Ctx) override { this->Ctx = &Ctx; }
+
+  bool handleDeclOccurence(const Decl *D, SymbolRoleSet Roles,
+                           ArrayRef<SymbolRelation> Relations,
+                           SourceLocation Loc, ASTNodeInfo ASTNode) override {
+    SourceManager &SM = Ctx->getSourceManager();
+    Loc = SM.getFileLoc(Loc);
+    if (Loc.isInvalid())
+      return true;
+    FileID FID;
+    unsigned Offset;
+    std::tie(FID, Offset) = SM.getDecomposedLoc(Loc);
+    if (!SM.getFileEntryForID(FID))
+      return true;
+
+    std::unique_ptr<FileIndexRecord> &Record = Records[FID];
+    if (!Record)
+      Record = llvm::make_unique<FileIndexRecord>(FID,
+                                                  SM.isInSystemHeader(Loc));
+    Record->addDeclOccurence(Roles, Offset, D->getCanonicalDecl(), Relations);
+    return true;
+  }
+
+  void finish() override;
+
+private:
+  std::string getFilePath(FileID FID) const;
+  IndexRecord buildRecord(const FileIndexRecord &FileRecord) const;
+};
+
+} // anonymous namespace
+
+std::string IndexRecordingConsumer::getFilePath(FileID FID) const {
+  SourceManager &SM = Ctx->getSourceManager();
+  const FileEntry *FE = SM.getFileEntryForID(FID);
+  StringRef RealPath = FE->tryGetRealPathName();
+  SmallString<128> Path(RealPath.empty() ? FE->getName() : RealPath);
+  SM.getFileManager().makeAbsolutePath(Path);
+  return Path.str();
+}
+
+IndexRecord
+IndexRecordingConsumer::buildRecord(const FileIndexRecord &FileRecord) const {
+  SourceManager &SM = Ctx->getSourceManager();
+  FileID FID = FileRecord.getFileID();
+  IndexRecord Record;
+  llvm::DenseMap<const Decl *, unsigned> SymbolIndices;
+  for (const DeclOccurrence &Occ :
+       FileRecord.getDeclOccurrencesSortedByOffset()) {
+    auto It = SymbolIndices.find(Occ.Dcl);
+    if (It == SymbolIndices.end()) {
+      SmallString<128> USR;
+      if (generateUSRForDecl(Occ.Dcl, USR))
+        continue;
+      StoredSymbol Sym;
+      Sym.Info = getSymbolInfo(Occ.Dcl);
+      Sym.USR = USR.str();
+      if (const auto *ND = dyn_cast<NamedDecl>(Occ.Dcl)) {
+        Sym.Name = ND->getNameAsString();
+        std::string QualifiedName = ND->getQualifiedNameAsString();
+        if (StringRef(QualifiedName).endswith(Sym.Name))
+          Sym.Scope = QualifiedName.substr(0, QualifiedName.size() -
+                                                  Sym.Name.size());
+      }
+      It = SymbolIndices.try_emplace(Occ.Dcl, Record.Symbols.size()).first;
+      Record.Symbols.push_back(std::move(Sym));
+    }
+
+    StoredOccurrence StoredOcc;
+    StoredOcc.Symbol = It->second;
+    StoredOcc.Roles = Occ.Roles;
+    StoredOcc.Line = SM.getLineNumber(FID, Occ.Offset);
+    StoredOcc.Column = SM.getColumnNumber(FID, Occ.Offset);
+    StoredOcc.Length = Lexer::MeasureTokenLength(
+        SM.getComposedLoc(FID, Occ.Offset), SM, Ctx->getLangOpts());
+    Record.Occurrences.push_back(StoredOcc);
+  }
+  return Record;
+}
+
+void IndexRecordingConsumer::finish() {
+  if (!Ctx)
+    return;
+  SourceManager &SM = Ctx->getSourceManager();
+  FileID MainFID = SM.getMainFileID();
+  if (!SM.getFileEntryForID(MainFID))
+    return;
+
+  auto ReportError = [&](llvm::Error Err) {
+    Ctx->getDiagnostics().Report(diag::warn_fe_index_store_write_failure)
+        << Store.getStorePath() << llvm::toString(std::move(Err));
+  };
+
+  IndexUnit Unit;
+  Unit.MainFile = getFilePath(MainFID);
+  // The main file is part of the unit even if it has no occurrences.
+  Records.try_emplace(MainFID);
+
+  std::vector<std::pair<std::string, FileID>> Files;
+  for (const auto &Entry : Records)
+    Files.emplace_back(getFilePath(Entry.first), Entry.first);
+  // Keep the unit deterministic, with the main file first.
+  llvm::sort(Files, [&](const std::pair<std::string, FileID> &L,
+                        const std::pair<std::string, FileID> &R) {
+    return std::make_pair(L.second != MainFID, L.first) <
+           std::make_pair(R.second != MainFID, R.first);
+  });
+
+  for (const auto &File : Files) {
+    bool Invalid = false;
+    StringRef Content = SM.getBufferData(File.second, &Invalid);
+    if (Invalid)
+      continue;
+    const FileIndexRecord *FileRecord = Records[File.second].get();
+    std::string RecordName = IndexRecordStore::getRecordName(Content);
+    bool IsSystem =
+        SM.isInSystemHeader(SM.getLocForStartOfFile(File.second));
+    Unit.Files.push_back({File.first, RecordName, IsSystem});
+
+    // The record of a file with the same contents is the same: it only needs
+    // to be written by the first translation unit including it.
+    if (Store.hasRecord(RecordName))
+      continue;
+    IndexRecord Record = FileRecord ? buildRecord(*FileRecord) : IndexRecord();
+    if (llvm::Error Err = Store.writeRecord(RecordName, Record))
+      return ReportError(std::move(Err));
+  }
+
+  if (llvm::Error Err = Store.writeUnit(Unit))
+    ReportError(std::move(Err));
+}
+
+std::unique_ptr<FrontendAction> index::createIndexDataRecordingAction(
+    StringRef StorePath, IndexingOptions Opts,
+    std::unique_ptr<FrontendAction> WrappedAction) {
+  return createIndexingAction(
+      std::make_shared<IndexRecordingConsumer>(StorePath), Opts,
+      std::move(WrappedAction));
+}
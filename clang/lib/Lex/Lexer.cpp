@@ -2227,6 +2227,13 @@ bool Lexer::SkipWhitespace(Token &Result, const char *CurPtr,
   return false;
 }
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+#elif __ALTIVEC__
+#include <altivec.h>
+#undef bool
+#endif
+
 /// We have just read the // characters from input.  Skip until we find the
 /// newline character that terminates the comment.  Then update BufferPtr and
 /// return.
@@ -2254,6 +2261,27 @@ bool Lexer::SkipLineComment(Token &Result, const char *CurPtr,
   char C;
   while (true) {
     C = *CurPtr;
+#ifdef __SSE2__
+    // Skip 16 characters at a time until a chunk contains a newline or a nul,
+    // then let the loop below find it.
+    {
+      __m128i Zeros = _mm_setzero_si128();
+      __m128i LFs = _mm_set1_epi8('\n');
+      __m128i CRs = _mm_set1_epi8('\r');
+      while (CurPtr + 16 <= BufferEnd) {
+        __m128i Chunk = _mm_loadu_si128((const __m128i *)CurPtr);
+        __m128i Stop = _mm_or_si128(_mm_cmpeq_epi8(Chunk, Zeros),
+                                    _mm_or_si128(_mm_cmpeq_epi8(Chunk, LFs),
+                                                 _mm_cmpeq_epi8(Chunk, CRs)));
+        if (int Cmp = _mm_movemask_epi8(Stop)) {
+          CurPtr += llvm::countTrailingZeros<unsigned>(Cmp);
+          break;
+        }
+        CurPtr += 16;
+      }
+      C = *CurPtr;
+    }
+#endif
     // Skip over characters in the fast loop.
     while (C != 0 &&                // Potentially EOF.
            C != '\n' && C != '\r')  // Newline or DOS-style newline.
@@ -2460,13 +2488,6 @@ static bool isEndOfBlockCommentWithEscapedNewLine(const char *CurPtr,
   return true;
 }
 
-#ifdef __SSE2__
-#include <emmintrin.h>
-#elif __ALTIVEC__
-#include <altivec.h>
-#undef bool
-#endif
-
 /// We have just read from input the / and * characters that started a comment.
 /// Read until we find the * and / characters that terminate the comment.
 /// Note that we don't bother decoding trigraphs or escaped newlines in block
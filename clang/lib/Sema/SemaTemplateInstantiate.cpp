@@ -357,6 +357,15 @@ Sema::InstantiatingTemplate::InstantiatingTemplate(
           PointOfInstantiation, InstantiationRange, Param, Template,
           TemplateArgs) {}
 
+void Sema::traceInstantiationCounters() {
+  if (!llvm::timeTraceProfilerEnabled())
+    return;
+  llvm::timeTraceProfilerCounter("Template Instantiations",
+                                 ++NumTimeTracedInstantiations);
+  llvm::timeTraceProfilerCounter("AST Memory",
+                                 Context.getASTAllocatedMemory());
+}
+
 void Sema::pushCodeSynthesisContext(CodeSynthesisContext Ctx) {
   Ctx.SavedInNonInstantiationSFINAEContext = InNonInstantiationSFINAEContext;
   InNonInstantiationSFINAEContext = false;
@@ -2032,6 +2041,7 @@ Sema::InstantiateClass(SourceLocation PointOfInstantiation,
                                         /*Qualified=*/true);
     return Name;
   });
+  traceInstantiationCounters();
 
   Pattern = PatternDef;
 
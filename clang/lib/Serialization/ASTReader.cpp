@@ -4138,6 +4138,11 @@ ASTReader::ASTReadResult ASTReader::ReadAST(StringRef FileName,
     break;
   }
 
+  ++NumASTImports;
+  NumASTFilesLoaded += Loaded.size();
+  for (const ImportedModule &IM : Loaded)
+    TotalASTFileBytesLoaded += IM.Mod->Buffer->getBufferSize();
+
   // Here comes stuff that we only do once the entire chain is loaded.
 
   // Load the AST blocks of all of the modules that we loaded.
@@ -8080,6 +8085,13 @@ void ASTReader::PrintStats() {
                                           SelectorsLoaded.end(),
                                           Selector());
 
+  if (NumASTImports)
+    std::fprintf(stderr,
+                 "  %u AST files (%llu bytes) loaded by %u imports "
+                 "(%f bytes per import)\n",
+                 NumASTFilesLoaded,
+                 (unsigned long long)TotalASTFileBytesLoaded, NumASTImports,
+                 (double)TotalASTFileBytesLoaded / NumASTImports);
   if (unsigned TotalNumSLocEntries = getTotalNumSLocs())
     std::fprintf(stderr, "  %u/%u source location entries read (%f%%)\n",
                  NumSLocEntriesRead, TotalNumSLocEntries,
@@ -401,7 +401,7 @@ public:
     // only determined when they are instantiated.
     if (FD->isThisDeclarationADefinition() &&
         !FD->isDependentContext()) {
-      assert(RecVisitorMode == AM_Syntax || Mgr->shouldInlineCall() == false);
+      assert(!(RecVisitorMode & AM_Path) || Mgr->shouldInlineCall() == false);
       HandleCode(FD, RecVisitorMode);
     }
     return true;
@@ -409,7 +409,7 @@ public:
 
   bool VisitObjCMethodDecl(ObjCMethodDecl *MD) {
     if (MD->isThisDeclarationADefinition()) {
-      assert(RecVisitorMode == AM_Syntax || Mgr->shouldInlineCall() == false);
+      assert(!(RecVisitorMode & AM_Path) || Mgr->shouldInlineCall() == false);
       HandleCode(MD, RecVisitorMode);
     }
     return true;
@@ -417,7 +417,7 @@ public:
 
   bool VisitBlockDecl(BlockDecl *BD) {
     if (BD->hasBody()) {
-      assert(RecVisitorMode == AM_Syntax || Mgr->shouldInlineCall() == false);
+      assert(!(RecVisitorMode & AM_Path) || Mgr->shouldInlineCall() == false);
       // Since we skip function template definitions, we should skip blocks
       // declared in those functions as well.
       if (!BD->isDependentContext()) {
@@ -533,6 +533,7 @@ void AnalysisConsumer::HandleDeclsCallGraph(const unsigned LocalTUDeclsSize) {
   // often.
   SetOfConstDecls Visited;
   SetOfConstDecls VisitedAsTopLevel;
+  unsigned TopLevelIndex = 0;
   llvm::ReversePostOrderTraversal<clang::CallGraph*> RPOT(&CG);
   for (llvm::ReversePostOrderTraversal<clang::CallGraph*>::rpo_iterator
          I = RPOT.begin(), E = RPOT.end(); I != E; ++I) {
@@ -545,6 +546,13 @@ void AnalysisConsumer::HandleDeclsCallGraph(const unsigned LocalTUDeclsSize) {
     if (!D)
       continue;
 
+    // Skip the functions of the other shards. Every shard walks the call graph
+    // in the same order, so they agree on the shard of each function. The
+    // functions which another shard inlined are still analyzed here.
+    if (TopLevelIndex++ % Opts->TopLevelShardCount !=
+        Opts->TopLevelShardIndex)
+      continue;
+
     // Skip the functions which have been processed already or previously
     // inlined.
     if (shouldSkipFunction(D, Visited, VisitedAsTopLevel))
@@ -578,17 +586,23 @@ static bool isBisonFile(ASTContext &C) {
 void AnalysisConsumer::runAnalysisOnTranslationUnit(ASTContext &C) {
   BugReporter BR(*Mgr);
   TranslationUnitDecl *TU = C.getTranslationUnitDecl();
-  if (SyntaxCheckTimer)
-    SyntaxCheckTimer->startTimer();
-  checkerMgr->runCheckersOnASTDecl(TU, *Mgr, BR);
-  if (SyntaxCheckTimer)
-    SyntaxCheckTimer->stopTimer();
+  // When the top level functions are split into shards, the AST-based checks
+  // are only run by the first shard, so that they are reported once.
+  bool IsFirstShard = Opts->TopLevelShardIndex == 0;
+  if (IsFirstShard) {
+    if (SyntaxCheckTimer)
+      SyntaxCheckTimer->startTimer();
+    checkerMgr->runCheckersOnASTDecl(TU, *Mgr, BR);
+    if (SyntaxCheckTimer)
+      SyntaxCheckTimer->stopTimer();
+  }
 
   // Run the AST-only checks using the order in which functions are defined.
   // If inlining is not turned on, use the simplest function order for path
-  // sensitive analyzes as well.
-  RecVisitorMode = AM_Syntax;
-  if (!Mgr->shouldInlineCall())
+  // sensitive analyzes as well. Without inlining, there is no call graph to
+  // split, so the first shard analyzes everything.
+  RecVisitorMode = IsFirstShard ? AM_Syntax : AM_None;
+  if (!Mgr->shouldInlineCall() && IsFirstShard)
     RecVisitorMode |= AM_Path;
   RecVisitorBR = &BR;
 
@@ -607,7 +621,8 @@ void AnalysisConsumer::runAnalysisOnTranslationUnit(ASTContext &C) {
     HandleDeclsCallGraph(LocalTUDeclsSize);
 
   // After all decls handled, run checkers on the entire TranslationUnit.
-  checkerMgr->runCheckersOnEndOfTranslationUnit(TU, *Mgr, BR);
+  if (IsFirstShard)
+    checkerMgr->runCheckersOnEndOfTranslationUnit(TU, *Mgr, BR);
 
   RecVisitorBR = nullptr;
 }
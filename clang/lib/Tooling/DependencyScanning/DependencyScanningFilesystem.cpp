@@ -0,0 +1,165 @@
+//===- DependencyScanningFilesystem.cpp - clang-scan-deps fs --------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Tooling/DependencyScanning/DependencyScanningFilesystem.h"
+#include "clang/Basic/Version.h"
+#include "clang/Lex/DependencyDirectivesSourceMinimizer.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MD5.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/raw_ostream.h"
+
+using namespace clang;
+using namespace tooling;
+using namespace dependencies;
+
+/// Returns false for files that the compiler reads as something other than
+/// C-family source, which minimizing would corrupt.
+static bool shouldMinimize(StringRef Path) {
+  StringRef Name = llvm::sys::path::filename(Path);
+  if (Name == "module.modulemap" || Name == "module.private.modulemap" ||
+      Name == "module.map" || Name == "module_private.map")
+    return false;
+  StringRef Ext = llvm::sys::path::extension(Name);
+  return Ext != ".modulemap" && Ext != ".pcm" && Ext != ".pch";
+}
+
+std::unique_ptr<llvm::MemoryBuffer>
+MinimizedSourceCache::minimize(StringRef Path,
+                               const llvm::MemoryBuffer &Input) {
+  // The minimizer's output depends on the compiler version, so make that part
+  // of the key as well.
+  SmallString<128> CachePath;
+  if (!CacheDir.empty()) {
+    llvm::MD5 Hash;
+    Hash.update(getClangFullVersion());
+    Hash.update(Input.getBuffer());
+    llvm::MD5::MD5Result Result;
+    Hash.final(Result);
+    CachePath = CacheDir;
+    llvm::sys::path::append(CachePath, Result.digest() + ".min");
+    if (auto Cached = llvm::MemoryBuffer::getFile(CachePath))
+      return llvm::MemoryBuffer::getMemBufferCopy((*Cached)->getBuffer(),
+                                                  Path);
+  }
+
+  SmallString<1024> Minimized;
+  SmallVector<minimize_source_to_dependency_directives::Token, 64> Tokens;
+  if (minimizeSourceToDependencyDirectives(Input.getBuffer(), Minimized,
+                                           Tokens)) {
+    // Let the preprocessor see, and diagnose, whatever the minimizer could not
+    // handle.
+    return llvm::MemoryBuffer::getMemBufferCopy(Input.getBuffer(), Path);
+  }
+
+  if (!CachePath.empty()) {
+    // Write to a temporary file first so that concurrent scans never read a
+    // partially written entry. Failing to cache the result is not an error.
+    int FD;
+    SmallString<128> TempPath;
+    if (!llvm::sys::fs::createUniqueFile(CachePath + ".tmp%%%%%%", FD,
+                                         TempPath)) {
+      {
+        llvm::raw_fd_ostream OS(FD, /*shouldClose=*/true);
+        OS << Minimized;
+      }
+      if (llvm::sys::fs::rename(TempPath, CachePath))
+        llvm::sys::fs::remove(TempPath);
+    }
+  }
+  return llvm::MemoryBuffer::getMemBufferCopy(Minimized, Path);
+}
+
+const MinimizedSourceCache::Entry &
+MinimizedSourceCache::get(StringRef Path, llvm::vfs::FileSystem &FS) {
+  {
+    std::lock_guard<std::mutex> Guard(Lock);
+    auto It = Entries.find(Path);
+    if (It != Entries.end())
+      return It->second;
+  }
+
+  // Read and minimize the file without holding the lock. If another worker
+  // gets here first for the same path, its entry is kept and ours is dropped.
+  Entry E;
+  llvm::ErrorOr<llvm::vfs::Status> Status = FS.status(Path);
+  if (!Status) {
+    E.EC = Status.getError();
+  } else if (Status->isDirectory()) {
+    E.Status = *Status;
+  } else {
+    llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> Buffer =
+        FS.getBufferForFile(Path);
+    if (!Buffer) {
+      E.EC = Buffer.getError();
+    } else {
+      if (shouldMinimize(Path))
+        E.Contents = minimize(Path, **Buffer);
+      else
+        E.Contents = std::move(*Buffer);
+      E.Status = llvm::vfs::Status(
+          Status->getName(), Status->getUniqueID(),
+          Status->getLastModificationTime(), Status->getUser(),
+          Status->getGroup(), E.Contents->getBufferSize(), Status->getType(),
+          Status->getPermissions());
+    }
+  }
+
+  std::lock_guard<std::mutex> Guard(Lock);
+  return Entries.insert(std::make_pair(Path, std::move(E))).first->second;
+}
+
+namespace {
+
+/// A file whose contents come from a \c MinimizedSourceCache entry.
+class MinimizedVFSFile : public llvm::vfs::File {
+public:
+  MinimizedVFSFile(const MinimizedSourceCache::Entry &E) : E(E) {}
+
+  llvm::ErrorOr<llvm::vfs::Status> status() override { return E.Status; }
+
+  llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>>
+  getBuffer(const Twine &Name, int64_t FileSize, bool RequiresNullTerminator,
+            bool IsVolatile) override {
+    return llvm::MemoryBuffer::getMemBuffer(E.Contents->getBuffer(),
+                                            E.Contents->getBufferIdentifier());
+  }
+
+  std::error_code close() override { return {}; }
+
+private:
+  const MinimizedSourceCache::Entry &E;
+};
+
+} // end anonymous namespace
+
+const MinimizedSourceCache::Entry &
+DependencyScanningFilesystem::getEntry(const Twine &Path) {
+  SmallString<256> AbsolutePath;
+  Path.toVector(AbsolutePath);
+  makeAbsolute(AbsolutePath);
+  return Cache.get(AbsolutePath, getUnderlyingFS());
+}
+
+llvm::ErrorOr<llvm::vfs::Status>
+DependencyScanningFilesystem::status(const Twine &Path) {
+  const MinimizedSourceCache::Entry &E = getEntry(Path);
+  if (E.EC)
+    return E.EC;
+  return E.Status;
+}
+
+llvm::ErrorOr<std::unique_ptr<llvm::vfs::File>>
+DependencyScanningFilesystem::openFileForRead(const Twine &Path) {
+  const MinimizedSourceCache::Entry &E = getEntry(Path);
+  if (E.EC)
+    return E.EC;
+  if (!E.Contents)
+    return std::make_error_code(std::errc::is_a_directory);
+  return llvm::make_unique<MinimizedVFSFile>(E);
+}
@@ -7,10 +7,12 @@
 //===----------------------------------------------------------------------===//
 
 #include "clang/Tooling/DependencyScanning/DependencyScanningWorker.h"
+#include "clang/Basic/FileSystemStatCache.h"
 #include "clang/Frontend/CompilerInstance.h"
 #include "clang/Frontend/FrontendActions.h"
 #include "clang/Frontend/TextDiagnosticPrinter.h"
 #include "clang/Frontend/Utils.h"
+#include "clang/Tooling/DependencyScanning/DependencyScanningFilesystem.h"
 #include "clang/Tooling/Tooling.h"
 
 using namespace clang;
@@ -63,9 +65,10 @@ private:
 class DependencyScanningAction : public tooling::ToolAction {
 public:
   DependencyScanningAction(StringRef WorkingDirectory,
-                           std::string &DependencyFileContents)
+                           std::string &DependencyFileContents,
+                           SharedStatCache *StatCache)
       : WorkingDirectory(WorkingDirectory),
-        DependencyFileContents(DependencyFileContents) {}
+        DependencyFileContents(DependencyFileContents), StatCache(StatCache) {}
 
   bool runInvocation(std::shared_ptr<CompilerInvocation> Invocation,
                      FileManager *FileMgr,
@@ -76,6 +79,9 @@ public:
     Compiler.setInvocation(std::move(Invocation));
     FileMgr->getFileSystemOpts().WorkingDir = WorkingDirectory;
     Compiler.setFileManager(FileMgr);
+    if (StatCache)
+      FileMgr->setStatCache(
+          llvm::make_unique<SharedStatCacheClient>(*StatCache));
 
     // Don't print 'X warnings and Y errors generated'.
     Compiler.getDiagnosticOpts().ShowCarets = false;
@@ -111,16 +117,19 @@ private:
   StringRef WorkingDirectory;
   /// The dependency file will be written to this string.
   std::string &DependencyFileContents;
+  SharedStatCache *StatCache;
 };
 
 } // end anonymous namespace
 
-DependencyScanningWorker::DependencyScanningWorker() {
+DependencyScanningWorker::DependencyScanningWorker(
+    SharedStatCache *StatCache, MinimizedSourceCache *MinimizedSources)
+    : StatCache(StatCache) {
   DiagOpts = new DiagnosticOptions();
   PCHContainerOps = std::make_shared<PCHContainerOperations>();
-  /// FIXME: Use the shared file system from the service for fast scanning
-  /// mode.
   WorkerFS = new ProxyFileSystemWithoutChdir(llvm::vfs::getRealFileSystem());
+  if (MinimizedSources)
+    WorkerFS = new DependencyScanningFilesystem(*MinimizedSources, WorkerFS);
 }
 
 llvm::Expected<std::string>
@@ -140,7 +149,7 @@ DependencyScanningWorker::getDependencyFile(const std::string &Input,
   Tool.setPrintErrorMessage(false);
   Tool.setDiagnosticConsumer(&DiagPrinter);
   std::string Output;
-  DependencyScanningAction Action(WorkingDirectory, Output);
+  DependencyScanningAction Action(WorkingDirectory, Output, StatCache);
   if (Tool.run(&Action)) {
     return llvm::make_error<llvm::StringError>(DiagnosticsOS.str(),
                                                llvm::inconvertibleErrorCode());
@@ -42,6 +42,17 @@
 // RUN:   -analyzer-config ctu-dir=0123012301230123
 
 
+// RUN: not %clang_analyze_cc1 -verify %s \
+// RUN:   -analyzer-checker=core \
+// RUN:   -analyzer-config top-level-shard-count=2 \
+// RUN:   -analyzer-config top-level-shard-index=2 \
+// RUN:   2>&1 | FileCheck %s -check-prefix=CHECK-SHARD-INPUT
+
+// CHECK-SHARD-INPUT: (frontend): invalid input for analyzer-config option
+// CHECK-SHARD-INPUT-SAME:        'top-level-shard-index', that expects a
+// CHECK-SHARD-INPUT-SAME:        smaller than 'top-level-shard-count' value
+
+
 // RUN: not %clang_analyze_cc1 -verify %s \
 // RUN:   -analyzer-checker=core \
 // RUN:   -analyzer-config no-false-positives=true \
@@ -0,0 +1,29 @@
+// RUN: %clang_analyze_cc1 -analyzer-checker=core,deadcode.DeadStores \
+// RUN:   -verify=ast,shard0,shard1 %s
+// RUN: %clang_analyze_cc1 -analyzer-checker=core,deadcode.DeadStores \
+// RUN:   -analyzer-config top-level-shard-count=2 \
+// RUN:   -analyzer-config top-level-shard-index=0 \
+// RUN:   -verify=ast,shard0 %s
+// RUN: %clang_analyze_cc1 -analyzer-checker=core,deadcode.DeadStores \
+// RUN:   -analyzer-config top-level-shard-count=2 \
+// RUN:   -analyzer-config top-level-shard-index=1 \
+// RUN:   -verify=shard1 %s
+
+// The top level functions are assigned to the shards in the reverse post
+// order of the call graph: h, g, then f. Only the first shard runs the
+// AST-based checks.
+
+int f(int x) {
+  int z = 0;
+  return x / z; // shard0-warning{{Division by zero}}
+}
+
+int g(int x) {
+  int z = 0;
+  return x / z; // shard1-warning{{Division by zero}}
+}
+
+void h(int x) {
+  int y;
+  y = x; // ast-warning{{Value stored to 'y' is never read}}
+}
@@ -0,0 +1,40 @@
+// RUN: rm -rf %t && mkdir %t
+// RUN: %clang_cc1 -triple x86_64-unknown-linux-gnu -emit-obj -O2 \
+// RUN:   -fbackend-cache-path=%t/cache %s -o %t/1.o
+// RUN: ls %t/cache/llvmcache-* | count 1
+// RUN: ls %t/cache | FileCheck --check-prefix=ENTRY %s
+// ENTRY: llvmcache-{{[0-9a-f]+$}}
+
+// The output is taken from the cache when the IR and the options are the same.
+// RUN: echo cached > %t/cached
+// RUN: cp %t/cached %t/cache/llvmcache-*
+// RUN: %clang_cc1 -triple x86_64-unknown-linux-gnu -emit-obj -O2 \
+// RUN:   -fbackend-cache-path=%t/cache %s -o %t/2.o
+// RUN: FileCheck --check-prefix=HIT %s < %t/2.o
+// HIT: cached
+
+// A different IR or different options make a new entry.
+// RUN: %clang_cc1 -triple x86_64-unknown-linux-gnu -emit-obj -O2 -DCHANGE \
+// RUN:   -fbackend-cache-path=%t/cache %s -o %t/3.o
+// RUN: ls %t/cache/llvmcache-* | count 2
+// RUN: %clang_cc1 -triple x86_64-unknown-linux-gnu -emit-obj -O1 \
+// RUN:   -fbackend-cache-path=%t/cache %s -o %t/4.o
+// RUN: ls %t/cache/llvmcache-* | count 3
+
+// Warnings don't change the output.
+// RUN: %clang_cc1 -triple x86_64-unknown-linux-gnu -emit-obj -O2 -Wall \
+// RUN:   -fbackend-cache-path=%t/cache %s -o %t/5.o
+// RUN: ls %t/cache/llvmcache-* | count 3
+
+// RUN: not %clang_cc1 -triple x86_64-unknown-linux-gnu -emit-obj \
+// RUN:   -fbackend-cache-path=%t/cache -fbackend-cache-policy=foo=1 %s \
+// RUN:   -o %t/6.o 2>&1 | FileCheck --check-prefix=POLICY %s
+// POLICY: error: invalid value 'foo=1' in '-fbackend-cache-policy=foo=1'
+
+int f(int x) {
+#ifdef CHANGE
+  return x * 3;
+#else
+  return x * 2;
+#endif
+}
@@ -0,0 +1,30 @@
+// REQUIRES: x86-registered-target
+
+// RUN: %clang_cc1 -triple x86_64-pc-linux-gnu -O2 -S -o - < %s | FileCheck %s --check-prefix=NONE
+// RUN: %clang_cc1 -triple x86_64-pc-linux-gnu -O2 -S -fbasic-block-sections=all -o - < %s | FileCheck %s --check-prefix=ALL
+// RUN: %clang_cc1 -triple x86_64-pc-linux-gnu -O2 -S -fbasic-block-sections=all -ffunction-sections -funwind-tables -o - < %s | FileCheck %s --check-prefix=ALL-FS
+
+int world(int a);
+
+int another(int a) {
+  if (a > 10)
+    return world(a);
+  return a + 1;
+}
+
+// NONE-NOT: .__part.
+
+// ALL: .section .text.another.__part.1,"ax",@progbits
+// ALL-NEXT: .p2align
+// ALL-NEXT: .type another.__part.1,@function
+// ALL: another.__part.1:
+// ALL: .size another.__part.1, .Lbb_section_end
+
+// ALL-FS: .section .text.another,"ax",@progbits
+// ALL-FS: .cfi_startproc
+// ALL-FS: .cfi_endproc
+// ALL-FS: .section .text.another.another.__part.1,"ax",@progbits
+// ALL-FS: .cfi_startproc
+// ALL-FS: another.__part.1:
+// ALL-FS: .cfi_endproc
+// ALL-FS: .size another, .Lfunc_end0-another
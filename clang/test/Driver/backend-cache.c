@@ -0,0 +1,8 @@
+// RUN: %clang -### -c -fbackend-cache-path=%t.cache \
+// RUN:   -fbackend-cache-policy=cache_size=10%% %s 2>&1 | FileCheck %s
+// CHECK: "-cc1"
+// CHECK-SAME: "-fbackend-cache-path={{.*}}.cache"
+// CHECK-SAME: "-fbackend-cache-policy=cache_size=10%"
+
+// RUN: %clang -### -c %s 2>&1 | FileCheck --check-prefix=NONE %s
+// NONE-NOT: -fbackend-cache
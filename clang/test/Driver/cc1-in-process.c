@@ -0,0 +1,16 @@
+// Check that -cc1 jobs run in the driver's process still report diagnostics
+// and produce their outputs.
+
+// RUN: %clang -fintegrated-cc1 -fsyntax-only -Wunused-variable %s 2>&1 \
+// RUN:   | FileCheck %s
+// CHECK: warning: unused variable 'x'
+
+// RUN: rm -f %t.o
+// RUN: %clang -fintegrated-cc1 -c %s -o %t.o
+// RUN: test -f %t.o
+
+// RUN: %clang -### -fintegrated-cc1 -fno-integrated-cc1 -c %s 2>&1 \
+// RUN:   | FileCheck -check-prefix=NOWARN %s
+// NOWARN-NOT: argument unused
+
+void f() { int x; }
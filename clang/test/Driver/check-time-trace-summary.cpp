@@ -0,0 +1,21 @@
+// REQUIRES: shell
+// RUN: %clangxx -S -ftime-trace -mllvm --time-trace-granularity=0 -o %T/check-time-trace-summary %s
+// RUN: FileCheck --check-prefix=SUMMARY %s < %T/check-time-trace-summary.summary.txt
+// RUN: FileCheck --check-prefix=COUNTER %s < %T/check-time-trace-summary.json
+
+// SUMMARY: InstantiateClass: {{[0-9.]+}} ms in 1 sections
+// SUMMARY-NEXT: {{[0-9.]+}} ms  Struct<int>
+
+// COUNTER-DAG: "name":"Template Instantiations"
+// COUNTER-DAG: "name":"AST Memory"
+
+template <typename T>
+struct Struct {
+  T Num;
+};
+
+int main() {
+  Struct<int> S;
+
+  return 0;
+}
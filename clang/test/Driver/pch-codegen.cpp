@@ -0,0 +1,13 @@
+// RUN: rm -rf %t && mkdir -p %t
+// RUN: touch %t/foo.h %t/foo.pch
+
+// RUN: %clang -### -fpch-codegen -fpch-debuginfo -x c++-header %t/foo.h -o %t/foo.pch 2>&1 | FileCheck -check-prefix=CHECK-CREATE %s
+// CHECK-CREATE: "-fmodules-codegen"
+// CHECK-CREATE: "-fmodules-debuginfo"
+
+// RUN: %clang -### -fpch-codegen -fno-pch-codegen -x c++-header %t/foo.h -o %t/foo.pch 2>&1 | FileCheck -check-prefix=CHECK-NONE %s
+// CHECK-NONE-NOT: "-fmodules-codegen"
+
+// RUN: %clang -### -c %t/foo.pch -o %t/foo.o 2>&1 | FileCheck -check-prefix=CHECK-OBJ %s
+// CHECK-OBJ: "-emit-obj"
+// CHECK-OBJ-SAME: "-x" "precompiled-header"
@@ -0,0 +1,17 @@
+// RUN: rm -rf %t && mkdir -p %t
+// RUN: cp %s %t/a.c && cp %s %t/b.c
+// RUN: %clang_cc1 -fsyntax-only -index-store-path %t/store -I %S/Inputs %t/a.c
+// RUN: %clang_cc1 -fsyntax-only -index-store-path %t/store -I %S/Inputs %t/b.c
+
+// Each translation unit has a unit, and the files with the same contents share
+// a record: the header and the copies of this file.
+// RUN: ls %t/store/units | count 2
+// RUN: ls %t/store/records | count 2
+
+// RUN: %clang -### -index-store-path %t/store -c %s 2>&1 | FileCheck %s
+// CHECK: "-cc1"
+// CHECK-SAME: "-index-store-path" "{{.*}}store"
+
+#include "index-store-header.h"
+
+int user(void) { return shared(1); }
@@ -0,0 +1,2 @@
+struct foo {};
+inline void f1() {}
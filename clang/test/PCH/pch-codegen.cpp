@@ -0,0 +1,34 @@
+// REQUIRES: x86-registered-target
+// RUN: rm -rf %t && mkdir -p %t
+
+// Build the precompiled headers with the definitions and the debug info of
+// their declarations attached to them.
+// RUN: %clang_cc1 -triple x86_64-linux-gnu -fmodules-codegen -x c++-header -emit-pch %S/Inputs/pch-codegen.h -o %t/cg.pch
+// RUN: %clang_cc1 -triple x86_64-linux-gnu -fmodules-debuginfo -x c++-header -emit-pch %S/Inputs/pch-codegen.h -o %t/di.pch
+
+// The object of the precompiled header provides them.
+// RUN: %clang_cc1 -triple x86_64-linux-gnu -emit-llvm -debug-info-kind=limited -o - %t/cg.pch | FileCheck --check-prefix=CG %s
+// RUN: %clang_cc1 -triple x86_64-linux-gnu -emit-llvm -debug-info-kind=limited -o - %t/di.pch | FileCheck --check-prefix=DI %s
+
+// And the translation units using the precompiled header only reference them.
+// RUN: %clang_cc1 -triple x86_64-linux-gnu -emit-llvm -debug-info-kind=limited -o - -include-pch %t/cg.pch %s | FileCheck --check-prefix=CG-USE %s
+// RUN: %clang_cc1 -triple x86_64-linux-gnu -emit-llvm -debug-info-kind=limited -o - -include-pch %t/di.pch %s | FileCheck --check-prefix=DI-USE %s
+
+// CG: define weak_odr void @_Z2f1v
+// CG: DICompileUnit
+// CG-NOT: DICompositeType
+
+// CG-USE: declare void @_Z2f1v
+// CG-USE: DICompileUnit
+// CG-USE: distinct !DICompositeType(tag: DW_TAG_structure_type, name: "foo"
+
+// DI-NOT: define
+// DI: distinct !DICompositeType(tag: DW_TAG_structure_type, name: "foo"
+
+// DI-USE: define linkonce_odr void @_Z2f1v
+// DI-USE: = !DICompositeType(tag: DW_TAG_structure_type, name: "foo", {{.*}}, flags: DIFlagFwdDecl
+
+void use() {
+  foo f;
+  f1();
+}
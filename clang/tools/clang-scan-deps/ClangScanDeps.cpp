@@ -6,10 +6,13 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include "clang/Basic/FileSystemStatCache.h"
 #include "clang/Frontend/CompilerInstance.h"
 #include "clang/Tooling/CommonOptionsParser.h"
+#include "clang/Tooling/DependencyScanning/DependencyScanningFilesystem.h"
 #include "clang/Tooling/DependencyScanning/DependencyScanningWorker.h"
 #include "clang/Tooling/JSONCompilationDatabase.h"
+#include "llvm/Support/FileSystem.h"
 #include "llvm/Support/InitLLVM.h"
 #include "llvm/Support/Options.h"
 #include "llvm/Support/Program.h"
@@ -45,9 +48,16 @@ public:
   ///
   /// \param Compilations     The reference to the compilation database that's
   /// used by the clang tool.
+  /// \param StatCache       The stat cache shared by all workers.
+  ///
+  /// \param MinimizedSources The minimized source cache shared by all
+  /// workers, or null to preprocess the original sources.
   DependencyScanningTool(const tooling::CompilationDatabase &Compilations,
-                         SharedStream &OS, SharedStream &Errs)
-      : Compilations(Compilations), OS(OS), Errs(Errs) {}
+                         SharedStream &OS, SharedStream &Errs,
+                         SharedStatCache &StatCache,
+                         MinimizedSourceCache *MinimizedSources)
+      : Worker(&StatCache, MinimizedSources), Compilations(Compilations),
+        OS(OS), Errs(Errs) {}
 
   /// Computes the dependencies for the given file and prints them out.
   ///
@@ -80,6 +90,29 @@ llvm::cl::opt<bool> Help("h", llvm::cl::desc("Alias for -help"),
 
 llvm::cl::OptionCategory DependencyScannerCategory("Tool options");
 
+enum class ScanningMode { Preprocess, PreprocessMinimizedSources };
+
+llvm::cl::opt<ScanningMode> ScanMode(
+    "mode",
+    llvm::cl::desc("The preprocessing mode used to compute the dependencies"),
+    llvm::cl::values(
+        clEnumValN(ScanningMode::Preprocess, "preprocess",
+                   "The set of dependencies is computed by preprocessing the "
+                   "unmodified source files"),
+        clEnumValN(ScanningMode::PreprocessMinimizedSources,
+                   "preprocess-minimized-sources",
+                   "The set of dependencies is computed by preprocessing the "
+                   "source files that were minimized to only include the "
+                   "contents that might affect the dependencies")),
+    llvm::cl::init(ScanningMode::Preprocess),
+    llvm::cl::cat(DependencyScannerCategory));
+
+llvm::cl::opt<std::string> MinimizedSourceCacheDir(
+    "minimized-source-cache",
+    llvm::cl::desc("Directory in which minimized sources are kept between "
+                   "runs (only used with -mode=preprocess-minimized-sources)"),
+    llvm::cl::cat(DependencyScannerCategory));
+
 llvm::cl::opt<unsigned>
     NumThreads("j", llvm::cl::Optional,
                llvm::cl::desc("Number of worker threads to use (default: use "
@@ -138,10 +171,27 @@ int main(int argc, const char **argv) {
   SharedStream DependencyOS(llvm::outs());
   unsigned NumWorkers =
       NumThreads == 0 ? llvm::hardware_concurrency() : NumThreads;
+  // The file system does not change while we scan, so the workers can share
+  // the results of every stat() they perform.
+  SharedStatCache StatCache;
+  std::unique_ptr<MinimizedSourceCache> MinimizedSources;
+  if (ScanMode == ScanningMode::PreprocessMinimizedSources) {
+    if (!MinimizedSourceCacheDir.empty()) {
+      if (std::error_code EC =
+              llvm::sys::fs::create_directories(MinimizedSourceCacheDir)) {
+        llvm::errs() << "error: cannot create '" << MinimizedSourceCacheDir
+                     << "': " << EC.message() << "\n";
+        return 1;
+      }
+    }
+    MinimizedSources =
+        llvm::make_unique<MinimizedSourceCache>(MinimizedSourceCacheDir);
+  }
   std::vector<std::unique_ptr<DependencyScanningTool>> WorkerTools;
   for (unsigned I = 0; I < NumWorkers; ++I)
     WorkerTools.push_back(llvm::make_unique<DependencyScanningTool>(
-        *AdjustingCompilations, DependencyOS, Errs));
+        *AdjustingCompilations, DependencyOS, Errs, StatCache,
+        MinimizedSources.get()));
 
   std::vector<std::thread> WorkerThreads;
   std::atomic<bool> HadErrors(false);
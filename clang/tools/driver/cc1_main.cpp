@@ -217,7 +217,7 @@ int cc1_main(ArrayRef<const char *> Argv, const char *Argv0, void *MainAddr) {
       Clang->getInvocation(), Argv.begin(), Argv.end(), Diags);
 
   if (Clang->getFrontendOpts().TimeTrace)
-    llvm::timeTraceProfilerInitialize();
+    llvm::timeTraceProfilerInitialize("clang");
 
   // --print-supported-cpus takes priority over the actual compilation.
   if (Clang->getFrontendOpts().PrintSupportedCPUs)
@@ -266,6 +266,20 @@ int cc1_main(ArrayRef<const char *> Argv, const char *Argv0, void *MainAddr) {
     llvm::timeTraceProfilerWrite(*profilerOutput);
     // FIXME(ibiryukov): make profilerOutput flush in destructor instead.
     profilerOutput->flush();
+
+    // Next to the trace, list the slowest sections of each kind, e.g. the
+    // most expensive template instantiations.
+    SmallString<128> SummaryPath(Path);
+    llvm::sys::path::replace_extension(SummaryPath, "summary.txt");
+    if (auto summaryOutput =
+            Clang->createOutputFile(SummaryPath.str(),
+                                    /*Binary=*/false,
+                                    /*RemoveFileOnSignal=*/false, "",
+                                    /*Extension=*/"txt",
+                                    /*useTemporary=*/false)) {
+      llvm::timeTraceProfilerWriteSummary(*summaryOutput, /*TopN=*/10);
+      summaryOutput->flush();
+    }
     llvm::timeTraceProfilerCleanup();
 
     llvm::errs() << "Time trace json-file dumped to " << Path.str() << "\n";
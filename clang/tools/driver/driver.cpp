@@ -318,6 +318,14 @@ static int ExecuteCC1Tool(ArrayRef<const char *> argv, StringRef Tool) {
   return 1;
 }
 
+/// Runs a -cc1 job of this driver in-process; see -fintegrated-cc1.
+static int ExecuteCC1InProcess(SmallVectorImpl<const char *> &ArgV) {
+  // The previous job may have set options of its own.
+  llvm::cl::ResetAllOptionOccurrences();
+  StringRef Tool = ArgV[1] + 4;
+  return ExecuteCC1Tool(ArgV, Tool);
+}
+
 int main(int argc_, const char **argv_) {
   llvm::InitLLVM X(argc_, argv_);
   SmallVector<const char *, 256> argv(argv_, argv_ + argc_);
@@ -453,6 +461,7 @@ int main(int argc_, const char **argv_) {
   insertTargetAndModeArgs(TargetAndMode, argv, SavedStrings);
 
   SetBackdoorDriverOutputsFromEnvVars(TheDriver);
+  TheDriver.CC1Main = &ExecuteCC1InProcess;
 
   std::unique_ptr<Compilation> C(TheDriver.BuildCompilation(argv));
   int Res = 1;
@@ -118,6 +118,27 @@ TEST(MatchFinder, CheckProfiling) {
   EXPECT_EQ("MyID", Records.begin()->getKey());
 }
 
+TEST(MatchFinder, CheckProfilingSeparatesCallbacks) {
+  MatchFinder::MatchFinderOptions Options;
+  llvm::StringMap<llvm::TimeRecord> Records;
+  Options.CheckProfiling.emplace(Records);
+  Options.CheckProfiling->SeparateCallbacks = true;
+  MatchFinder Finder(std::move(Options));
+
+  struct NamedCallback : public MatchFinder::MatchCallback {
+    void run(const MatchFinder::MatchResult &Result) override {}
+    StringRef getID() const override { return "MyID"; }
+  } Callback;
+  Finder.addMatcher(decl(), &Callback);
+  std::unique_ptr<FrontendActionFactory> Factory(
+      newFrontendActionFactory(&Finder));
+  ASSERT_TRUE(tooling::runToolOnCode(Factory->create(), "int x;"));
+
+  EXPECT_EQ(2u, Records.size());
+  EXPECT_EQ(1u, Records.count("MyID"));
+  EXPECT_EQ(1u, Records.count("MyID.callback"));
+}
+
 class VerifyStartOfTranslationUnit : public MatchFinder::MatchCallback {
 public:
   VerifyStartOfTranslationUnit() : Called(false) {}
@@ -170,6 +191,61 @@ TEST(MatchFinder, InterceptsEndOfTranslationUnit) {
   EXPECT_TRUE(VerifyCallback.Called);
 }
 
+TEST(MatchFinder, DispatchesMatchersByName) {
+  struct RecordingCallback : public MatchFinder::MatchCallback {
+    RecordingCallback(std::vector<std::string> &Log, StringRef Name)
+        : Log(Log), Name(Name) {}
+    void run(const MatchFinder::MatchResult &Result) override {
+      Log.push_back(Name);
+    }
+    std::vector<std::string> &Log;
+    std::string Name;
+  };
+  std::vector<std::string> Log;
+  RecordingCallback CallsF(Log, "f"), CallsG(Log, "g"), CallsAny(Log, "any"),
+      CallsFOrH(Log, "f|h"), Ctor(Log, "ctor");
+  MatchFinder Finder;
+  Finder.addMatcher(callExpr(callee(functionDecl(hasName("::f")))), &CallsF);
+  Finder.addMatcher(callExpr(callee(functionDecl(hasName("g")))), &CallsG);
+  Finder.addMatcher(callExpr(), &CallsAny);
+  Finder.addMatcher(callExpr(callee(namedDecl(hasAnyName("f", "h")))),
+                    &CallsFOrH);
+  Finder.addMatcher(cxxConstructorDecl(hasName("A")), &Ctor);
+  std::unique_ptr<FrontendActionFactory> Factory(
+      newFrontendActionFactory(&Finder));
+  ASSERT_TRUE(tooling::runToolOnCode(Factory->create(),
+                                     "struct A { A(); };"
+                                     "void f(); void h();"
+                                     "void x() { f(); h(); }"));
+  EXPECT_EQ((std::vector<std::string>{"ctor", "f", "any", "f|h", "any",
+                                      "f|h"}),
+            Log);
+}
+
+template <typename T>
+static bool getRequiredNames(const internal::Matcher<T> &Matcher,
+                             std::vector<std::string> &Names) {
+  return internal::DynTypedMatcher(Matcher).getRequiredNames(Names);
+}
+
+TEST(Matcher, GetRequiredNames) {
+  std::vector<std::string> Names;
+  EXPECT_FALSE(getRequiredNames(functionDecl(), Names));
+  EXPECT_FALSE(getRequiredNames(functionDecl(unless(hasName("f"))), Names));
+  EXPECT_FALSE(getRequiredNames(functionDecl(hasName("operator=")), Names));
+  EXPECT_FALSE(
+      getRequiredNames(functionDecl(anyOf(hasName("f"), isInline())), Names));
+  EXPECT_TRUE(Names.empty());
+
+  EXPECT_TRUE(
+      getRequiredNames(functionDecl(hasName("a::f"), isInline()), Names));
+  EXPECT_EQ(std::vector<std::string>{"f"}, Names);
+  Names.clear();
+  EXPECT_TRUE(getRequiredNames(
+      callExpr(callee(namedDecl(hasAnyName("f", "::g")))), Names));
+  EXPECT_EQ((std::vector<std::string>{"f", "g"}), Names);
+}
+
 TEST(Matcher, matchOverEntireASTContext) {
   std::unique_ptr<ASTUnit> AST =
       clang::tooling::buildASTFromCode("struct { int *foo; };");
@@ -379,4 +379,35 @@ TEST_F(FileManagerTest, getFileDontOpenRealPath) {
   EXPECT_EQ(file->tryGetRealPathName(), ExpectedResult);
 }
 
+#ifndef _WIN32
+TEST_F(FileManagerTest, sharedStatCacheIsSharedBetweenManagers) {
+  auto FS = IntrusiveRefCntPtr<llvm::vfs::InMemoryFileSystem>(
+      new llvm::vfs::InMemoryFileSystem);
+  FS->addFile("/inc/a.h", 0, llvm::MemoryBuffer::getMemBuffer(""));
+
+  SharedStatCache Shared;
+  FileSystemOptions Opts;
+  {
+    FileManager Manager(Opts, FS);
+    Manager.setStatCache(llvm::make_unique<SharedStatCacheClient>(Shared));
+    EXPECT_NE(nullptr, Manager.getFile("/inc/a.h"));
+    EXPECT_EQ(nullptr, Manager.getFile("/inc/b.h"));
+  }
+
+  // A later invocation is answered from the cache, including the failure.
+  FS->addFile("/inc/b.h", 0, llvm::MemoryBuffer::getMemBuffer(""));
+  {
+    FileManager Manager(Opts, FS);
+    Manager.setStatCache(llvm::make_unique<SharedStatCacheClient>(Shared));
+    EXPECT_NE(nullptr, Manager.getFile("/inc/a.h"));
+    EXPECT_EQ(nullptr, Manager.getFile("/inc/b.h"));
+  }
+
+  Shared.clear();
+  FileManager Manager(Opts, FS);
+  Manager.setStatCache(llvm::make_unique<SharedStatCacheClient>(Shared));
+  EXPECT_NE(nullptr, Manager.getFile("/inc/b.h"));
+}
+#endif // !_WIN32
+
 } // anonymous namespace
@@ -603,6 +603,38 @@ TEST_F(FormatTestSelective, KeepsIndentAfterCommentSectionImport) {
   EXPECT_EQ(Code, format(Code, 47, 1));
 }
 
+TEST_F(FormatTestSelective, FormatsRangeAfterUnformattedDeclarations) {
+  Style.AllowShortFunctionsOnASingleLine = FormatStyle::SFS_All;
+  EXPECT_EQ("void  f( ) {  return ; }\n"
+            "int   a;\n"
+            "\n"
+            "int b; // comment\n"
+            "int cc; // comment\n"
+            "void g() { return; }\n"
+            "void  h( ) {  }",
+            format("void  f( ) {  return ; }\n"
+                   "int   a;\n"
+                   "\n"
+                   "int b; // comment\n"
+                   "int  cc;   // comment\n"
+                   "void  g( )  {\n"
+                   "  return  ;\n"
+                   "}\n"
+                   "void  h( ) {  }",
+                   53, 49));
+  EXPECT_EQ("void  f( ) {  return ; }\n"
+            "int   a;\n"
+            "\n"
+            "int b;  // comment\n"
+            "int cc; // comment",
+            format("void  f( ) {  return ; }\n"
+                   "int   a;\n"
+                   "\n"
+                   "int b;  // comment\n"
+                   "int  cc;   // comment",
+                   54, 0));
+}
+
 } // end namespace
 } // end namespace format
 } // end namespace clang
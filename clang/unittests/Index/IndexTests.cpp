@@ -14,11 +14,14 @@
 #include "clang/Frontend/CompilerInstance.h"
 #include "clang/Frontend/FrontendAction.h"
 #include "clang/Index/IndexDataConsumer.h"
+#include "clang/Index/IndexRecordStore.h"
 #include "clang/Index/IndexSymbol.h"
 #include "clang/Index/IndexingAction.h"
 #include "clang/Lex/Preprocessor.h"
 #include "clang/Tooling/Tooling.h"
+#include "llvm/ADT/ScopeExit.h"
 #include "llvm/ADT/StringRef.h"
+#include "llvm/Support/FileSystem.h"
 #include "llvm/Support/VirtualFileSystem.h"
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
@@ -144,6 +147,7 @@ private:
 
 using testing::AllOf;
 using testing::Contains;
+using testing::ElementsAre;
 using testing::Not;
 using testing::UnorderedElementsAre;
 
@@ -292,6 +296,56 @@ TEST(IndexTest, Constructors) {
                 WrittenAt(Position(4, 8)))));
 }
 
+TEST(IndexTest, RecordToStore) {
+  llvm::SmallString<128> StorePath;
+  ASSERT_FALSE(llvm::sys::fs::createUniqueDirectory("index-store", StorePath));
+  auto RemoveStore = llvm::make_scope_exit(
+      [&] { llvm::sys::fs::remove_directories(StorePath); });
+
+  std::string Code = R"cpp(namespace ns { int f(); }
+int ns::f() { return 0; }
+int g() { return ns::f(); })cpp";
+  tooling::runToolOnCode(
+      createIndexDataRecordingAction(StorePath, IndexingOptions(), nullptr)
+          .release(),
+      Code, "/src/main.cpp");
+
+  IndexRecordStore Store(StorePath);
+  auto Unit = Store.readUnit("/src/main.cpp");
+  ASSERT_TRUE(bool(Unit)) << llvm::toString(Unit.takeError());
+  ASSERT_EQ(Unit->Files.size(), 1u);
+  EXPECT_EQ(Unit->Files[0].Path, "/src/main.cpp");
+  EXPECT_EQ(Unit->Files[0].RecordName, IndexRecordStore::getRecordName(Code));
+  EXPECT_FALSE(Unit->Files[0].IsSystem);
+
+  auto Record = Store.readRecord(Unit->Files[0].RecordName);
+  ASSERT_TRUE(bool(Record)) << llvm::toString(Record.takeError());
+  std::vector<std::string> Names;
+  for (const StoredSymbol &Sym : Record->Symbols)
+    Names.push_back(Sym.Scope + Sym.Name);
+  EXPECT_THAT(Names, UnorderedElementsAre("ns", "ns::f", "g"));
+
+  std::vector<Position> Occurrences;
+  for (const StoredOccurrence &Occ : Record->Occurrences) {
+    if (Record->Symbols[Occ.Symbol].Name != "f")
+      continue;
+    Occurrences.emplace_back(Occ.Line, Occ.Column);
+    EXPECT_EQ(Occ.Length, 1u);
+  }
+  EXPECT_THAT(Occurrences,
+              ElementsAre(Position(1, 20), Position(2, 9), Position(3, 22)));
+
+  // A file with the same contents shares the record.
+  tooling::runToolOnCode(
+      createIndexDataRecordingAction(StorePath, IndexingOptions(), nullptr)
+          .release(),
+      Code, "/src/copy.cpp");
+  auto CopyUnit = Store.readUnit("/src/copy.cpp");
+  ASSERT_TRUE(bool(CopyUnit)) << llvm::toString(CopyUnit.takeError());
+  ASSERT_EQ(CopyUnit->Files.size(), 1u);
+  EXPECT_EQ(CopyUnit->Files[0].RecordName, Unit->Files[0].RecordName);
+}
+
 } // namespace
 } // namespace index
 } // namespace clang
@@ -303,6 +303,14 @@ bool ClangTableGenMain(raw_ostream &OS, RecordKeeper &Records) {
 
   return false;
 }
+
+bool ClangTableGenSelectAction(StringRef Name) {
+  ActionType Value;
+  if (Action.getParser().parse(Action, Name, "", Value))
+    return true;
+  Action = Value;
+  return false;
+}
 }
 
 int main(int argc, char **argv) {
@@ -312,7 +320,7 @@ int main(int argc, char **argv) {
 
   llvm_shutdown_obj Y;
 
-  return TableGenMain(argv[0], &ClangTableGenMain);
+  return TableGenMain(argv[0], &ClangTableGenMain, &ClangTableGenSelectAction);
 }
 
 #ifdef __has_feature
@@ -506,7 +506,8 @@ struct Allocator {
     }
     m->user_requested_alignment_log = user_requested_alignment_log;
 
-    m->alloc_context_id = StackDepotPut(*stack);
+    m->alloc_context_id = StackDepotPut(
+        *stack, t ? &t->malloc_storage().stack_depot_cache : nullptr);
 
     uptr size_rounded_down_to_granularity =
         RoundDownTo(size, SHADOW_GRANULARITY);
@@ -570,7 +571,8 @@ struct Allocator {
       CHECK_EQ(m->free_tid, kInvalidTid);
     AsanThread *t = GetCurrentThread();
     m->free_tid = t ? t->tid() : 0;
-    m->free_context_id = StackDepotPut(*stack);
+    m->free_context_id = StackDepotPut(
+        *stack, t ? &t->malloc_storage().stack_depot_cache : nullptr);
 
     Flags &fl = *flags();
     if (fl.max_free_fill_size > 0) {
@@ -19,6 +19,7 @@
 #include "asan_interceptors.h"
 #include "sanitizer_common/sanitizer_allocator.h"
 #include "sanitizer_common/sanitizer_list.h"
+#include "sanitizer_common/sanitizer_stackdepot.h"
 
 namespace __asan {
 
@@ -194,6 +195,10 @@ using AllocatorCache = AsanAllocator::AllocatorCache;
 struct AsanThreadLocalMallocStorage {
   uptr quarantine_cache[16];
   AllocatorCache allocator_cache;
+  StackDepotCache stack_depot_cache;
+  // The number of malloc and free stacks to collect in short before the next
+  // full one, see malloc_context_sample_period.
+  u32 malloc_context_countdown;
   void CommitBack();
  private:
   // These objects are allocated via mmap() and are zero-initialized.
@@ -26,6 +26,24 @@ u32 GetMallocContextSize() {
   return atomic_load(&malloc_context_size, memory_order_acquire);
 }
 
+u32 GetSampledMallocContextSize() {
+  u32 size = GetMallocContextSize();
+  int period = flags()->malloc_context_sample_period;
+  if (period <= 1 || size <= 2)
+    return size;
+  AsanThread *t = GetCurrentThread();
+  if (!t)
+    return size;
+  // Collect the first stack of each thread in full, then one in period.
+  u32 &countdown = t->malloc_storage().malloc_context_countdown;
+  if (countdown == 0) {
+    countdown = period - 1;
+    return size;
+  }
+  countdown--;
+  return 2;
+}
+
 namespace {
 
 // ScopedUnwinding is a scope for stacktracing member of a context
@@ -25,6 +25,9 @@ static const u32 kDefaultMallocContextSize = 30;
 
 void SetMallocContextSize(u32 size);
 u32 GetMallocContextSize();
+// Returns the number of frames to collect for the next malloc or free stack
+// of the current thread, see malloc_context_sample_period.
+u32 GetSampledMallocContextSize();
 
 } // namespace __asan
 
@@ -32,18 +35,19 @@ u32 GetMallocContextSize();
 // as early as possible (in functions exposed to the user), as we generally
 // don't want stack trace to contain functions from ASan internals.
 
-#define GET_STACK_TRACE(max_size, fast)                          \
-  BufferedStackTrace stack;                                      \
-  if (max_size <= 2) {                                           \
-    stack.size = max_size;                                       \
-    if (max_size > 0) {                                          \
-      stack.top_frame_bp = GET_CURRENT_FRAME();                  \
-      stack.trace_buffer[0] = StackTrace::GetCurrentPc();        \
-      if (max_size > 1) stack.trace_buffer[1] = GET_CALLER_PC(); \
-    }                                                            \
-  } else {                                                       \
-    stack.Unwind(StackTrace::GetCurrentPc(),                     \
-                 GET_CURRENT_FRAME(), nullptr, fast, max_size);  \
+#define GET_STACK_TRACE(max_size, fast)                                \
+  BufferedStackTrace stack;                                            \
+  u32 stack_max_size = max_size;                                       \
+  if (stack_max_size <= 2) {                                           \
+    stack.size = stack_max_size;                                       \
+    if (stack_max_size > 0) {                                          \
+      stack.top_frame_bp = GET_CURRENT_FRAME();                        \
+      stack.trace_buffer[0] = StackTrace::GetCurrentPc();              \
+      if (stack_max_size > 1) stack.trace_buffer[1] = GET_CALLER_PC(); \
+    }                                                                  \
+  } else {                                                             \
+    stack.Unwind(StackTrace::GetCurrentPc(),                           \
+                 GET_CURRENT_FRAME(), nullptr, fast, stack_max_size);  \
   }
 
 #define GET_STACK_TRACE_FATAL(pc, bp)              \
@@ -65,8 +69,9 @@ u32 GetMallocContextSize();
 #define GET_STACK_TRACE_THREAD                                    \
   GET_STACK_TRACE(kStackTraceMax, true)
 
-#define GET_STACK_TRACE_MALLOC                                                 \
-  GET_STACK_TRACE(GetMallocContextSize(), common_flags()->fast_unwind_on_malloc)
+#define GET_STACK_TRACE_MALLOC                     \
+  GET_STACK_TRACE(GetSampledMallocContextSize(), \
+                  common_flags()->fast_unwind_on_malloc)
 
 #define GET_STACK_TRACE_FREE GET_STACK_TRACE_MALLOC
 
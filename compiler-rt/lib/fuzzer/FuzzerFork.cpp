@@ -68,7 +68,6 @@ struct FuzzJob {
   std::string FeaturesDir;
   std::string LogPath;
   std::string SeedListPath;
-  std::string CFPath;
   size_t      JobId;
 
   int         DftTimeInSeconds = 0;
@@ -77,7 +76,6 @@ struct FuzzJob {
   int ExitCode;
 
   ~FuzzJob() {
-    RemoveFile(CFPath);
     RemoveFile(LogPath);
     RemoveFile(SeedListPath);
     RmDirRecursive(CorpusDir);
@@ -106,6 +104,11 @@ struct GlobalEnv {
 
   size_t NumRuns = 0;
 
+  // Finished jobs whose new inputs are waiting to be merged, together with the
+  // inputs of each job that have features not in Features.
+  Vector<std::unique_ptr<FuzzJob>> JobsToMerge;
+  Vector<SizedFile> MergeCandidates;
+
   std::string StopFile() { return DirPlusFile(TempDir, "STOP"); }
 
   size_t secondsSinceProcessStartUp() const {
@@ -153,7 +156,6 @@ struct GlobalEnv {
     Job->LogPath = DirPlusFile(TempDir, std::to_string(JobId) + ".log");
     Job->CorpusDir = DirPlusFile(TempDir, "C" + std::to_string(JobId));
     Job->FeaturesDir = DirPlusFile(TempDir, "F" + std::to_string(JobId));
-    Job->CFPath = DirPlusFile(TempDir, std::to_string(JobId) + ".merge");
     Job->JobId = JobId;
 
 
@@ -177,11 +179,15 @@ struct GlobalEnv {
     return Job;
   }
 
-  void RunOneMergeJob(FuzzJob *Job) {
+  // Collects the inputs of a finished job that may be added to the corpus. They
+  // are merged by MergePendingJobs, together with those of the other jobs that
+  // finished in the meantime, so that the merge process is run once per batch
+  // of jobs rather than once per job.
+  void AddJobToMerge(FuzzJob *Job) {
     auto Stats = ParseFinalStatsFromLog(Job->LogPath);
     NumRuns += Stats.number_of_executed_units;
 
-    Vector<SizedFile> TempFiles, MergeCandidates;
+    Vector<SizedFile> TempFiles;
     // Read all newly created inputs and their feature sets.
     // Choose only those inputs that have new features.
     GetSizedFilesFromDir(Job->CorpusDir, &TempFiles);
@@ -207,12 +213,27 @@ struct GlobalEnv {
            Stats.average_exec_per_sec, NumOOMs, NumTimeouts, NumCrashes,
            secondsSinceProcessStartUp(), Job->JobId, Job->DftTimeInSeconds);
 
-    if (MergeCandidates.empty()) return;
+    // The candidates are read from the job's corpus directory, which is
+    // removed with the job.
+    JobsToMerge.emplace_back(Job);
+  }
+
+  void MergePendingJobs() {
+    if (MergeCandidates.empty()) {
+      JobsToMerge.clear();
+      return;
+    }
 
     Vector<std::string> FilesToAdd;
     Set<uint32_t> NewFeatures, NewCov;
+    // The merge prefers smaller inputs, so sort the candidates of all jobs.
+    std::sort(MergeCandidates.begin(), MergeCandidates.end());
+    auto CFPath = DirPlusFile(TempDir, "batch.merge");
     CrashResistantMerge(Args, {}, MergeCandidates, &FilesToAdd, Features,
-                        &NewFeatures, Cov, &NewCov, Job->CFPath, false);
+                        &NewFeatures, Cov, &NewCov, CFPath, false);
+    RemoveFile(CFPath);
+    MergeCandidates.clear();
+    JobsToMerge.clear();
     for (auto &Path : FilesToAdd) {
       auto U = FileToVector(Path);
       auto NewPath = DirPlusFile(MainCorpusDir, Hash(U));
@@ -260,6 +281,10 @@ struct JobQueue {
     }
     Cv.notify_one();
   }
+  bool Empty() {
+    std::lock_guard<std::mutex> Lock(Mu);
+    return Qu.empty();
+  }
   FuzzJob *Pop() {
     std::unique_lock<std::mutex> Lk(Mu);
     // std::lock_guard<std::mutex> Lock(Mu);
@@ -336,18 +361,20 @@ void FuzzWithFork(Random &Rand, const FuzzingOptions &Options,
   }
 
   while (true) {
-    std::unique_ptr<FuzzJob> Job(MergeQ.Pop());
+    FuzzJob *Job = MergeQ.Pop();
     if (!Job)
       break;
     ExitCode = Job->ExitCode;
     if (ExitCode == Options.InterruptExitCode) {
       Printf("==%lu== libFuzzer: a child was interrupted; exiting\n", GetPid());
+      delete Job;
       StopJobs();
       break;
     }
     Fuzzer::MaybeExitGracefully();
 
-    Env.RunOneMergeJob(Job.get());
+    // Env owns the job from now on, until its inputs are merged.
+    Env.AddJobToMerge(Job);
 
     // Continue if our crash is one of the ignorred ones.
     if (Options.IgnoreTimeouts && ExitCode == Options.TimeoutExitCode)
@@ -390,9 +417,16 @@ void FuzzWithFork(Random &Rand, const FuzzingOptions &Options,
       break;
     }
 
+    // Merge once no other job is waiting, or once there is a pending job per
+    // worker. With many workers, this runs one merge process for several jobs.
+    if (MergeQ.Empty() || Env.JobsToMerge.size() >= (size_t)NumJobs)
+      Env.MergePendingJobs();
+
     FuzzQ.Push(Env.CreateNewJob(JobId++));
   }
 
+  Env.MergePendingJobs();
+
   for (auto &T : Threads)
     T.join();
 
@@ -211,47 +211,76 @@ void Fuzzer::CrashResistantMergeInternalStep(const std::string &CFPath) {
   std::ofstream OF(CFPath, std::ofstream::out | std::ofstream::app);
   Set<size_t> AllFeatures;
   Set<const TracePC::PCTableEntry *> AllPCs;
-  for (size_t i = M.FirstNotProcessedFile; i < M.Files.size(); i++) {
-    Fuzzer::MaybeExitGracefully();
-    auto U = FileToVector(M.Files[i].Name);
-    if (U.size() > MaxInputLen) {
-      U.resize(MaxInputLen);
-      U.shrink_to_fit();
+  size_t FirstFile = M.FirstNotProcessedFile;
+  auto ProcessFiles = [&]() {
+    for (size_t i = FirstFile; i < M.Files.size(); i++) {
+      Fuzzer::MaybeExitGracefully();
+      auto U = FileToVector(M.Files[i].Name);
+      if (U.size() > MaxInputLen) {
+        U.resize(MaxInputLen);
+        U.shrink_to_fit();
+      }
+      std::ostringstream StartedLine;
+      // Write the pre-run marker.
+      OF << "STARTED " << i << " " << U.size() << "\n";
+      OF.flush();  // Flush is important since Command::Execute may crash.
+      // Run.
+      TPC.ResetMaps();
+      ExecuteCallback(U.data(), U.size());
+      // Collect coverage. We are iterating over the files in this order:
+      // * First, files in the initial corpus ordered by size, smallest first.
+      // * Then, all other files, smallest first.
+      // So it makes no sense to record all features for all files, instead we
+      // only record features that were not seen before.
+      Set<size_t> UniqFeatures;
+      TPC.CollectFeatures([&](size_t Feature) {
+        if (AllFeatures.insert(Feature).second)
+          UniqFeatures.insert(Feature);
+      });
+      TPC.UpdateObservedPCs();
+      // Show stats.
+      if (!(TotalNumberOfRuns & (TotalNumberOfRuns - 1)))
+        PrintStats("pulse ");
+      // Write the post-run marker and the coverage.
+      OF << "FT " << i;
+      for (size_t F : UniqFeatures)
+        OF << " " << F;
+      OF << "\n";
+      OF << "COV " << i;
+      TPC.ForEachObservedPC([&](const TracePC::PCTableEntry *TE) {
+        if (AllPCs.insert(TE).second)
+          OF << " " << TPC.PCTableEntryIdx(TE);
+      });
+      OF << "\n";
+      OF.flush();
+    }
+    return 0;
+  };
+
+  if (Options.MergeForkServer) {
+    // Process the files in forked copies of this process. When a copy
+    // crashes, the control file tells where it stopped, and a new copy
+    // resumes with the next file, like a new inner process would.
+    while (FirstFile < M.Files.size()) {
+      int ExitCode = ExecuteCallbackInForkedProcess(Options, ProcessFiles);
+      if (ExitCode == 0) {
+        FirstFile = M.Files.size();
+        break;
+      }
+      if (ExitCode < 0)
+        break;  // Can't fork, process the files in this process.
+      Merger Progress;
+      std::ifstream ProgressIF(CFPath);
+      Progress.ParseOrExit(ProgressIF, false);
+      Printf("MERGE-INNER: '%s' caused a failure in a forked process\n",
+             Progress.LastFailure.c_str());
+      // Leave it to the outer process if the copy did not make any progress.
+      if (Progress.FirstNotProcessedFile <= FirstFile)
+        exit(ExitCode);
+      FirstFile = Progress.FirstNotProcessedFile;
     }
-    std::ostringstream StartedLine;
-    // Write the pre-run marker.
-    OF << "STARTED " << i << " " << U.size() << "\n";
-    OF.flush();  // Flush is important since Command::Execute may crash.
-    // Run.
-    TPC.ResetMaps();
-    ExecuteCallback(U.data(), U.size());
-    // Collect coverage. We are iterating over the files in this order:
-    // * First, files in the initial corpus ordered by size, smallest first.
-    // * Then, all other files, smallest first.
-    // So it makes no sense to record all features for all files, instead we
-    // only record features that were not seen before.
-    Set<size_t> UniqFeatures;
-    TPC.CollectFeatures([&](size_t Feature) {
-      if (AllFeatures.insert(Feature).second)
-        UniqFeatures.insert(Feature);
-    });
-    TPC.UpdateObservedPCs();
-    // Show stats.
-    if (!(TotalNumberOfRuns & (TotalNumberOfRuns - 1)))
-      PrintStats("pulse ");
-    // Write the post-run marker and the coverage.
-    OF << "FT " << i;
-    for (size_t F : UniqFeatures)
-      OF << " " << F;
-    OF << "\n";
-    OF << "COV " << i;
-    TPC.ForEachObservedPC([&](const TracePC::PCTableEntry *TE) {
-      if (AllPCs.insert(TE).second)
-        OF << " " << TPC.PCTableEntryIdx(TE);
-    });
-    OF << "\n";
-    OF.flush();
   }
+  ProcessFiles();
   PrintStats("DONE ");
 }
 
@@ -15,6 +15,7 @@
 #include "FuzzerBuiltinsMsvc.h"
 #include "FuzzerCommand.h"
 #include "FuzzerDefs.h"
+#include <functional>
 
 namespace fuzzer {
 
@@ -60,6 +61,12 @@ size_t GetPeakRSSMb();
 
 int ExecuteCommand(const Command &Cmd);
 
+// Runs Callback in a forked copy of this process, which exits with the value
+// returned by Callback. Returns the exit code of the copy (1 if it was killed
+// by a signal), or -1 if the platform can't fork.
+int ExecuteCallbackInForkedProcess(const FuzzingOptions &Options,
+                                   const std::function<int()> &Callback);
+
 FILE *OpenProcessPipe(const char *Command, const char *Mode);
 
 const void *SearchMemory(const void *haystack, size_t haystacklen,
@@ -484,6 +484,11 @@ int ExecuteCommand(const Command &Cmd) {
   return Info.return_code;
 }
 
+int ExecuteCallbackInForkedProcess(const FuzzingOptions &Options,
+                                   const std::function<int()> &Callback) {
+  return -1;
+}
+
 const void *SearchMemory(const void *Data, size_t DataLen, const void *Patt,
                          size_t PattLen) {
   return memmem(Data, DataLen, Patt, PattLen);
@@ -24,6 +24,7 @@
 #include <sys/syscall.h>
 #include <sys/time.h>
 #include <sys/types.h>
+#include <sys/wait.h>
 #include <thread>
 #include <unistd.h>
 
@@ -128,6 +129,24 @@ void SetSignalHandler(const FuzzingOptions& Options) {
     SetSigaction(SIGUSR2, GracefulExitHandler);
 }
 
+int ExecuteCallbackInForkedProcess(const FuzzingOptions &Options,
+                                   const std::function<int()> &Callback) {
+  pid_t Pid = fork();
+  if (Pid < 0)
+    return -1;
+  if (Pid == 0) {
+    // The child does not inherit the interval timer.
+    if (Options.UnitTimeoutSec > 0)
+      SetTimer(Options.UnitTimeoutSec / 2 + 1);
+    _Exit(Callback());
+  }
+  int Status;
+  while (waitpid(Pid, &Status, 0) < 0)
+    if (errno != EINTR)
+      return 1;
+  return WIFEXITED(Status) ? WEXITSTATUS(Status) : 1;
+}
+
 void SleepSeconds(int Seconds) {
   sleep(Seconds); // Use C API to avoid coverage from instrumented libc++.
 }
@@ -160,6 +160,11 @@ int ExecuteCommand(const Command &Cmd) {
   return system(CmdLine.c_str());
 }
 
+int ExecuteCallbackInForkedProcess(const FuzzingOptions &Options,
+                                   const std::function<int()> &Callback) {
+  return -1;
+}
+
 const void *SearchMemory(const void *Data, size_t DataLen, const void *Patt,
                          size_t PattLen) {
   // TODO: make this implementation more efficient.
@@ -137,9 +137,10 @@ void GuardedPoolAllocator::init(const options::Options &Opts) {
   Metadata = reinterpret_cast<AllocationMetadata *>(mapMemory(BytesRequired));
   markReadWrite(Metadata, BytesRequired);
 
-  // Allocate memory and set up the free pages queue.
-  BytesRequired = MaxSimultaneousAllocations * sizeof(*FreeSlots);
-  FreeSlots = reinterpret_cast<size_t *>(mapMemory(BytesRequired));
+  // Allocate memory and set up the free slots bitmap.
+  FreeSlotsWords = (MaxSimultaneousAllocations + 63) / 64;
+  BytesRequired = FreeSlotsWords * sizeof(*FreeSlots);
+  FreeSlots = reinterpret_cast<uint64_t *>(mapMemory(BytesRequired));
   markReadWrite(FreeSlots, BytesRequired);
 
   // Multiply the sample rate by 2 to give a good, fast approximation for (1 /
@@ -174,12 +175,7 @@ void *GuardedPoolAllocator::allocate(size_t Size) {
   if (Size == 0 || Size > maximumAllocationSize())
     return nullptr;
 
-  size_t Index;
-  {
-    ScopedLock L(PoolMutex);
-    Index = reserveSlot();
-  }
-
+  size_t Index = reserveSlot();
   if (Index == kInvalidSlotID)
     return nullptr;
 
@@ -207,32 +203,26 @@ void GuardedPoolAllocator::deallocate(void *Ptr) {
     exit(EXIT_FAILURE);
   }
 
-  // Intentionally scope the mutex here, so that other threads can access the
-  // pool during the expensive markInaccessible() call.
-  {
-    ScopedLock L(PoolMutex);
-    if (Meta->IsDeallocated) {
-      reportError(UPtr, Error::DOUBLE_FREE);
-      exit(EXIT_FAILURE);
-    }
-
-    // Ensure that the deallocation is recorded before marking the page as
-    // inaccessible. Otherwise, a racy use-after-free will have inconsistent
-    // metadata.
-    Meta->RecordDeallocation(Backtrace);
+  // Only one of concurrent frees of the same pointer may proceed.
+  if (__atomic_exchange_n(&Meta->IsDeallocated, true, __ATOMIC_RELAXED)) {
+    reportError(UPtr, Error::DOUBLE_FREE);
+    exit(EXIT_FAILURE);
   }
 
+  // Ensure that the deallocation is recorded before marking the page as
+  // inaccessible. Otherwise, a racy use-after-free will have inconsistent
+  // metadata.
+  Meta->RecordDeallocation(Backtrace);
+
   markInaccessible(reinterpret_cast<void *>(SlotStart),
                    maximumAllocationSize());
 
-  // And finally, lock again to release the slot back into the pool.
-  ScopedLock L(PoolMutex);
+  // And finally, release the slot back into the pool.
   freeSlot(addrToSlot(UPtr));
 }
 
 size_t GuardedPoolAllocator::getSize(const void *Ptr) {
   assert(pointerIsMine(Ptr));
-  ScopedLock L(PoolMutex);
   AllocationMetadata *Meta = addrToMetadata(reinterpret_cast<uintptr_t>(Ptr));
   assert(Meta->Addr == reinterpret_cast<uintptr_t>(Ptr));
   return Meta->Size;
@@ -267,23 +257,47 @@ bool GuardedPoolAllocator::isGuardPage(uintptr_t Ptr) const {
 }
 
 size_t GuardedPoolAllocator::reserveSlot() {
+  if (__atomic_load_n(&IsReportingError, __ATOMIC_RELAXED))
+    return kInvalidSlotID;
+
   // Avoid potential reuse of a slot before we have made at least a single
   // allocation in each slot. Helps with our use-after-free detection.
-  if (NumSampledAllocations < MaxSimultaneousAllocations)
-    return NumSampledAllocations++;
-
-  if (FreeSlotsLength == 0)
-    return kInvalidSlotID;
+  size_t N = __atomic_load_n(&NumSampledAllocations, __ATOMIC_RELAXED);
+  while (N < MaxSimultaneousAllocations) {
+    if (__atomic_compare_exchange_n(&NumSampledAllocations, &N, N + 1,
+                                    /*weak=*/true, __ATOMIC_RELAXED,
+                                    __ATOMIC_RELAXED))
+      return N;
+  }
 
-  size_t ReservedIndex = getRandomUnsigned32() % FreeSlotsLength;
-  size_t SlotIndex = FreeSlots[ReservedIndex];
-  FreeSlots[ReservedIndex] = FreeSlots[--FreeSlotsLength];
-  return SlotIndex;
+  // Claim a free slot, starting the search at a random slot: take the first
+  // free slot at or after it in its word, or else in the following words.
+  const size_t Start = getRandomUnsigned32() % MaxSimultaneousAllocations;
+  for (size_t I = 0; I <= FreeSlotsWords; ++I) {
+    const size_t Word = (Start / 64 + I) % FreeSlotsWords;
+    const uint64_t StartMask = I == 0 ? ~0ULL << (Start % 64) : ~0ULL;
+    uint64_t Bits = __atomic_load_n(&FreeSlots[Word], __ATOMIC_RELAXED);
+    while (Bits) {
+      const uint64_t Candidates = Bits & StartMask ? Bits & StartMask : Bits;
+      const uint64_t Bit = 1ULL << __builtin_ctzll(Candidates);
+      // Acquire the deallocation of the slot by the thread that freed it.
+      const uint64_t Old =
+          __atomic_fetch_and(&FreeSlots[Word], ~Bit, __ATOMIC_ACQUIRE);
+      if (Old & Bit)
+        return Word * 64 + __builtin_ctzll(Bit);
+      Bits = Old & ~Bit;
+    }
+  }
+  return kInvalidSlotID;
 }
 
 void GuardedPoolAllocator::freeSlot(size_t SlotIndex) {
-  assert(FreeSlotsLength < MaxSimultaneousAllocations);
-  FreeSlots[FreeSlotsLength++] = SlotIndex;
+  assert(SlotIndex < MaxSimultaneousAllocations);
+  const uint64_t Bit = 1ULL << (SlotIndex % 64);
+  const uint64_t Old =
+      __atomic_fetch_or(&FreeSlots[SlotIndex / 64], Bit, __ATOMIC_RELEASE);
+  (void)Old;
+  assert(!(Old & Bit) && "Slot was freed twice");
 }
 
 uintptr_t GuardedPoolAllocator::allocationSlotOffset(size_t Size) const {
@@ -462,8 +476,8 @@ void GuardedPoolAllocator::reportErrorInternal(uintptr_t AccessPtr, Error E) {
 
   // Attempt to prevent races to re-use the same slot that triggered this error.
   // This does not guarantee that there are no races, because another thread can
-  // take the locks during the time that the signal handler is being called.
-  PoolMutex.tryLock();
+  // have reserved a slot already, before we set this flag.
+  __atomic_store_n(&IsReportingError, true, __ATOMIC_RELAXED);
   ThreadLocals.RecursiveGuard = true;
 
   Printf("*** GWP-ASan detected a memory error ***\n");
@@ -10,7 +10,6 @@
 #define GWP_ASAN_GUARDED_POOL_ALLOCATOR_H_
 
 #include "gwp_asan/definitions.h"
-#include "gwp_asan/mutex.h"
 #include "gwp_asan/options.h"
 #include "gwp_asan/random.h"
 
@@ -183,10 +182,10 @@ private:
   bool isGuardPage(uintptr_t Ptr) const;
 
   // Reserve a slot for a new guarded allocation. Returns kInvalidSlotID if no
-  // slot is available to be reserved.
+  // slot is available to be reserved. This function is lock-free.
   size_t reserveSlot();
 
-  // Unreserve the guarded slot.
+  // Unreserve the guarded slot. This function is lock-free.
   void freeSlot(size_t SlotIndex);
 
   // Returns the offset (in bytes) between the start of a guarded slot and where
@@ -204,13 +203,11 @@ private:
   // Cached page size for this system in bytes.
   size_t PageSize = 0;
 
-  // A mutex to protect the guarded slot and metadata pool for this class.
-  Mutex PoolMutex;
   // The number of guarded slots that this pool holds.
   size_t MaxSimultaneousAllocations = 0;
   // Record the number allocations that we've sampled. We store this amount so
   // that we don't randomly choose to recycle a slot that previously had an
-  // allocation before all the slots have been utilised.
+  // allocation before all the slots have been utilised. Updated atomically.
   size_t NumSampledAllocations = 0;
   // Pointer to the pool of guarded slots. Note that this points to the start of
   // the pool (which is a guard page), not a pointer to the first guarded page.
@@ -220,10 +217,16 @@ private:
   // if any.
   AllocationMetadata *Metadata = nullptr;
 
-  // Pointer to an array of free slot indexes.
-  size_t *FreeSlots = nullptr;
-  // The current length of the list of free slots.
-  size_t FreeSlotsLength = 0;
+  // Bitmap of the free slots, with a set bit for each slot that has been used
+  // and freed since. Updated atomically, so that sampled allocations and frees
+  // from different threads don't serialise on a lock.
+  uint64_t *FreeSlots = nullptr;
+  // The number of 64-bit words in FreeSlots.
+  size_t FreeSlotsWords = 0;
+
+  // Set while an error is being reported, so that no slot gets reused (and its
+  // metadata overwritten) during the report.
+  bool IsReportingError = false;
 
   // See options.{h, inc} for more information.
   bool PerfectlyRightAlign = false;
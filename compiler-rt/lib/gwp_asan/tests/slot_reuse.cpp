@@ -70,3 +70,42 @@ TEST_F(CustomGuardedPoolAllocator, NoReuseBeforeNecessary129) {
   InitNumSlots(kPoolSize);
   runNoReuseBeforeNecessary(&GPA, kPoolSize);
 }
+
+// This test ensures that, once every slot has been used, all the freed slots
+// can be reserved again, including those in the last (partial) word of the
+// free slots bitmap.
+void runReuseOfAllSlots(gwp_asan::GuardedPoolAllocator *GPA,
+                        unsigned PoolSize) {
+  std::set<void *> Ptrs;
+  for (unsigned i = 0; i < PoolSize; ++i)
+    GPA->deallocate(GPA->allocate(1));
+
+  for (unsigned i = 0; i < PoolSize; ++i) {
+    void *Ptr = GPA->allocate(1);
+    EXPECT_TRUE(GPA->pointerIsMine(Ptr));
+    Ptrs.insert(Ptr);
+  }
+  EXPECT_EQ(PoolSize, Ptrs.size());
+  EXPECT_EQ(nullptr, GPA->allocate(1));
+
+  for (void *Ptr : Ptrs)
+    GPA->deallocate(Ptr);
+}
+
+TEST_F(CustomGuardedPoolAllocator, ReuseOfAllSlots1) {
+  constexpr unsigned kPoolSize = 1;
+  InitNumSlots(kPoolSize);
+  runReuseOfAllSlots(&GPA, kPoolSize);
+}
+
+TEST_F(CustomGuardedPoolAllocator, ReuseOfAllSlots64) {
+  constexpr unsigned kPoolSize = 64;
+  InitNumSlots(kPoolSize);
+  runReuseOfAllSlots(&GPA, kPoolSize);
+}
+
+TEST_F(CustomGuardedPoolAllocator, ReuseOfAllSlots129) {
+  constexpr unsigned kPoolSize = 129;
+  InitNumSlots(kPoolSize);
+  runReuseOfAllSlots(&GPA, kPoolSize);
+}
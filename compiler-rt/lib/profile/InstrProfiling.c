@@ -39,6 +39,16 @@ COMPILER_RT_VISIBILITY void __llvm_profile_set_dumped() {
   lprofSetProfileDumped();
 }
 
+static int ContinuousModeEnabled = 0;
+
+COMPILER_RT_VISIBILITY int __llvm_profile_is_continuous_mode_enabled(void) {
+  return ContinuousModeEnabled;
+}
+
+COMPILER_RT_VISIBILITY void lprofSetContinuousModeEnabled(int Enabled) {
+  ContinuousModeEnabled = Enabled;
+}
+
 /* Return the number of bytes needed to add to SizeInBytes to make it
  *   the result a multiple of 8.
  */
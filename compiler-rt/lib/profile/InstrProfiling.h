@@ -44,6 +44,21 @@ typedef struct ValueProfNode {
  */
 uint8_t __llvm_profile_get_num_padding_bytes(uint64_t SizeInBytes);
 
+/*!
+ * \brief Get the number of bytes to pad the counters with in the raw profile.
+ *
+ * In continuous mode the counters are placed in the profile so that they can
+ * be mmap'd onto the counter section: \p PaddingBytesBeforeCounters puts them
+ * at the same offset in a file page as \c CountersBegin in a memory page, and
+ * \p PaddingBytesAfterCounters ends them on a page boundary. Otherwise both
+ * are zero. \p PaddingBytesAfterNames pads the names to eight bytes.
+ */
+void __llvm_profile_get_padding_sizes_for_counters(
+    uint64_t DataSize, const uint64_t *CountersBegin,
+    const uint64_t *CountersEnd, uint64_t NamesSize,
+    uint64_t *PaddingBytesBeforeCounters, uint64_t *PaddingBytesAfterCounters,
+    uint64_t *PaddingBytesAfterNames);
+
 /*!
  * \brief Get required size for profile buffer.
  */
@@ -176,6 +191,17 @@ void __llvm_profile_set_filename(const char *Name);
  */
 void __llvm_profile_set_file_object(FILE *File, int EnableMerge);
 
+/*!
+ * \brief Return 1 if the counters are mmap'd onto the profile file.
+ *
+ * Continuous mode is requested with the \c %c specifier in the profile file
+ * name. The profile file is then written when the file name is set, with the
+ * counter section mmap'd onto it, so that the counters are always up to date
+ * in the file and nothing is left to write at exit, even if the process is
+ * killed or crashes. Value profile data is not written in continuous mode.
+ */
+int __llvm_profile_is_continuous_mode_enabled(void);
+
 /*! \brief Register to write instrumentation data to file at exit. */
 int __llvm_profile_register_write_file_atexit(void);
 
@@ -8,6 +8,7 @@
 
 #include "InstrProfiling.h"
 #include "InstrProfilingInternal.h"
+#include "InstrProfilingUtil.h"
 
 COMPILER_RT_VISIBILITY
 uint64_t __llvm_profile_get_size_for_buffer(void) {
@@ -30,18 +31,49 @@ uint64_t __llvm_profile_get_data_size(const __llvm_profile_data *Begin,
          sizeof(__llvm_profile_data);
 }
 
+COMPILER_RT_VISIBILITY
+void __llvm_profile_get_padding_sizes_for_counters(
+    uint64_t DataSize, const uint64_t *CountersBegin,
+    const uint64_t *CountersEnd, uint64_t NamesSize,
+    uint64_t *PaddingBytesBeforeCounters, uint64_t *PaddingBytesAfterCounters,
+    uint64_t *PaddingBytesAfterNames) {
+  *PaddingBytesAfterNames = __llvm_profile_get_num_padding_bytes(NamesSize);
+  if (!__llvm_profile_is_continuous_mode_enabled()) {
+    *PaddingBytesBeforeCounters = 0;
+    *PaddingBytesAfterCounters = 0;
+    return;
+  }
+
+  /* Pad the header and the data to a page, then up to the offset of the
+   * counters in their first page. The counters only share their first and
+   * last page with padding, so these pages can be mapped onto the file. */
+  uint64_t PageSize = lprofGetPageSize();
+  uint64_t DataEnd =
+      sizeof(__llvm_profile_header) + DataSize * sizeof(__llvm_profile_data);
+  *PaddingBytesBeforeCounters = (PageSize - DataEnd % PageSize) % PageSize +
+                                (uintptr_t)CountersBegin % PageSize;
+  *PaddingBytesAfterCounters =
+      (PageSize - (uintptr_t)CountersEnd % PageSize) % PageSize;
+}
+
 COMPILER_RT_VISIBILITY
 uint64_t __llvm_profile_get_size_for_buffer_internal(
     const __llvm_profile_data *DataBegin, const __llvm_profile_data *DataEnd,
     const uint64_t *CountersBegin, const uint64_t *CountersEnd,
     const char *NamesBegin, const char *NamesEnd) {
   /* Match logic in __llvm_profile_write_buffer(). */
+  const uint64_t DataSize = __llvm_profile_get_data_size(DataBegin, DataEnd);
   const uint64_t NamesSize = (NamesEnd - NamesBegin) * sizeof(char);
-  const uint8_t Padding = __llvm_profile_get_num_padding_bytes(NamesSize);
+  uint64_t PaddingBytesBeforeCounters, PaddingBytesAfterCounters,
+      PaddingBytesAfterNames;
+  __llvm_profile_get_padding_sizes_for_counters(
+      DataSize, CountersBegin, CountersEnd, NamesSize,
+      &PaddingBytesBeforeCounters, &PaddingBytesAfterCounters,
+      &PaddingBytesAfterNames);
   return sizeof(__llvm_profile_header) +
-         (__llvm_profile_get_data_size(DataBegin, DataEnd) *
-          sizeof(__llvm_profile_data)) +
-         (CountersEnd - CountersBegin) * sizeof(uint64_t) + NamesSize + Padding;
+         DataSize * sizeof(__llvm_profile_data) + PaddingBytesBeforeCounters +
+         (CountersEnd - CountersBegin) * sizeof(uint64_t) +
+         PaddingBytesAfterCounters + NamesSize + PaddingBytesAfterNames;
 }
 
 COMPILER_RT_VISIBILITY
@@ -331,6 +331,111 @@ static int writeOrderFile(const char *OutputName) {
   return RetVal;
 }
 
+/* Write the profile to the current file and map the counter section onto
+ * it, so that the counters are updated in the file as the program runs. */
+static void initializeProfileForContinuousMode(void) {
+#if defined(_WIN32)
+  PROF_WARN("%s", "continuous mode (%c) is not supported on Windows.\n");
+  lprofSetContinuousModeEnabled(0);
+#else
+  const __llvm_profile_data *DataBegin = __llvm_profile_begin_data();
+  const __llvm_profile_data *DataEnd = __llvm_profile_end_data();
+  const uint64_t *CountersBegin = __llvm_profile_begin_counters();
+  const uint64_t *CountersEnd = __llvm_profile_end_counters();
+  const char *NamesBegin = __llvm_profile_begin_names();
+  const char *NamesEnd = __llvm_profile_end_names();
+  uint64_t DataSize, PaddingBytesBeforeCounters, PaddingBytesAfterCounters,
+      PaddingBytesAfterNames, CountersOffset, MapOffset;
+  uintptr_t PageSize, MapBegin, MapEnd;
+  const char *Filename;
+  char *FilenameBuf;
+  FILE *File;
+  int Length, Fd;
+  void *Map;
+
+  if (CountersBegin == CountersEnd)
+    return;
+
+  Length = getCurFilenameLength();
+  FilenameBuf = (char *)COMPILER_RT_ALLOCA(Length + 1);
+  Filename = getCurFilename(FilenameBuf, 0);
+  if (!Filename) {
+    lprofSetContinuousModeEnabled(0);
+    return;
+  }
+
+  /* Check if there is llvm/runtime version mismatch.  */
+  if (GET_VERSION(__llvm_profile_get_version()) != INSTR_PROF_RAW_VERSION) {
+    PROF_ERR("Runtime and instrumentation version mismatch : "
+             "expected %d, but get %d\n",
+             INSTR_PROF_RAW_VERSION,
+             (int)GET_VERSION(__llvm_profile_get_version()));
+    lprofSetContinuousModeEnabled(0);
+    return;
+  }
+
+  createProfileDir(Filename);
+  File = fopen(Filename, "w+b");
+  if (!File) {
+    PROF_ERR("Failed to open file \"%s\" for continuous mode: %s\n", Filename,
+             strerror(errno));
+    lprofSetContinuousModeEnabled(0);
+    return;
+  }
+
+  /* The counters are page aligned in the file, see
+   * __llvm_profile_get_padding_sizes_for_counters. */
+  ProfDataWriter fileWriter;
+  initFileWriter(&fileWriter, File);
+  if (lprofWriteDataImpl(&fileWriter, DataBegin, DataEnd, CountersBegin,
+                         CountersEnd, 0, NamesBegin, NamesEnd, 0) ||
+      fflush(File)) {
+    PROF_ERR("Failed to write file \"%s\": %s\n", Filename, strerror(errno));
+    fclose(File);
+    lprofSetContinuousModeEnabled(0);
+    return;
+  }
+
+  DataSize = __llvm_profile_get_data_size(DataBegin, DataEnd);
+  __llvm_profile_get_padding_sizes_for_counters(
+      DataSize, CountersBegin, CountersEnd, NamesEnd - NamesBegin,
+      &PaddingBytesBeforeCounters, &PaddingBytesAfterCounters,
+      &PaddingBytesAfterNames);
+  CountersOffset = sizeof(__llvm_profile_header) +
+                   DataSize * sizeof(__llvm_profile_data) +
+                   PaddingBytesBeforeCounters;
+  PageSize = lprofGetPageSize();
+  MapBegin = (uintptr_t)CountersBegin - (uintptr_t)CountersBegin % PageSize;
+  MapEnd = (uintptr_t)CountersEnd + PaddingBytesAfterCounters;
+  MapOffset = CountersOffset - ((uintptr_t)CountersBegin - MapBegin);
+
+  /* The first and the last page of the counters may hold other data of the
+   * program. Copy it to the padding the pages are mapped onto, so that it is
+   * kept. Updates of this data by other threads until the mapping is in place
+   * would be lost, which is why this is done as the program starts. */
+  Fd = fileno(File);
+  if (pwrite(Fd, (void *)MapBegin, (uintptr_t)CountersBegin - MapBegin,
+             MapOffset) < 0 ||
+      pwrite(Fd, CountersEnd, PaddingBytesAfterCounters,
+             CountersOffset + (CountersEnd - CountersBegin) *
+                                  sizeof(uint64_t)) < 0) {
+    PROF_ERR("Failed to write file \"%s\": %s\n", Filename, strerror(errno));
+    fclose(File);
+    lprofSetContinuousModeEnabled(0);
+    return;
+  }
+
+  Map = mmap((void *)MapBegin, MapEnd - MapBegin, PROT_READ | PROT_WRITE,
+             MAP_FIXED | MAP_SHARED, Fd, MapOffset);
+  if (Map == MAP_FAILED) {
+    PROF_ERR("Failed to mmap the counters onto \"%s\": %s\n", Filename,
+             strerror(errno));
+    lprofSetContinuousModeEnabled(0);
+  }
+  fclose(File);
+#endif
+}
+
 static void truncateCurrentFile(void) {
   const char *Filename;
   char *FilenameBuf;
@@ -383,6 +488,7 @@ static int parseFilenamePattern(const char *FilenamePat,
   char *PidChars = &lprofCurFilename.PidChars[0];
   char *Hostname = &lprofCurFilename.Hostname[0];
   int MergingEnabled = 0;
+  int ContinuousModeRequested = 0;
 
   /* Clean up cached prefix and filename.  */
   if (lprofCurFilename.ProfilePathPrefix)
@@ -422,6 +528,13 @@ static int parseFilenamePattern(const char *FilenamePat,
                       FilenamePat);
             return -1;
           }
+      } else if (FilenamePat[I] == 'c') {
+        if (ContinuousModeRequested) {
+          PROF_WARN("%%c specifier can only be specified once in %s.\n",
+                    FilenamePat);
+          return -1;
+        }
+        ContinuousModeRequested = 1;
       } else if (containsMergeSpecifier(FilenamePat, I)) {
         if (MergingEnabled) {
           PROF_WARN("%%m specifier can only be specified once in %s.\n",
@@ -438,8 +551,20 @@ static int parseFilenamePattern(const char *FilenamePat,
       }
     }
 
+  /* The mapped file is shared by the processes that write to it, so it
+   * can't be merged into. */
+  if (ContinuousModeRequested && MergingEnabled) {
+    PROF_WARN("%%c and %%m specifiers can't be combined in %s.\n",
+              FilenamePat);
+    return -1;
+  }
+
   lprofCurFilename.NumPids = NumPids;
   lprofCurFilename.NumHosts = NumHosts;
+  /* Once the counters are mapped onto a file, they stay mapped: a later file
+   * name gets them mapped onto the new file. */
+  if (ContinuousModeRequested)
+    lprofSetContinuousModeEnabled(1);
   return 0;
 }
 
@@ -478,6 +603,8 @@ static void parseAndSetFilename(const char *FilenamePat,
   }
 
   truncateCurrentFile();
+  if (__llvm_profile_is_continuous_mode_enabled())
+    initializeProfileForContinuousMode();
 }
 
 /* Return buffer length that is required to store the current profile
@@ -490,7 +617,8 @@ static int getCurFilenameLength() {
     return 0;
 
   if (!(lprofCurFilename.NumPids || lprofCurFilename.NumHosts ||
-        lprofCurFilename.MergePoolSize))
+        lprofCurFilename.MergePoolSize ||
+        __llvm_profile_is_continuous_mode_enabled()))
     return strlen(lprofCurFilename.FilenamePat);
 
   Len = strlen(lprofCurFilename.FilenamePat) +
@@ -514,7 +642,8 @@ static const char *getCurFilename(char *FilenameBuf, int ForceUseBuf) {
     return 0;
 
   if (!(lprofCurFilename.NumPids || lprofCurFilename.NumHosts ||
-        lprofCurFilename.MergePoolSize)) {
+        lprofCurFilename.MergePoolSize ||
+        __llvm_profile_is_continuous_mode_enabled())) {
     if (!ForceUseBuf)
       return lprofCurFilename.FilenamePat;
 
@@ -672,6 +801,10 @@ int __llvm_profile_write_file(void) {
     return 0;
   }
 
+  /* The counters are already in the file. */
+  if (__llvm_profile_is_continuous_mode_enabled())
+    return 0;
+
   Length = getCurFilenameLength();
   FilenameBuf = (char *)COMPILER_RT_ALLOCA(Length + 1);
   Filename = getCurFilename(FilenameBuf, 0);
@@ -104,6 +104,9 @@ uint32_t lprofBufferWriter(ProfDataWriter *This, ProfDataIOVec *IOVecs,
                            uint32_t NumIOVecs);
 void initBufferWriter(ProfDataWriter *BufferWriter, char *Buffer);
 
+/* Turn continuous mode on (\p Enabled = 1) or off. */
+void lprofSetContinuousModeEnabled(int Enabled);
+
 struct ValueProfData;
 struct ValueProfRecord;
 struct InstrProfValueData;
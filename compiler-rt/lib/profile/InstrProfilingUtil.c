@@ -104,6 +104,16 @@ COMPILER_RT_VISIBILITY int lprofGetHostName(char *Name, int Len) {
 }
 #endif
 
+COMPILER_RT_VISIBILITY size_t lprofGetPageSize(void) {
+#ifdef _WIN32
+  SYSTEM_INFO Info;
+  GetSystemInfo(&Info);
+  return Info.dwPageSize;
+#else
+  return sysconf(_SC_PAGESIZE);
+#endif
+}
+
 COMPILER_RT_VISIBILITY int lprofLockFd(int fd) {
 #ifdef COMPILER_RT_HAS_FCNTL_LCK
   struct flock s_flock;
@@ -263,6 +263,38 @@ COMPILER_RT_VISIBILITY void __llvm_profile_instrument_range(
   __llvm_profile_instrument_target(TargetValue, Data, CounterIndex);
 }
 
+/*
+ * Like __llvm_profile_instrument_range, except that the values in
+ * (PreciseRangeLast, LargeValue) are not all collapsed into one value. They
+ * are grouped into power-of-two buckets instead, each one counted as its
+ * upper bound: a value V is mapped to the smallest power of two that is not
+ * less than V, so that the bucket of a power of two P is (P / 2, P].
+ *
+ * A bucket that would be counted as PreciseRangeLast + 1 or as LargeValue
+ * would be mistaken for the other groups, so it is collapsed into
+ * PreciseRangeLast + 1 as before.
+ */
+COMPILER_RT_VISIBILITY void __llvm_profile_instrument_range_buckets(
+    uint64_t TargetValue, void *Data, uint32_t CounterIndex,
+    int64_t PreciseRangeStart, int64_t PreciseRangeLast, int64_t LargeValue) {
+
+  if (LargeValue != INT64_MIN && (int64_t)TargetValue >= LargeValue)
+    TargetValue = LargeValue;
+  else if ((int64_t)TargetValue < PreciseRangeStart)
+    TargetValue = PreciseRangeLast + 1;
+  else if ((int64_t)TargetValue > PreciseRangeLast) {
+    uint64_t Bucket = 1;
+    while (Bucket < TargetValue)
+      Bucket <<= 1;
+    if ((int64_t)Bucket <= PreciseRangeLast + 1 ||
+        (LargeValue != INT64_MIN && (int64_t)Bucket >= LargeValue))
+      Bucket = PreciseRangeLast + 1;
+    TargetValue = Bucket;
+  }
+
+  __llvm_profile_instrument_target(TargetValue, Data, CounterIndex);
+}
+
 /*
  * A wrapper struct that represents value profile runtime data.
  * Like InstrProfRecord class which is used by profiling host tools,
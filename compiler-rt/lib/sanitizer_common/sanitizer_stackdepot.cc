@@ -99,6 +99,22 @@ u32 StackDepotPut(StackTrace stack) {
   return h.valid() ? h.id() : 0;
 }
 
+u32 StackDepotPut(StackTrace stack, StackDepotCache *cache) {
+  if (!cache)
+    return StackDepotPut(stack);
+  if (!StackDepotNode::is_valid(stack))
+    return 0;
+  u32 hash = StackDepotNode::hash(stack);
+  StackDepotNode *&cached = cache->nodes[hash % StackDepotCache::kSize];
+  if (cached && cached->eq(hash, stack))
+    return cached->id;
+  StackDepotHandle h = theDepot.PutWithHash(stack, hash);
+  if (!h.valid())
+    return 0;
+  cached = h.node_;
+  return h.id();
+}
+
 StackDepotHandle StackDepotPut_WithHandle(StackTrace stack) {
   return theDepot.Put(stack);
 }
@@ -33,8 +33,19 @@ struct StackDepotHandle {
 
 const int kStackDepotMaxUseCount = 1U << (SANITIZER_ANDROID ? 16 : 20);
 
+// A small cache of the stacks that a thread stored last. Allocation-heavy
+// code stores the same few stacks over and over, and finding them in the
+// cache is cheaper than looking them up in the depot. The cache must be
+// zero-initialized, and must only be used by one thread at a time.
+struct StackDepotCache {
+  static const uptr kSize = 64;
+  StackDepotNode *nodes[kSize];
+};
+
 StackDepotStats *StackDepotGetStats();
 u32 StackDepotPut(StackTrace stack);
+// Same as StackDepotPut, looking the stack up in the cache first.
+u32 StackDepotPut(StackTrace stack, StackDepotCache *cache);
 StackDepotHandle StackDepotPut_WithHandle(StackTrace stack);
 // Retrieves a stored stack trace by the id.
 StackTrace StackDepotGet(u32 id);
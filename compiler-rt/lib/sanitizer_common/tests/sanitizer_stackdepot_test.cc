@@ -64,6 +64,23 @@ TEST(SanitizerCommon, StackDepotSeveral) {
   EXPECT_NE(i1, i2);
 }
 
+TEST(SanitizerCommon, StackDepotCache) {
+  StackDepotCache cache = {};
+  uptr array1[] = {1, 2, 3, 4, 10};
+  uptr array2[] = {1, 2, 3, 4, 11};
+  StackTrace s1(array1, ARRAY_SIZE(array1));
+  StackTrace s2(array2, ARRAY_SIZE(array2));
+  u32 i1 = StackDepotPut(s1, &cache);
+  EXPECT_NE(0U, i1);
+  EXPECT_EQ(i1, StackDepotPut(s1, &cache));
+  EXPECT_EQ(i1, StackDepotPut(s1));
+  u32 i2 = StackDepotPut(s2, &cache);
+  EXPECT_NE(i1, i2);
+  EXPECT_EQ(i2, StackDepotPut(s2, &cache));
+  EXPECT_EQ(i1, StackDepotPut(s1, &cache));
+  EXPECT_EQ(0U, StackDepotPut(StackTrace(), &cache));
+}
+
 TEST(SanitizerCommon, StackDepotReverseMap) {
   uptr array1[] = {1, 2, 3, 4, 5};
   uptr array2[] = {7, 1, 3, 0};
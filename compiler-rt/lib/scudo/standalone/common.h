@@ -127,6 +127,11 @@ INLINE uptr getPageSizeCached() {
 
 u32 getNumberOfCPUs();
 
+// Returns the CPU the calling thread is running on, or -1 if that can't be
+// determined. The result is only a hint, as the thread can migrate at any
+// time.
+s32 getCurrentCPU();
+
 const char *getEnv(const char *Name);
 
 u64 getMonotonicTime();
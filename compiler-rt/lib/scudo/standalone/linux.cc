@@ -115,6 +115,10 @@ u32 getNumberOfCPUs() {
   return static_cast<u32>(CPU_COUNT(&CPUs));
 }
 
+// sched_getcpu() reads the CPU number from the rseq area or the vDSO where
+// available, so it doesn't require a syscall on recent kernels.
+s32 getCurrentCPU() { return sched_getcpu(); }
+
 // Blocking is possibly unused if the getrandom block is not compiled in.
 bool getRandom(void *Buffer, uptr Length, UNUSED bool Blocking) {
   if (!Buffer || !Length || Length > MaxRandomLength)
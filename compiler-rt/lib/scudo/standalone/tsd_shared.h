@@ -109,6 +109,18 @@ private:
 
   NOINLINE TSD<Allocator> *getTSDAndLockSlow(TSD<Allocator> *CurrentTSD) {
     if (MaxTSDCount > 1U && NumberOfTSDs > 1U) {
+      // First try the TSD of the CPU we are running on. The threads running on
+      // a given CPU at a given time are then the only ones using its TSD, so
+      // a thread pool with more threads than CPUs ends up with (mostly)
+      // uncontended per-CPU caches, and we switch to it for later calls.
+      const s32 CPU = getCurrentCPU();
+      if (CPU >= 0) {
+        TSD<Allocator> *CPUTSD = &TSDs[static_cast<u32>(CPU) % NumberOfTSDs];
+        if (CPUTSD != CurrentTSD && CPUTSD->tryLock()) {
+          setCurrentTSD(CPUTSD);
+          return CPUTSD;
+        }
+      }
       // Use the Precedence of the current TSD as our random seed. Since we are
       // in the slow path, it means that tryLock failed, and as a result it's
       // very likely that said Precedence is non-zero.
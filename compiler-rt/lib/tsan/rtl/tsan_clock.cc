@@ -237,14 +237,16 @@ void ThreadClock::ReleaseStore(ClockCache *c, SyncClock *dst) {
   DCHECK_LE(dst->size_, kMaxTid);
   CPP_STAT_INC(StatClockStore);
 
-  if (dst->size_ == 0 && cached_idx_ != 0) {
-    // Reuse the cached clock.
-    // Note: we could reuse/cache the cached clock in more cases:
-    // we could update the existing clock and cache it, or replace it with the
-    // currently cached clock and release the old one. And for a shared
-    // existing clock, we could replace it with the currently cached;
-    // or unshare, update and cache. But, for simplicity, we currnetly reuse
-    // cached clock only when the target clock is empty.
+  if (cached_idx_ != 0 && (dst->size_ == 0 || !IsReleaseStoreFast(dst))) {
+    // Reuse the cached clock. The release-store overwrites dst completely,
+    // so if dst is not empty, we drop the reference to its old clock and
+    // replace it with the cached one. This way the sync objects that a thread
+    // releases to between acquires share a single clock, rather than each
+    // holding its own O(N) copy.
+    if (dst->size_ != 0) {
+      CPP_STAT_INC(StatClockStoreReplace);
+      dst->Reset(c);
+    }
     dst->tab_ = ctx->clock_alloc.Map(cached_idx_);
     dst->tab_idx_ = cached_idx_;
     dst->size_ = cached_size_;
@@ -267,9 +269,7 @@ void ThreadClock::ReleaseStore(ClockCache *c, SyncClock *dst) {
   if (dst->size_ < nclk_)
     dst->Resize(c, nclk_);
 
-  if (dst->release_store_tid_ == tid_ &&
-      dst->release_store_reused_ == reused_ &&
-      dst->elem(tid_).epoch > last_acquire_) {
+  if (IsReleaseStoreFast(dst)) {
     CPP_STAT_INC(StatClockStoreFast);
     UpdateCurrentThread(c, dst);
     return;
@@ -337,6 +337,15 @@ void ThreadClock::UpdateCurrentThread(ClockCache *c, SyncClock *dst) const {
   dst->FlushDirty();
 }
 
+// Checks whether dst holds the result of the last release-store of the
+// current thread and we had not acquired anything from other threads since.
+// If so, the release-store needs to update only dst->elem(tid_).
+ALWAYS_INLINE bool ThreadClock::IsReleaseStoreFast(const SyncClock *dst) const {
+  return dst->release_store_tid_ == tid_ &&
+         dst->release_store_reused_ == reused_ &&
+         dst->elem(tid_).epoch > last_acquire_;
+}
+
 // Checks whether the current thread has already acquired src.
 bool ThreadClock::IsAlreadyAcquired(const SyncClock *src) const {
   if (src->elem(tid_).reused != reused_)
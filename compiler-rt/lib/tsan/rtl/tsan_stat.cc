@@ -86,6 +86,7 @@ void StatOutput(u64 *stat) {
   name[StatClockStore]                   = "Clock release store               ";
   name[StatClockStoreResize]             = "  resize                          ";
   name[StatClockStoreFast]               = "  fast                            ";
+  name[StatClockStoreReplace]            = "  replaced with cached            ";
   name[StatClockStoreFull]               = "  slow                            ";
   name[StatClockStoreTail]               = "  clear tail                      ";
   name[StatClockAcquireRelease]          = "Clock acquire-release             ";
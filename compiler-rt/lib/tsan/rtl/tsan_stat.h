@@ -87,6 +87,7 @@ enum StatType {
   StatClockStore,
   StatClockStoreResize,
   StatClockStoreFast,
+  StatClockStoreReplace,
   StatClockStoreFull,
   StatClockStoreTail,
   // Clocks - acquire-release.
@@ -108,6 +108,35 @@ TEST(Clock, RepeatedAcquire) {
   sync.Reset(&cache);
 }
 
+TEST(Clock, ReleaseStoreReplacesCached) {
+  // thr2 releases to sync2, which already holds a larger clock of thr1,
+  // while it has a cached clock from the release-store to sync1.
+  ThreadClock thr1(100);
+  thr1.tick();
+  ThreadClock thr2(2);
+  thr2.tick();
+  SyncClock sync1, sync2;
+  thr1.ReleaseStore(&cache, &sync2);
+  ASSERT_EQ(sync2.size(), 101U);
+  thr2.ReleaseStore(&cache, &sync1);
+  thr2.tick();
+  thr2.ReleaseStore(&cache, &sync2);
+  ASSERT_EQ(sync2.size(), 3U);
+  ASSERT_EQ(sync2.get(2), 2U);
+  ASSERT_EQ(sync1.get(2), 1U);
+
+  ThreadClock thr3(3);
+  thr3.acquire(&cache, &sync2);
+  ASSERT_EQ(thr3.get(2), 2U);
+  ASSERT_EQ(thr3.get(100), 0U);
+  thr3.acquire(&cache, &sync1);
+  ASSERT_EQ(thr3.get(2), 2U);
+
+  sync1.Reset(&cache);
+  sync2.Reset(&cache);
+  thr2.ResetCached(&cache);
+}
+
 TEST(Clock, ManyThreads) {
   SyncClock chunked;
   for (unsigned i = 0; i < 200; i++) {
@@ -17,6 +17,7 @@
 #include <future>
 #include <thread>
 #include <unistd.h>
+#include <vector>
 
 namespace __xray {
 namespace {
@@ -106,6 +107,47 @@ TEST(BufferQueueTest, MultiThreaded) {
   F();
 }
 
+TEST(BufferQueueTest, MultiThreadedKeepsAllBuffers) {
+  bool Success = false;
+  static constexpr size_t kCount = 4;
+  BufferQueue Buffers(kSize, kCount, Success);
+  ASSERT_TRUE(Success);
+
+  // More threads than buffers get and release buffers concurrently, to catch
+  // buffers that are lost or handed out twice.
+  std::atomic<bool> Shared{false};
+  auto F = [&] {
+    for (int I = 0; I < 10000; ++I) {
+      BufferQueue::Buffer B;
+      if (Buffers.getBuffer(B) != BufferQueue::ErrorCode::Ok)
+        continue;
+      auto *Owner = static_cast<std::atomic<bool> *>(B.Data);
+      if (Owner->exchange(true, std::memory_order_acq_rel))
+        Shared.store(true, std::memory_order_release);
+      Owner->store(false, std::memory_order_release);
+      ASSERT_EQ(Buffers.releaseBuffer(B), BufferQueue::ErrorCode::Ok);
+    }
+  };
+  std::vector<std::thread> Threads;
+  for (int I = 0; I < 8; ++I)
+    Threads.emplace_back(F);
+  for (auto &T : Threads)
+    T.join();
+  EXPECT_FALSE(Shared.load(std::memory_order_acquire));
+
+  // All the buffers are available again, and they are distinct.
+  BufferQueue::Buffer Bs[kCount];
+  for (auto &B : Bs)
+    ASSERT_EQ(Buffers.getBuffer(B), BufferQueue::ErrorCode::Ok);
+  BufferQueue::Buffer Extra;
+  EXPECT_EQ(Buffers.getBuffer(Extra), BufferQueue::ErrorCode::NotEnoughMemory);
+  for (size_t I = 0; I < kCount; ++I)
+    for (size_t J = I + 1; J < kCount; ++J)
+      EXPECT_NE(Bs[I].Data, Bs[J].Data);
+  for (auto &B : Bs)
+    EXPECT_EQ(Buffers.releaseBuffer(B), BufferQueue::ErrorCode::Ok);
+}
+
 TEST(BufferQueueTest, Apply) {
   bool Success = false;
   BufferQueue Buffers(kSize, 10, Success);
@@ -53,6 +53,33 @@ void incRefCount(BufferQueue::ControlBlock *C) {
   atomic_fetch_add(&C->RefCount, 1, memory_order_acq_rel);
 }
 
+size_t ringSize(size_t Count) {
+  return sizeof(BufferQueue::BufferRing) +
+         (Count - 1) * sizeof(BufferQueue::BufferRep);
+}
+
+BufferQueue::BufferRing *allocRing(size_t Count) {
+  auto R = allocateBuffer(ringSize(Count));
+  return R == nullptr ? nullptr
+                      : reinterpret_cast<BufferQueue::BufferRing *>(R);
+}
+
+void decRefCount(BufferQueue::BufferRing *R, size_t Count) {
+  if (R == nullptr)
+    return;
+  if (atomic_fetch_sub(&R->RefCount, 1, memory_order_acq_rel) != 1)
+    return;
+  for (auto B = R->Reps, E = R->Reps + Count; B != E; ++B)
+    B->~BufferRep();
+  deallocateBuffer(reinterpret_cast<unsigned char *>(R), ringSize(Count));
+}
+
+void incRefCount(BufferQueue::BufferRing *R) {
+  if (R == nullptr)
+    return;
+  atomic_fetch_add(&R->RefCount, 1, memory_order_acq_rel);
+}
+
 // We use a struct to ensure that we are allocating one atomic_uint64_t per
 // cache line. This allows us to not worry about false-sharing among atomic
 // objects being updated (constantly) by different threads.
@@ -102,9 +129,12 @@ BufferQueue::ErrorCode BufferQueue::init(size_t BS, size_t BC) {
     ExtentsBackingStore = nullptr;
   });
 
-  Buffers = initArray<BufferRep>(BufferCount);
-  if (Buffers == nullptr)
+  Ring = allocRing(BufferCount);
+  if (Ring == nullptr)
     return BufferQueue::ErrorCode::NotEnoughMemory;
+  Buffers = Ring->Reps;
+  for (size_t i = 0; i < BufferCount; ++i)
+    new (Buffers + i) BufferRep();
 
   // At this point we increment the generation number to associate the buffers
   // to the new generation.
@@ -114,6 +144,7 @@ BufferQueue::ErrorCode BufferQueue::init(size_t BS, size_t BC) {
   // being at the start of the BackingStore pointer.
   atomic_store(&BackingStore->RefCount, 1, memory_order_release);
   atomic_store(&ExtentsBackingStore->RefCount, 1, memory_order_release);
+  atomic_store(&Ring->RefCount, 1, memory_order_release);
 
   // Then we initialise the individual buffers that sub-divide the whole backing
   // store. Each buffer will start at the `Data` member of the ControlBlock, and
@@ -130,13 +161,17 @@ BufferQueue::ErrorCode BufferQueue::init(size_t BS, size_t BC) {
     Buf.Size = BufferSize;
     Buf.BackingStore = BackingStore;
     Buf.ExtentsBackingStore = ExtentsBackingStore;
+    Buf.Ring = Ring;
     Buf.Count = BufferCount;
     T.Used = false;
+
+    // All the buffers start out available, as if they had been released at
+    // positions [0, BufferCount).
+    atomic_store(&T.Sequence, i + 1, memory_order_relaxed);
   }
 
-  Next = Buffers;
-  First = Buffers;
-  LiveBuffers = 0;
+  atomic_store(&Ring->GetPos, 0, memory_order_relaxed);
+  atomic_store(&Ring->ReleasePos, BufferCount, memory_order_relaxed);
   atomic_store(&Finalizing, 0, memory_order_release);
   Success = true;
   return BufferQueue::ErrorCode::Ok;
@@ -150,10 +185,8 @@ BufferQueue::BufferQueue(size_t B, size_t N,
       Finalizing{1},
       BackingStore(nullptr),
       ExtentsBackingStore(nullptr),
+      Ring(nullptr),
       Buffers(nullptr),
-      Next(Buffers),
-      First(Buffers),
-      LiveBuffers(0),
       Generation{0} {
   Success = init(B, N) == BufferQueue::ErrorCode::Ok;
 }
@@ -162,56 +195,107 @@ BufferQueue::ErrorCode BufferQueue::getBuffer(Buffer &Buf) {
   if (atomic_load(&Finalizing, memory_order_acquire))
     return ErrorCode::QueueFinalizing;
 
+  // Claim the slot at the get position, if it holds an available buffer. When
+  // it does not, all the buffers are handed out.
+  BufferRing *R = Ring;
+  size_t Count = BufferCount;
   BufferRep *B = nullptr;
-  {
-    SpinMutexLock Guard(&Mutex);
-    if (LiveBuffers == BufferCount)
-      return ErrorCode::NotEnoughMemory;
-    B = Next++;
-    if (Next == (Buffers + BufferCount))
-      Next = Buffers;
-    ++LiveBuffers;
+  atomic_uint64_t::Type Pos = atomic_load(&R->GetPos, memory_order_relaxed);
+  while (true) {
+    B = &R->Reps[Pos % Count];
+    uint64_t Seq = atomic_load(&B->Sequence, memory_order_acquire);
+    int64_t Diff = static_cast<int64_t>(Seq - (Pos + 1));
+    if (Diff < 0) {
+      // The slot is empty: either all the buffers are handed out, or a
+      // release that claimed this slot has yet to fill it.
+      if (atomic_load(&R->ReleasePos, memory_order_acquire) <= Pos)
+        return ErrorCode::NotEnoughMemory;
+      proc_yield(1);
+      Pos = atomic_load(&R->GetPos, memory_order_relaxed);
+      continue;
+    }
+    if (Diff > 0) {
+      // Another thread claimed this slot first.
+      Pos = atomic_load(&R->GetPos, memory_order_relaxed);
+      continue;
+    }
+    if (atomic_compare_exchange_weak(&R->GetPos, &Pos, Pos + 1,
+                                     memory_order_relaxed))
+      break;
   }
 
-  incRefCount(BackingStore);
-  incRefCount(ExtentsBackingStore);
   Buf = B->Buff;
-  Buf.Generation = generation();
   B->Used = true;
+
+  // Make the slot available to the release that is a full turn of the ring
+  // ahead.
+  atomic_store(&B->Sequence, Pos + Count, memory_order_release);
+
+  incRefCount(Buf.BackingStore);
+  incRefCount(Buf.ExtentsBackingStore);
+  incRefCount(Buf.Ring);
+  Buf.Generation = generation();
   return ErrorCode::Ok;
 }
 
 BufferQueue::ErrorCode BufferQueue::releaseBuffer(Buffer &Buf) {
+  // The buffer keeps the backing stores and the ring of its generation alive,
+  // so that buffers of a previous generation can be dropped without looking
+  // at the current one.
+  auto DropReferences = [&Buf] {
+    decRefCount(Buf.BackingStore, Buf.Size, Buf.Count);
+    decRefCount(Buf.ExtentsBackingStore, kExtentsSize, Buf.Count);
+    decRefCount(Buf.Ring, Buf.Count);
+    Buf = {};
+  };
+
+  if (Buf.Generation != generation()) {
+    DropReferences();
+    return BufferQueue::ErrorCode::Ok;
+  }
+
   // Check whether the buffer being referred to is within the bounds of the
   // backing store's range.
+  if (Buf.Ring == nullptr || Buf.BackingStore == nullptr ||
+      Buf.Data < &Buf.BackingStore->Data ||
+      Buf.Data > &Buf.BackingStore->Data + (Buf.Count * Buf.Size))
+    return BufferQueue::ErrorCode::UnrecognizedBuffer;
+
+  // Claim the slot at the release position. The slot is free once the get
+  // that took its previous buffer is done, unless more buffers are released
+  // than were handed out.
+  BufferRing *R = Buf.Ring;
+  size_t Count = Buf.Count;
   BufferRep *B = nullptr;
-  {
-    SpinMutexLock Guard(&Mutex);
-    if (Buf.Generation != generation() || LiveBuffers == 0) {
-      Buf = {};
-      decRefCount(Buf.BackingStore, Buf.Size, Buf.Count);
-      decRefCount(Buf.ExtentsBackingStore, kExtentsSize, Buf.Count);
-      return BufferQueue::ErrorCode::Ok;
+  atomic_uint64_t::Type Pos = atomic_load(&R->ReleasePos, memory_order_relaxed);
+  while (true) {
+    B = &R->Reps[Pos % Count];
+    uint64_t Seq = atomic_load(&B->Sequence, memory_order_acquire);
+    int64_t Diff = static_cast<int64_t>(Seq - Pos);
+    if (Diff < 0) {
+      if (atomic_load(&R->GetPos, memory_order_acquire) + Count <= Pos) {
+        DropReferences();
+        return BufferQueue::ErrorCode::Ok;
+      }
+      proc_yield(1);
+      Pos = atomic_load(&R->ReleasePos, memory_order_relaxed);
+      continue;
     }
-
-    if (Buf.Data < &BackingStore->Data ||
-        Buf.Data > &BackingStore->Data + (BufferCount * BufferSize))
-      return BufferQueue::ErrorCode::UnrecognizedBuffer;
-
-    --LiveBuffers;
-    B = First++;
-    if (First == (Buffers + BufferCount))
-      First = Buffers;
+    if (Diff > 0) {
+      Pos = atomic_load(&R->ReleasePos, memory_order_relaxed);
+      continue;
+    }
+    if (atomic_compare_exchange_weak(&R->ReleasePos, &Pos, Pos + 1,
+                                     memory_order_relaxed))
+      break;
   }
 
-  // Now that the buffer has been released, we mark it as "used".
+  // Now that the buffer has been released, we mark it as "used", and publish
+  // it to the next thread that gets this slot.
   B->Buff = Buf;
   B->Used = true;
-  decRefCount(Buf.BackingStore, Buf.Size, Buf.Count);
-  decRefCount(Buf.ExtentsBackingStore, kExtentsSize, Buf.Count);
-  atomic_store(B->Buff.Extents, atomic_load(Buf.Extents, memory_order_acquire),
-               memory_order_release);
-  Buf = {};
+  atomic_store(&B->Sequence, Pos + 1, memory_order_release);
+  DropReferences();
   return ErrorCode::Ok;
 }
 
@@ -222,13 +306,12 @@ BufferQueue::ErrorCode BufferQueue::finalize() {
 }
 
 void BufferQueue::cleanupBuffers() {
-  for (auto B = Buffers, E = Buffers + BufferCount; B != E; ++B)
-    B->~BufferRep();
-  deallocateBuffer(Buffers, BufferCount);
   decRefCount(BackingStore, BufferSize, BufferCount);
   decRefCount(ExtentsBackingStore, kExtentsSize, BufferCount);
+  decRefCount(Ring, BufferCount);
   BackingStore = nullptr;
   ExtentsBackingStore = nullptr;
+  Ring = nullptr;
   Buffers = nullptr;
   BufferCount = 0;
   BufferSize = 0;
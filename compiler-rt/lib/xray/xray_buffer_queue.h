@@ -28,8 +28,16 @@ namespace __xray {
 /// get from or return buffers to the queue. This is one key component of the
 /// "flight data recorder" (FDR) mode to support ongoing XRay function call
 /// trace collection.
+///
+/// Getting and releasing buffers is lock-free: the queue is a bounded
+/// multi-producer/multi-consumer ring, where each slot has a sequence number
+/// telling whether it holds an available buffer. Threads that get and release
+/// buffers then only contend on the two positions in the ring, rather than on
+/// a lock whose holder may be preempted.
 class BufferQueue {
 public:
+  struct BufferRing;
+
   /// ControlBlock represents the memory layout of how we interpret the backing
   /// store for all buffers and extents managed by a BufferQueue instance. The
   /// ControlBlock has the reference count as the first member, sized according
@@ -61,6 +69,7 @@ public:
     friend class BufferQueue;
     ControlBlock *BackingStore = nullptr;
     ControlBlock *ExtentsBackingStore = nullptr;
+    BufferRing *Ring = nullptr;
     size_t Count = 0;
   };
 
@@ -71,6 +80,36 @@ public:
     // This is true if the buffer has been returned to the available queue, and
     // is considered "used" by another thread.
     bool Used = false;
+
+    // The slot holds an available buffer when Sequence is one past the
+    // position of the next get from the ring, and is free to receive a
+    // released buffer when Sequence is equal to the position of the next
+    // release.
+    atomic_uint64_t Sequence;
+  };
+
+  /// BufferRing holds the slots of the ring of a generation, along with the
+  /// positions of the next get and release. Like the backing stores, it is
+  /// reference counted by the buffers handed out, so that releasing a buffer
+  /// of a generation that was cleaned up never touches freed memory. Each
+  /// atomic lives in a cache line of its own.
+  struct BufferRing {
+    union {
+      atomic_uint64_t RefCount;
+      char RefCountStorage[kCacheLineSize];
+    };
+    union {
+      atomic_uint64_t ReleasePos;
+      char ReleasePosStorage[kCacheLineSize];
+    };
+    union {
+      atomic_uint64_t GetPos;
+      char GetPosStorage[kCacheLineSize];
+    };
+
+    /// We need to make this size 1, to conform to the C++ rules for array data
+    /// members.
+    BufferRep Reps[1];
   };
 
 private:
@@ -137,6 +176,8 @@ private:
   // Amount of pre-allocated buffers.
   size_t BufferCount;
 
+  // Serialises (re-)initialisation with apply(...). Getting and releasing
+  // buffers does not take this lock.
   SpinMutex Mutex;
   atomic_uint8_t Finalizing;
 
@@ -146,18 +187,11 @@ private:
   // The collocated ControlBlock and extents storage.
   ControlBlock *ExtentsBackingStore;
 
-  // A dynamically allocated array of BufferRep instances.
-  BufferRep *Buffers;
-
-  // Pointer to the next buffer to be handed out.
-  BufferRep *Next;
+  // The ring of the current generation.
+  BufferRing *Ring;
 
-  // Pointer to the entry in the array where the next released buffer will be
-  // placed.
-  BufferRep *First;
-
-  // Count of buffers that have been handed out through 'getBuffer'.
-  size_t LiveBuffers;
+  // The BufferRep instances of the ring of the current generation.
+  BufferRep *Buffers;
 
   // We use a generation number to identify buffers and which generation they're
   // associated with.
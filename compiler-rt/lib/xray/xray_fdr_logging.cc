@@ -66,6 +66,13 @@ struct XRAY_TLS_ALIGNAS(64) ThreadLocalData {
                                     alignof(FDRController<>)>::type;
   ControllerStorage CStorage;
   FDRController<> *Controller = nullptr;
+
+  // Sampling state: the depth of instrumented calls on this thread, the number
+  // of outermost calls left to skip, and whether the current outermost call is
+  // recorded.
+  uint32_t CallDepth = 0;
+  uint32_t SkippedCalls = 0;
+  bool Sampled = false;
 };
 
 } // namespace
@@ -83,6 +90,9 @@ static BufferQueue *BQ = nullptr;
 // Global thresholds for function durations.
 static atomic_uint64_t ThresholdTicks{0};
 
+// Global sampling rate: one in this many outermost calls is recorded.
+static atomic_uint32_t SamplingRate{1};
+
 // Global for ticks per second.
 static atomic_uint64_t TicksPerSec{0};
 
@@ -492,6 +502,36 @@ static bool setupTLD(ThreadLocalData &TLD) XRAY_NEVER_INSTRUMENT {
   return true;
 }
 
+// Tracks the calls of this thread, and returns whether the event at Entry
+// belongs to a sampled call. Sampling works on whole call trees, so that the
+// log never holds an entry without its exit.
+static bool isSampled(ThreadLocalData &TLD,
+                      XRayEntryType Entry) XRAY_NEVER_INSTRUMENT {
+  auto Rate = atomic_load_relaxed(&SamplingRate);
+  if (LIKELY(Rate <= 1))
+    return true;
+
+  switch (Entry) {
+  case XRayEntryType::ENTRY:
+  case XRayEntryType::LOG_ARGS_ENTRY:
+    if (TLD.CallDepth++ == 0) {
+      TLD.Sampled = TLD.SkippedCalls == 0;
+      TLD.SkippedCalls = TLD.Sampled ? Rate - 1 : TLD.SkippedCalls - 1;
+    }
+    return TLD.Sampled;
+  case XRayEntryType::EXIT:
+  case XRayEntryType::TAIL:
+    // Exits of calls that started before logging did are left unbalanced.
+    if (TLD.CallDepth > 0)
+      --TLD.CallDepth;
+    return TLD.Sampled;
+  case XRayEntryType::CUSTOM_EVENT:
+  case XRayEntryType::TYPED_EVENT:
+    break;
+  }
+  return TLD.Sampled || TLD.CallDepth == 0;
+}
+
 void fdrLoggingHandleArg0(int32_t FuncId,
                           XRayEntryType Entry) XRAY_NEVER_INSTRUMENT {
   auto TC = getTimestamp();
@@ -502,7 +542,8 @@ void fdrLoggingHandleArg0(int32_t FuncId,
     return;
 
   auto &TLD = getThreadLocalData();
-  if (!setupTLD(TLD))
+  bool Sampled = isSampled(TLD, Entry);
+  if (!setupTLD(TLD) || !Sampled)
     return;
 
   switch (Entry) {
@@ -532,7 +573,8 @@ void fdrLoggingHandleArg1(int32_t FuncId, XRayEntryType Entry,
     return;
 
   auto &TLD = getThreadLocalData();
-  if (!setupTLD(TLD))
+  bool Sampled = isSampled(TLD, Entry);
+  if (!setupTLD(TLD) || !Sampled)
     return;
 
   switch (Entry) {
@@ -574,7 +616,8 @@ void fdrLoggingHandleCustomEvent(void *Event,
   }
 
   auto &TLD = getThreadLocalData();
-  if (!setupTLD(TLD))
+  bool Sampled = isSampled(TLD, XRayEntryType::CUSTOM_EVENT);
+  if (!setupTLD(TLD) || !Sampled)
     return;
 
   int32_t ReducedEventSize = static_cast<int32_t>(EventSize);
@@ -604,7 +647,8 @@ void fdrLoggingHandleTypedEvent(
   }
 
   auto &TLD = getThreadLocalData();
-  if (!setupTLD(TLD))
+  bool Sampled = isSampled(TLD, XRayEntryType::TYPED_EVENT);
+  if (!setupTLD(TLD) || !Sampled)
     return;
 
   int32_t ReducedEventSize = static_cast<int32_t>(EventSize);
@@ -701,6 +745,9 @@ XRayLogInitStatus fdrLoggingInit(size_t, size_t, void *Options,
             });
       });
 
+  atomic_store(&SamplingRate,
+               fdrFlags()->sampling_rate > 1 ? fdrFlags()->sampling_rate : 1,
+               memory_order_release);
   atomic_store(&ThresholdTicks,
                atomic_load_relaxed(&TicksPerSec) *
                    fdrFlags()->func_duration_threshold_us / 1000000,
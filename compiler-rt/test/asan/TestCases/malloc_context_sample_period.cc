@@ -0,0 +1,29 @@
+// RUN: %clangxx_asan -O0 %s -o %t
+// RUN: not %run %t 2>&1 | FileCheck %s --check-prefix=FULL
+// RUN: %env_asan_opts=malloc_context_sample_period=1000000 not %run %t 2>&1 \
+// RUN:   | FileCheck %s --check-prefix=SAMPLED
+
+// The first malloc stack of a thread is collected in full, and with a large
+// period all the later ones are short.
+
+__attribute__((noinline)) char *Alloc() { return new char[20]; }
+
+int main() {
+  char *warmup = new char[1];
+  delete[] warmup;
+  char *x = Alloc();
+  delete[] x;
+  return x[0];
+
+  // FULL: previously allocated by thread T{{.*}} here:
+  // FULL-NEXT: #0 0x{{.*}} in {{operator new( )?\[\]|wrap__Znam}}
+  // FULL-NEXT: #1 0x{{.*}} in Alloc{{.*}}malloc_context_sample_period.cc
+  // FULL-NEXT: #2 0x{{.*}} in main {{.*}}malloc_context_sample_period.cc
+  // FULL: SUMMARY: AddressSanitizer: heap-use-after-free
+
+  // SAMPLED: previously allocated by thread T{{.*}} here:
+  // SAMPLED-NEXT: #0 0x{{.*}} in {{operator new( )?\[\]|wrap__Znam}}
+  // SAMPLED-NEXT: #1 0x{{.*}} in Alloc{{.*}}malloc_context_sample_period.cc
+  // SAMPLED-NOT: #2 0x{{.*}}
+  // SAMPLED: SUMMARY: AddressSanitizer: heap-use-after-free
+}
@@ -0,0 +1,45 @@
+// Check that the range checks of -asan-opt-loops and the accesses left out by
+// -asan-opt-dominating still detect overflows.
+// RUN: %clangxx_asan -O1 -mllvm -asan-opt-loops %s -o %t
+// RUN: not %run %t 2>&1 | FileCheck %s --check-prefix=LOOP
+// RUN: %clangxx_asan -O1 -mllvm -asan-opt-loops -mllvm -asan-opt-dominating \
+// RUN:   %s -o %t
+// RUN: not %run %t 2>&1 | FileCheck %s --check-prefix=LOOP
+// RUN: not %run %t 1 2>&1 | FileCheck %s --check-prefix=DOMINATED
+
+// REQUIRES: Clang
+
+#include <stdlib.h>
+
+// The last access is not dominated by the conditional one, so it is still
+// checked when the condition is false.
+__attribute__((noinline)) int Dominated(volatile int *a, int n, int c) {
+  int res = a[n];
+  if (c)
+    res += a[n + 1];
+  return res + a[n + 1];
+}
+
+int main(int argc, char **argv) {
+  int *a = (int *)malloc(10 * sizeof(int));
+  if (argc > 1) {
+    int res = Dominated(a, 9, argc - 2);
+    free(a);
+    return res;
+  }
+  int n = 10 + argc;
+  for (int i = 0; i < n; i++)
+    a[i] = i;
+  int res = a[argc];
+  free(a);
+  return res;
+  // LOOP: ERROR: AddressSanitizer: heap-buffer-overflow
+  // LOOP: WRITE of size {{[0-9]+}} at 0x{{.*}} thread T0
+  // LOOP: #{{[01]}} 0x{{.*}} in main {{.*}}opt-loops.cc
+  // LOOP: 0x{{.*}} is located 0 bytes to the right of 40-byte region
+
+  // DOMINATED: ERROR: AddressSanitizer: heap-buffer-overflow
+  // DOMINATED: READ of size 4 at 0x{{.*}} thread T0
+  // DOMINATED: #0 0x{{.*}} in Dominated{{.*}}opt-loops.cc
+  // DOMINATED: 0x{{.*}} is located 0 bytes to the right of 40-byte region
+}
@@ -0,0 +1,22 @@
+// The counters are mmap'd onto the profile with %c, so they are in the file
+// even though the program is killed before it could write the profile.
+// RUN: %clang_profgen -o %t -O0 %s
+// RUN: rm -f %t.profraw
+// RUN: env LLVM_PROFILE_FILE="%c%t.profraw" not --crash %run %t
+// RUN: llvm-profdata show --counts --all-functions %t.profraw | FileCheck %s
+
+#include <signal.h>
+
+int X;
+
+__attribute__((noinline)) void foo(void) { ++X; }
+
+int main() {
+  for (int I = 0; I < 7; ++I)
+    foo();
+  raise(SIGKILL);
+  return 0;
+}
+
+// CHECK-DAG: Function count: 7
+// CHECK-DAG: Block counts: [7]
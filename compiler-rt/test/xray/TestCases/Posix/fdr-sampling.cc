@@ -0,0 +1,45 @@
+// RUN: %clangxx_xray -g -std=c++11 %s -o %t
+// RUN: rm -f fdr-sampling-*
+// RUN: XRAY_OPTIONS="patch_premain=false verbosity=1 \
+// RUN:     xray_logfile_base=fdr-sampling-" %run %t 2>&1
+// RUN: %llvm_xray convert --output-format=yaml --symbolize --instr_map=%t \
+// RUN:   "`ls fdr-sampling-* | head -n1`" | FileCheck %s
+// RUN: rm fdr-sampling-*
+//
+// REQUIRES: x86_64-target-arch
+
+#include "xray/xray_log_interface.h"
+#include <cassert>
+
+[[clang::xray_always_instrument]] void __attribute__((noinline)) callee() {}
+
+[[clang::xray_always_instrument]] void __attribute__((noinline))
+caller(int I) {
+  callee();
+}
+
+int main(int argc, char *argv[]) {
+  auto status = __xray_log_init_mode(
+      "xray-fdr", "func_duration_threshold_us=0:sampling_rate=4");
+  assert(status == XRayLogInitStatus::XRAY_LOG_INITIALIZED);
+
+  __xray_patch();
+  for (int I = 0; I != 8; ++I)
+    caller(I);
+  __xray_unpatch();
+  assert(__xray_log_finalize() == XRAY_LOG_FINALIZED);
+  assert(__xray_log_flushLog() == XRAY_LOG_FLUSHED);
+  return 0;
+}
+
+// Only the first and the fifth call trees are recorded, with their callees.
+// CHECK: records:
+// CHECK-NEXT: - { type: 0, func-id: [[CALLER:[0-9]+]], function: {{.*caller.*}}, {{.*}} kind: function-enter,
+// CHECK-NEXT: - { type: 0, func-id: [[CALLEE:[0-9]+]], function: {{.*callee.*}}, {{.*}} kind: function-enter,
+// CHECK-NEXT: - { type: 0, func-id: [[CALLEE]], function: {{.*callee.*}}, {{.*}} kind: function-exit,
+// CHECK-NEXT: - { type: 0, func-id: [[CALLER]], function: {{.*caller.*}}, {{.*}} kind: function-exit,
+// CHECK-NEXT: - { type: 0, func-id: [[CALLER]], function: {{.*caller.*}}, {{.*}} kind: function-enter,
+// CHECK-NEXT: - { type: 0, func-id: [[CALLEE]], function: {{.*callee.*}}, {{.*}} kind: function-enter,
+// CHECK-NEXT: - { type: 0, func-id: [[CALLEE]], function: {{.*callee.*}}, {{.*}} kind: function-exit,
+// CHECK-NEXT: - { type: 0, func-id: [[CALLER]], function: {{.*caller.*}}, {{.*}} kind: function-exit,
+// CHECK-NOT: function-enter
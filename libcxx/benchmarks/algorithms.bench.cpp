@@ -1,6 +1,7 @@
 
 #include <algorithm>
 #include <cstdint>
+#include <execution>
 #include <map>
 #include <random>
 #include <string>
@@ -163,6 +164,24 @@ struct StableSort {
   };
 };
 
+template <class ValueType, class Order>
+struct ParallelSort {
+  size_t Quantity;
+
+  void run(benchmark::State& state) const {
+    runOpOnCopies<ValueType>(state, Quantity, Order(), false, [](auto& Copy) {
+      std::sort(std::execution::par, Copy.begin(), Copy.end());
+    });
+  }
+
+  bool skip() const { return Order() == ::Order::Heap; }
+
+  std::string name() const {
+    return "BM_ParallelSort" + ValueType::name() + Order::name() + "_" +
+           std::to_string(Quantity);
+  };
+};
+
 template <class ValueType, class Order>
 struct MakeHeap {
   size_t Quantity;
@@ -248,6 +267,59 @@ struct PopHeap {
   };
 };
 
+// find, count and mismatch scan the whole range: the value searched for is
+// the last one, and the range is compared with itself.
+template <class ValueType>
+struct Find {
+  size_t Quantity;
+
+  void run(benchmark::State& state) const {
+    runOpOnCopies<ValueType>(
+        state, Quantity, Order::Ascending, true, [](auto& Copy) {
+          benchmark::DoNotOptimize(
+              std::find(Copy.begin(), Copy.end(), Copy.back()));
+        });
+  }
+
+  std::string name() const {
+    return "BM_Find" + ValueType::name() + "_" + std::to_string(Quantity);
+  };
+};
+
+template <class ValueType>
+struct Count {
+  size_t Quantity;
+
+  void run(benchmark::State& state) const {
+    runOpOnCopies<ValueType>(
+        state, Quantity, Order::Ascending, true, [](auto& Copy) {
+          benchmark::DoNotOptimize(
+              std::count(Copy.begin(), Copy.end(), Copy.back()));
+        });
+  }
+
+  std::string name() const {
+    return "BM_Count" + ValueType::name() + "_" + std::to_string(Quantity);
+  };
+};
+
+template <class ValueType>
+struct Mismatch {
+  size_t Quantity;
+
+  void run(benchmark::State& state) const {
+    runOpOnCopies<ValueType>(
+        state, Quantity, Order::Ascending, true, [](auto& Copy) {
+          benchmark::DoNotOptimize(
+              std::mismatch(Copy.begin(), Copy.end(), Copy.begin()));
+        });
+  }
+
+  std::string name() const {
+    return "BM_Mismatch" + ValueType::name() + "_" + std::to_string(Quantity);
+  };
+};
+
 } // namespace
 
 int main(int argc, char** argv) {
@@ -260,11 +332,16 @@ int main(int argc, char** argv) {
   makeCartesianProductBenchmark<Sort, AllValueTypes, AllOrders>(Quantities);
   makeCartesianProductBenchmark<StableSort, AllValueTypes, AllOrders>(
       Quantities);
+  makeCartesianProductBenchmark<ParallelSort, AllValueTypes, AllOrders>(
+      Quantities);
   makeCartesianProductBenchmark<MakeHeap, AllValueTypes, AllOrders>(Quantities);
   makeCartesianProductBenchmark<SortHeap, AllValueTypes>(Quantities);
   makeCartesianProductBenchmark<MakeThenSortHeap, AllValueTypes, AllOrders>(
       Quantities);
   makeCartesianProductBenchmark<PushHeap, AllValueTypes, AllOrders>(Quantities);
   makeCartesianProductBenchmark<PopHeap, AllValueTypes>(Quantities);
+  makeCartesianProductBenchmark<Find, AllValueTypes>(Quantities);
+  makeCartesianProductBenchmark<Count, AllValueTypes>(Quantities);
+  makeCartesianProductBenchmark<Mismatch, AllValueTypes>(Quantities);
   benchmark::RunSpecifiedBenchmarks();
 }
@@ -0,0 +1,135 @@
+#include <charconv>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+
+// Random finite values, of all magnitudes.
+template <class T, class Bits>
+static std::vector<T> makeValues() {
+  std::mt19937_64 gen(42);
+  std::vector<T> values;
+  while (values.size() < 1024) {
+    Bits bits = static_cast<Bits>(gen());
+    T value;
+    std::memcpy(&value, &bits, sizeof(value));
+    if (value == value && value - value == 0)
+      values.push_back(value);
+  }
+  return values;
+}
+
+template <class T>
+static std::vector<std::vector<char>> makeStrings(const std::vector<T>& values) {
+  std::vector<std::vector<char>> strings;
+  for (T value : values) {
+    char buf[64];
+    std::to_chars_result r = std::to_chars(buf, buf + sizeof(buf), value);
+    strings.emplace_back(buf, r.ptr);
+    strings.back().push_back('\0');
+  }
+  return strings;
+}
+
+template <class T, class Bits>
+static void BM_ToChars(benchmark::State& state) {
+  std::vector<T> values = makeValues<T, Bits>();
+  char buf[64];
+  for (auto _ : state)
+    for (T value : values) {
+      benchmark::DoNotOptimize(std::to_chars(buf, buf + sizeof(buf), value));
+      benchmark::DoNotOptimize(buf);
+    }
+  state.SetItemsProcessed(state.iterations() * values.size());
+}
+BENCHMARK_TEMPLATE(BM_ToChars, float, std::uint32_t);
+BENCHMARK_TEMPLATE(BM_ToChars, double, std::uint64_t);
+
+// What it replaces: the shortest %.*g which reads back as the value.
+template <class T, class Bits>
+static void BM_SnprintfShortest(benchmark::State& state) {
+  std::vector<T> values = makeValues<T, Bits>();
+  char buf[64];
+  for (auto _ : state)
+    for (T value : values) {
+      for (int precision = 1; precision <= 17; ++precision) {
+        std::snprintf(buf, sizeof(buf), "%.*g", precision, static_cast<double>(value));
+        if (static_cast<T>(std::strtod(buf, nullptr)) == value)
+          break;
+      }
+      benchmark::DoNotOptimize(buf);
+    }
+  state.SetItemsProcessed(state.iterations() * values.size());
+}
+BENCHMARK_TEMPLATE(BM_SnprintfShortest, float, std::uint32_t);
+BENCHMARK_TEMPLATE(BM_SnprintfShortest, double, std::uint64_t);
+
+// The round-trip precision, which needs no search.
+template <class T, class Bits>
+static void BM_SnprintfMaxDigits(benchmark::State& state) {
+  std::vector<T> values = makeValues<T, Bits>();
+  const int precision = sizeof(T) == sizeof(float) ? 9 : 17;
+  char buf[64];
+  for (auto _ : state)
+    for (T value : values) {
+      std::snprintf(buf, sizeof(buf), "%.*g", precision, static_cast<double>(value));
+      benchmark::DoNotOptimize(buf);
+    }
+  state.SetItemsProcessed(state.iterations() * values.size());
+}
+BENCHMARK_TEMPLATE(BM_SnprintfMaxDigits, float, std::uint32_t);
+BENCHMARK_TEMPLATE(BM_SnprintfMaxDigits, double, std::uint64_t);
+
+template <class T, class Bits>
+static void BM_FromChars(benchmark::State& state) {
+  std::vector<std::vector<char>> strings = makeStrings(makeValues<T, Bits>());
+  for (auto _ : state)
+    for (const std::vector<char>& s : strings) {
+      T value;
+      benchmark::DoNotOptimize(std::from_chars(s.data(), s.data() + s.size() - 1, value));
+      benchmark::DoNotOptimize(value);
+    }
+  state.SetItemsProcessed(state.iterations() * strings.size());
+}
+BENCHMARK_TEMPLATE(BM_FromChars, float, std::uint32_t);
+BENCHMARK_TEMPLATE(BM_FromChars, double, std::uint64_t);
+
+template <class T, class Bits>
+static void BM_Strtod(benchmark::State& state) {
+  std::vector<std::vector<char>> strings = makeStrings(makeValues<T, Bits>());
+  for (auto _ : state)
+    for (const std::vector<char>& s : strings) {
+      if (sizeof(T) == sizeof(float))
+        benchmark::DoNotOptimize(std::strtof(s.data(), nullptr));
+      else
+        benchmark::DoNotOptimize(std::strtod(s.data(), nullptr));
+    }
+  state.SetItemsProcessed(state.iterations() * strings.size());
+}
+BENCHMARK_TEMPLATE(BM_Strtod, float, std::uint32_t);
+BENCHMARK_TEMPLATE(BM_Strtod, double, std::uint64_t);
+
+// Short decimals, which the exact fast path of from_chars covers.
+static void BM_FromCharsShort(benchmark::State& state) {
+  std::vector<std::vector<char>> strings;
+  std::mt19937 gen(42);
+  for (int i = 0; i < 1024; ++i) {
+    char buf[32];
+    int n = std::snprintf(buf, sizeof(buf), "%u.%02u", gen() % 100000, gen() % 100);
+    strings.emplace_back(buf, buf + n + 1);
+  }
+  for (auto _ : state)
+    for (const std::vector<char>& s : strings) {
+      double value;
+      benchmark::DoNotOptimize(std::from_chars(s.data(), s.data() + s.size() - 1, value));
+      benchmark::DoNotOptimize(value);
+    }
+  state.SetItemsProcessed(state.iterations() * strings.size());
+}
+BENCHMARK(BM_FromCharsShort);
+
+BENCHMARK_MAIN();
@@ -1,3 +1,6 @@
+#include <fstream>
+#include <string>
+
 #include "benchmark/benchmark.h"
 #include "GenerateInput.hpp"
 #include "test_iterators.h"
@@ -160,4 +163,56 @@ BENCHMARK_CAPTURE(BM_LexicallyNormal, small_path,
 BENCHMARK_CAPTURE(BM_LexicallyNormal, large_path,
   getRandomPaths, /*PathLen*/32)->RangeMultiplier(2)->Range(2, 256)->Complexity();
 
+// Creates a directory tree of the given depth in which every directory holds
+// Fanout subdirectories and Files regular files, and removes it at the end.
+struct DirectoryTree {
+  fs::path Root;
+
+  DirectoryTree(int Depth, int Fanout, int Files)
+      : Root(fs::temp_directory_path() /
+             ("libcxx-bench-" + getRandomString(16))) {
+    fs::create_directory(Root);
+    populate(Root, Depth, Fanout, Files);
+  }
+  ~DirectoryTree() { fs::remove_all(Root); }
+
+  static void populate(const fs::path& Dir, int Depth, int Fanout, int Files) {
+    for (int I = 0; I < Files; ++I)
+      std::ofstream(Dir / ("file_" + std::to_string(I) + ".cpp"));
+    if (Depth == 0)
+      return;
+    for (int I = 0; I < Fanout; ++I) {
+      fs::path Sub = Dir / ("dir_" + std::to_string(I));
+      fs::create_directory(Sub);
+      populate(Sub, Depth - 1, Fanout, Files);
+    }
+  }
+};
+
+void BM_DirectoryIterate(benchmark::State &st) {
+  DirectoryTree Tree(/*Depth*/0, /*Fanout*/0, st.range(0));
+  while (st.KeepRunning()) {
+    size_t Count = 0;
+    for (const fs::directory_entry& Entry : fs::directory_iterator(Tree.Root))
+      Count += Entry.is_regular_file();
+    benchmark::DoNotOptimize(Count);
+  }
+  st.SetItemsProcessed(st.iterations() * st.range(0));
+}
+BENCHMARK(BM_DirectoryIterate)->Range(64, 4096);
+
+void BM_RecursiveDirectoryIterate(benchmark::State &st) {
+  DirectoryTree Tree(st.range(0), /*Fanout*/4, /*Files*/16);
+  size_t Entries = 0;
+  while (st.KeepRunning()) {
+    Entries = 0;
+    for (const fs::directory_entry& Entry :
+         fs::recursive_directory_iterator(Tree.Root))
+      Entries += Entry.is_directory() || Entry.is_regular_file();
+    benchmark::DoNotOptimize(Entries);
+  }
+  st.SetItemsProcessed(st.iterations() * Entries);
+}
+BENCHMARK(BM_RecursiveDirectoryIterate)->DenseRange(1, 5, 2);
+
 BENCHMARK_MAIN();
@@ -24,17 +24,22 @@ enum class FunctionType {
   MemberPointer,
   SmallTrivialFunctor,
   SmallNonTrivialFunctor,
+  MediumTrivialFunctor,
+  MediumNonTrivialFunctor,
   LargeTrivialFunctor,
   LargeNonTrivialFunctor
 };
 
-struct AllFunctionTypes : EnumValuesAsTuple<AllFunctionTypes, FunctionType, 8> {
+struct AllFunctionTypes
+    : EnumValuesAsTuple<AllFunctionTypes, FunctionType, 10> {
   static constexpr const char* Names[] = {"Null",
                                           "FuncPtr",
                                           "MemFuncPtr",
                                           "MemPtr",
                                           "SmallTrivialFunctor",
                                           "SmallNonTrivialFunctor",
+                                          "MediumTrivialFunctor",
+                                          "MediumNonTrivialFunctor",
                                           "LargeTrivialFunctor",
                                           "LargeNonTrivialFunctor"};
 };
@@ -61,6 +66,24 @@ struct SmallNonTrivialFunctor {
   ~SmallNonTrivialFunctor() {}
   int operator()(const S*) const { return 0; }
 };
+// Four pointers large, which is only stored inline with
+// _LIBCPP_ABI_FUNCTION_LARGE_SMALL_BUFFER.
+struct MediumTrivialFunctor {
+  MediumTrivialFunctor() {
+      // Do not spend time initializing the padding.
+  }
+  void* padding[4];
+  int operator()(const S*) const { return 0; }
+};
+struct MediumNonTrivialFunctor {
+  void* padding[4];
+  MediumNonTrivialFunctor() {
+      // Do not spend time initializing the padding.
+  }
+  MediumNonTrivialFunctor(const MediumNonTrivialFunctor&) {}
+  ~MediumNonTrivialFunctor() {}
+  int operator()(const S*) const { return 0; }
+};
 struct LargeTrivialFunctor {
   LargeTrivialFunctor() {
       // Do not spend time initializing the padding.
@@ -95,6 +118,10 @@ inline Function MakeFunction(FunctionType type, bool opaque = false) {
       return maybeOpaque(SmallTrivialFunctor{}, opaque);
     case FunctionType::SmallNonTrivialFunctor:
       return maybeOpaque(SmallNonTrivialFunctor{}, opaque);
+    case FunctionType::MediumTrivialFunctor:
+      return maybeOpaque(MediumTrivialFunctor{}, opaque);
+    case FunctionType::MediumNonTrivialFunctor:
+      return maybeOpaque(MediumNonTrivialFunctor{}, opaque);
     case FunctionType::LargeTrivialFunctor:
       return maybeOpaque(LargeTrivialFunctor{}, opaque);
     case FunctionType::LargeNonTrivialFunctor:
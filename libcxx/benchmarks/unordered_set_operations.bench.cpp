@@ -1,4 +1,5 @@
 #include <unordered_set>
+#include <__flat_hash_table>
 #include <vector>
 #include <functional>
 #include <cstdint>
@@ -304,4 +305,58 @@ BENCHMARK_CAPTURE(BM_EmplaceDuplicate,
     std::unordered_set<std::string>{},
     getRandomCStringInputs)->Arg(TestNumInputs);
 
+//----------------------------------------------------------------------------//
+//                    __flat_unordered_set (open addressing)
+// ---------------------------------------------------------------------------//
+
+BENCHMARK_CAPTURE(BM_InsertValue,
+    flat_unordered_set_uint32,
+    std::__flat_unordered_set<uint32_t>{},
+    getRandomIntegerInputs<uint32_t>)->Arg(TestNumInputs);
+
+BENCHMARK_CAPTURE(BM_InsertValueRehash,
+    flat_unordered_set_top_bits_uint32,
+    std::__flat_unordered_set<uint32_t, UInt32Hash>{},
+    getSortedTopBitsIntegerInputs<uint32_t>)->Arg(TestNumInputs);
+
+BENCHMARK_CAPTURE(BM_InsertValue,
+    flat_unordered_set_string,
+    std::__flat_unordered_set<std::string>{},
+    getRandomStringInputs)->Arg(TestNumInputs);
+
+BENCHMARK_CAPTURE(BM_Find,
+    flat_unordered_set_random_uint64,
+    std::__flat_unordered_set<uint64_t>{},
+    getRandomIntegerInputs<uint64_t>)->Arg(TestNumInputs);
+
+BENCHMARK_CAPTURE(BM_FindRehash,
+    flat_unordered_set_random_uint64,
+    std::__flat_unordered_set<uint64_t, UInt64Hash>{},
+    getRandomIntegerInputs<uint64_t>)->Arg(TestNumInputs);
+
+BENCHMARK_CAPTURE(BM_Find,
+    flat_unordered_set_sorted_uint64,
+    std::__flat_unordered_set<uint64_t>{},
+    getSortedIntegerInputs<uint64_t>)->Arg(TestNumInputs);
+
+BENCHMARK_CAPTURE(BM_Find,
+    flat_unordered_set_top_bits_uint64,
+    std::__flat_unordered_set<uint64_t>{},
+    getSortedTopBitsIntegerInputs<uint64_t>)->Arg(TestNumInputs);
+
+BENCHMARK_CAPTURE(BM_Find,
+    flat_unordered_set_string,
+    std::__flat_unordered_set<std::string>{},
+    getRandomStringInputs)->Arg(TestNumInputs);
+
+BENCHMARK_CAPTURE(BM_InsertDuplicate,
+    flat_unordered_set_int,
+    std::__flat_unordered_set<int>{},
+    getRandomIntegerInputs<int>)->Arg(TestNumInputs);
+
+BENCHMARK_CAPTURE(BM_EmplaceDuplicate,
+    flat_unordered_set_string,
+    std::__flat_unordered_set<std::string>{},
+    getRandomStringInputs)->Arg(TestNumInputs);
+
 BENCHMARK_MAIN();
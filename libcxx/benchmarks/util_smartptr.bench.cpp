@@ -7,6 +7,7 @@
 //===----------------------------------------------------------------------===//
 
 #include <memory>
+#include <thread>
 
 #include "benchmark/benchmark.h"
 
@@ -38,4 +39,18 @@ static void BM_WeakPtrIncDecRef(benchmark::State& st) {
 }
 BENCHMARK(BM_WeakPtrIncDecRef);
 
+// Once a thread has been started, reference counts are updated with atomic
+// operations even if that thread does not touch them. This has to be the last
+// benchmark, as the process stays multi-threaded for the ones after it.
+static void BM_SharedPtrIncDecRefAfterThreadStart(benchmark::State& st) {
+  std::thread([] {}).join();
+  auto sp = std::make_shared<int>(42);
+  benchmark::DoNotOptimize(sp.get());
+  while (st.KeepRunning()) {
+    std::shared_ptr<int> sp2(sp);
+    benchmark::ClobberMemory();
+  }
+}
+BENCHMARK(BM_SharedPtrIncDecRefAfterThreadStart);
+
 BENCHMARK_MAIN();
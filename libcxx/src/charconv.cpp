@@ -7,8 +7,15 @@
 //===----------------------------------------------------------------------===//
 
 #include "charconv"
+#include "limits"
+#include "locale"
+#include "memory"
+#include <errno.h>
+#include <float.h>
 #include <string.h>
 
+#include "include/ryu_tables.h"
+
 _LIBCPP_BEGIN_NAMESPACE_STD
 
 namespace __itoa
@@ -157,4 +164,1060 @@ __u64toa(uint64_t value, char* buffer)
 
 }  // namespace __itoa
 
+namespace
+{
+
+// Ryu, from Ulf Adams, "Ryu: fast float-to-string conversion" (PLDI 2018):
+// the shortest decimal which reads back as the same float or double, found
+// with a few multiplications by the precomputed powers of five of
+// ryu_tables.h rather than with big numbers.
+
+inline int32_t
+pow5bits(int32_t e)
+{
+    // ceil(log2(5^e)), or 1 for e == 0.
+    return static_cast<int32_t>(((static_cast<uint32_t>(e) * 1217359) >> 19) + 1);
+}
+
+inline uint32_t
+log10_pow2(int32_t e)
+{
+    // floor(log10(2^e)) for 0 <= e <= 1650.
+    return (static_cast<uint32_t>(e) * 78913) >> 18;
+}
+
+inline uint32_t
+log10_pow5(int32_t e)
+{
+    // floor(log10(5^e)) for 0 <= e <= 2620.
+    return (static_cast<uint32_t>(e) * 732923) >> 20;
+}
+
+template <class T>
+inline uint32_t
+pow5_factor(T value)
+{
+    uint32_t count = 0;
+    for (; value % 5 == 0; value /= 5)
+        ++count;
+    return count;
+}
+
+template <class T>
+inline bool
+multiple_of_pow5(T value, uint32_t p)
+{
+    return pow5_factor(value) >= p;
+}
+
+template <class T>
+inline bool
+multiple_of_pow2(T value, uint32_t p)
+{
+    return (value & ((T(1) << p) - 1)) == 0;
+}
+
+// (m * mul) >> j, where mul is a 128 bit number and 64 < j < 128.
+inline uint64_t
+mul_shift64(uint64_t m, const uint64_t* mul, int32_t j)
+{
+#ifndef _LIBCPP_HAS_NO_INT128
+    __uint128_t b0 = static_cast<__uint128_t>(m) * mul[0];
+    __uint128_t b2 = static_cast<__uint128_t>(m) * mul[1];
+    return static_cast<uint64_t>(((b0 >> 64) + b2) >> (j - 64));
+#else
+    // The halves of the two 64 x 64 bit products, added up.
+    uint64_t m_lo = static_cast<uint32_t>(m), m_hi = m >> 32;
+    uint64_t hi[2], lo[2];
+    for (int k = 0; k < 2; ++k)
+    {
+        uint64_t b_lo = static_cast<uint32_t>(mul[k]), b_hi = mul[k] >> 32;
+        uint64_t b00 = m_lo * b_lo, b01 = m_lo * b_hi;
+        uint64_t b10 = m_hi * b_lo, b11 = m_hi * b_hi;
+        uint64_t mid1 = b10 + (b00 >> 32);
+        uint64_t mid2 = b01 + static_cast<uint32_t>(mid1);
+        hi[k] = b11 + (mid1 >> 32) + (mid2 >> 32);
+        lo[k] = (mid2 << 32) | static_cast<uint32_t>(b00);
+    }
+    uint64_t sum = hi[0] + lo[1];
+    uint64_t high = hi[1] + (sum < hi[0]);
+    int32_t dist = j - 64;
+    return (high << (64 - dist)) | (sum >> dist);
+#endif
+}
+
+// (m * factor) >> shift, where factor is a 64 bit number and 32 < shift < 96.
+inline uint32_t
+mul_shift32(uint32_t m, uint64_t factor, int32_t shift)
+{
+    uint64_t bits0 = static_cast<uint64_t>(m) * static_cast<uint32_t>(factor);
+    uint64_t bits1 = static_cast<uint64_t>(m) * (factor >> 32);
+    uint64_t sum = (bits0 >> 32) + bits1;
+    return static_cast<uint32_t>(sum >> (shift - 32));
+}
+
+// A decimal mantissa and exponent.
+template <class T>
+struct decimal
+{
+    T mantissa;
+    int32_t exponent;
+};
+
+const int double_mantissa_bits = 52;
+const int double_exponent_bits = 11;
+const int double_bias = 1023;
+const int double_pow5_inv_bitcount = 125;
+const int double_pow5_bitcount = 125;
+
+const int float_mantissa_bits = 23;
+const int float_exponent_bits = 8;
+const int float_bias = 127;
+const int float_pow5_inv_bitcount = 59;
+const int float_pow5_bitcount = 61;
+
+decimal<uint64_t>
+d2d(uint64_t ieee_mantissa, uint32_t ieee_exponent)
+{
+    int32_t e2;
+    uint64_t m2;
+    if (ieee_exponent == 0)
+    {
+        e2 = 1 - double_bias - double_mantissa_bits - 2;
+        m2 = ieee_mantissa;
+    }
+    else
+    {
+        e2 = static_cast<int32_t>(ieee_exponent) - double_bias - double_mantissa_bits - 2;
+        m2 = (uint64_t(1) << double_mantissa_bits) | ieee_mantissa;
+    }
+    const bool accept_bounds = (m2 & 1) == 0;
+
+    // The value and the halfway points to its neighbours, times 4 and
+    // 2^-e2. The lower neighbour is closer below a power of two.
+    const uint64_t mv = 4 * m2;
+    const uint32_t mm_shift = ieee_mantissa != 0 || ieee_exponent <= 1;
+
+    // The same, times 10^-e10, which makes them integers of 17 digits or so.
+    uint64_t vr, vp, vm;
+    int32_t e10;
+    bool vm_is_trailing_zeros = false;
+    bool vr_is_trailing_zeros = false;
+    if (e2 >= 0)
+    {
+        const uint32_t q = log10_pow2(e2) - (e2 > 3);
+        e10 = static_cast<int32_t>(q);
+        const int32_t k = double_pow5_inv_bitcount + pow5bits(static_cast<int32_t>(q)) - 1;
+        const int32_t i = -e2 + static_cast<int32_t>(q) + k;
+        vr = mul_shift64(mv, __double_pow5_inv_split[q], i);
+        vp = mul_shift64(mv + 2, __double_pow5_inv_split[q], i);
+        vm = mul_shift64(mv - 1 - mm_shift, __double_pow5_inv_split[q], i);
+        if (q <= 21)
+        {
+            // Only one of mp, mv and mm can be a multiple of 5, if any.
+            if (mv % 5 == 0)
+                vr_is_trailing_zeros = multiple_of_pow5(mv, q);
+            else if (accept_bounds)
+                vm_is_trailing_zeros = multiple_of_pow5(mv - 1 - mm_shift, q);
+            else
+                vp -= multiple_of_pow5(mv + 2, q);
+        }
+    }
+    else
+    {
+        const uint32_t q = log10_pow5(-e2) - (-e2 > 1);
+        e10 = static_cast<int32_t>(q) + e2;
+        const int32_t i = -e2 - static_cast<int32_t>(q);
+        const int32_t k = pow5bits(i) - double_pow5_bitcount;
+        const int32_t j = static_cast<int32_t>(q) - k;
+        vr = mul_shift64(mv, __double_pow5_split[i], j);
+        vp = mul_shift64(mv + 2, __double_pow5_split[i], j);
+        vm = mul_shift64(mv - 1 - mm_shift, __double_pow5_split[i], j);
+        if (q <= 1)
+        {
+            // mv has at least q trailing 0 bits, and mp = mv + 2 only one.
+            vr_is_trailing_zeros = true;
+            if (accept_bounds)
+                vm_is_trailing_zeros = mm_shift == 1;
+            else
+                --vp;
+        }
+        else if (q < 63)
+        {
+            vr_is_trailing_zeros = multiple_of_pow2(mv, q);
+        }
+    }
+
+    // Drops the digits vp and vm have in common with vr, rounding vr.
+    int32_t removed = 0;
+    uint8_t last_removed_digit = 0;
+    uint64_t output;
+    if (vm_is_trailing_zeros || vr_is_trailing_zeros)
+    {
+        // The exact halfway or bound cases, which are rare.
+        for (; vp / 10 > vm / 10; ++removed)
+        {
+            vm_is_trailing_zeros &= vm % 10 == 0;
+            vr_is_trailing_zeros &= last_removed_digit == 0;
+            last_removed_digit = static_cast<uint8_t>(vr % 10);
+            vr /= 10;
+            vp /= 10;
+            vm /= 10;
+        }
+        if (vm_is_trailing_zeros)
+        {
+            for (; vm % 10 == 0; ++removed)
+            {
+                vr_is_trailing_zeros &= last_removed_digit == 0;
+                last_removed_digit = static_cast<uint8_t>(vr % 10);
+                vr /= 10;
+                vp /= 10;
+                vm /= 10;
+            }
+        }
+        if (vr_is_trailing_zeros && last_removed_digit == 5 && vr % 2 == 0)
+            last_removed_digit = 4; // Round an exact ...50...0 to even.
+        output = vr + ((vr == vm && (!accept_bounds || !vm_is_trailing_zeros)) ||
+                       last_removed_digit >= 5);
+    }
+    else
+    {
+        bool round_up = false;
+        if (vp / 100 > vm / 100)
+        {
+            round_up = vr % 100 >= 50;
+            vr /= 100;
+            vp /= 100;
+            vm /= 100;
+            removed += 2;
+        }
+        for (; vp / 10 > vm / 10; ++removed)
+        {
+            round_up = vr % 10 >= 5;
+            vr /= 10;
+            vp /= 10;
+            vm /= 10;
+        }
+        output = vr + (vr == vm || round_up);
+    }
+    decimal<uint64_t> d = {output, e10 + removed};
+    return d;
+}
+
+decimal<uint32_t>
+f2d(uint32_t ieee_mantissa, uint32_t ieee_exponent)
+{
+    int32_t e2;
+    uint32_t m2;
+    if (ieee_exponent == 0)
+    {
+        e2 = 1 - float_bias - float_mantissa_bits - 2;
+        m2 = ieee_mantissa;
+    }
+    else
+    {
+        e2 = static_cast<int32_t>(ieee_exponent) - float_bias - float_mantissa_bits - 2;
+        m2 = (uint32_t(1) << float_mantissa_bits) | ieee_mantissa;
+    }
+    const bool accept_bounds = (m2 & 1) == 0;
+
+    const uint32_t mv = 4 * m2;
+    const uint32_t mp = 4 * m2 + 2;
+    const uint32_t mm_shift = ieee_mantissa != 0 || ieee_exponent <= 1;
+    const uint32_t mm = 4 * m2 - 1 - mm_shift;
+
+    uint32_t vr, vp, vm;
+    int32_t e10;
+    bool vm_is_trailing_zeros = false;
+    bool vr_is_trailing_zeros = false;
+    uint8_t last_removed_digit = 0;
+    if (e2 >= 0)
+    {
+        const uint32_t q = log10_pow2(e2);
+        e10 = static_cast<int32_t>(q);
+        const int32_t k = float_pow5_inv_bitcount + pow5bits(static_cast<int32_t>(q)) - 1;
+        const int32_t i = -e2 + static_cast<int32_t>(q) + k;
+        vr = mul_shift32(mv, __float_pow5_inv_split[q], i);
+        vp = mul_shift32(mp, __float_pow5_inv_split[q], i);
+        vm = mul_shift32(mm, __float_pow5_inv_split[q], i);
+        if (q != 0 && (vp - 1) / 10 <= vm / 10)
+        {
+            // The loop below removes no digit, but the rounding needs the
+            // one below vr.
+            const int32_t l = float_pow5_inv_bitcount + pow5bits(static_cast<int32_t>(q) - 1) - 1;
+            last_removed_digit = static_cast<uint8_t>(
+                mul_shift32(mv, __float_pow5_inv_split[q - 1],
+                            -e2 + static_cast<int32_t>(q) - 1 + l) % 10);
+        }
+        if (q <= 9)
+        {
+            if (mv % 5 == 0)
+                vr_is_trailing_zeros = multiple_of_pow5(mv, q);
+            else if (accept_bounds)
+                vm_is_trailing_zeros = multiple_of_pow5(mm, q);
+            else
+                vp -= multiple_of_pow5(mp, q);
+        }
+    }
+    else
+    {
+        const uint32_t q = log10_pow5(-e2);
+        e10 = static_cast<int32_t>(q) + e2;
+        const int32_t i = -e2 - static_cast<int32_t>(q);
+        const int32_t k = pow5bits(i) - float_pow5_bitcount;
+        int32_t j = static_cast<int32_t>(q) - k;
+        vr = mul_shift32(mv, __float_pow5_split[i], j);
+        vp = mul_shift32(mp, __float_pow5_split[i], j);
+        vm = mul_shift32(mm, __float_pow5_split[i], j);
+        if (q != 0 && (vp - 1) / 10 <= vm / 10)
+        {
+            j = static_cast<int32_t>(q) - 1 - (pow5bits(i + 1) - float_pow5_bitcount);
+            last_removed_digit = static_cast<uint8_t>(
+                mul_shift32(mv, __float_pow5_split[i + 1], j) % 10);
+        }
+        if (q <= 1)
+        {
+            vr_is_trailing_zeros = true;
+            if (accept_bounds)
+                vm_is_trailing_zeros = mm_shift == 1;
+            else
+                --vp;
+        }
+        else if (q < 31)
+        {
+            vr_is_trailing_zeros = multiple_of_pow2(mv, q - 1);
+        }
+    }
+
+    int32_t removed = 0;
+    uint32_t output;
+    if (vm_is_trailing_zeros || vr_is_trailing_zeros)
+    {
+        for (; vp / 10 > vm / 10; ++removed)
+        {
+            vm_is_trailing_zeros &= vm % 10 == 0;
+            vr_is_trailing_zeros &= last_removed_digit == 0;
+            last_removed_digit = static_cast<uint8_t>(vr % 10);
+            vr /= 10;
+            vp /= 10;
+            vm /= 10;
+        }
+        if (vm_is_trailing_zeros)
+        {
+            for (; vm % 10 == 0; ++removed)
+            {
+                vr_is_trailing_zeros &= last_removed_digit == 0;
+                last_removed_digit = static_cast<uint8_t>(vr % 10);
+                vr /= 10;
+                vp /= 10;
+                vm /= 10;
+            }
+        }
+        if (vr_is_trailing_zeros && last_removed_digit == 5 && vr % 2 == 0)
+            last_removed_digit = 4;
+        output = vr + ((vr == vm && (!accept_bounds || !vm_is_trailing_zeros)) ||
+                       last_removed_digit >= 5);
+    }
+    else
+    {
+        for (; vp / 10 > vm / 10; ++removed)
+        {
+            last_removed_digit = static_cast<uint8_t>(vr % 10);
+            vr /= 10;
+            vp /= 10;
+            vm /= 10;
+        }
+        output = vr + (vr == vm || last_removed_digit >= 5);
+    }
+    decimal<uint32_t> d = {output, e10 + removed};
+    return d;
+}
+
+// How a value is converted to characters, given to the formatting below.
+struct shortest_digits
+{
+    char digits[40];  // The significant digits, without leading zeros.
+    int count;        // How many.
+    int exponent;     // The decimal exponent of the first one.
+};
+
+template <class UInt>
+void
+set_digits(shortest_digits& s, decimal<UInt> d)
+{
+    char* end = __itoa::__u64toa(d.mantissa, s.digits);
+    s.count = static_cast<int>(end - s.digits);
+    s.exponent = d.exponent + s.count - 1;
+}
+
+inline size_t
+exponent_length(int x)
+{
+    int a = x < 0 ? -x : x;
+    return 2 + (a >= 1000 ? 4 : a >= 100 ? 3 : 2);
+}
+
+inline size_t
+scientific_length(const shortest_digits& s)
+{
+    return static_cast<size_t>(s.count) + (s.count > 1) + exponent_length(s.exponent);
+}
+
+inline size_t
+fixed_length(const shortest_digits& s)
+{
+    if (s.exponent < 0)
+        return static_cast<size_t>(s.count) + 1 - s.exponent;
+    if (s.count <= s.exponent + 1)
+        return static_cast<size_t>(s.exponent) + 1;
+    return static_cast<size_t>(s.count) + 1;
+}
+
+to_chars_result
+write_scientific(char* first, char* last, const shortest_digits& s)
+{
+    if (static_cast<size_t>(last - first) < scientific_length(s))
+        return {last, errc::value_too_large};
+    *first++ = s.digits[0];
+    if (s.count > 1)
+    {
+        *first++ = '.';
+        memcpy(first, s.digits + 1, static_cast<size_t>(s.count) - 1);
+        first += s.count - 1;
+    }
+    *first++ = 'e';
+    int x = s.exponent;
+    *first++ = x < 0 ? '-' : '+';
+    if (x < 0)
+        x = -x;
+    if (x < 10)
+        *first++ = '0';
+    first = __itoa::__u32toa(static_cast<uint32_t>(x), first);
+    return {first, errc()};
+}
+
+to_chars_result
+write_fixed(char* first, char* last, const shortest_digits& s)
+{
+    if (static_cast<size_t>(last - first) < fixed_length(s))
+        return {last, errc::value_too_large};
+    if (s.exponent < 0)
+    {
+        *first++ = '0';
+        *first++ = '.';
+        memset(first, '0', static_cast<size_t>(-s.exponent - 1));
+        first += -s.exponent - 1;
+        memcpy(first, s.digits, static_cast<size_t>(s.count));
+        return {first + s.count, errc()};
+    }
+    if (s.count <= s.exponent + 1)
+    {
+        memcpy(first, s.digits, static_cast<size_t>(s.count));
+        first += s.count;
+        memset(first, '0', static_cast<size_t>(s.exponent + 1 - s.count));
+        return {first + (s.exponent + 1 - s.count), errc()};
+    }
+    memcpy(first, s.digits, static_cast<size_t>(s.exponent) + 1);
+    first += s.exponent + 1;
+    *first++ = '.';
+    memcpy(first, s.digits + s.exponent + 1, static_cast<size_t>(s.count - s.exponent - 1));
+    return {first + (s.count - s.exponent - 1), errc()};
+}
+
+// printf into [first, last), which it may fill without room for the
+// terminating null.
+template <class T>
+to_chars_result
+printf_to_chars(char* first, char* last, const char* fmt, int precision, T value)
+{
+    size_t n = static_cast<size_t>(last - first);
+    int len = __libcpp_snprintf_l(first, n, _LIBCPP_GET_C_LOCALE, fmt, precision, value);
+    if (len < 0)
+        return {last, errc::value_too_large};
+    size_t size = static_cast<size_t>(len);
+    if (size < n)
+        return {first + size, errc()};
+    if (size > n)
+        return {last, errc::value_too_large};
+    unique_ptr<char[]> buf(new char[size + 1]);
+    __libcpp_snprintf_l(buf.get(), size + 1, _LIBCPP_GET_C_LOCALE, fmt, precision, value);
+    memcpy(first, buf.get(), size);
+    return {last, errc()};
+}
+
+// %a without the 0x prefix.
+template <class T>
+to_chars_result
+printf_hex_to_chars(char* first, char* last, const char* fmt, int precision, T value)
+{
+    char buf[64];
+    int len = __libcpp_snprintf_l(buf, sizeof(buf), _LIBCPP_GET_C_LOCALE, fmt, precision, value);
+    size_t size = static_cast<size_t>(len);
+    unique_ptr<char[]> big;
+    char* p = buf;
+    if (size >= sizeof(buf))
+    {
+        big.reset(new char[size + 1]);
+        p = big.get();
+        __libcpp_snprintf_l(p, size + 1, _LIBCPP_GET_C_LOCALE, fmt, precision, value);
+    }
+    const char* src = p;
+    if (*src == '-')
+    {
+        if (first == last)
+            return {last, errc::value_too_large};
+        *first++ = *src++;
+        --size;
+    }
+    src += 2;
+    size -= 2;
+    if (static_cast<size_t>(last - first) < size)
+        return {last, errc::value_too_large};
+    memcpy(first, src, size);
+    return {first + size, errc()};
+}
+
+template <class Float>
+struct float_traits;
+
+template <>
+struct float_traits<float>
+{
+    typedef uint32_t bits_type;
+    static const int mantissa_bits = float_mantissa_bits;
+    static const int exponent_bits = float_exponent_bits;
+    static const int bias = float_bias;
+
+    static void shortest(shortest_digits& s, bits_type mantissa, uint32_t exponent)
+    {
+        set_digits(s, f2d(mantissa, exponent));
+    }
+};
+
+template <>
+struct float_traits<double>
+{
+    typedef uint64_t bits_type;
+    static const int mantissa_bits = double_mantissa_bits;
+    static const int exponent_bits = double_exponent_bits;
+    static const int bias = double_bias;
+
+    static void shortest(shortest_digits& s, bits_type mantissa, uint32_t exponent)
+    {
+        set_digits(s, d2d(mantissa, exponent));
+    }
+};
+
+to_chars_result
+write_special(char* first, char* last, bool negative, bool is_nan)
+{
+    const char* name = is_nan ? "nan" : "inf";
+    size_t size = 3 + negative;
+    if (static_cast<size_t>(last - first) < size)
+        return {last, errc::value_too_large};
+    if (negative)
+        *first++ = '-';
+    memcpy(first, name, 3);
+    return {first + 3, errc()};
+}
+
+// The shortest %a, without the 0x prefix: the mantissa with its trailing
+// zero digits dropped.
+template <class Float>
+to_chars_result
+write_hex(char* first, char* last, typename float_traits<Float>::bits_type mantissa,
+          uint32_t exponent)
+{
+    typedef float_traits<Float> traits;
+    typedef typename float_traits<Float>::bits_type bits_type;
+    const int digits = (traits::mantissa_bits + 3) / 4;
+    bits_type m = mantissa << (digits * 4 - traits::mantissa_bits);
+    int e;
+    char lead;
+    if (exponent == 0)
+    {
+        lead = '0';
+        e = mantissa == 0 ? 0 : 1 - traits::bias;
+    }
+    else
+    {
+        lead = '1';
+        e = static_cast<int>(exponent) - traits::bias;
+    }
+    int n = digits;
+    while (n > 0 && (m & 0xF) == 0)
+    {
+        m >>= 4;
+        --n;
+    }
+    char buf[32];
+    char* p = buf;
+    *p++ = lead;
+    if (n > 0)
+    {
+        *p++ = '.';
+        for (int i = n - 1; i >= 0; --i)
+            p[i] = "0123456789abcdef"[(m >> (4 * (n - 1 - i))) & 0xF];
+        p += n;
+    }
+    *p++ = 'p';
+    *p++ = e < 0 ? '-' : '+';
+    p = __itoa::__u32toa(static_cast<uint32_t>(e < 0 ? -e : e), p);
+    size_t size = static_cast<size_t>(p - buf);
+    if (static_cast<size_t>(last - first) < size)
+        return {last, errc::value_too_large};
+    memcpy(first, buf, size);
+    return {first + size, errc()};
+}
+
+// fmt is 0 for the overloads without one, which pick the shorter of fixed and
+// scientific.
+template <class Float>
+to_chars_result
+to_chars_shortest(char* first, char* last, Float value, chars_format fmt)
+{
+    typedef float_traits<Float> traits;
+    typedef typename float_traits<Float>::bits_type bits_type;
+    bits_type bits;
+    memcpy(&bits, &value, sizeof(bits));
+    const bool negative = (bits >> (traits::mantissa_bits + traits::exponent_bits)) & 1;
+    const bits_type mantissa = bits & ((bits_type(1) << traits::mantissa_bits) - 1);
+    const uint32_t exponent = static_cast<uint32_t>(
+        (bits >> traits::mantissa_bits) & ((1u << traits::exponent_bits) - 1));
+
+    if (exponent == (1u << traits::exponent_bits) - 1)
+        return write_special(first, last, negative, mantissa != 0);
+    if (negative)
+    {
+        if (first == last)
+            return {last, errc::value_too_large};
+        *first++ = '-';
+    }
+    if (fmt == chars_format::hex)
+        return write_hex<Float>(first, last, mantissa, exponent);
+
+    shortest_digits s;
+    if (mantissa == 0 && exponent == 0)
+    {
+        s.digits[0] = '0';
+        s.count = 1;
+        s.exponent = 0;
+    }
+    else
+    {
+        traits::shortest(s, mantissa, exponent);
+    }
+
+    bool fixed;
+    if (fmt == chars_format::fixed)
+        fixed = true;
+    else if (fmt == chars_format::scientific)
+        fixed = false;
+    else if (fmt == chars_format::general)
+        fixed = -4 <= s.exponent && s.exponent < 6; // %g without a precision
+    else
+        fixed = fixed_length(s) <= scientific_length(s);
+    if (!fixed)
+        return write_scientific(first, last, s);
+
+    // Above 2^mantissa_bits+1 values are integers, whose shortest digits
+    // followed by zeros are further from the value than its exact digits,
+    // which are never more.
+    if (exponent > static_cast<uint32_t>(traits::bias + traits::mantissa_bits))
+        return printf_to_chars(first, last, "%.*f", 0, fabs(static_cast<double>(value)));
+    return write_fixed(first, last, s);
+}
+
+template <class Float>
+to_chars_result
+to_chars_precision(char* first, char* last, Float value, chars_format fmt, int precision)
+{
+    if (precision < 0)
+        precision = 6;
+    typedef typename conditional<is_same<Float, long double>::value, long double,
+                                 double>::type printf_type;
+    const bool is_long = is_same<Float, long double>::value;
+    switch (fmt)
+    {
+    case chars_format::fixed:
+        return printf_to_chars(first, last, is_long ? "%.*Lf" : "%.*f", precision,
+                               static_cast<printf_type>(value));
+    case chars_format::scientific:
+        return printf_to_chars(first, last, is_long ? "%.*Le" : "%.*e", precision,
+                               static_cast<printf_type>(value));
+    case chars_format::hex:
+        return printf_hex_to_chars(first, last, is_long ? "%.*La" : "%.*a", precision,
+                                   static_cast<printf_type>(value));
+    default:
+        return printf_to_chars(first, last, is_long ? "%.*Lg" : "%.*g", precision,
+                               static_cast<printf_type>(value));
+    }
+}
+
+// long double has no Ryu tables: its shortest digits are those of the
+// shortest %.*Le which reads back the same.
+to_chars_result
+to_chars_shortest(char* first, char* last, long double value, chars_format fmt)
+{
+    if (sizeof(long double) == sizeof(double))
+        return to_chars_shortest(first, last, static_cast<double>(value), fmt);
+    if (value != value || value == numeric_limits<long double>::infinity() ||
+        value == -numeric_limits<long double>::infinity())
+        return write_special(first, last, signbit(value), value != value);
+    if (fmt == chars_format::hex)
+        return printf_hex_to_chars(first, last, "%.*La", -1, value);
+    if (signbit(value))
+    {
+        if (first == last)
+            return {last, errc::value_too_large};
+        *first++ = '-';
+        value = -value;
+    }
+
+    shortest_digits s;
+    char buf[64];
+    for (int precision = 0;; ++precision)
+    {
+        __libcpp_snprintf_l(buf, sizeof(buf), _LIBCPP_GET_C_LOCALE, "%.*Le", precision, value);
+        if (precision >= LDBL_DECIMAL_DIG - 1 ||
+            __do_strtod<long double>(buf, nullptr) == value)
+            break;
+    }
+    // buf is d[.ddd]e+XX, with trailing zeros only for 0.
+    const char* p = buf;
+    s.count = 0;
+    for (; *p != 'e'; ++p)
+        if (*p != '.')
+            s.digits[s.count++] = *p;
+    s.exponent = atoi(p + 1);
+    while (s.count > 1 && s.digits[s.count - 1] == '0')
+        --s.count;
+
+    bool fixed;
+    if (fmt == chars_format::fixed)
+        fixed = true;
+    else if (fmt == chars_format::scientific)
+        fixed = false;
+    else if (fmt == chars_format::general)
+        fixed = -4 <= s.exponent && s.exponent < 6;
+    else
+        fixed = fixed_length(s) <= scientific_length(s);
+    if (!fixed)
+        return write_scientific(first, last, s);
+    if (s.count <= s.exponent && value >= 1 / numeric_limits<long double>::epsilon())
+        return printf_to_chars(first, last, "%.*Lf", 0, value);
+    return write_fixed(first, last, s);
+}
+
+// from_chars: the strtod pattern, less the leading whitespace, the plus
+// sign and the 0x of hex numbers, and with the exponent required or
+// forbidden by the format.
+
+inline bool
+match_icase(const char* first, const char* last, const char* word)
+{
+    for (; *word; ++word, ++first)
+        if (first == last || (*first | 0x20) != *word)
+            return false;
+    return true;
+}
+
+inline bool
+is_digit(char c, bool hex)
+{
+    if (c >= '0' && c <= '9')
+        return true;
+    return hex && ((c | 0x20) >= 'a' && (c | 0x20) <= 'f');
+}
+
+// The largest exact powers of ten, for the conversions which need only one
+// correctly rounded multiplication or division.
+const double exact_pow10[] = {
+    1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+template <class Float>
+struct fast_path;
+
+template <>
+struct fast_path<float>
+{
+    static const uint64_t max_mantissa = uint64_t(1) << 24;
+    static const int max_exponent = 10;
+    static float convert(uint64_t m, int e)
+    {
+        float f = static_cast<float>(m);
+        float p = static_cast<float>(exact_pow10[e < 0 ? -e : e]);
+        return e < 0 ? f / p : f * p;
+    }
+};
+
+template <>
+struct fast_path<double>
+{
+    static const uint64_t max_mantissa = uint64_t(1) << 53;
+    static const int max_exponent = 22;
+    static double convert(uint64_t m, int e)
+    {
+        double f = static_cast<double>(m);
+        return e < 0 ? f / exact_pow10[-e] : f * exact_pow10[e];
+    }
+};
+
+template <>
+struct fast_path<long double>
+{
+    // Always take strtold, whose precision may differ from double's.
+    static const uint64_t max_mantissa = 0;
+    static const int max_exponent = -1;
+    static long double convert(uint64_t, int) { return 0; }
+};
+
+template <class Float>
+from_chars_result
+from_chars_floating_point(const char* first, const char* last, Float& value,
+                          chars_format fmt)
+{
+    const char* p = first;
+    const bool negative = p != last && *p == '-';
+    if (negative)
+        ++p;
+
+    if (match_icase(p, last, "inf"))
+    {
+        p += 3;
+        if (match_icase(p, last, "inity"))
+            p += 5;
+        value = negative ? -numeric_limits<Float>::infinity()
+                         : numeric_limits<Float>::infinity();
+        return {p, errc()};
+    }
+    if (match_icase(p, last, "nan"))
+    {
+        p += 3;
+        if (p != last && *p == '(')
+        {
+            const char* q = p + 1;
+            while (q != last && (is_digit(*q, true) || (*q | 0x20) == 'x' ||
+                                 ((*q | 0x20) >= 'a' && (*q | 0x20) <= 'z') || *q == '_'))
+                ++q;
+            if (q != last && *q == ')')
+                p = q + 1;
+        }
+        value = negative ? -numeric_limits<Float>::quiet_NaN()
+                         : numeric_limits<Float>::quiet_NaN();
+        return {p, errc()};
+    }
+
+    const bool hex = fmt == chars_format::hex;
+    const char* const mantissa_first = p;
+
+    // Up to 19 significant digits, which an uint64_t holds, and the decimal
+    // exponent of the last one.
+    uint64_t m = 0;
+    int digits = 0;
+    int dropped = 0; // Significant digits after the 19th, before the point.
+    int fraction = 0;
+    bool nonzero = false;
+    bool inexact = false;
+    for (; p != last && is_digit(*p, hex); ++p)
+    {
+        if (*p != '0')
+            nonzero = true;
+        if (digits < 19)
+        {
+            m = 10 * m + static_cast<uint64_t>(*p - '0');
+            digits += m != 0;
+        }
+        else
+        {
+            ++dropped;
+            inexact |= *p != '0';
+        }
+    }
+    const char* point = p;
+    if (p != last && *p == '.')
+    {
+        for (++p; p != last && is_digit(*p, hex); ++p)
+        {
+            if (*p != '0')
+                nonzero = true;
+            if (digits < 19)
+            {
+                m = 10 * m + static_cast<uint64_t>(*p - '0');
+                digits += m != 0;
+                ++fraction;
+            }
+            else
+            {
+                inexact |= *p != '0';
+            }
+        }
+    }
+    // No digit at all, or only the point.
+    if (p == mantissa_first || (p - mantissa_first == 1 && point != p))
+        return {first, errc::invalid_argument};
+
+    int exponent = 0;
+    const char exponent_char = hex ? 'p' : 'e';
+    if ((static_cast<unsigned>(fmt) & static_cast<unsigned>(chars_format::scientific)) || hex)
+    {
+        if (p != last && (*p | 0x20) == exponent_char)
+        {
+            const char* q = p + 1;
+            bool exponent_negative = false;
+            if (q != last && (*q == '+' || *q == '-'))
+                exponent_negative = *q++ == '-';
+            if (q != last && is_digit(*q, false))
+            {
+                for (; q != last && is_digit(*q, false); ++q)
+                    if (exponent < 100000)
+                        exponent = 10 * exponent + (*q - '0');
+                if (exponent_negative)
+                    exponent = -exponent;
+                p = q;
+            }
+            else if (fmt == chars_format::scientific)
+                return {first, errc::invalid_argument};
+        }
+        else if (fmt == chars_format::scientific)
+        {
+            return {first, errc::invalid_argument};
+        }
+    }
+
+    if (!hex)
+    {
+        if (!nonzero)
+        {
+            value = negative ? -Float(0) : Float(0);
+            return {p, errc()};
+        }
+        // Clinger's fast path: an exact mantissa times an exact power of ten
+        // is correctly rounded by a single floating-point operation.
+        int e = exponent + dropped - fraction;
+        if (!inexact && m <= fast_path<Float>::max_mantissa &&
+            -fast_path<Float>::max_exponent <= e && e <= fast_path<Float>::max_exponent)
+        {
+            Float r = fast_path<Float>::convert(m, e);
+            value = negative ? -r : r;
+            return {p, errc()};
+        }
+    }
+
+    // strtod, on a null-terminated copy of the pattern.
+    size_t size = static_cast<size_t>(p - mantissa_first);
+    char small[128];
+    unique_ptr<char[]> big;
+    char* buf = small;
+    if (size + 4 > sizeof(small))
+    {
+        big.reset(new char[size + 4]);
+        buf = big.get();
+    }
+    char* b = buf;
+    if (negative)
+        *b++ = '-';
+    if (hex)
+    {
+        *b++ = '0';
+        *b++ = 'x';
+    }
+    memcpy(b, mantissa_first, size);
+    b[size] = '\0';
+
+    int saved_errno = errno;
+    errno = 0;
+    char* end;
+    Float r = __do_strtod<Float>(buf, &end);
+    bool out_of_range = errno == ERANGE &&
+                        (r == 0 || r == numeric_limits<Float>::infinity() ||
+                         r == -numeric_limits<Float>::infinity());
+    errno = saved_errno;
+    if (out_of_range)
+        return {p, errc::result_out_of_range};
+    value = r;
+    return {p, errc()};
+}
+
+}  // unnamed namespace
+
+to_chars_result
+to_chars(char* __first, char* __last, float __value)
+{
+    return to_chars_shortest(__first, __last, __value, chars_format());
+}
+
+to_chars_result
+to_chars(char* __first, char* __last, double __value)
+{
+    return to_chars_shortest(__first, __last, __value, chars_format());
+}
+
+to_chars_result
+to_chars(char* __first, char* __last, long double __value)
+{
+    return to_chars_shortest(__first, __last, __value, chars_format());
+}
+
+to_chars_result
+to_chars(char* __first, char* __last, float __value, chars_format __fmt)
+{
+    return to_chars_shortest(__first, __last, __value, __fmt);
+}
+
+to_chars_result
+to_chars(char* __first, char* __last, double __value, chars_format __fmt)
+{
+    return to_chars_shortest(__first, __last, __value, __fmt);
+}
+
+to_chars_result
+to_chars(char* __first, char* __last, long double __value, chars_format __fmt)
+{
+    return to_chars_shortest(__first, __last, __value, __fmt);
+}
+
+to_chars_result
+to_chars(char* __first, char* __last, float __value, chars_format __fmt,
+         int __precision)
+{
+    return to_chars_precision(__first, __last, __value, __fmt, __precision);
+}
+
+to_chars_result
+to_chars(char* __first, char* __last, double __value, chars_format __fmt,
+         int __precision)
+{
+    return to_chars_precision(__first, __last, __value, __fmt, __precision);
+}
+
+to_chars_result
+to_chars(char* __first, char* __last, long double __value, chars_format __fmt,
+         int __precision)
+{
+    return to_chars_precision(__first, __last, __value, __fmt, __precision);
+}
+
+from_chars_result
+from_chars(const char* __first, const char* __last, float& __value,
+           chars_format __fmt)
+{
+    return from_chars_floating_point(__first, __last, __value, __fmt);
+}
+
+from_chars_result
+from_chars(const char* __first, const char* __last, double& __value,
+           chars_format __fmt)
+{
+    return from_chars_floating_point(__first, __last, __value, __fmt);
+}
+
+from_chars_result
+from_chars(const char* __first, const char* __last, long double& __value,
+           chars_format __fmt)
+{
+    return from_chars_floating_point(__first, __last, __value, __fmt);
+}
+
 _LIBCPP_END_NAMESPACE_STD
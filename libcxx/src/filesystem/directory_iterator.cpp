@@ -14,6 +14,11 @@
 #else
 #include <dirent.h>
 #endif
+#if defined(__linux__)
+#include <fcntl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
 #include <errno.h>
 
 #include "filesystem_common.h"
@@ -58,6 +63,40 @@ static file_type get_file_type(DirEntT* ent, long) {
   return file_type::none;
 }
 
+#if defined(__linux__)
+// The record getdents64 fills its buffer with. glibc's struct dirent64 has
+// the same layout, but is only declared with _LARGEFILE64_SOURCE.
+struct linux_dirent64 {
+  uint64_t d_ino;
+  int64_t d_off;
+  unsigned short d_reclen;
+  unsigned char d_type;
+  char d_name[1];
+};
+
+// Large enough for several hundred entries, like the buffer glibc's readdir
+// uses.
+const size_t dirent_buffer_size = 32 * 1024;
+
+static int linux_opendir(int dir_fd, const char* name, error_code& ec) {
+  int fd = ::openat(dir_fd, name,
+                    O_RDONLY | O_DIRECTORY | O_NONBLOCK | O_CLOEXEC);
+  if (fd == -1)
+    ec = capture_errno();
+  return fd;
+}
+
+// Refills buf with directory entries. Returns the number of bytes read, which
+// is zero at the end of the directory or on error.
+static size_t linux_getdents(int fd, char* buf, error_code& ec) {
+  long n = ::syscall(SYS_getdents64, fd, buf, dirent_buffer_size);
+  if (n < 0) {
+    ec = capture_errno();
+    return 0;
+  }
+  return static_cast<size_t>(n);
+}
+#else
 static pair<string_view, file_type> posix_readdir(DIR* dir_stream,
                                                   error_code& ec) {
   struct dirent* dir_entry_ptr = nullptr;
@@ -71,6 +110,7 @@ static pair<string_view, file_type> posix_readdir(DIR* dir_stream,
     return {dir_entry_ptr->d_name, get_file_type(dir_entry_ptr, 0)};
   }
 }
+#endif // defined(__linux__)
 #else
 
 static file_type get_file_type(const WIN32_FIND_DATA& data) {
@@ -108,6 +148,11 @@ public:
     __ds.__stream_ = INVALID_HANDLE_VALUE;
   }
 
+  // Opens the directory parent.__entry_ refers to.
+  __dir_stream(const __dir_stream& parent, directory_options opts,
+               error_code& ec)
+      : __dir_stream(parent.__entry_.path(), opts, ec) {}
+
   __dir_stream(const path& root, directory_options opts, error_code& ec)
       : __stream_(INVALID_HANDLE_VALUE), __root_(root) {
     __stream_ = ::FindFirstFileEx(root.c_str(), &__data_);
@@ -170,12 +215,101 @@ public:
   __dir_stream() = delete;
   __dir_stream& operator=(const __dir_stream&) = delete;
 
-  __dir_stream(__dir_stream&& other) noexcept : __stream_(other.__stream_),
-                                                __root_(move(other.__root_)),
-                                                __entry_(move(other.__entry_)) {
+#if defined(__linux__)
+  __dir_stream(__dir_stream&& other) noexcept
+      : __fd_(other.__fd_), __buf_(move(other.__buf_)), __pos_(other.__pos_),
+        __end_(other.__end_), __name_(other.__name_),
+        __prefix_(move(other.__prefix_)), __root_(move(other.__root_)),
+        __entry_(move(other.__entry_)) {
+    other.__fd_ = -1;
+  }
+
+  __dir_stream(const path& root, directory_options opts, error_code& ec)
+      : __root_(root) {
+    __open(AT_FDCWD, root.c_str(), opts, ec);
+  }
+
+  // Opens the directory parent.__entry_ refers to. The directory is opened
+  // relative to its parent, so the kernel does not have to look up the
+  // whole path again.
+  __dir_stream(const __dir_stream& parent, directory_options opts,
+               error_code& ec)
+      : __root_(parent.__entry_.path()) {
+    __open(parent.__fd_, parent.__name_, opts, ec);
+  }
+
+  ~__dir_stream() noexcept {
+    if (__fd_ != -1)
+      close();
+  }
+
+  bool good() const noexcept { return __fd_ != -1; }
+
+  bool advance(error_code& ec) {
+    ec.clear();
+    while (true) {
+      if (__pos_ == __end_) {
+        __pos_ = 0;
+        __end_ = detail::linux_getdents(__fd_, __buf_.get(), ec);
+        if (__end_ == 0) {
+          close();
+          return false;
+        }
+      }
+      auto* ent =
+          reinterpret_cast<detail::linux_dirent64*>(__buf_.get() + __pos_);
+      __pos_ += ent->d_reclen;
+      string_view str = ent->d_name;
+      if (str == "." || str == "..")
+        continue;
+      __name_ = ent->d_name;
+      __assign_entry(str, detail::get_file_type(ent, 0));
+      return true;
+    }
+  }
+
+private:
+  void __open(int dir_fd, const char* name, directory_options opts,
+              error_code& ec) {
+    if ((__fd_ = detail::linux_opendir(dir_fd, name, ec)) == -1) {
+      const bool allow_eacess =
+          bool(opts & directory_options::skip_permission_denied);
+      if (allow_eacess && ec.value() == EACCES)
+        ec.clear();
+      return;
+    }
+    __buf_.reset(new char[detail::dirent_buffer_size]);
+    __prefix_ = __root_ / "";
+    advance(ec);
+  }
+
+  error_code close() noexcept {
+    error_code m_ec;
+    if (::close(__fd_) == -1)
+      m_ec = detail::capture_errno();
+    __fd_ = -1;
+    __buf_.reset();
+    return m_ec;
+  }
+
+  int __fd_{-1};
+  unique_ptr<char[]> __buf_;
+  size_t __pos_{0};
+  size_t __end_{0};
+  // The name of the current entry, which lives in __buf_.
+  const char* __name_{nullptr};
+#else
+  __dir_stream(__dir_stream&& other) noexcept
+      : __stream_(other.__stream_), __prefix_(move(other.__prefix_)),
+        __root_(move(other.__root_)), __entry_(move(other.__entry_)) {
     other.__stream_ = nullptr;
   }
 
+  // Opens the directory parent.__entry_ refers to.
+  __dir_stream(const __dir_stream& parent, directory_options opts,
+               error_code& ec)
+      : __dir_stream(parent.__entry_.path(), opts, ec) {}
+
   __dir_stream(const path& root, directory_options opts, error_code& ec)
       : __stream_(nullptr), __root_(root) {
     if ((__stream_ = ::opendir(root.c_str())) == nullptr) {
@@ -186,6 +320,7 @@ public:
         ec.clear();
       return;
     }
+    __prefix_ = __root_ / "";
     advance(ec);
   }
 
@@ -206,9 +341,7 @@ public:
         close();
         return false;
       } else {
-        __entry_.__assign_iter_entry(
-            __root_ / str,
-            directory_entry::__create_iter_result(str_type_pair.second));
+        __assign_entry(str, str_type_pair.second);
         return true;
       }
     }
@@ -224,6 +357,19 @@ private:
   }
 
   DIR* __stream_{nullptr};
+#endif
+
+  // Points the entry at __root_ / name. Copying __prefix_ into the path of
+  // the previous entry reuses its storage, and avoids working out for every
+  // entry whether __root_ needs a separator.
+  void __assign_entry(string_view name, file_type ft) {
+    __entry_.__p_ = __prefix_;
+    __entry_.__p_ += name;
+    __entry_.__data_ = directory_entry::__create_iter_result(ft);
+  }
+
+  // __root_ followed by a separator, if it needs one.
+  path __prefix_;
 
 public:
   path __root_;
@@ -374,7 +520,7 @@ bool recursive_directory_iterator::__try_recursion(error_code* ec) {
   }
 
   if (!skip_rec) {
-    __dir_stream new_it(curr_it.__entry_.path(), __imp_->__options_, m_ec);
+    __dir_stream new_it(curr_it, __imp_->__options_, m_ec);
     if (new_it.good()) {
       __imp_->__stack_.push(move(new_it));
       return true;
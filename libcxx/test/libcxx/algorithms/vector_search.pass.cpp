@@ -0,0 +1,113 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+// <algorithm>
+
+// find, count and mismatch compare contiguous ranges of integers a vector
+// register at a time. Check them at every length and alignment around the
+// vector width, against the element loops.
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "test_macros.h"
+
+template <class T>
+void test_type() {
+  const std::size_t N = 160;
+  std::vector<T> buf(N + 64);
+  for (std::size_t i = 0; i < buf.size(); ++i)
+    buf[i] = static_cast<T>(i % 7 + 1);
+  for (std::size_t off = 0; off < 33; ++off) {
+    for (std::size_t len = 0; len < N - off; ++len) {
+      T* first = buf.data() + off;
+      T* last = first + len;
+      // Absent, then present at every position of the range.
+      assert(std::find(first, last, T(0)) == last);
+      assert(std::count(first, last, T(0)) == 0);
+      for (std::size_t pos = 0; pos < len; pos += (len < 40 ? 1 : 7)) {
+        T saved = first[pos];
+        first[pos] = T(0);
+        assert(std::find(first, last, T(0)) == first + pos);
+        const T* cfirst = first;
+        assert(std::find(cfirst, cfirst + len, T(0)) == cfirst + pos);
+        first[pos] = saved;
+      }
+      std::ptrdiff_t ones = 0;
+      for (T* p = first; p != last; ++p)
+        ones += *p == T(1);
+      assert(std::count(first, last, T(1)) == ones);
+
+      std::vector<T> other(first, last);
+      assert(std::mismatch(first, last, other.data()).first == last);
+      for (std::size_t pos = 0; pos < len; pos += (len < 40 ? 1 : 5)) {
+        other[pos] = T(0);
+        std::pair<T*, T*> r = std::mismatch(first, last, other.data());
+        assert(r.first == first + pos && r.second == other.data() + pos);
+#if TEST_STD_VER > 11
+        std::pair<T*, typename std::vector<T>::iterator> r2 =
+            std::mismatch(first, last, other.begin(), other.end());
+        assert(r2.first == first + pos && r2.second == other.begin() + pos);
+        r2 = std::mismatch(first, last, other.begin(), other.begin() + pos);
+        assert(r2.first == first + pos && r2.second == other.begin() + pos);
+#endif
+        other[pos] = first[pos];
+      }
+    }
+  }
+
+  // Through vector iterators.
+  std::vector<T> v(1000, T(3));
+  v[777] = T(4);
+  assert(std::find(v.begin(), v.end(), T(4)) == v.begin() + 777);
+  assert(std::find(v.cbegin(), v.cend(), T(4)) == v.cbegin() + 777);
+  assert(std::count(v.begin(), v.end(), T(3)) == 999);
+  assert(std::mismatch(v.begin(), v.end(), std::vector<T>(1000, T(3)).begin()).first ==
+         v.begin() + 777);
+}
+
+// More matches than a byte lane can count.
+void test_long_count() {
+  std::vector<unsigned char> v(100000, 5);
+  v[12345] = 6;
+  assert(std::count(v.begin(), v.end(), 5) == 99999);
+  assert(std::count(v.begin(), v.end(), (unsigned char)5) == 99999);
+  std::vector<short> s(300000, -1);
+  assert(std::count(s.begin(), s.end(), short(-1)) == 300000);
+}
+
+void test_char_traits() {
+  std::u16string s16(300, u'a');
+  s16[257] = u'b';
+  assert(s16.find(u'b') == 257);
+  assert(std::char_traits<char16_t>::find(s16.data(), 257, u'b') == nullptr);
+  std::u32string s32(300, U'a');
+  s32[33] = U'b';
+  assert(s32.find(U'b') == 33);
+  assert(s32.find(U'c') == std::u32string::npos);
+}
+
+int main(int, char**) {
+  test_type<char>();
+  test_type<signed char>();
+  test_type<unsigned char>();
+  test_type<short>();
+  test_type<int>();
+  test_type<unsigned>();
+  test_type<long long>();
+  test_type<char16_t>();
+  test_type<char32_t>();
+  test_type<wchar_t>();
+  test_long_count();
+  test_char_traits();
+
+  return 0;
+}
@@ -0,0 +1,93 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+// UNSUPPORTED: c++98, c++03
+
+// <vector>
+
+// An allocator providing allocate_at_least(n) has the whole allocation it
+// returns used as capacity, and gets the same size back in deallocate.
+
+#include <vector>
+#include <cassert>
+#include <cstddef>
+#include <new>
+
+#include "test_macros.h"
+
+static int outstanding = 0;
+
+template <class T>
+struct rounding_allocator
+{
+    typedef T value_type;
+
+    struct result
+    {
+        T* ptr;
+        std::size_t count;
+    };
+
+    rounding_allocator() {}
+    template <class U>
+    rounding_allocator(const rounding_allocator<U>&) {}
+
+    static std::size_t round(std::size_t n) { return (n + 7) & ~std::size_t(7); }
+
+    T* allocate(std::size_t n)
+    {
+        ++outstanding;
+        return static_cast<T*>(::operator new(n * sizeof(T)));
+    }
+
+    result allocate_at_least(std::size_t n)
+    {
+        result r = {allocate(round(n)), round(n)};
+        return r;
+    }
+
+    void deallocate(T* p, std::size_t n)
+    {
+        assert(n == round(n));
+        --outstanding;
+        ::operator delete(p);
+    }
+
+    friend bool operator==(rounding_allocator, rounding_allocator) { return true; }
+    friend bool operator!=(rounding_allocator, rounding_allocator) { return false; }
+};
+
+int main(int, char**)
+{
+    {
+        std::vector<int, rounding_allocator<int> > v;
+        v.reserve(3);
+        assert(v.capacity() == 8);
+        for (int i = 0; i < 100; ++i)
+            v.push_back(i);
+        assert(v.capacity() % 8 == 0);
+        for (int i = 0; i < 100; ++i)
+            assert(v[i] == i);
+        std::vector<int, rounding_allocator<int> > w(v);
+        assert(w.capacity() == 104);
+        v.shrink_to_fit();
+        assert(v.capacity() == 104);
+    }
+    assert(outstanding == 0);
+    {
+        typedef std::vector<bool, rounding_allocator<bool> > V;
+        V v(1);
+        std::size_t bits = sizeof(typename V::size_type) * 8;
+        assert(v.capacity() == 8 * bits);
+        v.resize(8 * bits + 1);
+        assert(v.capacity() % (8 * bits) == 0);
+    }
+    assert(outstanding == 0);
+
+  return 0;
+}
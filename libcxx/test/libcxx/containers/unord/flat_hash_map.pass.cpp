@@ -0,0 +1,118 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// UNSUPPORTED: c++98, c++03
+
+// Not a portable test
+
+// <__flat_hash_table>
+
+// template <class Key, class T, class Hash, class Pred, class Alloc>
+// class __flat_unordered_map;
+
+#include <__flat_hash_table>
+#include <unordered_map>
+#include <memory>
+#include <string>
+#include <cassert>
+
+#include "test_macros.h"
+#include "MoveOnly.h"
+#include "count_new.hpp"
+
+void test_basic() {
+  typedef std::__flat_unordered_map<int, std::string> Map;
+  Map m = {{1, "one"}, {2, "two"}, {1, "uno"}};
+  assert(m.size() == 2);
+  assert(m[1] == "one");
+  assert(m.at(2) == "two");
+  m[3] = "three";
+  assert(m.size() == 3);
+  assert(!m.try_emplace(3, "drei").second);
+  assert(m[3] == "three");
+  assert(m.insert_or_assign(3, "drei").second == false);
+  assert(m[3] == "drei");
+  assert(m.emplace(4, "four").second);
+  assert(m.insert(std::make_pair(5, "five")).second);
+  assert(m.count(5) == 1);
+  const Map& cm = m;
+  assert(cm.find(4)->second == "four");
+  assert(cm.at(4) == "four");
+#ifndef TEST_HAS_NO_EXCEPTIONS
+  try {
+    (void)cm.at(6);
+    assert(false);
+  } catch (std::out_of_range&) {
+  }
+#endif
+
+  Map c(m);
+  assert(c == m);
+  c[1] = "eins";
+  assert(c != m);
+  c.erase(c.find(1));
+  assert(c.size() == 4 && c.count(1) == 0);
+  for (Map::iterator i = c.begin(); i != c.end(); ++i)
+    i->second += "!";
+  assert(c[2] == "two!");
+}
+
+// A rehash moves the elements, the keys as well as the mapped values.
+void test_move_only() {
+  typedef std::__flat_unordered_map<MoveOnly, MoveOnly, std::hash<MoveOnly> > Map;
+  Map m;
+  for (int i = 0; i < 1000; ++i)
+    assert(m.try_emplace(MoveOnly(i), 2 * i).second);
+  assert(m.size() == 1000);
+  for (int i = 0; i < 1000; ++i)
+    assert(m.find(MoveOnly(i))->second == MoveOnly(2 * i));
+  Map n(std::move(m));
+  assert(m.empty() && n.size() == 1000);
+  m = std::move(n);
+  assert(n.empty() && m.size() == 1000);
+}
+
+void test_churn() {
+  std::__flat_unordered_map<int, int> m;
+  std::unordered_map<int, int> ref;
+  unsigned state = 7;
+  for (int step = 0; step < 20000; ++step) {
+    state = state * 1103515245 + 12345;
+    int key = static_cast<int>((state >> 8) % 3000);
+    if ((state >> 4) % 4 == 0)
+      assert(m.erase(key) == ref.erase(key));
+    else
+      m[key] += step, ref[key] += step;
+  }
+  assert(m.size() == ref.size());
+  for (const auto& kv : ref)
+    assert(m.at(kv.first) == kv.second);
+}
+
+// No node is allocated per element.
+void test_allocations() {
+  globalMemCounter.reset();
+  {
+    std::__flat_unordered_map<int, int> m;
+    m.reserve(1000);
+    int before = globalMemCounter.outstanding_new;
+    for (int i = 0; i < 1000; ++i)
+      m[i] = i;
+    assert(globalMemCounter.checkOutstandingNewEq(before));
+  }
+  assert(globalMemCounter.checkOutstandingNewEq(0));
+}
+
+int main(int, char**) {
+  test_basic();
+  test_move_only();
+  test_churn();
+  test_allocations();
+
+  return 0;
+}
@@ -0,0 +1,157 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// UNSUPPORTED: c++98, c++03
+
+// Not a portable test
+
+// <__flat_hash_table>
+
+// template <class Value, class Hash, class Pred, class Alloc>
+// class __flat_unordered_set;
+
+#include <__flat_hash_table>
+#include <unordered_set>
+#include <string>
+#include <cassert>
+#include <cstddef>
+
+#include "test_macros.h"
+#include "min_allocator.h"
+
+// Sends every key to the same probe sequence, and only varies the low bits
+// which make the control bytes.
+struct BadHash {
+  std::size_t operator()(int x) const { return static_cast<std::size_t>(x) & 3; }
+};
+
+template <class Set>
+void check_equal(const Set& s, const std::unordered_set<int>& ref) {
+  assert(s.size() == ref.size());
+  assert(s.empty() == ref.empty());
+  std::size_t n = 0;
+  for (typename Set::const_iterator i = s.begin(); i != s.end(); ++i, ++n)
+    assert(ref.count(*i) == 1);
+  assert(n == ref.size());
+  for (int x : ref) {
+    assert(s.count(x) == 1);
+    assert(*s.find(x) == x);
+  }
+  assert(s.load_factor() <= s.max_load_factor());
+}
+
+// Inserts and erases pseudo random keys, which reuses erased slots and
+// rehashes the table in place and to larger capacities.
+template <class Set>
+void test_churn() {
+  Set s;
+  std::unordered_set<int> ref;
+  unsigned state = 12345;
+  for (int step = 0; step < 20000; ++step) {
+    state = state * 1103515245 + 12345;
+    int key = static_cast<int>((state >> 8) % 2000);
+    if ((state >> 4) % 3 == 0) {
+      assert(s.erase(key) == ref.erase(key));
+    } else {
+      bool inserted = s.insert(key).second;
+      assert(inserted == ref.insert(key).second);
+    }
+    if (step % 1000 == 0)
+      check_equal(s, ref);
+  }
+  check_equal(s, ref);
+  for (typename Set::const_iterator i = s.begin(); i != s.end();) {
+    if (*i % 2)
+      i = s.erase(i);
+    else
+      ++i;
+  }
+  for (auto i = ref.begin(); i != ref.end();) {
+    if (*i % 2)
+      i = ref.erase(i);
+    else
+      ++i;
+  }
+  check_equal(s, ref);
+  s.rehash(0);
+  check_equal(s, ref);
+  s.erase(s.begin(), s.end());
+  assert(s.empty());
+  assert(s.begin() == s.end());
+  assert(s.find(4) == s.end());
+}
+
+void test_basic() {
+  typedef std::__flat_unordered_set<int> Set;
+  Set s;
+  assert(s.empty());
+  assert(s.begin() == s.end());
+  assert(s.bucket_count() == 0);
+  assert(s.find(1) == s.end());
+  assert(s.erase(1) == 0);
+
+  s = {1, 2, 3, 2, 1};
+  assert(s.size() == 3);
+  assert(s.count(2) == 1);
+  assert(s.count(4) == 0);
+  assert(s.contains(3));
+  assert(*s.emplace(4).first == 4);
+  assert(!s.emplace(4).second);
+  assert(s.equal_range(4).first == s.find(4));
+  assert(s.equal_range(5).first == s.end());
+
+  Set c(s);
+  assert(c == s);
+  c.erase(1);
+  assert(c != s);
+  Set m(std::move(c));
+  assert(c.empty());
+  assert(m.size() == 3);
+  m.swap(s);
+  assert(s.size() == 3 && m.size() == 4);
+  s = m;
+  assert(s == m);
+  m.clear();
+  assert(m.empty() && m.find(1) == m.end());
+  m = std::move(s);
+  assert(m.size() == 4 && s.empty());
+
+  s.reserve(1000);
+  std::size_t bc = s.bucket_count();
+  assert(bc >= 1000);
+  for (int i = 0; i < 1000; ++i)
+    s.insert(i);
+  assert(s.bucket_count() == bc);
+  s.clear();
+  s.rehash(0);
+  assert(s.bucket_count() == 0);
+}
+
+void test_strings() {
+  std::__flat_unordered_set<std::string> s;
+  for (int i = 0; i < 500; ++i)
+    s.insert(std::to_string(i));
+  assert(s.size() == 500);
+  for (int i = 0; i < 500; ++i)
+    assert(s.count(std::to_string(i)) == 1);
+  assert(s.count("500") == 0);
+  std::string moved("moved");
+  s.insert(std::move(moved));
+  assert(s.count("moved") == 1);
+}
+
+int main(int, char**) {
+  test_basic();
+  test_strings();
+  test_churn<std::__flat_unordered_set<int> >();
+  test_churn<std::__flat_unordered_set<int, BadHash> >();
+  test_churn<std::__flat_unordered_set<int, std::hash<int>, std::equal_to<int>,
+                                       min_allocator<int> > >();
+
+  return 0;
+}
@@ -63,6 +63,7 @@
 #include <deque>
 #include <errno.h>
 #include <exception>
+#include <execution>
 #include <fenv.h>
 #include <filesystem>
 #include <float.h>
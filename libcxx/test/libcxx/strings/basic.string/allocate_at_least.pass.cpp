@@ -0,0 +1,86 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+// UNSUPPORTED: c++98, c++03
+
+// <string>
+
+// An allocator providing allocate_at_least(n) has the whole allocation it
+// returns used as capacity, and gets the same size back in deallocate.
+
+#include <string>
+#include <cassert>
+#include <cstddef>
+#include <new>
+
+#include "test_macros.h"
+
+static int outstanding = 0;
+
+template <class T>
+struct rounding_allocator
+{
+    typedef T value_type;
+
+    struct result
+    {
+        T* ptr;
+        std::size_t count;
+    };
+
+    rounding_allocator() {}
+    template <class U>
+    rounding_allocator(const rounding_allocator<U>&) {}
+
+    static std::size_t round(std::size_t n) { return (n + 63) & ~std::size_t(63); }
+
+    T* allocate(std::size_t n)
+    {
+        ++outstanding;
+        return static_cast<T*>(::operator new(n * sizeof(T)));
+    }
+
+    result allocate_at_least(std::size_t n)
+    {
+        result r = {allocate(round(n)), round(n)};
+        return r;
+    }
+
+    void deallocate(T* p, std::size_t n)
+    {
+        // The string may keep a little less than was returned.
+        assert(n <= round(n) && n + 2 > round(n));
+        --outstanding;
+        ::operator delete(p);
+    }
+
+    friend bool operator==(rounding_allocator, rounding_allocator) { return true; }
+    friend bool operator!=(rounding_allocator, rounding_allocator) { return false; }
+};
+
+int main(int, char**)
+{
+    typedef std::basic_string<char, std::char_traits<char>, rounding_allocator<char> > S;
+    {
+        S s(30, 'a');
+        assert(s.capacity() == 63);
+        s.append(40, 'b');
+        assert(s.size() == 70);
+        assert(s.capacity() == 127);
+        s.reserve(200);
+        assert(s.capacity() == 255);
+        S t(s);
+        assert(t == s);
+        assert(t.capacity() == 127);
+        s.shrink_to_fit();
+        assert(s.capacity() == 127);
+    }
+    assert(outstanding == 0);
+
+  return 0;
+}
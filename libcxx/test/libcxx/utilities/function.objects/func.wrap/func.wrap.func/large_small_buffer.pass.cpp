@@ -0,0 +1,78 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+// <functional>
+
+// class function<R(ArgTypes...)>
+
+// With _LIBCPP_ABI_FUNCTION_LARGE_SMALL_BUFFER, callables of up to five
+// pointers are stored inside the function object.
+
+// UNSUPPORTED: c++98, c++03
+
+// MODULES_DEFINES: _LIBCPP_ABI_FUNCTION_LARGE_SMALL_BUFFER
+#define _LIBCPP_ABI_FUNCTION_LARGE_SMALL_BUFFER
+#include <functional>
+#include <cassert>
+
+#include "test_macros.h"
+#include "count_new.hpp"
+
+struct Trivial
+{
+    void* p[5];
+    int operator()() const { return p[0] == p[4] ? 1 : 2; }
+};
+
+struct NonTrivial
+{
+    static int count;
+    void* p[5];
+    NonTrivial() : p() { ++count; }
+    NonTrivial(const NonTrivial& other) TEST_NOEXCEPT {
+        for (int i = 0; i < 5; ++i)
+            p[i] = other.p[i];
+        ++count;
+    }
+    ~NonTrivial() { --count; }
+    int operator()() const { return p[0] == p[4] ? 3 : 4; }
+};
+
+int NonTrivial::count = 0;
+
+int main(int, char**)
+{
+    static_assert(sizeof(std::function<int()>) <= 8 * sizeof(void*), "");
+    assert(globalMemCounter.checkOutstandingNewEq(0));
+    {
+        Trivial t = {};
+        std::function<int()> f = t;
+        assert(globalMemCounter.checkOutstandingNewEq(0));
+        std::function<int()> g = f;
+        assert(globalMemCounter.checkOutstandingNewEq(0));
+        assert(f() == 1 && g() == 1);
+    }
+    {
+        std::function<int()> f = NonTrivial();
+        assert(NonTrivial::count == 1);
+#ifndef _LIBCPP_ABI_OPTIMIZED_FUNCTION
+        // The optimized std::function stores only trivial callables inline.
+        assert(globalMemCounter.checkOutstandingNewEq(0));
+#endif
+        std::function<int()> g = [] { return 5; };
+        f.swap(g);
+        assert(NonTrivial::count == 1);
+        assert(f() == 5 && g() == 3);
+        std::function<int()> h = std::move(g);
+        assert(h() == 3);
+    }
+    assert(NonTrivial::count == 0);
+    assert(globalMemCounter.checkOutstandingNewEq(0));
+
+    return 0;
+}
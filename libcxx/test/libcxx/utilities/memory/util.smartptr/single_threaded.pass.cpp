@@ -0,0 +1,69 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// UNSUPPORTED: libcpp-has-no-threads
+//
+// <memory>
+//
+// class shared_ptr
+//
+// The reference counts are updated without atomic operations until the
+// process starts its first thread. Check that the counts stay correct across
+// that transition, for pointers created before and after it.
+
+#include <memory>
+#include <thread>
+#include <vector>
+#include <cassert>
+
+#include "test_macros.h"
+
+typedef std::shared_ptr<int> Ptr;
+typedef std::weak_ptr<int> WeakPtr;
+
+void churn(Ptr p, int n) {
+    for (int i = 0; i < n; ++i) {
+        Ptr p2 = p;
+        WeakPtr w = p;
+        Ptr p3 = w.lock();
+        assert(p3.get() == p.get());
+    }
+}
+
+int main(int, char**) {
+    Ptr before = std::make_shared<int>(42);
+    std::vector<Ptr> copies(10, before);
+    WeakPtr weak = before;
+    assert(before.use_count() == 11);
+    copies.clear();
+    assert(before.use_count() == 1);
+    assert(!weak.expired());
+
+    {
+        std::thread t1(churn, before, 100000);
+        std::thread t2(churn, before, 100000);
+        churn(before, 100000);
+        t1.join();
+        t2.join();
+    }
+    assert(before.use_count() == 1);
+
+    Ptr after = std::make_shared<int>(43);
+    {
+        std::thread t1(churn, after, 100000);
+        churn(after, 100000);
+        t1.join();
+    }
+    assert(after.use_count() == 1);
+
+    before.reset();
+    assert(weak.expired());
+    assert(!weak.lock());
+
+    return 0;
+}
@@ -0,0 +1,61 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+// <execution>
+// UNSUPPORTED: c++98, c++03, c++11, c++14
+
+// template<class ExecutionPolicy, class ForwardIterator1, class ForwardIterator2,
+//          class UnaryOperation>
+//   ForwardIterator2 transform(ExecutionPolicy&& exec,
+//                              ForwardIterator1 first, ForwardIterator1 last,
+//                              ForwardIterator2 result, UnaryOperation op);
+
+#include <execution>
+#include <algorithm>
+#include <cassert>
+#include <vector>
+
+#include "test_macros.h"
+#include "test_iterators.h"
+
+template <class InIter, class OutIter, class Policy>
+void test(Policy&& policy, int n)
+{
+    std::vector<int> in(n);
+    for (int i = 0; i < n; ++i)
+        in[i] = i;
+    std::vector<long> out(n + 1, -1);
+    OutIter r = std::transform(policy, InIter(in.data()), InIter(in.data() + n),
+                               OutIter(out.data()),
+                               [](int x) { return 3L * x + 1; });
+    assert(base(r) == out.data() + n);
+    for (int i = 0; i < n; ++i)
+        assert(out[i] == 3L * i + 1);
+    assert(out[n] == -1);
+}
+
+template <class Policy>
+void test_policy(Policy&& policy)
+{
+    const int sizes[] = {0, 1, 2, 1000, 4099, 100003};
+    for (int n : sizes) {
+        test<forward_iterator<const int*>, forward_iterator<long*> >(policy, n);
+        test<random_access_iterator<const int*>, forward_iterator<long*> >(policy, n);
+        test<random_access_iterator<const int*>, random_access_iterator<long*> >(policy, n);
+        test<const int*, long*>(policy, n);
+    }
+}
+
+int main(int, char**)
+{
+    test_policy(std::execution::seq);
+    test_policy(std::execution::par);
+    test_policy(std::execution::par_unseq);
+
+  return 0;
+}
@@ -0,0 +1,61 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+// <execution>
+// UNSUPPORTED: c++98, c++03, c++11, c++14
+
+// template<class ExecutionPolicy, class ForwardIterator, class Function>
+//   void for_each(ExecutionPolicy&& exec,
+//                 ForwardIterator first, ForwardIterator last, Function f);
+
+#include <execution>
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <vector>
+
+#include "test_macros.h"
+#include "test_iterators.h"
+
+void increment(int& x) { ++x; }
+
+template <class Iter, class Policy>
+void test(Policy&& policy, int n)
+{
+    std::vector<int> v(n, 0);
+    std::atomic<int> calls(0);
+    std::for_each(policy, Iter(v.data()), Iter(v.data() + n),
+                  [&calls](int& x) { ++x; ++calls; });
+    assert(calls == n);
+    assert(std::count(v.begin(), v.end(), 1) == n);
+}
+
+template <class Policy>
+void test_policy(Policy&& policy)
+{
+    const int sizes[] = {0, 1, 2, 1000, 4099, 100003};
+    for (int n : sizes) {
+        test<forward_iterator<int*> >(policy, n);
+        test<random_access_iterator<int*> >(policy, n);
+        test<int*>(policy, n);
+    }
+}
+
+int main(int, char**)
+{
+    test_policy(std::execution::seq);
+    test_policy(std::execution::par);
+    test_policy(std::execution::par_unseq);
+
+    static_assert(std::is_same_v<decltype(std::for_each(std::execution::par,
+                                                        (int*)0, (int*)0,
+                                                        &increment)),
+                                 void>, "");
+
+  return 0;
+}
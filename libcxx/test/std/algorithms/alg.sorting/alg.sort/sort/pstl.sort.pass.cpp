@@ -0,0 +1,90 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+// <execution>
+// UNSUPPORTED: c++98, c++03, c++11, c++14
+
+// template<class ExecutionPolicy, class RandomAccessIterator>
+//   void sort(ExecutionPolicy&& exec,
+//             RandomAccessIterator first, RandomAccessIterator last);
+// template<class ExecutionPolicy, class RandomAccessIterator, class Compare>
+//   void sort(ExecutionPolicy&& exec,
+//             RandomAccessIterator first, RandomAccessIterator last,
+//             Compare comp);
+
+#include <execution>
+#include <algorithm>
+#include <cassert>
+#include <functional>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "test_macros.h"
+#include "test_iterators.h"
+
+std::mt19937 randomness;
+
+template <class Iter, class Policy>
+void test(Policy&& policy, int n)
+{
+    std::vector<int> v(n);
+    for (int i = 0; i < n; ++i)
+        v[i] = i % 1000;
+    std::shuffle(v.begin(), v.end(), randomness);
+    std::vector<int> expected = v;
+    std::sort(expected.begin(), expected.end());
+
+    std::sort(policy, Iter(v.data()), Iter(v.data() + n));
+    assert(v == expected);
+
+    std::shuffle(v.begin(), v.end(), randomness);
+    std::sort(policy, Iter(v.data()), Iter(v.data() + n), std::greater<int>());
+    assert(std::equal(v.begin(), v.end(), expected.rbegin()));
+}
+
+// Elements which only compare equal on their key, to check that no element is
+// lost or duplicated, and that move-only types are supported.
+template <class Policy>
+void test_move_only(Policy&& policy, int n)
+{
+    std::vector<std::unique_ptr<int> > v;
+    for (int i = 0; i < n; ++i)
+        v.push_back(std::unique_ptr<int>(new int(i)));
+    std::shuffle(v.begin(), v.end(), randomness);
+    std::sort(policy, v.begin(), v.end(),
+              [](const std::unique_ptr<int>& x, const std::unique_ptr<int>& y) {
+                  return *x / 10 < *y / 10;
+              });
+    std::vector<bool> seen(n, false);
+    for (int i = 0; i < n; ++i) {
+        assert(*v[i] / 10 == i / 10);
+        assert(!seen[*v[i]]);
+        seen[*v[i]] = true;
+    }
+}
+
+template <class Policy>
+void test_policy(Policy&& policy)
+{
+    const int sizes[] = {0, 1, 2, 1000, 4099, 100003};
+    for (int n : sizes) {
+        test<random_access_iterator<int*> >(policy, n);
+        test<int*>(policy, n);
+        test_move_only(policy, n);
+    }
+}
+
+int main(int, char**)
+{
+    test_policy(std::execution::seq);
+    test_policy(std::execution::par);
+    test_policy(std::execution::par_unseq);
+
+  return 0;
+}
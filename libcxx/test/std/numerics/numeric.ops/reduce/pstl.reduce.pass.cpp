@@ -0,0 +1,82 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+// <execution>
+// UNSUPPORTED: c++98, c++03, c++11, c++14
+
+// template<class ExecutionPolicy, class ForwardIterator>
+//   typename iterator_traits<ForwardIterator>::value_type
+//     reduce(ExecutionPolicy&& exec,
+//            ForwardIterator first, ForwardIterator last);
+// template<class ExecutionPolicy, class ForwardIterator, class T>
+//   T reduce(ExecutionPolicy&& exec,
+//            ForwardIterator first, ForwardIterator last, T init);
+// template<class ExecutionPolicy, class ForwardIterator, class T, class BinaryOperation>
+//   T reduce(ExecutionPolicy&& exec,
+//            ForwardIterator first, ForwardIterator last, T init,
+//            BinaryOperation binary_op);
+
+#include <execution>
+#include <numeric>
+#include <algorithm>
+#include <cassert>
+#include <vector>
+
+#include "test_macros.h"
+#include "test_iterators.h"
+
+// A type with no default constructor, as the partial sums must not need one.
+struct Sum {
+    Sum(long v) : value(v) {}
+    long value;
+};
+
+template <class Iter, class Policy>
+void test(Policy&& policy, int n)
+{
+    std::vector<int> v(n);
+    for (int i = 0; i < n; ++i)
+        v[i] = i % 7;
+    long expected = 0;
+    double max = 1.0;
+    for (int i = 0; i < n; ++i) {
+        expected += i % 7;
+        max = std::max(max, double(i % 7));
+    }
+
+    Iter first(v.data()), last(v.data() + n);
+    static_assert(std::is_same_v<decltype(std::reduce(policy, first, last)), int>, "");
+    assert(std::reduce(policy, first, last) == expected);
+    assert(std::reduce(policy, first, last, 10L) == expected + 10);
+    Sum s = std::reduce(policy, first, last, Sum(5),
+                        [](const Sum& x, const Sum& y) { return Sum(x.value + y.value); });
+    assert(s.value == expected + 5);
+    assert(std::reduce(policy, first, last, 1.0,
+                       [](double x, double y) { return x > y ? x : y; })
+           == max);
+}
+
+template <class Policy>
+void test_policy(Policy&& policy)
+{
+    const int sizes[] = {0, 1, 2, 1000, 4099, 100003};
+    for (int n : sizes) {
+        test<forward_iterator<const int*> >(policy, n);
+        test<random_access_iterator<const int*> >(policy, n);
+        test<const int*>(policy, n);
+    }
+}
+
+int main(int, char**)
+{
+    test_policy(std::execution::seq);
+    test_policy(std::execution::par);
+    test_policy(std::execution::par_unseq);
+
+  return 0;
+}
@@ -0,0 +1,87 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+// <execution>
+// UNSUPPORTED: c++98, c++03, c++11, c++14
+
+// template<class ExecutionPolicy, class ForwardIterator1, class ForwardIterator2, class T>
+//   T transform_reduce(ExecutionPolicy&& exec,
+//                      ForwardIterator1 first1, ForwardIterator1 last1,
+//                      ForwardIterator2 first2, T init);
+// template<class ExecutionPolicy, class ForwardIterator1, class ForwardIterator2, class T,
+//          class BinaryOperation1, class BinaryOperation2>
+//   T transform_reduce(ExecutionPolicy&& exec,
+//                      ForwardIterator1 first1, ForwardIterator1 last1,
+//                      ForwardIterator2 first2, T init,
+//                      BinaryOperation1 binary_op1, BinaryOperation2 binary_op2);
+// template<class ExecutionPolicy, class ForwardIterator, class T,
+//          class BinaryOperation, class UnaryOperation>
+//   T transform_reduce(ExecutionPolicy&& exec,
+//                      ForwardIterator first, ForwardIterator last, T init,
+//                      BinaryOperation binary_op, UnaryOperation unary_op);
+
+#include <execution>
+#include <numeric>
+#include <algorithm>
+#include <cassert>
+#include <functional>
+#include <vector>
+
+#include "test_macros.h"
+#include "test_iterators.h"
+
+template <class Iter1, class Iter2, class Policy>
+void test(Policy&& policy, int n)
+{
+    std::vector<int> a(n), b(n);
+    for (int i = 0; i < n; ++i) {
+        a[i] = i % 5;
+        b[i] = i % 3;
+    }
+    long long dot = 0, sq = 0;
+    int max_sum = 0;
+    for (int i = 0; i < n; ++i) {
+        dot += a[i] * b[i];
+        sq += a[i] * a[i];
+        max_sum = std::max(max_sum, a[i] + b[i]);
+    }
+
+    Iter1 first1(a.data()), last1(a.data() + n);
+    Iter2 first2(b.data());
+    assert(std::transform_reduce(policy, first1, last1, first2, 0LL) == dot);
+    assert(std::transform_reduce(policy, first1, last1, first2, 3LL,
+                                 std::plus<>(), std::multiplies<>()) == dot + 3);
+    assert(std::transform_reduce(policy, first1, last1, first2, 0,
+                                 [](int x, int y) { return x > y ? x : y; },
+                                 [](int x, int y) { return x + y; })
+           == max_sum);
+    assert(std::transform_reduce(policy, first1, last1, 7LL, std::plus<>(),
+                                 [](int x) { return (long long)x * x; }) == sq + 7);
+}
+
+template <class Policy>
+void test_policy(Policy&& policy)
+{
+    const int sizes[] = {0, 1, 2, 1000, 4099, 100003};
+    for (int n : sizes) {
+        test<forward_iterator<const int*>, forward_iterator<const int*> >(policy, n);
+        test<random_access_iterator<const int*>, forward_iterator<const int*> >(policy, n);
+        test<random_access_iterator<const int*>,
+             random_access_iterator<const int*> >(policy, n);
+        test<const int*, const int*>(policy, n);
+    }
+}
+
+int main(int, char**)
+{
+    test_policy(std::execution::seq);
+    test_policy(std::execution::par);
+    test_policy(std::execution::par_unseq);
+
+  return 0;
+}
@@ -0,0 +1,136 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+// UNSUPPORTED: c++98, c++03
+// UNSUPPORTED: !libc++ && c++11
+// UNSUPPORTED: !libc++ && c++14
+
+// XFAIL: with_system_cxx_lib=macosx10.14
+// XFAIL: with_system_cxx_lib=macosx10.13
+// XFAIL: with_system_cxx_lib=macosx10.12
+// XFAIL: with_system_cxx_lib=macosx10.11
+// XFAIL: with_system_cxx_lib=macosx10.10
+// XFAIL: with_system_cxx_lib=macosx10.9
+// XFAIL: with_system_cxx_lib=macosx10.8
+// XFAIL: with_system_cxx_lib=macosx10.7
+// <charconv>
+
+// from_chars_result from_chars(const char* first, const char* last,
+//                              Floating& value,
+//                              chars_format fmt = chars_format::general)
+
+#include <charconv>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+#include "test_macros.h"
+
+template <typename T>
+void test(const char* s, T expected, std::size_t used,
+          std::chars_format fmt = std::chars_format::general)
+{
+    T value = 42;
+    std::from_chars_result r = std::from_chars(s, s + std::strlen(s), value, fmt);
+    assert(r.ec == std::errc());
+    assert(r.ptr == s + used);
+    if (expected != expected)
+        assert(value != value);
+    else
+    {
+        assert(value == expected);
+        assert(std::signbit(value) == std::signbit(expected));
+    }
+}
+
+template <typename T>
+void test_error(const char* s, std::errc ec, std::size_t used,
+                std::chars_format fmt = std::chars_format::general)
+{
+    T value = 42;
+    std::from_chars_result r = std::from_chars(s, s + std::strlen(s), value, fmt);
+    assert(r.ec == ec);
+    assert(r.ptr == s + used);
+    assert(value == 42);
+}
+
+template <typename T>
+void test_all()
+{
+    const T inf = std::numeric_limits<T>::infinity();
+    const T nan = std::numeric_limits<T>::quiet_NaN();
+    const std::chars_format fixed = std::chars_format::fixed;
+    const std::chars_format scientific = std::chars_format::scientific;
+    const std::chars_format hex = std::chars_format::hex;
+
+    test<T>("0", 0, 1);
+    test<T>("-0", -T(0), 2);
+    test<T>("1.5", T(1.5), 3);
+    test<T>("-1.5x", T(-1.5), 4);
+    test<T>(".5", T(0.5), 2);
+    test<T>("5.", T(5), 2);
+    test<T>("0.25e1", T(2.5), 6);
+    test<T>("25e-1", T(2.5), 5);
+    test<T>("1E+2", T(100), 4);
+    test<T>("1e", T(1), 1);
+    test<T>("1e+", T(1), 1);
+    test<T>("000000000000000000000000001", T(1), 27);
+    test<T>("inf", inf, 3);
+    test<T>("-INFINITY", -inf, 9);
+    test<T>("infinit", inf, 3);
+    test<T>("nan", nan, 3);
+    test<T>("-NaN(abc_1)", nan, 11);
+    test<T>("nan(", nan, 3);
+
+    test<T>("1e5", T(1), 1, fixed);
+    test<T>("1.5", T(1.5), 3, fixed);
+    test<T>("1e5", T(100000), 3, scientific);
+    test<T>("1.8p3", T(12), 5, hex);
+    test<T>("-a.8p-1", T(-5.25), 7, hex);
+    test<T>("1.8", T(1.5), 3, hex);
+    test<T>("0x1p3", T(0), 1, hex);
+
+    test_error<T>("", std::errc::invalid_argument, 0);
+    test_error<T>("-", std::errc::invalid_argument, 0);
+    test_error<T>(".", std::errc::invalid_argument, 0);
+    test_error<T>(" 1", std::errc::invalid_argument, 0);
+    test_error<T>("+1", std::errc::invalid_argument, 0);
+    test_error<T>("e5", std::errc::invalid_argument, 0);
+    test_error<T>("15", std::errc::invalid_argument, 0, scientific);
+    test_error<T>("1e", std::errc::invalid_argument, 0, scientific);
+    test_error<T>("p3", std::errc::invalid_argument, 0, hex);
+
+    test_error<T>("1e100000", std::errc::result_out_of_range, 8);
+    test_error<T>("-1e100000", std::errc::result_out_of_range, 9);
+    test_error<T>("1e-100000", std::errc::result_out_of_range, 9);
+}
+
+int main(int, char**)
+{
+    test_all<float>();
+    test_all<double>();
+    test_all<long double>();
+
+    // The closest value, not the one of the correctly rounded 19 first
+    // digits.
+    test<double>("9007199254740993", 9007199254740992.0, 16);
+    test<double>("9007199254740993.0000000000001", 9007199254740994.0, 30);
+    test<double>("0.1", 0.1, 3);
+    test<double>("123456789012345678901234567890", 1.2345678901234568e+29, 30);
+    test<double>("2.2250738585072011e-308", 2.2250738585072011e-308, 23);
+    test<double>("4.9406564584124654e-324", 5e-324, 23);
+    test<double>("1.7976931348623157e308", 1.7976931348623157e308, 22);
+    test<float>("16777217", 16777216.0f, 8);
+    test<float>("0.1", 0.1f, 3);
+    test<float>("3.4028235e38", 3.4028235e38f, 12);
+    test_error<float>("1e39", std::errc::result_out_of_range, 4);
+    test_error<double>("1e309", std::errc::result_out_of_range, 5);
+
+  return 0;
+}
@@ -0,0 +1,185 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+// UNSUPPORTED: c++98, c++03
+// UNSUPPORTED: !libc++ && c++11
+// UNSUPPORTED: !libc++ && c++14
+
+// XFAIL: with_system_cxx_lib=macosx10.14
+// XFAIL: with_system_cxx_lib=macosx10.13
+// XFAIL: with_system_cxx_lib=macosx10.12
+// XFAIL: with_system_cxx_lib=macosx10.11
+// XFAIL: with_system_cxx_lib=macosx10.10
+// XFAIL: with_system_cxx_lib=macosx10.9
+// XFAIL: with_system_cxx_lib=macosx10.8
+// XFAIL: with_system_cxx_lib=macosx10.7
+// <charconv>
+
+// to_chars_result to_chars(char* first, char* last, Floating value);
+// to_chars_result to_chars(char* first, char* last, Floating value,
+//                          chars_format fmt);
+// to_chars_result to_chars(char* first, char* last, Floating value,
+//                          chars_format fmt, int precision);
+
+#include <charconv>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+
+#include "test_macros.h"
+
+template <typename T>
+void test(T value, const char* expected)
+{
+    char buf[400];
+    std::to_chars_result r = std::to_chars(buf, buf + sizeof(buf), value);
+    assert(r.ec == std::errc());
+    std::size_t len = std::strlen(expected);
+    assert(r.ptr == buf + len);
+    assert(std::memcmp(buf, expected, len) == 0);
+
+    // One character less is too small.
+    r = std::to_chars(buf, buf + len - 1, value);
+    assert(r.ec == std::errc::value_too_large);
+    assert(r.ptr == buf + len - 1);
+}
+
+template <typename T>
+void test(T value, std::chars_format fmt, const char* expected)
+{
+    char buf[400];
+    std::to_chars_result r = std::to_chars(buf, buf + sizeof(buf), value, fmt);
+    assert(r.ec == std::errc());
+    std::size_t len = std::strlen(expected);
+    assert(r.ptr == buf + len);
+    assert(std::memcmp(buf, expected, len) == 0);
+
+    r = std::to_chars(buf, buf + len - 1, value, fmt);
+    assert(r.ec == std::errc::value_too_large);
+}
+
+template <typename T>
+void test(T value, std::chars_format fmt, int precision, const char* expected)
+{
+    char buf[400];
+    std::to_chars_result r =
+        std::to_chars(buf, buf + sizeof(buf), value, fmt, precision);
+    assert(r.ec == std::errc());
+    std::size_t len = std::strlen(expected);
+    assert(r.ptr == buf + len);
+    assert(std::memcmp(buf, expected, len) == 0);
+
+    r = std::to_chars(buf, buf + len, value, fmt, precision);
+    assert(r.ec == std::errc());
+    assert(r.ptr == buf + len);
+    r = std::to_chars(buf, buf + len - 1, value, fmt, precision);
+    assert(r.ec == std::errc::value_too_large);
+}
+
+// The shortest characters read back as the same value.
+template <typename T, typename Bits>
+void test_round_trip()
+{
+    std::uint64_t seed = 1;
+    for (int i = 0; i < 10000; ++i)
+    {
+        seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+        Bits bits = static_cast<Bits>(seed >> (64 - 8 * sizeof(Bits)));
+        T value;
+        std::memcpy(&value, &bits, sizeof(value));
+        if (value != value || value == std::numeric_limits<T>::infinity() ||
+            value == -std::numeric_limits<T>::infinity())
+            continue;
+
+        char buf[400];
+        const std::chars_format fmts[] = {
+            std::chars_format::scientific, std::chars_format::fixed,
+            std::chars_format::general, std::chars_format::hex};
+        for (int f = -1; f < 4; ++f)
+        {
+            std::to_chars_result r =
+                f < 0 ? std::to_chars(buf, buf + sizeof(buf), value)
+                      : std::to_chars(buf, buf + sizeof(buf), value, fmts[f]);
+            assert(r.ec == std::errc());
+            T back;
+            std::from_chars_result fr = std::from_chars(
+                buf, r.ptr, back,
+                f == 3 ? std::chars_format::hex : std::chars_format::general);
+            assert(fr.ec == std::errc());
+            assert(fr.ptr == r.ptr);
+            assert(std::memcmp(&back, &value, sizeof(value)) == 0);
+        }
+    }
+}
+
+int main(int, char**)
+{
+    test(0.0, "0");
+    test(-0.0, "-0");
+    test(1.0, "1");
+    test(0.1, "0.1");
+    test(0.3, "0.3");
+    test(-1.5, "-1.5");
+    test(123456.0, "123456");
+    test(1e22, "1e+22");
+    test(1e23, "1e+23");
+    test(1e-7, "1e-07");
+    test(0.001, "0.001");
+    test(5e-324, "5e-324");
+    test(2.2250738585072014e-308, "2.2250738585072014e-308");
+    test(1.7976931348623157e308, "1.7976931348623157e+308");
+    test(std::numeric_limits<double>::infinity(), "inf");
+    test(-std::numeric_limits<double>::infinity(), "-inf");
+    test(std::numeric_limits<double>::quiet_NaN(), "nan");
+
+    test(1.0f, "1");
+    test(0.1f, "0.1");
+    test(3.4028235e38f, "3.4028235e+38");
+    test(1e-45f, "1e-45");
+    test(1.1754944e-38f, "1.1754944e-38");
+    test(16777216.0f, "16777216");
+
+    test(1e20, std::chars_format::fixed, "100000000000000000000");
+    test(1e23, std::chars_format::fixed, "99999999999999991611392");
+    test(-1e23, std::chars_format::fixed, "-99999999999999991611392");
+    test(1.5e-5, std::chars_format::fixed, "0.000015");
+    test(150.0, std::chars_format::scientific, "1.5e+02");
+    test(0.0, std::chars_format::scientific, "0e+00");
+    test(123456.0, std::chars_format::general, "123456");
+    test(1234567.0, std::chars_format::general, "1.234567e+06");
+    test(0.0001, std::chars_format::general, "0.0001");
+    test(0.00001, std::chars_format::general, "1e-05");
+    test(1.0, std::chars_format::hex, "1p+0");
+    test(0.1, std::chars_format::hex, "1.999999999999ap-4");
+    test(-0.5, std::chars_format::hex, "-1p-1");
+    test(5e-324, std::chars_format::hex, "0.0000000000001p-1022");
+    test(0.1f, std::chars_format::hex, "1.99999ap-4");
+    test(1e-45f, std::chars_format::hex, "0.000002p-126");
+
+    test(3.14159, std::chars_format::fixed, 2, "3.14");
+    test(3.14159, std::chars_format::scientific, 3, "3.142e+00");
+    test(3.14159, std::chars_format::general, 3, "3.14");
+    test(3.14159, std::chars_format::hex, 3, "1.922p+1");
+    test(-3.14159, std::chars_format::hex, 3, "-1.922p+1");
+    test(0.5f, std::chars_format::fixed, 0, "0");
+    test(1.0, std::chars_format::fixed, -1, "1.000000");
+    test(1e100, std::chars_format::fixed, 0,
+         "1000000000000000015902891109759918046836080856394528138978132755774"
+         "7838772170381060813469985856815104");
+    test(0.1L, std::chars_format::fixed, 3, "0.100");
+
+    test(0.1L, "0.1");
+    test(-2.5L, "-2.5");
+    test(1e300L, std::chars_format::scientific, "1e+300");
+
+    test_round_trip<double, std::uint64_t>();
+    test_round_trip<float, std::uint32_t>();
+
+  return 0;
+}
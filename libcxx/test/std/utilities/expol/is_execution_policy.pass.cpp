@@ -0,0 +1,56 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+// <execution>
+// UNSUPPORTED: c++98, c++03, c++11, c++14
+
+// template<class T> struct is_execution_policy;
+// template<class T> inline constexpr bool is_execution_policy_v;
+//
+// namespace execution {
+//   inline constexpr sequenced_policy            seq{unspecified};
+//   inline constexpr parallel_policy             par{unspecified};
+//   inline constexpr parallel_unsequenced_policy par_unseq{unspecified};
+// }
+
+#include <execution>
+#include <type_traits>
+
+#include "test_macros.h"
+
+template <class T>
+void test_policy(const T&)
+{
+    static_assert(std::is_execution_policy<T>::value, "");
+    static_assert(std::is_execution_policy_v<T>, "");
+    static_assert(!std::is_execution_policy_v<T*>, "");
+    static_assert(!std::is_default_constructible<T>::value, "");
+    static_assert(!std::is_copy_constructible<T>::value, "");
+    static_assert(!std::is_copy_assignable<T>::value, "");
+}
+
+int main(int, char**)
+{
+    test_policy(std::execution::seq);
+    test_policy(std::execution::par);
+    test_policy(std::execution::par_unseq);
+
+    static_assert(std::is_same_v<decltype(std::execution::seq),
+                                 const std::execution::sequenced_policy>, "");
+    static_assert(std::is_same_v<decltype(std::execution::par),
+                                 const std::execution::parallel_policy>, "");
+    static_assert(std::is_same_v<decltype(std::execution::par_unseq),
+                                 const std::execution::parallel_unsequenced_policy>, "");
+
+    static_assert(!std::is_execution_policy_v<int>, "");
+    static_assert(std::is_base_of_v<std::false_type, std::is_execution_policy<int> >, "");
+    static_assert(std::is_base_of_v<std::true_type,
+                      std::is_execution_policy<std::execution::parallel_policy> >, "");
+
+  return 0;
+}
@@ -9,6 +9,7 @@
 #ifndef LLD_COFF_DEBUGTYPES_H
 #define LLD_COFF_DEBUGTYPES_H
 
+#include "llvm/DebugInfo/CodeView/TypeHashing.h"
 #include "llvm/Support/Error.h"
 #include "llvm/Support/MemoryBuffer.h"
 
@@ -36,6 +37,11 @@ public:
 
   const TpiKind Kind;
   const ObjFile *File;
+
+  // Global hashes of the type records of this source. They are computed in
+  // parallel before type merging if the object file has no usable .debug$H
+  // section, and are released once the types are merged.
+  std::vector<llvm::codeview::GloballyHashedType> GHashes;
 };
 
 TpiSource *makeTpiSource(const ObjFile *F);
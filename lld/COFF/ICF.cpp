@@ -263,7 +263,7 @@ void ICF::run(ArrayRef<Chunk *> Vec) {
 
   // Initially, we use hash values to partition sections.
   parallelForEach(Chunks, [&](SectionChunk *SC) {
-    SC->Class[0] = xxHash64(SC->getContents());
+    SC->Class[0] = xxh3_64bits(SC->getContents());
   });
 
   // Combine the hashes of the sections referenced by each section into its
@@ -71,6 +71,7 @@ static ExitOnError ExitOnErr;
 static Timer TotalPdbLinkTimer("PDB Emission (Cumulative)", Timer::root());
 
 static Timer AddObjectsTimer("Add Objects", TotalPdbLinkTimer);
+static Timer TypeHashingTimer("Type Hashing", AddObjectsTimer);
 static Timer TypeMergingTimer("Type Merging", AddObjectsTimer);
 static Timer SymbolMergingTimer("Symbol Merging", AddObjectsTimer);
 static Timer GlobalsLayoutTimer("Globals Stream Layout", TotalPdbLinkTimer);
@@ -104,6 +105,11 @@ public:
   /// Link info for each import file in the symbol table into the PDB.
   void addImportFilesToPDB(ArrayRef<OutputSection *> OutputSections);
 
+  /// Compute global type hashes of all object files that don't have a
+  /// usable .debug$H section and of all type server PDBs. Only used with
+  /// /DEBUG:GHASH.
+  void computeGlobalHashes();
+
   /// Link CodeView from a single object file into the target (output) PDB.
   /// When a precompiled headers object is linked, its TPI map might be provided
   /// externally.
@@ -180,6 +186,14 @@ private:
   /// Type index mappings of type server PDBs that we've loaded so far.
   std::map<codeview::GUID, CVIndexMap> TypeServerIndexMappings;
 
+  /// Global hashes of the TPI and IPI streams of type server PDBs, computed
+  /// by computeGlobalHashes() before type merging.
+  struct TypeServerHashes {
+    std::vector<GloballyHashedType> Tpi;
+    std::vector<GloballyHashedType> Ipi;
+  };
+  std::map<codeview::GUID, TypeServerHashes> TypeServerGHashes;
+
   /// Type index mappings of precompiled objects type map that we've loaded so
   /// far.
   std::map<uint32_t, CVIndexMap> PrecompTypeIndexMappings;
@@ -393,10 +407,12 @@ PDBLinker::mergeDebugT(ObjFile *File, CVIndexMap *ObjectIndexMap) {
   if (Config->DebugGHashes) {
     ArrayRef<GloballyHashedType> Hashes;
     std::vector<GloballyHashedType> OwnedHashes;
-    if (Optional<ArrayRef<uint8_t>> DebugH = getDebugH(File))
+    if (Optional<ArrayRef<uint8_t>> DebugH = getDebugH(File)) {
       Hashes = getHashesFromDebugH(*DebugH);
-    else {
-      OwnedHashes = GloballyHashedType::hashTypes(Types);
+    } else {
+      OwnedHashes = std::move(File->DebugTypesObj->GHashes);
+      if (OwnedHashes.empty())
+        OwnedHashes = GloballyHashedType::hashTypes(Types);
       Hashes = OwnedHashes;
     }
 
@@ -447,8 +463,19 @@ Expected<const CVIndexMap &> PDBLinker::maybeMergeTypeServerPDB(ObjFile *File) {
     // PDB we have to synthesize global hashes.  To do this, we first synthesize
     // global hashes for the TPI stream, since it is independent, then we
     // synthesize hashes for the IPI stream, using the hashes for the TPI stream
-    // as inputs.
-    auto TpiHashes = GloballyHashedType::hashTypes(ExpectedTpi->typeArray());
+    // as inputs. These are usually precomputed by computeGlobalHashes().
+    std::vector<GloballyHashedType> TpiHashes;
+    std::vector<GloballyHashedType> IpiHashes;
+    auto HashIt = TypeServerGHashes.find(Info.getGuid());
+    if (HashIt != TypeServerGHashes.end()) {
+      TpiHashes = std::move(HashIt->second.Tpi);
+      IpiHashes = std::move(HashIt->second.Ipi);
+    } else {
+      TpiHashes = GloballyHashedType::hashTypes(ExpectedTpi->typeArray());
+      if (MaybeIpi)
+        IpiHashes = GloballyHashedType::hashIds(MaybeIpi->typeArray(),
+                                                TpiHashes);
+    }
     Optional<uint32_t> EndPrecomp;
     // Merge TPI first, because the IPI stream will reference type indices.
     if (auto Err =
@@ -458,8 +485,6 @@ Expected<const CVIndexMap &> PDBLinker::maybeMergeTypeServerPDB(ObjFile *File) {
 
     // Merge IPI.
     if (MaybeIpi) {
-      auto IpiHashes =
-          GloballyHashedType::hashIds(MaybeIpi->typeArray(), TpiHashes);
       if (auto Err =
               mergeIdRecords(TMerger.GlobalIDTable, IndexMap.TPIMap,
                              IndexMap.IPIMap, MaybeIpi->typeArray(), IpiHashes))
@@ -1275,6 +1300,73 @@ static PublicSym32 createPublic(Defined *Def) {
   return Pub;
 }
 
+void PDBLinker::computeGlobalHashes() {
+  ScopedTimer T(TypeHashingTimer);
+
+  // Type records have to be merged in command line order to get
+  // deterministic type indices, but hashing the records of each object file
+  // is independent of other files and is the bulk of the cost of merging
+  // types of objects without .debug$H. So do that in parallel first.
+  parallelForEach(ObjFile::Instances, [](ObjFile *File) {
+    TpiSource *Source = File->DebugTypesObj;
+    if (!Source || Source->Kind == TpiSource::UsingPDB || getDebugH(File))
+      return;
+
+    // Objects using precompiled headers start with an LF_PRECOMP record,
+    // which is not merged. See mergeDebugT.
+    CVTypeArray Types = *File->DebugTypes;
+    if (Source->Kind == TpiSource::UsingPCH) {
+      if (Types.begin() == Types.end())
+        return;
+      Types.setUnderlyingStream(Types.getUnderlyingStream().drop_front(
+          Types.begin()->RecordData.size()));
+    }
+    Source->GHashes = GloballyHashedType::hashTypes(Types);
+  });
+
+  // PDBs don't store global hashes, so they have to be synthesized for type
+  // servers too. A type server is usually shared by many objects, so find
+  // the unique ones first.
+  std::vector<std::pair<pdb::PDBFile *, TypeServerHashes *>> TypeServers;
+  for (ObjFile *File : ObjFile::Instances) {
+    if (!File->DebugTypesObj ||
+        File->DebugTypesObj->Kind != TpiSource::UsingPDB)
+      continue;
+    Expected<pdb::NativeSession *> Session = findTypeServerSource(File);
+    if (!Session) {
+      // The error is reported when the object file is merged.
+      consumeError(Session.takeError());
+      continue;
+    }
+    pdb::PDBFile &PDBFile = Session.get()->getPDBFile();
+    pdb::InfoStream &Info = cantFail(PDBFile.getPDBInfoStream());
+    auto It = TypeServerGHashes.emplace(Info.getGuid(), TypeServerHashes());
+    if (It.second)
+      TypeServers.push_back({&PDBFile, &It.first->second});
+  }
+
+  parallelForEach(TypeServers,
+                  [](std::pair<pdb::PDBFile *, TypeServerHashes *> &P) {
+    // Stream errors are reported by maybeMergeTypeServerPDB.
+    Expected<pdb::TpiStream &> Tpi = P.first->getPDBTpiStream();
+    if (!Tpi) {
+      consumeError(Tpi.takeError());
+      return;
+    }
+    P.second->Tpi = GloballyHashedType::hashTypes(Tpi->typeArray());
+
+    if (!P.first->hasPDBIpiStream())
+      return;
+    Expected<pdb::TpiStream &> Ipi = P.first->getPDBIpiStream();
+    if (!Ipi) {
+      consumeError(Ipi.takeError());
+      return;
+    }
+    P.second->Ipi =
+        GloballyHashedType::hashIds(Ipi->typeArray(), P.second->Tpi);
+  });
+}
+
 // Add all object files to the PDB. Merge .debug$T sections into IpiData and
 // TpiData.
 void PDBLinker::addObjectsToPDB() {
@@ -1282,6 +1374,9 @@ void PDBLinker::addObjectsToPDB() {
 
   createModuleDBI(Builder);
 
+  if (Config->DebugGHashes)
+    computeGlobalHashes();
+
   for (ObjFile *File : ObjFile::Instances)
     addObjFile(File);
 
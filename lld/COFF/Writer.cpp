@@ -113,7 +113,7 @@ public:
       // "the timestamp field is really a hash", or a 4-byte size field
       // followed by that many bytes containing a longer hash (with the
       // lowest 4 bytes usually being the timestamp in little-endian order).
-      // Consider storing the full 8 bytes computed by xxHash64 here.
+      // Consider storing the full 8 bytes computed by xxh3_64bits here.
       fillEntry(D, COFF::IMAGE_DEBUG_TYPE_REPRO, 0, 0, 0);
     }
   }
@@ -1750,7 +1750,7 @@ void Writer::writeBuildId() {
       Config->MinGW && Config->Debug && Config->PDBPath.empty();
 
   if (Config->Repro || GenerateSyntheticBuildId)
-    Hash = xxHash64(OutputFileData);
+    Hash = xxh3_64bits(OutputFileData);
 
   if (Config->Repro)
     Timestamp = static_cast<uint32_t>(Hash);
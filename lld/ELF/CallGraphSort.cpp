@@ -82,6 +82,7 @@ private:
   std::vector<const InputSectionBase *> Sections;
 
   void groupClusters();
+  void logHotTextSize() const;
 };
 
 // Maximum ammount the combined cluster density can be worse than the original
@@ -214,6 +215,24 @@ void CallGraphSort::groupClusters() {
   });
 }
 
+// Reports the size of the code covered by the profile, that is, the
+// expected hot text footprint after sorting. Sections are laid out in
+// cluster order, so the number of pages the clusters span gives an
+// estimate of the i-TLB entries needed to cover the hot code.
+void CallGraphSort::logHotTextSize() const {
+  uint64_t Size = 0;
+  for (const Cluster &C : Clusters)
+    for (int SecIndex : C.Sections)
+      Size = alignTo(Size, Sections[SecIndex]->Alignment) +
+             Sections[SecIndex]->getSize();
+
+  uint64_t SmallPages = divideCeil(Size, 4096);
+  uint64_t HugePages = divideCeil(Size, 2 * 1024 * 1024);
+  log("call graph profile: " + Twine(Clusters.size()) + " clusters, " +
+      Twine(Size) + " bytes of hot text (" + Twine(SmallPages) +
+      " 4 KiB pages, " + Twine(HugePages) + " 2 MiB pages)");
+}
+
 DenseMap<const InputSectionBase *, int> CallGraphSort::run() {
   groupClusters();
 
@@ -225,6 +244,9 @@ DenseMap<const InputSectionBase *, int> CallGraphSort::run() {
     for (int SecIndex : C.Sections)
       OrderMap[Sections[SecIndex]] = CurOrder++;
 
+  if (errorHandler().Verbose)
+    logHotTextSize();
+
   if (!Config->PrintSymbolOrder.empty()) {
     std::error_code EC;
     raw_fd_ostream OS(Config->PrintSymbolOrder, EC, sys::fs::F_None);
@@ -17,6 +17,7 @@
 #include "llvm/Support/CachePruning.h"
 #include "llvm/Support/CodeGen.h"
 #include "llvm/Support/Endian.h"
+#include "llvm/Support/Threading.h"
 #include <atomic>
 #include <vector>
 
@@ -107,6 +108,7 @@ struct Configuration {
   llvm::StringRef Sysroot;
   llvm::StringRef ThinLTOCacheDir;
   llvm::StringRef ThinLTOIndexOnlyArg;
+  llvm::StringRef TimeTraceFile;
   std::pair<llvm::StringRef, llvm::StringRef> ThinLTOObjectSuffixReplace;
   std::pair<llvm::StringRef, llvm::StringRef> ThinLTOPrefixReplace;
   std::string Rpath;
@@ -134,7 +136,6 @@ struct Configuration {
   bool BsymbolicFunctions;
   bool CallGraphProfileSort;
   bool CheckSections;
-  bool CompressDebugSections;
   bool Cref;
   bool DefineCommon;
   bool Demangle = true;
@@ -161,6 +162,7 @@ struct Configuration {
   bool LTOCSProfileGenerate;
   bool LTODebugPassManager;
   bool LTONewPassManager;
+  bool LTOParallelOptimization;
   bool MergeArmExidx;
   bool MipsN32Abi = false;
   bool Nmagic;
@@ -182,7 +184,9 @@ struct Configuration {
   bool Static = false;
   bool SysvHash = false;
   bool Target1Rel;
+  bool TimeTrace;
   bool Trace;
+  bool ThinLTOCacheByImportedContent;
   bool ThinLTOEmitImportsFiles;
   bool ThinLTOIndexOnly;
   bool TocOptimize;
@@ -220,16 +224,20 @@ struct Configuration {
   StripPolicy Strip;
   UnresolvedPolicy UnresolvedSymbols;
   Target2Policy Target2;
+  llvm::ThreadAffinity ThreadAffinity;
   ARMVFPArgKind ARMVFPArgs = ARMVFPArgKind::Default;
   BuildIdKind BuildId = BuildIdKind::None;
   ELFKind EKind = ELFNoneKind;
   uint16_t DefaultSymbolVersion = llvm::ELF::VER_NDX_GLOBAL;
   uint16_t EMachine = llvm::ELF::EM_NONE;
+  // The ELFCOMPRESS_* type for --compress-debug-sections, or 0 for none.
+  uint32_t CompressDebugSections = 0;
   llvm::Optional<uint64_t> ImageBase;
   uint64_t CommonPageSize;
   uint64_t MaxPageSize;
   uint64_t MipsGotSize;
   uint64_t ZStackSize;
+  unsigned LTOCodeGenThreads;
   unsigned LTOPartitions;
   unsigned LTOO;
   unsigned Optimize;
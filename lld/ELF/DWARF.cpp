@@ -26,6 +26,14 @@ using namespace lld;
 using namespace lld::elf;
 
 template <class ELFT> LLDDwarfObj<ELFT>::LLDDwarfObj(ObjFile<ELFT> *Obj) {
+  auto GetData = [&](InputSectionBase *Sec) {
+    std::unique_ptr<uint8_t[]> Storage;
+    StringRef Data = toStringRef(Sec->dataCopy(Storage));
+    if (Storage)
+      Uncompressed.push_back(std::move(Storage));
+    return Data;
+  };
+
   for (InputSectionBase *Sec : Obj->getSections()) {
     if (!Sec)
       continue;
@@ -40,17 +48,17 @@ template <class ELFT> LLDDwarfObj<ELFT>::LLDDwarfObj(ObjFile<ELFT> *Obj) {
                 .Case(".debug_rnglists", &RngListsSection)
                 .Case(".debug_line", &LineSection)
                 .Default(nullptr)) {
-      M->Data = toStringRef(Sec->data());
+      M->Data = GetData(Sec);
       M->Sec = Sec;
       continue;
     }
 
     if (Sec->Name == ".debug_abbrev")
-      AbbrevSection = toStringRef(Sec->data());
+      AbbrevSection = GetData(Sec);
     else if (Sec->Name == ".debug_str")
-      StrSection = toStringRef(Sec->data());
+      StrSection = GetData(Sec);
     else if (Sec->Name == ".debug_line_str")
-      LineStringSection = toStringRef(Sec->data());
+      LineStringSection = GetData(Sec);
   }
 }
 
@@ -84,6 +84,11 @@ private:
   StringRef AbbrevSection;
   StringRef StrSection;
   StringRef LineStringSection;
+
+  // Uncompressed contents of compressed input sections. They are owned by
+  // this object rather than by the input sections so that they are freed
+  // as soon as we are done with the debug info.
+  std::vector<std::unique_ptr<uint8_t[]>> Uncompressed;
 };
 
 } // namespace elf
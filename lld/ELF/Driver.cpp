@@ -52,9 +52,12 @@
 #include "llvm/Support/Compression.h"
 #include "llvm/Support/GlobPattern.h"
 #include "llvm/Support/LEB128.h"
+#include "llvm/Support/Parallel.h"
 #include "llvm/Support/Path.h"
+#include "llvm/Support/Process.h"
 #include "llvm/Support/TarWriter.h"
 #include "llvm/Support/TargetSelect.h"
+#include "llvm/Support/TimeProfiler.h"
 #include "llvm/Support/raw_ostream.h"
 #include <cstdlib>
 #include <utility>
@@ -394,6 +397,51 @@ static void checkZOptions(opt::InputArgList &Args) {
       error("unknown -z value: " + StringRef(Arg->getValue()));
 }
 
+// Writes the --time-trace output. The default file name is the output
+// file name followed by ".time-trace".
+static void writeTimeTrace() {
+  std::string Path = Config->TimeTraceFile;
+  if (Path.empty())
+    Path = (Config->OutputFile + ".time-trace").str();
+
+  std::error_code EC;
+  raw_fd_ostream OS(Path, EC, sys::fs::F_None);
+  if (EC) {
+    error("cannot open " + Path + ": " + EC.message());
+    return;
+  }
+  timeTraceProfilerWrite(OS);
+}
+
+// Records the heap usage at the end of a link phase in the time trace, so
+// that phases that allocate a lot of memory stand out.
+static void traceMemoryUsage() {
+  if (timeTraceProfilerEnabled())
+    timeTraceProfilerCounter("Memory usage", sys::Process::GetMallocUsage());
+}
+
+// Starts reading the input files named on the command line into the OS cache
+// on a background thread, so that createFiles() waits less for the disk or
+// the network. Archives are skipped because usually only a few of their
+// members are read.
+static void prefetchInputFiles(opt::InputArgList &Args) {
+  if (!ThreadsEnabled)
+    return;
+  std::vector<std::string> Paths;
+  for (auto *Arg : Args.filtered(OPT_INPUT)) {
+    StringRef Path = Arg->getValue();
+    if (Path.endswith(".a"))
+      continue;
+    // Mirror readFile().
+    if (!Config->Chroot.empty() && Path.startswith("/"))
+      Paths.push_back((Config->Chroot + Path).str());
+    else
+      Paths.push_back(Path);
+  }
+  if (Paths.size() > 1)
+    sys::fs::prefetchFilesInBackground(std::move(Paths));
+}
+
 void LinkerDriver::main(ArrayRef<const char *> ArgsArr) {
   ELFOptTable Parser;
   opt::InputArgList Args = Parser.parse(ArgsArr.slice(1));
@@ -450,6 +498,7 @@ void LinkerDriver::main(ArrayRef<const char *> ArgsArr) {
     return;
 
   initLLVM();
+  prefetchInputFiles(Args);
   createFiles(Args);
   if (errorCount())
     return;
@@ -465,21 +514,32 @@ void LinkerDriver::main(ArrayRef<const char *> ArgsArr) {
   // values such as a default image base address.
   Target = getTarget();
 
-  switch (Config->EKind) {
-  case ELF32LEKind:
-    link<ELF32LE>(Args);
-    return;
-  case ELF32BEKind:
-    link<ELF32BE>(Args);
-    return;
-  case ELF64LEKind:
-    link<ELF64LE>(Args);
-    return;
-  case ELF64BEKind:
-    link<ELF64BE>(Args);
-    return;
-  default:
-    llvm_unreachable("unknown Config->EKind");
+  if (Config->TimeTrace)
+    timeTraceProfilerInitialize(Config->ProgName);
+
+  {
+    llvm::TimeTraceScope TimeScope("Link", StringRef(""));
+    switch (Config->EKind) {
+    case ELF32LEKind:
+      link<ELF32LE>(Args);
+      break;
+    case ELF32BEKind:
+      link<ELF32BE>(Args);
+      break;
+    case ELF64LEKind:
+      link<ELF64LE>(Args);
+      break;
+    case ELF64BEKind:
+      link<ELF64BE>(Args);
+      break;
+    default:
+      llvm_unreachable("unknown Config->EKind");
+    }
+  }
+
+  if (Config->TimeTrace) {
+    writeTimeTrace();
+    timeTraceProfilerCleanup();
   }
 }
 
@@ -536,6 +596,18 @@ static Target2Policy getTarget2(opt::InputArgList &Args) {
   return Target2Policy::GotRel;
 }
 
+static ThreadAffinity getThreadAffinity(opt::InputArgList &Args) {
+  StringRef S = Args.getLastArgValue(OPT_thread_affinity, "none");
+  if (S == "none")
+    return ThreadAffinity::None;
+  if (S == "compact")
+    return ThreadAffinity::Compact;
+  if (S == "spread")
+    return ThreadAffinity::Spread;
+  error("unknown --thread-affinity option: " + S);
+  return ThreadAffinity::None;
+}
+
 static bool isOutputFormatBinary(opt::InputArgList &Args) {
   StringRef S = Args.getLastArgValue(OPT_oformat, "elf");
   if (S == "binary")
@@ -735,15 +807,20 @@ template <class ELFT> static void readCallGraphsFromObjectFiles() {
   }
 }
 
-static bool getCompressDebugSections(opt::InputArgList &Args) {
+static uint32_t getCompressDebugSections(opt::InputArgList &Args) {
   StringRef S = Args.getLastArgValue(OPT_compress_debug_sections, "none");
   if (S == "none")
-    return false;
+    return 0;
+  if (S == "zstd") {
+    if (!zstd::isAvailable())
+      error("--compress-debug-sections: zstd is not available");
+    return ELFCOMPRESS_ZSTD;
+  }
   if (S != "zlib")
     error("unknown --compress-debug-sections value: " + S);
   if (!zlib::isAvailable())
     error("--compress-debug-sections: zlib is not available");
-  return true;
+  return ELFCOMPRESS_ZLIB;
 }
 
 static std::pair<StringRef, StringRef> getOldNewOptions(opt::InputArgList &Args,
@@ -786,6 +863,8 @@ static void readConfigs(opt::InputArgList &Args) {
   errorHandler().FatalWarnings =
       Args.hasFlag(OPT_fatal_warnings, OPT_no_fatal_warnings, false);
   ThreadsEnabled = Args.hasFlag(OPT_threads, OPT_no_threads, true);
+  Config->ThreadAffinity = getThreadAffinity(Args);
+  parallel::strategy.Affinity = Config->ThreadAffinity;
 
   Config->AllowMultipleDefinition =
       Args.hasFlag(OPT_allow_multiple_definition,
@@ -842,10 +921,13 @@ static void readConfigs(opt::InputArgList &Args) {
   Config->LTOCSProfileFile = Args.getLastArgValue(OPT_lto_cs_profile_file);
   Config->LTODebugPassManager = Args.hasArg(OPT_lto_debug_pass_manager);
   Config->LTONewPassManager = Args.hasArg(OPT_lto_new_pass_manager);
+  Config->LTOParallelOptimization = Args.hasArg(OPT_lto_parallel_optimization);
   Config->LTONewPmPasses = Args.getLastArgValue(OPT_lto_newpm_passes);
   Config->LTOO = args::getInteger(Args, OPT_lto_O, 2);
   Config->LTOObjPath = Args.getLastArgValue(OPT_plugin_opt_obj_path_eq);
   Config->LTOPartitions = args::getInteger(Args, OPT_lto_partitions, 1);
+  Config->LTOCodeGenThreads =
+      args::getInteger(Args, OPT_lto_codegen_threads, 0);
   Config->LTOSampleProfile = Args.getLastArgValue(OPT_lto_sample_profile);
   Config->MapFile = Args.getLastArgValue(OPT_Map);
   Config->MipsGotSize = args::getInteger(Args, OPT_mips_got_size, 0xfff0);
@@ -889,6 +971,8 @@ static void readConfigs(opt::InputArgList &Args) {
   Config->ThinLTOCachePolicy = CHECK(
       parseCachePruningPolicy(Args.getLastArgValue(OPT_thinlto_cache_policy)),
       "--thinlto-cache-policy: invalid cache policy");
+  Config->ThinLTOCacheByImportedContent =
+      Args.hasArg(OPT_thinlto_cache_by_imported_content);
   Config->ThinLTOEmitImportsFiles =
       Args.hasArg(OPT_plugin_opt_thinlto_emit_imports_files);
   Config->ThinLTOIndexOnly = Args.hasArg(OPT_plugin_opt_thinlto_index_only) ||
@@ -900,6 +984,8 @@ static void readConfigs(opt::InputArgList &Args) {
       getOldNewOptions(Args, OPT_plugin_opt_thinlto_object_suffix_replace_eq);
   Config->ThinLTOPrefixReplace =
       getOldNewOptions(Args, OPT_plugin_opt_thinlto_prefix_replace_eq);
+  Config->TimeTrace = Args.hasArg(OPT_time_trace);
+  Config->TimeTraceFile = Args.getLastArgValue(OPT_time_trace_file);
   Config->Trace = Args.hasArg(OPT_trace);
   Config->Undefined = args::getStrings(Args, OPT_undefined);
   Config->UndefinedVersion =
@@ -1699,12 +1785,22 @@ template <class ELFT> void LinkerDriver::link(opt::InputArgList &Args) {
   for (auto *Arg : Args.filtered(OPT_trace_symbol))
     Symtab->insert(Arg->getValue())->Traced = true;
 
-  // Add all files to the symbol table. This will add almost all
-  // symbols that we need to the symbol table. This process might
-  // add files to the link, via autolinking, these files are always
-  // appended to the Files vector.
-  for (size_t I = 0; I < Files.size(); ++I)
-    parseFile(Files[I]);
+  // Symbol names can be hashed independently for each file, so do that
+  // in parallel first. Symbols are still added to the symbol table in
+  // command line order below, so symbol resolution is deterministic.
+  {
+    llvm::TimeTraceScope TimeScope("Parse input files", StringRef(""));
+    if (ThreadsEnabled)
+      parallelForEach(Files, hashSymbolNames);
+
+    // Add all files to the symbol table. This will add almost all
+    // symbols that we need to the symbol table. This process might
+    // add files to the link, via autolinking, these files are always
+    // appended to the Files vector.
+    for (size_t I = 0; I < Files.size(); ++I)
+      parseFile(Files[I]);
+  }
+  traceMemoryUsage();
 
   // Now that we have every file, we can decide if we will need a
   // dynamic symbol table.
@@ -1796,7 +1892,11 @@ template <class ELFT> void LinkerDriver::link(opt::InputArgList &Args) {
   //
   // With this the symbol table should be complete. After this, no new names
   // except a few linker-synthesized ones will be added to the symbol table.
-  compileBitcodeFiles<ELFT>();
+  {
+    llvm::TimeTraceScope TimeScope("LTO", StringRef(""));
+    compileBitcodeFiles<ELFT>();
+  }
+  traceMemoryUsage();
   if (errorCount())
     return;
 
@@ -1886,11 +1986,23 @@ template <class ELFT> void LinkerDriver::link(opt::InputArgList &Args) {
 
   // Do size optimizations: garbage collection, merging of SHF_MERGE sections
   // and identical code folding.
-  splitSections<ELFT>();
-  markLive<ELFT>();
-  demoteSharedSymbols();
-  mergeSections();
+  {
+    llvm::TimeTraceScope TimeScope("Split sections", StringRef(""));
+    splitSections<ELFT>();
+  }
+  {
+    llvm::TimeTraceScope TimeScope("Mark live sections", StringRef(""));
+    markLive<ELFT>();
+    demoteSharedSymbols();
+  }
+  traceMemoryUsage();
+  {
+    llvm::TimeTraceScope TimeScope("Merge sections", StringRef(""));
+    mergeSections();
+  }
+  traceMemoryUsage();
   if (Config->ICF != ICFLevel::None) {
+    llvm::TimeTraceScope TimeScope("ICF", StringRef(""));
     findKeepUniqueSections<ELFT>(Args);
     doIcf<ELFT>();
   }
@@ -1904,5 +2016,13 @@ template <class ELFT> void LinkerDriver::link(opt::InputArgList &Args) {
   }
 
   // Write the result to the file.
-  writeResult<ELFT>();
+  {
+    llvm::TimeTraceScope TimeScope("Write output file", StringRef(""));
+    writeResult<ELFT>();
+  }
+
+  // Wait for the pruning of the ThinLTO cache, which runs while the output
+  // is written.
+  LTO.reset();
+  traceMemoryUsage();
 }
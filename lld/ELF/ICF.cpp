@@ -453,7 +453,7 @@ template <class ELFT> void ICF<ELFT>::run() {
 
   // Initially, we use hash values to partition sections.
   parallelForEach(Sections, [&](InputSection *S) {
-    S->Class[0] = xxHash64(S->data());
+    S->Class[0] = xxh3_64bits(S->data());
   });
 
   for (unsigned Cnt = 0; Cnt != 2; ++Cnt) {
@@ -471,6 +471,23 @@ template <class ELFT> void ICF<ELFT>::run() {
     return A->Class[0] < B->Class[0];
   });
 
+  // A section whose hash value is not shared with any other section cannot
+  // be identical to any other section, so we remove it from Sections to
+  // not visit it again in every iteration of the main loop. In a typical
+  // program most sections are unique. Sections referring to a removed
+  // section still compare its class, so we make the class valid in both
+  // slots.
+  size_t NumCandidates = 0;
+  forEachClassRange(0, Sections.size(), [&](size_t Begin, size_t End) {
+    if (End - Begin == 1) {
+      Sections[Begin]->Class[1] = Sections[Begin]->Class[0];
+      return;
+    }
+    for (size_t I = Begin; I < End; ++I)
+      Sections[NumCandidates++] = Sections[I];
+  });
+  Sections.resize(NumCandidates);
+
   // Compare static contents and assign unique IDs for each static content.
   forEachClass([&](size_t Begin, size_t End) { segregate(Begin, End, true); });
 
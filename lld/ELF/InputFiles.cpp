@@ -207,6 +207,28 @@ void elf::parseFile(InputFile *File) {
   }
 }
 
+void elf::hashSymbolNames(InputFile *File) {
+  if (File->kind() != InputFile::ObjKind)
+    return;
+
+  switch (Config->EKind) {
+  case ELF32LEKind:
+    cast<ObjFile<ELF32LE>>(File)->hashSymbolNames();
+    return;
+  case ELF32BEKind:
+    cast<ObjFile<ELF32BE>>(File)->hashSymbolNames();
+    return;
+  case ELF64LEKind:
+    cast<ObjFile<ELF64LE>>(File)->hashSymbolNames();
+    return;
+  case ELF64BEKind:
+    cast<ObjFile<ELF64BE>>(File)->hashSymbolNames();
+    return;
+  default:
+    llvm_unreachable("unknown ELFT");
+  }
+}
+
 // Concatenates arguments to construct a string representing an error location.
 static std::string createFileLineMsg(StringRef Path, unsigned Line) {
   std::string Filename = path::filename(Path);
@@ -460,6 +482,25 @@ template <class ELFT> void ObjFile<ELFT>::parse(bool IgnoreComdats) {
   initializeSymbols();
 }
 
+// Hashing symbol names is a large part of the cost of symbol insertion,
+// and unlike insertion itself, it does not depend on other files. This
+// function is called for many files in parallel before they are added to
+// the symbol table in command line order. It must not emit diagnostics;
+// if something is wrong, it gives up and initializeSymbols() reports it.
+template <class ELFT> void ObjFile<ELFT>::hashSymbolNames() {
+  ArrayRef<Elf_Sym> ESyms = this->getGlobalELFSyms<ELFT>();
+  std::vector<CachedHashStringRef> Keys;
+  Keys.reserve(ESyms.size());
+
+  for (const Elf_Sym &ESym : ESyms) {
+    if (ESym.st_name >= this->StringTable.size())
+      return;
+    Keys.push_back(
+        SymbolTable::getKey(this->StringTable.data() + ESym.st_name));
+  }
+  GlobalSymbolKeys = std::move(Keys);
+}
+
 // Sections with SHT_GROUP and comdat bits define comdat section groups.
 // They are identified and deduplicated by group name. This function
 // returns a group name.
@@ -1046,10 +1087,20 @@ template <class ELFT> void ObjFile<ELFT>::initializeSymbols() {
 
   // Our symbol table may have already been partially initialized
   // because of LazyObjFile.
-  for (size_t I = 0, End = ESyms.size(); I != End; ++I)
-    if (!this->Symbols[I] && ESyms[I].getBinding() != STB_LOCAL)
+  for (size_t I = 0, End = ESyms.size(); I != End; ++I) {
+    if (this->Symbols[I] || ESyms[I].getBinding() == STB_LOCAL)
+      continue;
+    if (I >= this->FirstGlobal && !GlobalSymbolKeys.empty())
+      this->Symbols[I] =
+          Symtab->insert(GlobalSymbolKeys[I - this->FirstGlobal]);
+    else
       this->Symbols[I] =
           Symtab->insert(CHECK(ESyms[I].getName(this->StringTable), this));
+  }
+
+  // The keys are not needed anymore.
+  GlobalSymbolKeys.clear();
+  GlobalSymbolKeys.shrink_to_fit();
 
   // Fill this->Symbols. A symbol is either local or global.
   for (size_t I = 0, End = ESyms.size(); I != End; ++I) {
@@ -57,6 +57,10 @@ llvm::Optional<MemoryBufferRef> readFile(StringRef Path);
 // Add symbols in File to the symbol table.
 void parseFile(InputFile *File);
 
+// Computes symbol table keys for File's global symbols so that parseFile()
+// does not need to hash symbol names. Thread-safe.
+void hashSymbolNames(InputFile *File);
+
 // The root class of input files.
 class InputFile {
 public:
@@ -206,6 +210,7 @@ public:
   }
 
   void parse(bool IgnoreComdats = false);
+  void hashSymbolNames();
 
   StringRef getShtGroupSignature(ArrayRef<Elf_Shdr> Sections,
                                  const Elf_Shdr &Sec);
@@ -280,6 +285,10 @@ private:
   // .shstrtab contents.
   StringRef SectionStringTable;
 
+  // Symbol table keys of global symbols, computed by hashSymbolNames()
+  // ahead of time. Empty if they have not been computed.
+  std::vector<llvm::CachedHashStringRef> GlobalSymbolKeys;
+
   // Debugging information to retrieve source file and line for error
   // reporting. Linker may find reasonable number of errors in a
   // single object file, so we cache debugging information in order to
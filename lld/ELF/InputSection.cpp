@@ -71,6 +71,7 @@ InputSectionBase::InputSectionBase(InputFile *File, uint64_t Flags,
 
   NumRelocations = 0;
   AreRelocsRela = false;
+  IsZstdCompressed = false;
 
   // The ELF spec states that a value of 0 means the section has
   // no alignment constraits.
@@ -83,12 +84,8 @@ InputSectionBase::InputSectionBase(InputFile *File, uint64_t Flags,
   // section name may be mangled by appending "z" (e.g. ".zdebug_info").
   // If that's the case, demangle section name so that we can handle a
   // section as if it weren't compressed.
-  if ((Flags & SHF_COMPRESSED) || Name.startswith(".zdebug")) {
-    if (!zlib::isAvailable())
-      error(toString(File) + ": contains a compressed section, " +
-            "but zlib is not available");
+  if ((Flags & SHF_COMPRESSED) || Name.startswith(".zdebug"))
     parseCompressedHeader();
-  }
 }
 
 // Drop SHF_GROUP bit unless we are producing a re-linkable object file.
@@ -144,18 +141,35 @@ size_t InputSectionBase::getSize() const {
 
 void InputSectionBase::uncompress() const {
   size_t Size = UncompressedSize;
-  char *UncompressedBuf;
+  uint8_t *UncompressedBuf;
   {
     static std::mutex Mu;
     std::lock_guard<std::mutex> Lock(Mu);
-    UncompressedBuf = BAlloc.Allocate<char>(Size);
+    UncompressedBuf = BAlloc.Allocate<uint8_t>(Size);
   }
 
-  if (Error E = zlib::uncompress(toStringRef(RawData), UncompressedBuf, Size))
+  uncompressTo(UncompressedBuf);
+  RawData = makeArrayRef(UncompressedBuf, Size);
+  UncompressedSize = -1;
+}
+
+void InputSectionBase::uncompressTo(uint8_t *Buf) const {
+  size_t Size = UncompressedSize;
+  Error E = IsZstdCompressed
+                ? zstd::uncompress(toStringRef(RawData), (char *)Buf, Size)
+                : zlib::uncompress(toStringRef(RawData), (char *)Buf, Size);
+  if (E)
     fatal(toString(this) +
           ": uncompress failed: " + llvm::toString(std::move(E)));
-  RawData = makeArrayRef((uint8_t *)UncompressedBuf, Size);
-  UncompressedSize = -1;
+}
+
+ArrayRef<uint8_t>
+InputSectionBase::dataCopy(std::unique_ptr<uint8_t[]> &Storage) const {
+  if (UncompressedSize < 0)
+    return RawData;
+  Storage.reset(new uint8_t[UncompressedSize]);
+  uncompressTo(Storage.get());
+  return makeArrayRef(Storage.get(), UncompressedSize);
 }
 
 uint64_t InputSectionBase::getOffsetInFile() const {
@@ -207,14 +221,40 @@ OutputSection *SectionBase::getOutputSection() {
 }
 
 // When a section is compressed, `RawData` consists with a header followed
-// by zlib-compressed data. This function parses a header to initialize
-// `UncompressedSize` member and remove the header from `RawData`.
+// by zlib- or zstd-compressed data. This function parses a header to
+// initialize `UncompressedSize` member and remove the header from `RawData`.
 void InputSectionBase::parseCompressedHeader() {
   using Chdr64 = typename ELF64LE::Chdr;
   using Chdr32 = typename ELF32LE::Chdr;
 
+  auto CheckType = [&](uint32_t Type) {
+    if (Type == ELFCOMPRESS_ZLIB) {
+      if (zlib::isAvailable())
+        return true;
+      error(toString(File) + ": contains a compressed section, " +
+            "but zlib is not available");
+      return false;
+    }
+    if (Type == ELFCOMPRESS_ZSTD) {
+      if (zstd::isAvailable()) {
+        IsZstdCompressed = true;
+        return true;
+      }
+      error(toString(File) + ": contains a compressed section, " +
+            "but zstd is not available");
+      return false;
+    }
+    error(toString(this) + ": unsupported compression type");
+    return false;
+  };
+
   // Old-style header
   if (Name.startswith(".zdebug")) {
+    if (!zlib::isAvailable()) {
+      error(toString(File) + ": contains a compressed section, " +
+            "but zlib is not available");
+      return;
+    }
     if (!toStringRef(RawData).startswith("ZLIB")) {
       error(toString(this) + ": corrupted compressed section header");
       return;
@@ -246,10 +286,8 @@ void InputSectionBase::parseCompressedHeader() {
     }
 
     auto *Hdr = reinterpret_cast<const Chdr64 *>(RawData.data());
-    if (Hdr->ch_type != ELFCOMPRESS_ZLIB) {
-      error(toString(this) + ": unsupported compression type");
+    if (!CheckType(Hdr->ch_type))
       return;
-    }
 
     UncompressedSize = Hdr->ch_size;
     Alignment = std::max<uint32_t>(Hdr->ch_addralign, 1);
@@ -264,10 +302,8 @@ void InputSectionBase::parseCompressedHeader() {
   }
 
   auto *Hdr = reinterpret_cast<const Chdr32 *>(RawData.data());
-  if (Hdr->ch_type != ELFCOMPRESS_ZLIB) {
-    error(toString(this) + ": unsupported compression type");
+  if (!CheckType(Hdr->ch_type))
     return;
-  }
 
   UncompressedSize = Hdr->ch_size;
   Alignment = std::max<uint32_t>(Hdr->ch_addralign, 1);
@@ -1110,12 +1146,8 @@ template <class ELFT> void InputSection::writeTo(uint8_t *Buf) {
   // If this is a compressed section, uncompress section contents directly
   // to the buffer.
   if (UncompressedSize >= 0) {
-    size_t Size = UncompressedSize;
-    if (Error E = zlib::uncompress(toStringRef(RawData),
-                                   (char *)(Buf + OutSecOff), Size))
-      fatal(toString(this) +
-            ": uncompress failed: " + llvm::toString(std::move(E)));
-    uint8_t *BufEnd = Buf + OutSecOff + Size;
+    uncompressTo(Buf + OutSecOff);
+    uint8_t *BufEnd = Buf + OutSecOff + UncompressedSize;
     relocate<ELFT>(Buf, BufEnd);
     return;
   }
@@ -1225,7 +1257,7 @@ void MergeInputSection::splitStrings(ArrayRef<uint8_t> Data, size_t EntSize) {
       fatal(toString(this) + ": string is not null terminated");
     size_t Size = End + EntSize;
 
-    Pieces.emplace_back(Off, xxHash64(S.substr(0, Size)), !IsAlloc);
+    Pieces.emplace_back(Off, xxh3_64bits(S.substr(0, Size)), !IsAlloc);
     S = S.substr(Size);
     Off += Size;
   }
@@ -1240,7 +1272,7 @@ void MergeInputSection::splitNonStrings(ArrayRef<uint8_t> Data,
   bool IsAlloc = Flags & SHF_ALLOC;
 
   for (size_t I = 0; I != Size; I += EntSize)
-    Pieces.emplace_back(I, xxHash64(Data.slice(I, EntSize)), !IsAlloc);
+    Pieces.emplace_back(I, xxh3_64bits(Data.slice(I, EntSize)), !IsAlloc);
 }
 
 template <class ELFT>
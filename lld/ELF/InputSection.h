@@ -128,8 +128,11 @@ public:
   static bool classof(const SectionBase *S) { return S->kind() != Output; }
 
   // Relocations that refer to this section.
-  unsigned NumRelocations : 31;
+  unsigned NumRelocations : 30;
   unsigned AreRelocsRela : 1;
+
+  // Set if RawData was compressed with zstd rather than zlib.
+  unsigned IsZstdCompressed : 1;
   const void *FirstRelocation = nullptr;
 
   // The file which contains this section. Its dynamic type is always
@@ -147,6 +150,13 @@ public:
     return RawData;
   }
 
+  // Returns section contents like data(), except that a compressed
+  // section is uncompressed into a buffer owned by Storage instead of a
+  // buffer that lives until the end of the link. The section itself stays
+  // compressed, so that writeTo() can later inflate it directly into the
+  // output file. Use this for contents that are needed only temporarily.
+  ArrayRef<uint8_t> dataCopy(std::unique_ptr<uint8_t[]> &Storage) const;
+
   uint64_t getOffsetInFile() const;
 
   // Input sections are part of an output section. Special sections
@@ -216,6 +226,7 @@ public:
 protected:
   void parseCompressedHeader();
   void uncompress() const;
+  void uncompressTo(uint8_t *Buf) const;
 
   mutable ArrayRef<uint8_t> RawData;
 
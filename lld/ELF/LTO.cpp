@@ -103,6 +103,9 @@ static lto::Config createConfig() {
 
   C.SampleProfile = Config->LTOSampleProfile;
   C.UseNewPM = Config->LTONewPassManager;
+  C.ParallelOptimization = Config->LTOParallelOptimization;
+  C.CodeGenThreads = Config->LTOCodeGenThreads;
+  C.CacheByImportedContent = Config->ThinLTOCacheByImportedContent;
   C.DebugPassManager = Config->LTODebugPassManager;
   C.DwoDir = Config->DwoDir;
 
@@ -135,8 +138,15 @@ BitcodeCompiler::BitcodeCompiler() {
     Backend = lto::createWriteIndexesThinBackend(
         Config->ThinLTOPrefixReplace.first, Config->ThinLTOPrefixReplace.second,
         Config->ThinLTOEmitImportsFiles, IndexFile.get(), OnIndexWrite);
-  } else if (Config->ThinLTOJobs != -1U) {
-    Backend = lto::createInProcessThinBackend(Config->ThinLTOJobs);
+  } else if (Config->ThinLTOJobs != -1U ||
+             Config->ThreadAffinity != ThreadAffinity::None) {
+    ThreadPoolStrategy Parallelism;
+    if (Config->ThinLTOJobs != -1U)
+      Parallelism.ThreadsRequested = Config->ThinLTOJobs;
+    else
+      Parallelism.UseHyperThreads = false;
+    Parallelism.Affinity = Config->ThreadAffinity;
+    Backend = lto::createInProcessThinBackend(Parallelism);
   }
 
   LTOObj = llvm::make_unique<lto::LTO>(createConfig(), Backend,
@@ -276,8 +286,10 @@ std::vector<InputFile *> BitcodeCompiler::compile() {
     return {};
   }
 
+  // Prune the cache in the background, while the output is written.
   if (!Config->ThinLTOCacheDir.empty())
-    pruneCache(Config->ThinLTOCacheDir, Config->ThinLTOCachePolicy);
+    CachePruning = pruneCacheAsync(Config->ThinLTOCacheDir,
+                                   Config->ThinLTOCachePolicy);
 
   if (!Config->LTOObjPath.empty()) {
     saveBuffer(Buf[0], Config->LTOObjPath);
@@ -24,6 +24,7 @@
 #include "llvm/ADT/DenseSet.h"
 #include "llvm/ADT/SmallString.h"
 #include "llvm/Support/raw_ostream.h"
+#include <future>
 #include <memory>
 #include <vector>
 
@@ -55,6 +56,7 @@ private:
   llvm::DenseSet<StringRef> UsedStartStop;
   std::unique_ptr<llvm::raw_fd_ostream> IndexFile;
   llvm::DenseSet<StringRef> ThinIndices;
+  std::future<bool> CachePruning;
 };
 } // namespace elf
 } // namespace lld
@@ -187,14 +187,17 @@ template <class ELFT> void OutputSection::maybeCompress() {
   // Create a section header.
   ZDebugHeader.resize(sizeof(Elf_Chdr));
   auto *Hdr = reinterpret_cast<Elf_Chdr *>(ZDebugHeader.data());
-  Hdr->ch_type = ELFCOMPRESS_ZLIB;
+  Hdr->ch_type = Config->CompressDebugSections;
   Hdr->ch_size = Size;
   Hdr->ch_addralign = Alignment;
 
   // Write section contents to a temporary buffer and compress it.
   std::vector<uint8_t> Buf(Size);
   writeTo<ELFT>(Buf.data());
-  if (Error E = zlib::compress(toStringRef(Buf), CompressedData))
+  Error E = Config->CompressDebugSections == ELFCOMPRESS_ZSTD
+                ? zstd::compress(toStringRef(Buf), CompressedData)
+                : zlib::compress(toStringRef(Buf), CompressedData);
+  if (E)
     fatal("compress failed: " + llvm::toString(std::move(E)));
 
   // Update section headers.
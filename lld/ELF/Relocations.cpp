@@ -52,6 +52,7 @@
 #include "lld/Common/ErrorHandler.h"
 #include "lld/Common/Memory.h"
 #include "lld/Common/Strings.h"
+#include "lld/Common/Threads.h"
 #include "llvm/ADT/SmallSet.h"
 #include "llvm/Support/Endian.h"
 #include "llvm/Support/raw_ostream.h"
@@ -1342,15 +1343,102 @@ static void scanReloc(InputSectionBase &Sec, OffsetGetter &GetOffset, RelTy *&I,
   processRelocAux<ELFT>(Sec, Expr, Type, Offset, Sym, Rel, Addend);
 }
 
+// Most relocations refer to defined, non-preemptible symbols and resolve to
+// link-time constants. Processing such a relocation has no side effect
+// other than adding it to Sec.Relocations, so we can precompute the
+// result for many sections in parallel. This function returns true and
+// sets R if Rel is such a relocation; R.Expr is R_NONE if the relocation
+// needs no processing at all. It must not change any shared state.
 template <class ELFT, class RelTy>
-static void scanRelocs(InputSectionBase &Sec, ArrayRef<RelTy> Rels) {
+static bool getLinkTimeConstantReloc(InputSectionBase &Sec, const RelTy *I,
+                                     const RelTy *End, Relocation &R) {
+  const RelTy &Rel = *I;
+  uint32_t SymIndex = Rel.getSymbol(Config->IsMips64EL);
+  ObjFile<ELFT> *File = Sec.getFile<ELFT>();
+  if (SymIndex == 0 || SymIndex >= File->getSymbols().size())
+    return false;
+
+  Symbol &Sym = File->getSymbol(SymIndex);
+  if (!Sym.isDefined() || Sym.IsPreemptible || Sym.isGnuIFunc() ||
+      Sym.isTls())
+    return false;
+
+  RelType Type = Rel.getType(Config->IsMips64EL);
+  const uint8_t *RelocatedAddr = Sec.data().begin() + Rel.r_offset;
+  RelExpr Expr = Target->getRelExpr(Type, Sym, RelocatedAddr);
+  if (oneof<R_HINT, R_NONE>(Expr)) {
+    R.Expr = R_NONE;
+    return true;
+  }
+
+  // Relax relocations in the same way as scanReloc().
+  if (Expr == R_GOT_PC && !isAbsoluteValue(Sym))
+    Expr = Target->adjustRelaxExpr(Type, RelocatedAddr, Expr);
+  else
+    Expr = fromPlt(Expr);
+
+  // Leave relocations that need GOT or PLT to scanReloc().
+  if (needsPlt(Expr) || needsGot(Expr) ||
+      oneof<R_GOTPLTONLY_PC, R_GOTPLTREL, R_GOTPLT, R_TLSGD_GOTPLT,
+            R_GOTONLY_PC, R_GOTREL>(Expr))
+    return false;
+
+  // A relative relocation to an absolute symbol may be an error, which
+  // should be reported in a deterministic order.
+  if (isAbsoluteValue(Sym) && isRelExpr(Expr))
+    return false;
+  if (!isStaticLinkTimeConstant(Expr, Type, Sym, Sec, Rel.r_offset))
+    return false;
+
+  int64_t Addend = computeAddend<ELFT>(Rel, End, Sec, Expr, Sym.isLocal());
+  R = {Expr, Type, Rel.r_offset, Addend, &Sym};
+  return true;
+}
+
+// Precomputes link-time constant relocations of Sec. The results are
+// stored to Sec.Relocations, and their indices in Rels to Indices.
+template <class ELFT, class RelTy>
+static void prescanRelocs(InputSectionBase &Sec, ArrayRef<RelTy> Rels,
+                          std::vector<uint32_t> &Indices) {
+  for (const RelTy *I = Rels.begin(), *End = Rels.end(); I != End; ++I) {
+    Relocation R;
+    if (getLinkTimeConstantReloc<ELFT>(Sec, I, End, R)) {
+      Indices.push_back(I - Rels.begin());
+      Sec.Relocations.push_back(R);
+    }
+  }
+}
+
+template <class ELFT, class RelTy>
+static void scanRelocs(InputSectionBase &Sec, ArrayRef<RelTy> Rels,
+                       ArrayRef<uint32_t> Prescanned) {
   OffsetGetter GetOffset(Sec);
 
+  // Sec.Relocations contains precomputed results for the relocations
+  // whose indices are in Prescanned.
+  std::vector<Relocation> Known = std::move(Sec.Relocations);
+  Sec.Relocations.clear();
+
   // Not all relocations end up in Sec.Relocations, but a lot do.
   Sec.Relocations.reserve(Rels.size());
 
-  for (auto I = Rels.begin(), End = Rels.end(); I != End;)
+  size_t K = 0;
+  for (auto I = Rels.begin(), End = Rels.end(); I != End;) {
+    // Skip results of relocations that have been consumed by a preceding
+    // relocation, such as TLS relocations handled as a pair.
+    size_t Idx = I - Rels.begin();
+    while (K < Prescanned.size() && Prescanned[K] < Idx)
+      ++K;
+
+    if (K < Prescanned.size() && Prescanned[K] == Idx) {
+      if (Known[K].Expr != R_NONE)
+        Sec.Relocations.push_back(Known[K]);
+      ++I;
+      ++K;
+      continue;
+    }
     scanReloc<ELFT>(Sec, GetOffset, I, End);
+  }
 
   // Sort relocations by offset for more efficient searching for
   // R_RISCV_PCREL_HI20 and R_PPC64_ADDR64.
@@ -1362,11 +1450,41 @@ static void scanRelocs(InputSectionBase &Sec, ArrayRef<RelTy> Rels) {
                       });
 }
 
-template <class ELFT> void elf::scanRelocations(InputSectionBase &S) {
-  if (S.AreRelocsRela)
-    scanRelocs<ELFT>(S, S.relas<ELFT>());
-  else
-    scanRelocs<ELFT>(S, S.rels<ELFT>());
+// getLinkTimeConstantReloc() relies on the target's getRelExpr(),
+// adjustRelaxExpr() and getImplicitAddend() having no side effects and
+// not needing the MIPS or PPC specific processing in scanReloc().
+static bool canPrescanRelocations() {
+  return ThreadsEnabled &&
+         (Config->EMachine == EM_386 || Config->EMachine == EM_X86_64 ||
+          Config->EMachine == EM_AARCH64);
+}
+
+template <class ELFT>
+void elf::scanRelocations(ArrayRef<InputSectionBase *> Sections) {
+  // Find link-time constant relocations in parallel first. .eh_frame
+  // sections are excluded because their offsets need to be translated.
+  std::vector<std::vector<uint32_t>> Prescanned(Sections.size());
+  if (canPrescanRelocations()) {
+    parallelForEachN(0, Sections.size(), [&](size_t I) {
+      InputSectionBase &Sec = *Sections[I];
+      if (isa<EhInputSection>(Sec))
+        return;
+      if (Sec.AreRelocsRela)
+        prescanRelocs<ELFT>(Sec, Sec.relas<ELFT>(), Prescanned[I]);
+      else
+        prescanRelocs<ELFT>(Sec, Sec.rels<ELFT>(), Prescanned[I]);
+    });
+  }
+
+  // Then process the remaining relocations in the original order.
+  for (size_t I = 0, E = Sections.size(); I != E; ++I) {
+    InputSectionBase &Sec = *Sections[I];
+    if (Sec.AreRelocsRela)
+      scanRelocs<ELFT>(Sec, Sec.relas<ELFT>(), Prescanned[I]);
+    else
+      scanRelocs<ELFT>(Sec, Sec.rels<ELFT>(), Prescanned[I]);
+    Prescanned[I] = {};
+  }
 }
 
 // Figure out which representation to use for any absolute relocs to
@@ -1809,10 +1927,10 @@ bool ThunkCreator::createThunks(ArrayRef<OutputSection *> OutputSections) {
   return AddressesChanged;
 }
 
-template void elf::scanRelocations<ELF32LE>(InputSectionBase &);
-template void elf::scanRelocations<ELF32BE>(InputSectionBase &);
-template void elf::scanRelocations<ELF64LE>(InputSectionBase &);
-template void elf::scanRelocations<ELF64BE>(InputSectionBase &);
+template void elf::scanRelocations<ELF32LE>(ArrayRef<InputSectionBase *>);
+template void elf::scanRelocations<ELF32BE>(ArrayRef<InputSectionBase *>);
+template void elf::scanRelocations<ELF64LE>(ArrayRef<InputSectionBase *>);
+template void elf::scanRelocations<ELF64BE>(ArrayRef<InputSectionBase *>);
 template void elf::reportUndefinedSymbols<ELF32LE>();
 template void elf::reportUndefinedSymbols<ELF32BE>();
 template void elf::reportUndefinedSymbols<ELF64LE>();
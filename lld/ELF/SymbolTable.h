@@ -42,6 +42,11 @@ public:
   }
 
   Symbol *insert(StringRef Name);
+  Symbol *insert(llvm::CachedHashStringRef Key);
+
+  // Returns the key under which a symbol named Name is stored. The
+  // computation is pure, so it may be called from multiple threads.
+  static llvm::CachedHashStringRef getKey(StringRef Name);
 
   Symbol *addSymbol(const Symbol &New);
 
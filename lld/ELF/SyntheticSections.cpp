@@ -52,6 +52,7 @@ using llvm::support::endian::read32le;
 using llvm::support::endian::write32le;
 using llvm::support::endian::write64le;
 
+constexpr size_t MergeTailSection::NumShards;
 constexpr size_t MergeNoTailSection::NumShards;
 
 static uint64_t readUint(uint8_t *Buf) {
@@ -2509,37 +2510,45 @@ readPubNamesAndTypes(const LLDDwarfObj<ELFT> &Obj,
   return Ret;
 }
 
-// Create a list of symbols from a given list of symbol names and types
-// by uniquifying them by name.
-static std::vector<GdbIndexSection::GdbSymbol>
-createSymbols(ArrayRef<std::vector<GdbIndexSection::NameAttrEntry>> NameAttrs,
-              const std::vector<GdbIndexSection::GdbChunk> &Chunks) {
-  using GdbSymbol = GdbIndexSection::GdbSymbol;
-  using NameAttrEntry = GdbIndexSection::NameAttrEntry;
+namespace {
+// A sharded map to uniquify symbols by name. Symbol names and types are
+// added in batches of files, so we don't need to keep the names and types
+// of all input files in memory at once.
+class GdbSymbolMerger {
+public:
+  GdbSymbolMerger();
+  void add(ArrayRef<std::vector<GdbIndexSection::NameAttrEntry>> NameAttrs,
+           ArrayRef<uint32_t> CuIdxs);
+  std::vector<GdbIndexSection::GdbSymbol> finalize();
+
+private:
+  // The number of symbols we will handle is of the order of millions for
+  // very large executables, so we use multi-threading to speed it up.
+  static constexpr size_t NumShards = 32;
+  size_t Concurrency = 1;
+  size_t Shift = 32 - countTrailingZeros(NumShards);
 
-  // For each chunk, compute the number of compilation units preceding it.
-  uint32_t CuIdx = 0;
-  std::vector<uint32_t> CuIdxs(Chunks.size());
-  for (uint32_t I = 0, E = Chunks.size(); I != E; ++I) {
-    CuIdxs[I] = CuIdx;
-    CuIdx += Chunks[I].CompilationUnits.size();
-  }
+  std::vector<DenseMap<CachedHashStringRef, size_t>> Map;
+  std::vector<std::vector<GdbIndexSection::GdbSymbol>> Symbols;
+};
+} // namespace
 
-  // The number of symbols we will handle in this function is of the order
-  // of millions for very large executables, so we use multi-threading to
-  // speed it up.
-  size_t NumShards = 32;
-  size_t Concurrency = 1;
+constexpr size_t GdbSymbolMerger::NumShards;
+
+GdbSymbolMerger::GdbSymbolMerger() : Map(NumShards), Symbols(NumShards) {
   if (ThreadsEnabled)
     Concurrency =
         std::min<size_t>(PowerOf2Floor(hardware_concurrency()), NumShards);
+}
 
-  // A sharded map to uniquify symbols by name.
-  std::vector<DenseMap<CachedHashStringRef, size_t>> Map(NumShards);
-  size_t Shift = 32 - countTrailingZeros(NumShards);
+// Instantiate GdbSymbols for a given list of symbol names and types while
+// uniquifying them by name. CuIdxs[I] is the number of compilation units
+// preceding the file of NameAttrs[I].
+void GdbSymbolMerger::add(
+    ArrayRef<std::vector<GdbIndexSection::NameAttrEntry>> NameAttrs,
+    ArrayRef<uint32_t> CuIdxs) {
+  using NameAttrEntry = GdbIndexSection::NameAttrEntry;
 
-  // Instantiate GdbSymbols while uniqufying them by name.
-  std::vector<std::vector<GdbSymbol>> Symbols(NumShards);
   parallelForEachN(0, Concurrency, [&](size_t ThreadId) {
     uint32_t I = 0;
     for (ArrayRef<NameAttrEntry> Entries : NameAttrs) {
@@ -2561,6 +2570,14 @@ createSymbols(ArrayRef<std::vector<GdbIndexSection::NameAttrEntry>> NameAttrs,
       ++I;
     }
   });
+}
+
+// Returns the list of all symbols added so far.
+std::vector<GdbIndexSection::GdbSymbol> GdbSymbolMerger::finalize() {
+  using GdbSymbol = GdbIndexSection::GdbSymbol;
+
+  // The hash maps are no longer needed.
+  Map.clear();
 
   size_t NumSymbols = 0;
   for (ArrayRef<GdbSymbol> V : Symbols)
@@ -2570,9 +2587,11 @@ createSymbols(ArrayRef<std::vector<GdbIndexSection::NameAttrEntry>> NameAttrs,
   // contents to Ret.
   std::vector<GdbSymbol> Ret;
   Ret.reserve(NumSymbols);
-  for (std::vector<GdbSymbol> &Vec : Symbols)
+  for (std::vector<GdbSymbol> &Vec : Symbols) {
     for (GdbSymbol &Sym : Vec)
       Ret.push_back(std::move(Sym));
+    Vec = {};
+  }
 
   // CU vectors and symbol names are adjacent in the output file.
   // We can compute their offsets in the output file now.
@@ -2601,23 +2620,45 @@ template <class ELFT> GdbIndexSection *GdbIndexSection::create() {
       S->markDead();
 
   std::vector<GdbChunk> Chunks(Sections.size());
-  std::vector<std::vector<NameAttrEntry>> NameAttrs(Sections.size());
-
-  parallelForEachN(0, Sections.size(), [&](size_t I) {
-    ObjFile<ELFT> *File = Sections[I]->getFile<ELFT>();
-    DWARFContext Dwarf(make_unique<LLDDwarfObj<ELFT>>(File));
-
-    Chunks[I].Sec = Sections[I];
-    Chunks[I].CompilationUnits = readCuList(Dwarf);
-    Chunks[I].AddressAreas = readAddressAreas(Dwarf, Sections[I]);
-    NameAttrs[I] = readPubNamesAndTypes<ELFT>(
-        static_cast<const LLDDwarfObj<ELFT> &>(Dwarf.getDWARFObj()),
-        Chunks[I].CompilationUnits);
-  });
+  GdbSymbolMerger Merger;
+
+  // The total number of names and types in input files is usually much
+  // larger than the number of unique names because declarations in header
+  // files are repeated in every compilation unit. To bound memory usage,
+  // we read them in batches of files and uniquify them before reading the
+  // next batch.
+  const size_t BatchSize = 1024;
+  uint32_t CuIdx = 0;
+
+  for (size_t Begin = 0; Begin < Sections.size(); Begin += BatchSize) {
+    size_t End = std::min(Begin + BatchSize, Sections.size());
+    std::vector<std::vector<NameAttrEntry>> NameAttrs(End - Begin);
+
+    parallelForEachN(Begin, End, [&](size_t I) {
+      ObjFile<ELFT> *File = Sections[I]->getFile<ELFT>();
+      DWARFContext Dwarf(make_unique<LLDDwarfObj<ELFT>>(File));
+
+      Chunks[I].Sec = Sections[I];
+      Chunks[I].CompilationUnits = readCuList(Dwarf);
+      Chunks[I].AddressAreas = readAddressAreas(Dwarf, Sections[I]);
+      NameAttrs[I - Begin] = readPubNamesAndTypes<ELFT>(
+          static_cast<const LLDDwarfObj<ELFT> &>(Dwarf.getDWARFObj()),
+          Chunks[I].CompilationUnits);
+    });
+
+    // For each chunk, compute the number of compilation units preceding it.
+    std::vector<uint32_t> CuIdxs(End - Begin);
+    for (size_t I = Begin; I != End; ++I) {
+      CuIdxs[I - Begin] = CuIdx;
+      CuIdx += Chunks[I].CompilationUnits.size();
+    }
+
+    Merger.add(NameAttrs, CuIdxs);
+  }
 
   auto *Ret = make<GdbIndexSection>();
   Ret->Chunks = std::move(Chunks);
-  Ret->Symbols = createSymbols(NameAttrs, Ret->Chunks);
+  Ret->Symbols = Merger.finalize();
   Ret->initOutputSize();
   return Ret;
 }
@@ -2923,33 +2964,79 @@ void MergeSyntheticSection::addSection(MergeInputSection *MS) {
   Alignment = std::max(Alignment, MS->Alignment);
 }
 
-MergeTailSection::MergeTailSection(StringRef Name, uint32_t Type,
-                                   uint64_t Flags, uint32_t Alignment)
-    : MergeSyntheticSection(Name, Type, Flags, Alignment),
-      Builder(StringTableBuilder::RAW, Alignment) {}
-
-size_t MergeTailSection::getSize() const { return Builder.getSize(); }
+size_t MergeTailSection::getShardId(StringRef S, uint64_t Entsize) {
+  // A piece ends with a null terminator of Entsize bytes. Empty strings are
+  // tails of any string, so they can go to any shard.
+  if (S.size() < 2 * Entsize)
+    return 0;
+  size_t Id = 0;
+  for (char C : S.substr(S.size() - 2 * Entsize, Entsize))
+    Id = Id * 31 + (uint8_t)C;
+  return Id % NumShards;
+}
 
-void MergeTailSection::writeTo(uint8_t *Buf) { Builder.write(Buf); }
+void MergeTailSection::writeTo(uint8_t *Buf) {
+  for (size_t I = 0; I < NumShards; ++I)
+    Shards[I].write(Buf + ShardOffsets[I]);
+}
 
+// Tail merging sorts all strings of the section, which is slow for large
+// sections such as .debug_str. For any strings S and T, S can be a tail of T
+// only if they end with the same character, so we shard the strings by their
+// last character and tail-merge the shards in parallel. This finds the same
+// tails as a single string table would.
 void MergeTailSection::finalizeContents() {
-  // Add all string pieces to the string table builder to create section
-  // contents.
-  for (MergeInputSection *Sec : Sections)
-    for (size_t I = 0, E = Sec->Pieces.size(); I != E; ++I)
-      if (Sec->Pieces[I].Live)
-        Builder.add(Sec->getData(I));
+  // Initializes string table builders.
+  for (size_t I = 0; I < NumShards; ++I)
+    Shards.emplace_back(StringTableBuilder::RAW, Alignment);
 
-  // Fix the string table content. After this, the contents will never change.
-  Builder.finalize();
+  // Concurrency level. Must be a power of 2 to avoid expensive modulo
+  // operations in the following tight loop.
+  size_t Concurrency = 1;
+  if (ThreadsEnabled)
+    Concurrency =
+        std::min<size_t>(PowerOf2Floor(hardware_concurrency()), NumShards);
 
-  // finalize() fixed tail-optimized strings, so we can now get
-  // offsets of strings. Get an offset for each string and save it
-  // to a corresponding StringPiece for easy access.
-  for (MergeInputSection *Sec : Sections)
-    for (size_t I = 0, E = Sec->Pieces.size(); I != E; ++I)
-      if (Sec->Pieces[I].Live)
-        Sec->Pieces[I].OutputOff = Builder.getOffset(Sec->getData(I));
+  // Add section pieces to the builders.
+  parallelForEachN(0, Concurrency, [&](size_t ThreadId) {
+    for (MergeInputSection *Sec : Sections) {
+      for (size_t I = 0, E = Sec->Pieces.size(); I != E; ++I) {
+        if (!Sec->Pieces[I].Live)
+          continue;
+        CachedHashStringRef Data = Sec->getData(I);
+        size_t ShardId = getShardId(Data.val(), Sec->Entsize);
+        if ((ShardId & (Concurrency - 1)) == ThreadId)
+          Shards[ShardId].add(Data);
+      }
+    }
+  });
+
+  // Fix the contents of the shards. After this, they will never change.
+  parallelForEachN(0, NumShards, [&](size_t I) { Shards[I].finalize(); });
+
+  // Compute an in-section offset for each shard.
+  size_t Off = 0;
+  for (size_t I = 0; I < NumShards; ++I) {
+    if (Shards[I].getSize() > 0)
+      Off = alignTo(Off, Alignment);
+    ShardOffsets[I] = Off;
+    Off += Shards[I].getSize();
+  }
+  Size = Off;
+
+  // finalize() fixed tail-optimized strings, so we can now get offsets of
+  // strings. Get an offset for each string and save it to a corresponding
+  // StringPiece for easy access.
+  parallelForEach(Sections, [&](MergeInputSection *Sec) {
+    for (size_t I = 0, E = Sec->Pieces.size(); I != E; ++I) {
+      if (!Sec->Pieces[I].Live)
+        continue;
+      CachedHashStringRef Data = Sec->getData(I);
+      size_t ShardId = getShardId(Data.val(), Sec->Entsize);
+      Sec->Pieces[I].OutputOff =
+          ShardOffsets[ShardId] + Shards[ShardId].getOffset(Data);
+    }
+  });
 }
 
 void MergeNoTailSection::writeTo(uint8_t *Buf) {
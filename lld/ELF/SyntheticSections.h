@@ -707,7 +707,9 @@ public:
 
   struct GdbSymbol {
     llvm::CachedHashStringRef Name;
-    std::vector<uint32_t> CuVector;
+    // Most symbols are defined in a single compilation unit, so avoid a
+    // heap allocation for the common case.
+    SmallVector<uint32_t, 1> CuVector;
     uint32_t NameOff;
     uint32_t CuVectorOff;
   };
@@ -847,14 +849,25 @@ protected:
 class MergeTailSection final : public MergeSyntheticSection {
 public:
   MergeTailSection(StringRef Name, uint32_t Type, uint64_t Flags,
-                   uint32_t Alignment);
+                   uint32_t Alignment)
+      : MergeSyntheticSection(Name, Type, Flags, Alignment) {}
 
-  size_t getSize() const override;
+  size_t getSize() const override { return Size; }
   void writeTo(uint8_t *Buf) override;
   void finalizeContents() override;
 
 private:
-  llvm::StringTableBuilder Builder;
+  // A string can only be the tail of strings ending with the same character,
+  // so we use the last character of a string as its shard ID.
+  static size_t getShardId(StringRef S, uint64_t Entsize);
+
+  // Section size
+  size_t Size;
+
+  // String table contents
+  constexpr static size_t NumShards = 32;
+  std::vector<llvm::StringTableBuilder> Shards;
+  size_t ShardOffsets[NumShards];
 };
 
 class MergeNoTailSection final : public MergeSyntheticSection {
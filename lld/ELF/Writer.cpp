@@ -26,6 +26,7 @@
 #include "llvm/ADT/StringSwitch.h"
 #include "llvm/Support/RandomNumberGenerator.h"
 #include "llvm/Support/SHA1.h"
+#include "llvm/Support/TimeProfiler.h"
 #include "llvm/Support/xxhash.h"
 #include <climits>
 
@@ -109,14 +110,16 @@ StringRef elf::getOutputSectionName(const InputSectionBase *S) {
   }
 
   // This check is for -z keep-text-section-prefix.  This option separates text
-  // sections with prefix ".text.hot", ".text.unlikely", ".text.startup" or
-  // ".text.exit".
+  // sections with prefix ".text.hot", ".text.unlikely", ".text.split",
+  // ".text.startup" or ".text.exit". ".text.split" holds the cold code that
+  // the compiler split out of hot functions.
   // When enabled, this allows identifying the hot code region (.text.hot) in
   // the final binary which can be selectively mapped to huge pages or mlocked,
   // for instance.
   if (Config->ZKeepTextSectionPrefix)
     for (StringRef V :
-         {".text.hot.", ".text.unlikely.", ".text.startup.", ".text.exit."})
+         {".text.hot.", ".text.unlikely.", ".text.split.", ".text.startup.",
+          ".text.exit."})
       if (isSectionPrefix(V, S->Name))
         return V.drop_back();
 
@@ -577,7 +580,10 @@ template <class ELFT> void Writer<ELFT>::run() {
   // completes section contents. For example, we need to add strings
   // to the string table, and add entries to .got and .plt.
   // finalizeSections does that.
-  finalizeSections();
+  {
+    llvm::TimeTraceScope TimeScope("Finalize sections", StringRef(""));
+    finalizeSections();
+  }
   checkExecuteOnly();
   if (errorCount())
     return;
@@ -621,17 +627,23 @@ template <class ELFT> void Writer<ELFT>::run() {
   if (errorCount())
     return;
 
-  if (!Config->OFormatBinary) {
-    writeTrapInstr();
-    writeHeader();
-    writeSections();
-  } else {
-    writeSectionsBinary();
+  {
+    llvm::TimeTraceScope TimeScope("Write sections", StringRef(""));
+    if (!Config->OFormatBinary) {
+      writeTrapInstr();
+      writeHeader();
+      writeSections();
+    } else {
+      writeSectionsBinary();
+    }
   }
 
   // Backfill .note.gnu.build-id section content. This is done at last
   // because the content is usually a hash value of the entire output file.
-  writeBuildId();
+  {
+    llvm::TimeTraceScope TimeScope("Write build ID", StringRef(""));
+    writeBuildId();
+  }
   if (errorCount())
     return;
 
@@ -1738,7 +1750,9 @@ template <class ELFT> void Writer<ELFT>::finalizeSections() {
   // Scan relocations. This must be done after every symbol is declared so that
   // we can correctly decide if a dynamic relocation is needed.
   if (!Config->Relocatable) {
-    forEachRelSec(scanRelocations<ELFT>);
+    std::vector<InputSectionBase *> RelSecs;
+    forEachRelSec([&](InputSectionBase &S) { RelSecs.push_back(&S); });
+    scanRelocations<ELFT>(RelSecs);
     reportUndefinedSymbols<ELFT>();
   }
 
@@ -2622,9 +2636,18 @@ template <class ELFT> void Writer<ELFT>::writeSections() {
     if (Sec->Type == SHT_REL || Sec->Type == SHT_RELA)
       Sec->writeTo<ELFT>(Out::BufferStart + Sec->Offset);
 
-  for (OutputSection *Sec : OutputSections)
-    if (Sec->Type != SHT_REL && Sec->Type != SHT_RELA)
-      Sec->writeTo<ELFT>(Out::BufferStart + Sec->Offset);
+  for (OutputSection *Sec : OutputSections) {
+    if (Sec->Type == SHT_REL || Sec->Type == SHT_RELA)
+      continue;
+    Sec->writeTo<ELFT>(Out::BufferStart + Sec->Offset);
+
+    // Non-allocated sections, most of which are debug info, are not
+    // accessed again unless we compute a build-id. Let the kernel release
+    // their pages as soon as they are written so that the written output
+    // does not pile up in our resident set for large outputs.
+    if (!(Sec->Flags & SHF_ALLOC) && Config->BuildId == BuildIdKind::None)
+      Buffer->dontNeed(Sec->Offset, Sec->Size);
+  }
 }
 
 // Split one uint8 array into small pieces of uint8 arrays.
@@ -2678,7 +2701,7 @@ template <class ELFT> void Writer<ELFT>::writeBuildId() {
   switch (Config->BuildId) {
   case BuildIdKind::Fast:
     computeHash(BuildId, Buf, [](uint8_t *Dest, ArrayRef<uint8_t> Arr) {
-      write64le(Dest, xxHash64(Arr));
+      write64le(Dest, xxh3_64bits(Arr));
     });
     break;
   case BuildIdKind::Md5:
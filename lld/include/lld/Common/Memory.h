@@ -22,7 +22,9 @@
 #define LLD_COMMON_MEMORY_H
 
 #include "llvm/Support/Allocator.h"
+#include "llvm/Support/ConcurrentBumpPtrAllocator.h"
 #include "llvm/Support/StringSaver.h"
+#include <mutex>
 #include <vector>
 
 namespace lld {
@@ -36,19 +38,24 @@ void freeArena();
 // These two classes are hack to keep track of all
 // SpecificBumpPtrAllocator instances.
 struct SpecificAllocBase {
-  SpecificAllocBase() { Instances.push_back(this); }
+  SpecificAllocBase() {
+    std::lock_guard<std::mutex> Lock(InstancesMutex);
+    Instances.push_back(this);
+  }
   virtual ~SpecificAllocBase() = default;
   virtual void reset() = 0;
   static std::vector<SpecificAllocBase *> Instances;
+  static std::mutex InstancesMutex;
 };
 
 template <class T> struct SpecificAlloc : public SpecificAllocBase {
   void reset() override { Alloc.DestroyAll(); }
-  llvm::SpecificBumpPtrAllocator<T> Alloc;
+  llvm::ConcurrentSpecificBumpPtrAllocator<T> Alloc;
 };
 
 // Use this arena if your object has a destructor.
 // Your destructor will be invoked from freeArena().
+// This is thread-safe, so it may be called from parallel loops.
 template <typename T, typename... U> T *make(U &&... Args) {
   static SpecificAlloc<T> Alloc;
   return new (Alloc.Alloc.Allocate()) T(std::forward<U>(Args)...);
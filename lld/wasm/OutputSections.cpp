@@ -85,9 +85,14 @@ void CodeSection::finalizeContents() {
   OS.flush();
   BodySize = CodeSectionHeader.size();
 
+  // With --compress-relocations, the size of a function depends on the
+  // values of its relocations. Compute that for all functions in parallel
+  // before assigning offsets.
+  parallelForEach(Functions,
+                  [](InputFunction *Func) { Func->calculateSize(); });
+
   for (InputFunction *Func : Functions) {
     Func->OutputOffset = BodySize;
-    Func->calculateSize();
     BodySize += Func->getSize();
   }
 
@@ -109,8 +114,9 @@ void CodeSection::writeTo(uint8_t *Buf) {
   memcpy(Buf, CodeSectionHeader.data(), CodeSectionHeader.size());
 
   // Write code section bodies
-  for (const InputChunk *Chunk : Functions)
+  parallelForEach(Functions, [&](const InputChunk *Chunk) {
     Chunk->writeTo(Buf);
+  });
 }
 
 uint32_t CodeSection::numRelocations() const {
@@ -186,8 +192,9 @@ void DataSection::writeTo(uint8_t *Buf) {
     memcpy(SegStart, Segment->Header.data(), Segment->Header.size());
 
     // Write segment data payload
-    for (const InputChunk *Chunk : Segment->InputSegments)
+    parallelForEach(Segment->InputSegments, [&](const InputChunk *Chunk) {
       Chunk->writeTo(Buf);
+    });
   }
 }
 
@@ -234,8 +241,9 @@ void CustomSection::writeTo(uint8_t *Buf) {
   Buf += NameData.size();
 
   // Write custom sections payload
-  for (const InputSection *Section : InputSections)
+  parallelForEach(InputSections, [&](const InputSection *Section) {
     Section->writeTo(Buf);
+  });
 }
 
 uint32_t CustomSection::numRelocations() const {
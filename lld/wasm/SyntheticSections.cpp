@@ -17,6 +17,7 @@
 #include "InputGlobal.h"
 #include "OutputSegment.h"
 #include "SymbolTable.h"
+#include "lld/Common/Threads.h"
 #include "llvm/Support/Path.h"
 
 using namespace llvm;
@@ -482,13 +483,25 @@ void NameSection::writeBody() {
       writeStr(Sub.OS, toString(*S), "symbol name");
     }
   }
-  for (const InputFunction *F : Out.FunctionSec->InputFunctions) {
+
+  // Demangling is the expensive part of building this section, so demangle
+  // the names of all functions without a debug name in parallel first.
+  ArrayRef<InputFunction *> Functions = Out.FunctionSec->InputFunctions;
+  std::vector<std::string> Demangled(Functions.size());
+  parallelForEachN(0, Functions.size(), [&](size_t I) {
+    const InputFunction *F = Functions[I];
+    if (!F->getName().empty() && F->getDebugName().empty())
+      Demangled[I] = maybeDemangleSymbol(F->getName());
+  });
+
+  for (size_t I = 0, E = Functions.size(); I != E; ++I) {
+    const InputFunction *F = Functions[I];
     if (!F->getName().empty()) {
       writeUleb128(Sub.OS, F->getFunctionIndex(), "func index");
       if (!F->getDebugName().empty()) {
         writeStr(Sub.OS, F->getDebugName(), "symbol name");
       } else {
-        writeStr(Sub.OS, maybeDemangleSymbol(F->getName()), "symbol name");
+        writeStr(Sub.OS, Demangled[I], "symbol name");
       }
     }
   }
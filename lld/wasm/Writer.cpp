@@ -180,12 +180,15 @@ void Writer::writeHeader() {
   memcpy(Buffer->getBufferStart(), Header.data(), Header.size());
 }
 
+// Sections with many input chunks write them in parallel. Nested parallel
+// loops run serially, so sections are written one at a time; apart from
+// the code, data and custom sections, they are small and prebuilt.
 void Writer::writeSections() {
   uint8_t *Buf = Buffer->getBufferStart();
-  parallelForEach(OutputSections, [Buf](OutputSection *S) {
+  for (OutputSection *S : OutputSections) {
     assert(S->isNeeded());
     S->writeTo(Buf);
-  });
+  }
 }
 
 // Fix the memory layout of the output binary.  This assigns memory offsets
@@ -44,6 +44,11 @@ public:
                       const lldb::DataBufferSP &data_buffer_sp);
 
 protected:
+  /// Reads \p num_lines cache lines starting at \p line_addr with a single
+  /// read, stopping before any line that is already cached or invalid.
+  /// Returns false if not even the first line could be read.
+  bool ReadAheadCacheLines(lldb::addr_t line_addr, uint32_t num_lines);
+
   typedef std::map<lldb::addr_t, lldb::DataBufferSP> BlockMap;
   typedef RangeArray<lldb::addr_t, lldb::addr_t, 4> InvalidRanges;
   typedef Range<lldb::addr_t, lldb::addr_t> AddrRange;
@@ -57,6 +62,10 @@ protected:
   InvalidRanges m_invalid_ranges;
   Process &m_process;
   uint32_t m_L2_cache_line_byte_size;
+  // The address of the line after the last read from the process, and the
+  // number of lines to read on the next miss if it is at that address.
+  lldb::addr_t m_next_sequential_line_addr;
+  uint32_t m_read_ahead_lines;
 
 private:
   DISALLOW_COPY_AND_ASSIGN(MemoryCache);
@@ -1046,6 +1046,18 @@ public:
       const EvaluateExpressionOptions &options,
       ValueObject *ctx_obj, Status &error);
 
+  // UserExpression::Evaluate keeps the expressions that parsed successfully
+  // here, under a key made of their text and of the context and options they
+  // were parsed with, so that evaluating them again doesn't parse them again.
+  // The cache is cleared whenever modules are loaded or unloaded.
+
+  lldb::UserExpressionSP GetParsedUserExpression(llvm::StringRef key);
+
+  void AddParsedUserExpression(llvm::StringRef key,
+                               const lldb::UserExpressionSP &user_expr_sp);
+
+  void ClearParsedUserExpressions() { m_parsed_user_expressions.clear(); }
+
   // Creates a FunctionCaller for the given language, the rest of the
   // parameters have the same meaning as for the FunctionCaller constructor.
   // Since a FunctionCaller can't be
@@ -1299,6 +1311,8 @@ protected:
 
   lldb::SourceManagerUP m_source_manager_up;
 
+  std::map<std::string, lldb::UserExpressionSP> m_parsed_user_expressions;
+
   typedef std::map<lldb::user_id_t, StopHookSP> StopHookCollection;
   StopHookCollection m_stop_hooks;
   lldb::user_id_t m_stop_hook_next_id;
@@ -0,0 +1,104 @@
+"""
+Benchmark the time and memory taken by common commands on a large program.
+"""
+
+from __future__ import print_function
+
+import resource
+import sys
+
+import lldb
+from lldbsuite.test.decorators import *
+from lldbsuite.test.lldbbench import *
+from lldbsuite.test.lldbtest import *
+from lldbsuite.test import lldbutil
+
+
+class LargeProgramBench(BenchBase):
+
+    mydir = TestBase.compute_mydir(__file__)
+
+    OPERATIONS = ["target create", "breakpoint set -n", "process launch",
+                  "bt", "frame variable", "expression"]
+
+    def setUp(self):
+        BenchBase.setUp(self)
+        self.count = 5
+        self.stopwatches = {op: Stopwatch() for op in self.OPERATIONS}
+        self.max_rss_growth = {op: 0 for op in self.OPERATIONS}
+
+    @benchmarks_test
+    @skipIfWindows
+    def test_large_program_commands(self):
+        """Benchmark target create, breakpoint set, bt, frame variable and
+        expression on a program with many compile units."""
+        self.build()
+        exe = self.getBuildArtifact("a.out")
+
+        for i in range(self.count):
+            self.run_commands(exe)
+
+        for op in self.OPERATIONS:
+            print("%s: %s, max RSS growth %d KB" %
+                  (op, self.stopwatches[op], self.max_rss_growth[op]))
+
+    def max_rss_kb(self):
+        max_rss = resource.getrusage(resource.RUSAGE_SELF).ru_maxrss
+        # macOS reports bytes, other systems report kilobytes.
+        if sys.platform == "darwin":
+            max_rss //= 1024
+        return max_rss
+
+    def measure(self, op, fn):
+        """Time fn under the stopwatch of op and record how much it grew the
+        peak memory use of the process."""
+        max_rss = self.max_rss_kb()
+        with self.stopwatches[op]:
+            result = fn()
+        self.max_rss_growth[op] = max(self.max_rss_growth[op],
+                                      self.max_rss_kb() - max_rss)
+        return result
+
+    def handle_command(self, command):
+        result = lldb.SBCommandReturnObject()
+        self.dbg.GetCommandInterpreter().HandleCommand(command, result)
+        self.assertTrue(result.Succeeded(), result.GetError())
+
+    def run_commands(self, exe):
+        target = self.measure("target create",
+                              lambda: self.dbg.CreateTarget(exe))
+        self.assertTrue(target, VALID_TARGET)
+
+        bkpt = self.measure("breakpoint set -n",
+                            lambda: target.BreakpointCreateByName("stop_here"))
+        self.assertTrue(bkpt.GetNumLocations() > 0, VALID_BREAKPOINT)
+
+        process = self.measure(
+            "process launch",
+            lambda: target.LaunchSimple(
+                None, None, self.get_process_working_directory()))
+        self.assertTrue(process, PROCESS_IS_VALID)
+        thread = lldbutil.get_stopped_thread(process,
+                                             lldb.eStopReasonBreakpoint)
+        self.assertTrue(thread, "There should be a thread stopped at the "
+                        "breakpoint")
+
+        self.measure("bt", lambda: self.handle_command("bt"))
+
+        # Select the frame of the last generated unit, which has a local of
+        # a large class type.
+        thread.SetSelectedFrame(1)
+        self.measure("frame variable",
+                     lambda: self.handle_command("frame variable"))
+
+        frame = thread.GetSelectedFrame()
+        value = self.measure(
+            "expression",
+            lambda: frame.EvaluateExpression("local.Get49() + depth"))
+        self.assertTrue(value.GetError().Success(), value.GetError())
+
+        process.Kill()
+        self.dbg.DeleteTarget(target)
+        # Drop the modules of the target, so that the next target create
+        # parses them again.
+        lldb.SBDebugger.MemoryPressureDetected()
@@ -0,0 +1,61 @@
+"""
+Generate the source of a compile unit of the large program benchmark.
+
+Usage: generate.py <unit> <num_units>
+
+Each unit defines a namespace with a chain of class types, a set of
+functions using them, and an entry point that calls the entry point of the
+next unit, so that the stop in the last one has a frame per unit.
+"""
+
+from __future__ import print_function
+
+import sys
+
+NUM_TYPES = 50
+NUM_FUNCTIONS = 50
+
+
+def generate(unit, num_units):
+    ns = "unit%d" % unit
+    print("#include <map>")
+    print("#include <string>")
+    print("#include <vector>")
+    print()
+    if unit < num_units:
+        print("int unit_entry_%d(int depth);" % (unit + 1))
+    else:
+        print("int stop_here(int depth);")
+    print()
+    print("namespace %s {" % ns)
+    print("struct Type0 { int value; };")
+    for i in range(1, NUM_TYPES):
+        print("struct Type%d : Type%d {" % (i, i - 1))
+        print("  Type%d *prev;" % (i - 1))
+        print("  std::string name;")
+        print("  std::vector<Type%d> children;" % (i - 1))
+        print("  std::map<int, double> values;")
+        print("  int Get%d() const { return value + %d; }" % (i, i))
+        print("};")
+    for i in range(NUM_FUNCTIONS):
+        last = NUM_TYPES - 1
+        print("int Function%d(const Type%d &t) {" % (i, last))
+        print("  return t.Get%d() + %d;" % (last, i))
+        print("}")
+    print("} // namespace %s" % ns)
+    print()
+    print("int unit_entry_%d(int depth) {" % unit)
+    print("  %s::Type%d local;" % (ns, NUM_TYPES - 1))
+    print("  local.value = depth;")
+    print("  local.name = \"%s\";" % ns)
+    print("  local.values[depth] = depth;")
+    if unit < num_units:
+        print("  return %s::Function0(local) + unit_entry_%d(depth + 1);" %
+              (ns, unit + 1))
+    else:
+        print("  return %s::Function0(local) + stop_here(depth + 1);" % ns)
+    print("}")
+
+
+if __name__ == "__main__":
+    generate(int(sys.argv[1]), int(sys.argv[2]))
@@ -0,0 +1,11 @@
+int unit_entry_1(int depth);
+
+int stop_here(int depth) {
+  int result = depth * 2; // Set break point at this line.
+  return result;
+}
+
+int main(int argc, char const *argv[]) {
+  unit_entry_1(argc);
+  return 0;
+}
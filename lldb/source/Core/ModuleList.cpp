@@ -80,9 +80,18 @@ static constexpr PropertyDefinition g_properties[] = {
     },
     {"clang-modules-cache-path", OptionValue::eTypeFileSpec, true, 0, nullptr,
      {},
-     "The path to the clang modules cache directory (-fmodules-cache-path)."}};
-
-enum { ePropertyEnableExternalLookup, ePropertyClangModulesCachePath };
+     "The path to the clang modules cache directory (-fmodules-cache-path)."},
+    {"dwarf-index-cache-path", OptionValue::eTypeFileSpec, true, 0, nullptr,
+     {},
+     "The path to a directory in which the indexes of the DWARF of modules "
+     "without accelerator tables are cached between sessions. The cache is "
+     "disabled if this is empty."}};
+
+enum {
+  ePropertyEnableExternalLookup,
+  ePropertyClangModulesCachePath,
+  ePropertyDWARFIndexCachePath
+};
 
 } // namespace
 
@@ -119,6 +128,18 @@ bool ModuleListProperties::SetClangModulesCachePath(llvm::StringRef path) {
       nullptr, ePropertyClangModulesCachePath, path);
 }
 
+FileSpec ModuleListProperties::GetDWARFIndexCachePath() const {
+  return m_collection_sp
+      ->GetPropertyAtIndexAsOptionValueFileSpec(nullptr, false,
+                                                ePropertyDWARFIndexCachePath)
+      ->GetCurrentValue();
+}
+
+bool ModuleListProperties::SetDWARFIndexCachePath(llvm::StringRef path) {
+  return m_collection_sp->SetPropertyAtIndexAsString(
+      nullptr, ePropertyDWARFIndexCachePath, path);
+}
+
 ModuleList::ModuleList()
     : m_modules(), m_modules_mutex(), m_notifier(nullptr) {}
 
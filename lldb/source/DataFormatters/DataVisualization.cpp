@@ -128,8 +128,10 @@ void DataVisualization::Categories::Enable(ConstString category,
 
 void DataVisualization::Categories::Enable(lldb::LanguageType lang_type) {
   if (LanguageCategory *lang_category =
-          GetFormatManager().GetCategoryForLanguage(lang_type))
+          GetFormatManager().GetCategoryForLanguage(lang_type)) {
     lang_category->Enable();
+    GetFormatManager().Changed();
+  }
 }
 
 void DataVisualization::Categories::Disable(ConstString category) {
@@ -139,8 +141,10 @@ void DataVisualization::Categories::Disable(ConstString category) {
 
 void DataVisualization::Categories::Disable(lldb::LanguageType lang_type) {
   if (LanguageCategory *lang_category =
-          GetFormatManager().GetCategoryForLanguage(lang_type))
+          GetFormatManager().GetCategoryForLanguage(lang_type)) {
     lang_category->Disable();
+    GetFormatManager().Changed();
+  }
 }
 
 void DataVisualization::Categories::Enable(
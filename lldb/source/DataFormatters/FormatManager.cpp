@@ -156,6 +156,8 @@ void FormatManager::EnableAllCategories() {
     if (iter.second)
       iter.second->Enable();
   }
+  // The cache also holds the formatters found in the language categories.
+  Changed();
 }
 
 void FormatManager::DisableAllCategories() {
@@ -165,6 +167,8 @@ void FormatManager::DisableAllCategories() {
     if (iter.second)
       iter.second->Disable();
   }
+  // The cache also holds the formatters found in the language categories.
+  Changed();
 }
 
 void FormatManager::GetPossibleMatches(
@@ -662,9 +666,7 @@ FormatManager::GetFormat(ValueObject &valobj,
     }
     if (retval) {
       if (log)
-        log->Printf(
-            "[FormatManager::GetFormat] Language search success. Returning.");
-      return retval;
+        log->Printf("[FormatManager::GetFormat] Language search success.");
     }
   }
   if (!retval) {
@@ -741,8 +743,7 @@ FormatManager::GetSummaryFormat(ValueObject &valobj,
     if (retval) {
       if (log)
         log->Printf("[FormatManager::GetSummaryFormat] Language search "
-                    "success. Returning.");
-      return retval;
+                    "success.");
     }
   }
   if (!retval) {
@@ -819,8 +820,7 @@ FormatManager::GetSyntheticChildren(ValueObject &valobj,
     if (retval) {
       if (log)
         log->Printf("[FormatManager::GetSyntheticChildren] Language search "
-                    "success. Returning.");
-      return retval;
+                    "success.");
     }
   }
   if (!retval) {
@@ -883,9 +883,7 @@ FormatManager::GetValidator(ValueObject &valobj,
     }
     if (retval) {
       if (log)
-        log->Printf("[FormatManager::GetValidator] Language search success. "
-                    "Returning.");
-      return retval;
+        log->Printf("[FormatManager::GetValidator] Language search success.");
     }
   }
   if (!retval) {
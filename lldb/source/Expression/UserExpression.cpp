@@ -41,6 +41,7 @@
 #include "lldb/Utility/ConstString.h"
 #include "lldb/Utility/Log.h"
 #include "lldb/Utility/StreamString.h"
+#include "llvm/Support/FormatVariadic.h"
 
 using namespace lldb_private;
 
@@ -218,19 +219,47 @@ lldb::ExpressionResults UserExpression::Evaluate(
       language = frame->GetLanguage();
   }
 
-  lldb::UserExpressionSP user_expression_sp(
-      target->GetUserExpressionForLanguage(expr, full_prefix, language,
-                                           desired_type, options, ctx_obj,
-                                           error));
-  if (error.Fail()) {
-    if (log)
-      log->Printf("== [UserExpression::Evaluate] Getting expression: %s ==",
-                  error.AsCString());
-    return lldb::eExpressionSetupError;
+  // Reuse the expression if it was already parsed at this location with the
+  // same options. Expressions that refer to persistent variables or registers
+  // are parsed again, as their meaning can change between evaluations, and
+  // top level expressions are only evaluated once anyway.
+  std::string cache_key;
+  if (!ctx_obj && execution_policy != eExecutionPolicyTopLevel &&
+      expr.find('$') == llvm::StringRef::npos &&
+      full_prefix.find('$') == llvm::StringRef::npos) {
+    lldb::addr_t pc = LLDB_INVALID_ADDRESS;
+    if (StackFrame *frame = exe_ctx.GetFramePtr())
+      pc = frame->GetFrameCodeAddress().GetLoadAddress(target);
+    cache_key = llvm::formatv("{0};{1};{2};{3};{4:x};{5}\n{6}", language,
+                              desired_type, execution_policy,
+                              options.GetGenerateDebugInfo(), pc,
+                              full_prefix.size(), full_prefix)
+                    .str();
+    cache_key.append(expr.data(), expr.size());
+  }
+
+  lldb::UserExpressionSP user_expression_sp;
+  if (!cache_key.empty()) {
+    user_expression_sp = target->GetParsedUserExpression(cache_key);
+    if (user_expression_sp && !user_expression_sp->MatchesContext(exe_ctx))
+      user_expression_sp.reset();
+  }
+  const bool reuse_parsed_expression = bool(user_expression_sp);
+
+  if (!reuse_parsed_expression) {
+    user_expression_sp.reset(target->GetUserExpressionForLanguage(
+        expr, full_prefix, language, desired_type, options, ctx_obj, error));
+    if (error.Fail()) {
+      if (log)
+        log->Printf("== [UserExpression::Evaluate] Getting expression: %s ==",
+                    error.AsCString());
+      return lldb::eExpressionSetupError;
+    }
   }
 
   if (log)
-    log->Printf("== [UserExpression::Evaluate] Parsing expression %s ==",
+    log->Printf("== [UserExpression::Evaluate] %s expression %s ==",
+                reuse_parsed_expression ? "Reusing parsed" : "Parsing",
                 expr.str().c_str());
 
   const bool keep_expression_in_memory = true;
@@ -246,8 +275,11 @@ lldb::ExpressionResults UserExpression::Evaluate(
   DiagnosticManager diagnostic_manager;
 
   bool parse_success =
+      reuse_parsed_expression ||
       user_expression_sp->Parse(diagnostic_manager, exe_ctx, execution_policy,
                                 keep_expression_in_memory, generate_debug_info);
+  if (parse_success && !reuse_parsed_expression && !cache_key.empty())
+    target->AddParsedUserExpression(cache_key, user_expression_sp);
 
   // Calculate the fixed expression always, since we need it for errors.
   std::string tmp_fixed_expression;
@@ -317,6 +349,9 @@ lldb::ExpressionResults UserExpression::Evaluate(
         error.SetExpressionError(lldb::eExpressionSetupError,
                                  "expression needed to run but couldn't");
     } else if (execution_policy == eExecutionPolicyTopLevel) {
+      // The new top level declarations can change the meaning of the
+      // expressions that were already parsed.
+      target->ClearParsedUserExpressions();
       error.SetError(UserExpression::kNoResult, lldb::eErrorTypeGeneric);
       return lldb::eExpressionCompleted;
     } else {
@@ -14,6 +14,7 @@
 #include "lldb/Core/ModuleSpec.h"
 #include "lldb/Core/PluginManager.h"
 #include "lldb/Core/Section.h"
+#include "lldb/Host/TaskPool.h"
 #include "lldb/Symbol/Function.h"
 #include "lldb/Symbol/ObjectFile.h"
 #include "lldb/Target/MemoryRegionInfo.h"
@@ -553,6 +554,37 @@ ModuleSP DynamicLoaderPOSIXDYLD::LoadInterpreterModule() {
   return nullptr;
 }
 
+// Creates the modules of the given files and parses their object files and
+// symbol tables in parallel. The modules end up in the shared module list,
+// where LoadModuleAtAddress then finds them, so that only adding them to the
+// target is done serially. The returned modules keep them alive until then.
+static std::vector<ModuleSP>
+PrefetchModules(Process &process, const std::vector<FileSpec> &files) {
+  Target &target = process.GetTarget();
+  PlatformSP platform_sp = target.GetPlatform();
+  // Remote platforms may download the modules, which they do one at a time.
+  if (!platform_sp || !platform_sp->IsHost())
+    return {};
+
+  const FileSpecList search_paths = target.GetExecutableSearchPaths();
+  std::vector<ModuleSP> modules(files.size());
+  auto prefetch_fn = [&](size_t idx) {
+    ModuleSpec module_spec(files[idx], target.GetArchitecture());
+    if (target.GetImages().FindFirstModule(module_spec))
+      return;
+    ModuleSP module_sp;
+    platform_sp->GetSharedModule(module_spec, &process, module_sp,
+                                 &search_paths, nullptr, nullptr);
+    if (!module_sp)
+      return;
+    if (ObjectFile *objfile = module_sp->GetObjectFile())
+      objfile->GetSymtab();
+    modules[idx] = std::move(module_sp);
+  };
+  TaskMapOverInt(0, files.size(), prefetch_fn);
+  return modules;
+}
+
 void DynamicLoaderPOSIXDYLD::LoadAllCurrentModules() {
   DYLDRendezvous::iterator I;
   DYLDRendezvous::iterator E;
@@ -579,6 +611,8 @@ void DynamicLoaderPOSIXDYLD::LoadAllCurrentModules() {
     module_names.push_back(I->file_spec);
   m_process->PrefetchModuleSpecs(
       module_names, m_process->GetTarget().GetArchitecture().GetTriple());
+  std::vector<ModuleSP> prefetched_modules =
+      PrefetchModules(*m_process, module_names);
 
   for (I = m_rendezvous.begin(), E = m_rendezvous.end(); I != E; ++I) {
     ModuleSP module_sp =
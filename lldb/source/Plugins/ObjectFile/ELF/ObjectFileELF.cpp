@@ -20,14 +20,19 @@
 #include "lldb/Host/FileSystem.h"
 #include "lldb/Symbol/DWARFCallFrameInfo.h"
 #include "lldb/Symbol/SymbolContext.h"
+#include "lldb/Target/MemoryRegionInfo.h"
+#include "lldb/Target/Process.h"
+#include "lldb/Target/RegisterContext.h"
 #include "lldb/Target/SectionLoadList.h"
 #include "lldb/Target/Target.h"
+#include "lldb/Target/Thread.h"
 #include "lldb/Utility/ArchSpec.h"
 #include "lldb/Utility/DataBufferHeap.h"
 #include "lldb/Utility/Log.h"
 #include "lldb/Utility/RangeMap.h"
 #include "lldb/Utility/Status.h"
 #include "lldb/Utility/Stream.h"
+#include "lldb/Utility/StreamString.h"
 #include "lldb/Utility/Timer.h"
 
 #include "llvm/ADT/IntervalMap.h"
@@ -340,7 +345,8 @@ const uint32_t ObjectFileELF::g_core_uuid_magic(0xE210C);
 void ObjectFileELF::Initialize() {
   PluginManager::RegisterPlugin(GetPluginNameStatic(),
                                 GetPluginDescriptionStatic(), CreateInstance,
-                                CreateMemoryInstance, GetModuleSpecifications);
+                                CreateMemoryInstance, GetModuleSpecifications,
+                                SaveCore);
 }
 
 void ObjectFileELF::Terminate() {
@@ -3375,3 +3381,322 @@ ObjectFileELF::GetLoadableData(Target &target) {
   }
   return loadables;
 }
+
+namespace {
+/// A PT_LOAD segment of a core file, with the memory region it describes.
+struct CoreSegment {
+  lldb::addr_t vaddr;
+  lldb::addr_t size;
+  uint32_t flags;
+  lldb::offset_t file_offset;
+};
+} // namespace
+
+// Appends a note with the "CORE" owner to notes. All the fields of the notes
+// of a core file are 4-byte aligned.
+static void AppendCoreNote(StreamString &notes, uint32_t type,
+                           llvm::StringRef desc) {
+  static const char g_core_owner[] = "CORE";
+  notes.PutHex32(sizeof(g_core_owner));
+  notes.PutHex32(desc.size());
+  notes.PutHex32(type);
+  notes.PutRawBytes(g_core_owner, sizeof(g_core_owner));
+  notes.PutRawBytes("\0\0\0", llvm::alignTo(sizeof(g_core_owner), 4) -
+                                  sizeof(g_core_owner));
+  notes.PutRawBytes(desc.data(), desc.size());
+  notes.PutRawBytes("\0\0\0", llvm::alignTo(desc.size(), 4) - desc.size());
+}
+
+// Returns the NT_PRSTATUS note of a x86_64 Linux thread, with its general
+// purpose registers in the order of the kernel's user_regs_struct.
+static std::string GetLinuxX86_64PrStatus(Thread &thread) {
+  static const char *const g_gpr_names[] = {
+      "r15", "r14", "r13",    "r12", "rbp",    "rbx",     "r11",
+      "r10", "r9",  "r8",     "rax", "rcx",    "rdx",     "rsi",
+      "rdi", "orig_rax",      "rip", "cs",     "rflags",  "rsp",
+      "ss",  "fs_base",       "gs_base",       "ds",      "es",
+      "fs",  "gs"};
+
+  StreamString prstatus(Stream::eBinary, 8, eByteOrderLittle);
+  // si_signo, si_code, si_errno, pr_cursig and padding.
+  prstatus.PutHex32(0);
+  prstatus.PutHex32(0);
+  prstatus.PutHex32(0);
+  prstatus.PutHex32(0);
+  // pr_sigpend and pr_sighold.
+  prstatus.PutHex64(0);
+  prstatus.PutHex64(0);
+  // pr_pid is the thread ID, the rest of the IDs are of the process.
+  prstatus.PutHex32(thread.GetProtocolID());
+  prstatus.PutHex32(0);
+  prstatus.PutHex32(0);
+  prstatus.PutHex32(0);
+  // pr_utime, pr_stime, pr_cutime and pr_cstime.
+  for (int i = 0; i < 8; ++i)
+    prstatus.PutHex64(0);
+
+  RegisterContextSP reg_ctx_sp = thread.GetRegisterContext();
+  for (const char *name : g_gpr_names) {
+    uint64_t value = 0;
+    if (reg_ctx_sp) {
+      if (const RegisterInfo *reg_info = reg_ctx_sp->GetRegisterInfoByName(
+              name))
+        value = reg_ctx_sp->ReadRegisterAsUnsigned(reg_info, 0);
+    }
+    prstatus.PutHex64(value);
+  }
+  // pr_fpvalid and padding.
+  prstatus.PutHex32(0);
+  prstatus.PutHex32(0);
+  return prstatus.GetString();
+}
+
+// Returns the NT_PRPSINFO note of a x86_64 Linux process.
+static std::string GetLinuxX86_64PrPsInfo(Process &process) {
+  StreamString prpsinfo(Stream::eBinary, 8, eByteOrderLittle);
+  // pr_state, pr_sname, pr_zomb, pr_nice and padding.
+  prpsinfo.PutHex32(0);
+  prpsinfo.PutHex32(0);
+  // pr_flag, pr_uid and pr_gid.
+  prpsinfo.PutHex64(0);
+  prpsinfo.PutHex32(0);
+  prpsinfo.PutHex32(0);
+  // pr_pid, pr_ppid, pr_pgrp and pr_sid.
+  prpsinfo.PutHex32(process.GetID());
+  prpsinfo.PutHex32(0);
+  prpsinfo.PutHex32(0);
+  prpsinfo.PutHex32(0);
+
+  char fname[16] = {};
+  char psargs[80] = {};
+  if (ModuleSP exe_module_sp = process.GetTarget().GetExecutableModule()) {
+    llvm::StringRef name =
+        exe_module_sp->GetFileSpec().GetFilename().GetStringRef();
+    ::strncpy(fname, name.str().c_str(), sizeof(fname) - 1);
+    ::strncpy(psargs, name.str().c_str(), sizeof(psargs) - 1);
+  }
+  prpsinfo.PutRawBytes(fname, sizeof(fname));
+  prpsinfo.PutRawBytes(psargs, sizeof(psargs));
+  return prpsinfo.GetString();
+}
+
+// Writes the memory of the process described by segment to its offset in
+// core_file. Pages that are all zeros, and pages that can't be read, are
+// skipped rather than written, which leaves holes in the file that read back
+// as zeros. written_end is raised to the end of the data that was written.
+static Status WriteCoreSegmentData(Process &process, File &core_file,
+                                   const CoreSegment &segment,
+                                   lldb::offset_t &written_end) {
+  const size_t page_size = 0x1000;
+  // Read large chunks at once, so that remote processes don't need a round
+  // trip per page.
+  const size_t chunk_size = 256 * page_size;
+  std::vector<uint8_t> chunk(chunk_size);
+  static const uint8_t g_zero_page[page_size] = {};
+
+  addr_t addr = segment.vaddr;
+  addr_t end = segment.vaddr + segment.size;
+  off_t file_offset = segment.file_offset;
+  while (addr < end) {
+    const size_t bytes_to_read = std::min<addr_t>(chunk_size, end - addr);
+    // In a savecore setting, we don't really care about caching, as the data
+    // is dumped and very likely never read again, so we call
+    // ReadMemoryFromInferior to bypass it.
+    Status read_error;
+    const size_t bytes_read = process.ReadMemoryFromInferior(
+        addr, chunk.data(), bytes_to_read, read_error);
+
+    // Write the chunk one run of non-zero pages at a time. The part of the
+    // chunk that could not be read is skipped, except that if not even its
+    // first page could be read, that page is skipped and the next read
+    // starts after it.
+    const size_t bytes_valid =
+        bytes_read > 0 ? bytes_read : std::min(page_size, bytes_to_read);
+    size_t offset = 0;
+    while (offset < bytes_read) {
+      size_t run_end = offset;
+      while (run_end < bytes_read) {
+        const size_t page_bytes = std::min(page_size, bytes_read - run_end);
+        if (memcmp(&chunk[run_end], g_zero_page, page_bytes) == 0)
+          break;
+        run_end += page_bytes;
+      }
+      if (run_end > offset) {
+        if (core_file.SeekFromStart(file_offset + offset) == -1)
+          return Status("unable to seek in the core file");
+        size_t bytes_written = run_end - offset;
+        Status error = core_file.Write(&chunk[offset], bytes_written);
+        if (error.Fail())
+          return error;
+        written_end =
+            std::max<lldb::offset_t>(written_end, file_offset + run_end);
+        offset = run_end;
+      } else {
+        offset += std::min(page_size, bytes_read - offset);
+      }
+    }
+
+    addr += bytes_valid;
+    file_offset += bytes_valid;
+  }
+  return Status();
+}
+
+bool ObjectFileELF::SaveCore(const lldb::ProcessSP &process_sp,
+                             const FileSpec &outfile, Status &error) {
+  if (!process_sp)
+    return false;
+
+  const ArchSpec &arch = process_sp->GetTarget().GetArchitecture();
+  const llvm::Triple &triple = arch.GetTriple();
+  if (triple.getOS() != llvm::Triple::Linux)
+    return false;
+  if (triple.getArch() != llvm::Triple::x86_64) {
+    error.SetErrorStringWithFormat("unsupported core architecture: %s",
+                                   triple.str().c_str());
+    return true;
+  }
+
+  // Describe every readable memory region with a PT_LOAD segment.
+  std::vector<CoreSegment> segments;
+  MemoryRegionInfo range_info;
+  Status range_error = process_sp->GetMemoryRegionInfo(0, range_info);
+  if (range_error.Fail()) {
+    error.SetErrorString("process doesn't support getting memory region info");
+    return true;
+  }
+  while (range_info.GetRange().GetRangeBase() != LLDB_INVALID_ADDRESS) {
+    const addr_t addr = range_info.GetRange().GetRangeBase();
+    const addr_t size = range_info.GetRange().GetByteSize();
+    if (size == 0)
+      break;
+
+    if (range_info.GetReadable() == MemoryRegionInfo::eYes) {
+      uint32_t flags = llvm::ELF::PF_R;
+      if (range_info.GetWritable() == MemoryRegionInfo::eYes)
+        flags |= llvm::ELF::PF_W;
+      if (range_info.GetExecutable() == MemoryRegionInfo::eYes)
+        flags |= llvm::ELF::PF_X;
+      segments.push_back({addr, size, flags, 0});
+    }
+
+    const addr_t next_addr = range_info.GetRange().GetRangeEnd();
+    if (next_addr <= addr)
+      break;
+    range_error = process_sp->GetMemoryRegionInfo(next_addr, range_info);
+    if (range_error.Fail())
+      break;
+  }
+
+  // The notes, in the order in which Linux writes them: the first thread,
+  // which is the one that stopped, the process information and the auxiliary
+  // vector, and then the rest of the threads.
+  StreamString notes(Stream::eBinary, 8, eByteOrderLittle);
+  ThreadList &thread_list = process_sp->GetThreadList();
+  const uint32_t num_threads = thread_list.GetSize();
+  for (uint32_t thread_idx = 0; thread_idx < num_threads; ++thread_idx) {
+    ThreadSP thread_sp = thread_list.GetThreadAtIndex(thread_idx);
+    if (!thread_sp)
+      continue;
+    AppendCoreNote(notes, NT_PRSTATUS,
+                   GetLinuxX86_64PrStatus(*thread_sp));
+    if (thread_idx == 0) {
+      AppendCoreNote(notes, NT_PRPSINFO,
+                     GetLinuxX86_64PrPsInfo(*process_sp));
+      DataExtractor auxv = process_sp->GetAuxvData();
+      if (auxv.GetByteSize() > 0)
+        AppendCoreNote(notes, NT_AUXV,
+                       llvm::StringRef(reinterpret_cast<const char *>(
+                                           auxv.GetDataStart()),
+                                       auxv.GetByteSize()));
+    }
+  }
+
+  // Lay out the file: the ELF header, the program headers, the notes and the
+  // page-aligned data of the segments.
+  const size_t num_phdrs = segments.size() + 1;
+  const lldb::offset_t notes_offset =
+      sizeof(llvm::ELF::Elf64_Ehdr) + num_phdrs * sizeof(llvm::ELF::Elf64_Phdr);
+  lldb::offset_t file_offset =
+      llvm::alignTo(notes_offset + notes.GetSize(), 0x1000);
+  for (CoreSegment &segment : segments) {
+    segment.file_offset = file_offset;
+    file_offset += segment.size;
+  }
+  const lldb::offset_t file_size = file_offset;
+
+  StreamString headers(Stream::eBinary, 8, eByteOrderLittle);
+  const uint8_t ident[llvm::ELF::EI_NIDENT] = {
+      0x7f, 'E', 'L', 'F', llvm::ELF::ELFCLASS64, llvm::ELF::ELFDATA2LSB,
+      llvm::ELF::EV_CURRENT, llvm::ELF::ELFOSABI_NONE};
+  headers.PutRawBytes(ident, sizeof(ident));
+  headers.PutHex16(llvm::ELF::ET_CORE);
+  headers.PutHex16(llvm::ELF::EM_X86_64);
+  headers.PutHex32(llvm::ELF::EV_CURRENT);
+  headers.PutHex64(0); // e_entry
+  headers.PutHex64(sizeof(llvm::ELF::Elf64_Ehdr)); // e_phoff
+  headers.PutHex64(0);                             // e_shoff
+  headers.PutHex32(0);                             // e_flags
+  headers.PutHex16(sizeof(llvm::ELF::Elf64_Ehdr));
+  headers.PutHex16(sizeof(llvm::ELF::Elf64_Phdr));
+  headers.PutHex16(num_phdrs);
+  headers.PutHex16(sizeof(llvm::ELF::Elf64_Shdr));
+  headers.PutHex16(0); // e_shnum
+  headers.PutHex16(0); // e_shstrndx
+
+  auto put_phdr = [&headers](uint32_t type, uint32_t flags,
+                             lldb::offset_t offset, addr_t vaddr,
+                             uint64_t size, uint64_t align) {
+    headers.PutHex32(type);
+    headers.PutHex32(flags);
+    headers.PutHex64(offset);
+    headers.PutHex64(vaddr);
+    headers.PutHex64(0); // p_paddr
+    headers.PutHex64(size);
+    headers.PutHex64(size);
+    headers.PutHex64(align);
+  };
+  put_phdr(llvm::ELF::PT_NOTE, 0, notes_offset, 0, notes.GetSize(), 4);
+  for (const CoreSegment &segment : segments)
+    put_phdr(llvm::ELF::PT_LOAD, segment.flags, segment.file_offset,
+             segment.vaddr, segment.size, 0x1000);
+
+  File core_file;
+  error = FileSystem::Instance().Open(core_file, outfile,
+                                      File::eOpenOptionWrite |
+                                          File::eOpenOptionTruncate |
+                                          File::eOpenOptionCanCreate);
+  if (error.Fail())
+    return true;
+
+  size_t bytes_written = headers.GetSize();
+  error = core_file.Write(headers.GetString().data(), bytes_written);
+  if (error.Fail())
+    return true;
+  bytes_written = notes.GetSize();
+  error = core_file.Write(notes.GetString().data(), bytes_written);
+  if (error.Fail())
+    return true;
+
+  lldb::offset_t written_end = notes_offset + notes.GetSize();
+  for (const CoreSegment &segment : segments) {
+    error = WriteCoreSegmentData(*process_sp, core_file, segment, written_end);
+    if (error.Fail())
+      return true;
+  }
+
+  // The data at the end of the last segments may have been skipped, in which
+  // case the file has to be extended to its full size.
+  if (written_end < file_size) {
+    if (core_file.SeekFromStart(file_size - 1) == -1) {
+      error.SetErrorStringWithFormat("unable to seek to offset 0x%" PRIx64
+                                     " in '%s'",
+                                     file_size - 1, outfile.GetPath().c_str());
+      return true;
+    }
+    const uint8_t zero = 0;
+    size_t zero_size = sizeof(zero);
+    error = core_file.Write(&zero, zero_size);
+  }
+  return true;
+}
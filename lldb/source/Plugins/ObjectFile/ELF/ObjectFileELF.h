@@ -86,6 +86,10 @@ public:
   static bool MagicBytesMatch(lldb::DataBufferSP &data_sp, lldb::addr_t offset,
                               lldb::addr_t length);
 
+  static bool SaveCore(const lldb::ProcessSP &process_sp,
+                       const lldb_private::FileSpec &outfile,
+                       lldb_private::Status &error);
+
   // PluginInterface protocol
   lldb_private::ConstString GetPluginName() override;
 
@@ -31,6 +31,7 @@
 #include "lldb/Target/MemoryRegionInfo.h"
 #include "lldb/Utility/Args.h"
 #include "lldb/Utility/DataBuffer.h"
+#include "lldb/Utility/DataExtractor.h"
 #include "lldb/Utility/Endian.h"
 #include "lldb/Utility/JSON.h"
 #include "lldb/Utility/LLDBAssert.h"
@@ -465,6 +466,59 @@ static JSONObject::SP GetRegistersAsJSON(NativeThreadProtocol &thread) {
   return register_object_sp;
 }
 
+namespace {
+/// A block of inferior memory that is sent to the client ahead of time.
+struct ExpeditedMemory {
+  lldb::addr_t address;
+  std::vector<uint8_t> bytes;
+};
+} // namespace
+
+/// Returns the frame records (saved frame pointer and return address) of the
+/// frame pointer chain of the thread, so that the client can backtrace the
+/// thread without reading them from the stack one round-trip at a time.
+static std::vector<ExpeditedMemory>
+GetExpeditedStackMemory(NativeProcessProtocol &process,
+                        NativeThreadProtocol &thread) {
+  std::vector<ExpeditedMemory> records;
+
+  // Only walk the chains of the architectures whose frame records are laid
+  // out as {saved frame pointer, return address}.
+  switch (process.GetArchitecture().GetMachine()) {
+  case llvm::Triple::x86:
+  case llvm::Triple::x86_64:
+  case llvm::Triple::aarch64:
+    break;
+  default:
+    return records;
+  }
+
+  const uint32_t addr_size = process.GetAddressByteSize();
+  const lldb::ByteOrder byte_order = process.GetByteOrder();
+  // Stop at the first frame pointer that doesn't look like it points further
+  // up the stack, or after enough frames for a typical backtrace.
+  const size_t k_max_frames = 64;
+  const lldb::addr_t k_max_frame_size = 1024 * 1024;
+  lldb::addr_t fp = thread.GetRegisterContext().GetFP(0);
+  while (fp != 0 && fp % addr_size == 0 && records.size() < k_max_frames) {
+    ExpeditedMemory record{fp, std::vector<uint8_t>(2 * addr_size)};
+    size_t bytes_read = 0;
+    Status error = process.ReadMemory(fp, record.bytes.data(),
+                                      record.bytes.size(), bytes_read);
+    if (error.Fail() || bytes_read != record.bytes.size())
+      break;
+    DataExtractor data(record.bytes.data(), record.bytes.size(), byte_order,
+                       addr_size);
+    lldb::offset_t offset = 0;
+    const lldb::addr_t next_fp = data.GetAddress(&offset);
+    records.push_back(std::move(record));
+    if (next_fp <= fp || next_fp - fp > k_max_frame_size)
+      break;
+    fp = next_fp;
+  }
+  return records;
+}
+
 static const char *GetStopReasonString(StopReason stop_reason) {
   switch (stop_reason) {
   case eStopReasonTrace:
@@ -558,7 +612,24 @@ static JSONArray::SP GetJSONThreadsInfo(NativeProcessProtocol &process,
       thread_obj_sp->SetObject("medata", medata_array_sp);
     }
 
-    // TODO: Expedite interesting regions of inferior memory
+    if (!abridged) {
+      std::vector<ExpeditedMemory> memory =
+          GetExpeditedStackMemory(process, *thread);
+      if (!memory.empty()) {
+        JSONArray::SP memory_array_sp = std::make_shared<JSONArray>();
+        for (const ExpeditedMemory &block : memory) {
+          JSONObject::SP block_sp = std::make_shared<JSONObject>();
+          block_sp->SetObject("address",
+                              std::make_shared<JSONNumber>(block.address));
+          StreamString bytes;
+          bytes.PutBytesAsRawHex8(block.bytes.data(), block.bytes.size());
+          block_sp->SetObject("bytes",
+                              std::make_shared<JSONString>(bytes.GetString()));
+          memory_array_sp->AppendObject(block_sp);
+        }
+        thread_obj_sp->SetObject("memory", memory_array_sp);
+      }
+    }
   }
 
   return threads_array_sp;
@@ -779,6 +850,15 @@ GDBRemoteCommunicationServerLLGS::SendStopReplyPacketForThread(
     }
   }
 
+  // Expedite the frame records of the stack, which the client reads first to
+  // backtrace the thread.
+  for (const ExpeditedMemory &block :
+       GetExpeditedStackMemory(*m_debugged_process_up, *thread)) {
+    response.Printf("memory:0x%" PRIx64 "=", block.address);
+    response.PutBytesAsRawHex8(block.bytes.data(), block.bytes.size());
+    response.PutChar(';');
+  }
+
   return SendPacketNoLock(response.GetString());
 }
 
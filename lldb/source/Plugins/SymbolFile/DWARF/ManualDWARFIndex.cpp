@@ -13,10 +13,18 @@
 #include "Plugins/SymbolFile/DWARF/LogChannelDWARF.h"
 #include "Plugins/SymbolFile/DWARF/SymbolFileDWARFDwo.h"
 #include "lldb/Core/Module.h"
+#include "lldb/Core/ModuleList.h"
 #include "lldb/Host/TaskPool.h"
 #include "lldb/Symbol/ObjectFile.h"
+#include "lldb/Utility/DataExtractor.h"
 #include "lldb/Utility/Stream.h"
 #include "lldb/Utility/Timer.h"
+#include "llvm/Support/Chrono.h"
+#include "llvm/Support/EndianStream.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/FormatVariadic.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
 
 using namespace lldb_private;
 using namespace lldb;
@@ -31,6 +39,10 @@ void ManualDWARFIndex::Index() {
   static Timer::Category func_cat(LLVM_PRETTY_FUNCTION);
   Timer scoped_timer(func_cat, "%p", static_cast<void *>(&debug_info));
 
+  const std::string cache_path = GetCacheFilePath();
+  if (!cache_path.empty() && LoadFromCache(cache_path))
+    return;
+
   std::vector<DWARFUnit *> units_to_index;
   units_to_index.reserve(debug_info.GetNumUnits());
   for (size_t U = 0; U < debug_info.GetNumUnits(); ++U) {
@@ -85,6 +97,121 @@ void ManualDWARFIndex::Index() {
                      [&]() { finalize_fn(&IndexSet::globals); },
                      [&]() { finalize_fn(&IndexSet::types); },
                      [&]() { finalize_fn(&IndexSet::namespaces); });
+
+  // The dwo files can change without the module changing, so don't cache
+  // indexes that refer to their DIEs.
+  if (!cache_path.empty() &&
+      llvm::none_of(units_to_index, [](DWARFUnit *unit) {
+        return unit->GetDwoSymbolFile() != nullptr;
+      }))
+    SaveToCache(cache_path);
+}
+
+// Index cache files start with a magic number and a version, followed by the
+// index sets in the order of GetCachedIndexSets(). The version must be bumped
+// whenever the encoding or the contents of the index change.
+static constexpr uint32_t g_index_cache_magic = 0x58444944; // "DIDX"
+static constexpr uint32_t g_index_cache_version = 1;
+
+std::string ManualDWARFIndex::GetCacheFilePath() {
+  // An index that skips some units is only a part of the index of the module.
+  if (!m_units_to_avoid.empty())
+    return std::string();
+  FileSpec cache_dir =
+      ModuleList::GetGlobalModuleListProperties().GetDWARFIndexCachePath();
+  const UUID &uuid = m_module.GetUUID();
+  if (!cache_dir || !uuid)
+    return std::string();
+  llvm::SmallString<128> path(cache_dir.GetPath());
+  llvm::sys::path::append(
+      path, llvm::formatv("{0}-{1}.dwarf-index", uuid.GetAsString(""),
+                          llvm::sys::toTimeT(m_module.GetModificationTime()))
+                .str());
+  return path.str();
+}
+
+llvm::ArrayRef<NameToDIE ManualDWARFIndex::IndexSet::*>
+ManualDWARFIndex::GetCachedIndexSets() {
+  static NameToDIE IndexSet::*const sets[] = {
+      &IndexSet::function_basenames, &IndexSet::function_fullnames,
+      &IndexSet::function_methods,   &IndexSet::function_selectors,
+      &IndexSet::objc_class_selectors, &IndexSet::globals,
+      &IndexSet::types,              &IndexSet::namespaces};
+  return sets;
+}
+
+bool ManualDWARFIndex::LoadFromCache(llvm::StringRef path) {
+  // Large files are mapped rather than read.
+  auto buffer_or_error =
+      llvm::MemoryBuffer::getFile(path, /*FileSize=*/-1,
+                                  /*RequiresNullTerminator=*/false);
+  if (!buffer_or_error)
+    return false;
+  llvm::MemoryBuffer &buffer = **buffer_or_error;
+  DataExtractor data(buffer.getBufferStart(), buffer.getBufferSize(),
+                     eByteOrderLittle, 4);
+
+  lldb::offset_t offset = 0;
+  if (!data.ValidOffsetForDataOfSize(offset, 8) ||
+      data.GetU32(&offset) != g_index_cache_magic ||
+      data.GetU32(&offset) != g_index_cache_version)
+    return false;
+  for (NameToDIE IndexSet::*index : GetCachedIndexSets()) {
+    if (!(m_set.*index).Decode(data, &offset)) {
+      m_set = IndexSet();
+      return false;
+    }
+  }
+
+  Log *log = LogChannelDWARF::GetLogIfAll(DWARF_LOG_DEBUG_INFO);
+  if (log)
+    m_module.LogMessage(log, "ManualDWARFIndex loaded the index from '%s'",
+                        path.str().c_str());
+  return true;
+}
+
+void ManualDWARFIndex::SaveToCache(llvm::StringRef path) {
+  Log *log = LogChannelDWARF::GetLogIfAll(DWARF_LOG_DEBUG_INFO);
+  if (std::error_code ec = llvm::sys::fs::create_directories(
+          llvm::sys::path::parent_path(path))) {
+    if (log)
+      m_module.LogMessage(log, "ManualDWARFIndex can't create the cache "
+                               "directory of '%s': %s",
+                          path.str().c_str(), ec.message().c_str());
+    return;
+  }
+
+  // Write to a temporary file first, so that concurrent sessions never read
+  // a partial index.
+  int fd;
+  llvm::SmallString<128> temp_path;
+  if (std::error_code ec = llvm::sys::fs::createUniqueFile(
+          path + ".tmp-%%%%%%%%", fd, temp_path)) {
+    if (log)
+      m_module.LogMessage(log, "ManualDWARFIndex can't create '%s': %s",
+                          path.str().c_str(), ec.message().c_str());
+    return;
+  }
+
+  llvm::raw_fd_ostream os(fd, /*shouldClose=*/true);
+  llvm::support::endian::write<uint32_t>(os, g_index_cache_magic,
+                                         llvm::support::little);
+  llvm::support::endian::write<uint32_t>(os, g_index_cache_version,
+                                         llvm::support::little);
+  for (NameToDIE IndexSet::*index : GetCachedIndexSets())
+    (m_set.*index).Encode(os);
+  os.close();
+
+  std::error_code ec = os.error();
+  os.clear_error();
+  if (!ec)
+    ec = llvm::sys::fs::rename(temp_path, path);
+  if (ec) {
+    llvm::sys::fs::remove(temp_path);
+    if (log)
+      m_module.LogMessage(log, "ManualDWARFIndex can't write '%s': %s",
+                          path.str().c_str(), ec.message().c_str());
+  }
 }
 
 void ManualDWARFIndex::IndexUnit(DWARFUnit &unit, IndexSet &set) {
@@ -11,6 +11,7 @@
 
 #include "Plugins/SymbolFile/DWARF/DWARFIndex.h"
 #include "Plugins/SymbolFile/DWARF/NameToDIE.h"
+#include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/DenseSet.h"
 
 class DWARFDebugInfo;
@@ -58,6 +59,14 @@ private:
   void Index();
   void IndexUnit(DWARFUnit &unit, IndexSet &set);
 
+  /// Returns the path of the file caching the index of the module, or an
+  /// empty string if the index of this module should not be cached.
+  std::string GetCacheFilePath();
+  /// The index sets, in the order in which they are stored in cache files.
+  static llvm::ArrayRef<NameToDIE IndexSet::*> GetCachedIndexSets();
+  bool LoadFromCache(llvm::StringRef path);
+  void SaveToCache(llvm::StringRef path);
+
   static void IndexUnitImpl(DWARFUnit &unit,
                             const lldb::LanguageType cu_language,
                             IndexSet &set);
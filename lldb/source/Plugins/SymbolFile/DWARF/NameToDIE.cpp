@@ -10,9 +10,11 @@
 #include "DWARFUnit.h"
 #include "lldb/Symbol/ObjectFile.h"
 #include "lldb/Utility/ConstString.h"
+#include "lldb/Utility/DataExtractor.h"
 #include "lldb/Utility/RegularExpression.h"
 #include "lldb/Utility/Stream.h"
 #include "lldb/Utility/StreamString.h"
+#include "llvm/Support/EndianStream.h"
 
 using namespace lldb;
 using namespace lldb_private;
@@ -76,3 +78,59 @@ void NameToDIE::Append(const NameToDIE &other) {
                  other.m_map.GetValueAtIndexUnchecked(i));
   }
 }
+
+// Each entry is encoded as the NUL-terminated name, followed by the dwo number
+// and section of the DIERef packed in a uint32_t and the DIE offset. All the
+// integers are little endian.
+static constexpr uint32_t g_dwo_num_valid_bit = 1u << 30;
+static constexpr uint32_t g_section_bit = 1u << 31;
+
+void NameToDIE::Encode(llvm::raw_ostream &os) const {
+  const uint32_t size = m_map.GetSize();
+  llvm::support::endian::write<uint32_t>(os, size, llvm::support::little);
+  for (uint32_t i = 0; i < size; ++i) {
+    os << m_map.GetCStringAtIndexUnchecked(i).GetStringRef() << '\0';
+    const DIERef &die_ref = m_map.GetValueAtIndexUnchecked(i);
+    uint32_t flags = 0;
+    if (llvm::Optional<uint32_t> dwo_num = die_ref.dwo_num())
+      flags = *dwo_num | g_dwo_num_valid_bit;
+    if (die_ref.section() == DIERef::DebugTypes)
+      flags |= g_section_bit;
+    llvm::support::endian::write<uint32_t>(os, flags, llvm::support::little);
+    llvm::support::endian::write<uint32_t>(os, die_ref.die_offset(),
+                                           llvm::support::little);
+  }
+}
+
+bool NameToDIE::Decode(const DataExtractor &data, lldb::offset_t *offset_ptr) {
+  m_map.Clear();
+  if (!data.ValidOffsetForDataOfSize(*offset_ptr, sizeof(uint32_t)))
+    return false;
+  const uint32_t size = data.GetU32(offset_ptr);
+  // Each entry takes at least 9 bytes, so a bogus size can't make us reserve
+  // more memory than the data could describe.
+  if (!data.ValidOffsetForDataOfSize(*offset_ptr, uint64_t(size) * 9))
+    return false;
+  m_map.Reserve(size);
+  for (uint32_t i = 0; i < size; ++i) {
+    const char *name = data.GetCStr(offset_ptr);
+    if (!name || !data.ValidOffsetForDataOfSize(*offset_ptr, 8)) {
+      m_map.Clear();
+      return false;
+    }
+    const uint32_t flags = data.GetU32(offset_ptr);
+    const dw_offset_t die_offset = data.GetU32(offset_ptr);
+    llvm::Optional<uint32_t> dwo_num;
+    if (flags & g_dwo_num_valid_bit)
+      dwo_num = flags & (g_dwo_num_valid_bit - 1);
+    m_map.Append(ConstString(name),
+                 DIERef(dwo_num,
+                        (flags & g_section_bit) ? DIERef::DebugTypes
+                                                : DIERef::DebugInfo,
+                        die_offset));
+  }
+  // The map is sorted by the addresses of the ConstStrings, which differ
+  // between sessions.
+  Finalize();
+  return true;
+}
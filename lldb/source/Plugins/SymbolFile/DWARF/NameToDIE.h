@@ -18,6 +18,14 @@
 
 class DWARFUnit;
 
+namespace lldb_private {
+class DataExtractor;
+}
+
+namespace llvm {
+class raw_ostream;
+}
+
 class NameToDIE {
 public:
   NameToDIE() : m_map() {}
@@ -46,6 +54,16 @@ public:
                              const DIERef &die_ref)> const
               &callback) const;
 
+  /// Write the entries of the map to \p os, in a form that Decode can read
+  /// back in a later session. The map must have been finalized.
+  void Encode(llvm::raw_ostream &os) const;
+
+  /// Replace the entries of the map with the ones encoded at \p *offset_ptr
+  /// in \p data, and finalize the map. Returns false if the data is
+  /// truncated, in which case the map is left empty.
+  bool Decode(const lldb_private::DataExtractor &data,
+              lldb::offset_t *offset_ptr);
+
 protected:
   lldb_private::UniqueCStringMap<DIERef> m_map;
 };
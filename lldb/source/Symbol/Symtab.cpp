@@ -15,6 +15,7 @@
 #include "lldb/Core/RichManglingContext.h"
 #include "lldb/Core/STLUtils.h"
 #include "lldb/Core/Section.h"
+#include "lldb/Host/TaskPool.h"
 #include "lldb/Symbol/ObjectFile.h"
 #include "lldb/Symbol/Symbol.h"
 #include "lldb/Symbol/SymbolContext.h"
@@ -250,6 +251,46 @@ static bool lldb_skip_name(llvm::StringRef mangled,
   llvm_unreachable("unknown scheme!");
 }
 
+namespace {
+/// The index entries of a range of symbols, collected by one indexing task.
+struct SymbolIndexEntries {
+  struct Function {
+    Symtab::NameToIndexMap::Entry entry;
+    /// The pool string of the declaration context, or null if the function
+    /// has none.
+    const char *decl_context;
+    bool is_ctor_or_dtor;
+  };
+
+  std::vector<Symtab::NameToIndexMap::Entry> names;
+  std::vector<Symtab::NameToIndexMap::Entry> selectors;
+  std::vector<Function> functions;
+};
+} // namespace
+
+// Collects the base name and declaration context of the function whose mangled
+// name was parsed into rmc.
+static void
+CollectMangledNameEntry(uint32_t value, RichManglingContext &rmc,
+                        std::vector<SymbolIndexEntries::Function> &functions) {
+  // Only register functions that have a base name.
+  rmc.ParseFunctionBaseName();
+  llvm::StringRef base_name = rmc.GetBufferRef();
+  if (base_name.empty())
+    return;
+
+  // The base name will be our entry's name.
+  Symtab::NameToIndexMap::Entry entry(ConstString(base_name), value);
+
+  rmc.ParseFunctionDeclContextName();
+  llvm::StringRef decl_context = rmc.GetBufferRef();
+
+  // Make sure we have a pool-string pointer for the context name.
+  const char *decl_context_ccstr =
+      decl_context.empty() ? nullptr : ConstString(decl_context).GetCString();
+  functions.push_back({entry, decl_context_ccstr, rmc.IsCtorOrDtor()});
+}
+
 void Symtab::InitNameIndexes() {
   // Protected function, no need to lock mutex...
   if (!m_name_indexes_computed) {
@@ -260,71 +301,101 @@ void Symtab::InitNameIndexes() {
     const size_t num_symbols = m_symbols.size();
     m_name_to_index.Reserve(num_symbols);
 
-    // The "const char *" in "class_contexts" and backlog::value_type::second
-    // must come from a ConstString::GetCString()
-    std::set<const char *> class_contexts;
-    std::vector<std::pair<NameToIndexMap::Entry, const char *>> backlog;
-    backlog.reserve(num_symbols / 2);
-
-    // Instantiation of the demangler is expensive, so better use a single one
-    // for all entries during batch processing.
-    RichManglingContext rmc;
-    for (uint32_t value = 0; value < num_symbols; ++value) {
-      Symbol *symbol = &m_symbols[value];
-
-      // Don't let trampolines get into the lookup by name map If we ever need
-      // the trampoline symbols to be searchable by name we can remove this and
-      // then possibly add a new bool to any of the Symtab functions that
-      // lookup symbols by name to indicate if they want trampolines.
-      if (symbol->IsTrampoline())
-        continue;
+    // Demangling the names dominates the time it takes to build the indexes,
+    // so the symbols are demangled in parallel, in batches of symbols. Each
+    // task only touches the symbols of its batch, and the demangled names are
+    // shared through the string pool. The entries of the batches are then
+    // added to the maps in order, as the classification of methods depends on
+    // the order of the symbols.
+    const size_t batch_size = 4096;
+    std::vector<SymbolIndexEntries> batches((num_symbols + batch_size - 1) /
+                                            batch_size);
+
+    auto collect_fn = [&](size_t batch_idx) {
+      SymbolIndexEntries &batch = batches[batch_idx];
+      // Instantiation of the demangler is expensive, so better use a single
+      // one for all entries of the batch.
+      RichManglingContext rmc;
+      const uint32_t end =
+          std::min<size_t>(num_symbols, (batch_idx + 1) * batch_size);
+      for (uint32_t value = batch_idx * batch_size; value < end; ++value) {
+        Symbol *symbol = &m_symbols[value];
+
+        // Don't let trampolines get into the lookup by name map If we ever
+        // need the trampoline symbols to be searchable by name we can remove
+        // this and then possibly add a new bool to any of the Symtab functions
+        // that lookup symbols by name to indicate if they want trampolines.
+        if (symbol->IsTrampoline())
+          continue;
 
-      // If the symbol's name string matched a Mangled::ManglingScheme, it is
-      // stored in the mangled field.
-      Mangled &mangled = symbol->GetMangled();
-      if (ConstString name = mangled.GetMangledName()) {
-        m_name_to_index.Append(name, value);
-
-        if (symbol->ContainsLinkerAnnotations()) {
-          // If the symbol has linker annotations, also add the version without
-          // the annotations.
-          ConstString stripped = ConstString(
-              m_objfile->StripLinkerSymbolAnnotations(name.GetStringRef()));
-          m_name_to_index.Append(stripped, value);
-        }
+        // If the symbol's name string matched a Mangled::ManglingScheme, it is
+        // stored in the mangled field.
+        Mangled &mangled = symbol->GetMangled();
+        if (ConstString name = mangled.GetMangledName()) {
+          batch.names.emplace_back(name, value);
+
+          if (symbol->ContainsLinkerAnnotations()) {
+            // If the symbol has linker annotations, also add the version
+            // without the annotations.
+            ConstString stripped = ConstString(
+                m_objfile->StripLinkerSymbolAnnotations(name.GetStringRef()));
+            batch.names.emplace_back(stripped, value);
+          }
 
-        const SymbolType type = symbol->GetType();
-        if (type == eSymbolTypeCode || type == eSymbolTypeResolver) {
-          if (mangled.DemangleWithRichManglingInfo(rmc, lldb_skip_name))
-            RegisterMangledNameEntry(value, class_contexts, backlog, rmc);
+          const SymbolType type = symbol->GetType();
+          if (type == eSymbolTypeCode || type == eSymbolTypeResolver) {
+            if (mangled.DemangleWithRichManglingInfo(rmc, lldb_skip_name))
+              CollectMangledNameEntry(value, rmc, batch.functions);
+          }
         }
-      }
 
-      // Symbol name strings that didn't match a Mangled::ManglingScheme, are
-      // stored in the demangled field.
-      if (ConstString name = mangled.GetDemangledName(symbol->GetLanguage())) {
-        m_name_to_index.Append(name, value);
-
-        if (symbol->ContainsLinkerAnnotations()) {
-          // If the symbol has linker annotations, also add the version without
-          // the annotations.
-          name = ConstString(
-              m_objfile->StripLinkerSymbolAnnotations(name.GetStringRef()));
-          m_name_to_index.Append(name, value);
-        }
+        // Symbol name strings that didn't match a Mangled::ManglingScheme, are
+        // stored in the demangled field.
+        if (ConstString name =
+                mangled.GetDemangledName(symbol->GetLanguage())) {
+          batch.names.emplace_back(name, value);
+
+          if (symbol->ContainsLinkerAnnotations()) {
+            // If the symbol has linker annotations, also add the version
+            // without the annotations.
+            name = ConstString(
+                m_objfile->StripLinkerSymbolAnnotations(name.GetStringRef()));
+            batch.names.emplace_back(name, value);
+          }
 
-        // If the demangled name turns out to be an ObjC name, and is a category
-        // name, add the version without categories to the index too.
-        ObjCLanguage::MethodName objc_method(name.GetStringRef(), true);
-        if (objc_method.IsValid(true)) {
-          m_selector_to_index.Append(objc_method.GetSelector(), value);
+          // If the demangled name turns out to be an ObjC name, and is a
+          // category name, add the version without categories to the index
+          // too.
+          ObjCLanguage::MethodName objc_method(name.GetStringRef(), true);
+          if (objc_method.IsValid(true)) {
+            batch.selectors.emplace_back(objc_method.GetSelector(), value);
 
-          if (ConstString objc_method_no_category =
-                  objc_method.GetFullNameWithoutCategory(true))
-            m_name_to_index.Append(objc_method_no_category, value);
+            if (ConstString objc_method_no_category =
+                    objc_method.GetFullNameWithoutCategory(true))
+              batch.names.emplace_back(objc_method_no_category, value);
+          }
         }
       }
+    };
+    TaskMapOverInt(0, batches.size(), collect_fn);
+
+    // The "const char *" in "class_contexts" and backlog::value_type::second
+    // must come from a ConstString::GetCString()
+    std::set<const char *> class_contexts;
+    std::vector<std::pair<NameToIndexMap::Entry, const char *>> backlog;
+    backlog.reserve(num_symbols / 2);
+
+    for (const SymbolIndexEntries &batch : batches) {
+      for (const NameToIndexMap::Entry &entry : batch.names)
+        m_name_to_index.Append(entry);
+      for (const NameToIndexMap::Entry &entry : batch.selectors)
+        m_selector_to_index.Append(entry);
+      for (const SymbolIndexEntries::Function &function : batch.functions)
+        RegisterMangledNameEntry(function.entry, function.decl_context,
+                                 function.is_ctor_or_dtor, class_contexts,
+                                 backlog);
     }
+    batches.clear();
 
     for (const auto &record : backlog) {
       RegisterBacklogEntry(record.first, record.second, class_contexts);
@@ -342,23 +413,11 @@ void Symtab::InitNameIndexes() {
 }
 
 void Symtab::RegisterMangledNameEntry(
-    uint32_t value, std::set<const char *> &class_contexts,
-    std::vector<std::pair<NameToIndexMap::Entry, const char *>> &backlog,
-    RichManglingContext &rmc) {
-  // Only register functions that have a base name.
-  rmc.ParseFunctionBaseName();
-  llvm::StringRef base_name = rmc.GetBufferRef();
-  if (base_name.empty())
-    return;
-
-  // The base name will be our entry's name.
-  NameToIndexMap::Entry entry(ConstString(base_name), value);
-
-  rmc.ParseFunctionDeclContextName();
-  llvm::StringRef decl_context = rmc.GetBufferRef();
-
+    const NameToIndexMap::Entry &entry, const char *decl_context,
+    bool is_ctor_or_dtor, std::set<const char *> &class_contexts,
+    std::vector<std::pair<NameToIndexMap::Entry, const char *>> &backlog) {
   // Register functions with no context.
-  if (decl_context.empty()) {
+  if (!decl_context) {
     // This has to be a basename
     m_basename_to_index.Append(entry);
     // If there is no context (no namespaces or class scopes that come before
@@ -367,17 +426,15 @@ void Symtab::RegisterMangledNameEntry(
     return;
   }
 
-  // Make sure we have a pool-string pointer and see if we already know the
-  // context name.
-  const char *decl_context_ccstr = ConstString(decl_context).GetCString();
-  auto it = class_contexts.find(decl_context_ccstr);
+  // See if we already know the context name.
+  auto it = class_contexts.find(decl_context);
 
   // Register constructors and destructors. They are methods and create
   // declaration contexts.
-  if (rmc.IsCtorOrDtor()) {
+  if (is_ctor_or_dtor) {
     m_method_to_index.Append(entry);
     if (it == class_contexts.end())
-      class_contexts.insert(it, decl_context_ccstr);
+      class_contexts.insert(it, decl_context);
     return;
   }
 
@@ -389,7 +446,7 @@ void Symtab::RegisterMangledNameEntry(
 
   // Regular methods in unknown declaration contexts are put to the backlog. We
   // will revisit them once we processed all remaining symbols.
-  backlog.push_back(std::make_pair(entry, decl_context_ccstr));
+  backlog.push_back(std::make_pair(entry, decl_context));
 }
 
 void Symtab::RegisterBacklogEntry(
@@ -19,11 +19,16 @@
 using namespace lldb;
 using namespace lldb_private;
 
+// The maximum number of cache lines that a miss reads ahead.
+static const uint32_t g_max_read_ahead_lines = 16;
+
 // MemoryCache constructor
 MemoryCache::MemoryCache(Process &process)
     : m_mutex(), m_L1_cache(), m_L2_cache(), m_invalid_ranges(),
       m_process(process),
-      m_L2_cache_line_byte_size(process.GetMemoryCacheLineSize()) {}
+      m_L2_cache_line_byte_size(process.GetMemoryCacheLineSize()),
+      m_next_sequential_line_addr(LLDB_INVALID_ADDRESS),
+      m_read_ahead_lines(1) {}
 
 // Destructor
 MemoryCache::~MemoryCache() {}
@@ -35,6 +40,8 @@ void MemoryCache::Clear(bool clear_invalid_ranges) {
   if (clear_invalid_ranges)
     m_invalid_ranges.Clear();
   m_L2_cache_line_byte_size = m_process.GetMemoryCacheLineSize();
+  m_next_sequential_line_addr = LLDB_INVALID_ADDRESS;
+  m_read_ahead_lines = 1;
 }
 
 void MemoryCache::AddL1CacheData(lldb::addr_t addr, const void *src,
@@ -224,6 +231,20 @@ size_t MemoryCache::Read(addr_t addr, void *dst, size_t dst_len,
 
       if (bytes_left > 0) {
         assert((curr_addr % cache_line_byte_size) == 0);
+        // Misses that continue where the previous read from the process
+        // ended, e.g. when walking a large container, read twice as many
+        // lines each time, so that scanning memory doesn't cost a read (and a
+        // round-trip for remote processes) per line.
+        if (curr_addr == m_next_sequential_line_addr)
+          m_read_ahead_lines =
+              std::min(2 * m_read_ahead_lines, g_max_read_ahead_lines);
+        else
+          m_read_ahead_lines = 1;
+        m_next_sequential_line_addr = curr_addr + cache_line_byte_size;
+        if (m_read_ahead_lines > 1 &&
+            ReadAheadCacheLines(curr_addr, m_read_ahead_lines))
+          continue;
+
         std::unique_ptr<DataBufferHeap> data_buffer_heap_up(
             new DataBufferHeap(cache_line_byte_size, 0));
         size_t process_bytes_read = m_process.ReadMemoryFromInferior(
@@ -244,6 +265,41 @@ size_t MemoryCache::Read(addr_t addr, void *dst, size_t dst_len,
   return dst_len - bytes_left;
 }
 
+bool MemoryCache::ReadAheadCacheLines(addr_t line_addr, uint32_t num_lines) {
+  const uint32_t cache_line_byte_size = m_L2_cache_line_byte_size;
+  uint32_t lines_to_read = 1;
+  for (; lines_to_read < num_lines; ++lines_to_read) {
+    const addr_t next_line_addr =
+        line_addr + lines_to_read * cache_line_byte_size;
+    if (next_line_addr < line_addr || m_L2_cache.count(next_line_addr) ||
+        m_invalid_ranges.FindEntryThatContains(next_line_addr))
+      break;
+  }
+  if (lines_to_read < 2)
+    return false;
+
+  // Errors past the first line are not errors of the read that caused the
+  // miss, and a failure to read the first line is reported by the caller's
+  // single line read.
+  Status error;
+  DataBufferHeap buffer(lines_to_read * cache_line_byte_size, 0);
+  const size_t bytes_read = m_process.ReadMemoryFromInferior(
+      line_addr, buffer.GetBytes(), buffer.GetByteSize(), error);
+  if (bytes_read < cache_line_byte_size)
+    return false;
+
+  for (size_t offset = 0; offset < bytes_read;
+       offset += cache_line_byte_size) {
+    const size_t line_size =
+        std::min<size_t>(cache_line_byte_size, bytes_read - offset);
+    m_L2_cache[line_addr + offset] = DataBufferSP(
+        new DataBufferHeap(buffer.GetBytes() + offset, line_size));
+  }
+  m_next_sequential_line_addr =
+      line_addr + lines_to_read * cache_line_byte_size;
+  return true;
+}
+
 AllocatedBlock::AllocatedBlock(lldb::addr_t addr, uint32_t byte_size,
                                uint32_t permissions, uint32_t chunk_size)
     : m_range(addr, byte_size), m_permissions(permissions),
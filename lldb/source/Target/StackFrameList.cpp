@@ -9,9 +9,12 @@
 #include "lldb/Target/StackFrameList.h"
 #include "lldb/Breakpoint/Breakpoint.h"
 #include "lldb/Breakpoint/BreakpointLocation.h"
+#include "lldb/Core/Module.h"
 #include "lldb/Core/SourceManager.h"
 #include "lldb/Core/StreamFile.h"
+#include "lldb/Host/TaskPool.h"
 #include "lldb/Symbol/Block.h"
+#include "lldb/Symbol/CompileUnit.h"
 #include "lldb/Symbol/Function.h"
 #include "lldb/Symbol/Symbol.h"
 #include "lldb/Target/Process.h"
@@ -932,6 +935,55 @@ StackFrameList::GetStackFrameSPForStackFramePtr(StackFrame *stack_frame_ptr) {
   return ret_sp;
 }
 
+/// Parses the line tables that the frames [first_frame, last_frame) of \p
+/// frames are going to need when they are printed. The modules of the frames
+/// are handled in parallel: otherwise the line table of each compile unit is
+/// parsed on demand, while printing the frame that needs it.
+static void PrefetchLineTables(StackFrameList &frames, uint32_t first_frame,
+                               uint32_t last_frame) {
+  std::vector<std::pair<ModuleSP, std::vector<Address>>> module_addrs;
+  for (uint32_t frame_idx = first_frame; frame_idx < last_frame; ++frame_idx) {
+    StackFrameSP frame_sp = frames.GetFrameAtIndex(frame_idx);
+    if (!frame_sp)
+      break;
+    Address lookup_addr(frame_sp->GetFrameCodeAddress());
+    ModuleSP module_sp = lookup_addr.GetModule();
+    if (!module_sp)
+      continue;
+    // The return address of a caller frame may be the first address after
+    // its compile unit, see StackFrame::GetSymbolContext.
+    if (frame_idx > 0 && lookup_addr.GetOffset() > 0)
+      lookup_addr.SetOffset(lookup_addr.GetOffset() - 1);
+
+    auto pos = std::find_if(
+        module_addrs.begin(), module_addrs.end(),
+        [&](const std::pair<ModuleSP, std::vector<Address>> &entry) {
+          return entry.first == module_sp;
+        });
+    if (pos == module_addrs.end())
+      pos = module_addrs.emplace(pos, module_sp, std::vector<Address>());
+    pos->second.push_back(lookup_addr);
+  }
+
+  // A single module is parsed just as fast on demand.
+  if (module_addrs.size() < 2)
+    return;
+
+  // Only the compile unit is resolved: resolving functions or types could
+  // need the name index of the module, which is itself built on the task
+  // pool and so mustn't be built from a task.
+  auto prefetch_fn = [&module_addrs](size_t idx) {
+    Module &module = *module_addrs[idx].first;
+    for (const Address &addr : module_addrs[idx].second) {
+      SymbolContext sc;
+      module.ResolveSymbolContextForAddress(addr, eSymbolContextCompUnit, sc);
+      if (sc.comp_unit)
+        sc.comp_unit->GetLineTable();
+    }
+  };
+  TaskMapOverInt(0, module_addrs.size(), prefetch_fn);
+}
+
 size_t StackFrameList::GetStatus(Stream &strm, uint32_t first_frame,
                                  uint32_t num_frames, bool show_frame_info,
                                  uint32_t num_frames_with_source,
@@ -962,6 +1014,9 @@ size_t StackFrameList::GetStatus(Stream &strm, uint32_t first_frame,
   }
   const char *marker = nullptr;
 
+  if (show_frame_info)
+    PrefetchLineTables(*this, first_frame, last_frame);
+
   for (frame_idx = first_frame; frame_idx < last_frame; ++frame_idx) {
     frame_sp = GetFrameAtIndex(frame_idx);
     if (!frame_sp)
@@ -1658,6 +1658,7 @@ void Target::ModulesDidLoad(ModuleList &module_list) {
     }
     m_breakpoint_list.UpdateBreakpoints(module_list, true, false);
     m_internal_breakpoint_list.UpdateBreakpoints(module_list, true, false);
+    ClearParsedUserExpressions();
     if (m_process_sp) {
       m_process_sp->ModulesDidLoad(module_list);
     }
@@ -1687,6 +1688,7 @@ void Target::ModulesDidUnload(ModuleList &module_list, bool delete_locations) {
     m_breakpoint_list.UpdateBreakpoints(module_list, false, delete_locations);
     m_internal_breakpoint_list.UpdateBreakpoints(module_list, false,
                                                  delete_locations);
+    ClearParsedUserExpressions();
     BroadcastEvent(eBroadcastBitModulesUnloaded,
                    new TargetEventData(this->shared_from_this(), module_list));
   }
@@ -2241,6 +2243,23 @@ UserExpression *Target::GetUserExpressionForLanguage(
   return user_expr;
 }
 
+lldb::UserExpressionSP Target::GetParsedUserExpression(llvm::StringRef key) {
+  auto pos = m_parsed_user_expressions.find(key.str());
+  if (pos == m_parsed_user_expressions.end())
+    return lldb::UserExpressionSP();
+  return pos->second;
+}
+
+void Target::AddParsedUserExpression(
+    llvm::StringRef key, const lldb::UserExpressionSP &user_expr_sp) {
+  // Each expression keeps its JIT'd code in the process, so don't let the
+  // cache grow without bounds.
+  const size_t max_parsed_user_expressions = 64;
+  if (m_parsed_user_expressions.size() >= max_parsed_user_expressions)
+    m_parsed_user_expressions.clear();
+  m_parsed_user_expressions[key.str()] = user_expr_sp;
+}
+
 FunctionCaller *Target::GetFunctionCallerForLanguage(
     lldb::LanguageType language, const CompilerType &return_type,
     const Address &function_address, const ValueList &arg_value_list,
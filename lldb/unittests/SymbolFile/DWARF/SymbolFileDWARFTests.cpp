@@ -18,6 +18,7 @@
 #include "Plugins/SymbolFile/DWARF/DWARFAbbreviationDeclaration.h"
 #include "Plugins/SymbolFile/DWARF/DWARFDataExtractor.h"
 #include "Plugins/SymbolFile/DWARF/DWARFDebugAbbrev.h"
+#include "Plugins/SymbolFile/DWARF/NameToDIE.h"
 #include "Plugins/SymbolFile/DWARF/SymbolFileDWARF.h"
 #include "Plugins/SymbolFile/PDB/SymbolFilePDB.h"
 #include "TestingSupport/TestUtilities.h"
@@ -32,6 +33,7 @@
 #include "lldb/Symbol/SymbolVendor.h"
 #include "lldb/Utility/ArchSpec.h"
 #include "lldb/Utility/DataEncoder.h"
+#include "lldb/Utility/DataExtractor.h"
 #include "lldb/Utility/FileSpec.h"
 #include "lldb/Utility/StreamString.h"
 
@@ -329,3 +331,39 @@ TEST_F(SymbolFileDWARFTests, TestAbbrevMissingTerminator) {
   EXPECT_EQ("abbreviation declaration attribute list not terminated with a "
             "null entry", llvm::toString(std::move(error)));
 }
+
+TEST_F(SymbolFileDWARFTests, TestNameToDIEEncodeDecode) {
+  // Test that the entries of a NameToDIE survive a round trip through the
+  // encoding of the DWARF index cache, and that truncated data is rejected.
+  NameToDIE map;
+  map.Insert(ConstString("foo"), DIERef(llvm::None, DIERef::DebugInfo, 0x10));
+  map.Insert(ConstString("bar"), DIERef(3, DIERef::DebugTypes, 0x20));
+  map.Insert(ConstString("foo"), DIERef(llvm::None, DIERef::DebugTypes, 0x30));
+  map.Finalize();
+
+  std::string encoded;
+  llvm::raw_string_ostream os(encoded);
+  map.Encode(os);
+  os.flush();
+
+  DataExtractor data(encoded.data(), encoded.size(), eByteOrderLittle, 4);
+  NameToDIE decoded;
+  lldb::offset_t offset = 0;
+  ASSERT_TRUE(decoded.Decode(data, &offset));
+  EXPECT_EQ(encoded.size(), offset);
+
+  DIEArray foo_dies;
+  EXPECT_EQ(2U, decoded.Find(ConstString("foo"), foo_dies));
+  DIEArray bar_dies;
+  ASSERT_EQ(1U, decoded.Find(ConstString("bar"), bar_dies));
+  EXPECT_EQ(3U, bar_dies[0].dwo_num());
+  EXPECT_EQ(DIERef::DebugTypes, bar_dies[0].section());
+  EXPECT_EQ(0x20U, bar_dies[0].die_offset());
+
+  DataExtractor truncated(encoded.data(), encoded.size() - 1, eByteOrderLittle,
+                          4);
+  offset = 0;
+  EXPECT_FALSE(decoded.Decode(truncated, &offset));
+  DIEArray no_dies;
+  EXPECT_EQ(0U, decoded.Find(ConstString("foo"), no_dies));
+}
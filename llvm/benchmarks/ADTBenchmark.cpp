@@ -0,0 +1,254 @@
+//===- ADTBenchmark.cpp - Benchmarks for the ADT containers ---------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// Measures the common operations of the containers in llvm/ADT. The argument
+// of each benchmark is the number of elements it works on.
+//
+//===----------------------------------------------------------------------===//
+
+#include "benchmark/benchmark.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/FoldingSet.h"
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Support/Allocator.h"
+#include <string>
+#include <vector>
+
+using namespace llvm;
+
+namespace {
+
+/// Returns 2 * N distinct pointers into \p Storage, in address order and 32
+/// bytes apart like pointers to small objects. The second half can be used
+/// for failed lookups.
+std::vector<int *> makePointers(std::vector<int> &Storage, unsigned N) {
+  constexpr unsigned Stride = 32 / sizeof(int);
+  Storage.resize(2 * N * Stride);
+  std::vector<int *> Result;
+  for (unsigned I = 0; I != 2 * N; ++I)
+    Result.push_back(&Storage[I * Stride]);
+  return Result;
+}
+
+/// Returns 2 * N distinct strings that look like identifiers.
+std::vector<std::string> makeStrings(unsigned N) {
+  std::vector<std::string> Result;
+  for (unsigned I = 0; I != 2 * N; ++I)
+    Result.push_back("identifier_" + std::to_string(I * 2654435761u));
+  return Result;
+}
+
+//===----------------------------------------------------------------------===//
+// SmallVector
+//===----------------------------------------------------------------------===//
+
+template <unsigned InlineElts>
+void BM_SmallVectorPushBack(benchmark::State &State) {
+  unsigned N = State.range(0);
+  for (auto _ : State) {
+    SmallVector<unsigned, InlineElts> V;
+    for (unsigned I = 0; I != N; ++I)
+      V.push_back(I);
+    benchmark::DoNotOptimize(V.data());
+  }
+  State.SetItemsProcessed(State.iterations() * N);
+}
+// Each size either fits in the inline storage or spills to the heap.
+BENCHMARK_TEMPLATE(BM_SmallVectorPushBack, 8)->Arg(4)->Arg(8)->Arg(64);
+BENCHMARK_TEMPLATE(BM_SmallVectorPushBack, 128)->Arg(4)->Arg(64)->Arg(128);
+
+void BM_SmallVectorCopy(benchmark::State &State) {
+  unsigned N = State.range(0);
+  SmallVector<unsigned, 16> Src(N, 42);
+  for (auto _ : State) {
+    SmallVector<unsigned, 16> Copy(Src);
+    benchmark::DoNotOptimize(Copy.data());
+  }
+  State.SetItemsProcessed(State.iterations() * N);
+}
+BENCHMARK(BM_SmallVectorCopy)->Arg(8)->Arg(16)->Arg(1024);
+
+void BM_SmallVectorInsertFront(benchmark::State &State) {
+  unsigned N = State.range(0);
+  for (auto _ : State) {
+    SmallVector<unsigned, 16> V;
+    for (unsigned I = 0; I != N; ++I)
+      V.insert(V.begin(), I);
+    benchmark::DoNotOptimize(V.data());
+  }
+  State.SetItemsProcessed(State.iterations() * N);
+}
+BENCHMARK(BM_SmallVectorInsertFront)->Arg(16)->Arg(256);
+
+//===----------------------------------------------------------------------===//
+// DenseMap
+//===----------------------------------------------------------------------===//
+
+void BM_DenseMapInsert(benchmark::State &State) {
+  unsigned N = State.range(0);
+  for (auto _ : State) {
+    DenseMap<unsigned, unsigned> Map;
+    for (unsigned I = 0; I != N; ++I)
+      Map[I * 7] = I;
+    benchmark::DoNotOptimize(Map);
+  }
+  State.SetItemsProcessed(State.iterations() * N);
+}
+BENCHMARK(BM_DenseMapInsert)->Range(16, 1 << 16);
+
+void BM_DenseMapInsertReserved(benchmark::State &State) {
+  unsigned N = State.range(0);
+  for (auto _ : State) {
+    DenseMap<unsigned, unsigned> Map(N);
+    for (unsigned I = 0; I != N; ++I)
+      Map[I * 7] = I;
+    benchmark::DoNotOptimize(Map);
+  }
+  State.SetItemsProcessed(State.iterations() * N);
+}
+BENCHMARK(BM_DenseMapInsertReserved)->Range(16, 1 << 16);
+
+void BM_DenseMapFind(benchmark::State &State) {
+  unsigned N = State.range(0);
+  std::vector<int> Storage;
+  std::vector<int *> Keys = makePointers(Storage, N);
+  DenseMap<int *, unsigned> Map;
+  for (unsigned I = 0; I != N; ++I)
+    Map[Keys[I]] = I;
+  // Every other lookup fails.
+  for (auto _ : State)
+    for (unsigned I = 0; I != N; ++I)
+      benchmark::DoNotOptimize(Map.find(Keys[I + (I & 1) * N]));
+  State.SetItemsProcessed(State.iterations() * N);
+}
+BENCHMARK(BM_DenseMapFind)->Range(16, 1 << 16);
+
+void BM_DenseMapIterate(benchmark::State &State) {
+  unsigned N = State.range(0);
+  DenseMap<unsigned, unsigned> Map;
+  for (unsigned I = 0; I != N; ++I)
+    Map[I] = I;
+  for (auto _ : State) {
+    unsigned Sum = 0;
+    for (const auto &KV : Map)
+      Sum += KV.second;
+    benchmark::DoNotOptimize(Sum);
+  }
+  State.SetItemsProcessed(State.iterations() * N);
+}
+BENCHMARK(BM_DenseMapIterate)->Range(16, 1 << 16);
+
+//===----------------------------------------------------------------------===//
+// StringMap
+//===----------------------------------------------------------------------===//
+
+void BM_StringMapInsert(benchmark::State &State) {
+  unsigned N = State.range(0);
+  std::vector<std::string> Keys = makeStrings(N);
+  for (auto _ : State) {
+    StringMap<unsigned> Map;
+    for (unsigned I = 0; I != N; ++I)
+      Map[Keys[I]] = I;
+    benchmark::DoNotOptimize(Map);
+  }
+  State.SetItemsProcessed(State.iterations() * N);
+}
+BENCHMARK(BM_StringMapInsert)->Range(16, 1 << 16);
+
+void BM_StringMapFind(benchmark::State &State) {
+  unsigned N = State.range(0);
+  std::vector<std::string> Keys = makeStrings(N);
+  StringMap<unsigned> Map;
+  for (unsigned I = 0; I != N; ++I)
+    Map[Keys[I]] = I;
+  // Every other lookup fails.
+  for (auto _ : State)
+    for (unsigned I = 0; I != N; ++I)
+      benchmark::DoNotOptimize(Map.find(Keys[I + (I & 1) * N]));
+  State.SetItemsProcessed(State.iterations() * N);
+}
+BENCHMARK(BM_StringMapFind)->Range(16, 1 << 16);
+
+//===----------------------------------------------------------------------===//
+// SmallPtrSet
+//===----------------------------------------------------------------------===//
+
+void BM_SmallPtrSetInsert(benchmark::State &State) {
+  unsigned N = State.range(0);
+  std::vector<int> Storage;
+  std::vector<int *> Keys = makePointers(Storage, N);
+  for (auto _ : State) {
+    SmallPtrSet<int *, 16> Set;
+    for (unsigned I = 0; I != N; ++I)
+      Set.insert(Keys[I]);
+    benchmark::DoNotOptimize(Set);
+  }
+  State.SetItemsProcessed(State.iterations() * N);
+}
+// Sets of up to 16 elements use the small, linearly searched representation.
+BENCHMARK(BM_SmallPtrSetInsert)->Arg(4)->Arg(16)->Arg(256)->Arg(4096);
+
+void BM_SmallPtrSetCount(benchmark::State &State) {
+  unsigned N = State.range(0);
+  std::vector<int> Storage;
+  std::vector<int *> Keys = makePointers(Storage, N);
+  SmallPtrSet<int *, 16> Set;
+  for (unsigned I = 0; I != N; ++I)
+    Set.insert(Keys[I]);
+  // Every other lookup fails.
+  for (auto _ : State)
+    for (unsigned I = 0; I != N; ++I)
+      benchmark::DoNotOptimize(Set.count(Keys[I + (I & 1) * N]));
+  State.SetItemsProcessed(State.iterations() * N);
+}
+BENCHMARK(BM_SmallPtrSetCount)->Arg(4)->Arg(16)->Arg(256)->Arg(4096);
+
+//===----------------------------------------------------------------------===//
+// FoldingSet
+//===----------------------------------------------------------------------===//
+
+struct PairNode : FoldingSetNode {
+  unsigned First, Second;
+
+  PairNode(unsigned First, unsigned Second) : First(First), Second(Second) {}
+
+  void Profile(FoldingSetNodeID &ID) const { Profile(ID, First, Second); }
+
+  static void Profile(FoldingSetNodeID &ID, unsigned First, unsigned Second) {
+    ID.AddInteger(First);
+    ID.AddInteger(Second);
+  }
+};
+
+/// Uniques 2 * N requests for N distinct nodes, the way the AST and the
+/// SelectionDAG unique their nodes.
+void BM_FoldingSetGetOrInsert(benchmark::State &State) {
+  unsigned N = State.range(0);
+  for (auto _ : State) {
+    BumpPtrAllocator Alloc;
+    FoldingSet<PairNode> Set;
+    for (unsigned I = 0; I != 2 * N; ++I) {
+      unsigned First = I % N, Second = First % 3;
+      FoldingSetNodeID ID;
+      PairNode::Profile(ID, First, Second);
+      void *InsertPos;
+      if (Set.FindNodeOrInsertPos(ID, InsertPos))
+        continue;
+      Set.InsertNode(new (Alloc) PairNode(First, Second), InsertPos);
+    }
+    benchmark::DoNotOptimize(Set.size());
+  }
+  State.SetItemsProcessed(State.iterations() * 2 * N);
+}
+BENCHMARK(BM_FoldingSetGetOrInsert)->Range(16, 1 << 16);
+
+} // end anonymous namespace
+
+BENCHMARK_MAIN();
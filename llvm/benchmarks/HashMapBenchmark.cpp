@@ -0,0 +1,134 @@
+//===- HashMapBenchmark.cpp - DenseMap vs. FlatHashMap --------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// Compares the insertion and lookup speed of DenseMap and FlatHashMap for
+// pointer, pair and string keys.
+//
+//===----------------------------------------------------------------------===//
+
+#include "benchmark/benchmark.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/FlatHashMap.h"
+#include "llvm/ADT/StringRef.h"
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace llvm;
+
+namespace {
+
+/// Creates \p N distinct keys of each kind; twice as many are created so that
+/// the second half can be used for failed lookups.
+template <typename KeyT> struct Keys;
+
+template <> struct Keys<void *> {
+  std::vector<char> Storage;
+  std::vector<void *> Values;
+  explicit Keys(unsigned N) : Storage(2 * N * 16) {
+    for (unsigned I = 0; I != 2 * N; ++I)
+      Values.push_back(&Storage[I * 16]);
+  }
+};
+
+template <> struct Keys<std::pair<unsigned, unsigned>> {
+  std::vector<std::pair<unsigned, unsigned>> Values;
+  explicit Keys(unsigned N) {
+    for (unsigned I = 0; I != 2 * N; ++I)
+      Values.emplace_back(I * 7, I ^ 0x5555);
+  }
+};
+
+template <> struct Keys<StringRef> {
+  std::vector<std::string> Storage;
+  std::vector<StringRef> Values;
+  explicit Keys(unsigned N) {
+    for (unsigned I = 0; I != 2 * N; ++I)
+      Storage.push_back("identifier_" + std::to_string(I * 2654435761u));
+    Values.assign(Storage.begin(), Storage.end());
+  }
+};
+
+template <typename MapT> void BM_Insert(benchmark::State &State) {
+  unsigned N = State.range(0);
+  Keys<typename MapT::key_type> K(N);
+  for (auto _ : State) {
+    MapT Map;
+    for (unsigned I = 0; I != N; ++I)
+      Map[K.Values[I]] = I;
+    benchmark::DoNotOptimize(Map);
+  }
+  State.SetItemsProcessed(State.iterations() * N);
+}
+
+template <typename MapT> void BM_FindHit(benchmark::State &State) {
+  unsigned N = State.range(0);
+  Keys<typename MapT::key_type> K(N);
+  MapT Map;
+  for (unsigned I = 0; I != N; ++I)
+    Map[K.Values[I]] = I;
+  for (auto _ : State)
+    for (unsigned I = 0; I != N; ++I)
+      benchmark::DoNotOptimize(Map.find(K.Values[I]));
+  State.SetItemsProcessed(State.iterations() * N);
+}
+
+template <typename MapT> void BM_FindMiss(benchmark::State &State) {
+  unsigned N = State.range(0);
+  Keys<typename MapT::key_type> K(N);
+  MapT Map;
+  for (unsigned I = 0; I != N; ++I)
+    Map[K.Values[I]] = I;
+  for (auto _ : State)
+    for (unsigned I = N; I != 2 * N; ++I)
+      benchmark::DoNotOptimize(Map.find(K.Values[I]));
+  State.SetItemsProcessed(State.iterations() * N);
+}
+
+template <typename MapT> void BM_EraseInsert(benchmark::State &State) {
+  unsigned N = State.range(0);
+  Keys<typename MapT::key_type> K(N);
+  MapT Map;
+  for (unsigned I = 0; I != N; ++I)
+    Map[K.Values[I]] = I;
+  // Keep the map at N entries while cycling through all 2 * N keys.
+  unsigned Next = N;
+  for (auto _ : State) {
+    Map.erase(K.Values[(Next + N) % (2 * N)]);
+    Map[K.Values[Next]] = Next;
+    Next = (Next + 1) % (2 * N);
+  }
+  State.SetItemsProcessed(State.iterations());
+}
+
+} // end anonymous namespace
+
+#define HASHMAP_BENCHMARKS(KeyT)                                               \
+  BENCHMARK_TEMPLATE(BM_Insert, DenseMap<KeyT, unsigned>)                      \
+      ->Range(16, 1 << 18);                                                    \
+  BENCHMARK_TEMPLATE(BM_Insert, FlatHashMap<KeyT, unsigned>)                   \
+      ->Range(16, 1 << 18);                                                    \
+  BENCHMARK_TEMPLATE(BM_FindHit, DenseMap<KeyT, unsigned>)                     \
+      ->Range(16, 1 << 18);                                                    \
+  BENCHMARK_TEMPLATE(BM_FindHit, FlatHashMap<KeyT, unsigned>)                  \
+      ->Range(16, 1 << 18);                                                    \
+  BENCHMARK_TEMPLATE(BM_FindMiss, DenseMap<KeyT, unsigned>)                    \
+      ->Range(16, 1 << 18);                                                    \
+  BENCHMARK_TEMPLATE(BM_FindMiss, FlatHashMap<KeyT, unsigned>)                 \
+      ->Range(16, 1 << 18);                                                    \
+  BENCHMARK_TEMPLATE(BM_EraseInsert, DenseMap<KeyT, unsigned>)                 \
+      ->Range(16, 1 << 18);                                                    \
+  BENCHMARK_TEMPLATE(BM_EraseInsert, FlatHashMap<KeyT, unsigned>)              \
+      ->Range(16, 1 << 18);
+
+using UnsignedPair = std::pair<unsigned, unsigned>;
+HASHMAP_BENCHMARKS(void *)
+HASHMAP_BENCHMARKS(UnsignedPair)
+HASHMAP_BENCHMARKS(StringRef)
+
+BENCHMARK_MAIN();
@@ -0,0 +1,186 @@
+//===- MCBenchmark.cpp - Benchmarks for the integrated assembler ----------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// Measures the integrated assembler on a large generated x86-64 assembly file,
+// both parsing and matching alone, into a null streamer, and assembling it
+// into an ELF object. The benchmarks are skipped if the X86 target is not
+// built.
+//
+//===----------------------------------------------------------------------===//
+
+#include "benchmark/benchmark.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/MC/MCAsmBackend.h"
+#include "llvm/MC/MCAsmInfo.h"
+#include "llvm/MC/MCCodeEmitter.h"
+#include "llvm/MC/MCContext.h"
+#include "llvm/MC/MCInstrInfo.h"
+#include "llvm/MC/MCObjectFileInfo.h"
+#include "llvm/MC/MCObjectWriter.h"
+#include "llvm/MC/MCParser/MCAsmParser.h"
+#include "llvm/MC/MCParser/MCTargetAsmParser.h"
+#include "llvm/MC/MCRegisterInfo.h"
+#include "llvm/MC/MCStreamer.h"
+#include "llvm/MC/MCSubtargetInfo.h"
+#include "llvm/MC/MCTargetOptions.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/SourceMgr.h"
+#include "llvm/Support/TargetRegistry.h"
+#include "llvm/Support/TargetSelect.h"
+#include "llvm/Support/raw_ostream.h"
+#include <memory>
+#include <string>
+
+using namespace llvm;
+
+namespace {
+
+const char *TripleName = "x86_64-unknown-linux-gnu";
+
+/// Returns assembly with \p NumFunctions small functions, in the mix of
+/// labels, directives, instructions and macros of generated code.
+std::string generateAssembly(unsigned NumFunctions) {
+  std::string Source;
+  raw_string_ostream OS(Source);
+  OS << ".macro save_regs\n"
+        "  pushq %rbx\n"
+        "  pushq %r12\n"
+        ".endm\n"
+        ".text\n";
+  for (unsigned I = 0; I != NumFunctions; ++I) {
+    OS << "  .globl f" << I << "\n"
+       << "  .p2align 4, 0x90\n"
+       << "  .type f" << I << ",@function\n"
+       << "f" << I << ":\n"
+       << "  .cfi_startproc\n"
+       << "  save_regs\n"
+       << "  movq %rdi, %rbx\n"
+       << "  xorl %eax, %eax\n"
+       << ".Lloop" << I << ":\n"
+       << "  addq (%rbx,%rax,8), %r12\n"
+       << "  leaq 1(%rax), %rax\n"
+       << "  cmpq %rsi, %rax\n"
+       << "  jne .Lloop" << I << "\n"
+       << "  movq %r12, %rax\n"
+       << "  popq %r12\n"
+       << "  popq %rbx\n"
+       << "  retq\n"
+       << "  .cfi_endproc\n"
+       << ".Lend" << I << ":\n"
+       << "  .size f" << I << ", .Lend" << I << "-f" << I << "\n";
+  }
+  OS << ".data\n";
+  for (unsigned I = 0; I != NumFunctions; ++I)
+    OS << "  .quad f" << I << "\n"
+       << "  .long " << I << "\n"
+       << "  .asciz \"string" << I << "\"\n";
+  return OS.str();
+}
+
+/// The target-specific objects that outlive the assembler runs.
+struct AssemblerSetup {
+  const Target *TheTarget = nullptr;
+  Triple TheTriple{TripleName};
+  std::unique_ptr<MCRegisterInfo> MRI;
+  std::unique_ptr<MCAsmInfo> MAI;
+  std::unique_ptr<MCInstrInfo> MCII;
+  std::unique_ptr<MCSubtargetInfo> STI;
+  MCTargetOptions MCOptions;
+
+  AssemblerSetup() {
+    InitializeAllTargetInfos();
+    InitializeAllTargetMCs();
+    InitializeAllAsmParsers();
+
+    std::string Error;
+    TheTarget = TargetRegistry::lookupTarget(TripleName, Error);
+    if (!TheTarget)
+      return;
+    MRI.reset(TheTarget->createMCRegInfo(TripleName));
+    MAI.reset(TheTarget->createMCAsmInfo(*MRI, TripleName));
+    MCII.reset(TheTarget->createMCInstrInfo());
+    STI.reset(TheTarget->createMCSubtargetInfo(TripleName, "", ""));
+  }
+
+  /// Assembles \p Source, into an ELF object in \p Object if \p EmitObject is
+  /// true and into a null streamer otherwise. Returns true on success.
+  bool assemble(StringRef Source, bool EmitObject,
+                SmallVectorImpl<char> &Object) {
+    SourceMgr SrcMgr;
+    SrcMgr.AddNewSourceBuffer(
+        MemoryBuffer::getMemBuffer(Source, "bench.s",
+                                   /*RequiresNullTerminator=*/false),
+        SMLoc());
+    MCObjectFileInfo MOFI;
+    MCContext Ctx(MAI.get(), MRI.get(), &MOFI, &SrcMgr);
+    MOFI.InitMCObjectFileInfo(TheTriple, /*PIC=*/false, Ctx);
+
+    raw_svector_ostream OS(Object);
+    std::unique_ptr<MCStreamer> Str;
+    if (EmitObject) {
+      MCCodeEmitter *CE = TheTarget->createMCCodeEmitter(*MCII, *MRI, Ctx);
+      MCAsmBackend *MAB =
+          TheTarget->createMCAsmBackend(*STI, *MRI, MCOptions);
+      Str.reset(TheTarget->createMCObjectStreamer(
+          TheTriple, Ctx, std::unique_ptr<MCAsmBackend>(MAB),
+          MAB->createObjectWriter(OS), std::unique_ptr<MCCodeEmitter>(CE),
+          *STI, /*RelaxAll=*/false, /*IncrementalLinkerCompatible=*/false,
+          /*DWARFMustBeAtTheEnd=*/false));
+    } else {
+      Str.reset(TheTarget->createNullStreamer(Ctx));
+    }
+    Str->setUseAssemblerInfoForParsing(true);
+
+    std::unique_ptr<MCAsmParser> Parser(
+        createMCAsmParser(SrcMgr, Ctx, *Str, *MAI));
+    std::unique_ptr<MCTargetAsmParser> TAP(
+        TheTarget->createMCAsmParser(*STI, *Parser, *MCII, MCOptions));
+    if (!TAP)
+      return false;
+    Parser->setTargetParser(*TAP);
+    return !Parser->Run(/*NoInitialTextSection=*/false);
+  }
+};
+
+AssemblerSetup &getSetup() {
+  static AssemblerSetup Setup;
+  return Setup;
+}
+
+void runAssembler(benchmark::State &State, bool EmitObject) {
+  AssemblerSetup &Setup = getSetup();
+  if (!Setup.TheTarget) {
+    State.SkipWithError("the X86 target is not built");
+    return;
+  }
+  std::string Source = generateAssembly(State.range(0));
+  SmallString<0> Object;
+  for (auto _ : State) {
+    Object.clear();
+    if (!Setup.assemble(Source, EmitObject, Object)) {
+      State.SkipWithError("the generated assembly did not assemble");
+      return;
+    }
+    benchmark::DoNotOptimize(Object.data());
+  }
+  State.SetBytesProcessed(State.iterations() * Source.size());
+}
+
+void BM_AsmParse(benchmark::State &State) {
+  runAssembler(State, /*EmitObject=*/false);
+}
+BENCHMARK(BM_AsmParse)->Arg(100)->Arg(10000);
+
+void BM_AsmAssembleObject(benchmark::State &State) {
+  runAssembler(State, /*EmitObject=*/true);
+}
+BENCHMARK(BM_AsmAssembleObject)->Arg(100)->Arg(10000);
+
+} // end anonymous namespace
+
+BENCHMARK_MAIN();
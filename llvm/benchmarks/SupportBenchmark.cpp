@@ -0,0 +1,236 @@
+//===- SupportBenchmark.cpp - Benchmarks for llvm/Support utilities -------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// Measures BumpPtrAllocator, the formatting functions of raw_ostream, APInt
+// arithmetic, and the xxHash and SHA1 hashes.
+//
+//===----------------------------------------------------------------------===//
+
+#include "benchmark/benchmark.h"
+#include "llvm/ADT/APInt.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Support/Allocator.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/FormatVariadic.h"
+#include "llvm/Support/SHA1.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/Support/xxhash.h"
+#include <vector>
+
+using namespace llvm;
+
+namespace {
+
+//===----------------------------------------------------------------------===//
+// BumpPtrAllocator
+//===----------------------------------------------------------------------===//
+
+void BM_BumpPtrAllocate(benchmark::State &State) {
+  unsigned Size = State.range(0);
+  constexpr unsigned NumAllocs = 1024;
+  BumpPtrAllocator Alloc;
+  for (auto _ : State) {
+    for (unsigned I = 0; I != NumAllocs; ++I)
+      benchmark::DoNotOptimize(Alloc.Allocate(Size, 8));
+    // Reset() keeps the first slab, so small sizes stop calling malloc.
+    Alloc.Reset();
+  }
+  State.SetItemsProcessed(State.iterations() * NumAllocs);
+}
+BENCHMARK(BM_BumpPtrAllocate)->Arg(8)->Arg(64)->Arg(512)->Arg(8192);
+
+/// Includes the cost of allocating and freeing the slabs.
+void BM_BumpPtrAllocateFresh(benchmark::State &State) {
+  unsigned Size = State.range(0);
+  constexpr unsigned NumAllocs = 1024;
+  for (auto _ : State) {
+    BumpPtrAllocator Alloc;
+    for (unsigned I = 0; I != NumAllocs; ++I)
+      benchmark::DoNotOptimize(Alloc.Allocate(Size, 8));
+  }
+  State.SetItemsProcessed(State.iterations() * NumAllocs);
+}
+BENCHMARK(BM_BumpPtrAllocateFresh)->Arg(8)->Arg(512)->Arg(8192);
+
+struct Object {
+  unsigned Data[6];
+  Object() { Data[0] = 1; }
+  ~Object() { benchmark::DoNotOptimize(Data[0]); }
+};
+
+void BM_SpecificBumpPtrAllocate(benchmark::State &State) {
+  unsigned NumAllocs = State.range(0);
+  for (auto _ : State) {
+    SpecificBumpPtrAllocator<Object> Alloc;
+    for (unsigned I = 0; I != NumAllocs; ++I)
+      new (Alloc.Allocate()) Object();
+  }
+  State.SetItemsProcessed(State.iterations() * NumAllocs);
+}
+BENCHMARK(BM_SpecificBumpPtrAllocate)->Arg(64)->Arg(4096);
+
+//===----------------------------------------------------------------------===//
+// raw_ostream
+//===----------------------------------------------------------------------===//
+
+void BM_RawOstreamIntegers(benchmark::State &State) {
+  SmallString<256> Buffer;
+  for (auto _ : State) {
+    Buffer.clear();
+    raw_svector_ostream OS(Buffer);
+    for (unsigned I = 0; I != 16; ++I)
+      OS << I * 123457u << ' ' << -int64_t(I) << '\n';
+    benchmark::DoNotOptimize(Buffer.data());
+  }
+  State.SetItemsProcessed(State.iterations() * 32);
+}
+BENCHMARK(BM_RawOstreamIntegers);
+
+void BM_RawOstreamStrings(benchmark::State &State) {
+  SmallString<1024> Buffer;
+  StringRef Str = "some_identifier";
+  for (auto _ : State) {
+    Buffer.clear();
+    raw_svector_ostream OS(Buffer);
+    for (unsigned I = 0; I != 32; ++I)
+      OS << Str << ", ";
+    benchmark::DoNotOptimize(Buffer.data());
+  }
+  State.SetItemsProcessed(State.iterations() * 32);
+}
+BENCHMARK(BM_RawOstreamStrings);
+
+void BM_RawOstreamWriteHex(benchmark::State &State) {
+  SmallString<512> Buffer;
+  for (auto _ : State) {
+    Buffer.clear();
+    raw_svector_ostream OS(Buffer);
+    for (uint64_t I = 0; I != 16; ++I)
+      OS << format_hex(I * 0x9E3779B97F4A7C15ULL, 18) << '\n';
+    benchmark::DoNotOptimize(Buffer.data());
+  }
+  State.SetItemsProcessed(State.iterations() * 16);
+}
+BENCHMARK(BM_RawOstreamWriteHex);
+
+void BM_RawOstreamFormat(benchmark::State &State) {
+  SmallString<512> Buffer;
+  const char *Name = "name";
+  for (auto _ : State) {
+    Buffer.clear();
+    raw_svector_ostream OS(Buffer);
+    for (unsigned I = 0; I != 16; ++I)
+      OS << format("%5u: %-10s %8.3f\n", I, Name, I * 0.5);
+    benchmark::DoNotOptimize(Buffer.data());
+  }
+  State.SetItemsProcessed(State.iterations() * 16);
+}
+BENCHMARK(BM_RawOstreamFormat);
+
+void BM_RawOstreamFormatv(benchmark::State &State) {
+  SmallString<512> Buffer;
+  for (auto _ : State) {
+    Buffer.clear();
+    raw_svector_ostream OS(Buffer);
+    for (unsigned I = 0; I != 16; ++I)
+      OS << formatv("{0,5}: {1,-10} {2:F3}\n", I, "name", I * 0.5);
+    benchmark::DoNotOptimize(Buffer.data());
+  }
+  State.SetItemsProcessed(State.iterations() * 16);
+}
+BENCHMARK(BM_RawOstreamFormatv);
+
+//===----------------------------------------------------------------------===//
+// APInt
+//===----------------------------------------------------------------------===//
+
+/// Returns an APInt of \p BitWidth bits with every word set to a distinct
+/// nonzero value.
+APInt makeAPInt(unsigned BitWidth, uint64_t Seed) {
+  SmallVector<uint64_t, 16> Words;
+  for (unsigned I = 0, E = (BitWidth + 63) / 64; I != E; ++I)
+    Words.push_back((Seed + I) * 0x9E3779B97F4A7C15ULL | 1);
+  return APInt(BitWidth, Words);
+}
+
+void BM_APIntAdd(benchmark::State &State) {
+  APInt A = makeAPInt(State.range(0), 1), B = makeAPInt(State.range(0), 2);
+  for (auto _ : State) {
+    A += B;
+    benchmark::DoNotOptimize(A);
+  }
+}
+BENCHMARK(BM_APIntAdd)->Arg(32)->Arg(64)->Arg(128)->Arg(1024);
+
+void BM_APIntMul(benchmark::State &State) {
+  APInt A = makeAPInt(State.range(0), 1), B = makeAPInt(State.range(0), 2);
+  for (auto _ : State)
+    benchmark::DoNotOptimize(A * B);
+}
+BENCHMARK(BM_APIntMul)->Arg(32)->Arg(64)->Arg(128)->Arg(1024);
+
+void BM_APIntUDiv(benchmark::State &State) {
+  unsigned BitWidth = State.range(0);
+  APInt A = makeAPInt(BitWidth, 1);
+  APInt B = makeAPInt(BitWidth, 2).lshr(BitWidth / 2);
+  for (auto _ : State)
+    benchmark::DoNotOptimize(A.udiv(B));
+}
+BENCHMARK(BM_APIntUDiv)->Arg(32)->Arg(64)->Arg(128)->Arg(1024);
+
+void BM_APIntShift(benchmark::State &State) {
+  unsigned BitWidth = State.range(0);
+  APInt A = makeAPInt(BitWidth, 1);
+  for (auto _ : State) {
+    benchmark::DoNotOptimize(A.shl(BitWidth / 3));
+    benchmark::DoNotOptimize(A.lshr(BitWidth / 5));
+  }
+}
+BENCHMARK(BM_APIntShift)->Arg(64)->Arg(128)->Arg(1024);
+
+void BM_APIntToString(benchmark::State &State) {
+  APInt A = makeAPInt(State.range(0), 1);
+  SmallString<512> Str;
+  for (auto _ : State) {
+    Str.clear();
+    A.toString(Str, 10, /*Signed=*/false);
+    benchmark::DoNotOptimize(Str.data());
+  }
+}
+BENCHMARK(BM_APIntToString)->Arg(64)->Arg(128)->Arg(1024);
+
+//===----------------------------------------------------------------------===//
+// Hashing
+//===----------------------------------------------------------------------===//
+
+template <uint64_t (*HashFn)(ArrayRef<uint8_t>)>
+void BM_Hash(benchmark::State &State) {
+  std::vector<uint8_t> Data(State.range(0));
+  for (size_t I = 0; I != Data.size(); ++I)
+    Data[I] = uint8_t(I * 31);
+  for (auto _ : State)
+    benchmark::DoNotOptimize(HashFn(Data));
+  State.SetBytesProcessed(State.iterations() * Data.size());
+}
+// The sizes of string literals and of typical input sections.
+BENCHMARK_TEMPLATE(BM_Hash, xxHash64)->RangeMultiplier(8)->Range(8, 1 << 16);
+BENCHMARK_TEMPLATE(BM_Hash, xxh3_64bits)->RangeMultiplier(8)->Range(8, 1 << 16);
+
+void BM_SHA1(benchmark::State &State) {
+  std::vector<uint8_t> Data(State.range(0));
+  for (size_t I = 0; I != Data.size(); ++I)
+    Data[I] = uint8_t(I * 31);
+  for (auto _ : State)
+    benchmark::DoNotOptimize(SHA1::hash(Data));
+  State.SetBytesProcessed(State.iterations() * Data.size());
+}
+BENCHMARK(BM_SHA1)->RangeMultiplier(8)->Range(64, 1 << 16);
+
+} // end anonymous namespace
+
+BENCHMARK_MAIN();
@@ -0,0 +1,618 @@
+//===- llvm/ADT/FlatHashMap.h - Open-addressing hash map --------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file defines FlatHashMap, an open-addressing hash map that keeps one
+/// byte of metadata per bucket and probes a whole group of buckets with a
+/// single comparison of these bytes, using SSE2 or NEON when available. The
+/// design follows the "Swiss tables" of the Abseil libraries.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_ADT_FLATHASHMAP_H
+#define LLVM_ADT_FLATHASHMAP_H
+
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/DenseMapInfo.h"
+#include "llvm/Support/Endian.h"
+#include "llvm/Support/MathExtras.h"
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define LLVM_FLATHASHMAP_SSE2 1
+#elif defined(__ARM_NEON) && defined(__aarch64__) && !defined(__AARCH64EB__)
+#include <arm_neon.h>
+#define LLVM_FLATHASHMAP_NEON 1
+#endif
+
+namespace llvm {
+
+namespace detail {
+
+/// The special values of the control byte of a bucket. The control byte of a
+/// bucket that holds an entry is the top 7 bits of the hash of its key, so it
+/// is never negative.
+enum : int8_t {
+  FlatHashEmpty = -128,
+  FlatHashDeleted = -2,
+};
+
+/// A set of buckets of a group, as returned by the FlatHashGroup::match
+/// functions. Each bucket is represented by one bit of Mask, or by the top bit
+/// of one byte of Mask if Shift is 3.
+template <unsigned Shift> class FlatHashBitMask {
+  uint64_t Mask;
+
+public:
+  explicit FlatHashBitMask(uint64_t Mask) : Mask(Mask) {}
+
+  explicit operator bool() const { return Mask != 0; }
+
+  /// Returns the index in the group of the first bucket of the set.
+  unsigned first() const { return countTrailingZeros(Mask) >> Shift; }
+
+  /// Removes the first bucket from the set.
+  void dropFirst() { Mask &= Mask - 1; }
+};
+
+#if LLVM_FLATHASHMAP_SSE2
+/// The control bytes of 16 consecutive buckets.
+class FlatHashGroup {
+  __m128i Ctrl;
+
+public:
+  static constexpr unsigned Width = 16;
+  using BitMask = FlatHashBitMask<0>;
+
+  explicit FlatHashGroup(const int8_t *Pos)
+      : Ctrl(_mm_loadu_si128(reinterpret_cast<const __m128i *>(Pos))) {}
+
+  /// Returns the buckets whose control byte is \p H2.
+  BitMask match(int8_t H2) const {
+    return BitMask(static_cast<uint16_t>(
+        _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(H2), Ctrl))));
+  }
+
+  BitMask matchEmpty() const { return match(FlatHashEmpty); }
+
+  BitMask matchEmptyOrDeleted() const {
+    // Both special values are smaller than -1, and the others are not.
+    return BitMask(static_cast<uint16_t>(
+        _mm_movemask_epi8(_mm_cmpgt_epi8(_mm_set1_epi8(-1), Ctrl))));
+  }
+};
+#elif LLVM_FLATHASHMAP_NEON
+/// The control bytes of 8 consecutive buckets.
+class FlatHashGroup {
+  int8x8_t Ctrl;
+
+  static FlatHashBitMask<3> toBitMask(uint8x8_t Matches) {
+    return FlatHashBitMask<3>(vget_lane_u64(vreinterpret_u64_u8(Matches), 0) &
+                              0x8080808080808080ULL);
+  }
+
+public:
+  static constexpr unsigned Width = 8;
+  using BitMask = FlatHashBitMask<3>;
+
+  explicit FlatHashGroup(const int8_t *Pos) : Ctrl(vld1_s8(Pos)) {}
+
+  /// Returns the buckets whose control byte is \p H2.
+  BitMask match(int8_t H2) const {
+    return toBitMask(vceq_s8(Ctrl, vdup_n_s8(H2)));
+  }
+
+  BitMask matchEmpty() const { return match(FlatHashEmpty); }
+
+  BitMask matchEmptyOrDeleted() const {
+    // Both special values are smaller than -1, and the others are not.
+    return toBitMask(vclt_s8(Ctrl, vdup_n_s8(-1)));
+  }
+};
+#else
+/// The control bytes of 8 consecutive buckets, compared as a 64-bit word.
+class FlatHashGroup {
+  static constexpr uint64_t Lsbs = 0x0101010101010101ULL;
+  static constexpr uint64_t Msbs = 0x8080808080808080ULL;
+
+  uint64_t Ctrl;
+
+public:
+  static constexpr unsigned Width = 8;
+  using BitMask = FlatHashBitMask<3>;
+
+  explicit FlatHashGroup(const int8_t *Pos)
+      : Ctrl(support::endian::read64le(Pos)) {}
+
+  /// Returns the buckets whose control byte is \p H2. This may also return a
+  /// bucket that follows one that matches, which only costs an extra key
+  /// comparison.
+  BitMask match(int8_t H2) const {
+    uint64_t X = Ctrl ^ (Lsbs * static_cast<uint8_t>(H2));
+    return BitMask((X - Lsbs) & ~X & Msbs);
+  }
+
+  BitMask matchEmpty() const {
+    // Empty is the only value with the top bit set and bit 1 clear.
+    return BitMask(Ctrl & (~Ctrl << 6) & Msbs);
+  }
+
+  BitMask matchEmptyOrDeleted() const {
+    // The special values are the only ones with the top bit set and bit 0
+    // clear.
+    return BitMask(Ctrl & (~Ctrl << 7) & Msbs);
+  }
+};
+#endif
+
+} // end namespace detail
+
+/// An open-addressing hash map from \p KeyT to \p ValueT.
+///
+/// FlatHashMap is customized through \p KeyInfoT like DenseMap, but only uses
+/// its getHashValue() and isEqual() functions: keys do not need reserved empty
+/// and tombstone values. Each bucket has a control byte that is either empty,
+/// deleted, or 7 bits of the hash of its key. Lookups compare the control
+/// bytes of a group of buckets at once and only compare the keys of the
+/// buckets whose control byte matches, so most lookups perform a single key
+/// comparison even in full tables.
+///
+/// As with DenseMap, entries are stored inline and inserting an entry may
+/// invalidate iterators and references to the other entries.
+template <typename KeyT, typename ValueT,
+          typename KeyInfoT = DenseMapInfo<KeyT>>
+class FlatHashMap {
+public:
+  using key_type = KeyT;
+  using mapped_type = ValueT;
+  using value_type = detail::DenseMapPair<KeyT, ValueT>;
+  using size_type = unsigned;
+
+private:
+  using Group = detail::FlatHashGroup;
+  static constexpr unsigned Width = Group::Width;
+
+  template <bool IsConst> class Iterator {
+    friend class FlatHashMap;
+    friend class Iterator<!IsConst>;
+
+    using PairT = detail::DenseMapPair<KeyT, ValueT>;
+    using BucketT =
+        typename std::conditional<IsConst, const PairT, PairT>::type;
+
+    BucketT *Ptr = nullptr;
+    BucketT *End = nullptr;
+    const int8_t *Ctrl = nullptr;
+
+    Iterator(BucketT *Ptr, BucketT *End, const int8_t *Ctrl)
+        : Ptr(Ptr), End(End), Ctrl(Ctrl) {}
+
+    void skipUnused() {
+      while (Ptr != End && *Ctrl < 0) {
+        ++Ptr;
+        ++Ctrl;
+      }
+    }
+
+  public:
+    using difference_type = ptrdiff_t;
+    using value_type = PairT;
+    using pointer = BucketT *;
+    using reference = BucketT &;
+    using iterator_category = std::forward_iterator_tag;
+
+    Iterator() = default;
+
+    // Allow conversion from iterator to const_iterator.
+    template <bool WasConst, typename = typename std::enable_if<
+                                 IsConst && !WasConst>::type>
+    Iterator(const Iterator<WasConst> &I)
+        : Ptr(I.Ptr), End(I.End), Ctrl(I.Ctrl) {}
+
+    reference operator*() const { return *Ptr; }
+    pointer operator->() const { return Ptr; }
+
+    bool operator==(const Iterator &RHS) const { return Ptr == RHS.Ptr; }
+    bool operator!=(const Iterator &RHS) const { return Ptr != RHS.Ptr; }
+
+    Iterator &operator++() {
+      ++Ptr;
+      ++Ctrl;
+      skipUnused();
+      return *this;
+    }
+    Iterator operator++(int) {
+      Iterator Tmp = *this;
+      ++*this;
+      return Tmp;
+    }
+  };
+
+public:
+  using iterator = Iterator<false>;
+  using const_iterator = Iterator<true>;
+
+  explicit FlatHashMap(unsigned InitialReserve = 0) {
+    if (InitialReserve)
+      allocateBuckets(getMinBucketsForEntries(InitialReserve));
+  }
+
+  FlatHashMap(const FlatHashMap &Other) { copyFrom(Other); }
+
+  FlatHashMap(FlatHashMap &&Other) { swap(Other); }
+
+  template <typename InputIt> FlatHashMap(const InputIt &I, const InputIt &E) {
+    reserve(std::distance(I, E));
+    insert(I, E);
+  }
+
+  FlatHashMap(std::initializer_list<typename iterator::value_type> Vals) {
+    reserve(Vals.size());
+    insert(Vals.begin(), Vals.end());
+  }
+
+  ~FlatHashMap() {
+    destroyAll();
+    operator delete(Buckets);
+  }
+
+  FlatHashMap &operator=(const FlatHashMap &Other) {
+    if (&Other != this) {
+      destroyAll();
+      operator delete(Buckets);
+      Buckets = nullptr;
+      Ctrl = nullptr;
+      NumBuckets = NumEntries = GrowthLeft = 0;
+      copyFrom(Other);
+    }
+    return *this;
+  }
+
+  FlatHashMap &operator=(FlatHashMap &&Other) {
+    destroyAll();
+    operator delete(Buckets);
+    Buckets = nullptr;
+    Ctrl = nullptr;
+    NumBuckets = NumEntries = GrowthLeft = 0;
+    swap(Other);
+    return *this;
+  }
+
+  void swap(FlatHashMap &RHS) {
+    std::swap(Buckets, RHS.Buckets);
+    std::swap(Ctrl, RHS.Ctrl);
+    std::swap(NumBuckets, RHS.NumBuckets);
+    std::swap(NumEntries, RHS.NumEntries);
+    std::swap(GrowthLeft, RHS.GrowthLeft);
+  }
+
+  iterator begin() {
+    iterator I(Buckets, Buckets + NumBuckets, Ctrl);
+    I.skipUnused();
+    return I;
+  }
+  iterator end() {
+    return iterator(Buckets + NumBuckets, Buckets + NumBuckets, nullptr);
+  }
+  const_iterator begin() const {
+    const_iterator I(Buckets, Buckets + NumBuckets, Ctrl);
+    I.skipUnused();
+    return I;
+  }
+  const_iterator end() const {
+    return const_iterator(Buckets + NumBuckets, Buckets + NumBuckets, nullptr);
+  }
+
+  LLVM_NODISCARD bool empty() const { return NumEntries == 0; }
+  unsigned size() const { return NumEntries; }
+
+  /// Grow the map so that it can contain at least \p NumEntries entries
+  /// without growing again.
+  void reserve(size_type NumEntries) {
+    unsigned Needed = getMinBucketsForEntries(NumEntries);
+    if (Needed > NumBuckets)
+      rehash(Needed);
+  }
+
+  void clear() {
+    if (NumEntries == 0 && GrowthLeft == getMaxLoad(NumBuckets))
+      return;
+    destroyAll();
+    if (NumBuckets)
+      std::memset(Ctrl, detail::FlatHashEmpty, NumBuckets + Width - 1);
+    NumEntries = 0;
+    GrowthLeft = getMaxLoad(NumBuckets);
+  }
+
+  /// Return 1 if the specified key is in the map, 0 otherwise.
+  size_type count(const KeyT &Key) const { return findBucket(Key) ? 1 : 0; }
+
+  iterator find(const KeyT &Key) { return makeIterator(findBucket(Key)); }
+  const_iterator find(const KeyT &Key) const {
+    return makeIterator(findBucket(Key));
+  }
+
+  /// Alternate version of find() which allows a different, and possibly less
+  /// expensive, key type. KeyInfoT must provide getHashValue() and isEqual()
+  /// overloads for \p LookupKeyT.
+  template <class LookupKeyT> iterator find_as(const LookupKeyT &Key) {
+    return makeIterator(findBucket(Key));
+  }
+  template <class LookupKeyT>
+  const_iterator find_as(const LookupKeyT &Key) const {
+    return makeIterator(findBucket(Key));
+  }
+
+  /// Return the entry for the specified key, or a default constructed value
+  /// if no such entry exists.
+  ValueT lookup(const KeyT &Key) const {
+    if (const value_type *B = findBucket(Key))
+      return B->getSecond();
+    return ValueT();
+  }
+
+  // Inserts key,value pair into the map if the key isn't already in the map.
+  // If the key is already in the map, it returns false and doesn't update the
+  // value.
+  std::pair<iterator, bool> insert(const std::pair<KeyT, ValueT> &KV) {
+    return try_emplace(KV.first, KV.second);
+  }
+
+  std::pair<iterator, bool> insert(std::pair<KeyT, ValueT> &&KV) {
+    return try_emplace(std::move(KV.first), std::move(KV.second));
+  }
+
+  /// Insert a range of pairs.
+  template <typename InputIt> void insert(InputIt I, InputIt E) {
+    for (; I != E; ++I)
+      insert(*I);
+  }
+
+  // Inserts key,value pair into the map if the key isn't already in the map.
+  // The value is constructed in-place if the key is not in the map, otherwise
+  // it is not moved.
+  template <typename... Ts>
+  std::pair<iterator, bool> try_emplace(KeyT &&Key, Ts &&... Args) {
+    std::pair<value_type *, bool> Found = findOrPrepareInsert(Key);
+    if (Found.second) {
+      ::new (&Found.first->getFirst()) KeyT(std::move(Key));
+      ::new (&Found.first->getSecond()) ValueT(std::forward<Ts>(Args)...);
+    }
+    return std::make_pair(makeIterator(Found.first), Found.second);
+  }
+
+  template <typename... Ts>
+  std::pair<iterator, bool> try_emplace(const KeyT &Key, Ts &&... Args) {
+    std::pair<value_type *, bool> Found = findOrPrepareInsert(Key);
+    if (Found.second) {
+      ::new (&Found.first->getFirst()) KeyT(Key);
+      ::new (&Found.first->getSecond()) ValueT(std::forward<Ts>(Args)...);
+    }
+    return std::make_pair(makeIterator(Found.first), Found.second);
+  }
+
+  ValueT &operator[](const KeyT &Key) {
+    return try_emplace(Key).first->getSecond();
+  }
+
+  ValueT &operator[](KeyT &&Key) {
+    return try_emplace(std::move(Key)).first->getSecond();
+  }
+
+  bool erase(const KeyT &Key) {
+    value_type *B = findBucket(Key);
+    if (!B)
+      return false;
+    eraseBucket(B);
+    return true;
+  }
+
+  void erase(iterator I) { eraseBucket(I.Ptr); }
+
+  /// Return the approximate size (in bytes) of the actual map.
+  /// This is just the raw memory used by the map, and does not include
+  /// memory allocated by the keys or values.
+  size_t getMemorySize() const {
+    return NumBuckets ? getAllocationSize(NumBuckets) : 0;
+  }
+
+private:
+  /// The buckets, in the same allocation as the control bytes that follow
+  /// them. There is one control byte per bucket, followed by copies of the
+  /// first Width - 1 ones, so that a group can be loaded from any bucket.
+  value_type *Buckets = nullptr;
+  int8_t *Ctrl = nullptr;
+  unsigned NumBuckets = 0;
+  unsigned NumEntries = 0;
+  /// The number of entries that can still be put in empty buckets before
+  /// the map has to grow. Deleted buckets are reused for free.
+  unsigned GrowthLeft = 0;
+
+  /// Returns the 7 bits of \p Hash stored in the control byte. The low bits
+  /// of the hash pick the first group to probe. DenseMapInfo hashes are often
+  /// weak in their high bits, so mix them first.
+  static int8_t getH2(unsigned Hash) {
+    return static_cast<int8_t>((uint64_t(Hash) * 0x9E3779B97F4A7C15ULL) >> 57);
+  }
+
+  /// Keep at least one bucket out of eight empty, which also guarantees that
+  /// probing always finds an empty bucket.
+  static unsigned getMaxLoad(unsigned NumBuckets) {
+    return NumBuckets - NumBuckets / 8;
+  }
+
+  static unsigned getMinBucketsForEntries(unsigned NumEntries) {
+    if (NumEntries == 0)
+      return 0;
+    unsigned Result = Width;
+    while (getMaxLoad(Result) < NumEntries)
+      Result *= 2;
+    return Result;
+  }
+
+  static size_t getAllocationSize(unsigned NumBuckets) {
+    return NumBuckets * sizeof(value_type) + NumBuckets + Width - 1;
+  }
+
+  iterator makeIterator(value_type *B) {
+    if (!B)
+      return end();
+    return iterator(B, Buckets + NumBuckets, Ctrl + (B - Buckets));
+  }
+  const_iterator makeIterator(const value_type *B) const {
+    if (!B)
+      return end();
+    return const_iterator(B, Buckets + NumBuckets, Ctrl + (B - Buckets));
+  }
+
+  void setCtrl(unsigned I, int8_t Value) {
+    Ctrl[I] = Value;
+    if (I < Width - 1)
+      Ctrl[NumBuckets + I] = Value;
+  }
+
+  /// Returns the bucket holding \p Key, or null. Groups are probed
+  /// triangularly, which visits every group when the number of groups is a
+  /// power of two.
+  template <typename LookupKeyT>
+  value_type *findBucket(const LookupKeyT &Key) const {
+    if (NumBuckets == 0)
+      return nullptr;
+    unsigned Hash = KeyInfoT::getHashValue(Key);
+    int8_t H2 = getH2(Hash);
+    unsigned Mask = NumBuckets - 1;
+    unsigned Pos = Hash & Mask;
+    for (unsigned Step = Width;; Step += Width) {
+      Group G(Ctrl + Pos);
+      for (auto Match = G.match(H2); Match; Match.dropFirst()) {
+        unsigned I = (Pos + Match.first()) & Mask;
+        if (KeyInfoT::isEqual(Key, Buckets[I].getFirst()))
+          return Buckets + I;
+      }
+      if (G.matchEmpty())
+        return nullptr;
+      Pos = (Pos + Step) & Mask;
+    }
+  }
+
+  /// Returns the first empty or deleted bucket on the probe sequence of
+  /// \p Hash.
+  unsigned findFirstNonFull(unsigned Hash) const {
+    unsigned Mask = NumBuckets - 1;
+    unsigned Pos = Hash & Mask;
+    for (unsigned Step = Width;; Step += Width) {
+      if (auto Match = Group(Ctrl + Pos).matchEmptyOrDeleted())
+        return (Pos + Match.first()) & Mask;
+      Pos = (Pos + Step) & Mask;
+    }
+  }
+
+  /// Returns the bucket of \p Key and false if it is in the map. Otherwise,
+  /// claims a bucket for it and returns that bucket, which the caller must
+  /// construct, and true.
+  std::pair<value_type *, bool> findOrPrepareInsert(const KeyT &Key) {
+    if (value_type *B = findBucket(Key))
+      return std::make_pair(B, false);
+    if (NumBuckets == 0)
+      allocateBuckets(Width);
+    unsigned Hash = KeyInfoT::getHashValue(Key);
+    unsigned I = findFirstNonFull(Hash);
+    if (GrowthLeft == 0 && Ctrl[I] == detail::FlatHashEmpty) {
+      // If deleted buckets take up enough of the room, compacting the map in
+      // place is enough. This still leaves room for NumBuckets * 3 / 32
+      // entries, so the rehashes remain amortized constant time.
+      rehash(uint64_t(NumEntries) * 32 <= uint64_t(NumBuckets) * 25
+                 ? NumBuckets
+                 : NumBuckets * 2);
+      I = findFirstNonFull(Hash);
+    }
+    if (Ctrl[I] == detail::FlatHashEmpty)
+      --GrowthLeft;
+    ++NumEntries;
+    setCtrl(I, getH2(Hash));
+    return std::make_pair(Buckets + I, true);
+  }
+
+  void eraseBucket(value_type *B) {
+    B->getSecond().~ValueT();
+    B->getFirst().~KeyT();
+    setCtrl(B - Buckets, detail::FlatHashDeleted);
+    --NumEntries;
+  }
+
+  void allocateBuckets(unsigned Num) {
+    Buckets = static_cast<value_type *>(operator new(getAllocationSize(Num)));
+    Ctrl = reinterpret_cast<int8_t *>(Buckets + Num);
+    std::memset(Ctrl, detail::FlatHashEmpty, Num + Width - 1);
+    NumBuckets = Num;
+    GrowthLeft = getMaxLoad(Num);
+  }
+
+  void destroyAll() {
+    for (unsigned I = 0; I != NumBuckets; ++I) {
+      if (Ctrl[I] < 0)
+        continue;
+      Buckets[I].getSecond().~ValueT();
+      Buckets[I].getFirst().~KeyT();
+    }
+  }
+
+  void rehash(unsigned NewNumBuckets) {
+    value_type *OldBuckets = Buckets;
+    int8_t *OldCtrl = Ctrl;
+    unsigned OldNumBuckets = NumBuckets;
+
+    allocateBuckets(NewNumBuckets);
+    GrowthLeft -= NumEntries;
+    for (unsigned I = 0; I != OldNumBuckets; ++I) {
+      if (OldCtrl[I] < 0)
+        continue;
+      value_type &Old = OldBuckets[I];
+      unsigned Hash = KeyInfoT::getHashValue(Old.getFirst());
+      unsigned J = findFirstNonFull(Hash);
+      setCtrl(J, getH2(Hash));
+      ::new (&Buckets[J].getFirst()) KeyT(std::move(Old.getFirst()));
+      ::new (&Buckets[J].getSecond()) ValueT(std::move(Old.getSecond()));
+      Old.getSecond().~ValueT();
+      Old.getFirst().~KeyT();
+    }
+    operator delete(OldBuckets);
+  }
+
+  void copyFrom(const FlatHashMap &Other) {
+    if (Other.NumBuckets == 0)
+      return;
+    allocateBuckets(Other.NumBuckets);
+    std::memcpy(Ctrl, Other.Ctrl, NumBuckets + Width - 1);
+    for (unsigned I = 0; I != NumBuckets; ++I) {
+      if (Ctrl[I] < 0)
+        continue;
+      ::new (&Buckets[I].getFirst()) KeyT(Other.Buckets[I].getFirst());
+      ::new (&Buckets[I].getSecond()) ValueT(Other.Buckets[I].getSecond());
+    }
+    NumEntries = Other.NumEntries;
+    GrowthLeft = Other.GrowthLeft;
+  }
+};
+
+template <typename KeyT, typename ValueT, typename KeyInfoT>
+inline size_t
+capacity_in_bytes(const FlatHashMap<KeyT, ValueT, KeyInfoT> &X) {
+  return X.getMemorySize();
+}
+
+} // end namespace llvm
+
+#endif // LLVM_ADT_FLATHASHMAP_H
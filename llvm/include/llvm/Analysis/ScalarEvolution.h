@@ -1353,6 +1353,11 @@ private:
     /// subexpression.
     bool hasOperand(const SCEV *S, ScalarEvolution *SE) const;
 
+    /// Add every subexpression of the backedge taken count expressions to
+    /// \p Ops.
+    void collectOperands(SmallPtrSetImpl<const SCEV *> &Ops,
+                         ScalarEvolution *SE) const;
+
     /// Invalidate this result and free associated memory.
     void clear();
   };
@@ -1365,6 +1370,20 @@ private:
   /// function as they are computed.
   DenseMap<const Loop *, BackedgeTakenInfo> PredicatedBackedgeTakenCounts;
 
+  /// Map each subexpression of a cached backedge-taken count to the loops
+  /// whose count uses it, with a flag telling whether the count is the
+  /// predicated one. This lets forgetMemoizedResults find the counts to drop
+  /// without looking at every loop. Entries may be stale, so the counts are
+  /// checked again before being dropped.
+  DenseMap<const SCEV *,
+           SmallVector<PointerIntPair<const Loop *, 1, bool>, 2>>
+      BECountUsers;
+
+  /// Record the subexpressions of the backedge-taken count \p BTI of \p L
+  /// in BECountUsers.
+  void addBECountUsers(const Loop *L, const BackedgeTakenInfo &BTI,
+                       bool Predicated);
+
   /// This map contains entries for all of the PHI instructions that we
   /// attempt to compute constant evolutions for.  This allows us to avoid
   /// potentially expensive recomputation of these properties.  An instruction
@@ -679,6 +679,11 @@ public:
   /// vector loads/stores.
   bool enableMaskedInterleavedAccessVectorization() const;
 
+  /// Indicate that the vectorizer should fold the tail of loops with a small
+  /// trip count by masking, rather than running the remaining iterations in
+  /// a scalar epilogue.
+  bool preferPredicateOverEpilogue() const;
+
   /// Indicate that it is potentially unsafe to automatically vectorize
   /// floating-point operations because the semantics of vector and scalar
   /// floating-point semantics may differ. For example, ARM NEON v7 SIMD math
@@ -787,6 +792,13 @@ public:
   /// applies when shouldMaximizeVectorBandwidth returns true.
   unsigned getMinimumVF(unsigned ElemWidth) const;
 
+  /// \return The cost, as a percentage of the cost computed from the
+  /// instructions, of running vector code using registers of \p BitWidth bits
+  /// wider than getRegisterBitWidth(true), or 0 if such registers should not
+  /// be used. This lets the loop vectorizer use wider registers only when they
+  /// pay for a cost the instructions don't show, such as a lower frequency.
+  unsigned getWideVectorRegisterCostPercent(unsigned BitWidth) const;
+
   /// \return True if it should be considered for address type promotion.
   /// \p AllowPromotionWithoutCommonHeader Set true if promoting \p I is
   /// profitable without finding other extensions fed by the same input.
@@ -1198,6 +1210,7 @@ public:
   enableMemCmpExpansion(bool OptSize, bool IsZeroCmp) const = 0;
   virtual bool enableInterleavedAccessVectorization() = 0;
   virtual bool enableMaskedInterleavedAccessVectorization() = 0;
+  virtual bool preferPredicateOverEpilogue() = 0;
   virtual bool isFPVectorizationPotentiallyUnsafe() = 0;
   virtual bool allowsMisalignedMemoryAccesses(LLVMContext &Context,
                                               unsigned BitWidth,
@@ -1220,6 +1233,7 @@ public:
   virtual unsigned getMinVectorRegisterBitWidth() = 0;
   virtual bool shouldMaximizeVectorBandwidth(bool OptSize) const = 0;
   virtual unsigned getMinimumVF(unsigned ElemWidth) const = 0;
+  virtual unsigned getWideVectorRegisterCostPercent(unsigned BitWidth) const = 0;
   virtual bool shouldConsiderAddressTypePromotion(
       const Instruction &I, bool &AllowPromotionWithoutCommonHeader) = 0;
   virtual unsigned getCacheLineSize() = 0;
@@ -1512,6 +1526,9 @@ public:
   bool enableMaskedInterleavedAccessVectorization() override {
     return Impl.enableMaskedInterleavedAccessVectorization();
   }
+  bool preferPredicateOverEpilogue() override {
+    return Impl.preferPredicateOverEpilogue();
+  }
   bool isFPVectorizationPotentiallyUnsafe() override {
     return Impl.isFPVectorizationPotentiallyUnsafe();
   }
@@ -1562,6 +1579,9 @@ public:
   unsigned getMinimumVF(unsigned ElemWidth) const override {
     return Impl.getMinimumVF(ElemWidth);
   }
+  unsigned getWideVectorRegisterCostPercent(unsigned BitWidth) const override {
+    return Impl.getWideVectorRegisterCostPercent(BitWidth);
+  }
   bool shouldConsiderAddressTypePromotion(
       const Instruction &I, bool &AllowPromotionWithoutCommonHeader) override {
     return Impl.shouldConsiderAddressTypePromotion(
@@ -311,6 +311,8 @@ public:
 
   bool enableMaskedInterleavedAccessVectorization() { return false; }
 
+  bool preferPredicateOverEpilogue() { return false; }
+
   bool isFPVectorizationPotentiallyUnsafe() { return false; }
 
   bool allowsMisalignedMemoryAccesses(LLVMContext &Context,
@@ -356,6 +358,10 @@ public:
 
   unsigned getMinimumVF(unsigned ElemWidth) const { return 0; }
 
+  unsigned getWideVectorRegisterCostPercent(unsigned BitWidth) const {
+    return 0;
+  }
+
   bool
   shouldConsiderAddressTypePromotion(const Instruction &I,
                                      bool &AllowPromotionWithoutCommonHeader) {
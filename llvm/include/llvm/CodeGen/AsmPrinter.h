@@ -311,6 +311,14 @@ public:
 
   void emitCFIInstruction(const MachineInstr &MI);
 
+  /// Switch to the section of \p MBB, which starts a basic block section.
+  /// \p PrevCFIs are the CFI instructions of the blocks emitted before it.
+  void emitBasicBlockSectionStart(const MachineBasicBlock &MBB,
+                                  ArrayRef<const MachineInstr *> PrevCFIs);
+
+  /// Emit the size of the basic block section that ends with \p MBB.
+  void emitBasicBlockSectionSize(const MachineBasicBlock &MBB);
+
   void emitFrameAlloc(const MachineInstr &MI);
 
   void emitStackSizeSection(const MachineFunction &MF);
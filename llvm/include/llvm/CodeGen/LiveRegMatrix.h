@@ -57,6 +57,13 @@ class LiveRegMatrix : public MachineFunctionPass {
   unsigned RegMaskVirtReg = 0;
   BitVector RegMaskUsable;
 
+  // Cached register unit interference info of RegUnitVirtReg, indexed by
+  // PhysReg: the registers checked so far, and those that interfere.
+  unsigned RegUnitTag = 0;
+  unsigned RegUnitVirtReg = 0;
+  BitVector RegUnitChecked;
+  BitVector RegUnitInterference;
+
   // MachineFunctionPass boilerplate.
   void getAnalysisUsage(AnalysisUsage &) const override;
   bool runOnMachineFunction(MachineFunction &) override;
@@ -77,6 +77,11 @@ public:
         : PhysReg(PhysReg), LaneMask(LaneMask) {}
   };
 
+  /// IDs of the sections of basic blocks, when the function is emitted into
+  /// several sections. Blocks in FunctionSectionID stay in the section of the
+  /// function; blocks in ColdSectionID go to the cold section of the function.
+  enum : unsigned { FunctionSectionID = 0, ColdSectionID = ~0U };
+
 private:
   using Instructions = ilist<MachineInstr, ilist_sentinel_tracking<true>>;
 
@@ -129,6 +134,9 @@ private:
   /// Indicate that this basic block is the entry block of a cleanup funclet.
   bool IsCleanupFuncletEntry = false;
 
+  /// The ID of the section the block is emitted into.
+  unsigned SectionID = FunctionSectionID;
+
   /// since getSymbol is a relatively heavy-weight operation, the symbol
   /// is only computed once and is cached.
   mutable MCSymbol *CachedMCSymbol = nullptr;
@@ -413,6 +421,20 @@ public:
   /// Returns true if it is legal to hoist instructions into this block.
   bool isLegalToHoistInto() const;
 
+  /// Returns the ID of the section the block is emitted into, if its function
+  /// has basic block sections. The blocks of each section are contiguous in
+  /// the layout, and the blocks in FunctionSectionID come first.
+  unsigned getSectionID() const { return SectionID; }
+
+  /// Sets the ID of the section the block is emitted into.
+  void setSectionID(unsigned ID) { SectionID = ID; }
+
+  /// Returns true if the block is the first one of its section.
+  bool isBeginSection() const;
+
+  /// Returns true if the block is the last one of its section.
+  bool isEndSection() const;
+
   // Code Layout methods.
 
   /// Move 'this' block before or after the specified block.  This only moves
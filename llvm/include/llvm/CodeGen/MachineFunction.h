@@ -61,6 +61,7 @@ class MachineJumpTableInfo;
 class MachineModuleInfo;
 class MachineRegisterInfo;
 class MCContext;
+class MCSection;
 class MCInstrDesc;
 class MCSymbol;
 class Pass;
@@ -292,6 +293,13 @@ class MachineFunction {
   /// True if any WinCFI instruction have been emitted in this function.
   bool HasWinCFI = false;
 
+  /// True if some basic blocks of the function are emitted into sections of
+  /// their own. See MachineBasicBlock::getSectionID().
+  bool HasBBSections = false;
+
+  /// The section the function is emitted into.
+  MCSection *Section = nullptr;
+
   /// Current high-level properties of the IR of the function (e.g. is in SSA
   /// form or whether registers have been allocated)
   MachineFunctionProperties Properties;
@@ -508,6 +516,16 @@ public:
   const WinEHFuncInfo *getWinEHFuncInfo() const { return WinEHInfo; }
   WinEHFuncInfo *getWinEHFuncInfo() { return WinEHInfo; }
 
+  /// Returns the section the function is emitted into, once the AsmPrinter
+  /// selected it.
+  MCSection *getSection() const { return Section; }
+  void setSection(MCSection *S) { Section = S; }
+
+  /// Returns true if some basic blocks of the function are emitted into
+  /// sections of their own.
+  bool hasBBSections() const { return HasBBSections; }
+  void setHasBBSections(bool V = true) { HasBBSections = V; }
+
   /// getAlignment - Return the alignment (log2, not bytes) of the function.
   unsigned getAlignment() const { return Alignment; }
 
@@ -310,6 +310,10 @@ namespace llvm {
   /// This pass inserts FEntry calls
   extern char &FEntryInserterID;
 
+  /// This pass assigns basic blocks to sections of their own, as selected by
+  /// -basic-block-sections.
+  extern char &BasicBlockSectionsID;
+
   /// This pass implements the "patchable-function" attribute.
   extern char &PatchableFunctionID;
 
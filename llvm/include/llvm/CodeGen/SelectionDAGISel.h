@@ -14,6 +14,8 @@
 #ifndef LLVM_CODEGEN_SELECTIONDAGISEL_H
 #define LLVM_CODEGEN_SELECTIONDAGISEL_H
 
+#include "llvm/ADT/BitVector.h"
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/CodeGen/MachineFunctionPass.h"
 #include "llvm/CodeGen/SelectionDAG.h"
 #include "llvm/CodeGen/TargetSubtargetInfo.h"
@@ -353,6 +355,27 @@ private:
   /// state machines that start with a OPC_SwitchOpcode node.
   std::vector<unsigned> OpcodeOffset;
 
+  /// The cases selected by the OPC_SwitchOpcode and OPC_SwitchType nodes that
+  /// have many cases, keyed by the index of the node in the matcher table and
+  /// the opcode or type matched against it. The value is the index of the
+  /// selected case, or 0 if no case matched.
+  DenseMap<uint64_t, unsigned> SwitchCaseCache;
+
+  /// The matcher table indices of the switch nodes cached in SwitchCaseCache,
+  /// so that the short switches do not pay for a lookup.
+  BitVector CachedSwitches;
+
+  /// Sets \p CaseIndex to the cached case of the switch node at \p SwitchStart
+  /// for \p Key, and returns true, if it is cached.
+  bool lookupSwitchCache(uint64_t Key, unsigned SwitchStart,
+                         unsigned &CaseIndex);
+
+  /// Caches \p CaseIndex for \p Key if finding it scanned many cases of the
+  /// switch node at \p SwitchStart.
+  void addToSwitchCache(uint64_t Key, unsigned SwitchStart,
+                        unsigned NumCasesScanned, unsigned TableSize,
+                        unsigned CaseIndex);
+
   void UpdateChains(SDNode *NodeToMatch, SDValue InputChain,
                     SmallVectorImpl<SDNode *> &ChainNodesMatched,
                     bool isMorphNodeTo);
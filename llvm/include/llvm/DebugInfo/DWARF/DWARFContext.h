@@ -300,6 +300,10 @@ public:
   getLineTableForUnit(DWARFUnit *U,
                       std::function<void(Error)> RecoverableErrorCallback);
 
+  /// Extract the DIEs and line tables of \p Units on all available threads,
+  /// so that later queries against those units find them already parsed.
+  void prefetchUnits(ArrayRef<DWARFUnit *> Units);
+
   DataExtractor getStringExtractor() const {
     return DataExtractor(DObj->getStringSection(), false, 0);
   }
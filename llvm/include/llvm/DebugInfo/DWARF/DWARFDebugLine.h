@@ -300,6 +300,9 @@ public:
       DWARFDataExtractor &DebugLineData, uint32_t Offset,
       const DWARFContext &Ctx, const DWARFUnit *U,
       std::function<void(Error)> RecoverableErrorCallback);
+  /// Cache a line table that was parsed outside of getOrParseLineTable(), e.g.
+  /// on another thread. An existing entry for \p Offset is kept.
+  void addLineTable(uint32_t Offset, LineTable &&LT);
 
   /// Helper to allow for parsing of an entire .debug_line section in sequence.
   class SectionParser {
@@ -43,6 +43,10 @@ public:
     std::vector<std::string> DsymHints;
     std::string FallbackDebugPath;
     std::string DWPName;
+    /// Upper bound, in bytes, on the size of the binaries kept open by the
+    /// symbolizer. Once it is exceeded, all cached modules are dropped before
+    /// the next module is loaded. 0 means no limit.
+    uint64_t MaxCacheSize = 0;
   };
 
   LLVMSymbolizer() = default;
@@ -111,6 +115,9 @@ private:
   std::map<std::pair<std::string, std::string>, std::unique_ptr<ObjectFile>>
       ObjectForUBPathAndArch;
 
+  /// Total size of the buffers held by BinaryForPath.
+  uint64_t CacheSize = 0;
+
   Options Opts;
 };
 
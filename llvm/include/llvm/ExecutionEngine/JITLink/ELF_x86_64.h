@@ -0,0 +1,51 @@
+//===----- ELF_x86_64.h - JIT link functions for ELF/x86-64 -----*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// jit-link functions for ELF/x86-64.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_EXECUTIONENGINE_JITLINK_ELF_X86_64_H
+#define LLVM_EXECUTIONENGINE_JITLINK_ELF_X86_64_H
+
+#include "llvm/ExecutionEngine/JITLink/JITLink.h"
+
+namespace llvm {
+namespace jitlink {
+
+namespace ELF_x86_64_Edges {
+
+/// The edge kinds of ELF/x86-64 graphs. Unlike the MachO kinds, the addend of
+/// an edge is the ELF addend: PC-relative fixups compute
+/// Target + Addend - FixupAddress.
+enum ELFX86RelocationKind : Edge::Kind {
+  Branch32 = Edge::FirstRelocation,
+  Pointer32,
+  Pointer32Signed,
+  Pointer64,
+  PCRel32,
+  PCRel64,
+  PCRel32GOTLoad,
+  NegDelta32,
+};
+
+} // namespace ELF_x86_64_Edges
+
+/// jit-link the given ELF/x86-64 relocatable object.
+///
+/// Only the small and medium code models are supported: thread-local storage
+/// and the GOT-relative relocations of the large code model are reported as
+/// errors.
+void jitLink_ELF_x86_64(std::unique_ptr<JITLinkContext> Ctx);
+
+StringRef getELFX86RelocationKindName(Edge::Kind R);
+
+} // end namespace jitlink
+} // end namespace llvm
+
+#endif // LLVM_EXECUTIONENGINE_JITLINK_ELF_X86_64_H
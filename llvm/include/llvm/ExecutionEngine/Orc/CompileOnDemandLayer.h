@@ -95,6 +95,13 @@ public:
   /// called by the JIT when a definition added via the add method is requested.
   void emit(MaterializationResponsibility R, ThreadSafeModule TSM) override;
 
+  /// Points the stub for Name, a callable that this layer emitted to the
+  /// implementation dylib ImplD, at NewAddr. This replaces the implementation
+  /// of Name for all callers that go through the stub, e.g. with a
+  /// recompiled version of the function.
+  Error updateStubPointer(JITDylib &ImplD, const SymbolStringPtr &Name,
+                          JITTargetAddress NewAddr);
+
 private:
   struct PerDylibResources {
   public:
@@ -18,6 +18,7 @@
 #include "llvm/ExecutionEngine/Orc/SymbolStringPool.h"
 #include "llvm/IR/Module.h"
 #include "llvm/Support/Debug.h"
+#include "llvm/Support/RWMutex.h"
 
 #include <memory>
 #include <vector>
@@ -717,6 +718,9 @@ private:
                   std::vector<std::unique_ptr<MaterializationUnit>> &MUs,
                   SymbolNameSet &Unresolved);
 
+  bool lookupReady(const SymbolNameSet &Names, bool MatchNonExported,
+                   SymbolMap &Result);
+
   void detachQueryHelper(AsynchronousSymbolQuery &Q,
                          const SymbolNameSet &QuerySymbols);
 
@@ -746,6 +750,13 @@ private:
   MaterializingInfosMap MaterializingInfos;
   GeneratorFunction DefGenerator;
   JITDylibSearchList SearchOrder;
+
+  // The symbols that have reached SymbolState::Ready. Lookups that only need
+  // these are answered under this lock rather than the session lock, which
+  // is only taken here by writers, so compile threads looking up finished
+  // symbols do not contend with materialization.
+  sys::RWMutex ReadySymbolsMutex;
+  SymbolMap ReadySymbols;
 };
 
 /// An ExecutionSession represents a running JIT program.
@@ -21,6 +21,7 @@
 #include "llvm/ExecutionEngine/Orc/JITTargetMachineBuilder.h"
 #include "llvm/ExecutionEngine/Orc/ObjectTransformLayer.h"
 #include "llvm/ExecutionEngine/Orc/ThreadSafeModule.h"
+#include "llvm/ExecutionEngine/Orc/TieredCompileLayer.h"
 #include "llvm/Support/ThreadPool.h"
 
 namespace llvm {
@@ -148,6 +149,7 @@ class LLLazyJIT : public LLJIT {
   template <typename, typename, typename> friend class LLJITBuilderSetters;
 
 public:
+  ~LLLazyJIT();
 
   /// Set an IR transform (e.g. pass manager pipeline) to run on each function
   /// when it is compiled.
@@ -176,6 +178,9 @@ private:
 
   std::unique_ptr<LazyCallThroughManager> LCTMgr;
   std::unique_ptr<IRTransformLayer> TransformLayer;
+  std::unique_ptr<IRCompileLayer> OptCompileLayer;
+  std::unique_ptr<IRTransformLayer> OptTransformLayer;
+  std::unique_ptr<TieredCompileLayer> TieredLayer;
   std::unique_ptr<CompileOnDemandLayer> CODLayer;
 };
 
@@ -187,6 +192,7 @@ public:
   std::unique_ptr<ExecutionSession> ES;
   Optional<JITTargetMachineBuilder> JTMB;
   CreateObjectLinkingLayerFunction CreateObjectLinkingLayer;
+  ObjectCache *ObjCache = nullptr;
   unsigned NumCompileThreads = 0;
 
   /// Called prior to JIT class construcion to fix up defaults.
@@ -222,6 +228,16 @@ public:
     return impl();
   }
 
+  /// Set an ObjectCache for the compile layer to query before compiling a
+  /// module, such as a PersistentObjectCache. The cache must outlive the JIT,
+  /// and be thread-safe if there are compile threads.
+  ///
+  /// If this method is not called, every module is compiled.
+  SetterImpl &setObjectCache(ObjectCache *ObjCache) {
+    impl().ObjCache = ObjCache;
+    return impl();
+  }
+
   /// Set the number of compile threads to use.
   ///
   /// If set to zero, compilation will be performed on the execution thread when
@@ -267,6 +283,9 @@ public:
   JITTargetAddress LazyCompileFailureAddr = 0;
   std::unique_ptr<LazyCallThroughManager> LCTMgr;
   IndirectStubsManagerBuilderFunction ISMBuilder;
+  unsigned HotCallThreshold = 0;
+  Optional<JITTargetMachineBuilder> OptJTMB;
+  IRTransformLayer::TransformFunction OptTransform;
 
   Error prepareForConstruction();
 };
@@ -302,6 +321,24 @@ public:
     this->impl().ISMBuilder = std::move(ISMBuilder);
     return this->impl();
   }
+
+  /// Enable tiered compilation: functions are first compiled with the
+  /// JITTargetMachineBuilder of the JIT, which should favor compile time
+  /// (e.g. CodeGenOpt::None with FastISel). A function that is called
+  /// HotCallThreshold times is then recompiled in the background (on the
+  /// compile threads, if any) with OptJTMB, after running OptTransform on it,
+  /// and its stub is pointed at the optimized code.
+  ///
+  /// If this method is not called then functions are compiled once.
+  SetterImpl &setTieredCompilation(
+      unsigned HotCallThreshold, JITTargetMachineBuilder OptJTMB,
+      IRTransformLayer::TransformFunction OptTransform =
+          IRTransformLayer::identityTransform) {
+    this->impl().HotCallThreshold = HotCallThreshold;
+    this->impl().OptJTMB = std::move(OptJTMB);
+    this->impl().OptTransform = std::move(OptTransform);
+    return this->impl();
+  }
 };
 
 /// Constructs LLLazyJIT instances.
@@ -0,0 +1,121 @@
+//===- PersistentObjectCache.h - Cache of JIT'd objects on disk -*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// Contains an ObjectCache that keys the objects compiled by the JIT by the
+// hash of their module and target configuration, and keeps them in a store
+// that outlives the process, so that a restarted JIT can skip codegen for
+// the modules that it compiled before.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_EXECUTIONENGINE_ORC_PERSISTENTOBJECTCACHE_H
+#define LLVM_EXECUTIONENGINE_ORC_PERSISTENTOBJECTCACHE_H
+
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ExecutionEngine/ObjectCache.h"
+#include "llvm/ExecutionEngine/Orc/JITTargetMachineBuilder.h"
+#include "llvm/Support/CachePruning.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace llvm {
+
+class Module;
+class TargetMachine;
+
+namespace orc {
+
+/// A store for the objects of a PersistentObjectCache.
+///
+/// Implementations must be safe to call from several compile threads at once.
+class ObjectCacheStore {
+public:
+  virtual ~ObjectCacheStore();
+
+  /// Returns the object stored under \p Key, or null if there is none.
+  virtual std::unique_ptr<MemoryBuffer> load(StringRef Key) = 0;
+
+  /// Stores \p Obj under \p Key. The store is best-effort: objects that can
+  /// not be stored are simply compiled again the next time.
+  virtual void store(StringRef Key, MemoryBufferRef Obj) = 0;
+};
+
+/// Stores objects as the files of a directory, which are memory mapped when
+/// they are loaded.
+///
+/// The files are named like the LTO cache entries, so the directory is pruned
+/// by pruneCache() with the given policy. This happens when the store is
+/// destroyed, and on every call to prune().
+class DirectoryObjectCacheStore : public ObjectCacheStore {
+public:
+  /// Creates a store in the directory \p Path, creating the directory if it
+  /// does not exist.
+  static Expected<std::unique_ptr<DirectoryObjectCacheStore>>
+  Create(StringRef Path, CachePruningPolicy Policy = CachePruningPolicy());
+
+  ~DirectoryObjectCacheStore() override;
+
+  std::unique_ptr<MemoryBuffer> load(StringRef Key) override;
+  void store(StringRef Key, MemoryBufferRef Obj) override;
+
+  /// Prunes the directory with the policy of the store. Returns true if the
+  /// pruning interval of the policy had expired.
+  bool prune();
+
+private:
+  DirectoryObjectCacheStore(std::string Path, CachePruningPolicy Policy)
+      : Path(std::move(Path)), Policy(std::move(Policy)) {}
+
+  std::string Path;
+  CachePruningPolicy Policy;
+};
+
+/// An ObjectCache that keeps the objects compiled by the JIT in an
+/// ObjectCacheStore, keyed by a hash of the bitcode of their module and of the
+/// configuration of the target machine that compiled them.
+///
+/// Give the cache to SimpleCompiler, ConcurrentIRCompiler or
+/// LLJITBuilder::setObjectCache to have the IRCompileLayer look up a module
+/// before compiling it. The cache may be shared by several compile threads.
+class PersistentObjectCache : public ObjectCache {
+public:
+  /// Creates a cache for the objects compiled by target machines built by
+  /// \p JTMB. \p ExtraKey is added to the key of every module, and should
+  /// identify anything else that changes the objects, such as the version of
+  /// the client.
+  static Expected<std::unique_ptr<PersistentObjectCache>>
+  Create(std::unique_ptr<ObjectCacheStore> Store, JITTargetMachineBuilder JTMB,
+         StringRef ExtraKey = "");
+
+  /// Creates a cache for the objects compiled by \p TM.
+  PersistentObjectCache(std::unique_ptr<ObjectCacheStore> Store,
+                        const TargetMachine &TM, StringRef ExtraKey = "");
+
+  void notifyObjectCompiled(const Module *M, MemoryBufferRef Obj) override;
+  std::unique_ptr<MemoryBuffer> getObject(const Module *M) override;
+
+  /// Returns the key under which the object of \p M is stored.
+  std::string getKey(const Module &M) const;
+
+private:
+  std::unique_ptr<ObjectCacheStore> Store;
+  std::string TargetKey;
+
+  // The keys of the modules that missed in getObject, so that they are not
+  // hashed again when their objects are stored.
+  std::mutex PendingKeysMutex;
+  DenseMap<const Module *, std::string> PendingKeys;
+};
+
+} // end namespace orc
+} // end namespace llvm
+
+#endif // LLVM_EXECUTIONENGINE_ORC_PERSISTENTOBJECTCACHE_H
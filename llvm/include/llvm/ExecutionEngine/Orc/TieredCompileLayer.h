@@ -0,0 +1,88 @@
+//===---- TieredCompileLayer.h - Recompile hot functions --------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// JIT layer that counts the calls to the functions that it emits, and
+// recompiles the functions that become hot with an optimizing layer.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_EXECUTIONENGINE_ORC_TIEREDCOMPILELAYER_H
+#define LLVM_EXECUTIONENGINE_ORC_TIEREDCOMPILELAYER_H
+
+#include "llvm/ADT/DenseSet.h"
+#include "llvm/ExecutionEngine/JITSymbol.h"
+#include "llvm/ExecutionEngine/Orc/Layer.h"
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace llvm {
+namespace orc {
+
+/// Emits modules to a fast (tier-1) layer, instrumenting each externally
+/// visible function with a call counter. When a function has been called
+/// HotCallThreshold times, an uninstrumented copy of the function is emitted
+/// to a second, optimizing (tier-2) layer, and the UpdateImpl callback is
+/// asked to redirect the callers of the function to the optimized code.
+///
+/// This layer is meant to sit below a CompileOnDemandLayer, whose
+/// updateStubPointer method redirects the callers: calls that go through the
+/// stubs of the CompileOnDemandLayer reach the optimized code, while direct
+/// calls within a partition keep calling the tier-1 code.
+///
+/// The counters call back into the JIT process, so the JIT'd code must run in
+/// the same process as the layer.
+class TieredCompileLayer : public IRLayer {
+public:
+  /// Redirects the callers of the symbol Name, implemented in JD, to the
+  /// optimized implementation at NewAddr.
+  using UpdateImplFunction = std::function<Error(
+      JITDylib &JD, const SymbolStringPtr &Name, JITTargetAddress NewAddr)>;
+
+  /// Construct a TieredCompileLayer that emits modules to BaseLayer, and hot
+  /// functions to OptimizingLayer. Hot functions are compiled wherever the
+  /// ExecutionSession dispatches materialization, e.g. on compile threads, so
+  /// that the hot call does not wait for the optimized code.
+  TieredCompileLayer(ExecutionSession &ES, IRLayer &BaseLayer,
+                     IRLayer &OptimizingLayer, unsigned HotCallThreshold,
+                     UpdateImplFunction UpdateImpl);
+
+  void emit(MaterializationResponsibility R, ThreadSafeModule TSM) override;
+
+private:
+  struct TieredFunction {
+    TieredCompileLayer *Layer;
+    JITDylib *JD;
+    std::shared_ptr<ThreadSafeModule> Source;
+    std::string Name;
+    SymbolStringPtr ImplName;
+    SymbolStringPtr OptImplName;
+  };
+
+  static void tierUpEntry(void *Ctx);
+
+  Error defineTierUpEntry(JITDylib &JD, const DataLayout &DL);
+  void instrument(Module &M, JITDylib &JD,
+                  std::shared_ptr<ThreadSafeModule> Source);
+  void recompile(TieredFunction &TF);
+
+  std::mutex TieredLayerMutex;
+  IRLayer &BaseLayer;
+  IRLayer &OptimizingLayer;
+  unsigned HotCallThreshold;
+  UpdateImplFunction UpdateImpl;
+  DenseSet<const JITDylib *> DylibsWithTierUpEntry;
+  std::list<TieredFunction> TieredFunctions;
+};
+
+} // end namespace orc
+} // end namespace llvm
+
+#endif // LLVM_EXECUTIONENGINE_ORC_TIEREDCOMPILELAYER_H
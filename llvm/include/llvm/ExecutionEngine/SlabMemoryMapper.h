@@ -0,0 +1,80 @@
+//===- SlabMemoryMapper.h - Slab allocator for JIT memory -------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// This file declares a SectionMemoryManager::MemoryMapper that carves the
+// memory of the JIT out of large, huge-page backed slabs.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_EXECUTIONENGINE_SLABMEMORYMAPPER_H
+#define LLVM_EXECUTIONENGINE_SLABMEMORYMAPPER_H
+
+#include "llvm/ExecutionEngine/SectionMemoryManager.h"
+#include "llvm/Support/Memory.h"
+#include <cstddef>
+#include <map>
+#include <mutex>
+
+namespace llvm {
+
+/// A MemoryMapper that hands out page-granular blocks from slabs of SlabSize
+/// bytes, with one current slab per allocation purpose. The code of many
+/// small objects then shares a few huge pages, rather than each object
+/// taking its own pages for code, read-only and read-write data, which
+/// fragments memory and the iTLB when there are many JIT'd objects.
+///
+/// One mapper is meant to be shared by the SectionMemoryManagers of all the
+/// objects of a JIT, e.g. those created by an RTDyldObjectLinkingLayer. It is
+/// thread-safe, and must outlive these memory managers. A slab is unmapped
+/// once all the blocks carved from it are released.
+class SlabMemoryMapper final : public SectionMemoryManager::MemoryMapper {
+public:
+  /// Creates a mapper with slabs of (at least) \p SlabSize bytes. If
+  /// \p UseHugePages is true the slabs are backed by huge pages where the
+  /// system supports it (see sys::Memory::MF_HUGE_HINT).
+  SlabMemoryMapper(size_t SlabSize = 2 * 1024 * 1024,
+                   bool UseHugePages = true);
+  ~SlabMemoryMapper() override;
+
+  sys::MemoryBlock
+  allocateMappedMemory(SectionMemoryManager::AllocationPurpose Purpose,
+                       size_t NumBytes, const sys::MemoryBlock *const NearBlock,
+                       unsigned Flags, std::error_code &EC) override;
+
+  std::error_code protectMappedMemory(const sys::MemoryBlock &Block,
+                                      unsigned Flags) override;
+
+  std::error_code releaseMappedMemory(sys::MemoryBlock &M) override;
+
+  /// Returns the number of slabs currently mapped.
+  size_t getNumSlabs() const;
+
+private:
+  struct Slab {
+    sys::MemoryBlock Mem;
+    size_t Used = 0;
+    size_t LiveBlocks = 0;
+  };
+
+  using SlabMap = std::map<uintptr_t, Slab>;
+
+  static unsigned purposeIndex(SectionMemoryManager::AllocationPurpose P);
+
+  mutable std::mutex SlabsMutex;
+  size_t SlabSize;
+  bool UseHugePages;
+  size_t PageSize;
+  // The slabs, keyed by their base address.
+  SlabMap Slabs;
+  // The slab that each allocation purpose currently carves blocks from.
+  SlabMap::iterator CurrentSlab[3];
+};
+
+} // end namespace llvm
+
+#endif // LLVM_EXECUTIONENGINE_SLABMEMORYMAPPER_H
@@ -55,6 +55,26 @@ struct Config {
   /// Disable entirely the optimizer, including importing for ThinLTO
   bool CodeGenOnly = false;
 
+  /// For regular LTO with more than one code generation partition, only run
+  /// the interprocedural passes on the merged module and the function passes
+  /// on each partition, in parallel. Only works with the old pass manager.
+  /// Optimization remarks are only emitted for the interprocedural passes.
+  bool ParallelOptimization = false;
+
+  /// The number of threads that generate the code of the partitions of the
+  /// regular LTO module, or 0 for one thread per partition. With more
+  /// partitions than threads, each thread picks the next partition when it is
+  /// done with one, which balances partitions that take very different times.
+  unsigned CodeGenThreads = 0;
+
+  /// When the native object of a ThinLTO backend is not in the cache, import
+  /// functions into the module and look it up again, by the contents of the
+  /// module after importing rather than by the hashes of the whole modules it
+  /// imports from. Changes to the parts of those modules that are not
+  /// imported then leave the object in the cache. The cache may add the same
+  /// object file for a task twice.
+  bool CacheByImportedContent = false;
+
   /// Run PGO context sensitive IR instrumentation.
   bool RunCSIRInstr = false;
 
@@ -25,6 +25,7 @@
 #include "llvm/Linker/IRMover.h"
 #include "llvm/Object/IRSymtab.h"
 #include "llvm/Support/Error.h"
+#include "llvm/Support/Threading.h"
 #include "llvm/Support/ToolOutputFile.h"
 #include "llvm/Support/thread.h"
 #include "llvm/Target/TargetOptions.h"
@@ -64,6 +65,11 @@ void thinLTOInternalizeAndPromoteInIndex(
 /// Computes a unique hash for the Module considering the current list of
 /// export/import and other global analysis results.
 /// The hash is produced in \p Key.
+///
+/// If \p ImportedModuleHash is not empty, it is the hash of the module after
+/// function importing, which replaces the hashes of the module and of the
+/// modules it imports from. The key then stays the same when those modules
+/// change in parts that the module does not import.
 void computeLTOCacheKey(
     SmallString<40> &Key, const lto::Config &Conf,
     const ModuleSummaryIndex &Index, StringRef ModuleID,
@@ -72,7 +78,8 @@ void computeLTOCacheKey(
     const std::map<GlobalValue::GUID, GlobalValue::LinkageTypes> &ResolvedODR,
     const GVSummaryMapTy &DefinedGlobals,
     const std::set<GlobalValue::GUID> &CfiFunctionDefs = {},
-    const std::set<GlobalValue::GUID> &CfiFunctionDecls = {});
+    const std::set<GlobalValue::GUID> &CfiFunctionDecls = {},
+    ArrayRef<uint8_t> ImportedModuleHash = None);
 
 namespace lto {
 
@@ -227,6 +234,10 @@ using ThinBackend = std::function<std::unique_ptr<ThinBackendProc>(
 /// This ThinBackend runs the individual backend jobs in-process.
 ThinBackend createInProcessThinBackend(unsigned ParallelismLevel);
 
+/// This ThinBackend runs the individual backend jobs in-process, on threads
+/// created and placed according to \p Parallelism.
+ThinBackend createInProcessThinBackend(ThreadPoolStrategy Parallelism);
+
 /// This ThinBackend writes individual module indexes to files, instead of
 /// running the individual backend jobs. This backend is for distributed builds
 /// where separate processes will invoke the real backends.
@@ -247,6 +258,44 @@ ThinBackend createWriteIndexesThinBackend(std::string OldPrefix,
                                           raw_fd_ostream *LinkedObjectsFile,
                                           IndexWriteCallback OnWrite);
 
+/// A ThinLTO backend job that can run without the other modules of the link,
+/// for instance on another machine.
+struct RemoteThinBackendJob {
+  /// The task that the object file is produced for.
+  unsigned Task;
+  /// The identifier of the module in the link.
+  std::string ModuleID;
+  /// The bitcode of the module after function importing. It has the bodies of
+  /// the functions it imports, so the modules they come from are not needed.
+  std::string Bitcode;
+  /// The summaries the module needs from the combined index, in the format
+  /// of the individual indexes written for distributed backends.
+  std::string Index;
+};
+
+/// Runs \p Job and writes its object file to a stream obtained from
+/// \p AddStream. Returns false, without calling \p AddStream, to have the job
+/// run in-process instead, for instance because no worker is available. It is
+/// called concurrently from the threads of the backend.
+using RemoteThinBackendFn = std::function<Expected<bool>(
+    const RemoteThinBackendJob &Job, AddStreamFn AddStream)>;
+
+/// This ThinBackend does function importing for each module in-process and
+/// hands the optimization and code generation of the result to \p Execute.
+/// Only the job is shipped to the worker, which can run it with
+/// runRemoteThinBackendJob(), and whole-program bitcode is only needed
+/// locally. As calls of \p Execute usually block while a worker runs the job,
+/// \p Parallelism should allow for as many threads as there are workers;
+/// jobs that \p Execute turns down use the same threads. The native object
+/// cache is used like in createInProcessThinBackend().
+ThinBackend createRemoteThinBackend(ThreadPoolStrategy Parallelism,
+                                    RemoteThinBackendFn Execute);
+
+/// Optimizes and compiles \p Job, which createRemoteThinBackend() created with
+/// a compatible configuration, and writes the object file to \p AddStream.
+Error runRemoteThinBackendJob(Config &C, const RemoteThinBackendJob &Job,
+                              AddStreamFn AddStream);
+
 /// This class implements a resolution-based interface to LLVM's LTO
 /// functionality. It supports regular LTO, parallel LTO code generation and
 /// ThinLTO. You can use it from a linker in the following way:
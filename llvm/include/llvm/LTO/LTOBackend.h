@@ -45,6 +45,26 @@ Error thinBackend(Config &C, unsigned Task, AddStreamFn AddStream, Module &M,
                   const FunctionImporter::ImportMapTy &ImportList,
                   const GVSummaryMapTy &DefinedGlobals,
                   MapVector<StringRef, BitcodeModule> &ModuleMap);
+
+/// Runs the first half of a ThinLTO backend on \p M: promotion, symbol
+/// resolution, internalization and function importing. Afterwards \p M no
+/// longer refers to the other modules of the link, and can be shipped to
+/// thinBackendOptAndCodeGen() elsewhere. Returns false if one of the module
+/// hooks of \p C asked to stop.
+Expected<bool>
+thinBackendImport(Config &C, unsigned Task, Module &M,
+                  const ModuleSummaryIndex &CombinedIndex,
+                  const FunctionImporter::ImportMapTy &ImportList,
+                  const GVSummaryMapTy &DefinedGlobals,
+                  MapVector<StringRef, BitcodeModule> &ModuleMap);
+
+/// Runs the second half of a ThinLTO backend, optimization and code
+/// generation, on a module prepared by thinBackendImport(). \p CombinedIndex
+/// only needs to contain the summaries of the module and of its imports, like
+/// the individual indexes written for distributed backends.
+Error thinBackendOptAndCodeGen(Config &C, unsigned Task, AddStreamFn AddStream,
+                               Module &M,
+                               const ModuleSummaryIndex &CombinedIndex);
 }
 }
 
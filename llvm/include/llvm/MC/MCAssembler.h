@@ -12,6 +12,7 @@
 #include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/ADT/iterator.h"
 #include "llvm/ADT/iterator_range.h"
@@ -154,6 +155,11 @@ private:
 
   VersionInfoType VersionInfo;
 
+  /// The fragments of each section, indexed by section ordinal, whose size may
+  /// change during layout. The relaxation loop only visits these, and skips
+  /// the sections that have none.
+  std::vector<SmallVector<MCFragment *, 4>> RelaxableFragments;
+
   /// Evaluate a fixup to a relocatable expression and the value which should be
   /// placed into the fixup.
   ///
@@ -58,6 +58,8 @@ private:
 
   StringRef SectionData;
   uint64_t DecompressedSize;
+  /// The ch_type of the compression header, ELFCOMPRESS_ZLIB for gnu style.
+  uint32_t CompressionType;
 };
 
 } // end namespace object
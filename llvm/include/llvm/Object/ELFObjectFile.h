@@ -251,6 +251,15 @@ protected:
   const Elf_Shdr *DotSymtabSec = nullptr; // Symbol table section.
   ArrayRef<Elf_Word> ShndxTable;
 
+  // The string tables of DotSymtabSec and DotDynSymSec, so that symbol name
+  // lookups don't have to find and validate them for every symbol. These are
+  // empty if a string table is invalid, in which case getSymbolName reports
+  // the error.
+  StringRef DotSymtabStrTab;
+  StringRef DotDynSymStrTab;
+
+  StringRef getSymbolStringTable(const Elf_Shdr *SymTab) const;
+
   void moveSymbolNext(DataRefImpl &Symb) const override;
   Expected<StringRef> getSymbolName(DataRefImpl Symb) const override;
   Expected<uint64_t> getSymbolAddress(DataRefImpl Symb) const override;
@@ -453,14 +462,24 @@ Expected<StringRef> ELFObjectFile<ELFT>::getSymbolName(DataRefImpl Sym) const {
   if (!SymTabOrErr)
     return SymTabOrErr.takeError();
   const Elf_Shdr *SymTableSec = *SymTabOrErr;
-  auto StrTabOrErr = EF.getSection(SymTableSec->sh_link);
-  if (!StrTabOrErr)
-    return StrTabOrErr.takeError();
-  const Elf_Shdr *StringTableSec = *StrTabOrErr;
-  auto SymStrTabOrErr = EF.getStringTable(StringTableSec);
-  if (!SymStrTabOrErr)
-    return SymStrTabOrErr.takeError();
-  Expected<StringRef> Name = ESym->getName(*SymStrTabOrErr);
+
+  StringRef SymStrTab;
+  if (SymTableSec == DotSymtabSec)
+    SymStrTab = DotSymtabStrTab;
+  else if (SymTableSec == DotDynSymSec)
+    SymStrTab = DotDynSymStrTab;
+
+  if (SymStrTab.empty()) {
+    auto StrTabOrErr = EF.getSection(SymTableSec->sh_link);
+    if (!StrTabOrErr)
+      return StrTabOrErr.takeError();
+    const Elf_Shdr *StringTableSec = *StrTabOrErr;
+    auto SymStrTabOrErr = EF.getStringTable(StringTableSec);
+    if (!SymStrTabOrErr)
+      return SymStrTabOrErr.takeError();
+    SymStrTab = *SymStrTabOrErr;
+  }
+  Expected<StringRef> Name = ESym->getName(SymStrTab);
 
   // If the symbol name is empty use the section name.
   if ((!Name || Name->empty()) && ESym->getType() == ELF::STT_SECTION) {
@@ -983,7 +1002,23 @@ ELFObjectFile<ELFT>::ELFObjectFile(MemoryBufferRef Object, ELFFile<ELFT> EF,
           getELFType(ELFT::TargetEndianness == support::little, ELFT::Is64Bits),
           Object),
       EF(EF), DotDynSymSec(DotDynSymSec), DotSymtabSec(DotSymtabSec),
-      ShndxTable(ShndxTable) {}
+      ShndxTable(ShndxTable) {
+  DotSymtabStrTab = getSymbolStringTable(DotSymtabSec);
+  DotDynSymStrTab = getSymbolStringTable(DotDynSymSec);
+}
+
+template <class ELFT>
+StringRef
+ELFObjectFile<ELFT>::getSymbolStringTable(const Elf_Shdr *SymTab) const {
+  if (!SymTab)
+    return "";
+  auto StrTabOrErr = EF.getStringTableForSymtab(*SymTab);
+  if (!StrTabOrErr) {
+    consumeError(StrTabOrErr.takeError());
+    return "";
+  }
+  return *StrTabOrErr;
+}
 
 template <class ELFT>
 ELFObjectFile<ELFT>::ELFObjectFile(ELFObjectFile<ELFT> &&Other)
@@ -200,6 +200,28 @@ private:
 
 raw_ostream &operator<<(raw_ostream &OS, const SampleRecord &Sample);
 
+/// Helpers for the calling contexts of context-sensitive profiles.
+///
+/// A context-sensitive profile keeps the samples of a function apart for
+/// each calling context the function was seen in, instead of nesting them in
+/// the profiles of its callers. Each such profile is keyed by the full
+/// context, e.g. "main:3 @ foo:2.1 @ bar" for bar called at line offset 2,
+/// discriminator 1 of foo, where foo was called at line offset 3 of main.
+class SampleContext {
+public:
+  /// Returns the context of \p CalleeName called at \p CallSite of the
+  /// function whose context is \p CallerContext.
+  static std::string getCalleeContext(StringRef CallerContext,
+                                      const LineLocation &CallSite,
+                                      StringRef CalleeName);
+
+  /// Returns the name of the function that \p Context ends with.
+  static StringRef getLeafName(StringRef Context) {
+    size_t Pos = Context.rfind(" @ ");
+    return Pos == StringRef::npos ? Context : Context.substr(Pos + 3);
+  }
+};
+
 class FunctionSamples;
 
 using BodySampleMap = std::map<LineLocation, SampleRecord>;
@@ -405,6 +427,13 @@ public:
   /// Return the function name.
   StringRef getName() const { return Name; }
 
+  /// Set the full calling context of a context-sensitive profile.
+  void setContext(StringRef FunctionContext) { Context = FunctionContext; }
+
+  /// Return the full calling context of a context-sensitive profile, or an
+  /// empty string for any other profile. See SampleContext.
+  StringRef getContext() const { return Context; }
+
   /// Return the original function name if it exists in Module \p M.
   StringRef getFuncNameInModule(const Module *M) const {
     return getNameInModule(Name, M);
@@ -521,6 +550,9 @@ private:
   /// Mangled name of the function.
   StringRef Name;
 
+  /// Calling context of the function, for context-sensitive profiles.
+  StringRef Context;
+
   /// Total number of samples collected inside this function.
   ///
   /// Samples are cumulative, they include all the samples collected
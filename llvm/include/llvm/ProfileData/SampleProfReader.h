@@ -114,6 +114,22 @@
 //    total number of samples collected for the inlined instance at this
 //    callsite
 //
+// Context-sensitive profiles
+//
+// Instead of nesting the samples of inlined calls, a profile may keep the
+// samples of a function apart for each full calling context it was seen in.
+// The header of such a section has the context in brackets in place of the
+// function name, with the callers first:
+//
+//     [main:3 @ foo:2.1 @ bar]:total_samples:total_head_samples
+//
+// This section holds the samples of bar called at line offset 2,
+// discriminator 1 of foo, where foo was called at line offset 3 of main.
+// Context sections may be mixed with ordinary ones, which are used for the
+// functions that are not inlined. When an inlined call has a context section
+// of its own, the profile loader uses it in place of the nested samples.
+// Context sections are only supported by the text format.
+//
 //
 // Binary format
 // -------------
@@ -326,6 +342,9 @@ public:
   /// \brief Return the profile format.
   SampleProfileFormat getFormat() { return Format; }
 
+  /// Whether any of the profiles is keyed by a full calling context.
+  bool profileIsCS() const { return ProfileIsCS; }
+
 protected:
   /// Map every function to its associated profile.
   ///
@@ -354,6 +373,9 @@ protected:
 
   /// \brief The format of sample.
   SampleProfileFormat Format = SPF_None;
+
+  /// Whether any of the profiles is keyed by a full calling context.
+  bool ProfileIsCS = false;
 };
 
 class SampleProfileReaderText : public SampleProfileReader {
@@ -548,6 +570,7 @@ public:
       : SampleProfileReader(std::move(B), C, Underlying->getFormat()) {
     Profiles = std::move(Underlying->getProfiles());
     Summary = takeSummary(*Underlying);
+    ProfileIsCS = Underlying->profileIsCS();
     // Keep the underlying reader alive; the profile data may contain
     // StringRefs referencing names in its name table.
     UnderlyingReader = std::move(Underlying);
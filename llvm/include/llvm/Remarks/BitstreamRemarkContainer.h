@@ -0,0 +1,101 @@
+//===-- BitstreamRemarkContainer.h - Container for remarks --------------*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// This file provides declarations for things used in the various types of
+// remark containers using the LLVM bitstream format.
+//
+// A remark container starts with the magic number followed by a META_BLOCK
+// describing the container, and, for remark files, one REMARK_BLOCK per
+// remark:
+//
+// * A remarks file, emitted by BitstreamSerializer:
+//     "RMRK"
+//     BLOCKINFO_BLOCK (abbreviations for REMARK_BLOCK)
+//     META_BLOCK
+//       RECORD_META_CONTAINER_INFO: <version, RemarksFile>
+//       RECORD_META_REMARK_VERSION: <version>
+//     REMARK_BLOCK...
+//       RECORD_REMARK_STRING: <blob>...
+//       RECORD_REMARK_HEADER: <type, pass, name, function>
+//       RECORD_REMARK_DEBUG_LOC: <file, line, column>        (optional)
+//       RECORD_REMARK_HOTNESS: <hotness>                     (optional)
+//       RECORD_REMARK_ARG_WITH_DEBUGLOC / _WITHOUT_DEBUGLOC...
+//
+//   Strings are referenced by their index in the string table of the file.
+//   The string table is built as the remarks are emitted: a remark block first
+//   defines, in order, the strings that no previous remark used.
+//
+// * The remarks section embedded in an object file, pointing to that file:
+//     "RMRK"
+//     META_BLOCK
+//       RECORD_META_CONTAINER_INFO: <version, RemarksMeta>
+//       RECORD_META_REMARK_VERSION: <version>
+//       RECORD_META_EXTERNAL_FILE: <blob>
+//
+//   Containers are a whole number of 32-bit words, so the remarks sections
+//   of several objects can be concatenated by a linker or dsymutil and still
+//   be read one container after the other.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_REMARKS_BITSTREAM_REMARK_CONTAINER_H
+#define LLVM_REMARKS_BITSTREAM_REMARK_CONTAINER_H
+
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Bitstream/BitCodes.h"
+#include <cstdint>
+
+namespace llvm {
+namespace remarks {
+
+/// The magic number identifying a bitstream remark container.
+constexpr StringRef ContainerMagic("RMRK", 4);
+
+/// The current version of the remark container.
+constexpr uint64_t CurrentContainerVersion = 0;
+
+/// The type of a bitstream remark container.
+enum class BitstreamRemarkContainerType {
+  /// A file containing remarks, along with the strings they use.
+  RemarksFile,
+  /// The section of an object file referencing the remarks file.
+  RemarksMeta,
+  LastTypeValue = RemarksMeta
+};
+
+/// The block IDs used in a bitstream remark container.
+enum BlockIDs {
+  META_BLOCK_ID = bitc::FIRST_APPLICATION_BLOCKID,
+  REMARK_BLOCK_ID
+};
+
+/// The record codes used in the META_BLOCK.
+enum MetaRecordIDs {
+  RECORD_META_CONTAINER_INFO = 1,
+  RECORD_META_REMARK_VERSION = 2,
+  RECORD_META_EXTERNAL_FILE = 3
+};
+
+/// The record codes used in a REMARK_BLOCK.
+enum RemarkRecordIDs {
+  RECORD_REMARK_STRING = 1,
+  RECORD_REMARK_HEADER = 2,
+  RECORD_REMARK_DEBUG_LOC = 3,
+  RECORD_REMARK_HOTNESS = 4,
+  RECORD_REMARK_ARG_WITH_DEBUGLOC = 5,
+  RECORD_REMARK_ARG_WITHOUT_DEBUGLOC = 6
+};
+
+/// The width of the abbreviation IDs in the blocks.
+constexpr unsigned MetaBlockCodeSize = 3;
+constexpr unsigned RemarkBlockCodeSize = 4;
+
+} // end namespace remarks
+} // end namespace llvm
+
+#endif /* LLVM_REMARKS_BITSTREAM_REMARK_CONTAINER_H */
@@ -18,6 +18,7 @@
 #include "llvm/Remarks/Remark.h"
 #include "llvm/Support/Error.h"
 #include <memory>
+#include <vector>
 
 namespace llvm {
 namespace remarks {
@@ -25,7 +26,7 @@ namespace remarks {
 struct ParserImpl;
 struct ParsedStringTable;
 
-enum class ParserFormat { YAML };
+enum class ParserFormat { YAML, Bitstream };
 
 /// Parser used to parse a raw buffer to remarks::Remark objects.
 struct Parser {
@@ -62,6 +63,12 @@ struct ParsedStringTable {
   ParsedStringTable(StringRef Buffer);
 };
 
+/// Parse the remarks section \p Buf of an object file, emitted in the
+/// bitstream format, and return the paths of the remarks files it references.
+/// \p Buf can be the concatenation of the remarks sections of several objects,
+/// as found in a linked image or a dSYM bundle.
+Expected<std::vector<StringRef>> parseBitstreamRemarksSection(StringRef Buf);
+
 } // end namespace remarks
 } // end namespace llvm
 
@@ -13,6 +13,8 @@
 #ifndef LLVM_REMARKS_REMARK_SERIALIZER_H
 #define LLVM_REMARKS_REMARK_SERIALIZER_H
 
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/Bitstream/BitstreamWriter.h"
 #include "llvm/Remarks/Remark.h"
 #include "llvm/Remarks/RemarkStringTable.h"
 #include "llvm/Support/YAMLTraits.h"
@@ -35,6 +37,11 @@ struct Serializer {
   /// This is just an interface.
   virtual ~Serializer() = default;
   virtual void emit(const Remark &Remark) = 0;
+  /// Serialize the contents of the remarks section embedded in an object file
+  /// to \p OS. The section points to \p ExternalFilename, the file the
+  /// remarks are emitted to.
+  virtual void emitMetaSection(raw_ostream &OS,
+                               StringRef ExternalFilename) const = 0;
 };
 
 /// Wether the serializer should use a string table while emitting.
@@ -60,6 +67,53 @@ struct YAMLSerializer : public Serializer {
 
   /// Emit a remark to the stream.
   void emit(const Remark &Remark) override;
+  /// Emit the remarks section: the magic number, the version, the string table
+  /// and the null-terminated path to the remarks file.
+  void emitMetaSection(raw_ostream &OS,
+                       StringRef ExternalFilename) const override;
+};
+
+/// Serialize the remarks to the LLVM bitstream format, described in
+/// BitstreamRemarkContainer.h. Each remark is encoded in its own block and
+/// written to the stream as soon as it is emitted, while the strings are
+/// deduplicated through the string table.
+struct BitstreamSerializer : public Serializer {
+  /// The buffer the bitstream is encoded to before being written to the
+  /// stream. It only holds the remark that is being emitted.
+  SmallVector<char, 1024> Encoded;
+  /// The bitstream writer, encoding to \p Encoded.
+  BitstreamWriter Bitstream;
+  /// Temporary buffer for the record values.
+  SmallVector<uint64_t, 64> R;
+  /// Temporary buffer for the string IDs used by a remark.
+  SmallVector<uint64_t, 16> StrIDs;
+  /// Temporary buffer for the strings a remark is the first to use.
+  SmallVector<StringRef, 16> NewStrings;
+
+  /// Abbreviation IDs of the records in a REMARK_BLOCK.
+  unsigned RecordRemarkStringAbbrevID = 0;
+  unsigned RecordRemarkHeaderAbbrevID = 0;
+  unsigned RecordRemarkDebugLocAbbrevID = 0;
+  unsigned RecordRemarkHotnessAbbrevID = 0;
+  unsigned RecordRemarkArgWithDebugLocAbbrevID = 0;
+  unsigned RecordRemarkArgWithoutDebugLocAbbrevID = 0;
+
+  /// Emit the magic number, the block info and the META_BLOCK of the remarks
+  /// file to \p OS.
+  BitstreamSerializer(raw_ostream &OS);
+
+  /// Emit a remark to the stream.
+  void emit(const Remark &Remark) override;
+  /// Emit the remarks section as a bitstream container pointing to the remarks
+  /// file.
+  void emitMetaSection(raw_ostream &OS,
+                       StringRef ExternalFilename) const override;
+
+private:
+  /// Add \p Str to the string table and record its ID for the next remark.
+  void addString(StringRef Str);
+  /// Write the encoded bitstream to the stream.
+  void flushToStream();
 };
 
 } // end namespace remarks
@@ -16,6 +16,7 @@
 
 #include "llvm/ADT/StringRef.h"
 #include <chrono>
+#include <future>
 
 namespace llvm {
 
@@ -57,13 +58,26 @@ struct CachePruningPolicy {
   /// 4096 and large_dir disabled), there is a per-directory entry limit of
   /// 508*510*floor(4096/(40+8))~=20M for average filename length of 40.
   uint64_t MaxSizeFiles = 1000000;
+
+  /// Whether to prune incrementally. Instead of scanning the cache directory,
+  /// the pruner then reads a journal of the sizes and the uses of the entries,
+  /// which the users of the cache append to with recordCacheEntryUse(), and
+  /// the expiration and the eviction order are based on the last recorded
+  /// use rather than on the access time of the files. Only the first pruning,
+  /// which creates the journal, scans the directory.
+  ///
+  /// Entries which are added to the cache without being recorded are not
+  /// pruned until the journal is removed, which the non-incremental pruning
+  /// does.
+  bool Incremental = false;
 };
 
 /// Parse the given string as a cache pruning policy. Defaults are taken from a
 /// default constructed CachePruningPolicy object.
 /// For example: "prune_interval=30s:prune_after=24h:cache_size=50%"
 /// which means a pruning interval of 30 seconds, expiration time of 24 hours
-/// and maximum cache size of 50% of available disk space.
+/// and maximum cache size of 50% of available disk space. "prune_incremental=1"
+/// selects the incremental pruning.
 Expected<CachePruningPolicy> parseCachePruningPolicy(StringRef PolicyStr);
 
 /// Peform pruning using the supplied policy, returns true if pruning
@@ -74,6 +88,16 @@ Expected<CachePruningPolicy> parseCachePruningPolicy(StringRef PolicyStr);
 /// pattern "llvmcache-*".
 bool pruneCache(StringRef Path, CachePruningPolicy Policy);
 
+/// Runs pruneCache() on a separate thread, if LLVM is built with threads, so
+/// that the caller can carry on with its work. The pruning is over once the
+/// returned future is ready.
+std::future<bool> pruneCacheAsync(StringRef Path, CachePruningPolicy Policy);
+
+/// Records in the journal of the cache directory of \p EntryPath that the
+/// entry was added to the cache, or used, now, and that its size is \p Size.
+/// This does nothing unless the cache is pruned incrementally.
+void recordCacheEntryUse(StringRef EntryPath, uint64_t Size);
+
 } // namespace llvm
 
 #endif
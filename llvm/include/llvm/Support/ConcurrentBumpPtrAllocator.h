@@ -0,0 +1,265 @@
+//===- ConcurrentBumpPtrAllocator.h - Thread-safe arenas --------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file defines arena allocators that many threads can allocate from at
+/// the same time. Each thread bumps a pointer in slabs of its own, so
+/// allocating takes no lock, and the arena is reset or destroyed as a whole.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_SUPPORT_CONCURRENTBUMPPTRALLOCATOR_H
+#define LLVM_SUPPORT_CONCURRENTBUMPPTRALLOCATOR_H
+
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/Support/Allocator.h"
+#include "llvm/Support/Compiler.h"
+#include "llvm/Support/Threading.h"
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace llvm {
+
+namespace detail {
+
+/// Returns a number that identifies the current thread among all the threads
+/// that ever called this function. Numbers are handed out from 0 in the order
+/// of the first call and are never reused.
+unsigned getThreadOrdinal();
+
+} // end namespace detail
+
+/// A set of allocators of type \p AllocatorT, one for each thread that asks
+/// for one.
+///
+/// get() returns the allocator of the current thread, which no other thread
+/// uses, so AllocatorT does not need to be thread-safe. Allocators are created
+/// on first use. The threads with the first \p MaxThreads thread ordinals find
+/// their allocator without taking a lock; any other thread takes a lock in
+/// get(), but still has an allocator of its own.
+///
+/// forEach() and the destructor must not run concurrently with get().
+template <typename AllocatorT> class PerThreadAllocator {
+  struct Shard {
+    template <typename... ArgTs>
+    explicit Shard(ArgTs &&... Args) : Alloc(std::forward<ArgTs>(Args)...) {}
+
+    AllocatorT Alloc;
+    // Keep the allocators of different threads out of each other's cache
+    // lines.
+    char Padding[64];
+  };
+
+  std::function<Shard *()> Create;
+  std::vector<std::unique_ptr<Shard>> Shards;
+
+  std::mutex OverflowMutex;
+  DenseMap<unsigned, std::unique_ptr<Shard>> OverflowShards;
+
+  LLVM_ATTRIBUTE_NOINLINE AllocatorT &getSlow(unsigned Ordinal) {
+    if (Ordinal < Shards.size()) {
+      Shards[Ordinal].reset(Create());
+      return Shards[Ordinal]->Alloc;
+    }
+    std::lock_guard<std::mutex> Lock(OverflowMutex);
+    std::unique_ptr<Shard> &S = OverflowShards[Ordinal];
+    if (!S)
+      S.reset(Create());
+    return S->Alloc;
+  }
+
+public:
+  /// Creates an empty set. Its allocators will be constructed from copies of
+  /// \p Args. If \p MaxThreads is 0, it is twice the number of hardware
+  /// threads, which leaves room for the main thread and two thread pools.
+  template <typename... ArgTs>
+  explicit PerThreadAllocator(unsigned MaxThreads = 0, ArgTs... Args)
+      : Create([=] { return new Shard(Args...); }),
+        Shards(MaxThreads ? MaxThreads : 2 * hardware_concurrency()) {}
+
+  PerThreadAllocator(const PerThreadAllocator &) = delete;
+  PerThreadAllocator &operator=(const PerThreadAllocator &) = delete;
+
+  /// Returns the allocator of the current thread.
+  AllocatorT &get() {
+    unsigned Ordinal = detail::getThreadOrdinal();
+    if (LLVM_LIKELY(Ordinal < Shards.size() && Shards[Ordinal]))
+      return Shards[Ordinal]->Alloc;
+    return getSlow(Ordinal);
+  }
+
+  /// Calls \p F on every allocator created so far.
+  template <typename FnT> void forEach(FnT F) {
+    for (std::unique_ptr<Shard> &S : Shards)
+      if (S)
+        F(S->Alloc);
+    for (auto &KV : OverflowShards)
+      F(KV.second->Alloc);
+  }
+  template <typename FnT> void forEach(FnT F) const {
+    const_cast<PerThreadAllocator *>(this)->forEach(
+        [&](const AllocatorT &A) { F(A); });
+  }
+};
+
+/// A BumpPtrAllocator that any number of threads can allocate from
+/// concurrently.
+///
+/// Each thread allocates from slabs of its own. Memory is only freed by
+/// Reset() or by destroying the allocator, neither of which may run
+/// concurrently with Allocate(). getTotalMemory() and the slab callback let
+/// clients track the memory used by the arena while it is in use.
+class ConcurrentBumpPtrAllocator
+    : public AllocatorBase<ConcurrentBumpPtrAllocator> {
+public:
+  /// Called with the size of each slab when it is allocated and with its
+  /// negated size when it is freed, on the thread that allocates or frees it.
+  using SlabCallbackTy = std::function<void(ptrdiff_t)>;
+
+private:
+  /// Allocates the slabs of the per-thread allocators and accounts for them.
+  class SlabAllocator : public AllocatorBase<SlabAllocator> {
+    ConcurrentBumpPtrAllocator *Owner;
+
+  public:
+    explicit SlabAllocator(ConcurrentBumpPtrAllocator *Owner) : Owner(Owner) {}
+
+    LLVM_ATTRIBUTE_RETURNS_NONNULL void *Allocate(size_t Size,
+                                                  size_t /*Alignment*/) {
+      Owner->account(Size);
+      return safe_malloc(Size);
+    }
+    using AllocatorBase<SlabAllocator>::Allocate;
+
+    void Deallocate(const void *Ptr, size_t Size) {
+      Owner->account(-static_cast<ptrdiff_t>(Size));
+      free(const_cast<void *>(Ptr));
+    }
+    using AllocatorBase<SlabAllocator>::Deallocate;
+  };
+
+  using ThreadAllocatorTy = BumpPtrAllocatorImpl<SlabAllocator>;
+
+  void account(ptrdiff_t Delta) {
+    TotalMemory.fetch_add(static_cast<size_t>(Delta),
+                          std::memory_order_relaxed);
+    if (SlabCallback)
+      SlabCallback(Delta);
+  }
+
+  std::atomic<size_t> TotalMemory{0};
+  SlabCallbackTy SlabCallback;
+  PerThreadAllocator<ThreadAllocatorTy> Allocators;
+
+public:
+  /// See PerThreadAllocator for the meaning of \p MaxThreads.
+  explicit ConcurrentBumpPtrAllocator(unsigned MaxThreads = 0)
+      : Allocators(MaxThreads, SlabAllocator(this)) {}
+
+  /// Sets the callback invoked for every slab allocated or freed. This must
+  /// be called before anything is allocated. The callback may be called
+  /// concurrently from several threads.
+  void setSlabCallback(SlabCallbackTy Callback) {
+    SlabCallback = std::move(Callback);
+  }
+
+  LLVM_ATTRIBUTE_RETURNS_NONNULL void *Allocate(size_t Size,
+                                                size_t Alignment) {
+    return Allocators.get().Allocate(Size, Alignment);
+  }
+
+  // Pull in base class overloads.
+  using AllocatorBase<ConcurrentBumpPtrAllocator>::Allocate;
+
+  // Bump pointer allocators are expected to never free their storage; and
+  // clients expect pointers to remain valid for non-dereferencing
+  // comparisons.
+  void Deallocate(const void *Ptr, size_t Size) {}
+
+  // Pull in base class overloads.
+  using AllocatorBase<ConcurrentBumpPtrAllocator>::Deallocate;
+
+  /// Deallocate all but the current slab of every thread and reset their
+  /// current pointers to the beginning of it, freeing all memory allocated so
+  /// far.
+  void Reset() {
+    Allocators.forEach([](ThreadAllocatorTy &A) { A.Reset(); });
+  }
+
+  /// Returns the memory held by the slabs of all threads. Unlike the other
+  /// statistics, this may be read while other threads allocate.
+  size_t getTotalMemory() const {
+    return TotalMemory.load(std::memory_order_relaxed);
+  }
+
+  /// Returns the number of bytes allocated by all threads, including red
+  /// zones.
+  size_t getBytesAllocated() const {
+    size_t Result = 0;
+    Allocators.forEach(
+        [&](const ThreadAllocatorTy &A) { Result += A.getBytesAllocated(); });
+    return Result;
+  }
+
+  void PrintStats() const {
+    size_t NumSlabs = 0;
+    Allocators.forEach(
+        [&](const ThreadAllocatorTy &A) { NumSlabs += A.GetNumSlabs(); });
+    detail::printBumpPtrAllocatorStats(NumSlabs, getBytesAllocated(),
+                                       getTotalMemory());
+  }
+};
+
+/// A SpecificBumpPtrAllocator that any number of threads can allocate from
+/// concurrently.
+///
+/// Each thread allocates from slabs of its own. DestroyAll() calls the
+/// destructor of every object allocated by any thread, and must not run
+/// concurrently with Allocate().
+template <typename T> class ConcurrentSpecificBumpPtrAllocator {
+  PerThreadAllocator<SpecificBumpPtrAllocator<T>> Allocators;
+
+public:
+  /// See PerThreadAllocator for the meaning of \p MaxThreads.
+  explicit ConcurrentSpecificBumpPtrAllocator(unsigned MaxThreads = 0)
+      : Allocators(MaxThreads) {}
+
+  /// Call the destructor of each object allocated by any thread, and free all
+  /// but the current slab of every thread.
+  void DestroyAll() {
+    Allocators.forEach([](SpecificBumpPtrAllocator<T> &A) { A.DestroyAll(); });
+  }
+
+  /// Allocate space for an array of objects without constructing them.
+  T *Allocate(size_t Num = 1) { return Allocators.get().Allocate(Num); }
+};
+
+} // end namespace llvm
+
+inline void *operator new(size_t Size,
+                          llvm::ConcurrentBumpPtrAllocator &Allocator) {
+  struct S {
+    char c;
+    union {
+      double D;
+      long double LD;
+      long long L;
+      void *P;
+    } x;
+  };
+  return Allocator.Allocate(
+      Size, std::min((size_t)llvm::NextPowerOf2(Size), offsetof(S, x)));
+}
+
+inline void operator delete(void *, llvm::ConcurrentBumpPtrAllocator &) {}
+
+#endif // LLVM_SUPPORT_CONCURRENTBUMPPTRALLOCATOR_H
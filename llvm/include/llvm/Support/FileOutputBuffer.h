@@ -74,6 +74,11 @@ public:
   /// but keeps the memory mapping alive.
   virtual void discard() {}
 
+  /// Hints that [Offset, Offset + Size) of the buffer has been written and
+  /// will not be accessed again soon, so that the memory backing it can be
+  /// released before commit(). The contents are not affected.
+  virtual void dontNeed(size_t Offset, size_t Size) {}
+
 protected:
   FileOutputBuffer(StringRef Path) : FinalPath(Path) {}
 
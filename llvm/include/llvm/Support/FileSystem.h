@@ -431,6 +431,25 @@ std::error_code copy_file(const Twine &From, int ToFD);
 ///          platform-specific error_code.
 std::error_code resize_file(int FD, uint64_t Size);
 
+/// Asks the OS to start reading the file at \a Path into its cache, and
+/// returns without waiting for the read. This makes later reads of the file
+/// faster, especially on network file systems. It has no other effect, and
+/// does nothing on platforms without support for it.
+///
+/// @param Path Input path.
+/// @returns errc::success if the file could be opened, otherwise a
+///          platform-specific error_code.
+std::error_code prefetchFile(const Twine &Path);
+
+/// Calls prefetchFile() on each of \a Paths, in order, on a background
+/// thread, and returns immediately. Errors are ignored. Without thread support
+/// this does nothing.
+///
+/// This is meant for programs that know the files they are going to read,
+/// such as linkers, to overlap waiting for the disk or network with other
+/// work.
+void prefetchFilesInBackground(std::vector<std::string> Paths);
+
 /// Compute an MD5 hash of a file's contents.
 ///
 /// @param FD Input file descriptor.
@@ -1142,6 +1161,25 @@ public:
   /// behavior.
   const char *const_data() const;
 
+  /// Access patterns that can be hinted to the OS with advise().
+  enum advice {
+    normal,     ///< No particular access pattern.
+    sequential, ///< Accessed in order; read ahead aggressively.
+    random,     ///< Accessed in random order; do not read ahead.
+    willneed,   ///< Accessed soon; start reading all of the mapping now.
+    hugepage    ///< Back the mapping with huge pages where possible.
+  };
+
+  /// Hints how the mapping will be accessed. Hints that the platform does not
+  /// support are ignored.
+  void advise(advice Advice);
+
+  /// Hints that the pages in [Offset, Offset + Length) will not be accessed
+  /// soon, so the OS may evict them from the process's resident set. The
+  /// contents of readonly and readwrite mappings are preserved; the hint is
+  /// ignored for priv mappings and on platforms without support for it.
+  void dontNeed(size_t Offset, size_t Length);
+
   /// \returns The minimum alignment offset must be.
   static int alignment();
 };
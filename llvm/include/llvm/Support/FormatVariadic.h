@@ -28,6 +28,7 @@
 #include "llvm/ADT/Optional.h"
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/Support/FormatCommon.h"
 #include "llvm/Support/FormatProviders.h"
@@ -69,17 +70,20 @@ protected:
   // are not all the same type, we use some type-erasure by wrapping the
   // parameters in a template class that derives from a non-template superclass.
   // Essentially, we are converting a std::tuple<Derived<Ts...>> to a
-  // std::vector<Base*>.
+  // std::vector<Base*>. Both vectors are small vectors, so that formatting
+  // a few parameters allocates no memory.
+  using AdapterVector = SmallVector<detail::format_adapter *, 4>;
+  using ReplacementVector = SmallVector<ReplacementItem, 4>;
+
   struct create_adapters {
-    template <typename... Ts>
-    std::vector<detail::format_adapter *> operator()(Ts &... Items) {
-      return std::vector<detail::format_adapter *>{&Items...};
+    template <typename... Ts> AdapterVector operator()(Ts &... Items) {
+      return AdapterVector{&Items...};
     }
   };
 
   StringRef Fmt;
-  std::vector<detail::format_adapter *> Adapters;
-  std::vector<ReplacementItem> Replacements;
+  AdapterVector Adapters;
+  ReplacementVector Replacements;
 
   static bool consumeFieldLayout(StringRef &Spec, AlignStyle &Where,
                                  size_t &Align, char &Pad);
@@ -121,7 +125,7 @@ public:
       Align.format(S, R.Options);
     }
   }
-  static std::vector<ReplacementItem> parseFormatString(StringRef Fmt);
+  static ReplacementVector parseFormatString(StringRef Fmt);
 
   static Optional<ReplacementItem> parseReplacementItem(StringRef Spec);
 
@@ -145,6 +145,11 @@ public:
   /// MemoryBuffer.
   virtual BufferKind getBufferKind() const = 0;
 
+  /// Hints how the contents of the buffer will be accessed. This only has an
+  /// effect on buffers that map a file, since the others are already in
+  /// memory.
+  virtual void advise(sys::fs::mapped_file_region::advice Advice) {}
+
   MemoryBufferRef getMemBufferRef() const;
 };
 
@@ -0,0 +1,82 @@
+//===- llvm/Support/OrderedOutput.h - In-order parallel output --*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file defines OrderedOutput, which lets tools print the results of
+/// parallel work in a deterministic order.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_SUPPORT_ORDEREDOUTPUT_H
+#define LLVM_SUPPORT_ORDEREDOUTPUT_H
+
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Support/raw_ostream.h"
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace llvm {
+
+/// Writes the output of a fixed number of chunks of work to a stream, in
+/// chunk order, whatever the order in which the chunks complete.
+///
+/// Each chunk has a buffered stream of its own, so the threads that produce
+/// the chunks write to them without any synchronization. A chunk is written to
+/// the underlying stream, and its buffer freed, as soon as it and all the
+/// chunks before it are finished, so output starts before all the work is
+/// done and only the chunks that are out of order stay in memory.
+///
+/// \code
+///   OrderedOutput Out(outs(), Functions.size());
+///   parallel::for_each_n(parallel::par, size_t(0), Functions.size(),
+///                        [&](size_t I) {
+///                          print(Out.getChunk(I), Functions[I]);
+///                          Out.finishChunk(I);
+///                        });
+/// \endcode
+class OrderedOutput {
+public:
+  OrderedOutput(raw_ostream &OS, size_t NumChunks);
+
+  /// Writes the chunks that were not finished yet, in order.
+  ~OrderedOutput();
+
+  OrderedOutput(const OrderedOutput &) = delete;
+  OrderedOutput &operator=(const OrderedOutput &) = delete;
+
+  /// Returns the stream of chunk \p I. Only one thread at a time may write
+  /// to a given chunk, and only before it is finished.
+  raw_ostream &getChunk(size_t I) { return Chunks[I]->Stream; }
+
+  /// Marks chunk \p I as complete, and writes it along with any other chunk
+  /// that was only waiting for it.
+  void finishChunk(size_t I);
+
+private:
+  struct Chunk {
+    Chunk() : Stream(Buffer) {}
+
+    SmallString<0> Buffer;
+    raw_svector_ostream Stream;
+    bool Finished = false;
+  };
+
+  void writeFinishedChunks();
+
+  raw_ostream &OS;
+  std::vector<std::unique_ptr<Chunk>> Chunks;
+
+  /// Guards Finished and NextChunk, and serializes writes to OS.
+  std::mutex Mutex;
+  size_t NextChunk = 0;
+};
+
+} // end namespace llvm
+
+#endif // LLVM_SUPPORT_ORDEREDOUTPUT_H
@@ -12,6 +12,7 @@
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/Config/llvm-config.h"
 #include "llvm/Support/MathExtras.h"
+#include "llvm/Support/Threading.h"
 
 #include <algorithm>
 #include <condition_variable>
@@ -41,6 +42,11 @@ struct is_execution_policy
 constexpr sequential_execution_policy seq{};
 constexpr parallel_execution_policy par{};
 
+/// The number of threads that run the parallel algorithms, and their
+/// placement. This only has an effect if set before the first parallel
+/// algorithm runs, and is ignored when they use the ConcRT runtime.
+extern ThreadPoolStrategy strategy;
+
 namespace detail {
 
 #if LLVM_ENABLE_THREADS
@@ -69,6 +75,11 @@ public:
     std::unique_lock<std::mutex> lock(Mutex);
     Cond.wait(lock, [&] { return Count == 0; });
   }
+
+  bool isDone() const {
+    std::lock_guard<std::mutex> lock(Mutex);
+    return Count == 0;
+  }
 };
 
 class TaskGroup {
@@ -81,7 +92,9 @@ public:
 
   void spawn(std::function<void()> f);
 
-  void sync() const { L.sync(); }
+  /// Waits for all the spawned tasks to finish. When called on a thread of
+  /// the default executor, runs other pending tasks in the meantime.
+  void sync() const;
 };
 
 #if defined(_MSC_VER)
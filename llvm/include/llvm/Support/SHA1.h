@@ -64,10 +64,7 @@ private:
 
   // Internal State
   struct {
-    union {
-      uint8_t C[BLOCK_LENGTH];
-      uint32_t L[BLOCK_LENGTH / 4];
-    } Buffer;
+    uint8_t Buffer[BLOCK_LENGTH];
     uint32_t State[HASH_LENGTH / 4];
     uint32_t ByteCount;
     uint8_t BufferOffset;
@@ -77,7 +74,6 @@ private:
   uint32_t HashResult[HASH_LENGTH / 4];
 
   // Helper
-  void writebyte(uint8_t data);
   void hashBlock();
   void addUncounted(uint8_t data);
   void pad();
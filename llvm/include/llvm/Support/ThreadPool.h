@@ -14,6 +14,8 @@
 #define LLVM_SUPPORT_THREAD_POOL_H
 
 #include "llvm/Config/llvm-config.h"
+#include "llvm/Support/Threading.h"
+#include "llvm/Support/WorkStealingQueue.h"
 #include "llvm/Support/thread.h"
 
 #include <future>
@@ -32,7 +34,10 @@ namespace llvm {
 /// threads.
 ///
 /// The pool keeps a vector of threads alive, waiting on a condition variable
-/// for some work to become available.
+/// for some work to become available. Tasks submitted from outside of the pool
+/// run in FIFO order. Tasks submitted by a task of the pool go to a queue owned
+/// by its thread, which runs them in LIFO order unless another idle thread of
+/// the pool steals them first.
 class ThreadPool {
 public:
   using TaskTy = std::function<void()>;
@@ -45,6 +50,10 @@ public:
   /// Construct a pool of \p ThreadCount threads
   ThreadPool(unsigned ThreadCount);
 
+  /// Construct a pool with the number of threads and the thread placement
+  /// given by \p S.
+  explicit ThreadPool(ThreadPoolStrategy S);
+
   /// Blocking destructor: the pool will wait for all the threads to complete.
   ~ThreadPool();
 
@@ -64,8 +73,10 @@ public:
     return asyncImpl(std::forward<Function>(F));
   }
 
-  /// Blocking wait for all the threads to complete and the queue to be empty.
-  /// It is an error to try to add new tasks while blocking on this call.
+  /// Blocking wait for all the threads to complete and the queues to be empty,
+  /// including the tasks submitted by other tasks in the meantime. It is an
+  /// error to try to add new tasks from outside of the pool while blocking on
+  /// this call, or to call it from a task of the pool.
   void wait();
 
 private:
@@ -73,13 +84,28 @@ private:
   /// used to wait for the task to finish and is *non-blocking* on destruction.
   std::shared_future<void> asyncImpl(TaskTy F);
 
+#if LLVM_ENABLE_THREADS
+  ThreadPool(unsigned ThreadCount, ThreadPoolStrategy S);
+
+  /// The loop run by the thread \p ThreadID of the pool.
+  void work(unsigned ThreadID);
+
+  /// Returns the next task for the thread \p ThreadID to run, or null.
+  PackagedTaskTy *findTask(unsigned ThreadID);
+#endif
+
   /// Threads in flight
   std::vector<llvm::thread> Threads;
 
-  /// Tasks waiting for execution in the pool.
-  std::queue<PackagedTaskTy> Tasks;
+  /// Tasks submitted from outside of the pool, waiting for execution.
+  std::queue<std::unique_ptr<PackagedTaskTy>> Tasks;
+
+  /// Tasks submitted by the tasks running on each thread, waiting for
+  /// execution. Each queue is owned by the corresponding thread of Threads.
+  std::vector<std::unique_ptr<WorkStealingQueue<PackagedTaskTy>>> LocalTasks;
 
-  /// Locking and signaling for accessing the Tasks queue.
+  /// Locking and signaling for accessing the Tasks queue, and for idle threads
+  /// to wait for work.
   std::mutex QueueLock;
   std::condition_variable QueueCondition;
 
@@ -87,12 +113,17 @@ private:
   std::mutex CompletionLock;
   std::condition_variable CompletionCondition;
 
-  /// Keep track of the number of thread actually busy
-  std::atomic<unsigned> ActiveThreads;
+  /// Keep track of the number of tasks submitted but not finished yet
+  std::atomic<unsigned> PendingTasks;
 
 #if LLVM_ENABLE_THREADS // avoids warning for unused variable
   /// Signal for the destruction of the pool, asking thread to exit.
   bool EnableFlag;
+
+  /// The number of threads getting ready to wait on QueueCondition, and a
+  /// counter bumped under QueueLock to wake one of them up.
+  std::atomic<unsigned> IdleThreads;
+  uint64_t WakeUps = 0;
 #endif
 };
 }
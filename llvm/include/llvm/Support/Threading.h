@@ -142,6 +142,50 @@ void llvm_execute_on_thread(void (*UserFn)(void *), void *UserData,
   /// not available.
   unsigned hardware_concurrency();
 
+  /// How the threads of a pool are placed on the CPUs the process may run on.
+  enum class ThreadAffinity {
+    /// Let the operating system place and migrate the threads.
+    None,
+    /// Pin consecutive threads of the pool to consecutive CPUs, filling a NUMA
+    /// node before using the next one, so that the threads share caches and
+    /// local memory.
+    Compact,
+    /// Pin consecutive threads of the pool to CPUs of different NUMA nodes in
+    /// turn, so that the pool uses the memory bandwidth of every node.
+    Spread,
+  };
+
+  /// Describes how many threads a pool should use and where they should run.
+  /// Pools created with the same strategy but different values of NumaNode
+  /// can be used to keep a pool per NUMA node.
+  struct ThreadPoolStrategy {
+    /// The number of threads to use, or 0 to derive it from the host.
+    unsigned ThreadsRequested = 0;
+
+    /// When deriving the number of threads from the host, whether to use
+    /// hardware_concurrency() rather than heavyweight_hardware_concurrency().
+    bool UseHyperThreads = true;
+
+    ThreadAffinity Affinity = ThreadAffinity::None;
+
+    /// If not negative, only run on the CPUs of this NUMA node, numbered from
+    /// 0 to get_numa_node_count() - 1.
+    int NumaNode = -1;
+
+    /// Returns the number of threads that a pool using this strategy should
+    /// have. When NumaNode is set, this is the share of that node.
+    unsigned compute_thread_count() const;
+
+    /// Restricts the current thread, which is the \p ThreadPoolNum-th thread
+    /// of a pool, to the CPUs chosen by this strategy. This is a best effort:
+    /// it does nothing on hosts where placing threads is not supported.
+    void apply_thread_strategy(unsigned ThreadPoolNum) const;
+  };
+
+  /// Returns the number of NUMA nodes that have CPUs the process may run on,
+  /// or 1 if the host does not tell.
+  unsigned get_numa_node_count();
+
   /// Return the current thread id, as used in various OS system calls.
   /// Note that not all platforms guarantee that the value returned will be
   /// unique across the entire system, so portable code should not assume
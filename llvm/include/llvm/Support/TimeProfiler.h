@@ -18,8 +18,9 @@ extern TimeTraceProfiler *TimeTraceProfilerInstance;
 
 /// Initialize the time trace profiler.
 /// This sets up the global \p TimeTraceProfilerInstance
-/// variable to be the profiler instance.
-void timeTraceProfilerInitialize();
+/// variable to be the profiler instance. \p ProcName is the process name
+/// shown in the trace viewer.
+void timeTraceProfilerInitialize(StringRef ProcName);
 
 /// Cleanup the time trace profiler, if it was initialized.
 void timeTraceProfilerCleanup();
@@ -34,6 +35,11 @@ inline bool timeTraceProfilerEnabled() {
 /// https://docs.google.com/document/d/1CvAClvFfyA5R-PhYUmn5OOQtYMH4h6I0nSsKchNAySU/preview
 void timeTraceProfilerWrite(raw_pwrite_stream &OS);
 
+/// Write a plain-text summary of the profile to \p OS: the total time of each
+/// section name, followed by the details of its \p TopN longest sections
+/// (e.g. the slowest template instantiations).
+void timeTraceProfilerWriteSummary(raw_ostream &OS, unsigned TopN);
+
 /// Manually begin a time section, with the given \p Name and \p Detail.
 /// Profiler copies the string data, so the pointers can be given into
 /// temporaries. Time sections can be hierarchical; every Begin must have a
@@ -45,6 +51,11 @@ void timeTraceProfilerBegin(StringRef Name,
 /// Manually end the last time section.
 void timeTraceProfilerEnd();
 
+/// Record the current value of the counter \p Name. Counters are shown as
+/// a separate graph in the trace viewer, e.g. to track memory usage over
+/// time.
+void timeTraceProfilerCounter(StringRef Name, int64_t Value);
+
 /// The TimeTraceScope is a helper class to call the begin and end functions
 /// of the time trace profiler.  When the object is constructed, it begins
 /// the section; and when it is destroyed, it stops it. If the time profiler
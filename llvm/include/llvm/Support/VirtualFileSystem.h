@@ -404,6 +404,85 @@ private:
   virtual void anchor();
 };
 
+/// The results of status() and directory iteration on a file system, shared
+/// by the CachingFileSystem instances that wrap it.
+///
+/// All members are thread-safe. The entries are split into shards with a
+/// lock each, so that threads looking up different paths rarely wait for each
+/// other. Nothing is evicted: the cache assumes that the file system does not
+/// change unless it is told with invalidate(), for example by the callback of
+/// a file watcher.
+class FileSystemCache : public ThreadSafeRefCountedBase<FileSystemCache> {
+public:
+  /// \param CacheMissingFiles Whether to also remember that a path does not
+  /// exist.
+  explicit FileSystemCache(bool CacheMissingFiles = true);
+  ~FileSystemCache();
+
+  /// Forgets the status of the absolute path \p Path and the listings of it
+  /// and of its parent directory. Call this when \p Path is created,
+  /// modified or removed.
+  void invalidate(StringRef Path);
+
+  /// Forgets everything.
+  void invalidateAll();
+
+private:
+  friend class CachingFileSystem;
+
+  /// The names and types of the entries of a directory.
+  using DirectoryListing =
+      std::vector<std::pair<std::string, llvm::sys::fs::file_type>>;
+
+  struct Shard;
+  static constexpr unsigned NumShards = 32;
+
+  Shard &getShard(StringRef Path) const;
+
+  /// Returns the cached status of \p Path, if any.
+  Optional<llvm::ErrorOr<Status>> lookupStatus(StringRef Path) const;
+  /// Caches \p Result as the status of \p Path, if it is cacheable.
+  void insertStatus(StringRef Path, const llvm::ErrorOr<Status> &Result);
+
+  /// Returns the cached listing of the directory \p Path, if any.
+  std::shared_ptr<const DirectoryListing>
+  lookupListing(StringRef Path) const;
+  void insertListing(StringRef Path,
+                     std::shared_ptr<const DirectoryListing> Listing);
+
+  bool CacheMissingFiles;
+  std::unique_ptr<Shard[]> Shards;
+};
+
+/// A file system that answers status() and directory iteration from a
+/// FileSystemCache, and asks the underlying file system only for what is not
+/// cached yet.
+///
+/// Several CachingFileSystems can share one FileSystemCache, for example one
+/// for each compilation a tool runs in parallel. Each has its own working
+/// directory if the underlying file system does; paths are cached by their
+/// absolute form. Files are still opened by the underlying file system, but
+/// opening a path that is cached as missing fails right away.
+class CachingFileSystem : public ProxyFileSystem {
+public:
+  CachingFileSystem(IntrusiveRefCntPtr<FileSystem> FS,
+                    IntrusiveRefCntPtr<FileSystemCache> Cache);
+
+  llvm::ErrorOr<Status> status(const Twine &Path) override;
+  llvm::ErrorOr<std::unique_ptr<File>>
+  openFileForRead(const Twine &Path) override;
+  directory_iterator dir_begin(const Twine &Dir, std::error_code &EC) override;
+
+  FileSystemCache &getCache() { return *Cache; }
+
+private:
+  /// Returns the key of \p Path in the cache, or an empty string if the path
+  /// cannot be made absolute.
+  std::string getCacheKey(const Twine &Path) const;
+
+  IntrusiveRefCntPtr<FileSystemCache> Cache;
+};
+
 namespace detail {
 
 class InMemoryDirectory;
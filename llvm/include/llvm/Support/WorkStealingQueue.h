@@ -0,0 +1,146 @@
+//===- llvm/Support/WorkStealingQueue.h - Work-stealing deque ---*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file defines WorkStealingQueue, the lock-free deque described in
+/// "Dynamic Circular Work-Stealing Deque" by Chase and Lev, with the memory
+/// orderings of "Correct and Efficient Work-Stealing for Weak Memory Models"
+/// by Le et al.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_SUPPORT_WORKSTEALINGQUEUE_H
+#define LLVM_SUPPORT_WORKSTEALINGQUEUE_H
+
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace llvm {
+
+/// A double-ended queue of pointers to tasks, owned by a single thread.
+///
+/// The owner pushes and pops tasks at the bottom, so it runs the most recently
+/// queued task first. Any other thread may steal the oldest task from the top.
+/// No operation takes a lock, and the owner only executes an atomic
+/// read-modify-write when it races with a thief for the last task.
+///
+/// The queue does not own the tasks it points to.
+template <typename TaskT> class WorkStealingQueue {
+  /// A circular array of slots. Slots are atomic because a thief may read a
+  /// slot while the owner overwrites it; the thief then loses the race for
+  /// the top of the queue and discards what it read.
+  struct Buffer {
+    explicit Buffer(size_t Capacity)
+        : Mask(Capacity - 1), Slots(new std::atomic<TaskT *>[Capacity]) {
+      assert((Capacity & Mask) == 0 && "Capacity must be a power of two");
+    }
+
+    size_t capacity() const { return Mask + 1; }
+
+    TaskT *get(int64_t I) const {
+      return Slots[I & Mask].load(std::memory_order_relaxed);
+    }
+
+    void put(int64_t I, TaskT *Task) {
+      Slots[I & Mask].store(Task, std::memory_order_relaxed);
+    }
+
+    const size_t Mask;
+    std::unique_ptr<std::atomic<TaskT *>[]> Slots;
+  };
+
+  std::atomic<int64_t> Top{0};
+  std::atomic<int64_t> Bottom{0};
+  std::atomic<Buffer *> Current;
+
+  /// Every buffer this queue has used. Thieves may still be reading from a
+  /// buffer after the owner has replaced it, so buffers are only freed with
+  /// the queue.
+  std::vector<std::unique_ptr<Buffer>> Buffers;
+
+public:
+  explicit WorkStealingQueue(size_t Capacity = 256) {
+    Buffers.emplace_back(new Buffer(Capacity));
+    Current.store(Buffers.back().get(), std::memory_order_relaxed);
+  }
+
+  WorkStealingQueue(const WorkStealingQueue &) = delete;
+  WorkStealingQueue &operator=(const WorkStealingQueue &) = delete;
+
+  /// Returns true if the queue looked empty at some point during the call.
+  bool empty() const {
+    int64_t B = Bottom.load(std::memory_order_relaxed);
+    int64_t T = Top.load(std::memory_order_relaxed);
+    return B <= T;
+  }
+
+  /// Adds \p Task at the bottom of the queue. Only the owner may call this.
+  void push(TaskT *Task) {
+    int64_t B = Bottom.load(std::memory_order_relaxed);
+    int64_t T = Top.load(std::memory_order_acquire);
+    Buffer *Buf = Current.load(std::memory_order_relaxed);
+    if (B - T > static_cast<int64_t>(Buf->capacity()) - 1) {
+      Buffer *Bigger = new Buffer(Buf->capacity() * 2);
+      for (int64_t I = T; I != B; ++I)
+        Bigger->put(I, Buf->get(I));
+      Buffers.emplace_back(Bigger);
+      Current.store(Bigger, std::memory_order_relaxed);
+      Buf = Bigger;
+    }
+    Buf->put(B, Task);
+    std::atomic_thread_fence(std::memory_order_release);
+    Bottom.store(B + 1, std::memory_order_relaxed);
+  }
+
+  /// Removes and returns the task at the bottom of the queue, or null if the
+  /// queue is empty. Only the owner may call this.
+  TaskT *pop() {
+    int64_t B = Bottom.load(std::memory_order_relaxed) - 1;
+    Buffer *Buf = Current.load(std::memory_order_relaxed);
+    Bottom.store(B, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t T = Top.load(std::memory_order_relaxed);
+    if (T > B) {
+      Bottom.store(B + 1, std::memory_order_relaxed);
+      return nullptr;
+    }
+    TaskT *Task = Buf->get(B);
+    if (T == B) {
+      // This is the last task: take it from the thieves.
+      if (!Top.compare_exchange_strong(T, T + 1, std::memory_order_seq_cst,
+                                       std::memory_order_relaxed))
+        Task = nullptr;
+      Bottom.store(B + 1, std::memory_order_relaxed);
+    }
+    return Task;
+  }
+
+  /// Removes and returns the task at the top of the queue, or null if the
+  /// queue is empty. Any thread may call this.
+  TaskT *steal() {
+    while (true) {
+      int64_t T = Top.load(std::memory_order_acquire);
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      int64_t B = Bottom.load(std::memory_order_acquire);
+      if (T >= B)
+        return nullptr;
+      TaskT *Task = Current.load(std::memory_order_acquire)->get(T);
+      if (Top.compare_exchange_strong(T, T + 1, std::memory_order_seq_cst,
+                                      std::memory_order_relaxed))
+        return Task;
+      // Another thread took this task first; try the next one.
+    }
+  }
+};
+
+} // end namespace llvm
+
+#endif // LLVM_SUPPORT_WORKSTEALINGQUEUE_H
@@ -44,6 +44,15 @@
 namespace llvm {
 uint64_t xxHash64(llvm::StringRef Data);
 uint64_t xxHash64(llvm::ArrayRef<uint8_t> Data);
+
+/// Returns the XXH3 64-bit hash of \p Data, with the default secret and a
+/// seed of zero. XXH3 is several times faster than XXH64 on large inputs,
+/// which it processes with SIMD instructions where available, and on short
+/// inputs, so prefer it for hashing the contents of files and sections.
+uint64_t xxh3_64bits(llvm::ArrayRef<uint8_t> Data);
+inline uint64_t xxh3_64bits(llvm::StringRef Data) {
+  return xxh3_64bits(llvm::makeArrayRef(Data.bytes_begin(), Data.size()));
+}
 }
 
 #endif
@@ -17,12 +17,26 @@ namespace llvm {
 
 class raw_ostream;
 class RecordKeeper;
+class StringRef;
 
 /// Perform the action using Records, and write output to OS.
 /// Returns true on error, false otherwise.
 using TableGenMainFn = bool (raw_ostream &OS, RecordKeeper &Records);
 
-int TableGenMain(char *argv0, TableGenMainFn *MainFn);
+/// Select the action that the next call to the TableGenMainFn performs, by
+/// its command line name without the leading '-', e.g. "gen-instr-info".
+/// Returns true on error, false otherwise.
+using TableGenSelectActionFn = bool (StringRef Name);
+
+/// Parse the input file, run MainFn on the records and write the output.
+///
+/// If \p SelectAction is given, each -extra-output=<action>=<file> option
+/// runs MainFn again on the same records, after selecting <action>, and
+/// writes its output to <file>. This parses the input once for several
+/// backends. Like the main output, a file is only written if its contents
+/// change.
+int TableGenMain(char *argv0, TableGenMainFn *MainFn,
+                 TableGenSelectActionFn *SelectAction = nullptr);
 
 } // end namespace llvm
 
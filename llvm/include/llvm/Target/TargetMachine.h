@@ -254,6 +254,10 @@ public:
     return Options.FunctionSections;
   }
 
+  /// Return which basic blocks should be emitted into their own section,
+  /// corresponding to -fbasic-block-sections.
+  BasicBlockSection getBBSectionsType() const { return Options.BBSections; }
+
   /// Get a \c TargetIRAnalysis appropriate for the target.
   ///
   /// This is used to construct the new pass manager's target IR analysis pass,
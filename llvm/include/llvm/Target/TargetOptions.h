@@ -95,6 +95,14 @@ namespace llvm {
     SCE       // Tune debug info for SCE targets (e.g. PS4).
   };
 
+  /// Which basic blocks get a section of their own, so that the linker can
+  /// order code at the granularity of basic blocks.
+  enum class BasicBlockSection {
+    None, // Keep every block in the section of its function.
+    All,  // Give every basic block but the entry block its own section.
+    Cold  // Move the blocks that the profile says are cold to one section.
+  };
+
   /// Enable abort calls when global instruction selection fails to lower/select
   /// an instruction.
   enum class GlobalISelAbortMode {
@@ -299,6 +307,10 @@ namespace llvm {
     /// What exception model to use
     ExceptionHandling ExceptionModel = ExceptionHandling::None;
 
+    /// Which basic blocks to emit into sections of their own, corresponding to
+    /// -fbasic-block-sections.
+    BasicBlockSection BBSections = BasicBlockSection::None;
+
     /// Machine level options.
     MCTargetOptions MCOptions;
   };
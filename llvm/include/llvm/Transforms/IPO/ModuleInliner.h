@@ -0,0 +1,49 @@
+//===- ModuleInliner.h - Module level inliner pass --------------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// Provides a module level inliner that ranks all the call sites of a module
+/// at once, instead of visiting the call graph bottom-up one SCC at a time.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_TRANSFORMS_IPO_MODULEINLINER_H
+#define LLVM_TRANSFORMS_IPO_MODULEINLINER_H
+
+#include "llvm/Analysis/InlineCost.h"
+#include "llvm/IR/PassManager.h"
+
+namespace llvm {
+
+/// Inlines the call sites of a module in the order of their profile-weighted
+/// benefit over their cost.
+///
+/// Every call site to a defined function is ranked by how often it runs,
+/// according to the profile if there is one and the block frequency
+/// otherwise, divided by its inline cost. Call sites are then inlined best
+/// first, re-evaluating each one when it reaches the top of the queue, until
+/// the growth of the module reaches a code size budget. Call sites that
+/// shrink the code, or must always be inlined, do not use up the budget.
+///
+/// This is meant for the LTO and ThinLTO backends, where the whole program or
+/// its hot parts are visible and hot call sites with large callees should win
+/// over many cold call sites with small ones.
+class ModuleInlinerPass : public PassInfoMixin<ModuleInlinerPass> {
+public:
+  ModuleInlinerPass(InlineParams Params = getInlineParams())
+      : Params(std::move(Params)) {}
+
+  PreservedAnalyses run(Module &M, ModuleAnalysisManager &MAM);
+
+private:
+  InlineParams Params;
+};
+
+} // end namespace llvm
+
+#endif // LLVM_TRANSFORMS_IPO_MODULEINLINER_H
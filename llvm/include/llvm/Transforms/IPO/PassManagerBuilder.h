@@ -200,7 +200,9 @@ private:
   void addExtensionsToPM(ExtensionPointTy ETy,
                          legacy::PassManagerBase &PM) const;
   void addInitialAliasAnalysisPasses(legacy::PassManagerBase &PM) const;
-  void addLTOOptimizationPasses(legacy::PassManagerBase &PM);
+  void addLTOOptimizationPasses(legacy::PassManagerBase &PM,
+                                bool IPOOnly = false);
+  void addLTOFunctionOptimizationPasses(legacy::PassManagerBase &PM);
   void addLateLTOOptimizationPasses(legacy::PassManagerBase &PM);
   void addPGOInstrPasses(legacy::PassManagerBase &MPM, bool IsCS);
   void addFunctionSimplificationPasses(legacy::PassManagerBase &MPM);
@@ -215,6 +217,14 @@ public:
   /// populateModulePassManager - This sets up the primary pass manager.
   void populateModulePassManager(legacy::PassManagerBase &MPM);
   void populateLTOPassManager(legacy::PassManagerBase &PM);
+
+  /// Split the LTO pipeline for optimizing the parts of a module in parallel.
+  /// The pre-partition passes do the interprocedural work, such as inlining,
+  /// on the whole merged module, which can then be split with SplitModule.
+  /// The partition passes run the function simplification and the late LTO
+  /// passes on each part on its own.
+  void populateLTOPrePartitionPassManager(legacy::PassManagerBase &PM);
+  void populateLTOPartitionPassManager(legacy::PassManagerBase &PM);
   void populateThinLTOPassManager(legacy::PassManagerBase &PM);
 };
 
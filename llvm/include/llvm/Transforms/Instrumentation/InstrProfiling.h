@@ -41,6 +41,10 @@ public:
   PreservedAnalyses run(Module &M, ModuleAnalysisManager &AM);
   bool run(Module &M, const TargetLibraryInfo &TLI);
 
+  /// Returns true if the counters are only updated in sampled calls, which
+  /// changes the CFG.
+  bool isSamplingEnabled() const;
+
 private:
   InstrProfOptions Options;
   Module *M;
@@ -67,6 +71,12 @@ private:
   // vector of counter load/store pairs to be register promoted.
   std::vector<LoadStorePair> PromotionCandidates;
 
+  // The thread-local count of calls that decides which calls are sampled.
+  GlobalVariable *SamplingVar;
+
+  // Whether the current call of the function being lowered is sampled.
+  Value *IsSampled = nullptr;
+
   // The start value of precise value profile range for memory intrinsic sizes.
   int64_t MemOPSizeRangeStart;
   // The end value of precise value profile range for memory intrinsic sizes.
@@ -84,6 +94,10 @@ private:
   /// Returns true if profile counter update register promotion is enabled.
   bool isCounterPromotionEnabled() const;
 
+  /// Count the call to the function of \p Inc in the sampling variable, and
+  /// return whether the call is sampled.
+  Value *emitSamplingCheck(InstrProfIncrementInst *Inc);
+
   /// Count the number of instrumented value sites for the function.
   void computeNumValueSiteCounts(InstrProfValueProfileInst *Ins);
 
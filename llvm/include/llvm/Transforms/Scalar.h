@@ -467,6 +467,12 @@ FunctionPass *createLoopDistributePass();
 //
 FunctionPass *createLoopFusePass();
 
+//===----------------------------------------------------------------------===//
+//
+// LoopTiling - Tile simple perfect loop nests for cache locality.
+//
+FunctionPass *createLoopTilingPass();
+
 //===----------------------------------------------------------------------===//
 //
 // LoopLoadElimination - Perform loop-aware load elimination.
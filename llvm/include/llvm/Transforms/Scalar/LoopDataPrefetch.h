@@ -15,16 +15,34 @@
 
 #include "llvm/IR/Function.h"
 #include "llvm/IR/PassManager.h"
+#include <memory>
+#include <string>
 
 namespace llvm {
 
+namespace sampleprof {
+class SampleProfileReader;
+} // end namespace sampleprof
+
 /// An optimization pass inserting data prefetches in loops.
 class LoopDataPrefetchPass : public PassInfoMixin<LoopDataPrefetchPass> {
 public:
-  LoopDataPrefetchPass() = default;
+  /// \p MissProfileFile is a sample profile whose counts are the cache misses
+  /// of the loads, as sampled by the hardware. If it is empty, the file given
+  /// with -prefetch-profile-file is used, if any.
+  LoopDataPrefetchPass(std::string MissProfileFile = "");
+  LoopDataPrefetchPass(LoopDataPrefetchPass &&);
+  ~LoopDataPrefetchPass();
 
   /// Run the pass over the function.
   PreservedAnalyses run(Function &F, FunctionAnalysisManager &AM);
+
+private:
+  std::string MissProfileFile;
+
+  /// The profile of the cache misses, read on the first run in a context.
+  std::unique_ptr<sampleprof::SampleProfileReader> MissProfile;
+  LLVMContext *MissProfileContext = nullptr;
 };
 
 } // end namespace llvm
@@ -0,0 +1,38 @@
+//===- LoopTiling.h - Loop Tiling Pass --------------------------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements a lightweight loop tiling (cache blocking) pass for
+// simple perfect loop nests of depth two. The inner loop is strip-mined and
+// the loop over its strips is made outermost, so that the data the inner loop
+// reuses across the iterations of the outer loop stays in the cache.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_TRANSFORMS_SCALAR_LOOPTILING_H
+#define LLVM_TRANSFORMS_SCALAR_LOOPTILING_H
+
+#include "llvm/IR/PassManager.h"
+
+namespace llvm {
+
+class Function;
+
+class LoopTilingPass : public PassInfoMixin<LoopTilingPass> {
+  /// If not zero, the tile size to use instead of the one computed from the
+  /// size of the data cache.
+  unsigned TileSize;
+
+public:
+  explicit LoopTilingPass(unsigned TileSize = 0) : TileSize(TileSize) {}
+
+  PreservedAnalyses run(Function &F, FunctionAnalysisManager &AM);
+};
+
+} // end namespace llvm
+
+#endif // LLVM_TRANSFORMS_SCALAR_LOOPTILING_H
@@ -15,6 +15,7 @@
 #include <cstdint>
 #include <vector>
 
+#include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/Support/DataExtractor.h"
 #include "llvm/Support/Error.h"
@@ -74,6 +75,28 @@ Expected<Trace> loadTraceFile(StringRef Filename, bool Sort = false);
 /// DataExtractor.
 Expected<Trace> loadTrace(const DataExtractor &Extractor, bool Sort = false);
 
+/// Decodes the trace in Filename incrementally: HeaderCallback is called with
+/// the file header, then RecordCallback with each record. The records come in
+/// the order of loadTraceFile(Filename, false), i.e. one thread after the
+/// other, each in temporal order.
+///
+/// For FDR mode traces only the location of the blocks of each thread, and the
+/// records of the threads being decoded, are held in memory. Up to NumThreads
+/// threads of the trace are decoded in parallel; 0 means one per hardware
+/// thread. The callbacks are always called from the calling thread. Traces in
+/// other formats are loaded in memory first.
+Error processTraceFile(
+    StringRef Filename,
+    function_ref<Error(const XRayFileHeader &)> HeaderCallback,
+    function_ref<Error(const XRayRecord &)> RecordCallback,
+    unsigned NumThreads = 1);
+
+/// Like processTraceFile, for the trace in Extractor.
+Error processTrace(const DataExtractor &Extractor,
+                   function_ref<Error(const XRayFileHeader &)> HeaderCallback,
+                   function_ref<Error(const XRayRecord &)> RecordCallback,
+                   unsigned NumThreads = 1);
+
 } // namespace xray
 } // namespace llvm
 
@@ -145,6 +145,12 @@ STATISTIC(NumTripCountsNotComputed,
           "Number of loops without predictable loop counts");
 STATISTIC(NumBruteForceTripCountsComputed,
           "Number of loops with trip counts computed by force");
+STATISTIC(NumArithDepthLimitHits,
+          "Number of add/mul expressions not folded due to the depth limit");
+STATISTIC(NumHugeExprLimitHits,
+          "Number of expressions not folded because an operand is huge");
+STATISTIC(NumBECountsForgotten,
+          "Number of backedge-taken counts dropped by forgetMemoizedResults");
 
 static cl::opt<unsigned>
 MaxBruteForceIterations("scalar-evolution-max-iterations", cl::ReallyHidden,
@@ -2441,8 +2447,13 @@ const SCEV *ScalarEvolution::getAddExpr(SmallVectorImpl<const SCEV *> &Ops,
   }
 
   // Limit recursion calls depth.
-  if (Depth > MaxArithDepth || hasHugeExpression(Ops))
+  if (Depth > MaxArithDepth || hasHugeExpression(Ops)) {
+    if (Depth > MaxArithDepth)
+      ++NumArithDepthLimitHits;
+    else
+      ++NumHugeExprLimitHits;
     return getOrCreateAddExpr(Ops, Flags);
+  }
 
   // Okay, check to see if the same value occurs in the operand list more than
   // once.  If so, merge them together into an multiply expression.  Since we
@@ -2920,8 +2931,13 @@ const SCEV *ScalarEvolution::getMulExpr(SmallVectorImpl<const SCEV *> &Ops,
   Flags = StrengthenNoWrapFlags(this, scMulExpr, Ops, Flags);
 
   // Limit recursion calls depth.
-  if (Depth > MaxArithDepth || hasHugeExpression(Ops))
+  if (Depth > MaxArithDepth || hasHugeExpression(Ops)) {
+    if (Depth > MaxArithDepth)
+      ++NumArithDepthLimitHits;
+    else
+      ++NumHugeExprLimitHits;
     return getOrCreateMulExpr(Ops, Flags);
+  }
 
   // If there are any constants, fold them together.
   unsigned Idx = 0;
@@ -6631,7 +6647,10 @@ ScalarEvolution::getPredicatedBackedgeTakenInfo(const Loop *L) {
   BackedgeTakenInfo Result =
       computeBackedgeTakenCount(L, /*AllowPredicates=*/true);
 
-  return PredicatedBackedgeTakenCounts.find(L)->second = std::move(Result);
+  BackedgeTakenInfo &PredBTI = PredicatedBackedgeTakenCounts.find(L)->second =
+      std::move(Result);
+  addBECountUsers(L, PredBTI, /*Predicated=*/true);
+  return PredBTI;
 }
 
 const ScalarEvolution::BackedgeTakenInfo &
@@ -6734,7 +6753,24 @@ ScalarEvolution::getBackedgeTakenInfo(const Loop *L) {
   // recusive call to getBackedgeTakenInfo (on a different
   // loop), which would invalidate the iterator computed
   // earlier.
-  return BackedgeTakenCounts.find(L)->second = std::move(Result);
+  BackedgeTakenInfo &BTI = BackedgeTakenCounts.find(L)->second =
+      std::move(Result);
+  addBECountUsers(L, BTI, /*Predicated=*/false);
+  return BTI;
+}
+
+void ScalarEvolution::addBECountUsers(const Loop *L,
+                                      const BackedgeTakenInfo &BTI,
+                                      bool Predicated) {
+  SmallPtrSet<const SCEV *, 16> Ops;
+  BTI.collectOperands(Ops, this);
+  PointerIntPair<const Loop *, 1, bool> User(L, Predicated);
+  for (const SCEV *S : Ops) {
+    auto &Users = BECountUsers[S];
+    // A count computed again after it was dropped is already recorded.
+    if (!is_contained(Users, User))
+      Users.push_back(User);
+  }
 }
 
 void ScalarEvolution::forgetAllLoops() {
@@ -6745,6 +6781,7 @@ void ScalarEvolution::forgetAllLoops() {
   // result.
   BackedgeTakenCounts.clear();
   PredicatedBackedgeTakenCounts.clear();
+  BECountUsers.clear();
   LoopPropertiesCache.clear();
   ConstantEvolutionLoopExitValue.clear();
   ValueExprMap.clear();
@@ -6945,6 +6982,24 @@ bool ScalarEvolution::BackedgeTakenInfo::hasOperand(const SCEV *S,
   return false;
 }
 
+void ScalarEvolution::BackedgeTakenInfo::collectOperands(
+    SmallPtrSetImpl<const SCEV *> &Ops, ScalarEvolution *SE) const {
+  struct CollectOperands {
+    SmallPtrSetImpl<const SCEV *> &Ops;
+    CollectOperands(SmallPtrSetImpl<const SCEV *> &Ops) : Ops(Ops) {}
+    bool follow(const SCEV *S) { return Ops.insert(S).second; }
+    bool isDone() const { return false; }
+  };
+  CollectOperands Collect(Ops);
+
+  if (getMax() && getMax() != SE->getCouldNotCompute())
+    visitAll(getMax(), Collect);
+
+  for (auto &ENT : ExitNotTaken)
+    if (ENT.ExactNotTaken != SE->getCouldNotCompute())
+      visitAll(ENT.ExactNotTaken, Collect);
+}
+
 ScalarEvolution::ExitLimit::ExitLimit(const SCEV *E)
     : ExactNotTaken(E), MaxNotTaken(E) {
   assert((isa<SCEVCouldNotCompute>(MaxNotTaken) ||
@@ -11358,6 +11413,7 @@ ScalarEvolution::ScalarEvolution(ScalarEvolution &&Arg)
       BackedgeTakenCounts(std::move(Arg.BackedgeTakenCounts)),
       PredicatedBackedgeTakenCounts(
           std::move(Arg.PredicatedBackedgeTakenCounts)),
+      BECountUsers(std::move(Arg.BECountUsers)),
       ConstantEvolutionLoopExitValue(
           std::move(Arg.ConstantEvolutionLoopExitValue)),
       ValuesAtScopes(std::move(Arg.ValuesAtScopes)),
@@ -11801,20 +11857,25 @@ ScalarEvolution::forgetMemoizedResults(const SCEV *S) {
       ++I;
   }
 
-  auto RemoveSCEVFromBackedgeMap =
-      [S, this](DenseMap<const Loop *, BackedgeTakenInfo> &Map) {
-        for (auto I = Map.begin(), E = Map.end(); I != E;) {
-          BackedgeTakenInfo &BEInfo = I->second;
-          if (BEInfo.hasOperand(S, this)) {
-            BEInfo.clear();
-            Map.erase(I++);
-          } else
-            ++I;
-        }
-      };
-
-  RemoveSCEVFromBackedgeMap(BackedgeTakenCounts);
-  RemoveSCEVFromBackedgeMap(PredicatedBackedgeTakenCounts);
+  // Only the counts recorded as users of S can refer to it. The record may be
+  // stale if the count was dropped and computed again since.
+  auto UsersIt = BECountUsers.find(S);
+  if (UsersIt == BECountUsers.end())
+    return;
+  SmallVector<PointerIntPair<const Loop *, 1, bool>, 2> Users =
+      std::move(UsersIt->second);
+  BECountUsers.erase(UsersIt);
+  for (auto LoopAndPredicated : Users) {
+    DenseMap<const Loop *, BackedgeTakenInfo> &Map =
+        LoopAndPredicated.getInt() ? PredicatedBackedgeTakenCounts
+                                   : BackedgeTakenCounts;
+    auto I = Map.find(LoopAndPredicated.getPointer());
+    if (I != Map.end() && I->second.hasOperand(S, this)) {
+      I->second.clear();
+      Map.erase(I);
+      ++NumBECountsForgotten;
+    }
+  }
 }
 
 void
@@ -406,6 +406,10 @@ bool TargetTransformInfo::enableMaskedInterleavedAccessVectorization() const {
   return TTIImpl->enableMaskedInterleavedAccessVectorization();
 }
 
+bool TargetTransformInfo::preferPredicateOverEpilogue() const {
+  return TTIImpl->preferPredicateOverEpilogue();
+}
+
 bool TargetTransformInfo::isFPVectorizationPotentiallyUnsafe() const {
   return TTIImpl->isFPVectorizationPotentiallyUnsafe();
 }
@@ -486,6 +490,11 @@ unsigned TargetTransformInfo::getMinimumVF(unsigned ElemWidth) const {
   return TTIImpl->getMinimumVF(ElemWidth);
 }
 
+unsigned
+TargetTransformInfo::getWideVectorRegisterCostPercent(unsigned BitWidth) const {
+  return TTIImpl->getWideVectorRegisterCostPercent(BitWidth);
+}
+
 bool TargetTransformInfo::shouldConsiderAddressTypePromotion(
     const Instruction &I, bool &AllowPromotionWithoutCommonHeader) const {
   return TTIImpl->shouldConsiderAddressTypePromotion(
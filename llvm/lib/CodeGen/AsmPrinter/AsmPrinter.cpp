@@ -99,8 +99,7 @@
 #include "llvm/MC/MCValue.h"
 #include "llvm/MC/SectionKind.h"
 #include "llvm/Pass.h"
-#include "llvm/Remarks/Remark.h"
-#include "llvm/Remarks/RemarkStringTable.h"
+#include "llvm/Remarks/RemarkSerializer.h"
 #include "llvm/Support/Casting.h"
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Compiler.h"
@@ -660,7 +659,8 @@ void AsmPrinter::EmitFunctionHeader() {
   EmitConstantPool();
 
   // Print the 'header' of function.
-  OutStreamer->SwitchSection(getObjFileLowering().SectionForGlobal(&F, TM));
+  MF->setSection(getObjFileLowering().SectionForGlobal(&F, TM));
+  OutStreamer->SwitchSection(MF->getSection());
   EmitVisibility(CurrentFnSym, F.getVisibility());
 
   EmitLinkage(&F, CurrentFnSym);
@@ -961,6 +961,43 @@ void AsmPrinter::emitCFIInstruction(const MachineInstr &MI) {
   emitCFIInstruction(CFI);
 }
 
+void AsmPrinter::emitBasicBlockSectionStart(
+    const MachineBasicBlock &MBB, ArrayRef<const MachineInstr *> PrevCFIs) {
+  const TargetLoweringObjectFile &TLOF = getObjFileLowering();
+  OutStreamer->SwitchSection(
+      TLOF.getSectionForMachineBasicBlock(MF->getFunction(), MBB, TM));
+  if (MAI->hasFunctionAlignment())
+    EmitAlignment(MF->getAlignment());
+  if (MAI->hasDotTypeDotSizeDirective())
+    OutStreamer->EmitSymbolAttribute(MBB.getSymbol(), MCSA_ELF_TypeFunction);
+
+  // Every section needs a frame of its own. CFI instructions are interpreted
+  // in address order, so replaying those of the preceding blocks gives the
+  // new frame the state that the function had at the start of the block.
+  for (const HandlerInfo &HI : Handlers)
+    HI.Handler->beginFragment(
+        &MBB, [](AsmPrinter *Asm) { return Asm->getCurExceptionSym(); });
+  for (const MachineInstr *MI : PrevCFIs)
+    emitCFIInstruction(*MI);
+}
+
+void AsmPrinter::emitBasicBlockSectionSize(const MachineBasicBlock &MBB) {
+  // The size of the section of the function is that of the function.
+  if (MBB.getSectionID() == MachineBasicBlock::FunctionSectionID ||
+      !MAI->hasDotTypeDotSizeDirective())
+    return;
+
+  const MachineBasicBlock *Begin = &MBB;
+  while (!Begin->isBeginSection())
+    Begin = Begin->getPrevNode();
+  MCSymbol *End = createTempSymbol("bb_section_end");
+  OutStreamer->EmitLabel(End);
+  const MCExpr *SizeExp = MCBinaryExpr::createSub(
+      MCSymbolRefExpr::create(End, OutContext),
+      MCSymbolRefExpr::create(Begin->getSymbol(), OutContext), OutContext);
+  OutStreamer->emitELFSize(Begin->getSymbol(), SizeExp);
+}
+
 void AsmPrinter::emitFrameAlloc(const MachineInstr &MI) {
   // The operands are the MCSymbol and the frame offset of the allocation.
   MCSymbol *FrameAllocSym = MI.getOperand(0).getMCSymbol();
@@ -1040,7 +1077,11 @@ void AsmPrinter::EmitFunctionBody() {
   // Print out code for the function.
   bool HasAnyRealCode = false;
   int NumInstsInFunction = 0;
+  SmallVector<const MachineInstr *, 16> CFIInstrs;
   for (auto &MBB : *MF) {
+    if (MF->hasBBSections() && MBB.isBeginSection() && &MBB != &MF->front())
+      emitBasicBlockSectionStart(MBB, CFIInstrs);
+
     // Print a label for the basic block.
     EmitBasicBlockStart(MBB);
     for (auto &MI : MBB) {
@@ -1070,6 +1111,8 @@ void AsmPrinter::EmitFunctionBody() {
       switch (MI.getOpcode()) {
       case TargetOpcode::CFI_INSTRUCTION:
         emitCFIInstruction(MI);
+        if (MF->hasBBSections())
+          CFIInstrs.push_back(&MI);
         break;
       case TargetOpcode::LOCAL_ESCAPE:
         emitFrameAlloc(MI);
@@ -1121,6 +1164,12 @@ void AsmPrinter::EmitFunctionBody() {
     }
 
     EmitBasicBlockEnd(MBB);
+
+    if (MF->hasBBSections() && MBB.isEndSection() && &MBB != &MF->back()) {
+      emitBasicBlockSectionSize(MBB);
+      for (const HandlerInfo &HI : Handlers)
+        HI.Handler->endFragment();
+    }
   }
 
   EmittedInsts += NumInstsInFunction;
@@ -1167,6 +1216,22 @@ void AsmPrinter::EmitFunctionBody() {
   // Emit target-specific gunk after the function body.
   EmitFunctionBodyEnd();
 
+  // If the last block has a section of its own, end that section and its
+  // frame, and emit the rest of the function into the section of the
+  // function.
+  bool EndsInBBSection =
+      MF->hasBBSections() &&
+      MF->back().getSectionID() != MachineBasicBlock::FunctionSectionID;
+  if (EndsInBBSection) {
+    emitBasicBlockSectionSize(MF->back());
+    for (const HandlerInfo &HI : Handlers) {
+      NamedRegionTimer T(HI.TimerName, HI.TimerDescription, HI.TimerGroupName,
+                         HI.TimerGroupDescription, TimePassesIsEnabled);
+      HI.Handler->markFunctionEnd();
+    }
+    OutStreamer->SwitchSection(MF->getSection());
+  }
+
   if (needFuncLabelsForEHOrDebugInfo(*MF, MMI) ||
       MAI->hasDotTypeDotSizeDirective()) {
     // Create a symbol for the end of function.
@@ -1185,10 +1250,12 @@ void AsmPrinter::EmitFunctionBody() {
     OutStreamer->emitELFSize(CurrentFnSym, SizeExp);
   }
 
-  for (const HandlerInfo &HI : Handlers) {
-    NamedRegionTimer T(HI.TimerName, HI.TimerDescription, HI.TimerGroupName,
-                       HI.TimerGroupDescription, TimePassesIsEnabled);
-    HI.Handler->markFunctionEnd();
+  if (!EndsInBBSection) {
+    for (const HandlerInfo &HI : Handlers) {
+      NamedRegionTimer T(HI.TimerName, HI.TimerDescription, HI.TimerGroupName,
+                         HI.TimerGroupDescription, TimePassesIsEnabled);
+      HI.Handler->markFunctionEnd();
+    }
   }
 
   // Print out jump tables referenced by the function.
@@ -1355,53 +1422,18 @@ void AsmPrinter::emitRemarksSection(Module &M) {
       OutContext.getObjectFileInfo()->getRemarksSection();
   OutStreamer->SwitchSection(RemarksSection);
 
-  // Emit the magic number.
-  OutStreamer->EmitBytes(remarks::Magic);
-  // Explicitly emit a '\0'.
-  OutStreamer->EmitIntValue(/*Value=*/0, /*Size=*/1);
-
-  // Emit the version number: little-endian uint64_t.
-  // The version number is located at the offset 0x0 in the section.
-  std::array<char, 8> Version;
-  support::endian::write64le(Version.data(), remarks::Version);
-  OutStreamer->EmitBinaryData(StringRef(Version.data(), Version.size()));
-
-  // Emit the string table in the section.
-  // Note: we need to use the streamer here to emit it in the section. We can't
-  // just use the serialize function with a raw_ostream because of the way
-  // MCStreamers work.
-  uint64_t StrTabSize =
-      Serializer.StrTab ? Serializer.StrTab->SerializedSize : 0;
-  // Emit the total size of the string table (the size itself excluded):
-  // little-endian uint64_t.
-  // The total size is located after the version number.
-  // Note: even if no string table is used, emit 0.
-  std::array<char, 8> StrTabSizeBuf;
-  support::endian::write64le(StrTabSizeBuf.data(), StrTabSize);
-  OutStreamer->EmitBinaryData(
-      StringRef(StrTabSizeBuf.data(), StrTabSizeBuf.size()));
-
-  if (const Optional<remarks::StringTable> &StrTab = Serializer.StrTab) {
-    std::vector<StringRef> StrTabStrings = StrTab->serialize();
-    // Emit a list of null-terminated strings.
-    // Note: the order is important here: the ID used in the remarks corresponds
-    // to the position of the string in the section.
-    for (StringRef Str : StrTabStrings) {
-      OutStreamer->EmitBytes(Str);
-      // Explicitly emit a '\0'.
-      OutStreamer->EmitIntValue(/*Value=*/0, /*Size=*/1);
-    }
-  }
-
-  // Emit the null-terminated absolute path to the remark file.
-  // The path is located at the offset 0x4 in the section.
+  // The section points to the absolute path of the remark file.
   StringRef FilenameRef = RS->getFilename();
   SmallString<128> Filename = FilenameRef;
   sys::fs::make_absolute(Filename);
   assert(!Filename.empty() && "The filename can't be empty.");
-  OutStreamer->EmitBytes(Filename);
-  // Explicitly emit a '\0'.
-  OutStreamer->EmitIntValue(/*Value=*/0, /*Size=*/1);
+
+  // Note: the serializer writes to a raw_ostream, so we have to go through a
+  // buffer to emit the contents in the section with the streamer.
+  SmallString<256> Buf;
+  raw_svector_ostream OS(Buf);
+  Serializer.emitMetaSection(OS, Filename);
+  OutStreamer->EmitBinaryData(OS.str());
 }
 
 bool AsmPrinter::doFinalization(Module &M) {
@@ -2975,10 +3007,14 @@ void AsmPrinter::EmitBasicBlockStart(const MachineBasicBlock &MBB) const {
     emitBasicBlockLoopComments(MBB, MLI, *this);
   }
 
-  // Print the main label for the block.
-  if (MBB.pred_empty() ||
-      (isBlockOnlyReachableByFallthrough(&MBB) && !MBB.isEHFuncletEntry() &&
-       !MBB.hasLabelMustBeEmitted())) {
+  // Print the main label for the block. A block that starts a basic block
+  // section always needs its symbol.
+  bool StartsBBSection =
+      MF->hasBBSections() && MBB.isBeginSection() && &MBB != &MF->front();
+  if (!StartsBBSection &&
+      (MBB.pred_empty() ||
+       (isBlockOnlyReachableByFallthrough(&MBB) && !MBB.isEHFuncletEntry() &&
+        !MBB.hasLabelMustBeEmitted()))) {
     if (isVerbose()) {
       // NOTE: Want this comment at start of line, don't emit with AddComment.
       OutStreamer->emitRawComment(" %bb." + Twine(MBB.getNumber()) + ":",
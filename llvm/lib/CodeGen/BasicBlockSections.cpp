@@ -0,0 +1,187 @@
+//===- BasicBlockSections.cpp - Emit basic blocks into their own sections -===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// This pass assigns the basic blocks of functions to sections, as selected by
+// -basic-block-sections, so that the linker can order code at the
+// granularity of basic blocks:
+//
+//  * "all" gives every basic block but the entry block a section of its own.
+//  * "cold" moves the blocks that the profile says are cold to the end of the
+//    function, into one cold section per function.
+//
+// A block can no longer fall through into the next block of the layout when
+// that block is in another section, so the pass turns such fall-throughs into
+// explicit branches. The AsmPrinter then switches sections at the first block
+// of every section, and gives each section a symbol, a size and a CFI frame of
+// its own.
+//
+// Functions with landing pads, funclets or debug info are left alone, as
+// their exception tables and DWARF ranges describe each function as a single
+// range of addresses.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/Analysis/ProfileSummaryInfo.h"
+#include "llvm/CodeGen/MachineBasicBlock.h"
+#include "llvm/CodeGen/MachineBlockFrequencyInfo.h"
+#include "llvm/CodeGen/MachineFunction.h"
+#include "llvm/CodeGen/MachineFunctionPass.h"
+#include "llvm/CodeGen/MachineJumpTableInfo.h"
+#include "llvm/CodeGen/Passes.h"
+#include "llvm/CodeGen/TargetInstrInfo.h"
+#include "llvm/CodeGen/TargetSubtargetInfo.h"
+#include "llvm/IR/Function.h"
+#include "llvm/InitializePasses.h"
+#include "llvm/Target/TargetMachine.h"
+
+using namespace llvm;
+
+#define DEBUG_TYPE "bbsections"
+
+STATISTIC(NumSplitFunctions, "Number of functions emitted into several "
+                             "sections");
+STATISTIC(NumColdBlocks, "Number of blocks moved to a cold section");
+
+namespace {
+
+class BasicBlockSections : public MachineFunctionPass {
+public:
+  static char ID;
+
+  BasicBlockSections() : MachineFunctionPass(ID) {
+    initializeBasicBlockSectionsPass(*PassRegistry::getPassRegistry());
+  }
+
+  StringRef getPassName() const override {
+    return "Basic Block Sections";
+  }
+
+  void getAnalysisUsage(AnalysisUsage &AU) const override {
+    AU.addRequired<MachineBlockFrequencyInfo>();
+    AU.addRequired<ProfileSummaryInfoWrapperPass>();
+    MachineFunctionPass::getAnalysisUsage(AU);
+  }
+
+  bool runOnMachineFunction(MachineFunction &MF) override;
+};
+
+} // end anonymous namespace
+
+char BasicBlockSections::ID = 0;
+char &llvm::BasicBlockSectionsID = BasicBlockSections::ID;
+INITIALIZE_PASS_BEGIN(BasicBlockSections, DEBUG_TYPE,
+                      "Emit basic blocks into separate sections", false, false)
+INITIALIZE_PASS_DEPENDENCY(MachineBlockFrequencyInfo)
+INITIALIZE_PASS_DEPENDENCY(ProfileSummaryInfoWrapperPass)
+INITIALIZE_PASS_END(BasicBlockSections, DEBUG_TYPE,
+                    "Emit basic blocks into separate sections", false, false)
+
+/// Returns true if the blocks of \p MF can be emitted into several sections.
+static bool canSplitFunction(const MachineFunction &MF) {
+  const Function &F = MF.getFunction();
+  if (!MF.getTarget().getTargetTriple().isOSBinFormatELF() || MF.size() < 2)
+    return false;
+
+  // Keep functions in the sections that the user asked for.
+  if (F.hasSection())
+    return false;
+
+  // The call site tables of the LSDA and the DWARF of a subprogram expect a
+  // function to be a single range of addresses.
+  if (!MF.getLandingPads().empty() || MF.hasEHFunclets() || F.getSubprogram())
+    return false;
+
+  // Jump tables must be able to refer to blocks in any section.
+  if (const MachineJumpTableInfo *MJTI = MF.getJumpTableInfo())
+    if (!MJTI->isEmpty() &&
+        MJTI->getEntryKind() != MachineJumpTableInfo::EK_BlockAddress &&
+        MJTI->getEntryKind() != MachineJumpTableInfo::EK_LabelDifference32)
+      return false;
+
+  return true;
+}
+
+bool BasicBlockSections::runOnMachineFunction(MachineFunction &MF) {
+  BasicBlockSection Type = MF.getTarget().getBBSectionsType();
+  if (Type == BasicBlockSection::None || !canSplitFunction(MF))
+    return false;
+
+  // Select the section of every block, in layout order.
+  SmallVector<unsigned, 32> SectionIDs;
+  if (Type == BasicBlockSection::All) {
+    for (unsigned I = 0, E = MF.size(); I != E; ++I)
+      SectionIDs.push_back(I);
+  } else {
+    ProfileSummaryInfo *PSI =
+        &getAnalysis<ProfileSummaryInfoWrapperPass>().getPSI();
+    if (!PSI->hasProfileSummary() || !MF.getFunction().hasProfileData())
+      return false;
+    auto &MBFI = getAnalysis<MachineBlockFrequencyInfo>();
+    for (MachineBasicBlock &MBB : MF) {
+      Optional<uint64_t> Count = MBFI.getBlockProfileCount(&MBB);
+      bool IsCold = &MBB != &MF.front() && Count && PSI->isColdCount(*Count);
+      SectionIDs.push_back(IsCold ? MachineBasicBlock::ColdSectionID
+                                  : MachineBasicBlock::FunctionSectionID);
+    }
+    if (llvm::all_of(SectionIDs, [](unsigned ID) {
+          return ID == MachineBasicBlock::FunctionSectionID;
+        }))
+      return false;
+  }
+
+  // Find the blocks that fall through into a block of another section. Give
+  // up if one of them ends in a branch that cannot be analyzed, as it cannot
+  // be rewritten.
+  const TargetInstrInfo *TII = MF.getSubtarget().getInstrInfo();
+  SmallVector<MachineBasicBlock *, 16> FallThroughs;
+  unsigned Index = 0;
+  for (MachineBasicBlock &MBB : MF) {
+    unsigned ID = SectionIDs[Index++];
+    MachineBasicBlock *FT = MBB.getFallThrough();
+    if (!FT || SectionIDs[Index] == ID)
+      continue;
+    MachineBasicBlock *TBB = nullptr, *FBB = nullptr;
+    SmallVector<MachineOperand, 4> Cond;
+    if (TII->analyzeBranch(MBB, TBB, FBB, Cond))
+      return false;
+    if (!TBB || (!Cond.empty() && !FBB))
+      FallThroughs.push_back(&MBB);
+  }
+
+  for (MachineBasicBlock *MBB : FallThroughs) {
+    MachineBasicBlock *FT = &*std::next(MBB->getIterator());
+    MachineBasicBlock *TBB = nullptr, *FBB = nullptr;
+    SmallVector<MachineOperand, 4> Cond;
+    TII->analyzeBranch(*MBB, TBB, FBB, Cond);
+    DebugLoc DL = MBB->findBranchDebugLoc();
+    if (!TBB) {
+      TII->insertBranch(*MBB, FT, nullptr, Cond, DL);
+    } else {
+      TII->removeBranch(*MBB);
+      TII->insertBranch(*MBB, TBB, FT, Cond, DL);
+    }
+  }
+
+  // Assign the sections and keep the blocks of each section contiguous.
+  SmallVector<MachineBasicBlock *, 16> ColdBlocks;
+  Index = 0;
+  for (MachineBasicBlock &MBB : MF) {
+    MBB.setSectionID(SectionIDs[Index++]);
+    if (MBB.getSectionID() == MachineBasicBlock::ColdSectionID)
+      ColdBlocks.push_back(&MBB);
+  }
+  for (MachineBasicBlock *MBB : ColdBlocks)
+    MBB->moveAfter(&MF.back());
+
+  MF.setHasBBSections();
+  ++NumSplitFunctions;
+  NumColdBlocks += ColdBlocks.size();
+  return true;
+}
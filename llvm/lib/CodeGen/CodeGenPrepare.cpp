@@ -433,7 +433,9 @@ bool CodeGenPrepare::runOnFunction(Function &F) {
 
   ProfileSummaryInfo *PSI =
       &getAnalysis<ProfileSummaryInfoWrapperPass>().getPSI();
-  if (ProfileGuidedSectionPrefix) {
+  // Keep the prefix of functions that an earlier pass placed already, such
+  // as the cold functions split out by HotColdSplitting.
+  if (ProfileGuidedSectionPrefix && !F.getSectionPrefix()) {
     if (PSI->isFunctionHotInCallGraph(&F, *BFI))
       F.setSectionPrefix(".hot");
     else if (PSI->isFunctionColdInCallGraph(&F, *BFI))
@@ -164,6 +164,22 @@ bool LiveRegMatrix::checkRegUnitInterference(LiveInterval &VirtReg,
                                              unsigned PhysReg) {
   if (VirtReg.empty())
     return false;
+
+  // The live ranges of the register units do not change during allocation,
+  // so the result only depends on VirtReg. The allocators ask for the same
+  // registers several times while assigning, evicting and recoloring, and
+  // the overlap checks are expensive for long live ranges.
+  if (RegUnitVirtReg != VirtReg.reg || RegUnitTag != UserTag) {
+    RegUnitVirtReg = VirtReg.reg;
+    RegUnitTag = UserTag;
+    RegUnitChecked.clear();
+    RegUnitChecked.resize(TRI->getNumRegs());
+    RegUnitInterference.clear();
+    RegUnitInterference.resize(TRI->getNumRegs());
+  }
+  if (RegUnitChecked.test(PhysReg))
+    return RegUnitInterference.test(PhysReg);
+
   CoalescerPair CP(VirtReg.reg, PhysReg, *TRI);
 
   bool Result = foreachUnit(TRI, VirtReg, PhysReg, [&](unsigned Unit,
@@ -171,6 +187,9 @@ bool LiveRegMatrix::checkRegUnitInterference(LiveInterval &VirtReg,
     const LiveRange &UnitRange = LIS->getRegUnit(Unit);
     return Range.overlaps(UnitRange, CP, *LIS->getSlotIndexes());
   });
+  RegUnitChecked.set(PhysReg);
+  if (Result)
+    RegUnitInterference.set(PhysReg);
   return Result;
 }
 
@@ -54,6 +54,18 @@ MCSymbol *MachineBasicBlock::getSymbol() const {
   if (!CachedMCSymbol) {
     const MachineFunction *MF = getParent();
     MCContext &Ctx = MF->getContext();
+
+    // A block that starts a section of its own gets a real symbol, so that
+    // the linker can order its section by it.
+    if (MF->hasBBSections() && isBeginSection() && this != &MF->front()) {
+      if (SectionID == ColdSectionID)
+        CachedMCSymbol = Ctx.getOrCreateSymbol(MF->getName() + ".cold");
+      else
+        CachedMCSymbol = Ctx.getOrCreateSymbol(MF->getName() + ".__part." +
+                                               Twine(SectionID));
+      return CachedMCSymbol;
+    }
+
     auto Prefix = Ctx.getAsmInfo()->getPrivateLabelPrefix();
     assert(getNumber() >= 0 && "cannot get label for unreachable MBB");
     CachedMCSymbol = Ctx.getOrCreateSymbol(Twine(Prefix) + "BB" +
@@ -64,6 +76,16 @@ MCSymbol *MachineBasicBlock::getSymbol() const {
   return CachedMCSymbol;
 }
 
+bool MachineBasicBlock::isBeginSection() const {
+  const MachineBasicBlock *Prev = getPrevNode();
+  return !Prev || Prev->getSectionID() != SectionID;
+}
+
+bool MachineBasicBlock::isEndSection() const {
+  const MachineBasicBlock *Next = getNextNode();
+  return !Next || Next->getSectionID() != SectionID;
+}
+
 
 raw_ostream &llvm::operator<<(raw_ostream &OS, const MachineBasicBlock &MBB) {
   MBB.print(OS);
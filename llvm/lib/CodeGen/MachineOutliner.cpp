@@ -57,6 +57,7 @@
 #include "llvm/CodeGen/MachineOutliner.h"
 #include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/Statistic.h"
+#include "llvm/ADT/Triple.h"
 #include "llvm/ADT/Twine.h"
 #include "llvm/CodeGen/MachineFunction.h"
 #include "llvm/CodeGen/MachineModuleInfo.h"
@@ -71,6 +72,7 @@
 #include "llvm/Support/Allocator.h"
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Debug.h"
+#include "llvm/Support/MD5.h"
 #include "llvm/Support/raw_ostream.h"
 #include <functional>
 #include <tuple>
@@ -96,6 +98,16 @@ static cl::opt<bool> EnableLinkOnceODROutlining(
     cl::desc("Enable the machine outliner on linkonceodr functions"),
     cl::init(false));
 
+// Set to true to name outlined functions after their contents and emit them
+// as linkonce_odr, so that the linker keeps a single copy of the identical
+// functions outlined in different modules. This matters with ThinLTO, where
+// each backend outlines from its own module.
+static cl::opt<bool> EnableOutlinedFunctionMerging(
+    "enable-outlined-function-merging", cl::Hidden,
+    cl::desc("Let the linker merge identical outlined functions across "
+             "modules"),
+    cl::init(false));
+
 namespace {
 
 /// Represents an undefined index in the suffix tree.
@@ -1087,6 +1099,50 @@ MachineOutliner::findCandidates(InstructionMapper &Mapper,
   }
 }
 
+/// Returns a name for the outlined function \p MF that only depends on its
+/// contents, or an empty string if it refers to anything that is local to the
+/// module, and thus may differ between modules with identical contents.
+static std::string getMergeableOutlinedFunctionName(const MachineFunction &MF) {
+  const Function &F = MF.getFunction();
+  const TargetInstrInfo *TII = MF.getSubtarget().getInstrInfo();
+  std::string Contents;
+  raw_string_ostream OS(Contents);
+  OS << F.getFnAttribute("target-cpu").getValueAsString() << '\n'
+     << F.getFnAttribute("target-features").getValueAsString() << '\n';
+  for (const MachineBasicBlock &MBB : MF) {
+    for (const MachineInstr &MI : MBB) {
+      for (const MachineOperand &MO : MI.operands()) {
+        switch (MO.getType()) {
+        case MachineOperand::MO_GlobalAddress:
+          if (MO.getGlobal()->hasLocalLinkage())
+            return "";
+          break;
+        case MachineOperand::MO_MachineBasicBlock:
+        case MachineOperand::MO_FrameIndex:
+        case MachineOperand::MO_ConstantPoolIndex:
+        case MachineOperand::MO_TargetIndex:
+        case MachineOperand::MO_JumpTableIndex:
+        case MachineOperand::MO_BlockAddress:
+        case MachineOperand::MO_Metadata:
+        case MachineOperand::MO_MCSymbol:
+          return "";
+        default:
+          break;
+        }
+      }
+      MI.print(OS, /*IsStandalone=*/true, /*SkipOpers=*/false,
+               /*SkipDebugLoc=*/true, /*AddNewLine=*/true, TII);
+    }
+    OS << '\n';
+  }
+
+  MD5 Hash;
+  Hash.update(OS.str());
+  MD5::MD5Result Result;
+  Hash.final(Result);
+  return ("OUTLINED_FUNCTION_" + Result.digest()).str();
+}
+
 MachineFunction *
 MachineOutliner::createOutlinedFunction(Module &M, OutlinedFunction &OF,
                                         InstructionMapper &Mapper,
@@ -1153,6 +1209,19 @@ MachineOutliner::createOutlinedFunction(Module &M, OutlinedFunction &OF,
   MF.getProperties().reset(MachineFunctionProperties::Property::TracksLiveness);
   MF.getRegInfo().freezeReservedRegs(MF);
 
+  // Identical functions outlined from other modules get the same name, so
+  // the linker can keep just one of them.
+  if (EnableOutlinedFunctionMerging) {
+    std::string MergeableName = getMergeableOutlinedFunctionName(MF);
+    if (!MergeableName.empty() && !M.getFunction(MergeableName)) {
+      F->setName(MergeableName);
+      F->setLinkage(GlobalValue::LinkOnceODRLinkage);
+      F->setVisibility(GlobalValue::HiddenVisibility);
+      if (Triple(M.getTargetTriple()).supportsCOMDAT())
+        F->setComdat(M.getOrInsertComdat(F->getName()));
+    }
+  }
+
   // If there's a DISubprogram associated with this outlined function, then
   // emit debug info for the outlined function.
   if (DISubprogram *SP = getSubprogramOrNull(OF)) {
@@ -84,6 +84,10 @@ using namespace llvm;
 STATISTIC(NumGlobalSplits, "Number of split global live ranges");
 STATISTIC(NumLocalSplits,  "Number of split local live ranges");
 STATISTIC(NumEvicted,      "Number of interferences evicted");
+STATISTIC(NumGrowRegionBudgetExhausted,
+          "Number of region split candidates given up for compile time");
+STATISTIC(NumColdBlockSplits,
+          "Number of cold live ranges split around blocks only");
 
 static cl::opt<SplitEditor::ComplementSpillMode> SplitSpillMode(
     "split-spill-mode", cl::Hidden,
@@ -130,6 +134,26 @@ static cl::opt<unsigned>
                               "high compile time cost in global splitting."),
                      cl::init(5000));
 
+static cl::opt<unsigned> GrowRegionComplexityBudget(
+    "grow-region-complexity-budget", cl::Hidden,
+    cl::desc("growRegion() does not scale with the number of edge bundles, "
+             "so limit the number of blocks it may visit for a candidate"),
+    cl::init(10000));
+
+static cl::opt<unsigned> HugeFunctionVRegs(
+    "huge-function-vregs-for-split", cl::Hidden,
+    cl::desc("The number of virtual registers from which a function is "
+             "considered huge, and its cold live ranges are not split around "
+             "regions"),
+    cl::init(10000));
+
+static cl::opt<unsigned> ColdRangeFreqPercent(
+    "cold-range-freq-percent", cl::Hidden,
+    cl::desc("In huge functions, split live ranges whose blocks all run "
+             "less often than this percentage of the function entry around "
+             "blocks only (0 = disabled)"),
+    cl::init(1));
+
 // FIXME: Find a good default for this flag and remove the flag.
 static cl::opt<unsigned>
 CSRFirstTimeCost("regalloc-csr-first-time-cost",
@@ -487,6 +511,7 @@ private:
   unsigned tryRegionSplit(LiveInterval&, AllocationOrder&,
                           SmallVectorImpl<unsigned>&);
   unsigned isSplitBenefitWorthCost(LiveInterval &VirtReg);
+  bool isColdRange() const;
   /// Calculate cost of region splitting.
   unsigned calculateRegionSplitCost(LiveInterval &VirtReg,
                                     AllocationOrder &Order,
@@ -1317,6 +1342,7 @@ bool RAGreedy::growRegion(GlobalSplitCandidate &Cand) {
 #ifndef NDEBUG
   unsigned Visited = 0;
 #endif
+  unsigned Budget = GrowRegionComplexityBudget;
 
   while (true) {
     ArrayRef<unsigned> NewBundles = SpillPlacer->getRecentPositive();
@@ -1325,6 +1351,16 @@ bool RAGreedy::growRegion(GlobalSplitCandidate &Cand) {
       unsigned Bundle = NewBundles[i];
       // Look at all blocks connected to Bundle in the full graph.
       ArrayRef<unsigned> Blocks = Bundles->getBlocks(Bundle);
+      // Limit compile time by giving up on the candidate once the budget is
+      // used up.
+      if (Budget) {
+        if (Blocks.size() >= Budget) {
+          ++NumGrowRegionBudgetExhausted;
+          LLVM_DEBUG(dbgs() << ", budget exhausted");
+          return false;
+        }
+        Budget -= Blocks.size();
+      }
       for (ArrayRef<unsigned>::iterator I = Blocks.begin(), E = Blocks.end();
            I != E; ++I) {
         unsigned Block = *I;
@@ -1826,6 +1862,24 @@ unsigned RAGreedy::isSplitBenefitWorthCost(LiveInterval &VirtReg) {
   return true;
 }
 
+/// Return true if the live range analyzed by SA is in a huge function and only
+/// lives in cold blocks. Region splitting would then cost much compile time
+/// for little gain, and splitting around blocks does well enough.
+bool RAGreedy::isColdRange() const {
+  if (!ColdRangeFreqPercent || MRI->getNumVirtRegs() < HugeFunctionVRegs)
+    return false;
+
+  BlockFrequency Threshold = BlockFrequency(MBFI->getEntryFreq()) *
+                             BranchProbability(ColdRangeFreqPercent, 100);
+  for (const SplitAnalysis::BlockInfo &BI : SA->getUseBlocks())
+    if (MBFI->getBlockFreq(BI.MBB) >= Threshold)
+      return false;
+  for (unsigned Number : SA->getThroughBlocks().set_bits())
+    if (MBFI->getBlockFreq(MF->getBlockNumbered(Number)) >= Threshold)
+      return false;
+  return true;
+}
+
 unsigned RAGreedy::tryRegionSplit(LiveInterval &VirtReg, AllocationOrder &Order,
                                   SmallVectorImpl<unsigned> &NewVRegs) {
   if (!isSplitBenefitWorthCost(VirtReg))
@@ -2492,12 +2546,18 @@ unsigned RAGreedy::trySplit(LiveInterval &VirtReg, AllocationOrder &Order,
   }
 
   // First try to split around a region spanning multiple blocks. RS_Split2
-  // ranges already made dubious progress with region splitting, so they go
-  // straight to single block splitting.
+  // ranges already made dubious progress with region splitting, and cold
+  // ranges of huge functions are not worth it, so they go straight to single
+  // block splitting.
   if (getStage(VirtReg) < RS_Split2) {
-    unsigned PhysReg = tryRegionSplit(VirtReg, Order, NewVRegs);
-    if (PhysReg || !NewVRegs.empty())
-      return PhysReg;
+    if (isColdRange()) {
+      ++NumColdBlockSplits;
+      LLVM_DEBUG(dbgs() << "Cold range, splitting around blocks only.\n");
+    } else {
+      unsigned PhysReg = tryRegionSplit(VirtReg, Order, NewVRegs);
+      if (PhysReg || !NewVRegs.empty())
+        return PhysReg;
+    }
   }
 
   // Then isolate blocks.
@@ -3106,9 +3166,14 @@ unsigned RAGreedy::selectOrSplitImpl(LiveInterval &VirtReg,
 
   // If we couldn't allocate a register from spilling, there is probably some
   // invalid inline assembly. The base class will report it.
-  if (Stage >= RS_Done || !VirtReg.isSpillable())
+  if (Stage >= RS_Done || !VirtReg.isSpillable()) {
+    // Recoloring recurses into selectOrSplitImpl(), only time the outermost
+    // attempt.
+    NamedRegionTimer T("recolor", "Last Chance Recoloring", TimerGroupName,
+                       TimerGroupDescription, TimePassesIsEnabled && !Depth);
     return tryLastChanceRecoloring(VirtReg, Order, NewVRegs, FixedRegisters,
                                    Depth);
+  }
 
   // Finally spill VirtReg itself.
   if (EnableDeferredSpilling && getStage(VirtReg) < RS_Memory) {
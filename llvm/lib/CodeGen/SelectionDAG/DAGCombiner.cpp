@@ -58,6 +58,7 @@
 #include "llvm/Support/Compiler.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/Format.h"
 #include "llvm/Support/KnownBits.h"
 #include "llvm/Support/MachineValueType.h"
 #include "llvm/Support/MathExtras.h"
@@ -84,6 +85,8 @@ STATISTIC(OpsNarrowed     , "Number of load/op/store narrowed");
 STATISTIC(LdStFP2Int      , "Number of fp load/store pairs transformed to int");
 STATISTIC(SlicedLoads, "Number of load sliced");
 STATISTIC(NumFPLogicOpsConv, "Number of logic ops converted to fp ops");
+STATISTIC(NumCombineAttempts, "Number of nodes visited by the combiner");
+STATISTIC(NumBudgetsExhausted, "Number of DAGs whose combine budget ran out");
 
 static cl::opt<bool>
 CombinerGlobalAA("combiner-global-alias-analysis", cl::Hidden,
@@ -115,6 +118,21 @@ static cl::opt<unsigned> TokenFactorInlineLimit(
     "combiner-tokenfactor-inline-limit", cl::Hidden, cl::init(2048),
     cl::desc("Limit the number of operands to inline for Token Factors"));
 
+static cl::opt<unsigned> CombineBudgetFactor(
+    "combiner-budget-factor", cl::Hidden, cl::init(64),
+    cl::desc("Limit the number of nodes the combiner visits in a DAG to this "
+             "factor times the number of nodes of the DAG (0 = no limit)"));
+
+static cl::opt<unsigned> MaxPredecessorSearchSteps(
+    "combiner-max-predecessor-search", cl::Hidden, cl::init(8192),
+    cl::desc("Limit the number of nodes searched to prove that forming an "
+             "indexed load or store does not create a cycle (0 = no limit)"));
+
+static cl::opt<bool> PrintOpcodeStats(
+    "combiner-print-opcode-stats", cl::Hidden, cl::init(false),
+    cl::desc("Print the number of combine attempts and successes by opcode "
+             "for every DAG"));
+
 namespace {
 
   class DAGCombiner {
@@ -705,6 +723,25 @@ public:
   }
 };
 
+/// Adds the nodes whose operands a replacement changed to the worklist, as
+/// well as the existing nodes that were CSE'd with them. Unlike adding all
+/// the users of the replacement, this leaves out the users it already had,
+/// which may be many, e.g. for constants or the entry token.
+class WorklistUpdatedNodesAdder : public SelectionDAG::DAGUpdateListener {
+  DAGCombiner &DC;
+
+public:
+  explicit WorklistUpdatedNodesAdder(DAGCombiner &dc)
+      : SelectionDAG::DAGUpdateListener(dc.getDAG()), DC(dc) {}
+
+  void NodeDeleted(SDNode *N, SDNode *E) override {
+    if (E)
+      DC.AddToWorklist(E);
+  }
+
+  void NodeUpdated(SDNode *N) override { DC.AddToWorklist(N); }
+};
+
 class WorklistInserter : public SelectionDAG::DAGUpdateListener {
   DAGCombiner &DC;
 
@@ -1165,15 +1202,15 @@ SDValue DAGCombiner::CombineTo(SDNode *N, const SDValue *To, unsigned NumTo,
            "Cannot combine value to value of different type!");
 
   WorklistRemover DeadNodes(*this);
-  DAG.ReplaceAllUsesWith(N, To);
   if (AddTo) {
-    // Push the new nodes and any users onto the worklist
-    for (unsigned i = 0, e = NumTo; i != e; ++i) {
-      if (To[i].getNode()) {
+    // Push the new nodes and the users that now use them onto the worklist.
+    WorklistUpdatedNodesAdder UpdatedNodes(*this);
+    DAG.ReplaceAllUsesWith(N, To);
+    for (unsigned i = 0, e = NumTo; i != e; ++i)
+      if (To[i].getNode())
         AddToWorklist(To[i].getNode());
-        AddUsersToWorklist(To[i].getNode());
-      }
-    }
+  } else {
+    DAG.ReplaceAllUsesWith(N, To);
   }
 
   // Finally, if the node is now dead, remove it from the graph.  The node
@@ -1574,6 +1611,20 @@ void DAGCombiner::Run(CombineLevel AtLevel) {
   // changes of the root.
   HandleSDNode Dummy(DAG.getRoot());
 
+  // Bound the number of nodes visited, so that the huge blocks of generated
+  // code cannot keep the combiner busy for minutes. Once the budget is used
+  // up, the nodes left on the worklist are still legalized and deleted when
+  // dead, but no longer combined.
+  uint64_t Budget = 0, NumAttempts = 0;
+  if (CombineBudgetFactor)
+    Budget = uint64_t(CombineBudgetFactor) *
+             std::max<uint64_t>(DAG.allnodes_size(), 1024);
+
+  // The number of attempts and successes for each opcode, and the name of
+  // the opcode, if -combiner-print-opcode-stats is given.
+  using OpcodeStat = std::tuple<unsigned, unsigned, std::string>;
+  DenseMap<unsigned, OpcodeStat> OpcodeStats;
+
   // While we have a valid worklist entry node, try to combine it.
   while (SDNode *N = getNextWorklistEntry()) {
     // If N has no uses, it is dead.  Make sure to revisit all N's operands once
@@ -1598,6 +1649,15 @@ void DAGCombiner::Run(CombineLevel AtLevel) {
         continue;
     }
 
+    if (Budget && NumAttempts >= Budget)
+      continue;
+    if (Budget && ++NumAttempts == Budget) {
+      ++NumBudgetsExhausted;
+      LLVM_DEBUG(dbgs() << "\nCombine budget of " << Budget
+                        << " nodes exhausted\n");
+    }
+    ++NumCombineAttempts;
+
     LLVM_DEBUG(dbgs() << "\nCombining: "; N->dump(&DAG));
 
     // Add any operands of the new node which have not yet been combined to the
@@ -1608,8 +1668,22 @@ void DAGCombiner::Run(CombineLevel AtLevel) {
       if (!CombinedNodes.count(ChildN.getNode()))
         AddToWorklist(ChildN.getNode());
 
+    unsigned Opcode = N->getOpcode();
+    std::string OpcodeName;
+    if (PrintOpcodeStats)
+      OpcodeName = N->getOperationName(&DAG);
+
     SDValue RV = combine(N);
 
+    if (PrintOpcodeStats) {
+      auto &Stats = OpcodeStats[Opcode];
+      ++std::get<0>(Stats);
+      if (RV.getNode())
+        ++std::get<1>(Stats);
+      if (std::get<2>(Stats).empty())
+        std::get<2>(Stats) = std::move(OpcodeName);
+    }
+
     if (!RV.getNode())
       continue;
 
@@ -1628,17 +1702,18 @@ void DAGCombiner::Run(CombineLevel AtLevel) {
 
     LLVM_DEBUG(dbgs() << " ... into: "; RV.getNode()->dump(&DAG));
 
-    if (N->getNumValues() == RV.getNode()->getNumValues())
-      DAG.ReplaceAllUsesWith(N, RV.getNode());
-    else {
-      assert(N->getValueType(0) == RV.getValueType() &&
-             N->getNumValues() == 1 && "Type mismatch");
-      DAG.ReplaceAllUsesWith(N, &RV);
+    // Push the new node and the users that now use it onto the worklist.
+    {
+      WorklistUpdatedNodesAdder UpdatedNodes(*this);
+      if (N->getNumValues() == RV.getNode()->getNumValues())
+        DAG.ReplaceAllUsesWith(N, RV.getNode());
+      else {
+        assert(N->getValueType(0) == RV.getValueType() &&
+               N->getNumValues() == 1 && "Type mismatch");
+        DAG.ReplaceAllUsesWith(N, &RV);
+      }
     }
-
-    // Push the new node and any users onto the worklist
     AddToWorklist(RV.getNode());
-    AddUsersToWorklist(RV.getNode());
 
     // Finally, if the node is now dead, remove it from the graph.  The node
     // may not be dead if the replacement process recursively simplified to
@@ -1647,6 +1722,21 @@ void DAGCombiner::Run(CombineLevel AtLevel) {
     recursivelyDeleteUnusedNodes(N);
   }
 
+  if (PrintOpcodeStats && !OpcodeStats.empty()) {
+    SmallVector<OpcodeStat, 32> Sorted;
+    for (auto &KV : OpcodeStats)
+      Sorted.push_back(std::move(KV.second));
+    llvm::sort(Sorted, [](const OpcodeStat &A, const OpcodeStat &B) {
+      return std::get<0>(A) > std::get<0>(B);
+    });
+    dbgs() << "DAG combine attempts in '"
+           << DAG.getMachineFunction().getName() << "' at level " << Level
+           << ":\n";
+    for (auto &S : Sorted)
+      dbgs() << format("%10u %10u ", std::get<0>(S), std::get<1>(S))
+             << std::get<2>(S) << "\n";
+  }
+
   // If the root changed (e.g. it was a dead load, update the root).
   DAG.setRoot(Dummy.getValue());
   DAG.RemoveDeadNodes();
@@ -13662,7 +13752,8 @@ bool DAGCombiner::CombineToPreIndexedLoadStore(SDNode *N) {
       if (Use.getUser() == Ptr.getNode() || Use != BasePtr)
         continue;
 
-      if (SDNode::hasPredecessorHelper(Use.getUser(), Visited, Worklist))
+      if (SDNode::hasPredecessorHelper(Use.getUser(), Visited, Worklist,
+                                       MaxPredecessorSearchSteps))
         continue;
 
       if (Use.getUser()->getOpcode() != ISD::ADD &&
@@ -13695,7 +13786,8 @@ bool DAGCombiner::CombineToPreIndexedLoadStore(SDNode *N) {
   for (SDNode *Use : Ptr.getNode()->uses()) {
     if (Use == N)
       continue;
-    if (SDNode::hasPredecessorHelper(Use, Visited, Worklist))
+    if (SDNode::hasPredecessorHelper(Use, Visited, Worklist,
+                                     MaxPredecessorSearchSteps))
       return false;
 
     // If Ptr may be folded in addressing mode of other use, then it's
@@ -13880,8 +13972,10 @@ bool DAGCombiner::CombineToPostIndexedLoadStore(SDNode *N) {
       Visited.insert(Ptr.getNode());
       Worklist.push_back(N);
       Worklist.push_back(Op);
-      if (!SDNode::hasPredecessorHelper(N, Visited, Worklist) &&
-          !SDNode::hasPredecessorHelper(Op, Visited, Worklist)) {
+      if (!SDNode::hasPredecessorHelper(N, Visited, Worklist,
+                                        MaxPredecessorSearchSteps) &&
+          !SDNode::hasPredecessorHelper(Op, Visited, Worklist,
+                                        MaxPredecessorSearchSteps)) {
         SDValue Result = isLoad
           ? DAG.getIndexedLoad(SDValue(N,0), SDLoc(N),
                                BasePtr, Offset, AM)
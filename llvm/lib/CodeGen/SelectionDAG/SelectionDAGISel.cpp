@@ -114,6 +114,8 @@ STATISTIC(NumDAGIselRetries,"Number of times dag isel has to try another path");
 STATISTIC(NumEntryBlocks, "Number of entry blocks encountered");
 STATISTIC(NumFastIselFailLowerArguments,
           "Number of entry blocks where fast isel failed to lower arguments");
+STATISTIC(NumSwitchCacheHits,
+          "Number of matcher table switches resolved by the switch cache");
 
 static cl::opt<int> EnableFastISelAbort(
     "fast-isel-abort", cl::Hidden,
@@ -128,6 +130,12 @@ static cl::opt<bool> EnableFastISelFallbackReport(
     cl::desc("Emit a diagnostic when \"fast\" instruction selection "
              "falls back to SelectionDAG."));
 
+static cl::opt<unsigned> SwitchCacheMinCases(
+    "isel-switch-cache-min-cases", cl::init(8), cl::Hidden,
+    cl::desc("Remember the case selected by the opcode and type switches of "
+             "the matcher table that have at least this many cases, instead "
+             "of scanning them again (0 = never)"));
+
 static cl::opt<bool>
 UseMBPI("use-mbpi",
         cl::desc("use Machine Branch Probability Info"),
@@ -2747,6 +2755,30 @@ public:
 
 } // end anonymous namespace
 
+bool SelectionDAGISel::lookupSwitchCache(uint64_t Key, unsigned SwitchStart,
+                                         unsigned &CaseIndex) {
+  if (SwitchStart >= CachedSwitches.size() || !CachedSwitches.test(SwitchStart))
+    return false;
+  auto It = SwitchCaseCache.find(Key);
+  if (It == SwitchCaseCache.end())
+    return false;
+  ++NumSwitchCacheHits;
+  CaseIndex = It->second;
+  return true;
+}
+
+void SelectionDAGISel::addToSwitchCache(uint64_t Key, unsigned SwitchStart,
+                                        unsigned NumCasesScanned,
+                                        unsigned TableSize,
+                                        unsigned CaseIndex) {
+  if (SwitchCacheMinCases == 0 || NumCasesScanned < SwitchCacheMinCases)
+    return;
+  if (CachedSwitches.empty())
+    CachedSwitches.resize(TableSize);
+  CachedSwitches.set(SwitchStart);
+  SwitchCaseCache[Key] = CaseIndex;
+}
+
 void SelectionDAGISel::SelectCodeCommon(SDNode *NodeToMatch,
                                         const unsigned char *MatcherTable,
                                         unsigned TableSize) {
@@ -3073,7 +3105,15 @@ void SelectionDAGISel::SelectCodeCommon(SDNode *NodeToMatch,
     case OPC_SwitchOpcode: {
       unsigned CurNodeOpcode = N.getOpcode();
       unsigned SwitchStart = MatcherIndex-1; (void)SwitchStart;
-      unsigned CaseSize;
+      uint64_t CacheKey = uint64_t(SwitchStart) << 32 | CurNodeOpcode;
+      unsigned CachedIndex;
+      if (lookupSwitchCache(CacheKey, SwitchStart, CachedIndex)) {
+        if (CachedIndex == 0)
+          break;
+        MatcherIndex = CachedIndex;
+        continue;
+      }
+      unsigned CaseSize, NumCases = 0;
       while (true) {
         // Get the size of this case.
         CaseSize = MatcherTable[MatcherIndex++];
@@ -3090,7 +3130,10 @@ void SelectionDAGISel::SelectCodeCommon(SDNode *NodeToMatch,
 
         // Otherwise, skip over this case.
         MatcherIndex += CaseSize;
+        ++NumCases;
       }
+      addToSwitchCache(CacheKey, SwitchStart, NumCases, TableSize,
+                       CaseSize ? MatcherIndex : 0);
 
       // If no cases matched, bail out.
       if (CaseSize == 0) break;
@@ -3104,7 +3147,15 @@ void SelectionDAGISel::SelectCodeCommon(SDNode *NodeToMatch,
     case OPC_SwitchType: {
       MVT CurNodeVT = N.getSimpleValueType();
       unsigned SwitchStart = MatcherIndex-1; (void)SwitchStart;
-      unsigned CaseSize;
+      uint64_t CacheKey = uint64_t(SwitchStart) << 32 | CurNodeVT.SimpleTy;
+      unsigned CachedIndex;
+      if (lookupSwitchCache(CacheKey, SwitchStart, CachedIndex)) {
+        if (CachedIndex == 0)
+          break;
+        MatcherIndex = CachedIndex;
+        continue;
+      }
+      unsigned CaseSize, NumCases = 0;
       while (true) {
         // Get the size of this case.
         CaseSize = MatcherTable[MatcherIndex++];
@@ -3122,7 +3173,10 @@ void SelectionDAGISel::SelectCodeCommon(SDNode *NodeToMatch,
 
         // Otherwise, skip over this case.
         MatcherIndex += CaseSize;
+        ++NumCases;
       }
+      addToSwitchCache(CacheKey, SwitchStart, NumCases, TableSize,
+                       CaseSize ? MatcherIndex : 0);
 
       // If no cases matched, bail out.
       if (CaseSize == 0) break;
@@ -21,6 +21,8 @@
 #include "llvm/BinaryFormat/Dwarf.h"
 #include "llvm/BinaryFormat/ELF.h"
 #include "llvm/BinaryFormat/MachO.h"
+#include "llvm/CodeGen/MachineBasicBlock.h"
+#include "llvm/CodeGen/MachineFunction.h"
 #include "llvm/CodeGen/MachineModuleInfo.h"
 #include "llvm/CodeGen/MachineModuleInfoImpls.h"
 #include "llvm/IR/Comdat.h"
@@ -710,6 +712,38 @@ MCSection *TargetLoweringObjectFileELF::getSectionForJumpTable(
                                    /* AssociatedSymbol */ nullptr);
 }
 
+MCSection *TargetLoweringObjectFileELF::getSectionForMachineBasicBlock(
+    const Function &F, const MachineBasicBlock &MBB,
+    const TargetMachine &TM) const {
+  // The cold blocks of every function go to .text.split, which the linker
+  // keeps apart from the hot text with -z keep-text-section-prefix. Other
+  // blocks stay next to the section of their function, so that their
+  // sections keep its prefix, such as .text.hot.
+  SmallString<128> Name;
+  if (MBB.getSectionID() == MachineBasicBlock::ColdSectionID)
+    Name = ".text.split";
+  else
+    Name = cast<MCSectionELF>(MBB.getParent()->getSection())->getSectionName();
+
+  unsigned UniqueID = MCContext::GenericSectionID;
+  if (TM.getUniqueSectionNames()) {
+    Name.push_back('.');
+    Name += MBB.getSymbol()->getName();
+  } else {
+    UniqueID = NextUniqueID++;
+  }
+
+  unsigned Flags = ELF::SHF_ALLOC | ELF::SHF_EXECINSTR;
+  std::string GroupName;
+  if (const Comdat *C = F.getComdat()) {
+    Flags |= ELF::SHF_GROUP;
+    GroupName = C->getName();
+  }
+  return getContext().getELFSection(Name, ELF::SHT_PROGBITS, Flags,
+                                    /*EntrySize=*/0, GroupName, UniqueID,
+                                    /*Associated=*/nullptr);
+}
+
 bool TargetLoweringObjectFileELF::shouldPutJumpTableInFunctionSection(
     bool UsesLabelDifference, const Function &F) const {
   // We can always create relative relocations, so use another section
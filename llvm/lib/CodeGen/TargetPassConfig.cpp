@@ -978,6 +978,9 @@ void TargetPassConfig::addMachinePasses() {
       addPass(createMachineOutlinerPass(RunOnAllFunctions));
   }
 
+  if (TM->getBBSectionsType() != BasicBlockSection::None)
+    addPass(&BasicBlockSectionsID);
+
   // Add passes that directly emit MI after all other MI passes.
   addPreEmitPass2();
 
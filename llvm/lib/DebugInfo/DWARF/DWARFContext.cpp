@@ -43,6 +43,7 @@
 #include "llvm/Support/Format.h"
 #include "llvm/Support/LEB128.h"
 #include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Parallel.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/TargetRegistry.h"
 #include "llvm/Support/WithColor.h"
@@ -655,8 +656,13 @@ bool DWARFContext::verify(raw_ostream &OS, DIDumpOptions DumpOpts) {
   Success &= verifier.handleDebugAbbrev();
   if (DumpOpts.DumpType & DIDT_DebugInfo)
     Success &= verifier.handleDebugInfo();
-  if (DumpOpts.DumpType & DIDT_DebugLine)
+  if (DumpOpts.DumpType & DIDT_DebugLine) {
+    SmallVector<DWARFUnit *, 16> CUs;
+    for (const auto &CU : compile_units())
+      CUs.push_back(CU.get());
+    prefetchUnits(CUs);
     Success &= verifier.handleDebugLine();
+  }
   Success &= verifier.handleAccelTables();
   return Success;
 }
@@ -874,6 +880,57 @@ Expected<const DWARFDebugLine::LineTable *> DWARFContext::getLineTableForUnit(
                                    RecoverableErrorCallback);
 }
 
+void DWARFContext::prefetchUnits(ArrayRef<DWARFUnit *> Units) {
+  // The abbreviation cache is shared between units, so fill it up front.
+  // After that, extracting DIEs only touches state owned by each unit.
+  for (DWARFUnit *U : Units)
+    U->getAbbreviations();
+  parallel::for_each(parallel::par, Units.begin(), Units.end(),
+                     [](DWARFUnit *U) { U->getNumDIEs(); });
+
+  // Units may share a line table, so collect each uncached table once.
+  if (!Line)
+    Line.reset(new DWARFDebugLine);
+  std::map<uint32_t, DWARFUnit *> Pending;
+  for (DWARFUnit *U : Units) {
+    auto UnitDIE = U->getUnitDIE();
+    if (!UnitDIE)
+      continue;
+    auto Offset = toSectionOffset(UnitDIE.find(DW_AT_stmt_list));
+    if (!Offset)
+      continue;
+    uint32_t StmtOffset = *Offset + U->getLineTableOffset();
+    if (StmtOffset >= U->getLineSection().Data.size() ||
+        Line->getLineTable(StmtOffset))
+      continue;
+    Pending.emplace(StmtOffset, U);
+  }
+
+  // Parse every table into its own object and only cache the ones that parsed
+  // cleanly. Anything with problems is left for getLineTableForUnit() to parse
+  // again, so that its diagnostics are reported the usual way.
+  std::vector<std::pair<uint32_t, DWARFUnit *>> Work(Pending.begin(),
+                                                     Pending.end());
+  std::vector<DWARFLineTable> Tables(Work.size());
+  std::vector<uint8_t> Clean(Work.size());
+  parallel::for_each_n(parallel::par, size_t(0), Work.size(), [&](size_t I) {
+    uint32_t Offset = Work[I].first;
+    DWARFUnit *U = Work[I].second;
+    DWARFDataExtractor LineData(*DObj, U->getLineSection(), isLittleEndian(),
+                                U->getAddressByteSize());
+    bool HadWarning = false;
+    Error Err = Tables[I].parse(LineData, &Offset, *this, U, [&](Error E) {
+      HadWarning = true;
+      consumeError(std::move(E));
+    });
+    Clean[I] = !Err && !HadWarning;
+    consumeError(std::move(Err));
+  });
+  for (size_t I = 0, E = Work.size(); I != E; ++I)
+    if (Clean[I])
+      Line->addLineTable(Work[I].first, std::move(Tables[I]));
+}
+
 void DWARFContext::parseNormalUnits() {
   if (!NormalUnits.empty())
     return;
@@ -454,6 +454,10 @@ DWARFDebugLine::getLineTable(uint32_t Offset) const {
   return nullptr;
 }
 
+void DWARFDebugLine::addLineTable(uint32_t Offset, LineTable &&LT) {
+  LineTableMap.emplace(Offset, std::move(LT));
+}
+
 Expected<const DWARFDebugLine::LineTable *> DWARFDebugLine::getOrParseLineTable(
     DWARFDataExtractor &DebugLineData, uint32_t Offset, const DWARFContext &Ctx,
     const DWARFUnit *U, std::function<void(Error)> RecoverableErrorCallback) {
@@ -12,6 +12,7 @@
 #include "llvm/DebugInfo/CodeView/TypeIndex.h"
 #include "llvm/DebugInfo/PDB/IPDBEnumChildren.h"
 #include "llvm/DebugInfo/PDB/IPDBSourceFile.h"
+#include "llvm/DebugInfo/PDB/Native/DbiStream.h"
 #include "llvm/DebugInfo/PDB/Native/NativeCompilandSymbol.h"
 #include "llvm/DebugInfo/PDB/Native/NativeEnumTypes.h"
 #include "llvm/DebugInfo/PDB/Native/NativeExeSymbol.h"
@@ -24,6 +25,7 @@
 #include "llvm/DebugInfo/PDB/PDBSymbolCompiland.h"
 #include "llvm/DebugInfo/PDB/PDBSymbolExe.h"
 #include "llvm/DebugInfo/PDB/PDBSymbolTypeEnum.h"
+#include "llvm/Object/COFF.h"
 #include "llvm/Support/Allocator.h"
 #include "llvm/Support/BinaryByteStream.h"
 #include "llvm/Support/Error.h"
@@ -79,9 +81,12 @@ Error NativeSession::createFromExe(StringRef Path,
   return make_error<RawError>(raw_error_code::feature_unsupported);
 }
 
-uint64_t NativeSession::getLoadAddress() const { return 0; }
+uint64_t NativeSession::getLoadAddress() const { return LoadAddress; }
 
-bool NativeSession::setLoadAddress(uint64_t Address) { return false; }
+bool NativeSession::setLoadAddress(uint64_t Address) {
+  LoadAddress = Address;
+  return true;
+}
 
 std::unique_ptr<PDBSymbolExe> NativeSession::getGlobalScope() {
   return PDBSymbol::createAs<PDBSymbolExe>(*this, getNativeGlobalScope());
@@ -94,28 +99,54 @@ NativeSession::getSymbolById(SymIndexId SymbolId) const {
 
 bool NativeSession::addressForVA(uint64_t VA, uint32_t &Section,
                                  uint32_t &Offset) const {
-  return false;
+  if (VA < LoadAddress)
+    return false;
+  return addressForRVA(VA - LoadAddress, Section, Offset);
 }
 
-bool NativeSession::addressForRVA(uint32_t VA, uint32_t &Section,
+bool NativeSession::addressForRVA(uint32_t RVA, uint32_t &Section,
                                   uint32_t &Offset) const {
+  Expected<DbiStream &> Dbi = Pdb->getPDBDbiStream();
+  if (!Dbi) {
+    consumeError(Dbi.takeError());
+    return false;
+  }
+
+  // Section numbers start at 1.
+  uint32_t Index = 1;
+  for (const object::coff_section &Header : Dbi->getSectionHeaders()) {
+    if (RVA >= Header.VirtualAddress &&
+        RVA - Header.VirtualAddress < Header.VirtualSize) {
+      Section = Index;
+      Offset = RVA - Header.VirtualAddress;
+      return true;
+    }
+    ++Index;
+  }
   return false;
 }
 
 std::unique_ptr<PDBSymbol>
 NativeSession::findSymbolByAddress(uint64_t Address, PDB_SymType Type) const {
-  return nullptr;
+  uint32_t Section, Offset;
+  if (!addressForVA(Address, Section, Offset))
+    return nullptr;
+  return findSymbolBySectOffset(Section, Offset, Type);
 }
 
 std::unique_ptr<PDBSymbol>
 NativeSession::findSymbolByRVA(uint32_t RVA, PDB_SymType Type) const {
-  return nullptr;
+  uint32_t Section, Offset;
+  if (!addressForRVA(RVA, Section, Offset))
+    return nullptr;
+  return findSymbolBySectOffset(Section, Offset, Type);
 }
 
 std::unique_ptr<PDBSymbol>
 NativeSession::findSymbolBySectOffset(uint32_t Sect, uint32_t Offset,
                                       PDB_SymType Type) const {
-  return nullptr;
+  return const_cast<NativeSession &>(*this).Cache.findSymbolBySectOffset(
+      Sect, Offset, Type);
 }
 
 std::unique_ptr<IPDBEnumLineNumbers>
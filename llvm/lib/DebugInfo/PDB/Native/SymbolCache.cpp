@@ -5,6 +5,7 @@
 #include "llvm/DebugInfo/CodeView/TypeRecordHelpers.h"
 #include "llvm/DebugInfo/PDB/Native/DbiStream.h"
 #include "llvm/DebugInfo/PDB/Native/GlobalsStream.h"
+#include "llvm/DebugInfo/PDB/Native/ISectionContribVisitor.h"
 #include "llvm/DebugInfo/PDB/Native/NativeCompilandSymbol.h"
 #include "llvm/DebugInfo/PDB/Native/NativeEnumGlobals.h"
 #include "llvm/DebugInfo/PDB/Native/NativeEnumTypes.h"
@@ -297,3 +298,69 @@ SymbolCache::getOrCreateCompiland(uint32_t Index) {
 
   return Session.getConcreteSymbolById<PDBSymbolCompiland>(Compilands[Index]);
 }
+
+namespace {
+class SectionContribCollector : public ISectionContribVisitor {
+public:
+  explicit SectionContribCollector(std::vector<SectionContrib> &Contribs)
+      : Contribs(Contribs) {}
+
+  void visit(const SectionContrib &C) override {
+    if (C.Size > 0)
+      Contribs.push_back(C);
+  }
+  void visit(const SectionContrib2 &C) override { visit(C.Base); }
+
+private:
+  std::vector<SectionContrib> &Contribs;
+};
+} // namespace
+
+static bool contribStartsBefore(const SectionContrib &C, uint32_t Sect,
+                                uint32_t Offset) {
+  return std::make_pair(uint32_t(C.ISect), uint32_t(C.Off)) <=
+         std::make_pair(Sect, Offset);
+}
+
+void SymbolCache::parseSectionContribs() {
+  ParsedSectionContribs = true;
+  if (!Dbi)
+    return;
+
+  SectionContribCollector Collector(SectionContribs);
+  Dbi->visitSectionContributions(Collector);
+  llvm::sort(SectionContribs, [](const SectionContrib &L,
+                                 const SectionContrib &R) {
+    return !contribStartsBefore(R, L.ISect, L.Off);
+  });
+}
+
+Optional<uint16_t> SymbolCache::getModuleIndexForSectOffset(uint32_t Sect,
+                                                            uint32_t Offset) {
+  if (!ParsedSectionContribs)
+    parseSectionContribs();
+
+  // Find the last contribution starting at or before the address.
+  auto It = partition_point(SectionContribs, [&](const SectionContrib &C) {
+    return contribStartsBefore(C, Sect, Offset);
+  });
+  if (It == SectionContribs.begin())
+    return None;
+  --It;
+  if (It->ISect != Sect || Offset - uint32_t(It->Off) >= uint32_t(It->Size))
+    return None;
+  return uint16_t(It->Imod);
+}
+
+std::unique_ptr<PDBSymbol>
+SymbolCache::findSymbolBySectOffset(uint32_t Sect, uint32_t Offset,
+                                    PDB_SymType Type) {
+  // Only compilands are found by address so far.
+  if (Type != PDB_SymType::Compiland)
+    return nullptr;
+
+  Optional<uint16_t> Modi = getModuleIndexForSectOffset(Sect, Offset);
+  if (!Modi)
+    return nullptr;
+  return getOrCreateCompiland(*Modi);
+}
@@ -161,6 +161,7 @@ void LLVMSymbolizer::flush() {
   BinaryForPath.clear();
   ObjectPairForPathArch.clear();
   Modules.clear();
+  CacheSize = 0;
 }
 
 namespace {
@@ -366,6 +367,7 @@ LLVMSymbolizer::getOrCreateObject(const std::string &Path,
       return BinOrErr.takeError();
     Pair.first->second = std::move(BinOrErr.get());
     Bin = Pair.first->second.getBinary();
+    CacheSize += Bin->getMemoryBufferRef().getBufferSize();
   }
 
   if (!Bin)
@@ -400,6 +402,13 @@ LLVMSymbolizer::getOrCreateModuleInfo(const std::string &ModuleName) {
   if (I != Modules.end())
     return I->second.get();
 
+  // Long-running clients feed the symbolizer addresses from many modules.
+  // Keep the memory it holds bounded by starting over once the binaries
+  // loaded so far exceed the budget. No pointer into the caches escapes a
+  // single request, so dropping them here is safe.
+  if (Opts.MaxCacheSize && CacheSize > Opts.MaxCacheSize)
+    flush();
+
   std::string BinaryName = ModuleName;
   std::string ArchName = Opts.DefaultArch;
   size_t ColonPos = ModuleName.find_last_of(':');
@@ -0,0 +1,813 @@
+//===----- ELF_x86_64.cpp - JIT linker implementation for ELF/x86-64 ------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// ELF/x86-64 jit-link implementation.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/ExecutionEngine/JITLink/ELF_x86_64.h"
+
+#include "BasicGOTAndStubsBuilder.h"
+#include "JITLinkGeneric.h"
+#include "llvm/ADT/DenseSet.h"
+#include "llvm/BinaryFormat/ELF.h"
+#include "llvm/Object/ELF.h"
+
+#include <map>
+
+#define DEBUG_TYPE "jitlink"
+
+using namespace llvm;
+using namespace llvm::jitlink;
+using namespace llvm::jitlink::ELF_x86_64_Edges;
+
+namespace {
+
+/// Builds an AtomGraph from an ELF/x86-64 relocatable object.
+///
+/// The sections of a relocatable ELF object all start at address zero, so the
+/// allocatable sections are first given consecutive addresses in a virtual
+/// address space of their own. Each symbol defined in such a section then
+/// starts an atom that extends to the next symbol of the section, and every
+/// section without a symbol at its start gets an anonymous atom there. The
+/// records of .eh_frame are split into atoms of their own, and each FDE is
+/// kept alive by the function that it describes.
+class ELFAtomGraphBuilder_x86_64 {
+public:
+  using ELFT = object::ELF64LE;
+  using Elf_Shdr = ELFT::Shdr;
+  using Elf_Sym = ELFT::Sym;
+  using Elf_Rela = ELFT::Rela;
+
+  ELFAtomGraphBuilder_x86_64(const object::ELFFile<ELFT> &Obj,
+                             StringRef FileName)
+      : Obj(Obj),
+        G(llvm::make_unique<AtomGraph>(FileName, 8, support::little)) {}
+
+  Expected<std::unique_ptr<AtomGraph>> buildGraph() {
+    if (auto Err = parseSections())
+      return std::move(Err);
+
+    if (auto Err = addAtoms())
+      return std::move(Err);
+
+    if (auto Err = addRelocations())
+      return std::move(Err);
+
+    addEHFrameKeepAlives();
+
+    return std::move(G);
+  }
+
+private:
+  struct ELFSection {
+    Section *GenericSection = nullptr;
+    JITTargetAddress Address = 0;
+    uint64_t Size = 0;
+    uint32_t Alignment = 1;
+    StringRef Content;
+    bool IsEHFrame = false;
+    /// The atoms of the section, by offset.
+    std::map<uint64_t, DefinedAtom *> Atoms;
+  };
+
+  struct FDERecord {
+    DefinedAtom *FDE;
+    JITTargetAddress CIEAddress;
+  };
+
+  static bool isPCRelative(ELFX86RelocationKind Kind) {
+    return Kind != Pointer32 && Kind != Pointer32Signed && Kind != Pointer64;
+  }
+
+  static Expected<ELFX86RelocationKind> getRelocationKind(uint32_t Type) {
+    switch (Type) {
+    case ELF::R_X86_64_PLT32:
+      return Branch32;
+    case ELF::R_X86_64_32:
+      return Pointer32;
+    case ELF::R_X86_64_32S:
+      return Pointer32Signed;
+    case ELF::R_X86_64_64:
+      return Pointer64;
+    case ELF::R_X86_64_PC32:
+      return PCRel32;
+    case ELF::R_X86_64_PC64:
+      return PCRel64;
+    case ELF::R_X86_64_GOTPCREL:
+    case ELF::R_X86_64_GOTPCRELX:
+    case ELF::R_X86_64_REX_GOTPCRELX:
+      return PCRel32GOTLoad;
+    }
+    return make_error<JITLinkError>("Unsupported x86-64 relocation: type=" +
+                                    formatv("{0:d}", Type));
+  }
+
+  static uint32_t getFixupSize(ELFX86RelocationKind Kind) {
+    return Kind == Pointer64 || Kind == PCRel64 ? 8 : 4;
+  }
+
+  Error parseSections() {
+    auto Secs = Obj.sections();
+    if (!Secs)
+      return Secs.takeError();
+
+    JITTargetAddress NextAddress = 0;
+    for (unsigned Index = 0, E = Secs->size(); Index != E; ++Index) {
+      const Elf_Shdr &Sec = (*Secs)[Index];
+
+      if (Sec.sh_type == ELF::SHT_SYMTAB) {
+        if (SymTab)
+          return make_error<JITLinkError>("Multiple symbol tables in ELF "
+                                          "object");
+        SymTab = &Sec;
+        continue;
+      }
+
+      // Sections that are not loaded, such as the debug info, are dropped.
+      if (!(Sec.sh_flags & ELF::SHF_ALLOC))
+        continue;
+
+      auto Name = Obj.getSectionName(&Sec);
+      if (!Name)
+        return Name.takeError();
+
+      if (Sec.sh_flags & ELF::SHF_TLS)
+        return make_error<JITLinkError>("Thread-local section " + *Name +
+                                        " is not supported");
+
+      uint64_t Align = std::max<uint64_t>(Sec.sh_addralign, 1);
+      if (!isPowerOf2_64(Align) ||
+          Align > std::numeric_limits<uint32_t>::max())
+        return make_error<JITLinkError>("Section " + *Name +
+                                        " has invalid alignment");
+
+      unsigned Prot = sys::Memory::MF_READ;
+      if (Sec.sh_flags & ELF::SHF_WRITE)
+        Prot |= sys::Memory::MF_WRITE;
+      if (Sec.sh_flags & ELF::SHF_EXECINSTR)
+        Prot |= sys::Memory::MF_EXEC;
+
+      bool IsZeroFill = Sec.sh_type == ELF::SHT_NOBITS;
+      auto &GenericSection = G->createSection(
+          *Name, Align, static_cast<sys::Memory::ProtectionFlags>(Prot),
+          IsZeroFill);
+
+      NextAddress = alignTo(NextAddress, Align);
+
+      LLVM_DEBUG({
+        dbgs() << "Adding section " << *Name << ": "
+               << format("0x%016" PRIx64, NextAddress) << ", align: " << Align
+               << "\n";
+      });
+
+      ELFSection &S = Sections[Index];
+      S.GenericSection = &GenericSection;
+      S.Address = NextAddress;
+      S.Size = Sec.sh_size;
+      S.Alignment = Align;
+      S.IsEHFrame = *Name == ".eh_frame";
+      if (!IsZeroFill) {
+        auto Content = Obj.getSectionContents(&Sec);
+        if (!Content)
+          return Content.takeError();
+        S.Content = StringRef(reinterpret_cast<const char *>(Content->data()),
+                              Content->size());
+      }
+
+      NextAddress += S.Size;
+    }
+
+    return Error::success();
+  }
+
+  Section &getCommonSection() {
+    if (!CommonSymbolsSection) {
+      auto Prot = static_cast<sys::Memory::ProtectionFlags>(
+          sys::Memory::MF_READ | sys::Memory::MF_WRITE);
+      CommonSymbolsSection = &G->createSection("<common>", 1, Prot, true);
+    }
+    return *CommonSymbolsSection;
+  }
+
+  // Adds one atom for every symbol defined at a distinct offset. Global
+  // symbols are added first, so that a local symbol at the same address as a
+  // global one resolves to the atom of the global symbol.
+  Error addSymbolAtoms() {
+    auto Syms = Obj.symbols(SymTab);
+    if (!Syms)
+      return Syms.takeError();
+    auto StrTab = Obj.getStringTableForSymtab(*SymTab);
+    if (!StrTab)
+      return StrTab.takeError();
+
+    SymbolAtoms.resize(Syms->size(), nullptr);
+    DenseSet<StringRef> Names;
+
+    for (bool Globals : {true, false}) {
+      // Symbol zero is the null symbol.
+      for (unsigned Index = 1, E = Syms->size(); Index != E; ++Index) {
+        const Elf_Sym &Sym = (*Syms)[Index];
+        if ((Sym.getBinding() != ELF::STB_LOCAL) != Globals)
+          continue;
+        if (Sym.getType() == ELF::STT_SECTION || Sym.getType() == ELF::STT_FILE)
+          continue;
+
+        auto Name = Sym.getName(*StrTab);
+        if (!Name)
+          return Name.takeError();
+
+        if (Sym.getType() == ELF::STT_TLS)
+          return make_error<JITLinkError>("Thread-local symbol " + *Name +
+                                          " is not supported");
+
+        if (Globals && Names.count(*Name))
+          return make_error<JITLinkError>(
+              "Duplicate definition within object: " + *Name);
+
+        // Locals may share their names, and only the first one is named.
+        StringRef AtomName;
+        if (!Names.count(*Name))
+          AtomName = *Name;
+
+        bool IsGlobal = Sym.getBinding() != ELF::STB_LOCAL;
+        bool IsExported =
+            IsGlobal && Sym.getVisibility() != ELF::STV_HIDDEN &&
+            Sym.getVisibility() != ELF::STV_INTERNAL;
+        bool IsWeak = Sym.getBinding() == ELF::STB_WEAK;
+
+        if (Sym.isUndefined()) {
+          if (AtomName.empty())
+            return make_error<JITLinkError>("Undefined symbol without a name");
+          LLVM_DEBUG(dbgs() << "Adding undef atom \"" << AtomName << "\"\n");
+          SymbolAtoms[Index] = &G->addExternalAtom(AtomName);
+          Names.insert(AtomName);
+          continue;
+        }
+
+        if (Sym.isAbsolute()) {
+          if (AtomName.empty())
+            continue;
+          LLVM_DEBUG(dbgs() << "Adding absolute \"" << AtomName << "\" addr: "
+                            << format("0x%016" PRIx64, uint64_t(Sym.st_value)) << "\n");
+          auto &A = G->addAbsoluteAtom(AtomName, Sym.st_value);
+          A.setGlobal(IsGlobal);
+          A.setExported(IsExported);
+          A.setWeak(IsWeak);
+          SymbolAtoms[Index] = &A;
+          Names.insert(AtomName);
+          continue;
+        }
+
+        if (Sym.isCommon()) {
+          if (AtomName.empty())
+            return make_error<JITLinkError>("Common symbol without a name");
+          LLVM_DEBUG(dbgs() << "Adding common \"" << AtomName << "\"\n");
+          // The value of a common symbol is its alignment.
+          auto &A = G->addCommonAtom(
+              getCommonSection(), AtomName, 0,
+              std::max<uint64_t>(Sym.st_value, 1), Sym.st_size);
+          A.setGlobal(IsGlobal);
+          A.setExported(IsExported);
+          SymbolAtoms[Index] = &A;
+          Names.insert(AtomName);
+          continue;
+        }
+
+        if (Sym.st_shndx >= ELF::SHN_LORESERVE)
+          return make_error<JITLinkError>("Symbol " + *Name +
+                                          " has an unsupported section index");
+
+        // Symbols of sections that are not loaded are dropped along with
+        // their sections.
+        auto SecItr = Sections.find(Sym.st_shndx);
+        if (SecItr == Sections.end())
+          continue;
+        auto &S = SecItr->second;
+
+        if (Sym.st_value > S.Size)
+          return make_error<JITLinkError>("Symbol " + *Name +
+                                          " is outside of its section");
+
+        // Atoms must not be empty, so a symbol at the end of its section does
+        // not start one. This is also where the records of .eh_frame are
+        // taken apart.
+        if (Sym.st_value == S.Size || S.IsEHFrame)
+          continue;
+
+        auto &Slot = S.Atoms[Sym.st_value];
+        if (Slot) {
+          if (IsGlobal)
+            return make_error<JITLinkError>("Global symbol " + *Name +
+                                            " is an alias of " +
+                                            Slot->getName() +
+                                            ", which is not supported");
+          SymbolAtoms[Index] = Slot;
+          continue;
+        }
+
+        JITTargetAddress Addr = S.Address + Sym.st_value;
+        uint32_t Align = MinAlign(S.Alignment, Sym.st_value);
+        DefinedAtom &DA =
+            AtomName.empty()
+                ? G->addAnonymousAtom(*S.GenericSection, Addr, Align)
+                : G->addDefinedAtom(*S.GenericSection, AtomName, Addr, Align);
+        DA.setGlobal(IsGlobal);
+        DA.setExported(IsExported);
+        DA.setWeak(IsWeak);
+        DA.setCallable(Sym.getType() == ELF::STT_FUNC);
+
+        LLVM_DEBUG({
+          dbgs() << "  Added " << DA
+                 << " addr: " << format("0x%016" PRIx64, Addr)
+                 << ", align: " << Align
+                 << ", section: " << S.GenericSection->getName() << "\n";
+        });
+
+        Slot = &DA;
+        SymbolAtoms[Index] = &DA;
+        if (!AtomName.empty())
+          Names.insert(AtomName);
+      }
+    }
+
+    return Error::success();
+  }
+
+  // Splits .eh_frame into one atom per CIE or FDE record, and remembers the
+  // CIE of each FDE.
+  Error splitEHFrame(ELFSection &S) {
+    using namespace support;
+
+    uint64_t Offset = 0;
+    while (Offset < S.Size) {
+      if (S.Size - Offset < 4)
+        return make_error<JITLinkError>("Truncated .eh_frame record");
+      uint32_t Length = endian::read32le(S.Content.data() + Offset);
+      if (Length == 0xffffffff)
+        return make_error<JITLinkError>("64-bit DWARF .eh_frame records are "
+                                        "not supported");
+
+      // The zero terminator runs to the end of the section, and must be kept
+      // for the unwinder to find the end of the frames.
+      uint64_t RecordSize =
+          Length == 0 ? S.Size - Offset : 4 + uint64_t(Length);
+      if (RecordSize > S.Size - Offset || (Length != 0 && Length < 4))
+        return make_error<JITLinkError>("Malformed .eh_frame record");
+
+      auto &DA = G->addAnonymousAtom(*S.GenericSection, S.Address + Offset,
+                                     MinAlign(S.Alignment, Offset));
+      S.Atoms[Offset] = &DA;
+
+      if (Length == 0) {
+        DA.setLive(true);
+      } else {
+        // A non-zero CIE pointer makes this an FDE. The pointer is the
+        // distance back to its CIE, from the pointer itself.
+        uint32_t CIEPointer = endian::read32le(S.Content.data() + Offset + 4);
+        if (CIEPointer != 0) {
+          if (CIEPointer > Offset + 4)
+            return make_error<JITLinkError>("FDE refers to a CIE outside of "
+                                            ".eh_frame");
+          FDERecords.push_back({&DA, S.Address + Offset + 4 - CIEPointer});
+        }
+      }
+
+      Offset += RecordSize;
+    }
+
+    return Error::success();
+  }
+
+  Error addAtoms() {
+    if (SymTab)
+      if (auto Err = addSymbolAtoms())
+        return Err;
+
+    for (auto &KV : Sections) {
+      auto &S = KV.second;
+
+      // Skip empty sections.
+      if (S.Size == 0)
+        continue;
+
+      if (S.IsEHFrame) {
+        if (auto Err = splitEHFrame(S))
+          return Err;
+        continue;
+      }
+
+      // Check whether this section had an atom covering offset zero. If not,
+      // add one.
+      if (!S.Atoms.count(0))
+        S.Atoms[0] = &G->addAnonymousAtom(*S.GenericSection, S.Address,
+                                          S.Alignment);
+    }
+
+    LLVM_DEBUG(dbgs() << "ELFGraphBuilder setting atom content\n");
+
+    // Set atom contents. Iterate the atoms of each section in reverse order,
+    // so that each one extends to the start of the next.
+    for (auto &KV : Sections) {
+      auto &S = KV.second;
+      uint64_t LastAtomOffset = S.Size;
+      for (auto I = S.Atoms.rbegin(), E = S.Atoms.rend(); I != E; ++I) {
+        auto Offset = I->first;
+        auto &A = *I->second;
+        if (S.GenericSection->isZeroFill())
+          A.setZeroFill(LastAtomOffset - Offset);
+        else
+          A.setContent(S.Content.substr(Offset, LastAtomOffset - Offset));
+        LastAtomOffset = Offset;
+      }
+    }
+
+    // Relocatable objects leave the CIE pointers of FDEs unrelocated, as the
+    // records are contiguous. Tie every FDE to its CIE with an edge instead,
+    // so that the pointer stays right as records are dead-stripped.
+    for (auto &R : FDERecords) {
+      auto CIE = G->findAtomByAddress(R.CIEAddress);
+      if (!CIE)
+        return CIE.takeError();
+      if (CIE->getAddress() != R.CIEAddress)
+        return make_error<JITLinkError>("FDE does not refer to the start of "
+                                        "a CIE");
+      R.FDE->addEdge(NegDelta32, 4, *CIE, 0);
+    }
+
+    return Error::success();
+  }
+
+  // Returns the atom that the relocation \p R of \p Kind refers to, and sets
+  // \p Addend to the addend of the edge relative to that atom. \p InCode is
+  // true if the fixup is in an executable section.
+  Expected<Atom &> findTargetAtom(const Elf_Rela &R, ELFX86RelocationKind Kind,
+                                  bool InCode, int64_t &Addend) {
+    uint32_t SymIndex = R.getSymbol(false);
+    Addend = R.r_addend;
+    if (SymIndex < SymbolAtoms.size() && SymbolAtoms[SymIndex]) {
+      Atom &A = *SymbolAtoms[SymIndex];
+      if (A.isDefined() && !static_cast<DefinedAtom &>(A).isCommon()) {
+        // Local symbols that alias another symbol share its atom.
+        auto Sym = Obj.getSymbol(SymTab, SymIndex);
+        if (!Sym)
+          return Sym.takeError();
+        auto SecItr = Sections.find((*Sym)->st_shndx);
+        if (SecItr != Sections.end())
+          Addend += SecItr->second.Address + (*Sym)->st_value - A.getAddress();
+      }
+      return A;
+    }
+
+    // Otherwise, this is a section symbol or a local symbol without an atom
+    // of its own. Find the atom by the address that the relocation points
+    // to, allowing for the -4 of PC-relative operands of instructions.
+    if (!SymTab)
+      return make_error<JITLinkError>("Relocation without a symbol table");
+    auto Sym = Obj.getSymbol(SymTab, SymIndex);
+    if (!Sym)
+      return Sym.takeError();
+    auto SecItr = Sections.find((*Sym)->st_shndx);
+    if ((*Sym)->st_shndx >= ELF::SHN_LORESERVE || SecItr == Sections.end())
+      return make_error<JITLinkError>("Relocation against a symbol outside "
+                                      "of the loaded sections");
+
+    JITTargetAddress SymAddress = SecItr->second.Address + (*Sym)->st_value;
+    JITTargetAddress TargetAddress =
+        SymAddress + R.r_addend + (InCode && isPCRelative(Kind) ? 4 : 0);
+    DefinedAtom *Target = nullptr;
+    if (SecItr->second.Atoms.empty() ||
+        TargetAddress < SecItr->second.Address ||
+        TargetAddress >= SecItr->second.Address + SecItr->second.Size ||
+        !(Target = G->getAtomByAddress(TargetAddress))) {
+      auto TargetOrErr = G->findAtomByAddress(SymAddress);
+      if (!TargetOrErr)
+        return TargetOrErr.takeError();
+      Target = &*TargetOrErr;
+    }
+    Addend = SymAddress + R.r_addend - Target->getAddress();
+    return *Target;
+  }
+
+  Error addRelocations() {
+    auto Secs = Obj.sections();
+    if (!Secs)
+      return Secs.takeError();
+
+    for (const Elf_Shdr &RelSec : *Secs) {
+      if (RelSec.sh_type == ELF::SHT_REL)
+        return make_error<JITLinkError>("SHT_REL relocations are not "
+                                        "supported on x86-64");
+      if (RelSec.sh_type != ELF::SHT_RELA)
+        continue;
+
+      // Relocations of sections that are not loaded are dropped.
+      auto SecItr = Sections.find(RelSec.sh_info);
+      if (SecItr == Sections.end())
+        continue;
+      auto &S = SecItr->second;
+      bool InCode =
+          S.GenericSection->getProtectionFlags() & sys::Memory::MF_EXEC;
+
+      auto Relas = Obj.relas(&RelSec);
+      if (!Relas)
+        return Relas.takeError();
+
+      for (const Elf_Rela &R : *Relas) {
+        uint32_t Type = R.getType(false);
+        if (Type == ELF::R_X86_64_NONE)
+          continue;
+
+        auto Kind = getRelocationKind(Type);
+        if (!Kind)
+          return Kind.takeError();
+
+        JITTargetAddress FixupAddress = S.Address + R.r_offset;
+
+        LLVM_DEBUG({
+          dbgs() << "Processing relocation at "
+                 << format("0x%016" PRIx64, FixupAddress) << "\n";
+        });
+
+        auto AtomToFix = G->findAtomByAddress(FixupAddress);
+        if (!AtomToFix)
+          return AtomToFix.takeError();
+
+        if (FixupAddress + getFixupSize(*Kind) >
+            AtomToFix->getAddress() + AtomToFix->getContent().size())
+          return make_error<JITLinkError>(
+              "Relocation content extends past end of fixup atom");
+
+        int64_t Addend = 0;
+        auto TargetAtom = findTargetAtom(R, *Kind, InCode, Addend);
+        if (!TargetAtom)
+          return TargetAtom.takeError();
+
+        if (*Kind == PCRel32GOTLoad && !TargetAtom->hasName())
+          return make_error<JITLinkError>("GOT relocation against an "
+                                          "anonymous symbol is not supported");
+
+        LLVM_DEBUG({
+          Edge GE(*Kind, FixupAddress - AtomToFix->getAddress(), *TargetAtom,
+                  Addend);
+          printEdge(dbgs(), *AtomToFix, GE, getELFX86RelocationKindName(*Kind));
+          dbgs() << "\n";
+        });
+        AtomToFix->addEdge(*Kind, FixupAddress - AtomToFix->getAddress(),
+                           *TargetAtom, Addend);
+      }
+    }
+    return Error::success();
+  }
+
+  // Keeps each FDE alive for as long as the function that it describes, by
+  // the edge of its initial location.
+  void addEHFrameKeepAlives() {
+    for (auto &R : FDERecords) {
+      Atom *Target = nullptr;
+      for (auto &E : R.FDE->edges())
+        if (E.getOffset() == 8)
+          Target = &E.getTarget();
+      if (Target && Target->isDefined())
+        static_cast<DefinedAtom *>(Target)->addEdge(Edge::KeepAlive, 0,
+                                                    *R.FDE, 0);
+      else
+        R.FDE->setLive(true);
+    }
+  }
+
+  const object::ELFFile<ELFT> &Obj;
+  std::unique_ptr<AtomGraph> G;
+  const Elf_Shdr *SymTab = nullptr;
+  std::map<unsigned, ELFSection> Sections;
+  Section *CommonSymbolsSection = nullptr;
+  /// The atom of each symbol, by symbol index, if the symbol starts one.
+  std::vector<Atom *> SymbolAtoms;
+  std::vector<FDERecord> FDERecords;
+};
+
+class ELF_x86_64_GOTAndStubsBuilder
+    : public BasicGOTAndStubsBuilder<ELF_x86_64_GOTAndStubsBuilder> {
+public:
+  ELF_x86_64_GOTAndStubsBuilder(AtomGraph &G)
+      : BasicGOTAndStubsBuilder<ELF_x86_64_GOTAndStubsBuilder>(G) {}
+
+  bool isGOTEdge(Edge &E) const { return E.getKind() == PCRel32GOTLoad; }
+
+  DefinedAtom &createGOTEntry(Atom &Target) {
+    auto &GOTEntryAtom = G.addAnonymousAtom(getGOTSection(), 0x0, 8);
+    GOTEntryAtom.setContent(
+        StringRef(reinterpret_cast<const char *>(NullGOTEntryContent), 8));
+    GOTEntryAtom.addEdge(Pointer64, 0, Target, 0);
+    return GOTEntryAtom;
+  }
+
+  void fixGOTEdge(Edge &E, Atom &GOTEntry) {
+    assert(E.getKind() == PCRel32GOTLoad && "Not a GOT edge?");
+    E.setKind(PCRel32);
+    E.setTarget(GOTEntry);
+    // Leave the edge addend as-is.
+  }
+
+  bool isExternalBranchEdge(Edge &E) {
+    return E.getKind() == Branch32 && !E.getTarget().isDefined();
+  }
+
+  DefinedAtom &createStub(Atom &Target) {
+    auto &StubAtom = G.addAnonymousAtom(getStubsSection(), 0x0, 2);
+    StubAtom.setContent(
+        StringRef(reinterpret_cast<const char *>(StubContent), 6));
+
+    // Re-use GOT entries for stub targets. The jmp reads its operand
+    // relative to the end of the instruction.
+    auto &GOTEntryAtom = getGOTEntryAtom(Target);
+    StubAtom.addEdge(PCRel32, 2, GOTEntryAtom, -4);
+
+    return StubAtom;
+  }
+
+  void fixExternalBranchEdge(Edge &E, Atom &Stub) {
+    assert(E.getKind() == Branch32 && "Not a Branch32 edge?");
+    E.setTarget(Stub);
+    // Leave the edge addend as-is.
+  }
+
+private:
+  Section &getGOTSection() {
+    if (!GOTSection)
+      GOTSection = &G.createSection("$__GOT", 8, sys::Memory::MF_READ, false);
+    return *GOTSection;
+  }
+
+  Section &getStubsSection() {
+    if (!StubsSection) {
+      auto StubsProt = static_cast<sys::Memory::ProtectionFlags>(
+          sys::Memory::MF_READ | sys::Memory::MF_EXEC);
+      StubsSection = &G.createSection("$__STUBS", 8, StubsProt, false);
+    }
+    return *StubsSection;
+  }
+
+  static const uint8_t NullGOTEntryContent[8];
+  static const uint8_t StubContent[6];
+  Section *GOTSection = nullptr;
+  Section *StubsSection = nullptr;
+};
+
+const uint8_t ELF_x86_64_GOTAndStubsBuilder::NullGOTEntryContent[8] = {
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00};
+const uint8_t ELF_x86_64_GOTAndStubsBuilder::StubContent[6] = {
+    0xFF, 0x25, 0x00, 0x00, 0x00, 0x00};
+} // namespace
+
+namespace llvm {
+namespace jitlink {
+
+class ELFJITLinker_x86_64 : public JITLinker<ELFJITLinker_x86_64> {
+  friend class JITLinker<ELFJITLinker_x86_64>;
+
+public:
+  ELFJITLinker_x86_64(std::unique_ptr<JITLinkContext> Ctx,
+                      PassConfiguration PassConfig)
+      : JITLinker(std::move(Ctx), std::move(PassConfig)) {}
+
+private:
+  StringRef getEdgeKindName(Edge::Kind R) const override {
+    return getELFX86RelocationKindName(R);
+  }
+
+  Expected<std::unique_ptr<AtomGraph>>
+  buildGraph(MemoryBufferRef ObjBuffer) override {
+    auto ELFObj =
+        object::ELFFile<object::ELF64LE>::create(ObjBuffer.getBuffer());
+    if (!ELFObj)
+      return ELFObj.takeError();
+    return ELFAtomGraphBuilder_x86_64(*ELFObj, ObjBuffer.getBufferIdentifier())
+        .buildGraph();
+  }
+
+  static Error targetOutOfRangeError(const Atom &A, const Edge &E) {
+    std::string ErrMsg;
+    {
+      raw_string_ostream ErrStream(ErrMsg);
+      ErrStream << "Relocation target out of range: ";
+      printEdge(ErrStream, A, E, getELFX86RelocationKindName(E.getKind()));
+      ErrStream << "\n";
+    }
+    return make_error<JITLinkError>(std::move(ErrMsg));
+  }
+
+  static bool isInt32(int64_t Value) {
+    return Value >= std::numeric_limits<int32_t>::min() &&
+           Value <= std::numeric_limits<int32_t>::max();
+  }
+
+  Error applyFixup(DefinedAtom &A, const Edge &E, char *AtomWorkingMem) const {
+    using namespace support;
+
+    char *FixupPtr = AtomWorkingMem + E.getOffset();
+    JITTargetAddress FixupAddress = A.getAddress() + E.getOffset();
+
+    switch (E.getKind()) {
+    case Branch32:
+    case PCRel32: {
+      int64_t Value = E.getTarget().getAddress() + E.getAddend() - FixupAddress;
+      if (!isInt32(Value))
+        return targetOutOfRangeError(A, E);
+      *(little32_t *)FixupPtr = Value;
+      break;
+    }
+    case PCRel64: {
+      int64_t Value = E.getTarget().getAddress() + E.getAddend() - FixupAddress;
+      *(little64_t *)FixupPtr = Value;
+      break;
+    }
+    case Pointer32: {
+      uint64_t Value = E.getTarget().getAddress() + E.getAddend();
+      if (Value > std::numeric_limits<uint32_t>::max())
+        return targetOutOfRangeError(A, E);
+      *(ulittle32_t *)FixupPtr = Value;
+      break;
+    }
+    case Pointer32Signed: {
+      int64_t Value = E.getTarget().getAddress() + E.getAddend();
+      if (!isInt32(Value))
+        return targetOutOfRangeError(A, E);
+      *(little32_t *)FixupPtr = Value;
+      break;
+    }
+    case Pointer64: {
+      uint64_t Value = E.getTarget().getAddress() + E.getAddend();
+      *(ulittle64_t *)FixupPtr = Value;
+      break;
+    }
+    case NegDelta32: {
+      int64_t Value = FixupAddress - E.getTarget().getAddress() + E.getAddend();
+      if (!isInt32(Value))
+        return targetOutOfRangeError(A, E);
+      *(little32_t *)FixupPtr = Value;
+      break;
+    }
+    default:
+      llvm_unreachable("Unrecognized edge kind");
+    }
+
+    return Error::success();
+  }
+};
+
+void jitLink_ELF_x86_64(std::unique_ptr<JITLinkContext> Ctx) {
+  PassConfiguration Config;
+  Triple TT("x86_64-unknown-linux");
+
+  if (Ctx->shouldAddDefaultTargetPasses(TT)) {
+    // Add a mark-live pass.
+    if (auto MarkLive = Ctx->getMarkLivePass(TT))
+      Config.PrePrunePasses.push_back(std::move(MarkLive));
+    else
+      Config.PrePrunePasses.push_back(markAllAtomsLive);
+
+    // Add an in-place GOT/Stubs pass.
+    Config.PostPrunePasses.push_back([](AtomGraph &G) -> Error {
+      ELF_x86_64_GOTAndStubsBuilder(G).run();
+      return Error::success();
+    });
+  }
+
+  if (auto Err = Ctx->modifyPassConfig(TT, Config))
+    return Ctx->notifyFailed(std::move(Err));
+
+  // Construct a JITLinker and run the link function.
+  ELFJITLinker_x86_64::link(std::move(Ctx), std::move(Config));
+}
+
+StringRef getELFX86RelocationKindName(Edge::Kind R) {
+  switch (R) {
+  case Branch32:
+    return "Branch32";
+  case Pointer32:
+    return "Pointer32";
+  case Pointer32Signed:
+    return "Pointer32Signed";
+  case Pointer64:
+    return "Pointer64";
+  case PCRel32:
+    return "PCRel32";
+  case PCRel64:
+    return "PCRel64";
+  case PCRel32GOTLoad:
+    return "PCRel32GOTLoad";
+  case NegDelta32:
+    return "NegDelta32";
+  default:
+    return getGenericEdgeKindName(static_cast<Edge::Kind>(R));
+  }
+}
+
+} // end namespace jitlink
+} // end namespace llvm
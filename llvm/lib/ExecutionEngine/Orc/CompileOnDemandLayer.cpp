@@ -161,6 +161,18 @@ void CompileOnDemandLayer::emit(MaterializationResponsibility R,
                           std::move(Callables)));
 }
 
+Error CompileOnDemandLayer::updateStubPointer(JITDylib &ImplD,
+                                              const SymbolStringPtr &Name,
+                                              JITTargetAddress NewAddr) {
+  std::lock_guard<std::mutex> Lock(CODLayerMutex);
+  for (auto &KV : DylibResources)
+    if (&KV.second.getImplDylib() == &ImplD)
+      return KV.second.getISManager().updatePointer(*Name, NewAddr);
+  return make_error<StringError>("No stubs for implementation dylib " +
+                                     ImplD.getName(),
+                                 inconvertibleErrorCode());
+}
+
 CompileOnDemandLayer::PerDylibResources &
 CompileOnDemandLayer::getPerDylibResources(JITDylib &TargetD) {
   auto I = DylibResources.find(&TargetD);
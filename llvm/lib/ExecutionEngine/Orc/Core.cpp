@@ -950,6 +950,11 @@ void JITDylib::emit(const SymbolFlagsMap &Emitted) {
             assert(DependantSymI != DependantJD.Symbols.end() &&
                    "Dependant has no entry in the Symbols table");
             DependantSymI->second.setState(SymbolState::Ready);
+            {
+              sys::ScopedWriter Lock(DependantJD.ReadySymbolsMutex);
+              DependantJD.ReadySymbols[DependantName] =
+                  DependantSymI->second.getSymbol();
+            }
 
             for (auto &Q : DependantMI.takeQueriesMeeting(SymbolState::Ready)) {
               Q->notifySymbolMetRequiredState(
@@ -970,6 +975,10 @@ void JITDylib::emit(const SymbolFlagsMap &Emitted) {
         auto SymI = Symbols.find(Name);
         assert(SymI != Symbols.end() && "Symbol has no entry in Symbols table");
         SymI->second.setState(SymbolState::Ready);
+        {
+          sys::ScopedWriter Lock(ReadySymbolsMutex);
+          ReadySymbols[Name] = SymI->second.getSymbol();
+        }
         for (auto &Q : MI.takeQueriesMeeting(SymbolState::Ready)) {
           Q->notifySymbolMetRequiredState(Name, SymI->second.getSymbol());
           if (Q->isComplete())
@@ -1135,6 +1144,11 @@ Error JITDylib::remove(const SymbolNameSet &Names) {
       return make_error<SymbolsCouldNotBeRemoved>(std::move(Materializing));
 
     // Remove the symbols.
+    {
+      sys::ScopedWriter Lock(ReadySymbolsMutex);
+      for (auto &Name : Names)
+        ReadySymbols.erase(Name);
+    }
     for (auto &SymbolMaterializerItrPair : SymbolsToRemove) {
       auto UMII = SymbolMaterializerItrPair.second;
 
@@ -1397,6 +1411,20 @@ bool JITDylib::lookupImpl(
   return QueryComplete;
 }
 
+bool JITDylib::lookupReady(const SymbolNameSet &Names, bool MatchNonExported,
+                           SymbolMap &Result) {
+  sys::ScopedReader Lock(ReadySymbolsMutex);
+  for (auto &Name : Names) {
+    auto I = ReadySymbols.find(Name);
+    if (I == ReadySymbols.end())
+      return false;
+    if (!MatchNonExported && !I->second.getFlags().isExported())
+      return false;
+    Result[Name] = I->second;
+  }
+  return true;
+}
+
 void JITDylib::dump(raw_ostream &OS) {
   ES.runSessionLocked([&, this]() {
     OS << "JITDylib \"" << JITDylibName << "\" (ES: "
@@ -1711,6 +1739,18 @@ void ExecutionSession::lookup(
     });
   });
 
+  // If every symbol is already ready in the first JITDylib of the search
+  // order, answer the query without taking the session lock. There is
+  // nothing to materialize or to register dependencies on in that case.
+  if (!SearchOrder.empty() && !Symbols.empty()) {
+    SymbolMap Result;
+    if (SearchOrder.front().first->lookupReady(
+            Symbols, SearchOrder.front().second, Result)) {
+      NotifyComplete(std::move(Result));
+      return;
+    }
+  }
+
   // lookup can be re-entered recursively if running on a single thread. Run any
   // outstanding MUs in case this query depends on them, otherwise this lookup
   // will starve waiting for a result from an MU that is stuck in the queue.
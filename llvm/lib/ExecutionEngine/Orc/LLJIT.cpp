@@ -17,8 +17,9 @@ namespace {
   // A SimpleCompiler that owns its TargetMachine.
   class TMOwningSimpleCompiler : public llvm::orc::SimpleCompiler {
   public:
-    TMOwningSimpleCompiler(std::unique_ptr<llvm::TargetMachine> TM)
-      : llvm::orc::SimpleCompiler(*TM), TM(std::move(TM)) {}
+    TMOwningSimpleCompiler(std::unique_ptr<llvm::TargetMachine> TM,
+                           llvm::ObjectCache *ObjCache = nullptr)
+      : llvm::orc::SimpleCompiler(*TM, ObjCache), TM(std::move(TM)) {}
   private:
     // FIXME: shared because std::functions (and thus
     // IRCompileLayer::CompileFunction) are not moveable.
@@ -108,7 +109,8 @@ LLJIT::LLJIT(LLJITBuilderState &S, Error &Err)
 
     {
       auto TmpCompileLayer = llvm::make_unique<IRCompileLayer>(
-          *ES, *ObjLinkingLayer, ConcurrentIRCompiler(std::move(*S.JTMB)));
+          *ES, *ObjLinkingLayer,
+          ConcurrentIRCompiler(std::move(*S.JTMB), S.ObjCache));
 
       TmpCompileLayer->setCloneToNewContextOnEmit(true);
       CompileLayer = std::move(TmpCompileLayer);
@@ -135,7 +137,8 @@ LLJIT::LLJIT(LLJITBuilderState &S, Error &Err)
     DL = (*TM)->createDataLayout();
 
     CompileLayer = llvm::make_unique<IRCompileLayer>(
-        *ES, *ObjLinkingLayer, TMOwningSimpleCompiler(std::move(*TM)));
+        *ES, *ObjLinkingLayer,
+        TMOwningSimpleCompiler(std::move(*TM), S.ObjCache));
   }
 }
 
@@ -183,6 +186,13 @@ Error LLLazyJIT::addLazyIRModule(JITDylib &JD, ThreadSafeModule TSM) {
   return CODLayer->add(JD, std::move(TSM), ES->allocateVModule());
 }
 
+LLLazyJIT::~LLLazyJIT() {
+  // Hot functions may still be recompiling on the compile threads, using the
+  // layers of this class.
+  if (CompileThreads)
+    CompileThreads->wait();
+}
+
 LLLazyJIT::LLLazyJIT(LLLazyJITBuilderState &S, Error &Err) : LLJIT(S, Err) {
 
   // If LLJIT construction failed then bail out.
@@ -223,9 +233,28 @@ LLLazyJIT::LLLazyJIT(LLLazyJITBuilderState &S, Error &Err) : LLJIT(S, Err) {
   // Create the transform layer.
   TransformLayer = llvm::make_unique<IRTransformLayer>(*ES, *CompileLayer);
 
+  // If tiered compilation was requested, count calls below the COD layer and
+  // recompile hot functions with the optimizing layers.
+  IRLayer *CODBaseLayer = TransformLayer.get();
+  if (S.HotCallThreshold > 0) {
+    OptCompileLayer = llvm::make_unique<IRCompileLayer>(
+        *ES, *ObjLinkingLayer,
+        ConcurrentIRCompiler(std::move(*S.OptJTMB)));
+    OptTransformLayer = llvm::make_unique<IRTransformLayer>(
+        *ES, *OptCompileLayer, std::move(S.OptTransform));
+
+    TieredLayer = llvm::make_unique<TieredCompileLayer>(
+        *ES, *TransformLayer, *OptTransformLayer, S.HotCallThreshold,
+        [this](JITDylib &JD, const SymbolStringPtr &Name,
+               JITTargetAddress NewAddr) {
+          return CODLayer->updateStubPointer(JD, Name, NewAddr);
+        });
+    CODBaseLayer = TieredLayer.get();
+  }
+
   // Create the COD layer.
   CODLayer = llvm::make_unique<CompileOnDemandLayer>(
-      *ES, *TransformLayer, *LCTMgr, std::move(ISMBuilder));
+      *ES, *CODBaseLayer, *LCTMgr, std::move(ISMBuilder));
 
   if (S.NumCompileThreads > 0)
     CODLayer->setCloneToNewContextOnEmit(true);
@@ -0,0 +1,211 @@
+//===--- PersistentObjectCache.cpp - Object cache that outlives the JIT ---===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/ExecutionEngine/Orc/PersistentObjectCache.h"
+
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/Bitcode/BitcodeWriter.h"
+#include "llvm/Config/llvm-config.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/SHA1.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/Target/TargetMachine.h"
+
+#if !defined(_MSC_VER) && !defined(__MINGW32__)
+#include <unistd.h>
+#else
+#include <io.h>
+#endif
+
+namespace llvm {
+namespace orc {
+
+ObjectCacheStore::~ObjectCacheStore() {}
+
+Expected<std::unique_ptr<DirectoryObjectCacheStore>>
+DirectoryObjectCacheStore::Create(StringRef Path, CachePruningPolicy Policy) {
+  if (std::error_code EC = sys::fs::create_directories(Path))
+    return errorCodeToError(EC);
+  return std::unique_ptr<DirectoryObjectCacheStore>(
+      new DirectoryObjectCacheStore(Path, std::move(Policy)));
+}
+
+DirectoryObjectCacheStore::~DirectoryObjectCacheStore() { prune(); }
+
+bool DirectoryObjectCacheStore::prune() { return pruneCache(Path, Policy); }
+
+std::unique_ptr<MemoryBuffer> DirectoryObjectCacheStore::load(StringRef Key) {
+  // This choice of file name allows the cache to be pruned (see pruneCache()
+  // in include/llvm/Support/CachePruning.h).
+  SmallString<64> EntryPath;
+  sys::path::append(EntryPath, Path, "llvmcache-" + Key);
+
+  // Update the access time, so that the pruner evicts the least recently used
+  // objects first.
+  int FD;
+  if (sys::fs::openFileForRead(Twine(EntryPath), FD, sys::fs::OF_UpdateAtime))
+    return nullptr;
+  ErrorOr<std::unique_ptr<MemoryBuffer>> MBOrErr =
+      MemoryBuffer::getOpenFile(FD, EntryPath,
+                                /*FileSize*/ -1,
+                                /*RequiresNullTerminator*/ false);
+  close(FD);
+  if (!MBOrErr)
+    return nullptr;
+  recordCacheEntryUse(EntryPath, (*MBOrErr)->getBufferSize());
+  return std::move(*MBOrErr);
+}
+
+void DirectoryObjectCacheStore::store(StringRef Key, MemoryBufferRef Obj) {
+  // Write to a temporary file and rename it into place, so that concurrent
+  // JITs never load a partial object.
+  SmallString<64> TempFilenameModel;
+  sys::path::append(TempFilenameModel, Path, "JIT-%%%%%%.tmp.o");
+  Expected<sys::fs::TempFile> Temp = sys::fs::TempFile::create(
+      TempFilenameModel, sys::fs::owner_read | sys::fs::owner_write);
+  if (!Temp) {
+    consumeError(Temp.takeError());
+    return;
+  }
+
+  {
+    raw_fd_ostream OS(Temp->FD, /*shouldClose=*/false);
+    OS << Obj.getBuffer();
+    OS.flush();
+    if (OS.has_error()) {
+      OS.clear_error();
+      consumeError(Temp->discard());
+      return;
+    }
+  }
+
+  SmallString<64> EntryPath;
+  sys::path::append(EntryPath, Path, "llvmcache-" + Key);
+  if (Error Err = Temp->keep(EntryPath)) {
+    // Another process may have the entry open on Windows. Its object is the
+    // same as ours, so just drop ours.
+    consumeError(std::move(Err));
+    consumeError(Temp->discard());
+    return;
+  }
+  recordCacheEntryUse(EntryPath, Obj.getBufferSize());
+}
+
+/// Returns a string that identifies the configuration of \p TM that changes
+/// the objects that it emits.
+static std::string getTargetKey(const TargetMachine &TM, StringRef ExtraKey) {
+  std::string Key;
+  raw_string_ostream OS(Key);
+
+  OS << LLVM_VERSION_STRING;
+#ifdef LLVM_REVISION
+  OS << ' ' << LLVM_REVISION;
+#endif
+  OS << '\0' << TM.getTargetTriple().str() << '\0' << TM.getTargetCPU() << '\0'
+     << TM.getTargetFeatureString() << '\0' << unsigned(TM.getOptLevel())
+     << ' ' << unsigned(TM.getRelocationModel()) << ' '
+     << unsigned(TM.getCodeModel()) << '\0';
+
+  const TargetOptions &Opts = TM.Options;
+  bool Flags[] = {Opts.UnsafeFPMath,
+                  Opts.NoInfsFPMath,
+                  Opts.NoNaNsFPMath,
+                  Opts.NoTrappingFPMath,
+                  Opts.NoSignedZerosFPMath,
+                  Opts.HonorSignDependentRoundingFPMathOption,
+                  Opts.NoZerosInBSS,
+                  Opts.GuaranteedTailCallOpt,
+                  Opts.EnableFastISel,
+                  Opts.EnableGlobalISel,
+                  Opts.UseInitArray,
+                  Opts.RelaxELFRelocations,
+                  Opts.FunctionSections,
+                  Opts.DataSections,
+                  Opts.UniqueSectionNames,
+                  Opts.TrapUnreachable,
+                  Opts.NoTrapAfterNoreturn,
+                  Opts.EmulatedTLS,
+                  Opts.EnableIPRA,
+                  Opts.EmitStackSizeSection,
+                  Opts.EnableMachineOutliner,
+                  Opts.EmitAddrsig};
+  for (bool Flag : Flags)
+    OS << (Flag ? '1' : '0');
+  OS << ' ' << Opts.StackAlignmentOverride << ' '
+     << unsigned(Opts.FloatABIType) << ' ' << unsigned(Opts.AllowFPOpFusion)
+     << ' ' << unsigned(Opts.ThreadModel) << ' '
+     << unsigned(Opts.FPDenormalMode) << ' ' << unsigned(Opts.ExceptionModel)
+     << ' ' << unsigned(Opts.BBSections) << '\0' << ExtraKey;
+
+  return OS.str();
+}
+
+Expected<std::unique_ptr<PersistentObjectCache>>
+PersistentObjectCache::Create(std::unique_ptr<ObjectCacheStore> Store,
+                              JITTargetMachineBuilder JTMB,
+                              StringRef ExtraKey) {
+  // Key on the configuration of an actual target machine, which includes the
+  // defaults that the target picks for anything left unset in JTMB.
+  auto TM = JTMB.createTargetMachine();
+  if (!TM)
+    return TM.takeError();
+  return llvm::make_unique<PersistentObjectCache>(std::move(Store), **TM,
+                                                  ExtraKey);
+}
+
+PersistentObjectCache::PersistentObjectCache(
+    std::unique_ptr<ObjectCacheStore> Store, const TargetMachine &TM,
+    StringRef ExtraKey)
+    : Store(std::move(Store)), TargetKey(getTargetKey(TM, ExtraKey)) {}
+
+std::string PersistentObjectCache::getKey(const Module &M) const {
+  SmallVector<char, 0> Bitcode;
+  {
+    raw_svector_ostream OS(Bitcode);
+    WriteBitcodeToFile(M, OS);
+  }
+
+  SHA1 Hasher;
+  Hasher.update(TargetKey);
+  Hasher.update(ArrayRef<uint8_t>{0});
+  Hasher.update(StringRef(Bitcode.data(), Bitcode.size()));
+  return toHex(Hasher.result());
+}
+
+std::unique_ptr<MemoryBuffer>
+PersistentObjectCache::getObject(const Module *M) {
+  std::string Key = getKey(*M);
+  if (auto Obj = Store->load(Key))
+    return Obj;
+
+  std::lock_guard<std::mutex> Lock(PendingKeysMutex);
+  PendingKeys[M] = std::move(Key);
+  return nullptr;
+}
+
+void PersistentObjectCache::notifyObjectCompiled(const Module *M,
+                                                 MemoryBufferRef Obj) {
+  std::string Key;
+  {
+    std::lock_guard<std::mutex> Lock(PendingKeysMutex);
+    auto I = PendingKeys.find(M);
+    if (I != PendingKeys.end()) {
+      Key = std::move(I->second);
+      PendingKeys.erase(I);
+    }
+  }
+  if (Key.empty())
+    Key = getKey(*M);
+  Store->store(Key, Obj);
+}
+
+} // end namespace orc
+} // end namespace llvm
@@ -0,0 +1,172 @@
+//===-------- TieredCompileLayer.cpp - Recompile hot functions ------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/ExecutionEngine/Orc/TieredCompileLayer.h"
+#include "llvm/IR/IRBuilder.h"
+#include "llvm/IR/MDBuilder.h"
+#include "llvm/IR/Mangler.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Transforms/Utils/BasicBlockUtils.h"
+
+#define DEBUG_TYPE "orc"
+
+using namespace llvm;
+using namespace llvm::orc;
+
+static const char *TierUpEntryName = "__orc_tier_up";
+
+TieredCompileLayer::TieredCompileLayer(ExecutionSession &ES,
+                                       IRLayer &BaseLayer,
+                                       IRLayer &OptimizingLayer,
+                                       unsigned HotCallThreshold,
+                                       UpdateImplFunction UpdateImpl)
+    : IRLayer(ES), BaseLayer(BaseLayer), OptimizingLayer(OptimizingLayer),
+      HotCallThreshold(HotCallThreshold), UpdateImpl(std::move(UpdateImpl)) {
+  assert(HotCallThreshold > 0 && "Hot call threshold must be non-zero");
+}
+
+void TieredCompileLayer::emit(MaterializationResponsibility R,
+                              ThreadSafeModule TSM) {
+  assert(TSM.getModule() && "Module must not be null");
+
+  auto &JD = R.getTargetJITDylib();
+  if (auto Err = defineTierUpEntry(JD, TSM.getModule()->getDataLayout())) {
+    getExecutionSession().reportError(std::move(Err));
+    R.failMaterialization();
+    return;
+  }
+
+  // Keep an uninstrumented copy of the module to recompile hot functions from.
+  auto Source = std::make_shared<ThreadSafeModule>(cloneToNewContext(TSM));
+
+  {
+    auto Lock = TSM.getContextLock();
+    instrument(*TSM.getModule(), JD, std::move(Source));
+  }
+
+  BaseLayer.emit(std::move(R), std::move(TSM));
+}
+
+void TieredCompileLayer::tierUpEntry(void *Ctx) {
+  auto &TF = *static_cast<TieredFunction *>(Ctx);
+  TF.Layer->recompile(TF);
+}
+
+Error TieredCompileLayer::defineTierUpEntry(JITDylib &JD,
+                                            const DataLayout &DL) {
+  std::lock_guard<std::mutex> Lock(TieredLayerMutex);
+  if (!DylibsWithTierUpEntry.insert(&JD).second)
+    return Error::success();
+
+  MangleAndInterner Mangle(getExecutionSession(), DL);
+  return JD.define(absoluteSymbols(
+      {{Mangle(TierUpEntryName),
+        JITEvaluatedSymbol(pointerToJITTargetAddress(&tierUpEntry),
+                           JITSymbolFlags::Callable)}}));
+}
+
+void TieredCompileLayer::instrument(Module &M, JITDylib &JD,
+                                    std::shared_ptr<ThreadSafeModule> Source) {
+  auto &Ctx = M.getContext();
+  auto *Int64Ty = Type::getInt64Ty(Ctx);
+  auto *Int8PtrTy = Type::getInt8PtrTy(Ctx);
+  auto *IntPtrTy = M.getDataLayout().getIntPtrType(Ctx);
+  MangleAndInterner Mangle(getExecutionSession(), M.getDataLayout());
+
+  std::vector<Function *> Worklist;
+  for (auto &F : M.functions())
+    if (!F.isDeclarationForLinker() && !F.hasLocalLinkage() &&
+        !F.hasFnAttribute(Attribute::Naked))
+      Worklist.push_back(&F);
+  if (Worklist.empty())
+    return;
+
+  FunctionCallee TierUp = M.getOrInsertFunction(
+      TierUpEntryName, Type::getVoidTy(Ctx), Int8PtrTy);
+  auto *Hot = ConstantInt::get(Int64Ty, HotCallThreshold - 1);
+  auto *Cold = MDBuilder(Ctx).createBranchWeights(1, HotCallThreshold);
+
+  for (auto *F : Worklist) {
+    TieredFunction *TF;
+    {
+      std::lock_guard<std::mutex> Lock(TieredLayerMutex);
+      TieredFunctions.push_back(
+          {this, &JD, Source, F->getName().str(), Mangle(F->getName()),
+           Mangle((F->getName() + ".tier2").str())});
+      TF = &TieredFunctions.back();
+    }
+
+    auto *Counter = new GlobalVariable(M, Int64Ty, false,
+                                       GlobalValue::PrivateLinkage,
+                                       ConstantInt::get(Int64Ty, 0),
+                                       F->getName() + ".calls");
+
+    // Count the call after the allocas of the entry block, so that they stay
+    // static allocas.
+    auto IP = F->getEntryBlock().begin();
+    while (isa<AllocaInst>(IP))
+      ++IP;
+
+    // Only the call that reaches the threshold tiers up, so the function is
+    // recompiled once.
+    IRBuilder<> B(&*IP);
+    auto *Calls = B.CreateAtomicRMW(AtomicRMWInst::Add, Counter,
+                                    ConstantInt::get(Int64Ty, 1),
+                                    AtomicOrdering::Monotonic);
+    auto *IsHot = B.CreateICmpEQ(Calls, Hot);
+    auto *ThenTerm = SplitBlockAndInsertIfThen(IsHot, &*IP, false, Cold);
+    B.SetInsertPoint(ThenTerm);
+    B.CreateCall(TierUp,
+                 {B.CreateIntToPtr(
+                     ConstantInt::get(IntPtrTy, pointerToJITTargetAddress(TF)),
+                     Int8PtrTy)});
+  }
+}
+
+void TieredCompileLayer::recompile(TieredFunction &TF) {
+  // Clone the hot function alone: everything else that it uses is already
+  // defined by the tier-1 code. Rename it so that the clone does not clash
+  // with the tier-1 definition.
+  auto OptTSM = cloneToNewContext(*TF.Source, [&](const GlobalValue &GV) {
+    return GV.getName() == TF.Name;
+  });
+  auto *F = OptTSM.getModule()->getFunction(TF.Name);
+  assert(F && !F->isDeclaration() && "Hot function missing from its module");
+  F->setName(TF.Name + ".tier2");
+
+  auto &ES = getExecutionSession();
+  if (auto Err = OptimizingLayer.add(*TF.JD, std::move(OptTSM))) {
+    ES.reportError(std::move(Err));
+    return;
+  }
+
+  // Look the optimized code up without waiting for it: the hot call carries
+  // on in the tier-1 code, and the stub is updated once the optimized code is
+  // ready.
+  auto OnReady = [this, &TF](Expected<SymbolMap> Result) {
+    auto &ES = getExecutionSession();
+    if (!Result) {
+      ES.reportError(Result.takeError());
+      return;
+    }
+    auto OptImplAddr = (*Result)[TF.OptImplName].getAddress();
+
+    LLVM_DEBUG({
+      dbgs() << "Tiering up " << *TF.ImplName << " to "
+             << format("0x%016" PRIx64, OptImplAddr) << "\n";
+    });
+
+    if (auto Err = UpdateImpl(*TF.JD, TF.ImplName, OptImplAddr))
+      ES.reportError(std::move(Err));
+  };
+
+  ES.lookup(JITDylibSearchList({{TF.JD, true}}), {TF.OptImplName},
+            SymbolState::Ready, std::move(OnReady), NoDependenciesToRegister);
+}
@@ -0,0 +1,148 @@
+//===- SlabMemoryMapper.cpp - Slab allocator for JIT memory ---------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/ExecutionEngine/SlabMemoryMapper.h"
+#include "llvm/Support/MathExtras.h"
+#include "llvm/Support/Process.h"
+
+namespace llvm {
+
+SlabMemoryMapper::SlabMemoryMapper(size_t SlabSize, bool UseHugePages)
+    : UseHugePages(UseHugePages),
+      PageSize(sys::Process::getPageSizeEstimate()) {
+  this->SlabSize = alignTo(SlabSize, PageSize);
+  for (auto &Current : CurrentSlab)
+    Current = Slabs.end();
+}
+
+SlabMemoryMapper::~SlabMemoryMapper() {
+  for (auto &KV : Slabs)
+    sys::Memory::releaseMappedMemory(KV.second.Mem);
+}
+
+unsigned
+SlabMemoryMapper::purposeIndex(SectionMemoryManager::AllocationPurpose P) {
+  switch (P) {
+  case SectionMemoryManager::AllocationPurpose::Code:
+    return 0;
+  case SectionMemoryManager::AllocationPurpose::ROData:
+    return 1;
+  case SectionMemoryManager::AllocationPurpose::RWData:
+    return 2;
+  }
+  llvm_unreachable("Unknown SectionMemoryManager::AllocationPurpose");
+}
+
+sys::MemoryBlock SlabMemoryMapper::allocateMappedMemory(
+    SectionMemoryManager::AllocationPurpose Purpose, size_t NumBytes,
+    const sys::MemoryBlock *const NearBlock, unsigned Flags,
+    std::error_code &EC) {
+  EC = std::error_code();
+  if (NumBytes == 0)
+    return sys::MemoryBlock();
+
+  const unsigned RW = sys::Memory::MF_READ | sys::Memory::MF_WRITE;
+  const unsigned HugeHint = UseHugePages ? sys::Memory::MF_HUGE_HINT : 0;
+  size_t Size = alignTo(NumBytes, PageSize);
+
+  std::lock_guard<std::mutex> Lock(SlabsMutex);
+
+  // Blocks that would take most of a slab get a slab of their own.
+  if (Size > SlabSize / 2) {
+    sys::MemoryBlock Mem =
+        sys::Memory::allocateMappedMemory(Size, nullptr, Flags | HugeHint, EC);
+    if (EC)
+      return sys::MemoryBlock();
+    Slab &S = Slabs[reinterpret_cast<uintptr_t>(Mem.base())];
+    S.Mem = Mem;
+    S.Used = Mem.allocatedSize();
+    S.LiveBlocks = 1;
+    return sys::MemoryBlock(Mem.base(), Size);
+  }
+
+  // Start a new slab for this purpose if the current one is full. The near
+  // hint of the caller is ignored: blocks of the same purpose already end up
+  // next to each other.
+  auto &Current = CurrentSlab[purposeIndex(Purpose)];
+  if (Current == Slabs.end() ||
+      Current->second.Mem.allocatedSize() - Current->second.Used < Size) {
+    const sys::MemoryBlock *Near =
+        Current != Slabs.end() ? &Current->second.Mem : nullptr;
+    sys::MemoryBlock Mem = sys::Memory::allocateMappedMemory(
+        SlabSize, Near, RW | HugeHint, EC);
+    if (EC)
+      return sys::MemoryBlock();
+
+    // The old slab was kept around while it was current, even if all of its
+    // blocks had been released.
+    auto Prev = Current;
+    Current = Slabs.insert({reinterpret_cast<uintptr_t>(Mem.base()), Slab()})
+                  .first;
+    Current->second.Mem = Mem;
+    if (Prev != Slabs.end() && Prev->second.LiveBlocks == 0) {
+      sys::Memory::releaseMappedMemory(Prev->second.Mem);
+      Slabs.erase(Prev);
+    }
+  }
+
+  Slab &S = Current->second;
+  sys::MemoryBlock Block(static_cast<char *>(S.Mem.base()) + S.Used, Size);
+  S.Used += Size;
+  ++S.LiveBlocks;
+
+  // The part of the slab that was never handed out is still read-write.
+  if ((Flags & sys::Memory::MF_RWE_MASK) != RW) {
+    EC = sys::Memory::protectMappedMemory(Block, Flags);
+    if (EC) {
+      --S.LiveBlocks;
+      return sys::MemoryBlock();
+    }
+  }
+
+  return Block;
+}
+
+std::error_code
+SlabMemoryMapper::protectMappedMemory(const sys::MemoryBlock &Block,
+                                      unsigned Flags) {
+  return sys::Memory::protectMappedMemory(Block, Flags);
+}
+
+std::error_code SlabMemoryMapper::releaseMappedMemory(sys::MemoryBlock &M) {
+  std::lock_guard<std::mutex> Lock(SlabsMutex);
+
+  auto I = Slabs.upper_bound(reinterpret_cast<uintptr_t>(M.base()));
+  assert(I != Slabs.begin() && "Block was not allocated by this mapper");
+  --I;
+  Slab &S = I->second;
+  assert(S.LiveBlocks > 0 && "Block was released twice");
+  M = sys::MemoryBlock();
+
+  if (--S.LiveBlocks != 0)
+    return std::error_code();
+
+  // Reuse the current slab of a purpose from the start, rather than mapping
+  // a new one.
+  for (auto &Current : CurrentSlab)
+    if (Current == I) {
+      S.Used = 0;
+      return sys::Memory::protectMappedMemory(
+          S.Mem, sys::Memory::MF_READ | sys::Memory::MF_WRITE);
+    }
+
+  std::error_code EC = sys::Memory::releaseMappedMemory(S.Mem);
+  Slabs.erase(I);
+  return EC;
+}
+
+size_t SlabMemoryMapper::getNumSlabs() const {
+  std::lock_guard<std::mutex> Lock(SlabsMutex);
+  return Slabs.size();
+}
+
+} // namespace llvm
@@ -12,6 +12,7 @@
 
 #include "llvm/LTO/Caching.h"
 #include "llvm/ADT/StringExtras.h"
+#include "llvm/Support/CachePruning.h"
 #include "llvm/Support/Errc.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Path.h"
@@ -49,6 +50,10 @@ Expected<NativeObjectCache> lto::localCache(StringRef CacheDirectoryPath,
                                     /*RequiresNullTerminator*/ false);
       close(FD);
       if (MBOrErr) {
+        // The caller reads all of the object file, usually after looking up
+        // the other tasks, so start reading it from the cache now.
+        (*MBOrErr)->advise(sys::fs::mapped_file_region::willneed);
+        recordCacheEntryUse(EntryPath, (*MBOrErr)->getBufferSize());
         AddBuffer(Task, std::move(*MBOrErr));
         return AddStreamFn();
       }
@@ -124,6 +129,7 @@ Expected<NativeObjectCache> lto::localCache(StringRef CacheDirectoryPath,
                              TempFile.TmpName + " to " + EntryPath + ": " +
                              toString(std::move(E)) + "\n");
 
+        recordCacheEntryUse(EntryPath, (*MBOrErr)->getBufferSize());
         AddBuffer(Task, std::move(*MBOrErr));
       }
     };
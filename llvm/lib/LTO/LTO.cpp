@@ -40,6 +40,7 @@
 #include "llvm/Support/Threading.h"
 #include "llvm/Support/VCSRevision.h"
 #include "llvm/Support/raw_ostream.h"
+#include "llvm/Support/raw_sha1_ostream.h"
 #include "llvm/Target/TargetMachine.h"
 #include "llvm/Target/TargetOptions.h"
 #include "llvm/Transforms/IPO.h"
@@ -74,7 +75,8 @@ void llvm::computeLTOCacheKey(
     const std::map<GlobalValue::GUID, GlobalValue::LinkageTypes> &ResolvedODR,
     const GVSummaryMapTy &DefinedGlobals,
     const std::set<GlobalValue::GUID> &CfiFunctionDefs,
-    const std::set<GlobalValue::GUID> &CfiFunctionDecls) {
+    const std::set<GlobalValue::GUID> &CfiFunctionDecls,
+    ArrayRef<uint8_t> ImportedModuleHash) {
   // Compute the unique hash for this entry.
   // This is based on the current compiler version, the module itself, the
   // export list, the hash for every single module in the import list, the
@@ -116,9 +118,10 @@ void llvm::computeLTOCacheKey(
   // FIXME: Hash more of Options. For now all clients initialize Options from
   // command-line flags (which is unsupported in production), but may set
   // RelaxELFRelocations. The clang driver can also pass FunctionSections,
-  // DataSections and DebuggerTuning via command line flags.
+  // BBSections, DataSections and DebuggerTuning via command line flags.
   AddUnsigned(Conf.Options.RelaxELFRelocations);
   AddUnsigned(Conf.Options.FunctionSections);
+  AddUnsigned((unsigned)Conf.Options.BBSections);
   AddUnsigned(Conf.Options.DataSections);
   AddUnsigned((unsigned)Conf.Options.DebuggerTuning);
   for (auto &A : Conf.MAttrs)
@@ -142,9 +145,15 @@ void llvm::computeLTOCacheKey(
   AddString(Conf.DefaultTriple);
   AddString(Conf.DwoDir);
 
-  // Include the hash for the current module
-  auto ModHash = Index.getModuleHash(ModuleID);
-  Hasher.update(ArrayRef<uint8_t>((uint8_t *)&ModHash[0], sizeof(ModHash)));
+  // Include the hash for the current module, or for the current module with
+  // its imports in it.
+  if (ImportedModuleHash.empty()) {
+    auto ModHash = Index.getModuleHash(ModuleID);
+    Hasher.update(ArrayRef<uint8_t>((uint8_t *)&ModHash[0], sizeof(ModHash)));
+  } else {
+    AddString("imported");
+    Hasher.update(ImportedModuleHash);
+  }
   for (auto F : ExportList)
     // The export list can impact the internalization, be conservative here
     Hasher.update(ArrayRef<uint8_t>((uint8_t *)&F, sizeof(F)));
@@ -153,8 +162,11 @@ void llvm::computeLTOCacheKey(
   // imported symbols for each module may affect code generation and is
   // sensitive to link order, so include that as well.
   for (auto &Entry : ImportList) {
-    auto ModHash = Index.getModuleHash(Entry.first());
-    Hasher.update(ArrayRef<uint8_t>((uint8_t *)&ModHash[0], sizeof(ModHash)));
+    if (ImportedModuleHash.empty()) {
+      auto ModHash = Index.getModuleHash(Entry.first());
+      Hasher.update(
+          ArrayRef<uint8_t>((uint8_t *)&ModHash[0], sizeof(ModHash)));
+    }
 
     AddUint64(Entry.second.size());
     for (auto &Fn : Entry.second)
@@ -1025,7 +1037,35 @@ public:
 };
 
 namespace {
+/// Returns a stream callback whose stream keeps the object file in memory and
+/// writes it to a stream from each of \p AddStreams when it is destroyed.
+AddStreamFn teeAddStream(std::vector<AddStreamFn> AddStreams) {
+  struct TeeStream : NativeObjectStream {
+    std::unique_ptr<SmallVector<char, 0>> Buffer;
+    std::vector<AddStreamFn> AddStreams;
+    unsigned Task;
+
+    TeeStream(std::unique_ptr<SmallVector<char, 0>> Buffer,
+              std::vector<AddStreamFn> AddStreams, unsigned Task)
+        : NativeObjectStream(llvm::make_unique<raw_svector_ostream>(*Buffer)),
+          Buffer(std::move(Buffer)), AddStreams(std::move(AddStreams)),
+          Task(Task) {}
+
+    ~TeeStream() {
+      OS.reset();
+      for (AddStreamFn &AddStream : AddStreams)
+        AddStream(Task)->OS->write(Buffer->data(), Buffer->size());
+    }
+  };
+
+  return [=](unsigned Task) -> std::unique_ptr<NativeObjectStream> {
+    auto Buffer = llvm::make_unique<SmallVector<char, 0>>();
+    return llvm::make_unique<TeeStream>(std::move(Buffer), AddStreams, Task);
+  };
+}
+
 class InProcessThinBackend : public ThinBackendProc {
+protected:
   ThreadPool BackendThreadPool;
   AddStreamFn AddStream;
   NativeObjectCache Cache;
@@ -1038,11 +1078,11 @@ class InProcessThinBackend : public ThinBackendProc {
 public:
   InProcessThinBackend(
       Config &Conf, ModuleSummaryIndex &CombinedIndex,
-      unsigned ThinLTOParallelismLevel,
+      ThreadPoolStrategy ThinLTOParallelism,
       const StringMap<GVSummaryMapTy> &ModuleToDefinedGVSummaries,
       AddStreamFn AddStream, NativeObjectCache Cache)
       : ThinBackendProc(Conf, CombinedIndex, ModuleToDefinedGVSummaries),
-        BackendThreadPool(ThinLTOParallelismLevel),
+        BackendThreadPool(ThinLTOParallelism),
         AddStream(std::move(AddStream)), Cache(std::move(Cache)) {
     for (auto &Name : CombinedIndex.cfiFunctionDefs())
       CfiFunctionDefs.insert(
@@ -1052,6 +1092,15 @@ public:
           GlobalValue::getGUID(GlobalValue::dropLLVMManglingEscape(Name)));
   }
 
+  /// Optimizes and compiles \p Mod, which has been through
+  /// thinBackendImport(), and writes the object file to \p AddStream.
+  virtual Error
+  runImportedBackend(AddStreamFn AddStream, unsigned Task, Module &Mod,
+                     StringRef ModuleID,
+                     const FunctionImporter::ImportMapTy &ImportList) {
+    return thinBackendOptAndCodeGen(Conf, Task, AddStream, Mod, CombinedIndex);
+  }
+
   Error runThinLTOBackendThread(
       AddStreamFn AddStream, NativeObjectCache Cache, unsigned Task,
       BitcodeModule BM, ModuleSummaryIndex &CombinedIndex,
@@ -1060,24 +1109,55 @@ public:
       const std::map<GlobalValue::GUID, GlobalValue::LinkageTypes> &ResolvedODR,
       const GVSummaryMapTy &DefinedGlobals,
       MapVector<StringRef, BitcodeModule> &ModuleMap) {
-    auto RunThinBackend = [&](AddStreamFn AddStream) {
+    auto ModuleID = BM.getModuleIdentifier();
+
+    // If LookUpImported is true, the object file was not found in the cache,
+    // and is looked up again by the contents of the module after importing.
+    auto RunThinBackend = [&](AddStreamFn AddStream,
+                              bool LookUpImported) -> Error {
       LTOLLVMContext BackendContext(Conf);
       Expected<std::unique_ptr<Module>> MOrErr = BM.parseModule(BackendContext);
       if (!MOrErr)
         return MOrErr.takeError();
+      Module &Mod = **MOrErr;
+
+      if (Conf.CodeGenOnly)
+        return thinBackendOptAndCodeGen(Conf, Task, AddStream, Mod,
+                                        CombinedIndex);
+
+      Expected<bool> ContinueOrErr =
+          thinBackendImport(Conf, Task, Mod, CombinedIndex, ImportList,
+                            DefinedGlobals, ModuleMap);
+      if (!ContinueOrErr)
+        return ContinueOrErr.takeError();
+      if (!*ContinueOrErr)
+        return Error::success();
+
+      if (LookUpImported) {
+        raw_sha1_ostream Hasher;
+        WriteBitcodeToFile(Mod, Hasher);
+        SmallString<40> ImportedKey;
+        computeLTOCacheKey(ImportedKey, Conf, CombinedIndex, ModuleID,
+                           ImportList, ExportList, ResolvedODR, DefinedGlobals,
+                           CfiFunctionDefs, CfiFunctionDecls,
+                           arrayRefFromStringRef(Hasher.sha1()));
+        AddStreamFn ImportedAddStream = Cache(Task, ImportedKey);
+        if (!ImportedAddStream)
+          return Error::success();
+        // Fill in both entries, so that the next link finds the object file
+        // without importing again.
+        AddStream = teeAddStream({AddStream, ImportedAddStream});
+      }
 
-      return thinBackend(Conf, Task, AddStream, **MOrErr, CombinedIndex,
-                         ImportList, DefinedGlobals, ModuleMap);
+      return runImportedBackend(AddStream, Task, Mod, ModuleID, ImportList);
     };
 
-    auto ModuleID = BM.getModuleIdentifier();
-
     if (!Cache || !CombinedIndex.modulePaths().count(ModuleID) ||
         all_of(CombinedIndex.getModuleHash(ModuleID),
                [](uint32_t V) { return V == 0; }))
       // Cache disabled or no entry for this module in the combined index or
       // no module hash.
-      return RunThinBackend(AddStream);
+      return RunThinBackend(AddStream, /*LookUpImported=*/false);
 
     SmallString<40> Key;
     // The module may be cached, this helps handling it.
@@ -1085,7 +1165,7 @@ public:
                        ExportList, ResolvedODR, DefinedGlobals, CfiFunctionDefs,
                        CfiFunctionDecls);
     if (AddStreamFn CacheAddStream = Cache(Task, Key))
-      return RunThinBackend(CacheAddStream);
+      return RunThinBackend(CacheAddStream, Conf.CacheByImportedContent);
 
     return Error::success();
   }
@@ -1135,15 +1215,97 @@ public:
 } // end anonymous namespace
 
 ThinBackend lto::createInProcessThinBackend(unsigned ParallelismLevel) {
+  ThreadPoolStrategy Parallelism;
+  Parallelism.ThreadsRequested = ParallelismLevel;
+  return createInProcessThinBackend(Parallelism);
+}
+
+ThinBackend lto::createInProcessThinBackend(ThreadPoolStrategy Parallelism) {
   return [=](Config &Conf, ModuleSummaryIndex &CombinedIndex,
              const StringMap<GVSummaryMapTy> &ModuleToDefinedGVSummaries,
              AddStreamFn AddStream, NativeObjectCache Cache) {
     return llvm::make_unique<InProcessThinBackend>(
-        Conf, CombinedIndex, ParallelismLevel, ModuleToDefinedGVSummaries,
+        Conf, CombinedIndex, Parallelism, ModuleToDefinedGVSummaries,
         AddStream, Cache);
   };
 }
 
+namespace {
+class RemoteThinBackend : public InProcessThinBackend {
+  RemoteThinBackendFn Execute;
+
+public:
+  RemoteThinBackend(
+      Config &Conf, ModuleSummaryIndex &CombinedIndex,
+      ThreadPoolStrategy Parallelism,
+      const StringMap<GVSummaryMapTy> &ModuleToDefinedGVSummaries,
+      AddStreamFn AddStream, NativeObjectCache Cache,
+      RemoteThinBackendFn Execute)
+      : InProcessThinBackend(Conf, CombinedIndex, Parallelism,
+                             ModuleToDefinedGVSummaries, std::move(AddStream),
+                             std::move(Cache)),
+        Execute(std::move(Execute)) {}
+
+  Error
+  runImportedBackend(AddStreamFn AddStream, unsigned Task, Module &Mod,
+                     StringRef ModuleID,
+                     const FunctionImporter::ImportMapTy &ImportList) override {
+    RemoteThinBackendJob Job;
+    Job.Task = Task;
+    Job.ModuleID = ModuleID;
+    {
+      raw_string_ostream OS(Job.Bitcode);
+      WriteBitcodeToFile(Mod, OS);
+    }
+    {
+      std::map<std::string, GVSummaryMapTy> ModuleToSummariesForIndex;
+      gatherImportedSummariesForModule(Job.ModuleID,
+                                       ModuleToDefinedGVSummaries, ImportList,
+                                       ModuleToSummariesForIndex);
+      raw_string_ostream OS(Job.Index);
+      WriteIndexToFile(CombinedIndex, OS, &ModuleToSummariesForIndex);
+    }
+
+    Expected<bool> RanOrErr = Execute(Job, AddStream);
+    if (!RanOrErr)
+      return RanOrErr.takeError();
+    if (*RanOrErr)
+      return Error::success();
+
+    // The job was turned down; the module is ready to be compiled here.
+    return thinBackendOptAndCodeGen(Conf, Task, AddStream, Mod, CombinedIndex);
+  }
+};
+} // end anonymous namespace
+
+ThinBackend lto::createRemoteThinBackend(ThreadPoolStrategy Parallelism,
+                                         RemoteThinBackendFn Execute) {
+  return [=](Config &Conf, ModuleSummaryIndex &CombinedIndex,
+             const StringMap<GVSummaryMapTy> &ModuleToDefinedGVSummaries,
+             AddStreamFn AddStream, NativeObjectCache Cache) {
+    return llvm::make_unique<RemoteThinBackend>(
+        Conf, CombinedIndex, Parallelism, ModuleToDefinedGVSummaries,
+        AddStream, Cache, Execute);
+  };
+}
+
+Error lto::runRemoteThinBackendJob(Config &C, const RemoteThinBackendJob &Job,
+                                   AddStreamFn AddStream) {
+  Expected<std::unique_ptr<ModuleSummaryIndex>> IndexOrErr =
+      getModuleSummaryIndex(MemoryBufferRef(Job.Index, Job.ModuleID));
+  if (!IndexOrErr)
+    return IndexOrErr.takeError();
+
+  LTOLLVMContext Ctx(C);
+  Expected<std::unique_ptr<Module>> MOrErr =
+      parseBitcodeFile(MemoryBufferRef(Job.Bitcode, Job.ModuleID), Ctx);
+  if (!MOrErr)
+    return MOrErr.takeError();
+
+  return thinBackendOptAndCodeGen(C, Job.Task, AddStream, **MOrErr,
+                                  **IndexOrErr);
+}
+
 // Given the original \p Path to an output file, replace any path
 // prefix matching \p OldPrefix with \p NewPrefix. Also, create the
 // resulting directory if it does not yet exist.
@@ -262,17 +262,10 @@ static void runNewPMCustomPasses(Module &Mod, TargetMachine *TM,
   MPM.run(Mod, MAM);
 }
 
-static void runOldPMPasses(Config &Conf, Module &Mod, TargetMachine *TM,
-                           bool IsThinLTO, ModuleSummaryIndex *ExportSummary,
-                           const ModuleSummaryIndex *ImportSummary) {
-  legacy::PassManager passes;
-  passes.add(createTargetTransformInfoWrapperPass(TM->getTargetIRAnalysis()));
-
-  PassManagerBuilder PMB;
+static void setUpPassManagerBuilder(PassManagerBuilder &PMB, Config &Conf,
+                                    TargetMachine *TM) {
   PMB.LibraryInfo = new TargetLibraryInfoImpl(Triple(TM->getTargetTriple()));
   PMB.Inliner = createFunctionInliningPass();
-  PMB.ExportSummary = ExportSummary;
-  PMB.ImportSummary = ImportSummary;
   // Unconditionally verify input since it is not verified before this
   // point and has unknown origin.
   PMB.VerifyInput = true;
@@ -286,6 +279,18 @@ static void runOldPMPasses(Config &Conf, Module &Mod, TargetMachine *TM,
     PMB.EnablePGOCSInstrUse = true;
     PMB.PGOInstrUse = Conf.CSIRProfile;
   }
+}
+
+static void runOldPMPasses(Config &Conf, Module &Mod, TargetMachine *TM,
+                           bool IsThinLTO, ModuleSummaryIndex *ExportSummary,
+                           const ModuleSummaryIndex *ImportSummary) {
+  legacy::PassManager passes;
+  passes.add(createTargetTransformInfoWrapperPass(TM->getTargetIRAnalysis()));
+
+  PassManagerBuilder PMB;
+  setUpPassManagerBuilder(PMB, Conf, TM);
+  PMB.ExportSummary = ExportSummary;
+  PMB.ImportSummary = ImportSummary;
   if (IsThinLTO)
     PMB.populateThinLTOPassManager(passes);
   else
@@ -293,6 +298,27 @@ static void runOldPMPasses(Config &Conf, Module &Mod, TargetMachine *TM,
   passes.run(Mod);
 }
 
+/// Runs the part of the regular LTO pipeline that comes before (if
+/// \p PrePartition) or after splitting the module for parallel optimization.
+static void runOldPMPartitionPasses(Config &Conf, Module &Mod,
+                                    TargetMachine *TM, bool PrePartition,
+                                    ModuleSummaryIndex *ExportSummary) {
+  legacy::PassManager passes;
+  passes.add(createTargetTransformInfoWrapperPass(TM->getTargetIRAnalysis()));
+
+  PassManagerBuilder PMB;
+  setUpPassManagerBuilder(PMB, Conf, TM);
+  PMB.ExportSummary = ExportSummary;
+  if (PrePartition) {
+    PMB.populateLTOPrePartitionPassManager(passes);
+  } else {
+    // The partitions come from our own pre-partition passes.
+    PMB.VerifyInput = false;
+    PMB.populateLTOPartitionPassManager(passes);
+  }
+  passes.run(Mod);
+}
+
 bool opt(Config &Conf, TargetMachine *TM, unsigned Task, Module &Mod,
          bool IsThinLTO, ModuleSummaryIndex *ExportSummary,
          const ModuleSummaryIndex *ImportSummary) {
@@ -346,10 +372,16 @@ void codegen(Config &Conf, TargetMachine *TM, AddStreamFn AddStream,
     DwoOut->keep();
 }
 
+/// Splits \p Mod into \p ParallelCodeGenParallelismLevel partitions and
+/// generates code for them in parallel. If \p OptimizePartitions is true, the
+/// partitions are run through the post-partition LTO passes first.
 void splitCodeGen(Config &C, TargetMachine *TM, AddStreamFn AddStream,
                   unsigned ParallelCodeGenParallelismLevel,
-                  std::unique_ptr<Module> Mod) {
-  ThreadPool CodegenThreadPool(ParallelCodeGenParallelismLevel);
+                  std::unique_ptr<Module> Mod, bool OptimizePartitions) {
+  ThreadPool CodegenThreadPool(
+      C.CodeGenThreads
+          ? std::min(C.CodeGenThreads, ParallelCodeGenParallelismLevel)
+          : ParallelCodeGenParallelismLevel);
   unsigned ThreadCount = 0;
   const Target *T = &TM->getTarget();
 
@@ -380,6 +412,15 @@ void splitCodeGen(Config &C, TargetMachine *TM, AddStreamFn AddStream,
               std::unique_ptr<TargetMachine> TM =
                   createTargetMachine(C, T, *MPartInCtx);
 
+              if (OptimizePartitions) {
+                runOldPMPartitionPasses(C, *MPartInCtx, TM.get(),
+                                        /*PrePartition=*/false,
+                                        /*ExportSummary=*/nullptr);
+                if (C.PostOptModuleHook &&
+                    !C.PostOptModuleHook(ThreadId, *MPartInCtx))
+                  return;
+              }
+
               codegen(C, TM.get(), AddStream, ThreadId, *MPartInCtx);
             },
             // Pass BC using std::move to ensure that it get moved rather than
@@ -438,7 +479,16 @@ Error lto::backend(Config &C, AddStreamFn AddStream,
     return DiagFileOrErr.takeError();
   auto DiagnosticOutputFile = std::move(*DiagFileOrErr);
 
-  if (!C.CodeGenOnly) {
+  // With parallel optimization, the function passes run on each partition in
+  // splitCodeGen rather than on the whole module here.
+  bool OptimizePartitions = C.ParallelOptimization && !C.CodeGenOnly &&
+                            ParallelCodeGenParallelismLevel > 1 &&
+                            C.OptPipeline.empty() && !C.UseNewPM;
+
+  if (OptimizePartitions) {
+    runOldPMPartitionPasses(C, *Mod, TM.get(), /*PrePartition=*/true,
+                            /*ExportSummary=*/&CombinedIndex);
+  } else if (!C.CodeGenOnly) {
     if (!opt(C, TM.get(), 0, *Mod, /*IsThinLTO=*/false,
              /*ExportSummary=*/&CombinedIndex, /*ImportSummary=*/nullptr))
       return finalizeOptimizationRemarks(std::move(DiagnosticOutputFile));
@@ -448,7 +498,7 @@ Error lto::backend(Config &C, AddStreamFn AddStream,
     codegen(C, TM.get(), AddStream, 0, *Mod);
   } else {
     splitCodeGen(C, TM.get(), AddStream, ParallelCodeGenParallelismLevel,
-                 std::move(Mod));
+                 std::move(Mod), OptimizePartitions);
   }
   return finalizeOptimizationRemarks(std::move(DiagnosticOutputFile));
 }
@@ -474,32 +524,14 @@ static void dropDeadSymbols(Module &Mod, const GVSummaryMapTy &DefinedGlobals,
   }
 }
 
-Error lto::thinBackend(Config &Conf, unsigned Task, AddStreamFn AddStream,
-                       Module &Mod, const ModuleSummaryIndex &CombinedIndex,
-                       const FunctionImporter::ImportMapTy &ImportList,
-                       const GVSummaryMapTy &DefinedGlobals,
-                       MapVector<StringRef, BitcodeModule> &ModuleMap) {
-  Expected<const Target *> TOrErr = initAndLookupTarget(Conf, Mod);
-  if (!TOrErr)
-    return TOrErr.takeError();
-
-  std::unique_ptr<TargetMachine> TM = createTargetMachine(Conf, *TOrErr, Mod);
-
-  // Setup optimization remarks.
-  auto DiagFileOrErr = lto::setupOptimizationRemarks(
-      Mod.getContext(), Conf.RemarksFilename, Conf.RemarksPasses,
-      Conf.RemarksFormat, Conf.RemarksWithHotness, Task);
-  if (!DiagFileOrErr)
-    return DiagFileOrErr.takeError();
-  auto DiagnosticOutputFile = std::move(*DiagFileOrErr);
-
-  if (Conf.CodeGenOnly) {
-    codegen(Conf, TM.get(), AddStream, Task, Mod);
-    return finalizeOptimizationRemarks(std::move(DiagnosticOutputFile));
-  }
-
+Expected<bool> lto::thinBackendImport(
+    Config &Conf, unsigned Task, Module &Mod,
+    const ModuleSummaryIndex &CombinedIndex,
+    const FunctionImporter::ImportMapTy &ImportList,
+    const GVSummaryMapTy &DefinedGlobals,
+    MapVector<StringRef, BitcodeModule> &ModuleMap) {
   if (Conf.PreOptModuleHook && !Conf.PreOptModuleHook(Task, Mod))
-    return finalizeOptimizationRemarks(std::move(DiagnosticOutputFile));
+    return false;
 
   renameModuleForThinLTO(Mod, CombinedIndex);
 
@@ -508,14 +540,14 @@ Error lto::thinBackend(Config &Conf, unsigned Task, AddStreamFn AddStream,
   thinLTOResolvePrevailingInModule(Mod, DefinedGlobals);
 
   if (Conf.PostPromoteModuleHook && !Conf.PostPromoteModuleHook(Task, Mod))
-    return finalizeOptimizationRemarks(std::move(DiagnosticOutputFile));
+    return false;
 
   if (!DefinedGlobals.empty())
     thinLTOInternalizeModule(Mod, DefinedGlobals);
 
   if (Conf.PostInternalizeModuleHook &&
       !Conf.PostInternalizeModuleHook(Task, Mod))
-    return finalizeOptimizationRemarks(std::move(DiagnosticOutputFile));
+    return false;
 
   auto ModuleLoader = [&](StringRef Identifier) {
     assert(Mod.getContext().isODRUniquingDebugTypes() &&
@@ -529,10 +561,32 @@ Error lto::thinBackend(Config &Conf, unsigned Task, AddStreamFn AddStream,
 
   FunctionImporter Importer(CombinedIndex, ModuleLoader);
   if (Error Err = Importer.importFunctions(Mod, ImportList).takeError())
-    return Err;
+    return std::move(Err);
+
+  return !Conf.PostImportModuleHook || Conf.PostImportModuleHook(Task, Mod);
+}
 
-  if (Conf.PostImportModuleHook && !Conf.PostImportModuleHook(Task, Mod))
+Error lto::thinBackendOptAndCodeGen(Config &Conf, unsigned Task,
+                                    AddStreamFn AddStream, Module &Mod,
+                                    const ModuleSummaryIndex &CombinedIndex) {
+  Expected<const Target *> TOrErr = initAndLookupTarget(Conf, Mod);
+  if (!TOrErr)
+    return TOrErr.takeError();
+
+  std::unique_ptr<TargetMachine> TM = createTargetMachine(Conf, *TOrErr, Mod);
+
+  // Setup optimization remarks.
+  auto DiagFileOrErr = lto::setupOptimizationRemarks(
+      Mod.getContext(), Conf.RemarksFilename, Conf.RemarksPasses,
+      Conf.RemarksFormat, Conf.RemarksWithHotness, Task);
+  if (!DiagFileOrErr)
+    return DiagFileOrErr.takeError();
+  auto DiagnosticOutputFile = std::move(*DiagFileOrErr);
+
+  if (Conf.CodeGenOnly) {
+    codegen(Conf, TM.get(), AddStream, Task, Mod);
     return finalizeOptimizationRemarks(std::move(DiagnosticOutputFile));
+  }
 
   if (!opt(Conf, TM.get(), Task, Mod, /*IsThinLTO=*/true,
            /*ExportSummary=*/nullptr, /*ImportSummary=*/&CombinedIndex))
@@ -541,3 +595,21 @@ Error lto::thinBackend(Config &Conf, unsigned Task, AddStreamFn AddStream,
   codegen(Conf, TM.get(), AddStream, Task, Mod);
   return finalizeOptimizationRemarks(std::move(DiagnosticOutputFile));
 }
+
+Error lto::thinBackend(Config &Conf, unsigned Task, AddStreamFn AddStream,
+                       Module &Mod, const ModuleSummaryIndex &CombinedIndex,
+                       const FunctionImporter::ImportMapTy &ImportList,
+                       const GVSummaryMapTy &DefinedGlobals,
+                       MapVector<StringRef, BitcodeModule> &ModuleMap) {
+  if (Conf.CodeGenOnly)
+    return thinBackendOptAndCodeGen(Conf, Task, AddStream, Mod, CombinedIndex);
+
+  Expected<bool> ContinueOrErr = thinBackendImport(
+      Conf, Task, Mod, CombinedIndex, ImportList, DefinedGlobals, ModuleMap);
+  if (!ContinueOrErr)
+    return ContinueOrErr.takeError();
+  if (!*ContinueOrErr)
+    return Error::success();
+
+  return thinBackendOptAndCodeGen(Conf, Task, AddStream, Mod, CombinedIndex);
+}
@@ -360,6 +360,8 @@ public:
                                   /*FileSize*/ -1,
                                   /*RequiresNullTerminator*/ false);
     close(FD);
+    if (MBOrErr)
+      recordCacheEntryUse(EntryPath, (*MBOrErr)->getBufferSize());
     return MBOrErr;
   }
 
@@ -388,6 +390,8 @@ public:
     EC = sys::fs::rename(TempFilename, EntryPath);
     if (EC)
       sys::fs::remove(TempFilename);
+    else
+      recordCacheEntryUse(EntryPath, OutputBuffer.getBufferSize());
   }
 };
 
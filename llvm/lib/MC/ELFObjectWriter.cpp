@@ -38,6 +38,7 @@
 #include "llvm/MC/StringTableBuilder.h"
 #include "llvm/Support/Allocator.h"
 #include "llvm/Support/Casting.h"
+#include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Compression.h"
 #include "llvm/Support/Endian.h"
 #include "llvm/Support/Error.h"
@@ -45,6 +46,7 @@
 #include "llvm/Support/Host.h"
 #include "llvm/Support/LEB128.h"
 #include "llvm/Support/MathExtras.h"
+#include "llvm/Support/Parallel.h"
 #include "llvm/Support/SMLoc.h"
 #include "llvm/Support/StringSaver.h"
 #include "llvm/Support/SwapByteOrder.h"
@@ -64,6 +66,11 @@ using namespace llvm;
 #undef  DEBUG_TYPE
 #define DEBUG_TYPE "reloc-info"
 
+static cl::opt<bool> ParallelDebugCompression(
+    "parallel-compress-debug-sections", cl::init(false), cl::Hidden,
+    cl::desc("Write and compress the debug sections of ELF objects on "
+             "several threads"));
+
 namespace {
 
 using SectionIndexMapTy = DenseMap<const MCSectionELF *, uint32_t>;
@@ -108,6 +115,17 @@ struct ELFWriter {
     DwoOnly,
   } Mode;
 
+  /// The contents of a debug section, and whether zlib could compress them.
+  struct CompressedSectionData {
+    SmallVector<char, 0> Uncompressed;
+    SmallVector<char, 0> Compressed;
+    bool IsCompressed = false;
+  };
+
+  /// The debug sections that precompressDebugSections compressed ahead of the
+  /// serial walk over the sections.
+  DenseMap<const MCSection *, CompressedSectionData> PrecompressedSections;
+
   static uint64_t SymbolValue(const MCSymbol &Sym, const MCAsmLayout &Layout);
   static bool isInSymtab(const MCAsmLayout &Layout, const MCSymbolELF &Symbol,
                          bool Used, bool Renamed);
@@ -159,7 +177,7 @@ struct ELFWriter {
 
   bool maybeWriteCompression(uint64_t Size,
                              SmallVectorImpl<char> &CompressedContents,
-                             bool ZLibStyle, unsigned Alignment);
+                             DebugCompressionType Type, unsigned Alignment);
 
 public:
   ELFWriter(ELFObjectWriter &OWriter, raw_pwrite_stream &OS,
@@ -211,6 +229,10 @@ public:
                           const SectionIndexMapTy &SectionIndexMap,
                           const SectionOffsetsTy &SectionOffsets);
 
+  bool shouldCompressSection(const MCAssembler &Asm,
+                             const MCSectionELF &Section) const;
+  void precompressDebugSections(const MCAssembler &Asm,
+                                const MCAsmLayout &Layout);
   void writeSectionData(const MCAssembler &Asm, MCSection &Sec,
                         const MCAsmLayout &Layout);
 
@@ -814,9 +836,11 @@ MCSectionELF *ELFWriter::createRelocationSection(MCContext &Ctx,
 
 // Include the debug info compression header.
 bool ELFWriter::maybeWriteCompression(
-    uint64_t Size, SmallVectorImpl<char> &CompressedContents, bool ZLibStyle,
-    unsigned Alignment) {
-  if (ZLibStyle) {
+    uint64_t Size, SmallVectorImpl<char> &CompressedContents,
+    DebugCompressionType Type, unsigned Alignment) {
+  if (Type != DebugCompressionType::GNU) {
+    unsigned ChType = Type == DebugCompressionType::Zstd ? ELF::ELFCOMPRESS_ZSTD
+                                                         : ELF::ELFCOMPRESS_ZLIB;
     uint64_t HdrSize =
         is64Bit() ? sizeof(ELF::Elf32_Chdr) : sizeof(ELF::Elf64_Chdr);
     if (Size <= HdrSize + CompressedContents.size())
@@ -824,13 +848,13 @@ bool ELFWriter::maybeWriteCompression(
     // Platform specific header is followed by compressed data.
     if (is64Bit()) {
       // Write Elf64_Chdr header.
-      write(static_cast<ELF::Elf64_Word>(ELF::ELFCOMPRESS_ZLIB));
+      write(static_cast<ELF::Elf64_Word>(ChType));
       write(static_cast<ELF::Elf64_Word>(0)); // ch_reserved field.
       write(static_cast<ELF::Elf64_Xword>(Size));
       write(static_cast<ELF::Elf64_Xword>(Alignment));
     } else {
       // Write Elf32_Chdr header otherwise.
-      write(static_cast<ELF::Elf32_Word>(ELF::ELFCOMPRESS_ZLIB));
+      write(static_cast<ELF::Elf32_Word>(ChType));
       write(static_cast<ELF::Elf32_Word>(Size));
       write(static_cast<ELF::Elf32_Word>(Alignment));
     }
@@ -847,6 +871,68 @@ bool ELFWriter::maybeWriteCompression(
   return true;
 }
 
+bool ELFWriter::shouldCompressSection(const MCAssembler &Asm,
+                                      const MCSectionELF &Section) const {
+  StringRef SectionName = Section.getSectionName();
+  const MCAsmInfo *MAI = Asm.getContext().getAsmInfo();
+
+  // Compressing debug_frame requires handling alignment fragments which is
+  // more work (possibly generalizing MCAssembler.cpp:writeFragment to allow
+  // for writing to arbitrary buffers) for little benefit.
+  bool CompressionEnabled =
+      MAI->compressDebugSections() != DebugCompressionType::None;
+  return CompressionEnabled && SectionName.startswith(".debug_") &&
+         SectionName != ".debug_frame";
+}
+
+/// Writes the contents of \p Sec into \p Data and compresses them.
+static void compressSectionData(const MCAssembler &Asm, const MCSection &Sec,
+                                const MCAsmLayout &Layout,
+                                ELFWriter::CompressedSectionData &Data) {
+  raw_svector_ostream VecOS(Data.Uncompressed);
+  Asm.writeSectionData(VecOS, &Sec, Layout);
+
+  StringRef Uncompressed(Data.Uncompressed.data(), Data.Uncompressed.size());
+  Error E = Asm.getContext().getAsmInfo()->compressDebugSections() ==
+                    DebugCompressionType::Zstd
+                ? zstd::compress(Uncompressed, Data.Compressed)
+                : zlib::compress(Uncompressed, Data.Compressed);
+  if (E) {
+    consumeError(std::move(E));
+    return;
+  }
+  Data.IsCompressed = true;
+}
+
+// Writing a debug section out and compressing it only reads the layout, so the
+// sections of a large object can be compressed concurrently. Renaming the
+// sections and writing them to the output stream stays serial, in
+// writeSectionData, which keeps the object identical to a serial run.
+void ELFWriter::precompressDebugSections(const MCAssembler &Asm,
+                                         const MCAsmLayout &Layout) {
+  std::vector<const MCSectionELF *> Sections;
+  for (const MCSection &Sec : Asm) {
+    const auto &Section = static_cast<const MCSectionELF &>(Sec);
+    if (Mode == NonDwoOnly && isDwoSection(Section))
+      continue;
+    if (Mode == DwoOnly && !isDwoSection(Section))
+      continue;
+    if (shouldCompressSection(Asm, Section))
+      Sections.push_back(&Section);
+  }
+  if (Sections.size() < 2)
+    return;
+
+  std::vector<CompressedSectionData> Data(Sections.size());
+  parallel::for_each_n(parallel::par, size_t(0), Sections.size(),
+                       [&](size_t I) {
+                         compressSectionData(Asm, *Sections[I], Layout,
+                                             Data[I]);
+                       });
+  for (size_t I = 0, E = Sections.size(); I != E; ++I)
+    PrecompressedSections[Sections[I]] = std::move(Data[I]);
+}
+
 void ELFWriter::writeSectionData(const MCAssembler &Asm, MCSection &Sec,
                                  const MCAsmLayout &Layout) {
   MCSectionELF &Section = static_cast<MCSectionELF &>(Sec);
@@ -855,43 +941,38 @@ void ELFWriter::writeSectionData(const MCAssembler &Asm, MCSection &Sec,
   auto &MC = Asm.getContext();
   const auto &MAI = MC.getAsmInfo();
 
-  // Compressing debug_frame requires handling alignment fragments which is
-  // more work (possibly generalizing MCAssembler.cpp:writeFragment to allow
-  // for writing to arbitrary buffers) for little benefit.
-  bool CompressionEnabled =
-      MAI->compressDebugSections() != DebugCompressionType::None;
-  if (!CompressionEnabled || !SectionName.startswith(".debug_") ||
-      SectionName == ".debug_frame") {
+  if (!shouldCompressSection(Asm, Section)) {
     Asm.writeSectionData(W.OS, &Section, Layout);
     return;
   }
 
   assert((MAI->compressDebugSections() == DebugCompressionType::Z ||
-          MAI->compressDebugSections() == DebugCompressionType::GNU) &&
-         "expected zlib or zlib-gnu style compression");
-
-  SmallVector<char, 128> UncompressedData;
-  raw_svector_ostream VecOS(UncompressedData);
-  Asm.writeSectionData(VecOS, &Section, Layout);
-
-  SmallVector<char, 128> CompressedContents;
-  if (Error E = zlib::compress(
-          StringRef(UncompressedData.data(), UncompressedData.size()),
-          CompressedContents)) {
-    consumeError(std::move(E));
+          MAI->compressDebugSections() == DebugCompressionType::GNU ||
+          MAI->compressDebugSections() == DebugCompressionType::Zstd) &&
+         "expected zlib, zlib-gnu or zstd style compression");
+
+  CompressedSectionData Data;
+  auto It = PrecompressedSections.find(&Section);
+  if (It != PrecompressedSections.end())
+    Data = std::move(It->second);
+  else
+    compressSectionData(Asm, Section, Layout, Data);
+  SmallVectorImpl<char> &UncompressedData = Data.Uncompressed;
+  SmallVectorImpl<char> &CompressedContents = Data.Compressed;
+  if (!Data.IsCompressed) {
     W.OS << UncompressedData;
     return;
   }
 
-  bool ZlibStyle = MAI->compressDebugSections() == DebugCompressionType::Z;
-  if (!maybeWriteCompression(UncompressedData.size(), CompressedContents,
-                             ZlibStyle, Sec.getAlignment())) {
+  DebugCompressionType Type = MAI->compressDebugSections();
+  if (!maybeWriteCompression(UncompressedData.size(), CompressedContents, Type,
+                             Sec.getAlignment())) {
     W.OS << UncompressedData;
     return;
   }
 
-  if (ZlibStyle) {
-    // Set the compressed flag. That is zlib style.
+  if (Type != DebugCompressionType::GNU) {
+    // Set the compressed flag. That is zlib or zstd style.
     Section.setFlags(Section.getFlags() | ELF::SHF_COMPRESSED);
     // Alignment field should reflect the requirements of
     // the compressed section header.
@@ -1090,6 +1171,8 @@ uint64_t ELFWriter::writeObject(MCAssembler &Asm, const MCAsmLayout &Layout) {
   writeHeader(Asm);
 
   // ... then the sections ...
+  if (ParallelDebugCompression)
+    precompressDebugSections(Asm, Layout);
   SectionOffsetsTy SectionOffsets;
   std::vector<MCSectionELF *> Groups;
   std::vector<MCSectionELF *> Relocations;
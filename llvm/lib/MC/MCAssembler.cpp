@@ -67,6 +67,8 @@ STATISTIC(FragmentLayouts, "Number of fragment layouts");
 STATISTIC(ObjectBytes, "Number of emitted object file bytes");
 STATISTIC(RelaxationSteps, "Number of assembler layout and relaxation steps");
 STATISTIC(RelaxedInstructions, "Number of relaxed instructions");
+STATISTIC(SectionsWithoutRelaxation,
+          "Number of sections laid out without a relaxation pass");
 STATISTIC(PaddingFragmentsRelaxations,
           "Number of Padding Fragments relaxations");
 STATISTIC(PaddingFragmentsBytes,
@@ -109,6 +111,7 @@ void MCAssembler::reset() {
   IncrementalLinkerCompatible = false;
   ELFHeaderEFlags = 0;
   LOHContainer.reset();
+  RelaxableFragments.clear();
   VersionInfo.Major = 0;
   VersionInfo.SDKVersion = VersionTuple();
 
@@ -781,6 +784,31 @@ void MCAssembler::layout(MCAsmLayout &Layout) {
       Frag.setLayoutOrder(FragmentIndex++);
   }
 
+  // Collect the fragments that relaxation may resize. Data, fill, align and
+  // org fragments never change size once laid out, so straight-line code that
+  // needs no relaxation is laid out in a single pass without visiting them.
+  RelaxableFragments.clear();
+  RelaxableFragments.resize(SectionIndex);
+  for (MCSection &Sec : *this) {
+    for (MCFragment &Frag : Sec) {
+      switch (Frag.getKind()) {
+      default:
+        break;
+      case MCFragment::FT_Relaxable:
+      case MCFragment::FT_Dwarf:
+      case MCFragment::FT_DwarfFrame:
+      case MCFragment::FT_LEB:
+      case MCFragment::FT_Padding:
+      case MCFragment::FT_CVInlineLines:
+      case MCFragment::FT_CVDefRange:
+        RelaxableFragments[Sec.getOrdinal()].push_back(&Frag);
+        break;
+      }
+    }
+    if (RelaxableFragments[Sec.getOrdinal()].empty())
+      ++stats::SectionsWithoutRelaxation;
+  }
+
   // Layout until everything fits.
   while (layoutOnce(Layout))
     if (getContext().hadError())
@@ -1045,8 +1073,8 @@ bool MCAssembler::layoutSectionOnce(MCAsmLayout &Layout, MCSection &Sec) {
   // invalidated because their offset is going to change.
   MCFragment *FirstRelaxedFragment = nullptr;
 
-  // Attempt to relax all the fragments in the section.
-  for (MCSection::iterator I = Sec.begin(), IE = Sec.end(); I != IE; ++I) {
+  // Attempt to relax all the fragments in the section that may change size.
+  for (MCFragment *I : RelaxableFragments[Sec.getOrdinal()]) {
     // Check if this is a fragment that needs relaxation.
     bool RelaxedFrag = false;
     switch(I->getKind()) {
@@ -1081,7 +1109,7 @@ bool MCAssembler::layoutSectionOnce(MCAsmLayout &Layout, MCSection &Sec) {
       break;
     }
     if (RelaxedFrag && !FirstRelaxedFragment)
-      FirstRelaxedFragment = &*I;
+      FirstRelaxedFragment = I;
   }
   if (FirstRelaxedFragment) {
     Layout.invalidateFragmentsFrom(FirstRelaxedFragment);
@@ -1096,6 +1124,8 @@ bool MCAssembler::layoutOnce(MCAsmLayout &Layout) {
   bool WasRelaxed = false;
   for (iterator it = begin(), ie = end(); it != ie; ++it) {
     MCSection &Sec = *it;
+    if (RelaxableFragments[Sec.getOrdinal()].empty())
+      continue;
     while (layoutSectionOnce(Layout, Sec))
       WasRelaxed = true;
   }
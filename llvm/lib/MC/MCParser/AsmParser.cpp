@@ -201,6 +201,7 @@ public:
   }
 
   void addAliasForDirective(StringRef Directive, StringRef Alias) override {
+    assert(Directive.startswith(".") && "directives start with '.'");
     DirectiveKindMap[Directive] = DirectiveKindMap[Alias];
   }
 
@@ -1733,12 +1734,15 @@ bool AsmParser::parseStatement(ParseStatementInfo &Info,
 
   // Handle conditional assembly here before checking for skipping.  We
   // have to do this so that .endif isn't skipped in a ".if 0" block for
-  // example.
-  StringMap<DirectiveKind>::const_iterator DirKindIt =
-      DirectiveKindMap.find(IDVal);
-  DirectiveKind DirKind = (DirKindIt == DirectiveKindMap.end())
-                              ? DK_NO_DIRECTIVE
-                              : DirKindIt->getValue();
+  // example. All directives start with '.', so instructions and labels, which
+  // make up most statements, skip hashing their name into the map.
+  DirectiveKind DirKind = DK_NO_DIRECTIVE;
+  if (IDVal.startswith(".")) {
+    StringMap<DirectiveKind>::const_iterator DirKindIt =
+        DirectiveKindMap.find(IDVal);
+    if (DirKindIt != DirectiveKindMap.end())
+      DirKind = DirKindIt->getValue();
+  }
   switch (DirKind) {
   default:
     break;
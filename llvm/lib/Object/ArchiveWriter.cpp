@@ -22,6 +22,7 @@
 #include "llvm/Support/Errc.h"
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/Format.h"
+#include "llvm/Support/Parallel.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/ToolOutputFile.h"
 #include "llvm/Support/raw_ostream.h"
@@ -451,7 +452,25 @@ computeMemberData(raw_ostream &StringTable, raw_ostream &SymNames,
       Entry.second = Entry.second > 1 ? 1 : 0;
   }
 
-  for (const NewArchiveMember &M : NewMembers) {
+  // Reading the symbols of a member is the expensive part of building the
+  // symbol table, in particular for bitcode members, and doesn't depend on
+  // other members. So read them in parallel into per-member buffers, and
+  // concatenate them in member order below.
+  std::vector<std::string> MemberSymNames(NewMembers.size());
+  std::vector<Optional<Expected<std::vector<unsigned>>>> MemberSymbols(
+      NewMembers.size());
+  std::vector<char> MemberHasObject(NewMembers.size());
+  parallel::for_each_n(
+      parallel::par, size_t(0), NewMembers.size(), [&](size_t I) {
+        raw_string_ostream OS(MemberSymNames[I]);
+        bool MemberIsObject = false;
+        MemberSymbols[I].emplace(getSymbols(
+            NewMembers[I].Buf->getMemBufferRef(), OS, MemberIsObject));
+        MemberHasObject[I] = MemberIsObject;
+      });
+
+  for (size_t I = 0, E = NewMembers.size(); I != E; ++I) {
+    const NewArchiveMember &M = NewMembers[I];
     std::string Header;
     raw_string_ostream Out(Header);
 
@@ -477,10 +496,19 @@ computeMemberData(raw_ostream &StringTable, raw_ostream &SymNames,
                       ModTime, Buf.getBufferSize() + MemberPadding);
     Out.flush();
 
-    Expected<std::vector<unsigned>> Symbols =
-        getSymbols(Buf, SymNames, HasObject);
-    if (auto E = Symbols.takeError())
+    Expected<std::vector<unsigned>> &Symbols = *MemberSymbols[I];
+    if (auto E = Symbols.takeError()) {
+      for (size_t J = I + 1; J != NewMembers.size(); ++J)
+        consumeError(MemberSymbols[J]->takeError());
       return std::move(E);
+    }
+
+    // Symbol offsets are relative to the start of the member's names.
+    uint64_t SymNamesBase = SymNames.tell();
+    for (unsigned &Offset : *Symbols)
+      Offset += SymNamesBase;
+    SymNames << MemberSymNames[I];
+    HasObject |= MemberHasObject[I];
 
     Pos += Header.size() + Data.size() + Padding.size();
     Ret.push_back({std::move(*Symbols), std::move(Header), Data, Padding});
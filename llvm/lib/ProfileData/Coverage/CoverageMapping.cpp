@@ -27,6 +27,8 @@
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/ManagedStatic.h"
 #include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Threading.h"
+#include "llvm/Support/ThreadPool.h"
 #include "llvm/Support/raw_ostream.h"
 #include <algorithm>
 #include <cassert>
@@ -248,24 +250,109 @@ Error CoverageMapping::loadFunctionRecord(
   if (!RecordProvenance[FilenamesHash].insert(hash_value(OrigFuncName)).second)
     return Error::success();
 
+  // Index the record by each of the files it uses, once per file.
+  unsigned RecordIndex = Functions.size();
+  for (StringRef Filename : Record.Filenames) {
+    auto &RecordIndices = FilenameHash2RecordIndices[hash_value(Filename)];
+    if (RecordIndices.empty() || RecordIndices.back() != RecordIndex)
+      RecordIndices.push_back(RecordIndex);
+  }
+
   Functions.push_back(std::move(Function));
   return Error::success();
 }
 
+namespace {
+
+/// A coverage mapping record which owns its expressions and regions, so that
+/// it outlives the iteration of the reader which decoded it.
+struct DecodedMappingRecord {
+  StringRef FunctionName;
+  uint64_t FunctionHash;
+  std::vector<StringRef> Filenames;
+  std::vector<CounterExpression> Expressions;
+  std::vector<CounterMappingRegion> MappingRegions;
+
+  DecodedMappingRecord(const CoverageMappingRecord &Record)
+      : FunctionName(Record.FunctionName), FunctionHash(Record.FunctionHash),
+        Filenames(Record.Filenames.begin(), Record.Filenames.end()),
+        Expressions(Record.Expressions.begin(), Record.Expressions.end()),
+        MappingRegions(Record.MappingRegions.begin(),
+                       Record.MappingRegions.end()) {}
+
+  CoverageMappingRecord getRecord() const {
+    return {FunctionName, FunctionHash, Filenames, Expressions,
+            MappingRegions};
+  }
+};
+
+} // end anonymous namespace
+
+/// Decode all the records of \p Reader into \p Records.
+static Error decodeMappingRecords(CoverageMappingReader &Reader,
+                                  std::vector<DecodedMappingRecord> &Records) {
+  for (auto RecordOrErr : Reader) {
+    if (Error E = RecordOrErr.takeError())
+      return E;
+    Records.emplace_back(*RecordOrErr);
+  }
+  return Error::success();
+}
+
 Expected<std::unique_ptr<CoverageMapping>> CoverageMapping::load(
     ArrayRef<std::unique_ptr<CoverageMappingReader>> CoverageReaders,
     IndexedInstrProfReader &ProfileReader) {
   auto Coverage = std::unique_ptr<CoverageMapping>(new CoverageMapping());
 
-  for (const auto &CoverageReader : CoverageReaders) {
-    for (auto RecordOrErr : *CoverageReader) {
-      if (Error E = RecordOrErr.takeError())
-        return std::move(E);
-      const auto &Record = *RecordOrErr;
-      if (Error E = Coverage->loadFunctionRecord(Record, ProfileReader))
-        return std::move(E);
+  unsigned NumThreads =
+      std::min(heavyweight_hardware_concurrency(),
+               unsigned(CoverageReaders.size()));
+  if (NumThreads < 2 || !llvm_is_multithreaded()) {
+    for (const auto &CoverageReader : CoverageReaders) {
+      for (auto RecordOrErr : *CoverageReader) {
+        if (Error E = RecordOrErr.takeError())
+          return std::move(E);
+        const auto &Record = *RecordOrErr;
+        if (Error E = Coverage->loadFunctionRecord(Record, ProfileReader))
+          return std::move(E);
+      }
+    }
+    return std::move(Coverage);
+  }
+
+  // The readers are independent, so decode their records in parallel. The
+  // profile reader isn't thread-safe, and the records have to be added in a
+  // deterministic order, so they are then loaded one reader after the other.
+  std::vector<std::vector<DecodedMappingRecord>> Decoded(
+      CoverageReaders.size());
+  std::vector<Optional<Error>> Errors(CoverageReaders.size());
+  {
+    ThreadPool Pool(NumThreads);
+    for (unsigned I = 0, E = CoverageReaders.size(); I != E; ++I)
+      Pool.async([&, I]() {
+        Errors[I] = decodeMappingRecords(*CoverageReaders[I], Decoded[I]);
+      });
+    Pool.wait();
+  }
+
+  Error Err = Error::success();
+  for (unsigned I = 0, E = CoverageReaders.size(); I != E; ++I) {
+    // The records decoded before an error are loaded, as in the serial case.
+    for (const DecodedMappingRecord &Record : Decoded[I]) {
+      if (Err)
+        break;
+      Err = Coverage->loadFunctionRecord(Record.getRecord(), ProfileReader);
     }
+    if (!Err)
+      Err = std::move(*Errors[I]);
+    else
+      consumeError(std::move(*Errors[I]));
+    // The records of this reader are no longer needed.
+    Decoded[I].clear();
+    Decoded[I].shrink_to_fit();
   }
+  if (Err)
+    return std::move(Err);
 
   return std::move(Coverage);
 }
@@ -557,6 +644,15 @@ public:
 
 } // end anonymous namespace
 
+ArrayRef<unsigned> CoverageMapping::getImpreciseRecordIndicesForFilename(
+    StringRef Filename) const {
+  size_t FilenameHash = hash_value(Filename);
+  auto RecordIt = FilenameHash2RecordIndices.find(FilenameHash);
+  if (RecordIt == FilenameHash2RecordIndices.end())
+    return {};
+  return RecordIt->second;
+}
+
 std::vector<StringRef> CoverageMapping::getUniqueSourceFiles() const {
   std::vector<StringRef> Filenames;
   for (const auto &Function : getCoveredFunctions())
@@ -607,7 +703,12 @@ CoverageData CoverageMapping::getCoverageForFile(StringRef Filename) const {
   CoverageData FileCoverage(Filename);
   std::vector<CountedRegion> Regions;
 
-  for (const auto &Function : Functions) {
+  // Look up the function records in the given file. Due to hash collisions on
+  // the filename, we may get back some records that are not in the file.
+  ArrayRef<unsigned> RecordIndices =
+      getImpreciseRecordIndicesForFilename(Filename);
+  for (unsigned RecordIndex : RecordIndices) {
+    const FunctionRecord &Function = Functions[RecordIndex];
     auto MainFileID = findMainViewFileID(Filename, Function);
     auto FileIDs = gatherFileIDs(Filename, Function);
     for (const auto &CR : Function.CountedRegions)
@@ -627,7 +728,12 @@ CoverageData CoverageMapping::getCoverageForFile(StringRef Filename) const {
 std::vector<InstantiationGroup>
 CoverageMapping::getInstantiationGroups(StringRef Filename) const {
   FunctionInstantiationSetCollector InstantiationSetCollector;
-  for (const auto &Function : Functions) {
+  // Look up the function records in the given file. Due to hash collisions on
+  // the filename, we may get back some records that are not in the file.
+  ArrayRef<unsigned> RecordIndices =
+      getImpreciseRecordIndicesForFilename(Filename);
+  for (unsigned RecordIndex : RecordIndices) {
+    const FunctionRecord &Function = Functions[RecordIndex];
     auto MainFileID = findMainViewFileID(Filename, Function);
     if (!MainFileID)
       continue;
@@ -621,11 +621,25 @@ void InstrProfValueSiteRecord::merge(InstrProfValueSiteRecord &Input,
   }
 }
 
-void InstrProfValueSiteRecord::scale(uint64_t Weight,
+// Scale Count by N / D, rounding down. Count * N is not computed directly, so
+// that scaling by a fraction does not overflow.
+static uint64_t scaleCount(uint64_t Count, uint64_t N, uint64_t D,
+                           bool &Overflowed) {
+  assert(D != 0 && "D cannot be 0");
+  if (D == 1)
+    return SaturatingMultiply(Count, N, &Overflowed);
+  bool RemOverflowed;
+  uint64_t Rem = SaturatingMultiply(Count % D, N, &RemOverflowed) / D;
+  uint64_t Res = SaturatingMultiplyAdd(Count / D, N, Rem, &Overflowed);
+  Overflowed |= RemOverflowed;
+  return Res;
+}
+
+void InstrProfValueSiteRecord::scale(uint64_t N, uint64_t D,
                                      function_ref<void(instrprof_error)> Warn) {
   for (auto I = ValueData.begin(), IE = ValueData.end(); I != IE; ++I) {
     bool Overflowed;
-    I->Count = SaturatingMultiply(I->Count, Weight, &Overflowed);
+    I->Count = scaleCount(I->Count, N, D, Overflowed);
     if (Overflowed)
       Warn(instrprof_error::counter_overflow);
   }
@@ -674,22 +688,23 @@ void InstrProfRecord::merge(InstrProfRecord &Other, uint64_t Weight,
 }
 
 void InstrProfRecord::scaleValueProfData(
-    uint32_t ValueKind, uint64_t Weight,
+    uint32_t ValueKind, uint64_t N, uint64_t D,
     function_ref<void(instrprof_error)> Warn) {
   for (auto &R : getValueSitesForKind(ValueKind))
-    R.scale(Weight, Warn);
+    R.scale(N, D, Warn);
 }
 
-void InstrProfRecord::scale(uint64_t Weight,
+void InstrProfRecord::scale(uint64_t N, uint64_t D,
                             function_ref<void(instrprof_error)> Warn) {
+  assert(D != 0 && "D cannot be 0");
   for (auto &Count : this->Counts) {
     bool Overflowed;
-    Count = SaturatingMultiply(Count, Weight, &Overflowed);
+    Count = scaleCount(Count, N, D, Overflowed);
     if (Overflowed)
       Warn(instrprof_error::counter_overflow);
   }
   for (uint32_t Kind = IPVK_First; Kind <= IPVK_Last; ++Kind)
-    scaleValueProfData(Kind, Weight, Warn);
+    scaleValueProfData(Kind, N, D, Warn);
 }
 
 // Map indirect call target name hash to name string.
@@ -87,6 +87,15 @@ void LineLocation::print(raw_ostream &OS) const {
     OS << "." << Discriminator;
 }
 
+std::string SampleContext::getCalleeContext(StringRef CallerContext,
+                                            const LineLocation &CallSite,
+                                            StringRef CalleeName) {
+  std::string Context;
+  raw_string_ostream OS(Context);
+  OS << CallerContext << ":" << CallSite << " @ " << CalleeName;
+  return OS.str();
+}
+
 raw_ostream &llvm::sampleprof::operator<<(raw_ostream &OS,
                                           const LineLocation &Loc) {
   Loc.print(OS);
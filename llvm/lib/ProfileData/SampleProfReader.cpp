@@ -211,6 +211,9 @@ std::error_code SampleProfileReaderText::read() {
     //
     // The only requirement we place on the identifier, then, is that it
     // should not begin with a number.
+    //
+    // The profile of a function in a given calling context has the context
+    // in brackets instead, and is keyed by the context.
     if ((*LineIt)[0] != ' ') {
       uint64_t NumSamples, NumHeadSamples;
       StringRef FName;
@@ -219,9 +222,19 @@ std::error_code SampleProfileReaderText::read() {
                     "Expected 'mangled_name:NUM:NUM', found " + *LineIt);
         return sampleprof_error::malformed;
       }
+      bool IsContext = FName.size() > 2 && FName.front() == '[' &&
+                       FName.back() == ']';
+      if (IsContext)
+        FName = FName.drop_front().drop_back();
       Profiles[FName] = FunctionSamples();
       FunctionSamples &FProfile = Profiles[FName];
-      FProfile.setName(FName);
+      if (IsContext) {
+        FProfile.setName(SampleContext::getLeafName(FName));
+        FProfile.setContext(FName);
+        ProfileIsCS = true;
+      } else {
+        FProfile.setName(FName);
+      }
       MergeResult(Result, FProfile.addTotalSamples(NumSamples));
       MergeResult(Result, FProfile.addHeadSamples(NumHeadSamples));
       InlineStack.clear();
@@ -83,7 +83,11 @@ std::error_code SampleProfileWriterCompactBinary::write(
 /// it needs to be parsed by the SampleProfileReaderText class.
 std::error_code SampleProfileWriterText::write(const FunctionSamples &S) {
   auto &OS = *OutputStream;
-  OS << S.getName() << ":" << S.getTotalSamples();
+  if (!S.getContext().empty())
+    OS << "[" << S.getContext() << "]";
+  else
+    OS << S.getName();
+  OS << ":" << S.getTotalSamples();
   if (Indent == 0)
     OS << ":" << S.getHeadSamples();
   OS << "\n";
@@ -325,12 +329,17 @@ std::error_code SampleProfileWriterBinary::writeBody(const FunctionSamples &S) {
 ///
 /// \returns true if the samples were written successfully, false otherwise.
 std::error_code SampleProfileWriterBinary::write(const FunctionSamples &S) {
+  // Context-sensitive profiles are only supported by the text format.
+  if (!S.getContext().empty())
+    return sampleprof_error::unsupported_writing_format;
   encodeULEB128(S.getHeadSamples(), *OutputStream);
   return writeBody(S);
 }
 
 std::error_code
 SampleProfileWriterCompactBinary::write(const FunctionSamples &S) {
+  if (!S.getContext().empty())
+    return sampleprof_error::unsupported_writing_format;
   uint64_t Offset = OutputStream->tell();
   StringRef Name = S.getName();
   FuncOffsetTable[Name] = Offset;
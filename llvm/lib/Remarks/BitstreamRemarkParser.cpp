@@ -0,0 +1,335 @@
+//===- BitstreamRemarkParser.cpp ------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// This file provides utility methods used by clients that want to use the
+// parser for remark diagnostics in LLVM.
+//
+//===----------------------------------------------------------------------===//
+
+#include "BitstreamRemarkParser.h"
+#include "llvm/Remarks/RemarkParser.h"
+
+using namespace llvm;
+using namespace llvm::remarks;
+
+static Error malformed(const char *Msg) {
+  return createStringError(std::make_error_code(std::errc::invalid_argument),
+                           Msg);
+}
+
+static Error parseContainerMagic(BitstreamCursor &Stream) {
+  for (const char C : ContainerMagic) {
+    Expected<SimpleBitstreamCursor::word_t> MaybeByte = Stream.Read(8);
+    if (!MaybeByte)
+      return MaybeByte.takeError();
+    if (static_cast<char>(*MaybeByte) != C)
+      return malformed("Unknown magic number: expecting RMRK.");
+  }
+  return Error::success();
+}
+
+/// Parse the META_BLOCK the cursor \p Stream just entered, checking that the
+/// container is of type \p ExpectedType. If the block references an external
+/// file, its path is stored in \p ExternalFilename.
+static Error parseMetaBlock(BitstreamCursor &Stream,
+                            BitstreamRemarkContainerType ExpectedType,
+                            Optional<StringRef> &ExternalFilename) {
+  if (Error E = Stream.EnterSubBlock(META_BLOCK_ID))
+    return E;
+
+  SmallVector<uint64_t, 4> Record;
+  bool HasContainerInfo = false;
+  while (true) {
+    Expected<BitstreamEntry> MaybeEntry = Stream.advance();
+    if (!MaybeEntry)
+      return MaybeEntry.takeError();
+    const BitstreamEntry &Entry = *MaybeEntry;
+
+    if (Entry.Kind == BitstreamEntry::EndBlock)
+      break;
+    if (Entry.Kind == BitstreamEntry::Error)
+      return malformed("Error while parsing META_BLOCK: malformed block.");
+    if (Entry.Kind == BitstreamEntry::SubBlock) {
+      // Skip the blocks we don't know about.
+      if (Error E = Stream.SkipBlock())
+        return E;
+      continue;
+    }
+
+    Record.clear();
+    StringRef Blob;
+    Expected<unsigned> MaybeCode = Stream.readRecord(Entry.ID, Record, &Blob);
+    if (!MaybeCode)
+      return MaybeCode.takeError();
+
+    switch (*MaybeCode) {
+    case RECORD_META_CONTAINER_INFO:
+      if (Record.size() != 2)
+        return malformed("Error while parsing META_BLOCK: malformed container "
+                         "info record.");
+      if (Record[0] != CurrentContainerVersion)
+        return malformed("Error while parsing META_BLOCK: unsupported "
+                         "container version.");
+      if (Record[1] != static_cast<uint64_t>(ExpectedType))
+        return malformed("Error while parsing META_BLOCK: unexpected "
+                         "container type.");
+      HasContainerInfo = true;
+      break;
+    case RECORD_META_REMARK_VERSION:
+      if (Record.size() != 1)
+        return malformed("Error while parsing META_BLOCK: malformed remark "
+                         "version record.");
+      if (Record[0] != remarks::Version)
+        return malformed("Error while parsing META_BLOCK: unsupported remark "
+                         "version.");
+      break;
+    case RECORD_META_EXTERNAL_FILE:
+      ExternalFilename = Blob;
+      break;
+    default:
+      // Ignore the records we don't know about.
+      break;
+    }
+  }
+
+  if (!HasContainerInfo)
+    return malformed(
+        "Error while parsing META_BLOCK: missing container info record.");
+  return Error::success();
+}
+
+/// Parse the entry at the cursor \p Stream, which has to be the start of the
+/// block \p BlockID.
+static Error expectSubBlock(BitstreamCursor &Stream, unsigned BlockID,
+                            const char *Msg) {
+  Expected<BitstreamEntry> MaybeEntry = Stream.advance();
+  if (!MaybeEntry)
+    return MaybeEntry.takeError();
+  if (MaybeEntry->Kind != BitstreamEntry::SubBlock ||
+      MaybeEntry->ID != BlockID)
+    return malformed(Msg);
+  return Error::success();
+}
+
+Error BitstreamRemarkParser::parseHeader() {
+  if (Error E = parseContainerMagic(Stream))
+    return E;
+
+  while (true) {
+    Expected<BitstreamEntry> MaybeEntry = Stream.advance();
+    if (!MaybeEntry)
+      return MaybeEntry.takeError();
+    if (MaybeEntry->Kind != BitstreamEntry::SubBlock)
+      return malformed("Error while parsing BLOCKINFO_BLOCK: expecting "
+                       "BLOCKINFO_BLOCK or META_BLOCK.");
+
+    if (MaybeEntry->ID == META_BLOCK_ID)
+      break;
+    if (MaybeEntry->ID != bitc::BLOCKINFO_BLOCK_ID)
+      return malformed("Error while parsing BLOCKINFO_BLOCK: expecting "
+                       "BLOCKINFO_BLOCK or META_BLOCK.");
+
+    Expected<Optional<BitstreamBlockInfo>> MaybeBlockInfo =
+        Stream.ReadBlockInfoBlock();
+    if (!MaybeBlockInfo)
+      return MaybeBlockInfo.takeError();
+    if (!*MaybeBlockInfo)
+      return malformed(
+          "Error while parsing BLOCKINFO_BLOCK: malformed block.");
+    BlockInfo = std::move(*MaybeBlockInfo);
+    Stream.setBlockInfo(&*BlockInfo);
+  }
+
+  Optional<StringRef> ExternalFilename;
+  return parseMetaBlock(Stream, BitstreamRemarkContainerType::RemarksFile,
+                        ExternalFilename);
+}
+
+Expected<bool> BitstreamRemarkParser::hasNextRemark() {
+  if (!ParsedHeader) {
+    if (Error E = parseHeader())
+      return std::move(E);
+    ParsedHeader = true;
+  }
+  return !Stream.AtEndOfStream();
+}
+
+void BitstreamRemarkParser::skipToEnd() {
+  ParsedHeader = true;
+  // Jumping to the end of the buffer doesn't read anything, so it can't fail.
+  cantFail(Stream.JumpToBit(Stream.getBitcodeBytes().size() * 8));
+}
+
+Expected<StringRef> BitstreamRemarkParser::getString(uint64_t ID) const {
+  if (ID >= Strings.size())
+    return createStringError(
+        std::make_error_code(std::errc::invalid_argument),
+        "String with index %u is out of bounds (size = %u).",
+        static_cast<unsigned>(ID), static_cast<unsigned>(Strings.size()));
+  return Strings[ID];
+}
+
+Expected<RemarkLocation>
+BitstreamRemarkParser::getLocation(uint64_t FileID, uint64_t Line,
+                                   uint64_t Column) const {
+  Expected<StringRef> File = getString(FileID);
+  if (!File)
+    return File.takeError();
+  return RemarkLocation{*File, static_cast<unsigned>(Line),
+                        static_cast<unsigned>(Column)};
+}
+
+Error BitstreamRemarkParser::parseRemarkBlock() {
+  if (Error E = expectSubBlock(
+          Stream, REMARK_BLOCK_ID,
+          "Error while parsing REMARK_BLOCK: expecting REMARK_BLOCK."))
+    return E;
+  if (Error E = Stream.EnterSubBlock(REMARK_BLOCK_ID))
+    return E;
+
+  TheRemark = Remark();
+  TmpArgs.clear();
+  bool HasHeader = false;
+  while (true) {
+    Expected<BitstreamEntry> MaybeEntry = Stream.advance();
+    if (!MaybeEntry)
+      return MaybeEntry.takeError();
+    const BitstreamEntry &Entry = *MaybeEntry;
+
+    if (Entry.Kind == BitstreamEntry::EndBlock)
+      break;
+    if (Entry.Kind == BitstreamEntry::Error)
+      return malformed("Error while parsing REMARK_BLOCK: malformed block.");
+    if (Entry.Kind == BitstreamEntry::SubBlock) {
+      // Skip the blocks we don't know about.
+      if (Error E = Stream.SkipBlock())
+        return E;
+      continue;
+    }
+
+    Record.clear();
+    StringRef Blob;
+    Expected<unsigned> MaybeCode = Stream.readRecord(Entry.ID, Record, &Blob);
+    if (!MaybeCode)
+      return MaybeCode.takeError();
+
+    switch (*MaybeCode) {
+    case RECORD_REMARK_STRING:
+      Strings.push_back(Blob);
+      break;
+    case RECORD_REMARK_HEADER: {
+      if (Record.size() != 4)
+        return malformed(
+            "Error while parsing REMARK_BLOCK: malformed header record.");
+      if (Record[0] > static_cast<uint64_t>(Type::LastTypeValue))
+        return malformed(
+            "Error while parsing REMARK_BLOCK: unknown remark type.");
+      TheRemark.RemarkType = static_cast<Type>(Record[0]);
+      Expected<StringRef> PassName = getString(Record[1]);
+      if (!PassName)
+        return PassName.takeError();
+      TheRemark.PassName = *PassName;
+      Expected<StringRef> RemarkName = getString(Record[2]);
+      if (!RemarkName)
+        return RemarkName.takeError();
+      TheRemark.RemarkName = *RemarkName;
+      Expected<StringRef> FunctionName = getString(Record[3]);
+      if (!FunctionName)
+        return FunctionName.takeError();
+      TheRemark.FunctionName = *FunctionName;
+      HasHeader = true;
+      break;
+    }
+    case RECORD_REMARK_DEBUG_LOC: {
+      if (Record.size() != 3)
+        return malformed(
+            "Error while parsing REMARK_BLOCK: malformed debug loc record.");
+      Expected<RemarkLocation> Loc =
+          getLocation(Record[0], Record[1], Record[2]);
+      if (!Loc)
+        return Loc.takeError();
+      TheRemark.Loc = *Loc;
+      break;
+    }
+    case RECORD_REMARK_HOTNESS:
+      if (Record.size() != 1)
+        return malformed(
+            "Error while parsing REMARK_BLOCK: malformed hotness record.");
+      TheRemark.Hotness = Record[0];
+      break;
+    case RECORD_REMARK_ARG_WITH_DEBUGLOC:
+    case RECORD_REMARK_ARG_WITHOUT_DEBUGLOC: {
+      bool HasDebugLoc = *MaybeCode == RECORD_REMARK_ARG_WITH_DEBUGLOC;
+      if (Record.size() != (HasDebugLoc ? 5U : 2U))
+        return malformed(
+            "Error while parsing REMARK_BLOCK: malformed argument record.");
+      TmpArgs.emplace_back();
+      Argument &Arg = TmpArgs.back();
+      Expected<StringRef> Key = getString(Record[0]);
+      if (!Key)
+        return Key.takeError();
+      Arg.Key = *Key;
+      Expected<StringRef> Val = getString(Record[1]);
+      if (!Val)
+        return Val.takeError();
+      Arg.Val = *Val;
+      if (HasDebugLoc) {
+        Expected<RemarkLocation> Loc =
+            getLocation(Record[2], Record[3], Record[4]);
+        if (!Loc)
+          return Loc.takeError();
+        Arg.Loc = *Loc;
+      }
+      break;
+    }
+    default:
+      // Ignore the records we don't know about.
+      break;
+    }
+  }
+
+  if (!HasHeader)
+    return malformed(
+        "Error while parsing REMARK_BLOCK: missing remark header.");
+  TheRemark.Args = TmpArgs;
+  return Error::success();
+}
+
+Expected<std::vector<StringRef>>
+llvm::remarks::parseBitstreamRemarksSection(StringRef Buf) {
+  std::vector<StringRef> ExternalFilenames;
+  while (!Buf.empty()) {
+    // Linkers may pad the sections they concatenate with zeros.
+    if (Buf.front() == '\0') {
+      Buf = Buf.drop_front();
+      continue;
+    }
+
+    BitstreamCursor Stream(Buf);
+    if (Error E = parseContainerMagic(Stream))
+      return std::move(E);
+    if (Error E = expectSubBlock(
+            Stream, META_BLOCK_ID,
+            "Error while parsing META_BLOCK: expecting META_BLOCK."))
+      return std::move(E);
+    Optional<StringRef> ExternalFilename;
+    if (Error E = parseMetaBlock(Stream,
+                                 BitstreamRemarkContainerType::RemarksMeta,
+                                 ExternalFilename))
+      return std::move(E);
+    if (!ExternalFilename)
+      return malformed(
+          "Error while parsing META_BLOCK: missing external file record.");
+    ExternalFilenames.push_back(*ExternalFilename);
+
+    // The container ends at the end of the META_BLOCK, which is aligned to 32
+    // bits.
+    Buf = Buf.drop_front(Stream.getCurrentByteNo());
+  }
+  return std::move(ExternalFilenames);
+}
@@ -0,0 +1,93 @@
+//===-- BitstreamRemarkParser.h - Parser for Bitstream remarks --*- C++/-*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// This file provides the implementation of the Bitstream remark parser.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_REMARKS_BITSTREAM_REMARK_PARSER_H
+#define LLVM_REMARKS_BITSTREAM_REMARK_PARSER_H
+
+#include "RemarkParserImpl.h"
+#include "llvm/ADT/Optional.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/Bitstream/BitstreamReader.h"
+#include "llvm/Remarks/BitstreamRemarkContainer.h"
+#include "llvm/Remarks/Remark.h"
+#include "llvm/Remarks/RemarkParser.h"
+#include "llvm/Support/Error.h"
+#include <string>
+#include <vector>
+
+namespace llvm {
+namespace remarks {
+/// Parses a remarks file one remark block at a time, and holds the state of
+/// the latest parsed remark.
+struct BitstreamRemarkParser {
+  /// The cursor in the remarks file.
+  BitstreamCursor Stream;
+  /// The abbreviations of the remark blocks, read from the block info.
+  Optional<BitstreamBlockInfo> BlockInfo;
+  /// The strings defined so far in the file. The N-th string has the ID N.
+  std::vector<StringRef> Strings;
+  /// Temporary parsing buffer for the record values.
+  SmallVector<uint64_t, 64> Record;
+  /// Temporary parsing buffer for the arguments.
+  SmallVector<Argument, 8> TmpArgs;
+  /// The latest parsed remark. Invalidated with every call to
+  /// `parseRemarkBlock`.
+  Remark TheRemark;
+  /// Set once the magic number, the block info and the META_BLOCK are parsed.
+  bool ParsedHeader = false;
+
+  BitstreamRemarkParser(StringRef Buf) : Stream(Buf) {}
+
+  /// Parse the header of the file if needed. Returns true if there is a remark
+  /// block to parse next.
+  Expected<bool> hasNextRemark();
+  /// Parse the next remark block into `TheRemark`.
+  Error parseRemarkBlock();
+  /// Stop parsing: the next remark block is the end of the file.
+  void skipToEnd();
+
+private:
+  /// Parse the magic number, the block info and the META_BLOCK.
+  Error parseHeader();
+  /// Parse the string with the ID \p ID.
+  Expected<StringRef> getString(uint64_t ID) const;
+  /// Parse the location made of the string ID \p FileID, \p Line and \p
+  /// Column.
+  Expected<RemarkLocation> getLocation(uint64_t FileID, uint64_t Line,
+                                       uint64_t Column) const;
+};
+
+/// Bitstream to Remark parser.
+struct BitstreamParserImpl : public ParserImpl {
+  /// The object parsing the bitstream.
+  BitstreamRemarkParser BitstreamParser;
+  /// Set if the parser was given an external string table, which is not
+  /// supported by the bitstream format.
+  bool HasExternalStrTab = false;
+  /// Set to `true` if we had any errors during parsing.
+  bool HasErrors = false;
+  /// Storage for the error message of the C API.
+  std::string ErrorString;
+
+  BitstreamParserImpl(StringRef Buf, bool HasExternalStrTab = false)
+      : ParserImpl{ParserFormat::Bitstream}, BitstreamParser(Buf),
+        HasExternalStrTab(HasExternalStrTab) {}
+
+  static bool classof(const ParserImpl *PI) {
+    return PI->Format == ParserFormat::Bitstream;
+  }
+};
+
+} // end namespace remarks
+} // end namespace llvm
+
+#endif /* LLVM_REMARKS_BITSTREAM_REMARK_PARSER_H */
@@ -0,0 +1,226 @@
+//===- BitstreamRemarkSerializer.cpp --------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// This file provides the implementation of the LLVM bitstream remark
+// serializer using LLVM's bitstream writer.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/Remarks/BitstreamRemarkContainer.h"
+#include "llvm/Remarks/RemarkSerializer.h"
+
+using namespace llvm;
+using namespace llvm::remarks;
+
+static_assert(static_cast<unsigned>(Type::LastTypeValue) < (1 << 3),
+              "The remark type is encoded on 3 bits.");
+static_assert(static_cast<unsigned>(
+                  BitstreamRemarkContainerType::LastTypeValue) < (1 << 2),
+              "The container type is encoded on 2 bits.");
+
+static void emitMagic(BitstreamWriter &Bitstream) {
+  for (const char C : ContainerMagic)
+    Bitstream.Emit(static_cast<unsigned>(C), 8);
+}
+
+/// Emit a META_BLOCK for a container of type \p ContainerType, referencing
+/// \p ExternalFilename if it is not empty.
+static void emitMetaBlock(BitstreamWriter &Bitstream,
+                          BitstreamRemarkContainerType ContainerType,
+                          StringRef ExternalFilename) {
+  Bitstream.EnterSubblock(META_BLOCK_ID, MetaBlockCodeSize);
+
+  // The abbreviations are only used once, so define them in the block itself.
+  auto Abbrev = std::make_shared<BitCodeAbbrev>();
+  Abbrev->Add(BitCodeAbbrevOp(RECORD_META_CONTAINER_INFO));
+  Abbrev->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::VBR, 6)); // Version.
+  Abbrev->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::Fixed, 2)); // Type.
+  unsigned ContainerInfoAbbrevID = Bitstream.EmitAbbrev(std::move(Abbrev));
+
+  Abbrev = std::make_shared<BitCodeAbbrev>();
+  Abbrev->Add(BitCodeAbbrevOp(RECORD_META_REMARK_VERSION));
+  Abbrev->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::VBR, 6)); // Version.
+  unsigned RemarkVersionAbbrevID = Bitstream.EmitAbbrev(std::move(Abbrev));
+
+  uint64_t ContainerInfo[] = {RECORD_META_CONTAINER_INFO,
+                              CurrentContainerVersion,
+                              static_cast<uint64_t>(ContainerType)};
+  Bitstream.EmitRecordWithAbbrev(ContainerInfoAbbrevID, ContainerInfo);
+  uint64_t RemarkVersion[] = {RECORD_META_REMARK_VERSION, remarks::Version};
+  Bitstream.EmitRecordWithAbbrev(RemarkVersionAbbrevID, RemarkVersion);
+
+  if (!ExternalFilename.empty()) {
+    Abbrev = std::make_shared<BitCodeAbbrev>();
+    Abbrev->Add(BitCodeAbbrevOp(RECORD_META_EXTERNAL_FILE));
+    Abbrev->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::Blob)); // Filename.
+    unsigned ExternalFileAbbrevID = Bitstream.EmitAbbrev(std::move(Abbrev));
+    uint64_t ExternalFile[] = {RECORD_META_EXTERNAL_FILE};
+    Bitstream.EmitRecordWithBlob(ExternalFileAbbrevID, ExternalFile,
+                                 ExternalFilename);
+  }
+
+  Bitstream.ExitBlock();
+}
+
+BitstreamSerializer::BitstreamSerializer(raw_ostream &OS)
+    : Serializer(OS), Bitstream(Encoded) {
+  // The strings are always deduplicated through the string table.
+  StrTab.emplace();
+
+  emitMagic(Bitstream);
+
+  // The abbreviations for the remark blocks are shared by all of them.
+  Bitstream.EnterBlockInfoBlock();
+
+  auto Abbrev = std::make_shared<BitCodeAbbrev>();
+  Abbrev->Add(BitCodeAbbrevOp(RECORD_REMARK_STRING));
+  Abbrev->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::Blob)); // String.
+  RecordRemarkStringAbbrevID =
+      Bitstream.EmitBlockInfoAbbrev(REMARK_BLOCK_ID, std::move(Abbrev));
+
+  Abbrev = std::make_shared<BitCodeAbbrev>();
+  Abbrev->Add(BitCodeAbbrevOp(RECORD_REMARK_HEADER));
+  Abbrev->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::Fixed, 3)); // Type.
+  Abbrev->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::VBR, 6));   // Pass name.
+  Abbrev->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::VBR, 6));   // Remark name.
+  Abbrev->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::VBR, 6));   // Function name.
+  RecordRemarkHeaderAbbrevID =
+      Bitstream.EmitBlockInfoAbbrev(REMARK_BLOCK_ID, std::move(Abbrev));
+
+  Abbrev = std::make_shared<BitCodeAbbrev>();
+  Abbrev->Add(BitCodeAbbrevOp(RECORD_REMARK_DEBUG_LOC));
+  Abbrev->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::VBR, 6)); // File.
+  Abbrev->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::VBR, 6)); // Line.
+  Abbrev->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::VBR, 6)); // Column.
+  RecordRemarkDebugLocAbbrevID =
+      Bitstream.EmitBlockInfoAbbrev(REMARK_BLOCK_ID, std::move(Abbrev));
+
+  Abbrev = std::make_shared<BitCodeAbbrev>();
+  Abbrev->Add(BitCodeAbbrevOp(RECORD_REMARK_HOTNESS));
+  Abbrev->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::VBR, 8)); // Hotness.
+  RecordRemarkHotnessAbbrevID =
+      Bitstream.EmitBlockInfoAbbrev(REMARK_BLOCK_ID, std::move(Abbrev));
+
+  Abbrev = std::make_shared<BitCodeAbbrev>();
+  Abbrev->Add(BitCodeAbbrevOp(RECORD_REMARK_ARG_WITH_DEBUGLOC));
+  Abbrev->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::VBR, 6)); // Key.
+  Abbrev->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::VBR, 6)); // Value.
+  Abbrev->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::VBR, 6)); // File.
+  Abbrev->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::VBR, 6)); // Line.
+  Abbrev->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::VBR, 6)); // Column.
+  RecordRemarkArgWithDebugLocAbbrevID =
+      Bitstream.EmitBlockInfoAbbrev(REMARK_BLOCK_ID, std::move(Abbrev));
+
+  Abbrev = std::make_shared<BitCodeAbbrev>();
+  Abbrev->Add(BitCodeAbbrevOp(RECORD_REMARK_ARG_WITHOUT_DEBUGLOC));
+  Abbrev->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::VBR, 6)); // Key.
+  Abbrev->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::VBR, 6)); // Value.
+  RecordRemarkArgWithoutDebugLocAbbrevID =
+      Bitstream.EmitBlockInfoAbbrev(REMARK_BLOCK_ID, std::move(Abbrev));
+
+  Bitstream.ExitBlock();
+
+  emitMetaBlock(Bitstream, BitstreamRemarkContainerType::RemarksFile,
+                /*ExternalFilename=*/StringRef());
+  flushToStream();
+}
+
+void BitstreamSerializer::addString(StringRef Str) {
+  size_t Size = StrTab->StrTab.size();
+  unsigned ID = StrTab->add(Str).first;
+  // A new string gets the next ID, and has to be defined by this remark.
+  if (ID == Size)
+    NewStrings.push_back(Str);
+  StrIDs.push_back(ID);
+}
+
+void BitstreamSerializer::flushToStream() {
+  OS.write(Encoded.data(), Encoded.size());
+  Encoded.clear();
+}
+
+void BitstreamSerializer::emit(const Remark &Remark) {
+  // Collect the IDs of the strings first: the new strings have to be defined
+  // before the records using them. The IDs are then used in the same order.
+  StrIDs.clear();
+  NewStrings.clear();
+  addString(Remark.PassName);
+  addString(Remark.RemarkName);
+  addString(Remark.FunctionName);
+  if (const Optional<RemarkLocation> &Loc = Remark.Loc)
+    addString(Loc->SourceFilePath);
+  for (const Argument &Arg : Remark.Args) {
+    addString(Arg.Key);
+    addString(Arg.Val);
+    if (const Optional<RemarkLocation> &Loc = Arg.Loc)
+      addString(Loc->SourceFilePath);
+  }
+  const uint64_t *NextID = StrIDs.begin();
+
+  Bitstream.EnterSubblock(REMARK_BLOCK_ID, RemarkBlockCodeSize);
+
+  for (StringRef Str : NewStrings) {
+    R.clear();
+    R.push_back(RECORD_REMARK_STRING);
+    Bitstream.EmitRecordWithBlob(RecordRemarkStringAbbrevID, R, Str);
+  }
+
+  R.clear();
+  R.push_back(RECORD_REMARK_HEADER);
+  R.push_back(static_cast<uint64_t>(Remark.RemarkType));
+  R.append(NextID, NextID + 3);
+  NextID += 3;
+  Bitstream.EmitRecordWithAbbrev(RecordRemarkHeaderAbbrevID, R);
+
+  if (const Optional<RemarkLocation> &Loc = Remark.Loc) {
+    R.clear();
+    R.push_back(RECORD_REMARK_DEBUG_LOC);
+    R.push_back(*NextID++);
+    R.push_back(Loc->SourceLine);
+    R.push_back(Loc->SourceColumn);
+    Bitstream.EmitRecordWithAbbrev(RecordRemarkDebugLocAbbrevID, R);
+  }
+
+  if (Optional<uint64_t> Hotness = Remark.Hotness) {
+    R.clear();
+    R.push_back(RECORD_REMARK_HOTNESS);
+    R.push_back(*Hotness);
+    Bitstream.EmitRecordWithAbbrev(RecordRemarkHotnessAbbrevID, R);
+  }
+
+  for (const Argument &Arg : Remark.Args) {
+    R.clear();
+    R.push_back(Arg.Loc ? RECORD_REMARK_ARG_WITH_DEBUGLOC
+                        : RECORD_REMARK_ARG_WITHOUT_DEBUGLOC);
+    R.append(NextID, NextID + 2);
+    NextID += 2;
+    if (const Optional<RemarkLocation> &Loc = Arg.Loc) {
+      R.push_back(*NextID++);
+      R.push_back(Loc->SourceLine);
+      R.push_back(Loc->SourceColumn);
+      Bitstream.EmitRecordWithAbbrev(RecordRemarkArgWithDebugLocAbbrevID, R);
+    } else {
+      Bitstream.EmitRecordWithAbbrev(RecordRemarkArgWithoutDebugLocAbbrevID,
+                                     R);
+    }
+  }
+  assert(NextID == StrIDs.end() && "Unused string IDs.");
+
+  Bitstream.ExitBlock();
+  flushToStream();
+}
+
+void BitstreamSerializer::emitMetaSection(raw_ostream &OS,
+                                          StringRef ExternalFilename) const {
+  SmallVector<char, 256> Buf;
+  BitstreamWriter MetaBitstream(Buf);
+  emitMagic(MetaBitstream);
+  emitMetaBlock(MetaBitstream, BitstreamRemarkContainerType::RemarksMeta,
+                ExternalFilename);
+  OS.write(Buf.data(), Buf.size());
+}
@@ -12,6 +12,7 @@
 //===----------------------------------------------------------------------===//
 
 #include "llvm/Remarks/RemarkParser.h"
+#include "BitstreamRemarkParser.h"
 #include "YAMLRemarkParser.h"
 #include "llvm-c/Remarks.h"
 #include "llvm/ADT/STLExtras.h"
@@ -25,6 +26,8 @@ static std::unique_ptr<ParserImpl> formatToParserImpl(ParserFormat Format,
   switch (Format) {
   case ParserFormat::YAML:
     return llvm::make_unique<YAMLParserImpl>(Buf);
+  case ParserFormat::Bitstream:
+    return llvm::make_unique<BitstreamParserImpl>(Buf);
   };
   llvm_unreachable("Unhandled llvm::remarks::ParserFormat enum");
 }
@@ -35,6 +38,10 @@ formatToParserImpl(ParserFormat Format, StringRef Buf,
   switch (Format) {
   case ParserFormat::YAML:
     return llvm::make_unique<YAMLParserImpl>(Buf, &StrTab);
+  case ParserFormat::Bitstream:
+    // The strings are defined in the remarks file itself.
+    return llvm::make_unique<BitstreamParserImpl>(Buf,
+                                                  /*HasExternalStrTab=*/true);
   };
   llvm_unreachable("Unhandled llvm::remarks::ParserFormat enum");
 }
@@ -74,9 +81,38 @@ static Expected<const Remark *> getNextYAML(YAMLParserImpl &Impl) {
                              "unexpected error while parsing.");
 }
 
+static Expected<const Remark *> getNextBitstream(BitstreamParserImpl &Impl) {
+  if (Impl.HasExternalStrTab)
+    return createStringError(std::make_error_code(std::errc::invalid_argument),
+                             "bitstream remarks do not use an external string "
+                             "table.");
+
+  BitstreamRemarkParser &BitstreamParser = Impl.BitstreamParser;
+  // Check for EOF.
+  Expected<bool> HasNext = BitstreamParser.hasNextRemark();
+  if (!HasNext) {
+    // Skip to the end, in case the user calls getNext again.
+    BitstreamParser.skipToEnd();
+    return HasNext.takeError();
+  }
+  if (!*HasNext)
+    return nullptr;
+
+  // Try to parse an entry.
+  if (Error E = BitstreamParser.parseRemarkBlock()) {
+    BitstreamParser.skipToEnd();
+    return std::move(E);
+  }
+
+  // Return the just-parsed remark.
+  return &BitstreamParser.TheRemark;
+}
+
 Expected<const Remark *> Parser::getNext() const {
   if (auto *Impl = dyn_cast<YAMLParserImpl>(this->Impl.get()))
     return getNextYAML(*Impl);
+  if (auto *Impl = dyn_cast<BitstreamParserImpl>(this->Impl.get()))
+    return getNextBitstream(*Impl);
   llvm_unreachable("Get next called with an unknown parsing implementation.");
 }
 
@@ -115,6 +151,13 @@ extern "C" LLVMRemarkParserRef LLVMRemarkParserCreateYAML(const void *Buf,
                           StringRef(static_cast<const char *>(Buf), Size)));
 }
 
+extern "C" LLVMRemarkParserRef LLVMRemarkParserCreateBitstream(const void *Buf,
+                                                               uint64_t Size) {
+  return wrap(
+      new remarks::Parser(remarks::ParserFormat::Bitstream,
+                          StringRef(static_cast<const char *>(Buf), Size)));
+}
+
 static void handleYAMLError(remarks::YAMLParserImpl &Impl, Error E) {
   handleAllErrors(
       std::move(E),
@@ -135,7 +178,11 @@ LLVMRemarkParserGetNext(LLVMRemarkParserRef Parser) {
     // Error during parsing.
     if (auto *Impl = dyn_cast<remarks::YAMLParserImpl>(TheParser.Impl.get()))
       handleYAMLError(*Impl, RemarkOrErr.takeError());
-    else
+    else if (auto *Impl = dyn_cast<remarks::BitstreamParserImpl>(
+                 TheParser.Impl.get())) {
+      Impl->ErrorString = toString(RemarkOrErr.takeError());
+      Impl->HasErrors = true;
+    } else
       llvm_unreachable("unkown parser implementation.");
     return nullptr;
   }
@@ -150,6 +197,9 @@ extern "C" LLVMBool LLVMRemarkParserHasError(LLVMRemarkParserRef Parser) {
   if (auto *Impl =
           dyn_cast<remarks::YAMLParserImpl>(unwrap(Parser)->Impl.get()))
     return Impl->HasErrors;
+  if (auto *Impl =
+          dyn_cast<remarks::BitstreamParserImpl>(unwrap(Parser)->Impl.get()))
+    return Impl->HasErrors;
   llvm_unreachable("unkown parser implementation.");
 }
 
@@ -158,6 +208,9 @@ LLVMRemarkParserGetErrorMessage(LLVMRemarkParserRef Parser) {
   if (auto *Impl =
           dyn_cast<remarks::YAMLParserImpl>(unwrap(Parser)->Impl.get()))
     return Impl->YAMLParser.ErrorStream.str().c_str();
+  if (auto *Impl =
+          dyn_cast<remarks::BitstreamParserImpl>(unwrap(Parser)->Impl.get()))
+    return Impl->ErrorString.c_str();
   llvm_unreachable("unkown parser implementation.");
 }
 
@@ -13,6 +13,7 @@
 
 #include "llvm/Remarks/RemarkSerializer.h"
 #include "llvm/Support/CommandLine.h"
+#include "llvm/Support/EndianStream.h"
 
 using namespace llvm;
 using namespace llvm::remarks;
@@ -164,3 +165,27 @@ void YAMLSerializer::emit(const Remark &Remark) {
   auto R = const_cast<remarks::Remark *>(&Remark);
   YAMLOutput << R;
 }
+
+void YAMLSerializer::emitMetaSection(raw_ostream &OS,
+                                     StringRef ExternalFilename) const {
+  // Emit the magic number.
+  OS << remarks::Magic;
+  // Explicitly emit a '\0'.
+  OS.write('\0');
+
+  // Emit the version number: little-endian uint64_t.
+  support::endian::write<uint64_t>(OS, remarks::Version, support::little);
+
+  // Emit the string table: the total size of the string table (the size
+  // itself excluded), followed by the list of null-terminated strings. Even if
+  // no string table is used, emit the size 0.
+  if (StrTab)
+    StrTab->serialize(OS);
+  else
+    support::endian::write<uint64_t>(OS, 0, support::little);
+
+  // Emit the null-terminated absolute path to the remark file.
+  OS << ExternalFilename;
+  // Explicitly emit a '\0'.
+  OS.write('\0');
+}
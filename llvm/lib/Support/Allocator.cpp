@@ -11,7 +11,10 @@
 //===----------------------------------------------------------------------===//
 
 #include "llvm/Support/Allocator.h"
+#include "llvm/Support/Compiler.h"
+#include "llvm/Support/ConcurrentBumpPtrAllocator.h"
 #include "llvm/Support/raw_ostream.h"
+#include <atomic>
 
 namespace llvm {
 
@@ -26,6 +29,14 @@ void printBumpPtrAllocatorStats(unsigned NumSlabs, size_t BytesAllocated,
          << " (includes alignment, etc)\n";
 }
 
+unsigned getThreadOrdinal() {
+  static std::atomic<unsigned> NextOrdinal{0};
+  static LLVM_THREAD_LOCAL unsigned Ordinal = ~0U;
+  if (LLVM_UNLIKELY(Ordinal == ~0U))
+    Ordinal = NextOrdinal++;
+  return Ordinal;
+}
+
 } // End namespace detail.
 
 void PrintRecyclerStats(size_t Size,
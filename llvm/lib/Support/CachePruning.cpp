@@ -12,10 +12,14 @@
 
 #include "llvm/Support/CachePruning.h"
 
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Config/llvm-config.h"
+#include "llvm/Support/Chrono.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/Errc.h"
 #include "llvm/Support/Error.h"
 #include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/raw_ostream.h"
 
@@ -131,6 +135,12 @@ llvm::parseCachePruningPolicy(StringRef PolicyStr) {
       if (Value.getAsInteger(0, Policy.MaxSizeFiles))
         return make_error<StringError>("'" + Value + "' not an integer",
                                        inconvertibleErrorCode());
+    } else if (Key == "prune_incremental") {
+      unsigned Incremental;
+      if (Value.getAsInteger(0, Incremental) || Incremental > 1)
+        return make_error<StringError>("'" + Value + "' must be 0 or 1",
+                                       inconvertibleErrorCode());
+      Policy.Incremental = Incremental;
     } else {
       return make_error<StringError>("Unknown key: '" + Key + "'",
                                      inconvertibleErrorCode());
@@ -140,6 +150,218 @@ llvm::parseCachePruningPolicy(StringRef PolicyStr) {
   return Policy;
 }
 
+/// Calls \p Fn with the path and the status of each file of the cache
+/// directory \p Path.
+static void forEachCacheFile(
+    StringRef Path,
+    function_ref<void(StringRef, const sys::fs::basic_file_status &)> Fn) {
+  std::error_code EC;
+  SmallString<128> CachePathNative;
+  sys::path::native(Path, CachePathNative);
+  // Walk all of the files within this directory.
+  for (sys::fs::directory_iterator File(CachePathNative, EC), FileEnd;
+       File != FileEnd && !EC; File.increment(EC)) {
+    // Ignore any files not beginning with the string "llvmcache-". This
+    // includes the timestamp file as well as any files created by the user.
+    // This acts as a safeguard against data loss if the user specifies the
+    // wrong directory as their cache directory.
+    if (!sys::path::filename(File->path()).startswith("llvmcache-"))
+      continue;
+
+    // Look at this file. If we can't stat it, there's nothing interesting
+    // there.
+    ErrorOr<sys::fs::basic_file_status> StatusOrErr = File->status();
+    if (!StatusOrErr) {
+      LLVM_DEBUG(dbgs() << "Ignore " << File->path() << " (can't stat)\n");
+      continue;
+    }
+    Fn(File->path(), *StatusOrErr);
+  }
+}
+
+/// Removes the files of \p FileInfos that are over the size limits of
+/// \p Policy, least recently used first, and erases them from \p FileInfos.
+static void pruneToSizeLimits(StringRef Path, CachePruningPolicy &Policy,
+                              std::set<FileInfo> &FileInfos,
+                              uint64_t TotalSize) {
+  size_t NumFiles = FileInfos.size();
+
+  auto RemoveCacheFile = [&]() {
+    auto FileInfo = FileInfos.begin();
+    // Remove the file.
+    sys::fs::remove(FileInfo->Path);
+    // Update size
+    TotalSize -= FileInfo->Size;
+    NumFiles--;
+    LLVM_DEBUG(dbgs() << " - Remove " << FileInfo->Path << " (size "
+                      << FileInfo->Size << "), new occupancy is " << TotalSize
+                      << "%\n");
+    FileInfos.erase(FileInfo);
+  };
+
+  // Prune for number of files.
+  if (Policy.MaxSizeFiles)
+    while (NumFiles > Policy.MaxSizeFiles)
+      RemoveCacheFile();
+
+  // Prune for size now if needed
+  if (Policy.MaxSizePercentageOfAvailableSpace > 0 || Policy.MaxSizeBytes > 0) {
+    auto ErrOrSpaceInfo = sys::fs::disk_space(Path);
+    if (!ErrOrSpaceInfo) {
+      report_fatal_error("Can't get available size");
+    }
+    sys::fs::space_info SpaceInfo = ErrOrSpaceInfo.get();
+    auto AvailableSpace = TotalSize + SpaceInfo.free;
+
+    if (Policy.MaxSizePercentageOfAvailableSpace == 0)
+      Policy.MaxSizePercentageOfAvailableSpace = 100;
+    if (Policy.MaxSizeBytes == 0)
+      Policy.MaxSizeBytes = AvailableSpace;
+    auto TotalSizeTarget = std::min<uint64_t>(
+        AvailableSpace * Policy.MaxSizePercentageOfAvailableSpace / 100ull,
+        Policy.MaxSizeBytes);
+
+    LLVM_DEBUG(dbgs() << "Occupancy: " << ((100 * TotalSize) / AvailableSpace)
+                      << "% target is: "
+                      << Policy.MaxSizePercentageOfAvailableSpace << "%, "
+                      << Policy.MaxSizeBytes << " bytes\n");
+
+    // Remove the oldest accessed files first, till we get below the threshold.
+    while (TotalSize > TotalSizeTarget && !FileInfos.empty())
+      RemoveCacheFile();
+  }
+}
+
+/// Returns the path of the journal of the cache directory \p Path.
+static SmallString<128> getJournalPath(StringRef Path) {
+  SmallString<128> JournalFile(Path);
+  sys::path::append(JournalFile, "llvmcache.journal");
+  return JournalFile;
+}
+
+/// Writes a journal record of the use at \p Time of the cache file \p Name of
+/// \p Size bytes. A record is a line "<time> <size> <file name>", where the
+/// time is in seconds since the epoch.
+static void writeJournalRecord(raw_ostream &OS, sys::TimePoint<> Time,
+                               uint64_t Size, StringRef Name) {
+  OS << uint64_t(sys::toTimeT(Time)) << ' ' << Size << ' ' << Name << '\n';
+}
+
+/// Reads the records of the journal \p JournalFile of the cache directory
+/// \p Path into \p Entries, which maps the names of the files to their last
+/// recorded use.
+static void readJournal(StringRef Path, StringRef JournalFile,
+                        StringMap<FileInfo> &Entries) {
+  ErrorOr<std::unique_ptr<MemoryBuffer>> BufOrErr =
+      MemoryBuffer::getFile(JournalFile);
+  if (!BufOrErr)
+    return;
+
+  StringRef Records = (*BufOrErr)->getBuffer();
+  while (!Records.empty()) {
+    StringRef Record;
+    std::tie(Record, Records) = Records.split('\n');
+    StringRef TimeStr, SizeStr, Name;
+    std::tie(TimeStr, Record) = Record.split(' ');
+    std::tie(SizeStr, Name) = Record.split(' ');
+    uint64_t Time, Size;
+    // Skip the malformed records, such as one cut short by a crash, and the
+    // records of the files that the directory scan would ignore.
+    if (TimeStr.getAsInteger(10, Time) || SizeStr.getAsInteger(10, Size) ||
+        !Name.startswith("llvmcache-") || Name.contains('/') ||
+        Name.contains('\\'))
+      continue;
+
+    FileInfo &Entry = Entries[Name];
+    sys::TimePoint<> RecordTime = sys::toTimePoint(Time);
+    if (!Entry.Path.empty() && Entry.Time > RecordTime)
+      continue;
+    Entry.Time = RecordTime;
+    Entry.Size = Size;
+    if (Entry.Path.empty()) {
+      SmallString<128> EntryPath(Path);
+      sys::path::append(EntryPath, Name);
+      Entry.Path = EntryPath.str();
+    }
+  }
+}
+
+/// Prunes the cache directory \p Path based on its journal instead of on the
+/// access times of its files.
+static void pruneCacheIncrementally(StringRef Path, CachePruningPolicy &Policy,
+                                    sys::TimePoint<> CurrentTime) {
+  using namespace std::chrono;
+
+  // The records to prune are moved aside, so that the uses of the cache during
+  // the pruning go to a new journal. The records left aside by a pruning that
+  // was interrupted are taken into account again.
+  SmallString<128> JournalFile = getJournalPath(Path);
+  SmallString<128> PruningFile(JournalFile);
+  PruningFile += ".pruning";
+  StringMap<FileInfo> Entries;
+  readJournal(Path, PruningFile, Entries);
+  std::error_code RenameEC = sys::fs::rename(JournalFile, PruningFile);
+  if (RenameEC && RenameEC != errc::no_such_file_or_directory)
+    return;
+  {
+    std::error_code EC;
+    raw_fd_ostream OS(JournalFile, EC, sys::fs::F_Append);
+    if (EC)
+      return;
+  }
+
+  if (RenameEC) {
+    // This is the first incremental pruning: look for the files that predate
+    // the journal.
+    forEachCacheFile(Path, [&](StringRef FilePath,
+                               const sys::fs::basic_file_status &Status) {
+      FileInfo &Entry = Entries[sys::path::filename(FilePath)];
+      if (!Entry.Path.empty() && Entry.Time > Status.getLastAccessedTime())
+        return;
+      Entry = {Status.getLastAccessedTime(), Status.getSize(), FilePath};
+    });
+  } else {
+    readJournal(Path, PruningFile, Entries);
+  }
+
+  std::set<FileInfo> FileInfos;
+  uint64_t TotalSize = 0;
+  for (auto &Entry : Entries) {
+    FileInfo &File = Entry.second;
+    auto FileAge = CurrentTime - File.Time;
+    if (Policy.Expiration != seconds(0) && FileAge > Policy.Expiration) {
+      LLVM_DEBUG(dbgs() << "Remove " << File.Path << " ("
+                        << duration_cast<seconds>(FileAge).count()
+                        << "s old)\n");
+      sys::fs::remove(File.Path);
+      continue;
+    }
+    TotalSize += File.Size;
+    FileInfos.insert(std::move(File));
+  }
+
+  pruneToSizeLimits(Path, Policy, FileInfos, TotalSize);
+
+  // Write the remaining entries back to the journal, after the uses that were
+  // recorded in the meantime. The last use of an entry is the one that counts,
+  // whatever the order of the records.
+  std::error_code EC;
+  {
+    raw_fd_ostream OS(JournalFile, EC, sys::fs::F_Append);
+    if (EC)
+      return;
+    for (const FileInfo &File : FileInfos)
+      writeJournalRecord(OS, File.Time, File.Size,
+                         sys::path::filename(File.Path));
+    OS.close();
+    if (OS.has_error()) {
+      OS.clear_error();
+      return;
+    }
+  }
+  sys::fs::remove(PruningFile);
+}
+
 /// Prune the cache of files that haven't been accessed in a long time.
 bool llvm::pruneCache(StringRef Path, CachePruningPolicy Policy) {
   using namespace std::chrono;
@@ -199,94 +421,75 @@ bool llvm::pruneCache(StringRef Path, CachePruningPolicy Policy) {
     writeTimestampFile(TimestampFile);
   }
 
+  if (Policy.Incremental) {
+    pruneCacheIncrementally(Path, Policy, CurrentTime);
+    return true;
+  }
+
+  // The journal is only kept up to date by the incremental pruning. Stop
+  // recording the uses of the cache.
+  sys::fs::remove(getJournalPath(Path));
+
   // Keep track of files to delete to get below the size limit.
   // Order by time of last use so that recently used files are preserved.
   std::set<FileInfo> FileInfos;
   uint64_t TotalSize = 0;
 
   // Walk the entire directory cache, looking for unused files.
-  std::error_code EC;
-  SmallString<128> CachePathNative;
-  sys::path::native(Path, CachePathNative);
-  // Walk all of the files within this directory.
-  for (sys::fs::directory_iterator File(CachePathNative, EC), FileEnd;
-       File != FileEnd && !EC; File.increment(EC)) {
-    // Ignore any files not beginning with the string "llvmcache-". This
-    // includes the timestamp file as well as any files created by the user.
-    // This acts as a safeguard against data loss if the user specifies the
-    // wrong directory as their cache directory.
-    if (!sys::path::filename(File->path()).startswith("llvmcache-"))
-      continue;
-
-    // Look at this file. If we can't stat it, there's nothing interesting
-    // there.
-    ErrorOr<sys::fs::basic_file_status> StatusOrErr = File->status();
-    if (!StatusOrErr) {
-      LLVM_DEBUG(dbgs() << "Ignore " << File->path() << " (can't stat)\n");
-      continue;
-    }
-
+  forEachCacheFile(Path, [&](StringRef FilePath,
+                             const sys::fs::basic_file_status &Status) {
     // If the file hasn't been used recently enough, delete it
-    const auto FileAccessTime = StatusOrErr->getLastAccessedTime();
+    const auto FileAccessTime = Status.getLastAccessedTime();
     auto FileAge = CurrentTime - FileAccessTime;
     if (Policy.Expiration != seconds(0) && FileAge > Policy.Expiration) {
-      LLVM_DEBUG(dbgs() << "Remove " << File->path() << " ("
+      LLVM_DEBUG(dbgs() << "Remove " << FilePath << " ("
                         << duration_cast<seconds>(FileAge).count()
                         << "s old)\n");
-      sys::fs::remove(File->path());
-      continue;
+      sys::fs::remove(FilePath);
+      return;
     }
 
     // Leave it here for now, but add it to the list of size-based pruning.
-    TotalSize += StatusOrErr->getSize();
-    FileInfos.insert({FileAccessTime, StatusOrErr->getSize(), File->path()});
-  }
-
-  auto FileInfo = FileInfos.begin();
-  size_t NumFiles = FileInfos.size();
+    TotalSize += Status.getSize();
+    FileInfos.insert({FileAccessTime, Status.getSize(), FilePath});
+  });
 
-  auto RemoveCacheFile = [&]() {
-    // Remove the file.
-    sys::fs::remove(FileInfo->Path);
-    // Update size
-    TotalSize -= FileInfo->Size;
-    NumFiles--;
-    LLVM_DEBUG(dbgs() << " - Remove " << FileInfo->Path << " (size "
-                      << FileInfo->Size << "), new occupancy is " << TotalSize
-                      << "%\n");
-    ++FileInfo;
-  };
-
-  // Prune for number of files.
-  if (Policy.MaxSizeFiles)
-    while (NumFiles > Policy.MaxSizeFiles)
-      RemoveCacheFile();
-
-  // Prune for size now if needed
-  if (Policy.MaxSizePercentageOfAvailableSpace > 0 || Policy.MaxSizeBytes > 0) {
-    auto ErrOrSpaceInfo = sys::fs::disk_space(Path);
-    if (!ErrOrSpaceInfo) {
-      report_fatal_error("Can't get available size");
-    }
-    sys::fs::space_info SpaceInfo = ErrOrSpaceInfo.get();
-    auto AvailableSpace = TotalSize + SpaceInfo.free;
-
-    if (Policy.MaxSizePercentageOfAvailableSpace == 0)
-      Policy.MaxSizePercentageOfAvailableSpace = 100;
-    if (Policy.MaxSizeBytes == 0)
-      Policy.MaxSizeBytes = AvailableSpace;
-    auto TotalSizeTarget = std::min<uint64_t>(
-        AvailableSpace * Policy.MaxSizePercentageOfAvailableSpace / 100ull,
-        Policy.MaxSizeBytes);
+  pruneToSizeLimits(Path, Policy, FileInfos, TotalSize);
+  return true;
+}
 
-    LLVM_DEBUG(dbgs() << "Occupancy: " << ((100 * TotalSize) / AvailableSpace)
-                      << "% target is: "
-                      << Policy.MaxSizePercentageOfAvailableSpace << "%, "
-                      << Policy.MaxSizeBytes << " bytes\n");
+std::future<bool> llvm::pruneCacheAsync(StringRef Path,
+                                        CachePruningPolicy Policy) {
+#if LLVM_ENABLE_THREADS
+  return std::async(std::launch::async,
+                    [](std::string Path, CachePruningPolicy Policy) {
+                      return pruneCache(Path, Policy);
+                    },
+                    Path.str(), Policy);
+#else
+  std::promise<bool> Pruned;
+  Pruned.set_value(pruneCache(Path, Policy));
+  return Pruned.get_future();
+#endif
+}
 
-    // Remove the oldest accessed files first, till we get below the threshold.
-    while (TotalSize > TotalSizeTarget && FileInfo != FileInfos.end())
-      RemoveCacheFile();
-  }
-  return true;
+void llvm::recordCacheEntryUse(StringRef EntryPath, uint64_t Size) {
+  // Only the incremental pruning creates the journal.
+  SmallString<128> JournalFile =
+      getJournalPath(sys::path::parent_path(EntryPath));
+  if (!sys::fs::exists(JournalFile))
+    return;
+  int FD;
+  if (sys::fs::openFileForWrite(JournalFile, FD, sys::fs::CD_OpenAlways,
+                                sys::fs::OF_Append))
+    return;
+
+  // Write the record at once, so that it isn't interleaved with the records
+  // of the other users of the cache.
+  SmallString<128> Record;
+  raw_svector_ostream RecordOS(Record);
+  writeJournalRecord(RecordOS, std::chrono::system_clock::now(), Size,
+                     sys::path::filename(EntryPath));
+  raw_fd_ostream OS(FD, /*shouldClose=*/true, /*unbuffered=*/true);
+  OS << Record;
 }
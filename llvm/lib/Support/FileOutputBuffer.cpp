@@ -66,6 +66,12 @@ public:
     consumeError(Temp.discard());
   }
 
+  void dontNeed(size_t Offset, size_t Size) override {
+    // Dirty pages of a shared file mapping stay in the page cache and are
+    // written back to the file as usual.
+    Buffer->dontNeed(Offset, Size);
+  }
+
 private:
   std::unique_ptr<fs::mapped_file_region> Buffer;
   fs::TempFile Temp;
@@ -17,11 +17,13 @@
 #include "llvm/Support/Signals.h"
 #include "llvm/Support/raw_ostream.h"
 #include <cerrno>
+#include <chrono>
 #include <ctime>
 #include <memory>
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <system_error>
+#include <thread>
 #include <tuple>
 #ifdef _WIN32
 #include <windows.h>
@@ -294,26 +296,21 @@ LockFileManager::WaitForUnlockResult LockFileManager::waitForUnlock() {
   if (getState() != LFS_Shared)
     return Res_Success;
 
-#ifdef _WIN32
-  unsigned long Interval = 1;
-#else
-  struct timespec Interval;
-  Interval.tv_sec = 0;
-  Interval.tv_nsec = 1000000;
-#endif
-  // Don't wait more than 40s per iteration. Total timeout for the file
-  // to appear is ~1.5 minutes.
-  const unsigned MaxSeconds = 40;
+  // Poll with exponential backoff, but never sleep for more than half a
+  // second at a time. An owner that takes a long time to finish (e.g. a big
+  // module build) would otherwise leave us sleeping for up to as long again
+  // after it released the lock. Total timeout for the file to appear is
+  // ~1.5 minutes.
+  using namespace std::chrono;
+  const auto MaxInterval = milliseconds(500);
+  const auto Deadline = steady_clock::now() + seconds(90);
+  milliseconds Interval(1);
   do {
     // Sleep for the designated interval, to allow the owning process time to
     // finish up and remove the lock file.
     // FIXME: Should we hook in to system APIs to get a notification when the
     // lock file is deleted?
-#ifdef _WIN32
-    Sleep(Interval);
-#else
-    nanosleep(&Interval, nullptr);
-#endif
+    std::this_thread::sleep_for(Interval);
 
     if (sys::fs::access(LockFileName.c_str(), sys::fs::AccessMode::Exist) ==
         errc::no_such_file_or_directory) {
@@ -327,24 +324,10 @@ LockFileManager::WaitForUnlockResult LockFileManager::waitForUnlock() {
     if (!processStillExecuting((*Owner).first, (*Owner).second))
       return Res_OwnerDied;
 
-    // Exponentially increase the time we wait for the lock to be removed.
-#ifdef _WIN32
     Interval *= 2;
-#else
-    Interval.tv_sec *= 2;
-    Interval.tv_nsec *= 2;
-    if (Interval.tv_nsec >= 1000000000) {
-      ++Interval.tv_sec;
-      Interval.tv_nsec -= 1000000000;
-    }
-#endif
-  } while (
-#ifdef _WIN32
-           Interval < MaxSeconds * 1000
-#else
-           Interval.tv_sec < (time_t)MaxSeconds
-#endif
-           );
+    if (Interval > MaxInterval)
+      Interval = MaxInterval;
+  } while (steady_clock::now() < Deadline);
 
   // Give up.
   return Res_Timeout;
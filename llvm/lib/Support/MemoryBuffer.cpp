@@ -204,6 +204,10 @@ public:
   MemoryBuffer::BufferKind getBufferKind() const override {
     return MemoryBuffer::MemoryBuffer_MMap;
   }
+
+  void advise(sys::fs::mapped_file_region::advice Advice) override {
+    MFR.advise(Advice);
+  }
 };
 }
 
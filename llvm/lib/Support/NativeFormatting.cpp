@@ -13,19 +13,40 @@
 #include "llvm/ADT/StringExtras.h"
 #include "llvm/Support/Format.h"
 
+#include <cstring>
 #include <float.h>
 
 using namespace llvm;
 
 template<typename T, std::size_t N>
 static int format_to_buffer(T Value, char (&Buffer)[N]) {
+  // The decimal representations of 0 to 99, so that each division produces
+  // two digits.
+  static const char TwoDigits[] = "00010203040506070809"
+                                  "10111213141516171819"
+                                  "20212223242526272829"
+                                  "30313233343536373839"
+                                  "40414243444546474849"
+                                  "50515253545556575859"
+                                  "60616263646566676869"
+                                  "70717273747576777879"
+                                  "80818283848586878889"
+                                  "90919293949596979899";
   char *EndPtr = std::end(Buffer);
   char *CurPtr = EndPtr;
 
-  do {
-    *--CurPtr = '0' + char(Value % 10);
-    Value /= 10;
-  } while (Value);
+  while (Value >= 100) {
+    unsigned Pair = static_cast<unsigned>(Value % 100);
+    Value /= 100;
+    CurPtr -= 2;
+    std::memcpy(CurPtr, &TwoDigits[Pair * 2], 2);
+  }
+  if (Value >= 10) {
+    CurPtr -= 2;
+    std::memcpy(CurPtr, &TwoDigits[Value * 2], 2);
+  } else {
+    *--CurPtr = '0' + char(Value);
+  }
   return EndPtr - CurPtr;
 }
 
@@ -53,24 +74,36 @@ static void write_unsigned_impl(raw_ostream &S, T N, size_t MinDigits,
   static_assert(std::is_unsigned<T>::value, "Value is not unsigned!");
 
   char NumberBuffer[128];
-  std::memset(NumberBuffer, '0', sizeof(NumberBuffer));
+  size_t Len = format_to_buffer(N, NumberBuffer);
+  char *Digits = std::end(NumberBuffer) - Len;
 
-  size_t Len = 0;
-  Len = format_to_buffer(N, NumberBuffer);
-
-  if (IsNegative)
-    S << '-';
+  if (Style == IntegerStyle::Number) {
+    if (IsNegative)
+      S << '-';
+    writeWithCommas(S, ArrayRef<char>(Digits, Len));
+    return;
+  }
 
-  if (Len < MinDigits && Style != IntegerStyle::Number) {
+  if (Len < MinDigits && MinDigits >= sizeof(NumberBuffer)) {
+    // The padding does not fit in the buffer.
+    if (IsNegative)
+      S << '-';
     for (size_t I = Len; I < MinDigits; ++I)
       S << '0';
+    S.write(Digits, Len);
+    return;
   }
 
-  if (Style == IntegerStyle::Number) {
-    writeWithCommas(S, ArrayRef<char>(std::end(NumberBuffer) - Len, Len));
-  } else {
-    S.write(std::end(NumberBuffer) - Len, Len);
+  // Put the sign and the padding in the buffer as well, so that the stream
+  // is written once.
+  char *Begin = Digits;
+  if (Len < MinDigits) {
+    Begin = std::end(NumberBuffer) - MinDigits;
+    std::memset(Begin, '0', MinDigits - Len);
   }
+  if (IsNegative)
+    *--Begin = '-';
+  S.write(Begin, std::end(NumberBuffer) - Begin);
 }
 
 template <typename T>
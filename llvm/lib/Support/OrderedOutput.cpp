@@ -0,0 +1,41 @@
+//===- llvm/Support/OrderedOutput.cpp - In-order parallel output ----------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/Support/OrderedOutput.h"
+
+using namespace llvm;
+
+OrderedOutput::OrderedOutput(raw_ostream &OS, size_t NumChunks) : OS(OS) {
+  Chunks.reserve(NumChunks);
+  for (size_t I = 0; I != NumChunks; ++I)
+    Chunks.push_back(llvm::make_unique<Chunk>());
+}
+
+OrderedOutput::~OrderedOutput() {
+  std::lock_guard<std::mutex> Lock(Mutex);
+  for (std::unique_ptr<Chunk> &C : Chunks)
+    if (C)
+      C->Finished = true;
+  writeFinishedChunks();
+}
+
+void OrderedOutput::finishChunk(size_t I) {
+  std::lock_guard<std::mutex> Lock(Mutex);
+  assert(!Chunks[I]->Finished && "chunk finished twice");
+  Chunks[I]->Finished = true;
+  if (I == NextChunk)
+    writeFinishedChunks();
+}
+
+void OrderedOutput::writeFinishedChunks() {
+  for (; NextChunk != Chunks.size() && Chunks[NextChunk]->Finished;
+       ++NextChunk) {
+    OS << Chunks[NextChunk]->Buffer;
+    Chunks[NextChunk].reset();
+  }
+}
@@ -9,13 +9,18 @@
 #include "llvm/Support/Parallel.h"
 #include "llvm/Config/llvm-config.h"
 
+llvm::ThreadPoolStrategy llvm::parallel::strategy;
+
 #if LLVM_ENABLE_THREADS
 
+#include "llvm/Support/Compiler.h"
 #include "llvm/Support/Threading.h"
+#include "llvm/Support/WorkStealingQueue.h"
 
 #include <atomic>
-#include <stack>
+#include <deque>
 #include <thread>
+#include <vector>
 
 namespace llvm {
 namespace parallel {
@@ -29,6 +34,10 @@ public:
   virtual ~Executor() = default;
   virtual void add(std::function<void()> func) = 0;
 
+  /// Runs one of the pending closures on the current thread, if the executor
+  /// supports it. Returns false if no closure was run.
+  virtual bool runPendingTask() { return false; }
+
   static Executor *getDefaultExecutor();
 };
 
@@ -60,19 +69,32 @@ Executor *Executor::getDefaultExecutor() {
 }
 
 #else
-/// An implementation of an Executor that runs closures on a thread pool
-///   in filo order.
+/// An implementation of an Executor that runs closures on a thread pool.
+///
+/// Each thread of the pool has its own WorkStealingQueue. Closures added by a
+/// thread of the pool go to its queue and run in filo order, and closures
+/// added by any other thread go to a shared queue. A thread that runs out of
+/// work takes from the shared queue, then steals from the other threads.
 class ThreadPoolExecutor : public Executor {
+  using TaskTy = std::function<void()>;
+
 public:
-  explicit ThreadPoolExecutor(unsigned ThreadCount = hardware_concurrency())
-      : Done(ThreadCount) {
+  explicit ThreadPoolExecutor(ThreadPoolStrategy S = ThreadPoolStrategy())
+      : Done(S.compute_thread_count()) {
+    unsigned ThreadCount = S.compute_thread_count();
+    for (unsigned I = 0; I < ThreadCount; ++I)
+      Queues.push_back(llvm::make_unique<WorkStealingQueue<TaskTy>>());
     // Spawn all but one of the threads in another thread as spawning threads
     // can take a while.
-    std::thread([&, ThreadCount] {
-      for (size_t i = 1; i < ThreadCount; ++i) {
-        std::thread([=] { work(); }).detach();
+    std::thread([&, ThreadCount, S] {
+      for (unsigned I = 1; I < ThreadCount; ++I) {
+        std::thread([=] {
+          S.apply_thread_strategy(I);
+          work(I);
+        }).detach();
       }
-      work();
+      S.apply_thread_strategy(0);
+      work(0);
     }).detach();
   }
 
@@ -85,41 +107,116 @@ public:
   }
 
   void add(std::function<void()> F) override {
-    std::unique_lock<std::mutex> Lock(Mutex);
-    WorkStack.push(F);
-    Lock.unlock();
+    TaskTy *Task = new TaskTy(std::move(F));
+    if (WorkerID >= 0) {
+      Queues[WorkerID]->push(Task);
+    } else {
+      std::lock_guard<std::mutex> Lock(SharedMutex);
+      SharedTasks.push_back(Task);
+      NumSharedTasks.store(SharedTasks.size(), std::memory_order_relaxed);
+    }
+    // Pairs with the fence in waitForTask(): either the sleeping thread sees
+    // the new task, or we see that it is about to sleep.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (NumSleepers.load(std::memory_order_relaxed) == 0)
+      return;
+    {
+      std::lock_guard<std::mutex> Lock(Mutex);
+      ++WakeUps;
+    }
     Cond.notify_one();
   }
 
+  bool runPendingTask() override {
+    if (WorkerID < 0)
+      return false;
+    std::unique_ptr<TaskTy> Task(findTask());
+    if (!Task)
+      return false;
+    (*Task)();
+    return true;
+  }
+
 private:
-  void work() {
-    while (true) {
-      std::unique_lock<std::mutex> Lock(Mutex);
-      Cond.wait(Lock, [&] { return Stop || !WorkStack.empty(); });
-      if (Stop)
-        break;
-      auto Task = WorkStack.top();
-      WorkStack.pop();
-      Lock.unlock();
-      Task();
+  /// Returns a task for the current thread of the pool to run, or null if
+  /// there is none.
+  TaskTy *findTask() {
+    if (TaskTy *Task = Queues[WorkerID]->pop())
+      return Task;
+    if (NumSharedTasks.load(std::memory_order_relaxed) != 0) {
+      std::lock_guard<std::mutex> Lock(SharedMutex);
+      if (!SharedTasks.empty()) {
+        TaskTy *Task = SharedTasks.front();
+        SharedTasks.pop_front();
+        NumSharedTasks.store(SharedTasks.size(), std::memory_order_relaxed);
+        return Task;
+      }
+    }
+    for (size_t I = 1, E = Queues.size(); I < E; ++I)
+      if (TaskTy *Task = Queues[(WorkerID + I) % E]->steal())
+        return Task;
+    return nullptr;
+  }
+
+  /// Blocks until a task is added or the executor stops, unless a task shows
+  /// up while the current thread gets ready to sleep. Returns that task, if
+  /// any.
+  TaskTy *waitForTask() {
+    std::unique_lock<std::mutex> Lock(Mutex);
+    uint64_t SeenWakeUps = WakeUps;
+    ++NumSleepers;
+    Lock.unlock();
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    TaskTy *Task = findTask();
+    Lock.lock();
+    if (!Task)
+      Cond.wait(Lock, [&] { return Stop || WakeUps != SeenWakeUps; });
+    --NumSleepers;
+    return Task;
+  }
+
+  void work(unsigned ID) {
+    WorkerID = ID;
+    while (!Stop) {
+      std::unique_ptr<TaskTy> Task(findTask());
+      if (!Task)
+        Task.reset(waitForTask());
+      if (Task)
+        (*Task)();
     }
     Done.dec();
   }
 
+  /// The index of the current thread in the pool, or -1 if it is not one of
+  /// its threads. There is only ever one ThreadPoolExecutor.
+  static LLVM_THREAD_LOCAL int WorkerID;
+
   std::atomic<bool> Stop{false};
-  std::stack<std::function<void()>> WorkStack;
+  std::vector<std::unique_ptr<WorkStealingQueue<TaskTy>>> Queues;
+
+  std::mutex SharedMutex;
+  std::deque<TaskTy *> SharedTasks;
+  std::atomic<size_t> NumSharedTasks{0};
+
+  /// Threads with nothing to run wait on Cond for WakeUps to change.
   std::mutex Mutex;
   std::condition_variable Cond;
+  uint64_t WakeUps = 0;
+  std::atomic<unsigned> NumSleepers{0};
+
   parallel::detail::Latch Done;
 };
 
+LLVM_THREAD_LOCAL int ThreadPoolExecutor::WorkerID = -1;
+
 Executor *Executor::getDefaultExecutor() {
-  static ThreadPoolExecutor exec;
+  static ThreadPoolExecutor exec(strategy);
   return &exec;
 }
 #endif
 }
 
+#if defined(_MSC_VER)
 static std::atomic<int> TaskGroupInstances;
 
 // Latch::sync() called by the dtor may cause one thread to block. If is a dead
@@ -128,6 +225,12 @@ static std::atomic<int> TaskGroupInstances;
 // of nested parallel_for_each(), only the outermost one runs parallelly.
 TaskGroup::TaskGroup() : Parallel(TaskGroupInstances++ == 0) {}
 TaskGroup::~TaskGroup() { --TaskGroupInstances; }
+#else
+// A thread of the pool that waits for a TaskGroup runs pending tasks in the
+// meantime (see sync()), so nested TaskGroups run in parallel as well.
+TaskGroup::TaskGroup() : Parallel(true) {}
+TaskGroup::~TaskGroup() { sync(); }
+#endif
 
 void TaskGroup::spawn(std::function<void()> F) {
   if (Parallel) {
@@ -141,6 +244,16 @@ void TaskGroup::spawn(std::function<void()> F) {
   }
 }
 
+void TaskGroup::sync() const {
+  // The pending tasks are likely to include some of this group. Running them
+  // instead of blocking also guarantees progress when every thread of the
+  // pool waits for a nested group.
+  Executor *E = Executor::getDefaultExecutor();
+  while (!L.isDone() && E->runPendingTask())
+    ;
+  L.sync();
+}
+
 } // namespace detail
 } // namespace parallel
 } // namespace llvm
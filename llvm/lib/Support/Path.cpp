@@ -22,6 +22,10 @@
 #include <cctype>
 #include <cstring>
 
+#if LLVM_ENABLE_THREADS
+#include <thread>
+#endif
+
 #if !defined(_MSC_VER) && !defined(__MINGW32__)
 #include <unistd.h>
 #else
@@ -1104,6 +1108,20 @@ ErrorOr<perms> getPermissions(const Twine &Path) {
   return Status.permissions();
 }
 
+void prefetchFilesInBackground(std::vector<std::string> Paths) {
+#if LLVM_ENABLE_THREADS
+  if (Paths.empty())
+    return;
+  std::thread(
+      [](std::vector<std::string> Paths) {
+        for (const std::string &Path : Paths)
+          prefetchFile(Path);
+      },
+      std::move(Paths))
+      .detach();
+#endif
+}
+
 } // end namespace fs
 } // end namespace sys
 } // end namespace llvm
@@ -16,12 +16,27 @@
 
 #include "llvm/Support/SHA1.h"
 #include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Support/Endian.h"
 #include "llvm/Support/Host.h"
 using namespace llvm;
 
+#include <algorithm>
 #include <stdint.h>
 #include <string.h>
 
+// The x86 SHA extensions are detected at run time, so they may be used even
+// if the compiler was not told that the target has them. The ARMv8
+// cryptography extension is only used if the target is known to have it.
+#if (defined(__x86_64__) || defined(__i386__)) &&                              \
+    (defined(__clang__) || (defined(__GNUC__) && __GNUC__ >= 5))
+#define LLVM_SHA1_HAS_SHANI
+#include <immintrin.h>
+#elif defined(__aarch64__) && defined(__ARM_FEATURE_CRYPTO)
+#define LLVM_SHA1_HAS_ARM_CRYPTO
+#include <arm_neon.h>
+#endif
+
 #if defined(BYTE_ORDER) && defined(BIG_ENDIAN) && BYTE_ORDER == BIG_ENDIAN
 #define SHA_BIG_ENDIAN
 #endif
@@ -81,6 +96,251 @@ static void r4(uint32_t &A, uint32_t &B, uint32_t &C, uint32_t &D, uint32_t &E,
 #define SEED_3 0x10325476
 #define SEED_4 0xc3d2e1f0
 
+/// Hashes \p NumBlocks consecutive blocks of \p Data into \p State.
+static void hashBlocksPortable(uint32_t *State, const uint8_t *Data,
+                               size_t NumBlocks) {
+  for (; NumBlocks; --NumBlocks, Data += 64) {
+    uint32_t Buf[16];
+    for (int I = 0; I != 16; ++I)
+      Buf[I] = support::endian::read32be(Data + 4 * I);
+
+    uint32_t A = State[0];
+    uint32_t B = State[1];
+    uint32_t C = State[2];
+    uint32_t D = State[3];
+    uint32_t E = State[4];
+
+    // 4 rounds of 20 operations each. Loop unrolled.
+    r0(A, B, C, D, E, 0, Buf);
+    r0(E, A, B, C, D, 1, Buf);
+    r0(D, E, A, B, C, 2, Buf);
+    r0(C, D, E, A, B, 3, Buf);
+    r0(B, C, D, E, A, 4, Buf);
+    r0(A, B, C, D, E, 5, Buf);
+    r0(E, A, B, C, D, 6, Buf);
+    r0(D, E, A, B, C, 7, Buf);
+    r0(C, D, E, A, B, 8, Buf);
+    r0(B, C, D, E, A, 9, Buf);
+    r0(A, B, C, D, E, 10, Buf);
+    r0(E, A, B, C, D, 11, Buf);
+    r0(D, E, A, B, C, 12, Buf);
+    r0(C, D, E, A, B, 13, Buf);
+    r0(B, C, D, E, A, 14, Buf);
+    r0(A, B, C, D, E, 15, Buf);
+    r1(E, A, B, C, D, 16, Buf);
+    r1(D, E, A, B, C, 17, Buf);
+    r1(C, D, E, A, B, 18, Buf);
+    r1(B, C, D, E, A, 19, Buf);
+
+    r2(A, B, C, D, E, 20, Buf);
+    r2(E, A, B, C, D, 21, Buf);
+    r2(D, E, A, B, C, 22, Buf);
+    r2(C, D, E, A, B, 23, Buf);
+    r2(B, C, D, E, A, 24, Buf);
+    r2(A, B, C, D, E, 25, Buf);
+    r2(E, A, B, C, D, 26, Buf);
+    r2(D, E, A, B, C, 27, Buf);
+    r2(C, D, E, A, B, 28, Buf);
+    r2(B, C, D, E, A, 29, Buf);
+    r2(A, B, C, D, E, 30, Buf);
+    r2(E, A, B, C, D, 31, Buf);
+    r2(D, E, A, B, C, 32, Buf);
+    r2(C, D, E, A, B, 33, Buf);
+    r2(B, C, D, E, A, 34, Buf);
+    r2(A, B, C, D, E, 35, Buf);
+    r2(E, A, B, C, D, 36, Buf);
+    r2(D, E, A, B, C, 37, Buf);
+    r2(C, D, E, A, B, 38, Buf);
+    r2(B, C, D, E, A, 39, Buf);
+
+    r3(A, B, C, D, E, 40, Buf);
+    r3(E, A, B, C, D, 41, Buf);
+    r3(D, E, A, B, C, 42, Buf);
+    r3(C, D, E, A, B, 43, Buf);
+    r3(B, C, D, E, A, 44, Buf);
+    r3(A, B, C, D, E, 45, Buf);
+    r3(E, A, B, C, D, 46, Buf);
+    r3(D, E, A, B, C, 47, Buf);
+    r3(C, D, E, A, B, 48, Buf);
+    r3(B, C, D, E, A, 49, Buf);
+    r3(A, B, C, D, E, 50, Buf);
+    r3(E, A, B, C, D, 51, Buf);
+    r3(D, E, A, B, C, 52, Buf);
+    r3(C, D, E, A, B, 53, Buf);
+    r3(B, C, D, E, A, 54, Buf);
+    r3(A, B, C, D, E, 55, Buf);
+    r3(E, A, B, C, D, 56, Buf);
+    r3(D, E, A, B, C, 57, Buf);
+    r3(C, D, E, A, B, 58, Buf);
+    r3(B, C, D, E, A, 59, Buf);
+
+    r4(A, B, C, D, E, 60, Buf);
+    r4(E, A, B, C, D, 61, Buf);
+    r4(D, E, A, B, C, 62, Buf);
+    r4(C, D, E, A, B, 63, Buf);
+    r4(B, C, D, E, A, 64, Buf);
+    r4(A, B, C, D, E, 65, Buf);
+    r4(E, A, B, C, D, 66, Buf);
+    r4(D, E, A, B, C, 67, Buf);
+    r4(C, D, E, A, B, 68, Buf);
+    r4(B, C, D, E, A, 69, Buf);
+    r4(A, B, C, D, E, 70, Buf);
+    r4(E, A, B, C, D, 71, Buf);
+    r4(D, E, A, B, C, 72, Buf);
+    r4(C, D, E, A, B, 73, Buf);
+    r4(B, C, D, E, A, 74, Buf);
+    r4(A, B, C, D, E, 75, Buf);
+    r4(E, A, B, C, D, 76, Buf);
+    r4(D, E, A, B, C, 77, Buf);
+    r4(C, D, E, A, B, 78, Buf);
+    r4(B, C, D, E, A, 79, Buf);
+
+    State[0] += A;
+    State[1] += B;
+    State[2] += C;
+    State[3] += D;
+    State[4] += E;
+  }
+}
+
+#if defined(LLVM_SHA1_HAS_SHANI)
+/// Hashes \p NumBlocks consecutive blocks of \p Data into \p State with the
+/// x86 SHA extensions.
+__attribute__((target("sha,sse4.1,ssse3"))) static void
+hashBlocksSHANI(uint32_t *State, const uint8_t *Data, size_t NumBlocks) {
+  // Reverses the bytes of the block, so that the first word of the block ends
+  // up big-endian in the highest lane.
+  const __m128i Mask =
+      _mm_set_epi64x(0x0001020304050607ULL, 0x08090a0b0c0d0e0fULL);
+
+  // The instructions keep A in the highest lane and E in a separate register.
+  __m128i ABCD = _mm_shuffle_epi32(
+      _mm_loadu_si128(reinterpret_cast<const __m128i *>(State)), 0x1B);
+  __m128i E0 = _mm_set_epi32(State[4], 0, 0, 0);
+
+  for (; NumBlocks; --NumBlocks, Data += 64) {
+    const __m128i *In = reinterpret_cast<const __m128i *>(Data);
+    __m128i ABCDSave = ABCD;
+    __m128i E0Save = E0;
+    __m128i Msg[4];
+    for (int I = 0; I != 4; ++I)
+      Msg[I] = _mm_shuffle_epi8(_mm_loadu_si128(In + I), Mask);
+
+    // Each step of 4 rounds uses the next 4 words of the message schedule,
+    // and the E computed from the A from before the previous step.
+    __m128i E = _mm_add_epi32(E0, Msg[0]);
+    __m128i PrevABCD;
+#define SHA1_ROUNDS4(I, FUNC)                                                  \
+  do {                                                                         \
+    if (I >= 4)                                                                \
+      Msg[I % 4] = _mm_sha1msg2_epu32(                                         \
+          _mm_xor_si128(_mm_sha1msg1_epu32(Msg[I % 4], Msg[(I + 1) % 4]),      \
+                        Msg[(I + 2) % 4]),                                     \
+          Msg[(I + 3) % 4]);                                                   \
+    if (I > 0)                                                                 \
+      E = _mm_sha1nexte_epu32(PrevABCD, Msg[I % 4]);                           \
+    PrevABCD = ABCD;                                                           \
+    ABCD = _mm_sha1rnds4_epu32(ABCD, E, FUNC);                                 \
+  } while (false)
+    SHA1_ROUNDS4(0, 0);
+    SHA1_ROUNDS4(1, 0);
+    SHA1_ROUNDS4(2, 0);
+    SHA1_ROUNDS4(3, 0);
+    SHA1_ROUNDS4(4, 0);
+    SHA1_ROUNDS4(5, 1);
+    SHA1_ROUNDS4(6, 1);
+    SHA1_ROUNDS4(7, 1);
+    SHA1_ROUNDS4(8, 1);
+    SHA1_ROUNDS4(9, 1);
+    SHA1_ROUNDS4(10, 2);
+    SHA1_ROUNDS4(11, 2);
+    SHA1_ROUNDS4(12, 2);
+    SHA1_ROUNDS4(13, 2);
+    SHA1_ROUNDS4(14, 2);
+    SHA1_ROUNDS4(15, 3);
+    SHA1_ROUNDS4(16, 3);
+    SHA1_ROUNDS4(17, 3);
+    SHA1_ROUNDS4(18, 3);
+    SHA1_ROUNDS4(19, 3);
+#undef SHA1_ROUNDS4
+
+    E0 = _mm_sha1nexte_epu32(PrevABCD, E0Save);
+    ABCD = _mm_add_epi32(ABCD, ABCDSave);
+  }
+
+  _mm_storeu_si128(reinterpret_cast<__m128i *>(State),
+                   _mm_shuffle_epi32(ABCD, 0x1B));
+  State[4] = _mm_extract_epi32(E0, 3);
+}
+#endif
+
+#if defined(LLVM_SHA1_HAS_ARM_CRYPTO)
+/// Hashes \p NumBlocks consecutive blocks of \p Data into \p State with the
+/// ARMv8 cryptography extension.
+static void hashBlocksARM(uint32_t *State, const uint8_t *Data,
+                          size_t NumBlocks) {
+  static const uint32_t K[4] = {SHA1_K0, SHA1_K20, SHA1_K40, SHA1_K60};
+  uint32x4_t ABCD = vld1q_u32(State);
+  uint32_t E0 = State[4];
+
+  for (; NumBlocks; --NumBlocks, Data += 64) {
+    uint32x4_t ABCDSave = ABCD;
+    uint32_t E0Save = E0;
+    uint32x4_t Msg[4];
+    for (int I = 0; I != 4; ++I)
+      Msg[I] = vreinterpretq_u32_u8(vrev32q_u8(vld1q_u8(Data + 16 * I)));
+
+    uint32_t E = E0;
+    for (int I = 0; I != 20; ++I) {
+      if (I >= 4)
+        Msg[I % 4] = vsha1su1q_u32(
+            vsha1su0q_u32(Msg[I % 4], Msg[(I + 1) % 4], Msg[(I + 2) % 4]),
+            Msg[(I + 3) % 4]);
+      uint32x4_t W = vaddq_u32(Msg[I % 4], vdupq_n_u32(K[I / 5]));
+      uint32_t NextE = vsha1h_u32(vgetq_lane_u32(ABCD, 0));
+      if (I < 5)
+        ABCD = vsha1cq_u32(ABCD, E, W);
+      else if (I >= 10 && I < 15)
+        ABCD = vsha1mq_u32(ABCD, E, W);
+      else
+        ABCD = vsha1pq_u32(ABCD, E, W);
+      E = NextE;
+    }
+
+    E0 = E + E0Save;
+    ABCD = vaddq_u32(ABCD, ABCDSave);
+  }
+
+  vst1q_u32(State, ABCD);
+  State[4] = E0;
+}
+#endif
+
+using HashBlocksFn = void (*)(uint32_t *, const uint8_t *, size_t);
+
+/// Returns the fastest implementation of the compression function that the
+/// host supports.
+static HashBlocksFn selectHashBlocks() {
+#if defined(LLVM_SHA1_HAS_ARM_CRYPTO)
+  return hashBlocksARM;
+#else
+#if defined(LLVM_SHA1_HAS_SHANI)
+  StringMap<bool> Features;
+  if (sys::getHostCPUFeatures(Features) && Features.lookup("sha") &&
+      Features.lookup("sse4.1") && Features.lookup("ssse3"))
+    return hashBlocksSHANI;
+#endif
+  return hashBlocksPortable;
+#endif
+}
+
+static void hashBlocks(uint32_t *State, const uint8_t *Data,
+                       size_t NumBlocks) {
+  static const HashBlocksFn Impl = selectHashBlocks();
+  Impl(State, Data, NumBlocks);
+}
+
+
 void SHA1::init() {
   InternalState.State[0] = SEED_0;
   InternalState.State[1] = SEED_1;
@@ -92,110 +352,11 @@ void SHA1::init() {
 }
 
 void SHA1::hashBlock() {
-  uint32_t A = InternalState.State[0];
-  uint32_t B = InternalState.State[1];
-  uint32_t C = InternalState.State[2];
-  uint32_t D = InternalState.State[3];
-  uint32_t E = InternalState.State[4];
-
-  // 4 rounds of 20 operations each. Loop unrolled.
-  r0(A, B, C, D, E, 0, InternalState.Buffer.L);
-  r0(E, A, B, C, D, 1, InternalState.Buffer.L);
-  r0(D, E, A, B, C, 2, InternalState.Buffer.L);
-  r0(C, D, E, A, B, 3, InternalState.Buffer.L);
-  r0(B, C, D, E, A, 4, InternalState.Buffer.L);
-  r0(A, B, C, D, E, 5, InternalState.Buffer.L);
-  r0(E, A, B, C, D, 6, InternalState.Buffer.L);
-  r0(D, E, A, B, C, 7, InternalState.Buffer.L);
-  r0(C, D, E, A, B, 8, InternalState.Buffer.L);
-  r0(B, C, D, E, A, 9, InternalState.Buffer.L);
-  r0(A, B, C, D, E, 10, InternalState.Buffer.L);
-  r0(E, A, B, C, D, 11, InternalState.Buffer.L);
-  r0(D, E, A, B, C, 12, InternalState.Buffer.L);
-  r0(C, D, E, A, B, 13, InternalState.Buffer.L);
-  r0(B, C, D, E, A, 14, InternalState.Buffer.L);
-  r0(A, B, C, D, E, 15, InternalState.Buffer.L);
-  r1(E, A, B, C, D, 16, InternalState.Buffer.L);
-  r1(D, E, A, B, C, 17, InternalState.Buffer.L);
-  r1(C, D, E, A, B, 18, InternalState.Buffer.L);
-  r1(B, C, D, E, A, 19, InternalState.Buffer.L);
-
-  r2(A, B, C, D, E, 20, InternalState.Buffer.L);
-  r2(E, A, B, C, D, 21, InternalState.Buffer.L);
-  r2(D, E, A, B, C, 22, InternalState.Buffer.L);
-  r2(C, D, E, A, B, 23, InternalState.Buffer.L);
-  r2(B, C, D, E, A, 24, InternalState.Buffer.L);
-  r2(A, B, C, D, E, 25, InternalState.Buffer.L);
-  r2(E, A, B, C, D, 26, InternalState.Buffer.L);
-  r2(D, E, A, B, C, 27, InternalState.Buffer.L);
-  r2(C, D, E, A, B, 28, InternalState.Buffer.L);
-  r2(B, C, D, E, A, 29, InternalState.Buffer.L);
-  r2(A, B, C, D, E, 30, InternalState.Buffer.L);
-  r2(E, A, B, C, D, 31, InternalState.Buffer.L);
-  r2(D, E, A, B, C, 32, InternalState.Buffer.L);
-  r2(C, D, E, A, B, 33, InternalState.Buffer.L);
-  r2(B, C, D, E, A, 34, InternalState.Buffer.L);
-  r2(A, B, C, D, E, 35, InternalState.Buffer.L);
-  r2(E, A, B, C, D, 36, InternalState.Buffer.L);
-  r2(D, E, A, B, C, 37, InternalState.Buffer.L);
-  r2(C, D, E, A, B, 38, InternalState.Buffer.L);
-  r2(B, C, D, E, A, 39, InternalState.Buffer.L);
-
-  r3(A, B, C, D, E, 40, InternalState.Buffer.L);
-  r3(E, A, B, C, D, 41, InternalState.Buffer.L);
-  r3(D, E, A, B, C, 42, InternalState.Buffer.L);
-  r3(C, D, E, A, B, 43, InternalState.Buffer.L);
-  r3(B, C, D, E, A, 44, InternalState.Buffer.L);
-  r3(A, B, C, D, E, 45, InternalState.Buffer.L);
-  r3(E, A, B, C, D, 46, InternalState.Buffer.L);
-  r3(D, E, A, B, C, 47, InternalState.Buffer.L);
-  r3(C, D, E, A, B, 48, InternalState.Buffer.L);
-  r3(B, C, D, E, A, 49, InternalState.Buffer.L);
-  r3(A, B, C, D, E, 50, InternalState.Buffer.L);
-  r3(E, A, B, C, D, 51, InternalState.Buffer.L);
-  r3(D, E, A, B, C, 52, InternalState.Buffer.L);
-  r3(C, D, E, A, B, 53, InternalState.Buffer.L);
-  r3(B, C, D, E, A, 54, InternalState.Buffer.L);
-  r3(A, B, C, D, E, 55, InternalState.Buffer.L);
-  r3(E, A, B, C, D, 56, InternalState.Buffer.L);
-  r3(D, E, A, B, C, 57, InternalState.Buffer.L);
-  r3(C, D, E, A, B, 58, InternalState.Buffer.L);
-  r3(B, C, D, E, A, 59, InternalState.Buffer.L);
-
-  r4(A, B, C, D, E, 60, InternalState.Buffer.L);
-  r4(E, A, B, C, D, 61, InternalState.Buffer.L);
-  r4(D, E, A, B, C, 62, InternalState.Buffer.L);
-  r4(C, D, E, A, B, 63, InternalState.Buffer.L);
-  r4(B, C, D, E, A, 64, InternalState.Buffer.L);
-  r4(A, B, C, D, E, 65, InternalState.Buffer.L);
-  r4(E, A, B, C, D, 66, InternalState.Buffer.L);
-  r4(D, E, A, B, C, 67, InternalState.Buffer.L);
-  r4(C, D, E, A, B, 68, InternalState.Buffer.L);
-  r4(B, C, D, E, A, 69, InternalState.Buffer.L);
-  r4(A, B, C, D, E, 70, InternalState.Buffer.L);
-  r4(E, A, B, C, D, 71, InternalState.Buffer.L);
-  r4(D, E, A, B, C, 72, InternalState.Buffer.L);
-  r4(C, D, E, A, B, 73, InternalState.Buffer.L);
-  r4(B, C, D, E, A, 74, InternalState.Buffer.L);
-  r4(A, B, C, D, E, 75, InternalState.Buffer.L);
-  r4(E, A, B, C, D, 76, InternalState.Buffer.L);
-  r4(D, E, A, B, C, 77, InternalState.Buffer.L);
-  r4(C, D, E, A, B, 78, InternalState.Buffer.L);
-  r4(B, C, D, E, A, 79, InternalState.Buffer.L);
-
-  InternalState.State[0] += A;
-  InternalState.State[1] += B;
-  InternalState.State[2] += C;
-  InternalState.State[3] += D;
-  InternalState.State[4] += E;
+  hashBlocks(InternalState.State, InternalState.Buffer, 1);
 }
 
 void SHA1::addUncounted(uint8_t Data) {
-#ifdef SHA_BIG_ENDIAN
-  InternalState.Buffer.C[InternalState.BufferOffset] = Data;
-#else
-  InternalState.Buffer.C[InternalState.BufferOffset ^ 3] = Data;
-#endif
+  InternalState.Buffer[InternalState.BufferOffset] = Data;
 
   InternalState.BufferOffset++;
   if (InternalState.BufferOffset == BLOCK_LENGTH) {
@@ -204,14 +365,28 @@ void SHA1::addUncounted(uint8_t Data) {
   }
 }
 
-void SHA1::writebyte(uint8_t Data) {
-  ++InternalState.ByteCount;
-  addUncounted(Data);
-}
-
 void SHA1::update(ArrayRef<uint8_t> Data) {
-  for (auto &C : Data)
-    writebyte(C);
+  InternalState.ByteCount += Data.size();
+
+  // Finish the current block, if any.
+  if (InternalState.BufferOffset) {
+    size_t Size = std::min<size_t>(Data.size(),
+                                   BLOCK_LENGTH - InternalState.BufferOffset);
+    for (uint8_t C : Data.take_front(Size))
+      addUncounted(C);
+    Data = Data.drop_front(Size);
+  }
+
+  // Hash the whole blocks in place.
+  size_t NumBlocks = Data.size() / BLOCK_LENGTH;
+  if (NumBlocks) {
+    hashBlocks(InternalState.State, Data.data(), NumBlocks);
+    Data = Data.drop_front(NumBlocks * BLOCK_LENGTH);
+  }
+
+  // Buffer the rest.
+  for (uint8_t C : Data)
+    addUncounted(C);
 }
 
 void SHA1::pad() {
@@ -219,19 +394,23 @@ void SHA1::pad() {
 
   // Pad with 0x80 followed by 0x00 until the end of the block
   addUncounted(0x80);
-  while (InternalState.BufferOffset != 56)
-    addUncounted(0x00);
-
-  // Append length in the last 8 bytes
-  addUncounted(0); // We're only using 32 bit lengths
-  addUncounted(0); // But SHA-1 supports 64 bit lengths
-  addUncounted(0); // So zero pad the top bits
-  addUncounted(InternalState.ByteCount >> 29); // Shifting to multiply by 8
-  addUncounted(InternalState.ByteCount >>
-               21); // as SHA-1 supports bitstreams as well as
-  addUncounted(InternalState.ByteCount >> 13); // byte.
-  addUncounted(InternalState.ByteCount >> 5);
-  addUncounted(InternalState.ByteCount << 3);
+  if (InternalState.BufferOffset > 56) {
+    memset(InternalState.Buffer + InternalState.BufferOffset, 0,
+           BLOCK_LENGTH - InternalState.BufferOffset);
+    hashBlock();
+    InternalState.BufferOffset = 0;
+  }
+  memset(InternalState.Buffer + InternalState.BufferOffset, 0,
+         56 - InternalState.BufferOffset);
+
+  // Append the length in bits in the last 8 bytes. We're only using 32 bit
+  // lengths, so the top bits are zero.
+  support::endian::write32be(InternalState.Buffer + 56,
+                             InternalState.ByteCount >> 29);
+  support::endian::write32be(InternalState.Buffer + 60,
+                             InternalState.ByteCount << 3);
+  hashBlock();
+  InternalState.BufferOffset = 0;
 }
 
 StringRef SHA1::final() {
@@ -12,7 +12,9 @@
 
 #include "llvm/Support/ThreadPool.h"
 
+#include "llvm/ADT/STLExtras.h"
 #include "llvm/Config/llvm-config.h"
+#include "llvm/Support/Compiler.h"
 #include "llvm/Support/Threading.h"
 #include "llvm/Support/raw_ostream.h"
 
@@ -20,78 +22,136 @@ using namespace llvm;
 
 #if LLVM_ENABLE_THREADS
 
+/// The pool that the current thread belongs to, and its index in the pool.
+static LLVM_THREAD_LOCAL ThreadPool *CurrentPool = nullptr;
+static LLVM_THREAD_LOCAL unsigned CurrentThreadID = 0;
+
 // Default to hardware_concurrency
 ThreadPool::ThreadPool() : ThreadPool(hardware_concurrency()) {}
 
 ThreadPool::ThreadPool(unsigned ThreadCount)
-    : ActiveThreads(0), EnableFlag(true) {
+    : ThreadPool(ThreadCount, ThreadPoolStrategy()) {}
+
+ThreadPool::ThreadPool(ThreadPoolStrategy S)
+    : ThreadPool(S.compute_thread_count(), S) {}
+
+ThreadPool::ThreadPool(unsigned ThreadCount, ThreadPoolStrategy S)
+    : PendingTasks(0), EnableFlag(true), IdleThreads(0) {
+  // Threads look into each other's queues, so create all of them first.
+  LocalTasks.reserve(ThreadCount);
+  for (unsigned ThreadID = 0; ThreadID < ThreadCount; ++ThreadID)
+    LocalTasks.emplace_back(new WorkStealingQueue<PackagedTaskTy>());
   // Create ThreadCount threads that will loop forever, wait on QueueCondition
   // for tasks to be queued or the Pool to be destroyed.
   Threads.reserve(ThreadCount);
-  for (unsigned ThreadID = 0; ThreadID < ThreadCount; ++ThreadID) {
-    Threads.emplace_back([&] {
-      while (true) {
-        PackagedTaskTy Task;
-        {
-          std::unique_lock<std::mutex> LockGuard(QueueLock);
-          // Wait for tasks to be pushed in the queue
-          QueueCondition.wait(LockGuard,
-                              [&] { return !EnableFlag || !Tasks.empty(); });
-          // Exit condition
-          if (!EnableFlag && Tasks.empty())
-            return;
-          // Yeah, we have a task, grab it and release the lock on the queue
-
-          // We first need to signal that we are active before popping the queue
-          // in order for wait() to properly detect that even if the queue is
-          // empty, there is still a task in flight.
-          {
-            std::unique_lock<std::mutex> LockGuard(CompletionLock);
-            ++ActiveThreads;
-          }
-          Task = std::move(Tasks.front());
-          Tasks.pop();
-        }
-        // Run the task we just grabbed
-        Task();
-
-        {
-          // Adjust `ActiveThreads`, in case someone waits on ThreadPool::wait()
-          std::unique_lock<std::mutex> LockGuard(CompletionLock);
-          --ActiveThreads;
-        }
-
-        // Notify task completion, in case someone waits on ThreadPool::wait()
-        CompletionCondition.notify_all();
-      }
+  for (unsigned ThreadID = 0; ThreadID < ThreadCount; ++ThreadID)
+    Threads.emplace_back([=] {
+      S.apply_thread_strategy(ThreadID);
+      work(ThreadID);
     });
+}
+
+ThreadPool::PackagedTaskTy *ThreadPool::findTask(unsigned ThreadID) {
+  if (PackagedTaskTy *Task = LocalTasks[ThreadID]->pop())
+    return Task;
+  {
+    std::unique_lock<std::mutex> LockGuard(QueueLock);
+    if (!Tasks.empty()) {
+      PackagedTaskTy *Task = Tasks.front().release();
+      Tasks.pop();
+      return Task;
+    }
+  }
+  for (size_t I = 1, E = LocalTasks.size(); I < E; ++I)
+    if (PackagedTaskTy *Task = LocalTasks[(ThreadID + I) % E]->steal())
+      return Task;
+  return nullptr;
+}
+
+void ThreadPool::work(unsigned ThreadID) {
+  CurrentPool = this;
+  CurrentThreadID = ThreadID;
+  while (true) {
+    std::unique_ptr<PackagedTaskTy> Task(findTask(ThreadID));
+    if (!Task) {
+      std::unique_lock<std::mutex> LockGuard(QueueLock);
+      uint64_t SeenWakeUps = WakeUps;
+      ++IdleThreads;
+      LockGuard.unlock();
+      // Pairs with the fence in asyncImpl(): either we see the task it queued
+      // to another thread, or it sees that we are about to wait.
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      Task.reset(findTask(ThreadID));
+      LockGuard.lock();
+      // Wait for tasks to be pushed in a queue
+      if (!Task)
+        QueueCondition.wait(LockGuard, [&] {
+          return !EnableFlag || !Tasks.empty() || WakeUps != SeenWakeUps;
+        });
+      --IdleThreads;
+      if (!Task) {
+        // Exit condition. The other threads run what is left in their own
+        // queues before exiting.
+        if (!EnableFlag && Tasks.empty())
+          return;
+        continue;
+      }
+    }
+
+    // Run the task we just grabbed
+    (*Task)();
+    Task.reset();
+
+    {
+      // Adjust `PendingTasks`, in case someone waits on ThreadPool::wait()
+      std::unique_lock<std::mutex> LockGuard(CompletionLock);
+      --PendingTasks;
+    }
+
+    // Notify task completion, in case someone waits on ThreadPool::wait()
+    CompletionCondition.notify_all();
   }
 }
 
 void ThreadPool::wait() {
-  // Wait for all threads to complete and the queue to be empty
+  // Wait for all the tasks to complete. Counting the tasks rather than looking
+  // at the queues also accounts for the tasks that running tasks submit.
   std::unique_lock<std::mutex> LockGuard(CompletionLock);
-  // The order of the checks for ActiveThreads and Tasks.empty() matters because
-  // any active threads might be modifying the Tasks queue, and this would be a
-  // race.
-  CompletionCondition.wait(LockGuard,
-                           [&] { return !ActiveThreads && Tasks.empty(); });
+  CompletionCondition.wait(LockGuard, [&] { return !PendingTasks; });
 }
 
 std::shared_future<void> ThreadPool::asyncImpl(TaskTy Task) {
   /// Wrap the Task in a packaged_task to return a future object.
-  PackagedTaskTy PackagedTask(std::move(Task));
-  auto Future = PackagedTask.get_future();
-  {
-    // Lock the queue and push the new task
-    std::unique_lock<std::mutex> LockGuard(QueueLock);
-
-    // Don't allow enqueueing after disabling the pool
-    assert(EnableFlag && "Queuing a thread during ThreadPool destruction");
+  auto PackagedTask = llvm::make_unique<PackagedTaskTy>(std::move(Task));
+  auto Future = PackagedTask->get_future();
+  ++PendingTasks;
+
+  if (CurrentPool != this) {
+    {
+      // Lock the queue and push the new task
+      std::unique_lock<std::mutex> LockGuard(QueueLock);
+
+      // Don't allow enqueueing after disabling the pool
+      assert(EnableFlag && "Queuing a thread during ThreadPool destruction");
+
+      Tasks.push(std::move(PackagedTask));
+    }
+    QueueCondition.notify_one();
+    return Future.share();
+  }
 
-    Tasks.push(std::move(PackagedTask));
+  // A task of this pool is submitting a new task: queue it to the current
+  // thread without taking any lock, and only wake up an idle thread if there
+  // is one to steal it.
+  LocalTasks[CurrentThreadID]->push(PackagedTask.release());
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (IdleThreads.load(std::memory_order_relaxed)) {
+    {
+      std::unique_lock<std::mutex> LockGuard(QueueLock);
+      ++WakeUps;
+    }
+    QueueCondition.notify_one();
   }
-  QueueCondition.notify_one();
   return Future.share();
 }
 
@@ -112,19 +172,21 @@ ThreadPool::ThreadPool() : ThreadPool(0) {}
 
 // No threads are launched, issue a warning if ThreadCount is not 0
 ThreadPool::ThreadPool(unsigned ThreadCount)
-    : ActiveThreads(0) {
+    : PendingTasks(0) {
   if (ThreadCount) {
     errs() << "Warning: request a ThreadPool with " << ThreadCount
            << " threads, but LLVM_ENABLE_THREADS has been turned off\n";
   }
 }
 
+ThreadPool::ThreadPool(ThreadPoolStrategy S) : ThreadPool() {}
+
 void ThreadPool::wait() {
   // Sequential implementation running the tasks
   while (!Tasks.empty()) {
     auto Task = std::move(Tasks.front());
     Tasks.pop();
-    Task();
+    (*Task)();
   }
 }
 
@@ -133,8 +195,8 @@ std::shared_future<void> ThreadPool::asyncImpl(TaskTy Task) {
   auto Future = std::async(std::launch::deferred, std::move(Task)).share();
   // Wrap the future so that both ThreadPool::wait() can operate and the
   // returned future can be sync'ed on.
-  PackagedTaskTy PackagedTask([Future]() { Future.get(); });
-  Tasks.push(std::move(PackagedTask));
+  Tasks.push(
+      llvm::make_unique<PackagedTaskTy>([Future]() { Future.get(); }));
   return Future;
 }
 
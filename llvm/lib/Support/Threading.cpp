@@ -12,13 +12,17 @@
 //===----------------------------------------------------------------------===//
 
 #include "llvm/Support/Threading.h"
+#include "llvm/ADT/ArrayRef.h"
 #include "llvm/Config/config.h"
+#include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/Host.h"
 
+#include <algorithm>
 #include <cassert>
 #include <errno.h>
 #include <stdlib.h>
 #include <string.h>
+#include <vector>
 
 using namespace llvm;
 
@@ -56,6 +60,12 @@ void llvm::set_thread_name(const Twine &Name) {}
 
 void llvm::get_thread_name(SmallVectorImpl<char> &Name) { Name.clear(); }
 
+unsigned ThreadPoolStrategy::compute_thread_count() const { return 1; }
+
+void ThreadPoolStrategy::apply_thread_strategy(unsigned ThreadPoolNum) const {}
+
+unsigned llvm::get_numa_node_count() { return 1; }
+
 #else
 
 #include <thread>
@@ -84,6 +94,72 @@ unsigned llvm::hardware_concurrency() {
   return 1;
 }
 
+// Returns the CPUs the process may run on, grouped by NUMA node in the order
+// of the node numbers, or an empty list if the host does not tell. Defined by
+// the platform-specific parts.
+static const std::vector<std::vector<unsigned>> &getNumaNodeCPUs();
+
+// Restricts the current thread to \p CPUs. Defined by the platform-specific
+// parts.
+static void setThreadAffinity(ArrayRef<unsigned> CPUs);
+
+unsigned llvm::get_numa_node_count() {
+  return std::max<size_t>(getNumaNodeCPUs().size(), 1);
+}
+
+unsigned ThreadPoolStrategy::compute_thread_count() const {
+  if (ThreadsRequested)
+    return ThreadsRequested;
+  unsigned Count = UseHyperThreads ? hardware_concurrency()
+                                   : heavyweight_hardware_concurrency();
+  const std::vector<std::vector<unsigned>> &Nodes = getNumaNodeCPUs();
+  if (NumaNode < 0 || static_cast<size_t>(NumaNode) >= Nodes.size())
+    return Count;
+  size_t NumCPUs = 0;
+  for (const std::vector<unsigned> &CPUs : Nodes)
+    NumCPUs += CPUs.size();
+  return std::max<size_t>(Count * Nodes[NumaNode].size() / NumCPUs, 1);
+}
+
+void ThreadPoolStrategy::apply_thread_strategy(unsigned ThreadPoolNum) const {
+  const std::vector<std::vector<unsigned>> &Nodes = getNumaNodeCPUs();
+  if (Nodes.empty())
+    return;
+
+  if (NumaNode >= 0 && static_cast<size_t>(NumaNode) < Nodes.size()) {
+    const std::vector<unsigned> &CPUs = Nodes[NumaNode];
+    if (Affinity == ThreadAffinity::None)
+      setThreadAffinity(CPUs);
+    else
+      setThreadAffinity(CPUs[ThreadPoolNum % CPUs.size()]);
+    return;
+  }
+
+  switch (Affinity) {
+  case ThreadAffinity::None:
+    return;
+  case ThreadAffinity::Compact: {
+    size_t NumCPUs = 0;
+    for (const std::vector<unsigned> &CPUs : Nodes)
+      NumCPUs += CPUs.size();
+    size_t Index = ThreadPoolNum % NumCPUs;
+    for (const std::vector<unsigned> &CPUs : Nodes) {
+      if (Index < CPUs.size()) {
+        setThreadAffinity(CPUs[Index]);
+        return;
+      }
+      Index -= CPUs.size();
+    }
+    llvm_unreachable("CPU index out of range");
+  }
+  case ThreadAffinity::Spread: {
+    const std::vector<unsigned> &CPUs = Nodes[ThreadPoolNum % Nodes.size()];
+    setThreadAffinity(CPUs[(ThreadPoolNum / Nodes.size()) % CPUs.size()]);
+    return;
+  }
+  }
+}
+
 // Include the platform-specific parts of this class.
 #ifdef LLVM_ON_UNIX
 #include "Unix/Threading.inc"
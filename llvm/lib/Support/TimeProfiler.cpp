@@ -14,7 +14,9 @@
 #include "llvm/ADT/StringMap.h"
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Format.h"
 #include "llvm/Support/JSON.h"
+#include <algorithm>
 #include <cassert>
 #include <chrono>
 #include <string>
@@ -49,8 +51,17 @@ struct Entry {
         Detail(std::move(Dt)){};
 };
 
+struct CounterEntry {
+  time_point<steady_clock> Time;
+  std::string Name;
+  int64_t Value;
+
+  CounterEntry(time_point<steady_clock> &&T, std::string &&N, int64_t V)
+      : Time(std::move(T)), Name(std::move(N)), Value(V){};
+};
+
 struct TimeTraceProfiler {
-  TimeTraceProfiler() {
+  TimeTraceProfiler(StringRef ProcName) : ProcName(ProcName) {
     StartTime = steady_clock::now();
   }
 
@@ -84,6 +95,10 @@ struct TimeTraceProfiler {
     Stack.pop_back();
   }
 
+  void counter(std::string Name, int64_t Value) {
+    Counters.emplace_back(steady_clock::now(), std::move(Name), Value);
+  }
+
   void Write(raw_pwrite_stream &OS) {
     assert(Stack.empty() &&
            "All profiler sections should be ended when calling Write");
@@ -111,17 +126,7 @@ struct TimeTraceProfiler {
     // Emit totals by section name as additional "thread" events, sorted from
     // longest one.
     int Tid = 1;
-    std::vector<NameAndCountAndDurationType> SortedTotals;
-    SortedTotals.reserve(CountAndTotalPerName.size());
-    for (const auto &E : CountAndTotalPerName)
-      SortedTotals.emplace_back(E.getKey(), E.getValue());
-
-    llvm::sort(SortedTotals.begin(), SortedTotals.end(),
-               [](const NameAndCountAndDurationType &A,
-                  const NameAndCountAndDurationType &B) {
-                 return A.second.second > B.second.second;
-               });
-    for (const auto &E : SortedTotals) {
+    for (const auto &E : getSortedTotals()) {
       auto DurUs = duration_cast<microseconds>(E.second.second).count();
       auto Count = CountAndTotalPerName[E.first].first;
 
@@ -141,6 +146,20 @@ struct TimeTraceProfiler {
       ++Tid;
     }
 
+    // Emit counter events.
+    for (const auto &C : Counters) {
+      auto TimeUs = duration_cast<microseconds>(C.Time - StartTime).count();
+
+      J.object([&] {
+        J.attribute("pid", 1);
+        J.attribute("tid", 0);
+        J.attribute("ph", "C");
+        J.attribute("ts", TimeUs);
+        J.attribute("name", C.Name);
+        J.attributeObject("args", [&] { J.attribute("value", C.Value); });
+      });
+    }
+
     // Emit metadata event with process name.
     J.object([&] {
       J.attribute("cat", "");
@@ -149,7 +168,7 @@ struct TimeTraceProfiler {
       J.attribute("ts", 0);
       J.attribute("ph", "M");
       J.attribute("name", "process_name");
-      J.attributeObject("args", [&] { J.attribute("name", "clang"); });
+      J.attributeObject("args", [&] { J.attribute("name", ProcName); });
     });
 
     J.arrayEnd();
@@ -157,16 +176,57 @@ struct TimeTraceProfiler {
     J.objectEnd();
   }
 
+  void writeSummary(raw_ostream &OS, unsigned TopN) {
+    assert(Stack.empty() &&
+           "All profiler sections should be ended when calling writeSummary");
+    for (const auto &T : getSortedTotals()) {
+      OS << format("%s: %.3f ms in %zu sections\n", T.first.c_str(),
+                   duration<double, std::milli>(T.second.second).count(),
+                   T.second.first);
+
+      std::vector<const Entry *> Longest;
+      for (const Entry &E : Entries)
+        if (E.Name == T.first)
+          Longest.push_back(&E);
+      size_t N = std::min<size_t>(TopN, Longest.size());
+      std::partial_sort(Longest.begin(), Longest.begin() + N, Longest.end(),
+                        [](const Entry *A, const Entry *B) {
+                          return A->Duration > B->Duration;
+                        });
+      for (const Entry *E : makeArrayRef(Longest).take_front(N))
+        OS << format("  %10.3f ms  ",
+                     duration<double, std::milli>(E->Duration).count())
+           << E->Detail << '\n';
+    }
+  }
+
+  /// Totals by section name, sorted from the longest one.
+  std::vector<NameAndCountAndDurationType> getSortedTotals() const {
+    std::vector<NameAndCountAndDurationType> SortedTotals;
+    SortedTotals.reserve(CountAndTotalPerName.size());
+    for (const auto &E : CountAndTotalPerName)
+      SortedTotals.emplace_back(E.getKey(), E.getValue());
+
+    llvm::sort(SortedTotals.begin(), SortedTotals.end(),
+               [](const NameAndCountAndDurationType &A,
+                  const NameAndCountAndDurationType &B) {
+                 return A.second.second > B.second.second;
+               });
+    return SortedTotals;
+  }
+
   SmallVector<Entry, 16> Stack;
   SmallVector<Entry, 128> Entries;
+  std::vector<CounterEntry> Counters;
   StringMap<CountAndDurationType> CountAndTotalPerName;
   time_point<steady_clock> StartTime;
+  std::string ProcName;
 };
 
-void timeTraceProfilerInitialize() {
+void timeTraceProfilerInitialize(StringRef ProcName) {
   assert(TimeTraceProfilerInstance == nullptr &&
          "Profiler should not be initialized");
-  TimeTraceProfilerInstance = new TimeTraceProfiler();
+  TimeTraceProfilerInstance = new TimeTraceProfiler(ProcName);
 }
 
 void timeTraceProfilerCleanup() {
@@ -180,6 +240,12 @@ void timeTraceProfilerWrite(raw_pwrite_stream &OS) {
   TimeTraceProfilerInstance->Write(OS);
 }
 
+void timeTraceProfilerWriteSummary(raw_ostream &OS, unsigned TopN) {
+  assert(TimeTraceProfilerInstance != nullptr &&
+         "Profiler object can't be null");
+  TimeTraceProfilerInstance->writeSummary(OS, TopN);
+}
+
 void timeTraceProfilerBegin(StringRef Name, StringRef Detail) {
   if (TimeTraceProfilerInstance != nullptr)
     TimeTraceProfilerInstance->begin(Name, [&]() { return Detail; });
@@ -196,4 +262,9 @@ void timeTraceProfilerEnd() {
     TimeTraceProfilerInstance->end();
 }
 
+void timeTraceProfilerCounter(StringRef Name, int64_t Value) {
+  if (TimeTraceProfilerInstance != nullptr)
+    TimeTraceProfilerInstance->counter(Name, Value);
+}
+
 } // namespace llvm
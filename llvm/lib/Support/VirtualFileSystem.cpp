@@ -13,12 +13,14 @@
 #include "llvm/Support/VirtualFileSystem.h"
 #include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/Hashing.h"
 #include "llvm/ADT/IntrusiveRefCntPtr.h"
 #include "llvm/ADT/None.h"
 #include "llvm/ADT/Optional.h"
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/SmallString.h"
 #include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/ADT/StringSet.h"
 #include "llvm/ADT/Twine.h"
@@ -517,6 +519,193 @@ directory_iterator OverlayFileSystem::dir_begin(const Twine &Dir,
 
 void ProxyFileSystem::anchor() {}
 
+//===-----------------------------------------------------------------------===/
+// CachingFileSystem implementation
+//===-----------------------------------------------------------------------===/
+
+struct FileSystemCache::Shard {
+  mutable std::mutex Mutex;
+  StringMap<llvm::ErrorOr<Status>> Statuses;
+  StringMap<std::shared_ptr<const DirectoryListing>> Listings;
+};
+
+constexpr unsigned FileSystemCache::NumShards;
+
+FileSystemCache::FileSystemCache(bool CacheMissingFiles)
+    : CacheMissingFiles(CacheMissingFiles), Shards(new Shard[NumShards]) {}
+
+FileSystemCache::~FileSystemCache() = default;
+
+FileSystemCache::Shard &FileSystemCache::getShard(StringRef Path) const {
+  return Shards[hash_value(Path) % NumShards];
+}
+
+void FileSystemCache::invalidate(StringRef Path) {
+  SmallString<256> Key(Path);
+  sys::path::remove_dots(Key);
+  {
+    Shard &S = getShard(Key);
+    std::lock_guard<std::mutex> Lock(S.Mutex);
+    S.Statuses.erase(Key);
+    S.Listings.erase(Key);
+  }
+  StringRef Parent = sys::path::parent_path(Key);
+  if (Parent.empty())
+    return;
+  Shard &S = getShard(Parent);
+  std::lock_guard<std::mutex> Lock(S.Mutex);
+  S.Listings.erase(Parent);
+}
+
+void FileSystemCache::invalidateAll() {
+  for (unsigned I = 0; I != NumShards; ++I) {
+    std::lock_guard<std::mutex> Lock(Shards[I].Mutex);
+    Shards[I].Statuses.clear();
+    Shards[I].Listings.clear();
+  }
+}
+
+Optional<llvm::ErrorOr<Status>>
+FileSystemCache::lookupStatus(StringRef Path) const {
+  Shard &S = getShard(Path);
+  std::lock_guard<std::mutex> Lock(S.Mutex);
+  auto It = S.Statuses.find(Path);
+  if (It == S.Statuses.end())
+    return None;
+  return It->second;
+}
+
+void FileSystemCache::insertStatus(StringRef Path,
+                                   const llvm::ErrorOr<Status> &Result) {
+  // Other errors, such as permission or I/O errors, may be transient.
+  if (!Result && !(CacheMissingFiles &&
+                   Result.getError() == errc::no_such_file_or_directory))
+    return;
+  Shard &S = getShard(Path);
+  std::lock_guard<std::mutex> Lock(S.Mutex);
+  auto Inserted = S.Statuses.insert(std::make_pair(Path, Result));
+  if (!Inserted.second)
+    Inserted.first->second = Result;
+}
+
+std::shared_ptr<const FileSystemCache::DirectoryListing>
+FileSystemCache::lookupListing(StringRef Path) const {
+  Shard &S = getShard(Path);
+  std::lock_guard<std::mutex> Lock(S.Mutex);
+  return S.Listings.lookup(Path);
+}
+
+void FileSystemCache::insertListing(
+    StringRef Path, std::shared_ptr<const DirectoryListing> Listing) {
+  Shard &S = getShard(Path);
+  std::lock_guard<std::mutex> Lock(S.Mutex);
+  S.Listings[Path] = std::move(Listing);
+}
+
+namespace {
+
+/// Iterates over a directory listing from a FileSystemCache.
+class CachedDirIterImpl : public llvm::vfs::detail::DirIterImpl {
+  using ListingTy = std::vector<std::pair<std::string, file_type>>;
+
+  std::string Dir;
+  std::shared_ptr<const ListingTy> Listing;
+  ListingTy::const_iterator Current;
+
+  void setCurrentEntry() {
+    if (Current == Listing->end()) {
+      CurrentEntry = directory_entry();
+      return;
+    }
+    SmallString<256> Path(Dir);
+    llvm::sys::path::append(Path, Current->first);
+    CurrentEntry = directory_entry(Path.str(), Current->second);
+  }
+
+public:
+  CachedDirIterImpl(std::string Dir, std::shared_ptr<const ListingTy> Listing)
+      : Dir(std::move(Dir)), Listing(std::move(Listing)),
+        Current(this->Listing->begin()) {
+    setCurrentEntry();
+  }
+
+  std::error_code increment() override {
+    ++Current;
+    setCurrentEntry();
+    return {};
+  }
+};
+
+} // namespace
+
+CachingFileSystem::CachingFileSystem(IntrusiveRefCntPtr<FileSystem> FS,
+                                     IntrusiveRefCntPtr<FileSystemCache> Cache)
+    : ProxyFileSystem(std::move(FS)), Cache(std::move(Cache)) {}
+
+std::string CachingFileSystem::getCacheKey(const Twine &Path) const {
+  SmallString<256> Key;
+  Path.toVector(Key);
+  if (makeAbsolute(Key))
+    return std::string();
+  sys::path::remove_dots(Key);
+  return Key.str();
+}
+
+llvm::ErrorOr<Status> CachingFileSystem::status(const Twine &Path) {
+  std::string Key = getCacheKey(Path);
+  if (Key.empty())
+    return ProxyFileSystem::status(Path);
+  if (Optional<llvm::ErrorOr<Status>> Cached = Cache->lookupStatus(Key)) {
+    if (!*Cached)
+      return Cached->getError();
+    // The name of a status is the path it was asked for.
+    return Status::copyWithNewName(**Cached, Path);
+  }
+  llvm::ErrorOr<Status> Result = ProxyFileSystem::status(Path);
+  Cache->insertStatus(Key, Result);
+  return Result;
+}
+
+llvm::ErrorOr<std::unique_ptr<File>>
+CachingFileSystem::openFileForRead(const Twine &Path) {
+  std::string Key = getCacheKey(Path);
+  if (!Key.empty())
+    if (Optional<llvm::ErrorOr<Status>> Cached = Cache->lookupStatus(Key))
+      if (!*Cached)
+        return Cached->getError();
+  return ProxyFileSystem::openFileForRead(Path);
+}
+
+directory_iterator CachingFileSystem::dir_begin(const Twine &Dir,
+                                                std::error_code &EC) {
+  std::string Key = getCacheKey(Dir);
+  if (Key.empty())
+    return ProxyFileSystem::dir_begin(Dir, EC);
+  if (Optional<llvm::ErrorOr<Status>> Cached = Cache->lookupStatus(Key)) {
+    if (!*Cached) {
+      EC = Cached->getError();
+      return directory_iterator();
+    }
+  }
+
+  std::shared_ptr<const FileSystemCache::DirectoryListing> Listing =
+      Cache->lookupListing(Key);
+  if (!Listing) {
+    // Read all of the directory, so that it can be cached.
+    auto NewListing = std::make_shared<FileSystemCache::DirectoryListing>();
+    directory_iterator I = ProxyFileSystem::dir_begin(Dir, EC), E;
+    for (; !EC && I != E; I.increment(EC))
+      NewListing->emplace_back(sys::path::filename(I->path()), I->type());
+    if (EC)
+      return directory_iterator();
+    Listing = std::move(NewListing);
+    Cache->insertListing(Key, Listing);
+  }
+  EC = std::error_code();
+  return directory_iterator(
+      std::make_shared<CachedDirIterImpl>(Dir.str(), std::move(Listing)));
+}
+
 namespace llvm {
 namespace vfs {
 
@@ -26,6 +26,7 @@
 #include <algorithm>
 #include <cstdio>
 #include <system_error>
+#include <tuple>
 using namespace llvm;
 
 static cl::opt<std::string>
@@ -49,6 +50,12 @@ static cl::list<std::string>
 MacroNames("D", cl::desc("Name of the macro to be defined"),
             cl::value_desc("macro name"), cl::Prefix);
 
+static cl::list<std::string>
+ExtraOutputs("extra-output",
+             cl::desc("Also run the given action on the parsed records and "
+                      "write its output to the given file"),
+             cl::value_desc("action=filename"));
+
 static int reportError(const char *ProgName, Twine Msg) {
   errs() << ProgName << ": " << Msg;
   errs().flush();
@@ -77,9 +84,38 @@ static int createDependencyFile(const TGParser &Parser, const char *argv0) {
   return 0;
 }
 
-int llvm::TableGenMain(char *argv0, TableGenMainFn *MainFn) {
+/// Write \p Contents to \p Filename, unless the file already has them.
+///
+/// This prevents recompilation of all the files depending on it if there
+/// aren't any differences.
+static int writeIfChanged(const char *argv0, StringRef Filename,
+                          StringRef Contents) {
+  if (auto ExistingOrErr = MemoryBuffer::getFile(Filename))
+    if (std::move(ExistingOrErr.get())->getBuffer() == Contents)
+      return 0;
+
+  std::error_code EC;
+  ToolOutputFile OutFile(Filename, EC, sys::fs::F_Text);
+  if (EC)
+    return reportError(argv0, "error opening " + Filename + ":" +
+                                  EC.message() + "\n");
+  OutFile.os() << Contents;
+
+  if (ErrorsPrinted > 0)
+    return reportError(argv0, Twine(ErrorsPrinted) + " errors.\n");
+
+  // Declare success.
+  OutFile.keep();
+  return 0;
+}
+
+int llvm::TableGenMain(char *argv0, TableGenMainFn *MainFn,
+                       TableGenSelectActionFn *SelectAction) {
   RecordKeeper Records;
 
+  if (!ExtraOutputs.empty() && !SelectAction)
+    return reportError(argv0, "this tool does not support -extra-output\n");
+
   // Parse the input file.
   ErrorOr<std::unique_ptr<MemoryBuffer>> FileOrErr =
       MemoryBuffer::getFileOrSTDIN(InputFilename);
@@ -114,24 +150,25 @@ int llvm::TableGenMain(char *argv0, TableGenMainFn *MainFn) {
       return Ret;
   }
 
-  // Only updates the real output file if there are any differences.
-  // This prevents recompilation of all the files depending on it if there
-  // aren't any.
-  if (auto ExistingOrErr = MemoryBuffer::getFile(OutputFilename))
-    if (std::move(ExistingOrErr.get())->getBuffer() == Out.str())
-      return 0;
-
-  std::error_code EC;
-  ToolOutputFile OutFile(OutputFilename, EC, sys::fs::F_Text);
-  if (EC)
-    return reportError(argv0, "error opening " + OutputFilename + ":" +
-                                  EC.message() + "\n");
-  OutFile.os() << Out.str();
-
-  if (ErrorsPrinted > 0)
-    return reportError(argv0, Twine(ErrorsPrinted) + " errors.\n");
-
-  // Declare success.
-  OutFile.keep();
+  if (int Ret = writeIfChanged(argv0, OutputFilename, Out.str()))
+    return Ret;
+
+  // Run the other backends on the records parsed above.
+  for (StringRef ExtraOutput : ExtraOutputs) {
+    StringRef ActionName, Filename;
+    std::tie(ActionName, Filename) = ExtraOutput.split('=');
+    if (ActionName.empty() || Filename.empty())
+      return reportError(argv0, "expected -extra-output=<action>=<file>, "
+                                "got '" + ExtraOutput + "'\n");
+    if (SelectAction(ActionName))
+      return reportError(argv0, "unknown action '" + ActionName + "'\n");
+
+    std::string ExtraString;
+    raw_string_ostream ExtraOut(ExtraString);
+    if (MainFn(ExtraOut, Records))
+      return 1;
+    if (int Ret = writeIfChanged(argv0, Filename, ExtraOut.str()))
+      return Ret;
+  }
   return 0;
 }
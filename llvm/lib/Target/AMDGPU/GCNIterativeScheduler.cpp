@@ -20,6 +20,7 @@
 #include "llvm/CodeGen/RegisterPressure.h"
 #include "llvm/CodeGen/ScheduleDAG.h"
 #include "llvm/Config/llvm-config.h"
+#include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Compiler.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/raw_ostream.h"
@@ -35,6 +36,15 @@ using namespace llvm;
 
 #define DEBUG_TYPE "machine-scheduler"
 
+// Building a minimal register schedule is quadratic in the size of the region,
+// so bound the work spent on the tentative ones for large kernels.
+static cl::opt<unsigned> MinRegScheduleBudget(
+    "amdgpu-iterative-sched-budget", cl::Hidden,
+    cl::desc("Maximal number of region instructions per function the "
+             "iterative scheduler tries minimal register schedules for "
+             "(0 = unlimited)"),
+    cl::init(20000));
+
 namespace llvm {
 
 std::vector<const SUnit *> makeMinRegSchedule(ArrayRef<const SUnit *> TopRoots,
@@ -455,10 +465,22 @@ unsigned GCNIterativeScheduler::tryMaximizeOccupancy(unsigned TargetOcc) {
                     << ", current = " << Occ << '\n');
 
   auto NewOcc = TargetOcc;
+  unsigned Budget = MinRegScheduleBudget;
   for (auto R : Regions) {
     if (R->MaxPressure.getOccupancy(ST) >= NewOcc)
       break;
 
+    // The remaining regions keep their schedule, the most demanding of them
+    // bounds the occupancy.
+    if (MinRegScheduleBudget) {
+      if (R->NumRegionInstrs > Budget) {
+        LLVM_DEBUG(dbgs() << "Out of scheduling budget\n");
+        NewOcc = std::min(NewOcc, R->MaxPressure.getOccupancy(ST));
+        break;
+      }
+      Budget -= R->NumRegionInstrs;
+    }
+
     LLVM_DEBUG(printRegion(dbgs(), R->Begin, R->End, LIS, 3);
                printLivenessInfo(dbgs(), R->Begin, R->End, LIS));
 
@@ -546,10 +568,19 @@ void GCNIterativeScheduler::scheduleMinReg(bool force) {
   sortRegionsByPressure(TgtOcc);
 
   auto MaxPressure = Regions.front()->MaxPressure;
+  unsigned Budget = MinRegScheduleBudget;
   for (auto R : Regions) {
     if (!force && R->MaxPressure.less(ST, MaxPressure, TgtOcc))
       break;
 
+    if (!force && MinRegScheduleBudget) {
+      if (R->NumRegionInstrs > Budget) {
+        LLVM_DEBUG(dbgs() << "Out of scheduling budget\n");
+        break;
+      }
+      Budget -= R->NumRegionInstrs;
+    }
+
     BuildDAG DAG(*R, *this);
     const auto MinSchedule = makeMinRegSchedule(DAG.getTopRoots(), *this);
 
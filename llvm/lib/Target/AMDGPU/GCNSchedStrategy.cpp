@@ -16,13 +16,21 @@
 #include "SIInstrInfo.h"
 #include "SIMachineFunctionInfo.h"
 #include "SIRegisterInfo.h"
+#include "llvm/CodeGen/MachineLoopInfo.h"
 #include "llvm/CodeGen/RegisterClassInfo.h"
+#include "llvm/Support/CommandLine.h"
 #include "llvm/Support/MathExtras.h"
 
 #define DEBUG_TYPE "machine-scheduler"
 
 using namespace llvm;
 
+static cl::opt<bool> EnableRematerialization(
+    "amdgpu-sched-rematerialize", cl::Hidden,
+    cl::desc("Rematerialize instructions next to their use when it raises "
+             "the occupancy of a function limited by register pressure"),
+    cl::init(true));
+
 GCNMaxOccupancySchedStrategy::GCNMaxOccupancySchedStrategy(
     const MachineSchedContext *C) :
     GenericScheduler(C), TargetOccupancy(0), MF(nullptr) { }
@@ -498,6 +506,145 @@ GCNScheduleDAGMILive::getBBLiveInMap() const {
   return getLiveRegMap(BBStarters, false /*After*/, *LIS);
 }
 
+void GCNScheduleDAGMILive::updateRegionsPressure() {
+  std::vector<MachineInstr *> RegionStarters;
+  RegionStarters.reserve(Regions.size());
+  for (auto &Rgn : Regions) {
+    auto I = skipDebugInstructionsForward(Rgn.first, Rgn.second);
+    if (I != Rgn.second)
+      RegionStarters.push_back(&*I);
+  }
+  if (RegionStarters.empty())
+    return;
+  auto LiveInMap = getLiveRegMap(RegionStarters, false /*After*/, *LIS);
+
+  for (size_t I = 0, E = Regions.size(); I != E; ++I) {
+    auto &Rgn = Regions[I];
+    auto NonDbgMI = skipDebugInstructionsForward(Rgn.first, Rgn.second);
+    if (NonDbgMI == Rgn.second)
+      continue;
+    LiveIns[I] = LiveInMap.lookup(&*NonDbgMI);
+    GCNDownwardRPTracker RPTracker(*LIS);
+    RPTracker.advance(Rgn.first, Rgn.second, &LiveIns[I]);
+    Pressure[I] = RPTracker.moveMaxPressure();
+  }
+}
+
+bool GCNScheduleDAGMILive::rematerializeForOccupancy() {
+  unsigned TargetOccupancy = MinOccupancy + 1;
+  if (TargetOccupancy > std::min(MFI.getMaxWavesPerEU(),
+                                 ST.getOccupancyWithLocalMemSize(MF)))
+    return false;
+
+  // The regions that keep the function below the target occupancy, and their
+  // pressure once the candidates found so far are sunk.
+  DenseMap<unsigned, GCNRegPressure> HighPressure;
+  for (unsigned I = 0, E = Regions.size(); I != E; ++I)
+    if (Pressure[I].getOccupancy(ST) < TargetOccupancy)
+      HighPressure[I] = Pressure[I];
+  if (HighPressure.empty())
+    return false;
+
+  LLVM_DEBUG(dbgs() << "Trying to rematerialize instructions to reach "
+                    << "occupancy " << TargetOccupancy << ", "
+                    << HighPressure.size() << " regions above the limit.\n");
+
+  SmallVector<std::pair<MachineInstr *, MachineInstr *>, 16> Sinkable;
+  for (unsigned I = 0, E = MRI.getNumVirtRegs();
+       I != E && !HighPressure.empty(); ++I) {
+    unsigned Reg = TargetRegisterInfo::index2VirtReg(I);
+    if (!LIS->hasInterval(Reg) || !MRI.hasOneDef(Reg) ||
+        !MRI.hasOneNonDBGUse(Reg))
+      continue;
+
+    MachineInstr *Def = &*MRI.def_instr_begin(Reg);
+    MachineInstr *Use = &*MRI.use_instr_nodbg_begin(Reg);
+    MachineBasicBlock *DefMBB = Def->getParent();
+    MachineBasicBlock *UseMBB = Use->getParent();
+    // Only sink out of the block of the definition, and never into a loop:
+    // the instruction would be executed on every iteration.
+    if (DefMBB == UseMBB || Use->isPHI() ||
+        (MLI && MLI->getLoopDepth(UseMBB) > MLI->getLoopDepth(DefMBB)))
+      continue;
+    const MachineOperand &DefMO = Def->getOperand(0);
+    if (!DefMO.isReg() || DefMO.getReg() != Reg || DefMO.getSubReg() ||
+        !TII->isTriviallyReMaterializable(*Def, AA) ||
+        TII->isSchedulingBoundary(*Def, DefMBB, MF))
+      continue;
+    // Moving the uses of virtual registers would extend their live ranges.
+    if (llvm::any_of(Def->uses(), [](const MachineOperand &MO) {
+          return MO.isReg() &&
+                 TargetRegisterInfo::isVirtualRegister(MO.getReg());
+        }))
+      continue;
+
+    // Once sunk, the register is not live through the regions it is live-in
+    // of, except for the regions of the block of the use, which are left out
+    // to keep the estimate conservative.
+    bool Reduces = false;
+    for (auto It = HighPressure.begin(), End = HighPressure.end(); It != End;
+         ++It) {
+      if (Regions[It->first].first->getParent() == UseMBB)
+        continue;
+      auto LiveIn = LiveIns[It->first].find(Reg);
+      if (LiveIn == LiveIns[It->first].end())
+        continue;
+      It->second.inc(Reg, LiveIn->second, LaneBitmask::getNone(), MRI);
+      Reduces = true;
+    }
+    if (!Reduces)
+      continue;
+
+    Sinkable.push_back(std::make_pair(Def, Use));
+    for (auto It = HighPressure.begin(), End = HighPressure.end(); It != End;) {
+      auto Cur = It++;
+      if (Cur->second.getOccupancy(ST) >= TargetOccupancy)
+        HighPressure.erase(Cur);
+    }
+  }
+
+  if (!HighPressure.empty()) {
+    LLVM_DEBUG(dbgs() << "Not enough instructions to rematerialize, "
+                      << HighPressure.size() << " regions left above the "
+                      << "limit.\n");
+    return false;
+  }
+
+  for (auto &DefUse : Sinkable) {
+    MachineInstr *Def = DefUse.first, *Use = DefUse.second;
+    unsigned Reg = Def->getOperand(0).getReg();
+    MachineBasicBlock::iterator InsertPos = Use->getIterator();
+    TII->reMaterialize(*Use->getParent(), InsertPos, Reg, 0, *Def, *TRI);
+    MachineInstr *NewMI = &*std::prev(InsertPos);
+    LIS->InsertMachineInstrInMaps(*NewMI);
+    LLVM_DEBUG(dbgs() << "Rematerialized " << *Def << "  before " << *Use);
+
+    for (auto &Rgn : Regions) {
+      if (Rgn.first == Def->getIterator())
+        Rgn.first = std::next(Def->getIterator());
+      if (Rgn.first == Use->getIterator())
+        Rgn.first = NewMI->getIterator();
+    }
+    LIS->RemoveMachineInstrFromMaps(*Def);
+    Def->eraseFromParent();
+    LIS->removeInterval(Reg);
+    LIS->createAndComputeVirtRegInterval(Reg);
+  }
+
+  updateRegionsPressure();
+  unsigned NewOccupancy = TargetOccupancy;
+  for (const auto &RP : Pressure)
+    NewOccupancy = std::min(NewOccupancy, RP.getOccupancy(ST));
+  LLVM_DEBUG(dbgs() << "Occupancy after rematerialization is " << NewOccupancy
+                    << ".\n");
+  if (NewOccupancy <= MinOccupancy)
+    return false;
+
+  MFI.increaseOccupancy(MF, NewOccupancy);
+  MinOccupancy = MFI.getOccupancy();
+  return true;
+}
+
 void GCNScheduleDAGMILive::finalizeSchedule() {
   GCNMaxOccupancySchedStrategy &S = (GCNMaxOccupancySchedStrategy&)*SchedImpl;
   LLVM_DEBUG(dbgs() << "All regions recorded, starting actual scheduling.\n");
@@ -513,20 +660,31 @@ void GCNScheduleDAGMILive::finalizeSchedule() {
     RegionIdx = 0;
     MachineBasicBlock *MBB = nullptr;
 
-    if (Stage > 1) {
+    if (Stage == 2) {
       // Retry function scheduling if we found resulting occupancy and it is
       // lower than used for first pass scheduling. This will give more freedom
       // to schedule low register pressure blocks.
       // Code is partially copied from MachineSchedulerBase::scheduleRegions().
 
       if (!LIS || StartingOccupancy <= MinOccupancy)
-        break;
+        continue;
 
       LLVM_DEBUG(
           dbgs()
           << "Retrying function scheduling with lowest recorded occupancy "
           << MinOccupancy << ".\n");
 
+      S.setTargetOccupancy(MinOccupancy);
+    } else if (Stage == 3) {
+      // Rescheduling alone cannot lower the pressure of a value live through
+      // the regions limiting the occupancy. If rematerializing such values
+      // next to their use raises it, schedule again for the new occupancy.
+      if (!LIS || !EnableRematerialization || !rematerializeForOccupancy())
+        break;
+
+      LLVM_DEBUG(dbgs() << "Retrying function scheduling with occupancy "
+                        << MinOccupancy << " after rematerialization.\n");
+
       S.setTargetOccupancy(MinOccupancy);
     }
 
@@ -566,5 +724,5 @@ void GCNScheduleDAGMILive::finalizeSchedule() {
     }
     finishBlock();
 
-  } while (Stage < 2);
+  } while (Stage < 3);
 }
@@ -99,6 +99,14 @@ class GCNScheduleDAGMILive final : public ScheduleDAGMILive {
   // Compute and cache live-ins and pressure for all regions in block.
   void computeBlockPressure(const MachineBasicBlock *MBB);
 
+  // Recompute live-ins and pressure of all regions after the instructions
+  // were changed outside of scheduling.
+  void updateRegionsPressure();
+
+  // Sink trivially rematerializable instructions to their only use when it
+  // is enough to raise the occupancy of the function. Returns true if the
+  // occupancy was raised.
+  bool rematerializeForOccupancy();
 
 public:
   GCNScheduleDAGMILive(MachineSchedContext *C,
@@ -80,3 +80,27 @@ unsigned WebAssemblyTTIImpl::getVectorInstrCost(unsigned Opcode, Type *Val,
 
   return Cost;
 }
+
+unsigned WebAssemblyTTIImpl::getShuffleCost(TTI::ShuffleKind Kind, Type *Tp,
+                                            int Index, Type *SubTp) {
+  switch (Kind) {
+  case TTI::SK_Broadcast:
+  case TTI::SK_Select:
+  case TTI::SK_Reverse:
+  case TTI::SK_Transpose:
+  case TTI::SK_PermuteSingleSrc:
+  case TTI::SK_PermuteTwoSrc: {
+    // Whatever the mask, a shuffle of a SIMD128 vector is a single
+    // v8x16.shuffle, instead of the lane by lane extracts and inserts the
+    // base implementation assumes.
+    std::pair<int, MVT> LT = TLI->getTypeLegalizationCost(DL, Tp);
+    if (LT.first == 1 && LT.second.is128BitVector() &&
+        TLI->isOperationLegalOrCustom(ISD::VECTOR_SHUFFLE, LT.second))
+      return TargetTransformInfo::TCC_Basic;
+    break;
+  }
+  default:
+    break;
+  }
+  return BaseT::getShuffleCost(Kind, Tp, Index, SubTp);
+}
@@ -42951,6 +42951,69 @@ static SDValue combineLoopMAddPattern(SDNode *N, SelectionDAG &DAG,
   return DAG.getNode(ISD::ADD, DL, VT, Op0, Op1);
 }
 
+/// Match a reduction of the products of unsigned and signed bytes:
+///   add (mul (zext vXi8 A), (sext vXi8 B)), Acc
+/// into VPDPBUSD. VPDPBUSD adds the products of each group of 4 bytes into one
+/// i32 element, so it only updates a quarter of the elements of the reduction
+/// vector, which doesn't change the result of the reduction.
+static SDValue combineLoopVPDPBUSDPattern(SDNode *N, SelectionDAG &DAG,
+                                          const X86Subtarget &Subtarget) {
+  if (!Subtarget.hasVNNI())
+    return SDValue();
+
+  EVT VT = N->getValueType(0);
+  if (!VT.isVector() || VT.getVectorElementType() != MVT::i32)
+    return SDValue();
+
+  // The bytes must fill exactly one VNNI register.
+  unsigned NumElts = VT.getVectorNumElements();
+  unsigned BytesSize = NumElts * 8;
+  if (BytesSize == 512) {
+    if (!Subtarget.useAVX512Regs())
+      return SDValue();
+  } else if ((BytesSize != 128 && BytesSize != 256) || !Subtarget.hasVLX()) {
+    return SDValue();
+  }
+
+  SDValue Op0 = N->getOperand(0);
+  SDValue Op1 = N->getOperand(1);
+  if (Op0.getOpcode() != ISD::MUL)
+    std::swap(Op0, Op1);
+  if (Op0.getOpcode() != ISD::MUL || !Op0.hasOneUse())
+    return SDValue();
+
+  // The first source of VPDPBUSD is unsigned bytes, the second signed bytes.
+  auto IsUnsignedByte = [&](SDValue V) {
+    return DAG.computeKnownBits(V).countMinLeadingZeros() >= 24;
+  };
+  auto IsSignedByte = [&](SDValue V) {
+    return DAG.ComputeNumSignBits(V) >= 25;
+  };
+  SDValue UOp = Op0.getOperand(0);
+  SDValue SOp = Op0.getOperand(1);
+  if (!IsUnsignedByte(UOp) || !IsSignedByte(SOp))
+    std::swap(UOp, SOp);
+  if (!IsUnsignedByte(UOp) || !IsSignedByte(SOp))
+    return SDValue();
+
+  SDLoc DL(N);
+  EVT BytesVT = EVT::getVectorVT(*DAG.getContext(), MVT::i8, NumElts);
+  MVT DotVT = MVT::getVectorVT(MVT::i32, NumElts / 4);
+  // Shrink the operands of the mul, and let DAGCombine fold the truncates with
+  // the extensions.
+  SDValue UBytes =
+      DAG.getBitcast(DotVT, DAG.getNode(ISD::TRUNCATE, DL, BytesVT, UOp));
+  SDValue SBytes =
+      DAG.getBitcast(DotVT, DAG.getNode(ISD::TRUNCATE, DL, BytesVT, SOp));
+
+  // Accumulate into the low elements of the other operand.
+  SDValue Acc = DAG.getNode(ISD::EXTRACT_SUBVECTOR, DL, DotVT, Op1,
+                            DAG.getIntPtrConstant(0, DL));
+  SDValue Dot = DAG.getNode(X86ISD::VPDPBUSD, DL, DotVT, Acc, UBytes, SBytes);
+  return DAG.getNode(ISD::INSERT_SUBVECTOR, DL, VT, Op1, Dot,
+                     DAG.getIntPtrConstant(0, DL));
+}
+
 static SDValue combineLoopSADPattern(SDNode *N, SelectionDAG &DAG,
                                      const X86Subtarget &Subtarget) {
   if (!Subtarget.hasSSE2())
@@ -43291,6 +43354,8 @@ static SDValue combineAdd(SDNode *N, SelectionDAG &DAG,
   if (Flags.hasVectorReduction()) {
     if (SDValue Sad = combineLoopSADPattern(N, DAG, Subtarget))
       return Sad;
+    if (SDValue Dot = combineLoopVPDPBUSDPattern(N, DAG, Subtarget))
+      return Dot;
     if (SDValue MAdd = combineLoopMAddPattern(N, DAG, Subtarget))
       return MAdd;
   }
@@ -105,6 +105,9 @@ private:
                      MachineFunction &MF) const;
   bool selectCondBranch(MachineInstr &I, MachineRegisterInfo &MRI,
                         MachineFunction &MF) const;
+  bool selectIndirectBranch(MachineInstr &I, MachineRegisterInfo &MRI) const;
+  bool selectSelect(MachineInstr &I, MachineRegisterInfo &MRI,
+                    MachineFunction &MF) const;
   bool selectTurnIntoCOPY(MachineInstr &I, MachineRegisterInfo &MRI,
                           const unsigned DstReg,
                           const TargetRegisterClass *DstRC,
@@ -380,6 +383,10 @@ bool X86InstructionSelector::select(MachineInstr &I,
     return selectInsert(I, MRI, MF);
   case TargetOpcode::G_BRCOND:
     return selectCondBranch(I, MRI, MF);
+  case TargetOpcode::G_BRINDIRECT:
+    return selectIndirectBranch(I, MRI);
+  case TargetOpcode::G_SELECT:
+    return selectSelect(I, MRI, MF);
   case TargetOpcode::G_IMPLICIT_DEF:
   case TargetOpcode::G_PHI:
     return selectImplicitDefOrPHI(I, MRI);
@@ -1097,8 +1104,9 @@ bool X86InstructionSelector::selectUadde(MachineInstr &I,
 
   const LLT DstTy = MRI.getType(DstReg);
 
-  if (DstTy != LLT::scalar(32))
+  if (DstTy != LLT::scalar(32) && DstTy != LLT::scalar(64))
     return false;
+  const bool Is64 = DstTy == LLT::scalar(64);
 
   // find CarryIn def instruction.
   MachineInstr *Def = MRI.getVRegDef(CarryInReg);
@@ -1117,13 +1125,13 @@ bool X86InstructionSelector::selectUadde(MachineInstr &I,
     if (!RBI.constrainGenericRegister(CarryInReg, X86::GR32RegClass, MRI))
       return false;
 
-    Opcode = X86::ADC32rr;
+    Opcode = Is64 ? X86::ADC64rr : X86::ADC32rr;
   } else if (auto val = getConstantVRegVal(CarryInReg, MRI)) {
     // carry is constant, support only 0.
     if (*val != 0)
       return false;
 
-    Opcode = X86::ADD32rr;
+    Opcode = Is64 ? X86::ADD64rr : X86::ADD32rr;
   } else
     return false;
 
@@ -1431,6 +1439,70 @@ bool X86InstructionSelector::selectCondBranch(MachineInstr &I,
   return true;
 }
 
+bool X86InstructionSelector::selectIndirectBranch(
+    MachineInstr &I, MachineRegisterInfo &MRI) const {
+  assert((I.getOpcode() == TargetOpcode::G_BRINDIRECT) &&
+         "unexpected instruction");
+
+  // TODO: The x32 ABI needs the 32-bit address zero extended first.
+  const unsigned AddrReg = I.getOperand(0).getReg();
+  if (MRI.getType(AddrReg).getSizeInBits() != (STI.is64Bit() ? 64 : 32))
+    return false;
+
+  I.setDesc(TII.get(STI.is64Bit() ? X86::JMP64r : X86::JMP32r));
+  return constrainSelectedInstRegOperands(I, TII, TRI, RBI);
+}
+
+bool X86InstructionSelector::selectSelect(MachineInstr &I,
+                                          MachineRegisterInfo &MRI,
+                                          MachineFunction &MF) const {
+  assert((I.getOpcode() == TargetOpcode::G_SELECT) && "unexpected instruction");
+
+  const unsigned DstReg = I.getOperand(0).getReg();
+  const unsigned CondReg = I.getOperand(1).getReg();
+  const unsigned TrueReg = I.getOperand(2).getReg();
+  const unsigned FalseReg = I.getOperand(3).getReg();
+
+  // TODO: Select FP values and targets without CMOV with a branch.
+  if (!STI.hasCMov() ||
+      RBI.getRegBank(DstReg, MRI, TRI)->getID() != X86::GPRRegBankID)
+    return false;
+
+  unsigned Opc;
+  switch (MRI.getType(DstReg).getSizeInBits()) {
+  case 16:
+    Opc = X86::CMOV16rr;
+    break;
+  case 32:
+    Opc = X86::CMOV32rr;
+    break;
+  case 64:
+    Opc = X86::CMOV64rr;
+    break;
+  default:
+    return false;
+  }
+
+  MachineInstr &TestInst =
+      *BuildMI(*I.getParent(), I, I.getDebugLoc(), TII.get(X86::TEST8ri))
+           .addReg(CondReg)
+           .addImm(1);
+  // CMOV replaces its first source with the second one if the condition
+  // holds.
+  MachineInstr &CMovInst =
+      *BuildMI(*I.getParent(), I, I.getDebugLoc(), TII.get(Opc), DstReg)
+           .addReg(FalseReg)
+           .addReg(TrueReg)
+           .addImm(X86::COND_NE);
+
+  if (!constrainSelectedInstRegOperands(TestInst, TII, TRI, RBI) ||
+      !constrainSelectedInstRegOperands(CMovInst, TII, TRI, RBI))
+    return false;
+
+  I.eraseFromParent();
+  return true;
+}
+
 bool X86InstructionSelector::materializeFP(MachineInstr &I,
                                            MachineRegisterInfo &MRI,
                                            MachineFunction &MF) const {
@@ -142,10 +142,17 @@ void X86LegalizerInfo::setLegalizerInfo32bit() {
       .legalFor({{s8, s8}, {s16, s8}, {s32, s8}})
       .clampScalar(0, s8, s32)
       .clampScalar(1, s8, s8);
+
+    // Selects
+    getActionDefinitionsBuilder(G_SELECT)
+        .legalForCartesianProduct({s16, s32, p0}, {s1})
+        .clampScalar(0, s16, s32)
+        .widenScalarToNextPow2(0, /*Min*/ 16);
   }
 
   // Control-flow
   setAction({G_BRCOND, s1}, Legal);
+  setAction({G_BRINDIRECT, p0}, Legal);
 
   // Constants
   for (auto Ty : {s8, s16, s32, p0})
@@ -199,6 +206,8 @@ void X86LegalizerInfo::setLegalizerInfo64bit() {
   for (unsigned BinOp : {G_ADD, G_SUB, G_MUL, G_AND, G_OR, G_XOR})
     setAction({BinOp, s64}, Legal);
 
+  setAction({G_UADDE, s64}, Legal);
+
   for (unsigned MemOp : {G_LOAD, G_STORE})
     setAction({MemOp, s64}, Legal);
 
@@ -254,6 +263,12 @@ void X86LegalizerInfo::setLegalizerInfo64bit() {
     .clampScalar(0, s8, s64)
     .clampScalar(1, s8, s8);
 
+  // Selects
+  getActionDefinitionsBuilder(G_SELECT)
+      .legalForCartesianProduct({s16, s32, s64, p0}, {s1})
+      .clampScalar(0, s16, s64)
+      .widenScalarToNextPow2(0, /*Min*/ 16);
+
   // Merge/Unmerge
   setAction({G_MERGE_VALUES, s128}, Legal);
   setAction({G_UNMERGE_VALUES, 1, s128}, Legal);
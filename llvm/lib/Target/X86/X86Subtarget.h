@@ -703,6 +703,12 @@ public:
   bool useRetpolineExternalThunk() const { return UseRetpolineExternalThunk; }
 
   unsigned getPreferVectorWidth() const { return PreferVectorWidth; }
+  /// Return true if the preferred vector width comes from a
+  /// prefer-vector-width function attribute rather than from the CPU.
+  bool hasPreferVectorWidthOverride() const {
+    return PreferVectorWidthOverride != 0;
+  }
+  bool prefer256Bit() const { return Prefer256Bit; }
   unsigned getRequiredVectorWidth() const { return RequiredVectorWidth; }
 
   // Helper functions to determine when we should allow widening to 512-bit
@@ -60,6 +60,13 @@ static cl::opt<bool> EnableCondBrFoldingPass("x86-condbr-folding",
                                         "folding pass"),
                                cl::init(false), cl::Hidden);
 
+static cl::opt<int> EnableGlobalISelAtO(
+    "x86-enable-global-isel-at-O", cl::Hidden,
+    cl::desc("Enable GlobalISel at or below an opt level, falling back to "
+             "SelectionDAG for the functions it cannot select (-1 to "
+             "disable)"),
+    cl::init(-1));
+
 extern "C" void LLVMInitializeX86Target() {
   // Register the target.
   RegisterTargetMachine<X86TargetMachine> X(getTheX86_32Target());
@@ -237,6 +244,12 @@ X86TargetMachine::X86TargetMachine(const Target &T, const Triple &TT,
   if (TT.getArch() == Triple::x86_64)
     setMachineOutliner(true);
 
+  // Enable GlobalISel at or below EnableGlobalISelAtO.
+  if (getOptLevel() <= EnableGlobalISelAtO) {
+    setGlobalISel(true);
+    setGlobalISelAbort(GlobalISelAbortMode::Disable);
+  }
+
   initAsmInfo();
 }
 
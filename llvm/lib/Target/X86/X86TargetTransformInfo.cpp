@@ -44,12 +44,23 @@
 #include "llvm/CodeGen/CostTable.h"
 #include "llvm/CodeGen/TargetLowering.h"
 #include "llvm/IR/IntrinsicInst.h"
+#include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Debug.h"
 
 using namespace llvm;
 
 #define DEBUG_TYPE "x86tti"
 
+static cl::opt<bool> X86AutoPreferVectorWidth(
+    "x86-auto-prefer-vector-width", cl::Hidden,
+    cl::desc("Let the loop vectorizer use 512-bit vectors on CPUs preferring "
+             "256-bit vectors, when the cost model finds it profitable"));
+
+static cl::opt<unsigned> X86AVX512FrequencyPenalty(
+    "x86-avx512-frequency-penalty", cl::init(20), cl::Hidden,
+    cl::desc("The cost, in percent, added to loops using 512-bit vectors on "
+             "CPUs lowering their frequency to run them"));
+
 //===----------------------------------------------------------------------===//
 //
 // X86 cost model.
@@ -146,6 +157,16 @@ unsigned X86TTIImpl::getRegisterBitWidth(bool Vector) const {
   return 32;
 }
 
+unsigned X86TTIImpl::getWideVectorRegisterCostPercent(unsigned BitWidth) const {
+  // The CPUs preferring 256-bit vectors lower their frequency while running
+  // 512-bit instructions, which slows down the surrounding code as well. Only
+  // second-guess the CPU when the function doesn't ask for a vector width.
+  if (!X86AutoPreferVectorWidth || BitWidth != 512 || !ST->hasAVX512() ||
+      !ST->prefer256Bit() || ST->hasPreferVectorWidthOverride())
+    return 0;
+  return 100 + X86AVX512FrequencyPenalty;
+}
+
 unsigned X86TTIImpl::getLoadStoreVecRegBitWidth(unsigned) const {
   return getRegisterBitWidth(true);
 }
@@ -3324,6 +3345,12 @@ bool X86TTIImpl::enableInterleavedAccessVectorization() {
   return !(ST->isAtom());
 }
 
+bool X86TTIImpl::preferPredicateOverEpilogue() {
+  // AVX-512 has masked loads and stores for every element type, and using
+  // them for the last iterations is cheaper than a scalar loop.
+  return ST->hasAVX512() && ST->hasBWI() && ST->hasVLX();
+}
+
 // Get estimation for interleaved load/store operations for AVX2.
 // \p Factor is the interleaved-access factor (stride) - number of
 // (interleaved) elements in the group.
@@ -84,6 +84,22 @@ static cl::opt<int>
                        cl::desc("Base penalty for splitting cold code (as a "
                                 "multiple of TCC_Basic)"));
 
+static cl::opt<std::string> SplitSectionPrefix(
+    "hotcoldsplit-section-prefix", cl::init(".unlikely"), cl::Hidden,
+    cl::desc("Section prefix of split functions, which places them in "
+             ".text<prefix>.* with -ffunction-sections (e.g. \".split\"). "
+             "An empty prefix leaves them in .text"));
+
+static cl::opt<uint64_t> ColdCountThreshold(
+    "hotcoldsplit-cold-count-threshold", cl::Hidden,
+    cl::desc("With a profile, split blocks that run at most this many times, "
+             "instead of the blocks the profile summary considers cold"));
+
+static cl::opt<unsigned> ColdRatioThreshold(
+    "hotcoldsplit-cold-ratio", cl::init(0), cl::Hidden,
+    cl::desc("With a profile, also split blocks that run less than this many "
+             "times per million entries of their function (0 to disable)"));
+
 namespace {
 
 /// A sequence of basic blocks.
@@ -182,6 +198,8 @@ public:
 private:
   bool isFunctionCold(const Function &F) const;
   bool shouldOutlineFrom(const Function &F) const;
+  bool isProfileColdBlock(const BasicBlock &BB,
+                          BlockFrequencyInfo *BFI) const;
   bool outlineColdRegions(Function &F, bool HasProfileSummary);
   Function *extractColdRegion(const BlockSequence &Region, DominatorTree &DT,
                               BlockFrequencyInfo *BFI, TargetTransformInfo &TTI,
@@ -227,6 +245,32 @@ bool HotColdSplitting::isFunctionCold(const Function &F) const {
   return false;
 }
 
+/// Check whether the profile says that \p BB is cold.
+bool HotColdSplitting::isProfileColdBlock(const BasicBlock &BB,
+                                          BlockFrequencyInfo *BFI) const {
+  if (!BFI)
+    return false;
+  Optional<uint64_t> Count = BFI->getBlockProfileCount(&BB);
+  if (!Count)
+    return false;
+
+  if (ColdCountThreshold.getNumOccurrences())
+    return *Count <= ColdCountThreshold;
+  if (PSI->isColdCount(*Count))
+    return true;
+
+  // A block may be rarely run relative to its function, even if the function
+  // runs so often that the block is not cold for the whole program.
+  if (ColdRatioThreshold) {
+    Optional<uint64_t> EntryCount =
+        BFI->getBlockProfileCount(&BB.getParent()->getEntryBlock());
+    if (EntryCount && *EntryCount &&
+        double(*Count) * 1000000 < double(*EntryCount) * ColdRatioThreshold)
+      return true;
+  }
+  return false;
+}
+
 // Returns false if the function should not be considered for hot-cold split
 // optimization.
 bool HotColdSplitting::shouldOutlineFrom(const Function &F) const {
@@ -362,6 +406,12 @@ Function *HotColdSplitting::extractColdRegion(const BlockSequence &Region,
 
     markFunctionCold(*OutF, BFI != nullptr);
 
+    // Keep the split functions apart from the hot text, so that the linker
+    // can pack the hot code densely. lld groups these sections together with
+    // -z keep-text-section-prefix.
+    if (!SplitSectionPrefix.empty())
+      OutF->setSectionPrefix(SplitSectionPrefix);
+
     LLVM_DEBUG(llvm::dbgs() << "Outlined Region: " << *OutF);
     ORE.emit([&]() {
       return OptimizationRemark(DEBUG_TYPE, "HotColdSplit",
@@ -596,7 +646,7 @@ bool HotColdSplitting::outlineColdRegions(Function &F, bool HasProfileSummary) {
     if (ColdBlocks.count(BB))
       continue;
 
-    bool Cold = (BFI && PSI->isColdBlock(BB, BFI)) ||
+    bool Cold = isProfileColdBlock(*BB, BFI) ||
                 (EnableStaticAnalyis && unlikelyExecuted(*BB));
     if (!Cold)
       continue;
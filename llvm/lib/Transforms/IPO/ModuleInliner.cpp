@@ -0,0 +1,269 @@
+//===- ModuleInliner.cpp - Module level inliner pass ----------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements an inliner that ranks the call sites of the whole
+// module by their profile-weighted benefit over their cost, and inlines them
+// best first until a code size budget is used up.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/Transforms/IPO/ModuleInliner.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/Analysis/AssumptionCache.h"
+#include "llvm/Analysis/BlockFrequencyInfo.h"
+#include "llvm/Analysis/OptimizationRemarkEmitter.h"
+#include "llvm/Analysis/ProfileSummaryInfo.h"
+#include "llvm/Analysis/TargetTransformInfo.h"
+#include "llvm/IR/Attributes.h"
+#include "llvm/IR/CallSite.h"
+#include "llvm/IR/DiagnosticInfo.h"
+#include "llvm/IR/InstIterator.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/IR/IntrinsicInst.h"
+#include "llvm/IR/Module.h"
+#include "llvm/IR/ValueHandle.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Transforms/Utils/Cloning.h"
+#include <algorithm>
+#include <limits>
+#include <queue>
+#include <vector>
+
+using namespace llvm;
+
+#define DEBUG_TYPE "module-inline"
+
+STATISTIC(NumInlined, "Number of functions inlined");
+STATISTIC(NumDeleted, "Number of functions deleted because all callers found");
+STATISTIC(NumOverBudget,
+          "Number of call sites not inlined because the budget was used up");
+
+static cl::opt<unsigned> SizeGrowthPercent(
+    "module-inliner-size-growth", cl::init(20), cl::Hidden,
+    cl::desc("The percentage by which the module inliner may grow the number "
+             "of instructions of the module"));
+
+static cl::opt<unsigned> HotCallSiteThresholdFactor(
+    "module-inliner-hot-callsite-factor", cl::init(2), cl::Hidden,
+    cl::desc("The factor by which the module inliner raises the threshold "
+             "of hot call sites, which are only limited by the budget"));
+
+namespace {
+
+/// A call site waiting to be inlined.
+struct Candidate {
+  WeakTrackingVH Call;
+  /// The index into the inline history of the call site.
+  int HistoryID;
+  double Priority;
+  /// The order in which candidates were queued, to break ties.
+  unsigned Order;
+};
+
+struct CandidateLess {
+  bool operator()(const Candidate &L, const Candidate &R) const {
+    if (L.Priority != R.Priority)
+      return L.Priority < R.Priority;
+    return L.Order > R.Order;
+  }
+};
+
+} // end anonymous namespace
+
+/// Return true if the specified inline history ID indicates an inline history
+/// that includes the specified function.
+static bool InlineHistoryIncludes(
+    Function *F, int InlineHistoryID,
+    const SmallVectorImpl<std::pair<Function *, int>> &InlineHistory) {
+  while (InlineHistoryID != -1) {
+    if (InlineHistory[InlineHistoryID].first == F)
+      return true;
+    InlineHistoryID = InlineHistory[InlineHistoryID].second;
+  }
+  return false;
+}
+
+PreservedAnalyses ModuleInlinerPass::run(Module &M,
+                                         ModuleAnalysisManager &MAM) {
+  FunctionAnalysisManager &FAM =
+      MAM.getResult<FunctionAnalysisManagerModuleProxy>(M).getManager();
+  ProfileSummaryInfo *PSI = &MAM.getResult<ProfileSummaryAnalysis>(M);
+
+  std::function<AssumptionCache &(Function &)> GetAssumptionCache =
+      [&](Function &F) -> AssumptionCache & {
+    return FAM.getResult<AssumptionAnalysis>(F);
+  };
+  auto GetBFI = [&](Function &F) -> BlockFrequencyInfo & {
+    return FAM.getResult<BlockFrequencyAnalysis>(F);
+  };
+
+  // Hot call sites get a higher threshold than with the bottom-up inliner,
+  // as the budget keeps the total growth in check.
+  InlineParams HotParams = Params;
+  if (HotParams.HotCallSiteThreshold)
+    HotParams.HotCallSiteThreshold =
+        *HotParams.HotCallSiteThreshold * HotCallSiteThresholdFactor;
+
+  auto GetInlineCost = [&](CallBase &Call) {
+    Function &Callee = *Call.getCalledFunction();
+    auto &CalleeTTI = FAM.getResult<TargetIRAnalysis>(Callee);
+    return getInlineCost(Call, HotParams, CalleeTTI, GetAssumptionCache,
+                         {GetBFI}, PSI);
+  };
+
+  // The priority of a call site is the number of times it runs per unit of
+  // inline cost. Without a profile, the number of runs is only known
+  // relative to the entry of the caller.
+  auto GetPriority = [&](CallBase &Call, const InlineCost &IC) {
+    if (IC.isAlways())
+      return std::numeric_limits<double>::infinity();
+    BlockFrequencyInfo &CallerBFI = GetBFI(*Call.getCaller());
+    double Runs;
+    if (Optional<uint64_t> Count = PSI->getProfileCount(&Call, &CallerBFI))
+      Runs = *Count;
+    else
+      Runs = double(CallerBFI.getBlockFreq(Call.getParent()).getFrequency()) /
+             CallerBFI.getEntryFreq();
+    return (Runs + 1) / (std::max(IC.getCost(), 0) + 1);
+  };
+
+  std::priority_queue<Candidate, std::vector<Candidate>, CandidateLess> Queue;
+  unsigned NextOrder = 0;
+
+  // Queues \p Call, unless it is known not to be worth inlining.
+  auto Enqueue = [&](CallBase &Call, int HistoryID) {
+    Function *Callee = Call.getCalledFunction();
+    if (!Callee || Callee->isDeclaration() || isa<IntrinsicInst>(Call) ||
+        Call.getCaller()->hasOptNone())
+      return;
+    InlineCost IC = GetInlineCost(Call);
+    if (!IC)
+      return;
+    Queue.push({&Call, HistoryID, GetPriority(Call, IC), NextOrder++});
+  };
+
+  for (Function &F : M)
+    for (Instruction &I : instructions(F))
+      if (auto CS = CallSite(&I))
+        Enqueue(*cast<CallBase>(CS.getInstruction()), -1);
+
+  // When inlining a callee produces new call sites, we want to keep track of
+  // the fact that they were inlined from the callee. This allows us to avoid
+  // infinite inlining in some obscure cases. To represent this, we use an
+  // index into the InlineHistory vector.
+  SmallVector<std::pair<Function *, int>, 16> InlineHistory;
+
+  int64_t Budget = uint64_t(M.getInstructionCount()) * SizeGrowthPercent / 100;
+  bool Changed = false;
+
+  while (!Queue.empty()) {
+    Candidate C = Queue.top();
+    Queue.pop();
+
+    // The call may have been deleted along with its caller, or simplified
+    // away by an earlier inlining.
+    auto *Call = dyn_cast_or_null<CallBase>(C.Call);
+    if (!Call)
+      continue;
+    Function *Callee = Call->getCalledFunction();
+    if (!Callee || Callee->isDeclaration())
+      continue;
+    Function &Caller = *Call->getCaller();
+
+    if (C.HistoryID != -1 &&
+        InlineHistoryIncludes(Callee, C.HistoryID, InlineHistory))
+      continue;
+
+    // Inlining into the caller or the callee since the call site was queued
+    // changes its cost. Queue it again if it is no longer the best one.
+    InlineCost IC = GetInlineCost(*Call);
+    if (!IC)
+      continue;
+    double Priority = GetPriority(*Call, IC);
+    if (Priority < C.Priority && !Queue.empty() &&
+        Priority < Queue.top().Priority) {
+      Queue.push({Call, C.HistoryID, Priority, NextOrder++});
+      continue;
+    }
+
+    auto &ORE = FAM.getResult<OptimizationRemarkEmitterAnalysis>(Caller);
+    DebugLoc DLoc = Call->getDebugLoc();
+    BasicBlock *Block = Call->getParent();
+
+    int64_t CalleeSize = Callee->getInstructionCount();
+    bool ShrinksCode = IC.isAlways() || IC.getCost() <= 0;
+    if (!ShrinksCode && CalleeSize > Budget) {
+      ++NumOverBudget;
+      ORE.emit([&]() {
+        return OptimizationRemarkMissed(DEBUG_TYPE, "OverBudget", DLoc, Block)
+               << ore::NV("Callee", Callee) << " will not be inlined into "
+               << ore::NV("Caller", &Caller)
+               << " because the size budget of the module is used up";
+      });
+      continue;
+    }
+
+    InlineFunctionInfo IFI(/*cg=*/nullptr, &GetAssumptionCache, PSI,
+                           &GetBFI(Caller), &GetBFI(*Callee));
+    InlineResult IR = InlineFunction(Call, IFI);
+    if (!IR) {
+      ORE.emit([&]() {
+        return OptimizationRemarkMissed(DEBUG_TYPE, "NotInlined", DLoc, Block)
+               << ore::NV("Callee", Callee) << " will not be inlined into "
+               << ore::NV("Caller", &Caller) << ": "
+               << ore::NV("Reason", IR.message);
+      });
+      continue;
+    }
+    ++NumInlined;
+    Changed = true;
+    ORE.emit([&]() {
+      OptimizationRemark R(DEBUG_TYPE, IC.isAlways() ? "AlwaysInline"
+                                                     : "Inlined",
+                           DLoc, Block);
+      R << ore::NV("Callee", Callee) << " inlined into "
+        << ore::NV("Caller", &Caller);
+      if (IC.isVariable())
+        R << " with (cost=" << ore::NV("Cost", IC.getCost())
+          << ", threshold=" << ore::NV("Threshold", IC.getThreshold()) << ")";
+      return R;
+    });
+    if (!ShrinksCode)
+      Budget -= CalleeSize;
+
+    AttributeFuncs::mergeAttributesForInlining(Caller, *Callee);
+    FAM.invalidate(Caller, PreservedAnalyses::none());
+
+    // Queue any new call sites to defined functions.
+    if (!IFI.InlinedCallSites.empty()) {
+      int NewHistoryID = InlineHistory.size();
+      InlineHistory.push_back({Callee, C.HistoryID});
+      for (CallSite &CS : IFI.InlinedCallSites)
+        Enqueue(*cast<CallBase>(CS.getInstruction()), NewHistoryID);
+    }
+
+    // Delete the callee once the last call to it was inlined. This returns
+    // its size to the budget, and lets the calls from its body, which are
+    // now in the queue, become dead.
+    if (Callee->hasLocalLinkage() && !Callee->hasComdat()) {
+      Callee->removeDeadConstantUsers();
+      if (Callee->use_empty()) {
+        Budget += CalleeSize;
+        FAM.clear(*Callee, Callee->getName());
+        Callee->eraseFromParent();
+        ++NumDeleted;
+      }
+    }
+  }
+
+  if (!Changed)
+    return PreservedAnalyses::all();
+  return PreservedAnalyses::none();
+}
@@ -86,6 +86,10 @@ static cl::opt<bool> EnableLoopInterchange(
     "enable-loopinterchange", cl::init(false), cl::Hidden,
     cl::desc("Enable the new, experimental LoopInterchange Pass"));
 
+static cl::opt<bool> EnableLoopTiling(
+    "enable-loop-tiling", cl::init(false), cl::Hidden,
+    cl::desc("Enable the experimental LoopTiling Pass at -O3"));
+
 static cl::opt<bool> EnableUnrollAndJam("enable-unroll-and-jam",
                                         cl::init(false), cl::Hidden,
                                         cl::desc("Enable Unroll And Jam Pass"));
@@ -147,6 +151,8 @@ cl::opt<bool> EnableOrderFileInstrumentation(
     "enable-order-file-instrumentation", cl::init(false), cl::Hidden,
     cl::desc("Enable order file instrumentation (default = off)"));
 
+extern cl::opt<std::string> PrefetchProfileFile;
+
 PassManagerBuilder::PassManagerBuilder() {
     OptLevel = 2;
     SizeLevel = 0;
@@ -378,6 +384,8 @@ void PassManagerBuilder::addFunctionSimplificationPasses(
 
   if (EnableLoopInterchange)
     MPM.add(createLoopInterchangePass()); // Interchange loops
+  if (EnableLoopTiling && OptLevel > 2)
+    MPM.add(createLoopTilingPass()); // Tile loop nests for locality
 
   // Unroll small loops
   MPM.add(createSimpleLoopUnrollPass(OptLevel, DisableUnrollLoops,
@@ -737,6 +745,11 @@ void PassManagerBuilder::populateModulePassManager(
 
   MPM.add(createWarnMissedTransformationsPass());
 
+  // Prefetch the loads that the profile shows to miss the cache, once
+  // unrolling has settled the size of the loops.
+  if (!PrefetchProfileFile.empty())
+    MPM.add(createLoopDataPrefetchPass());
+
   // After vectorization and unrolling, assume intrinsics may tell us more
   // about pointer alignments.
   MPM.add(createAlignmentFromAssumptionsPass());
@@ -785,7 +798,8 @@ void PassManagerBuilder::populateModulePassManager(
   }
 }
 
-void PassManagerBuilder::addLTOOptimizationPasses(legacy::PassManagerBase &PM) {
+void PassManagerBuilder::addLTOOptimizationPasses(legacy::PassManagerBase &PM,
+                                                  bool IPOOnly) {
   // Load sample profile before running the LTO optimization pipeline.
   if (!PGOSampleUse.empty()) {
     PM.add(createPruneEHPass());
@@ -888,6 +902,12 @@ void PassManagerBuilder::addLTOOptimizationPasses(legacy::PassManagerBase &PM) {
   // transform it to pass arguments by value instead of by reference.
   PM.add(createArgumentPromotionPass());
 
+  if (!IPOOnly)
+    addLTOFunctionOptimizationPasses(PM);
+}
+
+void PassManagerBuilder::addLTOFunctionOptimizationPasses(
+    legacy::PassManagerBase &PM) {
   // The IPO passes may leave cruft around.  Clean up after them.
   addInstructionCombiningPass(PM);
   addExtensionsToPM(EP_Peephole, PM);
@@ -1045,6 +1065,47 @@ void PassManagerBuilder::populateLTOPassManager(legacy::PassManagerBase &PM) {
     PM.add(createVerifierPass());
 }
 
+void PassManagerBuilder::populateLTOPrePartitionPassManager(
+    legacy::PassManagerBase &PM) {
+  if (LibraryInfo)
+    PM.add(new TargetLibraryInfoWrapperPass(*LibraryInfo));
+
+  if (VerifyInput)
+    PM.add(createVerifierPass());
+
+  addExtensionsToPM(EP_FullLinkTimeOptimizationEarly, PM);
+
+  if (OptLevel != 0)
+    addLTOOptimizationPasses(PM, /*IPOOnly=*/true);
+  else
+    PM.add(createWholeProgramDevirtPass(ExportSummary, nullptr));
+
+  // These need to see every function of the program, so they run before the
+  // module is split rather than after the function passes as in the
+  // sequential pipeline.
+  PM.add(createCrossDSOCFIPass());
+  PM.add(createLowerTypeTestsPass(ExportSummary, nullptr));
+}
+
+void PassManagerBuilder::populateLTOPartitionPassManager(
+    legacy::PassManagerBase &PM) {
+  if (LibraryInfo)
+    PM.add(new TargetLibraryInfoWrapperPass(*LibraryInfo));
+
+  if (OptLevel > 1) {
+    addInitialAliasAnalysisPasses(PM);
+    addLTOFunctionOptimizationPasses(PM);
+  }
+
+  if (OptLevel != 0)
+    addLateLTOOptimizationPasses(PM);
+
+  addExtensionsToPM(EP_FullLinkTimeOptimizationLast, PM);
+
+  if (VerifyOutput)
+    PM.add(createVerifierPass());
+}
+
 inline PassManagerBuilder *unwrap(LLVMPassManagerBuilderRef P) {
     return reinterpret_cast<PassManagerBuilder*>(P);
 }
@@ -219,6 +219,7 @@ protected:
   findIndirectCallFunctionSamples(const Instruction &I, uint64_t &Sum) const;
   mutable DenseMap<const DILocation *, const FunctionSamples *> DILocation2SampleMap;
   const FunctionSamples *findFunctionSamples(const Instruction &I) const;
+  std::string getCallingContext(const DILocation *DIL) const;
   bool inlineCallInstruction(Instruction *I);
   bool inlineHotFunctions(Function &F,
                           DenseSet<GlobalValue::GUID> &InlinedGUIDs);
@@ -664,13 +665,21 @@ SampleProfileLoader::findCalleeFunctionSamples(const Instruction &Inst) const {
     if (Function *Callee = CI->getCalledFunction())
       CalleeName = Callee->getName();
 
+  LineLocation CallSite(FunctionSamples::getOffset(DIL),
+                        DIL->getBaseDiscriminator());
+
+  // Prefer the profile of the callee in the full calling context.
+  if (Reader->profileIsCS() && !CalleeName.empty())
+    if (const FunctionSamples *FS =
+            Reader->getSamplesFor(SampleContext::getCalleeContext(
+                getCallingContext(DIL), CallSite, CalleeName)))
+      return FS;
+
   const FunctionSamples *FS = findFunctionSamples(Inst);
   if (FS == nullptr)
     return nullptr;
 
-  return FS->findFunctionSamplesAt(LineLocation(FunctionSamples::getOffset(DIL),
-                                                DIL->getBaseDiscriminator()),
-                                   CalleeName);
+  return FS->findFunctionSamplesAt(CallSite, CalleeName);
 }
 
 /// Returns a vector of FunctionSamples that are the indirect call targets
@@ -732,11 +741,39 @@ SampleProfileLoader::findFunctionSamples(const Instruction &Inst) const {
     return Samples;
 
   auto it = DILocation2SampleMap.try_emplace(DIL,nullptr);
-  if (it.second)
-    it.first->second = Samples->findFunctionSamples(DIL);
+  if (it.second) {
+    // With a context-sensitive profile, the instance may have a profile of
+    // its own; otherwise fall back to the profile nested in its callers.
+    if (Reader->profileIsCS() && DIL->getInlinedAt())
+      it.first->second = Reader->getSamplesFor(getCallingContext(DIL));
+    if (!it.first->second)
+      it.first->second = Samples->findFunctionSamples(DIL);
+  }
   return it.first->second;
 }
 
+/// Get the full calling context of the inlined instance \p DIL comes from,
+/// starting at the function being processed.
+///
+/// \returns the context, in the form used to key context-sensitive profiles.
+std::string
+SampleProfileLoader::getCallingContext(const DILocation *DIL) const {
+  SmallVector<std::pair<LineLocation, StringRef>, 10> S;
+  const DILocation *PrevDIL = DIL;
+  for (DIL = DIL->getInlinedAt(); DIL; DIL = DIL->getInlinedAt()) {
+    S.push_back(std::make_pair(
+        LineLocation(FunctionSamples::getOffset(DIL),
+                     DIL->getBaseDiscriminator()),
+        PrevDIL->getScope()->getSubprogram()->getLinkageName()));
+    PrevDIL = DIL;
+  }
+  std::string Context = Samples->getName();
+  for (const auto &CallSite : llvm::reverse(S))
+    Context = SampleContext::getCalleeContext(Context, CallSite.first,
+                                              CallSite.second);
+  return Context;
+}
+
 bool SampleProfileLoader::inlineCallInstruction(Instruction *I) {
   assert(isa<CallInst>(I) || isa<InvokeInst>(I));
   CallSite CS(I);
@@ -16,6 +16,7 @@
 #include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/DepthFirstIterator.h"
+#include "llvm/ADT/PostOrderIterator.h"
 #include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/Statistic.h"
@@ -23,13 +24,19 @@
 #include "llvm/ADT/StringRef.h"
 #include "llvm/ADT/Triple.h"
 #include "llvm/ADT/Twine.h"
+#include "llvm/Analysis/AssumptionCache.h"
+#include "llvm/Analysis/LoopInfo.h"
 #include "llvm/Analysis/MemoryBuiltins.h"
+#include "llvm/Analysis/ScalarEvolution.h"
+#include "llvm/Analysis/ScalarEvolutionExpander.h"
+#include "llvm/Analysis/ScalarEvolutionExpressions.h"
 #include "llvm/Analysis/TargetLibraryInfo.h"
 #include "llvm/Analysis/ValueTracking.h"
 #include "llvm/BinaryFormat/MachO.h"
 #include "llvm/IR/Argument.h"
 #include "llvm/IR/Attributes.h"
 #include "llvm/IR/BasicBlock.h"
+#include "llvm/IR/CFG.h"
 #include "llvm/IR/CallSite.h"
 #include "llvm/IR/Comdat.h"
 #include "llvm/IR/Constant.h"
@@ -342,6 +349,18 @@ static cl::opt<bool> ClOptStack(
     "asan-opt-stack", cl::desc("Don't instrument scalar stack variables"),
     cl::Hidden, cl::init(false));
 
+static cl::opt<bool> ClOptDominating(
+    "asan-opt-dominating",
+    cl::desc("Don't instrument an access if a dominating access to the same "
+             "address is instrumented, and no call is in between"),
+    cl::Hidden, cl::init(false));
+
+static cl::opt<bool> ClOptLoops(
+    "asan-opt-loops",
+    cl::desc("Check the loop-invariant and strided accesses of call-free "
+             "loops once, with a range check in the loop preheader"),
+    cl::Hidden, cl::init(false));
+
 static cl::opt<bool> ClDynamicAllocaStack(
     "asan-stack-dynamic-alloca",
     cl::desc("Use dynamic alloca to represent stack variables"), cl::Hidden,
@@ -396,6 +415,10 @@ STATISTIC(NumInstrumentedReads, "Number of instrumented reads");
 STATISTIC(NumInstrumentedWrites, "Number of instrumented writes");
 STATISTIC(NumOptimizedAccessesToGlobalVar,
           "Number of optimized accesses to global vars");
+STATISTIC(NumOptimizedDominatedAccesses,
+          "Number of accesses checked by a dominating access");
+STATISTIC(NumOptimizedLoopAccesses,
+          "Number of loop accesses checked in the loop preheader");
 STATISTIC(NumOptimizedAccessesToStackVar,
           "Number of optimized accesses to stack vars");
 
@@ -623,6 +646,8 @@ struct AddressSanitizer {
                                  Value *SizeArgument, uint32_t Exp);
   void instrumentMemIntrinsic(MemIntrinsic *MI);
   Value *memToShadow(Value *Shadow, IRBuilder<> &IRB);
+  bool optimizeChecksAcrossBlocks(Function &F, const TargetLibraryInfo *TLI,
+                                  SmallVectorImpl<Instruction *> &ToInstrument);
   bool instrumentFunction(Function &F, const TargetLibraryInfo *TLI);
   bool maybeInsertAsanInitAtFunctionEntry(Function &F);
   void maybeInsertDynamicShadowAtFunctionEntry(Function &F);
@@ -2587,6 +2612,210 @@ void AddressSanitizer::markEscapedLocalAllocas(Function &F) {
   }
 }
 
+// Calls may free or poison memory, which invalidates the checks made before
+// them.
+static bool mayInvalidateChecks(const Instruction &I) {
+  return isa<CallBase>(I) && !isa<DbgInfoIntrinsic>(I);
+}
+
+// Returns true if a call may run after From and before To, where From
+// dominates To.
+static bool
+hasCallBetween(Instruction *From, Instruction *To,
+               const SmallPtrSetImpl<const BasicBlock *> &BlocksWithCalls) {
+  BasicBlock *FromBB = From->getParent();
+  BasicBlock *ToBB = To->getParent();
+  if (FromBB == ToBB)
+    return std::any_of(std::next(From->getIterator()), To->getIterator(),
+                       mayInvalidateChecks);
+  if (std::any_of(std::next(From->getIterator()), FromBB->end(),
+                  mayInvalidateChecks) ||
+      std::any_of(ToBB->begin(), To->getIterator(), mayInvalidateChecks))
+    return true;
+
+  // Every path to ToBB goes through FromBB, so the blocks in between are the
+  // ones reached by walking back from ToBB, up to FromBB.
+  SmallVector<const BasicBlock *, 8> Worklist(pred_begin(ToBB),
+                                              pred_end(ToBB));
+  SmallPtrSet<const BasicBlock *, 16> Visited;
+  while (!Worklist.empty()) {
+    const BasicBlock *BB = Worklist.pop_back_val();
+    if (BB == FromBB || !Visited.insert(BB).second)
+      continue;
+    if (BlocksWithCalls.count(BB))
+      return true;
+    Worklist.append(pred_begin(BB), pred_end(BB));
+  }
+  return false;
+}
+
+// Returns true if I runs on every iteration of L, up to the exit.
+static bool runsOnEveryIteration(Instruction *I, Loop *L,
+                                 const DominatorTree &DT) {
+  SmallVector<BasicBlock *, 4> Blocks;
+  L->getExitingBlocks(Blocks);
+  L->getLoopLatches(Blocks);
+  return llvm::all_of(Blocks, [&](BasicBlock *BB) {
+    return DT.dominates(I->getParent(), BB);
+  });
+}
+
+/// Removes from ToInstrument the accesses that need no check of their own.
+/// With -asan-opt-loops, the accesses of call-free loops to loop-invariant
+/// or strided addresses are checked once per loop, by a range check in the
+/// loop preheader. With -asan-opt-dominating, the accesses whose address is
+/// checked by a dominating access, with no call in between, are not checked.
+/// Returns true if any range check was inserted.
+bool AddressSanitizer::optimizeChecksAcrossBlocks(
+    Function &F, const TargetLibraryInfo *TLI,
+    SmallVectorImpl<Instruction *> &ToInstrument) {
+  const DataLayout &DL = F.getParent()->getDataLayout();
+  DominatorTree DT(F);
+  LoopInfo LI(DT);
+  AssumptionCache AC(F);
+  TargetLibraryInfo SETLI(*TLI);
+  ScalarEvolution SE(F, SETLI, AC, DT, LI);
+
+  SmallPtrSet<const BasicBlock *, 16> BlocksWithCalls;
+  for (auto &BB : F)
+    if (llvm::any_of(BB, mayInvalidateChecks))
+      BlocksWithCalls.insert(&BB);
+  auto IsCallFree = [&](Loop *L) {
+    return llvm::none_of(L->blocks(), [&](BasicBlock *BB) {
+      return BlocksWithCalls.count(BB);
+    });
+  };
+
+  // Only plain loads and stores of whole bytes are optimized.
+  auto GetAccess = [&](Instruction *I, bool &IsWrite,
+                       uint64_t &TypeSize) -> Value * {
+    if (!isa<LoadInst>(I) && !isa<StoreInst>(I))
+      return nullptr;
+    unsigned Alignment;
+    Value *Addr = isInterestingMemoryAccess(I, &IsWrite, &TypeSize, &Alignment);
+    return Addr && TypeSize % 8 == 0 ? Addr : nullptr;
+  };
+
+  struct RangeCheck {
+    Instruction *I;
+    Instruction *InsertBefore;
+    const SCEV *Begin;
+    const SCEV *End;
+    bool IsWrite;
+  };
+  SmallVector<RangeCheck, 8> RangeChecks;
+  SmallPtrSet<Instruction *, 16> Optimized;
+
+  if (ClOptLoops) {
+    for (Instruction *I : ToInstrument) {
+      bool IsWrite;
+      uint64_t TypeSize;
+      Value *Addr = GetAccess(I, IsWrite, TypeSize);
+      Loop *L = LI.getLoopFor(I->getParent());
+      if (!Addr || !L || !L->getLoopPreheader() || !IsCallFree(L) ||
+          !runsOnEveryIteration(I, L, DT))
+        continue;
+
+      // The access touches [Begin, End) over all the iterations of L. It runs
+      // at least once per entry into L, so checking the range up front does
+      // not report accesses that were never made.
+      const SCEV *AddrSCEV = SE.getSCEV(Addr);
+      Type *AddrTy = SE.getEffectiveSCEVType(Addr->getType());
+      const SCEV *AccessSize = SE.getConstant(AddrTy, TypeSize / 8);
+      const SCEV *Begin, *End;
+      if (SE.isLoopInvariant(AddrSCEV, L)) {
+        Begin = AddrSCEV;
+        End = SE.getAddExpr(AddrSCEV, AccessSize);
+      } else {
+        auto *AR = dyn_cast<SCEVAddRecExpr>(AddrSCEV);
+        const SCEV *BTC = SE.getBackedgeTakenCount(L);
+        if (!AR || AR->getLoop() != L || !AR->isAffine() ||
+            !AR->hasNoSelfWrap() || isa<SCEVCouldNotCompute>(BTC))
+          continue;
+        // A stride larger than the access would check the bytes in between.
+        auto *Step = dyn_cast<SCEVConstant>(AR->getStepRecurrence(SE));
+        if (!Step || Step->getAPInt().abs().ugt(TypeSize / 8))
+          continue;
+        const SCEV *Last = AR->evaluateAtIteration(BTC, SE);
+        if (Step->getAPInt().isNegative()) {
+          Begin = Last;
+          End = SE.getAddExpr(AR->getStart(), AccessSize);
+        } else {
+          Begin = AR->getStart();
+          End = SE.getAddExpr(Last, AccessSize);
+        }
+      }
+
+      Instruction *InsertBefore = L->getLoopPreheader()->getTerminator();
+      if (!isSafeToExpandAt(Begin, InsertBefore, SE) ||
+          !isSafeToExpandAt(End, InsertBefore, SE))
+        continue;
+      RangeChecks.push_back({I, InsertBefore, Begin, End, IsWrite});
+      Optimized.insert(I);
+      NumOptimizedLoopAccesses++;
+    }
+  }
+
+  if (ClOptDominating) {
+    // Visit the accesses in reverse post-order, so that the accesses that
+    // dominate an access are visited before it. An access is only checked by
+    // an access that is itself instrumented.
+    SmallPtrSet<Instruction *, 16> Candidates(ToInstrument.begin(),
+                                              ToInstrument.end());
+    DenseMap<Value *, SmallVector<std::pair<Instruction *, uint64_t>, 4>>
+        CheckedAddrs;
+    ReversePostOrderTraversal<Function *> RPOT(&F);
+    for (BasicBlock *BB : RPOT) {
+      for (Instruction &I : *BB) {
+        if (!Candidates.count(&I) || Optimized.count(&I))
+          continue;
+        bool IsWrite;
+        uint64_t TypeSize;
+        Value *Addr = GetAccess(&I, IsWrite, TypeSize);
+        if (!Addr)
+          continue;
+        auto &Checks = CheckedAddrs[Addr];
+        bool IsDominated = llvm::any_of(
+            Checks, [&](const std::pair<Instruction *, uint64_t> &C) {
+              return C.second >= TypeSize && DT.dominates(C.first, &I) &&
+                     !hasCallBetween(C.first, &I, BlocksWithCalls);
+            });
+        if (IsDominated) {
+          Optimized.insert(&I);
+          NumOptimizedDominatedAccesses++;
+        } else {
+          Checks.push_back({&I, TypeSize});
+        }
+      }
+    }
+  }
+
+  ToInstrument.erase(std::remove_if(ToInstrument.begin(), ToInstrument.end(),
+                                    [&](Instruction *I) {
+                                      return Optimized.count(I);
+                                    }),
+                     ToInstrument.end());
+
+  // Emit the range checks as __asan_loadN / __asan_storeN calls, attributed
+  // to the first access of the range.
+  SCEVExpander Expander(SE, DL, "asan.range");
+  uint32_t Exp = ClForceExperiment;
+  for (const RangeCheck &RC : RangeChecks) {
+    IRBuilder<> IRB(RC.InsertBefore);
+    IRB.SetCurrentDebugLocation(RC.I->getDebugLoc());
+    Value *Begin = Expander.expandCodeFor(RC.Begin, IntptrTy, RC.InsertBefore);
+    Value *End = Expander.expandCodeFor(RC.End, IntptrTy, RC.InsertBefore);
+    Value *Size = IRB.CreateSub(End, Begin);
+    if (Exp == 0)
+      IRB.CreateCall(AsanMemoryAccessCallbackSized[RC.IsWrite][0],
+                     {Begin, Size});
+    else
+      IRB.CreateCall(AsanMemoryAccessCallbackSized[RC.IsWrite][1],
+                     {Begin, Size, ConstantInt::get(IRB.getInt32Ty(), Exp)});
+  }
+  return !RangeChecks.empty();
+}
+
 bool AddressSanitizer::instrumentFunction(Function &F,
                                           const TargetLibraryInfo *TLI) {
   if (F.getLinkage() == GlobalValue::AvailableExternallyLinkage) return false;
@@ -2677,6 +2906,10 @@ bool AddressSanitizer::instrumentFunction(Function &F,
     }
   }
 
+  bool InsertedRangeChecks = false;
+  if (ClOpt && (ClOptDominating || ClOptLoops))
+    InsertedRangeChecks = optimizeChecksAcrossBlocks(F, TLI, ToInstrument);
+
   bool UseCalls =
       (ClInstrumentationWithCallsThreshold >= 0 &&
        ToInstrument.size() > (unsigned)ClInstrumentationWithCallsThreshold);
@@ -2714,7 +2947,8 @@ bool AddressSanitizer::instrumentFunction(Function &F,
     NumInstrumented++;
   }
 
-  if (NumInstrumented > 0 || ChangedStack || !NoReturnCalls.empty())
+  if (NumInstrumented > 0 || ChangedStack || !NoReturnCalls.empty() ||
+      InsertedRangeChecks)
     FunctionModified = true;
 
   LLVM_DEBUG(dbgs() << "ASAN done instrumenting: " << FunctionModified << " "
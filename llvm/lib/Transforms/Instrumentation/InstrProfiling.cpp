@@ -71,6 +71,15 @@ cl::opt<unsigned> MemOPSizeLarge(
              "Value of 0 disables the large value profiling."),
     cl::init(8192));
 
+// Whether the memory intrinsic sizes between the precise range and the large
+// value are profiled in power-of-two buckets rather than as a single group.
+cl::opt<bool> MemOPSizeRangeBuckets(
+    "memop-size-range-buckets",
+    cl::desc("Profile the memory intrinsic sizes above the precise range in "
+             "power-of-two buckets. This needs a profile runtime that "
+             "provides " INSTR_PROF_VALUE_RANGE_BUCKETS_PROF_FUNC_STR),
+    cl::init(false));
+
 namespace {
 
 cl::opt<bool> DoNameCompression("enable-name-compression",
@@ -142,6 +151,25 @@ cl::opt<bool> IterativeCounterPromotion(
     cl::ZeroOrMore, "iterative-counter-promotion", cl::init(true),
     cl::desc("Allow counter promotion across the whole loop nest."));
 
+// If the option is not specified, sampling is done as set in the
+// InstrProfOptions of the pass.
+cl::opt<bool> SampledInstrumentation(
+    "sampled-instrumentation", cl::ZeroOrMore,
+    cl::desc("Only update the profile counters in bursts of sampled calls"),
+    cl::init(false));
+
+cl::opt<unsigned> SampledInstrPeriod(
+    "sampled-instr-period", cl::ZeroOrMore,
+    cl::desc("The number of calls of the instrumented functions of a thread "
+             "in one sampling period"),
+    cl::init(65536));
+
+cl::opt<unsigned> SampledInstrBurstDuration(
+    "sampled-instr-burst-duration", cl::ZeroOrMore,
+    cl::desc("The number of sampled calls at the start of each sampling "
+             "period"),
+    cl::init(200));
+
 class InstrProfilingLegacyPass : public ModulePass {
   InstrProfiling InstrProf;
 
@@ -161,7 +189,8 @@ public:
   }
 
   void getAnalysisUsage(AnalysisUsage &AU) const override {
-    AU.setPreservesCFG();
+    if (!InstrProf.isSamplingEnabled())
+      AU.setPreservesCFG();
     AU.addRequired<TargetLibraryInfoWrapperPass>();
   }
 };
@@ -402,18 +431,20 @@ static InstrProfIncrementInst *castToIncrementInst(Instruction *Instr) {
 bool InstrProfiling::lowerIntrinsics(Function *F) {
   bool MadeChange = false;
   PromotionCandidates.clear();
-  for (BasicBlock &BB : *F) {
-    for (auto I = BB.begin(), E = BB.end(); I != E;) {
-      auto Instr = I++;
-      InstrProfIncrementInst *Inc = castToIncrementInst(&*Instr);
-      if (Inc) {
-        lowerIncrement(Inc);
-        MadeChange = true;
-      } else if (auto *Ind = dyn_cast<InstrProfValueProfileInst>(Instr)) {
-        lowerValueProfileInst(Ind);
-        MadeChange = true;
-      }
-    }
+  IsSampled = nullptr;
+  // Collect the intrinsics first: sampled counter updates split the blocks.
+  SmallVector<Instruction *, 16> Intrinsics;
+  for (BasicBlock &BB : *F)
+    for (Instruction &I : BB)
+      if (castToIncrementInst(&I) || isa<InstrProfValueProfileInst>(I))
+        Intrinsics.push_back(&I);
+
+  for (Instruction *I : Intrinsics) {
+    if (InstrProfIncrementInst *Inc = castToIncrementInst(I))
+      lowerIncrement(Inc);
+    else
+      lowerValueProfileInst(cast<InstrProfValueProfileInst>(I));
+    MadeChange = true;
   }
 
   if (!MadeChange)
@@ -430,6 +461,50 @@ bool InstrProfiling::isCounterPromotionEnabled() const {
   return Options.DoCounterPromotion;
 }
 
+bool InstrProfiling::isSamplingEnabled() const {
+  if (SampledInstrumentation.getNumOccurrences() > 0)
+    return SampledInstrumentation;
+
+  return Options.Sampling;
+}
+
+Value *InstrProfiling::emitSamplingCheck(InstrProfIncrementInst *Inc) {
+  auto *Int32Ty = Type::getInt32Ty(M->getContext());
+  if (!SamplingVar) {
+    // One sampling variable per linkage unit. It is thread-local, so that the
+    // threads neither share it nor the cache lines of the counters that they
+    // update outside of each other's bursts.
+    SamplingVar = new GlobalVariable(
+        *M, Int32Ty, false, GlobalValue::LinkOnceODRLinkage,
+        ConstantInt::get(Int32Ty, 0), "__llvm_profile_sampling", nullptr,
+        GlobalValue::GeneralDynamicTLSModel);
+    SamplingVar->setVisibility(GlobalValue::HiddenVisibility);
+    if (TT.supportsCOMDAT())
+      SamplingVar->setComdat(M->getOrInsertComdat(SamplingVar->getName()));
+  }
+
+  // Count the call after the allocas of the entry block, so that they stay
+  // static allocas once the counter updates are made conditional.
+  Function *F = Inc->getFunction();
+  auto IP = F->getEntryBlock().begin();
+  while (isa<AllocaInst>(IP))
+    ++IP;
+
+  // The first SampledInstrBurstDuration calls of every SampledInstrPeriod
+  // calls are sampled. All the counters of a sampled call are updated, so the
+  // counts of a function stay consistent with each other.
+  IRBuilder<> Builder(&*IP);
+  unsigned Period = std::max(SampledInstrPeriod.getValue(), 1U);
+  Value *Calls = Builder.CreateLoad(Int32Ty, SamplingVar, "pgosampling");
+  Value *NextCalls = Builder.CreateAdd(Calls, Builder.getInt32(1));
+  NextCalls = Builder.CreateSelect(
+      Builder.CreateICmpUGE(NextCalls, Builder.getInt32(Period)),
+      Builder.getInt32(0), NextCalls);
+  Builder.CreateStore(NextCalls, SamplingVar);
+  return Builder.CreateICmpULT(
+      Calls, Builder.getInt32(SampledInstrBurstDuration), "pgosampled");
+}
+
 void InstrProfiling::promoteCounterLoadStores(Function *F) {
   if (!isCounterPromotionEnabled())
     return;
@@ -487,6 +562,7 @@ bool InstrProfiling::run(Module &M, const TargetLibraryInfo &TLI) {
   this->TLI = &TLI;
   NamesVar = nullptr;
   NamesSize = 0;
+  SamplingVar = nullptr;
   ProfileDataMap.clear();
   UsedVars.clear();
   getMemOPSizeRangeFromOption(MemOPSizeRange, MemOPSizeRangeStart,
@@ -567,8 +643,10 @@ getOrInsertValueProfilingCall(Module &M, const TargetLibraryInfo &TLI,
     };
     auto *ValueRangeProfilingCallTy =
         FunctionType::get(ReturnTy, makeArrayRef(RangeParamTypes), false);
-    return M.getOrInsertFunction(getInstrProfValueRangeProfFuncName(),
-                                 ValueRangeProfilingCallTy, AL);
+    return M.getOrInsertFunction(
+        MemOPSizeRangeBuckets ? getInstrProfValueRangeBucketsProfFuncName()
+                              : getInstrProfValueRangeProfFuncName(),
+        ValueRangeProfilingCallTy, AL);
   }
 }
 
@@ -626,7 +704,17 @@ void InstrProfiling::lowerValueProfileInst(InstrProfValueProfileInst *Ind) {
 void InstrProfiling::lowerIncrement(InstrProfIncrementInst *Inc) {
   GlobalVariable *Counters = getOrCreateRegionCounters(Inc);
 
-  IRBuilder<> Builder(Inc);
+  // Only update the counter in sampled calls. The updates are not promoted,
+  // as they are conditional.
+  bool Sampled = isSamplingEnabled();
+  Instruction *InsertPt = Inc;
+  if (Sampled) {
+    if (!IsSampled)
+      IsSampled = emitSamplingCheck(Inc);
+    InsertPt = SplitBlockAndInsertIfThen(IsSampled, Inc, false);
+  }
+
+  IRBuilder<> Builder(InsertPt);
   uint64_t Index = Inc->getIndex()->getZExtValue();
   Value *Addr = Builder.CreateConstInBoundsGEP2_64(Counters->getValueType(),
                                                    Counters, 0, Index);
@@ -639,7 +727,7 @@ void InstrProfiling::lowerIncrement(InstrProfIncrementInst *Inc) {
     Value *Load = Builder.CreateLoad(IncStep->getType(), Addr, "pgocount");
     auto *Count = Builder.CreateAdd(Load, Inc->getStep());
     auto *Store = Builder.CreateStore(Count, Addr);
-    if (isCounterPromotionEnabled())
+    if (isCounterPromotionEnabled() && !Sampled)
       PromotionCandidates.emplace_back(cast<Instruction>(Load), Store);
   }
   Inc->eraseFromParent();
@@ -12,6 +12,12 @@
 // to a sequence of guarded specialized versions that are called with the
 // hottest size(s), for later expansion into more optimal inline sequences.
 //
+// When the sizes above the precise range were profiled in power-of-two buckets
+// (see -memop-size-range-buckets), a hot bucket (P / 2, P] of a small enough
+// memcpy or memset is guarded by a range check and expanded right away into
+// two accesses of P / 2 bytes, at the start and at the end of the block of
+// memory, which overlap unless the size is P.
+//
 //===----------------------------------------------------------------------===//
 
 #include "llvm/ADT/ArrayRef.h"
@@ -47,8 +53,11 @@
 #include "llvm/Transforms/Instrumentation.h"
 #include "llvm/Transforms/Instrumentation/PGOInstrumentation.h"
 #include "llvm/Transforms/Utils/BasicBlockUtils.h"
+#include <algorithm>
 #include <cassert>
 #include <cstdint>
+#include <tuple>
+#include <utility>
 #include <vector>
 
 using namespace llvm;
@@ -90,6 +99,14 @@ static cl::opt<bool>
                     cl::desc("Scale the memop size counts using the basic "
                              " block count value"));
 
+// The largest size bucket that is expanded inline.
+static cl::opt<unsigned>
+    MemOPMaxInlineSize("pgo-memop-max-inline-size", cl::init(64), cl::Hidden,
+                       cl::ZeroOrMore,
+                       cl::desc("The largest size up to which a hot bucket of "
+                                "memory intrinsic sizes is expanded inline. "
+                                "0 disables the expansion of buckets"));
+
 // This option sets the rangge of precise profile memop sizes.
 extern cl::opt<std::string> MemOPSizeRange;
 
@@ -185,16 +202,25 @@ private:
 
   // This kind shows which group the value falls in. For PreciseValue, we have
   // the profile count for that value. LargeGroup groups the values that are in
-  // range [LargeValue, +inf). NonLargeGroup groups the rest of values.
-  enum MemOPSizeKind { PreciseValue, NonLargeGroup, LargeGroup };
+  // range [LargeValue, +inf). RangeBucket groups the values in a power-of-two
+  // bucket above the precise range, see getBucketStart(). NonLargeGroup groups
+  // the rest of values.
+  enum MemOPSizeKind { PreciseValue, NonLargeGroup, LargeGroup, RangeBucket };
 
   MemOPSizeKind getMemOPSizeKind(int64_t Value) const {
     if (Value == MemOPSizeLarge && MemOPSizeLarge != 0)
       return LargeGroup;
     if (Value == PreciseRangeLast + 1)
       return NonLargeGroup;
+    if (Value > PreciseRangeLast + 1 && isPowerOf2_64(Value))
+      return RangeBucket;
     return PreciseValue;
   }
+
+  // Returns the smallest size in the bucket whose largest size is \p Value.
+  uint64_t getBucketStart(int64_t Value) const {
+    return std::max<int64_t>(Value / 2, PreciseRangeLast) + 1;
+  }
 };
 
 static const char *getMIName(const MemIntrinsic *MI) {
@@ -219,6 +245,52 @@ static bool isProfitable(uint64_t Count, uint64_t TotalCount) {
   return true;
 }
 
+// Returns true if \p MI can be expanded inline for the sizes of the bucket
+// whose largest size is \p Value.
+static bool canExpandBucket(const MemIntrinsic *MI, uint64_t Value) {
+  if (MemOPMaxInlineSize == 0 || Value > MemOPMaxInlineSize)
+    return false;
+  return !MI->isVolatile() && (isa<MemCpyInst>(MI) || isa<MemSetInst>(MI));
+}
+
+// Expands \p MI, whose length is known to be in [AccessSize, 2 * AccessSize],
+// into an access of AccessSize bytes at the start of its block of memory and
+// one at the end, at the insertion point of \p IRB.
+static void expandMemOpInline(MemIntrinsic *MI, uint64_t AccessSize,
+                              IRBuilder<> &IRB) {
+  Type *Ty = AccessSize <= 8
+                 ? static_cast<Type *>(IRB.getIntNTy(AccessSize * 8))
+                 : VectorType::get(IRB.getInt8Ty(), AccessSize);
+  Value *Length = MI->getLength();
+  Value *TailOffset =
+      IRB.CreateSub(Length, ConstantInt::get(Length->getType(), AccessSize));
+  auto GetHeadAndTail = [&](Value *Ptr) {
+    Type *PtrTy = Ty->getPointerTo(Ptr->getType()->getPointerAddressSpace());
+    Value *Tail = IRB.CreateGEP(IRB.getInt8Ty(), Ptr, TailOffset);
+    return std::make_pair(IRB.CreateBitCast(Ptr, PtrTy),
+                          IRB.CreateBitCast(Tail, PtrTy));
+  };
+
+  Value *Dst, *DstTail;
+  std::tie(Dst, DstTail) = GetHeadAndTail(MI->getRawDest());
+  Value *Head, *Tail;
+  if (auto *MCI = dyn_cast<MemCpyInst>(MI)) {
+    // Load both parts before storing either of them, as the source and the
+    // destination of a memcpy may be equal.
+    Value *Src, *SrcTail;
+    std::tie(Src, SrcTail) = GetHeadAndTail(MCI->getRawSource());
+    Head = IRB.CreateAlignedLoad(Ty, Src,
+                                 std::max(MCI->getSourceAlignment(), 1u));
+    Tail = IRB.CreateAlignedLoad(Ty, SrcTail, 1);
+  } else {
+    Value *Splat = IRB.CreateVectorSplat(AccessSize,
+                                         cast<MemSetInst>(MI)->getValue());
+    Head = Tail = IRB.CreateBitCast(Splat, Ty);
+  }
+  IRB.CreateAlignedStore(Head, Dst, std::max(MI->getDestAlignment(), 1u));
+  IRB.CreateAlignedStore(Tail, DstTail, 1);
+}
+
 static inline uint64_t getScaledCount(uint64_t Count, uint64_t Num,
                                       uint64_t Denom) {
   if (!MemOPScaleCount)
@@ -272,46 +344,56 @@ bool MemOPSizeOpt::perform(MemIntrinsic *MI) {
   uint64_t SavedRemainCount = SavedTotalCount;
   SmallVector<uint64_t, 16> SizeIds;
   SmallVector<uint64_t, 16> CaseCounts;
-  uint64_t MaxCount = 0;
+  SmallVector<uint64_t, 4> BucketIds;
+  SmallVector<uint64_t, 4> BucketCounts;
+  SmallVector<InstrProfValueData, 8> RemainVDs;
   unsigned Version = 0;
   // Default case is in the front -- save the slot here.
   CaseCounts.push_back(0);
-  for (auto &VD : VDs) {
+  for (unsigned I = 0, E = VDs.size(); I != E; ++I) {
+    const InstrProfValueData &VD = VDs[I];
     int64_t V = VD.Value;
     uint64_t C = VD.Count;
     if (MemOPScaleCount)
       C = getScaledCount(C, ActualCount, SavedTotalCount);
 
-    // Only care precise value here.
-    if (getMemOPSizeKind(V) != PreciseValue)
+    // Only care precise value and the buckets that can be expanded here.
+    MemOPSizeKind Kind = getMemOPSizeKind(V);
+    if (Kind != PreciseValue &&
+        (Kind != RangeBucket || !canExpandBucket(MI, V))) {
+      RemainVDs.push_back(VD);
       continue;
+    }
 
     // ValueCounts are sorted on the count. Break at the first un-profitable
     // value.
-    if (!isProfitable(C, RemainCount))
+    if (!isProfitable(C, RemainCount)) {
+      RemainVDs.append(VDs.begin() + I, VDs.end());
       break;
+    }
 
-    SizeIds.push_back(V);
-    CaseCounts.push_back(C);
-    if (C > MaxCount)
-      MaxCount = C;
+    if (Kind == RangeBucket) {
+      BucketIds.push_back(V);
+      BucketCounts.push_back(C);
+    } else {
+      SizeIds.push_back(V);
+      CaseCounts.push_back(C);
+    }
 
     assert(RemainCount >= C);
     RemainCount -= C;
     assert(SavedRemainCount >= VD.Count);
     SavedRemainCount -= VD.Count;
 
-    if (++Version > MemOPMaxVersion && MemOPMaxVersion != 0)
+    if (++Version > MemOPMaxVersion && MemOPMaxVersion != 0) {
+      RemainVDs.append(VDs.begin() + I + 1, VDs.end());
       break;
+    }
   }
 
   if (Version == 0)
     return false;
 
-  CaseCounts[0] = RemainCount;
-  if (RemainCount > MaxCount)
-    MaxCount = RemainCount;
-
   uint64_t SumForOpt = TotalCount - RemainCount;
 
   LLVM_DEBUG(dbgs() << "Optimize one memory intrinsic call to " << Version
@@ -329,6 +411,11 @@ bool MemOPSizeOpt::perform(MemIntrinsic *MI) {
   //      goto merge_bb;
   //   ...
   //   default:
+  //      if (size - lo1 <= hi1 - lo1) {
+  //        inline expansion of mem_op(..., size) for sizes in [lo1, hi1];
+  //        goto merge_bb;
+  //      }
+  //      ...
   //      mem_op(..., size);
   //      goto merge_bb;
   // }
@@ -350,50 +437,99 @@ bool MemOPSizeOpt::perform(MemIntrinsic *MI) {
 
   DomTreeUpdater DTU(DT, DomTreeUpdater::UpdateStrategy::Eager);
   auto &Ctx = Func.getContext();
+  Value *SizeVar = MI->getLength();
+  IntegerType *SizeType = dyn_cast<IntegerType>(SizeVar->getType());
+  assert(SizeType && "Expected integer type size argument.");
+
+  std::vector<DominatorTree::UpdateType> Updates;
+  if (DT)
+    Updates.reserve(2 * SizeIds.size() + 3 * BucketIds.size() + 2);
+
+  // Chain the range checks of the buckets, hottest first, in front of the
+  // default block.
+  BasicBlock *FallbackBB = DefaultBB;
+  uint64_t FallbackCount = RemainCount;
+  for (unsigned I = BucketIds.size(); I-- > 0;) {
+    uint64_t Hi = BucketIds[I];
+    uint64_t Lo = getBucketStart(Hi);
+    BasicBlock *CaseBB = BasicBlock::Create(
+        Ctx, Twine("MemOP.Range.") + Twine(Lo) + "." + Twine(Hi), &Func,
+        FallbackBB);
+    BasicBlock *CheckBB = BasicBlock::Create(
+        Ctx, Twine("MemOP.Check.") + Twine(Hi), &Func, CaseBB);
+
+    IRBuilder<> IRBCheck(CheckBB);
+    IRBCheck.SetCurrentDebugLocation(MI->getDebugLoc());
+    Value *InRange = IRBCheck.CreateICmpULE(
+        IRBCheck.CreateSub(SizeVar, ConstantInt::get(SizeType, Lo)),
+        ConstantInt::get(SizeType, Hi - Lo));
+    BranchInst *Br = IRBCheck.CreateCondBr(InRange, CaseBB, FallbackBB);
+    uint64_t BranchCounts[] = {BucketCounts[I], FallbackCount};
+    setProfMetadata(Func.getParent(), Br, BranchCounts,
+                    std::max(BucketCounts[I], FallbackCount));
+
+    IRBuilder<> IRBCase(CaseBB);
+    IRBCase.SetCurrentDebugLocation(MI->getDebugLoc());
+    expandMemOpInline(MI, Hi / 2, IRBCase);
+    IRBCase.CreateBr(MergeBB);
+
+    if (DT) {
+      Updates.push_back({DominatorTree::Insert, CheckBB, CaseBB});
+      Updates.push_back({DominatorTree::Insert, CheckBB, FallbackBB});
+      Updates.push_back({DominatorTree::Insert, CaseBB, MergeBB});
+    }
+    LLVM_DEBUG(dbgs() << *CheckBB << "\n" << *CaseBB << "\n");
+    FallbackBB = CheckBB;
+    FallbackCount += BucketCounts[I];
+  }
+
   IRBuilder<> IRB(BB);
   BB->getTerminator()->eraseFromParent();
-  Value *SizeVar = MI->getLength();
-  SwitchInst *SI = IRB.CreateSwitch(SizeVar, DefaultBB, SizeIds.size());
+  if (DT && FallbackBB != DefaultBB) {
+    Updates.push_back({DominatorTree::Delete, BB, DefaultBB});
+    Updates.push_back({DominatorTree::Insert, BB, FallbackBB});
+  }
 
   // Clear the value profile data.
   MI->setMetadata(LLVMContext::MD_prof, nullptr);
   // If all promoted, we don't need the MD.prof metadata.
-  if (SavedRemainCount > 0 || Version != NumVals)
+  if (SavedRemainCount > 0 || !RemainVDs.empty())
     // Otherwise we need update with the un-promoted records back.
-    annotateValueSite(*Func.getParent(), *MI, VDs.slice(Version),
-                      SavedRemainCount, IPVK_MemOPSize, NumVals);
+    annotateValueSite(*Func.getParent(), *MI, RemainVDs, SavedRemainCount,
+                      IPVK_MemOPSize, NumVals);
 
   LLVM_DEBUG(dbgs() << "\n\n== Basic Block After==\n");
 
-  std::vector<DominatorTree::UpdateType> Updates;
-  if (DT)
-    Updates.reserve(2 * SizeIds.size());
-
-  for (uint64_t SizeId : SizeIds) {
-    BasicBlock *CaseBB = BasicBlock::Create(
-        Ctx, Twine("MemOP.Case.") + Twine(SizeId), &Func, DefaultBB);
-    Instruction *NewInst = MI->clone();
-    // Fix the argument.
-    MemIntrinsic * MemI = dyn_cast<MemIntrinsic>(NewInst);
-    IntegerType *SizeType = dyn_cast<IntegerType>(MemI->getLength()->getType());
-    assert(SizeType && "Expected integer type size argument.");
-    ConstantInt *CaseSizeId = ConstantInt::get(SizeType, SizeId);
-    MemI->setLength(CaseSizeId);
-    CaseBB->getInstList().push_back(NewInst);
-    IRBuilder<> IRBCase(CaseBB);
-    IRBCase.CreateBr(MergeBB);
-    SI->addCase(CaseSizeId, CaseBB);
-    if (DT) {
-      Updates.push_back({DominatorTree::Insert, CaseBB, MergeBB});
-      Updates.push_back({DominatorTree::Insert, BB, CaseBB});
+  if (SizeIds.empty()) {
+    IRB.CreateBr(FallbackBB);
+  } else {
+    SwitchInst *SI = IRB.CreateSwitch(SizeVar, FallbackBB, SizeIds.size());
+    for (uint64_t SizeId : SizeIds) {
+      BasicBlock *CaseBB = BasicBlock::Create(
+          Ctx, Twine("MemOP.Case.") + Twine(SizeId), &Func, FallbackBB);
+      Instruction *NewInst = MI->clone();
+      // Fix the argument.
+      MemIntrinsic * MemI = dyn_cast<MemIntrinsic>(NewInst);
+      ConstantInt *CaseSizeId = ConstantInt::get(SizeType, SizeId);
+      MemI->setLength(CaseSizeId);
+      CaseBB->getInstList().push_back(NewInst);
+      IRBuilder<> IRBCase(CaseBB);
+      IRBCase.CreateBr(MergeBB);
+      SI->addCase(CaseSizeId, CaseBB);
+      if (DT) {
+        Updates.push_back({DominatorTree::Insert, CaseBB, MergeBB});
+        Updates.push_back({DominatorTree::Insert, BB, CaseBB});
+      }
+      LLVM_DEBUG(dbgs() << *CaseBB << "\n");
     }
-    LLVM_DEBUG(dbgs() << *CaseBB << "\n");
+
+    CaseCounts[0] = FallbackCount;
+    uint64_t MaxCount = *std::max_element(CaseCounts.begin(), CaseCounts.end());
+    setProfMetadata(Func.getParent(), SI, CaseCounts, MaxCount);
   }
   DTU.applyUpdates(Updates);
   Updates.clear();
 
-  setProfMetadata(Func.getParent(), SI, CaseCounts, MaxCount);
-
   LLVM_DEBUG(dbgs() << *BB << "\n");
   LLVM_DEBUG(dbgs() << *DefaultBB << "\n");
   LLVM_DEBUG(dbgs() << *MergeBB << "\n");
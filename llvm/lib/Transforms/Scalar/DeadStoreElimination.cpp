@@ -9,8 +9,9 @@
 // This file implements a trivial dead store elimination that only considers
 // basic-block local redundant stores.
 //
-// FIXME: This should eventually be extended to be a post-dominator tree
-// traversal.  Doing so would be pretty trivial.
+// With -enable-dse-memoryssa, a MemorySSA-based implementation is used
+// instead, which also removes stores overwritten in other blocks, see
+// DSEState.
 //
 //===----------------------------------------------------------------------===//
 
@@ -28,7 +29,10 @@
 #include "llvm/Analysis/MemoryBuiltins.h"
 #include "llvm/Analysis/MemoryDependenceAnalysis.h"
 #include "llvm/Analysis/MemoryLocation.h"
+#include "llvm/Analysis/MemorySSA.h"
+#include "llvm/Analysis/MemorySSAUpdater.h"
 #include "llvm/Analysis/OrderedBasicBlock.h"
+#include "llvm/Analysis/PostDominators.h"
 #include "llvm/Analysis/TargetLibraryInfo.h"
 #include "llvm/Analysis/ValueTracking.h"
 #include "llvm/IR/Argument.h"
@@ -74,6 +78,8 @@ STATISTIC(NumFastStores, "Number of stores deleted");
 STATISTIC(NumFastOther, "Number of other instrs removed");
 STATISTIC(NumCompletePartials, "Number of stores dead by later partials");
 STATISTIC(NumModifiedStores, "Number of stores modified");
+STATISTIC(NumCrossBlockStores,
+          "Number of stores deleted by a later store in another block");
 
 static cl::opt<bool>
 EnablePartialOverwriteTracking("enable-dse-partial-overwrite-tracking",
@@ -85,6 +91,20 @@ EnablePartialStoreMerging("enable-dse-partial-store-merging",
   cl::init(true), cl::Hidden,
   cl::desc("Enable partial store merging in DSE"));
 
+static cl::opt<bool>
+EnableMemorySSA("enable-dse-memoryssa", cl::init(false), cl::Hidden,
+  cl::desc("Use the MemorySSA-based DSE"));
+
+static cl::opt<unsigned> MemorySSAUpwardsStepLimit(
+    "dse-memoryssa-walklimit", cl::init(90), cl::Hidden,
+    cl::desc("The maximum number of MemoryDefs the MemorySSA-based DSE walks "
+             "up from a store looking for earlier stores it overwrites"));
+
+static cl::opt<unsigned> MemorySSAScanLimit(
+    "dse-memoryssa-scanlimit", cl::init(150), cl::Hidden,
+    cl::desc("The maximum number of memory accesses the MemorySSA-based DSE "
+             "checks for reads of a store before giving up on it"));
+
 //===----------------------------------------------------------------------===//
 // Helper functions
 //===----------------------------------------------------------------------===//
@@ -593,6 +613,9 @@ static bool memoryIsNotModifiedBetween(Instruction *FirstI,
   BasicBlock *FirstBB = FirstI->getParent();
   BasicBlock *SecondBB = SecondI->getParent();
   MemoryLocation MemLoc = MemoryLocation::get(SecondI);
+  // Nothing is changed during the walk, so the queries can share their
+  // results, e.g. the decomposition of MemLoc.
+  BatchAAResults BatchAA(*AA);
 
   // Start checking the store-block.
   WorkList.push_back(SecondBB);
@@ -619,7 +642,7 @@ static bool memoryIsNotModifiedBetween(Instruction *FirstI,
     for (; BI != EI; ++BI) {
       Instruction *I = &*BI;
       if (I->mayWriteToMemory() && I != SecondI)
-        if (isModSet(AA->getModRefInfo(I, MemLoc)))
+        if (isModSet(BatchAA.getModRefInfo(I, MemLoc)))
           return false;
     }
     if (B != FirstBB) {
@@ -714,7 +737,7 @@ static bool handleFree(CallInst *F, AliasAnalysis *AA,
 /// being loaded.
 static void removeAccessedObjects(const MemoryLocation &LoadedLoc,
                                   SmallSetVector<const Value *, 16> &DeadStackObjects,
-                                  const DataLayout &DL, AliasAnalysis *AA,
+                                  const DataLayout &DL, BatchAAResults &AA,
                                   const TargetLibraryInfo *TLI,
                                   const Function *F) {
   const Value *UnderlyingPointer = GetUnderlyingObject(LoadedLoc.Ptr, DL);
@@ -734,7 +757,7 @@ static void removeAccessedObjects(const MemoryLocation &LoadedLoc,
   DeadStackObjects.remove_if([&](const Value *I) {
     // See if the loaded location could alias the stack location.
     MemoryLocation StackLoc(I, getPointerSize(I, DL, *TLI, F));
-    return !AA->isNoAlias(StackLoc, LoadedLoc);
+    return AA.alias(StackLoc, LoadedLoc) != NoAlias;
   });
 }
 
@@ -775,6 +798,12 @@ static bool handleEndBlock(BasicBlock &BB, AliasAnalysis *AA,
 
   const DataLayout &DL = BB.getModule()->getDataLayout();
 
+  // The scan below only deletes instructions and never creates any, so no
+  // cached query can be confused by a new value reusing the address of a
+  // deleted one. Deleting stores can only remove captures and accesses, which
+  // leaves the cached results conservatively correct.
+  BatchAAResults BatchAA(*AA);
+
   // Scan the basic block backwards
   for (BasicBlock::iterator BBI = BB.end(); BBI != BB.begin(); ){
     --BBI;
@@ -850,8 +879,9 @@ static bool handleEndBlock(BasicBlock &BB, AliasAnalysis *AA,
       // the call is live.
       DeadStackObjects.remove_if([&](const Value *I) {
         // See if the call site touches the value.
-        return isRefSet(AA->getModRefInfo(
-            Call, I, getPointerSize(I, DL, *TLI, BB.getParent())));
+        return isRefSet(BatchAA.getModRefInfo(
+            Call,
+            MemoryLocation(I, getPointerSize(I, DL, *TLI, BB.getParent()))));
       });
 
       // If all of the allocas were clobbered by the call then we're not going
@@ -890,7 +920,8 @@ static bool handleEndBlock(BasicBlock &BB, AliasAnalysis *AA,
 
     // Remove any allocas from the DeadPointer set that are loaded, as this
     // makes any stores above the access live.
-    removeAccessedObjects(LoadedLoc, DeadStackObjects, DL, AA, TLI, BB.getParent());
+    removeAccessedObjects(LoadedLoc, DeadStackObjects, DL, BatchAA, TLI,
+                          BB.getParent());
 
     // If all of the allocas were clobbered by the access then we're not going
     // to find anything else to process.
@@ -1322,15 +1353,299 @@ static bool eliminateDeadStores(Function &F, AliasAnalysis *AA,
   return MadeChange;
 }
 
+//===----------------------------------------------------------------------===//
+// MemorySSA-based DSE
+//===----------------------------------------------------------------------===//
+//
+// Instead of asking MemoryDependenceResults for the store a store overwrites,
+// which is limited to a scan of the current block, walk up the MemoryDefs from
+// each store (the killing store) and remove the earlier stores it completely
+// overwrites, in any block, if
+//
+//  * the killing store post-dominates the earlier one, so every path from the
+//    earlier store to the end of the function passes the killing store,
+//  * no memory access reachable from the earlier store through the MemorySSA
+//    use lists may read the overwritten memory before a store overwriting it,
+//  * the earlier store cannot be observed by an unwinding caller.
+//
+// Stores to allocas which are not read at all before the function returns
+// are removed as well. Both walks are bounded by the limits above, which
+// keeps the pass linear in the size of the function.
+
+namespace {
+
+struct DSEState {
+  Function &F;
+  AliasAnalysis &AA;
+  // The pass only deletes instructions, which leaves the cached results
+  // conservatively correct.
+  BatchAAResults BatchAA;
+  MemorySSA &MSSA;
+  DominatorTree &DT;
+  PostDominatorTree &PDT;
+  const TargetLibraryInfo &TLI;
+  const DataLayout &DL;
+
+  // The stores which may be removed or may kill others, in program order.
+  SmallVector<Instruction *, 64> Stores;
+  // Instructions which were deleted, so Stores must skip them.
+  SmallPtrSet<Instruction *, 16> Deleted;
+  // Whether some instruction may unwind to a caller.
+  bool HasThrowingInst = false;
+
+  DSEState(Function &F, AliasAnalysis &AA, MemorySSA &MSSA, DominatorTree &DT,
+           PostDominatorTree &PDT, const TargetLibraryInfo &TLI)
+      : F(F), AA(AA), BatchAA(AA), MSSA(MSSA), DT(DT), PDT(PDT), TLI(TLI),
+        DL(F.getParent()->getDataLayout()) {
+    for (BasicBlock &BB : F) {
+      // Dead blocks may have strange pointer cycles that will confuse alias
+      // analysis.
+      if (!DT.isReachableFromEntry(&BB))
+        continue;
+      for (Instruction &I : BB) {
+        if (I.mayThrow())
+          HasThrowingInst = true;
+        if (isa_and_nonnull<MemoryDef>(MSSA.getMemoryAccess(&I)) &&
+            hasAnalyzableMemoryWrite(&I, TLI))
+          Stores.push_back(&I);
+      }
+    }
+  }
+
+  /// Returns true if \p I is a store the pass may delete.
+  bool isRemovableStore(Instruction *I) {
+    if (!isRemovable(I))
+      return false;
+    // Leave atomic stores alone, even unordered ones.
+    if (auto *SI = dyn_cast<StoreInst>(I))
+      return SI->isSimple();
+    return true;
+  }
+
+  /// Returns true if the memory \p Loc points into is gone once the function
+  /// returns or unwinds, so no caller can see what was stored to it.
+  bool isInvisibleToCaller(const MemoryLocation &Loc) {
+    return isa<AllocaInst>(GetUnderlyingObject(Loc.Ptr, DL));
+  }
+
+  /// Returns true if \p I overwrites all of \p EarlierLoc.
+  bool isCompleteOverwrite(Instruction *I, const MemoryLocation &EarlierLoc) {
+    if (!hasAnalyzableMemoryWrite(I, TLI))
+      return false;
+    MemoryLocation Loc = getLocForWrite(I);
+    if (!Loc.Ptr)
+      return false;
+    int64_t EarlierOff = 0, LaterOff = 0;
+    InstOverlapIntervalsTy IOL;
+    return isOverwrite(Loc, EarlierLoc, DL, TLI, EarlierOff, LaterOff, I, IOL,
+                       AA, &F) == OW_Complete;
+  }
+
+  /// Returns true if nothing reachable from \p EarlierDef may read the memory
+  /// at \p EarlierLoc before it is completely overwritten. Without a
+  /// \p Killer, the walk may come back to \p EarlierDef around a loop, as the
+  /// store is dead in every iteration then.
+  bool isUnreadBeforeOverwrite(MemoryDef *EarlierDef,
+                               const MemoryLocation &EarlierLoc,
+                               Instruction *Killer) {
+    SmallVector<MemoryAccess *, 32> WorkList;
+    SmallPtrSet<MemoryAccess *, 32> Visited;
+    auto PushUses = [&](MemoryAccess *Acc) {
+      for (Use &U : Acc->uses()) {
+        auto *UseAccess = cast<MemoryAccess>(U.getUser());
+        if (Visited.insert(UseAccess).second)
+          WorkList.push_back(UseAccess);
+      }
+    };
+    PushUses(EarlierDef);
+
+    for (unsigned I = 0; I < WorkList.size(); ++I) {
+      if (I >= MemorySSAScanLimit)
+        return false;
+      MemoryAccess *UseAccess = WorkList[I];
+      if (isa<MemoryPhi>(UseAccess)) {
+        PushUses(UseAccess);
+        continue;
+      }
+
+      // The store is reached again by going around a loop, and a later
+      // iteration may store somewhere else.
+      if (UseAccess == EarlierDef) {
+        if (Killer)
+          return false;
+        continue;
+      }
+
+      Instruction *UseInst = cast<MemoryUseOrDef>(UseAccess)->getMemoryInst();
+      if (isRefSet(BatchAA.getModRefInfo(UseInst, EarlierLoc)))
+        return false;
+
+      // Accesses after a complete overwrite read the later store.
+      if (isa<MemoryDef>(UseAccess) &&
+          (UseInst == Killer || isCompleteOverwrite(UseInst, EarlierLoc)))
+        continue;
+      PushUses(UseAccess);
+    }
+    return true;
+  }
+
+  /// Delete \p I from the function and MemorySSA, and the computation tree
+  /// that only fed it.
+  void deleteDeadInstruction(Instruction *I) {
+    MemorySSAUpdater Updater(&MSSA);
+    SmallVector<Instruction *, 32> NowDeadInsts;
+
+    NowDeadInsts.push_back(I);
+    --NumFastOther;
+
+    do {
+      Instruction *DeadInst = NowDeadInsts.pop_back_val();
+      ++NumFastOther;
+
+      // Try to preserve debug information attached to the dead instruction.
+      salvageDebugInfo(*DeadInst);
+
+      if (MemoryAccess *MA = MSSA.getMemoryAccess(DeadInst))
+        Updater.removeMemoryAccess(MA);
+
+      for (unsigned op = 0, e = DeadInst->getNumOperands(); op != e; ++op) {
+        Value *Op = DeadInst->getOperand(op);
+        DeadInst->setOperand(op, nullptr);
+
+        // If this operand just became dead, add it to the NowDeadInsts list.
+        if (!Op->use_empty())
+          continue;
+
+        if (Instruction *OpI = dyn_cast<Instruction>(Op))
+          if (isInstructionTriviallyDead(OpI, &TLI))
+            NowDeadInsts.push_back(OpI);
+      }
+
+      Deleted.insert(DeadInst);
+      DeadInst->eraseFromParent();
+    } while (!NowDeadInsts.empty());
+  }
+
+  /// Remove the earlier stores \p Killer completely overwrites.
+  bool eliminateDeadStoresKilledBy(Instruction *Killer) {
+    MemoryLocation KillerLoc = getLocForWrite(Killer);
+    if (!KillerLoc.Ptr)
+      return false;
+
+    bool MadeChange = false;
+    auto *KillerDef = cast<MemoryDef>(MSSA.getMemoryAccess(Killer));
+    MemoryAccess *Current = KillerDef->getDefiningAccess();
+    for (unsigned Steps = 0; Steps < MemorySSAUpwardsStepLimit; ++Steps) {
+      // FIXME: Look through MemoryPhis, which needs the earlier store to be
+      // found on every incoming path.
+      if (MSSA.isLiveOnEntryDef(Current) || !isa<MemoryDef>(Current))
+        break;
+      auto *EarlierDef = cast<MemoryDef>(Current);
+      Current = EarlierDef->getDefiningAccess();
+
+      // Other writes in between are fine: anything reading the earlier
+      // store is found by isUnreadBeforeOverwrite.
+      Instruction *Earlier = EarlierDef->getMemoryInst();
+      if (!hasAnalyzableMemoryWrite(Earlier, TLI) || !isRemovableStore(Earlier))
+        continue;
+      MemoryLocation EarlierLoc = getLocForWrite(Earlier);
+      if (!EarlierLoc.Ptr)
+        continue;
+
+      // The MemoryDef chain has no MemoryPhi in between, so Earlier dominates
+      // Killer. It must also be followed by Killer on every path.
+      if (!PDT.dominates(Killer->getParent(), Earlier->getParent()))
+        continue;
+      if (HasThrowingInst && !isInvisibleToCaller(EarlierLoc))
+        continue;
+
+      int64_t EarlierOff = 0, LaterOff = 0;
+      InstOverlapIntervalsTy IOL;
+      if (isOverwrite(KillerLoc, EarlierLoc, DL, TLI, EarlierOff, LaterOff,
+                      Earlier, IOL, AA, &F) != OW_Complete)
+        continue;
+      if (!isUnreadBeforeOverwrite(EarlierDef, EarlierLoc, Killer))
+        continue;
+
+      LLVM_DEBUG(dbgs() << "DSE: Remove Dead Store:\n  DEAD: " << *Earlier
+                        << "\n  KILLER: " << *Killer << '\n');
+      if (Earlier->getParent() != Killer->getParent())
+        ++NumCrossBlockStores;
+      deleteDeadInstruction(Earlier);
+      ++NumFastStores;
+      MadeChange = true;
+    }
+    return MadeChange;
+  }
+
+  /// Remove \p I if it stores to an alloca which is never read again.
+  bool eliminateUnreadStore(Instruction *I) {
+    if (!isRemovableStore(I))
+      return false;
+    MemoryLocation Loc = getLocForWrite(I);
+    if (!Loc.Ptr || !isInvisibleToCaller(Loc))
+      return false;
+    auto *Def = cast<MemoryDef>(MSSA.getMemoryAccess(I));
+    if (!isUnreadBeforeOverwrite(Def, Loc, nullptr))
+      return false;
+
+    LLVM_DEBUG(dbgs() << "DSE: Remove Store Never Read:\n  DEAD: " << *I
+                      << '\n');
+    deleteDeadInstruction(I);
+    ++NumFastStores;
+    return true;
+  }
+
+  bool run() {
+    bool MadeChange = false;
+    // Visit the killing stores backwards, so the ones they kill are still
+    // around to be visited.
+    for (Instruction *I : reverse(Stores)) {
+      if (Deleted.count(I))
+        continue;
+      if (eliminateUnreadStore(I)) {
+        MadeChange = true;
+        continue;
+      }
+      MadeChange |= eliminateDeadStoresKilledBy(I);
+    }
+    return MadeChange;
+  }
+};
+
+} // end anonymous namespace
+
+static bool eliminateDeadStoresMemorySSA(Function &F, AliasAnalysis &AA,
+                                         MemorySSA &MSSA, DominatorTree &DT,
+                                         PostDominatorTree &PDT,
+                                         const TargetLibraryInfo &TLI) {
+  return DSEState(F, AA, MSSA, DT, PDT, TLI).run();
+}
+
 //===----------------------------------------------------------------------===//
 // DSE Pass
 //===----------------------------------------------------------------------===//
 PreservedAnalyses DSEPass::run(Function &F, FunctionAnalysisManager &AM) {
   AliasAnalysis *AA = &AM.getResult<AAManager>(F);
   DominatorTree *DT = &AM.getResult<DominatorTreeAnalysis>(F);
-  MemoryDependenceResults *MD = &AM.getResult<MemoryDependenceAnalysis>(F);
   const TargetLibraryInfo *TLI = &AM.getResult<TargetLibraryAnalysis>(F);
 
+  if (EnableMemorySSA) {
+    MemorySSA &MSSA = AM.getResult<MemorySSAAnalysis>(F).getMSSA();
+    PostDominatorTree &PDT = AM.getResult<PostDominatorTreeAnalysis>(F);
+
+    if (!eliminateDeadStoresMemorySSA(F, *AA, MSSA, *DT, PDT, *TLI))
+      return PreservedAnalyses::all();
+
+    PreservedAnalyses PA;
+    PA.preserveSet<CFGAnalyses>();
+    PA.preserve<GlobalsAA>();
+    PA.preserve<MemorySSAAnalysis>();
+    return PA;
+  }
+
+  MemoryDependenceResults *MD = &AM.getResult<MemoryDependenceAnalysis>(F);
+
   if (!eliminateDeadStores(F, AA, MD, DT, TLI))
     return PreservedAnalyses::all();
 
@@ -1358,11 +1673,20 @@ public:
 
     DominatorTree *DT = &getAnalysis<DominatorTreeWrapperPass>().getDomTree();
     AliasAnalysis *AA = &getAnalysis<AAResultsWrapperPass>().getAAResults();
-    MemoryDependenceResults *MD =
-        &getAnalysis<MemoryDependenceWrapperPass>().getMemDep();
     const TargetLibraryInfo *TLI =
         &getAnalysis<TargetLibraryInfoWrapperPass>().getTLI();
 
+    if (EnableMemorySSA) {
+      MemorySSA &MSSA = getAnalysis<MemorySSAWrapperPass>().getMSSA();
+      PostDominatorTree &PDT =
+          getAnalysis<PostDominatorTreeWrapperPass>().getPostDomTree();
+
+      return eliminateDeadStoresMemorySSA(F, *AA, MSSA, *DT, PDT, *TLI);
+    }
+
+    MemoryDependenceResults *MD =
+        &getAnalysis<MemoryDependenceWrapperPass>().getMemDep();
+
     return eliminateDeadStores(F, AA, MD, DT, TLI);
   }
 
@@ -1370,11 +1694,19 @@ public:
     AU.setPreservesCFG();
     AU.addRequired<DominatorTreeWrapperPass>();
     AU.addRequired<AAResultsWrapperPass>();
-    AU.addRequired<MemoryDependenceWrapperPass>();
     AU.addRequired<TargetLibraryInfoWrapperPass>();
     AU.addPreserved<DominatorTreeWrapperPass>();
     AU.addPreserved<GlobalsAAWrapperPass>();
-    AU.addPreserved<MemoryDependenceWrapperPass>();
+
+    if (EnableMemorySSA) {
+      AU.addRequired<PostDominatorTreeWrapperPass>();
+      AU.addRequired<MemorySSAWrapperPass>();
+      AU.addPreserved<PostDominatorTreeWrapperPass>();
+      AU.addPreserved<MemorySSAWrapperPass>();
+    } else {
+      AU.addRequired<MemoryDependenceWrapperPass>();
+      AU.addPreserved<MemoryDependenceWrapperPass>();
+    }
   }
 };
 
@@ -1388,6 +1720,8 @@ INITIALIZE_PASS_DEPENDENCY(DominatorTreeWrapperPass)
 INITIALIZE_PASS_DEPENDENCY(AAResultsWrapperPass)
 INITIALIZE_PASS_DEPENDENCY(GlobalsAAWrapperPass)
 INITIALIZE_PASS_DEPENDENCY(MemoryDependenceWrapperPass)
+INITIALIZE_PASS_DEPENDENCY(MemorySSAWrapperPass)
+INITIALIZE_PASS_DEPENDENCY(PostDominatorTreeWrapperPass)
 INITIALIZE_PASS_DEPENDENCY(TargetLibraryInfoWrapperPass)
 INITIALIZE_PASS_END(DSELegacyPass, "dse", "Dead Store Elimination", false,
                     false)
@@ -8,6 +8,13 @@
 //
 // This file implements a Loop Data Prefetching Pass.
 //
+// Without a profile, the pass prefetches the strided accesses of the inner
+// loops on the targets that set a prefetch distance. With a sample profile of
+// the cache misses of the loads (such as the one produced from the precise
+// load latency or cache miss events of the hardware), it only prefetches the
+// loads that the profile shows to miss, on any target, and it also prefetches
+// indirect accesses a[b[i]] by loading the index ahead of time.
+//
 //===----------------------------------------------------------------------===//
 
 #include "llvm/Transforms/Scalar/LoopDataPrefetch.h"
@@ -24,15 +31,19 @@
 #include "llvm/Analysis/ScalarEvolutionExpressions.h"
 #include "llvm/Analysis/TargetTransformInfo.h"
 #include "llvm/IR/CFG.h"
+#include "llvm/IR/DebugInfoMetadata.h"
 #include "llvm/IR/Dominators.h"
 #include "llvm/IR/Function.h"
+#include "llvm/IR/DiagnosticInfo.h"
 #include "llvm/IR/Module.h"
+#include "llvm/ProfileData/SampleProfReader.h"
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Transforms/Scalar.h"
 #include "llvm/Transforms/Utils/BasicBlockUtils.h"
 #include "llvm/Transforms/Utils/ValueMapper.h"
 using namespace llvm;
+using namespace sampleprof;
 
 // By default, we limit this to creating 16 PHIs (which is a little over half
 // of the allocatable register set).
@@ -53,17 +64,34 @@ static cl::opt<unsigned> MaxPrefetchIterationsAhead(
     "max-prefetch-iters-ahead",
     cl::desc("Max number of iterations to prefetch ahead"), cl::Hidden);
 
+cl::opt<std::string> PrefetchProfileFile(
+    "prefetch-profile-file", cl::init(""), cl::value_desc("filename"),
+    cl::desc("Sample profile of the cache misses of the loads, used to "
+             "prefetch the loads that miss"),
+    cl::Hidden);
+
+static cl::opt<unsigned> PrefetchProfileMinMisses(
+    "prefetch-profile-min-misses", cl::init(100), cl::Hidden,
+    cl::desc("Min number of cache miss samples of a load to prefetch it"));
+
+static cl::opt<unsigned> PrefetchProfileDistance(
+    "prefetch-profile-distance", cl::init(256), cl::Hidden,
+    cl::desc("Number of instructions to prefetch the profiled loads ahead "
+             "on targets that don't set a prefetch distance"));
+
 STATISTIC(NumPrefetches, "Number of prefetches inserted");
+STATISTIC(NumIndirectPrefetches, "Number of indirect prefetches inserted");
 
 namespace {
 
 /// Loop prefetch implementation class.
 class LoopDataPrefetch {
 public:
-  LoopDataPrefetch(AssumptionCache *AC, LoopInfo *LI, ScalarEvolution *SE,
-                   const TargetTransformInfo *TTI,
-                   OptimizationRemarkEmitter *ORE)
-      : AC(AC), LI(LI), SE(SE), TTI(TTI), ORE(ORE) {}
+  LoopDataPrefetch(AssumptionCache *AC, DominatorTree *DT, LoopInfo *LI,
+                   ScalarEvolution *SE, const TargetTransformInfo *TTI,
+                   OptimizationRemarkEmitter *ORE,
+                   const FunctionSamples *Samples)
+      : AC(AC), DT(DT), LI(LI), SE(SE), TTI(TTI), ORE(ORE), Samples(Samples) {}
 
   bool run();
 
@@ -74,6 +102,17 @@ private:
   /// warrant a prefetch.
   bool isStrideLargeEnough(const SCEVAddRecExpr *AR);
 
+  /// Returns the number of cache miss samples of \p I in the profile.
+  uint64_t getMissSamples(const Instruction *I);
+
+  /// Prefetches \p ItersAhead iterations ahead the indirect access a[b[i]]
+  /// of \p MemI in \p L, if \p PtrValue is one. Returns true on success.
+  bool prefetchIndirect(Loop *L, Instruction *MemI, Value *PtrValue,
+                        unsigned ItersAhead);
+
+  /// Inserts a prefetch of \p PrefPtrValue before \p MemI.
+  void insertPrefetch(Instruction *MemI, Value *PrefPtrValue);
+
   unsigned getMinPrefetchStride() {
     if (MinPrefetchStride.getNumOccurrences() > 0)
       return MinPrefetchStride;
@@ -83,6 +122,10 @@ private:
   unsigned getPrefetchDistance() {
     if (PrefetchDistance.getNumOccurrences() > 0)
       return PrefetchDistance;
+    // The loads that the profile shows to miss are worth prefetching even on
+    // the targets that don't prefetch by default.
+    if (!TTI->getPrefetchDistance() && Samples)
+      return PrefetchProfileDistance;
     return TTI->getPrefetchDistance();
   }
 
@@ -93,10 +136,14 @@ private:
   }
 
   AssumptionCache *AC;
+  DominatorTree *DT;
   LoopInfo *LI;
   ScalarEvolution *SE;
   const TargetTransformInfo *TTI;
   OptimizationRemarkEmitter *ORE;
+
+  /// The cache miss samples of the function, if there is a profile.
+  const FunctionSamples *Samples;
 };
 
 /// Legacy class for inserting loop data prefetches.
@@ -109,6 +156,7 @@ public:
 
   void getAnalysisUsage(AnalysisUsage &AU) const override {
     AU.addRequired<AssumptionCacheTracker>();
+    AU.addRequired<DominatorTreeWrapperPass>();
     AU.addPreserved<DominatorTreeWrapperPass>();
     AU.addRequired<LoopInfoWrapperPass>();
     AU.addPreserved<LoopInfoWrapperPass>();
@@ -118,14 +166,19 @@ public:
     AU.addRequired<TargetTransformInfoWrapperPass>();
   }
 
+  bool doInitialization(Module &M) override;
   bool runOnFunction(Function &F) override;
-  };
+
+private:
+  std::unique_ptr<SampleProfileReader> MissProfile;
+};
 }
 
 char LoopDataPrefetchLegacyPass::ID = 0;
 INITIALIZE_PASS_BEGIN(LoopDataPrefetchLegacyPass, "loop-data-prefetch",
                       "Loop Data Prefetch", false, false)
 INITIALIZE_PASS_DEPENDENCY(AssumptionCacheTracker)
+INITIALIZE_PASS_DEPENDENCY(DominatorTreeWrapperPass)
 INITIALIZE_PASS_DEPENDENCY(TargetTransformInfoWrapperPass)
 INITIALIZE_PASS_DEPENDENCY(LoopInfoWrapperPass)
 INITIALIZE_PASS_DEPENDENCY(OptimizationRemarkEmitterWrapperPass)
@@ -153,8 +206,49 @@ bool LoopDataPrefetch::isStrideLargeEnough(const SCEVAddRecExpr *AR) {
   return TargetMinStride <= AbsStride;
 }
 
+/// Reads the profile of the cache misses in \p Filename for the functions of
+/// \p M. Returns null, after diagnosing it, if the profile can't be read.
+static std::unique_ptr<SampleProfileReader>
+readMissProfile(const std::string &Filename, Module &M) {
+  LLVMContext &Ctx = M.getContext();
+  auto ReaderOrErr = SampleProfileReader::create(Filename, Ctx);
+  if (std::error_code EC = ReaderOrErr.getError()) {
+    std::string Msg = "Could not open profile: " + EC.message();
+    Ctx.diagnose(DiagnosticInfoSampleProfile(Filename, Msg));
+    return nullptr;
+  }
+  std::unique_ptr<SampleProfileReader> Reader = std::move(ReaderOrErr.get());
+  Reader->collectFuncsToUse(M);
+  if (Reader->read() != sampleprof_error::success)
+    return nullptr;
+  return Reader;
+}
+
+/// Returns the samples of \p F in the profile read by \p Reader, if any.
+static const FunctionSamples *getMissSamplesFor(SampleProfileReader *Reader,
+                                                const Function &F) {
+  if (!Reader)
+    return nullptr;
+  FunctionSamples::Format = Reader->getFormat();
+  return Reader->getSamplesFor(F);
+}
+
+LoopDataPrefetchPass::LoopDataPrefetchPass(std::string MissProfileFile)
+    : MissProfileFile(MissProfileFile.empty() ? PrefetchProfileFile
+                                              : MissProfileFile) {}
+
+LoopDataPrefetchPass::LoopDataPrefetchPass(LoopDataPrefetchPass &&) = default;
+
+LoopDataPrefetchPass::~LoopDataPrefetchPass() = default;
+
 PreservedAnalyses LoopDataPrefetchPass::run(Function &F,
                                             FunctionAnalysisManager &AM) {
+  if (!MissProfileFile.empty() && MissProfileContext != &F.getContext()) {
+    MissProfile = readMissProfile(MissProfileFile, *F.getParent());
+    MissProfileContext = &F.getContext();
+  }
+
+  DominatorTree *DT = &AM.getResult<DominatorTreeAnalysis>(F);
   LoopInfo *LI = &AM.getResult<LoopAnalysis>(F);
   ScalarEvolution *SE = &AM.getResult<ScalarEvolutionAnalysis>(F);
   AssumptionCache *AC = &AM.getResult<AssumptionAnalysis>(F);
@@ -162,7 +256,8 @@ PreservedAnalyses LoopDataPrefetchPass::run(Function &F,
       &AM.getResult<OptimizationRemarkEmitterAnalysis>(F);
   const TargetTransformInfo *TTI = &AM.getResult<TargetIRAnalysis>(F);
 
-  LoopDataPrefetch LDP(AC, LI, SE, TTI, ORE);
+  LoopDataPrefetch LDP(AC, DT, LI, SE, TTI, ORE,
+                       getMissSamplesFor(MissProfile.get(), F));
   bool Changed = LDP.run();
 
   if (Changed) {
@@ -175,10 +270,17 @@ PreservedAnalyses LoopDataPrefetchPass::run(Function &F,
   return PreservedAnalyses::all();
 }
 
+bool LoopDataPrefetchLegacyPass::doInitialization(Module &M) {
+  if (!PrefetchProfileFile.empty())
+    MissProfile = readMissProfile(PrefetchProfileFile, M);
+  return false;
+}
+
 bool LoopDataPrefetchLegacyPass::runOnFunction(Function &F) {
   if (skipFunction(F))
     return false;
 
+  DominatorTree *DT = &getAnalysis<DominatorTreeWrapperPass>().getDomTree();
   LoopInfo *LI = &getAnalysis<LoopInfoWrapperPass>().getLoopInfo();
   ScalarEvolution *SE = &getAnalysis<ScalarEvolutionWrapperPass>().getSE();
   AssumptionCache *AC =
@@ -188,17 +290,20 @@ bool LoopDataPrefetchLegacyPass::runOnFunction(Function &F) {
   const TargetTransformInfo *TTI =
       &getAnalysis<TargetTransformInfoWrapperPass>().getTTI(F);
 
-  LoopDataPrefetch LDP(AC, LI, SE, TTI, ORE);
+  LoopDataPrefetch LDP(AC, DT, LI, SE, TTI, ORE,
+                       getMissSamplesFor(MissProfile.get(), F));
   return LDP.run();
 }
 
 bool LoopDataPrefetch::run() {
   // If PrefetchDistance is not set, don't run the pass.  This gives an
   // opportunity for targets to run this pass for selected subtargets only
-  // (whose TTI sets PrefetchDistance).
+  // (whose TTI sets PrefetchDistance), or for the functions that have a
+  // profile of their cache misses.
   if (getPrefetchDistance() == 0)
     return false;
-  assert(TTI->getCacheLineSize() && "Cache line size is not set for target");
+  assert((Samples || TTI->getCacheLineSize()) &&
+         "Cache line size is not set for target");
 
   bool MadeChange = false;
 
@@ -269,14 +374,22 @@ bool LoopDataPrefetch::runOnLoop(Loop *L) {
       if (L->isLoopInvariant(PtrValue))
         continue;
 
+      // With a profile, only the accesses that are known to miss the cache
+      // are prefetched, whatever their stride.
+      if (Samples && getMissSamples(MemI) < PrefetchProfileMinMisses)
+        continue;
+
       const SCEV *LSCEV = SE->getSCEV(PtrValue);
       const SCEVAddRecExpr *LSCEVAddRec = dyn_cast<SCEVAddRecExpr>(LSCEV);
-      if (!LSCEVAddRec)
+      if (!LSCEVAddRec) {
+        if (Samples && prefetchIndirect(L, MemI, PtrValue, ItersAhead))
+          MadeChange = true;
         continue;
+      }
 
       // Check if the stride of the accesses is large enough to warrant a
       // prefetch.
-      if (!isStrideLargeEnough(LSCEVAddRec))
+      if (!Samples && !isStrideLargeEnough(LSCEVAddRec))
         continue;
 
       // We don't want to double prefetch individual cache lines. If this load
@@ -308,18 +421,7 @@ bool LoopDataPrefetch::runOnLoop(Loop *L) {
       Type *I8Ptr = Type::getInt8PtrTy(BB->getContext(), PtrAddrSpace);
       SCEVExpander SCEVE(*SE, I.getModule()->getDataLayout(), "prefaddr");
       Value *PrefPtrValue = SCEVE.expandCodeFor(NextLSCEV, I8Ptr, MemI);
-
-      IRBuilder<> Builder(MemI);
-      Module *M = BB->getParent()->getParent();
-      Type *I32 = Type::getInt32Ty(BB->getContext());
-      Function *PrefetchFunc =
-          Intrinsic::getDeclaration(M, Intrinsic::prefetch);
-      Builder.CreateCall(
-          PrefetchFunc,
-          {PrefPtrValue,
-           ConstantInt::get(I32, MemI->mayReadFromMemory() ? 0 : 1),
-           ConstantInt::get(I32, 3), ConstantInt::get(I32, 1)});
-      ++NumPrefetches;
+      insertPrefetch(MemI, PrefPtrValue);
       LLVM_DEBUG(dbgs() << "  Access: " << *PtrValue << ", SCEV: " << *LSCEV
                         << "\n");
       ORE->emit([&]() {
@@ -333,3 +435,116 @@ bool LoopDataPrefetch::runOnLoop(Loop *L) {
 
   return MadeChange;
 }
+
+uint64_t LoopDataPrefetch::getMissSamples(const Instruction *I) {
+  const DILocation *DIL = I->getDebugLoc();
+  if (!DIL)
+    return 0;
+  const FunctionSamples *FS = Samples->findFunctionSamples(DIL);
+  if (!FS)
+    return 0;
+  ErrorOr<uint64_t> R = FS->findSamplesAt(FunctionSamples::getOffset(DIL),
+                                          DIL->getBaseDiscriminator());
+  return R ? R.get() : 0;
+}
+
+bool LoopDataPrefetch::prefetchIndirect(Loop *L, Instruction *MemI,
+                                        Value *PtrValue, unsigned ItersAhead) {
+  // Look for a[b[i]]: an address computed from a loop invariant base and the
+  // value of a load, possibly extended, from an affine address.
+  auto *GEP = dyn_cast<GetElementPtrInst>(PtrValue);
+  if (!GEP || !L->isLoopInvariant(GEP->getPointerOperand()))
+    return false;
+  unsigned IdxOperand = 0;
+  for (unsigned I = 1, E = GEP->getNumOperands(); I != E; ++I) {
+    if (L->isLoopInvariant(GEP->getOperand(I)))
+      continue;
+    if (IdxOperand)
+      return false;
+    IdxOperand = I;
+  }
+  if (!IdxOperand)
+    return false;
+
+  Value *Idx = GEP->getOperand(IdxOperand);
+  auto *IdxCast = dyn_cast<CastInst>(Idx);
+  if (IdxCast)
+    Idx = IdxCast->getOperand(0);
+  auto *IdxLoad = dyn_cast<LoadInst>(Idx);
+  if (!IdxLoad || !IdxLoad->isSimple() || !L->contains(IdxLoad))
+    return false;
+  const auto *IdxAddRec =
+      dyn_cast<SCEVAddRecExpr>(SE->getSCEV(IdxLoad->getPointerOperand()));
+  if (!IdxAddRec || IdxAddRec->getLoop() != L || !IdxAddRec->isAffine())
+    return false;
+
+  // The index is loaded ahead of time, and that load must not fault: it is
+  // clamped to the last index that the loop loads. This requires the index to
+  // be loaded in all the iterations, and the number of iterations.
+  BasicBlock *Latch = L->getLoopLatch();
+  if (!Latch || L->getExitingBlock() != Latch ||
+      !DT->dominates(IdxLoad->getParent(), Latch))
+    return false;
+  const SCEV *BECount = SE->getBackedgeTakenCount(L);
+  if (isa<SCEVCouldNotCompute>(BECount))
+    return false;
+
+  const SCEV *Step = IdxAddRec->getStepRecurrence(*SE);
+  const SCEV *NextIdxPtr = SE->getAddExpr(
+      IdxAddRec,
+      SE->getMulExpr(SE->getConstant(Step->getType(), ItersAhead), Step));
+  const SCEV *LastIdxPtr = SE->getAddExpr(
+      IdxAddRec->getStart(),
+      SE->getMulExpr(SE->getTruncateOrZeroExtend(BECount, Step->getType()),
+                     Step));
+  if (SE->isKnownPositive(Step))
+    NextIdxPtr = SE->getUMinExpr(NextIdxPtr, LastIdxPtr);
+  else if (SE->isKnownNegative(Step))
+    NextIdxPtr = SE->getUMaxExpr(NextIdxPtr, LastIdxPtr);
+  else
+    return false;
+  if (!isSafeToExpand(NextIdxPtr, *SE))
+    return false;
+
+  SCEVExpander SCEVE(*SE, MemI->getModule()->getDataLayout(), "prefidx");
+  Value *NextIdxPtrValue = SCEVE.expandCodeFor(
+      NextIdxPtr, IdxLoad->getPointerOperand()->getType(), MemI);
+
+  IRBuilder<> Builder(MemI);
+  LoadInst *NextIdx = Builder.CreateAlignedLoad(
+      IdxLoad->getType(), NextIdxPtrValue, IdxLoad->getAlignment(), "prefidx");
+  Value *NextIdxValue = NextIdx;
+  if (IdxCast)
+    NextIdxValue =
+        Builder.CreateCast(IdxCast->getOpcode(), NextIdx, IdxCast->getType());
+  SmallVector<Value *, 4> Indices(GEP->idx_begin(), GEP->idx_end());
+  Indices[IdxOperand - 1] = NextIdxValue;
+  // The element a[b[i + ItersAhead]] may be out of the bounds of a: the
+  // address is only used by the prefetch, so it isn't inbounds.
+  Value *PrefPtrValue = Builder.CreateGEP(
+      GEP->getSourceElementType(), GEP->getPointerOperand(), Indices);
+  PrefPtrValue = Builder.CreatePointerCast(
+      PrefPtrValue, Type::getInt8PtrTy(MemI->getContext()), "prefaddr");
+  insertPrefetch(MemI, PrefPtrValue);
+  ++NumIndirectPrefetches;
+
+  LLVM_DEBUG(dbgs() << "  Indirect access: " << *PtrValue << ", index: "
+                    << *IdxLoad << "\n");
+  ORE->emit([&]() {
+    return OptimizationRemark(DEBUG_TYPE, "Prefetched", MemI)
+           << "prefetched indirect memory access";
+  });
+  return true;
+}
+
+void LoopDataPrefetch::insertPrefetch(Instruction *MemI, Value *PrefPtrValue) {
+  IRBuilder<> Builder(MemI);
+  Module *M = MemI->getModule();
+  Type *I32 = Type::getInt32Ty(MemI->getContext());
+  Function *PrefetchFunc = Intrinsic::getDeclaration(M, Intrinsic::prefetch);
+  Builder.CreateCall(
+      PrefetchFunc,
+      {PrefPtrValue, ConstantInt::get(I32, MemI->mayReadFromMemory() ? 0 : 1),
+       ConstantInt::get(I32, 3), ConstantInt::get(I32, 1)});
+  ++NumPrefetches;
+}
@@ -0,0 +1,510 @@
+//===- LoopTiling.cpp - Loop Tiling Pass ----------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// This pass tiles the inner loop of simple perfect loop nests of depth two:
+//
+//   for (i = 0; i < N; ++i)         for (jj = 0; jj < M; jj += T)
+//     for (j = 0; j < M; ++j)   =>    for (i = 0; i < N; ++i)
+//       Body(i, j);                     for (j = jj; j < min(jj + T, M); ++j)
+//                                         Body(i, j);
+//
+// This strip-mines the inner loop and interchanges the loop over the strips
+// with the outer loop. When the inner loop reads data that does not depend on
+// the outer loop, e.g. B[j] in C[i] += A[i][j] * B[j], the data of one strip
+// is then reused by all the iterations of the outer loop while it is still in
+// the cache. The tile size T is chosen from the size of the first level data
+// cache reported by TargetTransformInfo.
+//
+// The pass is meant to be cheap: it only considers nests whose inner loop is
+// innermost, has a single induction variable with a trip count that does not
+// depend on the outer loop, and whose memory accesses are all simple loads and
+// stores in the inner loop. The legality of the interchange is checked with
+// DependenceAnalysis, with a bounded number of queries.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/Transforms/Scalar/LoopTiling.h"
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/Analysis/DependenceAnalysis.h"
+#include "llvm/Analysis/GlobalsModRef.h"
+#include "llvm/Analysis/LoopInfo.h"
+#include "llvm/Analysis/OptimizationRemarkEmitter.h"
+#include "llvm/Analysis/ScalarEvolution.h"
+#include "llvm/Analysis/ScalarEvolutionExpander.h"
+#include "llvm/Analysis/ScalarEvolutionExpressions.h"
+#include "llvm/Analysis/TargetTransformInfo.h"
+#include "llvm/IR/BasicBlock.h"
+#include "llvm/IR/Dominators.h"
+#include "llvm/IR/Function.h"
+#include "llvm/IR/IRBuilder.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/Pass.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/MathExtras.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/Transforms/Scalar.h"
+#include "llvm/Transforms/Utils/Local.h"
+#include "llvm/Transforms/Utils/LoopUtils.h"
+
+using namespace llvm;
+
+#define DEBUG_TYPE "loop-tiling"
+
+STATISTIC(NumTiled, "Number of loop nests tiled");
+
+static cl::opt<unsigned> TileSizeOpt(
+    "loop-tiling-tile-size", cl::init(0), cl::Hidden,
+    cl::desc("Use this tile size instead of the one computed from the size "
+             "of the data cache"));
+
+static cl::opt<unsigned> CacheSizeOpt(
+    "loop-tiling-cache-size", cl::init(0), cl::Hidden,
+    cl::desc("Size in bytes of the data cache to tile for, overriding the "
+             "one reported by the target"));
+
+static cl::opt<unsigned> MaxMemAccesses(
+    "loop-tiling-max-accesses", cl::init(32), cl::Hidden,
+    cl::desc("Maximal number of memory accesses in the inner loop of a nest "
+             "for the nest to be considered for tiling"));
+
+/// The loop attribute set on the tiled loop, so that it is not tiled again.
+static const char *const LLVMLoopTilingDisable = "llvm.loop.tiling.disable";
+
+/// The smallest tile worth the overhead of the additional loop.
+static const unsigned MinTileSize = 8;
+
+namespace {
+
+/// Tiles the inner loop of a perfect loop nest of depth two.
+class LoopTiling {
+  Loop &Outer;
+  Loop &Inner;
+  LoopInfo &LI;
+  DominatorTree &DT;
+  ScalarEvolution &SE;
+  DependenceInfo &DI;
+  const TargetTransformInfo &TTI;
+  OptimizationRemarkEmitter &ORE;
+
+  /// The induction variable of the inner loop, its value on the next
+  /// iteration, and the backedge taken count of the inner loop.
+  PHINode *InnerIV = nullptr;
+  Value *InnerIVNext = nullptr;
+  const SCEV *InnerBTC = nullptr;
+
+  /// The loads and stores of the nest, all in the inner loop.
+  SmallVector<Instruction *, 16> MemInsts;
+
+public:
+  LoopTiling(Loop &Outer, LoopInfo &LI, DominatorTree &DT, ScalarEvolution &SE,
+             DependenceInfo &DI, const TargetTransformInfo &TTI,
+             OptimizationRemarkEmitter &ORE)
+      : Outer(Outer), Inner(*Outer.getSubLoops().front()), LI(LI), DT(DT),
+        SE(SE), DI(DI), TTI(TTI), ORE(ORE) {}
+
+  /// Tiles the nest with \p TileSize, or with a tile size computed from the
+  /// size of the data cache if it is zero. Returns true if the nest was tiled.
+  bool run(unsigned TileSize);
+
+private:
+  bool isSupportedNest();
+  bool isLegal();
+  unsigned getProfitableTileSize();
+  void tile(unsigned TileSize);
+};
+
+} // end anonymous namespace
+
+/// Returns true if all the users of the instructions of \p L are in \p L.
+static bool hasNoLiveOuts(const Loop &L) {
+  for (const BasicBlock *BB : L.blocks())
+    for (const Instruction &I : *BB)
+      for (const User *U : I.users())
+        if (!L.contains(cast<Instruction>(U)->getParent()))
+          return false;
+  return true;
+}
+
+bool LoopTiling::isSupportedNest() {
+  if (!Inner.empty() || !Outer.isLoopSimplifyForm() ||
+      !Inner.isLoopSimplifyForm())
+    return false;
+  if (Outer.getExitingBlock() != Outer.getLoopLatch() ||
+      Inner.getExitingBlock() != Inner.getLoopLatch() || !Outer.getExitBlock())
+    return false;
+  // Tiling runs the outer loop once per tile, and splits the iterations of
+  // the inner loop between the tiles: neither may compute values used after
+  // it.
+  if (!hasNoLiveOuts(Outer) || !hasNoLiveOuts(Inner))
+    return false;
+
+  // The inner loop may only carry its induction variable. Other recurrences
+  // would have to be rewritten for the start of each tile.
+  BasicBlock *InnerHeader = Inner.getHeader();
+  if (!isa<PHINode>(InnerHeader->front()) ||
+      std::next(InnerHeader->phis().begin()) != InnerHeader->phis().end())
+    return false;
+  InnerIV = &*InnerHeader->phis().begin();
+  if (!InnerIV->getType()->isIntegerTy() ||
+      !Outer.isLoopInvariant(
+          InnerIV->getIncomingValueForBlock(Inner.getLoopPreheader())))
+    return false;
+  const auto *AR = dyn_cast<SCEVAddRecExpr>(SE.getSCEV(InnerIV));
+  if (!AR || AR->getLoop() != &Inner || !AR->isAffine() ||
+      !AR->getStepRecurrence(SE)->isOne())
+    return false;
+  InnerIVNext = InnerIV->getIncomingValueForBlock(Inner.getLoopLatch());
+  if (SE.getSCEV(InnerIVNext) != AR->getPostIncExpr(SE))
+    return false;
+
+  // The iterations of the inner loop must be the same for all the iterations
+  // of the outer loop, and must not cover the whole range of the induction
+  // variable, so that the end of the last tile can be represented.
+  InnerBTC = SE.getBackedgeTakenCount(&Inner);
+  if (isa<SCEVCouldNotCompute>(InnerBTC) ||
+      InnerBTC->getType() != InnerIV->getType() ||
+      !SE.isLoopInvariant(InnerBTC, &Outer) ||
+      SE.getUnsignedRangeMax(InnerBTC).isMaxValue())
+    return false;
+  if (!isSafeToExpandAt(InnerBTC, Outer.getLoopPreheader()->getTerminator(),
+                        SE))
+    return false;
+
+  for (BasicBlock *BB : Outer.blocks()) {
+    bool InInner = Inner.contains(BB);
+    for (Instruction &I : *BB) {
+      // The part of the outer loop out of the inner loop is run again for
+      // each tile: it may only compute values.
+      if (!InInner) {
+        if (I.mayReadOrWriteMemory() || I.mayHaveSideEffects())
+          return false;
+        if (isa<PHINode>(I) && BB != Outer.getHeader())
+          return false;
+        continue;
+      }
+      if (!I.mayReadOrWriteMemory())
+        continue;
+      auto *LD = dyn_cast<LoadInst>(&I);
+      auto *ST = dyn_cast<StoreInst>(&I);
+      if ((!LD || !LD->isSimple()) && (!ST || !ST->isSimple()))
+        return false;
+      if (MemInsts.size() == MaxMemAccesses) {
+        LLVM_DEBUG(dbgs() << "LoopTiling: too many memory accesses\n");
+        return false;
+      }
+      MemInsts.push_back(&I);
+    }
+  }
+  return !MemInsts.empty();
+}
+
+bool LoopTiling::isLegal() {
+  unsigned OuterLevel = Outer.getLoopDepth();
+  unsigned InnerLevel = Inner.getLoopDepth();
+  for (unsigned I = 0, E = MemInsts.size(); I != E; ++I) {
+    for (unsigned J = I; J != E; ++J) {
+      Instruction *Src = MemInsts[I], *Dst = MemInsts[J];
+      if (!isa<StoreInst>(Src) && !isa<StoreInst>(Dst))
+        continue;
+      std::unique_ptr<Dependence> D = DI.depends(Src, Dst, true);
+      if (!D)
+        continue;
+      if (D->isConfused() || D->getLevels() < InnerLevel) {
+        LLVM_DEBUG(dbgs() << "LoopTiling: unknown dependence between " << *Src
+                          << " and " << *Dst << "\n");
+        return false;
+      }
+      // After tiling, iteration (i1, j1) runs before (i2, j2) if the tile of j1
+      // comes first, or in the same tile, if i1 < i2. The order of a
+      // dependence between two iterations with i1 < i2 and j1 > j2 is reversed
+      // when j1 and j2 are in different tiles.
+      unsigned OuterDir = D->getDirection(OuterLevel);
+      unsigned InnerDir = D->getDirection(InnerLevel);
+      if (((OuterDir & Dependence::DVEntry::LT) &&
+           (InnerDir & Dependence::DVEntry::GT)) ||
+          ((OuterDir & Dependence::DVEntry::GT) &&
+           (InnerDir & Dependence::DVEntry::LT))) {
+        LLVM_DEBUG(dbgs() << "LoopTiling: dependence between " << *Src
+                          << " and " << *Dst << " prevents tiling\n");
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+unsigned LoopTiling::getProfitableTileSize() {
+  Optional<unsigned> CacheSize =
+      TTI.getCacheSize(TargetTransformInfo::CacheLevel::L1D);
+  if (CacheSizeOpt.getNumOccurrences())
+    CacheSize = (unsigned)CacheSizeOpt;
+  if (!CacheSize || !*CacheSize)
+    return 0;
+  uint64_t LineSize = TTI.getCacheLineSize();
+  if (!LineSize)
+    LineSize = 64;
+
+  // Estimate the bytes brought into the cache by each iteration of the inner
+  // loop, and look for data that is reused by the iterations of the outer
+  // loop: the accesses that only vary with the inner loop.
+  uint64_t BytesPerIteration = 0;
+  bool HasOuterReuse = false;
+  SmallPtrSet<const SCEV *, 16> Seen;
+  for (Instruction *I : MemInsts) {
+    const SCEV *Ptr = SE.getSCEV(getLoadStorePointerOperand(I));
+    if (!Seen.insert(Ptr).second || SE.isLoopInvariant(Ptr, &Inner))
+      continue;
+    const auto *AR = dyn_cast<SCEVAddRecExpr>(Ptr);
+    const auto *Step =
+        AR && AR->getLoop() == &Inner && AR->isAffine()
+            ? dyn_cast<SCEVConstant>(AR->getStepRecurrence(SE))
+            : nullptr;
+    if (!Step) {
+      BytesPerIteration += LineSize;
+      continue;
+    }
+    BytesPerIteration +=
+        std::min(Step->getAPInt().abs().getLimitedValue(), LineSize);
+    if (SE.isLoopInvariant(AR->getStart(), &Outer))
+      HasOuterReuse = true;
+  }
+  if (!HasOuterReuse || !BytesPerIteration)
+    return 0;
+
+  // Leave half of the cache to the data that is not reused.
+  uint64_t TileSize = PowerOf2Floor(*CacheSize / 2 / BytesPerIteration);
+  unsigned MaxTripCount = SE.getSmallConstantMaxTripCount(&Inner);
+  if (MaxTripCount && MaxTripCount <= TileSize) {
+    LLVM_DEBUG(dbgs() << "LoopTiling: the inner loop fits in the cache\n");
+    return 0;
+  }
+  return TileSize < MinTileSize ? 0 : TileSize;
+}
+
+void LoopTiling::tile(unsigned TileSize) {
+  BasicBlock *Preheader = Outer.getLoopPreheader();
+  BasicBlock *OuterHeader = Outer.getHeader();
+  BasicBlock *OuterLatch = Outer.getLoopLatch();
+  BasicBlock *Exit = Outer.getExitBlock();
+  BasicBlock *InnerLatch = Inner.getLoopLatch();
+  Function *F = OuterHeader->getParent();
+  LLVMContext &Ctx = F->getContext();
+  Type *IVTy = InnerIV->getType();
+  Value *Start = InnerIV->getIncomingValueForBlock(Inner.getLoopPreheader());
+
+  // The end of the iterations of the inner loop, computed before the nest.
+  SCEVExpander Expander(SE, F->getParent()->getDataLayout(), "tile");
+  const SCEV *EndSCEV = SE.getAddExpr(
+      SE.getSCEV(Start), SE.getAddExpr(InnerBTC, SE.getOne(IVTy)));
+  Value *End =
+      Expander.expandCodeFor(EndSCEV, IVTy, Preheader->getTerminator());
+  SE.forgetLoop(&Outer);
+
+  // tile.header:
+  //   %tile.iv = phi [ %start, %preheader ], [ %tile.iv.next, %tile.latch ]
+  //   %tile.end = %tile.iv + umin(%end - %tile.iv, TileSize)
+  //   br %outer.header
+  BasicBlock *TileHeader =
+      BasicBlock::Create(Ctx, "tile.header", F, OuterHeader);
+  IRBuilder<> Builder(TileHeader);
+  PHINode *TileIV = Builder.CreatePHI(IVTy, 2, "tile.iv");
+  Value *Remaining = Builder.CreateSub(End, TileIV, "tile.remaining");
+  Value *TileSizeV = ConstantInt::get(IVTy, TileSize);
+  Value *IsLastTile = Builder.CreateICmpULT(Remaining, TileSizeV);
+  Value *TileEnd = Builder.CreateAdd(
+      TileIV, Builder.CreateSelect(IsLastTile, Remaining, TileSizeV),
+      "tile.end");
+  Builder.CreateBr(OuterHeader);
+
+  Preheader->getTerminator()->replaceUsesOfWith(OuterHeader, TileHeader);
+  for (PHINode &PN : OuterHeader->phis())
+    PN.setIncomingBlock(PN.getBasicBlockIndex(Preheader), TileHeader);
+
+  // tile.latch:
+  //   %tile.iv.next = %tile.iv + TileSize
+  //   br (%end - %tile.iv > TileSize), %tile.header, %exit
+  BasicBlock *TileLatch = BasicBlock::Create(Ctx, "tile.latch", F, Exit);
+  Builder.SetInsertPoint(TileLatch);
+  Value *TileIVNext = Builder.CreateAdd(TileIV, TileSizeV, "tile.iv.next");
+  Value *HasNextTile =
+      Builder.CreateICmpUGT(Remaining, TileSizeV, "tile.has.next");
+  Builder.CreateCondBr(HasNextTile, TileHeader, Exit);
+  TileIV->addIncoming(Start, Preheader);
+  TileIV->addIncoming(TileIVNext, TileLatch);
+
+  OuterLatch->getTerminator()->replaceUsesOfWith(Exit, TileLatch);
+  for (PHINode &PN : Exit->phis())
+    PN.setIncomingBlock(PN.getBasicBlockIndex(OuterLatch), TileLatch);
+
+  // The inner loop runs from the start to the end of the tile.
+  InnerIV->setIncomingValue(
+      InnerIV->getBasicBlockIndex(Inner.getLoopPreheader()), TileIV);
+  auto *BI = cast<BranchInst>(InnerLatch->getTerminator());
+  Value *OldCond = BI->getCondition();
+  Builder.SetInsertPoint(BI);
+  bool ExitOnTrue = !Inner.contains(BI->getSuccessor(0));
+  BI->setCondition(Builder.CreateICmp(
+      ExitOnTrue ? ICmpInst::ICMP_EQ : ICmpInst::ICMP_NE, InnerIVNext,
+      TileEnd, "tile.cond"));
+  RecursivelyDeleteTriviallyDeadInstructions(OldCond);
+
+  DT.applyUpdates({{DominatorTree::Insert, Preheader, TileHeader},
+                   {DominatorTree::Insert, TileHeader, OuterHeader},
+                   {DominatorTree::Delete, Preheader, OuterHeader},
+                   {DominatorTree::Insert, OuterLatch, TileLatch},
+                   {DominatorTree::Insert, TileLatch, TileHeader},
+                   {DominatorTree::Insert, TileLatch, Exit},
+                   {DominatorTree::Delete, OuterLatch, Exit}});
+
+  // The loop over the tiles becomes the parent of the outer loop.
+  Loop *TileLoop = LI.AllocateLoop();
+  if (Loop *Parent = Outer.getParentLoop())
+    Parent->replaceChildLoopWith(&Outer, TileLoop);
+  else
+    LI.changeTopLevelLoop(&Outer, TileLoop);
+  TileLoop->addChildLoop(&Outer);
+  TileLoop->addBasicBlockToLoop(TileHeader, LI);
+  for (BasicBlock *BB : Outer.blocks())
+    TileLoop->addBlockEntry(BB);
+  TileLoop->addBasicBlockToLoop(TileLatch, LI);
+
+  addStringMetadataToLoop(&Outer, LLVMLoopTilingDisable, 1);
+}
+
+bool LoopTiling::run(unsigned TileSize) {
+  if (hasDisableAllTransformsHint(&Outer) ||
+      findStringMetadataForLoop(&Outer, LLVMLoopTilingDisable))
+    return false;
+
+  LLVM_DEBUG(dbgs() << "LoopTiling: considering the nest of "
+                    << Outer.getHeader()->getName() << " in "
+                    << Outer.getHeader()->getParent()->getName() << "\n");
+  if (!isSupportedNest()) {
+    LLVM_DEBUG(dbgs() << "LoopTiling: unsupported loop nest\n");
+    return false;
+  }
+  if (!TileSize)
+    TileSize = getProfitableTileSize();
+  if (!TileSize) {
+    LLVM_DEBUG(dbgs() << "LoopTiling: tiling is not profitable\n");
+    return false;
+  }
+  if (!isLegal())
+    return false;
+
+  LLVM_DEBUG(dbgs() << "LoopTiling: tiling with tile size " << TileSize
+                    << "\n");
+  tile(TileSize);
+  ++NumTiled;
+  ORE.emit([&]() {
+    return OptimizationRemark(DEBUG_TYPE, "Tiled", Inner.getStartLoc(),
+                              Inner.getHeader())
+           << "tiled the inner loop of the nest with tile size "
+           << ore::NV("TileSize", TileSize);
+  });
+  return true;
+}
+
+static bool tileLoops(Function &F, LoopInfo &LI, DominatorTree &DT,
+                      ScalarEvolution &SE, DependenceInfo &DI,
+                      const TargetTransformInfo &TTI,
+                      OptimizationRemarkEmitter &ORE, unsigned TileSize) {
+  if (TileSizeOpt.getNumOccurrences())
+    TileSize = TileSizeOpt;
+
+  // Collect the nests first: tiling adds loops.
+  SmallVector<Loop *, 8> Nests;
+  for (Loop *L : LI.getLoopsInPreorder())
+    if (L->getSubLoops().size() == 1 && L->getSubLoops().front()->empty())
+      Nests.push_back(L);
+
+  bool Changed = false;
+  for (Loop *L : Nests)
+    Changed |= LoopTiling(*L, LI, DT, SE, DI, TTI, ORE).run(TileSize);
+  return Changed;
+}
+
+namespace {
+
+class LoopTilingLegacyPass : public FunctionPass {
+public:
+  static char ID;
+
+  LoopTilingLegacyPass() : FunctionPass(ID) {
+    initializeLoopTilingLegacyPassPass(*PassRegistry::getPassRegistry());
+  }
+
+  bool runOnFunction(Function &F) override {
+    if (skipFunction(F))
+      return false;
+
+    auto &LI = getAnalysis<LoopInfoWrapperPass>().getLoopInfo();
+    auto &DT = getAnalysis<DominatorTreeWrapperPass>().getDomTree();
+    auto &SE = getAnalysis<ScalarEvolutionWrapperPass>().getSE();
+    auto &DI = getAnalysis<DependenceAnalysisWrapperPass>().getDI();
+    auto &TTI = getAnalysis<TargetTransformInfoWrapperPass>().getTTI(F);
+    auto &ORE = getAnalysis<OptimizationRemarkEmitterWrapperPass>().getORE();
+
+    return tileLoops(F, LI, DT, SE, DI, TTI, ORE, /*TileSize=*/0);
+  }
+
+  void getAnalysisUsage(AnalysisUsage &AU) const override {
+    AU.addRequired<LoopInfoWrapperPass>();
+    AU.addPreserved<LoopInfoWrapperPass>();
+    AU.addRequired<DominatorTreeWrapperPass>();
+    AU.addPreserved<DominatorTreeWrapperPass>();
+    AU.addRequired<ScalarEvolutionWrapperPass>();
+    AU.addPreserved<ScalarEvolutionWrapperPass>();
+    AU.addRequired<DependenceAnalysisWrapperPass>();
+    AU.addRequired<TargetTransformInfoWrapperPass>();
+    AU.addRequired<OptimizationRemarkEmitterWrapperPass>();
+    AU.addPreserved<GlobalsAAWrapperPass>();
+  }
+};
+
+} // end anonymous namespace
+
+char LoopTilingLegacyPass::ID = 0;
+
+INITIALIZE_PASS_BEGIN(LoopTilingLegacyPass, "loop-tiling", "Loop Tiling",
+                      false, false)
+INITIALIZE_PASS_DEPENDENCY(LoopInfoWrapperPass)
+INITIALIZE_PASS_DEPENDENCY(DominatorTreeWrapperPass)
+INITIALIZE_PASS_DEPENDENCY(ScalarEvolutionWrapperPass)
+INITIALIZE_PASS_DEPENDENCY(DependenceAnalysisWrapperPass)
+INITIALIZE_PASS_DEPENDENCY(TargetTransformInfoWrapperPass)
+INITIALIZE_PASS_DEPENDENCY(OptimizationRemarkEmitterWrapperPass)
+INITIALIZE_PASS_END(LoopTilingLegacyPass, "loop-tiling", "Loop Tiling", false,
+                    false)
+
+FunctionPass *llvm::createLoopTilingPass() {
+  return new LoopTilingLegacyPass();
+}
+
+PreservedAnalyses LoopTilingPass::run(Function &F,
+                                      FunctionAnalysisManager &AM) {
+  auto &LI = AM.getResult<LoopAnalysis>(F);
+  auto &DT = AM.getResult<DominatorTreeAnalysis>(F);
+  auto &SE = AM.getResult<ScalarEvolutionAnalysis>(F);
+  auto &DI = AM.getResult<DependenceAnalysis>(F);
+  auto &TTI = AM.getResult<TargetIRAnalysis>(F);
+  auto &ORE = AM.getResult<OptimizationRemarkEmitterAnalysis>(F);
+
+  if (!tileLoops(F, LI, DT, SE, DI, TTI, ORE, TileSize))
+    return PreservedAnalyses::all();
+
+  PreservedAnalyses PA;
+  PA.preserve<LoopAnalysis>();
+  PA.preserve<DominatorTreeAnalysis>();
+  PA.preserve<ScalarEvolutionAnalysis>();
+  PA.preserve<GlobalsAA>();
+  return PA;
+}
@@ -51,11 +51,14 @@
 #include "llvm/IR/Value.h"
 #include "llvm/Pass.h"
 #include "llvm/Support/Casting.h"
+#include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/Transforms/Scalar.h"
+#include "llvm/Transforms/Utils/Cloning.h"
 #include "llvm/Transforms/Utils/PredicateInfo.h"
+#include "llvm/Transforms/Utils/ValueMapper.h"
 #include <cassert>
 #include <utility>
 #include <vector>
@@ -70,6 +73,22 @@ STATISTIC(NumDeadBlocks , "Number of basic blocks unreachable");
 STATISTIC(IPNumInstRemoved, "Number of instructions removed by IPSCCP");
 STATISTIC(IPNumArgsElimed ,"Number of arguments constant propagated by IPSCCP");
 STATISTIC(IPNumGlobalConst, "Number of globals found to be constant by IPSCCP");
+STATISTIC(IPNumSpecializations,
+          "Number of function specializations created by IPSCCP");
+
+static cl::opt<bool> EnableFunctionSpecialization(
+    "enable-function-specialization", cl::init(false), cl::Hidden,
+    cl::desc("Let IPSCCP clone functions for constant arguments passed at "
+             "some of their call sites"));
+
+static cl::opt<unsigned> FuncSpecializationMaxSize(
+    "function-specialization-max-size", cl::init(500), cl::Hidden,
+    cl::desc("The maximum number of instructions of a function IPSCCP "
+             "specializes"));
+
+static cl::opt<unsigned> FuncSpecializationMaxClones(
+    "function-specialization-max-clones", cl::init(3), cl::Hidden,
+    cl::desc("The maximum number of specializations of a single function"));
 
 namespace {
 
@@ -1973,9 +1992,166 @@ static void forceIndeterminateEdge(Instruction* I, SCCPSolver &Solver) {
   }
 }
 
+//===----------------------------------------------------------------------===//
+// Function specialization
+//===----------------------------------------------------------------------===//
+//
+// Some functions get a constant for an argument at some of their call sites
+// only, for instance a sort routine taking a comparison function. The solver
+// cannot propagate such arguments, as they differ between the call sites.
+// Before solving, clone the function for the constants passed most often and
+// redirect the call sites passing them to the clones, in which the argument is
+// replaced by the constant. The solver then propagates it through the clone,
+// and the callback, which is now called directly, may be inlined later.
+
+/// Returns how much specializing \p A on a constant simplifies the function,
+/// or 0 if it does not.
+static unsigned getSpecializationBonus(Argument &A) {
+  unsigned Bonus = 0;
+  for (User *U : A.users()) {
+    if (auto *CB = dyn_cast<CallBase>(U)) {
+      // An indirect call becomes a direct one, which may be inlined.
+      if (CB->getCalledOperand() == &A)
+        Bonus += 10;
+    } else if (auto *BI = dyn_cast<BranchInst>(U)) {
+      if (BI->isConditional())
+        Bonus += 5;
+    } else if (auto *SI = dyn_cast<SwitchInst>(U)) {
+      if (SI->getCondition() == &A)
+        Bonus += 5;
+    } else if (isa<CmpInst>(U)) {
+      Bonus += 2;
+    }
+  }
+  return Bonus;
+}
+
+/// Returns true if \p F is small and simple enough to be cloned.
+static bool canSpecializeFunction(Function &F) {
+  if (F.isDeclaration() || F.isInterposable() || F.isVarArg() ||
+      F.hasOptSize() || F.hasFnAttribute(Attribute::OptimizeNone) ||
+      F.hasFnAttribute(Attribute::Naked))
+    return false;
+
+  unsigned NumInsts = 0;
+  for (BasicBlock &BB : F) {
+    // The clone would need blockaddresses of its own.
+    if (BB.hasAddressTaken())
+      return false;
+    for (Instruction &I : BB) {
+      if (auto *CB = dyn_cast<CallBase>(&I))
+        if (CB->cannotDuplicate())
+          return false;
+      if (++NumInsts > FuncSpecializationMaxSize)
+        return false;
+    }
+  }
+  return true;
+}
+
+/// Clone \p F for the constants passed most often for one of its arguments,
+/// and redirect the call sites passing them to the clones.
+static bool specializeFunction(Function &F) {
+  // The direct calls of F, and for each argument, the calls passing each
+  // constant for it.
+  SmallVector<CallBase *, 8> Calls;
+  for (Use &U : F.uses()) {
+    auto *CB = dyn_cast<CallBase>(U.getUser());
+    if (!CB || !CB->isCallee(&U) || CB->isMustTailCall())
+      continue;
+    if (CB->getFunctionType() != F.getFunctionType())
+      continue;
+    Calls.push_back(CB);
+  }
+  if (Calls.size() < 2 && F.hasLocalLinkage())
+    return false;
+
+  Argument *BestArg = nullptr;
+  unsigned BestBonus = 0;
+  MapVector<Constant *, SmallVector<CallBase *, 4>> BestSites;
+  for (Argument &A : F.args()) {
+    if (!A.getType()->isIntegerTy() &&
+        !(A.getType()->isPointerTy() &&
+          A.getType()->getPointerElementType()->isFunctionTy()))
+      continue;
+    if (A.hasByValOrInAllocaAttr())
+      continue;
+    unsigned Bonus = getSpecializationBonus(A);
+    if (Bonus <= BestBonus)
+      continue;
+
+    MapVector<Constant *, SmallVector<CallBase *, 4>> Sites;
+    bool AllSame = F.hasLocalLinkage();
+    for (CallBase *CB : Calls) {
+      auto *C = dyn_cast<Constant>(CB->getArgOperand(A.getArgNo()));
+      if (!C || isa<UndefValue>(C) || isa<ConstantExpr>(C))
+        AllSame = false;
+      else
+        Sites[C].push_back(CB);
+    }
+    // The solver propagates an argument which is the same everywhere itself.
+    if (Sites.empty() || (AllSame && Sites.size() == 1))
+      continue;
+
+    BestArg = &A;
+    BestBonus = Bonus;
+    BestSites = std::move(Sites);
+  }
+  if (!BestArg)
+    return false;
+
+  // Specialize for the constants passed at the most call sites.
+  SmallVector<std::pair<Constant *, SmallVector<CallBase *, 4>>, 4> Candidates(
+      BestSites.begin(), BestSites.end());
+  std::stable_sort(Candidates.begin(), Candidates.end(),
+                   [](const std::pair<Constant *, SmallVector<CallBase *, 4>> &A,
+                      const std::pair<Constant *, SmallVector<CallBase *, 4>> &B) {
+                     return A.second.size() > B.second.size();
+                   });
+  unsigned NumClones =
+      std::min<unsigned>(Candidates.size(), FuncSpecializationMaxClones);
+
+  unsigned ArgNo = BestArg->getArgNo();
+  for (unsigned I = 0; I != NumClones; ++I) {
+    Constant *C = Candidates[I].first;
+    ValueToValueMapTy VMap;
+    Function *Clone = CloneFunction(&F, VMap);
+    Clone->setName(F.getName() + ".specialized." + Twine(I + 1));
+    Clone->setLinkage(GlobalValue::InternalLinkage);
+    Clone->setVisibility(GlobalValue::DefaultVisibility);
+    Clone->setDLLStorageClass(GlobalValue::DefaultStorageClass);
+    Clone->setComdat(nullptr);
+
+    Argument *ClonedArg = Clone->arg_begin() + ArgNo;
+    ClonedArg->replaceAllUsesWith(C);
+
+    LLVM_DEBUG(dbgs() << "IPSCCP: Specialized " << F.getName() << " as "
+                      << Clone->getName() << " for argument " << ArgNo << " = "
+                      << *C << "\n");
+    for (CallBase *CB : Candidates[I].second)
+      CB->setCalledFunction(Clone);
+    ++IPNumSpecializations;
+  }
+  return true;
+}
+
+static bool specializeFunctions(Module &M) {
+  SmallVector<Function *, 16> Worklist;
+  for (Function &F : M)
+    if (canSpecializeFunction(F))
+      Worklist.push_back(&F);
+
+  bool Changed = false;
+  for (Function *F : Worklist)
+    Changed |= specializeFunction(*F);
+  return Changed;
+}
+
 bool llvm::runIPSCCP(
     Module &M, const DataLayout &DL, const TargetLibraryInfo *TLI,
     function_ref<AnalysisResultsForFn(Function &)> getAnalysis) {
+  bool Specialized = EnableFunctionSpecialization && specializeFunctions(M);
+
   SCCPSolver Solver(DL, TLI);
 
   // Loop over all functions, marking arguments to those with their addresses
@@ -2030,7 +2206,7 @@ bool llvm::runIPSCCP(
       }
   }
 
-  bool MadeChanges = false;
+  bool MadeChanges = Specialized;
 
   // Iterate over all of the instructions in the module, replacing them with
   // constants if we have found them to be of constant values.
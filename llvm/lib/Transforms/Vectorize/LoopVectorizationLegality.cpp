@@ -1231,9 +1231,13 @@ bool LoopVectorizationLegality::canFoldTailByMasking() {
   SmallPtrSet<Value *, 8> SafePointers;
 
   // Check and mark all blocks for predication, including those that ordinarily
-  // do not need predication such as the header block.
+  // do not need predication such as the header block. If this fails, forget
+  // the masked operations found so far, as the caller may still vectorize the
+  // loop with a scalar epilogue.
+  SmallPtrSet<const Instruction *, 8> TmpMaskedOp = MaskedOp;
   for (BasicBlock *BB : TheLoop->blocks()) {
     if (!blockCanBePredicated(BB, SafePointers)) {
+      MaskedOp = std::move(TmpMaskedOp);
       reportVectorizationFailure(
           "Cannot fold tail by masking as required",
           "control flow cannot be substituted for a select",
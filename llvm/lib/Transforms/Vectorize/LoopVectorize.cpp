@@ -73,6 +73,7 @@
 #include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/Statistic.h"
+#include "llvm/ADT/StringExtras.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/ADT/Twine.h"
 #include "llvm/ADT/iterator_range.h"
@@ -196,6 +197,19 @@ static cl::opt<bool> EnableMaskedInterleavedMemAccesses(
 /// number.
 static const unsigned TinyTripCountInterleaveThreshold = 128;
 
+static cl::opt<bool> PreferPredicateOverEpilog(
+    "prefer-predicate-over-epilog", cl::init(false), cl::Hidden,
+    cl::desc("Fold the tail of loops by masking instead of running it in a "
+             "scalar epilogue, whenever this is legal."));
+
+/// On targets that prefer predication over an epilogue, loops with a known or
+/// estimated trip count below this number fold their tail by masking.
+static cl::opt<unsigned> TinyTripCountFoldTailThreshold(
+    "vectorizer-fold-tail-trip-count", cl::init(128), cl::Hidden,
+    cl::desc("Loops with a known or estimated trip count that is smaller "
+             "than this value fold their tail by masking on targets that "
+             "prefer predication over a scalar epilogue."));
+
 static cl::opt<unsigned> ForceTargetNumScalarRegs(
     "force-target-num-scalar-regs", cl::init(0), cl::Hidden,
     cl::desc("A flag that overrides the target's number of scalar registers."));
@@ -877,6 +891,11 @@ public:
   /// 64 bit loop indices.
   std::pair<unsigned, unsigned> getSmallestAndWidestTypes();
 
+  /// \return The width of the widest vector registers to consider: the vector
+  /// register width of the target, or the wider registers the target lets the
+  /// cost model pick when they are profitable.
+  unsigned getWidestVectorRegisterBitWidth() const;
+
   /// \return The desired interleave count.
   /// If interleave count has been specified by metadata it will be returned.
   /// Otherwise, the interleave count is computed and returned. VF and LoopCost
@@ -1189,6 +1208,10 @@ private:
   /// One is returned if vectorization should best be avoided due to cost.
   unsigned computeFeasibleMaxVF(bool OptForSize, unsigned ConstTripCount);
 
+  /// \return True if the tail of the loop should be folded by masking even
+  /// though we don't optimize for size.
+  bool preferPredicateOverEpilogue();
+
   /// The vectorization cost is a combination of the cost itself and a boolean
   /// indicating whether any of the contributing operations will actually
   /// operate on
@@ -1996,6 +2019,24 @@ static bool useMaskedInterleavedAccesses(const TargetTransformInfo &TTI) {
   return TTI.enableMaskedInterleavedAccessVectorization();
 }
 
+// Return the trip count of \p L if it is a small constant, or else an
+// estimate from profile data, or else the upper bound that SCEV can prove.
+static Optional<unsigned> getSmallBestKnownTC(ScalarEvolution &SE, Loop *L) {
+  if (unsigned ExpectedTC = SE.getSmallConstantTripCount(L))
+    return ExpectedTC;
+
+  // ExpectedTC may be large because it's bound by a variable. Check
+  // profiling information to validate we should vectorize.
+  if (LoopVectorizeWithBlockFrequency)
+    if (auto EstimatedTC = getLoopEstimatedTripCount(L))
+      return EstimatedTC;
+
+  if (unsigned ExpectedTC = SE.getSmallConstantMaxTripCount(L))
+    return ExpectedTC;
+
+  return None;
+}
+
 // Try to vectorize the interleave group that \p Instr belongs to.
 //
 // E.g. Translate following interleaved load group (factor = 3):
@@ -4666,7 +4707,10 @@ Optional<unsigned> LoopVectorizationCostModel::computeMaxVF(bool OptForSize) {
   }
 
   unsigned TC = PSE.getSE()->getSmallConstantTripCount(TheLoop);
-  if (!OptForSize) // Remaining checks deal with scalar loop when OptForSize.
+  // Remaining checks deal with scalar loop when OptForSize or when the tail
+  // is preferably folded by masking.
+  bool PreferPredicate = !OptForSize && preferPredicateOverEpilogue();
+  if (!OptForSize && !PreferPredicate)
     return computeFeasibleMaxVF(OptForSize, TC);
 
   if (Legal->getRuntimePointerChecking()->Need) {
@@ -4714,9 +4758,10 @@ Optional<unsigned> LoopVectorizationCostModel::computeMaxVF(bool OptForSize) {
   }
 
   // Record that scalar epilogue is not allowed.
-  LLVM_DEBUG(dbgs() << "LV: Not allowing scalar epilogue due to -Os/-Oz.\n");
+  LLVM_DEBUG(dbgs() << "LV: Not allowing scalar epilogue due to "
+                    << (OptForSize ? "-Os/-Oz" : "predication") << ".\n");
 
-  IsScalarEpilogueAllowed = !OptForSize;
+  IsScalarEpilogueAllowed = false;
 
   // We don't create an epilogue when optimizing for size.
   // Invalidate interleave groups that require an epilogue if we can't mask
@@ -4740,6 +4785,15 @@ Optional<unsigned> LoopVectorizationCostModel::computeMaxVF(bool OptForSize) {
     return MaxVF;
   }
 
+  // Predication was only preferred; fall back to a scalar epilogue. The
+  // interleave groups invalidated above stay invalidated.
+  if (PreferPredicate) {
+    LLVM_DEBUG(dbgs() << "LV: Cannot fold tail by masking, using a scalar "
+                         "epilogue instead.\n");
+    IsScalarEpilogueAllowed = true;
+    return MaxVF;
+  }
+
   if (TC == 0) {
     ORE->emit(
         createMissedAnalysis("UnknownLoopCountComplexCFG")
@@ -4754,13 +4808,32 @@ Optional<unsigned> LoopVectorizationCostModel::computeMaxVF(bool OptForSize) {
   return None;
 }
 
+bool LoopVectorizationCostModel::preferPredicateOverEpilogue() {
+  // Like with -Os/-Oz, the tail is only folded if the loop needs no runtime
+  // checks, as those are not supported together with masking the tail.
+  if (Legal->getRuntimePointerChecking()->Need ||
+      !PSE.getUnionPredicate().getPredicates().empty() ||
+      !Legal->getLAI()->getSymbolicStrides().empty())
+    return false;
+
+  if (PreferPredicateOverEpilog.getNumOccurrences() > 0)
+    return PreferPredicateOverEpilog;
+
+  // Long loops spend little time in their epilogue, and the masked operations
+  // would slow down every iteration.
+  if (!TTI.preferPredicateOverEpilogue())
+    return false;
+  auto BestKnownTC = getSmallBestKnownTC(*PSE.getSE(), TheLoop);
+  return BestKnownTC && *BestKnownTC < TinyTripCountFoldTailThreshold;
+}
+
 unsigned
 LoopVectorizationCostModel::computeFeasibleMaxVF(bool OptForSize,
                                                  unsigned ConstTripCount) {
   MinBWs = computeMinimumValueSizes(TheLoop->getBlocks(), *DB, &TTI);
   unsigned SmallestType, WidestType;
   std::tie(SmallestType, WidestType) = getSmallestAndWidestTypes();
-  unsigned WidestRegister = TTI.getRegisterBitWidth(true);
+  unsigned WidestRegister = getWidestVectorRegisterBitWidth();
 
   // Get the maximum safe dependence distance in bits computed by LAA.
   // It is computed by MaxVF * sizeOf(type) * 8, where type is taken from
@@ -4833,6 +4906,11 @@ LoopVectorizationCostModel::selectVectorizationFactor(unsigned MaxVF) {
   unsigned Width = 1;
   LLVM_DEBUG(dbgs() << "LV: Scalar loop costs: " << (int)ScalarCost << ".\n");
 
+  // The VFs using registers wider than the preferred ones pay the extra cost
+  // the target reports for them.
+  unsigned WidestType = getSmallestAndWidestTypes().second;
+  unsigned RegisterBitWidth = TTI.getRegisterBitWidth(true);
+
   bool ForceVectorization = Hints->getForce() == LoopVectorizeHints::FK_Enabled;
   if (ForceVectorization && MaxVF > 1) {
     // Ignore scalar width, because the user explicitly wants vectorization.
@@ -4847,6 +4925,10 @@ LoopVectorizationCostModel::selectVectorizationFactor(unsigned MaxVF) {
     // the vector elements.
     VectorizationCostTy C = expectedCost(i);
     float VectorCost = C.first / (float)i;
+    unsigned VectorBits = i * WidestType;
+    if (VectorBits > RegisterBitWidth)
+      if (unsigned Percent = TTI.getWideVectorRegisterCostPercent(VectorBits))
+        VectorCost = VectorCost * Percent / 100;
     LLVM_DEBUG(dbgs() << "LV: Vector loop of width " << i
                       << " costs: " << (int)VectorCost << ".\n");
     if (!C.second && !ForceVectorization) {
@@ -4878,6 +4960,14 @@ LoopVectorizationCostModel::selectVectorizationFactor(unsigned MaxVF) {
   return Factor;
 }
 
+unsigned LoopVectorizationCostModel::getWidestVectorRegisterBitWidth() const {
+  unsigned WidestRegister = TTI.getRegisterBitWidth(true);
+  while (WidestRegister &&
+         TTI.getWideVectorRegisterCostPercent(WidestRegister * 2))
+    WidestRegister *= 2;
+  return WidestRegister;
+}
+
 std::pair<unsigned, unsigned>
 LoopVectorizationCostModel::getSmallestAndWidestTypes() {
   unsigned MinWidth = -1U;
@@ -4959,9 +5049,11 @@ unsigned LoopVectorizationCostModel::selectInterleaveCount(bool OptForSize,
   if (Legal->getMaxSafeDepDistBytes() != -1U)
     return 1;
 
-  // Do not interleave loops with a relatively small trip count.
-  unsigned TC = PSE.getSE()->getSmallConstantTripCount(TheLoop);
-  if (TC > 1 && TC < TinyTripCountInterleaveThreshold)
+  // Do not interleave loops with a relatively small known or estimated trip
+  // count.
+  auto BestKnownTC = getSmallBestKnownTC(*PSE.getSE(), TheLoop);
+  if (BestKnownTC && *BestKnownTC > 1 &&
+      *BestKnownTC < TinyTripCountInterleaveThreshold)
     return 1;
 
   unsigned TargetNumRegisters = TTI.getNumberOfRegisters(VF > 1);
@@ -5012,6 +5104,15 @@ unsigned LoopVectorizationCostModel::selectInterleaveCount(bool OptForSize,
       MaxInterleaveCount = ForceTargetMaxVectorInterleaveFactor;
   }
 
+  // If the trip count is known or estimated, don't interleave by more than it
+  // allows, or each iteration of the vector loop would cover more elements
+  // than the loop usually has, and the scalar remainder would do all of the
+  // work.
+  if (BestKnownTC && VF > 1)
+    MaxInterleaveCount = std::max(
+        1u, std::min(MaxInterleaveCount,
+                     (unsigned)PowerOf2Floor(*BestKnownTC / VF)));
+
   // If we did not calculate the cost for VF (because the user selected the VF)
   // then we calculate the cost of VF here.
   if (LoopCost == 0)
@@ -5168,7 +5269,7 @@ LoopVectorizationCostModel::calculateRegisterUsage(ArrayRef<unsigned> VFs) {
   if (Legal->getMaxSafeDepDistBytes() != -1U)
     MaxSafeDepDist = Legal->getMaxSafeDepDistBytes() * 8;
   unsigned WidestRegister =
-      std::min(TTI.getRegisterBitWidth(true), MaxSafeDepDist);
+      std::min(getWidestVectorRegisterBitWidth(), MaxSafeDepDist);
   const DataLayout &DL = TheFunction->getParent()->getDataLayout();
 
   SmallVector<RegisterUsage, 8> RUs(VFs.size());
@@ -7238,6 +7339,19 @@ static bool processLoopInVPlanNativePath(
   return true;
 }
 
+/// Make sure the "min-legal-vector-width" attribute of \p F, if any, covers
+/// vectors of \p VectorBits bits.
+static void raiseMinLegalVectorWidth(Function &F, unsigned VectorBits) {
+  if (!F.hasFnAttribute("min-legal-vector-width"))
+    return;
+  unsigned Width;
+  if (F.getFnAttribute("min-legal-vector-width")
+          .getValueAsString()
+          .getAsInteger(0, Width) ||
+      Width < VectorBits)
+    F.addFnAttr("min-legal-vector-width", utostr(VectorBits));
+}
+
 bool LoopVectorizePass::processLoop(Loop *L) {
   assert((EnableVPlanNativePath || L->empty()) &&
          "VPlan-native path is not enabled. Only process inner loops.");
@@ -7311,33 +7425,8 @@ bool LoopVectorizePass::processLoop(Loop *L) {
   // Check the loop for a trip count threshold: vectorize loops with a tiny trip
   // count by optimizing for size, to minimize overheads.
   // Prefer constant trip counts over profile data, over upper bound estimate.
-  unsigned ExpectedTC = 0;
-  bool HasExpectedTC = false;
-  if (const SCEVConstant *ConstExits =
-      dyn_cast<SCEVConstant>(SE->getBackedgeTakenCount(L))) {
-    const APInt &ExitsCount = ConstExits->getAPInt();
-    // We are interested in small values for ExpectedTC. Skip over those that
-    // can't fit an unsigned.
-    if (ExitsCount.ult(std::numeric_limits<unsigned>::max())) {
-      ExpectedTC = static_cast<unsigned>(ExitsCount.getZExtValue()) + 1;
-      HasExpectedTC = true;
-    }
-  }
-  // ExpectedTC may be large because it's bound by a variable. Check
-  // profiling information to validate we should vectorize.
-  if (!HasExpectedTC && LoopVectorizeWithBlockFrequency) {
-    auto EstimatedTC = getLoopEstimatedTripCount(L);
-    if (EstimatedTC) {
-      ExpectedTC = *EstimatedTC;
-      HasExpectedTC = true;
-    }
-  }
-  if (!HasExpectedTC) {
-    ExpectedTC = SE->getSmallConstantMaxTripCount(L);
-    HasExpectedTC = (ExpectedTC > 0);
-  }
-
-  if (HasExpectedTC && ExpectedTC < TinyTripCountVectorThreshold) {
+  auto ExpectedTC = getSmallBestKnownTC(*SE, L);
+  if (ExpectedTC && *ExpectedTC < TinyTripCountVectorThreshold) {
     LLVM_DEBUG(dbgs() << "LV: Found a loop with a very small trip count. "
                       << "This loop is worth vectorizing only if no scalar "
                       << "iteration overheads are incurred.");
@@ -7527,6 +7616,13 @@ bool LoopVectorizePass::processLoop(Loop *L) {
              << NV("InterleaveCount", IC) << ")";
     });
   } else {
+    // If the loop uses registers wider than the preferred ones, make sure the
+    // backend doesn't split them.
+    unsigned VectorBits = VF.Width * CM.getSmallestAndWidestTypes().second;
+    if (VectorBits > TTI->getRegisterBitWidth(true) &&
+        TTI->getWideVectorRegisterCostPercent(VectorBits))
+      raiseMinLegalVectorWidth(*F, VectorBits);
+
     // If we decided that it is *legal* to vectorize the loop, then do it.
     InnerLoopVectorizer LB(L, PSE, LI, DT, TLI, TTI, AC, ORE, VF.Width, IC,
                            &LVL, &CM);
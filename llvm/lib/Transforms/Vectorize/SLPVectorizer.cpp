@@ -139,6 +139,12 @@ static cl::opt<int> MinVectorRegSizeOption(
     "slp-min-reg-size", cl::init(128), cl::Hidden,
     cl::desc("Attempt to vectorize for this register size in bits"));
 
+static cl::opt<bool> VectorizeNonPowerOf2(
+    "slp-vectorize-non-power-of-2", cl::init(false), cl::Hidden,
+    cl::desc("Try to vectorize store chains and bundles with a number of "
+             "elements that is not a power of 2, like the x, y and z members "
+             "of a struct"));
+
 static cl::opt<unsigned> RecursionMaxDepth(
     "slp-recursion-max-depth", cl::init(12), cl::Hidden,
     cl::desc("Limit the recursion depth when building a vectorizable tree"));
@@ -2332,7 +2338,8 @@ void BoUpSLP::buildTree_rec(ArrayRef<Value *> VL, unsigned Depth,
     ReuseShuffleIndicies.clear();
   } else {
     LLVM_DEBUG(dbgs() << "SLP: Shuffle for reused scalars.\n");
-    if (UniqueValues.size() <= 1 || !llvm::isPowerOf2_32(UniqueValues.size())) {
+    if (UniqueValues.size() <= 1 ||
+        (!VectorizeNonPowerOf2 && !llvm::isPowerOf2_32(UniqueValues.size()))) {
       LLVM_DEBUG(dbgs() << "SLP: Scalar used twice in bundle.\n");
       newTreeEntry(VL, false, UserTreeIdx);
       return;
@@ -3654,9 +3661,9 @@ Value *BoUpSLP::vectorizeTree(ArrayRef<Value *> VL) {
         UniqueValues.emplace_back(V);
     }
     // Do not shuffle single element or if number of unique values is not power
-    // of 2.
+    // of 2, unless non-power-of-2 vectors are allowed.
     if (UniqueValues.size() == VL.size() || UniqueValues.size() <= 1 ||
-        !llvm::isPowerOf2_32(UniqueValues.size()))
+        (!VectorizeNonPowerOf2 && !llvm::isPowerOf2_32(UniqueValues.size())))
       ReuseShuffleIndicies.clear();
     else
       VL = UniqueValues;
@@ -5421,6 +5428,20 @@ bool SLPVectorizerPass::vectorizeStores(ArrayRef<StoreInst *> Stores,
       I = ConsecutiveChain[I];
     }
 
+    // A chain like the x, y and z members of a struct does not fill a vector
+    // of any power-of-2 width. Try to vectorize it as a whole first, leaving
+    // it to the cost model and the backend to widen the vector.
+    unsigned ChainLen = Operands.size();
+    if (VectorizeNonPowerOf2 && ChainLen > 2 && !isPowerOf2_32(ChainLen)) {
+      unsigned ChainSize = ChainLen * R.getVectorElementSize(Operands[0]);
+      if (ChainSize <= R.getMaxVecRegSize() &&
+          vectorizeStoreChain(Operands, R, ChainSize)) {
+        VectorizedStores.insert(Operands.begin(), Operands.end());
+        Changed = true;
+        continue;
+      }
+    }
+
     // FIXME: Is division-by-2 the correct step? Should we assert that the
     // register size is a power-of-2?
     for (unsigned Size = R.getMaxVecRegSize(); Size >= R.getMinVecRegSize();
@@ -10,10 +10,13 @@
 //
 //===----------------------------------------------------------------------===//
 #include "llvm/XRay/Trace.h"
+#include "llvm/ADT/Optional.h"
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/Support/DataExtractor.h"
 #include "llvm/Support/Error.h"
 #include "llvm/Support/FileSystem.h"
+#include "llvm/Support/ThreadPool.h"
+#include "llvm/Support/Threading.h"
 #include "llvm/XRay/BlockIndexer.h"
 #include "llvm/XRay/BlockVerifier.h"
 #include "llvm/XRay/FDRRecordConsumer.h"
@@ -340,6 +343,212 @@ Error loadFDRLog(StringRef Data, bool IsLittleEndian,
   return Error::success();
 }
 
+/// A run of records of a block that can be decoded on its own: decoding from
+/// DecodeOffset with a fresh record producer yields SkipRecords records that
+/// belong to other blocks, then the NumRecords records of the block.
+struct BlockSegment {
+  uint64_t DecodeOffset;
+  uint32_t SkipRecords;
+  uint32_t NumRecords;
+};
+
+/// The location of a block of an FDR log, as found by indexFDRLog. Unlike a
+/// BlockIndexer::Block, it does not hold on to the records of the block.
+struct BlockLocation {
+  SmallVector<BlockSegment, 1> Segments;
+  uint64_t Seconds = 0;
+  uint32_t Nanos = 0;
+};
+
+using BlockLocationIndex =
+    DenseMap<std::pair<uint64_t, int32_t>, std::vector<BlockLocation>>;
+
+// Decoding restarts from a later point in the log once it is this far from
+// the start of the current DataExtractor, whose offsets are 32-bit.
+constexpr uint64_t RebaseThreshold = 1ULL << 30;
+
+/// Indexes the blocks of the FDR log in Data by process and thread, like
+/// loadFDRLog does, but only keeps the location of each block, so that the
+/// memory used does not grow with the number of records.
+///
+/// A record producer carries no state from one buffer to the next: decoding
+/// can restart at the BufferExtents record of any buffer, or at any record in
+/// logs older than version 3, which have no buffer extents.
+Error indexFDRLog(StringRef Data, bool IsLittleEndian,
+                  XRayFileHeader &FileHeader, BlockLocationIndex &Index) {
+  if (Data.size() < 32)
+    return createStringError(std::make_error_code(std::errc::invalid_argument),
+                             "Not enough bytes for an XRay FDR log.");
+
+  uint64_t Base = 0;
+  uint32_t OffsetPtr = 0;
+  DataExtractor DE(Data, IsLittleEndian, 8);
+  auto FileHeaderOrError = readBinaryFormatHeader(DE, OffsetPtr);
+  if (!FileHeaderOrError)
+    return FileHeaderOrError.takeError();
+  FileHeader = std::move(FileHeaderOrError.get());
+
+  auto P = llvm::make_unique<FileBasedRecordProducer>(FileHeader, DE,
+                                                      OffsetPtr);
+  uint64_t DecodeOffset = OffsetPtr;
+  uint32_t RecordsSinceDecodeOffset = 0;
+
+  std::pair<uint64_t, int32_t> CurrentKey{0, 0};
+  BlockLocation CurrentBlock;
+  auto Flush = [&] {
+    Index[CurrentKey].push_back(std::move(CurrentBlock));
+    CurrentKey = {0, 0};
+    CurrentBlock = BlockLocation();
+  };
+
+  while (DE.isValidOffsetForDataOfSize(OffsetPtr, 1)) {
+    uint32_t PreReadOffset = OffsetPtr;
+    auto R = P->produce();
+    if (!R)
+      return R.takeError();
+
+    bool IsExtents = isa<BufferExtents>(R->get());
+    bool IsNewBuffer = isa<NewBufferRecord>(R->get());
+    if (IsExtents || (FileHeader.Version < 3 && IsNewBuffer)) {
+      // Restart decoding with a fresh producer from here, if the offsets of
+      // this extractor are getting large.
+      if (PreReadOffset > RebaseThreshold) {
+        Base += PreReadOffset;
+        DE = DataExtractor(Data.drop_front(Base), IsLittleEndian, 8);
+        OffsetPtr = 0;
+        P = llvm::make_unique<FileBasedRecordProducer>(FileHeader, DE,
+                                                       OffsetPtr);
+        continue;
+      }
+      DecodeOffset = Base + PreReadOffset;
+      RecordsSinceDecodeOffset = 0;
+    }
+
+    uint32_t RecordIndex = RecordsSinceDecodeOffset++;
+    if (IsExtents)
+      continue;
+
+    if (IsNewBuffer) {
+      if (!CurrentBlock.Segments.empty())
+        Flush();
+      CurrentKey.second = cast<NewBufferRecord>(R->get())->tid();
+    } else if (auto *W = dyn_cast<WallclockRecord>(R->get())) {
+      CurrentBlock.Seconds = W->seconds();
+      CurrentBlock.Nanos = W->nanos();
+    } else if (auto *PR = dyn_cast<PIDRecord>(R->get())) {
+      CurrentKey.first = PR->pid();
+    }
+
+    if (CurrentBlock.Segments.empty() ||
+        CurrentBlock.Segments.back().DecodeOffset != DecodeOffset)
+      CurrentBlock.Segments.push_back({DecodeOffset, RecordIndex, 0});
+    ++CurrentBlock.Segments.back().NumRecords;
+  }
+  Flush();
+  return Error::success();
+}
+
+/// Decodes, verifies, and expands the blocks of one thread of an FDR log.
+Expected<std::vector<XRayRecord>>
+expandThreadBlocks(StringRef Data, bool IsLittleEndian,
+                   const XRayFileHeader &FileHeader,
+                   std::vector<BlockLocation> &Blocks) {
+  // Sort the blocks the way loadFDRLog does.
+  llvm::sort(Blocks, [](const BlockLocation &L, const BlockLocation &R) {
+    return (L.Seconds < R.Seconds && L.Nanos < R.Nanos);
+  });
+
+  std::vector<XRayRecord> Records;
+  auto Adder = [&](const XRayRecord &R) { Records.push_back(R); };
+  TraceExpander Expander(Adder, FileHeader.Version);
+  std::vector<std::unique_ptr<Record>> BlockRecords;
+  for (auto &B : Blocks) {
+    BlockRecords.clear();
+    for (auto &S : B.Segments) {
+      DataExtractor DE(Data.drop_front(S.DecodeOffset), IsLittleEndian, 8);
+      uint32_t OffsetPtr = 0;
+      FileBasedRecordProducer P(FileHeader, DE, OffsetPtr);
+      for (uint32_t I = 0, E = S.SkipRecords + S.NumRecords; I != E; ++I) {
+        auto R = P.produce();
+        if (!R)
+          return R.takeError();
+        if (I >= S.SkipRecords && !isa<BufferExtents>(R->get()))
+          BlockRecords.push_back(std::move(*R));
+      }
+    }
+
+    BlockVerifier Verifier;
+    for (auto &R : BlockRecords)
+      if (auto E = R->apply(Verifier))
+        return std::move(E);
+    if (auto E = Verifier.verify())
+      return std::move(E);
+
+    for (auto &R : BlockRecords)
+      if (auto E = R->apply(Expander))
+        return std::move(E);
+  }
+  if (auto E = Expander.flush())
+    return std::move(E);
+  return std::move(Records);
+}
+
+/// Streams the records of the FDR log in Data, one thread at a time, decoding
+/// up to NumThreads threads in parallel.
+Error processFDRLog(StringRef Data, bool IsLittleEndian,
+                    const XRayFileHeader &FileHeader,
+                    BlockLocationIndex &Index,
+                    function_ref<Error(const XRayRecord &)> RecordCallback,
+                    unsigned NumThreads) {
+  std::vector<std::vector<BlockLocation> *> Threads;
+  for (auto &PTB : Index)
+    Threads.push_back(&PTB.second);
+
+  if (NumThreads <= 1) {
+    for (auto *Blocks : Threads) {
+      auto RecordsOrErr =
+          expandThreadBlocks(Data, IsLittleEndian, FileHeader, *Blocks);
+      if (!RecordsOrErr)
+        return RecordsOrErr.takeError();
+      for (const auto &R : *RecordsOrErr)
+        if (auto E = RecordCallback(R))
+          return E;
+    }
+    return Error::success();
+  }
+
+  // Decode the threads in batches, so that only the records of NumThreads
+  // threads are held in memory at a time.
+  ThreadPool Pool(NumThreads);
+  for (size_t I = 0, E = Threads.size(); I < E; I += NumThreads) {
+    size_t BatchSize = std::min<size_t>(NumThreads, E - I);
+    std::vector<Optional<Expected<std::vector<XRayRecord>>>> Results(
+        BatchSize);
+    for (size_t J = 0; J != BatchSize; ++J)
+      Pool.async([&, I, J] {
+        Results[J].emplace(expandThreadBlocks(Data, IsLittleEndian,
+                                              FileHeader, *Threads[I + J]));
+      });
+    Pool.wait();
+
+    Error Err = Error::success();
+    for (auto &RecordsOrErr : Results) {
+      if (!*RecordsOrErr) {
+        Err = joinErrors(std::move(Err), RecordsOrErr->takeError());
+        continue;
+      }
+      if (Err)
+        continue;
+      for (const auto &R : **RecordsOrErr)
+        if ((Err = RecordCallback(R)))
+          break;
+    }
+    if (Err)
+      return Err;
+  }
+  return Error::success();
+}
+
 Error loadYAMLLog(StringRef Data, XRayFileHeader &FileHeader,
                   std::vector<XRayRecord> &Records) {
   YAMLXRayTrace Trace;
@@ -467,3 +676,85 @@ Expected<Trace> llvm::xray::loadTrace(const DataExtractor &DE, bool Sort) {
 
   return std::move(T);
 }
+
+Error llvm::xray::processTraceFile(
+    StringRef Filename,
+    function_ref<Error(const XRayFileHeader &)> HeaderCallback,
+    function_ref<Error(const XRayRecord &)> RecordCallback,
+    unsigned NumThreads) {
+  int Fd;
+  if (auto EC = sys::fs::openFileForRead(Filename, Fd)) {
+    return make_error<StringError>(
+        Twine("Cannot read log from '") + Filename + "'", EC);
+  }
+
+  uint64_t FileSize;
+  if (auto EC = sys::fs::file_size(Filename, FileSize)) {
+    return make_error<StringError>(
+        Twine("Cannot read log from '") + Filename + "'", EC);
+  }
+  if (FileSize < 4) {
+    return make_error<StringError>(
+        Twine("File '") + Filename + "' too small for XRay.",
+        std::make_error_code(std::errc::executable_format_error));
+  }
+
+  std::error_code EC;
+  sys::fs::mapped_file_region MappedFile(
+      Fd, sys::fs::mapped_file_region::mapmode::readonly, FileSize, 0, EC);
+  if (EC) {
+    return make_error<StringError>(
+        Twine("Cannot read log from '") + Filename + "'", EC);
+  }
+  auto Data = StringRef(MappedFile.data(), MappedFile.size());
+
+  // The records may not be decoded twice, so pick the endianness up front:
+  // binary logs start with a type of 0 or 1, and YAML logs do not care.
+  auto IsLittleEndian = [&]() {
+    DataExtractor BigEndianDE(Data, false, 8);
+    uint32_t OffsetPtr = 2;
+    uint16_t BigEndianType = BigEndianDE.getU16(&OffsetPtr);
+    DataExtractor LittleEndianDE(Data, true, 8);
+    OffsetPtr = 2;
+    uint16_t LittleEndianType = LittleEndianDE.getU16(&OffsetPtr);
+    return LittleEndianType <= 1 || BigEndianType > 1;
+  };
+  DataExtractor DE(Data, IsLittleEndian(), 8);
+  return processTrace(DE, HeaderCallback, RecordCallback, NumThreads);
+}
+
+Error llvm::xray::processTrace(
+    const DataExtractor &DE,
+    function_ref<Error(const XRayFileHeader &)> HeaderCallback,
+    function_ref<Error(const XRayRecord &)> RecordCallback,
+    unsigned NumThreads) {
+  DataExtractor HeaderExtractor(DE.getData(), DE.isLittleEndian(), 8);
+  uint32_t OffsetPtr = 0;
+  uint16_t Version = HeaderExtractor.getU16(&OffsetPtr);
+  uint16_t Type = HeaderExtractor.getU16(&OffsetPtr);
+
+  // Only FDR mode logs are decoded incrementally.
+  if (Type != 1 || Version < 1 || Version > 5) {
+    auto TraceOrErr = loadTrace(DE);
+    if (!TraceOrErr)
+      return TraceOrErr.takeError();
+    if (auto E = HeaderCallback(TraceOrErr->getFileHeader()))
+      return E;
+    for (const auto &R : *TraceOrErr)
+      if (auto E = RecordCallback(R))
+        return E;
+    return Error::success();
+  }
+
+  XRayFileHeader FileHeader;
+  BlockLocationIndex Index;
+  if (auto E = indexFDRLog(DE.getData(), DE.isLittleEndian(), FileHeader,
+                           Index))
+    return E;
+  if (auto E = HeaderCallback(FileHeader))
+    return E;
+  return processFDRLog(DE.getData(), DE.isLittleEndian(), FileHeader, Index,
+                       RecordCallback,
+                       NumThreads ? NumThreads
+                                  : llvm::hardware_concurrency());
+}
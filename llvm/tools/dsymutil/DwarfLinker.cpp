@@ -2547,12 +2547,36 @@ bool DwarfLinker::link(const DebugMap &Map) {
   unsigned NumObjects = Map.getNumberOfObjects();
   std::vector<LinkContext> ObjectContexts;
   ObjectContexts.reserve(NumObjects);
-  for (const auto &Obj : Map.objects()) {
-    ObjectContexts.emplace_back(Map, *this, *Obj.get());
-    LinkContext &LC = ObjectContexts.back();
+  for (const auto &Obj : Map.objects())
+    ObjectContexts.emplace_back(*this, *Obj.get());
+
+  // Loading an object and parsing its DIEs doesn't depend on any other
+  // object, so when we can use more than one thread, do that for all
+  // objects up front with all available threads. The analyze and clone
+  // phases below then mostly work on already parsed debug info. In the
+  // single threaded case, DIEs are parsed on demand to limit memory usage.
+  auto LoadLambda = [&](size_t I) {
+    LinkContext &LC = ObjectContexts[I];
+    LC.load(Map, *this);
+    if (Options.Threads == 1 || !LC.DwarfContext)
+      return;
+    for (const auto &CU : LC.DwarfContext->compile_units())
+      CU->getNumDIEs();
+  };
+
+  if (Options.Threads == 1) {
+    for (unsigned I = 0; I != NumObjects; ++I)
+      LoadLambda(I);
+  } else {
+    ThreadPool Pool(Options.Threads);
+    for (unsigned I = 0; I != NumObjects; ++I)
+      Pool.async(LoadLambda, I);
+    Pool.wait();
+  }
+
+  for (LinkContext &LC : ObjectContexts)
     if (LC.ObjectFile)
       updateAccelKind(*LC.DwarfContext);
-  }
 
   // This Dwarf string pool which is only used for uniquing. This one should
   // never be used for offsets as its not thread-safe or predictable.
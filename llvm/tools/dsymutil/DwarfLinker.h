@@ -148,13 +148,16 @@ private:
     RangesTy Ranges;
     UnitListTy CompileUnits;
 
-    LinkContext(const DebugMap &Map, DwarfLinker &Linker, DebugMapObject &DMO)
-        : DMO(DMO), RelocMgr(Linker) {
+    LinkContext(DwarfLinker &Linker, DebugMapObject &DMO)
+        : DMO(DMO), ObjectFile(nullptr), RelocMgr(Linker) {}
+
+    /// Load the object file and create its DWARF context. This only touches
+    /// this context, so contexts of different objects can be loaded
+    /// concurrently.
+    void load(const DebugMap &Map, DwarfLinker &Linker) {
       // Swift ASTs are not object files.
-      if (DMO.getType() == MachO::N_AST) {
-        ObjectFile = nullptr;
+      if (DMO.getType() == MachO::N_AST)
         return;
-      }
       auto ErrOrObj = Linker.loadObject(DMO, Map);
       ObjectFile = ErrOrObj ? &*ErrOrObj : nullptr;
       DwarfContext = ObjectFile ? DWARFContext::create(*ObjectFile) : nullptr;
@@ -0,0 +1,354 @@
+//===- llvm-compile-time-bench.cpp - Per-pass compile time measurements ---===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// This tool runs a new pass manager pipeline over a set of IR files several
+// times and reports, for every pass and analysis, the wall time and the memory
+// it allocated, excluding the passes nested in it, and the change in the
+// number of IR instructions of the unit it ran on. The report is JSON, and
+// -diff compares two reports to track compile time regressions per pass.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/ADT/Any.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Analysis/AliasAnalysis.h"
+#include "llvm/IR/Function.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/Module.h"
+#include "llvm/IR/PassInstrumentation.h"
+#include "llvm/IR/PassManager.h"
+#include "llvm/IRReader/IRReader.h"
+#include "llvm/Passes/PassBuilder.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/InitLLVM.h"
+#include "llvm/Support/JSON.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Process.h"
+#include "llvm/Support/SourceMgr.h"
+#include "llvm/Support/Timer.h"
+#include "llvm/Support/ToolOutputFile.h"
+#include "llvm/Support/WithColor.h"
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace llvm;
+
+static cl::list<std::string> InputFilenames(cl::Positional, cl::OneOrMore,
+                                            cl::desc("<input files>"));
+
+static cl::opt<std::string>
+    PassPipeline("passes", cl::init("default<O2>"),
+                 cl::desc("The pass pipeline to measure, as for opt -passes"));
+
+static cl::opt<std::string>
+    AAPipeline("aa-pipeline", cl::init("default"),
+               cl::desc("The alias analysis pipeline, as for opt"));
+
+static cl::opt<unsigned>
+    Iterations("iterations", cl::init(3),
+               cl::desc("The number of times to run the pipeline on each "
+                        "input; the report has the average of the runs"));
+
+static cl::opt<std::string> OutputFilename("o", cl::init("-"),
+                                           cl::desc("Output JSON filename"),
+                                           cl::value_desc("filename"));
+
+static cl::opt<bool>
+    Diff("diff", cl::desc("Compare the two JSON reports given as inputs "
+                          "instead of measuring"));
+
+static cl::opt<double>
+    DiffThreshold("diff-threshold", cl::init(0.001),
+                  cl::desc("Only list the passes whose time changed by at "
+                           "least this many seconds in -diff mode"));
+
+static const char *ToolName;
+
+namespace {
+
+/// The cost of a pass or analysis, summed over all its runs.
+struct PassCost {
+  double WallTime = 0;
+  int64_t MallocBytes = 0;
+  int64_t InstrDelta = 0;
+  unsigned Runs = 0;
+};
+
+/// Measures the exclusive cost of each pass and analysis: the time spent in
+/// the passes nested in a pass manager or adaptor, and in the analyses that a
+/// pass computes, is charged to them and not to their parent.
+class PassCostTracker {
+  struct Frame {
+    StringRef PassID;
+    double Start;
+    size_t MallocStart;
+    int64_t InstrsBefore;
+  };
+  SmallVector<Frame, 8> Stack;
+  StringMap<PassCost> Costs;
+
+  static double getWallTime() {
+    return TimeRecord::getCurrentTime(/*Start=*/true).getWallTime();
+  }
+
+  /// Returns the number of instructions in \p IR, or -1 if it is not a module
+  /// or a function.
+  static int64_t getInstructionCount(const Any &IR) {
+    if (any_isa<const Module *>(IR))
+      return const_cast<Module *>(any_cast<const Module *>(IR))
+          ->getInstructionCount();
+    if (any_isa<const Function *>(IR))
+      return any_cast<const Function *>(IR)->getInstructionCount();
+    return -1;
+  }
+
+  /// Charges the time and memory since the top frame (re)started to it.
+  void chargeTop() {
+    Frame &Top = Stack.back();
+    PassCost &Cost = Costs[Top.PassID];
+    Cost.WallTime += getWallTime() - Top.Start;
+    Cost.MallocBytes += int64_t(sys::Process::GetMallocUsage()) -
+                        int64_t(Top.MallocStart);
+  }
+
+  void restartTop() {
+    Stack.back().Start = getWallTime();
+    Stack.back().MallocStart = sys::Process::GetMallocUsage();
+  }
+
+  void enter(StringRef PassID, const Any &IR, bool CountInstrs) {
+    if (!Stack.empty())
+      chargeTop();
+    // Count the instructions outside of the measured time.
+    int64_t InstrsBefore = CountInstrs ? getInstructionCount(IR) : -1;
+    Stack.push_back({PassID, 0, 0, InstrsBefore});
+    restartTop();
+  }
+
+  void leave(const Any &IR, bool IRValid) {
+    chargeTop();
+    Frame Top = Stack.pop_back_val();
+    PassCost &Cost = Costs[Top.PassID];
+    ++Cost.Runs;
+    if (IRValid && Top.InstrsBefore >= 0) {
+      int64_t InstrsAfter = getInstructionCount(IR);
+      if (InstrsAfter >= 0)
+        Cost.InstrDelta += InstrsAfter - Top.InstrsBefore;
+    }
+    if (!Stack.empty())
+      restartTop();
+  }
+
+public:
+  void registerCallbacks(PassInstrumentationCallbacks &PIC) {
+    PIC.registerBeforePassCallback([this](StringRef PassID, Any IR) {
+      enter(PassID, IR, /*CountInstrs=*/true);
+      return true;
+    });
+    PIC.registerAfterPassCallback(
+        [this](StringRef PassID, Any IR) { leave(IR, /*IRValid=*/true); });
+    PIC.registerAfterPassInvalidatedCallback(
+        [this](StringRef PassID) { leave(Any(), /*IRValid=*/false); });
+    PIC.registerBeforeAnalysisCallback([this](StringRef PassID, Any IR) {
+      enter(PassID, IR, /*CountInstrs=*/false);
+    });
+    PIC.registerAfterAnalysisCallback(
+        [this](StringRef PassID, Any IR) { leave(IR, /*IRValid=*/false); });
+  }
+
+  const StringMap<PassCost> &getCosts() const { return Costs; }
+};
+
+} // end anonymous namespace
+
+static void reportError(const Twine &Message) {
+  WithColor::error(errs(), ToolName) << Message << "\n";
+  exit(1);
+}
+
+/// Parses \p Buffer and runs the pipeline on it once, adding the costs of the
+/// passes to \p Tracker. Returns the wall time of the whole pipeline.
+static double runPipeline(MemoryBufferRef Buffer, PassCostTracker &Tracker) {
+  LLVMContext Context;
+  SMDiagnostic Err;
+  std::unique_ptr<Module> M = parseIR(Buffer, Err, Context);
+  if (!M) {
+    Err.print(ToolName, errs());
+    exit(1);
+  }
+
+  PassInstrumentationCallbacks PIC;
+  Tracker.registerCallbacks(PIC);
+  PassBuilder PB(/*TM=*/nullptr, PipelineTuningOptions(), None, &PIC);
+
+  AAManager AA;
+  if (Error E = PB.parseAAPipeline(AA, AAPipeline))
+    reportError(toString(std::move(E)));
+
+  LoopAnalysisManager LAM;
+  FunctionAnalysisManager FAM;
+  CGSCCAnalysisManager CGAM;
+  ModuleAnalysisManager MAM;
+  FAM.registerPass([&] { return std::move(AA); });
+  PB.registerModuleAnalyses(MAM);
+  PB.registerCGSCCAnalyses(CGAM);
+  PB.registerFunctionAnalyses(FAM);
+  PB.registerLoopAnalyses(LAM);
+  PB.crossRegisterProxies(LAM, FAM, CGAM, MAM);
+
+  ModulePassManager MPM;
+  if (Error E = PB.parsePassPipeline(MPM, PassPipeline,
+                                     /*VerifyEachPass=*/false))
+    reportError(toString(std::move(E)));
+
+  TimeRecord Start = TimeRecord::getCurrentTime(/*Start=*/true);
+  MPM.run(*M, MAM);
+  TimeRecord End = TimeRecord::getCurrentTime(/*Start=*/false);
+  return End.getWallTime() - Start.getWallTime();
+}
+
+static int measure() {
+  if (Iterations == 0)
+    reportError("-iterations must be at least 1");
+
+  std::vector<std::unique_ptr<MemoryBuffer>> Buffers;
+  for (const std::string &Filename : InputFilenames) {
+    ErrorOr<std::unique_ptr<MemoryBuffer>> BufferOrErr =
+        MemoryBuffer::getFileOrSTDIN(Filename);
+    if (std::error_code EC = BufferOrErr.getError())
+      reportError("cannot open '" + Filename + "': " + EC.message());
+    Buffers.push_back(std::move(*BufferOrErr));
+  }
+
+  PassCostTracker Tracker;
+  double TotalTime = 0;
+  for (unsigned I = 0; I != Iterations; ++I)
+    for (const std::unique_ptr<MemoryBuffer> &Buffer : Buffers)
+      TotalTime += runPipeline(Buffer->getMemBufferRef(), Tracker);
+
+  std::vector<const StringMapEntry<PassCost> *> Entries;
+  for (const StringMapEntry<PassCost> &Entry : Tracker.getCosts())
+    Entries.push_back(&Entry);
+  llvm::sort(Entries, [](const StringMapEntry<PassCost> *L,
+                         const StringMapEntry<PassCost> *R) {
+    return L->getKey() < R->getKey();
+  });
+
+  std::error_code EC;
+  ToolOutputFile Out(OutputFilename, EC, sys::fs::F_Text);
+  if (EC)
+    reportError("cannot open '" + OutputFilename + "': " + EC.message());
+
+  double N = Iterations;
+  json::OStream J(Out.os(), 2);
+  J.object([&] {
+    J.attribute("pipeline", PassPipeline);
+    J.attribute("iterations", int64_t(Iterations));
+    J.attributeArray("inputs", [&] {
+      for (const std::string &Filename : InputFilenames)
+        J.value(Filename);
+    });
+    J.attribute("wall", TotalTime / N);
+    J.attributeObject("passes", [&] {
+      for (const StringMapEntry<PassCost> *Entry : Entries) {
+        const PassCost &Cost = Entry->getValue();
+        J.attributeObject(Entry->getKey(), [&] {
+          J.attribute("wall", Cost.WallTime / N);
+          J.attribute("malloc", int64_t(std::llround(Cost.MallocBytes / N)));
+          J.attribute("instr-delta",
+                      int64_t(std::llround(Cost.InstrDelta / N)));
+          J.attribute("runs", int64_t(std::llround(Cost.Runs / N)));
+        });
+      }
+    });
+  });
+  Out.os() << "\n";
+  Out.keep();
+  return 0;
+}
+
+/// Returns the wall time of each pass in the report in \p Filename; the total
+/// time of the pipeline is under the empty name.
+static StringMap<double> readReport(StringRef Filename) {
+  ErrorOr<std::unique_ptr<MemoryBuffer>> BufferOrErr =
+      MemoryBuffer::getFile(Filename);
+  if (std::error_code EC = BufferOrErr.getError())
+    reportError("cannot open '" + Filename + "': " + EC.message());
+  Expected<json::Value> Report = json::parse((*BufferOrErr)->getBuffer());
+  if (!Report)
+    reportError("'" + Filename + "': " + toString(Report.takeError()));
+
+  const json::Object *Root = Report->getAsObject();
+  const json::Object *Passes = Root ? Root->getObject("passes") : nullptr;
+  if (!Passes)
+    reportError("'" + Filename + "' is not a llvm-compile-time-bench report");
+
+  StringMap<double> Times;
+  if (Optional<double> Wall = Root->getNumber("wall"))
+    Times[""] = *Wall;
+  for (const auto &KV : *Passes)
+    if (const json::Object *Pass = KV.second.getAsObject())
+      if (Optional<double> Wall = Pass->getNumber("wall"))
+        Times[KV.first.str()] = *Wall;
+  return Times;
+}
+
+static int diff() {
+  if (InputFilenames.size() != 2)
+    reportError("-diff expects a baseline and a new report");
+  StringMap<double> Base = readReport(InputFilenames[0]);
+  StringMap<double> New = readReport(InputFilenames[1]);
+
+  struct Change {
+    std::string Name;
+    double Base, New;
+  };
+  std::vector<Change> Changes;
+  for (const StringMapEntry<double> &Entry : Base)
+    Changes.push_back({Entry.getKey(), Entry.getValue(),
+                       New.lookup(Entry.getKey())});
+  for (const StringMapEntry<double> &Entry : New)
+    if (!Base.count(Entry.getKey()))
+      Changes.push_back({Entry.getKey(), 0, Entry.getValue()});
+  llvm::sort(Changes, [](const Change &L, const Change &R) {
+    return std::fabs(L.New - L.Base) > std::fabs(R.New - R.Base);
+  });
+
+  std::error_code EC;
+  ToolOutputFile Out(OutputFilename, EC, sys::fs::F_Text);
+  if (EC)
+    reportError("cannot open '" + OutputFilename + "': " + EC.message());
+  raw_ostream &OS = Out.os();
+  OS << "    base (s)      new (s)    change  pass\n";
+  for (const Change &C : Changes) {
+    if (!C.Name.empty() && std::fabs(C.New - C.Base) < DiffThreshold)
+      continue;
+    OS << format("%12.4f %12.4f ", C.Base, C.New);
+    if (C.Base > 0)
+      OS << format("%+8.1f%%", (C.New - C.Base) / C.Base * 100);
+    else
+      OS << "      new";
+    OS << "  " << (C.Name.empty() ? "<total>" : C.Name) << "\n";
+  }
+  Out.keep();
+  return 0;
+}
+
+int main(int argc, char **argv) {
+  InitLLVM X(argc, argv);
+  ToolName = argv[0];
+  cl::ParseCommandLineOptions(argc, argv,
+                              "per-pass compile time measurements\n");
+  return Diff ? diff() : measure();
+}
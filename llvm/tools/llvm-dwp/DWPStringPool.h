@@ -4,6 +4,8 @@
 #include "llvm/ADT/DenseMap.h"
 #include "llvm/MC/MCSection.h"
 #include "llvm/MC/MCStreamer.h"
+#include "llvm/Support/Allocator.h"
+#include "llvm/Support/StringSaver.h"
 #include <cassert>
 
 namespace llvm {
@@ -34,6 +36,10 @@ class DWPStringPool {
   MCSection *Sec;
   DenseMap<const char *, uint32_t, CStrDenseMapInfo> Pool;
   uint32_t Offset = 0;
+  // The pool keeps its own copies of the strings, so that the input files can
+  // be released once they have been written out.
+  BumpPtrAllocator Alloc;
+  StringSaver Saver{Alloc};
 
 public:
   DWPStringPool(MCStreamer &Out, MCSection *Sec) : Out(Out), Sec(Sec) {}
@@ -41,14 +47,17 @@ public:
   uint32_t getOffset(const char *Str, unsigned Length) {
     assert(strlen(Str) + 1 == Length && "Ensure length hint is correct");
 
-    auto Pair = Pool.insert(std::make_pair(Str, Offset));
-    if (Pair.second) {
-      Out.SwitchSection(Sec);
-      Out.EmitBytes(StringRef(Str, Length));
-      Offset += Length;
-    }
+    auto It = Pool.find(Str);
+    if (It != Pool.end())
+      return It->second;
 
-    return Pair.first->second;
+    uint32_t StrOffset = Offset;
+    Pool.insert(std::make_pair(
+        Saver.save(StringRef(Str, Length - 1)).data(), StrOffset));
+    Out.SwitchSection(Sec);
+    Out.EmitBytes(StringRef(Str, Length));
+    Offset += Length;
+    return StrOffset;
   }
 };
 }
@@ -39,6 +39,8 @@
 #include "llvm/Support/Path.h"
 #include "llvm/Support/TargetRegistry.h"
 #include "llvm/Support/TargetSelect.h"
+#include "llvm/Support/ThreadPool.h"
+#include "llvm/Support/Threading.h"
 #include "llvm/Support/ToolOutputFile.h"
 #include "llvm/Support/WithColor.h"
 #include "llvm/Support/raw_ostream.h"
@@ -61,6 +63,12 @@ static cl::opt<std::string> OutputFilename(cl::Required, "o",
                                            cl::value_desc("filename"),
                                            cl::cat(DwpCategory));
 
+static cl::opt<unsigned>
+    NumThreads("num-threads",
+               cl::desc("Specify the maximum number (n) of input files to read "
+                        "simultaneously (0 = the number of cores)"),
+               cl::init(0), cl::cat(DwpCategory));
+
 static void writeStringsAndOffsets(MCStreamer &Out, DWPStringPool &Strings,
                                    MCSection *StrOffsetSection,
                                    StringRef CurStrSection,
@@ -389,40 +397,66 @@ handleCompressedSection(std::deque<SmallString<32>> &UncompressedSections,
   return Error::success();
 }
 
-static Error handleSection(
-    const StringMap<std::pair<MCSection *, DWARFSectionKind>> &KnownSections,
-    const MCSection *StrSection, const MCSection *StrOffsetSection,
-    const MCSection *TypesSection, const MCSection *CUIndexSection,
-    const MCSection *TUIndexSection, const SectionRef &Section, MCStreamer &Out,
-    std::deque<SmallString<32>> &UncompressedSections,
-    uint32_t (&ContributionOffsets)[8], UnitIndexEntry &CurEntry,
-    StringRef &CurStrSection, StringRef &CurStrOffsetSection,
-    std::vector<StringRef> &CurTypesSection, StringRef &InfoSection,
-    StringRef &AbbrevSection, StringRef &CurCUIndexSection,
-    StringRef &CurTUIndexSection) {
-  if (Section.isBSS())
-    return Error::success();
+typedef StringMap<std::pair<MCSection *, DWARFSectionKind>> KnownSectionsTy;
 
-  if (Section.isVirtual())
-    return Error::success();
+/// An input .dwo or .dwp file, along with the contents of its known sections.
+struct InputDWO {
+  OwningBinary<object::ObjectFile> Obj;
+  /// The storage for the sections which had to be decompressed.
+  std::deque<SmallString<32>> UncompressedSections;
+  /// The names, without the leading "._", and contents of the known sections.
+  std::vector<std::pair<StringRef, StringRef>> Sections;
+};
 
-  StringRef Name;
-  if (std::error_code Err = Section.getName(Name))
-    return errorCodeToError(Err);
+/// Open \p Input and extract its known sections into \p DWO. This doesn't
+/// touch the output, so several inputs can be loaded concurrently.
+static Error loadInput(StringRef Input, const KnownSectionsTy &KnownSections,
+                       InputDWO &DWO) {
+  auto ErrOrObj = object::ObjectFile::createObjectFile(Input);
+  if (!ErrOrObj)
+    return ErrOrObj.takeError();
+  DWO.Obj = std::move(*ErrOrObj);
+
+  for (const auto &Section : DWO.Obj.getBinary()->sections()) {
+    if (Section.isBSS())
+      continue;
+
+    if (Section.isVirtual())
+      continue;
+
+    StringRef Name;
+    if (std::error_code Err = Section.getName(Name))
+      return errorCodeToError(Err);
+
+    Expected<StringRef> ContentsOrErr = Section.getContents();
+    if (!ContentsOrErr)
+      return ContentsOrErr.takeError();
+    StringRef Contents = *ContentsOrErr;
 
-  Expected<StringRef> ContentsOrErr = Section.getContents();
-  if (!ContentsOrErr)
-    return ContentsOrErr.takeError();
-  StringRef Contents = *ContentsOrErr;
+    if (auto Err =
+            handleCompressedSection(DWO.UncompressedSections, Name, Contents))
+      return Err;
 
-  if (auto Err = handleCompressedSection(UncompressedSections, Name, Contents))
-    return Err;
+    Name = Name.substr(Name.find_first_not_of("._"));
 
-  Name = Name.substr(Name.find_first_not_of("._"));
+    if (KnownSections.count(Name))
+      DWO.Sections.emplace_back(Name, Contents);
+  }
+  return Error::success();
+}
 
+static void handleSection(
+    const KnownSectionsTy &KnownSections, const MCSection *StrSection,
+    const MCSection *StrOffsetSection, const MCSection *TypesSection,
+    const MCSection *CUIndexSection, const MCSection *TUIndexSection,
+    StringRef Name, StringRef Contents, MCStreamer &Out,
+    uint32_t (&ContributionOffsets)[8], UnitIndexEntry &CurEntry,
+    StringRef &CurStrSection, StringRef &CurStrOffsetSection,
+    std::vector<StringRef> &CurTypesSection, StringRef &InfoSection,
+    StringRef &AbbrevSection, StringRef &CurCUIndexSection,
+    StringRef &CurTUIndexSection) {
   auto SectionPair = KnownSections.find(Name);
-  if (SectionPair == KnownSections.end())
-    return Error::success();
+  assert(SectionPair != KnownSections.end() && "Unknown section");
 
   if (DWARFSectionKind Kind = SectionPair->second.second) {
     auto Index = Kind - DW_SECT_INFO;
@@ -459,7 +493,6 @@ static Error handleSection(
     Out.SwitchSection(OutSection);
     Out.EmitBytes(Contents);
   }
-  return Error::success();
 }
 
 static Error
@@ -508,7 +541,7 @@ static Error write(MCStreamer &Out, ArrayRef<std::string> Inputs) {
   MCSection *const TypesSection = MCOFI.getDwarfTypesDWOSection();
   MCSection *const CUIndexSection = MCOFI.getDwarfCUIndexSection();
   MCSection *const TUIndexSection = MCOFI.getDwarfTUIndexSection();
-  const StringMap<std::pair<MCSection *, DWARFSectionKind>> KnownSections = {
+  const KnownSectionsTy KnownSections = {
       {"debug_info.dwo", {MCOFI.getDwarfInfoDWOSection(), DW_SECT_INFO}},
       {"debug_types.dwo", {MCOFI.getDwarfTypesDWOSection(), DW_SECT_TYPES}},
       {"debug_str_offsets.dwo", {StrOffsetSection, DW_SECT_STR_OFFSETS}},
@@ -526,19 +559,10 @@ static Error write(MCStreamer &Out, ArrayRef<std::string> Inputs) {
 
   DWPStringPool Strings(Out, StrSection);
 
-  SmallVector<OwningBinary<object::ObjectFile>, 128> Objects;
-  Objects.reserve(Inputs.size());
-
-  std::deque<SmallString<32>> UncompressedSections;
-
-  for (const auto &Input : Inputs) {
-    auto ErrOrObj = object::ObjectFile::createObjectFile(Input);
-    if (!ErrOrObj)
-      return ErrOrObj.takeError();
-
-    auto &Obj = *ErrOrObj->getBinary();
-    Objects.push_back(std::move(*ErrOrObj));
-
+  // Merge a loaded input into the output. The inputs are merged in order, so
+  // that the output doesn't depend on the order in which they were loaded.
+  auto MergeInput = [&](StringRef Input, const InputDWO &DWO) -> Error {
+    const ObjectFile &Obj = *DWO.Obj.getBinary();
     UnitIndexEntry CurEntry = {};
 
     StringRef CurStrSection;
@@ -549,17 +573,16 @@ static Error write(MCStreamer &Out, ArrayRef<std::string> Inputs) {
     StringRef CurCUIndexSection;
     StringRef CurTUIndexSection;
 
-    for (const auto &Section : Obj.sections())
-      if (auto Err = handleSection(
-              KnownSections, StrSection, StrOffsetSection, TypesSection,
-              CUIndexSection, TUIndexSection, Section, Out,
-              UncompressedSections, ContributionOffsets, CurEntry,
-              CurStrSection, CurStrOffsetSection, CurTypesSection, InfoSection,
-              AbbrevSection, CurCUIndexSection, CurTUIndexSection))
-        return Err;
+    for (const auto &Section : DWO.Sections)
+      handleSection(KnownSections, StrSection, StrOffsetSection, TypesSection,
+                    CUIndexSection, TUIndexSection, Section.first,
+                    Section.second, Out, ContributionOffsets, CurEntry,
+                    CurStrSection, CurStrOffsetSection, CurTypesSection,
+                    InfoSection, AbbrevSection, CurCUIndexSection,
+                    CurTUIndexSection);
 
     if (InfoSection.empty())
-      continue;
+      return Error::success();
 
     writeStringsAndOffsets(Out, Strings, StrOffsetSection, CurStrSection,
                            CurStrOffsetSection);
@@ -577,7 +600,7 @@ static Error write(MCStreamer &Out, ArrayRef<std::string> Inputs) {
       P.first->second.DWOName = ID.DWOName;
       addAllTypes(Out, TypeIndexEntries, TypesSection, CurTypesSection,
                   CurEntry, ContributionOffsets[DW_SECT_TYPES - DW_SECT_INFO]);
-      continue;
+      return Error::success();
     }
 
     DWARFUnitIndex CUIndex(DW_SECT_INFO);
@@ -623,6 +646,42 @@ static Error write(MCStreamer &Out, ArrayRef<std::string> Inputs) {
                          CurTypesSection.front(), CurEntry,
                          ContributionOffsets[DW_SECT_TYPES - DW_SECT_INFO]);
     }
+    return Error::success();
+  };
+
+  // Reading and decompressing the inputs is done in parallel, a batch at a
+  // time. Only the inputs of the current batch are kept in memory: the output
+  // streamer and the string pool keep copies of what they need.
+  unsigned Threads = NumThreads;
+  if (Threads == 0)
+    Threads = heavyweight_hardware_concurrency();
+  Threads = std::max(1U, std::min(Threads, unsigned(Inputs.size())));
+  const size_t BatchSize = 4 * Threads;
+  ThreadPool Pool(Threads);
+
+  for (size_t Begin = 0, E = Inputs.size(); Begin < E; Begin += BatchSize) {
+    ArrayRef<std::string> Batch =
+        Inputs.slice(Begin, std::min(BatchSize, E - Begin));
+    std::vector<InputDWO> DWOs(Batch.size());
+    std::vector<Optional<Error>> Errors(Batch.size());
+    for (size_t I = 0, N = Batch.size(); I != N; ++I)
+      Pool.async([&, I]() {
+        Errors[I] = loadInput(Batch[I], KnownSections, DWOs[I]);
+      });
+    Pool.wait();
+
+    for (size_t I = 0, N = Batch.size(); I != N; ++I) {
+      Error Err = std::move(*Errors[I]);
+      if (!Err)
+        Err = MergeInput(Batch[I], DWOs[I]);
+      if (Err) {
+        for (size_t J = I + 1; J != N; ++J)
+          consumeError(std::move(*Errors[J]));
+        return Err;
+      }
+      // The contents of this input are no longer needed.
+      DWOs[I] = InputDWO();
+    }
   }
 
   // Lie about there being no info contributions so the TU index only includes
@@ -7,6 +7,7 @@
 //===----------------------------------------------------------------------===//
 
 #include <array>
+#include <mutex>
 #include <string>
 
 #include "Assembler.h"
@@ -46,6 +47,31 @@ GenerateInstructions(const BenchmarkCode &BC, const size_t MinInstructions) {
 }
 
 namespace {
+// Enables crash recovery while at least one snippet runs. CrashRecoveryContext
+// handlers are process-wide, so a snippet that is done must not disable them
+// while snippets that run on other threads still rely on them.
+class ScopedCrashRecovery {
+public:
+  ScopedCrashRecovery() {
+    std::lock_guard<std::mutex> Lock(Mutex);
+    if (NumUsers++ == 0)
+      llvm::CrashRecoveryContext::Enable();
+  }
+
+  ~ScopedCrashRecovery() {
+    std::lock_guard<std::mutex> Lock(Mutex);
+    if (--NumUsers == 0)
+      llvm::CrashRecoveryContext::Disable();
+  }
+
+private:
+  static std::mutex Mutex;
+  static unsigned NumUsers;
+};
+
+std::mutex ScopedCrashRecovery::Mutex;
+unsigned ScopedCrashRecovery::NumUsers = 0;
+
 class FunctionExecutorImpl : public BenchmarkRunner::FunctionExecutor {
 public:
   FunctionExecutorImpl(const LLVMState &State,
@@ -73,13 +99,12 @@ private:
       Scratch->clear();
       {
         llvm::CrashRecoveryContext CRC;
-        llvm::CrashRecoveryContext::Enable();
+        const ScopedCrashRecovery EnableCrashRecovery;
         const bool Crashed = !CRC.RunSafely([this, &Counter, ScratchPtr]() {
           Counter.start();
           this->Function(ScratchPtr);
           Counter.stop();
         });
-        llvm::CrashRecoveryContext::Disable();
         // FIXME: Better diagnosis.
         if (Crashed)
           return llvm::make_error<BenchmarkFailure>(
@@ -35,9 +35,16 @@
 #include "llvm/Support/SourceMgr.h"
 #include "llvm/Support/TargetRegistry.h"
 #include "llvm/Support/TargetSelect.h"
+#include "llvm/Support/ThreadPool.h"
+#include "llvm/Support/Threading.h"
 #include <algorithm>
+#include <atomic>
 #include <string>
 
+#ifdef __linux__
+#include <sched.h>
+#endif
+
 namespace llvm {
 namespace exegesis {
 
@@ -85,6 +92,19 @@ static cl::opt<unsigned>
                    cl::desc("number of time to repeat the asm snippet"),
                    cl::cat(BenchmarkOptions), cl::init(10000));
 
+static cl::opt<unsigned> NumThreads(
+    "num-threads",
+    cl::desc("number of threads that run benchmarks concurrently, each pinned "
+             "to a CPU of its own where supported (0 = one per core)"),
+    cl::cat(BenchmarkOptions), cl::init(1));
+
+static cl::opt<bool> AppendToBenchmarkFile(
+    "append-to-benchmarks-file",
+    cl::desc("append the benchmark results to --benchmarks-file instead of "
+             "overwriting it, e.g. to gather the results of the latency, uops "
+             "and inverse_throughput modes in one file"),
+    cl::cat(BenchmarkOptions), cl::init(false));
+
 static cl::opt<bool> IgnoreInvalidSchedClass(
     "ignore-invalid-sched-class",
     cl::desc("ignore instructions that do not define a sched class"),
@@ -355,6 +375,76 @@ readSnippets(const LLVMState &State, llvm::StringRef Filename) {
   return std::vector<BenchmarkCode>{std::move(Result)};
 }
 
+// Returns the CPUs that this process may run on, in increasing order, or {}
+// if threads cannot be pinned on this host.
+static std::vector<unsigned> getAllowedCpus() {
+  std::vector<unsigned> Cpus;
+#ifdef __linux__
+  cpu_set_t Set;
+  if (sched_getaffinity(0, sizeof(Set), &Set) == 0)
+    for (unsigned Cpu = 0; Cpu < CPU_SETSIZE; ++Cpu)
+      if (CPU_ISSET(Cpu, &Set))
+        Cpus.push_back(Cpu);
+#endif
+  return Cpus;
+}
+
+// Pins the calling thread to CPU `Cpu`, so that the benchmarks that it runs do
+// not migrate or share a core with the benchmarks of another thread.
+static void pinCurrentThreadToCpu(unsigned Cpu) {
+#ifdef __linux__
+  cpu_set_t Set;
+  CPU_ZERO(&Set);
+  CPU_SET(Cpu, &Set);
+  if (sched_setaffinity(0, sizeof(Set), &Set) != 0)
+    llvm::errs() << "cannot pin benchmark thread to cpu " << Cpu << "\n";
+#endif
+}
+
+// Runs all the `Configurations` on `NumWorkers` threads, and returns the
+// results in the order of the configurations.
+static std::vector<InstructionBenchmark>
+runConfigurations(const LLVMState &State,
+                  llvm::ArrayRef<BenchmarkCode> Configurations,
+                  unsigned NumWorkers) {
+  std::vector<InstructionBenchmark> Results(Configurations.size());
+  const auto RunWorker = [&](std::atomic<size_t> &NextConf,
+                             const BenchmarkRunner &Runner) {
+    for (size_t I = NextConf++; I < Configurations.size(); I = NextConf++)
+      Results[I] = Runner.runConfiguration(Configurations[I], NumRepetitions,
+                                           DumpObjectToDisk);
+  };
+
+  const auto CreateRunner = [&State]() {
+    std::unique_ptr<BenchmarkRunner> Runner =
+        State.getExegesisTarget().createBenchmarkRunner(BenchmarkMode, State);
+    if (!Runner)
+      llvm::report_fatal_error("cannot create benchmark runner");
+    return Runner;
+  };
+
+  std::atomic<size_t> NextConf(0);
+  if (NumWorkers <= 1) {
+    RunWorker(NextConf, *CreateRunner());
+    return Results;
+  }
+
+  // Each thread gets a runner of its own, as runners own the scratch space of
+  // the snippets.
+  const std::vector<unsigned> Cpus = getAllowedCpus();
+  llvm::ThreadPool Pool(NumWorkers);
+  for (unsigned W = 0; W < NumWorkers; ++W) {
+    std::shared_ptr<BenchmarkRunner> Runner = CreateRunner();
+    Pool.async([&, W, Runner]() {
+      if (!Cpus.empty())
+        pinCurrentThreadToCpu(Cpus[W % Cpus.size()]);
+      RunWorker(NextConf, *Runner);
+    });
+  }
+  Pool.wait();
+  return Results;
+}
+
 void benchmarkMain() {
 #ifndef HAVE_LIBPFM
   llvm::report_fatal_error(
@@ -397,24 +487,41 @@ void benchmarkMain() {
     Configurations = ExitOnErr(readSnippets(State, SnippetsFile));
   }
 
-  const std::unique_ptr<BenchmarkRunner> Runner =
-      State.getExegesisTarget().createBenchmarkRunner(BenchmarkMode, State);
-  if (!Runner) {
-    llvm::report_fatal_error("cannot create benchmark runner");
-  }
-
   if (NumRepetitions == 0)
     llvm::report_fatal_error("--num-repetitions must be greater than zero");
 
+  const unsigned NumWorkers = NumThreads
+                                  ? NumThreads.getValue()
+                                  : llvm::heavyweight_hardware_concurrency();
+  if (NumWorkers > 1) {
+    // Concurrent runs would interleave their messages on stdout.
+    if (DumpObjectToDisk.getNumOccurrences() && DumpObjectToDisk)
+      llvm::report_fatal_error(
+          "--dump-object-to-disk cannot be used with --num-threads > 1");
+    DumpObjectToDisk = false;
+  }
+
   // Write to standard output if file is not set.
   if (BenchmarkFile.empty())
     BenchmarkFile = "-";
 
-  for (const BenchmarkCode &Conf : Configurations) {
-    InstructionBenchmark Result =
-        Runner->runConfiguration(Conf, NumRepetitions, DumpObjectToDisk);
-    ExitOnErr(Result.writeYaml(State, BenchmarkFile));
+  // Open the file once, so that it holds the results of all configurations.
+  std::unique_ptr<llvm::raw_fd_ostream> FileOS;
+  if (BenchmarkFile != "-") {
+    std::error_code EC;
+    FileOS = llvm::make_unique<llvm::raw_fd_ostream>(
+        BenchmarkFile, EC,
+        AppendToBenchmarkFile ? llvm::sys::fs::F_Append
+                              : llvm::sys::fs::F_Text);
+    if (EC)
+      llvm::report_fatal_error("cannot open benchmarks file: " + BenchmarkFile +
+                               ": " + EC.message());
   }
+  llvm::raw_ostream &OS = FileOS ? *FileOS : llvm::outs();
+
+  for (InstructionBenchmark &Result :
+       runConfigurations(State, Configurations, NumWorkers))
+    ExitOnErr(Result.writeYamlTo(State, OS));
   exegesis::pfm::pfmTerminate();
 }
 
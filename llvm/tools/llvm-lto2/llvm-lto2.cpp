@@ -68,6 +68,16 @@ static cl::opt<bool>
 static cl::opt<int> Threads("thinlto-threads",
                             cl::init(llvm::heavyweight_hardware_concurrency()));
 
+static cl::opt<ThreadAffinity> ThreadPlacement(
+    "thinlto-thread-affinity", cl::desc("Placement of the ThinLTO threads"),
+    cl::init(ThreadAffinity::None),
+    cl::values(clEnumValN(ThreadAffinity::None, "none",
+                          "Let the operating system place the threads"),
+               clEnumValN(ThreadAffinity::Compact, "compact",
+                          "Fill a NUMA node before using the next one"),
+               clEnumValN(ThreadAffinity::Spread, "spread",
+                          "Spread the threads over all the NUMA nodes")));
+
 static cl::list<std::string> SymbolResolutions(
     "r",
     cl::desc("Specify a symbol resolution: filename,symbolname,resolution\n"
@@ -272,14 +282,18 @@ static int run(int argc, char **argv) {
   Conf.StatsFile = StatsFile;
 
   ThinBackend Backend;
-  if (ThinLTODistributedIndexes)
+  if (ThinLTODistributedIndexes) {
     Backend = createWriteIndexesThinBackend(/* OldPrefix */ "",
                                             /* NewPrefix */ "",
                                             /* ShouldEmitImportsFiles */ true,
                                             /* LinkedObjectsFile */ nullptr,
                                             /* OnWrite */ {});
-  else
-    Backend = createInProcessThinBackend(Threads);
+  } else {
+    ThreadPoolStrategy Parallelism;
+    Parallelism.ThreadsRequested = Threads;
+    Parallelism.Affinity = ThreadPlacement;
+    Backend = createInProcessThinBackend(Parallelism);
+  }
   LTO Lto(std::move(Conf), std::move(Backend));
 
   bool HasErrors = false;
@@ -46,11 +46,15 @@
 #include "llvm/Support/ErrorOr.h"
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/Host.h"
+#include "llvm/Support/FormatVariadic.h"
 #include "llvm/Support/InitLLVM.h"
+#include "llvm/Support/JSON.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/SourceMgr.h"
 #include "llvm/Support/TargetRegistry.h"
 #include "llvm/Support/TargetSelect.h"
+#include "llvm/Support/ThreadPool.h"
+#include "llvm/Support/Threading.h"
 #include "llvm/Support/ToolOutputFile.h"
 #include "llvm/Support/WithColor.h"
 
@@ -193,6 +197,18 @@ static cl::opt<bool> EnableBottleneckAnalysis(
     cl::desc("Enable bottleneck analysis (disabled by default)"),
     cl::cat(ViewOptions), cl::init(false));
 
+static cl::opt<bool>
+    PrintJSON("json",
+              cl::desc("Print the summary view of each code region as JSON, "
+                       "instead of the other views"),
+              cl::cat(ViewOptions), cl::init(false));
+
+static cl::opt<unsigned>
+    NumJobs("jobs",
+            cl::desc("Number of code regions to simulate in parallel (0 = "
+                     "number of hardware threads)"),
+            cl::cat(ToolOptions), cl::init(1));
+
 namespace {
 
 const Target *getTarget(const char *ProgName) {
@@ -264,6 +280,161 @@ static bool runPipeline(mca::Pipeline &P) {
   return true;
 }
 
+namespace {
+
+/// Simulates code regions. The target state is shared and only read, while
+/// every region gets its own instruction builder, hardware context and
+/// printer, so that several threads can analyze regions at once.
+class RegionAnalyzer {
+public:
+  RegionAnalyzer(const Target &TheTarget, const MCSubtargetInfo &STI,
+                 const MCInstrInfo &MCII, const MCRegisterInfo &MRI,
+                 const MCAsmInfo &MAI, unsigned AssemblerDialect,
+                 const mca::PipelineOptions &PO)
+      : TheTarget(TheTarget), STI(STI), MCII(MCII), MRI(MRI), MAI(MAI),
+        AssemblerDialect(AssemblerDialect), PO(PO) {}
+
+  /// Simulates \p Region, and prints its report to \p OS. If \p Summary is
+  /// not null, only the summary view is computed, and stored in \p Summary.
+  /// Returns true on success.
+  bool analyze(const mca::CodeRegion &Region, raw_ostream &OS,
+               json::Value *Summary) const;
+
+private:
+  const Target &TheTarget;
+  const MCSubtargetInfo &STI;
+  const MCInstrInfo &MCII;
+  const MCRegisterInfo &MRI;
+  const MCAsmInfo &MAI;
+  unsigned AssemblerDialect;
+  const mca::PipelineOptions &PO;
+};
+
+} // end of anonymous namespace
+
+bool RegionAnalyzer::analyze(const mca::CodeRegion &Region, raw_ostream &OS,
+                             json::Value *Summary) const {
+  std::unique_ptr<MCInstPrinter> IP(TheTarget.createMCInstPrinter(
+      STI.getTargetTriple(), AssemblerDialect, MAI, MCII, MRI));
+  std::unique_ptr<MCInstrAnalysis> MCIA(
+      TheTarget.createMCInstrAnalysis(&MCII));
+
+  const MCSchedModel &SM = STI.getSchedModel();
+
+  // Create an instruction builder.
+  mca::InstrBuilder IB(STI, MCII, MRI, MCIA.get());
+
+  // Create a context to control ownership of the pipeline hardware.
+  mca::Context MCA(MRI, STI);
+
+  // Lower the MCInst sequence into an mca::Instruction sequence.
+  ArrayRef<MCInst> Insts = Region.getInstructions();
+  std::vector<std::unique_ptr<mca::Instruction>> LoweredSequence;
+  for (const MCInst &MCI : Insts) {
+    Expected<std::unique_ptr<mca::Instruction>> Inst =
+        IB.createInstruction(MCI);
+    if (!Inst) {
+      if (auto NewE = handleErrors(
+              Inst.takeError(),
+              [this, &IP](const mca::InstructionError<MCInst> &IE) {
+                std::string InstructionStr;
+                raw_string_ostream SS(InstructionStr);
+                WithColor::error() << IE.Message << '\n';
+                IP->printInst(&IE.Inst, SS, "", STI);
+                SS.flush();
+                WithColor::note() << "instruction: " << InstructionStr << '\n';
+              })) {
+        // Default case.
+        WithColor::error() << toString(std::move(NewE));
+      }
+      return false;
+    }
+
+    LoweredSequence.emplace_back(std::move(Inst.get()));
+  }
+
+  mca::SourceMgr S(LoweredSequence, PrintInstructionTables ? 1 : Iterations);
+
+  if (PrintInstructionTables) {
+    //  Create a pipeline, stages, and a printer.
+    auto P = llvm::make_unique<mca::Pipeline>();
+    P->appendStage(llvm::make_unique<mca::EntryStage>(S));
+    P->appendStage(llvm::make_unique<mca::InstructionTables>(SM));
+    mca::PipelinePrinter Printer(*P);
+
+    // Create the views for this pipeline, execute, and emit a report.
+    if (PrintInstructionInfoView) {
+      Printer.addView(
+          llvm::make_unique<mca::InstructionInfoView>(STI, MCII, Insts, *IP));
+    }
+    Printer.addView(
+        llvm::make_unique<mca::ResourcePressureView>(STI, *IP, Insts));
+
+    if (!runPipeline(*P))
+      return false;
+
+    Printer.printReport(OS);
+    return true;
+  }
+
+  // Create a basic pipeline simulating an out-of-order backend.
+  auto P = MCA.createDefaultPipeline(PO, IB, S);
+  mca::PipelinePrinter Printer(*P);
+
+  if (Summary) {
+    auto SV = llvm::make_unique<mca::SummaryView>(SM, Insts, DispatchWidth);
+    auto &SummaryV = *SV;
+    Printer.addView(std::move(SV));
+    if (!runPipeline(*P))
+      return false;
+    *Summary = SummaryV.toJSON();
+    return true;
+  }
+
+  if (PrintSummaryView)
+    Printer.addView(
+        llvm::make_unique<mca::SummaryView>(SM, Insts, DispatchWidth));
+
+  if (EnableBottleneckAnalysis) {
+    Printer.addView(llvm::make_unique<mca::BottleneckAnalysis>(
+        STI, *IP, Insts, S.getNumIterations()));
+  }
+
+  if (PrintInstructionInfoView)
+    Printer.addView(
+        llvm::make_unique<mca::InstructionInfoView>(STI, MCII, Insts, *IP));
+
+  if (PrintDispatchStats)
+    Printer.addView(llvm::make_unique<mca::DispatchStatistics>());
+
+  if (PrintSchedulerStats)
+    Printer.addView(llvm::make_unique<mca::SchedulerStatistics>(STI));
+
+  if (PrintRetireStats)
+    Printer.addView(llvm::make_unique<mca::RetireControlUnitStatistics>(SM));
+
+  if (PrintRegisterFileStats)
+    Printer.addView(llvm::make_unique<mca::RegisterFileStatistics>(STI));
+
+  if (PrintResourcePressureView)
+    Printer.addView(
+        llvm::make_unique<mca::ResourcePressureView>(STI, *IP, Insts));
+
+  if (PrintTimelineView) {
+    unsigned TimelineIterations =
+        TimelineMaxIterations ? TimelineMaxIterations : 10;
+    Printer.addView(llvm::make_unique<mca::TimelineView>(
+        STI, *IP, Insts, std::min(TimelineIterations, S.getNumIterations()),
+        TimelineMaxCycles));
+  }
+
+  if (!runPipeline(*P))
+    return false;
+
+  Printer.printReport(OS);
+  return true;
+}
+
 int main(int argc, char **argv) {
   InitLLVM X(argc, argv);
 
@@ -303,6 +474,11 @@ int main(int argc, char **argv) {
   // Apply overrides to llvm-mca specific options.
   processViewOptions();
 
+  if (PrintJSON && PrintInstructionTables) {
+    WithColor::error() << "-json can not be used with -instruction-tables.\n";
+    return 1;
+  }
+
   SourceMgr SrcMgr;
 
   // Tell SrcMgr about this buffer, which is what the parser will pick up.
@@ -322,9 +498,6 @@ int main(int argc, char **argv) {
 
   std::unique_ptr<MCInstrInfo> MCII(TheTarget->createMCInstrInfo());
 
-  std::unique_ptr<MCInstrAnalysis> MCIA(
-      TheTarget->createMCInstrAnalysis(MCII.get()));
-
   if (!MCPU.compare("native"))
     MCPU = llvm::sys::getHostCPUName();
 
@@ -398,137 +571,80 @@ int main(int argc, char **argv) {
 
   std::unique_ptr<ToolOutputFile> TOF = std::move(*OF);
 
-  const MCSchedModel &SM = STI->getSchedModel();
-
-  // Create an instruction builder.
-  mca::InstrBuilder IB(*STI, *MCII, *MRI, MCIA.get());
-
-  // Create a context to control ownership of the pipeline hardware.
-  mca::Context MCA(*MRI, *STI);
-
   mca::PipelineOptions PO(MicroOpQueue, DecoderThroughput, DispatchWidth,
                           RegisterFileSize, LoadQueueSize, StoreQueueSize,
                           AssumeNoAlias, EnableBottleneckAnalysis);
 
-  // Number each region in the sequence.
+  // Number each region in the sequence, and give each non-empty region a
+  // report of its own, so that the regions can be simulated independently.
+  std::vector<const mca::CodeRegion *> RegionsToAnalyze;
+  std::vector<std::string> Reports;
   unsigned RegionIdx = 0;
-
   for (const std::unique_ptr<mca::CodeRegion> &Region : Regions) {
     // Skip empty code regions.
     if (Region->empty())
       continue;
 
+    RegionsToAnalyze.push_back(Region.get());
+    Reports.emplace_back();
+
     // Don't print the header of this region if it is the default region, and
     // it doesn't have an end location.
-    if (Region->startLoc().isValid() || Region->endLoc().isValid()) {
-      TOF->os() << "\n[" << RegionIdx++ << "] Code Region";
-      StringRef Desc = Region->getDescription();
-      if (!Desc.empty())
-        TOF->os() << " - " << Desc;
-      TOF->os() << "\n\n";
-    }
-
-    // Lower the MCInst sequence into an mca::Instruction sequence.
-    ArrayRef<MCInst> Insts = Region->getInstructions();
-    std::vector<std::unique_ptr<mca::Instruction>> LoweredSequence;
-    for (const MCInst &MCI : Insts) {
-      Expected<std::unique_ptr<mca::Instruction>> Inst =
-          IB.createInstruction(MCI);
-      if (!Inst) {
-        if (auto NewE = handleErrors(
-                Inst.takeError(),
-                [&IP, &STI](const mca::InstructionError<MCInst> &IE) {
-                  std::string InstructionStr;
-                  raw_string_ostream SS(InstructionStr);
-                  WithColor::error() << IE.Message << '\n';
-                  IP->printInst(&IE.Inst, SS, "", *STI);
-                  SS.flush();
-                  WithColor::note()
-                      << "instruction: " << InstructionStr << '\n';
-                })) {
-          // Default case.
-          WithColor::error() << toString(std::move(NewE));
-        }
-        return 1;
-      }
-
-      LoweredSequence.emplace_back(std::move(Inst.get()));
-    }
-
-    mca::SourceMgr S(LoweredSequence, PrintInstructionTables ? 1 : Iterations);
-
-    if (PrintInstructionTables) {
-      //  Create a pipeline, stages, and a printer.
-      auto P = llvm::make_unique<mca::Pipeline>();
-      P->appendStage(llvm::make_unique<mca::EntryStage>(S));
-      P->appendStage(llvm::make_unique<mca::InstructionTables>(SM));
-      mca::PipelinePrinter Printer(*P);
-
-      // Create the views for this pipeline, execute, and emit a report.
-      if (PrintInstructionInfoView) {
-        Printer.addView(llvm::make_unique<mca::InstructionInfoView>(
-            *STI, *MCII, Insts, *IP));
-      }
-      Printer.addView(
-          llvm::make_unique<mca::ResourcePressureView>(*STI, *IP, Insts));
-
-      if (!runPipeline(*P))
-        return 1;
-
-      Printer.printReport(TOF->os());
+    if (PrintJSON ||
+        (!Region->startLoc().isValid() && !Region->endLoc().isValid()))
       continue;
-    }
-
-    // Create a basic pipeline simulating an out-of-order backend.
-    auto P = MCA.createDefaultPipeline(PO, IB, S);
-    mca::PipelinePrinter Printer(*P);
-
-    if (PrintSummaryView)
-      Printer.addView(
-          llvm::make_unique<mca::SummaryView>(SM, Insts, DispatchWidth));
-
-    if (EnableBottleneckAnalysis) {
-      Printer.addView(llvm::make_unique<mca::BottleneckAnalysis>(
-          *STI, *IP, Insts, S.getNumIterations()));
-    }
-
-    if (PrintInstructionInfoView)
-      Printer.addView(
-          llvm::make_unique<mca::InstructionInfoView>(*STI, *MCII, Insts, *IP));
-
-    if (PrintDispatchStats)
-      Printer.addView(llvm::make_unique<mca::DispatchStatistics>());
-
-    if (PrintSchedulerStats)
-      Printer.addView(llvm::make_unique<mca::SchedulerStatistics>(*STI));
-
-    if (PrintRetireStats)
-      Printer.addView(llvm::make_unique<mca::RetireControlUnitStatistics>(SM));
-
-    if (PrintRegisterFileStats)
-      Printer.addView(llvm::make_unique<mca::RegisterFileStatistics>(*STI));
+    raw_string_ostream OS(Reports.back());
+    OS << "\n[" << RegionIdx++ << "] Code Region";
+    StringRef Desc = Region->getDescription();
+    if (!Desc.empty())
+      OS << " - " << Desc;
+    OS << "\n\n";
+  }
 
-    if (PrintResourcePressureView)
-      Printer.addView(
-          llvm::make_unique<mca::ResourcePressureView>(*STI, *IP, Insts));
-
-    if (PrintTimelineView) {
-      unsigned TimelineIterations =
-          TimelineMaxIterations ? TimelineMaxIterations : 10;
-      Printer.addView(llvm::make_unique<mca::TimelineView>(
-          *STI, *IP, Insts, std::min(TimelineIterations, S.getNumIterations()),
-          TimelineMaxCycles));
+  RegionAnalyzer Analyzer(*TheTarget, *STI, *MCII, *MRI, *MAI,
+                          AssemblerDialect, PO);
+  std::vector<json::Value> Summaries(RegionsToAnalyze.size(), nullptr);
+  // Not a vector<bool>, whose elements can not be written concurrently.
+  std::vector<char> Succeeded(RegionsToAnalyze.size(), false);
+  auto AnalyzeRegion = [&](unsigned I) {
+    raw_string_ostream OS(Reports[I]);
+    Succeeded[I] = Analyzer.analyze(*RegionsToAnalyze[I], OS,
+                                    PrintJSON ? &Summaries[I] : nullptr);
+  };
+
+  if (NumJobs == 1) {
+    for (unsigned I = 0, E = RegionsToAnalyze.size(); I != E; ++I) {
+      AnalyzeRegion(I);
+      if (!Succeeded[I])
+        break;
     }
+  } else {
+    ThreadPool Pool(NumJobs ? NumJobs : heavyweight_hardware_concurrency());
+    for (unsigned I = 0, E = RegionsToAnalyze.size(); I != E; ++I)
+      Pool.async(AnalyzeRegion, I);
+    Pool.wait();
+  }
 
-    if (!runPipeline(*P))
+  // Print the reports in the order of the regions, up to the first region
+  // that could not be analyzed.
+  json::Array JSONRegions;
+  for (unsigned I = 0, E = RegionsToAnalyze.size(); I != E; ++I) {
+    TOF->os() << Reports[I];
+    if (!Succeeded[I])
       return 1;
-
-    Printer.printReport(TOF->os());
-
-    // Clear the InstrBuilder internal state in preparation for another round.
-    IB.clear();
+    if (PrintJSON)
+      JSONRegions.push_back(
+          json::Object({{"Index", I},
+                        {"Name", RegionsToAnalyze[I]->getDescription()},
+                        {"SummaryView", std::move(Summaries[I])}}));
   }
 
+  if (PrintJSON)
+    TOF->os() << formatv("{0:2}",
+                         json::Value(json::Object(
+                             {{"CodeRegions", std::move(JSONRegions)}})))
+              << '\n';
+
   TOF->keep();
   return 0;
 }
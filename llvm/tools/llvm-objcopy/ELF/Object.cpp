@@ -20,6 +20,7 @@
 #include "llvm/Support/Endian.h"
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/FileOutputBuffer.h"
+#include "llvm/Support/Parallel.h"
 #include "llvm/Support/Path.h"
 #include <algorithm>
 #include <cstddef>
@@ -422,18 +423,34 @@ getDecompressedSizeAndAlignment(ArrayRef<uint8_t> Data) {
 
 template <class ELFT>
 void ELFSectionWriter<ELFT>::visit(const DecompressedSection &Sec) {
-  const size_t DataOffset = isDataGnuCompressed(Sec.OriginalData)
+  const bool IsGnuDebug = isDataGnuCompressed(Sec.OriginalData);
+  const size_t DataOffset = IsGnuDebug
                                 ? (ZlibGnuMagic.size() + sizeof(Sec.Size))
                                 : sizeof(Elf_Chdr_Impl<ELFT>);
+  const uint32_t ChType =
+      IsGnuDebug ? static_cast<uint32_t>(ELF::ELFCOMPRESS_ZLIB)
+                 : reinterpret_cast<const Elf_Chdr_Impl<ELFT> *>(
+                       Sec.OriginalData.data())
+                       ->ch_type;
 
   StringRef CompressedContent(
       reinterpret_cast<const char *>(Sec.OriginalData.data()) + DataOffset,
       Sec.OriginalData.size() - DataOffset);
 
   SmallVector<char, 128> DecompressedContent;
-  if (Error E = zlib::uncompress(CompressedContent, DecompressedContent,
-                                 static_cast<size_t>(Sec.Size)))
+  if (ChType == ELF::ELFCOMPRESS_ZSTD) {
+    if (!zstd::isAvailable())
+      reportError(Sec.Name,
+                  createStringError(errc::invalid_argument,
+                                    "LLVM was not compiled with "
+                                    "LLVM_ENABLE_ZSTD: cannot decompress"));
+    if (Error E = zstd::uncompress(CompressedContent, DecompressedContent,
+                                   static_cast<size_t>(Sec.Size)))
+      reportError(Sec.Name, std::move(E));
+  } else if (Error E = zlib::uncompress(CompressedContent, DecompressedContent,
+                                        static_cast<size_t>(Sec.Size))) {
     reportError(Sec.Name, std::move(E));
+  }
 
   uint8_t *Buf = Out.getBufferStart() + Sec.Offset;
   std::copy(DecompressedContent.begin(), DecompressedContent.end(), Buf);
@@ -490,7 +507,9 @@ void ELFSectionWriter<ELFT>::visit(const CompressedSection &Sec) {
     Buf += sizeof(DecompressedSize);
   } else {
     Elf_Chdr_Impl<ELFT> Chdr;
-    Chdr.ch_type = ELF::ELFCOMPRESS_ZLIB;
+    Chdr.ch_type = Sec.CompressionType == DebugCompressionType::Zstd
+                       ? ELF::ELFCOMPRESS_ZSTD
+                       : ELF::ELFCOMPRESS_ZLIB;
     Chdr.ch_size = Sec.DecompressedSize;
     Chdr.ch_addralign = Sec.DecompressedAlign;
     memcpy(Buf, &Chdr, sizeof(Chdr));
@@ -504,10 +523,11 @@ CompressedSection::CompressedSection(const SectionBase &Sec,
                                      DebugCompressionType CompressionType)
     : SectionBase(Sec), CompressionType(CompressionType),
       DecompressedSize(Sec.OriginalData.size()), DecompressedAlign(Sec.Align) {
-  if (Error E = zlib::compress(
-          StringRef(reinterpret_cast<const char *>(OriginalData.data()),
-                    OriginalData.size()),
-          CompressedData))
+  StringRef Data(reinterpret_cast<const char *>(OriginalData.data()),
+                 OriginalData.size());
+  if (Error E = CompressionType == DebugCompressionType::Zstd
+                    ? zstd::compress(Data, CompressedData)
+                    : zlib::compress(Data, CompressedData))
     reportError(Name, std::move(E));
 
   size_t ChdrSize;
@@ -1758,12 +1778,33 @@ template <class ELFT> void ELFWriter<ELFT>::writeShdrs() {
 }
 
 template <class ELFT> void ELFWriter<ELFT>::writeSectionData() {
-  for (SectionBase &Sec : Obj.sections())
-    // Segments are responsible for writing their contents, so only write the
-    // section data if the section is not in a segment. Note that this renders
-    // sections in segments effectively immutable.
-    if (Sec.ParentSegment == nullptr)
-      Sec.accept(*SecWriter);
+  // Sections that are not in a segment don't overlap, and writing one (e.g.
+  // decompressing it) doesn't depend on any other, so write them in
+  // parallel.
+  auto Sections = Obj.sections();
+  parallel::for_each(parallel::par, Sections.begin(), Sections.end(),
+                     [&](SectionBase &Sec) {
+                       // Segments are responsible for writing their contents,
+                       // so only write the section data if the section is not
+                       // in a segment. Note that this renders sections in
+                       // segments effectively immutable.
+                       if (Sec.ParentSegment == nullptr)
+                         Sec.accept(*SecWriter);
+                     });
+}
+
+// Copies Size bytes from Src to Dst. Segments of large executables can be
+// gigabytes in size, and copying them into a fresh output mapping with a
+// single memcpy is bound by the page faults taken by one thread, so large
+// copies are split into chunks that are copied in parallel.
+static void copyData(uint8_t *Dst, const uint8_t *Src, size_t Size) {
+  const size_t ChunkSize = 4 * 1024 * 1024;
+  size_t NumChunks = (Size + ChunkSize - 1) / ChunkSize;
+  parallel::for_each_n(parallel::par, size_t(0), NumChunks, [&](size_t I) {
+    size_t Offset = I * ChunkSize;
+    std::memcpy(Dst + Offset, Src + Offset,
+                std::min(ChunkSize, Size - Offset));
+  });
 }
 
 template <class ELFT> void ELFWriter<ELFT>::writeSegmentData() {
@@ -1771,7 +1812,7 @@ template <class ELFT> void ELFWriter<ELFT>::writeSegmentData() {
     uint8_t *B = Buf.getBufferStart() + Seg.Offset;
     assert(Seg.FileSize == Seg.getContents().size() &&
            "Segment size must match contents size");
-    std::memcpy(B, Seg.getContents().data(), Seg.FileSize);
+    copyData(B, Seg.getContents().data(), Seg.FileSize);
   }
 
   // Iterate over removed sections and overwrite their old data with zeroes.
@@ -59,9 +59,12 @@
 #include "llvm/Support/StringSaver.h"
 #include "llvm/Support/TargetRegistry.h"
 #include "llvm/Support/TargetSelect.h"
+#include "llvm/Support/ThreadPool.h"
+#include "llvm/Support/Threading.h"
 #include "llvm/Support/WithColor.h"
 #include "llvm/Support/raw_ostream.h"
 #include <algorithm>
+#include <atomic>
 #include <cctype>
 #include <cstring>
 #include <system_error>
@@ -302,6 +305,12 @@ static cl::alias PrintSourceShort("S", cl::desc("Alias for -source"),
                                   cl::NotHidden, cl::Grouping,
                                   cl::aliasopt(PrintSource));
 
+static cl::opt<unsigned> NumThreads(
+    "num-threads",
+    cl::desc("Number of threads to disassemble symbols with (0 = all the "
+             "hardware threads). The output is the same as with one thread"),
+    cl::init(1), cl::cat(ObjdumpCat));
+
 static cl::opt<uint64_t>
     StartAddress("start-address", cl::desc("Disassemble beginning at address"),
                  cl::value_desc("address"), cl::init(0), cl::cat(ObjdumpCat));
@@ -643,14 +652,14 @@ static bool hasMappingSymbols(const ObjectFile *Obj) {
   return isArmElf(Obj) || isAArch64Elf(Obj);
 }
 
-static void printRelocation(const RelocationRef &Rel, uint64_t Address,
-                            bool Is64Bits) {
+static void printRelocation(raw_ostream &OS, const RelocationRef &Rel,
+                            uint64_t Address, bool Is64Bits) {
   StringRef Fmt = Is64Bits ? "\t\t%016" PRIx64 ":  " : "\t\t\t%08" PRIx64 ":  ";
   SmallString<16> Name;
   SmallString<32> Val;
   Rel.getTypeName(Name);
   error(getRelocationValueString(Rel, Val));
-  outs() << format(Fmt.data(), Address) << Name << "\t" << Val << "\n";
+  OS << format(Fmt.data(), Address) << Name << "\t" << Val << "\n";
 }
 
 class PrettyPrinter {
@@ -736,7 +745,7 @@ public:
     auto PrintReloc = [&]() -> void {
       while ((RelCur != RelEnd) && (RelCur->getOffset() <= Address.Address)) {
         if (RelCur->getOffset() == Address.Address) {
-          printRelocation(*RelCur, Address.Address, false);
+          printRelocation(OS, *RelCur, Address.Address, false);
           return;
         }
         ++RelCur;
@@ -1006,40 +1015,40 @@ static char getMappingSymbolKind(ArrayRef<MappingSymbolPair> MappingSymbols,
 }
 
 static uint64_t
-dumpARMELFData(uint64_t SectionAddr, uint64_t Index, uint64_t End,
-               const ObjectFile *Obj, ArrayRef<uint8_t> Bytes,
+dumpARMELFData(raw_ostream &OS, uint64_t SectionAddr, uint64_t Index,
+               uint64_t End, const ObjectFile *Obj, ArrayRef<uint8_t> Bytes,
                ArrayRef<MappingSymbolPair> MappingSymbols) {
   support::endianness Endian =
       Obj->isLittleEndian() ? support::little : support::big;
   while (Index < End) {
-    outs() << format("%8" PRIx64 ":", SectionAddr + Index);
-    outs() << "\t";
+    OS << format("%8" PRIx64 ":", SectionAddr + Index);
+    OS << "\t";
     if (Index + 4 <= End) {
-      dumpBytes(Bytes.slice(Index, 4), outs());
-      outs() << "\t.word\t"
-             << format_hex(
-                    support::endian::read32(Bytes.data() + Index, Endian), 10);
+      dumpBytes(Bytes.slice(Index, 4), OS);
+      OS << "\t.word\t"
+         << format_hex(
+                support::endian::read32(Bytes.data() + Index, Endian), 10);
       Index += 4;
     } else if (Index + 2 <= End) {
-      dumpBytes(Bytes.slice(Index, 2), outs());
-      outs() << "\t\t.short\t"
-             << format_hex(
-                    support::endian::read16(Bytes.data() + Index, Endian), 6);
+      dumpBytes(Bytes.slice(Index, 2), OS);
+      OS << "\t\t.short\t"
+         << format_hex(
+                support::endian::read16(Bytes.data() + Index, Endian), 6);
       Index += 2;
     } else {
-      dumpBytes(Bytes.slice(Index, 1), outs());
-      outs() << "\t\t.byte\t" << format_hex(Bytes[0], 4);
+      dumpBytes(Bytes.slice(Index, 1), OS);
+      OS << "\t\t.byte\t" << format_hex(Bytes[0], 4);
       ++Index;
     }
-    outs() << "\n";
+    OS << "\n";
     if (getMappingSymbolKind(MappingSymbols, Index) != 'd')
       break;
   }
   return Index;
 }
 
-static void dumpELFData(uint64_t SectionAddr, uint64_t Index, uint64_t End,
-                        ArrayRef<uint8_t> Bytes) {
+static void dumpELFData(raw_ostream &OS, uint64_t SectionAddr, uint64_t Index,
+                        uint64_t End, ArrayRef<uint8_t> Bytes) {
   // print out data up to 8 bytes at a time in hex and ascii
   uint8_t AsciiData[9] = {'\0'};
   uint8_t Byte;
@@ -1047,9 +1056,9 @@ static void dumpELFData(uint64_t SectionAddr, uint64_t Index, uint64_t End,
 
   for (; Index < End; ++Index) {
     if (NumBytes == 0)
-      outs() << format("%8" PRIx64 ":", SectionAddr + Index);
+      OS << format("%8" PRIx64 ":", SectionAddr + Index);
     Byte = Bytes.slice(Index)[0];
-    outs() << format(" %02x", Byte);
+    OS << format(" %02x", Byte);
     AsciiData[NumBytes] = isPrint(Byte) ? Byte : '.';
 
     uint8_t IndentOffset = 0;
@@ -1064,27 +1073,72 @@ static void dumpELFData(uint64_t SectionAddr, uint64_t Index, uint64_t End,
     }
     if (NumBytes == 8) {
       AsciiData[8] = '\0';
-      outs() << std::string(IndentOffset, ' ') << "         ";
-      outs() << reinterpret_cast<char *>(AsciiData);
-      outs() << '\n';
+      OS << std::string(IndentOffset, ' ') << "         ";
+      OS << reinterpret_cast<char *>(AsciiData);
+      OS << '\n';
       NumBytes = 0;
     }
   }
 }
 
+/// Create the instruction printer for \p Obj, set up as the command line asks.
+static std::unique_ptr<MCInstPrinter>
+createInstPrinter(const Target *TheTarget, const ObjectFile *Obj,
+                  const MCAsmInfo &AsmInfo, const MCInstrInfo &MII,
+                  const MCRegisterInfo &MRI) {
+  int AsmPrinterVariant = AsmInfo.getAssemblerDialect();
+  std::unique_ptr<MCInstPrinter> IP(TheTarget->createMCInstPrinter(
+      Triple(TripleName), AsmPrinterVariant, AsmInfo, MII, MRI));
+  if (!IP)
+    report_error(Obj->getFileName(),
+                 "no instruction printer for target " + TripleName);
+  IP->setPrintImmHex(PrintImmHex);
+
+  for (StringRef Opt : DisassemblerOptions)
+    if (!IP->applyTargetSpecificCLOption(Opt))
+      error("Unrecognized disassembler option: " + Opt);
+  return IP;
+}
+
+namespace {
+/// The disassembler and instruction printer symbols are disassembled with,
+/// along with the comments they produce. Each thread disassembling symbols
+/// uses its own.
+struct DisassemblerState {
+  MCDisassembler *DisAsm;
+  const MCSubtargetInfo *STI;
+  MCInstPrinter *IP;
+  SmallString<40> Comments;
+  raw_svector_ostream CommentStream;
+
+  DisassemblerState(MCDisassembler *DisAsm, const MCSubtargetInfo *STI,
+                    MCInstPrinter *IP)
+      : DisAsm(DisAsm), STI(STI), IP(IP), CommentStream(Comments) {}
+};
+
+/// A symbol to disassemble on a thread, and its disassembly.
+struct SymbolJob {
+  unsigned SI;
+  std::string Name;
+  uint64_t Start;
+  uint64_t End;
+  std::string Output;
+};
+} // namespace
+
 static void disassembleObject(const Target *TheTarget, const ObjectFile *Obj,
                               MCContext &Ctx, MCDisassembler *PrimaryDisAsm,
                               MCDisassembler *SecondaryDisAsm,
-                              const MCInstrAnalysis *MIA, MCInstPrinter *IP,
+                              const MCInstrAnalysis *MIA,
+                              const MCInstrInfo &MII, MCInstPrinter *IP,
                               const MCSubtargetInfo *PrimarySTI,
                               const MCSubtargetInfo *SecondarySTI,
                               PrettyPrinter &PIP,
                               SourcePrinter &SP, bool InlineRelocs) {
-  const MCSubtargetInfo *STI = PrimarySTI;
-  MCDisassembler *DisAsm = PrimaryDisAsm;
+  DisassemblerState SerialState(PrimaryDisAsm, PrimarySTI, IP);
   bool PrimaryIsThumb = false;
   if (isArmElf(Obj))
-    PrimaryIsThumb = STI->checkFeatures("+thumb-mode");
+    PrimaryIsThumb = PrimarySTI->checkFeatures("+thumb-mode");
 
   std::map<SectionRef, std::vector<RelocationRef>> RelocMap;
   if (InlineRelocs)
@@ -1159,6 +1213,34 @@ static void disassembleObject(const Target *TheTarget, const ObjectFile *Obj,
   for (std::pair<const SectionRef, SectionSymbolsTy> &SecSyms : AllSymbols)
     array_pod_sort(SecSyms.second.begin(), SecSyms.second.end());
   array_pod_sort(AbsoluteSymbols.begin(), AbsoluteSymbols.end());
+  // Make sure the branch targets can be looked up without adding to the map.
+  for (SectionRef Sec : Obj->sections())
+    AllSymbols[Sec];
+
+  // Symbols can only be disassembled in parallel when nothing carries over
+  // from one symbol to the next: the relocation cursor, the source lines, the
+  // ARM/Thumb mode, the AMDGPU symbolizer or the Hexagon packets.
+  unsigned ThreadCount = NumThreads ? NumThreads : hardware_concurrency();
+  bool Parallel = ThreadCount > 1 && llvm_is_multithreaded() &&
+                  !InlineRelocs && !PrintSource && !PrintLines &&
+                  !SecondarySTI && !hasMappingSymbols(Obj) &&
+                  Obj->getArch() != Triple::amdgcn &&
+                  Obj->getArch() != Triple::hexagon;
+  std::vector<std::unique_ptr<MCDisassembler>> ThreadDisAsms;
+  std::vector<std::unique_ptr<MCInstPrinter>> ThreadIPs;
+  std::vector<std::unique_ptr<DisassemblerState>> ThreadStates;
+  std::unique_ptr<ThreadPool> Pool;
+  if (Parallel) {
+    for (unsigned I = 0; I != ThreadCount; ++I) {
+      ThreadDisAsms.emplace_back(
+          TheTarget->createMCDisassembler(*PrimarySTI, Ctx));
+      ThreadIPs.push_back(createInstPrinter(TheTarget, Obj, *Ctx.getAsmInfo(),
+                                            MII, *Ctx.getRegisterInfo()));
+      ThreadStates.push_back(llvm::make_unique<DisassemblerState>(
+          ThreadDisAsms.back().get(), PrimarySTI, ThreadIPs.back().get()));
+    }
+    Pool = llvm::make_unique<ThreadPool>(ThreadCount);
+  }
 
   for (const SectionRef &Section : ToolSectionFilter(*Obj)) {
     if (FilterSections.empty() && !DisassembleAll &&
@@ -1198,7 +1280,7 @@ static void disassembleObject(const Target *TheTarget, const ObjectFile *Obj,
         std::unique_ptr<MCSymbolizer> Symbolizer(
           TheTarget->createMCSymbolizer(
             TripleName, nullptr, nullptr, &Symbols, &Ctx, std::move(RelInfo)));
-        DisAsm->setSymbolizer(std::move(Symbolizer));
+        SerialState.DisAsm->setSymbolizer(std::move(Symbolizer));
       }
     }
 
@@ -1218,9 +1300,6 @@ static void disassembleObject(const Target *TheTarget, const ObjectFile *Obj,
                           Section.isText() ? ELF::STT_FUNC : ELF::STT_OBJECT));
     }
 
-    SmallString<40> Comments;
-    raw_svector_ostream CommentStream(Comments);
-
     ArrayRef<uint8_t> Bytes = arrayRefFromStringRef(
         unwrapOrError(Section.getContents(), Obj->getFileName()));
 
@@ -1228,76 +1307,30 @@ static void disassembleObject(const Target *TheTarget, const ObjectFile *Obj,
     if (shouldAdjustVA(Section))
       VMAAdjustment = AdjustVMA;
 
-    uint64_t Size;
-    uint64_t Index;
     bool PrintedSection = false;
     std::vector<RelocationRef> Rels = RelocMap[Section];
     std::vector<RelocationRef>::const_iterator RelCur = Rels.begin();
     std::vector<RelocationRef>::const_iterator RelEnd = Rels.end();
-    // Disassemble symbol by symbol.
-    for (unsigned SI = 0, SE = Symbols.size(); SI != SE; ++SI) {
-      std::string SymbolName = std::get<1>(Symbols[SI]).str();
-      if (Demangle)
-        SymbolName = demangle(SymbolName);
-
-      // Skip if --disassemble-functions is not empty and the symbol is not in
-      // the list.
-      if (!DisasmFuncsSet.empty() && !DisasmFuncsSet.count(SymbolName))
-        continue;
-
-      uint64_t Start = std::get<0>(Symbols[SI]);
-      if (Start < SectionAddr || StopAddress <= Start)
-        continue;
-      else
-        FoundDisasmFuncsSet.insert(SymbolName);
-
-      // The end is the section end, the beginning of the next symbol, or
-      // --stop-address.
-      uint64_t End = std::min<uint64_t>(SectionAddr + SectSize, StopAddress);
-      if (SI + 1 < SE)
-        End = std::min(End, std::get<0>(Symbols[SI + 1]));
-      if (Start >= End || End <= StartAddress)
-        continue;
-      Start -= SectionAddr;
-      End -= SectionAddr;
-
-      if (!PrintedSection) {
-        PrintedSection = true;
-        outs() << "\nDisassembly of section ";
-        if (!SegmentName.empty())
-          outs() << SegmentName << ",";
-        outs() << SectionName << ":\n";
-      }
 
-      if (Obj->isELF() && Obj->getArch() == Triple::amdgcn) {
-        if (std::get<2>(Symbols[SI]) == ELF::STT_AMDGPU_HSA_KERNEL) {
-          // skip amd_kernel_code_t at the begining of kernel symbol (256 bytes)
-          Start += 256;
-        }
-        if (SI == SE - 1 ||
-            std::get<2>(Symbols[SI + 1]) == ELF::STT_AMDGPU_HSA_KERNEL) {
-          // cut trailing zeroes at the end of kernel
-          // cut up to 256 bytes
-          const uint64_t EndAlign = 256;
-          const auto Limit = End - (std::min)(EndAlign, End - Start);
-          while (End > Limit &&
-            *reinterpret_cast<const support::ulittle32_t*>(&Bytes[End - 4]) == 0)
-            End -= 4;
-        }
-      }
-
-      outs() << '\n';
+    // Disassemble the symbol \p SI, which covers [Start, End) in the section,
+    // to \p OS.
+    auto DisassembleSymbol = [&](DisassemblerState &State, raw_ostream &OS,
+                                 unsigned SI, StringRef SymbolName,
+                                 uint64_t Start, uint64_t End) {
+      uint64_t Size;
+      uint64_t Index;
+      OS << '\n';
       if (!NoLeadingAddr)
-        outs() << format(Is64Bits ? "%016" PRIx64 " " : "%08" PRIx64 " ",
-                         SectionAddr + Start + VMAAdjustment);
+        OS << format(Is64Bits ? "%016" PRIx64 " " : "%08" PRIx64 " ",
+                     SectionAddr + Start + VMAAdjustment);
 
-      outs() << SymbolName << ":\n";
+      OS << SymbolName << ":\n";
 
       // Don't print raw contents of a virtual section. A virtual section
       // doesn't have any contents in the file.
       if (Section.isVirtual()) {
-        outs() << "...\n";
-        continue;
+        OS << "...\n";
+        return;
       }
 
 #ifndef NDEBUG
@@ -1308,8 +1341,10 @@ static void disassembleObject(const Target *TheTarget, const ObjectFile *Obj,
 
       // Some targets (like WebAssembly) have a special prelude at the start
       // of each symbol.
-      DisAsm->onSymbolStart(SymbolName, Size, Bytes.slice(Start, End - Start),
-                            SectionAddr + Start, DebugOut, CommentStream);
+      State.DisAsm->onSymbolStart(SymbolName, Size,
+                                  Bytes.slice(Start, End - Start),
+                                  SectionAddr + Start, DebugOut,
+                                  State.CommentStream);
       Start += Size;
 
       Index = Start;
@@ -1322,7 +1357,7 @@ static void disassembleObject(const Target *TheTarget, const ObjectFile *Obj,
       if (Obj->isELF() && !DisassembleAll && Section.isText()) {
         uint8_t SymTy = std::get<2>(Symbols[SI]);
         if (SymTy == ELF::STT_OBJECT || SymTy == ELF::STT_COMMON) {
-          dumpELFData(SectionAddr, Index, End, Bytes);
+          dumpELFData(OS, SectionAddr, Index, End, Bytes);
           Index = End;
         }
       }
@@ -1337,7 +1372,7 @@ static void disassembleObject(const Target *TheTarget, const ObjectFile *Obj,
         // denoted as a word/short etc.
         if (CheckARMELFData &&
             getMappingSymbolKind(MappingSymbols, Index) == 'd') {
-          Index = dumpARMELFData(SectionAddr, Index, End, Obj, Bytes,
+          Index = dumpARMELFData(OS, SectionAddr, Index, End, Obj, Bytes,
                                  MappingSymbols);
           continue;
         }
@@ -1353,7 +1388,7 @@ static void disassembleObject(const Target *TheTarget, const ObjectFile *Obj,
 
           if (size_t N =
                   countSkippableZeroBytes(Bytes.slice(Index, MaxOffset))) {
-            outs() << "\t\t..." << '\n';
+            OS << "\t\t..." << '\n';
             Index += N;
             continue;
           }
@@ -1361,29 +1396,29 @@ static void disassembleObject(const Target *TheTarget, const ObjectFile *Obj,
 
         if (SecondarySTI) {
           if (getMappingSymbolKind(MappingSymbols, Index) == 'a') {
-            STI = PrimaryIsThumb ? SecondarySTI : PrimarySTI;
-            DisAsm = PrimaryIsThumb ? SecondaryDisAsm : PrimaryDisAsm;
+            State.STI = PrimaryIsThumb ? SecondarySTI : PrimarySTI;
+            State.DisAsm = PrimaryIsThumb ? SecondaryDisAsm : PrimaryDisAsm;
           } else if (getMappingSymbolKind(MappingSymbols, Index) == 't') {
-            STI = PrimaryIsThumb ? PrimarySTI : SecondarySTI;
-            DisAsm = PrimaryIsThumb ? PrimaryDisAsm : SecondaryDisAsm;
+            State.STI = PrimaryIsThumb ? PrimarySTI : SecondarySTI;
+            State.DisAsm = PrimaryIsThumb ? PrimaryDisAsm : SecondaryDisAsm;
           }
         }
 
         // Disassemble a real instruction or a data when disassemble all is
         // provided
         MCInst Inst;
-        bool Disassembled = DisAsm->getInstruction(
+        bool Disassembled = State.DisAsm->getInstruction(
             Inst, Size, Bytes.slice(Index), SectionAddr + Index, DebugOut,
-            CommentStream);
+            State.CommentStream);
         if (Size == 0)
           Size = 1;
 
         PIP.printInst(
-            *IP, Disassembled ? &Inst : nullptr, Bytes.slice(Index, Size),
-            {SectionAddr + Index + VMAAdjustment, Section.getIndex()}, outs(),
-            "", *STI, &SP, &Rels);
-        outs() << CommentStream.str();
-        Comments.clear();
+            *State.IP, Disassembled ? &Inst : nullptr, Bytes.slice(Index, Size),
+            {SectionAddr + Index + VMAAdjustment, Section.getIndex()}, OS,
+            "", *State.STI, &SP, &Rels);
+        OS << State.CommentStream.str();
+        State.Comments.clear();
 
         // Try to resolve the target of a call, tail call, etc. to a specific
         // symbol.
@@ -1407,7 +1442,7 @@ static void disassembleObject(const Target *TheTarget, const ObjectFile *Obj,
                   });
               if (It != SectionAddresses.begin()) {
                 --It;
-                TargetSectionSymbols = &AllSymbols[It->second];
+                TargetSectionSymbols = &AllSymbols.find(It->second)->second;
               } else {
                 TargetSectionSymbols = &AbsoluteSymbols;
               }
@@ -1433,15 +1468,15 @@ static void disassembleObject(const Target *TheTarget, const ObjectFile *Obj,
               --TargetSym;
               uint64_t TargetAddress = std::get<0>(*TargetSym);
               StringRef TargetName = std::get<1>(*TargetSym);
-              outs() << " <" << TargetName;
+              OS << " <" << TargetName;
               uint64_t Disp = Target - TargetAddress;
               if (Disp)
-                outs() << "+0x" << Twine::utohexstr(Disp);
-              outs() << '>';
+                OS << "+0x" << Twine::utohexstr(Disp);
+              OS << '>';
             }
           }
         }
-        outs() << "\n";
+        OS << "\n";
 
         // Hexagon does this in pretty printer
         if (Obj->getArch() != Triple::hexagon) {
@@ -1467,14 +1502,97 @@ static void disassembleObject(const Target *TheTarget, const ObjectFile *Obj,
                 Offset += AdjustVMA;
             }
 
-            printRelocation(*RelCur, SectionAddr + Offset, Is64Bits);
+            printRelocation(OS, *RelCur, SectionAddr + Offset, Is64Bits);
             ++RelCur;
           }
         }
 
         Index += Size;
       }
+    };
+
+    // With several threads, the symbols are disassembled in batches, each one
+    // to its own buffer, and the buffers are printed in order.
+    std::vector<SymbolJob> Jobs;
+    auto RunJobs = [&]() {
+      std::atomic<size_t> NextJob(0);
+      for (std::unique_ptr<DisassemblerState> &State : ThreadStates)
+        Pool->async([&]() {
+          for (size_t I; (I = NextJob++) < Jobs.size();) {
+            SymbolJob &Job = Jobs[I];
+            raw_string_ostream OS(Job.Output);
+            DisassembleSymbol(*State, OS, Job.SI, Job.Name, Job.Start,
+                              Job.End);
+          }
+        });
+      Pool->wait();
+      for (SymbolJob &Job : Jobs)
+        outs() << Job.Output;
+      Jobs.clear();
+    };
+
+    // Disassemble symbol by symbol.
+    for (unsigned SI = 0, SE = Symbols.size(); SI != SE; ++SI) {
+      std::string SymbolName = std::get<1>(Symbols[SI]).str();
+      if (Demangle)
+        SymbolName = demangle(SymbolName);
+
+      // Skip if --disassemble-functions is not empty and the symbol is not in
+      // the list.
+      if (!DisasmFuncsSet.empty() && !DisasmFuncsSet.count(SymbolName))
+        continue;
+
+      uint64_t Start = std::get<0>(Symbols[SI]);
+      if (Start < SectionAddr || StopAddress <= Start)
+        continue;
+      else
+        FoundDisasmFuncsSet.insert(SymbolName);
+
+      // The end is the section end, the beginning of the next symbol, or
+      // --stop-address.
+      uint64_t End = std::min<uint64_t>(SectionAddr + SectSize, StopAddress);
+      if (SI + 1 < SE)
+        End = std::min(End, std::get<0>(Symbols[SI + 1]));
+      if (Start >= End || End <= StartAddress)
+        continue;
+      Start -= SectionAddr;
+      End -= SectionAddr;
+
+      if (!PrintedSection) {
+        PrintedSection = true;
+        outs() << "\nDisassembly of section ";
+        if (!SegmentName.empty())
+          outs() << SegmentName << ",";
+        outs() << SectionName << ":\n";
+      }
+
+      if (Obj->isELF() && Obj->getArch() == Triple::amdgcn) {
+        if (std::get<2>(Symbols[SI]) == ELF::STT_AMDGPU_HSA_KERNEL) {
+          // skip amd_kernel_code_t at the begining of kernel symbol (256 bytes)
+          Start += 256;
+        }
+        if (SI == SE - 1 ||
+            std::get<2>(Symbols[SI + 1]) == ELF::STT_AMDGPU_HSA_KERNEL) {
+          // cut trailing zeroes at the end of kernel
+          // cut up to 256 bytes
+          const uint64_t EndAlign = 256;
+          const auto Limit = End - (std::min)(EndAlign, End - Start);
+          while (End > Limit &&
+            *reinterpret_cast<const support::ulittle32_t*>(&Bytes[End - 4]) == 0)
+            End -= 4;
+        }
+      }
+
+      if (!Parallel) {
+        DisassembleSymbol(SerialState, outs(), SI, SymbolName, Start, End);
+        continue;
+      }
+      Jobs.push_back({SI, std::move(SymbolName), Start, End, std::string()});
+      if (Jobs.size() == ThreadStates.size() * 64)
+        RunJobs();
     }
+    if (!Jobs.empty())
+      RunJobs();
   }
   StringSet<> MissingDisasmFuncsSet =
       set_difference(DisasmFuncsSet, FoundDisasmFuncsSet);
@@ -1542,24 +1660,15 @@ static void disassembleObject(const ObjectFile *Obj, bool InlineRelocs) {
   std::unique_ptr<const MCInstrAnalysis> MIA(
       TheTarget->createMCInstrAnalysis(MII.get()));
 
-  int AsmPrinterVariant = AsmInfo->getAssemblerDialect();
-  std::unique_ptr<MCInstPrinter> IP(TheTarget->createMCInstPrinter(
-      Triple(TripleName), AsmPrinterVariant, *AsmInfo, *MII, *MRI));
-  if (!IP)
-    report_error(Obj->getFileName(),
-                 "no instruction printer for target " + TripleName);
-  IP->setPrintImmHex(PrintImmHex);
+  std::unique_ptr<MCInstPrinter> IP =
+      createInstPrinter(TheTarget, Obj, *AsmInfo, *MII, *MRI);
 
   PrettyPrinter &PIP = selectPrettyPrinter(Triple(TripleName));
   SourcePrinter SP(Obj, TheTarget->getName());
 
-  for (StringRef Opt : DisassemblerOptions)
-    if (!IP->applyTargetSpecificCLOption(Opt))
-      error("Unrecognized disassembler option: " + Opt);
-
   disassembleObject(TheTarget, Obj, Ctx, DisAsm.get(), SecondaryDisAsm.get(),
-                    MIA.get(), IP.get(), STI.get(), SecondarySTI.get(), PIP,
-                    SP, InlineRelocs);
+                    MIA.get(), *MII, IP.get(), STI.get(), SecondarySTI.get(),
+                    PIP, SP, InlineRelocs);
 }
 
 void printRelocations(const ObjectFile *Obj) {
@@ -165,7 +165,9 @@ public:
 
 struct WeightedFile {
   std::string Filename;
+  /// The counts of the file are scaled by Weight / Divisor.
   uint64_t Weight;
+  uint64_t Divisor;
 };
 typedef SmallVector<WeightedFile, 5> WeightedFileVector;
 
@@ -226,6 +228,38 @@ static void overlapInput(const std::string &BaseFilename,
   }
 }
 
+/// Add a record of \p Input to the writer of \p WC, scaled by the weight of
+/// the input.
+static void addWeightedRecord(WriterContext *WC, NamedInstrProfRecord &&I,
+                              const WeightedFile &Input) {
+  const StringRef FuncName = I.Name;
+  bool Reported = false;
+  auto Warn = [&](Error E) {
+    if (Reported) {
+      consumeError(std::move(E));
+      return;
+    }
+    Reported = true;
+    // Only show hint the first time an error occurs.
+    instrprof_error IPE = InstrProfError::take(std::move(E));
+    std::unique_lock<std::mutex> ErrGuard{WC->ErrLock};
+    bool firstTime = WC->WriterErrorCodes.insert(IPE).second;
+    handleMergeWriterError(make_error<InstrProfError>(IPE), Input.Filename,
+                           FuncName, firstTime);
+  };
+
+  // The writer only scales by integer weights, so scale the record by a
+  // fractional weight before it is added.
+  uint64_t Weight = Input.Weight;
+  if (Input.Divisor != 1) {
+    I.scale(Input.Weight, Input.Divisor, [&](instrprof_error E) {
+      Warn(make_error<InstrProfError>(E));
+    });
+    Weight = 1;
+  }
+  WC->Writer.addRecord(std::move(I), Weight, Warn);
+}
+
 /// Load an input into a writer context.
 static void loadInput(const WeightedFile &Input, SymbolRemapper *Remapper,
                       WriterContext *WC) {
@@ -262,22 +296,73 @@ static void loadInput(const WeightedFile &Input, SymbolRemapper *Remapper,
   for (auto &I : *Reader) {
     if (Remapper)
       I.Name = (*Remapper)(I.Name);
-    const StringRef FuncName = I.Name;
-    bool Reported = false;
-    WC->Writer.addRecord(std::move(I), Input.Weight, [&](Error E) {
-      if (Reported) {
-        consumeError(std::move(E));
-        return;
-      }
-      Reported = true;
-      // Only show hint the first time an error occurs.
+    addWeightedRecord(WC, std::move(I), Input);
+  }
+  if (Reader->hasError()) {
+    if (Error E = Reader->getError()) {
       instrprof_error IPE = InstrProfError::take(std::move(E));
-      std::unique_lock<std::mutex> ErrGuard{WC->ErrLock};
-      bool firstTime = WC->WriterErrorCodes.insert(IPE).second;
-      handleMergeWriterError(make_error<InstrProfError>(IPE), Input.Filename,
-                             FuncName, firstTime);
-    });
+      if (isFatalError(IPE))
+        WC->Err = make_error<InstrProfError>(IPE);
+    }
   }
+}
+
+/// Return the shard that owns the function \p FuncName, out of \p NumShards
+/// shards that split the range of function name hashes evenly.
+static unsigned getShardIndex(StringRef FuncName, unsigned NumShards) {
+  uint64_t Hash = IndexedInstrProf::ComputeHash(FuncName);
+  return ((Hash >> 32) * NumShards) >> 32;
+}
+
+/// Load an input into the shards that own its functions. The per-thread
+/// context \p WC only keeps track of the errors in the input.
+static void
+loadInputIntoShards(const WeightedFile &Input, SymbolRemapper *Remapper,
+                    WriterContext *WC,
+                    ArrayRef<std::unique_ptr<WriterContext>> Shards) {
+  std::unique_lock<std::mutex> CtxGuard{WC->Lock};
+
+  // If there's a pending hard error, don't do more work.
+  if (WC->Err)
+    return;
+
+  WC->ErrWhence = Input.Filename;
+
+  auto ReaderOrErr = InstrProfReader::create(Input.Filename);
+  if (Error E = ReaderOrErr.takeError()) {
+    // Skip the empty profiles by returning sliently.
+    instrprof_error IPE = InstrProfError::take(std::move(E));
+    if (IPE != instrprof_error::empty_raw_profile)
+      WC->Err = make_error<InstrProfError>(IPE);
+    return;
+  }
+
+  // Group the records by shard, so that each shard is locked once per input.
+  auto Reader = std::move(ReaderOrErr.get());
+  std::vector<std::vector<NamedInstrProfRecord>> ShardRecords(Shards.size());
+  for (auto &I : *Reader) {
+    if (Remapper)
+      I.Name = (*Remapper)(I.Name);
+    ShardRecords[getShardIndex(I.Name, Shards.size())].push_back(std::move(I));
+  }
+
+  bool IsIRProfile = Reader->isIRLevelProfile();
+  bool HasCSIRProfile = Reader->hasCSIRLevelProfile();
+  for (unsigned S = 0, E = Shards.size(); S != E; ++S) {
+    WriterContext *Shard = Shards[S].get();
+    std::unique_lock<std::mutex> ShardGuard{Shard->Lock};
+    // Every shard sees every input, so that the shards agree on the kind of
+    // the profile.
+    if (Shard->Writer.setIsIRLevelProfile(IsIRProfile, HasCSIRProfile)) {
+      WC->Err = make_error<StringError>(
+          "Merge IR generated profile with Clang generated profile.",
+          std::error_code());
+      return;
+    }
+    for (auto &I : ShardRecords[S])
+      addWeightedRecord(Shard, std::move(I), Input);
+  }
+
   if (Reader->hasError()) {
     if (Error E = Reader->getError()) {
       instrprof_error IPE = InstrProfError::take(std::move(E));
@@ -309,7 +394,7 @@ static void mergeInstrProfile(const WeightedFileVector &Inputs,
                               SymbolRemapper *Remapper,
                               StringRef OutputFilename,
                               ProfileFormat OutputFormat, bool OutputSparse,
-                              unsigned NumThreads) {
+                              unsigned NumThreads, unsigned NumShards) {
   if (OutputFilename.compare("-") == 0)
     exitWithError("Cannot write indexed profdata format to stdout.");
 
@@ -336,7 +421,38 @@ static void mergeInstrProfile(const WeightedFileVector &Inputs,
     Contexts.emplace_back(llvm::make_unique<WriterContext>(
         OutputSparse, ErrorLock, WriterErrorCodes));
 
-  if (NumThreads == 1) {
+  WriterContext *Result = Contexts[0].get();
+  if (NumShards > 0) {
+    // The threads read disjoint sets of inputs, and add their functions to
+    // disjoint shards of the merged profile. The merged profile is then held
+    // once, however many threads there are, and never merged pairwise.
+    SmallVector<std::unique_ptr<WriterContext>, 4> Shards;
+    for (unsigned I = 0; I < NumShards; ++I)
+      Shards.emplace_back(llvm::make_unique<WriterContext>(
+          OutputSparse, ErrorLock, WriterErrorCodes));
+
+    if (NumThreads == 1) {
+      for (const auto &Input : Inputs)
+        loadInputIntoShards(Input, Remapper, Contexts[0].get(), Shards);
+    } else {
+      ThreadPool Pool(NumThreads);
+      unsigned Ctx = 0;
+      for (const auto &Input : Inputs) {
+        Pool.async(loadInputIntoShards, Input, Remapper, Contexts[Ctx].get(),
+                   ArrayRef<std::unique_ptr<WriterContext>>(Shards));
+        Ctx = (Ctx + 1) % NumThreads;
+      }
+      Pool.wait();
+    }
+
+    // The shards have no function in common, so gathering them only moves
+    // their records.
+    for (unsigned I = 1; I < NumShards; ++I)
+      mergeWriterContexts(Shards[0].get(), Shards[I].get());
+    Result = Shards[0].get();
+    for (auto &Shard : Shards)
+      Contexts.push_back(std::move(Shard));
+  } else if (NumThreads == 1) {
     for (const auto &Input : Inputs)
       loadInput(Input, Remapper, Contexts[0].get());
   } else {
@@ -384,7 +500,7 @@ static void mergeInstrProfile(const WeightedFileVector &Inputs,
            WC->ErrWhence);
   }
 
-  InstrProfWriter &Writer = Contexts[0]->Writer;
+  InstrProfWriter &Writer = Result->Writer;
   if (OutputFormat == PF_Text) {
     if (Error E = Writer.writeText(Output))
       exitWithError(std::move(E));
@@ -443,6 +559,10 @@ static void mergeSampleProfile(const WeightedFileVector &Inputs,
   SmallVector<std::unique_ptr<sampleprof::SampleProfileReader>, 5> Readers;
   LLVMContext Context;
   for (const auto &Input : Inputs) {
+    if (Input.Divisor != 1)
+      exitWithError("Fractional weights are only supported for "
+                    "instrumentation profiles.",
+                    Input.Filename);
     auto ReaderOrErr = SampleProfileReader::create(Input.Filename, Context);
     if (std::error_code EC = ReaderOrErr.getError())
       exitWithErrorCode(EC, Input.Filename);
@@ -480,11 +600,18 @@ static WeightedFile parseWeightedFile(const StringRef &WeightedFilename) {
   StringRef WeightStr, FileName;
   std::tie(WeightStr, FileName) = WeightedFilename.split(',');
 
-  uint64_t Weight;
+  // The weight may be a fraction, e.g. to decay the counts of older profiles.
+  StringRef DivisorStr = "1";
+  if (WeightStr.find('/') != StringRef::npos)
+    std::tie(WeightStr, DivisorStr) = WeightStr.split('/');
+
+  uint64_t Weight, Divisor;
   if (WeightStr.getAsInteger(10, Weight) || Weight < 1)
     exitWithError("Input weight must be a positive integer.");
+  if (DivisorStr.getAsInteger(10, Divisor) || Divisor < 1)
+    exitWithError("Input weight divisor must be a positive integer.");
 
-  return {FileName, Weight};
+  return {FileName, Weight, Divisor};
 }
 
 static std::unique_ptr<MemoryBuffer>
@@ -502,10 +629,11 @@ getInputFilenamesFileBuf(const StringRef &InputFilenamesFile) {
 static void addWeightedInput(WeightedFileVector &WNI, const WeightedFile &WF) {
   StringRef Filename = WF.Filename;
   uint64_t Weight = WF.Weight;
+  uint64_t Divisor = WF.Divisor;
 
   // If it's STDIN just pass it on.
   if (Filename == "-") {
-    WNI.push_back({Filename, Weight});
+    WNI.push_back({Filename, Weight, Divisor});
     return;
   }
 
@@ -516,7 +644,7 @@ static void addWeightedInput(WeightedFileVector &WNI, const WeightedFile &WF) {
                       Filename);
   // If it's a source file, collect it.
   if (llvm::sys::fs::is_regular_file(Status)) {
-    WNI.push_back({Filename, Weight});
+    WNI.push_back({Filename, Weight, Divisor});
     return;
   }
 
@@ -525,7 +653,7 @@ static void addWeightedInput(WeightedFileVector &WNI, const WeightedFile &WF) {
     for (llvm::sys::fs::recursive_directory_iterator F(Filename, EC), E;
          F != E && !EC; F.increment(EC)) {
       if (llvm::sys::fs::is_regular_file(F->path())) {
-        addWeightedInput(WNI, {F->path(), Weight});
+        addWeightedInput(WNI, {F->path(), Weight, Divisor});
       }
     }
     if (EC)
@@ -548,7 +676,7 @@ static void parseInputFilenamesFile(MemoryBuffer *Buffer,
       continue;
     // If there's no comma, it's an unweighted profile.
     else if (SanitizedEntry.find(',') == StringRef::npos)
-      addWeightedInput(WFV, {SanitizedEntry, 1});
+      addWeightedInput(WFV, {SanitizedEntry, 1, 1});
     else
       addWeightedInput(WFV, parseWeightedFile(SanitizedEntry));
   }
@@ -557,12 +685,12 @@ static void parseInputFilenamesFile(MemoryBuffer *Buffer,
 static int merge_main(int argc, const char *argv[]) {
   cl::list<std::string> InputFilenames(cl::Positional,
                                        cl::desc("<filename...>"));
-  cl::list<std::string> WeightedInputFilenames("weighted-input",
-                                               cl::desc("<weight>,<filename>"));
+  cl::list<std::string> WeightedInputFilenames(
+      "weighted-input", cl::desc("<weight>[/<divisor>],<filename>"));
   cl::opt<std::string> InputFilenamesFile(
       "input-files", cl::init(""),
       cl::desc("Path to file containing newline-separated "
-               "[<weight>,]<filename> entries"));
+               "[<weight>[/<divisor>],]<filename> entries"));
   cl::alias InputFilenamesFileA("f", cl::desc("Alias for --input-files"),
                                 cl::aliasopt(InputFilenamesFile));
   cl::opt<bool> DumpInputFileList(
@@ -596,12 +724,17 @@ static int merge_main(int argc, const char *argv[]) {
       cl::desc("Number of merge threads to use (default: autodetect)"));
   cl::alias NumThreadsA("j", cl::desc("Alias for --num-threads"),
                         cl::aliasopt(NumThreads));
+  cl::opt<unsigned> NumShards(
+      "num-shards", cl::init(0),
+      cl::desc("Split the merged profile into this many shards by function "
+               "name, shared by the merge threads, rather than keeping a copy "
+               "of the profile per thread (only meaningful for -instr)"));
 
   cl::ParseCommandLineOptions(argc, argv, "LLVM profile data merger\n");
 
   WeightedFileVector WeightedInputs;
   for (StringRef Filename : InputFilenames)
-    addWeightedInput(WeightedInputs, {Filename, 1});
+    addWeightedInput(WeightedInputs, {Filename, 1, 1});
   for (StringRef WeightedFilename : WeightedInputFilenames)
     addWeightedInput(WeightedInputs, parseWeightedFile(WeightedFilename));
 
@@ -615,8 +748,12 @@ static int merge_main(int argc, const char *argv[]) {
                   sys::path::filename(argv[0]) + " -help");
 
   if (DumpInputFileList) {
-    for (auto &WF : WeightedInputs)
-      outs() << WF.Weight << "," << WF.Filename << "\n";
+    for (auto &WF : WeightedInputs) {
+      outs() << WF.Weight;
+      if (WF.Divisor != 1)
+        outs() << "/" << WF.Divisor;
+      outs() << "," << WF.Filename << "\n";
+    }
     return 0;
   }
 
@@ -626,7 +763,7 @@ static int merge_main(int argc, const char *argv[]) {
 
   if (ProfileKind == instr)
     mergeInstrProfile(WeightedInputs, Remapper.get(), OutputFilename,
-                      OutputFormat, OutputSparse, NumThreads);
+                      OutputFormat, OutputSparse, NumThreads, NumShards);
   else
     mergeSampleProfile(WeightedInputs, Remapper.get(), OutputFilename,
                        OutputFormat);
@@ -642,7 +779,7 @@ static void overlapInstrProfile(const std::string &BaseFilename,
   std::mutex ErrorLock;
   SmallSet<instrprof_error, 4> WriterErrorCodes;
   WriterContext Context(false, ErrorLock, WriterErrorCodes);
-  WeightedFile WeightedInput{BaseFilename, 1};
+  WeightedFile WeightedInput{BaseFilename, 1, 1};
   OverlapStats Overlap;
   Error E = Overlap.accumuateCounts(BaseFilename, TestFilename, IsCS);
   if (E)
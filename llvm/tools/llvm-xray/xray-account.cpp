@@ -119,6 +119,18 @@ static cl::opt<std::string>
 static cl::alias AccountInstrMap2("m", cl::aliasopt(AccountInstrMap),
                                   cl::desc("Alias for -instr_map"),
                                   cl::sub(Account));
+static cl::opt<bool> AccountStream(
+    "stream",
+    cl::desc("account the records of an FDR mode log one thread at a time, "
+             "rather than loading the whole trace first"),
+    cl::sub(Account), cl::init(false));
+static cl::opt<unsigned>
+    AccountJobs("jobs",
+                cl::desc("number of threads decoding the log with -stream "
+                         "(0 = number of hardware threads)"),
+                cl::sub(Account), cl::init(0));
+static cl::alias AccountJobs2("j", cl::aliasopt(AccountJobs),
+                              cl::desc("Alias for -jobs"), cl::sub(Account));
 
 namespace {
 
@@ -431,18 +443,9 @@ static CommandRegistration Unused(&Account, []() -> Error {
   llvm::xray::FuncIdConversionHelper FuncIdHelper(AccountInstrMap, Symbolizer,
                                                   FunctionAddresses);
   xray::LatencyAccountant FCA(FuncIdHelper, AccountDeduceSiblingCalls);
-  auto TraceOrErr = loadTraceFile(AccountInput);
-  if (!TraceOrErr)
-    return joinErrors(
-        make_error<StringError>(
-            Twine("Failed loading input file '") + AccountInput + "'",
-            std::make_error_code(std::errc::executable_format_error)),
-        TraceOrErr.takeError());
-
-  auto &T = *TraceOrErr;
-  for (const auto &Record : T) {
+  auto AccountRecord = [&](const XRayRecord &Record) -> Error {
     if (FCA.accountRecord(Record))
-      continue;
+      return Error::success();
     errs()
         << "Error processing record: "
         << llvm::formatv(
@@ -466,13 +469,46 @@ static CommandRegistration Unused(&Account, []() -> Error {
           Twine("Failed accounting function calls in file '") + AccountInput +
               "'.",
           std::make_error_code(std::errc::executable_format_error));
+    return Error::success();
+  };
+
+  // The records of a streamed log are gone once accounted for, so only the
+  // file header is kept for the export below.
+  XRayFileHeader Header;
+  if (AccountStream) {
+    if (auto E = processTraceFile(AccountInput,
+                                  [&](const XRayFileHeader &FH) {
+                                    Header = FH;
+                                    return Error::success();
+                                  },
+                                  AccountRecord, AccountJobs))
+      return joinErrors(
+          make_error<StringError>(
+              Twine("Failed loading input file '") + AccountInput + "'",
+              std::make_error_code(std::errc::executable_format_error)),
+          std::move(E));
+  } else {
+    auto TraceOrErr = loadTraceFile(AccountInput);
+    if (!TraceOrErr)
+      return joinErrors(
+          make_error<StringError>(
+              Twine("Failed loading input file '") + AccountInput + "'",
+              std::make_error_code(std::errc::executable_format_error)),
+          TraceOrErr.takeError());
+
+    auto &T = *TraceOrErr;
+    for (const auto &Record : T)
+      if (auto E = AccountRecord(Record))
+        return E;
+    Header = T.getFileHeader();
   }
+
   switch (AccountOutputFormat) {
   case AccountOutputFormats::TEXT:
-    FCA.exportStatsAsText(OS, T.getFileHeader());
+    FCA.exportStatsAsText(OS, Header);
     break;
   case AccountOutputFormats::CSV:
-    FCA.exportStatsAsCSV(OS, T.getFileHeader());
+    FCA.exportStatsAsCSV(OS, Header);
     break;
   }
 
@@ -13,6 +13,7 @@
 
 #include "trie-node.h"
 #include "xray-registry.h"
+#include "llvm/ADT/Optional.h"
 #include "llvm/DebugInfo/Symbolize/Symbolize.h"
 #include "llvm/Support/EndianStream.h"
 #include "llvm/Support/FileSystem.h"
@@ -77,6 +78,19 @@ static cl::opt<bool> ConvertSortInput(
 static cl::alias ConvertSortInput2("s", cl::aliasopt(ConvertSortInput),
                                    cl::desc("Alias for -sort"),
                                    cl::sub(Convert));
+static cl::opt<bool> ConvertStream(
+    "stream",
+    cl::desc("convert the records of an FDR mode log one thread at a time, "
+             "rather than loading the whole trace first; only supported for "
+             "the trace_event output format"),
+    cl::sub(Convert), cl::init(false));
+static cl::opt<unsigned>
+    ConvertJobs("jobs",
+                cl::desc("number of threads decoding the log with -stream "
+                         "(0 = number of hardware threads)"),
+                cl::sub(Convert), cl::init(0));
+static cl::alias ConvertJobs2("j", cl::aliasopt(ConvertJobs),
+                              cl::desc("Alias for -jobs"), cl::sub(Convert));
 
 using llvm::yaml::Output;
 
@@ -265,76 +279,91 @@ void writeTraceViewerRecord(uint16_t Version, raw_ostream &OS, int32_t FuncId,
   }
 }
 
-} // namespace
-
-void TraceConverter::exportAsChromeTraceEventFormat(const Trace &Records,
-                                                    raw_ostream &OS) {
-  const auto &FH = Records.getFileHeader();
-  auto Version = FH.Version;
-  auto CycleFreq = FH.CycleFrequency;
+// Writes records to the Chrome Trace Event format one at a time, so that the
+// records need not all be in memory.
+class ChromeTraceEventWriter {
+  raw_ostream &OS;
+  const FuncIdConversionHelper &FuncIdHelper;
+  bool Symbolize;
+  uint16_t Version;
+  uint64_t CycleFreq;
 
   unsigned id_counter = 0;
-
-  OS << "{\n  \"traceEvents\": [";
   DenseMap<uint32_t, StackTrieNode *> StackCursorByThreadId{};
   DenseMap<uint32_t, SmallVector<StackTrieNode *, 4>> StackRootsByThreadId{};
   DenseMap<unsigned, StackTrieNode *> StacksByStackId{};
   std::forward_list<StackTrieNode> NodeStore{};
   int loop_count = 0;
-  for (const auto &R : Records) {
-    if (loop_count++ == 0)
-      OS << "\n";
-    else
-      OS << ",\n";
 
-    // Chrome trace event format always wants data in micros.
-    // CyclesPerMicro = CycleHertz / 10^6
-    // TSC / CyclesPerMicro == TSC * 10^6 / CycleHertz == MicroTimestamp
-    // Could lose some precision here by converting the TSC to a double to
-    // multiply by the period in micros. 52 bit mantissa is a good start though.
-    // TODO: Make feature request to Chrome Trace viewer to accept ticks and a
-    // frequency or do some more involved calculation to avoid dangers of
-    // conversion.
-    double EventTimestampUs = double(1000000) / CycleFreq * double(R.TSC);
-    StackTrieNode *&StackCursor = StackCursorByThreadId[R.TId];
-    switch (R.Type) {
-    case RecordTypes::CUSTOM_EVENT:
-    case RecordTypes::TYPED_EVENT:
-      // TODO: Support typed and custom event rendering on Chrome Trace Viewer.
-      break;
-    case RecordTypes::ENTER:
-    case RecordTypes::ENTER_ARG:
-      StackCursor = findOrCreateStackNode(StackCursor, R.FuncId, R.TId,
-                                          StackRootsByThreadId, StacksByStackId,
-                                          &id_counter, NodeStore);
-      // Each record is represented as a json dictionary with function name,
-      // type of B for begin or E for end, thread id, process id,
-      // timestamp in microseconds, and a stack frame id. The ids are logged
-      // in an id dictionary after the events.
-      writeTraceViewerRecord(Version, OS, R.FuncId, R.TId, R.PId, Symbolize,
-                             FuncIdHelper, EventTimestampUs, *StackCursor, "B");
-      break;
-    case RecordTypes::EXIT:
-    case RecordTypes::TAIL_EXIT:
-      // No entries to record end for.
-      if (StackCursor == nullptr)
-        break;
-      // Should we emit an END record anyway or account this condition?
-      // (And/Or in loop termination below)
-      StackTrieNode *PreviousCursor = nullptr;
-      do {
-        if (PreviousCursor != nullptr) {
-          OS << ",\n";
-        }
-        writeTraceViewerRecord(Version, OS, StackCursor->FuncId, R.TId, R.PId,
-                               Symbolize, FuncIdHelper, EventTimestampUs,
-                               *StackCursor, "E");
-        PreviousCursor = StackCursor;
-        StackCursor = StackCursor->Parent;
-      } while (PreviousCursor->FuncId != R.FuncId && StackCursor != nullptr);
+public:
+  ChromeTraceEventWriter(raw_ostream &OS,
+                         const FuncIdConversionHelper &FuncIdHelper,
+                         bool Symbolize, const XRayFileHeader &FH)
+      : OS(OS), FuncIdHelper(FuncIdHelper), Symbolize(Symbolize),
+        Version(FH.Version), CycleFreq(FH.CycleFrequency) {
+    OS << "{\n  \"traceEvents\": [";
+  }
+
+  void write(const XRayRecord &R);
+  void finish();
+};
+
+void ChromeTraceEventWriter::write(const XRayRecord &R) {
+  if (loop_count++ == 0)
+    OS << "\n";
+  else
+    OS << ",\n";
+
+  // Chrome trace event format always wants data in micros.
+  // CyclesPerMicro = CycleHertz / 10^6
+  // TSC / CyclesPerMicro == TSC * 10^6 / CycleHertz == MicroTimestamp
+  // Could lose some precision here by converting the TSC to a double to
+  // multiply by the period in micros. 52 bit mantissa is a good start though.
+  // TODO: Make feature request to Chrome Trace viewer to accept ticks and a
+  // frequency or do some more involved calculation to avoid dangers of
+  // conversion.
+  double EventTimestampUs = double(1000000) / CycleFreq * double(R.TSC);
+  StackTrieNode *&StackCursor = StackCursorByThreadId[R.TId];
+  switch (R.Type) {
+  case RecordTypes::CUSTOM_EVENT:
+  case RecordTypes::TYPED_EVENT:
+    // TODO: Support typed and custom event rendering on Chrome Trace Viewer.
+    break;
+  case RecordTypes::ENTER:
+  case RecordTypes::ENTER_ARG:
+    StackCursor = findOrCreateStackNode(StackCursor, R.FuncId, R.TId,
+                                        StackRootsByThreadId, StacksByStackId,
+                                        &id_counter, NodeStore);
+    // Each record is represented as a json dictionary with function name,
+    // type of B for begin or E for end, thread id, process id,
+    // timestamp in microseconds, and a stack frame id. The ids are logged
+    // in an id dictionary after the events.
+    writeTraceViewerRecord(Version, OS, R.FuncId, R.TId, R.PId, Symbolize,
+                           FuncIdHelper, EventTimestampUs, *StackCursor, "B");
+    break;
+  case RecordTypes::EXIT:
+  case RecordTypes::TAIL_EXIT:
+    // No entries to record end for.
+    if (StackCursor == nullptr)
       break;
-    }
+    // Should we emit an END record anyway or account this condition?
+    // (And/Or in loop termination below)
+    StackTrieNode *PreviousCursor = nullptr;
+    do {
+      if (PreviousCursor != nullptr) {
+        OS << ",\n";
+      }
+      writeTraceViewerRecord(Version, OS, StackCursor->FuncId, R.TId, R.PId,
+                             Symbolize, FuncIdHelper, EventTimestampUs,
+                             *StackCursor, "E");
+      PreviousCursor = StackCursor;
+      StackCursor = StackCursor->Parent;
+    } while (PreviousCursor->FuncId != R.FuncId && StackCursor != nullptr);
+    break;
   }
+}
+
+void ChromeTraceEventWriter::finish() {
   OS << "\n  ],\n"; // Close the Trace Events array.
   OS << "  "
      << "\"displayTimeUnit\": \"ns\",\n";
@@ -362,6 +391,38 @@ void TraceConverter::exportAsChromeTraceEventFormat(const Trace &Records,
   OS << "}\n";     // Close the JSON entry.
 }
 
+} // namespace
+
+void TraceConverter::exportAsChromeTraceEventFormat(const Trace &Records,
+                                                    raw_ostream &OS) {
+  ChromeTraceEventWriter Writer(OS, FuncIdHelper, Symbolize,
+                                Records.getFileHeader());
+  for (const auto &R : Records)
+    Writer.write(R);
+  Writer.finish();
+}
+
+Error TraceConverter::exportAsChromeTraceEventFormat(StringRef Filename,
+                                                     unsigned NumThreads,
+                                                     raw_ostream &OS) {
+  Optional<ChromeTraceEventWriter> Writer;
+  auto Err = processTraceFile(
+      Filename,
+      [&](const XRayFileHeader &FH) {
+        Writer.emplace(OS, FuncIdHelper, Symbolize, FH);
+        return Error::success();
+      },
+      [&](const XRayRecord &R) {
+        Writer->write(R);
+        return Error::success();
+      },
+      NumThreads);
+  if (Err)
+    return Err;
+  Writer->finish();
+  return Error::success();
+}
+
 namespace llvm {
 namespace xray {
 
@@ -393,6 +454,21 @@ static CommandRegistration Unused(&Convert, []() -> Error {
     return make_error<StringError>(
         Twine("Cannot open file '") + ConvertOutput + "' for writing.", EC);
 
+  if (ConvertStream) {
+    if (ConvertOutputFormat != ConvertFormats::CHROME_TRACE_EVENT)
+      return make_error<StringError>(
+          "-stream is only supported with -output-format=trace_event",
+          std::make_error_code(std::errc::invalid_argument));
+    if (auto E =
+            TC.exportAsChromeTraceEventFormat(ConvertInput, ConvertJobs, OS))
+      return joinErrors(
+          make_error<StringError>(
+              Twine("Failed converting input file '") + ConvertInput + "'.",
+              std::make_error_code(std::errc::executable_format_error)),
+          std::move(E));
+    return Error::success();
+  }
+
   auto TraceOrErr = loadTraceFile(ConvertInput, ConvertSortInput);
   if (!TraceOrErr)
     return joinErrors(
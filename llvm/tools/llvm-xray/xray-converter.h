@@ -35,6 +35,12 @@ public:
   /// to be in sorted TSC order. The trace event format encodes stack traces, so
   /// the linear history is essential for correct output.
   void exportAsChromeTraceEventFormat(const Trace &Records, raw_ostream &OS);
+
+  /// Converts the log in Filename to the trace event format without loading
+  /// all of its records, decoding the log with NumThreads threads (see
+  /// processTraceFile).
+  Error exportAsChromeTraceEventFormat(StringRef Filename, unsigned NumThreads,
+                                       raw_ostream &OS);
 };
 
 } // namespace xray
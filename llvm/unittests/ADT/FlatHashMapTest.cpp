@@ -0,0 +1,224 @@
+//===- llvm/unittest/ADT/FlatHashMapTest.cpp - FlatHashMap unit tests -----===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/ADT/FlatHashMap.h"
+#include "llvm/ADT/StringRef.h"
+#include "gtest/gtest.h"
+#include <map>
+#include <memory>
+#include <string>
+
+using namespace llvm;
+
+namespace {
+
+TEST(FlatHashMapTest, EmptyMap) {
+  FlatHashMap<unsigned, unsigned> Map;
+  EXPECT_TRUE(Map.empty());
+  EXPECT_EQ(0u, Map.size());
+  EXPECT_EQ(0u, Map.getMemorySize());
+  EXPECT_TRUE(Map.begin() == Map.end());
+  EXPECT_EQ(0u, Map.count(1));
+  EXPECT_TRUE(Map.find(1) == Map.end());
+  EXPECT_EQ(0u, Map.lookup(1));
+  EXPECT_FALSE(Map.erase(1));
+}
+
+TEST(FlatHashMapTest, InsertFindErase) {
+  FlatHashMap<unsigned, unsigned> Map;
+  EXPECT_TRUE(Map.insert(std::make_pair(1u, 2u)).second);
+  EXPECT_FALSE(Map.insert(std::make_pair(1u, 3u)).second);
+  EXPECT_EQ(1u, Map.size());
+  EXPECT_EQ(2u, Map.lookup(1));
+  EXPECT_EQ(2u, Map.find(1)->second);
+
+  Map[4] = 5;
+  EXPECT_EQ(2u, Map.size());
+  EXPECT_EQ(5u, Map[4]);
+
+  EXPECT_TRUE(Map.erase(1));
+  EXPECT_FALSE(Map.erase(1));
+  EXPECT_EQ(1u, Map.size());
+  EXPECT_EQ(0u, Map.count(1));
+
+  Map.erase(Map.find(4));
+  EXPECT_TRUE(Map.empty());
+  EXPECT_TRUE(Map.begin() == Map.end());
+}
+
+// Keys that are the usual DenseMap empty and tombstone keys may be inserted.
+TEST(FlatHashMapTest, NoReservedKeys) {
+  FlatHashMap<unsigned, unsigned> Map;
+  Map[DenseMapInfo<unsigned>::getEmptyKey()] = 1;
+  Map[DenseMapInfo<unsigned>::getTombstoneKey()] = 2;
+  EXPECT_EQ(1u, Map.lookup(DenseMapInfo<unsigned>::getEmptyKey()));
+  EXPECT_EQ(2u, Map.lookup(DenseMapInfo<unsigned>::getTombstoneKey()));
+  EXPECT_EQ(2u, Map.size());
+}
+
+// Compare against std::map across growth, erasure and the reuse of deleted
+// buckets.
+TEST(FlatHashMapTest, MatchesStdMap) {
+  FlatHashMap<unsigned, unsigned> Map;
+  std::map<unsigned, unsigned> Expected;
+  unsigned State = 1;
+  for (unsigned I = 0; I != 20000; ++I) {
+    State = State * 1103515245 + 12345;
+    unsigned Key = (State >> 8) % 2048;
+    if (State & 1) {
+      Map[Key] = I;
+      Expected[Key] = I;
+    } else {
+      EXPECT_EQ(Expected.erase(Key) != 0, Map.erase(Key));
+    }
+    ASSERT_EQ(Expected.size(), Map.size());
+  }
+  for (const auto &KV : Expected)
+    EXPECT_EQ(KV.second, Map.lookup(KV.first));
+
+  unsigned Visited = 0;
+  for (const auto &KV : Map) {
+    EXPECT_EQ(Expected[KV.first], KV.second);
+    ++Visited;
+  }
+  EXPECT_EQ(Expected.size(), Visited);
+}
+
+// Erasing and inserting forever must not grow the map.
+TEST(FlatHashMapTest, DeletedBucketsAreReclaimed) {
+  FlatHashMap<unsigned, unsigned> Map;
+  for (unsigned I = 0; I != 10; ++I)
+    Map[I] = I;
+  size_t Size = Map.getMemorySize();
+  for (unsigned I = 10; I != 100000; ++I) {
+    Map.erase(I - 10);
+    Map[I] = I;
+  }
+  EXPECT_EQ(10u, Map.size());
+  EXPECT_EQ(Size, Map.getMemorySize());
+  for (unsigned I = 100000 - 10; I != 100000; ++I)
+    EXPECT_EQ(I, Map.lookup(I));
+}
+
+TEST(FlatHashMapTest, Reserve) {
+  FlatHashMap<unsigned, unsigned> Map;
+  Map.reserve(1000);
+  size_t Size = Map.getMemorySize();
+  EXPECT_NE(0u, Size);
+  for (unsigned I = 0; I != 1000; ++I)
+    Map[I] = I;
+  EXPECT_EQ(Size, Map.getMemorySize());
+
+  Map.clear();
+  EXPECT_TRUE(Map.empty());
+  EXPECT_EQ(Size, Map.getMemorySize());
+  EXPECT_EQ(0u, Map.count(5));
+}
+
+TEST(FlatHashMapTest, CopyAndMove) {
+  FlatHashMap<unsigned, std::string> Map;
+  for (unsigned I = 0; I != 100; ++I)
+    Map[I] = std::to_string(I);
+
+  FlatHashMap<unsigned, std::string> Copy(Map);
+  EXPECT_EQ(100u, Copy.size());
+  EXPECT_EQ("42", Copy.lookup(42));
+
+  FlatHashMap<unsigned, std::string> Moved(std::move(Copy));
+  EXPECT_EQ(100u, Moved.size());
+  EXPECT_EQ("42", Moved.lookup(42));
+
+  Copy = Moved;
+  EXPECT_EQ("99", Copy.lookup(99));
+  Moved = FlatHashMap<unsigned, std::string>();
+  EXPECT_TRUE(Moved.empty());
+
+  Moved.swap(Copy);
+  EXPECT_TRUE(Copy.empty());
+  EXPECT_EQ("7", Moved.lookup(7));
+}
+
+TEST(FlatHashMapTest, MoveOnlyValues) {
+  FlatHashMap<unsigned, std::unique_ptr<unsigned>> Map;
+  for (unsigned I = 0; I != 100; ++I)
+    Map.try_emplace(I, new unsigned(I));
+  EXPECT_FALSE(Map.try_emplace(5, nullptr).second);
+  for (unsigned I = 0; I != 100; ++I)
+    EXPECT_EQ(I, *Map[I]);
+}
+
+TEST(FlatHashMapTest, PointerAndPairKeys) {
+  unsigned Values[64];
+  FlatHashMap<unsigned *, unsigned> PtrMap;
+  FlatHashMap<std::pair<unsigned, unsigned>, unsigned> PairMap;
+  for (unsigned I = 0; I != 64; ++I) {
+    PtrMap[&Values[I]] = I;
+    PairMap[std::make_pair(I, I * 3)] = I;
+  }
+  for (unsigned I = 0; I != 64; ++I) {
+    EXPECT_EQ(I, PtrMap.lookup(&Values[I]));
+    EXPECT_EQ(I, PairMap.lookup(std::make_pair(I, I * 3)));
+    EXPECT_EQ(0u, PairMap.count(std::make_pair(I, I * 3 + 1)));
+  }
+}
+
+TEST(FlatHashMapTest, StringRefKeys) {
+  std::vector<std::string> Strings;
+  for (unsigned I = 0; I != 500; ++I)
+    Strings.push_back("key" + std::to_string(I));
+  FlatHashMap<StringRef, unsigned> Map;
+  for (unsigned I = 0; I != 500; ++I)
+    Map[Strings[I]] = I;
+  for (unsigned I = 0; I != 500; ++I)
+    EXPECT_EQ(I, Map.lookup("key" + std::to_string(I)));
+  EXPECT_EQ(0u, Map.count("key500"));
+}
+
+// Hashes that collide in their low bits still end up in distinct buckets.
+struct CollidingInfo {
+  static unsigned getHashValue(unsigned Val) { return (Val % 4) << 20; }
+  static bool isEqual(unsigned LHS, unsigned RHS) { return LHS == RHS; }
+};
+
+TEST(FlatHashMapTest, CollidingHashes) {
+  FlatHashMap<unsigned, unsigned, CollidingInfo> Map;
+  for (unsigned I = 0; I != 300; ++I)
+    Map[I] = I + 1;
+  for (unsigned I = 0; I != 300; I += 2)
+    Map.erase(I);
+  for (unsigned I = 0; I != 300; ++I)
+    EXPECT_EQ(I % 2 ? I + 1 : 0u, Map.lookup(I));
+}
+
+// find_as() looks up keys of another type.
+struct IntPtrInfo {
+  static unsigned getHashValue(const std::unique_ptr<int> &Val) {
+    return getHashValue(Val.get());
+  }
+  static unsigned getHashValue(const int *Val) {
+    return DenseMapInfo<const int *>::getHashValue(Val);
+  }
+  static bool isEqual(const std::unique_ptr<int> &LHS,
+                      const std::unique_ptr<int> &RHS) {
+    return LHS == RHS;
+  }
+  static bool isEqual(const int *LHS, const std::unique_ptr<int> &RHS) {
+    return LHS == RHS.get();
+  }
+};
+
+TEST(FlatHashMapTest, FindAs) {
+  FlatHashMap<std::unique_ptr<int>, unsigned, IntPtrInfo> Map;
+  int *P = new int(1);
+  Map.try_emplace(std::unique_ptr<int>(P), 7u);
+  auto I = Map.find_as(static_cast<const int *>(P));
+  ASSERT_TRUE(I != Map.end());
+  EXPECT_EQ(7u, I->second);
+}
+
+} // end anonymous namespace
@@ -0,0 +1,223 @@
+//===---------- ELF_x86_64.cpp - Tests for JITLink ELF/x86-64 -------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "JITLinkTestCommon.h"
+
+#include "llvm/ExecutionEngine/JITLink/ELF_x86_64.h"
+#include "llvm/Testing/Support/Error.h"
+
+#include "gtest/gtest.h"
+
+using namespace llvm;
+using namespace llvm::jitlink;
+using namespace llvm::jitlink::ELF_x86_64_Edges;
+
+namespace {
+
+class JITLinkTest_ELF_x86_64 : public JITLinkTestCommon,
+                               public testing::Test {
+public:
+  using BasicVerifyGraphFunction =
+      std::function<void(AtomGraph &, const MCDisassembler &)>;
+
+  void runBasicVerifyGraphTest(StringRef AsmSrc,
+                               StringMap<JITEvaluatedSymbol> Externals,
+                               BasicVerifyGraphFunction RunGraphTest) {
+    auto TR = getTestResources(AsmSrc, "x86_64-unknown-linux-gnu", true,
+                               false, MCTargetOptions());
+    if (!TR) {
+      dbgs() << "Skipping JITLInk unit test: " << toString(TR.takeError())
+             << "\n";
+      return;
+    }
+
+    auto JTCtx = llvm::make_unique<TestJITLinkContext>(
+        **TR, [&](AtomGraph &G) { RunGraphTest(G, (*TR)->getDisassembler()); });
+
+    JTCtx->externals() = std::move(Externals);
+
+    jitLink_ELF_x86_64(std::move(JTCtx));
+  }
+
+protected:
+  static void verifyIsPointerTo(AtomGraph &G, DefinedAtom &A, Atom &Target) {
+    EXPECT_EQ(A.edges_size(), 1U) << "Incorrect number of edges for pointer";
+    if (A.edges_size() != 1U)
+      return;
+    auto &E = *A.edges().begin();
+    EXPECT_EQ(E.getKind(), Pointer64)
+        << "Expected pointer to have a pointer64 relocation";
+    EXPECT_EQ(&E.getTarget(), &Target) << "Expected edge to point at target";
+    EXPECT_THAT_EXPECTED(readInt<uint64_t>(G, A), HasValue(Target.getAddress()))
+        << "Pointer does not point to target";
+  }
+
+  // Checks that operand \p OpIdx of the instruction that starts \p OpOffset
+  // bytes before the fixup of \p E is the distance to \p Target.
+  static void verifyRel32(const MCDisassembler &Dis, DefinedAtom &A, Edge &E,
+                          size_t OpIdx, size_t OpOffset,
+                          JITTargetAddress Target) {
+    JITTargetAddress FixupAddress = A.getAddress() + E.getOffset();
+    int64_t PCRelDelta = Target - (FixupAddress + 4);
+    EXPECT_THAT_EXPECTED(
+        decodeImmediateOperand(Dis, A, OpIdx, E.getOffset() - OpOffset),
+        HasValue(PCRelDelta));
+  }
+};
+
+} // end anonymous namespace
+
+TEST_F(JITLinkTest_ELF_x86_64, BasicRelocations) {
+  runBasicVerifyGraphTest(
+      R"(
+            .text
+            .globl  bar
+            .p2align        4, 0x90
+            .type   bar,@function
+    bar:
+            callq   baz@PLT
+
+            .globl  foo
+            .p2align        4, 0x90
+            .type   foo,@function
+    foo:
+            callq   bar@PLT
+    foo.1:
+            movq    y@GOTPCREL(%rip), %rcx
+    foo.2:
+            movq    p(%rip), %rdx
+
+            .data
+            .globl  x
+            .p2align        2
+    x:
+            .long   42
+
+            .globl  p
+            .p2align        3
+    p:
+            .quad   x)",
+      {{"y", JITEvaluatedSymbol(0xdeadbeef, JITSymbolFlags::Exported)},
+       {"baz", JITEvaluatedSymbol(0xcafef00d, JITSymbolFlags::Exported)}},
+      [](AtomGraph &G, const MCDisassembler &Dis) {
+        auto &Baz = atom(G, "baz");
+        auto &Y = atom(G, "y");
+
+        auto &Bar = definedAtom(G, "bar");
+        auto &Foo = definedAtom(G, "foo");
+        auto &Foo_1 = definedAtom(G, "foo.1");
+        auto &Foo_2 = definedAtom(G, "foo.2");
+        auto &X = definedAtom(G, "x");
+        auto &P = definedAtom(G, "p");
+
+        EXPECT_TRUE(Bar.isCallable()) << "Expected bar to be callable";
+        EXPECT_FALSE(Foo_1.isGlobal()) << "Expected foo.1 to be local";
+
+        // Check the pointer in p.
+        verifyIsPointerTo(G, P, X);
+
+        // Check that bar calls baz through a stub that jumps through the GOT.
+        {
+          ASSERT_EQ(Bar.edges_size(), 1U)
+              << "Incorrect number of edges for bar";
+          auto &E = *Bar.edges().begin();
+          EXPECT_EQ(E.getKind(), Branch32) << "Unexpected edge kind for bar";
+          ASSERT_TRUE(E.getTarget().isDefined()) << "Edge target is not a stub";
+          verifyRel32(Dis, Bar, E, 0, 1, E.getTarget().getAddress());
+
+          auto &Stub = static_cast<DefinedAtom &>(E.getTarget());
+          ASSERT_EQ(Stub.edges_size(), 1U)
+              << "Expected one edge from stub to GOT entry";
+          auto &StubEdge = *Stub.edges().begin();
+          EXPECT_EQ(StubEdge.getKind(), PCRel32);
+          ASSERT_TRUE(StubEdge.getTarget().isDefined())
+              << "Stub does not jump through a GOT entry";
+          verifyIsPointerTo(G, static_cast<DefinedAtom &>(StubEdge.getTarget()),
+                            Baz);
+          verifyRel32(Dis, Stub, StubEdge, 3, 2,
+                      StubEdge.getTarget().getAddress());
+        }
+
+        // Check that foo calls bar directly.
+        {
+          ASSERT_EQ(Foo.edges_size(), 1U)
+              << "Incorrect number of edges for foo";
+          auto &E = *Foo.edges().begin();
+          EXPECT_EQ(E.getKind(), Branch32);
+          EXPECT_EQ(&E.getTarget(), &Bar) << "Expected foo to call bar";
+          verifyRel32(Dis, Foo, E, 0, 1, Bar.getAddress());
+        }
+
+        // Check the GOT load in foo.1.
+        {
+          ASSERT_EQ(Foo_1.edges_size(), 1U)
+              << "Incorrect number of edges for foo.1";
+          auto &E = *Foo_1.edges().begin();
+          EXPECT_EQ(E.getKind(), PCRel32) << "GOT edge was not fixed up";
+          ASSERT_TRUE(E.getTarget().isDefined())
+              << "GOT entry should be a defined atom";
+          verifyIsPointerTo(G, static_cast<DefinedAtom &>(E.getTarget()), Y);
+          verifyRel32(Dis, Foo_1, E, 4, 3, E.getTarget().getAddress());
+        }
+
+        // Check the PC-relative load of p in foo.2.
+        {
+          ASSERT_EQ(Foo_2.edges_size(), 1U)
+              << "Incorrect number of edges for foo.2";
+          auto &E = *Foo_2.edges().begin();
+          EXPECT_EQ(E.getKind(), PCRel32);
+          verifyRel32(Dis, Foo_2, E, 4, 3, P.getAddress());
+        }
+      });
+}
+
+TEST_F(JITLinkTest_ELF_x86_64, EHFrame) {
+  runBasicVerifyGraphTest(
+      R"(
+            .text
+            .globl  f
+            .p2align        4, 0x90
+            .type   f,@function
+    f:
+            .cfi_startproc
+            pushq   %rbp
+            .cfi_def_cfa_offset 16
+            popq    %rbp
+            retq
+            .cfi_endproc)",
+      {}, [](AtomGraph &G, const MCDisassembler &) {
+        auto &F = definedAtom(G, "f");
+
+        // The FDE of f is kept alive by f.
+        ASSERT_EQ(F.edges_size(), 1U) << "Incorrect number of edges for f";
+        auto &KeepAlive = *F.edges().begin();
+        EXPECT_EQ(KeepAlive.getKind(), Edge::KeepAlive);
+        ASSERT_TRUE(KeepAlive.getTarget().isDefined());
+        auto &FDE = static_cast<DefinedAtom &>(KeepAlive.getTarget());
+        EXPECT_EQ(FDE.getSection().getName(), ".eh_frame");
+
+        // The FDE points back at its CIE, and at f.
+        DefinedAtom *CIE = nullptr;
+        for (auto &E : FDE.edges()) {
+          if (E.getOffset() == 4) {
+            EXPECT_EQ(E.getKind(), NegDelta32);
+            CIE = static_cast<DefinedAtom *>(&E.getTarget());
+          } else if (E.getOffset() == 8) {
+            EXPECT_EQ(E.getKind(), PCRel32);
+            EXPECT_EQ(&E.getTarget(), &F) << "FDE does not describe f";
+            EXPECT_THAT_EXPECTED(readInt<int32_t>(G, FDE, 8),
+                                 HasValue(F.getAddress() -
+                                          (FDE.getAddress() + 8)));
+          }
+        }
+        ASSERT_NE(CIE, nullptr) << "FDE has no edge to its CIE";
+        EXPECT_THAT_EXPECTED(readInt<uint32_t>(G, FDE, 4),
+                             HasValue(FDE.getAddress() + 4 -
+                                      CIE->getAddress()));
+      });
+}
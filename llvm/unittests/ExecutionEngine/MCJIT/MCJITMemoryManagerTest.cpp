@@ -7,6 +7,7 @@
 //===----------------------------------------------------------------------===//
 
 #include "llvm/ExecutionEngine/SectionMemoryManager.h"
+#include "llvm/ExecutionEngine/SlabMemoryMapper.h"
 #include "gtest/gtest.h"
 
 using namespace llvm;
@@ -165,5 +166,59 @@ TEST(MCJITMemoryManagerTest, ManyVariedAllocations) {
   }
 }
 
+TEST(MCJITMemoryManagerTest, SlabAllocations) {
+  const uintptr_t SlabSize = 2 * 1024 * 1024;
+  SlabMemoryMapper Mapper(SlabSize);
+
+  {
+    // Memory managers that share the mapper share its slabs, so the code of
+    // all of them ends up in one slab.
+    SectionMemoryManager MemMgr1(&Mapper), MemMgr2(&Mapper);
+    uint8_t *Code1 = MemMgr1.allocateCodeSection(256, 0, 1, "");
+    uint8_t *Data1 = MemMgr1.allocateDataSection(256, 0, 2, "", false);
+    uint8_t *Code2 = MemMgr2.allocateCodeSection(256, 0, 1, "");
+    ASSERT_NE((uint8_t *)nullptr, Code1);
+    ASSERT_NE((uint8_t *)nullptr, Data1);
+    ASSERT_NE((uint8_t *)nullptr, Code2);
+    EXPECT_EQ(Mapper.getNumSlabs(), 2U) << "Expected a code and a data slab";
+
+    uintptr_t CodeDistance = Code1 < Code2 ? Code2 - Code1 : Code1 - Code2;
+    EXPECT_LT(CodeDistance, SlabSize) << "Code was not allocated in one slab";
+
+    for (unsigned i = 0; i < 256; ++i) {
+      Code1[i] = 1;
+      Data1[i] = 2;
+      Code2[i] = 3;
+    }
+
+    // Blocks larger than half a slab get their own slab.
+    uint8_t *Large = MemMgr2.allocateDataSection(SlabSize, 0, 2, "", true);
+    ASSERT_NE((uint8_t *)nullptr, Large);
+    EXPECT_EQ(Mapper.getNumSlabs(), 3U) << "Expected a slab for large data";
+    Large[0] = Large[SlabSize - 1] = 4;
+
+    std::string Error;
+    EXPECT_FALSE(MemMgr1.finalizeMemory(&Error));
+    EXPECT_FALSE(MemMgr2.finalizeMemory(&Error));
+
+    for (unsigned i = 0; i < 256; ++i) {
+      EXPECT_EQ(1, Code1[i]);
+      EXPECT_EQ(2, Data1[i]);
+      EXPECT_EQ(3, Code2[i]);
+    }
+  }
+
+  // Releasing the memory unmaps the large block's slab, and keeps the current
+  // slabs for reuse.
+  EXPECT_EQ(Mapper.getNumSlabs(), 2U) << "Slabs were not released";
+
+  SectionMemoryManager MemMgr(&Mapper);
+  uint8_t *Code = MemMgr.allocateCodeSection(256, 0, 1, "");
+  ASSERT_NE((uint8_t *)nullptr, Code);
+  for (unsigned i = 0; i < 256; ++i)
+    Code[i] = 5;
+  EXPECT_EQ(Mapper.getNumSlabs(), 2U) << "Current slab was not reused";
+}
+
 } // Namespace
 
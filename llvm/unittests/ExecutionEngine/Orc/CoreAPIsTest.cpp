@@ -769,6 +769,39 @@ TEST_F(CoreAPIsStandardTest, TestLookupWithUnthreadedMaterialization) {
       << "lookup returned incorrect flags";
 }
 
+TEST_F(CoreAPIsStandardTest, TestRepeatedLookupOfReadySymbols) {
+  // Test that lookups of symbols that are already ready (which do not take
+  // the session lock) see the same symbols as the first lookup, honor hidden
+  // symbols, and do not see removed symbols.
+  auto BarHiddenFlags = BarSym.getFlags() & ~JITSymbolFlags::Exported;
+  auto BarHiddenSym = JITEvaluatedSymbol(BarSym.getAddress(), BarHiddenFlags);
+
+  cantFail(JD.define(absoluteSymbols({{Foo, FooSym}, {Bar, BarHiddenSym}})));
+
+  auto &JD2 = ES.createJITDylib("JD2");
+  cantFail(JD2.define(absoluteSymbols({{Bar, QuxSym}})));
+
+  for (unsigned I = 0; I != 2; ++I) {
+    auto Result = cantFail(ES.lookup(JITDylibSearchList({{&JD, true}}),
+                                     {Foo, Bar}));
+    EXPECT_EQ(Result[Foo].getAddress(), FooSym.getAddress())
+        << "Wrong result for \"Foo\"";
+    EXPECT_EQ(Result[Bar].getAddress(), BarSym.getAddress())
+        << "Wrong result for hidden \"Bar\"";
+
+    auto BarResult = cantFail(
+        ES.lookup(JITDylibSearchList({{&JD, false}, {&JD2, false}}), Bar));
+    EXPECT_EQ(BarResult.getAddress(), QuxSym.getAddress())
+        << "Lookup matched a hidden symbol";
+  }
+
+  cantFail(JD.remove({Foo}));
+  auto Result = ES.lookup(JITDylibSearchList({{&JD, false}}), Foo);
+  EXPECT_TRUE(Result.errorIsA<SymbolsNotFound>())
+      << "Lookup found a removed symbol";
+  consumeError(Result.takeError());
+}
+
 TEST_F(CoreAPIsStandardTest, TestLookupWithThreadedMaterialization) {
 #if LLVM_ENABLE_THREADS
 
@@ -0,0 +1,118 @@
+//===------ PersistentObjectCacheTest.cpp - Tests for the object cache ----===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/ExecutionEngine/Orc/PersistentObjectCache.h"
+#include "OrcTestCommon.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/IR/Function.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Target/TargetMachine.h"
+
+using namespace llvm;
+using namespace llvm::orc;
+
+namespace {
+
+class MemoryObjectCacheStore : public ObjectCacheStore {
+public:
+  MemoryObjectCacheStore(StringMap<std::string> &Objects) : Objects(Objects) {}
+
+  std::unique_ptr<MemoryBuffer> load(StringRef Key) override {
+    auto I = Objects.find(Key);
+    if (I == Objects.end())
+      return nullptr;
+    return MemoryBuffer::getMemBufferCopy(I->second);
+  }
+
+  void store(StringRef Key, MemoryBufferRef Obj) override {
+    Objects[Key] = Obj.getBuffer();
+  }
+
+private:
+  StringMap<std::string> &Objects;
+};
+
+TEST(PersistentObjectCacheTest, DirectoryStore) {
+  SmallString<128> Path;
+  ASSERT_FALSE(sys::fs::createUniqueDirectory("orc-object-cache", Path));
+
+  {
+    // Do not prune the objects of the test.
+    CachePruningPolicy Policy;
+    Policy.Interval = None;
+    auto Store = cantFail(DirectoryObjectCacheStore::Create(Path, Policy));
+
+    EXPECT_EQ(Store->load("0123"), nullptr) << "Empty store has an object";
+
+    Store->store("0123", MemoryBufferRef("object", "obj"));
+    auto Obj = Store->load("0123");
+    ASSERT_NE(Obj, nullptr) << "Stored object was not found";
+    EXPECT_EQ(Obj->getBuffer(), "object");
+    EXPECT_EQ(Store->load("4567"), nullptr) << "Wrong object was found";
+
+    // A new store for the same directory sees the object.
+    auto OtherStore = cantFail(DirectoryObjectCacheStore::Create(Path, Policy));
+    auto OtherObj = OtherStore->load("0123");
+    ASSERT_NE(OtherObj, nullptr) << "Object did not persist";
+    EXPECT_EQ(OtherObj->getBuffer(), "object");
+  }
+
+  sys::fs::remove_directories(Path);
+}
+
+TEST(PersistentObjectCacheTest, KeysModules) {
+  // Bails out on error, as it is valid to run this test without any targets
+  // built.
+  OrcNativeTarget::initialize();
+  auto JTMB = JITTargetMachineBuilder::detectHost();
+  if (!JTMB) {
+    consumeError(JTMB.takeError());
+    return;
+  }
+  auto TM = JTMB->createTargetMachine();
+  if (!TM) {
+    consumeError(TM.takeError());
+    return;
+  }
+
+  StringMap<std::string> Objects;
+  PersistentObjectCache Cache(
+      llvm::make_unique<MemoryObjectCacheStore>(Objects), **TM);
+
+  LLVMContext Ctx;
+  Module M("m", Ctx);
+  Function::Create(FunctionType::get(Type::getVoidTy(Ctx), false),
+                   GlobalValue::ExternalLinkage, "f", &M);
+
+  EXPECT_EQ(Cache.getObject(&M), nullptr) << "Empty cache has an object";
+  Cache.notifyObjectCompiled(&M, MemoryBufferRef("object", "obj"));
+  EXPECT_EQ(Objects.size(), 1U) << "Object was not stored";
+  EXPECT_EQ(Objects.count(Cache.getKey(M)), 1U)
+      << "Object was not stored under the key of its module";
+
+  auto Obj = Cache.getObject(&M);
+  ASSERT_NE(Obj, nullptr) << "Object was not found";
+  EXPECT_EQ(Obj->getBuffer(), "object");
+
+  // A different module, or the same module for a different configuration,
+  // misses.
+  Module M2("m", Ctx);
+  Function::Create(FunctionType::get(Type::getVoidTy(Ctx), false),
+                   GlobalValue::ExternalLinkage, "g", &M2);
+  EXPECT_NE(Cache.getKey(M2), Cache.getKey(M));
+  EXPECT_EQ(Cache.getObject(&M2), nullptr) << "Module hit another's object";
+
+  PersistentObjectCache OtherCache(
+      llvm::make_unique<MemoryObjectCacheStore>(Objects), **TM, "v2");
+  EXPECT_NE(OtherCache.getKey(M), Cache.getKey(M))
+      << "Extra key does not change the key";
+}
+
+} // namespace
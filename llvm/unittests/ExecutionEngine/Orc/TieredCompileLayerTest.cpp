@@ -0,0 +1,85 @@
+//===---- TieredCompileLayerTest.cpp - Tests for tiered compilation -------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/ExecutionEngine/Orc/TieredCompileLayer.h"
+#include "OrcTestCommon.h"
+#include "llvm/ExecutionEngine/Orc/LLJIT.h"
+#include "llvm/IR/IRBuilder.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/Module.h"
+#include "gtest/gtest.h"
+
+using namespace llvm;
+using namespace llvm::orc;
+
+namespace {
+
+TEST(TieredCompileLayerTest, HotFunctionIsRecompiled) {
+  // Bails out on error, as it is valid to run this test without any targets
+  // built.
+  OrcNativeTarget::initialize();
+  auto JTMB = orc::JITTargetMachineBuilder::detectHost();
+  if (!JTMB) {
+    consumeError(JTMB.takeError());
+    return;
+  }
+
+  // Make the "optimized" f return 7 instead of 42, so that the test can tell
+  // which tier it called.
+  unsigned NumRecompiles = 0;
+  auto OptTransform = [&](ThreadSafeModule TSM,
+                          const MaterializationResponsibility &R)
+      -> Expected<ThreadSafeModule> {
+    ++NumRecompiles;
+    auto &M = *TSM.getModule();
+    for (auto &F : M)
+      for (auto &BB : F)
+        if (auto *Ret = dyn_cast<ReturnInst>(BB.getTerminator()))
+          Ret->setOperand(0, ConstantInt::get(Type::getInt32Ty(M.getContext()),
+                                              7));
+    return std::move(TSM);
+  };
+
+  auto J = LLLazyJITBuilder()
+               .setJITTargetMachineBuilder(*JTMB)
+               .setTieredCompilation(2, *JTMB, std::move(OptTransform))
+               .create();
+  if (!J) {
+    consumeError(J.takeError());
+    return;
+  }
+
+  auto Ctx = llvm::make_unique<LLVMContext>();
+  auto M = llvm::make_unique<Module>("m", *Ctx);
+  auto *F = Function::Create(
+      FunctionType::get(Type::getInt32Ty(*Ctx), false),
+      GlobalValue::ExternalLinkage, "f", M.get());
+  IRBuilder<> B(BasicBlock::Create(*Ctx, "entry", F));
+  B.CreateRet(B.getInt32(42));
+
+  cantFail((*J)->addLazyIRModule(
+      ThreadSafeModule(std::move(M), std::move(Ctx))));
+
+  auto FSym = cantFail((*J)->lookup("f"));
+  auto *FPtr = reinterpret_cast<int (*)()>(
+      static_cast<uintptr_t>(FSym.getAddress()));
+
+  EXPECT_EQ(FPtr(), 42) << "Cold call did not reach the tier-1 code";
+  EXPECT_EQ(NumRecompiles, 0U) << "Cold function was recompiled";
+
+  // Without compile threads, the hot call recompiles f before it returns.
+  EXPECT_EQ(FPtr(), 42) << "Hot call did not reach the tier-1 code";
+  EXPECT_EQ(NumRecompiles, 1U) << "Hot function was not recompiled";
+
+  EXPECT_EQ(FPtr(), 7) << "Stub was not pointed at the optimized code";
+  EXPECT_EQ(FPtr(), 7);
+  EXPECT_EQ(NumRecompiles, 1U) << "Hot function was recompiled again";
+}
+
+} // namespace
@@ -328,6 +328,39 @@ TEST_P(CoverageMappingTest, load_coverage_for_more_than_two_files) {
   }
 }
 
+TEST_P(CoverageMappingTest, load_coverage_for_file_ignores_other_files) {
+  ProfileWriter.addRecord({"func1", 0x1234, {10}}, Err);
+  ProfileWriter.addRecord({"func2", 0x2345, {20}}, Err);
+  ProfileWriter.addRecord({"func3", 0x3456, {30}}, Err);
+
+  startFunction("func1", 0x1234);
+  addCMR(Counter::getCounter(0), "foo", 1, 1, 5, 5);
+
+  startFunction("func2", 0x2345);
+  addCMR(Counter::getCounter(0), "bar", 2, 2, 6, 6);
+
+  startFunction("func3", 0x3456);
+  addCMR(Counter::getCounter(0), "foo", 7, 1, 9, 1);
+
+  EXPECT_THAT_ERROR(loadCoverageMapping(), Succeeded());
+
+  CoverageData Data = LoadedCoverage->getCoverageForFile("foo");
+  std::vector<CoverageSegment> Segments(Data.begin(), Data.end());
+  ASSERT_EQ(4U, Segments.size());
+  EXPECT_EQ(CoverageSegment(1, 1, 10, true), Segments[0]);
+  EXPECT_EQ(CoverageSegment(5, 5, false), Segments[1]);
+  EXPECT_EQ(CoverageSegment(7, 1, 30, true), Segments[2]);
+  EXPECT_EQ(CoverageSegment(9, 1, false), Segments[3]);
+
+  std::vector<InstantiationGroup> InstantiationGroups =
+      LoadedCoverage->getInstantiationGroups("bar");
+  ASSERT_EQ(1U, InstantiationGroups.size());
+  EXPECT_EQ("func2", InstantiationGroups[0].getName());
+
+  EXPECT_TRUE(LoadedCoverage->getCoverageForFile("baz").empty());
+  EXPECT_TRUE(LoadedCoverage->getInstantiationGroups("baz").empty());
+}
+
 TEST_P(CoverageMappingTest, load_coverage_with_bogus_function_name) {
   ProfileWriter.addRecord({"", 0x1234, {10}}, Err);
   startFunction("", 0x1234);
@@ -824,6 +824,28 @@ TEST_P(MaybeSparseInstrProfTest, get_weighted_function_counts) {
   ASSERT_EQ(20U, Counts[1]);
 }
 
+TEST_F(InstrProfTest, scale_by_fraction) {
+  InstrProfRecord Record({1, 3, 7, (1ULL << 63) + 1});
+  bool Overflowed = false;
+  Record.scale(3, 4, [&](instrprof_error E) {
+    Overflowed |= E == instrprof_error::counter_overflow;
+  });
+  // Counts are rounded down, and large counts are scaled down without
+  // overflowing.
+  ASSERT_FALSE(Overflowed);
+  ASSERT_EQ(0U, Record.Counts[0]);
+  ASSERT_EQ(2U, Record.Counts[1]);
+  ASSERT_EQ(5U, Record.Counts[2]);
+  ASSERT_EQ(3ULL << 61, Record.Counts[3]);
+
+  Record.scale(5, 1, [&](instrprof_error E) {
+    Overflowed |= E == instrprof_error::counter_overflow;
+  });
+  ASSERT_TRUE(Overflowed);
+  ASSERT_EQ(10U, Record.Counts[1]);
+  ASSERT_EQ(std::numeric_limits<uint64_t>::max(), Record.Counts[3]);
+}
+
 // Testing symtab creator interface used by indexed profile reader.
 TEST_P(MaybeSparseInstrProfTest, instr_prof_symtab_test) {
   std::vector<StringRef> FuncNames;
@@ -323,6 +323,55 @@ TEST_F(SampleProfTest, sample_overflow_saturation) {
   ASSERT_EQ(BodySamples.get(), Max);
 }
 
+TEST_F(SampleProfTest, context_sensitive_text_profile) {
+  const char *Input = "main:400:10\n"
+                      " 3: 100\n"
+                      "[main:3 @ _Z3fooi]:200:20\n"
+                      " 1: 20\n"
+                      "[main:3 @ _Z3fooi:2.1 @ _Z3bari]:50:5\n"
+                      " 1: 5\n";
+  std::unique_ptr<MemoryBuffer> Buffer = MemoryBuffer::getMemBuffer(Input);
+  auto ReaderOrErr = SampleProfileReader::create(Buffer, Context);
+  ASSERT_TRUE(NoError(ReaderOrErr.getError()));
+  Reader = std::move(ReaderOrErr.get());
+  ASSERT_TRUE(NoError(Reader->read()));
+  ASSERT_TRUE(Reader->profileIsCS());
+
+  FunctionSamples *Main = Reader->getSamplesFor("main");
+  ASSERT_TRUE(Main != nullptr);
+  ASSERT_TRUE(Main->getContext().empty());
+
+  FunctionSamples *Foo = Reader->getSamplesFor("main:3 @ _Z3fooi");
+  ASSERT_TRUE(Foo != nullptr);
+  ASSERT_EQ("_Z3fooi", Foo->getName());
+  ASSERT_EQ(200u, Foo->getTotalSamples());
+
+  std::string BarContext = SampleContext::getCalleeContext(
+      Foo->getContext(), LineLocation(2, 1), "_Z3bari");
+  ASSERT_EQ("main:3 @ _Z3fooi:2.1 @ _Z3bari", BarContext);
+  FunctionSamples *Bar = Reader->getSamplesFor(BarContext);
+  ASSERT_TRUE(Bar != nullptr);
+  ASSERT_EQ("_Z3bari", Bar->getName());
+  ASSERT_EQ(5u, Bar->getHeadSamples());
+
+  // Contexts are written back in brackets by the text writer, and are not
+  // supported by the binary formats.
+  std::string Output;
+  std::unique_ptr<raw_ostream> OS(new raw_string_ostream(Output));
+  auto WriterOrErr = SampleProfileWriter::create(OS, SPF_Text);
+  ASSERT_TRUE(NoError(WriterOrErr.getError()));
+  ASSERT_TRUE(NoError(WriterOrErr.get()->write(*Foo)));
+  WriterOrErr.get()->getOutputStream().flush();
+  ASSERT_EQ("[main:3 @ _Z3fooi]:200:20\n 1: 20\n", Output);
+
+  std::string BinaryOutput;
+  OS.reset(new raw_string_ostream(BinaryOutput));
+  WriterOrErr = SampleProfileWriter::create(OS, SPF_Binary);
+  ASSERT_TRUE(NoError(WriterOrErr.getError()));
+  ASSERT_EQ(std::error_code(sampleprof_error::unsupported_writing_format),
+            WriterOrErr.get()->write(*Foo));
+}
+
 TEST_F(SampleProfTest, default_suffix_elision_text) {
   // Default suffix elision policy: strip everything after first dot.
   // This implies that all suffix variants will map to "foo", so
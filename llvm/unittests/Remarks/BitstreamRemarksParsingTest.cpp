@@ -0,0 +1,212 @@
+//===- unittest/Remarks/BitstreamRemarksParsingTest.cpp - Bitstream tests -===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm-c/Remarks.h"
+#include "llvm/Remarks/Remark.h"
+#include "llvm/Remarks/RemarkParser.h"
+#include "llvm/Remarks/RemarkSerializer.h"
+#include "gtest/gtest.h"
+
+using namespace llvm;
+
+/// Make a remark using \p Args as the storage for its arguments.
+static remarks::Remark
+makeInlineRemark(SmallVectorImpl<remarks::Argument> &Args, StringRef Callee,
+                 unsigned Line) {
+  Args.clear();
+  Args.push_back({"Callee", Callee, None});
+  Args.push_back({"String", " will not be inlined into ", None});
+  Args.push_back({"Caller", "foo", remarks::RemarkLocation{"file.c", 2, 0}});
+  Args.push_back({"String", " because its definition is unavailable", None});
+
+  remarks::Remark R;
+  R.RemarkType = remarks::Type::Missed;
+  R.PassName = "inline";
+  R.RemarkName = "NoDefinition";
+  R.FunctionName = "foo";
+  R.Loc = remarks::RemarkLocation{"file.c", Line, 12};
+  R.Hotness = 4;
+  R.Args = Args;
+  return R;
+}
+
+static std::string serialize(ArrayRef<remarks::Remark> Remarks) {
+  std::string Buf;
+  raw_string_ostream OS(Buf);
+  remarks::BitstreamSerializer Serializer(OS);
+  for (const remarks::Remark &R : Remarks)
+    Serializer.emit(R);
+  return OS.str();
+}
+
+static std::string parseError(StringRef Buf) {
+  remarks::Parser Parser(remarks::ParserFormat::Bitstream, Buf);
+  Expected<const remarks::Remark *> Remark = Parser.getNext();
+  EXPECT_FALSE(Remark); // Expect an error here.
+  if (Remark)
+    return "";
+  return toString(Remark.takeError());
+}
+
+TEST(BitstreamRemarks, ParsingEmpty) {
+  std::string Buf = serialize({});
+  // The magic number, the block info and the META_BLOCK, in 32-bit words.
+  EXPECT_EQ(Buf.size() % 4, 0U);
+
+  remarks::Parser Parser(remarks::ParserFormat::Bitstream, Buf);
+  Expected<const remarks::Remark *> Remark = Parser.getNext();
+  EXPECT_FALSE(errorToBool(Remark.takeError()));
+  EXPECT_EQ(*Remark, nullptr);
+}
+
+TEST(BitstreamRemarks, ParsingGood) {
+  SmallVector<remarks::Argument, 4> Args[2];
+  remarks::Remark Remarks[] = {makeInlineRemark(Args[0], "bar", 3),
+                               makeInlineRemark(Args[1], "baz", 7)};
+  Remarks[1].Hotness = None;
+  Remarks[1].RemarkType = remarks::Type::AnalysisAliasing;
+  std::string Buf = serialize(Remarks);
+
+  remarks::Parser Parser(remarks::ParserFormat::Bitstream, Buf);
+  for (const remarks::Remark &Expected : Remarks) {
+    auto RemarkOrErr = Parser.getNext();
+    EXPECT_FALSE(errorToBool(RemarkOrErr.takeError()));
+    ASSERT_TRUE(*RemarkOrErr != nullptr);
+
+    const remarks::Remark &Remark = **RemarkOrErr;
+    EXPECT_EQ(Remark.RemarkType, Expected.RemarkType);
+    EXPECT_EQ(Remark.PassName, "inline");
+    EXPECT_EQ(Remark.RemarkName, "NoDefinition");
+    EXPECT_EQ(Remark.FunctionName, "foo");
+    ASSERT_TRUE(Remark.Loc);
+    EXPECT_EQ(Remark.Loc->SourceFilePath, "file.c");
+    EXPECT_EQ(Remark.Loc->SourceLine, Expected.Loc->SourceLine);
+    EXPECT_EQ(Remark.Loc->SourceColumn, 12U);
+    EXPECT_EQ(Remark.Hotness, Expected.Hotness);
+    ASSERT_EQ(Remark.Args.size(), 4U);
+    EXPECT_EQ(Remark.Args[0].Key, "Callee");
+    EXPECT_EQ(Remark.Args[0].Val, Expected.Args[0].Val);
+    EXPECT_FALSE(Remark.Args[0].Loc);
+    EXPECT_EQ(Remark.Args[1].Val, " will not be inlined into ");
+    EXPECT_EQ(Remark.Args[2].Key, "Caller");
+    EXPECT_EQ(Remark.Args[2].Val, "foo");
+    ASSERT_TRUE(Remark.Args[2].Loc);
+    EXPECT_EQ(Remark.Args[2].Loc->SourceFilePath, "file.c");
+    EXPECT_EQ(Remark.Args[2].Loc->SourceLine, 2U);
+    EXPECT_EQ(Remark.Args[2].Loc->SourceColumn, 0U);
+    EXPECT_EQ(Remark.Args[3].Val, " because its definition is unavailable");
+    EXPECT_EQ(Remark.getArgsAsMsg(),
+              (Expected.Args[0].Val + " will not be inlined into foo because "
+               "its definition is unavailable").str());
+  }
+
+  auto RemarkOrErr = Parser.getNext();
+  EXPECT_FALSE(errorToBool(RemarkOrErr.takeError()));
+  EXPECT_EQ(*RemarkOrErr, nullptr);
+}
+
+TEST(BitstreamRemarks, StringsAreEmittedOnce) {
+  SmallVector<remarks::Argument, 4> Args;
+  remarks::Remark R = makeInlineRemark(Args, "bar", 3);
+  std::string One = serialize(R);
+  remarks::Remark Remarks[] = {R, R};
+  std::string Two = serialize(Remarks);
+  // The second remark only references the strings of the first one.
+  EXPECT_LT(Two.size() - One.size(), One.size() / 2);
+  EXPECT_EQ(StringRef(Two).count("definition is unavailable"), 1U);
+}
+
+TEST(BitstreamRemarks, ParsingBadMagic) {
+  EXPECT_EQ(parseError("REMARKS"), "Unknown magic number: expecting RMRK.");
+}
+
+TEST(BitstreamRemarks, ParsingTruncated) {
+  SmallVector<remarks::Argument, 4> Args;
+  std::string Buf = serialize(makeInlineRemark(Args, "bar", 3));
+  remarks::Parser Parser(remarks::ParserFormat::Bitstream,
+                         StringRef(Buf).drop_back(8));
+  Expected<const remarks::Remark *> Remark = Parser.getNext();
+  EXPECT_FALSE(Remark);
+  consumeError(Remark.takeError());
+  // Once an error occurred, the parser stops.
+  Remark = Parser.getNext();
+  EXPECT_FALSE(errorToBool(Remark.takeError()));
+  EXPECT_EQ(*Remark, nullptr);
+}
+
+TEST(BitstreamRemarks, ParsingMetaSection) {
+  std::string Buf;
+  raw_string_ostream OS(Buf);
+  remarks::BitstreamSerializer Serializer(OS);
+  std::string Section;
+  raw_string_ostream SectionOS(Section);
+  Serializer.emitMetaSection(SectionOS, "/path/to/a.opt.bitstream");
+  // Concatenate the sections of two objects, with some padding.
+  Section.append(4, '\0');
+  Serializer.emitMetaSection(SectionOS, "/path/to/b.opt.bitstream");
+  SectionOS.flush();
+
+  Expected<std::vector<StringRef>> Files =
+      remarks::parseBitstreamRemarksSection(Section);
+  ASSERT_FALSE(errorToBool(Files.takeError()));
+  ASSERT_EQ(Files->size(), 2U);
+  EXPECT_EQ((*Files)[0], "/path/to/a.opt.bitstream");
+  EXPECT_EQ((*Files)[1], "/path/to/b.opt.bitstream");
+
+  // A remarks file is not a remarks section.
+  Files = remarks::parseBitstreamRemarksSection(OS.str());
+  EXPECT_FALSE(Files);
+  EXPECT_EQ(toString(Files.takeError()),
+            "Error while parsing META_BLOCK: expecting META_BLOCK.");
+}
+
+TEST(BitstreamRemarks, ContainerTypeMismatch) {
+  std::string Buf;
+  raw_string_ostream OS(Buf);
+  remarks::BitstreamSerializer Serializer(OS);
+  std::string Section;
+  raw_string_ostream SectionOS(Section);
+  Serializer.emitMetaSection(SectionOS, "/path/to/a.opt.bitstream");
+  EXPECT_EQ(parseError(SectionOS.str()),
+            "Error while parsing META_BLOCK: unexpected container type.");
+}
+
+TEST(BitstreamRemarks, ParsingExternalStrTab) {
+  SmallVector<remarks::Argument, 4> Args;
+  std::string Buf = serialize(makeInlineRemark(Args, "bar", 3));
+  remarks::ParsedStringTable StrTab(StringRef("inline"));
+  remarks::Parser Parser(remarks::ParserFormat::Bitstream, Buf, StrTab);
+  Expected<const remarks::Remark *> Remark = Parser.getNext();
+  EXPECT_FALSE(Remark);
+  EXPECT_EQ(toString(Remark.takeError()),
+            "bitstream remarks do not use an external string table.");
+}
+
+TEST(BitstreamRemarks, CAPI) {
+  SmallVector<remarks::Argument, 4> Args;
+  std::string Buf = serialize(makeInlineRemark(Args, "bar", 3));
+  LLVMRemarkParserRef Parser =
+      LLVMRemarkParserCreateBitstream(Buf.data(), Buf.size());
+  LLVMRemarkEntryRef Remark = LLVMRemarkParserGetNext(Parser);
+  ASSERT_TRUE(Remark != nullptr);
+  EXPECT_EQ(LLVMRemarkEntryGetType(Remark), LLVMRemarkTypeMissed);
+  LLVMRemarkStringRef PassName = LLVMRemarkEntryGetPassName(Remark);
+  EXPECT_EQ(StringRef(LLVMRemarkStringGetData(PassName),
+                      LLVMRemarkStringGetLen(PassName)),
+            "inline");
+  EXPECT_EQ(LLVMRemarkEntryGetNumArgs(Remark), 4U);
+  EXPECT_EQ(LLVMRemarkParserGetNext(Parser), nullptr);
+  EXPECT_FALSE(LLVMRemarkParserHasError(Parser));
+  LLVMRemarkParserDispose(Parser);
+
+  Parser = LLVMRemarkParserCreateBitstream(Buf.data(), 4);
+  EXPECT_EQ(LLVMRemarkParserGetNext(Parser), nullptr);
+  EXPECT_TRUE(LLVMRemarkParserHasError(Parser));
+  EXPECT_NE(StringRef(LLVMRemarkParserGetErrorMessage(Parser)), "");
+  LLVMRemarkParserDispose(Parser);
+}
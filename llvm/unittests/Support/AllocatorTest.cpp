@@ -7,8 +7,13 @@
 //===----------------------------------------------------------------------===//
 
 #include "llvm/Support/Allocator.h"
+#include "llvm/Config/llvm-config.h"
+#include "llvm/Support/ConcurrentBumpPtrAllocator.h"
 #include "gtest/gtest.h"
+#include <algorithm>
 #include <cstdlib>
+#include <thread>
+#include <vector>
 
 using namespace llvm;
 
@@ -184,4 +189,71 @@ TEST(AllocatorTest, TestBigAlignment) {
   EXPECT_GT(MockSlabAllocator::GetLastSlabSize(), 4096u);
 }
 
+#if LLVM_ENABLE_THREADS
+// Allocate from several threads at once, including more threads than the
+// allocator has lock-free slots for.
+TEST(AllocatorTest, ConcurrentBumpPtrAllocator) {
+  ConcurrentBumpPtrAllocator Alloc(/*MaxThreads=*/2);
+  std::atomic<ptrdiff_t> SlabBytes{0};
+  Alloc.setSlabCallback([&](ptrdiff_t Delta) { SlabBytes += Delta; });
+
+  constexpr unsigned NumThreads = 6, NumAllocs = 1000;
+  std::vector<std::vector<uint64_t *>> Ptrs(NumThreads);
+  std::vector<std::thread> Threads;
+  for (unsigned T = 0; T != NumThreads; ++T) {
+    Threads.emplace_back([&, T] {
+      for (unsigned I = 0; I != NumAllocs; ++I) {
+        uint64_t *P = Alloc.Allocate<uint64_t>(I % 7 + 1);
+        EXPECT_EQ(0u, reinterpret_cast<uintptr_t>(P) % alignof(uint64_t));
+        *P = T * NumAllocs + I;
+        Ptrs[T].push_back(P);
+      }
+    });
+  }
+  for (std::thread &T : Threads)
+    T.join();
+
+  std::vector<uint64_t *> All;
+  for (unsigned T = 0; T != NumThreads; ++T) {
+    for (unsigned I = 0; I != NumAllocs; ++I)
+      EXPECT_EQ(T * NumAllocs + I, *Ptrs[T][I]);
+    All.insert(All.end(), Ptrs[T].begin(), Ptrs[T].end());
+  }
+  std::sort(All.begin(), All.end());
+  EXPECT_TRUE(std::adjacent_find(All.begin(), All.end()) == All.end());
+
+  EXPECT_GE(Alloc.getBytesAllocated(), NumThreads * NumAllocs * 8);
+  EXPECT_GE(Alloc.getTotalMemory(), Alloc.getBytesAllocated());
+  EXPECT_EQ(SlabBytes, static_cast<ptrdiff_t>(Alloc.getTotalMemory()));
+
+  // Reset keeps one slab per thread.
+  Alloc.Reset();
+  EXPECT_EQ(0u, Alloc.getBytesAllocated());
+  EXPECT_EQ(NumThreads * 4096u, Alloc.getTotalMemory());
+  EXPECT_EQ(SlabBytes, static_cast<ptrdiff_t>(Alloc.getTotalMemory()));
+}
+
+struct DestructorCounter {
+  static std::atomic<unsigned> NumDestroyed;
+  ~DestructorCounter() { ++NumDestroyed; }
+};
+std::atomic<unsigned> DestructorCounter::NumDestroyed;
+
+TEST(AllocatorTest, ConcurrentSpecificBumpPtrAllocator) {
+  ConcurrentSpecificBumpPtrAllocator<DestructorCounter> Alloc;
+  std::vector<std::thread> Threads;
+  for (unsigned T = 0; T != 4; ++T)
+    Threads.emplace_back([&] {
+      for (unsigned I = 0; I != 1000; ++I)
+        new (Alloc.Allocate()) DestructorCounter();
+    });
+  for (std::thread &T : Threads)
+    T.join();
+
+  DestructorCounter::NumDestroyed = 0;
+  Alloc.DestroyAll();
+  EXPECT_EQ(4000u, DestructorCounter::NumDestroyed);
+}
+#endif
+
 }  // anonymous namespace
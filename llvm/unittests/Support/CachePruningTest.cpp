@@ -7,7 +7,12 @@
 //===----------------------------------------------------------------------===//
 
 #include "llvm/Support/CachePruning.h"
+#include "llvm/Support/Chrono.h"
 #include "llvm/Support/Error.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/raw_ostream.h"
 #include "gtest/gtest.h"
 
 using namespace llvm;
@@ -72,6 +77,18 @@ TEST(CachePruningPolicyParser, Multiple) {
   EXPECT_EQ(50u, P->MaxSizePercentageOfAvailableSpace);
 }
 
+TEST(CachePruningPolicyParser, Incremental) {
+  auto P = parseCachePruningPolicy("");
+  ASSERT_TRUE(bool(P));
+  EXPECT_FALSE(P->Incremental);
+  P = parseCachePruningPolicy("prune_incremental=1");
+  ASSERT_TRUE(bool(P));
+  EXPECT_TRUE(P->Incremental);
+  P = parseCachePruningPolicy("prune_incremental=0");
+  ASSERT_TRUE(bool(P));
+  EXPECT_FALSE(P->Incremental);
+}
+
 TEST(CachePruningPolicyParser, Errors) {
   EXPECT_EQ("Duration must not be empty",
             toString(parseCachePruningPolicy("prune_interval=").takeError()));
@@ -91,6 +108,102 @@ TEST(CachePruningPolicyParser, Errors) {
   EXPECT_EQ(
       "'foo' not an integer",
       toString(parseCachePruningPolicy("cache_size_bytes=foom").takeError()));
+  EXPECT_EQ(
+      "'2' must be 0 or 1",
+      toString(parseCachePruningPolicy("prune_incremental=2").takeError()));
   EXPECT_EQ("Unknown key: 'foo'",
             toString(parseCachePruningPolicy("foo=bar").takeError()));
 }
+
+namespace {
+struct CachePruningTest : ::testing::Test {
+  SmallString<128> Dir;
+
+  void SetUp() override {
+    ASSERT_FALSE(sys::fs::createUniqueDirectory("cache-pruning-test", Dir));
+  }
+
+  void TearDown() override { sys::fs::remove_directories(Dir); }
+
+  std::string path(StringRef Name) {
+    SmallString<128> Path(Dir);
+    sys::path::append(Path, Name);
+    return Path.str();
+  }
+
+  void write(StringRef Name, StringRef Contents, bool Append = false) {
+    std::error_code EC;
+    raw_fd_ostream OS(path(Name), EC,
+                      Append ? sys::fs::F_Append : sys::fs::F_None);
+    ASSERT_FALSE(EC);
+    OS << Contents;
+  }
+
+  std::string read(StringRef Name) {
+    auto Buf = MemoryBuffer::getFile(path(Name));
+    return Buf ? (*Buf)->getBuffer().str() : "";
+  }
+
+  bool exists(StringRef Name) { return sys::fs::exists(path(Name)); }
+};
+} // namespace
+
+TEST_F(CachePruningTest, Incremental) {
+  write("llvmcache-a", "a");
+  write("llvmcache-b", "bb");
+
+  // The uses of the entries are only recorded for the incremental pruning.
+  recordCacheEntryUse(path("llvmcache-a"), 1);
+  EXPECT_FALSE(exists("llvmcache.journal"));
+
+  // The first incremental pruning scans the directory to start the journal.
+  CachePruningPolicy Policy;
+  Policy.Interval = std::chrono::seconds(0);
+  Policy.Incremental = true;
+  EXPECT_TRUE(pruneCache(Dir, Policy));
+  EXPECT_TRUE(exists("llvmcache-a"));
+  EXPECT_TRUE(exists("llvmcache-b"));
+  std::string Journal = read("llvmcache.journal");
+  EXPECT_NE(std::string::npos, Journal.find(" 1 llvmcache-a\n"));
+  EXPECT_NE(std::string::npos, Journal.find(" 2 llvmcache-b\n"));
+
+  // From then on, the journal tells when the entries were used, whatever
+  // their access time, and the entries that are not in it are left alone.
+  write("llvmcache-c", "ccc");
+  write("llvmcache-d", "dddd");
+  write("llvmcache.journal",
+        std::to_string(sys::toTimeT(std::chrono::system_clock::now() -
+                                    std::chrono::hours(30 * 24))) +
+            " 3 llvmcache-c\n",
+        /*Append=*/true);
+  recordCacheEntryUse(path("llvmcache-a"), 1);
+  EXPECT_TRUE(pruneCacheAsync(Dir, Policy).get());
+  EXPECT_TRUE(exists("llvmcache-a"));
+  EXPECT_TRUE(exists("llvmcache-b"));
+  EXPECT_FALSE(exists("llvmcache-c"));
+  EXPECT_TRUE(exists("llvmcache-d"));
+  EXPECT_FALSE(exists("llvmcache.journal.pruning"));
+  Journal = read("llvmcache.journal");
+  EXPECT_NE(std::string::npos, Journal.find(" 1 llvmcache-a\n"));
+  EXPECT_NE(std::string::npos, Journal.find(" 2 llvmcache-b\n"));
+  EXPECT_EQ(std::string::npos, Journal.find("llvmcache-c"));
+
+  // The eviction order follows the journal.
+  write("llvmcache.journal",
+        std::to_string(sys::toTimeT(std::chrono::system_clock::now() +
+                                    std::chrono::hours(1))) +
+            " 1 llvmcache-a\n",
+        /*Append=*/true);
+  Policy.MaxSizeFiles = 1;
+  EXPECT_TRUE(pruneCache(Dir, Policy));
+  EXPECT_TRUE(exists("llvmcache-a"));
+  EXPECT_FALSE(exists("llvmcache-b"));
+  EXPECT_TRUE(exists("llvmcache-d"));
+
+  // The non-incremental pruning drops the journal.
+  Policy.Incremental = false;
+  Policy.MaxSizeFiles = 0;
+  EXPECT_TRUE(pruneCache(Dir, Policy));
+  EXPECT_FALSE(exists("llvmcache.journal"));
+  EXPECT_TRUE(exists("llvmcache-d"));
+}
@@ -118,6 +118,31 @@ TEST(FileOutputBuffer, Test) {
   EXPECT_TRUE(IsExecutable);
   ASSERT_NO_ERROR(fs::remove(File4.str()));
 
+  // TEST 5: Verify dontNeed() does not lose written data.
+  SmallString<128> File5(TestDirectory);
+  File5.append("/file5");
+  {
+    Expected<std::unique_ptr<FileOutputBuffer>> BufferOrErr =
+        FileOutputBuffer::create(File5, 81920);
+    ASSERT_NO_ERROR(errorToErrorCode(BufferOrErr.takeError()));
+    std::unique_ptr<FileOutputBuffer> &Buffer = *BufferOrErr;
+    memset(Buffer->getBufferStart(), 'A', Buffer->getBufferSize());
+    Buffer->dontNeed(0, Buffer->getBufferSize());
+    // Write to the middle of the buffer after the hint.
+    memcpy(Buffer->getBufferStart() + 40960, "BBBB", 4);
+    ASSERT_NO_ERROR(errorToErrorCode(Buffer->commit()));
+  }
+  {
+    ErrorOr<std::unique_ptr<MemoryBuffer>> BufOrErr =
+        MemoryBuffer::getFile(File5);
+    ASSERT_TRUE(bool(BufOrErr));
+    StringRef Data = (*BufOrErr)->getBuffer();
+    ASSERT_EQ(Data.size(), 81920U);
+    EXPECT_EQ(Data.count('A'), 81916U);
+    EXPECT_EQ(Data.substr(40960, 4), "BBBB");
+  }
+  ASSERT_NO_ERROR(fs::remove(File5.str()));
+
   // Clean up.
   ASSERT_NO_ERROR(fs::remove(TestDirectory.str()));
 }
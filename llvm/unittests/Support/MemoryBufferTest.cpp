@@ -212,6 +212,11 @@ TEST_F(MemoryBufferTest, slice) {
   EXPECT_TRUE(BufData.substr(0x2FF8,8).equals("abcdefgh"));
   EXPECT_TRUE(BufData.substr(0x3000,8).equals("ABCDEFGH"));
   EXPECT_TRUE(BufData.substr(0x3FF8,8).equals("ABCDEFGH"));
+
+  // Access hints do not change the contents.
+  MB.get()->advise(sys::fs::mapped_file_region::willneed);
+  MB.get()->advise(sys::fs::mapped_file_region::sequential);
+  EXPECT_TRUE(BufData.substr(0x1000,8).equals("abcdefgh"));
    
   // Try non-page aligned.
   ErrorOr<OwningBuffer> MB2 = MemoryBuffer::getFileSlice(TestPath.str(),
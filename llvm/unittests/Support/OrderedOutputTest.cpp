@@ -0,0 +1,66 @@
+//===- llvm/unittest/Support/OrderedOutputTest.cpp - OrderedOutput tests --===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/Support/OrderedOutput.h"
+#include "llvm/Support/Parallel.h"
+#include "gtest/gtest.h"
+#include <string>
+
+using namespace llvm;
+
+namespace {
+
+TEST(OrderedOutputTest, WritesInChunkOrder) {
+  std::string Result;
+  raw_string_ostream OS(Result);
+  {
+    OrderedOutput Out(OS, 3);
+    Out.getChunk(2) << "c";
+    Out.finishChunk(2);
+    Out.getChunk(1) << "b";
+    Out.finishChunk(1);
+    EXPECT_EQ("", OS.str());
+
+    Out.getChunk(0) << "a";
+    Out.finishChunk(0);
+    EXPECT_EQ("abc", OS.str());
+  }
+  EXPECT_EQ("abc", OS.str());
+}
+
+TEST(OrderedOutputTest, WritesUnfinishedChunksOnDestruction) {
+  std::string Result;
+  raw_string_ostream OS(Result);
+  {
+    OrderedOutput Out(OS, 3);
+    Out.getChunk(0) << "a";
+    Out.finishChunk(0);
+    EXPECT_EQ("a", OS.str());
+    Out.getChunk(2) << "c";
+    Out.getChunk(1) << "b";
+  }
+  EXPECT_EQ("abc", OS.str());
+}
+
+TEST(OrderedOutputTest, Parallel) {
+  std::string Result, Expected;
+  raw_string_ostream OS(Result);
+  constexpr size_t NumChunks = 1000;
+  for (size_t I = 0; I != NumChunks; ++I)
+    Expected += std::to_string(I) + "\n";
+  {
+    OrderedOutput Out(OS, NumChunks);
+    parallel::for_each_n(parallel::par, size_t(0), NumChunks, [&](size_t I) {
+      Out.getChunk(I) << I << '\n';
+      Out.finishChunk(I);
+    });
+  }
+  EXPECT_EQ(Expected, OS.str());
+}
+
+} // end anonymous namespace
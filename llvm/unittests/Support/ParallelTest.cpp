@@ -14,6 +14,7 @@
 #include "llvm/Support/Parallel.h"
 #include "gtest/gtest.h"
 #include <array>
+#include <atomic>
 #include <random>
 
 uint32_t array[1024 * 1024];
@@ -49,4 +50,14 @@ TEST(Parallel, parallel_for) {
   ASSERT_EQ(range[2049], 1u);
 }
 
+TEST(Parallel, nested_parallel_for) {
+  // Nested loops run in parallel as well: threads waiting for an inner loop
+  // must run its tasks rather than block.
+  std::atomic<uint32_t> count{0};
+  for_each_n(parallel::par, 0, 64, [&count](size_t I) {
+    for_each_n(parallel::par, 0, 2048, [&count](size_t J) { ++count; });
+  });
+  ASSERT_EQ(count.load(), 64u * 2048u);
+}
+
 #endif
@@ -1105,6 +1105,15 @@ TEST_F(FileSystemTest, FileMapping) {
     // Verify content
     EXPECT_EQ(StringRef(mfr.const_data()), Val);
 
+    // Hints do not change the contents.
+    for (auto Advice :
+         {fs::mapped_file_region::sequential, fs::mapped_file_region::random,
+          fs::mapped_file_region::willneed, fs::mapped_file_region::hugepage,
+          fs::mapped_file_region::normal}) {
+      mfr.advise(Advice);
+      EXPECT_EQ(StringRef(mfr.const_data()), Val);
+    }
+
     // Unmap temp file
     fs::mapped_file_region m(FD, fs::mapped_file_region::readonly, Size, 0, EC);
     ASSERT_NO_ERROR(EC);
@@ -1113,6 +1122,23 @@ TEST_F(FileSystemTest, FileMapping) {
   ASSERT_NO_ERROR(fs::remove(TempPath));
 }
 
+TEST_F(FileSystemTest, PrefetchFile) {
+  int FD;
+  SmallString<64> TempPath;
+  ASSERT_NO_ERROR(fs::createTemporaryFile("prefix", "temp", FD, TempPath));
+  ASSERT_NO_ERROR(fs::resize_file(FD, 4096));
+  ASSERT_EQ(close(FD), 0);
+
+  ASSERT_NO_ERROR(fs::prefetchFile(TempPath));
+  SmallString<64> Missing(TestDirectory);
+  path::append(Missing, "missing");
+  EXPECT_TRUE(fs::prefetchFile(Missing));
+
+  // Prefetching in the background ignores missing files.
+  fs::prefetchFilesInBackground({TempPath.str(), Missing.str()});
+  ASSERT_NO_ERROR(fs::remove(TempPath));
+}
+
 TEST(Support, NormalizePath) {
   using TestTuple = std::tuple<const char *, const char *, const char *>;
   std::vector<TestTuple> Tests;
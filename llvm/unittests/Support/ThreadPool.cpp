@@ -163,3 +163,19 @@ TEST_F(ThreadPoolTest, PoolDestruction) {
   }
   ASSERT_EQ(5, checked_in);
 }
+
+TEST_F(ThreadPoolTest, NestedAsync) {
+  CHECK_UNSUPPORTED();
+  // Test that wait() also waits for the tasks submitted by other tasks, which
+  // go to the queue of the thread that submits them.
+  std::atomic_int checked_in{0};
+  ThreadPool Pool{4};
+  for (size_t i = 0; i < 10; ++i) {
+    Pool.async([&Pool, &checked_in] {
+      for (size_t j = 0; j < 100; ++j)
+        Pool.async([&checked_in] { ++checked_in; });
+    });
+  }
+  Pool.wait();
+  ASSERT_EQ(1000, checked_in);
+}
@@ -21,4 +21,41 @@ TEST(Threading, PhysicalConcurrency) {
   ASSERT_LE(Num, thread::hardware_concurrency());
 }
 
+TEST(Threading, ThreadPoolStrategy) {
+  ThreadPoolStrategy S;
+  EXPECT_EQ(hardware_concurrency(), S.compute_thread_count());
+  S.UseHyperThreads = false;
+  EXPECT_EQ(heavyweight_hardware_concurrency(), S.compute_thread_count());
+  S.ThreadsRequested = 3;
+  EXPECT_EQ(3u, S.compute_thread_count());
+
+  // Each node gets its share of the threads, and at least one.
+  ASSERT_GE(get_numa_node_count(), 1u);
+  S.ThreadsRequested = 0;
+  S.UseHyperThreads = true;
+  for (unsigned Node = 0; Node < get_numa_node_count(); ++Node) {
+    S.NumaNode = Node;
+    EXPECT_GE(S.compute_thread_count(), 1u);
+    EXPECT_LE(S.compute_thread_count(), hardware_concurrency());
+  }
+}
+
+TEST(Threading, ApplyThreadStrategy) {
+  // Placing threads is a best effort, so only check that the threads run.
+  for (ThreadAffinity Affinity : {ThreadAffinity::None, ThreadAffinity::Compact,
+                                  ThreadAffinity::Spread}) {
+    ThreadPoolStrategy S;
+    S.Affinity = Affinity;
+    unsigned Ran = 0;
+    for (unsigned I = 0; I < 4; ++I) {
+      thread T([&, I] {
+        S.apply_thread_strategy(I);
+        ++Ran;
+      });
+      T.join();
+    }
+    EXPECT_EQ(4u, Ran);
+  }
+}
+
 } // end anon namespace
@@ -1994,3 +1994,120 @@ TEST_F(VFSFromYAMLTest, GetRealPath) {
   EXPECT_EQ(FS->getRealPath("/non_existing", RealPath),
             errc::no_such_file_or_directory);
 }
+
+namespace {
+/// Counts the calls that CachingFileSystem is meant to avoid.
+class CountingFileSystem : public vfs::ProxyFileSystem {
+public:
+  explicit CountingFileSystem(IntrusiveRefCntPtr<vfs::FileSystem> FS)
+      : ProxyFileSystem(std::move(FS)) {}
+
+  ErrorOr<vfs::Status> status(const Twine &Path) override {
+    ++NumStatus;
+    return ProxyFileSystem::status(Path);
+  }
+  vfs::directory_iterator dir_begin(const Twine &Dir,
+                                    std::error_code &EC) override {
+    ++NumDirBegin;
+    return ProxyFileSystem::dir_begin(Dir, EC);
+  }
+
+  unsigned NumStatus = 0;
+  unsigned NumDirBegin = 0;
+};
+
+struct CachingFileSystemTest : public ::testing::Test {
+  IntrusiveRefCntPtr<vfs::InMemoryFileSystem> Mem;
+  IntrusiveRefCntPtr<CountingFileSystem> Counting;
+  IntrusiveRefCntPtr<vfs::FileSystemCache> Cache;
+
+  void SetUp() override {
+    Mem = new vfs::InMemoryFileSystem();
+    Mem->setCurrentWorkingDirectory("/");
+    Mem->addFile("/a/b", 0, MemoryBuffer::getMemBuffer("b"));
+    Mem->addFile("/a/c", 0, MemoryBuffer::getMemBuffer("c"));
+    Counting = new CountingFileSystem(Mem);
+    Cache = new vfs::FileSystemCache();
+  }
+
+  std::vector<std::string> list(vfs::FileSystem &FS, StringRef Dir) {
+    std::vector<std::string> Result;
+    std::error_code EC;
+    for (vfs::directory_iterator I = FS.dir_begin(Dir, EC), E; !EC && I != E;
+         I.increment(EC))
+      Result.push_back(I->path());
+    EXPECT_FALSE(EC);
+    return Result;
+  }
+};
+} // end anonymous namespace
+
+TEST_F(CachingFileSystemTest, Status) {
+  vfs::CachingFileSystem FS(Counting, Cache);
+  ErrorOr<vfs::Status> S = FS.status("/a/b");
+  ASSERT_FALSE(S.getError());
+  EXPECT_TRUE(S->isRegularFile());
+  EXPECT_EQ(1u, Counting->NumStatus);
+
+  // Other spellings of the same path hit the cache, and keep their name.
+  S = FS.status("/a/./b");
+  ASSERT_FALSE(S.getError());
+  EXPECT_EQ("/a/./b", S->getName());
+  ASSERT_FALSE(FS.setCurrentWorkingDirectory("/a"));
+  S = FS.status("b");
+  ASSERT_FALSE(S.getError());
+  EXPECT_EQ("b", S->getName());
+  EXPECT_EQ(1u, Counting->NumStatus);
+}
+
+TEST_F(CachingFileSystemTest, MissingFiles) {
+  vfs::CachingFileSystem FS(Counting, Cache);
+  EXPECT_EQ(errc::no_such_file_or_directory, FS.status("/a/d").getError());
+  EXPECT_EQ(errc::no_such_file_or_directory, FS.status("/a/d").getError());
+  EXPECT_EQ(errc::no_such_file_or_directory,
+            FS.openFileForRead("/a/d").getError());
+  EXPECT_EQ(1u, Counting->NumStatus);
+
+  // Without negative caching, each lookup of a missing file goes through.
+  IntrusiveRefCntPtr<vfs::FileSystemCache> NoMissing(
+      new vfs::FileSystemCache(/*CacheMissingFiles=*/false));
+  vfs::CachingFileSystem FS2(Counting, NoMissing);
+  EXPECT_EQ(errc::no_such_file_or_directory, FS2.status("/a/d").getError());
+  EXPECT_EQ(errc::no_such_file_or_directory, FS2.status("/a/d").getError());
+  EXPECT_EQ(3u, Counting->NumStatus);
+}
+
+TEST_F(CachingFileSystemTest, DirectoryIteration) {
+  vfs::CachingFileSystem FS(Counting, Cache);
+  EXPECT_THAT(list(FS, "/a"), UnorderedElementsAre("/a/b", "/a/c"));
+  EXPECT_THAT(list(FS, "/a/"), UnorderedElementsAre("/a/b", "/a/c"));
+  EXPECT_EQ(1u, Counting->NumDirBegin);
+
+  // Entries are named after the directory as it was spelled.
+  ASSERT_FALSE(FS.setCurrentWorkingDirectory("/a"));
+  EXPECT_THAT(list(FS, "."), UnorderedElementsAre("./b", "./c"));
+  EXPECT_EQ(1u, Counting->NumDirBegin);
+}
+
+TEST_F(CachingFileSystemTest, SharedAndInvalidated) {
+  vfs::CachingFileSystem FS1(Counting, Cache);
+  vfs::CachingFileSystem FS2(Counting, Cache);
+  EXPECT_EQ(errc::no_such_file_or_directory, FS1.status("/a/d").getError());
+  EXPECT_THAT(list(FS1, "/a"), UnorderedElementsAre("/a/b", "/a/c"));
+
+  // A stale cache hides new files until they are invalidated.
+  Mem->addFile("/a/d", 0, MemoryBuffer::getMemBuffer("d"));
+  EXPECT_EQ(errc::no_such_file_or_directory, FS2.status("/a/d").getError());
+  EXPECT_THAT(list(FS2, "/a"), UnorderedElementsAre("/a/b", "/a/c"));
+  EXPECT_EQ(1u, Counting->NumStatus);
+  EXPECT_EQ(1u, Counting->NumDirBegin);
+
+  Cache->invalidate("/a/d");
+  EXPECT_FALSE(FS2.status("/a/d").getError());
+  EXPECT_THAT(list(FS2, "/a"), UnorderedElementsAre("/a/b", "/a/c", "/a/d"));
+
+  Cache->invalidateAll();
+  EXPECT_FALSE(FS1.status("/a/b").getError());
+  EXPECT_EQ(3u, Counting->NumStatus);
+  EXPECT_EQ(2u, Counting->NumDirBegin);
+}
@@ -0,0 +1,86 @@
+//===- llvm/unittest/Support/WorkStealingQueueTest.cpp --------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/Support/WorkStealingQueue.h"
+#include "llvm/Config/llvm-config.h"
+#include "gtest/gtest.h"
+#include <atomic>
+#include <thread>
+#include <vector>
+
+using namespace llvm;
+
+namespace {
+
+TEST(WorkStealingQueueTest, PopIsLIFOAndStealIsFIFO) {
+  int Tasks[4];
+  WorkStealingQueue<int> Q;
+  EXPECT_TRUE(Q.empty());
+  EXPECT_EQ(nullptr, Q.pop());
+  EXPECT_EQ(nullptr, Q.steal());
+
+  for (int &T : Tasks)
+    Q.push(&T);
+  EXPECT_FALSE(Q.empty());
+  EXPECT_EQ(&Tasks[3], Q.pop());
+  EXPECT_EQ(&Tasks[0], Q.steal());
+  EXPECT_EQ(&Tasks[2], Q.pop());
+  EXPECT_EQ(&Tasks[1], Q.steal());
+  EXPECT_TRUE(Q.empty());
+  EXPECT_EQ(nullptr, Q.pop());
+  EXPECT_EQ(nullptr, Q.steal());
+}
+
+TEST(WorkStealingQueueTest, Grow) {
+  std::vector<int> Tasks(100);
+  WorkStealingQueue<int> Q(2);
+  for (int &T : Tasks)
+    Q.push(&T);
+  EXPECT_EQ(&Tasks[0], Q.steal());
+  for (size_t I = Tasks.size() - 1; I > 0; --I)
+    EXPECT_EQ(&Tasks[I], Q.pop());
+  EXPECT_EQ(nullptr, Q.pop());
+}
+
+#if LLVM_ENABLE_THREADS
+TEST(WorkStealingQueueTest, ConcurrentSteal) {
+  // Each task must be taken exactly once, by the owner or by a thief.
+  const size_t NumTasks = 100000;
+  std::vector<int> Tasks(NumTasks);
+  std::vector<std::atomic<int>> Taken(NumTasks);
+  for (std::atomic<int> &T : Taken)
+    T = 0;
+  WorkStealingQueue<int> Q(4);
+  std::atomic<bool> Done{false};
+
+  std::vector<std::thread> Thieves;
+  for (int I = 0; I < 4; ++I)
+    Thieves.emplace_back([&] {
+      while (!Done || !Q.empty())
+        if (int *T = Q.steal())
+          ++Taken[T - Tasks.data()];
+    });
+
+  for (size_t I = 0; I < NumTasks; ++I) {
+    Q.push(&Tasks[I]);
+    if (I % 3 == 0)
+      if (int *T = Q.pop())
+        ++Taken[T - Tasks.data()];
+  }
+  while (int *T = Q.pop())
+    ++Taken[T - Tasks.data()];
+  Done = true;
+  for (std::thread &T : Thieves)
+    T.join();
+
+  for (size_t I = 0; I < NumTasks; ++I)
+    EXPECT_EQ(1, Taken[I]) << "task " << I;
+}
+#endif
+
+} // end anonymous namespace
@@ -43,6 +43,28 @@ TEST(sha1_hash_test, Basic) {
   ASSERT_EQ("2EF7BDE608CE5404E97D5F042F95F89F1C232871", Hash);
 }
 
+// Check inputs of several blocks, hashed at once and in updates that start
+// and end in the middle of blocks.
+TEST(sha1_hash_test, MultipleBlocks) {
+  ArrayRef<uint8_t> Input(
+      (const uint8_t *)"abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq",
+      56);
+  std::array<uint8_t, 20> Vec = SHA1::hash(Input);
+  ASSERT_EQ("84983E441C3BD26EBAAE4AA1F95129E5E54670F1",
+            toHex({(const char *)Vec.data(), 20}));
+
+  std::string Million(1000000, 'a');
+  const char *Expected = "34AA973CD4C4DAA4F61EEB2BDBAD27316534016F";
+  Vec = SHA1::hash(
+      ArrayRef<uint8_t>((const uint8_t *)Million.data(), Million.size()));
+  ASSERT_EQ(Expected, toHex({(const char *)Vec.data(), 20}));
+
+  SHA1 Hash;
+  for (size_t Pos = 0, Size = 1; Pos < Million.size(); Pos += Size, Size += 7)
+    Hash.update(StringRef(Million).substr(Pos, Size));
+  ASSERT_EQ(Expected, toHex(Hash.final()));
+}
+
 // Check that getting the intermediate hash in the middle of the stream does
 // not invalidate the final result.
 TEST(raw_sha1_ostreamTest, Intermediate) {
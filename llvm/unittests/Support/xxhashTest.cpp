@@ -17,3 +17,28 @@ TEST(xxhashTest, Basic) {
   EXPECT_EQ(0x69196c1b3af0bff9U,
             xxHash64("0123456789abcdefghijklmnopqrstuvwxyz"));
 }
+
+TEST(xxhashTest, xxh3) {
+  EXPECT_EQ(0xab6e5f64077e7d8aU, xxh3_64bits("foo"));
+  EXPECT_EQ(0xce7d19a5418fb365U,
+            xxh3_64bits("The quick brown fox jumps over the lazy dog"));
+
+  // Cover each of the code paths for the different input sizes, and the
+  // boundaries between them.
+  uint8_t Buf[2048];
+  for (size_t I = 0; I != sizeof(Buf); ++I)
+    Buf[I] = uint8_t(I * 7 + 3);
+  const std::pair<size_t, uint64_t> Cases[] = {
+      {0, 0x2d06800538d394c2U},    {1, 0x13e608bc156defedU},
+      {3, 0xa9088dda485b481cU},    {4, 0x6d9253b16c8b1ed3U},
+      {8, 0x60539db630471163U},    {9, 0xfeff668361d723a8U},
+      {16, 0xb8c859b0f030b585U},   {17, 0x714a04408e79b80fU},
+      {128, 0x67425a03650261bfU},  {129, 0xc664bf3311c6abc4U},
+      {240, 0x64556dc6b462a6cfU},  {241, 0x8beadd3a8874fe17U},
+      {1024, 0x9b81661c641c72b1U}, {1025, 0x806c2072ed713576U},
+      {2048, 0xabe604813ba62ed1U},
+  };
+  for (const auto &C : Cases)
+    EXPECT_EQ(C.second, xxh3_64bits(makeArrayRef(Buf, C.first)))
+        << "length " << C.first;
+}
@@ -0,0 +1,111 @@
+//===- ModuleInliner.cpp - Unit tests for the module inliner --------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/Transforms/IPO/ModuleInliner.h"
+#include "llvm/AsmParser/Parser.h"
+#include "llvm/IR/InstIterator.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Passes/PassBuilder.h"
+#include "llvm/Support/SourceMgr.h"
+#include "gtest/gtest.h"
+
+using namespace llvm;
+
+namespace {
+
+struct ModuleInlinerTest : ::testing::Test {
+  LLVMContext Context;
+  LoopAnalysisManager LAM;
+  FunctionAnalysisManager FAM;
+  CGSCCAnalysisManager CGAM;
+  ModuleAnalysisManager MAM;
+
+  ModuleInlinerTest() {
+    PassBuilder PB;
+    PB.registerModuleAnalyses(MAM);
+    PB.registerCGSCCAnalyses(CGAM);
+    PB.registerFunctionAnalyses(FAM);
+    PB.registerLoopAnalyses(LAM);
+    PB.crossRegisterProxies(LAM, FAM, CGAM, MAM);
+  }
+
+  std::unique_ptr<Module> parse(const char *IR) {
+    SMDiagnostic Err;
+    std::unique_ptr<Module> M = parseAssemblyString(IR, Err, Context);
+    if (!M)
+      Err.print("ModuleInlinerTest", errs());
+    return M;
+  }
+
+  static unsigned countCalls(Function &F) {
+    unsigned N = 0;
+    for (Instruction &I : instructions(F))
+      N += isa<CallInst>(I);
+    return N;
+  }
+};
+
+TEST_F(ModuleInlinerTest, InlinesAndDeletesCallees) {
+  std::unique_ptr<Module> M = parse(R"(
+    define internal i32 @leaf(i32 %x) {
+      %y = add i32 %x, 1
+      ret i32 %y
+    }
+
+    define internal i32 @middle(i32 %x) {
+      %y = call i32 @leaf(i32 %x)
+      %z = mul i32 %y, 3
+      ret i32 %z
+    }
+
+    define i32 @root(i32 %x) {
+      %y = call i32 @middle(i32 %x)
+      ret i32 %y
+    }
+  )");
+  ASSERT_TRUE(M);
+
+  PreservedAnalyses PA = ModuleInlinerPass().run(*M, MAM);
+  EXPECT_FALSE(PA.areAllPreserved());
+  EXPECT_EQ(nullptr, M->getFunction("leaf"));
+  EXPECT_EQ(nullptr, M->getFunction("middle"));
+  EXPECT_EQ(0u, countCalls(*M->getFunction("root")));
+}
+
+TEST_F(ModuleInlinerTest, StopsAtRecursion) {
+  std::unique_ptr<Module> M = parse(R"(
+    define i32 @f(i32 %x) {
+    entry:
+      %c = icmp eq i32 %x, 0
+      br i1 %c, label %done, label %rec
+
+    rec:
+      %y = sub i32 %x, 1
+      %r = call i32 @g(i32 %y)
+      ret i32 %r
+
+    done:
+      ret i32 0
+    }
+
+    define i32 @g(i32 %x) {
+      %r = call i32 @f(i32 %x)
+      ret i32 %r
+    }
+  )");
+  ASSERT_TRUE(M);
+
+  ModuleInlinerPass().run(*M, MAM);
+  ASSERT_NE(nullptr, M->getFunction("f"));
+  ASSERT_NE(nullptr, M->getFunction("g"));
+  EXPECT_GE(countCalls(*M->getFunction("f")), 1u);
+}
+
+} // end anonymous namespace
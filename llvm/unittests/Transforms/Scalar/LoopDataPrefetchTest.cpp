@@ -0,0 +1,164 @@
+//===- LoopDataPrefetchTest.cpp - Unit tests for loop data prefetching ----===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/Transforms/Scalar/LoopDataPrefetch.h"
+#include "llvm/AsmParser/Parser.h"
+#include "llvm/IR/InstIterator.h"
+#include "llvm/IR/IntrinsicInst.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/Module.h"
+#include "llvm/IR/Verifier.h"
+#include "llvm/Passes/PassBuilder.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/FileUtilities.h"
+#include "llvm/Support/SourceMgr.h"
+#include "llvm/Support/raw_ostream.h"
+#include "gtest/gtest.h"
+
+using namespace llvm;
+
+namespace {
+
+// for (i = 0; i != n; ++i) a[b[i]]++, with b[i] loaded at line 3 and a[b[i]]
+// at line 4 of @f, which starts at line 1.
+const char *IndirectLoopIR = R"(
+  define void @f(i32* %a, i32* %b, i64 %n) !dbg !6 {
+  entry:
+    br label %loop
+
+  loop:
+    %i = phi i64 [ 0, %entry ], [ %i.next, %loop ]
+    %b.addr = getelementptr inbounds i32, i32* %b, i64 %i
+    %idx = load i32, i32* %b.addr, !dbg !10
+    %idx.ext = sext i32 %idx to i64
+    %a.addr = getelementptr inbounds i32, i32* %a, i64 %idx.ext
+    %v = load i32, i32* %a.addr, !dbg !11
+    %v.inc = add i32 %v, 1
+    store i32 %v.inc, i32* %a.addr, !dbg !11
+    %i.next = add nuw nsw i64 %i, 1
+    %cond = icmp ne i64 %i.next, %n
+    br i1 %cond, label %loop, label %exit
+
+  exit:
+    ret void
+  }
+
+  !llvm.dbg.cu = !{!0}
+  !llvm.module.flags = !{!3, !4}
+
+  !0 = distinct !DICompileUnit(language: DW_LANG_C99, file: !1, emissionKind: FullDebug)
+  !1 = !DIFile(filename: "f.c", directory: "/")
+  !3 = !{i32 2, !"Dwarf Version", i32 4}
+  !4 = !{i32 2, !"Debug Info Version", i32 3}
+  !5 = !DISubroutineType(types: !{})
+  !6 = distinct !DISubprogram(name: "f", scope: !1, file: !1, line: 1, type: !5, unit: !0)
+  !10 = !DILocation(line: 3, column: 5, scope: !6)
+  !11 = !DILocation(line: 4, column: 5, scope: !6)
+)";
+
+struct LoopDataPrefetchTest : ::testing::Test {
+  LLVMContext Context;
+  LoopAnalysisManager LAM;
+  FunctionAnalysisManager FAM;
+  CGSCCAnalysisManager CGAM;
+  ModuleAnalysisManager MAM;
+
+  LoopDataPrefetchTest() {
+    PassBuilder PB;
+    PB.registerModuleAnalyses(MAM);
+    PB.registerCGSCCAnalyses(CGAM);
+    PB.registerFunctionAnalyses(FAM);
+    PB.registerLoopAnalyses(LAM);
+    PB.crossRegisterProxies(LAM, FAM, CGAM, MAM);
+  }
+
+  std::unique_ptr<Module> parseIR(const char *IR) {
+    SMDiagnostic Err;
+    std::unique_ptr<Module> M = parseAssemblyString(IR, Err, Context);
+    if (!M)
+      Err.print("LoopDataPrefetchTest", errs());
+    return M;
+  }
+
+  /// Runs the pass on @f with the text sample profile \p Profile, and returns
+  /// the prefetches inserted.
+  SmallVector<IntrinsicInst *, 4> prefetch(Module &M, StringRef Profile) {
+    SmallString<128> ProfilePath;
+    int FD;
+    EXPECT_FALSE(
+        sys::fs::createTemporaryFile("misses", "prof", FD, ProfilePath));
+    FileRemover Cleanup(ProfilePath);
+    {
+      raw_fd_ostream OS(FD, /*shouldClose=*/true);
+      OS << Profile;
+    }
+
+    Function &F = *M.getFunction("f");
+    LoopDataPrefetchPass(ProfilePath.str()).run(F, FAM);
+    EXPECT_FALSE(verifyFunction(F, &errs()));
+
+    SmallVector<IntrinsicInst *, 4> Prefetches;
+    for (Instruction &I : instructions(F))
+      if (auto *II = dyn_cast<IntrinsicInst>(&I))
+        if (II->getIntrinsicID() == Intrinsic::prefetch)
+          Prefetches.push_back(II);
+    return Prefetches;
+  }
+};
+
+// a[b[i]] misses: the index is loaded ahead of time to prefetch it.
+TEST_F(LoopDataPrefetchTest, PrefetchesIndirectMiss) {
+  std::unique_ptr<Module> M = parseIR(IndirectLoopIR);
+  ASSERT_TRUE(M);
+  SmallVector<IntrinsicInst *, 4> Prefetches = prefetch(*M, "f:10000:0\n"
+                                                              " 2: 10\n"
+                                                              " 3: 5000\n");
+  ASSERT_EQ(1u, Prefetches.size());
+
+  // The prefetch is before the load of a[b[i]], and its address is indexed
+  // by a new load of b.
+  Instruction *Next = Prefetches[0]->getNextNode();
+  ASSERT_TRUE(isa<LoadInst>(Next));
+  EXPECT_EQ("v", Next->getName());
+  auto *Addr = dyn_cast<GetElementPtrInst>(
+      Prefetches[0]->getArgOperand(0)->stripPointerCasts());
+  ASSERT_TRUE(Addr);
+  EXPECT_EQ(&*M->getFunction("f")->arg_begin(), Addr->getPointerOperand());
+  auto *Idx = dyn_cast<SExtInst>(Addr->getOperand(1));
+  ASSERT_TRUE(Idx);
+  auto *IdxLoad = dyn_cast<LoadInst>(Idx->getOperand(0));
+  ASSERT_TRUE(IdxLoad);
+  EXPECT_EQ("prefidx", IdxLoad->getName());
+}
+
+// b[i] misses: it is prefetched even though the target has no prefetch
+// distance.
+TEST_F(LoopDataPrefetchTest, PrefetchesStridedMiss) {
+  std::unique_ptr<Module> M = parseIR(IndirectLoopIR);
+  ASSERT_TRUE(M);
+  SmallVector<IntrinsicInst *, 4> Prefetches = prefetch(*M, "f:10000:0\n"
+                                                              " 2: 5000\n"
+                                                              " 3: 10\n");
+  ASSERT_EQ(1u, Prefetches.size());
+  Instruction *Next = Prefetches[0]->getNextNode();
+  ASSERT_TRUE(isa<LoadInst>(Next));
+  EXPECT_EQ("idx", Next->getName());
+}
+
+// Without samples for the function, the target decides, and it doesn't
+// prefetch.
+TEST_F(LoopDataPrefetchTest, NeedsSamples) {
+  std::unique_ptr<Module> M = parseIR(IndirectLoopIR);
+  ASSERT_TRUE(M);
+  EXPECT_TRUE(prefetch(*M, "g:10000:0\n"
+                           " 2: 5000\n"
+                           " 3: 5000\n")
+                  .empty());
+}
+
+} // end anonymous namespace
@@ -0,0 +1,161 @@
+//===- LoopTilingTest.cpp - Unit tests for the loop tiling pass -----------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/Transforms/Scalar/LoopTiling.h"
+#include "llvm/Analysis/LoopInfo.h"
+#include "llvm/AsmParser/Parser.h"
+#include "llvm/IR/Dominators.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/Module.h"
+#include "llvm/IR/Verifier.h"
+#include "llvm/Passes/PassBuilder.h"
+#include "llvm/Support/SourceMgr.h"
+#include "gtest/gtest.h"
+#include <algorithm>
+
+using namespace llvm;
+
+namespace {
+
+struct LoopTilingTest : ::testing::Test {
+  LLVMContext Context;
+  LoopAnalysisManager LAM;
+  FunctionAnalysisManager FAM;
+  CGSCCAnalysisManager CGAM;
+  ModuleAnalysisManager MAM;
+
+  LoopTilingTest() {
+    PassBuilder PB;
+    PB.registerModuleAnalyses(MAM);
+    PB.registerCGSCCAnalyses(CGAM);
+    PB.registerFunctionAnalyses(FAM);
+    PB.registerLoopAnalyses(LAM);
+    PB.crossRegisterProxies(LAM, FAM, CGAM, MAM);
+  }
+
+  /// Parses a function @f with a nest whose body is \p Body, and which
+  /// defines the outer and inner induction variables %i and %j.
+  std::unique_ptr<Module> parseNest(StringRef Body) {
+    std::string IR = (R"(
+      define void @f(float* noalias %A, float* noalias %B, float* noalias %C) {
+      entry:
+        br label %outer.header
+
+      outer.header:
+        %i = phi i64 [ 0, %entry ], [ %i.next, %outer.latch ]
+        %row = mul nuw nsw i64 %i, 1024
+        br label %inner.header
+
+      inner.header:
+        %j = phi i64 [ 1, %outer.header ], [ %j.next, %inner.header ]
+      )" + Body + R"(
+        %j.next = add nuw nsw i64 %j, 1
+        %inner.cond = icmp ne i64 %j.next, 1000
+        br i1 %inner.cond, label %inner.header, label %outer.latch
+
+      outer.latch:
+        %i.next = add nuw nsw i64 %i, 1
+        %outer.cond = icmp ne i64 %i.next, 1000
+        br i1 %outer.cond, label %outer.header, label %exit
+
+      exit:
+        ret void
+      }
+    )").str();
+    SMDiagnostic Err;
+    std::unique_ptr<Module> M = parseAssemblyString(IR, Err, Context);
+    if (!M)
+      Err.print("LoopTilingTest", errs());
+    return M;
+  }
+
+  /// Runs the pass and returns the depth of the inner loop afterwards.
+  unsigned tileAndGetInnerDepth(Function &F, unsigned TileSize) {
+    LoopTilingPass(TileSize).run(F, FAM);
+    EXPECT_FALSE(verifyFunction(F, &errs()));
+
+    // The analyses updated by the pass must match fresh ones.
+    DominatorTree DT(F);
+    LoopInfo LI(DT);
+    EXPECT_FALSE(FAM.getResult<DominatorTreeAnalysis>(F).compare(DT));
+    FAM.getResult<LoopAnalysis>(F).verify(DT);
+
+    const BasicBlock &InnerHeader =
+        *std::find_if(F.begin(), F.end(), [](const BasicBlock &BB) {
+          return BB.getName() == "inner.header";
+        });
+    EXPECT_EQ(LI.getLoopDepth(&InnerHeader),
+              FAM.getResult<LoopAnalysis>(F).getLoopDepth(&InnerHeader));
+    return LI.getLoopDepth(&InnerHeader);
+  }
+};
+
+// C[i] += A[i][j] * B[j]: the strips of B are reused by all the rows of A.
+TEST_F(LoopTilingTest, TilesMatrixVectorProduct) {
+  std::unique_ptr<Module> M = parseNest(R"(
+        %c = getelementptr inbounds float, float* %C, i64 %i
+        %a.idx = add nuw nsw i64 %row, %j
+        %a = getelementptr inbounds float, float* %A, i64 %a.idx
+        %b = getelementptr inbounds float, float* %B, i64 %j
+        %av = load float, float* %a
+        %bv = load float, float* %b
+        %mul = fmul float %av, %bv
+        %cv = load float, float* %c
+        %add = fadd float %cv, %mul
+        store float %add, float* %c
+  )");
+  ASSERT_TRUE(M);
+  Function &F = *M->getFunction("f");
+
+  EXPECT_EQ(3u, tileAndGetInnerDepth(F, 64));
+
+  // The inner loop now starts at the tile and stops at its end.
+  DominatorTree DT(F);
+  LoopInfo LI(DT);
+  Loop *TileLoop = *LI.begin();
+  EXPECT_EQ("tile.header", TileLoop->getHeader()->getName());
+  Loop *Inner = TileLoop->getSubLoops().front()->getSubLoops().front();
+  auto &J = cast<PHINode>(Inner->getHeader()->front());
+  EXPECT_EQ("tile.iv",
+            J.getIncomingValueForBlock(Inner->getLoopPreheader())->getName());
+  auto *BI = cast<BranchInst>(Inner->getLoopLatch()->getTerminator());
+  auto *Cond = cast<ICmpInst>(BI->getCondition());
+  EXPECT_EQ("tile.end", Cond->getOperand(1)->getName());
+
+  // The tiled nest is not tiled again.
+  EXPECT_EQ(3u, tileAndGetInnerDepth(F, 64));
+}
+
+// A[i + 1][j - 1] = A[i][j]: the dependence is reversed by tiling.
+TEST_F(LoopTilingTest, KeepsReversedDependence) {
+  std::unique_ptr<Module> M = parseNest(R"(
+        %ld.idx = add nuw nsw i64 %row, %j
+        %ld = getelementptr inbounds float, float* %A, i64 %ld.idx
+        %v = load float, float* %ld
+        %st.idx = add nuw nsw i64 %ld.idx, 1023
+        %st = getelementptr inbounds float, float* %A, i64 %st.idx
+        store float %v, float* %st
+  )");
+  ASSERT_TRUE(M);
+  EXPECT_EQ(2u, tileAndGetInnerDepth(*M->getFunction("f"), 64));
+}
+
+// Without a data cache size, there is no tile size to use.
+TEST_F(LoopTilingTest, NeedsCacheModel) {
+  std::unique_ptr<Module> M = parseNest(R"(
+        %b = getelementptr inbounds float, float* %B, i64 %j
+        %bv = load float, float* %b
+        %c = getelementptr inbounds float, float* %C, i64 %i
+        store float %bv, float* %c
+  )");
+  ASSERT_TRUE(M);
+  EXPECT_EQ(2u, tileAndGetInnerDepth(*M->getFunction("f"), 0));
+}
+
+} // end anonymous namespace
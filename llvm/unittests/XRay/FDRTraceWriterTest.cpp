@@ -16,6 +16,7 @@
 #include "llvm/XRay/Trace.h"
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
+#include <algorithm>
 #include <string>
 
 namespace llvm {
@@ -177,6 +178,94 @@ TEST(FDRTraceWriterTest, WriteToStringBufferVersion1) {
                           Field(&XRayRecord::Type, Eq(RecordTypes::EXIT))));
 }
 
+// Streaming the records of a log with processTrace must yield the same records
+// for each thread as loading the whole trace, whether the threads are decoded
+// serially or in parallel.
+TEST(FDRTraceWriterTest, ProcessTraceMatchesLoadTrace) {
+  std::string Data;
+  raw_string_ostream OS(Data);
+  XRayFileHeader H;
+  H.Version = 3;
+  H.Type = 1;
+  H.ConstantTSC = true;
+  H.NonstopTSC = true;
+  H.CycleFrequency = 3e9;
+  FDRTraceWriter Writer(OS, H);
+  // Two buffers for each of three threads. The buffers of thread 1 are written
+  // in the reverse order of their wallclock times, so that both must sort them
+  // back.
+  struct Block {
+    uint64_t TId;
+    uint64_t Seconds;
+    int32_t FuncId;
+  };
+  for (const auto &Blk : {Block{1, 2, 10}, Block{2, 1, 20}, Block{3, 1, 30},
+                          Block{1, 1, 11}, Block{2, 2, 21}, Block{3, 2, 31}}) {
+    auto L = LogBuilder()
+                 .add<BufferExtents>(80)
+                 .add<NewBufferRecord>(Blk.TId)
+                 .add<WallclockRecord>(Blk.Seconds, Blk.Seconds * 1000)
+                 .add<PIDRecord>(1)
+                 .add<NewCPUIDRecord>(Blk.TId, Blk.Seconds * 100)
+                 .add<FunctionRecord>(RecordTypes::ENTER, Blk.FuncId, 1)
+                 .add<FunctionRecord>(RecordTypes::EXIT, Blk.FuncId, 10)
+                 .consume();
+    for (auto &P : L)
+      ASSERT_FALSE(errorToBool(P->apply(Writer)));
+  }
+  OS.flush();
+
+  DataExtractor DE(Data, sys::IsLittleEndianHost, 8);
+  auto TraceOrErr = loadTrace(DE, false);
+  if (!TraceOrErr)
+    FAIL() << TraceOrErr.takeError();
+  std::vector<XRayRecord> Expected(TraceOrErr->begin(), TraceOrErr->end());
+  ASSERT_EQ(Expected.size(), 12u);
+
+  // The threads may come in any order, but the records of each thread must be
+  // in the order of loadTrace.
+  auto ByThread = [](const XRayRecord &L, const XRayRecord &R) {
+    return L.TId < R.TId;
+  };
+  std::stable_sort(Expected.begin(), Expected.end(), ByThread);
+
+  for (unsigned NumThreads : {1, 2}) {
+    XRayFileHeader Header;
+    std::vector<XRayRecord> Records;
+    auto Err = processTrace(DE,
+                            [&](const XRayFileHeader &FH) {
+                              Header = FH;
+                              return Error::success();
+                            },
+                            [&](const XRayRecord &R) {
+                              Records.push_back(R);
+                              return Error::success();
+                            },
+                            NumThreads);
+    if (Err)
+      FAIL() << std::move(Err);
+    EXPECT_EQ(Header.Version, 3u);
+    EXPECT_EQ(Header.CycleFrequency, H.CycleFrequency);
+    std::stable_sort(Records.begin(), Records.end(), ByThread);
+
+    ASSERT_EQ(Records.size(), Expected.size());
+    for (size_t I = 0; I != Records.size(); ++I) {
+      EXPECT_EQ(Records[I].TId, Expected[I].TId);
+      EXPECT_EQ(Records[I].FuncId, Expected[I].FuncId);
+      EXPECT_EQ(Records[I].Type, Expected[I].Type);
+      EXPECT_EQ(Records[I].TSC, Expected[I].TSC);
+      EXPECT_EQ(Records[I].CPU, Expected[I].CPU);
+    }
+  }
+
+  // Whichever order the blocks were written in, thread 1 goes through the
+  // block with the earlier wallclock time first.
+  auto T1 = std::find_if(Expected.begin(), Expected.end(),
+                         [](const XRayRecord &R) { return R.TId == 1; });
+  ASSERT_NE(T1, Expected.end());
+  EXPECT_EQ(T1->FuncId, 11);
+}
+
 } // namespace
 } // namespace xray
 } // namespace llvm
@@ -251,6 +251,14 @@ bool LLVMTableGenMain(raw_ostream &OS, RecordKeeper &Records) {
 
   return false;
 }
+
+bool LLVMTableGenSelectAction(StringRef Name) {
+  ActionType Value;
+  if (Action.getParser().parse(Action, Name, "", Value))
+    return true;
+  Action = Value;
+  return false;
+}
 }
 
 int main(int argc, char **argv) {
@@ -260,7 +268,7 @@ int main(int argc, char **argv) {
 
   llvm_shutdown_obj Y;
 
-  return TableGenMain(argv[0], &LLVMTableGenMain);
+  return TableGenMain(argv[0], &LLVMTableGenMain, &LLVMTableGenSelectAction);
 }
 
 #ifdef __has_feature
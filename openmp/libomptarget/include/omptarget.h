@@ -109,6 +109,15 @@ struct __tgt_target_table {
       *EntriesEnd; // End of the table with all the entries (non inclusive)
 };
 
+/// This struct is a record of the queue that the asynchronous operations of a
+/// target region or data transfer are issued to, e.g. a CUstream for CUDA. The
+/// operations issued to one queue run in order; those issued to different
+/// queues may overlap. The queue is picked by the RTL at the first operation
+/// and released by __tgt_rtl_synchronize.
+struct __tgt_async_info {
+  void *Queue = nullptr;
+};
+
 #ifdef __cplusplus
 extern "C" {
 #endif
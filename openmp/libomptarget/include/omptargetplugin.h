@@ -87,6 +87,35 @@ int32_t __tgt_rtl_run_target_team_region(int32_t ID, void *Entry, void **Args,
                                          int32_t NumTeams, int32_t ThreadLimit,
                                          uint64_t loop_tripcount);
 
+// The following functions are optional. They issue the same operations as the
+// functions above to the queue of AsyncInfo, picking a queue if it has none,
+// and return without waiting for the operations to complete. The host buffer
+// of __tgt_rtl_data_submit_async may be reused once the function returns; the
+// one of __tgt_rtl_data_retrieve_async, only once the queue is synchronized.
+// In case of success, return zero. Otherwise, return an error code.
+int32_t __tgt_rtl_data_submit_async(int32_t ID, void *TargetPtr, void *HostPtr,
+                                    int64_t Size,
+                                    __tgt_async_info *AsyncInfo);
+
+int32_t __tgt_rtl_data_retrieve_async(int32_t ID, void *HostPtr,
+                                      void *TargetPtr, int64_t Size,
+                                      __tgt_async_info *AsyncInfo);
+
+int32_t __tgt_rtl_run_target_region_async(int32_t ID, void *Entry,
+                                          void **Args, ptrdiff_t *Offsets,
+                                          int32_t NumArgs,
+                                          __tgt_async_info *AsyncInfo);
+
+int32_t __tgt_rtl_run_target_team_region_async(
+    int32_t ID, void *Entry, void **Args, ptrdiff_t *Offsets, int32_t NumArgs,
+    int32_t NumTeams, int32_t ThreadLimit, uint64_t loop_tripcount,
+    __tgt_async_info *AsyncInfo);
+
+// Wait for all the operations issued to the queue of AsyncInfo to complete,
+// and release the queue. In case of success, return zero. Otherwise, return
+// an error code.
+int32_t __tgt_rtl_synchronize(int32_t ID, __tgt_async_info *AsyncInfo);
+
 #ifdef __cplusplus
 }
 #endif
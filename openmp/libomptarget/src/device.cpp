@@ -16,6 +16,7 @@
 
 #include <cassert>
 #include <climits>
+#include <cstdlib>
 #include <string>
 
 /// Map between Device ID (i.e. openmp device id) and its DeviceTy.
@@ -185,7 +186,7 @@ void *DeviceTy::getOrAllocTgtPtr(void *HstPtrBegin, void *HstPtrBase,
   } else if (Size) {
     // If it is not contained and Size > 0 we should create a new entry for it.
     IsNew = true;
-    uintptr_t tp = (uintptr_t)RTL->data_alloc(RTLDeviceID, Size, HstPtrBegin);
+    uintptr_t tp = (uintptr_t)data_alloc(Size, HstPtrBegin);
     DP("Creating new map entry: HstBase=" DPxMOD ", HstBegin=" DPxMOD ", "
         "HstEnd=" DPxMOD ", TgtBegin=" DPxMOD "\n", DPxPTR(HstPtrBase),
         DPxPTR(HstPtrBegin), DPxPTR((uintptr_t)HstPtrBegin + Size), DPxPTR(tp));
@@ -256,7 +257,7 @@ int DeviceTy::deallocTgtPtr(void *HstPtrBegin, int64_t Size, bool ForceDelete) {
       assert(HT.RefCount == 0 && "did not expect a negative ref count");
       DP("Deleting tgt data " DPxMOD " of size %ld\n",
           DPxPTR(HT.TgtPtrBegin), Size);
-      RTL->data_delete(RTLDeviceID, (void *)HT.TgtPtrBegin);
+      data_delete((void *)HT.TgtPtrBegin, HT.HstPtrEnd - HT.HstPtrBegin);
       DP("Removing%s mapping with HstPtrBegin=" DPxMOD ", TgtPtrBegin=" DPxMOD
           ", Size=%ld\n", (ForceDelete ? " (forced)" : ""),
           DPxPTR(HT.HstPtrBegin), DPxPTR(HT.TgtPtrBegin), Size);
@@ -273,8 +274,22 @@ int DeviceTy::deallocTgtPtr(void *HstPtrBegin, int64_t Size, bool ForceDelete) {
   return rc;
 }
 
+// Bytes of free device memory kept by the memory pool of each device, from
+// LIBOMPTARGET_MEMORY_POOL_LIMIT. Zero disables the pool.
+static size_t getMemoryPoolLimit() {
+  static const size_t Limit = []() -> size_t {
+    if (const char *EnvStr = getenv("LIBOMPTARGET_MEMORY_POOL_LIMIT")) {
+      DP("Parsed LIBOMPTARGET_MEMORY_POOL_LIMIT=%s\n", EnvStr);
+      return std::stoull(EnvStr);
+    }
+    return (size_t)256 << 20;
+  }();
+  return Limit;
+}
+
 /// Init device, should not be called directly.
 void DeviceTy::init() {
+  MemoryPool.Limit = getMemoryPoolLimit();
   // Make call to init_requires if it exists for this plugin.
   if (RTL->init_requires)
     RTL->init_requires(RTLRequiresFlags);
@@ -308,31 +323,113 @@ __tgt_target_table *DeviceTy::load_binary(void *Img) {
   return rc;
 }
 
+// Allocate device memory, from the memory pool if it has a free block of the
+// size class of Size.
+void *DeviceTy::data_alloc(int64_t Size, void *HstPtrBegin) {
+  int Class = MemoryPoolTy::getSizeClass(Size);
+  if (Class < 0 || !MemoryPool.Limit)
+    return RTL->data_alloc(RTLDeviceID, Size, HstPtrBegin);
+
+  int64_t BlockSize = MemoryPoolTy::getBlockSize(Class);
+  MemoryPool.Mtx.lock();
+  std::vector<void *> &FreeBlocks = MemoryPool.FreeBlocks[Class];
+  if (!FreeBlocks.empty()) {
+    void *TgtPtrBegin = FreeBlocks.back();
+    FreeBlocks.pop_back();
+    MemoryPool.FreeBytes -= BlockSize;
+    MemoryPool.Mtx.unlock();
+    DP("Reusing %" PRId64 " bytes of device memory at " DPxMOD " for %" PRId64
+       " bytes\n", BlockSize, DPxPTR(TgtPtrBegin), Size);
+    return TgtPtrBegin;
+  }
+  MemoryPool.Mtx.unlock();
+
+  void *TgtPtrBegin = RTL->data_alloc(RTLDeviceID, BlockSize, HstPtrBegin);
+  if (!TgtPtrBegin) {
+    // The device may be out of memory because of the blocks that are kept.
+    MemoryPool.Mtx.lock();
+    size_t Released = MemoryPool.FreeBytes;
+    for (std::vector<void *> &Blocks : MemoryPool.FreeBlocks) {
+      for (void *Block : Blocks)
+        RTL->data_delete(RTLDeviceID, Block);
+      Blocks.clear();
+    }
+    MemoryPool.FreeBytes = 0;
+    MemoryPool.Mtx.unlock();
+    if (Released) {
+      DP("Released %zu bytes of free device memory after a failed "
+         "allocation\n", Released);
+      TgtPtrBegin = RTL->data_alloc(RTLDeviceID, BlockSize, HstPtrBegin);
+    }
+  }
+  return TgtPtrBegin;
+}
+
+// Release device memory allocated by data_alloc, keeping it in the memory
+// pool unless this would exceed the limit of the pool.
+int32_t DeviceTy::data_delete(void *TgtPtrBegin, int64_t Size) {
+  int Class = MemoryPoolTy::getSizeClass(Size);
+  if (Class < 0 || !MemoryPool.Limit)
+    return RTL->data_delete(RTLDeviceID, TgtPtrBegin);
+
+  int64_t BlockSize = MemoryPoolTy::getBlockSize(Class);
+  MemoryPool.Mtx.lock();
+  if (MemoryPool.FreeBytes + BlockSize <= MemoryPool.Limit) {
+    MemoryPool.FreeBlocks[Class].push_back(TgtPtrBegin);
+    MemoryPool.FreeBytes += BlockSize;
+    MemoryPool.Mtx.unlock();
+    return OFFLOAD_SUCCESS;
+  }
+  MemoryPool.Mtx.unlock();
+  return RTL->data_delete(RTLDeviceID, TgtPtrBegin);
+}
+
 // Submit data to device.
 int32_t DeviceTy::data_submit(void *TgtPtrBegin, void *HstPtrBegin,
-    int64_t Size) {
-  return RTL->data_submit(RTLDeviceID, TgtPtrBegin, HstPtrBegin, Size);
+    int64_t Size, __tgt_async_info *AsyncInfo) {
+  if (!AsyncInfo || !RTL->synchronize)
+    return RTL->data_submit(RTLDeviceID, TgtPtrBegin, HstPtrBegin, Size);
+  return RTL->data_submit_async(RTLDeviceID, TgtPtrBegin, HstPtrBegin, Size,
+      AsyncInfo);
 }
 
 // Retrieve data from device.
 int32_t DeviceTy::data_retrieve(void *HstPtrBegin, void *TgtPtrBegin,
-    int64_t Size) {
-  return RTL->data_retrieve(RTLDeviceID, HstPtrBegin, TgtPtrBegin, Size);
+    int64_t Size, __tgt_async_info *AsyncInfo) {
+  if (!AsyncInfo || !RTL->synchronize)
+    return RTL->data_retrieve(RTLDeviceID, HstPtrBegin, TgtPtrBegin, Size);
+  return RTL->data_retrieve_async(RTLDeviceID, HstPtrBegin, TgtPtrBegin, Size,
+      AsyncInfo);
 }
 
 // Run region on device
 int32_t DeviceTy::run_region(void *TgtEntryPtr, void **TgtVarsPtr,
-    ptrdiff_t *TgtOffsets, int32_t TgtVarsSize) {
-  return RTL->run_region(RTLDeviceID, TgtEntryPtr, TgtVarsPtr, TgtOffsets,
-      TgtVarsSize);
+    ptrdiff_t *TgtOffsets, int32_t TgtVarsSize, __tgt_async_info *AsyncInfo) {
+  if (!AsyncInfo || !RTL->synchronize)
+    return RTL->run_region(RTLDeviceID, TgtEntryPtr, TgtVarsPtr, TgtOffsets,
+        TgtVarsSize);
+  return RTL->run_region_async(RTLDeviceID, TgtEntryPtr, TgtVarsPtr,
+      TgtOffsets, TgtVarsSize, AsyncInfo);
 }
 
 // Run team region on device.
 int32_t DeviceTy::run_team_region(void *TgtEntryPtr, void **TgtVarsPtr,
     ptrdiff_t *TgtOffsets, int32_t TgtVarsSize, int32_t NumTeams,
-    int32_t ThreadLimit, uint64_t LoopTripCount) {
-  return RTL->run_team_region(RTLDeviceID, TgtEntryPtr, TgtVarsPtr, TgtOffsets,
-      TgtVarsSize, NumTeams, ThreadLimit, LoopTripCount);
+    int32_t ThreadLimit, uint64_t LoopTripCount,
+    __tgt_async_info *AsyncInfo) {
+  if (!AsyncInfo || !RTL->synchronize)
+    return RTL->run_team_region(RTLDeviceID, TgtEntryPtr, TgtVarsPtr,
+        TgtOffsets, TgtVarsSize, NumTeams, ThreadLimit, LoopTripCount);
+  return RTL->run_team_region_async(RTLDeviceID, TgtEntryPtr, TgtVarsPtr,
+      TgtOffsets, TgtVarsSize, NumTeams, ThreadLimit, LoopTripCount,
+      AsyncInfo);
+}
+
+// Wait for the asynchronous operations of AsyncInfo.
+int32_t DeviceTy::synchronize(__tgt_async_info *AsyncInfo) {
+  if (!RTL->synchronize || !AsyncInfo->Queue)
+    return OFFLOAD_SUCCESS;
+  return RTL->synchronize(RTLDeviceID, AsyncInfo);
 }
 
 /// Check whether a device has an associated RTL and initialize it if it's not
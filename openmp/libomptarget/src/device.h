@@ -24,6 +24,7 @@
 struct RTLInfoTy;
 struct __tgt_bin_desc;
 struct __tgt_target_table;
+struct __tgt_async_info;
 
 #define INF_REF_CNT (LONG_MAX>>1) // leave room for additions/subtractions
 #define CONSIDERED_INF(x) (x > (INF_REF_CNT>>1))
@@ -80,6 +81,53 @@ struct PendingCtorDtorListsTy {
 typedef std::map<__tgt_bin_desc *, PendingCtorDtorListsTy>
     PendingCtorsDtorsPerLibrary;
 
+/// Device memory released by the runtime that is kept to serve the next
+/// allocations without calling the RTL. Blocks are allocated with sizes
+/// rounded up to a power of two, from MinBlockSize to MaxBlockSize, and kept in
+/// one free list per size; bigger blocks are not kept. At most Limit bytes are
+/// kept per device.
+struct MemoryPoolTy {
+  static const int64_t MinBlockSize = 256;
+  static const int64_t MaxBlockSize = 64 << 20;
+  static const int NumSizeClasses = 19; // log2(MaxBlockSize / MinBlockSize)+1
+
+  std::vector<void *> FreeBlocks[NumSizeClasses];
+  size_t FreeBytes; // Total size of the blocks in FreeBlocks.
+  size_t Limit;
+  std::mutex Mtx;
+
+  MemoryPoolTy() : FreeBytes(0), Limit(0), Mtx() {}
+
+  // The blocks are owned by the copy: the device they were allocated from is
+  // only copied when the vector of devices grows.
+  MemoryPoolTy(const MemoryPoolTy &P)
+      : FreeBytes(P.FreeBytes), Limit(P.Limit), Mtx() {
+    for (int i = 0; i < NumSizeClasses; ++i)
+      FreeBlocks[i] = P.FreeBlocks[i];
+  }
+
+  MemoryPoolTy &operator=(const MemoryPoolTy &P) {
+    for (int i = 0; i < NumSizeClasses; ++i)
+      FreeBlocks[i] = P.FreeBlocks[i];
+    FreeBytes = P.FreeBytes;
+    Limit = P.Limit;
+    return *this;
+  }
+
+  // Return the size class of a block of Size bytes, or -1 if such blocks are
+  // not kept.
+  static int getSizeClass(int64_t Size) {
+    if (Size <= 0 || Size > MaxBlockSize)
+      return -1;
+    int Class = 0;
+    while ((MinBlockSize << Class) < Size)
+      ++Class;
+    return Class;
+  }
+
+  static int64_t getBlockSize(int Class) { return MinBlockSize << Class; }
+};
+
 struct DeviceTy {
   int32_t DeviceID;
   RTLInfoTy *RTL;
@@ -94,6 +142,8 @@ struct DeviceTy {
 
   ShadowPtrListTy ShadowPtrMap;
 
+  MemoryPoolTy MemoryPool;
+
   std::mutex DataMapMtx, PendingGlobalsMtx, ShadowMtx;
 
   uint64_t loopTripCnt;
@@ -103,8 +153,8 @@ struct DeviceTy {
   DeviceTy(RTLInfoTy *RTL)
       : DeviceID(-1), RTL(RTL), RTLDeviceID(-1), IsInit(false), InitFlag(),
         HasPendingGlobals(false), HostDataToTargetMap(),
-        PendingCtorsDtors(), ShadowPtrMap(), DataMapMtx(), PendingGlobalsMtx(),
-        ShadowMtx(), loopTripCnt(0), RTLRequiresFlags(0) {}
+        PendingCtorsDtors(), ShadowPtrMap(), MemoryPool(), DataMapMtx(),
+        PendingGlobalsMtx(), ShadowMtx(), loopTripCnt(0), RTLRequiresFlags(0) {}
 
   // The existence of mutexes makes DeviceTy non-copyable. We need to
   // provide a copy constructor and an assignment operator explicitly.
@@ -113,7 +163,7 @@ struct DeviceTy {
         IsInit(d.IsInit), InitFlag(), HasPendingGlobals(d.HasPendingGlobals),
         HostDataToTargetMap(d.HostDataToTargetMap),
         PendingCtorsDtors(d.PendingCtorsDtors), ShadowPtrMap(d.ShadowPtrMap),
-        DataMapMtx(), PendingGlobalsMtx(),
+        MemoryPool(d.MemoryPool), DataMapMtx(), PendingGlobalsMtx(),
         ShadowMtx(), loopTripCnt(d.loopTripCnt),
         RTLRequiresFlags(d.RTLRequiresFlags) {}
 
@@ -126,6 +176,7 @@ struct DeviceTy {
     HostDataToTargetMap = d.HostDataToTargetMap;
     PendingCtorsDtors = d.PendingCtorsDtors;
     ShadowPtrMap = d.ShadowPtrMap;
+    MemoryPool = d.MemoryPool;
     loopTripCnt = d.loopTripCnt;
     RTLRequiresFlags = d.RTLRequiresFlags;
 
@@ -147,14 +198,29 @@ struct DeviceTy {
   int32_t initOnce();
   __tgt_target_table *load_binary(void *Img);
 
-  int32_t data_submit(void *TgtPtrBegin, void *HstPtrBegin, int64_t Size);
-  int32_t data_retrieve(void *HstPtrBegin, void *TgtPtrBegin, int64_t Size);
+  // Allocate and release device memory through the memory pool. Size must be
+  // the same for both calls.
+  void *data_alloc(int64_t Size, void *HstPtrBegin);
+  int32_t data_delete(void *TgtPtrBegin, int64_t Size);
+
+  // If AsyncInfo is not null and the RTL supports it, the operations below
+  // are issued to the queue of AsyncInfo and may not be complete until the
+  // queue is synchronized.
+  int32_t data_submit(void *TgtPtrBegin, void *HstPtrBegin, int64_t Size,
+      __tgt_async_info *AsyncInfo = nullptr);
+  int32_t data_retrieve(void *HstPtrBegin, void *TgtPtrBegin, int64_t Size,
+      __tgt_async_info *AsyncInfo = nullptr);
 
   int32_t run_region(void *TgtEntryPtr, void **TgtVarsPtr,
-      ptrdiff_t *TgtOffsets, int32_t TgtVarsSize);
+      ptrdiff_t *TgtOffsets, int32_t TgtVarsSize,
+      __tgt_async_info *AsyncInfo = nullptr);
   int32_t run_team_region(void *TgtEntryPtr, void **TgtVarsPtr,
       ptrdiff_t *TgtOffsets, int32_t TgtVarsSize, int32_t NumTeams,
-      int32_t ThreadLimit, uint64_t LoopTripCount);
+      int32_t ThreadLimit, uint64_t LoopTripCount,
+      __tgt_async_info *AsyncInfo = nullptr);
+
+  // Wait for the operations issued to the queue of AsyncInfo to complete.
+  int32_t synchronize(__tgt_async_info *AsyncInfo);
 
 private:
   // Call to RTL
@@ -2122,6 +2122,7 @@ extern kmp_tasking_mode_t
     __kmp_tasking_mode; /* determines how/when to execute tasks */
 extern int __kmp_task_stealing_constraint;
 extern int __kmp_enable_task_throttling;
+extern int __kmp_task_steal_locality;
 #if OMP_40_ENABLED
 extern kmp_int32 __kmp_default_device; // Set via OMP_DEFAULT_DEVICE if
 // specified, defaults to 0 otherwise
@@ -2232,6 +2233,9 @@ typedef struct kmp_base_depnode {
   kmp_lock_t lock; /* guards shared fields: task, successors */
 #if KMP_SUPPORT_GRAPH_OUTPUT
   kmp_uint32 id;
+#endif
+#if OMP_50_ENABLED
+  kmp_int32 tg_seq; /* number of the task in the taskgraph being recorded */
 #endif
   std::atomic<kmp_int32> npredecessors;
   std::atomic<kmp_int32> nrefs;
@@ -2262,6 +2266,54 @@ typedef struct kmp_dephash {
 #endif
 } kmp_dephash_t;
 
+#if OMP_50_ENABLED
+// A taskgraph region records the dependences between the tasks it creates
+// the first time it is executed, and replays them the next times instead of
+// resolving the depend items again, see __kmpc_taskgraph_begin.
+enum kmp_taskgraph_state {
+  tgs_empty, /* the graph is recorded by the next region */
+  tgs_recorded, /* the graph can be replayed */
+  tgs_unreplayable /* the graph has dependences that are not replayed */
+};
+
+enum kmp_taskgraph_mode {
+  tgm_plain, /* the dependences are resolved, not recorded */
+  tgm_record, /* the dependences are resolved and recorded */
+  tgm_replay /* the recorded dependences are replayed */
+};
+
+// A task of a recorded graph: the n-th task with dependences created by the
+// region. Its predecessors are tg_preds[first_pred:first_pred + npreds].
+typedef struct kmp_taskgraph_task {
+  kmp_int32 ndeps; /* number of depend items, to check the replay */
+  kmp_int32 first_pred;
+  kmp_int32 npreds;
+} kmp_taskgraph_task_t;
+
+typedef struct kmp_taskgraph_rec {
+  kmp_int32 tg_id; /* id of the region */
+  enum kmp_taskgraph_state tg_state;
+  bool tg_in_use; /* a region records or replays the graph */
+  kmp_int32 tg_ntasks;
+  kmp_int32 tg_tasks_size; /* allocated entries of tg_tasks */
+  kmp_taskgraph_task_t *tg_tasks;
+  kmp_int32 tg_npreds;
+  kmp_int32 tg_preds_size; /* allocated entries of tg_preds */
+  kmp_int32 *tg_preds; /* numbers of the predecessor tasks */
+  struct kmp_taskgraph_rec *tg_next;
+} kmp_taskgraph_rec_t;
+
+// A taskgraph region being executed by a task
+typedef struct kmp_taskgraph {
+  kmp_taskgraph_rec_t *tg_rec; /* graph recorded or replayed, or NULL */
+  enum kmp_taskgraph_mode tg_mode;
+  kmp_int32 tg_ntasks; /* tasks replayed so far */
+  kmp_depnode_t **tg_nodes; /* nodes of the replayed tasks */
+  kmp_dephash_t *tg_outer_dephash; /* td_dephash of the task outside */
+  struct kmp_taskgraph *tg_outer; /* enclosing taskgraph region, or NULL */
+} kmp_taskgraph_t;
+#endif // OMP_50_ENABLED
+
 #if OMP_50_ENABLED
 typedef struct kmp_task_affinity_info {
   kmp_intptr_t base_addr;
@@ -2376,6 +2428,9 @@ struct kmp_taskdata { /* aligned during dynamic allocation       */
   kmp_depnode_t
       *td_depnode; // Pointer to graph node if this task has dependencies
 #endif // OMP_40_ENABLED
+#if OMP_50_ENABLED
+  kmp_taskgraph_t *td_taskgraph; // Current taskgraph region of the task
+#endif
 #if OMP_45_ENABLED
   kmp_task_team_t *td_task_team;
   kmp_int32 td_size_alloc; // The size of task structure, including shareds etc.
@@ -2400,20 +2455,36 @@ struct kmp_taskdata { /* aligned during dynamic allocation       */
 // Make sure padding above worked
 KMP_BUILD_ASSERT(sizeof(kmp_taskdata_t) % sizeof(void *) == 0);
 
+// A thread that a thread of the team may steal tasks from
+typedef struct kmp_steal_victim {
+  kmp_int32 sv_tid; // Thread number of the victim
+  kmp_int32 sv_group_end; // Index past the last victim as near as this one
+} kmp_steal_victim_t;
+
 // Data for task team but per thread
 typedef struct kmp_base_thread_data {
   kmp_info_p *td_thr; // Pointer back to thread info
   // Used only in __kmp_execute_tasks_template, maybe not avail until task is
   // queued?
-  kmp_bootstrap_lock_t td_deque_lock; // Lock for accessing deque
+  kmp_bootstrap_lock_t td_deque_lock; // Lock for non-owner deque accesses
   kmp_taskdata_t *
       *td_deque; // Deque of tasks encountered by td_thr, dynamically allocated
   kmp_int32 td_deque_size; // Size of deck
-  kmp_uint32 td_deque_head; // Head of deque (will wrap)
-  kmp_uint32 td_deque_tail; // Tail of deque (will wrap)
-  kmp_int32 td_deque_ntasks; // Number of tasks in deque
+  // The head and tail only grow, and are masked to index td_deque. The
+  // deque holds tail - head tasks.
+  std::atomic<kmp_uint32> td_deque_head; // Head of deque, where thieves steal
+  std::atomic<kmp_uint32> td_deque_tail; // Tail of deque, where td_thr works
+  // Set while td_thr pushes or pops without holding td_deque_lock
+  std::atomic<kmp_int32> td_deque_owner_busy;
+  // Set while another thread needs the deque exclusively
+  std::atomic<kmp_int32> td_deque_exclusive;
   // GEH: shouldn't this be volatile since used in while-spin?
   kmp_int32 td_deque_last_stolen; // Thread number of last successful steal
+  // The other threads of the team, nearest first, for picking new victims
+  kmp_steal_victim_t *td_steal_order;
+  kmp_int32 td_steal_order_nthreads; // Team size of td_steal_order, or 0
+  kmp_int32 td_steal_order_place; // Place of td_thr for td_steal_order
+  kmp_int32 td_steal_range; // New victims are td_steal_order[0:td_steal_range]
 #ifdef BUILD_TIED_TASK_STACK
   kmp_task_stack_t td_susp_tied_tasks; // Stack of suspended tied tasks for task
 // scheduling constraint
@@ -2954,6 +3025,7 @@ extern kmp_uint32 __kmp_barrier_gather_branch_bits[bs_last_barrier];
 extern kmp_uint32 __kmp_barrier_release_branch_bits[bs_last_barrier];
 extern kmp_bar_pat_e __kmp_barrier_gather_pattern[bs_last_barrier];
 extern kmp_bar_pat_e __kmp_barrier_release_pattern[bs_last_barrier];
+extern int __kmp_barrier_pattern_user_set[bs_last_barrier];
 extern char const *__kmp_barrier_branch_bit_env_name[bs_last_barrier];
 extern char const *__kmp_barrier_pattern_env_name[bs_last_barrier];
 extern char const *__kmp_barrier_type_name[bs_last_barrier];
@@ -3454,6 +3526,7 @@ extern void __kmp_affinity_set_init_mask(
     int gtid, int isa_root); /* set affinity according to KMP_AFFINITY */
 #if OMP_40_ENABLED
 extern void __kmp_affinity_set_place(int gtid);
+extern int __kmp_affinity_place_distance(int place1, int place2);
 #endif
 extern void __kmp_affinity_determine_capable(const char *env_var);
 extern int __kmp_aux_set_affinity(void **mask);
@@ -3846,6 +3919,12 @@ KMP_EXPORT void __kmpc_omp_wait_deps(ident_t *loc_ref, kmp_int32 gtid,
                                      kmp_depend_info_t *dep_list,
                                      kmp_int32 ndeps_noalias,
                                      kmp_depend_info_t *noalias_dep_list);
+#if OMP_50_ENABLED
+KMP_EXPORT void __kmpc_taskgraph_begin(ident_t *loc_ref, kmp_int32 gtid,
+                                       kmp_int32 graph_id);
+KMP_EXPORT void __kmpc_taskgraph_end(ident_t *loc_ref, kmp_int32 gtid);
+extern void __kmp_taskgraph_cleanup(void);
+#endif
 
 extern kmp_int32 __kmp_omp_task(kmp_int32 gtid, kmp_task_t *new_task,
                                 bool serialize_immediate);
@@ -4083,6 +4083,11 @@ static int __kmp_affinity_max_proc_per_core(const AddrUnsPair *address2os,
 static AddrUnsPair *address2os = NULL;
 static int *procarr = NULL;
 static int __kmp_aff_depth = 0;
+// Topology labels of the first proc of each place, from the top of the
+// machine hierarchy down, used to tell how far apart two places are. NULL if
+// the places were not built from address2os.
+static unsigned *__kmp_affinity_place_labels = NULL;
+static int __kmp_affinity_place_depth = 0;
 
 #if KMP_USE_HIER_SCHED
 #define KMP_EXIT_AFF_NONE                                                      \
@@ -4112,6 +4117,30 @@ static void __kmp_create_affinity_none_places() {
   KMP_CPU_COPY(dest, __kmp_affin_fullMask);
 }
 
+// Minimum number of available procs for which the hierarchical barrier is
+// selected when the machine topology is known
+#define KMP_HIER_BARRIER_MIN_PROCS 16
+
+// The hierarchical barrier builds its tree from the machine hierarchy, and the
+// threads of a leaf of the tree check in and are released with one flag
+// word. Select it for the plain and fork/join barriers whose pattern was not
+// given by the user, when the threads are bound to places sorted in topology
+// order, so that nearby thread ids share the subtrees of the barrier.
+static void __kmp_affinity_select_barrier_patterns(int depth) {
+  if (__kmp_affinity_type != affinity_compact || __kmp_affinity_compact != 0 ||
+      depth < 2 || __kmp_avail_proc < KMP_HIER_BARRIER_MIN_PROCS)
+    return;
+  for (int i = bs_plain_barrier; i <= bs_forkjoin_barrier; i++) {
+    if (__kmp_barrier_pattern_user_set[i])
+      continue;
+    KA_TRACE(10, ("__kmp_affinity_select_barrier_patterns: using the "
+                  "hierarchical pattern for %s barriers\n",
+                  __kmp_barrier_type_name[i]));
+    __kmp_barrier_gather_pattern[i] = bp_hierarchical_bar;
+    __kmp_barrier_release_pattern[i] = bp_hierarchical_bar;
+  }
+}
+
 static int __kmp_affinity_cmp_Address_child_num(const void *a, const void *b) {
   const Address *aa = &(((const AddrUnsPair *)a)->first);
   const Address *bb = &(((const AddrUnsPair *)b)->first);
@@ -4630,6 +4659,9 @@ static void __kmp_aux_affinity_initialize(void) {
     // __kmp_affinity_compact, then fill out __kmp_affinity_masks.
     qsort(address2os, __kmp_avail_proc, sizeof(*address2os),
           __kmp_affinity_cmp_Address_child_num);
+    __kmp_affinity_place_depth = depth;
+    __kmp_affinity_place_labels = (unsigned *)__kmp_allocate(
+        sizeof(unsigned) * depth * __kmp_affinity_num_masks);
     {
       int i;
       unsigned j;
@@ -4642,6 +4674,8 @@ static void __kmp_aux_affinity_initialize(void) {
         kmp_affin_mask_t *dest = KMP_CPU_INDEX(__kmp_affinity_masks, j);
         KMP_ASSERT(KMP_CPU_ISSET(osId, src));
         KMP_CPU_COPY(dest, src);
+        KMP_MEMCPY(&__kmp_affinity_place_labels[j * depth],
+                   address2os[i].first.labels, sizeof(unsigned) * depth);
         if (++j >= __kmp_affinity_num_masks) {
           break;
         }
@@ -4656,6 +4690,7 @@ static void __kmp_aux_affinity_initialize(void) {
 
   KMP_CPU_FREE_ARRAY(osId2Mask, maxIndex + 1);
   machine_hierarchy.init(address2os, __kmp_avail_proc);
+  __kmp_affinity_select_barrier_patterns(depth);
 }
 #undef KMP_EXIT_AFF_NONE
 
@@ -4707,6 +4742,10 @@ void __kmp_affinity_uninitialize(void) {
     __kmp_free(procarr);
     procarr = NULL;
   }
+  if (__kmp_affinity_place_labels != NULL) {
+    __kmp_free(__kmp_affinity_place_labels);
+    __kmp_affinity_place_labels = NULL;
+  }
 #if KMP_USE_HWLOC
   if (__kmp_hwloc_topology != NULL) {
     hwloc_topology_destroy(__kmp_hwloc_topology);
@@ -4875,6 +4914,27 @@ void __kmp_affinity_set_place(int gtid) {
   __kmp_set_system_affinity(th->th.th_affin_mask, TRUE);
 }
 
+// Returns how many levels of the machine hierarchy, counted from the bottom,
+// separate place1 from place2: 0 for the same place, 1 for two threads of a
+// core with the thread granularity, ..., up to the depth of the hierarchy for
+// places in different packages. Returns -1 if the topology of the places is
+// not known.
+int __kmp_affinity_place_distance(int place1, int place2) {
+  if (__kmp_affinity_place_labels == NULL || place1 < 0 || place2 < 0 ||
+      place1 >= (int)__kmp_affinity_num_masks ||
+      place2 >= (int)__kmp_affinity_num_masks)
+    return -1;
+  if (place1 == place2)
+    return 0;
+  int depth = __kmp_affinity_place_depth;
+  const unsigned *labels1 = &__kmp_affinity_place_labels[place1 * depth];
+  const unsigned *labels2 = &__kmp_affinity_place_labels[place2 * depth];
+  int level = 0;
+  while (level < depth && labels1[level] == labels2[level])
+    level++;
+  return level < depth ? depth - level : 1;
+}
+
 #endif /* OMP_40_ENABLED */
 
 int __kmp_aux_set_affinity(void **mask) {
@@ -1188,6 +1188,7 @@ void KMP_EXPAND_NAME(KMP_API_NAME_GOMP_TASK)(void (*func)(void *), void *data,
         dep_list[i].len = 0U;
         dep_list[i].flags.in = 1;
         dep_list[i].flags.out = (i < nout);
+        dep_list[i].flags.mtx = 0;
       }
       __kmpc_omp_task_with_deps(&loc, gtid, task, ndeps, dep_list, 0, NULL);
     } else {
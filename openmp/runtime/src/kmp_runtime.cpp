@@ -6734,6 +6734,7 @@ static void __kmp_do_serial_initialize(void) {
     __kmp_barrier_release_branch_bits[i] = __kmp_barrier_release_bb_dflt;
     __kmp_barrier_gather_pattern[i] = __kmp_barrier_gather_pat_dflt;
     __kmp_barrier_release_pattern[i] = __kmp_barrier_release_pat_dflt;
+    __kmp_barrier_pattern_user_set[i] = FALSE;
 #if KMP_FAST_REDUCTION_BARRIER
     if (i == bs_reduction_barrier) { // tested and confirmed on ALTIX only (
       // lin_64 ): hyper,1
@@ -7606,6 +7607,9 @@ void __kmp_cleanup(void) {
   }
 
   __kmp_cleanup_threadprivate_caches();
+#if OMP_50_ENABLED
+  __kmp_taskgraph_cleanup();
+#endif
 
   for (f = 0; f < __kmp_threads_capacity; f++) {
     if (__kmp_root[f] != NULL) {
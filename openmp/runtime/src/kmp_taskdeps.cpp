@@ -44,6 +44,9 @@ static void __kmp_init_node(kmp_depnode_t *node) {
   node->dn.mtx_num_locks = 0;
   __kmp_init_lock(&node->dn.lock);
   KMP_ATOMIC_ST_RLX(&node->dn.nrefs, 1); // init creates the first reference
+#if OMP_50_ENABLED
+  node->dn.tg_seq = -1;
+#endif
 #ifdef KMP_SUPPORT_GRAPH_OUTPUT
   node->dn.id = KMP_ATOMIC_INC(&kmp_node_id_seed);
 #endif
@@ -180,6 +183,82 @@ static inline void __kmp_track_dependence(kmp_depnode_t *source,
 #endif /* OMPT_SUPPORT && OMPT_OPTIONAL */
 }
 
+#if OMP_50_ENABLED
+// Graphs recorded by the taskgraph regions
+static kmp_taskgraph_rec_t *__kmp_taskgraphs = NULL;
+static kmp_bootstrap_lock_t __kmp_taskgraphs_lock =
+    KMP_BOOTSTRAP_LOCK_INITIALIZER(__kmp_taskgraphs_lock);
+
+// Grows the array *p of *size elements of elem_size bytes to at least n
+// elements
+static void __kmp_taskgraph_reserve(void **p, kmp_int32 *size, kmp_int32 n,
+                                    size_t elem_size) {
+  if (n <= *size)
+    return;
+  kmp_int32 new_size = *size ? 2 * *size : 16;
+  while (new_size < n)
+    new_size *= 2;
+  void *new_p = __kmp_allocate(new_size * elem_size);
+  if (*p) {
+    KMP_MEMCPY(new_p, *p, *size * elem_size);
+    __kmp_free(*p);
+  }
+  *p = new_p;
+  *size = new_size;
+}
+
+// Records the next task with dependences of the region, and returns its
+// number in the graph, or -1 if the graph cannot be replayed
+static kmp_int32
+__kmp_taskgraph_record_task(kmp_taskgraph_t *tg, kmp_int32 ndeps,
+                            kmp_depend_info_t *dep_list,
+                            kmp_int32 ndeps_noalias,
+                            kmp_depend_info_t *noalias_dep_list) {
+  kmp_taskgraph_rec_t *rec = tg->tg_rec;
+  // The locks of the mutexinoutset dependences are found in the dependence
+  // hash, which is not built when replaying
+  for (kmp_int32 i = 0; i < ndeps; i++)
+    if (dep_list[i].flags.mtx)
+      goto unreplayable;
+  for (kmp_int32 i = 0; i < ndeps_noalias; i++)
+    if (noalias_dep_list[i].flags.mtx)
+      goto unreplayable;
+
+  __kmp_taskgraph_reserve((void **)&rec->tg_tasks, &rec->tg_tasks_size,
+                          rec->tg_ntasks + 1, sizeof(kmp_taskgraph_task_t));
+  rec->tg_tasks[rec->tg_ntasks].ndeps = ndeps + ndeps_noalias;
+  rec->tg_tasks[rec->tg_ntasks].first_pred = rec->tg_npreds;
+  rec->tg_tasks[rec->tg_ntasks].npreds = 0;
+  return rec->tg_ntasks++;
+
+unreplayable:
+  KA_TRACE(20, ("__kmp_taskgraph_record_task: taskgraph %d cannot be "
+                "replayed\n",
+                rec->tg_id));
+  rec->tg_state = tgs_unreplayable;
+  tg->tg_mode = tgm_plain;
+  return -1;
+}
+
+// Records that the task of node depends on the task of pred. It does even if
+// the task of pred has finished already, as it may not when replaying.
+static void __kmp_taskgraph_record_edge(kmp_info_t *thread,
+                                        kmp_depnode_t *pred,
+                                        kmp_depnode_t *node) {
+  kmp_taskgraph_rec_t *rec = thread->th.th_current_task->td_taskgraph->tg_rec;
+  kmp_taskgraph_task_t *t = &rec->tg_tasks[node->dn.tg_seq];
+  KMP_DEBUG_ASSERT(pred->dn.tg_seq >= 0 && pred->dn.tg_seq < node->dn.tg_seq);
+  // The task may depend on pred through several depend items
+  for (kmp_int32 i = t->first_pred; i < t->first_pred + t->npreds; i++)
+    if (rec->tg_preds[i] == pred->dn.tg_seq)
+      return;
+  __kmp_taskgraph_reserve((void **)&rec->tg_preds, &rec->tg_preds_size,
+                          rec->tg_npreds + 1, sizeof(kmp_int32));
+  rec->tg_preds[rec->tg_npreds++] = pred->dn.tg_seq;
+  t->npreds++;
+}
+#endif // OMP_50_ENABLED
+
 static inline kmp_int32
 __kmp_depnode_link_successor(kmp_int32 gtid, kmp_info_t *thread,
                              kmp_task_t *task, kmp_depnode_t *node,
@@ -190,6 +269,10 @@ __kmp_depnode_link_successor(kmp_int32 gtid, kmp_info_t *thread,
   // link node as successor of list elements
   for (kmp_depnode_list_t *p = plist; p; p = p->next) {
     kmp_depnode_t *dep = p->node;
+#if OMP_50_ENABLED
+    if (node->dn.tg_seq >= 0)
+      __kmp_taskgraph_record_edge(thread, dep, node);
+#endif
     if (dep->dn.task) {
       KMP_ACQUIRE_DEPNODE(gtid, dep);
       if (dep->dn.task) {
@@ -215,6 +298,10 @@ static inline kmp_int32 __kmp_depnode_link_successor(kmp_int32 gtid,
   if (!sink)
     return 0;
   kmp_int32 npredecessors = 0;
+#if OMP_50_ENABLED
+  if (source->dn.tg_seq >= 0)
+    __kmp_taskgraph_record_edge(thread, sink, source);
+#endif
   if (sink->dn.task) {
     // synchronously add source to sink' list of successors
     KMP_ACQUIRE_DEPNODE(gtid, sink);
@@ -433,6 +520,82 @@ static bool __kmp_check_deps(kmp_int32 gtid, kmp_depnode_t *node,
   return npredecessors > 0 ? true : false;
 }
 
+#if OMP_50_ENABLED
+// Links node, the node of the next task of a replayed graph, to the nodes of
+// the recorded predecessors of the task. Returns true if the task has any
+// outstanding dependence, as __kmp_check_deps.
+static bool __kmp_taskgraph_replay_deps(kmp_int32 gtid, kmp_info_t *thread,
+                                        kmp_taskgraph_t *tg,
+                                        kmp_depnode_t *node, kmp_task_t *task) {
+  kmp_taskgraph_rec_t *rec = tg->tg_rec;
+  kmp_taskgraph_task_t *t = &rec->tg_tasks[tg->tg_ntasks];
+
+  // see __kmp_check_deps for the protocol on npredecessors
+  node->dn.npredecessors = -1;
+  int npredecessors = 0;
+  for (kmp_int32 i = t->first_pred; i < t->first_pred + t->npreds; i++) {
+    kmp_depnode_t *pred = tg->tg_nodes[rec->tg_preds[i]];
+    npredecessors +=
+        __kmp_depnode_link_successor(gtid, thread, task, node, pred);
+  }
+  tg->tg_nodes[tg->tg_ntasks++] = __kmp_node_ref(node);
+
+  node->dn.task = task;
+  KMP_MB();
+  npredecessors++;
+  npredecessors =
+      node->dn.npredecessors.fetch_add(npredecessors) + npredecessors;
+
+  KA_TRACE(20, ("__kmp_taskgraph_replay_deps: T#%d found %d predecessors for "
+                "task %p\n",
+                gtid, npredecessors, KMP_TASK_TO_TASKDATA(task)));
+  return npredecessors > 0 ? true : false;
+}
+
+// Waits for all the tasks replayed so far by the region
+static void __kmp_taskgraph_wait_replayed(kmp_int32 gtid, kmp_info_t *thread,
+                                          kmp_taskgraph_t *tg) {
+  kmp_depnode_t node = {0};
+  __kmp_init_node(&node);
+  node.dn.npredecessors = -1;
+  int npredecessors = 0;
+  for (kmp_int32 i = 0; i < tg->tg_ntasks; i++)
+    npredecessors += __kmp_depnode_link_successor(gtid, thread, NULL, &node,
+                                                  tg->tg_nodes[i]);
+  KMP_MB();
+  npredecessors++;
+  npredecessors =
+      node.dn.npredecessors.fetch_add(npredecessors) + npredecessors;
+  if (npredecessors == 0)
+    return;
+
+  int thread_finished = FALSE;
+  kmp_flag_32 flag((std::atomic<kmp_uint32> *)&node.dn.npredecessors, 0U);
+  while (node.dn.npredecessors > 0) {
+    flag.execute_tasks(thread, gtid, FALSE,
+                       &thread_finished USE_ITT_BUILD_ARG(NULL),
+                       __kmp_task_stealing_constraint);
+  }
+}
+
+// Stops replaying the graph when the region creates a task that does not match
+// the recording. The dependences of the tasks replayed so far are not in the
+// dependence hash, so they are waited for before the dependences of the next
+// tasks are resolved from the hash. The graph is recorded again next time.
+static void __kmp_taskgraph_stop_replay(kmp_int32 gtid, kmp_info_t *thread,
+                                        kmp_taskgraph_t *tg) {
+  KA_TRACE(20, ("__kmp_taskgraph_stop_replay: T#%d stops replaying taskgraph "
+                "%d after %d tasks\n",
+                gtid, tg->tg_rec->tg_id, tg->tg_ntasks));
+  __kmp_taskgraph_wait_replayed(gtid, thread, tg);
+  for (kmp_int32 i = 0; i < tg->tg_ntasks; i++)
+    __kmp_node_deref(thread, tg->tg_nodes[i]);
+  tg->tg_ntasks = 0;
+  tg->tg_mode = tgm_plain;
+  tg->tg_rec->tg_state = tgs_empty;
+}
+#endif // OMP_50_ENABLED
+
 /*!
 @ingroup TASKING
 @param loc_ref location of the original task directive
@@ -541,8 +704,22 @@ kmp_int32 __kmpc_omp_task_with_deps(ident_t *loc_ref, kmp_int32 gtid,
 #endif
 
   if (!serial && (ndeps > 0 || ndeps_noalias > 0)) {
+#if OMP_50_ENABLED
+    kmp_taskgraph_t *tg = current_task->td_taskgraph;
+    kmp_int32 tg_seq = -1;
+    if (tg && tg->tg_mode == tgm_replay &&
+        (tg->tg_ntasks == tg->tg_rec->tg_ntasks ||
+         tg->tg_rec->tg_tasks[tg->tg_ntasks].ndeps != ndeps + ndeps_noalias))
+      __kmp_taskgraph_stop_replay(gtid, thread, tg);
+    if (tg && tg->tg_mode == tgm_record)
+      tg_seq = __kmp_taskgraph_record_task(tg, ndeps, dep_list, ndeps_noalias,
+                                           noalias_dep_list);
+    bool replay = tg && tg->tg_mode == tgm_replay;
+#else
+    bool replay = false;
+#endif
     /* if no dependencies have been tracked yet, create the dependence hash */
-    if (current_task->td_dephash == NULL)
+    if (current_task->td_dephash == NULL && !replay)
       current_task->td_dephash = __kmp_dephash_create(thread, current_task);
 
 #if USE_FAST_MEMORY
@@ -556,9 +733,17 @@ kmp_int32 __kmpc_omp_task_with_deps(ident_t *loc_ref, kmp_int32 gtid,
     __kmp_init_node(node);
     new_taskdata->td_depnode = node;
 
-    if (__kmp_check_deps(gtid, node, new_task, current_task->td_dephash,
-                         NO_DEP_BARRIER, ndeps, dep_list, ndeps_noalias,
-                         noalias_dep_list)) {
+    bool blocked;
+#if OMP_50_ENABLED
+    node->dn.tg_seq = tg_seq;
+    if (replay)
+      blocked = __kmp_taskgraph_replay_deps(gtid, thread, tg, node, new_task);
+    else
+#endif
+      blocked = __kmp_check_deps(gtid, node, new_task, current_task->td_dephash,
+                                 NO_DEP_BARRIER, ndeps, dep_list,
+                                 ndeps_noalias, noalias_dep_list);
+    if (blocked) {
       KA_TRACE(10, ("__kmpc_omp_task_with_deps(exit): T#%d task had blocking "
                     "dependencies: "
                     "loc=%p task=%p, return: TASK_CURRENT_NOT_QUEUED\n",
@@ -626,6 +811,18 @@ void __kmpc_omp_wait_deps(ident_t *loc_ref, kmp_int32 gtid, kmp_int32 ndeps,
 #if OMP_45_ENABLED
   ignore = ignore && thread->th.th_task_team != NULL &&
            thread->th.th_task_team->tt.tt_found_proxy_tasks == FALSE;
+#endif
+#if OMP_50_ENABLED
+  // A replayed graph does not record which tasks access which addresses, so
+  // wait for all the tasks replayed so far
+  kmp_taskgraph_t *tg = current_task->td_taskgraph;
+  if (!ignore && tg && tg->tg_mode == tgm_replay) {
+    __kmp_taskgraph_wait_replayed(gtid, thread, tg);
+    KA_TRACE(10, ("__kmpc_omp_wait_deps(exit): T#%d finished waiting for the "
+                  "replayed tasks : loc=%p\n",
+                  gtid, loc_ref));
+    return;
+  }
 #endif
   ignore = ignore || current_task->td_dephash == NULL;
 
@@ -660,4 +857,133 @@ void __kmpc_omp_wait_deps(ident_t *loc_ref, kmp_int32 gtid, kmp_int32 ndeps,
                 gtid, loc_ref));
 }
 
+#if OMP_50_ENABLED
+/*!
+@ingroup TASKING
+@param loc_ref location of the region
+@param gtid Global Thread ID of encountering thread
+@param graph_id identifier of the region
+
+Starts a taskgraph region: a taskgroup whose tasks with dependences create the
+same graph of dependences each time the region with this id is executed, even
+if the addresses of the depend items change. The dependences of the tasks of
+the region are resolved only against each other.
+
+The first execution of the region records the graph, and the next ones link
+the tasks to their recorded predecessors without looking the depend items up
+in a dependence hash. If a task does not match the recording, the rest of the
+region resolves the dependences normally and the graph is recorded again.
+*/
+void __kmpc_taskgraph_begin(ident_t *loc_ref, kmp_int32 gtid,
+                            kmp_int32 graph_id) {
+  KA_TRACE(10, ("__kmpc_taskgraph_begin(enter): T#%d loc=%p graph_id=%d\n",
+                gtid, loc_ref, graph_id));
+  kmp_info_t *thread = __kmp_threads[gtid];
+  kmp_taskdata_t *current_task = thread->th.th_current_task;
+
+  __kmpc_taskgroup(loc_ref, gtid);
+
+  kmp_taskgraph_t *tg = (kmp_taskgraph_t *)__kmp_allocate(sizeof(*tg));
+  tg->tg_mode = tgm_plain;
+  tg->tg_outer_dephash = current_task->td_dephash;
+  tg->tg_outer = current_task->td_taskgraph;
+  current_task->td_dephash = NULL;
+  current_task->td_taskgraph = tg;
+
+  // dependences are not computed in serial teams, see __kmpc_omp_task_with_deps
+  bool serial = current_task->td_flags.team_serial ||
+                current_task->td_flags.tasking_ser ||
+                current_task->td_flags.final;
+  kmp_task_team_t *task_team = thread->th.th_task_team;
+  serial = serial && !(task_team && task_team->tt.tt_found_proxy_tasks);
+  if (serial)
+    return;
+
+  __kmp_acquire_bootstrap_lock(&__kmp_taskgraphs_lock);
+  kmp_taskgraph_rec_t *rec = __kmp_taskgraphs;
+  while (rec && rec->tg_id != graph_id)
+    rec = rec->tg_next;
+  if (rec == NULL) {
+    rec = (kmp_taskgraph_rec_t *)__kmp_allocate(sizeof(*rec));
+    rec->tg_id = graph_id;
+    rec->tg_state = tgs_empty;
+    rec->tg_next = __kmp_taskgraphs;
+    __kmp_taskgraphs = rec;
+  }
+  // Another region with this id may be recording or replaying the graph
+  if (!rec->tg_in_use) {
+    rec->tg_in_use = true;
+    tg->tg_rec = rec;
+    if (rec->tg_state == tgs_recorded) {
+      tg->tg_mode = tgm_replay;
+      if (rec->tg_ntasks > 0)
+        tg->tg_nodes = (kmp_depnode_t **)__kmp_allocate(
+            rec->tg_ntasks * sizeof(kmp_depnode_t *));
+    } else if (rec->tg_state == tgs_empty) {
+      tg->tg_mode = tgm_record;
+      rec->tg_ntasks = 0;
+      rec->tg_npreds = 0;
+    }
+  }
+  __kmp_release_bootstrap_lock(&__kmp_taskgraphs_lock);
+
+  KA_TRACE(10, ("__kmpc_taskgraph_begin(exit): T#%d graph_id=%d mode=%d\n",
+                gtid, graph_id, tg->tg_mode));
+}
+
+/*!
+@ingroup TASKING
+@param loc_ref location of the region
+@param gtid Global Thread ID of encountering thread
+
+Ends a taskgraph region, waiting for all its tasks as __kmpc_end_taskgroup.
+*/
+void __kmpc_taskgraph_end(ident_t *loc_ref, kmp_int32 gtid) {
+  KA_TRACE(10, ("__kmpc_taskgraph_end(enter): T#%d loc=%p\n", gtid, loc_ref));
+  kmp_info_t *thread = __kmp_threads[gtid];
+  kmp_taskdata_t *current_task = thread->th.th_current_task;
+  kmp_taskgraph_t *tg = current_task->td_taskgraph;
+  KMP_DEBUG_ASSERT(tg != NULL);
+
+  __kmpc_end_taskgroup(loc_ref, gtid);
+
+  if (current_task->td_dephash)
+    __kmp_dephash_free(thread, current_task->td_dephash);
+  current_task->td_dephash = tg->tg_outer_dephash;
+  current_task->td_taskgraph = tg->tg_outer;
+
+  if (tg->tg_nodes) {
+    for (kmp_int32 i = 0; i < tg->tg_ntasks; i++)
+      __kmp_node_deref(thread, tg->tg_nodes[i]);
+    __kmp_free(tg->tg_nodes);
+  }
+  kmp_taskgraph_rec_t *rec = tg->tg_rec;
+  if (rec) {
+    __kmp_acquire_bootstrap_lock(&__kmp_taskgraphs_lock);
+    if (tg->tg_mode == tgm_record && rec->tg_ntasks > 0)
+      rec->tg_state = tgs_recorded;
+    rec->tg_in_use = false;
+    __kmp_release_bootstrap_lock(&__kmp_taskgraphs_lock);
+  }
+  KA_TRACE(10, ("__kmpc_taskgraph_end(exit): T#%d mode=%d\n", gtid,
+                tg->tg_mode));
+  __kmp_free(tg);
+}
+
+// Frees the recorded graphs at library shutdown
+void __kmp_taskgraph_cleanup(void) {
+  kmp_taskgraph_rec_t *rec = __kmp_taskgraphs;
+  while (rec) {
+    kmp_taskgraph_rec_t *next = rec->tg_next;
+    if (rec->tg_tasks)
+      __kmp_free(rec->tg_tasks);
+    if (rec->tg_preds)
+      __kmp_free(rec->tg_preds);
+    __kmp_free(rec);
+    rec = next;
+  }
+  __kmp_taskgraphs = NULL;
+}
+#endif // OMP_50_ENABLED
+
 #endif /* OMP_40_ENABLED */
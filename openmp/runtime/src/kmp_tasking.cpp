@@ -294,14 +294,76 @@ static bool __kmp_task_is_allowed(int gtid, const kmp_int32 is_constrained,
   return true;
 }
 
+// The deque of a thread is a Chase-Lev work-stealing deque. Its owner pushes
+// and pops tasks at the tail without taking td_deque_lock. Thieves hold the
+// lock, which serializes them with each other, and claim the task at the
+// head with a CAS on td_deque_head, racing with the owner only for the last
+// task.
+//
+// The operations that move tasks other than the head one, or the deque
+// itself, need the deque exclusively: growing it from another thread, giving
+// a task to another thread, or stealing from the middle of the deque. They
+// take the lock and then wait for the owner to leave its lock-free push or
+// pop. The owner in turn takes the lock when such an operation is pending,
+// or when the deque needs to grow.
+
+// __kmp_task_deque_ntasks: number of tasks in the deque, racy unless the
+// deque is held exclusively
+static inline kmp_int32
+__kmp_task_deque_ntasks(kmp_thread_data_t *thread_data) {
+  kmp_uint32 head = KMP_ATOMIC_LD_ACQ(&thread_data->td.td_deque_head);
+  kmp_uint32 tail = KMP_ATOMIC_LD_ACQ(&thread_data->td.td_deque_tail);
+  kmp_int32 ntasks = (kmp_int32)(tail - head);
+  // The owner's pop briefly moves the tail before the head of an empty deque
+  return ntasks < 0 ? 0 : ntasks;
+}
+
+// __kmp_enter_task_deque_owner: marks the owner of the deque as being in a
+// lock-free push or pop. Returns false, and the owner must take the lock
+// instead, if another thread needs the deque exclusively.
+static inline bool
+__kmp_enter_task_deque_owner(kmp_thread_data_t *thread_data) {
+  KMP_ATOMIC_OP(store, &thread_data->td.td_deque_owner_busy, 1, seq_cst);
+  if (KMP_ATOMIC_LD(&thread_data->td.td_deque_exclusive, seq_cst) == 0)
+    return true;
+  KMP_ATOMIC_ST_REL(&thread_data->td.td_deque_owner_busy, 0);
+  return false;
+}
+
+static inline void __kmp_exit_task_deque_owner(kmp_thread_data_t *thread_data) {
+  KMP_ATOMIC_ST_REL(&thread_data->td.td_deque_owner_busy, 0);
+}
+
+// __kmp_make_task_deque_exclusive: waits for the owner of the deque to leave
+// its lock-free push or pop, and keeps it from starting another one. The
+// caller must hold the deque_lock.
+static void __kmp_make_task_deque_exclusive(kmp_thread_data_t *thread_data) {
+  KMP_ATOMIC_OP(store, &thread_data->td.td_deque_exclusive, 1, seq_cst);
+  while (KMP_ATOMIC_LD(&thread_data->td.td_deque_owner_busy, seq_cst) != 0)
+    KMP_CPU_PAUSE();
+}
+
+static void __kmp_acquire_task_deque_exclusive(kmp_thread_data_t *thread_data) {
+  __kmp_acquire_bootstrap_lock(&thread_data->td.td_deque_lock);
+  __kmp_make_task_deque_exclusive(thread_data);
+}
+
+static void __kmp_release_task_deque_exclusive(kmp_thread_data_t *thread_data) {
+  KMP_ATOMIC_ST_REL(&thread_data->td.td_deque_exclusive, 0);
+  __kmp_release_bootstrap_lock(&thread_data->td.td_deque_lock);
+}
+
 // __kmp_realloc_task_deque:
 // Re-allocates a task deque for a particular thread, copies the content from
 // the old deque and adjusts the necessary data structures relating to the
-// deque. This operation must be done with the deque_lock being held
+// deque. This operation must be done with the deque_lock being held, and by
+// the owner of the deque or with the deque held exclusively
 static void __kmp_realloc_task_deque(kmp_info_t *thread,
                                      kmp_thread_data_t *thread_data) {
   kmp_int32 size = TASK_DEQUE_SIZE(thread_data->td);
   kmp_int32 new_size = 2 * size;
+  kmp_uint32 head = KMP_ATOMIC_LD_RLX(&thread_data->td.td_deque_head);
+  kmp_int32 ntasks = __kmp_task_deque_ntasks(thread_data);
 
   KE_TRACE(10, ("__kmp_realloc_task_deque: T#%d reallocating deque[from %d to "
                 "%d] for thread_data %p\n",
@@ -310,15 +372,14 @@ static void __kmp_realloc_task_deque(kmp_info_t *thread,
   kmp_taskdata_t **new_deque =
       (kmp_taskdata_t **)__kmp_allocate(new_size * sizeof(kmp_taskdata_t *));
 
-  int i, j;
-  for (i = thread_data->td.td_deque_head, j = 0; j < size;
-       i = (i + 1) & TASK_DEQUE_MASK(thread_data->td), j++)
-    new_deque[j] = thread_data->td.td_deque[i];
+  for (kmp_int32 j = 0; j < ntasks; j++)
+    new_deque[j] =
+        thread_data->td.td_deque[(head + j) & TASK_DEQUE_MASK(thread_data->td)];
 
   __kmp_free(thread_data->td.td_deque);
 
-  thread_data->td.td_deque_head = 0;
-  thread_data->td.td_deque_tail = size;
+  KMP_ATOMIC_ST_RLX(&thread_data->td.td_deque_head, 0);
+  KMP_ATOMIC_ST_RLX(&thread_data->td.td_deque_tail, (kmp_uint32)ntasks);
   thread_data->td.td_deque = new_deque;
   thread_data->td.td_deque_size = new_size;
 }
@@ -370,9 +431,27 @@ static kmp_int32 __kmp_push_task(kmp_int32 gtid, kmp_task_t *task) {
     __kmp_alloc_task_deque(thread, thread_data);
   }
 
+  // Push without the lock if there is room in the deque
+  if (__kmp_enter_task_deque_owner(thread_data)) {
+    kmp_uint32 tail = KMP_ATOMIC_LD_RLX(&thread_data->td.td_deque_tail);
+    kmp_uint32 head = KMP_ATOMIC_LD_ACQ(&thread_data->td.td_deque_head);
+    if ((kmp_int32)(tail - head) < TASK_DEQUE_SIZE(thread_data->td)) {
+      thread_data->td.td_deque[tail & TASK_DEQUE_MASK(thread_data->td)] =
+          taskdata; // Push taskdata
+      KMP_ATOMIC_ST_REL(&thread_data->td.td_deque_tail, tail + 1);
+      __kmp_exit_task_deque_owner(thread_data);
+      KA_TRACE(20, ("__kmp_push_task: T#%d returning TASK_SUCCESSFULLY_PUSHED: "
+                    "task=%p ntasks=%d head=%u tail=%u\n",
+                    gtid, taskdata, (kmp_int32)(tail + 1 - head), head,
+                    tail + 1));
+      return TASK_SUCCESSFULLY_PUSHED;
+    }
+    __kmp_exit_task_deque_owner(thread_data);
+  }
+
   int locked = 0;
   // Check if deque is full
-  if (TCR_4(thread_data->td.td_deque_ntasks) >=
+  if (__kmp_task_deque_ntasks(thread_data) >=
       TASK_DEQUE_SIZE(thread_data->td)) {
     if (__kmp_enable_task_throttling &&
         __kmp_task_is_allowed(gtid, __kmp_task_stealing_constraint, taskdata,
@@ -393,7 +472,7 @@ static kmp_int32 __kmp_push_task(kmp_int32 gtid, kmp_task_t *task) {
     __kmp_acquire_bootstrap_lock(&thread_data->td.td_deque_lock);
 #if OMP_45_ENABLED
     // Need to recheck as we can get a proxy task from thread outside of OpenMP
-    if (TCR_4(thread_data->td.td_deque_ntasks) >=
+    if (__kmp_task_deque_ntasks(thread_data) >=
         TASK_DEQUE_SIZE(thread_data->td)) {
       if (__kmp_enable_task_throttling &&
           __kmp_task_is_allowed(gtid, __kmp_task_stealing_constraint, taskdata,
@@ -411,21 +490,19 @@ static kmp_int32 __kmp_push_task(kmp_int32 gtid, kmp_task_t *task) {
 #endif
   }
   // Must have room since no thread can add tasks but calling thread
-  KMP_DEBUG_ASSERT(TCR_4(thread_data->td.td_deque_ntasks) <
+  KMP_DEBUG_ASSERT(__kmp_task_deque_ntasks(thread_data) <
                    TASK_DEQUE_SIZE(thread_data->td));
 
-  thread_data->td.td_deque[thread_data->td.td_deque_tail] =
+  // The lock keeps the thieves out, so the deque is not raced for
+  kmp_uint32 tail = KMP_ATOMIC_LD_RLX(&thread_data->td.td_deque_tail);
+  thread_data->td.td_deque[tail & TASK_DEQUE_MASK(thread_data->td)] =
       taskdata; // Push taskdata
-  // Wrap index.
-  thread_data->td.td_deque_tail =
-      (thread_data->td.td_deque_tail + 1) & TASK_DEQUE_MASK(thread_data->td);
-  TCW_4(thread_data->td.td_deque_ntasks,
-        TCR_4(thread_data->td.td_deque_ntasks) + 1); // Adjust task count
+  KMP_ATOMIC_ST_REL(&thread_data->td.td_deque_tail, tail + 1);
 
   KA_TRACE(20, ("__kmp_push_task: T#%d returning TASK_SUCCESSFULLY_PUSHED: "
                 "task=%p ntasks=%d head=%u tail=%u\n",
-                gtid, taskdata, thread_data->td.td_deque_ntasks,
-                thread_data->td.td_deque_head, thread_data->td.td_deque_tail));
+                gtid, taskdata, __kmp_task_deque_ntasks(thread_data),
+                KMP_ATOMIC_LD_RLX(&thread_data->td.td_deque_head), tail + 1));
 
   __kmp_release_bootstrap_lock(&thread_data->td.td_deque_lock);
 
@@ -1093,6 +1170,7 @@ void __kmp_init_implicit_task(ident_t *loc_ref, kmp_info_t *this_thr,
   task->td_last_tied = task;
 #if OMP_50_ENABLED
   task->td_allow_completion_event.type = KMP_EVENT_UNINITIALIZED;
+  task->td_taskgraph = NULL;
 #endif
 
   if (set_curr_task) { // only do this init first time thread is created
@@ -1365,6 +1443,9 @@ kmp_task_t *__kmp_task_alloc(ident_t *loc_ref, kmp_int32 gtid,
       parent_task->td_taskgroup; // task inherits taskgroup from the parent task
   taskdata->td_dephash = NULL;
   taskdata->td_depnode = NULL;
+#endif
+#if OMP_50_ENABLED
+  taskdata->td_taskgraph = NULL;
 #endif
   if (flags->tiedness == TASK_UNTIED)
     taskdata->td_last_tied = NULL; // will be set when the task is scheduled
@@ -2683,7 +2764,7 @@ static kmp_task_t *__kmp_remove_my_task(kmp_info_t *thread, kmp_int32 gtid,
   kmp_task_t *task;
   kmp_taskdata_t *taskdata;
   kmp_thread_data_t *thread_data;
-  kmp_uint32 tail;
+  kmp_uint32 head, tail;
 
   KMP_DEBUG_ASSERT(__kmp_tasking_mode != tskm_immediate_exec);
   KMP_DEBUG_ASSERT(task_team->tt.tt_threads_data !=
@@ -2692,60 +2773,122 @@ static kmp_task_t *__kmp_remove_my_task(kmp_info_t *thread, kmp_int32 gtid,
   thread_data = &task_team->tt.tt_threads_data[__kmp_tid_from_gtid(gtid)];
 
   KA_TRACE(10, ("__kmp_remove_my_task(enter): T#%d ntasks=%d head=%u tail=%u\n",
-                gtid, thread_data->td.td_deque_ntasks,
-                thread_data->td.td_deque_head, thread_data->td.td_deque_tail));
+                gtid, __kmp_task_deque_ntasks(thread_data),
+                KMP_ATOMIC_LD_RLX(&thread_data->td.td_deque_head),
+                KMP_ATOMIC_LD_RLX(&thread_data->td.td_deque_tail)));
 
-  if (TCR_4(thread_data->td.td_deque_ntasks) == 0) {
+  if (__kmp_task_deque_ntasks(thread_data) == 0) {
     KA_TRACE(10,
              ("__kmp_remove_my_task(exit #1): T#%d No tasks to remove: "
               "ntasks=%d head=%u tail=%u\n",
-              gtid, thread_data->td.td_deque_ntasks,
-              thread_data->td.td_deque_head, thread_data->td.td_deque_tail));
+              gtid, __kmp_task_deque_ntasks(thread_data),
+              KMP_ATOMIC_LD_RLX(&thread_data->td.td_deque_head),
+              KMP_ATOMIC_LD_RLX(&thread_data->td.td_deque_tail)));
     return NULL;
   }
 
-  __kmp_acquire_bootstrap_lock(&thread_data->td.td_deque_lock);
+  bool locked = !__kmp_enter_task_deque_owner(thread_data);
+  if (locked)
+    __kmp_acquire_bootstrap_lock(&thread_data->td.td_deque_lock);
 
-  if (TCR_4(thread_data->td.td_deque_ntasks) == 0) {
-    __kmp_release_bootstrap_lock(&thread_data->td.td_deque_lock);
+  // Reserve the tail task first, then look at the head: the thieves may have
+  // taken all the tasks meanwhile. With the lock held there are no thieves
+  tail = KMP_ATOMIC_LD_RLX(&thread_data->td.td_deque_tail) - 1;
+  KMP_ATOMIC_ST_RLX(&thread_data->td.td_deque_tail, tail);
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  head = KMP_ATOMIC_LD_RLX(&thread_data->td.td_deque_head);
+
+  if ((kmp_int32)(tail - head) < 0) {
+    KMP_ATOMIC_ST_RLX(&thread_data->td.td_deque_tail, tail + 1);
+    if (locked)
+      __kmp_release_bootstrap_lock(&thread_data->td.td_deque_lock);
+    else
+      __kmp_exit_task_deque_owner(thread_data);
     KA_TRACE(10,
              ("__kmp_remove_my_task(exit #2): T#%d No tasks to remove: "
               "ntasks=%d head=%u tail=%u\n",
-              gtid, thread_data->td.td_deque_ntasks,
-              thread_data->td.td_deque_head, thread_data->td.td_deque_tail));
+              gtid, 0, tail + 1, tail + 1));
     return NULL;
   }
 
-  tail = (thread_data->td.td_deque_tail - 1) &
-         TASK_DEQUE_MASK(thread_data->td); // Wrap index.
-  taskdata = thread_data->td.td_deque[tail];
+  taskdata = thread_data->td.td_deque[tail & TASK_DEQUE_MASK(thread_data->td)];
+
+  if (tail == head) {
+    // The last task: win it from the thieves, then the deque is empty. The
+    // task must not be looked at before, as a thief could execute and free
+    // it meanwhile
+    if (!locked && !thread_data->td.td_deque_head.compare_exchange_strong(
+                       head, head + 1, std::memory_order_seq_cst,
+                       std::memory_order_relaxed)) {
+      KMP_ATOMIC_ST_RLX(&thread_data->td.td_deque_tail, tail + 1);
+      __kmp_exit_task_deque_owner(thread_data);
+      KA_TRACE(10,
+               ("__kmp_remove_my_task(exit #2): T#%d No tasks to remove: "
+                "ntasks=%d head=%u tail=%u\n",
+                gtid, 0, tail + 1, tail + 1));
+      return NULL;
+    }
+    if (locked)
+      KMP_ATOMIC_ST_RLX(&thread_data->td.td_deque_head, head + 1);
+    KMP_ATOMIC_ST_RLX(&thread_data->td.td_deque_tail, tail + 1);
+
+    if (!__kmp_task_is_allowed(gtid, is_constrained, taskdata,
+                               thread->th.th_current_task)) {
+      // The TSC does not allow to execute the task: push it back, there is
+      // room in the empty deque
+      tail = tail + 1;
+      thread_data->td.td_deque[tail & TASK_DEQUE_MASK(thread_data->td)] =
+          taskdata;
+      KMP_ATOMIC_ST_REL(&thread_data->td.td_deque_tail, tail + 1);
+      taskdata = NULL;
+    }
+  } else if (!__kmp_task_is_allowed(gtid, is_constrained, taskdata,
+                                    thread->th.th_current_task)) {
+    // The TSC does not allow to execute the tail task: the thieves can't
+    // have taken it, give it back
+    KMP_ATOMIC_ST_REL(&thread_data->td.td_deque_tail, tail + 1);
+    taskdata = NULL;
+  }
 
-  if (!__kmp_task_is_allowed(gtid, is_constrained, taskdata,
-                             thread->th.th_current_task)) {
-    // The TSC does not allow to steal victim task
+  if (locked)
     __kmp_release_bootstrap_lock(&thread_data->td.td_deque_lock);
+  else
+    __kmp_exit_task_deque_owner(thread_data);
+
+  if (taskdata == NULL) {
     KA_TRACE(10,
              ("__kmp_remove_my_task(exit #3): T#%d TSC blocks tail task: "
               "ntasks=%d head=%u tail=%u\n",
-              gtid, thread_data->td.td_deque_ntasks,
-              thread_data->td.td_deque_head, thread_data->td.td_deque_tail));
+              gtid, __kmp_task_deque_ntasks(thread_data),
+              KMP_ATOMIC_LD_RLX(&thread_data->td.td_deque_head),
+              KMP_ATOMIC_LD_RLX(&thread_data->td.td_deque_tail)));
     return NULL;
   }
 
-  thread_data->td.td_deque_tail = tail;
-  TCW_4(thread_data->td.td_deque_ntasks, thread_data->td.td_deque_ntasks - 1);
-
-  __kmp_release_bootstrap_lock(&thread_data->td.td_deque_lock);
-
   KA_TRACE(10, ("__kmp_remove_my_task(exit #4): T#%d task %p removed: "
                 "ntasks=%d head=%u tail=%u\n",
-                gtid, taskdata, thread_data->td.td_deque_ntasks,
-                thread_data->td.td_deque_head, thread_data->td.td_deque_tail));
+                gtid, taskdata, __kmp_task_deque_ntasks(thread_data),
+                KMP_ATOMIC_LD_RLX(&thread_data->td.td_deque_head),
+                KMP_ATOMIC_LD_RLX(&thread_data->td.td_deque_tail)));
 
   task = KMP_TASKDATA_TO_TASK(taskdata);
   return task;
 }
 
+// __kmp_unsteal_task: put back at the head of the victim's deque a task that
+// was claimed by a thief that may not execute it. The thief must hold the
+// victim's deque exclusively.
+static void __kmp_unsteal_task(kmp_info_t *victim_thr,
+                               kmp_thread_data_t *victim_td,
+                               kmp_taskdata_t *taskdata) {
+  // The owner may have filled the deque since the task was claimed
+  if (__kmp_task_deque_ntasks(victim_td) >= TASK_DEQUE_SIZE(victim_td->td))
+    __kmp_realloc_task_deque(victim_thr, victim_td);
+  kmp_uint32 head = KMP_ATOMIC_LD_RLX(&victim_td->td.td_deque_head) - 1;
+  victim_td->td.td_deque[head & TASK_DEQUE_MASK(victim_td->td)] = taskdata;
+  KMP_ATOMIC_ST_RLX(&victim_td->td.td_deque_head, head);
+}
+
 // __kmp_steal_task: remove a task from another thread's deque
 // Assume that calling thread has already checked existence of
 // task_team thread_data before calling this routine.
@@ -2758,7 +2901,7 @@ static kmp_task_t *__kmp_steal_task(kmp_info_t *victim_thr, kmp_int32 gtid,
   kmp_taskdata_t *taskdata;
   kmp_taskdata_t *current;
   kmp_thread_data_t *victim_td, *threads_data;
-  kmp_int32 target;
+  kmp_uint32 head, tail, target;
   kmp_int32 victim_tid;
 
   KMP_DEBUG_ASSERT(__kmp_tasking_mode != tskm_immediate_exec);
@@ -2772,55 +2915,80 @@ static kmp_task_t *__kmp_steal_task(kmp_info_t *victim_thr, kmp_int32 gtid,
   KA_TRACE(10, ("__kmp_steal_task(enter): T#%d try to steal from T#%d: "
                 "task_team=%p ntasks=%d head=%u tail=%u\n",
                 gtid, __kmp_gtid_from_thread(victim_thr), task_team,
-                victim_td->td.td_deque_ntasks, victim_td->td.td_deque_head,
-                victim_td->td.td_deque_tail));
+                __kmp_task_deque_ntasks(victim_td),
+                KMP_ATOMIC_LD_RLX(&victim_td->td.td_deque_head),
+                KMP_ATOMIC_LD_RLX(&victim_td->td.td_deque_tail)));
 
-  if (TCR_4(victim_td->td.td_deque_ntasks) == 0) {
+  if (__kmp_task_deque_ntasks(victim_td) == 0) {
     KA_TRACE(10, ("__kmp_steal_task(exit #1): T#%d could not steal from T#%d: "
                   "task_team=%p ntasks=%d head=%u tail=%u\n",
                   gtid, __kmp_gtid_from_thread(victim_thr), task_team,
-                  victim_td->td.td_deque_ntasks, victim_td->td.td_deque_head,
-                  victim_td->td.td_deque_tail));
+                  __kmp_task_deque_ntasks(victim_td),
+                  KMP_ATOMIC_LD_RLX(&victim_td->td.td_deque_head),
+                  KMP_ATOMIC_LD_RLX(&victim_td->td.td_deque_tail)));
     return NULL;
   }
 
+  // The lock only keeps the other thieves out, the victim keeps working on
+  // the tail of its deque
   __kmp_acquire_bootstrap_lock(&victim_td->td.td_deque_lock);
+  bool exclusive = false;
 
-  int ntasks = TCR_4(victim_td->td.td_deque_ntasks);
+  head = KMP_ATOMIC_LD_ACQ(&victim_td->td.td_deque_head);
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  tail = KMP_ATOMIC_LD_ACQ(&victim_td->td.td_deque_tail);
+  int ntasks = (kmp_int32)(tail - head);
   // Check again after we acquire the lock
-  if (ntasks == 0) {
+  if (ntasks <= 0) {
     __kmp_release_bootstrap_lock(&victim_td->td.td_deque_lock);
     KA_TRACE(10, ("__kmp_steal_task(exit #2): T#%d could not steal from T#%d: "
                   "task_team=%p ntasks=%d head=%u tail=%u\n",
-                  gtid, __kmp_gtid_from_thread(victim_thr), task_team, ntasks,
-                  victim_td->td.td_deque_head, victim_td->td.td_deque_tail));
+                  gtid, __kmp_gtid_from_thread(victim_thr), task_team, 0,
+                  head, tail));
     return NULL;
   }
 
   KMP_DEBUG_ASSERT(victim_td->td.td_deque != NULL);
   current = __kmp_threads[gtid]->th.th_current_task;
-  taskdata = victim_td->td.td_deque[victim_td->td.td_deque_head];
-  if (__kmp_task_is_allowed(gtid, is_constrained, taskdata, current)) {
-    // Bump head pointer and Wrap.
-    victim_td->td.td_deque_head =
-        (victim_td->td.td_deque_head + 1) & TASK_DEQUE_MASK(victim_td->td);
-  } else {
+  taskdata = victim_td->td.td_deque[head & TASK_DEQUE_MASK(victim_td->td)];
+  // Claim the head task before looking at it: the victim may be popping it
+  // as its last task
+  if (!victim_td->td.td_deque_head.compare_exchange_strong(
+          head, head + 1, std::memory_order_seq_cst,
+          std::memory_order_relaxed)) {
+    __kmp_release_bootstrap_lock(&victim_td->td.td_deque_lock);
+    KA_TRACE(10, ("__kmp_steal_task(exit #2): T#%d could not steal from T#%d: "
+                  "task_team=%p ntasks=%d head=%u tail=%u\n",
+                  gtid, __kmp_gtid_from_thread(victim_thr), task_team, 0,
+                  head, head));
+    return NULL;
+  }
+  if (!__kmp_task_is_allowed(gtid, is_constrained, taskdata, current)) {
+    // The TSC does not allow to steal the head task. Putting it back, and
+    // looking further into the deque, needs the victim out of the way
+    __kmp_make_task_deque_exclusive(victim_td);
+    exclusive = true;
+    __kmp_unsteal_task(victim_thr, victim_td, taskdata);
+    head = KMP_ATOMIC_LD_RLX(&victim_td->td.td_deque_head);
+    tail = KMP_ATOMIC_LD_RLX(&victim_td->td.td_deque_tail);
+    ntasks = (kmp_int32)(tail - head);
     if (!task_team->tt.tt_untied_task_encountered) {
       // The TSC does not allow to steal victim task
-      __kmp_release_bootstrap_lock(&victim_td->td.td_deque_lock);
+      __kmp_release_task_deque_exclusive(victim_td);
       KA_TRACE(10, ("__kmp_steal_task(exit #3): T#%d could not steal from "
                     "T#%d: task_team=%p ntasks=%d head=%u tail=%u\n",
                     gtid, __kmp_gtid_from_thread(victim_thr), task_team, ntasks,
-                    victim_td->td.td_deque_head, victim_td->td.td_deque_tail));
+                    head, tail));
       return NULL;
     }
     int i;
     // walk through victim's deque trying to steal any task
-    target = victim_td->td.td_deque_head;
+    target = head;
     taskdata = NULL;
     for (i = 1; i < ntasks; ++i) {
-      target = (target + 1) & TASK_DEQUE_MASK(victim_td->td);
-      taskdata = victim_td->td.td_deque[target];
+      target = target + 1;
+      taskdata =
+          victim_td->td.td_deque[target & TASK_DEQUE_MASK(victim_td->td)];
       if (__kmp_task_is_allowed(gtid, is_constrained, taskdata, current)) {
         break; // found victim task
       } else {
@@ -2829,24 +2997,23 @@ static kmp_task_t *__kmp_steal_task(kmp_info_t *victim_thr, kmp_int32 gtid,
     }
     if (taskdata == NULL) {
       // No appropriate candidate to steal found
-      __kmp_release_bootstrap_lock(&victim_td->td.td_deque_lock);
+      __kmp_release_task_deque_exclusive(victim_td);
       KA_TRACE(10, ("__kmp_steal_task(exit #4): T#%d could not steal from "
                     "T#%d: task_team=%p ntasks=%d head=%u tail=%u\n",
                     gtid, __kmp_gtid_from_thread(victim_thr), task_team, ntasks,
-                    victim_td->td.td_deque_head, victim_td->td.td_deque_tail));
+                    head, tail));
       return NULL;
     }
-    int prev = target;
+    kmp_uint32 prev = target;
     for (i = i + 1; i < ntasks; ++i) {
       // shift remaining tasks in the deque left by 1
-      target = (target + 1) & TASK_DEQUE_MASK(victim_td->td);
-      victim_td->td.td_deque[prev] = victim_td->td.td_deque[target];
+      target = target + 1;
+      victim_td->td.td_deque[prev & TASK_DEQUE_MASK(victim_td->td)] =
+          victim_td->td.td_deque[target & TASK_DEQUE_MASK(victim_td->td)];
       prev = target;
     }
-    KMP_DEBUG_ASSERT(
-        victim_td->td.td_deque_tail ==
-        (kmp_uint32)((target + 1) & TASK_DEQUE_MASK(victim_td->td)));
-    victim_td->td.td_deque_tail = target; // tail -= 1 (wrapped))
+    KMP_DEBUG_ASSERT(tail == target + 1);
+    KMP_ATOMIC_ST_RLX(&victim_td->td.td_deque_tail, target); // tail -= 1
   }
   if (*thread_finished) {
     // We need to un-mark this victim as a finished victim.  This must be done
@@ -2863,21 +3030,111 @@ static kmp_task_t *__kmp_steal_task(kmp_info_t *victim_thr, kmp_int32 gtid,
 
     *thread_finished = FALSE;
   }
-  TCW_4(victim_td->td.td_deque_ntasks, ntasks - 1);
 
-  __kmp_release_bootstrap_lock(&victim_td->td.td_deque_lock);
+  if (exclusive)
+    __kmp_release_task_deque_exclusive(victim_td);
+  else
+    __kmp_release_bootstrap_lock(&victim_td->td.td_deque_lock);
 
   KMP_COUNT_BLOCK(TASK_stolen);
   KA_TRACE(10,
            ("__kmp_steal_task(exit #5): T#%d stole task %p from T#%d: "
             "task_team=%p ntasks=%d head=%u tail=%u\n",
             gtid, taskdata, __kmp_gtid_from_thread(victim_thr), task_team,
-            ntasks, victim_td->td.td_deque_head, victim_td->td.td_deque_tail));
+            ntasks, KMP_ATOMIC_LD_RLX(&victim_td->td.td_deque_head),
+            KMP_ATOMIC_LD_RLX(&victim_td->td.td_deque_tail)));
 
   task = KMP_TASKDATA_TO_TASK(taskdata);
   return task;
 }
 
+#if OMP_40_ENABLED && KMP_AFFINITY_SUPPORTED
+// __kmp_init_task_steal_order: sort the other threads of the team by the
+// distance of their places to the place of the calling thread. Leaves
+// td_steal_order NULL if the topology of the places is not known.
+static void __kmp_init_task_steal_order(kmp_info_t *thread,
+                                        kmp_thread_data_t *threads_data,
+                                        kmp_int32 tid, kmp_int32 nthreads) {
+  kmp_thread_data_t *thread_data = &threads_data[tid];
+  int place = thread->th.th_current_place;
+
+  thread_data->td.td_steal_order_nthreads = nthreads;
+  thread_data->td.td_steal_order_place = place;
+  if (thread_data->td.td_steal_order != NULL) {
+    __kmp_free(thread_data->td.td_steal_order);
+    thread_data->td.td_steal_order = NULL;
+  }
+  if (__kmp_affinity_place_distance(place, place) < 0)
+    return;
+
+  // The threads whose place is not known come last
+  kmp_int32 *distance = (kmp_int32 *)KMP_ALLOCA(sizeof(kmp_int32) * nthreads);
+  kmp_int32 max_distance = 0;
+  for (kmp_int32 i = 0; i < nthreads; i++) {
+    kmp_info_t *other_thread = threads_data[i].td.td_thr;
+    distance[i] = __kmp_affinity_place_distance(
+        place, other_thread->th.th_current_place);
+    if (distance[i] > max_distance)
+      max_distance = distance[i];
+  }
+  for (kmp_int32 i = 0; i < nthreads; i++)
+    if (distance[i] < 0)
+      distance[i] = max_distance + 1;
+
+  kmp_steal_victim_t *order = (kmp_steal_victim_t *)__kmp_allocate(
+      sizeof(kmp_steal_victim_t) * (nthreads - 1));
+  kmp_int32 n = 0;
+  for (kmp_int32 d = 0; d <= max_distance + 1; d++) {
+    kmp_int32 group_begin = n;
+    // Start after the calling thread, so that the threads of a group do not
+    // all list the same victims in the same order
+    for (kmp_int32 j = 1; j < nthreads; j++) {
+      kmp_int32 i = (tid + j) % nthreads;
+      if (distance[i] == d)
+        order[n++].sv_tid = i;
+    }
+    for (kmp_int32 k = group_begin; k < n; k++)
+      order[k].sv_group_end = n;
+  }
+  KMP_DEBUG_ASSERT(n == nthreads - 1);
+
+  thread_data->td.td_steal_order = order;
+  thread_data->td.td_steal_range = order[0].sv_group_end;
+}
+#endif // OMP_40_ENABLED && KMP_AFFINITY_SUPPORTED
+
+// __kmp_get_task_steal_victim: pick a new thread to steal tasks from. When the
+// topology of the places is known, the victim is picked among the threads
+// nearest to the calling thread, and each new pick widens the choice to the
+// next nearest threads (same core, same package, then any) until a steal
+// succeeds. Otherwise any other thread of the team may be picked.
+static kmp_int32
+__kmp_get_task_steal_victim(kmp_info_t *thread, kmp_thread_data_t *threads_data,
+                            kmp_int32 tid, kmp_int32 nthreads) {
+  kmp_int32 victim_tid;
+#if OMP_40_ENABLED && KMP_AFFINITY_SUPPORTED
+  kmp_thread_data_t *thread_data = &threads_data[tid];
+  if (__kmp_task_steal_locality && nthreads > 2) {
+    if (thread_data->td.td_steal_order_nthreads != nthreads ||
+        thread_data->td.td_steal_order_place != thread->th.th_current_place)
+      __kmp_init_task_steal_order(thread, threads_data, tid, nthreads);
+    kmp_steal_victim_t *order = thread_data->td.td_steal_order;
+    if (order != NULL) {
+      kmp_int32 range = thread_data->td.td_steal_range;
+      victim_tid = order[__kmp_get_random(thread) % range].sv_tid;
+      if (range < nthreads - 1)
+        thread_data->td.td_steal_range = order[range].sv_group_end;
+      return victim_tid;
+    }
+  }
+#endif
+  victim_tid = __kmp_get_random(thread) % (nthreads - 1);
+  if (victim_tid >= tid) {
+    ++victim_tid; // Adjusts random distribution to exclude self
+  }
+  return victim_tid;
+}
+
 // __kmp_execute_tasks_template: Choose and execute tasks until either the
 // condition is statisfied (return true) or there are none left (return false).
 //
@@ -2949,10 +3206,8 @@ static inline int __kmp_execute_tasks_template(
             // Pick a random thread. Initial plan was to cycle through all the
             // threads, and only return if we tried to steal from every thread,
             // and failed.  Arch says that's not such a great idea.
-            victim_tid = __kmp_get_random(thread) % (nthreads - 1);
-            if (victim_tid >= tid) {
-              ++victim_tid; // Adjusts random distribution to exclude self
-            }
+            victim_tid = __kmp_get_task_steal_victim(thread, threads_data,
+                                                     tid, nthreads);
             // Found a potential victim
             other_thread = threads_data[victim_tid].td.td_thr;
             // There is a slight chance that __kmp_enable_tasking() did not wake
@@ -2988,6 +3243,12 @@ static inline int __kmp_execute_tasks_template(
                                   is_constrained);
         }
         if (task != NULL) { // set last stolen to victim
+#if OMP_40_ENABLED && KMP_AFFINITY_SUPPORTED
+          // Pick the next new victim among the nearest threads again
+          if (threads_data[tid].td.td_steal_order != NULL)
+            threads_data[tid].td.td_steal_range =
+                threads_data[tid].td.td_steal_order[0].sv_group_end;
+#endif
           if (threads_data[tid].td.td_deque_last_stolen != victim_tid) {
             threads_data[tid].td.td_deque_last_stolen = victim_tid;
             // The pre-refactored code did not try more than 1 successful new
@@ -3037,7 +3298,7 @@ static inline int __kmp_execute_tasks_template(
       KMP_YIELD(__kmp_library == library_throughput); // Yield before next task
       // If execution of a stolen task results in more tasks being placed on our
       // run queue, reset use_own_tasks
-      if (!use_own_tasks && TCR_4(threads_data[tid].td.td_deque_ntasks) != 0) {
+      if (!use_own_tasks && __kmp_task_deque_ntasks(&threads_data[tid]) != 0) {
         KA_TRACE(20, ("__kmp_execute_tasks_template: T#%d stolen task spawned "
                       "other tasks, restart\n",
                       gtid));
@@ -3255,9 +3516,9 @@ static void __kmp_alloc_task_deque(kmp_info_t *thread,
   // Initialize last stolen task field to "none"
   thread_data->td.td_deque_last_stolen = -1;
 
-  KMP_DEBUG_ASSERT(TCR_4(thread_data->td.td_deque_ntasks) == 0);
-  KMP_DEBUG_ASSERT(thread_data->td.td_deque_head == 0);
-  KMP_DEBUG_ASSERT(thread_data->td.td_deque_tail == 0);
+  KMP_DEBUG_ASSERT(KMP_ATOMIC_LD_RLX(&thread_data->td.td_deque_head) == 0);
+  KMP_DEBUG_ASSERT(KMP_ATOMIC_LD_RLX(&thread_data->td.td_deque_tail) == 0);
+  KMP_DEBUG_ASSERT(KMP_ATOMIC_LD_RLX(&thread_data->td.td_deque_exclusive) == 0);
 
   KE_TRACE(
       10,
@@ -3277,7 +3538,8 @@ static void __kmp_alloc_task_deque(kmp_info_t *thread,
 static void __kmp_free_task_deque(kmp_thread_data_t *thread_data) {
   if (thread_data->td.td_deque != NULL) {
     __kmp_acquire_bootstrap_lock(&thread_data->td.td_deque_lock);
-    TCW_4(thread_data->td.td_deque_ntasks, 0);
+    KMP_ATOMIC_ST_RLX(&thread_data->td.td_deque_head, 0);
+    KMP_ATOMIC_ST_RLX(&thread_data->td.td_deque_tail, 0);
     __kmp_free(thread_data->td.td_deque);
     thread_data->td.td_deque = NULL;
     __kmp_release_bootstrap_lock(&thread_data->td.td_deque_lock);
@@ -3391,6 +3653,8 @@ static int __kmp_realloc_task_threads_data(kmp_info_t *thread,
         // parallel region will exhibit the same behavior as previous region.
         thread_data->td.td_deque_last_stolen = -1;
       }
+      // The threads of the team, or their places, may have changed as well
+      thread_data->td.td_steal_order_nthreads = 0;
     }
 
     KMP_MB();
@@ -3410,6 +3674,8 @@ static void __kmp_free_task_threads_data(kmp_task_team_t *task_team) {
     int i;
     for (i = 0; i < task_team->tt.tt_max_threads; i++) {
       __kmp_free_task_deque(&task_team->tt.tt_threads_data[i]);
+      if (task_team->tt.tt_threads_data[i].td.td_steal_order != NULL)
+        __kmp_free(task_team->tt.tt_threads_data[i].td.td_steal_order);
     }
     __kmp_free(task_team->tt.tt_threads_data);
     task_team->tt.tt_threads_data = NULL;
@@ -3773,7 +4039,7 @@ static bool __kmp_give_task(kmp_info_t *thread, kmp_int32 tid, kmp_task_t *task,
     return result;
   }
 
-  if (TCR_4(thread_data->td.td_deque_ntasks) >=
+  if (__kmp_task_deque_ntasks(thread_data) >=
       TASK_DEQUE_SIZE(thread_data->td)) {
     KA_TRACE(
         30,
@@ -3785,14 +4051,14 @@ static bool __kmp_give_task(kmp_info_t *thread, kmp_int32 tid, kmp_task_t *task,
     if (TASK_DEQUE_SIZE(thread_data->td) / INITIAL_TASK_DEQUE_SIZE >= pass)
       return result;
 
-    __kmp_acquire_bootstrap_lock(&thread_data->td.td_deque_lock);
+    __kmp_acquire_task_deque_exclusive(thread_data);
     __kmp_realloc_task_deque(thread, thread_data);
 
   } else {
 
-    __kmp_acquire_bootstrap_lock(&thread_data->td.td_deque_lock);
+    __kmp_acquire_task_deque_exclusive(thread_data);
 
-    if (TCR_4(thread_data->td.td_deque_ntasks) >=
+    if (__kmp_task_deque_ntasks(thread_data) >=
         TASK_DEQUE_SIZE(thread_data->td)) {
       KA_TRACE(30, ("__kmp_give_task: queue is full while giving task %p to "
                     "thread %d.\n",
@@ -3807,21 +4073,21 @@ static bool __kmp_give_task(kmp_info_t *thread, kmp_int32 tid, kmp_task_t *task,
     }
   }
 
-  // lock is held here, and there is space in the deque
+  // the deque is held exclusively here, and there is space in it
 
-  thread_data->td.td_deque[thread_data->td.td_deque_tail] = taskdata;
-  // Wrap index.
-  thread_data->td.td_deque_tail =
-      (thread_data->td.td_deque_tail + 1) & TASK_DEQUE_MASK(thread_data->td);
-  TCW_4(thread_data->td.td_deque_ntasks,
-        TCR_4(thread_data->td.td_deque_ntasks) + 1);
+  {
+    kmp_uint32 tail = KMP_ATOMIC_LD_RLX(&thread_data->td.td_deque_tail);
+    thread_data->td.td_deque[tail & TASK_DEQUE_MASK(thread_data->td)] =
+        taskdata;
+    KMP_ATOMIC_ST_REL(&thread_data->td.td_deque_tail, tail + 1);
+  }
 
   result = true;
   KA_TRACE(30, ("__kmp_give_task: successfully gave task %p to thread %d.\n",
                 taskdata, tid));
 
 release_and_exit:
-  __kmp_release_bootstrap_lock(&thread_data->td.td_deque_lock);
+  __kmp_release_task_deque_exclusive(thread_data);
 
   return result;
 }
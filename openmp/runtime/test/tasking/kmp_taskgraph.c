@@ -0,0 +1,88 @@
+// RUN: %libomp-compile-and-run
+#include <stdio.h>
+#include <stdlib.h>
+#include <omp.h>
+
+/**
+ * A taskgraph region creates the same graph of dependences at every step,
+ * on buffers that are allocated anew, so the graph recorded at the first step
+ * is replayed at the next ones. Some steps create a different graph, which
+ * must be detected so that the dependences are resolved normally there.
+ */
+
+typedef struct ident ident_t;
+extern int __kmpc_global_thread_num(ident_t *);
+extern void __kmpc_taskgraph_begin(ident_t *, int gtid, int graph_id);
+extern void __kmpc_taskgraph_end(ident_t *, int gtid);
+
+#define N 64
+#define STEPS 20
+#define GRAPH_ID 1
+
+// Every element is overwritten from its left neighbour, which the tasks must
+// have computed before
+static void compute(int *a, int *b, int step, int tasks) {
+  int i;
+  for (i = 0; i < N; i++) {
+    #pragma omp task depend(out : a[i]) firstprivate(i)
+    a[i] = i + step;
+  }
+  for (i = 1; i < N; i++) {
+    #pragma omp task depend(in : a[i - 1]) depend(inout : a[i]) firstprivate(i)
+    a[i] = (a[i] + 2 * a[i - 1]) % 1009;
+  }
+  for (i = 0; i < N; i++) {
+    #pragma omp task depend(in : a[i]) depend(out : b[i]) firstprivate(i)
+    b[i] = a[i] % 1000;
+  }
+  if (tasks) {
+    // A different graph: more tasks, and tasks with other depend items
+    for (i = 1; i < N; i++) {
+      #pragma omp task depend(in : b[i - 1]) depend(inout : b[i]) \
+                       depend(in : a[0]) firstprivate(i)
+      b[i] += b[i - 1] % 7;
+    }
+  }
+}
+
+static void check(const int *b, int step, int tasks) {
+  int a[N], c[N], i;
+  for (i = 0; i < N; i++)
+    a[i] = i + step;
+  for (i = 1; i < N; i++)
+    a[i] = (a[i] + 2 * a[i - 1]) % 1009;
+  for (i = 0; i < N; i++)
+    c[i] = a[i] % 1000;
+  if (tasks)
+    for (i = 1; i < N; i++)
+      c[i] += c[i - 1] % 7;
+  for (i = 0; i < N; i++) {
+    if (b[i] != c[i]) {
+      fprintf(stderr, "step %d: b[%d] = %d, expected %d\n", step, i, b[i],
+              c[i]);
+      exit(1);
+    }
+  }
+}
+
+int main() {
+  #pragma omp parallel num_threads(4)
+  #pragma omp single
+  {
+    int gtid = __kmpc_global_thread_num(NULL);
+    int step;
+    for (step = 0; step < STEPS; step++) {
+      int *a = (int *)malloc(N * sizeof(int));
+      int *b = (int *)malloc(N * sizeof(int));
+      int tasks = step == 5 || step == 12;
+      __kmpc_taskgraph_begin(NULL, gtid, GRAPH_ID);
+      compute(a, b, step, tasks);
+      __kmpc_taskgraph_end(NULL, gtid);
+      check(b, step, tasks);
+      free(a);
+      free(b);
+    }
+  }
+  printf("passed\n");
+  return 0;
+}
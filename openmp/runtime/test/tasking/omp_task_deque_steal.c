@@ -0,0 +1,64 @@
+// RUN: %libomp-compile && env KMP_ENABLE_TASK_THROTTLING=0 %libomp-run
+// RUN: %libomp-compile && env KMP_ENABLE_TASK_THROTTLING=1 %libomp-run
+
+#include <stdio.h>
+#include <omp.h>
+
+/**
+ * Stress the task deques, which the owner thread pushes to and pops from
+ * without a lock while the other threads steal from them.
+ * A recursive fib makes every thread push, pop and steal concurrently; then
+ * the master thread pushes many tasks at once, so that without throttling its
+ * deque is grown while thieves are taking tasks from its head.
+ * Every task must be executed exactly once.
+ */
+
+#define N 20
+#define NUM_TASKS 5000
+#define REPS 10
+
+static long fib(int n) {
+  long x, y;
+  if (n < 2)
+    return n;
+  #pragma omp task shared(x)
+  x = fib(n - 1);
+  #pragma omp task shared(y)
+  y = fib(n - 2);
+  #pragma omp taskwait
+  return x + y;
+}
+
+int main() {
+  int r, i;
+  long expect = 6765;
+  for (r = 0; r < REPS; r++) {
+    long result = 0;
+    int count = 0;
+    #pragma omp parallel num_threads(4)
+    #pragma omp single
+    result = fib(N);
+    if (result != expect) {
+      fprintf(stderr, "fib(%d) = %ld, expected %ld\n", N, result, expect);
+      return 1;
+    }
+
+    #pragma omp parallel num_threads(4)
+    #pragma omp master
+    {
+      for (i = 0; i < NUM_TASKS; i++) {
+        #pragma omp task
+        {
+          #pragma omp atomic
+          count++;
+        }
+      }
+    }
+    if (count != NUM_TASKS) {
+      fprintf(stderr, "%d tasks executed, expected %d\n", count, NUM_TASKS);
+      return 1;
+    }
+  }
+  printf("passed\n");
+  return 0;
+}
@@ -232,6 +232,14 @@ protected:
   /// isl_ast_op_lt type.
   int getNumberOfIterations(isl::ast_node For);
 
+  /// Return whether the parallel loop @p For is known to execute too few
+  /// iterations for running it in parallel to pay off.
+  ///
+  /// The number of iterations is taken from the loop bounds if they are
+  /// constant and otherwise from the profile of the original loop, if the
+  /// loop enumerates the iterations of an original loop one by one.
+  bool hasTooFewIterationsForParallelism(isl::ast_node For);
+
   /// Compute the values and loops referenced in this subtree.
   ///
   /// This function looks at all ScopStmts scheduled below the provided For node
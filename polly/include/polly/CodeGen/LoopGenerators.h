@@ -34,6 +34,7 @@ enum class OMPGeneralSchedulingType {
 extern int PollyNumThreads;
 extern OMPGeneralSchedulingType PollyScheduling;
 extern int PollyChunkSize;
+extern int PollyMinParallelIterations;
 
 /// Create a scalar do/for-style loop.
 ///
@@ -177,6 +178,19 @@ public:
   /// @return A pointer to the subfunction.
   Function *createSubFnDefinition();
 
+  /// Create the number of threads to request from the runtime.
+  ///
+  /// Loops with fewer than PollyMinParallelIterations iterations are run by a
+  /// single thread, which is how the OpenMP 'if' clause is implemented. Other
+  /// loops use PollyNumThreads, where zero leaves the choice to the runtime.
+  ///
+  /// @param LB     The lower bound for the loop we parallelize.
+  /// @param UB     The (exclusive) upper bound for the loop we parallelize.
+  /// @param Stride The stride of the loop we parallelize.
+  ///
+  /// @return The number of threads as an i32 value.
+  Value *createNumThreads(Value *LB, Value *UB, Value *Stride);
+
   /// Create the runtime library calls for spawn and join of the worker threads.
   /// Additionally, places a call to the specified subfunction.
   ///
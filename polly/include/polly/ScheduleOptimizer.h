@@ -191,7 +191,8 @@ private:
   ///
   /// @param Node The node that contains a band to be optimized. The node
   ///             is required to successfully pass
-  ///             ScheduleTreeOptimizer::isMatrMultPattern.
+  ///             ScheduleTreeOptimizer::isMatrMultPattern or
+  ///             ScheduleTreeOptimizer::isTensorContractionPattern.
   /// @param TTI  Target Transform Info.
   /// @param MMI  Parameters of the matrix multiplication operands.
   /// @returns    The transformed schedule.
@@ -301,6 +302,31 @@ private:
                                 const polly::Dependences *D,
                                 polly::MatMulInfoTy &MMI);
 
+  /// Check if this node contains a tensor contraction or a convolution that
+  ///        could be optimized like a matrix multiplication.
+  ///
+  /// isTensorContractionPattern tries to determine whether the following
+  /// conditions are true:
+  /// 1. the partial schedule contains only one statement, whose loops are
+  ///    all in the band.
+  /// 2. the loops can be split into ones the result depends on and ones that
+  ///    only carry its reduction, which must be permutable.
+  /// 3. there are two operands and three loops i, j and k, such that the
+  ///    result depends on i and j, the first operand on i and k and the
+  ///    second on j and k, and k is a reduction loop.
+  /// If this is the case, the statement is a matrix multiplication in i, j
+  /// and k for every iteration of the other loops, and we can use the same
+  /// approach as for isMatrMultPattern, with the other loops outside of the
+  /// kernels.
+  ///
+  /// @param Node The node to check.
+  /// @param D    The SCoP dependencies.
+  /// @param MMI  Parameters of the operands and loops of the corresponding
+  ///             matrix multiplication.
+  static bool isTensorContractionPattern(isl::schedule_node Node,
+                                         const polly::Dependences *D,
+                                         polly::MatMulInfoTy &MMI);
+
   /// Create the BLIS macro-kernel.
   ///
   /// We create the BLIS macro-kernel by applying a combination of tiling
@@ -1694,6 +1694,9 @@ private:
   /// Flag to indicate that the scheduler actually optimized the SCoP.
   bool IsOptimized = false;
 
+  /// The time ScopBuilder took to build the SCoP, in microseconds.
+  uint64_t BuildTime = 0;
+
   /// True if the underlying region has a single exiting block.
   bool HasSingleExitEdge;
 
@@ -2441,6 +2444,9 @@ public:
   /// Check if the SCoP has been optimized by the scheduler.
   bool isOptimized() const { return IsOptimized; }
 
+  /// Return the time it took to build the SCoP, in microseconds.
+  uint64_t getBuildTime() const { return BuildTime; }
+
   /// Mark the SCoP to be skipped by ScopPass passes.
   void markAsToBeSkipped() { SkipScop = true; }
 
@@ -31,6 +31,8 @@ STATISTIC(ScopsProcessed,
 STATISTIC(ScopsPruned, "Number of pruned SCoPs because it they cannot be "
                        "optimized in a significant way");
 STATISTIC(ScopsSurvived, "Number of SCoPs after pruning");
+STATISTIC(PrunedScopsBuildTime,
+          "Microseconds spent building SCoPs that were pruned");
 
 STATISTIC(NumPrunedLoops, "Number of pruned loops");
 STATISTIC(NumPrunedBoxedLoops, "Number of pruned boxed loops");
@@ -46,6 +48,7 @@ private:
     auto ScopStats = S.getStatistics();
     if (Pruned) {
       ScopsPruned++;
+      PrunedScopsBuildTime += S.getBuildTime();
       NumPrunedLoops += ScopStats.NumAffineLoops + ScopStats.NumBoxedLoops;
       NumPrunedBoxedLoops += ScopStats.NumBoxedLoops;
       NumPrunedAffineLoops += ScopStats.NumAffineLoops;
@@ -51,6 +51,7 @@
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/raw_ostream.h"
 #include <cassert>
+#include <chrono>
 
 using namespace llvm;
 using namespace polly;
@@ -61,6 +62,11 @@ STATISTIC(ScopFound, "Number of valid Scops");
 STATISTIC(RichScopFound, "Number of Scops containing a loop");
 STATISTIC(InfeasibleScops,
           "Number of SCoPs with statically infeasible context.");
+STATISTIC(EarlyUnprofitableScops,
+          "Number of SCoPs dismissed as unprofitable before building domains");
+STATISTIC(ScopBuildTime, "Microseconds spent building valid SCoPs");
+STATISTIC(DismissedScopBuildTime,
+          "Microseconds spent building SCoPs that were dismissed");
 
 bool polly::ModelReadOnlyScalars;
 
@@ -1214,7 +1220,6 @@ void ScopBuilder::buildDomain(ScopStmt &Stmt) {
 }
 
 void ScopBuilder::collectSurroundingLoops(ScopStmt &Stmt) {
-  isl::set Domain = Stmt.getDomain();
   BasicBlock *BB = Stmt.getEntryBlock();
 
   Loop *L = LI.getLoopFor(BB);
@@ -1849,6 +1854,8 @@ void ScopBuilder::buildScop(Region &R, AssumptionCache &AC,
   scop.reset(new Scop(R, SE, LI, DT, *SD.getDetectionContext(&R), ORE));
 
   buildStmts(R);
+  for (ScopStmt &Stmt : *scop)
+    collectSurroundingLoops(Stmt);
 
   // Create all invariant load instructions first. These are categorized as
   // 'synthesizable', therefore are not part of any ScopStmt but need to be
@@ -1907,6 +1914,19 @@ void ScopBuilder::buildScop(Region &R, AssumptionCache &AC,
 
   buildInvariantEquivalenceClasses();
 
+  // Check for profitability before isl gets involved, which can take most of
+  // the compile time on large functions. The statements, their loops and
+  // their accesses are already known, and the statements removed below can
+  // only make the SCoP less profitable.
+  if (!scop->isProfitable(UnprofitableScalarAccs)) {
+    EarlyUnprofitableScops++;
+    scop->invalidate(PROFITABLE, DebugLoc());
+    LLVM_DEBUG(
+        dbgs() << "Bailing-out because SCoP is not considered profitable "
+                  "(early)\n");
+    return;
+  }
+
   /// A map from basic blocks to their invalid domains.
   DenseMap<BasicBlock *, isl::set> InvalidDomainMap;
 
@@ -1937,8 +1957,6 @@ void ScopBuilder::buildScop(Region &R, AssumptionCache &AC,
 
   // The ScopStmts now have enough information to initialize themselves.
   for (ScopStmt &Stmt : *scop) {
-    collectSurroundingLoops(Stmt);
-
     buildDomain(Stmt);
     buildAccessRelations(Stmt);
 
@@ -2009,18 +2027,25 @@ ScopBuilder::ScopBuilder(Region *R, AssumptionCache &AC, AliasAnalysis &AA,
   ORE.emit(OptimizationRemarkAnalysis(DEBUG_TYPE, "ScopEntry", Beg, P.first)
            << Msg);
 
+  auto Start = std::chrono::steady_clock::now();
   buildScop(*R, AC, ORE);
+  scop->BuildTime = std::chrono::duration_cast<std::chrono::microseconds>(
+                        std::chrono::steady_clock::now() - Start)
+                        .count();
 
   LLVM_DEBUG(dbgs() << *scop);
 
   if (!scop->hasFeasibleRuntimeContext()) {
     InfeasibleScops++;
+    DismissedScopBuildTime += scop->getBuildTime();
     Msg = "SCoP ends here but was dismissed.";
-    LLVM_DEBUG(dbgs() << "SCoP detected but dismissed\n");
+    LLVM_DEBUG(dbgs() << "SCoP detected but dismissed after "
+                      << scop->getBuildTime() << "us\n");
     scop.reset();
   } else {
     Msg = "SCoP ends here.";
     ++ScopFound;
+    ScopBuildTime += scop->getBuildTime();
     if (scop->getMaxLoopDepth() > 0)
       ++RichScopFound;
   }
@@ -25,6 +25,7 @@
 #include "polly/Support/SCEVValidator.h"
 #include "polly/Support/ScopHelper.h"
 #include "llvm/ADT/APInt.h"
+#include "llvm/ADT/Optional.h"
 #include "llvm/ADT/PostOrderIterator.h"
 #include "llvm/ADT/SetVector.h"
 #include "llvm/ADT/SmallPtrSet.h"
@@ -49,6 +50,7 @@
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Transforms/Utils/BasicBlockUtils.h"
+#include "llvm/Transforms/Utils/LoopUtils.h"
 #include "isl/aff.h"
 #include "isl/aff_type.h"
 #include "isl/ast.h"
@@ -76,6 +78,9 @@ STATISTIC(VersionedScops, "Number of SCoPs that required versioning.");
 
 STATISTIC(SequentialLoops, "Number of generated sequential for-loops");
 STATISTIC(ParallelLoops, "Number of generated parallel for-loops");
+STATISTIC(SmallParallelLoops,
+          "Number of parallel for-loops generated as sequential loops because "
+          "of their low number of iterations");
 STATISTIC(VectorLoops, "Number of generated vector for-loops");
 STATISTIC(IfConditions, "Number of generated if-conditions");
 
@@ -204,6 +209,69 @@ int IslNodeBuilder::getNumberOfIterations(isl::ast_node For) {
     return NumberIterations + 1;
 }
 
+/// Return the profiled trip count of the original loop which @p For
+/// enumerates, if any.
+///
+/// This is the case if, for every statement below @p For, the iterator of
+/// @p For is equal to one of the statement's loop iterators. The result is the
+/// largest trip count among these loops.
+static Optional<unsigned> getProfiledTripCount(isl::ast_node For) {
+  isl::union_map Schedule = isl::manage(IslAstInfo::getSchedule(For.get()));
+  if (!Schedule || Schedule.is_empty())
+    return None;
+
+  unsigned TripCount = 0;
+  for (isl::map Map : Schedule.get_map_list()) {
+    ScopStmt *Stmt =
+        static_cast<ScopStmt *>(Map.get_tuple_id(isl::dim::in).get_user());
+
+    // The iterator of @p For is the innermost schedule dimension.
+    unsigned NumDims = Map.dim(isl::dim::out);
+    isl::map LoopMap = Map.project_out(isl::dim::out, 0, NumDims - 1);
+
+    Loop *L = nullptr;
+    for (unsigned i = 0; i < LoopMap.dim(isl::dim::in) && !L; i++) {
+      isl::map Identity = isl::map::universe(LoopMap.get_space())
+                              .equate(isl::dim::in, i, isl::dim::out, 0);
+      if (LoopMap.is_subset(Identity))
+        L = Stmt->getLoopForDimension(i);
+    }
+    if (!L)
+      return None;
+
+    Optional<unsigned> LoopTripCount = getLoopEstimatedTripCount(L);
+    if (!LoopTripCount)
+      return None;
+    TripCount = std::max(TripCount, *LoopTripCount);
+  }
+
+  return TripCount;
+}
+
+bool IslNodeBuilder::hasTooFewIterationsForParallelism(isl::ast_node For) {
+  if (PollyMinParallelIterations <= 1)
+    return false;
+
+  CmpInst::Predicate Predicate;
+  isl::ast_expr Init = For.for_get_init();
+  isl::ast_expr Inc = For.for_get_inc();
+  isl::ast_expr UB = getUpperBound(For, Predicate);
+  if (isl_ast_expr_get_type(Init.get()) == isl_ast_expr_int &&
+      isl_ast_expr_get_type(Inc.get()) == isl_ast_expr_int &&
+      isl_ast_expr_get_type(UB.get()) == isl_ast_expr_int) {
+    long InitVal = Init.get_val().get_num_si();
+    long IncVal = Inc.get_val().get_num_si();
+    long UBVal = UB.get_val().get_num_si();
+    long Extent = UBVal - InitVal + (Predicate == CmpInst::ICMP_SLE ? 1 : 0);
+    long NumIterations = Extent <= 0 ? 0 : (Extent + IncVal - 1) / IncVal;
+    return NumIterations < PollyMinParallelIterations;
+  }
+
+  Optional<unsigned> TripCount = getProfiledTripCount(For);
+  return TripCount &&
+         *TripCount < static_cast<unsigned>(PollyMinParallelIterations);
+}
+
 /// Extract the values and SCEVs needed to generate code for a block.
 static int findReferencesInBlock(struct SubtreeReferences &References,
                                  const ScopStmt *Stmt, BasicBlock *BB) {
@@ -771,6 +839,14 @@ void IslNodeBuilder::createFor(__isl_take isl_ast_node *For) {
   }
 
   if (IslAstInfo::isExecutedInParallel(For)) {
+    // Loops with few iterations do not amortize the cost of starting and
+    // joining the threads. The remaining small loops are detected at run time
+    // by the parallel loop generator.
+    if (hasTooFewIterationsForParallelism(isl::manage_copy(For))) {
+      SmallParallelLoops++;
+      createForSequential(isl::manage(For), true);
+      return;
+    }
     createForParallel(For);
     return;
   }
@@ -1222,7 +1298,7 @@ Value *IslNodeBuilder::preloadUnconditionally(isl_set *AccessRange,
   return PreloadVal;
 }
 
-Value *IslNodeBuilder::preloadInvariantLoad(const MemoryAccess &MA,
+Value *IslNodeBuilder::preloadInvariantLoad(const polly::MemoryAccess &MA,
                                             isl_set *Domain) {
   isl_set *AccessRange = isl_map_range(MA.getAddressFunction().release());
   AccessRange = isl_set_gist_params(AccessRange, S.getContext().release());
@@ -1322,7 +1398,7 @@ bool IslNodeBuilder::preloadInvariantEquivClass(
   if (MAs.empty())
     return true;
 
-  MemoryAccess *MA = MAs.front();
+  polly::MemoryAccess *MA = MAs.front();
   assert(MA->isArrayKind() && MA->isRead());
 
   // If the access function was already mapped, the preload of this equivalence
@@ -1379,7 +1455,7 @@ bool IslNodeBuilder::preloadInvariantEquivClass(
   if (!PreloadVal)
     return false;
 
-  for (const MemoryAccess *MA : MAs) {
+  for (const polly::MemoryAccess *MA : MAs) {
     Instruction *MAAccInst = MA->getAccessInstruction();
     assert(PreloadVal->getType() == MAAccInst->getType());
     ValueMap[MAAccInst] = PreloadVal;
@@ -1404,7 +1480,7 @@ bool IslNodeBuilder::preloadInvariantEquivClass(
   for (auto *DerivedSAI : SAI->getDerivedSAIs()) {
     Value *BasePtr = DerivedSAI->getBasePtr();
 
-    for (const MemoryAccess *MA : MAs) {
+    for (const polly::MemoryAccess *MA : MAs) {
       // As the derived SAI information is quite coarse, any load from the
       // current SAI could be the base pointer of the derived SAI, however we
       // should only change the base pointer of the derived SAI if we actually
@@ -1420,7 +1496,7 @@ bool IslNodeBuilder::preloadInvariantEquivClass(
     }
   }
 
-  for (const MemoryAccess *MA : MAs) {
+  for (const polly::MemoryAccess *MA : MAs) {
     Instruction *MAAccInst = MA->getAccessInstruction();
     // Use the escape system to get the correct value to users outside the SCoP.
     BlockGenerator::EscapeUserVectorTy EscapeUsers;
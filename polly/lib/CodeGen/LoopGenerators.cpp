@@ -27,6 +27,7 @@ using namespace polly;
 int polly::PollyNumThreads;
 OMPGeneralSchedulingType polly::PollyScheduling;
 int polly::PollyChunkSize;
+int polly::PollyMinParallelIterations;
 
 static cl::opt<int, true>
     XPollyNumThreads("polly-num-threads",
@@ -55,6 +56,13 @@ static cl::opt<int, true>
                     cl::Hidden, cl::location(polly::PollyChunkSize),
                     cl::init(0), cl::Optional, cl::cat(PollyCategory));
 
+static cl::opt<int, true> XPollyMinParallelIterations(
+    "polly-parallel-min-iterations",
+    cl::desc("Execute parallel loops with fewer iterations on a single "
+             "thread (0 = always use all threads)"),
+    cl::Hidden, cl::location(polly::PollyMinParallelIterations), cl::init(2),
+    cl::Optional, cl::cat(PollyCategory));
+
 // We generate a loop of either of the following structures:
 //
 //              BeforeBB                      BeforeBB
@@ -214,6 +222,23 @@ Function *ParallelLoopGenerator::createSubFnDefinition() {
   return SubFn;
 }
 
+Value *ParallelLoopGenerator::createNumThreads(Value *LB, Value *UB,
+                                               Value *Stride) {
+  if (PollyMinParallelIterations <= 1)
+    return Builder.getInt32(PollyNumThreads);
+
+  // The loop has fewer than PollyMinParallelIterations iterations iff
+  // UB - LB <= (PollyMinParallelIterations - 1) * Stride.
+  Value *Extent = Builder.CreateSub(UB, LB, "polly.par.extent");
+  Value *MaxExtent = Builder.CreateMul(
+      Stride, ConstantInt::get(LongType, PollyMinParallelIterations - 1));
+  Value *IsSmall =
+      Builder.CreateICmpSLE(Extent, MaxExtent, "polly.par.fewIterations");
+  return Builder.CreateSelect(IsSmall, Builder.getInt32(1),
+                              Builder.getInt32(PollyNumThreads),
+                              "polly.par.numThreads");
+}
+
 AllocaInst *
 ParallelLoopGenerator::storeValuesIntoStruct(SetVector<Value *> &Values) {
   SmallVector<Type *, 8> Members;
@@ -41,7 +41,7 @@ void ParallelLoopGeneratorGOMP::createCallSpawnThreads(Value *SubFn,
     F = Function::Create(Ty, Linkage, Name, M);
   }
 
-  Value *Args[] = {SubFn, SubFnParam, Builder.getInt32(PollyNumThreads),
+  Value *Args[] = {SubFn, SubFnParam, createNumThreads(LB, UB, Stride),
                    LB,    UB,         Stride};
 
   Builder.CreateCall(F, Args);
@@ -63,10 +63,13 @@ void ParallelLoopGeneratorKMP::deployParallelExecution(Value *SubFn,
                                                        Value *SubFnParam,
                                                        Value *LB, Value *UB,
                                                        Value *Stride) {
-  // Inform OpenMP runtime about the number of threads if greater than zero
-  if (PollyNumThreads > 0) {
+  // Inform OpenMP runtime about the number of threads if greater than zero.
+  // The runtime ignores a request for zero threads, so a number which is only
+  // known at run time can be pushed unconditionally.
+  Value *NumThreads = createNumThreads(LB, UB, Stride);
+  if (!isa<ConstantInt>(NumThreads) || PollyNumThreads > 0) {
     Value *GlobalThreadID = createCallGlobalThreadNum();
-    createCallPushNumThreads(GlobalThreadID, Builder.getInt32(PollyNumThreads));
+    createCallPushNumThreads(GlobalThreadID, NumThreads);
   }
 
   // Tell the runtime we start a parallel loop
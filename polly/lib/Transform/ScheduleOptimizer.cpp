@@ -54,7 +54,9 @@
 #include "polly/ScopInfo.h"
 #include "polly/ScopPass.h"
 #include "polly/Simplify.h"
+#include "polly/Support/GICHelper.h"
 #include "polly/Support/ISLOStream.h"
+#include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/Statistic.h"
 #include "llvm/Analysis/TargetTransformInfo.h"
 #include "llvm/IR/Function.h"
@@ -103,6 +105,12 @@ static cl::opt<int> MaxCoefficient(
     cl::desc("The maximal coefficient allowed (-1 is unlimited)"), cl::Hidden,
     cl::init(20), cl::ZeroOrMore, cl::cat(PollyCategory));
 
+static cl::opt<int> ScheduleComputeOut(
+    "polly-schedule-computeout",
+    cl::desc("Bound the scheduler by a maximal amount of computational steps "
+             "(0 means no bound)"),
+    cl::Hidden, cl::init(300000), cl::ZeroOrMore, cl::cat(PollyCategory));
+
 static cl::opt<std::string> FusionStrategy(
     "polly-opt-fusion", cl::desc("The fusion strategy to choose (min/max)"),
     cl::Hidden, cl::init("min"), cl::ZeroOrMore, cl::cat(PollyCategory));
@@ -270,6 +278,8 @@ static cl::opt<bool> OptimizedScops(
 STATISTIC(ScopsProcessed, "Number of scops processed");
 STATISTIC(ScopsRescheduled, "Number of scops rescheduled");
 STATISTIC(ScopsOptimized, "Number of scops optimized");
+STATISTIC(ScheduleComputeOuts,
+          "Number of scops for which the scheduler exceeded its budget");
 
 STATISTIC(NumAffineLoopsOptimized, "Number of affine loops optimized");
 STATISTIC(NumBoxedLoopsOptimized, "Number of boxed loops optimized");
@@ -293,6 +303,8 @@ STATISTIC(RegisterTileOpts, "Number of register tiling applied");
 STATISTIC(PrevectOpts, "Number of strip-mining for prevectorization applied");
 STATISTIC(MatMulOpts,
           "Number of matrix multiplication patterns detected and optimized");
+STATISTIC(ContractionOpts,
+          "Number of tensor contraction patterns detected and optimized");
 
 /// Create an isl::union_set, which describes the isolate option based on
 /// IsolateDomain.
@@ -797,6 +809,205 @@ static bool containsMatrMult(isl::map PartialSchedule, const Dependences *D,
   return true;
 }
 
+/// Check whether the memory access @p MemAccess reads or writes different
+/// memory when the loop @p Pos of @p Schedule advances and all the other loops
+/// stay where they are.
+static bool dependsOnLoop(MemoryAccess *MemAccess, isl::map Schedule, int Pos) {
+  unsigned OutDimNum = Schedule.dim(isl::dim::out);
+  auto Map = permuteDimensions(Schedule, isl::dim::out, Pos, OutDimNum - 1);
+  return !MemAccess->isStrideZero(Map);
+}
+
+/// Check whether one of the subscripts of the access relation @p AccMap is
+/// the input dimension @p Pos alone.
+static bool hasPlainSubscript(isl::set Domain, isl::map AccMap, int Pos) {
+  AccMap = AccMap.intersect_domain(Domain);
+  isl::map Universe = isl::map::universe(AccMap.get_space());
+  for (unsigned i = 0; i < AccMap.dim(isl::dim::out); i++)
+    if (AccMap.is_subset(Universe.equate(isl::dim::in, Pos, isl::dim::out, i)))
+      return true;
+  return false;
+}
+
+/// Check for dependencies corresponding to a tensor contraction.
+///
+/// Check that the true and reduction dependences of the SCoP statement with
+/// the domain space @p Space are only carried by the loops marked in
+/// @p IsReductionLoop and that no dependence has a negative distance in any
+/// loop. The latter makes every order of the loops valid, in particular the
+/// one the BLIS kernels need.
+///
+/// @param Space           The space of the domain of the SCoP statement.
+/// @param D               The SCoP dependencies.
+/// @param IsReductionLoop The loops the output of the statement does not
+///                        depend on.
+/// @return True in case the dependencies correspond to a tensor contraction
+///         and false, otherwise.
+static bool containsOnlyContractionDeps(isl::space Space, const Dependences *D,
+                                        ArrayRef<bool> IsReductionLoop) {
+  auto MapSpace = Space.map_from_domain_and_range(Space);
+  isl::union_map Dep = D->getDependences(Dependences::TYPE_RAW);
+  isl::union_map Red = D->getDependences(Dependences::TYPE_RED);
+  if (Red)
+    Dep = Dep.unite(Red);
+  auto Deltas = Dep.extract_map(MapSpace).deltas();
+  if (Deltas.is_empty())
+    return false;
+  auto Carried = isl::set::universe(Deltas.get_space());
+  for (unsigned i = 0; i < IsReductionLoop.size(); i++)
+    if (!IsReductionLoop[i])
+      Carried = Carried.fix_si(isl::dim::set, i, 0);
+  if (!Deltas.is_subset(Carried))
+    return false;
+
+  isl::union_map Validity = D->getDependences(
+      Dependences::TYPE_RAW | Dependences::TYPE_WAR | Dependences::TYPE_WAW);
+  auto ValidityDeltas = Validity.extract_map(MapSpace).deltas();
+  auto NonNegative = isl::set::universe(ValidityDeltas.get_space());
+  for (unsigned i = 0; i < IsReductionLoop.size(); i++)
+    NonNegative = NonNegative.lower_bound_si(isl::dim::set, i, 0);
+  return ValidityDeltas.is_subset(NonNegative);
+}
+
+/// Pick the innermost of the loops for which @p Candidate holds.
+///
+/// @return The position of the loop or -1, if there is none.
+template <typename PredTy>
+static int getInnermostLoop(unsigned LoopNum, PredTy Candidate) {
+  for (int i = static_cast<int>(LoopNum) - 1; i >= 0; i--)
+    if (Candidate(i))
+      return i;
+  return -1;
+}
+
+/// Check if the SCoP statement is a tensor contraction or a convolution that
+/// could be optimized like a matrix multiplication.
+///
+/// A tensor contraction C[I, J] += A[I, P] * B[P, J], where I, J and P are
+/// sets of loops, is a matrix multiplication with the loops of I, J and P
+/// grouped together. The BLIS kernels only need one loop of each: the
+/// remaining ones stay outside of the kernels, and for every iteration of
+/// them the statement is a matrix multiplication of the blocks of A and B
+/// selected by i, j and k, the loops of I, J and P kept inside. The same
+/// holds for direct convolutions, such as
+/// Out[n, oc, oh, ow] += In[n, ic, oh + kh, ow + kw] * W[oc, ic, kh, kw],
+/// whose subscripts may be sums of loops: only what is accessed matters, not
+/// how the subscripts are formed.
+///
+/// containsTensorContraction checks that:
+/// 1. The last memory access modeling an array writes to C and there is
+///    a read of the same elements of C.
+/// 2. The true and reduction dependences are only carried by the loops C does
+///    not depend on, the reduction loops P, and no dependence has a negative
+///    distance.
+/// 3. There are exactly two other reads of arrays, A and B, that depend on
+///    a loop of the statement. There are loops i, j and k, such that C
+///    depends on i and j, A on i and k, but not on j, and B on j and k, but
+///    not on i, and k is a reduction loop.
+///
+/// Of the loops that qualify, i and j are the innermost ones, which are
+/// likely to access memory contiguously, and k the innermost one that is
+/// a plain subscript of both A and B, if there is one, so that k is not
+/// a loop of a convolution window.
+///
+/// @param Schedule The identity schedule of the SCoP statement to check.
+/// @param D        The SCoP dependencies.
+/// @param MMI      Parameters of the operands of the corresponding matrix
+///                 multiplication.
+static bool containsTensorContraction(isl::map Schedule, const Dependences *D,
+                                      MatMulInfoTy &MMI) {
+  auto InputDimsId = Schedule.get_tuple_id(isl::dim::in);
+  auto *Stmt = static_cast<ScopStmt *>(InputDimsId.get_user());
+  if (Stmt->size() <= 1)
+    return false;
+  unsigned LoopNum = Schedule.dim(isl::dim::out);
+  isl::set Domain = Stmt->getDomain();
+
+  auto Accesses = getAccessesInOrder(*Stmt);
+  for (auto *MemA = Accesses.end() - 1; MemA != Accesses.begin(); MemA--) {
+    auto *MemAccessPtr = *MemA;
+    if (!MemAccessPtr->isLatestArrayKind())
+      continue;
+    if (!MemAccessPtr->isWrite())
+      return false;
+    MMI.WriteToC = MemAccessPtr;
+    break;
+  }
+  if (!MMI.WriteToC)
+    return false;
+
+  SmallVector<bool, 8> IsReductionLoop(LoopNum);
+  for (unsigned i = 0; i < LoopNum; i++)
+    IsReductionLoop[i] = !dependsOnLoop(MMI.WriteToC, Schedule, i);
+  if (!containsOnlyContractionDeps(Stmt->getDomainSpace(), D, IsReductionLoop))
+    return false;
+
+  auto AccMapC =
+      MMI.WriteToC->getLatestAccessRelation().intersect_domain(Domain);
+  SmallVector<MemoryAccess *, 2> Operands;
+  for (auto *MemA = Accesses.begin(); MemA != Accesses.end() - 1; MemA++) {
+    auto *MemAccessPtr = *MemA;
+    if (!MemAccessPtr->isLatestArrayKind() || MemAccessPtr == MMI.WriteToC)
+      continue;
+    if (MemAccessPtr->isRead() && !MMI.ReadFromC &&
+        MemAccessPtr->getLatestAccessRelation()
+            .intersect_domain(Domain)
+            .is_equal(AccMapC)) {
+      MMI.ReadFromC = MemAccessPtr;
+      continue;
+    }
+    bool IsInvariant = true;
+    for (unsigned i = 0; i < LoopNum && IsInvariant; i++)
+      IsInvariant = !dependsOnLoop(MemAccessPtr, Schedule, i);
+    if (IsInvariant)
+      continue;
+    if (!MemAccessPtr->isRead() || Operands.size() == 2)
+      return false;
+    Operands.push_back(MemAccessPtr);
+  }
+  if (!MMI.ReadFromC || Operands.size() != 2)
+    return false;
+  MMI.A = Operands[0];
+  MMI.B = Operands[1];
+
+  SmallVector<bool, 8> DependsA(LoopNum), DependsB(LoopNum);
+  for (unsigned i = 0; i < LoopNum; i++) {
+    DependsA[i] = dependsOnLoop(MMI.A, Schedule, i);
+    DependsB[i] = dependsOnLoop(MMI.B, Schedule, i);
+  }
+  // The first read may as well be the second operand.
+  int I = getInnermostLoop(LoopNum, [&](unsigned Pos) {
+    return !IsReductionLoop[Pos] && DependsA[Pos] && !DependsB[Pos];
+  });
+  if (I < 0) {
+    std::swap(MMI.A, MMI.B);
+    std::swap(DependsA, DependsB);
+    I = getInnermostLoop(LoopNum, [&](unsigned Pos) {
+      return !IsReductionLoop[Pos] && DependsA[Pos] && !DependsB[Pos];
+    });
+  }
+  int J = getInnermostLoop(LoopNum, [&](unsigned Pos) {
+    return !IsReductionLoop[Pos] && DependsB[Pos] && !DependsA[Pos];
+  });
+  auto IsK = [&](unsigned Pos) {
+    return IsReductionLoop[Pos] && DependsA[Pos] && DependsB[Pos];
+  };
+  auto AccMapA = MMI.A->getLatestAccessRelation();
+  auto AccMapB = MMI.B->getLatestAccessRelation();
+  int K = getInnermostLoop(LoopNum, [&](unsigned Pos) {
+    return IsK(Pos) && hasPlainSubscript(Domain, AccMapA, Pos) &&
+           hasPlainSubscript(Domain, AccMapB, Pos);
+  });
+  if (K < 0)
+    K = getInnermostLoop(LoopNum, IsK);
+  if (I < 0 || J < 0 || K < 0)
+    return false;
+  MMI.i = I;
+  MMI.j = J;
+  MMI.k = K;
+  return true;
+}
+
 /// Permute two dimensions of the band node.
 ///
 /// Permute FirstDim and SecondDim dimensions of the Node.
@@ -1018,7 +1229,9 @@ getMacroKernelParams(const llvm::TargetTransformInfo *TTI,
 ///
 /// Create an access relation of the following form:
 /// [O0, O1, O2, O3, O4, O5, O6, O7, O8] -> [OI, O5, OJ]
-/// where I is @p FirstDim, J is @p SecondDim.
+/// where I is @p FirstDim, J is @p SecondDim. O0 - O8 are the last nine
+/// dimensions, those of the kernels, after the loops a tensor contraction
+/// keeps outside of them.
 ///
 /// It can be used, for example, to create relations that helps to consequently
 /// access elements of operands of a matrix multiplication after creation of
@@ -1041,11 +1254,15 @@ getMacroKernelParams(const llvm::TargetTransformInfo *TTI,
 /// @return The specified access relation.
 isl::map getMatMulAccRel(isl::map MapOldIndVar, unsigned FirstDim,
                          unsigned SecondDim) {
-  auto AccessRelSpace = isl::space(MapOldIndVar.get_ctx(), 0, 9, 3);
+  unsigned Dims = MapOldIndVar.dim(isl::dim::out);
+  unsigned Outer = Dims - 9;
+  auto AccessRelSpace = isl::space(MapOldIndVar.get_ctx(), 0, Dims, 3);
   auto AccessRel = isl::map::universe(AccessRelSpace);
-  AccessRel = AccessRel.equate(isl::dim::in, FirstDim, isl::dim::out, 0);
-  AccessRel = AccessRel.equate(isl::dim::in, 5, isl::dim::out, 1);
-  AccessRel = AccessRel.equate(isl::dim::in, SecondDim, isl::dim::out, 2);
+  AccessRel =
+      AccessRel.equate(isl::dim::in, Outer + FirstDim, isl::dim::out, 0);
+  AccessRel = AccessRel.equate(isl::dim::in, Outer + 5, isl::dim::out, 1);
+  AccessRel =
+      AccessRel.equate(isl::dim::in, Outer + SecondDim, isl::dim::out, 2);
   return MapOldIndVar.apply_range(AccessRel);
 }
 
@@ -1095,6 +1312,9 @@ optimizeDataLayoutMatrMulPattern(isl::schedule_node Node, isl::map MapOldIndVar,
                                  MatMulInfoTy &MMI) {
   auto InputDimsId = MapOldIndVar.get_tuple_id(isl::dim::in);
   auto *Stmt = static_cast<ScopStmt *>(InputDimsId.get_user());
+  // The loops a tensor contraction keeps outside of the kernels, which
+  // select the blocks to be copied.
+  unsigned Outer = MapOldIndVar.dim(isl::dim::out) - 9;
 
   // Create a copy statement that corresponds to the memory access to the
   // matrix B, the second operand of the matrix multiplication.
@@ -1110,8 +1330,8 @@ optimizeDataLayoutMatrMulPattern(isl::schedule_node Node, isl::map MapOldIndVar,
   AccRel = AccRel.set_tuple_id(isl::dim::out, SAI->getBasePtrId());
   auto OldAcc = MMI.B->getLatestAccessRelation();
   MMI.B->setNewAccessRelation(AccRel);
-  auto ExtMap = MapOldIndVar.project_out(isl::dim::out, 2,
-                                         MapOldIndVar.dim(isl::dim::out) - 2);
+  auto ExtMap = MapOldIndVar.project_out(
+      isl::dim::out, Outer + 2, MapOldIndVar.dim(isl::dim::out) - Outer - 2);
   ExtMap = ExtMap.reverse();
   ExtMap = ExtMap.fix_si(isl::dim::out, MMI.i, 0);
   auto Domain = Stmt->getDomain();
@@ -1138,8 +1358,8 @@ optimizeDataLayoutMatrMulPattern(isl::schedule_node Node, isl::map MapOldIndVar,
   AccRel = AccRel.set_tuple_id(isl::dim::out, SAI->getBasePtrId());
   OldAcc = MMI.A->getLatestAccessRelation();
   MMI.A->setNewAccessRelation(AccRel);
-  ExtMap = MapOldIndVar.project_out(isl::dim::out, 3,
-                                    MapOldIndVar.dim(isl::dim::out) - 3);
+  ExtMap = MapOldIndVar.project_out(
+      isl::dim::out, Outer + 3, MapOldIndVar.dim(isl::dim::out) - Outer - 3);
   ExtMap = ExtMap.reverse();
   ExtMap = ExtMap.fix_si(isl::dim::out, MMI.j, 0);
   NewStmt = Stmt->getParent()->addScopStmt(
@@ -1173,9 +1393,8 @@ getInductionVariablesSubstitution(isl::schedule_node Node,
   auto Child = Node.child(0);
   auto UnMapOldIndVar = Child.get_prefix_schedule_union_map();
   auto MapOldIndVar = isl::map::from_union_map(UnMapOldIndVar);
-  if (MapOldIndVar.dim(isl::dim::out) > 9)
-    return MapOldIndVar.project_out(isl::dim::out, 0,
-                                    MapOldIndVar.dim(isl::dim::out) - 9);
+  if (MapOldIndVar.dim(isl::dim::out) < 9)
+    return {};
   return MapOldIndVar;
 }
 
@@ -1288,6 +1507,13 @@ ScheduleTreeOptimizer::optimizeMatMulPattern(isl::schedule_node Node,
   Node = permuteBandNodeDimensions(Node, NewJ, DimOutNum - 2);
   NewK = NewK == DimOutNum - 2 ? NewJ : NewK;
   Node = permuteBandNodeDimensions(Node, NewK, DimOutNum - 1);
+
+  // The loops of a tensor contraction other than i, j and k stay outside of
+  // the kernels, in a band of their own.
+  if (DimOutNum > 3)
+    Node = isl::manage(
+               isl_schedule_node_band_split(Node.release(), DimOutNum - 3))
+               .child(0);
   auto MicroKernelParams = getMicroKernelParams(TTI, MMI);
   auto MacroKernelParams = getMacroKernelParams(TTI, MicroKernelParams, MMI);
   Node = createMacroKernel(Node, MacroKernelParams);
@@ -1324,6 +1550,31 @@ bool ScheduleTreeOptimizer::isMatrMultPattern(isl::schedule_node Node,
   return false;
 }
 
+bool ScheduleTreeOptimizer::isTensorContractionPattern(
+    isl::schedule_node Node, const Dependences *D, MatMulInfoTy &MMI) {
+  auto PartialSchedule = isl::manage(
+      isl_schedule_node_band_get_partial_schedule_union_map(Node.get()));
+  Node = Node.child(0);
+  auto LeafType = isl_schedule_node_get_type(Node.get());
+  Node = Node.parent();
+  if (LeafType != isl_schedule_node_leaf ||
+      isl_schedule_node_band_n_member(Node.get()) < 3 ||
+      Node.get_schedule_depth() != 0 ||
+      isl_union_map_n_map(PartialSchedule.get()) != 1)
+    return false;
+
+  // The loops are checked in the order of the domain, which the band is
+  // given back before it is optimized.
+  auto DomainSpace =
+      isl::map::from_union_map(PartialSchedule).get_space().domain();
+  if (DomainSpace.dim(isl::dim::set) !=
+      unsigned(isl_schedule_node_band_n_member(Node.get())))
+    return false;
+  auto Schedule = isl::map::identity(
+      DomainSpace.map_from_domain_and_range(DomainSpace));
+  return containsTensorContraction(Schedule, D, MMI);
+}
+
 __isl_give isl_schedule_node *
 ScheduleTreeOptimizer::optimizeBand(__isl_take isl_schedule_node *Node,
                                     void *User) {
@@ -1341,6 +1592,14 @@ ScheduleTreeOptimizer::optimizeBand(__isl_take isl_schedule_node *Node,
     return optimizeMatMulPattern(isl::manage(Node), OAI->TTI, MMI).release();
   }
 
+  MMI = MatMulInfoTy();
+  if (PMBasedOpts && User &&
+      isTensorContractionPattern(isl::manage_copy(Node), OAI->D, MMI)) {
+    LLVM_DEBUG(dbgs() << "The tensor contraction pattern was detected\n");
+    ContractionOpts++;
+    return optimizeMatMulPattern(isl::manage(Node), OAI->TTI, MMI).release();
+  }
+
   return standardBandOpts(isl::manage(Node), User).release();
 }
 
@@ -1585,15 +1844,28 @@ bool IslScheduleOptimizer::runOnScop(Scop &S) {
   isl_options_set_schedule_max_coefficient(Ctx, MaxCoefficient);
   isl_options_set_tile_scale_tile_loops(Ctx, 0);
 
-  auto OnErrorStatus = isl_options_get_on_error(Ctx);
-  isl_options_set_on_error(Ctx, ISL_ON_ERROR_CONTINUE);
-
-  auto SC = isl::schedule_constraints::on_domain(Domain);
-  SC = SC.set_proximity(Proximity);
-  SC = SC.set_validity(Validity);
-  SC = SC.set_coincidence(Validity);
-  auto Schedule = SC.compute_schedule();
-  isl_options_set_on_error(Ctx, OnErrorStatus);
+  isl::schedule Schedule;
+  {
+    IslMaxOperationsGuard MaxOpGuard(Ctx, ScheduleComputeOut);
+
+    auto OnErrorStatus = isl_options_get_on_error(Ctx);
+    isl_options_set_on_error(Ctx, ISL_ON_ERROR_CONTINUE);
+
+    auto SC = isl::schedule_constraints::on_domain(Domain);
+    SC = SC.set_proximity(Proximity);
+    SC = SC.set_validity(Validity);
+    SC = SC.set_coincidence(Validity);
+    Schedule = SC.compute_schedule();
+    isl_options_set_on_error(Ctx, OnErrorStatus);
+
+    if (MaxOpGuard.hasQuotaExceeded()) {
+      ScheduleComputeOuts++;
+      LLVM_DEBUG(dbgs() << "Scheduler exceeded its budget; keeping the "
+                           "original schedule\n");
+      Schedule = nullptr;
+      isl_ctx_reset_error(Ctx);
+    }
+  }
 
   walkScheduleTreeForStatistics(Schedule, 1);
 